@@ -0,0 +1,415 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <carla/client/ActorBlueprint.h>
+#include <carla/client/BlueprintLibrary.h>
+#include <carla/client/Client.h>
+#include <carla/client/Map.h>
+#include <carla/client/Sensor.h>
+#include <carla/client/TimeoutException.h>
+#include <carla/client/Vehicle.h>
+#include <carla/client/World.h>
+#include <carla/geom/Transform.h>
+#include <carla/rpc/Command.h>
+#include <carla/sensor/SensorData.h>
+
+namespace cc = carla::client;
+namespace cg = carla::geom;
+namespace cr = carla::rpc;
+
+using namespace std::chrono_literals;
+
+using Clock = std::chrono::steady_clock;
+
+#define EXPECT_TRUE(pred) if (!(pred)) { throw std::runtime_error(#pred); }
+
+// =============================================================================
+// -- Arguments ----------------------------------------------------------------
+// =============================================================================
+
+struct Arguments {
+  std::string host = "localhost";
+  uint16_t port = 2000u;
+  /// Map to load, the current one if empty.
+  std::string map;
+  size_t vehicles = 50u;
+  size_t sensors = 4u;
+  size_t ticks = 500u;
+  /// Ticks run before measuring, not reported.
+  size_t warm_up_ticks = 20u;
+  double delta_seconds = 0.05;
+  std::string sensor_type = "sensor.camera.rgb";
+  std::string image_size_x = "800";
+  std::string image_size_y = "600";
+  /// Write one line per tick as CSV to this file, if not empty.
+  std::string csv;
+};
+
+static void PrintUsage() {
+  std::cerr <<
+      "Usage: cpp_benchmark [--option=value...]\n"
+      "  --host=localhost  --port=2000  --map=<current map>\n"
+      "  --vehicles=50  --sensors=4  --ticks=500  --warm-up-ticks=20\n"
+      "  --delta-seconds=0.05  --sensor-type=sensor.camera.rgb\n"
+      "  --image-size-x=800  --image-size-y=600  --csv=<file>\n";
+}
+
+static Arguments ParseArguments(int argc, const char *argv[]) {
+  Arguments args;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const auto equal = arg.find('=');
+    if ((arg.compare(0u, 2u, "--") != 0) || (equal == std::string::npos)) {
+      PrintUsage();
+      throw std::invalid_argument("invalid argument " + arg);
+    }
+    const auto key = arg.substr(2u, equal - 2u);
+    const auto value = arg.substr(equal + 1u);
+    if (key == "host") {
+      args.host = value;
+    } else if (key == "port") {
+      args.port = static_cast<uint16_t>(std::stoi(value));
+    } else if (key == "map") {
+      args.map = value;
+    } else if (key == "vehicles") {
+      args.vehicles = std::stoul(value);
+    } else if (key == "sensors") {
+      args.sensors = std::stoul(value);
+    } else if (key == "ticks") {
+      args.ticks = std::stoul(value);
+    } else if (key == "warm-up-ticks") {
+      args.warm_up_ticks = std::stoul(value);
+    } else if (key == "delta-seconds") {
+      args.delta_seconds = std::stod(value);
+    } else if (key == "sensor-type") {
+      args.sensor_type = value;
+    } else if (key == "image-size-x") {
+      args.image_size_x = value;
+    } else if (key == "image-size-y") {
+      args.image_size_y = value;
+    } else if (key == "csv") {
+      args.csv = value;
+    } else {
+      PrintUsage();
+      throw std::invalid_argument("unknown argument " + arg);
+    }
+  }
+  return args;
+}
+
+// =============================================================================
+// -- Measurements -------------------------------------------------------------
+// =============================================================================
+
+/// Milliseconds elapsed from @a begin to @a end.
+static double Milliseconds(Clock::time_point begin, Clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+/// Latencies of a single tick, in milliseconds since the tick was sent.
+struct TickLatency {
+  uint64_t frame;
+  /// Until the tick RPC returned.
+  double tick_rpc;
+  /// Until the episode state of the frame was received.
+  double episode_state;
+  /// Until the data of every sensor for the frame was received.
+  double sensors;
+  /// Duration of applying the controls of all the vehicles, after the
+  /// sensors were received.
+  double control_apply;
+  /// Whole tick, including the control apply.
+  double total;
+};
+
+/// Keeps the arrival time of the sensor data of each frame, the benchmark
+/// waits until all the sensors delivered the frame it ticked.
+class SensorArrivals {
+public:
+
+  explicit SensorArrivals(size_t number_of_sensors)
+    : _number_of_sensors(number_of_sensors) {}
+
+  void Add(uint64_t frame) {
+    const auto now = Clock::now();
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto &arrival = _arrivals[frame];
+      ++arrival.count;
+      arrival.last = now;
+    }
+    _cv.notify_all();
+  }
+
+  /// Wait until all the sensors delivered @a frame, return the time the
+  /// last one arrived. Forgets the frames up to @a frame.
+  Clock::time_point WaitFor(uint64_t frame, Clock::duration timeout) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    const bool arrived = _cv.wait_for(lock, timeout, [&]() {
+      auto it = _arrivals.find(frame);
+      return (it != _arrivals.end()) && (it->second.count >= _number_of_sensors);
+    });
+    if (!arrived) {
+      throw std::runtime_error("timeout waiting for sensor data of frame " + std::to_string(frame));
+    }
+    const auto last = _arrivals[frame].last;
+    _arrivals.erase(_arrivals.begin(), _arrivals.upper_bound(frame));
+    return last;
+  }
+
+private:
+
+  struct Arrival {
+    size_t count = 0u;
+    Clock::time_point last;
+  };
+
+  const size_t _number_of_sensors;
+
+  std::mutex _mutex;
+
+  std::condition_variable _cv;
+
+  std::map<uint64_t, Arrival> _arrivals;
+};
+
+/// Print the statistics of @a values as a JSON object.
+static void PrintStats(std::ostream &out, std::vector<double> values) {
+  EXPECT_TRUE(!values.empty());
+  std::sort(values.begin(), values.end());
+  double sum = 0.0;
+  for (auto value : values) {
+    sum += value;
+  }
+  auto percentile = [&](double p) {
+    const auto index = static_cast<size_t>(p * static_cast<double>(values.size() - 1u) + 0.5);
+    return values[std::min(index, values.size() - 1u)];
+  };
+  out << "{\"mean\": " << sum / static_cast<double>(values.size())
+      << ", \"min\": " << values.front()
+      << ", \"p50\": " << percentile(0.50)
+      << ", \"p95\": " << percentile(0.95)
+      << ", \"p99\": " << percentile(0.99)
+      << ", \"max\": " << values.back() << '}';
+}
+
+static void PrintResults(
+    std::ostream &out,
+    const Arguments &args,
+    const std::string &map_name,
+    size_t vehicles,
+    const std::vector<TickLatency> &latencies,
+    double wall_seconds) {
+  auto stage = [&](const char *name, double TickLatency::*member, bool last = false) {
+    std::vector<double> values;
+    values.reserve(latencies.size());
+    for (auto &latency : latencies) {
+      values.emplace_back(latency.*member);
+    }
+    out << "    \"" << name << "\": ";
+    PrintStats(out, std::move(values));
+    out << (last ? "\n" : ",\n");
+  };
+  out << "{\n"
+      << "  \"map\": \"" << map_name << "\",\n"
+      << "  \"vehicles\": " << vehicles << ",\n"
+      << "  \"sensors\": " << args.sensors << ",\n"
+      << "  \"sensor_type\": \"" << args.sensor_type << "\",\n"
+      << "  \"ticks\": " << latencies.size() << ",\n"
+      << "  \"delta_seconds\": " << args.delta_seconds << ",\n"
+      << "  \"ticks_per_second\": " << static_cast<double>(latencies.size()) / wall_seconds << ",\n"
+      << "  \"latency_ms\": {\n";
+  stage("tick_rpc", &TickLatency::tick_rpc);
+  stage("episode_state", &TickLatency::episode_state);
+  stage("sensors", &TickLatency::sensors);
+  stage("control_apply", &TickLatency::control_apply);
+  stage("total", &TickLatency::total, true);
+  out << "  }\n}" << std::endl;
+}
+
+// =============================================================================
+// -- Benchmark ----------------------------------------------------------------
+// =============================================================================
+
+/// Restores the settings of the world and destroys the actors spawned, also
+/// when the benchmark fails.
+class Cleanup {
+public:
+
+  Cleanup(cc::Client &client, cc::World &world)
+    : _client(client),
+      _world(world),
+      _settings(world.GetSettings()) {}
+
+  ~Cleanup() {
+    try {
+      for (auto &sensor : sensors) {
+        sensor->Stop();
+      }
+      std::vector<cr::Command> commands;
+      for (auto &sensor : sensors) {
+        commands.emplace_back(cr::Command::DestroyActor{sensor->GetId()});
+      }
+      for (auto &vehicle : vehicles) {
+        commands.emplace_back(cr::Command::DestroyActor{vehicle->GetId()});
+      }
+      _client.ApplyBatchSync(std::move(commands), false);
+      _world.ApplySettings(_settings);
+    } catch (const std::exception &e) {
+      std::cerr << "Cleanup failed: " << e.what() << std::endl;
+    }
+  }
+
+  std::vector<carla::SharedPtr<cc::Vehicle>> vehicles;
+
+  std::vector<carla::SharedPtr<cc::Sensor>> sensors;
+
+private:
+
+  cc::Client &_client;
+
+  cc::World &_world;
+
+  const cr::EpisodeSettings _settings;
+};
+
+int main(int argc, const char *argv[]) {
+  try {
+
+    const auto args = ParseArguments(argc, argv);
+    EXPECT_TRUE(args.ticks > 0u);
+
+    std::mt19937_64 rng(42u);
+
+    auto client = cc::Client(args.host, args.port);
+    const carla::time_duration timeout = 30s;
+    client.SetTimeout(timeout);
+
+    auto world = args.map.empty() ? client.GetWorld() : client.LoadWorld(args.map);
+    const auto map = world.GetMap();
+    std::cerr << "Running on " << map->GetName() << std::endl;
+
+    // Declared before the cleanup, the sensors may call it until stopped.
+    SensorArrivals arrivals(args.sensors);
+
+    Cleanup cleanup(client, world);
+
+    auto settings = world.GetSettings();
+    settings.synchronous_mode = true;
+    settings.fixed_delta_seconds = args.delta_seconds;
+    world.ApplySettings(settings);
+
+    // Spawn the vehicles, as many as spawn points are free.
+    auto blueprint_library = world.GetBlueprintLibrary();
+    auto vehicle_blueprints = blueprint_library->Filter("vehicle.*");
+    EXPECT_TRUE(!vehicle_blueprints->empty());
+    auto spawn_points = map->GetRecommendedSpawnPoints();
+    std::shuffle(spawn_points.begin(), spawn_points.end(), rng);
+    for (size_t i = 0u; (i < spawn_points.size()) && (cleanup.vehicles.size() < args.vehicles); ++i) {
+      auto &blueprint = vehicle_blueprints->at(i % vehicle_blueprints->size());
+      auto actor = world.TrySpawnActor(blueprint, spawn_points[i]);
+      if (actor != nullptr) {
+        cleanup.vehicles.emplace_back(boost::static_pointer_cast<cc::Vehicle>(actor));
+      }
+    }
+    EXPECT_TRUE(!cleanup.vehicles.empty() || (args.sensors == 0u));
+    if (cleanup.vehicles.size() < args.vehicles) {
+      std::cerr << "Only " << cleanup.vehicles.size() << " vehicles could be spawned" << std::endl;
+    }
+
+    // Spawn the sensors attached to the vehicles, round-robin.
+    auto sensor_blueprint = *blueprint_library->Find(args.sensor_type);
+    if (sensor_blueprint.ContainsAttribute("image_size_x")) {
+      sensor_blueprint.SetAttribute("image_size_x", args.image_size_x);
+      sensor_blueprint.SetAttribute("image_size_y", args.image_size_y);
+    }
+    if (sensor_blueprint.ContainsAttribute("sensor_tick")) {
+      sensor_blueprint.SetAttribute("sensor_tick", "0.0");
+    }
+    const auto sensor_transform = cg::Transform{
+        cg::Location{-5.5f, 0.0f, 2.8f},
+        cg::Rotation{-15.0f, 0.0f, 0.0f}};
+    for (size_t i = 0u; i < args.sensors; ++i) {
+      auto &parent = cleanup.vehicles[i % cleanup.vehicles.size()];
+      auto actor = world.SpawnActor(sensor_blueprint, sensor_transform, parent.get());
+      auto sensor = boost::static_pointer_cast<cc::Sensor>(actor);
+      cleanup.sensors.emplace_back(sensor);
+      sensor->Listen([&arrivals](auto data) { arrivals.Add(data->GetFrame()); });
+    }
+
+    std::ofstream csv;
+    if (!args.csv.empty()) {
+      csv.open(args.csv);
+      EXPECT_TRUE(csv.is_open());
+      csv << "frame,tick_rpc,episode_state,sensors,control_apply,total\n";
+    }
+
+    std::uniform_real_distribution<float> steer(-0.2f, 0.2f);
+    std::vector<TickLatency> latencies;
+    latencies.reserve(args.ticks);
+    Clock::time_point first_measured_tick;
+
+    for (size_t i = 0u; i < args.warm_up_ticks + args.ticks; ++i) {
+      if (i == args.warm_up_ticks) {
+        first_measured_tick = Clock::now();
+      }
+      const auto begin = Clock::now();
+      const auto frame = world.TickAsync(1u);
+      const auto tick_returned = Clock::now();
+      world.WaitForFrame(frame, timeout);
+      const auto state_received = Clock::now();
+      const auto sensors_received = (args.sensors > 0u) ?
+          arrivals.WaitFor(frame, timeout.to_chrono()) :
+          state_received;
+
+      const auto controls_begin = Clock::now();
+      std::vector<cr::Command> commands;
+      commands.reserve(cleanup.vehicles.size());
+      for (auto &vehicle : cleanup.vehicles) {
+        cr::VehicleControl control;
+        control.throttle = 0.5f;
+        control.steer = steer(rng);
+        commands.emplace_back(cr::Command::ApplyVehicleControl{vehicle->GetId(), control});
+      }
+      client.ApplyBatchSync(std::move(commands), false);
+      const auto end = Clock::now();
+
+      if (i < args.warm_up_ticks) {
+        continue;
+      }
+      latencies.push_back(TickLatency{
+          frame,
+          Milliseconds(begin, tick_returned),
+          Milliseconds(begin, state_received),
+          Milliseconds(begin, sensors_received),
+          Milliseconds(controls_begin, end),
+          Milliseconds(begin, end)});
+      if (csv.is_open()) {
+        const auto &l = latencies.back();
+        csv << l.frame << ',' << l.tick_rpc << ',' << l.episode_state << ','
+            << l.sensors << ',' << l.control_apply << ',' << l.total << '\n';
+      }
+    }
+
+    const auto wall_seconds = std::chrono::duration<double>(Clock::now() - first_measured_tick).count();
+    PrintResults(std::cout, args, map->GetName(), cleanup.vehicles.size(), latencies, wall_seconds);
+
+  } catch (const cc::TimeoutException &e) {
+    std::cerr << '\n' << e.what() << std::endl;
+    return 1;
+  } catch (const std::exception &e) {
+    std::cerr << "\nException: " << e.what() << std::endl;
+    return 2;
+  }
+}
@@ -0,0 +1,170 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Logging.h"
+#include "carla/NonCopyable.h"
+#include "carla/ThreadGroup.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+
+namespace carla {
+
+  /// Counters of an AsyncWriter.
+  struct AsyncWriterStats {
+    /// Writes waiting in the queue.
+    size_t queued = 0u;
+
+    /// Most writes that were waiting in the queue at once.
+    size_t max_queued = 0u;
+
+    /// Maximum number of writes waiting in the queue.
+    size_t capacity = 0u;
+
+    size_t written = 0u;
+
+    /// Writes that threw an exception.
+    size_t failed = 0u;
+
+    /// Pushes that had to wait for room in the queue.
+    size_t blocked = 0u;
+
+    /// Total time pushes spent waiting for room in the queue.
+    double total_blocked_seconds = 0.0;
+  };
+
+  /// Writes files in a pool of worker threads, so the thread producing the
+  /// data does not wait for encoding or the disk.
+  ///
+  /// The queue is bounded: once @a capacity writes are waiting, Push blocks
+  /// until a worker picks one up. The time spent there is counted in the
+  /// stats, a sign that the disk does not keep up.
+  class AsyncWriter : private NonCopyable {
+  public:
+
+    /// Writes the file and returns its final path.
+    using WriteFunction = std::function<std::string()>;
+
+    static constexpr size_t DEFAULT_CAPACITY = 64u;
+
+    explicit AsyncWriter(size_t worker_threads, size_t capacity = DEFAULT_CAPACITY)
+      : _capacity(std::max<size_t>(capacity, 1u)) {
+      _workers.CreateThreads(std::max<size_t>(worker_threads, 1u), [this]() { Run(); });
+    }
+
+    /// Finishes the writes still in the queue and joins the workers.
+    ~AsyncWriter() {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+      }
+      _not_empty.notify_all();
+      _workers.JoinAll();
+    }
+
+    /// Queue @a write, blocking while the queue is full. The future holds the
+    /// path written or the exception thrown by @a write.
+    std::shared_future<std::string> Push(WriteFunction write) {
+      Task task{std::move(write), {}};
+      auto future = task.promise.get_future().share();
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_queue.size() >= _capacity) {
+          const auto start = std::chrono::steady_clock::now();
+          _not_full.wait(lock, [this]() { return _queue.size() < _capacity; });
+          ++_stats.blocked;
+          _stats.total_blocked_seconds += std::chrono::duration<double>(
+              std::chrono::steady_clock::now() - start).count();
+        }
+        _queue.emplace_back(std::move(task));
+        _stats.max_queued = std::max(_stats.max_queued, _queue.size());
+      }
+      _not_empty.notify_one();
+      return future;
+    }
+
+    /// Block until every write pushed so far finished.
+    void Wait() {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _idle.wait(lock, [this]() { return _queue.empty() && (_busy == 0u); });
+    }
+
+    AsyncWriterStats GetStats() const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto stats = _stats;
+      stats.queued = _queue.size();
+      stats.capacity = _capacity;
+      return stats;
+    }
+
+  private:
+
+    struct Task {
+      WriteFunction write;
+
+      std::promise<std::string> promise;
+    };
+
+    void Run() {
+      std::unique_lock<std::mutex> lock(_mutex);
+      for (;;) {
+        _not_empty.wait(lock, [this]() { return _stop || !_queue.empty(); });
+        if (_queue.empty()) {
+          return;
+        }
+        auto task = std::move(_queue.front());
+        _queue.pop_front();
+        ++_busy;
+        lock.unlock();
+        _not_full.notify_one();
+        bool failed = false;
+        try {
+          task.promise.set_value(task.write());
+        } catch (const std::exception &e) {
+          log_error("failed to write file:", e.what());
+          task.promise.set_exception(std::current_exception());
+          failed = true;
+        }
+        lock.lock();
+        --_busy;
+        ++(failed ? _stats.failed : _stats.written);
+        if (_queue.empty() && (_busy == 0u)) {
+          _idle.notify_all();
+        }
+      }
+    }
+
+    const size_t _capacity;
+
+    mutable std::mutex _mutex;
+
+    std::condition_variable _not_empty;
+
+    std::condition_variable _not_full;
+
+    std::condition_variable _idle;
+
+    std::deque<Task> _queue;
+
+    size_t _busy = 0u;
+
+    bool _stop = false;
+
+    AsyncWriterStats _stats;
+
+    ThreadGroup _workers;
+  };
+
+} // namespace carla
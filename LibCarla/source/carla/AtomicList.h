@@ -9,6 +9,7 @@
 #include "carla/AtomicSharedPtr.h"
 #include "carla/NonCopyable.h"
 
+#include <algorithm>
 #include <mutex>
 #include <vector>
 
@@ -2,8 +2,98 @@
 
 #include "carla/BufferPool.h"
 
+#ifdef __linux__
+#  include <sys/mman.h>
+#endif // __linux__
+
 namespace carla {
 
+namespace detail {
+
+  enum BufferMemoryKind : uint8_t {
+    HEAP,
+    MAPPED,
+    LOCKED
+  };
+
+  void BufferDeleter::operator()(unsigned char *data) const noexcept {
+    MemoryAccounting::Remove(tag, size);
+    switch (kind) {
+#ifdef __linux__
+      case LOCKED:
+        ::munlock(data, size);
+        ::munmap(data, size);
+        break;
+      case MAPPED:
+        ::munmap(data, size);
+        break;
+#endif // __linux__
+      default:
+        delete[] data;
+        break;
+    }
+  }
+
+#ifdef __linux__
+
+  static constexpr size_t HUGE_PAGE_SIZE = 2u * 1024u * 1024u;
+
+  static unsigned char *Map(size_t size, int flags) {
+    void *data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+    return data == MAP_FAILED ? nullptr : static_cast<unsigned char *>(data);
+  }
+
+  static unsigned char *MapHugePages(size_t size) {
+    if ((size % HUGE_PAGE_SIZE) == 0u) {
+      // Explicit huge pages, only available if the system reserved them.
+      if (auto *data = Map(size, MAP_HUGETLB)) {
+        return data;
+      }
+    }
+    // Otherwise ask for transparent huge pages.
+    auto *data = Map(size, 0);
+    if (data != nullptr) {
+      ::madvise(data, size, MADV_HUGEPAGE);
+    }
+    return data;
+  }
+
+#endif // __linux__
+
+} // namespace detail
+
+  Buffer::pointer_type Buffer::Allocate(
+      const size_type size,
+      const BufferAllocation allocation,
+      const MemoryTag tag) {
+    if (size == 0u) {
+      return nullptr;
+    }
+    const auto make_pointer = [size, tag](value_type *data, uint8_t kind) {
+      MemoryAccounting::Add(tag, size);
+      return pointer_type(data, {size, kind, tag});
+    };
+#ifdef __linux__
+    if ((allocation == BufferAllocation::HugePages) && (size >= detail::HUGE_PAGE_SIZE)) {
+      if (auto *data = detail::MapHugePages(size)) {
+        return make_pointer(data, detail::MAPPED);
+      }
+    } else if (allocation == BufferAllocation::Pinned) {
+      if (auto *data = detail::Map(size, 0)) {
+        if (::mlock(data, size) == 0) {
+          return make_pointer(data, detail::LOCKED);
+        }
+        log_debug("unable to lock buffer of", size, "bytes, falling back to unlocked memory");
+        return make_pointer(data, detail::MAPPED);
+      }
+    }
+#else
+    (void)allocation;
+#endif // __linux__
+    // Without the parentheses the memory is not value-initialized.
+    return make_pointer(new value_type[size], detail::HEAP);
+  }
+
   void Buffer::ReuseThisBuffer() {
     auto pool = _parent_pool.lock();
     if (pool != nullptr) {
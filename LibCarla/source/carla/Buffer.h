@@ -9,6 +9,7 @@
 #include "carla/Debug.h"
 #include "carla/Exception.h"
 #include "carla/Logging.h"
+#include "carla/MemoryAccounting.h"
 
 #include <boost/asio/buffer.hpp>
 
@@ -25,12 +26,49 @@ namespace carla {
 
   class BufferPool;
 
+  /// How the memory of a Buffer is allocated.
+  enum class BufferAllocation : uint8_t {
+    /// Uninitialized memory from the heap.
+    Default,
+
+    /// Blocks of at least 2 MiB are backed by huge pages where the OS
+    /// supports it, this way there are fewer page faults and TLB misses when
+    /// filling them. Smaller blocks come from the heap.
+    HugePages,
+
+    /// Page-aligned memory locked into RAM, so it is never swapped out and
+    /// can be registered by a DMA capable transport (GPU-direct, RDMA). Falls
+    /// back to unlocked memory if the lock limit of the process is reached.
+    Pinned
+  };
+
+  namespace detail {
+
+    /// Deleter of the memory of a Buffer, remembers how it was allocated and
+    /// the MemoryTag it is accounted under.
+    struct BufferDeleter {
+      uint32_t size = 0u;
+
+      uint8_t kind = 0u;
+
+      MemoryTag tag = MemoryTag::Buffer;
+
+      void operator()(unsigned char *data) const noexcept;
+    };
+
+  } // namespace detail
+
   /// A piece of raw data.
   ///
   /// Note that if more capacity is needed, a new memory block is allocated and
   /// the old one is deleted. This means that by default the buffer can only
   /// grow. To release the memory use `clear` or `pop`.
   ///
+  /// The memory is not initialized, and it is allocated according to the
+  /// BufferAllocation of the buffer, see set_allocation. The allocated bytes
+  /// are accounted by MemoryAccounting under the tag of the buffer, see
+  /// set_memory_tag.
+  ///
   /// This is a move-only type, meant to be cheap to pass by value. If the
   /// buffer is retrieved from a BufferPool, the memory is automatically pushed
   /// back to the pool on destruction.
@@ -53,6 +91,9 @@ namespace carla {
 
     using const_iterator = const value_type *;
 
+    /// Owner of the memory of a buffer.
+    using pointer_type = std::unique_ptr<value_type[], detail::BufferDeleter>;
+
     /// @}
     // =========================================================================
     /// @name Construction and destruction
@@ -68,7 +109,7 @@ namespace carla {
     explicit Buffer(size_type size)
       : _size(size),
         _capacity(size),
-        _data(std::make_unique<value_type[]>(size)) {}
+        _data(Allocate(size, _allocation, _memory_tag)) {}
 
     /// @copydoc Buffer(size_type)
     explicit Buffer(uint64_t size)
@@ -104,6 +145,8 @@ namespace carla {
       : _parent_pool(std::move(rhs._parent_pool)),
         _size(rhs._size),
         _capacity(rhs._capacity),
+        _allocation(rhs._allocation),
+        _memory_tag(rhs._memory_tag),
         _data(rhs.pop()) {}
 
     ~Buffer() {
@@ -126,6 +169,8 @@ namespace carla {
       _parent_pool = std::move(rhs._parent_pool);
       _size = rhs._size;
       _capacity = rhs._capacity;
+      _allocation = rhs._allocation;
+      _memory_tag = rhs._memory_tag;
       _data = rhs.pop();
       return *this;
     }
@@ -249,7 +294,7 @@ namespace carla {
     void reset(size_type size) {
       if (_capacity < size) {
         log_debug("allocating buffer of", size, "bytes");
-        _data = std::make_unique<value_type[]>(size);
+        _data = Allocate(size, _allocation, _memory_tag);
         _capacity = size;
       }
       _size = size;
@@ -265,7 +310,7 @@ namespace carla {
 
     /// Release the contents of this buffer and set its size and capacity to
     /// zero.
-    std::unique_ptr<value_type[]> pop() noexcept {
+    pointer_type pop() noexcept {
       _size = 0u;
       _capacity = 0u;
       return std::move(_data);
@@ -277,6 +322,31 @@ namespace carla {
       pop();
     }
 
+    /// How the memory of this buffer is allocated from now on. Memory already
+    /// allocated is kept as it is until it needs to grow.
+    void set_allocation(BufferAllocation allocation) noexcept {
+      _allocation = allocation;
+    }
+
+    BufferAllocation allocation() const noexcept {
+      return _allocation;
+    }
+
+    /// Account the memory of this buffer, the one already allocated too,
+    /// under @a tag.
+    void set_memory_tag(MemoryTag tag) noexcept {
+      if (_data != nullptr) {
+        auto &deleter = _data.get_deleter();
+        MemoryAccounting::Move(deleter.tag, tag, deleter.size);
+        deleter.tag = tag;
+      }
+      _memory_tag = tag;
+    }
+
+    MemoryTag memory_tag() const noexcept {
+      return _memory_tag;
+    }
+
     /// @}
     // =========================================================================
     /// @name copy_from
@@ -345,6 +415,8 @@ namespace carla {
 
     void ReuseThisBuffer();
 
+    static pointer_type Allocate(size_type size, BufferAllocation allocation, MemoryTag tag);
+
     friend class BufferPool;
 
     std::weak_ptr<BufferPool> _parent_pool;
@@ -353,7 +425,11 @@ namespace carla {
 
     size_type _capacity = 0u;
 
-    std::unique_ptr<value_type[]> _data = nullptr;
+    BufferAllocation _allocation = BufferAllocation::Default;
+
+    MemoryTag _memory_tag = MemoryTag::Buffer;
+
+    pointer_type _data = nullptr;
   };
 
 } // namespace carla
@@ -7,6 +7,8 @@
 #pragma once
 
 #include "carla/Buffer.h"
+#include "carla/Debug.h"
+#include "carla/Time.h"
 
 #if defined(__clang__)
 #  pragma clang diagnostic push
@@ -17,44 +19,290 @@
 #  pragma clang diagnostic pop
 #endif
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <memory>
 
 namespace carla {
 
+  /// Counters of a BufferPool.
+  struct BufferPoolStats {
+    /// Pops served with a buffer from the pool.
+    size_t hits = 0u;
+
+    /// Pops that had to allocate a new buffer.
+    size_t misses = 0u;
+
+    /// Buffers deleted on return because the pool was full.
+    size_t discarded = 0u;
+
+    /// Buffers deleted because their size class went idle.
+    size_t trimmed = 0u;
+
+    /// Buffers currently held by the pool.
+    size_t buffers = 0u;
+
+    /// Capacity of the buffers currently held by the pool.
+    size_t bytes = 0u;
+  };
+
   /// A pool of Buffer. Buffers popped from this pool automatically return to
   /// the pool on destruction so the allocated memory can be reused.
   ///
-  /// @warning Buffers adjust their size only by growing, they never shrink
-  /// unless explicitly cleared. The allocated memory is only deleted when this
-  /// pool is destroyed.
+  /// Returned buffers are sorted by capacity into power-of-two size classes,
+  /// this way Pop(size) hands out a buffer that can hold @a size bytes without
+  /// reallocating. Each class keeps at most a given number of buffers, and
+  /// the whole pool at most a given number of bytes; buffers returned to a
+  /// full pool are deleted.
+  ///
+  /// The buffers of a size class nobody popped from for a while are deleted
+  /// by the next Pop, so the memory of a sensor that stopped sending is not
+  /// kept forever.
   class BufferPool : public std::enable_shared_from_this<BufferPool> {
   public:
 
-    BufferPool() = default;
+    /// Default maximum number of buffers kept per size class.
+    static constexpr size_t DEFAULT_MAX_BUFFERS_PER_CLASS = 32u;
 
-    explicit BufferPool(size_t estimated_size) : _queue(estimated_size) {}
+    /// Default maximum capacity in bytes of the buffers kept by the pool.
+    static constexpr size_t DEFAULT_MAX_BYTES = 256u * 1024u * 1024u;
+
+    /// Default time after which the buffers of an unused size class are
+    /// deleted.
+    static time_duration DefaultIdleTime() {
+      return time_duration::seconds(10u);
+    }
+
+    BufferPool() : BufferPool(DEFAULT_MAX_BUFFERS_PER_CLASS) {}
+
+    explicit BufferPool(
+        size_t max_buffers_per_class,
+        size_t max_bytes = DEFAULT_MAX_BYTES,
+        time_duration idle_time = DefaultIdleTime())
+      : _max_buffers_per_class(max_buffers_per_class),
+        _max_bytes(max_bytes),
+        _idle_time(std::chrono::duration_cast<clock::duration>(idle_time.to_chrono()).count()) {
+      const auto now = Now();
+      for (auto &size_class : _classes) {
+        size_class.last_pop = now;
+      }
+      _next_trim = now + _idle_time;
+    }
 
     /// Pop a Buffer from the queue, creates a new one if the queue is empty.
+    /// The biggest buffers available are handed out first.
     Buffer Pop() {
       Buffer item;
-      _queue.try_dequeue(item); // we don't care if it fails.
+      bool found = false;
+      for (auto i = NUMBER_OF_CLASSES; (i > 0u) && !found; --i) {
+        found = TryPop(i - 1u, item);
+      }
+      ++(found ? _hits : _misses);
+      TrimIdleClasses();
+      return Adopt(std::move(item));
+    }
+
+    /// Pop a Buffer of @a size bytes from the size class of @a size. If none
+    /// is available a new one is created with the whole capacity of its size
+    /// class, so it can be reused for any size in the class.
+    Buffer Pop(Buffer::size_type size) {
+      const auto size_class = GetSizeClassOf(size);
+      Buffer item;
+      if (TryPop(size_class, item)) {
+        ++_hits;
+      } else {
+        ++_misses;
+        item.set_allocation(_allocation.load(std::memory_order_relaxed));
+        item.reset(GetCapacityOfClass(size_class));
+      }
+      item.reset(size);
+      TrimIdleClasses();
+      return Adopt(std::move(item));
+    }
+
+    /// How the memory of the buffers handed out by this pool is allocated,
+    /// buffers already in the pool keep their memory.
+    void SetAllocation(BufferAllocation allocation) {
+      _allocation = allocation;
+    }
+
+    /// Number of buffers currently held by the pool.
+    size_t GetNumberOfBuffers() const {
+      size_t total = 0u;
+      for (auto &size_class : _classes) {
+        total += size_class.count.load(std::memory_order_relaxed);
+      }
+      return total;
+    }
+
+    BufferPoolStats GetStats() const {
+      BufferPoolStats stats;
+      stats.hits = _hits;
+      stats.misses = _misses;
+      stats.discarded = _discarded;
+      stats.trimmed = _trimmed;
+      stats.buffers = GetNumberOfBuffers();
+      stats.bytes = _bytes;
+      return stats;
+    }
+
+    /// Delete every buffer held by the pool, buffers in use return to it as
+    /// usual.
+    void Trim() {
+      for (auto i = 0u; i < NUMBER_OF_CLASSES; ++i) {
+        TrimClass(i);
+      }
+    }
+
+  private:
+
+    friend class Buffer;
+
+    using clock = std::chrono::steady_clock;
+
+    static constexpr size_t NUMBER_OF_CLASSES = 8u * sizeof(Buffer::size_type) + 1u;
+
+    static clock::rep Now() {
+      return clock::now().time_since_epoch().count();
+    }
+
+    /// Smallest class whose capacity fits @a size, i.e. ceil(log2(size)).
+    static size_t GetSizeClassOf(Buffer::size_type size) {
+      size_t size_class = 0u;
+      while ((size_class < (NUMBER_OF_CLASSES - 1u)) &&
+             ((uint64_t(1u) << size_class) < size)) {
+        ++size_class;
+      }
+      return size_class;
+    }
+
+    /// Biggest class that fits in @a capacity, i.e. floor(log2(capacity)).
+    static size_t GetClassOfCapacity(Buffer::size_type capacity) {
+      DEBUG_ASSERT(capacity > 0u);
+      size_t size_class = 0u;
+      while ((capacity >>= 1u) != 0u) {
+        ++size_class;
+      }
+      return size_class;
+    }
+
+    static Buffer::size_type GetCapacityOfClass(size_t size_class) {
+      const auto capacity = uint64_t(1u) << size_class;
+      return capacity > Buffer::max_size() ?
+          Buffer::max_size() :
+          static_cast<Buffer::size_type>(capacity);
+    }
+
+    bool TryPop(size_t size_class, Buffer &item) {
+      auto &bucket = _classes[size_class];
+      bucket.last_pop.store(Now(), std::memory_order_relaxed);
+      return TryDequeue(size_class, item);
+    }
+
+    bool TryDequeue(size_t size_class, Buffer &item) {
+      auto &bucket = _classes[size_class];
+      if ((bucket.count.load(std::memory_order_relaxed) > 0u) &&
+          bucket.queue.try_dequeue(item)) {
+        bucket.count.fetch_sub(1u, std::memory_order_relaxed);
+        _bytes.fetch_sub(item.capacity(), std::memory_order_relaxed);
+        item.set_memory_tag(MemoryTag::Buffer);
+        return true;
+      }
+      return false;
+    }
+
+    /// Delete the buffers of @a size_class, without returning them to the
+    /// pool.
+    void TrimClass(size_t size_class) {
+      Buffer item;
+      while (TryDequeue(size_class, item)) {
+        // Without capacity the buffer is not returned on destruction.
+        item.clear();
+        ++_trimmed;
+      }
+    }
+
+    /// Trim the classes nobody popped from in the idle time, checked at most
+    /// once per idle time.
+    void TrimIdleClasses() {
+      const auto now = Now();
+      auto next_trim = _next_trim.load(std::memory_order_relaxed);
+      if ((now < next_trim) ||
+          !_next_trim.compare_exchange_strong(next_trim, now + _idle_time)) {
+        return;
+      }
+      for (auto i = 0u; i < NUMBER_OF_CLASSES; ++i) {
+        auto &bucket = _classes[i];
+        if ((bucket.count.load(std::memory_order_relaxed) > 0u) &&
+            ((now - bucket.last_pop.load(std::memory_order_relaxed)) > _idle_time)) {
+          TrimClass(i);
+        }
+      }
+    }
+
+    Buffer Adopt(Buffer &&item) {
+      item.set_allocation(_allocation.load(std::memory_order_relaxed));
 #if __cplusplus >= 201703L // C++17
       item._parent_pool = weak_from_this();
 #else
       item._parent_pool = shared_from_this();
 #endif
-      return item;
+      return std::move(item);
     }
 
-  private:
-
-    friend class Buffer;
-
     void Push(Buffer &&buffer) {
-      _queue.enqueue(std::move(buffer));
+      const auto capacity = buffer.capacity();
+      auto &bucket = _classes[GetClassOfCapacity(capacity)];
+      if (bucket.count.fetch_add(1u, std::memory_order_relaxed) >= _max_buffers_per_class) {
+        // Above the high-water mark, let the buffer delete its memory.
+        bucket.count.fetch_sub(1u, std::memory_order_relaxed);
+        ++_discarded;
+        return;
+      }
+      if (_bytes.fetch_add(capacity, std::memory_order_relaxed) + capacity > _max_bytes) {
+        bucket.count.fetch_sub(1u, std::memory_order_relaxed);
+        _bytes.fetch_sub(capacity, std::memory_order_relaxed);
+        ++_discarded;
+        return;
+      }
+      // Accounted as pool memory while idle.
+      buffer.set_memory_tag(MemoryTag::BufferPool);
+      bucket.queue.enqueue(std::move(buffer));
     }
 
-    moodycamel::ConcurrentQueue<Buffer> _queue;
+    struct SizeClass {
+      /// Most classes stay unused, don't preallocate any storage.
+      moodycamel::ConcurrentQueue<Buffer> queue{0u};
+
+      /// Approximate number of buffers in the queue.
+      std::atomic_size_t count{0u};
+
+      /// Last time a buffer of this class was requested.
+      std::atomic<clock::rep> last_pop{0};
+    };
+
+    const size_t _max_buffers_per_class;
+
+    const size_t _max_bytes;
+
+    const clock::rep _idle_time;
+
+    std::array<SizeClass, NUMBER_OF_CLASSES> _classes;
+
+    std::atomic<clock::rep> _next_trim{0};
+
+    std::atomic<BufferAllocation> _allocation{BufferAllocation::Default};
+
+    std::atomic_size_t _bytes{0u};
+
+    std::atomic_size_t _hits{0u};
+
+    std::atomic_size_t _misses{0u};
+
+    std::atomic_size_t _discarded{0u};
+
+    std::atomic_size_t _trimmed{0u};
   };
 
 } // namespace carla
@@ -0,0 +1,178 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/Logging.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace carla {
+namespace logging {
+
+  /// Messages queued above this are dropped, a stuck console does not eat
+  /// the memory.
+  static constexpr size_t MAX_QUEUED_MESSAGES = 16384u;
+
+  static std::atomic_bool ASYNCHRONOUS{true};
+
+  /// Set once the logger is destroyed at exit, later messages are written
+  /// right away.
+  static std::atomic_bool LOGGER_STOPPED{false};
+
+  /// Lock-free stack of messages pushed by any thread, the only consumer
+  /// takes it whole and writes it in the order pushed.
+  class AsyncLogger {
+  public:
+
+    AsyncLogger() : _thread([this]() { Run(); }) {}
+
+    ~AsyncLogger() {
+      {
+        std::lock_guard<std::mutex> lock(_wake_mutex);
+        _stop = true;
+      }
+      _wake_up.notify_one();
+      _thread.join();
+      Drain();
+      LOGGER_STOPPED = true;
+    }
+
+    void Push(std::ostream &out, std::string text) {
+      if (_queued.fetch_add(1u, std::memory_order_relaxed) >= MAX_QUEUED_MESSAGES) {
+        _queued.fetch_sub(1u, std::memory_order_relaxed);
+        _dropped.fetch_add(1u, std::memory_order_relaxed);
+        return;
+      }
+      auto *message = new Message{nullptr, &out, std::move(text)};
+      // The message belongs to the consumer once pushed, only its copy of
+      // the previous head is read after.
+      Message *head = _head.load(std::memory_order_relaxed);
+      do {
+        message->next = head;
+      } while (!_head.compare_exchange_weak(
+          head,
+          message,
+          std::memory_order_release,
+          std::memory_order_relaxed));
+      // Only the first message of a batch wakes the thread up, if missed it
+      // wakes up on its own shortly after.
+      if (head == nullptr) {
+        _wake_up.notify_one();
+      }
+    }
+
+    /// Write the messages queued, then @a text right away.
+    void Write(std::ostream &out, const std::string &text) {
+      std::lock_guard<std::mutex> lock(_write_mutex);
+      DrainLocked();
+      out << text << std::flush;
+    }
+
+    void Drain() {
+      std::lock_guard<std::mutex> lock(_write_mutex);
+      DrainLocked();
+    }
+
+  private:
+
+    struct Message {
+      Message *next;
+      std::ostream *out;
+      std::string text;
+    };
+
+    void Run() {
+      for (;;) {
+        Drain();
+        std::unique_lock<std::mutex> lock(_wake_mutex);
+        if (_stop) {
+          return;
+        }
+        _wake_up.wait_for(lock, std::chrono::milliseconds(50), [this]() {
+          return _stop || (_head.load(std::memory_order_relaxed) != nullptr);
+        });
+      }
+    }
+
+    void DrainLocked() {
+      Message *message = _head.exchange(nullptr, std::memory_order_acquire);
+      // Pushed newest first.
+      Message *reversed = nullptr;
+      size_t count = 0u;
+      while (message != nullptr) {
+        Message *next = message->next;
+        message->next = reversed;
+        reversed = message;
+        message = next;
+        ++count;
+      }
+      const size_t dropped = _dropped.exchange(0u, std::memory_order_relaxed);
+      if (dropped > 0u) {
+        std::cerr << "WARNING: logging queue full, " << dropped << " messages dropped\n";
+      }
+      if (count == 0u) {
+        return;
+      }
+      while (reversed != nullptr) {
+        Message *next = reversed->next;
+        *reversed->out << reversed->text;
+        delete reversed;
+        reversed = next;
+      }
+      _queued.fetch_sub(count, std::memory_order_relaxed);
+      std::cout << std::flush;
+      std::cerr << std::flush;
+    }
+
+    std::atomic<Message *> _head{nullptr};
+
+    std::atomic<size_t> _queued{0u};
+
+    std::atomic<size_t> _dropped{0u};
+
+    /// Held by whoever writes to the streams.
+    std::mutex _write_mutex;
+
+    std::mutex _wake_mutex;
+
+    std::condition_variable _wake_up;
+
+    bool _stop = false;
+
+    std::thread _thread;
+  };
+
+  static AsyncLogger &GetLogger() {
+    static AsyncLogger logger;
+    return logger;
+  }
+
+  void write_async(std::ostream &out, std::string message) {
+    if (LOGGER_STOPPED) {
+      out << message << std::flush;
+    } else if (ASYNCHRONOUS) {
+      GetLogger().Push(out, std::move(message));
+    } else {
+      GetLogger().Write(out, message);
+    }
+  }
+
+  void flush() {
+    if (!LOGGER_STOPPED) {
+      GetLogger().Drain();
+    }
+  }
+
+  void set_asynchronous(const bool enable) {
+    ASYNCHRONOUS = enable;
+    if (!enable) {
+      flush();
+    }
+  }
+
+} // namespace logging
+} // namespace carla
@@ -35,12 +35,31 @@
 //
 //  * LOG_DEBUG_ONLY(/* code here */)
 //  * LOG_INFO_ONLY(/* code here */)
+//
+// And the rate-limited versions of the log functions, writing at most one
+// message every given seconds per call site, for the ones in hot paths
+//
+//  * LOG_DEBUG_EVERY(seconds, /* message */)
+//  * LOG_INFO_EVERY(seconds, /* message */)
+//  * LOG_WARNING_EVERY(seconds, /* message */)
+//  * LOG_ERROR_EVERY(seconds, /* message */)
+//
+// The messages are formatted on the calling thread and written by a
+// background thread, see logging::set_asynchronous. The arguments of a
+// disabled log function are still evaluated, the ones of a disabled macro
+// are not.
 
 // =============================================================================
 // -- Implementation of log functions ------------------------------------------
 // =============================================================================
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
 
 namespace carla {
 
@@ -55,18 +74,72 @@ namespace logging {
     (void) expander{0, (void(out << ' ' << std::forward<Args>(args)), 0) ...};
   }
 
+  /// Queue @a message to be written to @a out by the logging thread. If the
+  /// queue is full the message is dropped, and the number of messages dropped
+  /// reported with the next ones written.
+  void write_async(std::ostream &out, std::string message);
+
+  /// Block until every message queued is written.
+  void flush();
+
+  /// Whether the messages are written by the logging thread, the default,
+  /// or right away on the calling thread.
+  void set_asynchronous(bool enable);
+
+  template <typename ... Args>
+  LIBCARLA_NOINLINE
+  static void write_message(std::ostream &out, Args && ... args) {
+    std::ostringstream message;
+    logging::write_to_stream(message, std::forward<Args>(args) ...);
+    logging::write_async(out, message.str());
+  }
+
   template <typename ... Args>
   static inline void log(Args && ... args) {
-    logging::write_to_stream(std::cout, std::forward<Args>(args) ..., '\n');
+    logging::write_message(std::cout, std::forward<Args>(args) ..., '\n');
   }
 
+  /// Allows at most one message every period, from any thread, and counts
+  /// the ones suppressed in between.
+  class RateLimiter {
+  public:
+
+    explicit RateLimiter(double seconds)
+      : _period(std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(seconds)).count()) {}
+
+    /// Whether a message may be written now. If so, @a suppressed is set to
+    /// the number of messages suppressed since the last one allowed.
+    bool Allow(size_t &suppressed) {
+      const int64_t now = Clock::now().time_since_epoch().count();
+      int64_t next = _next.load(std::memory_order_relaxed);
+      if ((now < next) ||
+          !_next.compare_exchange_strong(next, now + _period, std::memory_order_relaxed)) {
+        _suppressed.fetch_add(1u, std::memory_order_relaxed);
+        return false;
+      }
+      suppressed = _suppressed.exchange(0u, std::memory_order_relaxed);
+      return true;
+    }
+
+  private:
+
+    using Clock = std::chrono::steady_clock;
+
+    const int64_t _period;
+
+    std::atomic<int64_t> _next{std::numeric_limits<int64_t>::min()};
+
+    std::atomic<size_t> _suppressed{0u};
+  };
+
 } // namespace logging
 
 #if LIBCARLA_LOG_LEVEL <= LIBCARLA_LOG_LEVEL_DEBUG
 
   template <typename ... Args>
   static inline void log_debug(Args && ... args) {
-    logging::write_to_stream(std::cout, "DEBUG:", std::forward<Args>(args) ..., '\n');
+    logging::write_message(std::cout, "DEBUG:", std::forward<Args>(args) ..., '\n');
   }
 
 #else
@@ -80,7 +153,7 @@ namespace logging {
 
   template <typename ... Args>
   static inline void log_info(Args && ... args) {
-    logging::write_to_stream(std::cout, "INFO: ", std::forward<Args>(args) ..., '\n');
+    logging::write_message(std::cout, "INFO: ", std::forward<Args>(args) ..., '\n');
   }
 
 #else
@@ -94,7 +167,7 @@ namespace logging {
 
   template <typename ... Args>
   static inline void log_warning(Args && ... args) {
-    logging::write_to_stream(std::cerr, "WARNING:", std::forward<Args>(args) ..., '\n');
+    logging::write_message(std::cerr, "WARNING:", std::forward<Args>(args) ..., '\n');
   }
 
 #else
@@ -108,7 +181,7 @@ namespace logging {
 
   template <typename ... Args>
   static inline void log_error(Args && ... args) {
-    logging::write_to_stream(std::cerr, "ERROR:", std::forward<Args>(args) ..., '\n');
+    logging::write_message(std::cerr, "ERROR:", std::forward<Args>(args) ..., '\n');
   }
 
 #else
@@ -122,7 +195,9 @@ namespace logging {
 
   template <typename ... Args>
   static inline void log_critical(Args && ... args) {
-    logging::write_to_stream(std::cerr, "CRITICAL:", std::forward<Args>(args) ..., '\n');
+    logging::write_message(std::cerr, "CRITICAL:", std::forward<Args>(args) ..., '\n');
+    // Usually the last words before aborting.
+    logging::flush();
   }
 
 #else
@@ -149,3 +224,40 @@ namespace logging {
 #else
 #  define LOG_INFO_ONLY(code)
 #endif
+
+#define LIBCARLA_LOG_EVERY(seconds, log_function, ...) \
+  do { \
+    static ::carla::logging::RateLimiter libcarla_rate_limiter{seconds}; \
+    size_t libcarla_suppressed = 0u; \
+    if (libcarla_rate_limiter.Allow(libcarla_suppressed)) { \
+      if (libcarla_suppressed > 0u) { \
+        log_function(__VA_ARGS__, "(", libcarla_suppressed, "similar messages suppressed)"); \
+      } else { \
+        log_function(__VA_ARGS__); \
+      } \
+    } \
+  } while (false)
+
+#if LIBCARLA_LOG_LEVEL <= LIBCARLA_LOG_LEVEL_DEBUG
+#  define LOG_DEBUG_EVERY(seconds, ...) LIBCARLA_LOG_EVERY(seconds, ::carla::log_debug, __VA_ARGS__)
+#else
+#  define LOG_DEBUG_EVERY(seconds, ...) do {} while (false)
+#endif
+
+#if LIBCARLA_LOG_LEVEL <= LIBCARLA_LOG_LEVEL_INFO
+#  define LOG_INFO_EVERY(seconds, ...) LIBCARLA_LOG_EVERY(seconds, ::carla::log_info, __VA_ARGS__)
+#else
+#  define LOG_INFO_EVERY(seconds, ...) do {} while (false)
+#endif
+
+#if LIBCARLA_LOG_LEVEL <= LIBCARLA_LOG_LEVEL_WARNING
+#  define LOG_WARNING_EVERY(seconds, ...) LIBCARLA_LOG_EVERY(seconds, ::carla::log_warning, __VA_ARGS__)
+#else
+#  define LOG_WARNING_EVERY(seconds, ...) do {} while (false)
+#endif
+
+#if LIBCARLA_LOG_LEVEL <= LIBCARLA_LOG_LEVEL_ERROR
+#  define LOG_ERROR_EVERY(seconds, ...) LIBCARLA_LOG_EVERY(seconds, ::carla::log_error, __VA_ARGS__)
+#else
+#  define LOG_ERROR_EVERY(seconds, ...) do {} while (false)
+#endif
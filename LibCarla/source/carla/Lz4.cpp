@@ -0,0 +1,206 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/Lz4.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace carla {
+
+  // ===========================================================================
+  // -- Static local methods ---------------------------------------------------
+  // ===========================================================================
+
+  static constexpr size_t LZ4_MIN_MATCH = 4u;
+  static constexpr size_t LZ4_LAST_LITERALS = 5u;
+  static constexpr size_t LZ4_MATCH_FIND_LIMIT = 12u;
+  static constexpr size_t LZ4_MAX_DISTANCE = 65535u;
+  static constexpr size_t LZ4_HASH_LOG = 12u;
+
+  static size_t Lz4CompressBound(size_t size) {
+    return size + (size / 255u) + 16u;
+  }
+
+  static uint32_t Read32(const unsigned char *source) {
+    uint32_t value;
+    std::memcpy(&value, source, sizeof(value));
+    return value;
+  }
+
+  static uint32_t Lz4Hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32u - LZ4_HASH_LOG);
+  }
+
+  static unsigned char *Lz4WriteLength(unsigned char *destination, size_t length) {
+    for (; length >= 255u; length -= 255u) {
+      *destination++ = 255u;
+    }
+    *destination++ = static_cast<unsigned char>(length);
+    return destination;
+  }
+
+  static unsigned char *Lz4WriteSequence(
+      unsigned char *destination,
+      const unsigned char *literals,
+      const size_t literal_length,
+      const size_t offset,
+      const size_t match_length) {
+    auto *token = destination++;
+    if (literal_length >= 15u) {
+      *token = 15u << 4u;
+      destination = Lz4WriteLength(destination, literal_length - 15u);
+    } else {
+      *token = static_cast<unsigned char>(literal_length << 4u);
+    }
+    std::memcpy(destination, literals, literal_length);
+    destination += literal_length;
+    if (match_length == 0u) {
+      // Last sequence, only literals.
+      return destination;
+    }
+    *destination++ = static_cast<unsigned char>(offset & 0xFFu);
+    *destination++ = static_cast<unsigned char>(offset >> 8u);
+    const auto length = match_length - LZ4_MIN_MATCH;
+    if (length >= 15u) {
+      *token |= 15u;
+      destination = Lz4WriteLength(destination, length - 15u);
+    } else {
+      *token |= static_cast<unsigned char>(length);
+    }
+    return destination;
+  }
+
+  static size_t Lz4Compress(
+      const unsigned char *source,
+      const size_t size,
+      unsigned char *destination) {
+    auto *output = destination;
+    size_t anchor = 0u;
+    if (size > LZ4_MATCH_FIND_LIMIT) {
+      std::array<uint32_t, 1u << LZ4_HASH_LOG> table;
+      table.fill(0u);
+      const size_t match_limit = size - LZ4_LAST_LITERALS;
+      const size_t search_limit = size - LZ4_MATCH_FIND_LIMIT;
+      size_t position = 0u;
+      while (position < search_limit) {
+        const auto sequence = Read32(source + position);
+        auto &entry = table[Lz4Hash(sequence)];
+        const size_t candidate = entry;
+        entry = static_cast<uint32_t>(position);
+        if ((candidate < position) &&
+            ((position - candidate) <= LZ4_MAX_DISTANCE) &&
+            (Read32(source + candidate) == sequence)) {
+          size_t length = LZ4_MIN_MATCH;
+          while (((position + length) < match_limit) &&
+                 (source[candidate + length] == source[position + length])) {
+            ++length;
+          }
+          output = Lz4WriteSequence(
+              output,
+              source + anchor,
+              position - anchor,
+              position - candidate,
+              length);
+          position += length;
+          anchor = position;
+        } else {
+          // Skip faster over data that does not compress.
+          position += 1u + ((position - anchor) >> 6u);
+        }
+      }
+    }
+    output = Lz4WriteSequence(output, source + anchor, size - anchor, 0u, 0u);
+    return static_cast<size_t>(output - destination);
+  }
+
+  static bool Lz4ReadLength(const unsigned char *&source, const unsigned char *end, size_t &length) {
+    unsigned char byte;
+    do {
+      if (source >= end) {
+        return false;
+      }
+      byte = *source++;
+      length += byte;
+    } while (byte == 255u);
+    return true;
+  }
+
+  static bool Lz4Decompress(
+      const unsigned char *source,
+      const size_t source_size,
+      unsigned char *destination,
+      const size_t size) {
+    const auto *input_end = source + source_size;
+    auto *output = destination;
+    const auto *output_end = destination + size;
+    while (source < input_end) {
+      const auto token = *source++;
+      size_t literal_length = token >> 4u;
+      if ((literal_length == 15u) && !Lz4ReadLength(source, input_end, literal_length)) {
+        return false;
+      }
+      if ((literal_length > static_cast<size_t>(input_end - source)) ||
+          (literal_length > static_cast<size_t>(output_end - output))) {
+        return false;
+      }
+      std::memcpy(output, source, literal_length);
+      source += literal_length;
+      output += literal_length;
+      if (source == input_end) {
+        break;
+      }
+      if ((input_end - source) < 2) {
+        return false;
+      }
+      const size_t offset = source[0u] | (static_cast<size_t>(source[1u]) << 8u);
+      source += 2u;
+      if ((offset == 0u) || (offset > static_cast<size_t>(output - destination))) {
+        return false;
+      }
+      size_t match_length = token & 15u;
+      if ((match_length == 15u) && !Lz4ReadLength(source, input_end, match_length)) {
+        return false;
+      }
+      match_length += LZ4_MIN_MATCH;
+      if (match_length > static_cast<size_t>(output_end - output)) {
+        return false;
+      }
+      // The match may overlap the output, copy byte by byte.
+      const auto *match = output - offset;
+      for (size_t i = 0u; i < match_length; ++i) {
+        output[i] = match[i];
+      }
+      output += match_length;
+    }
+    return output == output_end;
+  }
+
+  // ===========================================================================
+  // -- Lz4 --------------------------------------------------------------------
+  // ===========================================================================
+
+  size_t Lz4::CompressBound(const size_t size) {
+    return Lz4CompressBound(size);
+  }
+
+  size_t Lz4::Compress(
+      const unsigned char *source,
+      const size_t size,
+      unsigned char *destination) {
+    return Lz4Compress(source, size, destination);
+  }
+
+  bool Lz4::Decompress(
+      const unsigned char *source,
+      const size_t source_size,
+      unsigned char *destination,
+      const size_t size) {
+    return Lz4Decompress(source, source_size, destination, size);
+  }
+
+} // namespace carla
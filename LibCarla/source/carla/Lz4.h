@@ -0,0 +1,38 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+
+namespace carla {
+
+  /// Compression of independent blocks in the LZ4 block format, see
+  /// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+  ///
+  /// A greedy single-pass compressor, fast rather than small.
+  class Lz4 {
+  public:
+
+    /// Maximum size of the compressed data of @a size bytes.
+    static size_t CompressBound(size_t size);
+
+    /// Compresses @a size bytes at @a source into @a destination, which must
+    /// hold at least CompressBound(size) bytes. Returns the compressed size.
+    static size_t Compress(
+        const unsigned char *source,
+        size_t size,
+        unsigned char *destination);
+
+    /// Returns false unless @a source decompresses into exactly @a size bytes.
+    static bool Decompress(
+        const unsigned char *source,
+        size_t source_size,
+        unsigned char *destination,
+        size_t size);
+  };
+
+} // namespace carla
@@ -0,0 +1,83 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/MemoryAccounting.h"
+
+#include "carla/Debug.h"
+
+#include <atomic>
+#include <fstream>
+
+#ifdef __linux__
+#  include <unistd.h>
+#endif // __linux__
+
+namespace carla {
+
+  struct MemoryCounters {
+    std::atomic_size_t bytes{0u};
+
+    std::atomic_size_t allocations{0u};
+
+    std::atomic_size_t peak_bytes{0u};
+  };
+
+  static MemoryCounters COUNTERS[static_cast<size_t>(MemoryTag::SIZE)];
+
+  static MemoryCounters &GetCounters(MemoryTag tag) noexcept {
+    DEBUG_ASSERT(tag < MemoryTag::SIZE);
+    return COUNTERS[static_cast<size_t>(tag)];
+  }
+
+  void MemoryAccounting::Add(const MemoryTag tag, const size_t bytes) noexcept {
+    auto &counters = GetCounters(tag);
+    const auto current = counters.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    counters.allocations.fetch_add(1u, std::memory_order_relaxed);
+    auto peak = counters.peak_bytes.load(std::memory_order_relaxed);
+    while ((peak < current) &&
+           !counters.peak_bytes.compare_exchange_weak(peak, current, std::memory_order_relaxed));
+  }
+
+  void MemoryAccounting::Remove(const MemoryTag tag, const size_t bytes) noexcept {
+    auto &counters = GetCounters(tag);
+    counters.bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    counters.allocations.fetch_sub(1u, std::memory_order_relaxed);
+  }
+
+  MemoryUsage MemoryAccounting::GetUsage(const MemoryTag tag) noexcept {
+    const auto &counters = GetCounters(tag);
+    MemoryUsage usage;
+    usage.bytes = counters.bytes.load(std::memory_order_relaxed);
+    usage.allocations = counters.allocations.load(std::memory_order_relaxed);
+    usage.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+    return usage;
+  }
+
+  const char *MemoryAccounting::GetName(const MemoryTag tag) noexcept {
+    switch (tag) {
+      case MemoryTag::Buffer:         return "buffer";
+      case MemoryTag::BufferPool:     return "buffer_pool";
+      case MemoryTag::StreamingQueue: return "streaming_queue";
+      case MemoryTag::MapData:        return "map_data";
+      case MemoryTag::Navigation:     return "navigation";
+      default:                        return "unknown";
+    }
+  }
+
+  size_t MemoryAccounting::GetResidentBytes() {
+#ifdef __linux__
+    // Second field, resident pages.
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0u;
+    size_t resident = 0u;
+    if (statm >> pages >> resident) {
+      return resident * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    }
+#endif // __linux__
+    return 0u;
+  }
+
+} // namespace carla
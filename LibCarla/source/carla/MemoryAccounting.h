@@ -0,0 +1,142 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace carla {
+
+  /// Subsystem the memory accounted by MemoryAccounting belongs to.
+  enum class MemoryTag : uint8_t {
+    /// Buffers in use, sensor data, images, messages.
+    Buffer,
+
+    /// Buffers kept by a BufferPool to be reused.
+    BufferPool,
+
+    /// Messages queued by the streaming sessions waiting to be sent.
+    StreamingQueue,
+
+    /// OpenDRIVE road data of the loaded maps.
+    MapData,
+
+    /// Navigation meshes of the loaded maps.
+    Navigation,
+
+    SIZE
+  };
+
+  struct MemoryUsage {
+    size_t bytes = 0u;
+
+    size_t allocations = 0u;
+
+    /// Highest number of bytes accounted at once.
+    size_t peak_bytes = 0u;
+  };
+
+  /// Process-wide counters of the memory used by each subsystem. Buffers are
+  /// accounted as they are allocated, containers add an estimate of their
+  /// size with a TrackedMemory.
+  ///
+  /// Thread-safe, the counters are atomic.
+  class MemoryAccounting {
+  public:
+
+    static void Add(MemoryTag tag, size_t bytes) noexcept;
+
+    static void Remove(MemoryTag tag, size_t bytes) noexcept;
+
+    /// Move the accounting of @a bytes from @a from to @a to.
+    static void Move(MemoryTag from, MemoryTag to, size_t bytes) noexcept {
+      if (from != to) {
+        Add(to, bytes);
+        Remove(from, bytes);
+      }
+    }
+
+    static MemoryUsage GetUsage(MemoryTag tag) noexcept;
+
+    static const char *GetName(MemoryTag tag) noexcept;
+
+    /// Resident set size of the process, zero if the platform does not tell.
+    static size_t GetResidentBytes();
+  };
+
+  /// Accounts @a bytes of memory under a MemoryTag while alive. Copies
+  /// account their own bytes.
+  class TrackedMemory {
+  public:
+
+    TrackedMemory() = default;
+
+    TrackedMemory(MemoryTag tag, size_t bytes) noexcept
+      : _tag(tag),
+        _bytes(bytes) {
+      if (_bytes > 0u) {
+        MemoryAccounting::Add(_tag, _bytes);
+      }
+    }
+
+    TrackedMemory(const TrackedMemory &rhs) noexcept
+      : TrackedMemory(rhs._tag, rhs._bytes) {}
+
+    TrackedMemory(TrackedMemory &&rhs) noexcept
+      : _tag(rhs._tag),
+        _bytes(rhs._bytes) {
+      rhs._bytes = 0u;
+    }
+
+    TrackedMemory &operator=(const TrackedMemory &rhs) noexcept {
+      if (this != &rhs) {
+        Reset(rhs._tag, rhs._bytes);
+      }
+      return *this;
+    }
+
+    TrackedMemory &operator=(TrackedMemory &&rhs) noexcept {
+      if (this != &rhs) {
+        Reset(rhs._tag, 0u);
+        _bytes = rhs._bytes;
+        rhs._bytes = 0u;
+      }
+      return *this;
+    }
+
+    ~TrackedMemory() {
+      Reset(_tag, 0u);
+    }
+
+    /// Account @a bytes instead of the current ones.
+    void Set(size_t bytes) noexcept {
+      Reset(_tag, bytes);
+    }
+
+    size_t bytes() const noexcept {
+      return _bytes;
+    }
+
+  private:
+
+    void Reset(MemoryTag tag, size_t bytes) noexcept {
+      if (_bytes > 0u) {
+        MemoryAccounting::Remove(_tag, _bytes);
+      }
+      _tag = tag;
+      _bytes = bytes;
+      if (_bytes > 0u) {
+        MemoryAccounting::Add(_tag, _bytes);
+      }
+    }
+
+    MemoryTag _tag = MemoryTag::Buffer;
+
+    size_t _bytes = 0u;
+  };
+
+} // namespace carla
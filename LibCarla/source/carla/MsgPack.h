@@ -7,32 +7,126 @@
 #pragma once
 
 #include "carla/Buffer.h"
+#include "carla/BufferPool.h"
+#include "carla/Exception.h"
 
 #include <rpc/msgpack.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
 namespace carla {
 
+namespace detail {
+
+  /// Stream for msgpack's packer that writes straight into a Buffer popped
+  /// from a BufferPool, growing into a bigger one from the same pool when
+  /// needed.
+  class MsgPackBufferStream {
+  public:
+
+    MsgPackBufferStream(BufferPool &pool, Buffer::size_type initial_capacity)
+      : _pool(pool),
+        _buffer(pool.Pop(initial_capacity)) {}
+
+    void write(const char *data, size_t size) {
+      const uint64_t required = uint64_t(_size) + size;
+      if (required > _buffer.size()) {
+        Grow(required);
+      }
+      std::memcpy(_buffer.data() + _size, data, size);
+      _size += static_cast<Buffer::size_type>(size);
+    }
+
+    /// Return the buffer holding the data written so far.
+    Buffer Release() {
+      _buffer.reset(_size);
+      return std::move(_buffer);
+    }
+
+  private:
+
+    void Grow(uint64_t required) {
+      if (required > Buffer::max_size()) {
+        throw_exception(std::invalid_argument("message size too big"));
+      }
+      const uint64_t doubled = 2u * uint64_t(_buffer.size());
+      const auto capacity = static_cast<Buffer::size_type>(
+          std::min<uint64_t>(std::max(required, doubled), Buffer::max_size()));
+      Buffer bigger = _pool.Pop(capacity);
+      std::memcpy(bigger.data(), _buffer.data(), _size);
+      // The previous buffer goes back to the pool.
+      _buffer = std::move(bigger);
+    }
+
+    BufferPool &_pool;
+
+    Buffer _buffer;
+
+    Buffer::size_type _size = 0u;
+  };
+
+} // namespace detail
+
   class MsgPack {
   public:
 
+    /// Capacity of the buffer a message starts being packed into.
+    static constexpr Buffer::size_type INITIAL_BUFFER_CAPACITY = 256u;
+
+    /// Pack @a obj into a Buffer from a pool shared by all the calls.
     template <typename T>
     static Buffer Pack(const T &obj) {
+      return Pack(obj, GetBufferPool());
+    }
+
+    /// Pack @a obj directly into a Buffer popped from @a pool, without an
+    /// intermediate copy.
+    template <typename T>
+    static Buffer Pack(const T &obj, BufferPool &pool) {
       namespace mp = ::clmdep_msgpack;
-      mp::sbuffer sbuf;
-      mp::pack(sbuf, obj);
-      return Buffer(reinterpret_cast<const unsigned char *>(sbuf.data()), sbuf.size());
+      detail::MsgPackBufferStream stream(pool, INITIAL_BUFFER_CAPACITY);
+      mp::pack(stream, obj);
+      return stream.Release();
     }
 
     template <typename T>
     static T UnPack(const Buffer &buffer) {
-      namespace mp = ::clmdep_msgpack;
-      return mp::unpack(reinterpret_cast<const char *>(buffer.data()), buffer.size()).template as<T>();
+      return UnPack<T>(buffer.data(), buffer.size());
     }
 
+    /// Unpack an object of type T from @a data. The intermediate msgpack
+    /// objects live in a zone reused by every call on the same thread, and
+    /// strings and binaries are referenced from @a data rather than copied,
+    /// so in the steady state only T allocates.
     template <typename T>
     static T UnPack(const unsigned char *data, size_t size) {
       namespace mp = ::clmdep_msgpack;
-      return mp::unpack(reinterpret_cast<const char *>(data), size).template as<T>();
+      auto &zone = GetThreadZone();
+      // Clear the zone when done, even if the conversion throws.
+      const std::unique_ptr<mp::zone, void(*)(mp::zone *)> guard(
+          &zone,
+          [](mp::zone *z) { z->clear(); });
+      const mp::object object = mp::unpack(
+          zone,
+          reinterpret_cast<const char *>(data),
+          size,
+          [](mp::type::object_type, size_t, void *) { return true; });
+      return object.as<T>();
+    }
+
+  private:
+
+    static BufferPool &GetBufferPool() {
+      static auto pool = std::make_shared<BufferPool>();
+      return *pool;
+    }
+
+    static ::clmdep_msgpack::zone &GetThreadZone() {
+      static thread_local ::clmdep_msgpack::zone zone;
+      return zone;
     }
   };
 
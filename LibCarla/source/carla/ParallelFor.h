@@ -0,0 +1,100 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/TaskScheduler.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace carla {
+
+namespace detail {
+
+  /// Number of chunks [0, @a size) is split into, a few per thread so
+  /// the threads finishing first steal the rest, but none smaller than
+  /// @a min_chunk_size.
+  inline size_t GetNumberOfChunks(const TaskScheduler &scheduler, const size_t size, const size_t min_chunk_size) {
+    constexpr size_t CHUNKS_PER_THREAD = 4u;
+    const size_t threads = scheduler.GetNumberOfWorkers() + 1u;
+    return std::max<size_t>(1u, std::min(CHUNKS_PER_THREAD * threads, size / std::max<size_t>(1u, min_chunk_size)));
+  }
+
+  /// Call @a functor(chunk, begin, end) for each of the @a number_of_chunks
+  /// chunks of [0, @a size) in the default TaskScheduler.
+  template <typename F>
+  void ForEachChunk(const size_t size, const size_t number_of_chunks, const TaskPriority priority, F &functor) {
+    const size_t chunk_size = (size + number_of_chunks - 1u) / number_of_chunks;
+    TaskGroup group;
+    size_t chunk = 1u;
+    for (size_t begin = chunk_size; begin < size; begin += chunk_size, ++chunk) {
+      const size_t end = std::min(size, begin + chunk_size);
+      group.Run([&functor, chunk, begin, end]() {
+        functor(chunk, begin, end);
+      }, priority);
+    }
+    // The calling thread takes the first chunk, then helps with the rest. If
+    // it throws, the group still waits for the rest before unwinding.
+    functor(size_t(0u), size_t(0u), std::min(size, chunk_size));
+    group.Wait();
+  }
+
+} // namespace detail
+
+  /// Call @a functor(begin, end) on contiguous chunks of the range
+  /// [0, @a size) in the default TaskScheduler, as long as they have at
+  /// least @a min_chunk_size elements. The calling thread takes the first
+  /// chunk. Returns once every chunk is done, rethrowing the exception thrown
+  /// by any of them.
+  template <typename F>
+  void ParallelForEachChunk(
+      const size_t size,
+      const size_t min_chunk_size,
+      F &&functor,
+      const TaskPriority priority = TaskPriority::Normal) {
+    const size_t number_of_chunks = detail::GetNumberOfChunks(TaskScheduler::GetDefault(), size, min_chunk_size);
+    if (number_of_chunks <= 1u) {
+      functor(size_t(0u), size);
+      return;
+    }
+    auto call = [&functor](size_t, const size_t begin, const size_t end) {
+      functor(begin, end);
+    };
+    detail::ForEachChunk(size, number_of_chunks, priority, call);
+  }
+
+  /// Reduce the range [0, @a size) split in chunks as in
+  /// ParallelForEachChunk: @a map(begin, end) returns the value of each
+  /// chunk, and the values are combined with @a reduce(lhs, rhs) in the order
+  /// of the chunks starting with @a identity, so the result does not depend
+  /// on the number of threads as long as @a reduce is associative.
+  template <typename T, typename MapT, typename ReduceT>
+  T ParallelReduce(
+      const size_t size,
+      const size_t min_chunk_size,
+      T identity,
+      MapT &&map,
+      ReduceT &&reduce,
+      const TaskPriority priority = TaskPriority::Normal) {
+    const size_t number_of_chunks = detail::GetNumberOfChunks(TaskScheduler::GetDefault(), size, min_chunk_size);
+    if (number_of_chunks <= 1u) {
+      return reduce(std::move(identity), map(size_t(0u), size));
+    }
+    std::vector<T> values(number_of_chunks, identity);
+    auto call = [&map, &values](const size_t chunk, const size_t begin, const size_t end) {
+      values[chunk] = map(begin, end);
+    };
+    detail::ForEachChunk(size, number_of_chunks, priority, call);
+    T result = std::move(identity);
+    for (auto &value : values) {
+      result = reduce(std::move(result), std::move(value));
+    }
+    return result;
+  }
+
+} // namespace carla
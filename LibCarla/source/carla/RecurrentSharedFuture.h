@@ -6,16 +6,21 @@
 
 #pragma once
 
+#include "carla/AtomicSharedPtr.h"
+#include "carla/Debug.h"
 #include "carla/Exception.h"
 #include "carla/Time.h"
 
 #include <boost/optional.hpp>
 #include <boost/variant.hpp>
 
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <exception>
-#include <map>
+#include <memory>
 #include <mutex>
+#include <thread>
 
 namespace carla {
 
@@ -31,6 +36,11 @@ namespace detail {
 
   /// This class is meant to be used similar to a shared future, but the value
   /// can be set any number of times.
+  ///
+  /// Each value set increments a sequence number, waiters wait for it to
+  /// change and then read the value published. Waiters spin briefly before
+  /// sleeping, and setting a value only locks the mutex to wake the ones
+  /// sleeping, if any.
   template <typename T>
   class RecurrentSharedFuture {
   public:
@@ -57,16 +67,21 @@ namespace detail {
 
   private:
 
-    std::mutex _mutex;
+    using ValueType = boost::variant<SharedException, T>;
 
-    std::condition_variable _cv;
+    /// Times a waiter checks for a new value, yielding between checks, before
+    /// sleeping.
+    static constexpr size_t SpinCount = 64u;
+
+    std::atomic<uint64_t> _sequence{0u};
+
+    AtomicSharedPtr<const ValueType> _value;
+
+    std::atomic<size_t> _number_of_sleepers{0u};
 
-    struct mapped_type {
-      bool should_wait;
-      boost::variant<SharedException, T> value;
-    };
+    std::mutex _mutex;
 
-    std::map<const char *, mapped_type> _map;
+    std::condition_variable _cv;
   };
 
   // ===========================================================================
@@ -75,8 +90,6 @@ namespace detail {
 
 namespace detail {
 
-  static thread_local const char thread_tag{};
-
   class SharedException : public std::exception {
   public:
 
@@ -103,27 +116,44 @@ namespace detail {
 
   template <typename T>
   boost::optional<T> RecurrentSharedFuture<T>::WaitFor(time_duration timeout) {
-    std::unique_lock<std::mutex> lock(_mutex);
-    auto &r = _map[&detail::thread_tag];
-    r.should_wait = true;
-    if (!_cv.wait_for(lock, timeout.to_chrono(), [&]() { return !r.should_wait; })) {
+    const auto sequence = _sequence.load();
+    auto is_set = [&]() { return _sequence.load() != sequence; };
+    bool ready = false;
+    for (auto i = 0u; (i < SpinCount) && !ready; ++i) {
+      std::this_thread::yield();
+      ready = is_set();
+    }
+    if (!ready) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      ++_number_of_sleepers;
+      ready = _cv.wait_for(lock, timeout.to_chrono(), is_set);
+      --_number_of_sleepers;
+    }
+    if (!ready) {
       return {};
     }
-    if (r.value.which() == 0) {
-      throw_exception(boost::get<SharedException>(r.value));
+    // The value may have been set again since, we return the latest.
+    const auto value = _value.load();
+    DEBUG_ASSERT(value != nullptr);
+    if (value->which() == 0) {
+      throw_exception(boost::get<SharedException>(*value));
     }
-    return boost::get<T>(std::move(r.value));
+    return boost::get<T>(*value);
   }
 
   template <typename T>
   template <typename T2>
   void RecurrentSharedFuture<T>::SetValue(const T2 &value) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    for (auto &pair : _map) {
-      pair.second.should_wait = false;
-      pair.second.value = value;
+    // Publish the value before the sequence number, a waiter that sees the
+    // new number reads this value or a later one.
+    _value.store(std::make_shared<const ValueType>(value));
+    ++_sequence;
+    // Sleepers register before checking the sequence number under the lock,
+    // so either they see the new number or we see them here.
+    if (_number_of_sleepers.load() > 0u) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _cv.notify_all();
     }
-    _cv.notify_all();
   }
 
   template <typename T>
@@ -0,0 +1,172 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/TaskScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace carla {
+
+  // ===========================================================================
+  // -- TaskScheduler ----------------------------------------------------------
+  // ===========================================================================
+
+  /// Scheduler and queue of the worker running in this thread, if any.
+  static thread_local const TaskScheduler *CURRENT_SCHEDULER = nullptr;
+
+  static thread_local size_t CURRENT_QUEUE = 0u;
+
+  TaskScheduler::TaskScheduler(const size_t worker_threads)
+    : _number_of_workers(std::max<size_t>(1u, worker_threads)) {
+    _queues.reserve(_number_of_workers + 1u);
+    for (size_t i = 0u; i <= _number_of_workers; ++i) {
+      _queues.emplace_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0u; i < _number_of_workers; ++i) {
+      _workers.CreateThread([this, i]() { RunWorker(i); });
+    }
+  }
+
+  TaskScheduler::~TaskScheduler() {
+    {
+      std::lock_guard<std::mutex> lock(_sleep_mutex);
+      _stop = true;
+    }
+    _wake_up.notify_all();
+    _workers.JoinAll();
+  }
+
+  TaskScheduler &TaskScheduler::GetDefault() {
+    static TaskScheduler scheduler{std::max(2u, std::thread::hardware_concurrency()) - 1u};
+    return scheduler;
+  }
+
+  void TaskScheduler::Post(Task task, const TaskPriority priority) {
+    // Counted before it is queued, a worker woken up in between finds
+    // nothing and looks again.
+    ++_pending;
+    auto &queue = *_queues[GetQueueIndex()];
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks[static_cast<size_t>(priority)].emplace_back(std::move(task));
+    }
+    {
+      std::lock_guard<std::mutex> lock(_sleep_mutex);
+    }
+    _wake_up.notify_one();
+  }
+
+  bool TaskScheduler::RunOne() {
+    Task task;
+    if (!TryPop(GetQueueIndex(), task)) {
+      return false;
+    }
+    task();
+    return true;
+  }
+
+  size_t TaskScheduler::GetQueueIndex() const {
+    return CURRENT_SCHEDULER == this ? CURRENT_QUEUE : _number_of_workers;
+  }
+
+  bool TaskScheduler::TryPop(const size_t index, Task &task) {
+    const size_t number_of_queues = _queues.size();
+    const bool is_worker = index < _number_of_workers;
+    for (auto &&priority : {TaskPriority::High, TaskPriority::Normal, TaskPriority::Low}) {
+      const auto p = static_cast<size_t>(priority);
+      // The newest task of its own queue, still in cache, or the oldest one
+      // of another queue, the one most likely to split into more tasks.
+      for (size_t i = 0u; i < number_of_queues; ++i) {
+        auto &queue = *_queues[(index + i) % number_of_queues];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        auto &tasks = queue.tasks[p];
+        if (tasks.empty()) {
+          continue;
+        }
+        if ((i == 0u) && is_worker) {
+          task = std::move(tasks.back());
+          tasks.pop_back();
+        } else {
+          task = std::move(tasks.front());
+          tasks.pop_front();
+        }
+        --_pending;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void TaskScheduler::RunWorker(const size_t index) {
+    CURRENT_SCHEDULER = this;
+    CURRENT_QUEUE = index;
+    Task task;
+    for (;;) {
+      if (TryPop(index, task)) {
+        task();
+        task = nullptr;
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(_sleep_mutex);
+      _wake_up.wait(lock, [this]() { return _stop || (_pending > 0u); });
+      if (_stop && (_pending == 0u)) {
+        return;
+      }
+    }
+  }
+
+  // ===========================================================================
+  // -- TaskGroup --------------------------------------------------------------
+  // ===========================================================================
+
+  TaskGroup::~TaskGroup() {
+    try {
+      Wait();
+    } catch (...) {
+      // The exceptions are only reported by Wait.
+    }
+  }
+
+  void TaskGroup::Wait() {
+    for (;;) {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_pending == 0u) {
+          break;
+        }
+      }
+      // The tasks of the group may be queued behind others, so this thread
+      // helps with whatever is pending.
+      if (!_scheduler.RunOne() && WaitIdle()) {
+        break;
+      }
+    }
+    std::exception_ptr exception;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      std::swap(exception, _exception);
+    }
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+
+  void TaskGroup::SetException(std::exception_ptr exception) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_exception) {
+      _exception = std::move(exception);
+    }
+  }
+
+  bool TaskGroup::WaitIdle() {
+    // Bounded, a task of the group may post more tasks this thread can run.
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _done.wait_for(lock, std::chrono::microseconds(200), [this]() { return _pending == 0u; });
+  }
+
+} // namespace carla
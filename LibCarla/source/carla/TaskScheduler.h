@@ -0,0 +1,147 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/ThreadGroup.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace carla {
+
+  enum class TaskPriority : uint8_t {
+    High,
+    Normal,
+    Low
+  };
+
+  /// Work-stealing scheduler of short CPU-bound tasks. Each worker thread
+  /// has its own queue, it runs the newest tasks it posted first and, once
+  /// empty, steals the oldest ones of the other queues. Higher priority tasks
+  /// are taken first, wherever they are. The tasks posted from threads that
+  /// are not workers of the scheduler go to a shared queue.
+  ///
+  /// Unlike ThreadPool there is no future per task, the tasks are meant to
+  /// be run in a TaskGroup. The servers keep their ThreadPool, their tasks
+  /// block on sockets.
+  class TaskScheduler : private NonCopyable {
+  public:
+
+    using Task = std::function<void()>;
+
+    /// Launch @a worker_threads threads, at least one.
+    explicit TaskScheduler(size_t worker_threads);
+
+    /// Run the tasks still pending and join the workers.
+    ~TaskScheduler();
+
+    /// The scheduler shared by LibCarla, with a worker for every hardware
+    /// thread but one, the thread waiting for the tasks runs them too.
+    static TaskScheduler &GetDefault();
+
+    size_t GetNumberOfWorkers() const {
+      return _number_of_workers;
+    }
+
+    void Post(Task task, TaskPriority priority = TaskPriority::Normal);
+
+    /// Run one of the pending tasks in this thread, returns false if there
+    /// was none.
+    bool RunOne();
+
+  private:
+
+    struct Queue {
+      std::mutex mutex;
+      std::deque<Task> tasks[3u];
+    };
+
+    /// Queue of the calling thread, the shared one if it is not a worker.
+    size_t GetQueueIndex() const;
+
+    bool TryPop(size_t index, Task &task);
+
+    void RunWorker(size_t index);
+
+    const size_t _number_of_workers;
+
+    /// One per worker, and the shared one last.
+    std::vector<std::unique_ptr<Queue>> _queues;
+
+    /// Tasks posted and not taken yet.
+    std::atomic<size_t> _pending{0u};
+
+    std::atomic_bool _stop{false};
+
+    std::mutex _sleep_mutex;
+
+    std::condition_variable _wake_up;
+
+    ThreadGroup _workers;
+  };
+
+  /// Tasks run in a TaskScheduler and waited for together.
+  class TaskGroup : private NonCopyable {
+  public:
+
+    explicit TaskGroup(TaskScheduler &scheduler = TaskScheduler::GetDefault())
+      : _scheduler(scheduler) {}
+
+    /// Wait for the tasks still running, the exceptions are dropped.
+    ~TaskGroup();
+
+    template <typename F>
+    void Run(F &&functor, TaskPriority priority = TaskPriority::Normal) {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_pending;
+      }
+      _scheduler.Post([this, functor=std::forward<F>(functor)]() mutable {
+        try {
+          functor();
+        } catch (...) {
+          SetException(std::current_exception());
+        }
+        // Within the lock, the group may be destroyed right after.
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (--_pending == 0u) {
+          _done.notify_all();
+        }
+      }, priority);
+    }
+
+    /// Wait for every task run, running pending tasks of the scheduler in
+    /// this thread meanwhile. Rethrows the first exception thrown by any of
+    /// them.
+    void Wait();
+
+  private:
+
+    void SetException(std::exception_ptr exception);
+
+    bool WaitIdle();
+
+    TaskScheduler &_scheduler;
+
+    std::mutex _mutex;
+
+    std::condition_variable _done;
+
+    size_t _pending = 0u;
+
+    std::exception_ptr _exception;
+  };
+
+} // namespace carla
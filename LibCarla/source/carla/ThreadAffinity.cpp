@@ -0,0 +1,76 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/ThreadAffinity.h"
+
+#include "carla/Logging.h"
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#elif defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+namespace carla {
+
+  bool ThreadAffinity::Set(const uint64_t cpu_mask) {
+    if (cpu_mask == 0u) {
+      return false;
+    }
+#ifdef _WIN32
+    const auto mask = static_cast<DWORD_PTR>(cpu_mask);
+    if (SetThreadAffinityMask(::GetCurrentThread(), mask) != 0u) {
+      return true;
+    }
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto i = 0u; i < 64u; ++i) {
+      if ((cpu_mask & (uint64_t(1u) << i)) != 0u) {
+        CPU_SET(i, &set);
+      }
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+      return true;
+    }
+#endif
+    log_warning("unable to set the CPU affinity of the thread to", cpu_mask);
+    return false;
+  }
+
+  uint64_t ThreadAffinity::Get() {
+    uint64_t cpu_mask = 0u;
+#ifdef _WIN32
+    // Windows can only read the mask by replacing it, the process mask is a
+    // superset of every thread mask.
+    DWORD_PTR process_mask;
+    DWORD_PTR system_mask;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask) != 0) {
+      const auto previous = SetThreadAffinityMask(::GetCurrentThread(), process_mask);
+      if (previous != 0u) {
+        SetThreadAffinityMask(::GetCurrentThread(), previous);
+        cpu_mask = static_cast<uint64_t>(previous);
+      }
+    }
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+      for (auto i = 0u; i < 64u; ++i) {
+        if (CPU_ISSET(i, &set)) {
+          cpu_mask |= uint64_t(1u) << i;
+        }
+      }
+    }
+#endif
+    return cpu_mask;
+  }
+
+} // namespace carla
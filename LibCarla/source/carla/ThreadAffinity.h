@@ -0,0 +1,29 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+
+namespace carla {
+
+  /// Pins threads to a set of CPUs. Masks have bit i set for CPU i, a zero
+  /// mask means no restriction. Only the first 64 CPUs can be selected.
+  ///
+  /// Only supported on Linux and Windows, elsewhere every function fails and
+  /// the threads keep running on any CPU.
+  class ThreadAffinity {
+  public:
+
+    /// Restricts the calling thread to the CPUs in @a cpu_mask. Returns false
+    /// if the mask is zero or could not be applied.
+    static bool Set(uint64_t cpu_mask);
+
+    /// Returns the CPUs the calling thread may run on, zero if unknown.
+    static uint64_t Get();
+  };
+
+} // namespace carla
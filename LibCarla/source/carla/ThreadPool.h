@@ -8,6 +8,7 @@
 
 #include "carla/MoveHandler.h"
 #include "carla/NonCopyable.h"
+#include "carla/ThreadAffinity.h"
 #include "carla/ThreadGroup.h"
 #include "carla/Time.h"
 
@@ -51,6 +52,19 @@ namespace carla {
       _workers.CreateThreads(worker_threads, [this]() { Run(); });
     }
 
+    /// @copydoc AsyncRun(size_t)
+    ///
+    /// The threads are pinned to the CPUs in @a cpu_mask, zero leaves them
+    /// unrestricted.
+    void AsyncRun(size_t worker_threads, uint64_t cpu_mask) {
+      _workers.CreateThreads(worker_threads, [this, cpu_mask]() {
+        if (cpu_mask != 0u) {
+          ThreadAffinity::Set(cpu_mask);
+        }
+        Run();
+      });
+    }
+
     /// @copydoc AsyncRun(size_t)
     void AsyncRun() {
       AsyncRun(std::thread::hardware_concurrency());
@@ -56,6 +56,10 @@ namespace client {
     GetEpisode().Lock()->SetActorSimulatePhysics(*this, enabled);
   }
 
+  void Actor::SetKinematic(const bool enabled) {
+    GetEpisode().Lock()->SetActorKinematic(*this, enabled);
+  }
+
   bool Actor::Destroy() {
     if (IsAlive()) {
       // Let the exceptions leave the function, IsAlive() will still be true.
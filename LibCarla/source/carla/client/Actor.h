@@ -73,6 +73,12 @@ namespace client {
     /// Enable or disable physics simulation on this actor.
     void SetSimulatePhysics(bool enabled = true);
 
+    /// Make this actor kinematic, moved only by the client: its physics is
+    /// disabled and its components generate no overlap events, so moving it
+    /// is cheap. Meant for the actors driven by an external simulator.
+    /// Disabling it turns the physics and the overlap events back on.
+    void SetKinematic(bool enabled = true);
+
     /// Set the angular velocity of the actor
     void SetAngularVelocity(const geom::Vector3D &vector);
 
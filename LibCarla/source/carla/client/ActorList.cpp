@@ -8,6 +8,7 @@
 
 #include "carla/StringUtil.h"
 #include "carla/client/detail/ActorFactory.h"
+#include "carla/client/detail/Simulator.h"
 
 #include <iterator>
 
@@ -31,8 +32,24 @@ namespace client {
 
   SharedPtr<ActorList> ActorList::Filter(const std::string &wildcard_pattern) const {
     SharedPtr<ActorList> filtered (new ActorList(_episode, {}));
-    for (auto &&actor : _actors) {
-      if (StringUtil::Match(actor.GetTypeId(), wildcard_pattern)) {
+    // The episode remembers which type ids match each pattern, only the
+    // actors it does not know are matched here.
+    std::vector<boost::optional<bool>> matches;
+    auto episode = _episode.TryLock();
+    if (episode != nullptr) {
+      std::vector<ActorId> ids;
+      ids.reserve(_actors.size());
+      for (auto &&actor : _actors) {
+        ids.emplace_back(actor.GetId());
+      }
+      matches = episode->MatchTypeIds(ids, wildcard_pattern);
+    }
+    for (auto i = 0u; i < _actors.size(); ++i) {
+      const auto &actor = _actors[i];
+      const bool is_match = ((i < matches.size()) && matches[i].has_value()) ?
+          *matches[i] :
+          StringUtil::Match(actor.GetTypeId(), wildcard_pattern);
+      if (is_match) {
         filtered->_actors.push_back(actor);
       }
     }
@@ -20,17 +20,66 @@ namespace client {
     for (auto &definition : blueprints) {
       _blueprints.emplace(definition.id, definition);
     }
+    BuildIndex();
+  }
+
+  void BlueprintLibrary::BuildIndex() {
+    _index.clear();
+    for (auto &pair : _blueprints) {
+      const auto &blueprint = pair.second;
+      _index.emplace_back(blueprint.GetId(), &blueprint);
+      for (auto &tag : blueprint.GetTags()) {
+        if (tag != blueprint.GetId()) {
+          _index.emplace_back(tag, &blueprint);
+        }
+      }
+    }
+    std::sort(_index.begin(), _index.end());
   }
 
   SharedPtr<BlueprintLibrary> BlueprintLibrary::Filter(
       const std::string &wildcard_pattern) const {
+    std::lock_guard<std::mutex> lock(_filter_mutex);
+    auto &cached = _filter_cache[wildcard_pattern];
+    if (cached != nullptr) {
+      return cached;
+    }
+
+    // The index is used when the pattern has no wildcard of fnmatch, or only a
+    // '*' at the end.
+    const auto wildcard = wildcard_pattern.find_first_of("*?[\\");
+    const bool is_exact = (wildcard == std::string::npos);
+    const bool is_prefix =
+        !is_exact &&
+        (wildcard == wildcard_pattern.size() - 1u) &&
+        (wildcard_pattern.back() == '*');
+
     map_type result;
-    for (auto &pair : _blueprints) {
-      if (pair.second.MatchTags(wildcard_pattern)) {
-        result.emplace(pair);
+    if (is_exact || is_prefix) {
+      const auto prefix = wildcard_pattern.substr(0u, wildcard);
+      auto it = std::lower_bound(
+          _index.begin(),
+          _index.end(),
+          prefix,
+          [](const auto &entry, const std::string &key) { return entry.first < key; });
+      for (; it != _index.end(); ++it) {
+        const bool matches = is_exact ?
+            (it->first == prefix) :
+            (it->first.compare(0u, prefix.size(), prefix) == 0);
+        if (!matches) {
+          break;
+        }
+        result.emplace(it->second->GetId(), *it->second);
+      }
+    } else {
+      for (auto &pair : _blueprints) {
+        if (pair.second.MatchTags(wildcard_pattern)) {
+          result.emplace(pair);
+        }
       }
     }
-    return SharedPtr<BlueprintLibrary>{new BlueprintLibrary(result)};
+    cached = SharedPtr<BlueprintLibrary>{new BlueprintLibrary(std::move(result))};
+    return cached;
   }
 
   BlueprintLibrary::const_pointer BlueprintLibrary::Find(const std::string &key) const {
@@ -12,8 +12,10 @@
 #include "carla/NonCopyable.h"
 #include "carla/client/ActorBlueprint.h"
 
+#include <mutex>
 #include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace carla {
@@ -37,11 +39,13 @@ namespace client {
 
     explicit BlueprintLibrary(const std::vector<rpc::ActorDefinition> &blueprints);
 
-    BlueprintLibrary(BlueprintLibrary &&) = default;
-    BlueprintLibrary &operator=(BlueprintLibrary &&) = default;
-
     /// Filters a list of ActorBlueprint with id or tags matching
     /// @a wildcard_pattern.
+    ///
+    /// Patterns without wildcards and patterns whose only wildcard is a
+    /// trailing '*' are looked up in a sorted index of the ids and tags, the
+    /// rest are matched against every blueprint. The result of each pattern is
+    /// kept, filtering again with the same pattern returns the same library.
     SharedPtr<BlueprintLibrary> Filter(const std::string &wildcard_pattern) const;
 
     const_pointer Find(const std::string &key) const;
@@ -78,9 +82,21 @@ namespace client {
   private:
 
     BlueprintLibrary(map_type blueprints)
-      : _blueprints(std::move(blueprints)) {}
+      : _blueprints(std::move(blueprints)) {
+      BuildIndex();
+    }
+
+    void BuildIndex();
 
     map_type _blueprints;
+
+    /// Ids and tags of every blueprint sorted by them, the same blueprint
+    /// appears once per key.
+    std::vector<std::pair<std::string, const value_type *>> _index;
+
+    mutable std::mutex _filter_mutex;
+
+    mutable std::unordered_map<std::string, SharedPtr<BlueprintLibrary>> _filter_cache;
   };
 
 } // namespace client
@@ -22,10 +22,15 @@ namespace client {
     /// @param port TCP port to connect with the simulator.
     /// @param worker_threads number of asynchronous threads to use, or 0 to use
     ///        all available hardware concurrency.
+    /// @param rpc_connections number of connections to the rpc server. Each
+    ///        thread calling the simulator sticks to one of them, so with
+    ///        several connections the requests of different threads don't
+    ///        wait for each other.
     explicit Client(
         const std::string &host,
         uint16_t port,
-        size_t worker_threads = 0u);
+        size_t worker_threads = 0u,
+        size_t rpc_connections = 1u);
 
     /// Set a timeout for networking operations. If set, any networking
     /// operation taking longer than @a timeout throws rpc::timeout.
@@ -43,6 +48,58 @@ namespace client {
       return _simulator->GetServerVersion();
     }
 
+    /// Return the statistics of the profiled scopes of the simulator, see
+    /// profiler::RuntimeProfiler.
+    std::vector<profiler::ProfilerStats> GetServerProfilerStats() const {
+      return _simulator->GetServerProfilerStats();
+    }
+
+    /// Switch on or off the runtime profiler of the simulator.
+    void SetServerProfilerEnabled(bool enabled) const {
+      _simulator->SetServerProfilerEnabled(enabled);
+    }
+
+    /// Return the counters of the RPC functions and the streams of the
+    /// simulator.
+    rpc::ServerMetrics GetServerMetrics() const {
+      return _simulator->GetServerMetrics();
+    }
+
+    /// Return the cost counters of the sensors alive, see
+    /// SetSensorMetricsEnabled.
+    std::vector<rpc::SensorMetrics> GetSensorMetrics() const {
+      return _simulator->GetSensorMetrics();
+    }
+
+    /// Switch on or off the measuring of the cost of the sensors of the
+    /// simulator. While on, the counters returned by GetSensorMetrics are
+    /// updated and each sensor::SensorData carries the cost of its frame.
+    void SetSensorMetricsEnabled(bool enabled) const {
+      _simulator->SetSensorMetricsEnabled(enabled);
+    }
+
+    /// Return the memory used by each subsystem of the simulator.
+    rpc::MemoryReport GetServerMemoryReport() const {
+      return _simulator->GetServerMemoryReport();
+    }
+
+    /// Return the memory used by each subsystem of LibCarla in this process,
+    /// buffers, streaming queues and the maps and navigation meshes loaded.
+    rpc::MemoryReport GetClientMemoryReport() const {
+      return rpc::MemoryReport::Make();
+    }
+
+    /// Return the spans recorded by the frame tracer of the simulator as
+    /// Chrome trace JSON, see profiler::FrameTracer.
+    std::string GetServerFrameTrace() const {
+      return _simulator->GetServerFrameTrace();
+    }
+
+    /// Switch on or off the frame tracer of the simulator.
+    void SetServerFrameTracerEnabled(bool enabled) const {
+      _simulator->SetServerFrameTracerEnabled(enabled);
+    }
+
     std::vector<std::string> GetAvailableMaps() const {
       return _simulator->GetAvailableMaps();
     }
@@ -55,6 +112,27 @@ namespace client {
       return World{_simulator->LoadEpisode(std::move(map_name))};
     }
 
+    /// Start loading @a map_name in the background along with the assets of
+    /// @a preload_assets, object paths, and return right away. The current
+    /// world keeps running until the map is loaded, then the simulator
+    /// switches to it. See GetMapLoadProgress to follow the load, the new
+    /// world is the one returned by GetWorld once the episode id changes.
+    void LoadWorldAsync(std::string map_name, std::vector<std::string> preload_assets = {}) const {
+      _simulator->LoadEpisodeAsync(std::move(map_name), std::move(preload_assets));
+    }
+
+    rpc::MapLoadProgress GetMapLoadProgress() const {
+      return _simulator->GetMapLoadProgress();
+    }
+
+    /// Start a new episode in the current map without reloading it: the
+    /// actors spawned are destroyed and the weather, the traffic lights and
+    /// the elapsed time are reset, but the settings are kept. In synchronous
+    /// mode this ticks the world once.
+    World ResetWorld() const {
+      return World{_simulator->ResetEpisode()};
+    }
+
     /// Return an instance of the world currently active in the simulator.
     World GetWorld() const {
       return World{_simulator->GetCurrentEpisode()};
@@ -80,6 +158,20 @@ namespace client {
       return _simulator->ShowRecorderActorsBlocked(name, min_time, min_distance);
     }
 
+    /// Same as ShowRecorderFileInfo, with the events of each frame instead of
+    /// a text report.
+    rpc::RecorderFileInfo GetRecorderFileInfo(std::string name) {
+      return _simulator->GetRecorderFileInfo(name);
+    }
+
+    rpc::RecorderCollisions GetRecorderCollisions(std::string name, char type1, char type2) {
+      return _simulator->GetRecorderCollisions(name, type1, type2);
+    }
+
+    rpc::RecorderBlockedActors GetRecorderActorsBlocked(std::string name, double min_time, double min_distance) {
+      return _simulator->GetRecorderActorsBlocked(name, min_time, min_distance);
+    }
+
     std::string ReplayFile(std::string name, double start, double duration, uint32_t follow_id) {
       return _simulator->ReplayFile(name, start, duration, follow_id);
     }
@@ -88,6 +180,35 @@ namespace client {
       _simulator->SetReplayerTimeFactor(time_factor);
     }
 
+    void SetReplayerInterpolation(bool enabled) {
+      _simulator->SetReplayerInterpolation(enabled);
+    }
+
+    /// Advance exactly one recorded frame on each tick of the world, requires
+    /// synchronous mode with a fixed delta.
+    void SetReplayerFrameByFrame(bool enabled) {
+      _simulator->SetReplayerFrameByFrame(enabled);
+    }
+
+    /// Id of the actor replaying the actor recorded with @a recorded_id, 0 if
+    /// there is none.
+    ActorId GetReplayerActorId(ActorId recorded_id) {
+      return _simulator->GetReplayerActorId(recorded_id);
+    }
+
+    void SetRecorderKeyFrameInterval(double seconds) {
+      _simulator->SetRecorderKeyFrameInterval(seconds);
+    }
+
+    void SetRecorderCompression(bool enabled) {
+      _simulator->SetRecorderCompression(enabled);
+    }
+
+    /// Set the actors sampled by the next recordings and how often.
+    void SetRecorderFilter(const rpc::RecorderFilter &filter) {
+      _simulator->SetRecorderFilter(filter);
+    }
+
     void ApplyBatch(
         std::vector<rpc::Command> commands,
         bool do_tick_cue = false) const {
@@ -100,6 +221,35 @@ namespace client {
       return _simulator->ApplyBatchSync(std::move(commands), do_tick_cue);
     }
 
+    /// Apply the controls of many vehicles at once, much faster than a batch
+    /// of Command::ApplyVehicleControl. Does not wait for the response,
+    /// controls of actors that are not vehicles are ignored.
+    void ApplyVehicleControlBatch(const rpc::VehicleControlBatch &batch) const {
+      _simulator->ApplyVehicleControlBatch(batch);
+    }
+
+    /// Move many actors at once, much faster than a batch of
+    /// Command::ApplyTransform. The actors are teleported without sweeping,
+    /// make them kinematic with Actor::SetKinematic so moving them doesn't
+    /// update their overlaps either. Does not wait for the response.
+    void ApplyTransformBatch(const rpc::TransformBatch &batch) const {
+      _simulator->ApplyTransformBatch(batch);
+    }
+
+    /// Register the bones named @a bone_names in the server, once per
+    /// skeleton. Returns the id of the bone set, the index of each bone is
+    /// its position in @a bone_names.
+    uint32_t RegisterWalkerBones(const std::vector<std::string> &bone_names) const {
+      return _simulator->RegisterWalkerBones(bone_names);
+    }
+
+    /// Set the bones of many walkers at once, much faster than a
+    /// WalkerBoneControl per walker. Does not wait for the response, walkers
+    /// not found and bones not in their skeleton are ignored.
+    void ApplyWalkerBoneControlBatch(const rpc::WalkerBoneControlBatch &batch) const {
+      _simulator->ApplyWalkerBoneControlBatch(batch);
+    }
+
   private:
 
     std::shared_ptr<detail::Simulator> _simulator;
@@ -108,9 +258,10 @@ namespace client {
   inline Client::Client(
       const std::string &host,
       uint16_t port,
-      size_t worker_threads)
+      size_t worker_threads,
+      size_t rpc_connections)
     : _simulator(
-        new detail::Simulator(host, port, worker_threads),
+        new detail::Simulator(host, port, worker_threads, false, rpc_connections),
         PythonUtil::ReleaseGILDeleter()) {}
 
 } // namespace client
@@ -81,5 +81,9 @@ namespace client {
     DrawShape(_episode, string, color, life_time, persistent_lines);
   }
 
+  void DebugHelper::Flush() {
+    _episode.Lock()->FlushDebugShapes();
+  }
+
 } // namespace client
 } // namespace carla
@@ -63,6 +63,10 @@ namespace client {
         float life_time = -1.0f,
         bool persistent_lines = true);
 
+    /// Shapes drawn are sent together on the next tick, send now the ones
+    /// drawn so far instead.
+    void Flush();
+
   private:
 
     detail::EpisodeProxy _episode;
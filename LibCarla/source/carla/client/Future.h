@@ -0,0 +1,111 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/Time.h"
+
+#include <boost/optional.hpp>
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+namespace carla {
+namespace client {
+
+  /// Result of a request sent to the simulator without waiting for its
+  /// response, so several requests can be in flight at once. Get() waits for
+  /// the response of this one, up to the timeout of the client that sent it.
+  ///
+  /// Copies share the same result, which is computed only once; Get() may be
+  /// called from any thread.
+  template <typename T>
+  class Future {
+  public:
+
+    /// Waits up to the given time for the response, returns whether it
+    /// arrived.
+    using WaitFunction = std::function<bool(time_duration)>;
+
+    /// Returns the result once the response arrived, throws if the request
+    /// failed or timed out.
+    using GetFunction = std::function<T()>;
+
+    Future(WaitFunction wait_for, GetFunction get)
+      : _state(std::make_shared<State>(std::move(wait_for), std::move(get))) {}
+
+    /// Whether the response already arrived, Get() does not block if so.
+    bool IsReady() const {
+      return WaitFor(time_duration::milliseconds(0u));
+    }
+
+    /// Wait up to @a timeout for the response, return whether it arrived.
+    bool WaitFor(time_duration timeout) const {
+      DEBUG_ASSERT(_state != nullptr);
+      return _state->wait_for(timeout);
+    }
+
+    /// Wait for the response and return the result. Throws the exception of
+    /// the request if it failed, every time it is called.
+    const T &Get() const {
+      DEBUG_ASSERT(_state != nullptr);
+      std::lock_guard<std::mutex> lock(_state->mutex);
+      if (!_state->value && (_state->error == nullptr)) {
+        try {
+          _state->value = _state->get();
+        } catch (...) {
+          _state->error = std::current_exception();
+        }
+        _state->get = nullptr;
+      }
+      if (_state->error != nullptr) {
+        std::rethrow_exception(_state->error);
+      }
+      return *_state->value;
+    }
+
+    /// Future of the result of @a functor applied to the result of this one.
+    /// @a functor is called on the thread that calls Get() on the returned
+    /// future.
+    template <typename F>
+    auto Then(F &&functor) const {
+      using R = std::decay_t<decltype(functor(std::declval<const T &>()))>;
+      auto state = _state;
+      return Future<R>(
+          [state](time_duration timeout) { return state->wait_for(timeout); },
+          [self = *this, functor = std::forward<F>(functor)]() -> R {
+            return functor(self.Get());
+          });
+    }
+
+  private:
+
+    struct State {
+      State(WaitFunction wait, GetFunction get_result)
+        : wait_for(std::move(wait)),
+          get(std::move(get_result)) {}
+
+      const WaitFunction wait_for;
+
+      std::mutex mutex;
+
+      GetFunction get;
+
+      boost::optional<T> value;
+
+      std::exception_ptr error;
+    };
+
+    std::shared_ptr<State> _state;
+  };
+
+} // namespace client
+} // namespace carla
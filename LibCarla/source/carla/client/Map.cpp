@@ -6,28 +6,106 @@
 
 #include "carla/client/Map.h"
 
+#include "carla/client/SpawnPointIndex.h"
 #include "carla/client/Waypoint.h"
+#include "carla/client/WorldSnapshot.h"
+#include "carla/FileSystem.h"
 #include "carla/opendrive/OpenDriveParser.h"
+#include "carla/road/CompiledMap.h"
 #include "carla/road/Map.h"
 #include "carla/road/RoadTypes.h"
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <random>
 #include <sstream>
+#include <stdexcept>
 
 namespace carla {
 namespace client {
 
-  static auto MakeMap(const std::string &opendrive_contents) {
+  static std::mutex CACHE_FOLDER_MUTEX;
+
+  static std::string CACHE_FOLDER;
+
+  static std::atomic<Map::LoadProfile> LOAD_PROFILE{Map::LoadProfile::Full};
+
+  static road::Map ParseMap(const std::string &opendrive_contents, const Map::LoadProfile profile) {
     auto stream = std::istringstream(opendrive_contents);
-    auto map = opendrive::OpenDriveParser::Load(stream.str());
+    auto map = opendrive::OpenDriveParser::Load(stream.str(), profile);
     if (!map.has_value()) {
       throw_exception(std::runtime_error("failed to generate map"));
     }
     return std::move(*map);
   }
 
+  /// The image is mapped read-only instead of copied, all the processes
+  /// loading it share the same physical copy.
+  static boost::optional<road::Map> ReadCompiledMap(const std::string &path, const uint64_t hash) {
+    namespace bip = boost::interprocess;
+    try {
+      const bip::file_mapping file(path.c_str(), bip::read_only);
+      const bip::mapped_region region(file, bip::read_only);
+      return road::CompiledMap::Load(
+          static_cast<const unsigned char *>(region.get_address()),
+          region.get_size(),
+          hash);
+    } catch (const bip::interprocess_exception &) {
+      // Missing or empty, it is compiled again.
+      return {};
+    }
+  }
+
+  /// Written to a temporary file first, other processes may be reading or
+  /// writing the same map.
+  static void WriteCompiledMap(const std::string &path, const std::vector<unsigned char> &image) {
+    const auto temp_path = path + "." + std::to_string(std::random_device{}()) + ".tmp";
+    {
+      std::ofstream file(temp_path, std::ios::binary);
+      file.write(reinterpret_cast<const char *>(image.data()), static_cast<std::streamsize>(image.size()));
+      if (!file) {
+        file.close();
+        std::remove(temp_path.c_str());
+        return;
+      }
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+      std::remove(temp_path.c_str());
+    }
+  }
+
+  static road::Map MakeMap(const std::string &opendrive_contents, const Map::LoadProfile profile) {
+    const auto folder = Map::GetCacheFolder();
+    if (folder.empty()) {
+      return ParseMap(opendrive_contents, profile);
+    }
+    // The images of each profile are cached apart.
+    auto hash = road::CompiledMap::Hash(opendrive_contents);
+    if (profile != Map::LoadProfile::Full) {
+      hash ^= 0x9e3779b97f4a7c15ull * static_cast<uint64_t>(profile);
+    }
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << hash << ".cmap";
+    auto path = folder + "/" + name.str();
+    FileSystem::ValidateFilePath(path);
+    auto compiled = ReadCompiledMap(path, hash);
+    if (compiled.has_value()) {
+      return std::move(*compiled);
+    }
+    auto map = ParseMap(opendrive_contents, profile);
+    WriteCompiledMap(path, road::CompiledMap::Compile(map, hash));
+    return map;
+  }
+
   Map::Map(rpc::MapInfo description)
     : _description(std::move(description)),
-      _map(MakeMap(_description.open_drive_file)) {}
+      _load_profile(GetLoadProfile()),
+      _map(MakeMap(_description.open_drive_file, _load_profile)) {}
 
   Map::Map(std::string name, std::string xodr_content)
     : Map(rpc::MapInfo{
@@ -37,6 +115,43 @@ namespace client {
 
   Map::~Map() = default;
 
+  void Map::SetCacheFolder(std::string folder) {
+    std::lock_guard<std::mutex> lock(CACHE_FOLDER_MUTEX);
+    CACHE_FOLDER = std::move(folder);
+  }
+
+  std::string Map::GetCacheFolder() {
+    std::lock_guard<std::mutex> lock(CACHE_FOLDER_MUTEX);
+    return CACHE_FOLDER;
+  }
+
+  void Map::SetLoadProfile(const LoadProfile profile) {
+    LOAD_PROFILE = profile;
+  }
+
+  Map::LoadProfile Map::GetLoadProfile() {
+    return LOAD_PROFILE;
+  }
+
+  const road::Map &Map::GetFullMap() const {
+    if (_load_profile == LoadProfile::Full) {
+      return _map;
+    }
+    std::call_once(_full_map_flag, [this]() {
+      _full_map = std::make_unique<const road::Map>(
+          MakeMap(_description.open_drive_file, LoadProfile::Full));
+    });
+    return *_full_map;
+  }
+
+  std::vector<geom::Transform> Map::GetFreeSpawnPoints(
+      const WorldSnapshot &snapshot,
+      const size_t count,
+      const float min_distance) const {
+    SpawnPointIndex index{snapshot, min_distance};
+    return index.TakeFree(GetRecommendedSpawnPoints(), count);
+  }
+
   SharedPtr<Waypoint> Map::GetWaypoint(
       const geom::Location &location,
       bool project_to_road,
@@ -52,6 +167,59 @@ namespace client {
         nullptr;
   }
 
+  std::vector<SharedPtr<Waypoint>> Map::GetWaypoints(
+      const std::vector<geom::Location> &locations,
+      bool project_to_road,
+      uint32_t lane_type) const {
+    const auto waypoints = project_to_road ?
+        _map.GetClosestWaypointsOnRoad(locations, lane_type) :
+        _map.GetWaypoints(locations, lane_type);
+    std::vector<SharedPtr<Waypoint>> result;
+    result.reserve(waypoints.size());
+    for (const auto &waypoint : waypoints) {
+      result.emplace_back(waypoint.has_value() ?
+          SharedPtr<Waypoint>(new Waypoint{shared_from_this(), *waypoint}) :
+          nullptr);
+    }
+    return result;
+  }
+
+  SharedPtr<Waypoint> Map::MakeWaypoint(const road::element::Waypoint &waypoint) const {
+    return SharedPtr<Waypoint>(new Waypoint{shared_from_this(), waypoint});
+  }
+
+  Map::WaypointBatch Map::GetNext(
+      const std::vector<SharedPtr<Waypoint>> &waypoints,
+      const std::vector<double> &distances) const {
+    return MakeWaypointBatch(_map.GetNext(GetRoadWaypoints(waypoints), distances));
+  }
+
+  Map::WaypointBatch Map::GetPrevious(
+      const std::vector<SharedPtr<Waypoint>> &waypoints,
+      const std::vector<double> &distances) const {
+    return MakeWaypointBatch(_map.GetPrevious(GetRoadWaypoints(waypoints), distances));
+  }
+
+  void Map::SetTransformCacheResolution(const double resolution) {
+    if (resolution > 0.0) {
+      _transform_cache = std::make_shared<road::element::LaneTransformCache>(_map, resolution);
+    } else {
+      _transform_cache.reset();
+    }
+  }
+
+  double Map::GetTransformCacheResolution() const {
+    const auto cache = _transform_cache.load();
+    return cache != nullptr ? cache->GetResolution() : 0.0;
+  }
+
+  geom::Transform Map::ComputeTransform(const road::element::Waypoint &waypoint) const {
+    const auto cache = _transform_cache.load();
+    return cache != nullptr ?
+        cache->ComputeTransform(waypoint) :
+        _map.ComputeTransform(waypoint);
+  }
+
   Map::TopologyList Map::GetTopology() const {
     namespace re = carla::road::element;
     std::unordered_map<re::Waypoint, SharedPtr<Waypoint>> waypoints;
@@ -66,8 +234,8 @@ namespace client {
       return it->second;
     };
 
+    const auto &topology = GetRoadTopology();
     TopologyList result;
-    auto topology = _map.GenerateTopology();
     result.reserve(topology.size());
     for (const auto &pair : topology) {
       result.emplace_back(
@@ -78,24 +246,173 @@ namespace client {
   }
 
   std::vector<SharedPtr<Waypoint>> Map::GenerateWaypoints(double distance) const {
+    const auto waypoints = GetRoadWaypoints(distance);
     std::vector<SharedPtr<Waypoint>> result;
-    const auto waypoints = _map.GenerateWaypoints(distance);
-    result.reserve(waypoints.size());
-    for (const auto &waypoint : waypoints) {
+    result.reserve(waypoints->size());
+    for (const auto &waypoint : *waypoints) {
       result.emplace_back(SharedPtr<Waypoint>(new Waypoint{shared_from_this(), waypoint}));
     }
     return result;
   }
 
+  WaypointHandle Map::MakeHandle(const Waypoint &waypoint) const {
+    return WaypointHandle(*this, GetRoadWaypoint(waypoint));
+  }
+
+  WaypointHandleList Map::GetNext(
+      const WaypointHandleList &handles,
+      const std::vector<double> &distances) const {
+    return MakeHandleList(_map.GetNext(GetRoadWaypoints(handles), distances));
+  }
+
+  WaypointHandleList Map::GetPrevious(
+      const WaypointHandleList &handles,
+      const std::vector<double> &distances) const {
+    return MakeHandleList(_map.GetPrevious(GetRoadWaypoints(handles), distances));
+  }
+
+  WaypointHandleList Map::GetTopologyHandles() const {
+    const auto &topology = GetRoadTopology();
+    WaypointHandleList result(shared_from_this());
+    result.reserve(2u * topology.size());
+    for (const auto &pair : topology) {
+      result.emplace_back(pair.first);
+      result.emplace_back(pair.second);
+    }
+    return result;
+  }
+
+  WaypointHandleList Map::GenerateWaypointHandles(double distance) const {
+    return MakeHandleList(*GetRoadWaypoints(distance));
+  }
+
+  WaypointHandleList Map::ComputeRoute(
+      const WaypointHandle &origin,
+      const WaypointHandle &destination) const {
+    return MakeHandleList(GetRoutePlanner().ComputeRoute(
+        GetRoadWaypoint(origin),
+        GetRoadWaypoint(destination)));
+  }
+
   std::vector<road::element::LaneMarking> Map::CalculateCrossedLanes(
       const geom::Location &origin,
       const geom::Location &destination) const {
-    return _map.CalculateCrossedLanes(origin, destination);
+    return GetLaneMarkingIndex().CalculateCrossedLanes(origin, destination);
+  }
+
+  const road::element::LaneMarkingIndex &Map::GetLaneMarkingIndex() const {
+    std::call_once(_lane_marking_index_flag, [this]() {
+      _lane_marking_index = std::make_unique<road::element::LaneMarkingIndex>(_map);
+    });
+    return *_lane_marking_index;
+  }
+
+  std::vector<SharedPtr<Waypoint>> Map::ComputeRoute(
+      const Waypoint &origin,
+      const Waypoint &destination) const {
+    const auto route = GetRoutePlanner().ComputeRoute(
+        GetRoadWaypoint(origin),
+        GetRoadWaypoint(destination));
+    std::vector<SharedPtr<Waypoint>> result;
+    result.reserve(route.size());
+    for (const auto &waypoint : route) {
+      result.emplace_back(SharedPtr<Waypoint>(new Waypoint{shared_from_this(), waypoint}));
+    }
+    return result;
+  }
+
+  const road::RoutePlanner &Map::GetRoutePlanner() const {
+    std::call_once(_route_planner_flag, [this]() {
+      _route_planner = std::make_unique<road::RoutePlanner>(_map);
+    });
+    return *_route_planner;
   }
 
   const geom::GeoLocation &Map::GetGeoReference() const {
     return _map.GetGeoReference();
   }
 
+  const road::element::Waypoint &Map::GetRoadWaypoint(const Waypoint &waypoint) const {
+    if (waypoint._parent.get() != this) {
+      throw_exception(std::invalid_argument("waypoint not of this map"));
+    }
+    return waypoint._waypoint;
+  }
+
+  const road::element::Waypoint &Map::GetRoadWaypoint(const WaypointHandle &handle) const {
+    if (&handle.GetMap() != this) {
+      throw_exception(std::invalid_argument("waypoint not of this map"));
+    }
+    return handle.GetRoadWaypoint();
+  }
+
+  std::vector<road::element::Waypoint> Map::GetRoadWaypoints(
+      const std::vector<SharedPtr<Waypoint>> &waypoints) const {
+    std::vector<road::element::Waypoint> result;
+    result.reserve(waypoints.size());
+    for (const auto &waypoint : waypoints) {
+      if (waypoint == nullptr) {
+        throw_exception(std::invalid_argument("waypoint not of this map"));
+      }
+      result.emplace_back(GetRoadWaypoint(*waypoint));
+    }
+    return result;
+  }
+
+  Map::WaypointBatch Map::MakeWaypointBatch(road::Map::WaypointBatch batch) const {
+    WaypointBatch result;
+    result.waypoints.reserve(batch.waypoints.size());
+    for (const auto &waypoint : batch.waypoints) {
+      result.waypoints.emplace_back(SharedPtr<Waypoint>(new Waypoint{shared_from_this(), waypoint}));
+    }
+    result.offsets = std::move(batch.offsets);
+    return result;
+  }
+
+  std::vector<road::element::Waypoint> Map::GetRoadWaypoints(const WaypointHandleList &handles) const {
+    std::vector<road::element::Waypoint> result;
+    result.reserve(handles.size());
+    for (const auto &handle : handles) {
+      result.emplace_back(GetRoadWaypoint(handle));
+    }
+    return result;
+  }
+
+  WaypointHandleList Map::MakeHandleList(const std::vector<road::element::Waypoint> &waypoints) const {
+    WaypointHandleList result(shared_from_this());
+    result.reserve(waypoints.size());
+    for (const auto &waypoint : waypoints) {
+      result.emplace_back(waypoint);
+    }
+    return result;
+  }
+
+  WaypointHandleList Map::MakeHandleList(road::Map::WaypointBatch batch) const {
+    auto result = MakeHandleList(batch.waypoints);
+    result.offsets = std::move(batch.offsets);
+    return result;
+  }
+
+  const std::vector<std::pair<road::element::Waypoint, road::element::Waypoint>> &Map::GetRoadTopology() const {
+    std::call_once(_topology_flag, [this]() {
+      _topology = _map.GenerateTopology();
+    });
+    return _topology;
+  }
+
+  std::shared_ptr<const std::vector<road::element::Waypoint>> Map::GetRoadWaypoints(double distance) const {
+    // Generated under the lock, concurrent calls with the same distance wait
+    // instead of generating them again.
+    std::lock_guard<std::mutex> lock(_waypoints_mutex);
+    auto it = _waypoints.find(distance);
+    if (it == _waypoints.end()) {
+      it = _waypoints.emplace(
+          distance,
+          std::make_shared<const std::vector<road::element::Waypoint>>(
+              _map.GenerateWaypoints(distance))).first;
+    }
+    return it->second;
+  }
+
 } // namespace client
 } // namespace carla
@@ -6,20 +6,32 @@
 
 #pragma once
 
+#include "carla/AtomicSharedPtr.h"
 #include "carla/Memory.h"
 #include "carla/NonCopyable.h"
+#include "carla/client/WaypointHandle.h"
+#include "carla/opendrive/OpenDriveParser.h"
 #include "carla/road/Map.h"
+#include "carla/road/RoutePlanner.h"
 #include "carla/road/element/LaneMarking.h"
+#include "carla/road/element/LaneMarkingIndex.h"
+#include "carla/road/element/LaneTransformCache.h"
 #include "carla/rpc/MapInfo.h"
 #include "carla/road/Lane.h"
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace carla {
 namespace geom { class GeoLocation; }
 namespace client {
 
   class Waypoint;
+  class WorldSnapshot;
 
   class Map
     : public EnableSharedFromThis<Map>,
@@ -32,14 +44,42 @@ namespace client {
 
     ~Map();
 
+    /// Folder where the maps are cached compiled, by hash of their OpenDRIVE
+    /// contents, so loading the same contents again skips the parsing. Empty,
+    /// the default, disables the cache. Only the maps created afterwards are
+    /// affected.
+    ///
+    /// The images are mapped read-only, the processes loading the same map
+    /// share one physical copy of its image; on a memory-backed folder like
+    /// /dev/shm it is never written to disk.
+    static void SetCacheFolder(std::string folder);
+
+    static std::string GetCacheFolder();
+
+    using LoadProfile = opendrive::OpenDriveParser::Profile;
+
+    /// Parts of the OpenDRIVE file parsed by the maps created afterwards,
+    /// Full by default. The workers that only drive along the lanes load
+    /// faster and take less memory with the Driving profile, the rest is
+    /// parsed the first time GetFullMap is called.
+    static void SetLoadProfile(LoadProfile profile);
+
+    static LoadProfile GetLoadProfile();
+
     const std::string &GetName() const {
       return _description.name;
     }
 
+    /// The map loaded with the profile set when this was created.
     const road::Map &GetMap() const {
       return _map;
     }
 
+    /// The map with everything parsed, the same as GetMap with the Full
+    /// profile. With any other, the first call parses the OpenDRIVE file
+    /// again, and the map is kept apart.
+    const road::Map &GetFullMap() const;
+
     const std::string &GetOpenDrive() const {
       return _description.open_drive_file;
     }
@@ -48,28 +88,181 @@ namespace client {
       return _description.recommended_spawn_points;
     }
 
+    /// Return up to @a count of the recommended spawn points at least @a
+    /// min_distance metres away of every actor of @a snapshot and of each
+    /// other, see SpawnPointIndex. Spawning at them does not fail unless
+    /// actors moved there since the snapshot.
+    std::vector<geom::Transform> GetFreeSpawnPoints(
+        const WorldSnapshot &snapshot,
+        size_t count,
+        float min_distance) const;
+
     SharedPtr<Waypoint> GetWaypoint(
         const geom::Location &location,
         bool project_to_road = true,
         uint32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
 
+    /// Same as GetWaypoint for each of @a locations, the waypoints not found
+    /// are nullptr.
+    std::vector<SharedPtr<Waypoint>> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        bool project_to_road = true,
+        uint32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
+
+    /// Create the waypoint at the given road coordinates. @a waypoint must
+    /// describe a valid point of this map, e.g. one taken from a waypoint
+    /// previously returned by it.
+    SharedPtr<Waypoint> MakeWaypoint(const road::element::Waypoint &waypoint) const;
+
+    /// Interpolate the transforms of the waypoints created from now on
+    /// between samples of their lanes taken every @a resolution meters, see
+    /// road::element::LaneTransformCache. The samples of a lane are computed
+    /// the first time they are needed. A resolution of 0 disables the cache,
+    /// the transforms are computed exactly, the default.
+    void SetTransformCacheResolution(double resolution);
+
+    /// Resolution of the transform cache, 0 if disabled.
+    double GetTransformCacheResolution() const;
+
+    /// Transform of @a waypoint, interpolated if the transform cache is
+    /// enabled.
+    geom::Transform ComputeTransform(const road::element::Waypoint &waypoint) const;
+
     using TopologyList = std::vector<std::pair<SharedPtr<Waypoint>, SharedPtr<Waypoint>>>;
 
+    /// The waypoints found for each of a batch of waypoints, in a single
+    /// list, see road::Map::WaypointBatch.
+    struct WaypointBatch {
+      std::vector<SharedPtr<Waypoint>> waypoints;
+      std::vector<size_t> offsets;
+    };
+
+    /// Same as Waypoint::GetNext for each of @a waypoints, at the distance of
+    /// the same index in @a distances, in a single call. The waypoints must
+    /// be of this map.
+    WaypointBatch GetNext(
+        const std::vector<SharedPtr<Waypoint>> &waypoints,
+        const std::vector<double> &distances) const;
+
+    /// Same as GetNext with Waypoint::GetPrevious.
+    WaypointBatch GetPrevious(
+        const std::vector<SharedPtr<Waypoint>> &waypoints,
+        const std::vector<double> &distances) const;
+
+    /// The topology is generated the first call, later calls reuse it.
     TopologyList GetTopology() const;
 
+    /// The waypoints of each @a distance are generated the first call with
+    /// it, later calls with the same distance reuse them.
     std::vector<SharedPtr<Waypoint>> GenerateWaypoints(double distance) const;
 
+    /// @name Waypoint handles
+    ///
+    /// Same as the queries above returning WaypointHandle values in a single
+    /// array instead of a client::Waypoint allocated for each point, for the
+    /// queries producing many of them. The handles passed must be of this
+    /// map.
+    /// @{
+
+    /// The handle of @a waypoint, that must be of this map.
+    WaypointHandle MakeHandle(const Waypoint &waypoint) const;
+
+    WaypointHandleList GetNext(
+        const WaypointHandleList &handles,
+        const std::vector<double> &distances) const;
+
+    WaypointHandleList GetPrevious(
+        const WaypointHandleList &handles,
+        const std::vector<double> &distances) const;
+
+    /// The segment i goes from the handle 2i to the handle 2i + 1.
+    WaypointHandleList GetTopologyHandles() const;
+
+    WaypointHandleList GenerateWaypointHandles(double distance) const;
+
+    WaypointHandleList ComputeRoute(
+        const WaypointHandle &origin,
+        const WaypointHandle &destination) const;
+
+    /// @}
+
+    /// Return the lane markings crossed moving from @a origin to
+    /// @a destination. The first call builds the lane marking index of the
+    /// map.
     std::vector<road::element::LaneMarking> CalculateCrossedLanes(
         const geom::Location &origin,
         const geom::Location &destination) const;
 
+    const road::element::LaneMarkingIndex &GetLaneMarkingIndex() const;
+
+    /// Return the route from @a origin to @a destination, both waypoints of
+    /// this map, see road::RoutePlanner. The first call builds the lane graph
+    /// of the map.
+    std::vector<SharedPtr<Waypoint>> ComputeRoute(
+        const Waypoint &origin,
+        const Waypoint &destination) const;
+
+    const road::RoutePlanner &GetRoutePlanner() const;
+
     const geom::GeoLocation &GetGeoReference() const;
 
+    const geom::GeoProjection &GetGeoProjection() const {
+      return _map.GetGeoProjection();
+    }
+
   private:
 
+    const road::element::Waypoint &GetRoadWaypoint(const Waypoint &waypoint) const;
+
+    const road::element::Waypoint &GetRoadWaypoint(const WaypointHandle &handle) const;
+
+    std::vector<road::element::Waypoint> GetRoadWaypoints(
+        const std::vector<SharedPtr<Waypoint>> &waypoints) const;
+
+    std::vector<road::element::Waypoint> GetRoadWaypoints(const WaypointHandleList &handles) const;
+
+    WaypointBatch MakeWaypointBatch(road::Map::WaypointBatch batch) const;
+
+    WaypointHandleList MakeHandleList(const std::vector<road::element::Waypoint> &waypoints) const;
+
+    WaypointHandleList MakeHandleList(road::Map::WaypointBatch batch) const;
+
+    const std::vector<std::pair<road::element::Waypoint, road::element::Waypoint>> &GetRoadTopology() const;
+
+    std::shared_ptr<const std::vector<road::element::Waypoint>> GetRoadWaypoints(double distance) const;
+
     const rpc::MapInfo _description;
 
+    const LoadProfile _load_profile;
+
     const road::Map _map;
+
+    mutable std::once_flag _full_map_flag;
+
+    mutable std::unique_ptr<const road::Map> _full_map;
+
+    mutable std::once_flag _lane_marking_index_flag;
+
+    mutable std::unique_ptr<const road::element::LaneMarkingIndex> _lane_marking_index;
+
+    mutable std::once_flag _route_planner_flag;
+
+    mutable std::unique_ptr<const road::RoutePlanner> _route_planner;
+
+    AtomicSharedPtr<const road::element::LaneTransformCache> _transform_cache;
+
+    // The road waypoints are kept and not the client ones, these keep the map
+    // alive.
+
+    mutable std::once_flag _topology_flag;
+
+    mutable std::vector<std::pair<road::element::Waypoint, road::element::Waypoint>> _topology;
+
+    mutable std::mutex _waypoints_mutex;
+
+    mutable std::unordered_map<
+        double,
+        std::shared_ptr<const std::vector<road::element::Waypoint>>> _waypoints;
   };
 
 } // namespace client
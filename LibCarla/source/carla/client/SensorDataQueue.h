@@ -0,0 +1,129 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/Time.h"
+#include "carla/sensor/SensorData.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace carla {
+namespace client {
+
+  /// Bounded FIFO of sensor data, meant to be filled by a sensor's callback on
+  /// the streaming threads and emptied by the user whenever it is ready. Unlike
+  /// a Python callback, pushing does not need the GIL.
+  class SensorDataQueue : private NonCopyable {
+  public:
+
+    using value_type = SharedPtr<sensor::SensorData>;
+
+    /// @param max_size maximum number of items kept, 0 means unbounded.
+    /// @param drop_oldest whether a push to a full queue discards the oldest
+    /// item, otherwise the new item is discarded.
+    explicit SensorDataQueue(size_t max_size = 0u, bool drop_oldest = true)
+      : _max_size(max_size),
+        _drop_oldest(drop_oldest) {}
+
+    /// Add @a data at the end of the queue, never blocks.
+    void Push(value_type data) {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if ((_max_size > 0u) && (_queue.size() >= _max_size)) {
+          ++_number_of_dropped_items;
+          if (!_drop_oldest) {
+            return;
+          }
+          _queue.pop_front();
+        }
+        _queue.emplace_back(std::move(data));
+      }
+      _not_empty.notify_all();
+    }
+
+    /// Take the oldest item, waiting up to @a timeout for one to arrive.
+    ///
+    /// @return nullptr if the timeout is met.
+    value_type Pop(time_duration timeout) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      if (!_not_empty.wait_for(lock, timeout.to_chrono(), [this]() { return !_queue.empty(); })) {
+        return nullptr;
+      }
+      return PopFront();
+    }
+
+    /// Take the item generated at @a frame, discarding the older ones and
+    /// waiting up to @a timeout for it to arrive.
+    ///
+    /// @return nullptr if the timeout is met or if the item of that frame was
+    /// dropped, i.e. a newer one is already in the queue.
+    value_type PopFrame(size_t frame, time_duration timeout) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      auto has_frame = [&]() {
+        while (!_queue.empty() && (_queue.front()->GetFrame() < frame)) {
+          _queue.pop_front();
+        }
+        return !_queue.empty();
+      };
+      if (!_not_empty.wait_for(lock, timeout.to_chrono(), has_frame) ||
+          (_queue.front()->GetFrame() != frame)) {
+        return nullptr;
+      }
+      return PopFront();
+    }
+
+    size_t size() const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _queue.size();
+    }
+
+    bool empty() const {
+      return size() == 0u;
+    }
+
+    void Clear() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _queue.clear();
+    }
+
+    size_t GetMaxSize() const {
+      return _max_size;
+    }
+
+    /// Number of items discarded so far because the queue was full.
+    size_t GetNumberOfDroppedItems() const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _number_of_dropped_items;
+    }
+
+  private:
+
+    value_type PopFront() {
+      auto data = std::move(_queue.front());
+      _queue.pop_front();
+      return data;
+    }
+
+    const size_t _max_size;
+
+    const bool _drop_oldest;
+
+    mutable std::mutex _mutex;
+
+    std::condition_variable _not_empty;
+
+    std::deque<value_type> _queue;
+
+    size_t _number_of_dropped_items = 0u;
+  };
+
+} // namespace client
+} // namespace carla
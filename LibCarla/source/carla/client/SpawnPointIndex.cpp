@@ -0,0 +1,101 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/SpawnPointIndex.h"
+
+#include "carla/client/WorldSnapshot.h"
+#include "carla/geom/Math.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace carla {
+namespace client {
+
+  /// Cells smaller than this would be too many to be worth it.
+  static constexpr float MIN_CELL_SIZE = 1.0f;
+
+  SpawnPointIndex::SpawnPointIndex(const float min_distance)
+    : _cell_size(std::max(min_distance, MIN_CELL_SIZE)),
+      _min_distance_squared(min_distance > 0.0f ? min_distance * min_distance : 0.0f) {}
+
+  SpawnPointIndex::SpawnPointIndex(const WorldSnapshot &snapshot, const float min_distance)
+    : SpawnPointIndex(min_distance) {
+    _cells.reserve(snapshot.size());
+    for (const auto &actor : snapshot) {
+      Add(actor.transform.location);
+    }
+  }
+
+  SpawnPointIndex::SpawnPointIndex(
+      const std::vector<geom::Location> &locations,
+      const float min_distance)
+    : SpawnPointIndex(min_distance) {
+    _cells.reserve(locations.size());
+    for (const auto &location : locations) {
+      Add(location);
+    }
+  }
+
+  bool SpawnPointIndex::IsFree(const geom::Location &location) const {
+    if ((_min_distance_squared <= 0.0f) || _cells.empty()) {
+      return true;
+    }
+    // The cells are at least as large as the distance, only the ones around
+    // can be closer.
+    const auto x = GetCell(location.x);
+    const auto y = GetCell(location.y);
+    for (auto i = x - 1; i <= x + 1; ++i) {
+      for (auto j = y - 1; j <= y + 1; ++j) {
+        const auto it = _cells.find(MakeKey(i, j));
+        if (it == _cells.end()) {
+          continue;
+        }
+        for (const auto &actor : it->second) {
+          if (geom::Math::DistanceSquared(actor, location) < _min_distance_squared) {
+            return false;
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  void SpawnPointIndex::Add(const geom::Location &location) {
+    _cells[MakeKey(GetCell(location.x), GetCell(location.y))].emplace_back(location);
+    ++_size;
+  }
+
+  std::vector<geom::Transform> SpawnPointIndex::TakeFree(
+      const std::vector<geom::Transform> &spawn_points,
+      const size_t count) {
+    std::vector<geom::Transform> result;
+    result.reserve(std::min(count, spawn_points.size()));
+    for (const auto &spawn_point : spawn_points) {
+      if (result.size() >= count) {
+        break;
+      }
+      if (IsFree(spawn_point.location)) {
+        result.emplace_back(spawn_point);
+        Add(spawn_point.location);
+      }
+    }
+    return result;
+  }
+
+  int32_t SpawnPointIndex::GetCell(const float coordinate) const {
+    // Far beyond any map, clamped so the neighbours don't overflow.
+    constexpr auto limit = static_cast<float>(std::numeric_limits<int32_t>::max() / 2);
+    return static_cast<int32_t>(std::floor(std::max(-limit, std::min(coordinate / _cell_size, limit))));
+  }
+
+  SpawnPointIndex::Key SpawnPointIndex::MakeKey(const int32_t x, const int32_t y) {
+    return (static_cast<Key>(static_cast<uint32_t>(x)) << 32u) | static_cast<uint32_t>(y);
+  }
+
+} // namespace client
+} // namespace carla
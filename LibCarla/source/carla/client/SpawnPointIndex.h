@@ -0,0 +1,76 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/Location.h"
+#include "carla/geom/Transform.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace client {
+
+  class WorldSnapshot;
+
+  /// Locations of the actors of a world hashed in a grid of cells as large
+  /// as the clearance asked for, so a spawn point is tested only against the
+  /// actors in the cells around it. Used to pick many spawn points free of
+  /// actors at once, instead of spawning and retrying on the occupied ones.
+  ///
+  /// Every actor counts, whatever its type, and the distance is measured
+  /// between locations, the size of the actors is not taken into account.
+  class SpawnPointIndex {
+  public:
+
+    /// Index the actors of @a snapshot, the spawn points are free if they are
+    /// at least @a min_distance metres away of any of them.
+    SpawnPointIndex(const WorldSnapshot &snapshot, float min_distance);
+
+    /// Index the actors at @a locations.
+    SpawnPointIndex(const std::vector<geom::Location> &locations, float min_distance);
+
+    /// Whether @a location is at least the minimum distance away of every
+    /// actor indexed.
+    bool IsFree(const geom::Location &location) const;
+
+    /// Index an actor at @a location.
+    void Add(const geom::Location &location);
+
+    /// Return up to @a count of @a spawn_points free of actors, in the same
+    /// order. Each one returned is indexed, so they are also at the minimum
+    /// distance of each other.
+    std::vector<geom::Transform> TakeFree(
+        const std::vector<geom::Transform> &spawn_points,
+        size_t count);
+
+    size_t size() const {
+      return _size;
+    }
+
+  private:
+
+    using Key = uint64_t;
+
+    explicit SpawnPointIndex(float min_distance);
+
+    int32_t GetCell(float coordinate) const;
+
+    static Key MakeKey(int32_t x, int32_t y);
+
+    const float _cell_size;
+
+    const float _min_distance_squared;
+
+    std::unordered_map<Key, std::vector<geom::Location>> _cells;
+
+    size_t _size = 0u;
+  };
+
+} // namespace client
+} // namespace carla
@@ -70,5 +70,17 @@ namespace client {
     return result;
   }
 
+  Future<std::vector<SharedPtr<TrafficLight>>> TrafficLight::GetGroupTrafficLightsAsync() {
+    auto future = GetEpisode().Lock()->GetGroupTrafficLightsAsync(*this);
+    return future.Then([world = GetWorld()](const std::vector<ActorId> &ids) {
+      std::vector<SharedPtr<TrafficLight>> result;
+      auto actors = world.GetActors(ids);
+      for (auto id : ids) {
+        result.push_back(boost::static_pointer_cast<TrafficLight>(actors->Find(id)));
+      }
+      return result;
+    });
+  }
+
 } // namespace client
 } // namespace carla
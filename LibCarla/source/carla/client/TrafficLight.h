@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "carla/client/Future.h"
 #include "carla/client/TrafficSign.h"
 #include "carla/rpc/TrafficLightState.h"
 
@@ -59,6 +60,10 @@ namespace client {
     ///
     /// @note This function calls the simulator
     std::vector<SharedPtr<TrafficLight>> GetGroupTrafficLights();
+
+    /// Same as GetGroupTrafficLights but does not wait for the response of
+    /// the simulator.
+    Future<std::vector<SharedPtr<TrafficLight>>> GetGroupTrafficLightsAsync();
   };
 
 } // namespace client
@@ -51,6 +51,10 @@ namespace client {
     return GetEpisode().Lock()->GetVehiclePhysicsControl(*this);
   }
 
+  Future<Vehicle::PhysicsControl> Vehicle::GetPhysicsControlAsync() const {
+    return GetEpisode().Lock()->GetVehiclePhysicsControlAsync(*this);
+  }
+
   float Vehicle::GetSpeedLimit() const {
     return GetEpisode().Lock()->GetActorSnapshot(*this).state.vehicle_data.speed_limit;
   }
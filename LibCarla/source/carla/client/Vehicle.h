@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/client/Actor.h"
+#include "carla/client/Future.h"
 #include "carla/rpc/VehicleControl.h"
 #include "carla/rpc/VehiclePhysicsControl.h"
 #include "carla/rpc/TrafficLightState.h"
@@ -45,6 +46,10 @@ namespace client {
     /// @warning This function does call the simulator.
     PhysicsControl GetPhysicsControl() const;
 
+    /// Same as GetPhysicsControl but does not wait for the response of the
+    /// simulator.
+    Future<PhysicsControl> GetPhysicsControlAsync() const;
+
     /// Return the speed limit currently affecting this vehicle.
     ///
     /// @note This function does not call the simulator, it returns the data
@@ -6,8 +6,11 @@
 
 #include "carla/client/WalkerAIController.h"
 
+#include "carla/Exception.h"
 #include "carla/client/detail/Simulator.h"
 
+#include <stdexcept>
+
 namespace carla {
 namespace client {
 
@@ -15,12 +18,25 @@ namespace client {
     : Actor(std::move(init)) {}
 
   void WalkerAIController::Start() {
-    GetEpisode().Lock()->RegisterAIController(*this);
+    auto episode = GetEpisode().Lock();
+
+    // let the server move the walker if so configured
+    if (episode->GetEpisodeSettings().server_side_navigation) {
+      auto walker = GetParent();
+      if (walker == nullptr) {
+        throw_exception(std::runtime_error(GetDisplayId() + ": not attached to walker"));
+        return;
+      }
+      episode->AddWalkerToServerNavigation(*walker);
+      return;
+    }
+
+    episode->RegisterAIController(*this);
 
     // add the walker in the Recast & Detour
     auto walker = GetParent();
     if (walker != nullptr) {
-      auto nav = GetEpisode().Lock()->GetNavigation();
+      auto nav = episode->GetNavigation();
       if (nav != nullptr) {
         nav->AddWalker(walker->GetId(), walker->GetLocation());
       }
@@ -28,14 +44,15 @@ namespace client {
   }
 
   void WalkerAIController::Stop() {
-    GetEpisode().Lock()->UnregisterAIController(*this);
+    auto episode = GetEpisode().Lock();
+    episode->UnregisterAIController(*this);
 
-    // remove the walker from the Recast & Detour
+    // remove the walker from the Recast & Detour, in the client or the server
     auto walker = GetParent();
     if (walker != nullptr) {
-      auto nav = GetEpisode().Lock()->GetNavigation();
-      if (nav != nullptr) {
-        nav->RemoveWalker(walker->GetId());
+      auto nav = episode->GetNavigation();
+      if ((nav == nullptr) || !nav->RemoveWalker(walker->GetId())) {
+        episode->RemoveWalkerFromServerNavigation(*walker);
       }
     }
   }
@@ -49,30 +66,31 @@ namespace client {
   }
 
   void WalkerAIController::GoToLocation(const carla::geom::Location &destination) {
-    auto nav = GetEpisode().Lock()->GetNavigation();
-    if (nav != nullptr) {
-      auto walker = GetParent();
-      if (walker != nullptr) {
-        if (!nav->SetWalkerTarget(walker->GetId(), destination)) {
-          log_warning("NAV: Failed to set request to go to ", destination.x, destination.y, destination.z);
-        }
-      } else {
-        log_warning("NAV: Failed to set request to go to ", destination.x, destination.y, destination.z, "(parent does not exist)");
+    auto episode = GetEpisode().Lock();
+    auto walker = GetParent();
+    if (walker != nullptr) {
+      auto nav = episode->GetNavigation();
+      // the walker is in the server navigation if not in the client one
+      if (((nav == nullptr) || !nav->SetWalkerTarget(walker->GetId(), destination)) &&
+          !episode->SetWalkerServerNavigationTarget(*walker, destination)) {
+        log_warning("NAV: Failed to set request to go to ", destination.x, destination.y, destination.z);
       }
+    } else {
+      log_warning("NAV: Failed to set request to go to ", destination.x, destination.y, destination.z, "(parent does not exist)");
     }
   }
 
   void WalkerAIController::SetMaxSpeed(const float max_speed) {
-    auto nav = GetEpisode().Lock()->GetNavigation();
-    if (nav != nullptr) {
-      auto walker = GetParent();
-      if (walker != nullptr) {
-        if (!nav->SetWalkerMaxSpeed(walker->GetId(), max_speed)) {
-          log_warning("NAV: failed to set max speed");
-        }
-      } else {
-        log_warning("NAV: failed to set max speed (parent does not exist)");
+    auto episode = GetEpisode().Lock();
+    auto walker = GetParent();
+    if (walker != nullptr) {
+      auto nav = episode->GetNavigation();
+      if (((nav == nullptr) || !nav->SetWalkerMaxSpeed(walker->GetId(), max_speed)) &&
+          !episode->SetWalkerServerNavigationMaxSpeed(*walker, max_speed)) {
+        log_warning("NAV: failed to set max speed");
       }
+    } else {
+      log_warning("NAV: failed to set max speed (parent does not exist)");
     }
   }
 
@@ -67,6 +67,8 @@ namespace client {
 
     std::vector<SharedPtr<Waypoint>> GetNext(double distance) const;
 
+    std::vector<SharedPtr<Waypoint>> GetPrevious(double distance) const;
+
     SharedPtr<Waypoint> GetRight() const;
 
     SharedPtr<Waypoint> GetLeft() const;
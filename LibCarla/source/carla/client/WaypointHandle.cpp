@@ -0,0 +1,63 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/WaypointHandle.h"
+
+#include "carla/client/Map.h"
+#include "carla/client/Waypoint.h"
+
+namespace carla {
+namespace client {
+
+  const geom::Transform &WaypointHandle::GetTransform() const {
+    if (!_transform.has_value()) {
+      _transform = _map->ComputeTransform(_waypoint);
+    }
+    return *_transform;
+  }
+
+  static std::vector<WaypointHandle> MakeHandles(
+      const Map &map,
+      const std::vector<road::element::Waypoint> &waypoints) {
+    std::vector<WaypointHandle> result;
+    result.reserve(waypoints.size());
+    for (const auto &waypoint : waypoints) {
+      result.emplace_back(map, waypoint);
+    }
+    return result;
+  }
+
+  static boost::optional<WaypointHandle> MakeHandle(
+      const Map &map,
+      const boost::optional<road::element::Waypoint> &waypoint) {
+    if (waypoint.has_value()) {
+      return WaypointHandle(map, *waypoint);
+    }
+    return boost::none;
+  }
+
+  std::vector<WaypointHandle> WaypointHandle::GetNext(double distance) const {
+    return MakeHandles(*_map, _map->GetMap().GetNext(_waypoint, distance));
+  }
+
+  std::vector<WaypointHandle> WaypointHandle::GetPrevious(double distance) const {
+    return MakeHandles(*_map, _map->GetMap().GetPrevious(_waypoint, distance));
+  }
+
+  boost::optional<WaypointHandle> WaypointHandle::GetRight() const {
+    return MakeHandle(*_map, _map->GetMap().GetRight(_waypoint));
+  }
+
+  boost::optional<WaypointHandle> WaypointHandle::GetLeft() const {
+    return MakeHandle(*_map, _map->GetMap().GetLeft(_waypoint));
+  }
+
+  SharedPtr<Waypoint> WaypointHandle::MakeWaypoint() const {
+    return _map->MakeWaypoint(_waypoint);
+  }
+
+} // namespace client
+} // namespace carla
@@ -0,0 +1,157 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/geom/Transform.h"
+#include "carla/road/RoadTypes.h"
+#include "carla/road/element/Waypoint.h"
+
+#include <boost/optional.hpp>
+
+#include <vector>
+
+namespace carla {
+namespace client {
+
+  class Map;
+  class Waypoint;
+
+  /// Light value-type counterpart of client::Waypoint: the road coordinates
+  /// of a point and a pointer to its map, with no allocation. The transform
+  /// is computed the first time it is asked and kept.
+  ///
+  /// The handle does not keep the map alive, the lists of handles returned by
+  /// the map do, see WaypointHandleList. Computing the transform the first
+  /// time modifies the handle, a handle shared between threads must not be
+  /// asked for it concurrently.
+  class WaypointHandle {
+  public:
+
+    WaypointHandle(const Map &map, road::element::Waypoint waypoint)
+      : _map(&map),
+        _waypoint(waypoint) {}
+
+    /// Same as Waypoint::GetId.
+    uint64_t GetId() const {
+      return std::hash<road::element::Waypoint>()(_waypoint);
+    }
+
+    road::RoadId GetRoadId() const {
+      return _waypoint.road_id;
+    }
+
+    road::SectionId GetSectionId() const {
+      return _waypoint.section_id;
+    }
+
+    road::LaneId GetLaneId() const {
+      return _waypoint.lane_id;
+    }
+
+    double GetDistance() const {
+      return _waypoint.s;
+    }
+
+    const road::element::Waypoint &GetRoadWaypoint() const {
+      return _waypoint;
+    }
+
+    const Map &GetMap() const {
+      return *_map;
+    }
+
+    const geom::Transform &GetTransform() const;
+
+    std::vector<WaypointHandle> GetNext(double distance) const;
+
+    std::vector<WaypointHandle> GetPrevious(double distance) const;
+
+    boost::optional<WaypointHandle> GetRight() const;
+
+    boost::optional<WaypointHandle> GetLeft() const;
+
+    /// Make the full client::Waypoint of this handle.
+    SharedPtr<Waypoint> MakeWaypoint() const;
+
+  private:
+
+    const Map *_map;
+
+    road::element::Waypoint _waypoint;
+
+    mutable boost::optional<geom::Transform> _transform;
+  };
+
+  /// Contiguous array of the handles of a map, keeping the map alive.
+  class WaypointHandleList {
+  public:
+
+    using value_type = WaypointHandle;
+    using const_iterator = std::vector<WaypointHandle>::const_iterator;
+
+    explicit WaypointHandleList(SharedPtr<const Map> map)
+      : _map(std::move(map)) {}
+
+    const SharedPtr<const Map> &GetMap() const {
+      return _map;
+    }
+
+    const WaypointHandle &operator[](size_t pos) const {
+      return _handles[pos];
+    }
+
+    const WaypointHandle &at(size_t pos) const {
+      return _handles.at(pos);
+    }
+
+    const WaypointHandle &front() const {
+      return _handles.front();
+    }
+
+    const WaypointHandle &back() const {
+      return _handles.back();
+    }
+
+    const_iterator begin() const {
+      return _handles.begin();
+    }
+
+    const_iterator end() const {
+      return _handles.end();
+    }
+
+    bool empty() const {
+      return _handles.empty();
+    }
+
+    size_t size() const {
+      return _handles.size();
+    }
+
+    void reserve(size_t size) {
+      _handles.reserve(size);
+    }
+
+    void emplace_back(const road::element::Waypoint &waypoint) {
+      _handles.emplace_back(*_map, waypoint);
+    }
+
+    /// For the lists answering a batch of queries, the handles found for the
+    /// i-th query go from offsets[i] to offsets[i + 1], see
+    /// road::Map::WaypointBatch. Empty otherwise.
+    std::vector<size_t> offsets;
+
+  private:
+
+    SharedPtr<const Map> _map;
+
+    std::vector<WaypointHandle> _handles;
+  };
+
+} // namespace client
+} // namespace carla
@@ -29,6 +29,18 @@ namespace client {
     return _episode.Lock()->GetRandomLocationFromNavigation();
   }
 
+  void World::SetMaxPedestriansPerRegion(unsigned max_pedestrians) {
+    _episode.Lock()->SetMaxPedestriansPerRegion(max_pedestrians);
+  }
+
+  rpc::RayHitBatch World::CastRays(const rpc::RayCastBatch &batch) const {
+    return _episode.Lock()->CastRays(batch);
+  }
+
+  rpc::BoxOverlapResultBatch World::OverlapBoxes(const rpc::BoxOverlapBatch &batch) const {
+    return _episode.Lock()->OverlapBoxes(batch);
+  }
+
   SharedPtr<Actor> World::GetSpectator() const {
     return _episode.Lock()->GetSpectator();
   }
@@ -41,6 +53,22 @@ namespace client {
     return _episode.Lock()->SetEpisodeSettings(settings);
   }
 
+  uint64_t World::SaveState() {
+    return _episode.Lock()->SaveEpisodeState();
+  }
+
+  void World::RestoreState(uint64_t snapshot_id) {
+    _episode.Lock()->RestoreEpisodeState(snapshot_id);
+  }
+
+  bool World::DropState(uint64_t snapshot_id) {
+    return _episode.Lock()->DropEpisodeState(snapshot_id);
+  }
+
+  void World::SetStateFilter(const rpc::EpisodeStateFilter &filter) {
+    _episode.Lock()->SetEpisodeStateFilter(filter);
+  }
+
   rpc::WeatherParameters World::GetWeather() const {
     return _episode.Lock()->GetWeatherParameters();
   }
@@ -49,6 +77,14 @@ namespace client {
     _episode.Lock()->SetWeatherParameters(weather);
   }
 
+  rpc::AutopilotSettings World::GetAutopilotSettings() const {
+    return _episode.Lock()->GetAutopilotSettings();
+  }
+
+  void World::ApplyAutopilotSettings(const rpc::AutopilotSettings &settings) {
+    _episode.Lock()->SetAutopilotSettings(settings);
+  }
+
   WorldSnapshot World::GetSnapshot() const {
     return _episode.Lock()->GetWorldSnapshot();
   }
@@ -67,6 +103,12 @@ namespace client {
                                   _episode.Lock()->GetAllTheActorsInTheEpisode()}};
   }
 
+  SharedPtr<ActorList> World::GetActorsByType(const std::string &wildcard_pattern) const {
+    return SharedPtr<ActorList>{new ActorList{
+                                  _episode,
+                                  _episode.Lock()->GetAllTheActorsInTheEpisode(wildcard_pattern)}};
+  }
+
   SharedPtr<ActorList> World::GetActors(const std::vector<ActorId> &actor_ids) const {
     return SharedPtr<ActorList>{new ActorList{
                                   _episode,
@@ -81,6 +123,14 @@ namespace client {
     return _episode.Lock()->SpawnActor(blueprint, transform, parent_actor, attachment_type);
   }
 
+  Future<SharedPtr<Actor>> World::SpawnActorAsync(
+      const ActorBlueprint &blueprint,
+      const geom::Transform &transform,
+      Actor *parent_actor,
+      rpc::AttachmentType attachment_type) {
+    return _episode.Lock()->SpawnActorAsync(blueprint, transform, parent_actor, attachment_type);
+  }
+
   SharedPtr<Actor> World::TrySpawnActor(
       const ActorBlueprint &blueprint,
       const geom::Transform &transform,
@@ -101,6 +151,14 @@ namespace client {
     return _episode.Lock()->RegisterOnTickEvent(std::move(callback));
   }
 
+  size_t World::OnTickAsync(std::function<void(WorldSnapshot)> callback) {
+    return _episode.Lock()->RegisterOnTickEventAsync(std::move(callback));
+  }
+
+  boost::optional<detail::CallbackStats> World::GetOnTickStats(size_t callback_id) const {
+    return _episode.Lock()->GetOnTickEventStats(callback_id);
+  }
+
   void World::RemoveOnTick(size_t callback_id) {
     _episode.Lock()->RemoveOnTickEvent(callback_id);
   }
@@ -109,5 +167,17 @@ namespace client {
     return _episode.Lock()->Tick();
   }
 
+  uint64_t World::TickAsync(size_t max_pending_ticks) {
+    return _episode.Lock()->TickAsync(max_pending_ticks);
+  }
+
+  uint64_t World::TickN(uint32_t frames, bool skip_intermediate_frames) {
+    return _episode.Lock()->TickN(frames, skip_intermediate_frames);
+  }
+
+  WorldSnapshot World::WaitForFrame(uint64_t frame, time_duration timeout) const {
+    return _episode.Lock()->WaitForFrame(frame, timeout);
+  }
+
 } // namespace client
 } // namespace carla
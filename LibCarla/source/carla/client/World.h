@@ -9,16 +9,23 @@
 #include "carla/Memory.h"
 #include "carla/Time.h"
 #include "carla/client/DebugHelper.h"
+#include "carla/client/Future.h"
 #include "carla/client/Timestamp.h"
 #include "carla/client/WorldSnapshot.h"
+#include "carla/client/detail/CallbackStats.h"
 #include "carla/client/detail/EpisodeProxy.h"
 #include "carla/geom/Transform.h"
 #include "carla/rpc/Actor.h"
 #include "carla/rpc/AttachmentType.h"
+#include "carla/rpc/AutopilotSettings.h"
 #include "carla/rpc/EpisodeSettings.h"
+#include "carla/rpc/EpisodeStateFilter.h"
+#include "carla/rpc/SceneQueryBatch.h"
 #include "carla/rpc/VehiclePhysicsControl.h"
 #include "carla/rpc/WeatherParameters.h"
 
+#include <boost/optional.hpp>
+
 #include <optional>
 
 namespace carla {
@@ -56,6 +63,19 @@ namespace client {
     /// Get a random location from the pedestrians navigation mesh
     boost::optional<geom::Location> GetRandomLocationFromNavigation() const;
 
+    /// Set the maximum number of pedestrians driven by the navigation in each
+    /// region of the navigation mesh (500 by default). Applies to the regions
+    /// that get their first pedestrian afterwards.
+    void SetMaxPedestriansPerRegion(unsigned max_pedestrians);
+
+    /// Cast every ray of @a batch against the physics scene of the server in
+    /// a single call, returns the first hit of each.
+    rpc::RayHitBatch CastRays(const rpc::RayCastBatch &batch) const;
+
+    /// Test every box of @a batch for overlap against the physics scene of
+    /// the server in a single call.
+    rpc::BoxOverlapResultBatch OverlapBoxes(const rpc::BoxOverlapBatch &batch) const;
+
     /// Return the spectator actor. The spectator controls the view in the
     /// simulator window.
     SharedPtr<Actor> GetSpectator() const;
@@ -65,12 +85,42 @@ namespace client {
     /// @return The id of the frame when the settings were applied.
     uint64_t ApplySettings(const rpc::EpisodeSettings &settings);
 
+    /// Capture in the memory of the simulator the transforms and velocities of
+    /// the actors, the controls, the traffic light timers and the crowd state
+    /// of the pedestrians, to roll the episode forward several times from the
+    /// same state. Actors spawned afterwards are not affected by restoring it.
+    ///
+    /// @return The id of the snapshot, valid until the episode changes.
+    uint64_t SaveState();
+
+    /// Put the episode back to the state saved with @a snapshot_id.
+    void RestoreState(uint64_t snapshot_id);
+
+    /// Release the state saved with @a snapshot_id.
+    ///
+    /// @return Whether there was such a snapshot.
+    bool DropState(uint64_t snapshot_id);
+
+    /// Receive only the state of the actors matching @a filter, e.g. the ones
+    /// around the ego vehicle, instead of the state of every actor each tick.
+    /// The actors filtered out are not returned by GetActors nor included in
+    /// the world snapshots. An empty filter receives every actor again.
+    void SetStateFilter(const rpc::EpisodeStateFilter &filter);
+
     /// Retrieve the weather parameters currently active in the world.
     rpc::WeatherParameters GetWeather() const;
 
     /// Change the weather in the simulation.
     void SetWeather(const rpc::WeatherParameters &weather);
 
+    /// Retrieve the settings of the autopilot run by the simulator, shared by
+    /// every vehicle with the autopilot enabled.
+    rpc::AutopilotSettings GetAutopilotSettings() const;
+
+    /// Change the settings of the autopilot run by the simulator, they apply
+    /// from the next tick on.
+    void ApplyAutopilotSettings(const rpc::AutopilotSettings &settings);
+
     /// Return a snapshot of the world at this moment.
     WorldSnapshot GetSnapshot() const;
 
@@ -83,6 +133,12 @@ namespace client {
     /// Return a list with the actors requested by ActorId.
     SharedPtr<ActorList> GetActors(const std::vector<ActorId> &actor_ids) const;
 
+    /// Return a list with the actors currently present in the world whose
+    /// type id matches @a wildcard_pattern. Same as
+    /// GetActors()->Filter(wildcard_pattern), without copying the actors that
+    /// do not match.
+    SharedPtr<ActorList> GetActorsByType(const std::string &wildcard_pattern) const;
+
     /// Spawn an actor into the world based on the @a blueprint provided at @a
     /// transform. If a @a parent is provided, the actor is attached to
     /// @a parent.
@@ -92,6 +148,16 @@ namespace client {
         Actor *parent = nullptr,
         rpc::AttachmentType attachment_type = rpc::AttachmentType::Rigid);
 
+    /// Same as SpawnActor but does not wait for the actor to be spawned, the
+    /// returned future throws on failure when its result is retrieved. Send
+    /// many requests this way before waiting for any of them to spawn a lot
+    /// of actors without waiting a round trip for each.
+    Future<SharedPtr<Actor>> SpawnActorAsync(
+        const ActorBlueprint &blueprint,
+        const geom::Transform &transform,
+        Actor *parent = nullptr,
+        rpc::AttachmentType attachment_type = rpc::AttachmentType::Rigid);
+
     /// Same as SpawnActor but return nullptr on failure instead of throwing an
     /// exception.
     SharedPtr<Actor> TrySpawnActor(
@@ -108,6 +174,16 @@ namespace client {
     /// @return ID of the callback, use it to remove the callback.
     size_t OnTick(std::function<void(WorldSnapshot)> callback);
 
+    /// Same as OnTick, but the @a callback is called on a dedicated thread
+    /// instead of the one receiving the ticks, so it does not delay them. If
+    /// it is still busy when new ticks arrive, it is only called with the
+    /// latest of them.
+    size_t OnTickAsync(std::function<void(WorldSnapshot)> callback);
+
+    /// Statistics of the calls to the callback @a callback_id registered
+    /// with OnTick or OnTickAsync, empty if there is no such callback.
+    boost::optional<detail::CallbackStats> GetOnTickStats(size_t callback_id) const;
+
     /// Remove a callback registered with OnTick.
     void RemoveOnTick(size_t callback_id);
 
@@ -117,6 +193,26 @@ namespace client {
     /// @return The id of the frame that this call started.
     uint64_t Tick();
 
+    /// Same as Tick but returns without waiting for the frame to be received,
+    /// so the client can compute while the simulator ticks. Up to
+    /// @a max_pending_ticks ticks are left in flight, if there are already
+    /// as many pending this waits first for the oldest one. Use the frame ids
+    /// returned and those of the sensor data to match them.
+    ///
+    /// @return The id of the frame that this call started.
+    uint64_t TickAsync(size_t max_pending_ticks = 2u);
+
+    /// Same as Tick, but the simulator runs @a frames frames back-to-back
+    /// before this returns. If @a skip_intermediate_frames, the episode
+    /// state is not broadcast and sensors are suspended until the last one.
+    ///
+    /// @return The id of the last frame started by this call.
+    uint64_t TickN(uint32_t frames, bool skip_intermediate_frames = false);
+
+    /// Block calling thread until the frame @a frame, or a later one, is
+    /// received, return the snapshot of the latest frame received.
+    WorldSnapshot WaitForFrame(uint64_t frame, time_duration timeout) const;
+
     DebugHelper MakeDebugHelper() const {
       return DebugHelper{_episode};
     }
@@ -0,0 +1,58 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/WorldSnapshot.h"
+
+namespace carla {
+namespace client {
+
+  static void Reserve(ActorStateArrays &states, size_t size) {
+    states.ids.reserve(size);
+    states.transforms.reserve(6u * size);
+    states.velocities.reserve(3u * size);
+    states.angular_velocities.reserve(3u * size);
+    states.accelerations.reserve(3u * size);
+  }
+
+  static void Append(std::vector<float> &values, const geom::Vector3D &vector) {
+    values.insert(values.end(), {vector.x, vector.y, vector.z});
+  }
+
+  static void Append(ActorStateArrays &states, const ActorSnapshot &actor) {
+    const auto &location = actor.transform.location;
+    const auto &rotation = actor.transform.rotation;
+    states.ids.emplace_back(actor.id);
+    states.transforms.insert(states.transforms.end(), {
+        location.x, location.y, location.z,
+        rotation.pitch, rotation.yaw, rotation.roll});
+    Append(states.velocities, actor.velocity);
+    Append(states.angular_velocities, actor.angular_velocity);
+    Append(states.accelerations, actor.acceleration);
+  }
+
+  ActorStateArrays WorldSnapshot::GetActorStates() const {
+    ActorStateArrays states;
+    Reserve(states, size());
+    for (auto &&actor : *this) {
+      Append(states, actor);
+    }
+    return states;
+  }
+
+  ActorStateArrays WorldSnapshot::GetActorStates(const std::vector<ActorId> &actor_ids) const {
+    ActorStateArrays states;
+    Reserve(states, actor_ids.size());
+    for (auto id : actor_ids) {
+      auto actor = Find(id);
+      if (actor) {
+        Append(states, *actor);
+      }
+    }
+    return states;
+  }
+
+} // namespace client
+} // namespace carla
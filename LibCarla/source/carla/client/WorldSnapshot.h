@@ -12,9 +12,25 @@
 
 #include <boost/optional.hpp>
 
+#include <vector>
+
 namespace carla {
 namespace client {
 
+  /// State of many actors in contiguous arrays, the values of the i-th actor
+  /// are the i-th in each of them.
+  struct ActorStateArrays {
+    std::vector<ActorId> ids;
+    /// Location x, y, z and rotation pitch, yaw, roll of each actor.
+    std::vector<float> transforms;
+    /// x, y, z of each actor.
+    std::vector<float> velocities;
+    /// x, y, z of each actor.
+    std::vector<float> angular_velocities;
+    /// x, y, z of each actor.
+    std::vector<float> accelerations;
+  };
+
   class WorldSnapshot {
   public:
 
@@ -45,6 +61,13 @@ namespace client {
       return _state->GetActorSnapshotIfPresent(actor_id);
     }
 
+    /// Get the state of every actor in this snapshot.
+    ActorStateArrays GetActorStates() const;
+
+    /// Get the state of the actors in @a actor_ids, in the same order. The
+    /// ones not present in this snapshot are skipped.
+    ActorStateArrays GetActorStates(const std::vector<ActorId> &actor_ids) const;
+
     /// Return number of ActorSnapshots present in this WorldSnapshot.
     size_t size() const {
       return _state->size();
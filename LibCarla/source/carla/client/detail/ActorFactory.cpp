@@ -7,7 +7,6 @@
 #include "carla/client/detail/ActorFactory.h"
 
 #include "carla/Logging.h"
-#include "carla/StringUtil.h"
 #include "carla/client/Actor.h"
 #include "carla/client/LaneInvasionSensor.h"
 #include "carla/client/ServerSideSensor.h"
@@ -70,24 +69,27 @@ namespace detail {
   SharedPtr<Actor> ActorFactory::MakeActor(
       EpisodeProxy episode,
       rpc::Actor description,
+      ActorKind kind,
       GarbageCollectionPolicy gc) {
-    auto init = ActorInitializer{description, episode};
-    if (description.description.id == "sensor.other.lane_invasion") {
-      return MakeActorImpl<LaneInvasionSensor>(std::move(init), gc);
-    } else if (description.HasAStream()) {
-      return MakeActorImpl<ServerSideSensor>(std::move(init), gc);
-    } else if (StringUtil::StartsWith(description.description.id, "vehicle.")) {
-      return MakeActorImpl<Vehicle>(std::move(init), gc);
-    } else if (StringUtil::StartsWith(description.description.id, "walker.")) {
-      return MakeActorImpl<Walker>(std::move(init), gc);
-    } else if (StringUtil::StartsWith(description.description.id, "traffic.traffic_light")) {
-      return MakeActorImpl<TrafficLight>(std::move(init), gc);
-    } else if (StringUtil::StartsWith(description.description.id, "traffic.")) {
-      return MakeActorImpl<TrafficSign>(std::move(init), gc);
-    } else if (description.description.id == "controller.ai.walker") {
-      return MakeActorImpl<WalkerAIController>(std::move(init), gc);
+    auto init = ActorInitializer{std::move(description), std::move(episode)};
+    switch (kind) {
+      case ActorKind::LaneInvasionSensor:
+        return MakeActorImpl<LaneInvasionSensor>(std::move(init), gc);
+      case ActorKind::ServerSideSensor:
+        return MakeActorImpl<ServerSideSensor>(std::move(init), gc);
+      case ActorKind::Vehicle:
+        return MakeActorImpl<Vehicle>(std::move(init), gc);
+      case ActorKind::Walker:
+        return MakeActorImpl<Walker>(std::move(init), gc);
+      case ActorKind::TrafficLight:
+        return MakeActorImpl<TrafficLight>(std::move(init), gc);
+      case ActorKind::TrafficSign:
+        return MakeActorImpl<TrafficSign>(std::move(init), gc);
+      case ActorKind::WalkerAIController:
+        return MakeActorImpl<WalkerAIController>(std::move(init), gc);
+      default:
+        return MakeActorImpl<Actor>(std::move(init), gc);
     }
-    return MakeActorImpl<Actor>(std::move(init), gc);
   }
 
 } // namespace detail
@@ -8,6 +8,7 @@
 
 #include "carla/Memory.h"
 #include "carla/client/GarbageCollectionPolicy.h"
+#include "carla/client/detail/ActorKind.h"
 #include "carla/client/detail/EpisodeProxy.h"
 #include "carla/rpc/Actor.h"
 
@@ -32,6 +33,16 @@ namespace detail {
     static SharedPtr<Actor> MakeActor(
         EpisodeProxy episode,
         rpc::Actor actor_description,
+        GarbageCollectionPolicy garbage_collection_policy) {
+      const auto kind = GetActorKind(actor_description);
+      return MakeActor(std::move(episode), std::move(actor_description), kind, garbage_collection_policy);
+    }
+
+    /// Same as above, but with the @a kind of the actor already classified.
+    static SharedPtr<Actor> MakeActor(
+        EpisodeProxy episode,
+        rpc::Actor actor_description,
+        ActorKind kind,
         GarbageCollectionPolicy garbage_collection_policy);
   };
 
@@ -0,0 +1,54 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/StringUtil.h"
+#include "carla/rpc/Actor.h"
+
+#include <cstdint>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  /// Class of the client object representing an actor.
+  enum class ActorKind : uint8_t {
+    Actor,
+    LaneInvasionSensor,
+    ServerSideSensor,
+    Vehicle,
+    Walker,
+    TrafficLight,
+    TrafficSign,
+    WalkerAIController
+  };
+
+  /// Classify @a actor by its type id. Done once per actor received, the
+  /// result is kept along with the actor description.
+  inline ActorKind GetActorKind(const rpc::Actor &actor) {
+    const auto &type_id = actor.description.id;
+    if (type_id == "sensor.other.lane_invasion") {
+      return ActorKind::LaneInvasionSensor;
+    } else if (actor.HasAStream()) {
+      return ActorKind::ServerSideSensor;
+    } else if (StringUtil::StartsWith(type_id, "vehicle.")) {
+      return ActorKind::Vehicle;
+    } else if (StringUtil::StartsWith(type_id, "walker.")) {
+      return ActorKind::Walker;
+    } else if (StringUtil::StartsWith(type_id, "traffic.traffic_light")) {
+      return ActorKind::TrafficLight;
+    } else if (StringUtil::StartsWith(type_id, "traffic.")) {
+      return ActorKind::TrafficSign;
+    } else if (type_id == "controller.ai.walker") {
+      return ActorKind::WalkerAIController;
+    }
+    return ActorKind::Actor;
+  }
+
+} // namespace detail
+} // namespace client
+} // namespace carla
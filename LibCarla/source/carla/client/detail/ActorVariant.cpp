@@ -7,6 +7,7 @@
 #include "carla/client/detail/ActorVariant.h"
 
 #include "carla/client/detail/ActorFactory.h"
+#include "carla/client/detail/Simulator.h"
 #include "carla/client/ActorList.h"
 
 namespace carla {
@@ -14,10 +15,17 @@ namespace client {
 namespace detail {
 
   void ActorVariant::MakeActor(EpisodeProxy episode) const {
-    _value = detail::ActorFactory::MakeActor(
-        episode,
-        boost::get<rpc::Actor>(std::move(_value)),
-        GarbageCollectionPolicy::Disabled);
+    auto description = boost::get<rpc::Actor>(std::move(_value));
+    auto simulator = episode.TryLock();
+    if (simulator != nullptr) {
+      _value = simulator->MakeActor(std::move(description));
+    } else {
+      // The episode is over, the actor is only good for reading its id.
+      _value = ActorFactory::MakeActor(
+          episode,
+          std::move(description),
+          GarbageCollectionPolicy::Disabled);
+    }
   }
 
 } // namespace detail
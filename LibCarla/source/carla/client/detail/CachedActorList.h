@@ -6,17 +6,30 @@
 
 #pragma once
 
+#include "carla/AtomicSharedPtr.h"
+#include "carla/Memory.h"
 #include "carla/NonCopyable.h"
+#include "carla/StringUtil.h"
+#include "carla/client/detail/ActorKind.h"
 #include "carla/rpc/Actor.h"
 
-#include <boost/iterator/transform_iterator.hpp>
+#include <boost/optional.hpp>
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <iterator>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace carla {
 namespace client {
+
+  class Actor;
+
 namespace detail {
 
   // ===========================================================================
@@ -26,10 +39,26 @@ namespace detail {
   /// Keeps a list of actor descriptions to avoid requesting each time the
   /// descriptions to the server.
   ///
+  /// The list is kept as an immutable snapshot swapped atomically on insert,
+  /// so the lookups never lock and the many threads querying the actors of
+  /// the episode don't serialize on each other. Inserting copies the table of
+  /// the snapshot, but only if there is any actor missing, and once for a
+  /// whole range; the actors are shared between the snapshots.
+  ///
+  /// The type ids of the actors are interned, and the types matching each
+  /// wildcard pattern are remembered, so filtering by type only matches each
+  /// pattern against each type id once.
+  ///
+  /// Each actor is classified once when inserted, and the client object made
+  /// for it is kept as a weak reference, so it is reused while anyone holds
+  /// it instead of being made again on every query.
+  ///
   /// @todo Dead actors are never removed from the list.
   class CachedActorList : private MovableNonCopyable {
   public:
 
+    CachedActorList();
+
     /// Inserts an actor into the list.
     void Insert(rpc::Actor actor);
 
@@ -50,54 +79,127 @@ namespace detail {
     template <typename RangeT>
     std::vector<rpc::Actor> GetActorsById(const RangeT &range) const;
 
+    /// Retrieve the actors matching the ids in @a range whose type id matches
+    /// @a wildcard_pattern.
+    template <typename RangeT>
+    std::vector<rpc::Actor> GetActorsById(
+        const RangeT &range,
+        const std::string &wildcard_pattern) const;
+
+    /// For each id in @a range, whether the type id of the actor matches
+    /// @a wildcard_pattern, or empty optional if the actor is not cached.
+    template <typename RangeT>
+    std::vector<boost::optional<bool>> MatchTypeIds(
+        const RangeT &range,
+        const std::string &wildcard_pattern) const;
+
+    /// Retrieve the client object of @a actor that is still alive, or the
+    /// one returned by @a make(actor, kind) if there is none. @a actor is
+    /// inserted into the list if missing.
+    ///
+    /// @warning @a make is called with the entry of @a actor locked, it must
+    /// not ask for the instance of the same actor.
+    template <typename FactoryT>
+    SharedPtr<Actor> GetOrMakeInstance(rpc::Actor actor, FactoryT &&make);
+
     void Clear();
 
   private:
 
-    mutable std::mutex _mutex;
+    struct CachedActor : private NonCopyable {
+      CachedActor(rpc::Actor actor, uint32_t type, ActorKind kind)
+        : actor(std::move(actor)),
+          type(type),
+          kind(kind) {}
+
+      const rpc::Actor actor;
+      /// Index of the type id of the actor in the interned type ids.
+      const uint32_t type;
+      const ActorKind kind;
+      /// Guards @a instance, the rest of the entry is immutable.
+      std::mutex instance_mutex;
+      /// Client object last made for this actor.
+      WeakPtr<Actor> instance;
+    };
+
+    using TypeIdList = std::vector<std::string>;
+
+    /// Immutable state of the list, replaced as a whole by the writers.
+    struct Snapshot {
+      std::unordered_map<ActorId, std::shared_ptr<CachedActor>> actors;
+      /// Interned type ids, replaced only when a new one is interned.
+      std::shared_ptr<const TypeIdList> type_ids;
+    };
+
+    using MatchingTypes = std::vector<bool>;
+
+    /// Publish a snapshot with the actors in @a range missing from the
+    /// current one. Returns the entry of the last actor of @a range.
+    ///
+    /// @pre _write_mutex is locked.
+    template <typename RangeT>
+    std::shared_ptr<CachedActor> InsertLocked(RangeT &&range);
+
+    /// Whether each of @a type_ids matches @a wildcard_pattern.
+    std::shared_ptr<const MatchingTypes> GetMatchingTypes(
+        const std::string &wildcard_pattern,
+        const TypeIdList &type_ids) const;
+
+    /// Patterns remembered before forgetting them all, in case they are
+    /// generated.
+    static constexpr size_t MaxNumberOfPatterns = 256u;
+
+    AtomicSharedPtr<const Snapshot> _snapshot;
+
+    /// Serializes the writers, the readers only load @a _snapshot.
+    std::mutex _write_mutex;
+
+    /// Index of each interned type id, only used by the writers.
+    std::unordered_map<std::string, uint32_t> _type_index;
 
-    std::unordered_map<ActorId, rpc::Actor> _actors;
+    mutable std::mutex _matching_types_mutex;
+
+    /// Whether each type id matches the wildcard pattern, for each pattern
+    /// used. Replaced by an extended copy when filtering once new type ids
+    /// are interned, the readers may still hold the previous one.
+    mutable std::unordered_map<std::string, std::shared_ptr<const MatchingTypes>> _matching_types;
   };
 
   // ===========================================================================
   // -- CachedActorList implementation -----------------------------------------
   // ===========================================================================
 
+  inline CachedActorList::CachedActorList()
+    : _snapshot(std::make_shared<const Snapshot>(Snapshot{{}, std::make_shared<const TypeIdList>()})) {}
+
   inline void CachedActorList::Insert(rpc::Actor actor) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    auto id = actor.id;
-    _actors.emplace(id, std::move(actor));
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    InsertLocked(std::array<rpc::Actor, 1u>{{std::move(actor)}});
   }
 
   template <typename RangeT>
   inline void CachedActorList::InsertRange(RangeT range) {
-    auto make_a_pair = [](rpc::Actor actor) {
-      auto id = actor.id;
-      return std::make_pair(id, std::move(actor));
-    };
-    auto make_iterator = [&make_a_pair](auto it) {
-      return boost::make_transform_iterator(std::make_move_iterator(it), make_a_pair);
-    };
-    std::lock_guard<std::mutex> lock(_mutex);
-    _actors.insert(make_iterator(std::begin(range)), make_iterator(std::end(range)));
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    InsertLocked(range);
   }
 
   template <typename RangeT>
   inline std::vector<ActorId> CachedActorList::GetMissingIds(const RangeT &range) const {
     std::vector<ActorId> result;
     result.reserve(range.size());
-    std::lock_guard<std::mutex> lock(_mutex);
-    std::copy_if(std::begin(range), std::end(range), std::back_inserter(result), [this](auto id) {
-      return _actors.find(id) == _actors.end();
+    const auto snapshot = _snapshot.load();
+    const auto &actors = snapshot->actors;
+    std::copy_if(std::begin(range), std::end(range), std::back_inserter(result), [&actors](auto id) {
+      return actors.find(id) == actors.end();
     });
     return result;
   }
 
   inline boost::optional<rpc::Actor> CachedActorList::GetActorById(ActorId id) const {
-    std::lock_guard<std::mutex> lock(_mutex);
-    auto it = _actors.find(id);
-    if (it != _actors.end()) {
-      return it->second;
+    const auto snapshot = _snapshot.load();
+    auto it = snapshot->actors.find(id);
+    if (it != snapshot->actors.end()) {
+      return it->second->actor;
     }
     return boost::none;
   }
@@ -106,19 +208,137 @@ namespace detail {
   inline std::vector<rpc::Actor> CachedActorList::GetActorsById(const RangeT &range) const {
     std::vector<rpc::Actor> result;
     result.reserve(range.size());
-    std::lock_guard<std::mutex> lock(_mutex);
+    const auto snapshot = _snapshot.load();
+    for (auto &&id : range) {
+      auto it = snapshot->actors.find(id);
+      if (it != snapshot->actors.end()) {
+        result.emplace_back(it->second->actor);
+      }
+    }
+    return result;
+  }
+
+  template <typename RangeT>
+  inline std::vector<rpc::Actor> CachedActorList::GetActorsById(
+      const RangeT &range,
+      const std::string &wildcard_pattern) const {
+    std::vector<rpc::Actor> result;
+    const auto snapshot = _snapshot.load();
+    const auto matching_types = GetMatchingTypes(wildcard_pattern, *snapshot->type_ids);
+    for (auto &&id : range) {
+      auto it = snapshot->actors.find(id);
+      if ((it != snapshot->actors.end()) && (*matching_types)[it->second->type]) {
+        result.emplace_back(it->second->actor);
+      }
+    }
+    return result;
+  }
+
+  template <typename RangeT>
+  inline std::vector<boost::optional<bool>> CachedActorList::MatchTypeIds(
+      const RangeT &range,
+      const std::string &wildcard_pattern) const {
+    std::vector<boost::optional<bool>> result;
+    result.reserve(range.size());
+    const auto snapshot = _snapshot.load();
+    const auto matching_types = GetMatchingTypes(wildcard_pattern, *snapshot->type_ids);
     for (auto &&id : range) {
-      auto it = _actors.find(id);
-      if (it != _actors.end()) {
-        result.emplace_back(it->second);
+      auto it = snapshot->actors.find(id);
+      if (it != snapshot->actors.end()) {
+        result.emplace_back(bool((*matching_types)[it->second->type]));
+      } else {
+        result.emplace_back(boost::none);
       }
     }
     return result;
   }
 
+  template <typename FactoryT>
+  inline SharedPtr<Actor> CachedActorList::GetOrMakeInstance(rpc::Actor actor, FactoryT &&make) {
+    std::shared_ptr<CachedActor> cached;
+    {
+      const auto snapshot = _snapshot.load();
+      auto it = snapshot->actors.find(actor.id);
+      if (it != snapshot->actors.end()) {
+        cached = it->second;
+      }
+    }
+    if (cached == nullptr) {
+      std::lock_guard<std::mutex> lock(_write_mutex);
+      cached = InsertLocked(std::array<rpc::Actor, 1u>{{std::move(actor)}});
+    }
+    std::lock_guard<std::mutex> lock(cached->instance_mutex);
+    auto instance = cached->instance.lock();
+    if (instance == nullptr) {
+      instance = make(cached->actor, cached->kind);
+      cached->instance = instance;
+    }
+    return instance;
+  }
+
   inline void CachedActorList::Clear() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _actors.clear();
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    // The interned type ids and the patterns matching them are still valid.
+    _snapshot.store(std::make_shared<const Snapshot>(Snapshot{{}, _snapshot.load()->type_ids}));
+  }
+
+  template <typename RangeT>
+  inline std::shared_ptr<CachedActorList::CachedActor> CachedActorList::InsertLocked(RangeT &&range) {
+    const auto current = _snapshot.load();
+    std::shared_ptr<Snapshot> next;
+    std::shared_ptr<TypeIdList> type_ids;
+    std::shared_ptr<CachedActor> last;
+    for (auto &&actor : range) {
+      const auto &actors = (next != nullptr) ? next->actors : current->actors;
+      auto it = actors.find(actor.id);
+      if (it != actors.end()) {
+        last = it->second;
+        continue;
+      }
+      if (next == nullptr) {
+        next = std::make_shared<Snapshot>(*current);
+      }
+      auto result = _type_index.emplace(actor.description.id, static_cast<uint32_t>(_type_index.size()));
+      if (result.second) {
+        if (type_ids == nullptr) {
+          type_ids = std::make_shared<TypeIdList>(*current->type_ids);
+        }
+        type_ids->emplace_back(actor.description.id);
+      }
+      const auto id = actor.id;
+      const auto type = result.first->second;
+      const auto kind = GetActorKind(actor);
+      last = std::make_shared<CachedActor>(std::move(actor), type, kind);
+      next->actors.emplace(id, last);
+    }
+    if (next != nullptr) {
+      if (type_ids != nullptr) {
+        next->type_ids = std::move(type_ids);
+      }
+      _snapshot.store(std::move(next));
+    }
+    return last;
+  }
+
+  inline std::shared_ptr<const CachedActorList::MatchingTypes> CachedActorList::GetMatchingTypes(
+      const std::string &wildcard_pattern,
+      const TypeIdList &type_ids) const {
+    std::lock_guard<std::mutex> lock(_matching_types_mutex);
+    if ((_matching_types.size() >= MaxNumberOfPatterns) &&
+        (_matching_types.find(wildcard_pattern) == _matching_types.end())) {
+      _matching_types.clear();
+    }
+    auto &matches = _matching_types[wildcard_pattern];
+    if ((matches == nullptr) || (matches->size() < type_ids.size())) {
+      auto extended = (matches != nullptr) ?
+          std::make_shared<MatchingTypes>(*matches) :
+          std::make_shared<MatchingTypes>();
+      for (auto i = extended->size(); i < type_ids.size(); ++i) {
+        extended->push_back(StringUtil::Match(type_ids[i], wildcard_pattern));
+      }
+      matches = std::move(extended);
+    }
+    return matches;
   }
 
 } // namespace detail
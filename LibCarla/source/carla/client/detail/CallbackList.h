@@ -7,15 +7,32 @@
 #pragma once
 
 #include "carla/AtomicList.h"
+#include "carla/Logging.h"
 #include "carla/NonCopyable.h"
+#include "carla/ThreadPool.h"
+#include "carla/client/detail/CallbackStats.h"
+
+#include <boost/optional.hpp>
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
 #include <functional>
+#include <memory>
+#include <mutex>
 
 namespace carla {
 namespace client {
 namespace detail {
 
+  /// List of callbacks called with the same inputs.
+  ///
+  /// Synchronous callbacks are called in the thread that calls Call().
+  /// Asynchronous callbacks are called in a dedicated thread instead, so a
+  /// slow one does not delay the caller. They are never called concurrently
+  /// with themselves, and if one is still busy when new inputs arrive it is
+  /// only called with the latest of them.
   template <typename... InputsT>
   class CallbackList : private NonCopyable {
   public:
@@ -25,30 +42,102 @@ namespace detail {
     void Call(InputsT... args) const {
       auto list = _list.Load();
       for (auto &item : *list) {
-        item.callback(args...);
+        if (item.executor == nullptr) {
+          item.state->Invoke([&]() { item.callback(args...); });
+        } else {
+          Schedule(item, std::function<void()>([callback = item.callback, args...]() {
+            callback(args...);
+          }));
+        }
       }
     }
 
     size_t Push(CallbackType &&callback) {
-      auto id = ++_counter;
-      DEBUG_ASSERT(id != 0u);
-      _list.Push(Item{id, std::move(callback)});
-      return id;
+      return Push(std::move(callback), nullptr);
+    }
+
+    /// Same as Push, but the callback is called asynchronously.
+    size_t PushAsync(CallbackType &&callback) {
+      return Push(std::move(callback), &GetExecutor());
     }
 
     void Remove(size_t id) {
+      auto list = _list.Load();
+      for (auto &item : *list) {
+        if (item.id == id) {
+          item.state->is_removed = true;
+        }
+      }
       _list.DeleteByValue(id);
     }
 
     void Clear() {
+      auto list = _list.Load();
+      for (auto &item : *list) {
+        item.state->is_removed = true;
+      }
       _list.Clear();
     }
 
+    /// Statistics of the callback @a id, empty if there is no such callback.
+    boost::optional<CallbackStats> GetStats(size_t id) const {
+      auto list = _list.Load();
+      for (auto &item : *list) {
+        if (item.id == id) {
+          return item.state->GetStats();
+        }
+      }
+      return boost::none;
+    }
+
   private:
 
+    struct State {
+      std::atomic_bool is_removed{false};
+
+      std::atomic_size_t calls{0u};
+
+      std::atomic_size_t coalesced{0u};
+
+      std::atomic<uint64_t> total_nanoseconds{0u};
+
+      std::atomic<uint64_t> max_nanoseconds{0u};
+
+      /// Inputs of an asynchronous callback waiting for it to be called.
+      std::mutex mutex;
+
+      std::function<void()> pending;
+
+      bool is_scheduled = false;
+
+      template <typename F>
+      void Invoke(F &&call) {
+        const auto start = std::chrono::steady_clock::now();
+        call();
+        const auto elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        ++calls;
+        total_nanoseconds += elapsed;
+        auto max = max_nanoseconds.load();
+        while ((elapsed > max) && !max_nanoseconds.compare_exchange_weak(max, elapsed));
+      }
+
+      CallbackStats GetStats() const {
+        CallbackStats stats;
+        stats.calls = calls;
+        stats.coalesced = coalesced;
+        stats.total_seconds = 1e-9 * static_cast<double>(total_nanoseconds.load());
+        stats.max_seconds = 1e-9 * static_cast<double>(max_nanoseconds.load());
+        return stats;
+      }
+    };
+
     struct Item {
       size_t id;
       CallbackType callback;
+      std::shared_ptr<State> state;
+      /// Null for synchronous callbacks.
+      ThreadPool *executor;
 
       friend bool operator==(const Item &lhs, const Item &rhs) {
         return lhs.id == rhs.id;
@@ -63,8 +152,70 @@ namespace detail {
       }
     };
 
+    size_t Push(CallbackType &&callback, ThreadPool *executor) {
+      auto id = ++_counter;
+      DEBUG_ASSERT(id != 0u);
+      _list.Push(Item{id, std::move(callback), std::make_shared<State>(), executor});
+      return id;
+    }
+
+    ThreadPool &GetExecutor() {
+      std::lock_guard<std::mutex> lock(_executor_mutex);
+      if (_executor == nullptr) {
+        _executor = std::make_unique<ThreadPool>();
+        _executor->AsyncRun(1u);
+      }
+      return *_executor;
+    }
+
+    /// Replace the pending inputs of @a item by @a call, and post it to the
+    /// executor if it is not already waiting there.
+    static void Schedule(const Item &item, std::function<void()> call) {
+      std::lock_guard<std::mutex> lock(item.state->mutex);
+      if (item.state->pending != nullptr) {
+        ++item.state->coalesced;
+      }
+      item.state->pending = std::move(call);
+      if (!item.state->is_scheduled) {
+        item.state->is_scheduled = true;
+        Post(*item.executor, item.state);
+      }
+    }
+
+    /// Call the pending inputs of @a state, posting it again if new ones
+    /// arrived meanwhile so other callbacks get their turn.
+    static void Post(ThreadPool &executor, std::shared_ptr<State> state) {
+      executor.io_context().post([&executor, state]() {
+        std::function<void()> call;
+        {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          call = std::move(state->pending);
+          state->pending = nullptr;
+        }
+        if (!state->is_removed) {
+          try {
+            state->Invoke(call);
+          } catch (const std::exception &e) {
+            log_error("exception thrown in asynchronous callback:", e.what());
+          }
+        }
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->pending != nullptr) {
+          Post(executor, state);
+        } else {
+          state->is_scheduled = false;
+        }
+      });
+    }
+
     std::atomic_size_t _counter{0u};
 
+    std::mutex _executor_mutex;
+
+    /// Calls to asynchronous callbacks hold their own copy of the callback,
+    /// the ones still queued are dropped when the executor is destroyed.
+    std::unique_ptr<ThreadPool> _executor;
+
     AtomicList<Item> _list;
   };
 
@@ -0,0 +1,33 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  /// Statistics of the calls to a callback.
+  struct CallbackStats {
+    /// Number of times the callback was called.
+    size_t calls = 0u;
+
+    /// Number of inputs an asynchronous callback skipped because a later one
+    /// arrived before it could be called.
+    size_t coalesced = 0u;
+
+    /// Total time spent in the callback.
+    double total_seconds = 0.0;
+
+    /// Longest time spent in a single call.
+    double max_seconds = 0.0;
+  };
+
+} // namespace detail
+} // namespace client
+} // namespace carla
@@ -21,7 +21,12 @@
 
 #include <rpc/rpc_error.h>
 
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <memory>
 #include <thread>
+#include <vector>
 
 namespace carla {
 namespace client {
@@ -43,27 +48,43 @@ namespace detail {
   class Client::Pimpl {
   public:
 
-    Pimpl(const std::string &host, uint16_t port, size_t worker_threads)
+    Pimpl(
+        const std::string &host,
+        uint16_t port,
+        size_t worker_threads,
+        size_t rpc_connections)
       : endpoint(host + ":" + std::to_string(port)),
-        rpc_client(host, port),
         streaming_client(host) {
-      rpc_client.set_timeout(1000u);
+      rpc_clients.reserve(std::max<size_t>(rpc_connections, 1u));
+      do {
+        rpc_clients.emplace_back(std::make_unique<rpc::Client>(host, port));
+        rpc_clients.back()->set_timeout(1000u);
+      } while (rpc_clients.size() < rpc_connections);
       streaming_client.AsyncRun(
           worker_threads > 0u ? worker_threads : std::thread::hardware_concurrency());
     }
 
+    /// Connection used by the calling thread. Each thread sticks to one
+    /// connection, so its calls keep their order, and the threads are spread
+    /// round-robin over the pool so that up to one request per connection is
+    /// in flight without waiting for the others.
+    rpc::Client &GetRpcClient() {
+      static std::atomic_size_t next_thread_index{0u};
+      thread_local const size_t thread_index = next_thread_index++;
+      return *rpc_clients[thread_index % rpc_clients.size()];
+    }
+
     template <typename ... Args>
     auto RawCall(const std::string &function, Args && ... args) {
       try {
-        return rpc_client.call(function, std::forward<Args>(args) ...);
+        return GetRpcClient().call(function, std::forward<Args>(args) ...);
       } catch (const ::rpc::timeout &) {
         throw_exception(TimeoutException(endpoint, GetTimeout()));
       }
     }
 
-    template <typename T, typename ... Args>
-    auto CallAndWait(const std::string &function, Args && ... args) {
-      auto object = RawCall(function, std::forward<Args>(args) ...);
+    template <typename T, typename Object>
+    static auto ParseResponse(const Object &object) {
       using R = typename carla::rpc::Response<T>;
       auto response = object.template as<R>();
       if (response.HasError()) {
@@ -72,21 +93,46 @@ namespace detail {
       return Get(response);
     }
 
+    template <typename T, typename ... Args>
+    auto CallAndWait(const std::string &function, Args && ... args) {
+      auto object = RawCall(function, std::forward<Args>(args) ...);
+      return ParseResponse<T>(object);
+    }
+
+    /// Send the request without waiting for the response, the returned
+    /// future waits for it up to the timeout set at the time of the call.
+    template <typename T, typename ... Args>
+    auto CallAsync(const std::string &function, Args && ... args) {
+      auto future = GetRpcClient().call_async(function, std::forward<Args>(args) ...).share();
+      const auto timeout = GetTimeout();
+      return Future<T>(
+          [future](time_duration wait_timeout) {
+            return future.wait_for(wait_timeout.to_chrono()) == std::future_status::ready;
+          },
+          [future, timeout, endpoint = endpoint]() -> T {
+            if (future.wait_for(timeout.to_chrono()) != std::future_status::ready) {
+              throw_exception(TimeoutException(endpoint, timeout));
+            }
+            return ParseResponse<T>(future.get());
+          });
+    }
+
     template <typename ... Args>
     void AsyncCall(const std::string &function, Args && ... args) {
       // Discard returned future.
-      rpc_client.async_call(function, std::forward<Args>(args) ...);
+      GetRpcClient().async_call(function, std::forward<Args>(args) ...);
     }
 
     time_duration GetTimeout() const {
-      auto timeout = rpc_client.get_timeout();
+      auto timeout = rpc_clients.front()->get_timeout();
       DEBUG_ASSERT(timeout.has_value());
       return time_duration::milliseconds(static_cast<size_t>(*timeout));
     }
 
     const std::string endpoint;
 
-    rpc::Client rpc_client;
+    /// Connections to the rpc server, at least one.
+    std::vector<std::unique_ptr<rpc::Client>> rpc_clients;
 
     streaming::Client streaming_client;
   };
@@ -98,13 +144,16 @@ namespace detail {
   Client::Client(
       const std::string &host,
       const uint16_t port,
-      const size_t worker_threads)
-    : _pimpl(std::make_unique<Pimpl>(host, port, worker_threads)) {}
+      const size_t worker_threads,
+      const size_t rpc_connections)
+    : _pimpl(std::make_unique<Pimpl>(host, port, worker_threads, rpc_connections)) {}
 
   Client::~Client() = default;
 
   void Client::SetTimeout(time_duration timeout) {
-    _pimpl->rpc_client.set_timeout(static_cast<int64_t>(timeout.milliseconds()));
+    for (auto &rpc_client : _pimpl->rpc_clients) {
+      rpc_client->set_timeout(static_cast<int64_t>(timeout.milliseconds()));
+    }
   }
 
   time_duration Client::GetTimeout() const {
@@ -123,11 +172,73 @@ namespace detail {
     return _pimpl->CallAndWait<std::string>("version");
   }
 
+  std::vector<profiler::ProfilerStats> Client::GetServerProfilerStats() {
+    using return_t = std::vector<profiler::ProfilerStats>;
+    return _pimpl->CallAndWait<return_t>("get_profiler_stats");
+  }
+
+  void Client::SetServerProfilerEnabled(bool enabled) {
+    _pimpl->AsyncCall("set_profiler_enabled", enabled);
+  }
+
+  rpc::ServerMetrics Client::GetServerMetrics() {
+    return _pimpl->CallAndWait<rpc::ServerMetrics>("get_server_metrics");
+  }
+
+  std::vector<rpc::SensorMetrics> Client::GetSensorMetrics() {
+    using return_t = std::vector<rpc::SensorMetrics>;
+    return _pimpl->CallAndWait<return_t>("get_sensor_metrics");
+  }
+
+  void Client::SetSensorMetricsEnabled(bool enabled) {
+    _pimpl->CallAndWait<void>("set_sensor_metrics_enabled", enabled);
+  }
+
+  rpc::MemoryReport Client::GetServerMemoryReport() {
+    return _pimpl->CallAndWait<rpc::MemoryReport>("get_memory_report");
+  }
+
+  std::string Client::GetServerFrameTrace() {
+    return _pimpl->CallAndWait<std::string>("get_frame_trace");
+  }
+
+  void Client::SetServerFrameTracerEnabled(bool enabled) {
+    _pimpl->AsyncCall("set_frame_tracer_enabled", enabled);
+  }
+
   void Client::LoadEpisode(std::string map_name) {
     // Await response, we need to be sure in this one.
     _pimpl->CallAndWait<void>("load_new_episode", std::move(map_name));
   }
 
+  void Client::LoadEpisodeAsync(std::string map_name, std::vector<std::string> preload_assets) {
+    _pimpl->CallAndWait<void>("load_new_episode_async", std::move(map_name), std::move(preload_assets));
+  }
+
+  rpc::MapLoadProgress Client::GetMapLoadProgress() {
+    return _pimpl->CallAndWait<rpc::MapLoadProgress>("get_map_load_progress");
+  }
+
+  void Client::ResetEpisode() {
+    _pimpl->CallAndWait<void>("reset_episode");
+  }
+
+  uint64_t Client::SaveEpisodeState() {
+    return _pimpl->CallAndWait<uint64_t>("save_episode_state");
+  }
+
+  void Client::RestoreEpisodeState(uint64_t snapshot_id) {
+    _pimpl->CallAndWait<void>("restore_episode_state", snapshot_id);
+  }
+
+  bool Client::DropEpisodeState(uint64_t snapshot_id) {
+    return _pimpl->CallAndWait<bool>("drop_episode_state", snapshot_id);
+  }
+
+  streaming::Token Client::OpenFilteredEpisodeStream(const rpc::EpisodeStateFilter &filter) {
+    return _pimpl->CallAndWait<streaming::Token>("open_filtered_episode_stream", filter);
+  }
+
   rpc::EpisodeInfo Client::GetEpisodeInfo() {
     return _pimpl->CallAndWait<rpc::EpisodeInfo>("get_episode_info");
   }
@@ -140,6 +251,10 @@ namespace detail {
     return _pimpl->CallAndWait<std::vector<uint8_t>>("get_navigation_mesh");
   }
 
+  rpc::NavigationMeshInfo Client::GetNavigationMeshInfo() const {
+    return _pimpl->CallAndWait<rpc::NavigationMeshInfo>("get_navigation_mesh_info");
+  }
+
   std::vector<std::string> Client::GetAvailableMaps() {
     return _pimpl->CallAndWait<std::vector<std::string>>("get_available_maps");
   }
@@ -148,6 +263,10 @@ namespace detail {
     return _pimpl->CallAndWait<std::vector<rpc::ActorDefinition>>("get_actor_definitions");
   }
 
+  uint64_t Client::GetActorDefinitionsVersion() {
+    return _pimpl->CallAndWait<uint64_t>("get_actor_definitions_version");
+  }
+
   rpc::Actor Client::GetSpectator() {
     return _pimpl->CallAndWait<carla::rpc::Actor>("get_spectator");
   }
@@ -168,6 +287,14 @@ namespace detail {
     _pimpl->AsyncCall("set_weather_parameters", weather);
   }
 
+  rpc::AutopilotSettings Client::GetAutopilotSettings() {
+    return _pimpl->CallAndWait<rpc::AutopilotSettings>("get_autopilot_settings");
+  }
+
+  void Client::SetAutopilotSettings(const rpc::AutopilotSettings &settings) {
+    _pimpl->CallAndWait<void>("set_autopilot_settings", settings);
+  }
+
   std::vector<rpc::Actor> Client::GetActorsById(
       const std::vector<ActorId> &ids) {
     using return_t = std::vector<rpc::Actor>;
@@ -179,6 +306,11 @@ namespace detail {
     return _pimpl->CallAndWait<carla::rpc::VehiclePhysicsControl>("get_physics_control", vehicle);
   }
 
+  Future<rpc::VehiclePhysicsControl> Client::GetVehiclePhysicsControlAsync(
+      const rpc::ActorId &vehicle) const {
+    return _pimpl->CallAsync<carla::rpc::VehiclePhysicsControl>("get_physics_control", vehicle);
+  }
+
   void Client::ApplyPhysicsControlToVehicle(
       const rpc::ActorId &vehicle,
       const rpc::VehiclePhysicsControl &physics_control) {
@@ -191,6 +323,12 @@ namespace detail {
     return _pimpl->CallAndWait<rpc::Actor>("spawn_actor", description, transform);
   }
 
+  Future<rpc::Actor> Client::SpawnActorAsync(
+      const rpc::ActorDescription &description,
+      const geom::Transform &transform) {
+    return _pimpl->CallAsync<rpc::Actor>("spawn_actor", description, transform);
+  }
+
   rpc::Actor Client::SpawnActorWithParent(
       const rpc::ActorDescription &description,
       const geom::Transform &transform,
@@ -203,6 +341,18 @@ namespace detail {
         attachment_type);
   }
 
+  Future<rpc::Actor> Client::SpawnActorWithParentAsync(
+      const rpc::ActorDescription &description,
+      const geom::Transform &transform,
+      rpc::ActorId parent,
+      rpc::AttachmentType attachment_type) {
+    return _pimpl->CallAsync<rpc::Actor>("spawn_actor_with_parent",
+        description,
+        transform,
+        parent,
+        attachment_type);
+  }
+
   bool Client::DestroyActor(rpc::ActorId actor) {
     try {
       return _pimpl->CallAndWait<void>("destroy_actor", actor);
@@ -236,6 +386,10 @@ namespace detail {
     _pimpl->AsyncCall("set_actor_simulate_physics", actor, enabled);
   }
 
+  void Client::SetActorKinematic(rpc::ActorId actor, const bool enabled) {
+    _pimpl->AsyncCall("set_actor_kinematic", actor, enabled);
+  }
+
   void Client::SetActorAutopilot(rpc::ActorId vehicle, const bool enabled) {
     _pimpl->AsyncCall("set_actor_autopilot", vehicle, enabled);
   }
@@ -252,6 +406,22 @@ namespace detail {
     _pimpl->AsyncCall("apply_bone_control_to_walker", walker, control);
   }
 
+  void Client::AddWalkerToNavigation(rpc::ActorId walker) {
+    _pimpl->CallAndWait<void>("add_walker_to_navigation", walker);
+  }
+
+  bool Client::RemoveWalkerFromNavigation(rpc::ActorId walker) {
+    return _pimpl->CallAndWait<bool>("remove_walker_from_navigation", walker);
+  }
+
+  bool Client::SetWalkerNavigationTarget(rpc::ActorId walker, const geom::Location &target) {
+    return _pimpl->CallAndWait<bool>("set_walker_navigation_target", walker, target);
+  }
+
+  bool Client::SetWalkerNavigationMaxSpeed(rpc::ActorId walker, float max_speed) {
+    return _pimpl->CallAndWait<bool>("set_walker_navigation_max_speed", walker, max_speed);
+  }
+
   void Client::SetTrafficLightState(
       rpc::ActorId traffic_light,
       const rpc::TrafficLightState traffic_light_state) {
@@ -279,6 +449,12 @@ namespace detail {
     return _pimpl->CallAndWait<return_t>("get_group_traffic_lights", traffic_light);
   }
 
+  Future<std::vector<ActorId>> Client::GetGroupTrafficLightsAsync(
+      const rpc::ActorId &traffic_light) {
+    using return_t = std::vector<ActorId>;
+    return _pimpl->CallAsync<return_t>("get_group_traffic_lights", traffic_light);
+  }
+
   std::string Client::StartRecorder(std::string name) {
     return _pimpl->CallAndWait<std::string>("start_recorder", name);
   }
@@ -299,6 +475,18 @@ namespace detail {
     return _pimpl->CallAndWait<std::string>("show_recorder_actors_blocked", name, min_time, min_distance);
   }
 
+  rpc::RecorderFileInfo Client::GetRecorderFileInfo(std::string name) {
+    return _pimpl->CallAndWait<rpc::RecorderFileInfo>("get_recorder_file_info", name);
+  }
+
+  rpc::RecorderCollisions Client::GetRecorderCollisions(std::string name, char type1, char type2) {
+    return _pimpl->CallAndWait<rpc::RecorderCollisions>("get_recorder_collisions", name, type1, type2);
+  }
+
+  rpc::RecorderBlockedActors Client::GetRecorderActorsBlocked(std::string name, double min_time, double min_distance) {
+    return _pimpl->CallAndWait<rpc::RecorderBlockedActors>("get_recorder_actors_blocked", name, min_time, min_distance);
+  }
+
   std::string Client::ReplayFile(std::string name, double start, double duration, uint32_t follow_id) {
     return _pimpl->CallAndWait<std::string>("replay_file", name, start, duration, follow_id);
   }
@@ -307,6 +495,30 @@ namespace detail {
     _pimpl->AsyncCall("set_replayer_time_factor", time_factor);
   }
 
+  void Client::SetReplayerInterpolation(bool enabled) {
+    _pimpl->AsyncCall("set_replayer_interpolation", enabled);
+  }
+
+  void Client::SetReplayerFrameByFrame(bool enabled) {
+    _pimpl->CallAndWait<void>("set_replayer_frame_by_frame", enabled);
+  }
+
+  rpc::ActorId Client::GetReplayerActorId(rpc::ActorId recorded_id) {
+    return _pimpl->CallAndWait<rpc::ActorId>("get_replayer_actor_id", recorded_id);
+  }
+
+  void Client::SetRecorderKeyFrameInterval(double seconds) {
+    _pimpl->AsyncCall("set_recorder_keyframe_interval", seconds);
+  }
+
+  void Client::SetRecorderCompression(bool enabled) {
+    _pimpl->AsyncCall("set_recorder_compression", enabled);
+  }
+
+  void Client::SetRecorderFilter(const rpc::RecorderFilter &filter) {
+    _pimpl->AsyncCall("set_recorder_filter", filter);
+  }
+
   void Client::SubscribeToStream(
       const streaming::Token &token,
       std::function<void(Buffer)> callback) {
@@ -321,10 +533,42 @@ namespace detail {
     _pimpl->AsyncCall("draw_debug_shape", shape);
   }
 
+  void Client::DrawDebugShapes(const std::vector<rpc::DebugShape> &shapes) {
+    _pimpl->AsyncCall("draw_debug_shapes", shapes);
+  }
+
   void Client::ApplyBatch(std::vector<rpc::Command> commands, bool do_tick_cue) {
     _pimpl->AsyncCall("apply_batch", std::move(commands), do_tick_cue);
   }
 
+  void Client::ApplyVehicleControlBatch(const rpc::VehicleControlBatch &batch) {
+    _pimpl->AsyncCall("apply_vehicle_control_batch", batch);
+  }
+
+  void Client::ApplyWalkerStateBatch(const rpc::WalkerStateBatch &batch) {
+    _pimpl->AsyncCall("apply_walker_state_batch", batch);
+  }
+
+  void Client::ApplyTransformBatch(const rpc::TransformBatch &batch) {
+    _pimpl->AsyncCall("apply_transform_batch", batch);
+  }
+
+  uint32_t Client::RegisterWalkerBones(const std::vector<std::string> &bone_names) {
+    return _pimpl->CallAndWait<uint32_t>("register_walker_bones", bone_names);
+  }
+
+  void Client::ApplyWalkerBoneControlBatch(const rpc::WalkerBoneControlBatch &batch) {
+    _pimpl->AsyncCall("apply_walker_bone_control_batch", batch);
+  }
+
+  rpc::RayHitBatch Client::CastRays(const rpc::RayCastBatch &batch) {
+    return _pimpl->CallAndWait<rpc::RayHitBatch>("cast_rays", batch);
+  }
+
+  rpc::BoxOverlapResultBatch Client::OverlapBoxes(const rpc::BoxOverlapBatch &batch) {
+    return _pimpl->CallAndWait<rpc::BoxOverlapResultBatch>("overlap_boxes", batch);
+  }
+
   std::vector<rpc::CommandResponse> Client::ApplyBatchSync(
       std::vector<rpc::Command> commands,
       bool do_tick_cue) {
@@ -336,6 +580,10 @@ namespace detail {
     return _pimpl->CallAndWait<uint64_t>("tick_cue");
   }
 
+  uint64_t Client::SendTickCues(uint32_t frames, bool skip_intermediate_frames) {
+    return _pimpl->CallAndWait<uint64_t>("tick_n", frames, skip_intermediate_frames);
+  }
+
 } // namespace detail
 } // namespace client
 } // namespace carla
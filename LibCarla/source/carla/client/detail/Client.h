@@ -9,17 +9,33 @@
 #include "carla/Memory.h"
 #include "carla/NonCopyable.h"
 #include "carla/Time.h"
+#include "carla/client/Future.h"
 #include "carla/geom/Transform.h"
+#include "carla/profiler/ProfilerStats.h"
 #include "carla/rpc/Actor.h"
 #include "carla/rpc/ActorDefinition.h"
 #include "carla/rpc/AttachmentType.h"
+#include "carla/rpc/AutopilotSettings.h"
 #include "carla/rpc/Command.h"
 #include "carla/rpc/CommandResponse.h"
 #include "carla/rpc/EpisodeInfo.h"
 #include "carla/rpc/EpisodeSettings.h"
+#include "carla/rpc/EpisodeStateFilter.h"
 #include "carla/rpc/MapInfo.h"
+#include "carla/rpc/MapLoadProgress.h"
+#include "carla/rpc/MemoryReport.h"
+#include "carla/rpc/NavigationMeshInfo.h"
+#include "carla/rpc/RecorderFilter.h"
+#include "carla/rpc/RecorderQuery.h"
+#include "carla/rpc/SceneQueryBatch.h"
+#include "carla/rpc/SensorMetrics.h"
+#include "carla/rpc/ServerMetrics.h"
 #include "carla/rpc/TrafficLightState.h"
+#include "carla/rpc/TransformBatch.h"
+#include "carla/rpc/WalkerBoneControlBatch.h"
+#include "carla/rpc/VehicleControlBatch.h"
 #include "carla/rpc/VehiclePhysicsControl.h"
+#include "carla/rpc/WalkerStateBatch.h"
 #include "carla/rpc/WeatherParameters.h"
 
 #include <functional>
@@ -54,10 +70,14 @@ namespace detail {
   class Client : private NonCopyable {
   public:
 
+    /// @param rpc_connections number of connections to the rpc server, the
+    ///        threads calling are spread over them so their requests don't
+    ///        wait for each other.
     explicit Client(
         const std::string &host,
         uint16_t port,
-        size_t worker_threads = 0u);
+        size_t worker_threads = 0u,
+        size_t rpc_connections = 1u);
 
     ~Client();
 
@@ -71,18 +91,58 @@ namespace detail {
 
     std::string GetServerVersion();
 
+    std::vector<profiler::ProfilerStats> GetServerProfilerStats();
+
+    void SetServerProfilerEnabled(bool enabled);
+
+    rpc::ServerMetrics GetServerMetrics();
+
+    std::vector<rpc::SensorMetrics> GetSensorMetrics();
+
+    void SetSensorMetricsEnabled(bool enabled);
+
+    rpc::MemoryReport GetServerMemoryReport();
+
+    std::string GetServerFrameTrace();
+
+    void SetServerFrameTracerEnabled(bool enabled);
+
     void LoadEpisode(std::string map_name);
 
+    void LoadEpisodeAsync(std::string map_name, std::vector<std::string> preload_assets);
+
+    rpc::MapLoadProgress GetMapLoadProgress();
+
+    void ResetEpisode();
+
+    uint64_t SaveEpisodeState();
+
+    void RestoreEpisodeState(uint64_t snapshot_id);
+
+    bool DropEpisodeState(uint64_t snapshot_id);
+
     rpc::EpisodeInfo GetEpisodeInfo();
 
+    /// Open a stream of the episode state sending only the actors matching
+    /// @a filter, or return the one with every actor if @a filter is empty.
+    streaming::Token OpenFilteredEpisodeStream(const rpc::EpisodeStateFilter &filter);
+
     rpc::MapInfo GetMapInfo();
 
     std::vector<uint8_t> GetNavigationMesh() const;
 
+    /// Map name and hash of the navigation mesh, cheap to check before
+    /// downloading it with GetNavigationMesh.
+    rpc::NavigationMeshInfo GetNavigationMeshInfo() const;
+
     std::vector<std::string> GetAvailableMaps();
 
     std::vector<rpc::ActorDefinition> GetActorDefinitions();
 
+    /// Hash of the actor definitions, cheap to check before downloading them
+    /// with GetActorDefinitions.
+    uint64_t GetActorDefinitionsVersion();
+
     rpc::Actor GetSpectator();
 
     rpc::EpisodeSettings GetEpisodeSettings();
@@ -93,11 +153,18 @@ namespace detail {
 
     void SetWeatherParameters(const rpc::WeatherParameters &weather);
 
+    rpc::AutopilotSettings GetAutopilotSettings();
+
+    void SetAutopilotSettings(const rpc::AutopilotSettings &settings);
+
     std::vector<rpc::Actor> GetActorsById(const std::vector<ActorId> &ids);
 
     rpc::VehiclePhysicsControl GetVehiclePhysicsControl(
         const rpc::ActorId &vehicle) const;
 
+    Future<rpc::VehiclePhysicsControl> GetVehiclePhysicsControlAsync(
+        const rpc::ActorId &vehicle) const;
+
     void ApplyPhysicsControlToVehicle(
         const rpc::ActorId &vehicle,
         const rpc::VehiclePhysicsControl &physics_control);
@@ -106,12 +173,22 @@ namespace detail {
         const rpc::ActorDescription &description,
         const geom::Transform &transform);
 
+    Future<rpc::Actor> SpawnActorAsync(
+        const rpc::ActorDescription &description,
+        const geom::Transform &transform);
+
     rpc::Actor SpawnActorWithParent(
         const rpc::ActorDescription &description,
         const geom::Transform &transform,
         rpc::ActorId parent,
         rpc::AttachmentType attachment_type);
 
+    Future<rpc::Actor> SpawnActorWithParentAsync(
+        const rpc::ActorDescription &description,
+        const geom::Transform &transform,
+        rpc::ActorId parent,
+        rpc::AttachmentType attachment_type);
+
     bool DestroyActor(rpc::ActorId actor);
 
     void SetActorLocation(
@@ -138,6 +215,10 @@ namespace detail {
         rpc::ActorId actor,
         bool enabled);
 
+    void SetActorKinematic(
+        rpc::ActorId actor,
+        bool enabled);
+
     void SetActorAutopilot(
         rpc::ActorId vehicle,
         bool enabled);
@@ -154,6 +235,19 @@ namespace detail {
         rpc::ActorId walker,
         const rpc::WalkerBoneControl &control);
 
+    /// @name Navigation of the walkers run by the server.
+    /// @{
+
+    void AddWalkerToNavigation(rpc::ActorId walker);
+
+    bool RemoveWalkerFromNavigation(rpc::ActorId walker);
+
+    bool SetWalkerNavigationTarget(rpc::ActorId walker, const geom::Location &target);
+
+    bool SetWalkerNavigationMaxSpeed(rpc::ActorId walker, float max_speed);
+
+    /// @}
+
     void SetTrafficLightState(
         rpc::ActorId traffic_light,
         const rpc::TrafficLightState trafficLightState);
@@ -177,6 +271,9 @@ namespace detail {
     std::vector<ActorId> GetGroupTrafficLights(
         const rpc::ActorId &traffic_light);
 
+    Future<std::vector<ActorId>> GetGroupTrafficLightsAsync(
+        const rpc::ActorId &traffic_light);
+
     std::string StartRecorder(std::string name);
 
     void StopRecorder();
@@ -187,10 +284,28 @@ namespace detail {
 
     std::string ShowRecorderActorsBlocked(std::string name, double min_time, double min_distance);
 
+    rpc::RecorderFileInfo GetRecorderFileInfo(std::string name);
+
+    rpc::RecorderCollisions GetRecorderCollisions(std::string name, char type1, char type2);
+
+    rpc::RecorderBlockedActors GetRecorderActorsBlocked(std::string name, double min_time, double min_distance);
+
     std::string ReplayFile(std::string name, double start, double duration, uint32_t follow_id);
 
     void SetReplayerTimeFactor(double time_factor);
 
+    void SetReplayerInterpolation(bool enabled);
+
+    void SetReplayerFrameByFrame(bool enabled);
+
+    rpc::ActorId GetReplayerActorId(rpc::ActorId recorded_id);
+
+    void SetRecorderKeyFrameInterval(double seconds);
+
+    void SetRecorderCompression(bool enabled);
+
+    void SetRecorderFilter(const rpc::RecorderFilter &filter);
+
     void SubscribeToStream(
         const streaming::Token &token,
         std::function<void(Buffer)> callback);
@@ -199,6 +314,8 @@ namespace detail {
 
     void DrawDebugShape(const rpc::DebugShape &shape);
 
+    void DrawDebugShapes(const std::vector<rpc::DebugShape> &shapes);
+
     void ApplyBatch(
         std::vector<rpc::Command> commands,
         bool do_tick_cue);
@@ -207,8 +324,32 @@ namespace detail {
         std::vector<rpc::Command> commands,
         bool do_tick_cue);
 
+    /// Apply every control of @a batch without waiting for the response.
+    void ApplyVehicleControlBatch(const rpc::VehicleControlBatch &batch);
+
+    /// Apply every walker state of @a batch without waiting for the response.
+    void ApplyWalkerStateBatch(const rpc::WalkerStateBatch &batch);
+
+    /// Apply every transform of @a batch without waiting for the response.
+    void ApplyTransformBatch(const rpc::TransformBatch &batch);
+
+    /// Register the bones named @a bone_names, returns the id of the bone set
+    /// the bone indices of a WalkerBoneControlBatch refer to.
+    uint32_t RegisterWalkerBones(const std::vector<std::string> &bone_names);
+
+    /// Apply every bone transform of @a batch without waiting for the
+    /// response.
+    void ApplyWalkerBoneControlBatch(const rpc::WalkerBoneControlBatch &batch);
+
+    rpc::RayHitBatch CastRays(const rpc::RayCastBatch &batch);
+
+    rpc::BoxOverlapResultBatch OverlapBoxes(const rpc::BoxOverlapBatch &batch);
+
     uint64_t SendTickCue();
 
+    /// Start @a frames frames, returns the id of the last one.
+    uint64_t SendTickCues(uint32_t frames, bool skip_intermediate_frames);
+
   private:
 
     class Pimpl;
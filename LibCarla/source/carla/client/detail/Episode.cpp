@@ -7,8 +7,13 @@
 #include "carla/client/detail/Episode.h"
 
 #include "carla/Logging.h"
+#include "carla/client/Actor.h"
+#include "carla/client/Map.h"
+#include "carla/client/detail/ActorFactory.h"
 #include "carla/client/detail/Client.h"
+#include "carla/client/detail/LaneInvasionBatch.h"
 #include "carla/client/detail/WalkerNavigation.h"
+#include "carla/profiler/FrameTracer.h"
 #include "carla/sensor/Deserializer.h"
 
 #include <exception>
@@ -17,18 +22,26 @@ namespace carla {
 namespace client {
 namespace detail {
 
-  static auto &CastData(const sensor::SensorData &data) {
+  /// Send the queued debug shapes once this many are waiting, even if no tick
+  /// arrived yet.
+  static constexpr size_t MAX_QUEUED_DEBUG_SHAPES = 2048u;
+
+  static auto CastData(SharedPtr<sensor::SensorData> data) {
     using target_t = const sensor::data::RawEpisodeState;
-    return static_cast<target_t &>(data);
+    return boost::static_pointer_cast<target_t>(std::move(data));
   }
 
-  template <typename RangeT>
-  static auto GetActorsById_Impl(Client &client, CachedActorList &actors, const RangeT &actor_ids) {
+  template <typename RangeT, typename... Args>
+  static auto GetActorsById_Impl(
+      Client &client,
+      CachedActorList &actors,
+      const RangeT &actor_ids,
+      Args &&... args) {
     auto missing_ids = actors.GetMissingIds(actor_ids);
     if (!missing_ids.empty()) {
       actors.InsertRange(client.GetActorsById(missing_ids));
     }
-    return actors.GetActorsById(actor_ids);
+    return actors.GetActorsById(actor_ids, std::forward<Args>(args)...);
   }
 
   Episode::Episode(Client &client)
@@ -41,6 +54,7 @@ namespace detail {
 
   Episode::~Episode() {
     try {
+      std::lock_guard<std::mutex> lock(_token_mutex);
       _client.UnSubscribeFromStream(_token);
     } catch (const std::exception &e) {
       log_error("exception trying to disconnect from episode:", e.what());
@@ -48,14 +62,45 @@ namespace detail {
   }
 
   void Episode::Listen() {
+    std::lock_guard<std::mutex> lock(_token_mutex);
+    Subscribe(_token);
+  }
+
+  void Episode::SetStateFilter(const rpc::EpisodeStateFilter &filter) {
+    auto token = _client.OpenFilteredEpisodeStream(filter);
+    std::lock_guard<std::mutex> lock(_token_mutex);
+    if (token.data == _token.data) {
+      return;
+    }
+    // Unsubscribed first, so frames of both streams are never mixed.
+    _client.UnSubscribeFromStream(_token);
+    _token = token;
+    Subscribe(_token);
+  }
+
+  void Episode::Subscribe(const streaming::Token &token) {
     std::weak_ptr<Episode> weak = shared_from_this();
-    _client.SubscribeToStream(_token, [weak](auto buffer) {
+    _client.SubscribeToStream(token, [weak](auto buffer) {
       auto self = weak.lock();
       if (self != nullptr) {
+        profiler::FrameTraceSpan span("episode.on_tick");
         auto data = sensor::Deserializer::Deserialize(std::move(buffer));
 
-        auto next = std::make_shared<const EpisodeState>(CastData(*data));
+        auto state = CastData(std::move(data));
+        span.SetFrame(state->GetFrame());
         auto prev = self->GetState();
+
+        std::shared_ptr<const EpisodeState> next;
+        if (state->IsDelta()) {
+          if ((prev->GetEpisodeId() != state->GetEpisodeId()) ||
+              (prev->GetFrame() != state->GetBaseFrame())) {
+            // We don't have the frame it is based on, wait for a full frame.
+            return;
+          }
+          next = std::make_shared<const EpisodeState>(*prev, *state);
+        } else {
+          next = std::make_shared<const EpisodeState>(std::move(state));
+        }
         do {
           if (prev->GetFrame() >= next->GetFrame()) {
             self->_on_tick_callbacks.Call(next);
@@ -76,7 +121,18 @@ namespace detail {
           navigation->Tick(*next);
         }
 
+        // Shapes drawn since the last tick, in asynchronous mode nobody else
+        // sends them.
+        self->FlushDebugShapes();
+
+        // Tick lane invasion sensors.
+        auto lane_invasion = self->_lane_invasion.load();
+        if (lane_invasion != nullptr) {
+          lane_invasion->Tick(next);
+        }
+
         // Call user callbacks.
+        CARLA_TRACE_FRAME(episode, user_callbacks, next->GetFrame());
         self->_on_tick_callbacks.Call(next);
       }
     });
@@ -94,6 +150,40 @@ namespace detail {
     return actor;
   }
 
+  SharedPtr<Actor> Episode::GetActorInstance(EpisodeProxy episode, rpc::Actor actor) {
+    return _actors.GetOrMakeInstance(std::move(actor), [&](const rpc::Actor &description, ActorKind kind) {
+      return ActorFactory::MakeActor(
+          std::move(episode),
+          description,
+          kind,
+          GarbageCollectionPolicy::Disabled);
+    });
+  }
+
+  void Episode::DrawDebugShape(const rpc::DebugShape &shape) {
+    std::vector<rpc::DebugShape> full;
+    {
+      std::lock_guard<std::mutex> lock(_debug_shapes_mutex);
+      _debug_shapes.emplace_back(shape);
+      if (_debug_shapes.size() < MAX_QUEUED_DEBUG_SHAPES) {
+        return;
+      }
+      full.swap(_debug_shapes);
+    }
+    _client.DrawDebugShapes(full);
+  }
+
+  void Episode::FlushDebugShapes() {
+    std::vector<rpc::DebugShape> shapes;
+    {
+      std::lock_guard<std::mutex> lock(_debug_shapes_mutex);
+      shapes.swap(_debug_shapes);
+    }
+    if (!shapes.empty()) {
+      _client.DrawDebugShapes(shapes);
+    }
+  }
+
   std::shared_ptr<WalkerNavigation> Episode::CreateNavigationIfMissing() {
     std::shared_ptr<WalkerNavigation> navigation;
     do {
@@ -106,6 +196,19 @@ namespace detail {
     return navigation;
   }
 
+  std::shared_ptr<LaneInvasionBatch> Episode::CreateLaneInvasionBatchIfMissing() {
+    std::shared_ptr<LaneInvasionBatch> lane_invasion;
+    do {
+      lane_invasion = _lane_invasion.load();
+      if (lane_invasion == nullptr) {
+        auto new_lane_invasion = std::make_shared<LaneInvasionBatch>(
+            MakeShared<Map>(_client.GetMapInfo()));
+        _lane_invasion.compare_exchange(&lane_invasion, new_lane_invasion);
+      }
+    } while (lane_invasion == nullptr);
+    return lane_invasion;
+  }
+
   std::vector<rpc::Actor> Episode::GetActorsById(const std::vector<ActorId> &actor_ids) {
     return GetActorsById_Impl(_client, _actors, actor_ids);
   }
@@ -114,10 +217,15 @@ namespace detail {
     return GetActorsById_Impl(_client, _actors, GetState()->GetActorIds());
   }
 
+  std::vector<rpc::Actor> Episode::GetActors(const std::string &wildcard_pattern) {
+    return GetActorsById_Impl(_client, _actors, GetState()->GetActorIds(), wildcard_pattern);
+  }
+
   void Episode::OnEpisodeStarted() {
     _actors.Clear();
     _on_tick_callbacks.Clear();
     _navigation.reset();
+    _lane_invasion.reset();
   }
 
 } // namespace detail
@@ -13,9 +13,13 @@
 #include "carla/client/WorldSnapshot.h"
 #include "carla/client/detail/CachedActorList.h"
 #include "carla/client/detail/CallbackList.h"
+#include "carla/client/detail/EpisodeProxy.h"
 #include "carla/client/detail/EpisodeState.h"
+#include "carla/rpc/DebugShape.h"
 #include "carla/rpc/EpisodeInfo.h"
+#include "carla/rpc/EpisodeStateFilter.h"
 
+#include <mutex>
 #include <vector>
 
 namespace carla {
@@ -23,6 +27,7 @@ namespace client {
 namespace detail {
 
   class Client;
+  class LaneInvasionBatch;
   class WalkerNavigation;
 
   /// Holds the current episode, and the current episode state.
@@ -41,6 +46,12 @@ namespace detail {
 
     void Listen();
 
+    /// Listen to a stream sending only the actors matching @a filter instead
+    /// of every actor, see rpc::EpisodeStateFilter. The actors filtered out
+    /// are missing from the episode state. An empty filter listens to every
+    /// actor again.
+    void SetStateFilter(const rpc::EpisodeStateFilter &filter);
+
     auto GetId() const {
       return GetState()->GetEpisodeId();
     }
@@ -51,10 +62,16 @@ namespace detail {
 
     std::shared_ptr<WalkerNavigation> CreateNavigationIfMissing();
 
+    /// Null if the client-side navigation was not created yet.
     std::shared_ptr<WalkerNavigation> GetNavigation() const {
-      auto nav = _navigation.load();
-      DEBUG_ASSERT(nav != nullptr);
-      return nav;
+      return _navigation.load();
+    }
+
+    std::shared_ptr<LaneInvasionBatch> CreateLaneInvasionBatchIfMissing();
+
+    /// Return nullptr if no lane invasion sensor listened in this episode.
+    std::shared_ptr<LaneInvasionBatch> GetLaneInvasionBatch() const {
+      return _lane_invasion.load();
     }
 
     void RegisterActor(rpc::Actor actor) {
@@ -63,10 +80,27 @@ namespace detail {
 
     boost::optional<rpc::Actor> GetActorById(ActorId id);
 
+    /// Return the client object of @a actor, without garbage collection. The
+    /// same object is returned while someone holds it, so iterating the
+    /// actors repeatedly does not make new ones each time.
+    SharedPtr<Actor> GetActorInstance(EpisodeProxy episode, rpc::Actor actor);
+
     std::vector<rpc::Actor> GetActorsById(const std::vector<ActorId> &actor_ids);
 
     std::vector<rpc::Actor> GetActors();
 
+    /// Return the actors in the episode whose type id matches
+    /// @a wildcard_pattern.
+    std::vector<rpc::Actor> GetActors(const std::string &wildcard_pattern);
+
+    /// For each of @a actor_ids, whether the type id of the actor matches
+    /// @a wildcard_pattern, or empty optional if the actor is not known.
+    std::vector<boost::optional<bool>> MatchTypeIds(
+        const std::vector<ActorId> &actor_ids,
+        const std::string &wildcard_pattern) const {
+      return _actors.MatchTypeIds(actor_ids, wildcard_pattern);
+    }
+
     boost::optional<WorldSnapshot> WaitForState(time_duration timeout) {
       return _snapshot.WaitFor(timeout);
     }
@@ -75,29 +109,59 @@ namespace detail {
       return _on_tick_callbacks.Push(std::move(callback));
     }
 
+    /// The callback is called on a dedicated thread instead of the one
+    /// receiving the episode state, with only the latest snapshot if it is
+    /// still busy when new ones arrive.
+    size_t RegisterOnTickEventAsync(std::function<void(WorldSnapshot)> callback) {
+      return _on_tick_callbacks.PushAsync(std::move(callback));
+    }
+
+    boost::optional<CallbackStats> GetOnTickEventStats(size_t id) const {
+      return _on_tick_callbacks.GetStats(id);
+    }
+
     void RemoveOnTickEvent(size_t id) {
       _on_tick_callbacks.Remove(id);
     }
 
+    /// Queue @a shape to be sent with the rest of the shapes drawn before the
+    /// next tick, in a single "draw_debug_shapes" call.
+    void DrawDebugShape(const rpc::DebugShape &shape);
+
+    /// Send the debug shapes queued so far.
+    void FlushDebugShapes();
+
   private:
 
     Episode(Client &client, const rpc::EpisodeInfo &info);
 
     void OnEpisodeStarted();
 
+    /// @pre _token_mutex is locked.
+    void Subscribe(const streaming::Token &token);
+
     Client &_client;
 
     AtomicSharedPtr<const EpisodeState> _state;
 
     AtomicSharedPtr<WalkerNavigation> _navigation;
 
+    AtomicSharedPtr<LaneInvasionBatch> _lane_invasion;
+
     CachedActorList _actors;
 
     CallbackList<WorldSnapshot> _on_tick_callbacks;
 
     RecurrentSharedFuture<WorldSnapshot> _snapshot;
 
-    const streaming::Token _token;
+    std::mutex _debug_shapes_mutex;
+
+    std::vector<rpc::DebugShape> _debug_shapes;
+
+    std::mutex _token_mutex;
+
+    /// Token of the stream listened to.
+    streaming::Token _token;
   };
 
 } // namespace detail
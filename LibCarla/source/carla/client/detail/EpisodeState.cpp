@@ -6,31 +6,118 @@
 
 #include "carla/client/detail/EpisodeState.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace carla {
 namespace client {
 namespace detail {
 
-  EpisodeState::EpisodeState(const sensor::data::RawEpisodeState &state)
-    : _episode_id(state.GetEpisodeId()),
+  using ActorIndex = std::vector<std::pair<ActorId, uint32_t>>;
+
+  /// Id and position of every actor in [@a begin, @a end), sorted by id.
+  template <typename ActorT>
+  static ActorIndex MakeIndex(const ActorT *begin, const ActorT *end) {
+    DEBUG_ASSERT(std::distance(begin, end) <= std::numeric_limits<uint32_t>::max());
+    ActorIndex index;
+    index.reserve(static_cast<size_t>(std::distance(begin, end)));
+    uint32_t position = 0u;
+    for (auto it = begin; it != end; ++it) {
+      index.emplace_back(static_cast<ActorId>(it->id), position++);
+    }
+    // The server usually sends the actors already sorted.
+    const auto compare_ids = [](const auto &lhs, const auto &rhs) {
+      return lhs.first < rhs.first;
+    };
+    if (!std::is_sorted(index.begin(), index.end(), compare_ids)) {
+      std::sort(index.begin(), index.end(), compare_ids);
+    }
+    DEBUG_ASSERT(std::adjacent_find(index.begin(), index.end(), [](const auto &lhs, const auto &rhs) {
+      return lhs.first == rhs.first;
+    }) == index.end());
+    return index;
+  }
+
+  static ActorIndex MakeIndex(const sensor::data::RawEpisodeState &state) {
+    if (state.IsCompact()) {
+      const auto actors = state.GetCompactActors();
+      return MakeIndex(actors.begin(), actors.end());
+    }
+    const auto actors = state.GetActors();
+    return MakeIndex(actors.begin(), actors.end());
+  }
+
+  /// The entry of @a id in @a index, or its end if not present.
+  static ActorIndex::const_iterator FindInIndex(const ActorIndex &index, ActorId id) {
+    auto it = std::lower_bound(
+        index.begin(),
+        index.end(),
+        id,
+        [](const auto &entry, ActorId actor_id) { return entry.first < actor_id; });
+    return ((it != index.end()) && (it->first == id)) ? it : index.end();
+  }
+
+  EpisodeState::EpisodeState(SharedPtr<const sensor::data::RawEpisodeState> state)
+    : _episode_id(state->GetEpisodeId()),
+      _timestamp(
+          state->GetFrame(),
+          state->GetGameTimeStamp(),
+          state->GetDeltaSeconds(),
+          state->GetPlatformTimeStamp()),
+      _state(std::move(state)) {
+    DEBUG_ASSERT(!_state->IsDelta());
+    _index = MakeIndex(*_state);
+  }
+
+  EpisodeState::EpisodeState(
+      const EpisodeState &previous,
+      const sensor::data::RawEpisodeState &delta)
+    : _episode_id(delta.GetEpisodeId()),
       _timestamp(
-          state.GetFrame(),
-          state.GetGameTimeStamp(),
-          state.GetDeltaSeconds(),
-          state.GetPlatformTimeStamp()) {
-    _actors.reserve(state.size());
-    for (auto &&actor : state) {
-      DEBUG_ONLY(auto result = )
-      _actors.emplace(
-          actor.id,
-          ActorSnapshot{
-              actor.id,
-              actor.transform,
-              actor.velocity,
-              actor.angular_velocity,
-              actor.acceleration,
-              actor.state});
-      DEBUG_ASSERT(result.second);
+          delta.GetFrame(),
+          delta.GetGameTimeStamp(),
+          delta.GetDeltaSeconds(),
+          delta.GetPlatformTimeStamp()) {
+    DEBUG_ASSERT(delta.IsDelta());
+    DEBUG_ASSERT(previous.GetEpisodeId() == delta.GetEpisodeId());
+    DEBUG_ASSERT(previous.GetFrame() == delta.GetBaseFrame());
+    auto destroyed_ids = delta.GetDestroyedActorIds();
+    std::vector<ActorId> destroyed(destroyed_ids.begin(), destroyed_ids.end());
+    std::sort(destroyed.begin(), destroyed.end());
+    const auto changed = MakeIndex(delta);
+    std::vector<bool> merged(changed.size(), false);
+    // Keep the order of the previous state, the new actors go at the end.
+    const auto previous_size = static_cast<uint32_t>(previous.size());
+    _merged_actors.reserve(previous.size() + delta.size());
+    for (auto position = 0u; position < previous_size; ++position) {
+      const ActorDynamicState actor = previous.GetActorAt(position);
+      const ActorId id = actor.id;
+      if (std::binary_search(destroyed.begin(), destroyed.end(), id)) {
+        continue;
+      }
+      auto entry = FindInIndex(changed, id);
+      if (entry != changed.end()) {
+        _merged_actors.emplace_back(delta.GetActor(entry->second));
+        merged[std::distance(changed.begin(), entry)] = true;
+      } else {
+        _merged_actors.emplace_back(actor);
+      }
+    }
+    for (auto i = 0u; i < changed.size(); ++i) {
+      if (!merged[i]) {
+        _merged_actors.emplace_back(delta.GetActor(changed[i].second));
+      }
+    }
+    _index = MakeIndex(_merged_actors.data(), _merged_actors.data() + _merged_actors.size());
+  }
+
+  boost::optional<uint32_t> EpisodeState::Find(ActorId id) const {
+    boost::optional<uint32_t> position;
+    auto it = FindInIndex(_index, id);
+    if (it != _index.end()) {
+      position = it->second;
     }
+    return position;
   }
 
 } // namespace detail
@@ -8,21 +8,30 @@
 
 #include "carla/Iterator.h"
 #include "carla/ListView.h"
+#include "carla/Memory.h"
 #include "carla/NonCopyable.h"
 #include "carla/client/ActorSnapshot.h"
 #include "carla/client/Timestamp.h"
 #include "carla/sensor/data/RawEpisodeState.h"
 
+#include <boost/iterator/counting_iterator.hpp>
 #include <boost/optional.hpp>
 
+#include <cstdint>
 #include <memory>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace carla {
 namespace client {
 namespace detail {
 
   /// Represents the state of all the actors of an episode at a given frame.
+  ///
+  /// The state is kept as received, the actors are looked up by id in a
+  /// sorted index over the received array and their ActorSnapshot is made,
+  /// decoding the compact ones, only when requested. Delta frames are merged
+  /// with the previous state into an array of their own.
   class EpisodeState
     : std::enable_shared_from_this<EpisodeState>,
       private NonCopyable {
@@ -30,7 +39,13 @@ namespace detail {
 
     explicit EpisodeState(uint64_t episode_id) : _episode_id(episode_id) {}
 
-    explicit EpisodeState(const sensor::data::RawEpisodeState &state);
+    /// @pre @a state is a full frame.
+    explicit EpisodeState(SharedPtr<const sensor::data::RawEpisodeState> state);
+
+    /// Apply the delta frame @a delta on top of @a previous.
+    ///
+    /// @pre @a delta is a delta frame based on the frame of @a previous.
+    EpisodeState(const EpisodeState &previous, const sensor::data::RawEpisodeState &delta);
 
     auto GetEpisodeId() const {
       return _episode_id;
@@ -45,54 +60,97 @@ namespace detail {
     }
 
     bool ContainsActorSnapshot(ActorId actor_id) const {
-      return _actors.find(actor_id) != _actors.end();
+      return Find(actor_id).is_initialized();
     }
 
     ActorSnapshot GetActorSnapshot(ActorId id) const {
-      ActorSnapshot state;
-      CopyActorSnapshotIfPresent(id, state);
-      return state;
+      const auto position = Find(id);
+      return position ? GetActorSnapshotAt(*position) : ActorSnapshot{};
     }
 
     boost::optional<ActorSnapshot> GetActorSnapshotIfPresent(ActorId id) const {
       boost::optional<ActorSnapshot> state;
-      CopyActorSnapshotIfPresent(id, state);
+      const auto position = Find(id);
+      if (position) {
+        state = GetActorSnapshotAt(*position);
+      }
       return state;
     }
 
+    /// The ids of the actors, in increasing order.
     auto GetActorIds() const {
       return MakeListView(
-          iterator::make_map_keys_const_iterator(_actors.begin()),
-          iterator::make_map_keys_const_iterator(_actors.end()));
+          iterator::make_map_keys_const_iterator(_index.begin()),
+          iterator::make_map_keys_const_iterator(_index.end()));
     }
 
     size_t size() const {
-      return _actors.size();
+      return _index.size();
     }
 
+    /// Iterates the actors in the order they were received, each
+    /// ActorSnapshot is made when dereferenced.
     auto begin() const {
-      return iterator::make_map_values_const_iterator(_actors.begin());
+      return boost::make_transform_iterator(
+          boost::counting_iterator<uint32_t>(0u),
+          SnapshotAt{this});
     }
 
     auto end() const {
-      return iterator::make_map_values_const_iterator(_actors.end());
+      return boost::make_transform_iterator(
+          boost::counting_iterator<uint32_t>(static_cast<uint32_t>(size())),
+          SnapshotAt{this});
     }
 
   private:
 
-    template <typename T>
-    void CopyActorSnapshotIfPresent(ActorId id, T &value) const {
-      auto it = _actors.find(id);
-      if (it != _actors.end()) {
-        value = it->second;
+    using ActorDynamicState = sensor::data::ActorDynamicState;
+
+    struct SnapshotAt {
+      const EpisodeState *self;
+
+      ActorSnapshot operator()(uint32_t position) const {
+        return self->GetActorSnapshotAt(position);
       }
+    };
+
+    static ActorSnapshot MakeActorSnapshot(const ActorDynamicState &actor) {
+      return ActorSnapshot{
+          actor.id,
+          actor.transform,
+          actor.velocity,
+          actor.angular_velocity,
+          actor.acceleration,
+          actor.state};
     }
 
+    /// The state of the actor at @a position in the order received.
+    ActorDynamicState GetActorAt(uint32_t position) const {
+      if (_state == nullptr) {
+        return _merged_actors[position];
+      }
+      return _state->GetActor(position);
+    }
+
+    ActorSnapshot GetActorSnapshotAt(uint32_t position) const {
+      return MakeActorSnapshot(GetActorAt(position));
+    }
+
+    /// The position of actor @a id, if present.
+    boost::optional<uint32_t> Find(ActorId id) const;
+
     const uint64_t _episode_id;
 
     const Timestamp _timestamp;
 
-    std::unordered_map<ActorId, ActorSnapshot> _actors;
+    /// Keeps the received buffer alive, null if merged from a delta frame.
+    const SharedPtr<const sensor::data::RawEpisodeState> _state;
+
+    /// The actors of a state merged from a delta frame.
+    std::vector<ActorDynamicState> _merged_actors;
+
+    /// Id of each actor and its position in the actors, sorted by id.
+    std::vector<std::pair<ActorId, uint32_t>> _index;
   };
 
 } // namespace detail
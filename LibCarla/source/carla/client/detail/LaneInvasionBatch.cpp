@@ -0,0 +1,160 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/detail/LaneInvasionBatch.h"
+
+#include "carla/AtomicSharedPtr.h"
+#include "carla/Logging.h"
+#include "carla/client/Map.h"
+#include "carla/client/Vehicle.h"
+#include "carla/client/WorldSnapshot.h"
+#include "carla/geom/Location.h"
+#include "carla/geom/Transform.h"
+#include "carla/sensor/data/LaneInvasionEvent.h"
+
+#include <array>
+#include <exception>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  // ===========================================================================
+  // -- LaneInvasionCallback ---------------------------------------------------
+  // ===========================================================================
+
+  class LaneInvasionCallback {
+  public:
+
+    LaneInvasionCallback(
+        const Vehicle &vehicle,
+        Sensor::CallbackFunctionType &&user_callback)
+      : _parent(vehicle.GetId()),
+        _parent_bounding_box(vehicle.GetBoundingBox()),
+        _callback(std::move(user_callback)) {}
+
+    void Tick(const WorldSnapshot &snapshot, const Map &map) const;
+
+  private:
+
+    struct Bounds {
+      size_t frame;
+      std::array<geom::Location, 4u> corners;
+    };
+
+    std::shared_ptr<const Bounds> MakeBounds(
+        size_t frame,
+        const geom::Transform &vehicle_transform) const;
+
+    ActorId _parent;
+
+    geom::BoundingBox _parent_bounding_box;
+
+    Sensor::CallbackFunctionType _callback;
+
+    mutable AtomicSharedPtr<const Bounds> _bounds;
+  };
+
+  void LaneInvasionCallback::Tick(const WorldSnapshot &snapshot, const Map &map) const {
+    // Make sure the parent is alive.
+    auto parent = snapshot.Find(_parent);
+    if (!parent) {
+      return;
+    }
+
+    auto next = MakeBounds(snapshot.GetFrame(), parent->transform);
+    auto prev = _bounds.load();
+
+    // First frame it'll be null.
+    if ((prev == nullptr) && _bounds.compare_exchange(&prev, next)) {
+      return;
+    }
+
+    // Make sure the distance is long enough.
+    constexpr float distance_threshold = 10.0f * std::numeric_limits<float>::epsilon();
+    for (auto i = 0u; i < 4u; ++i) {
+      if ((next->corners[i] - prev->corners[i]).Length() < distance_threshold) {
+        return;
+      }
+    }
+
+    // Make sure the current frame is up-to-date.
+    do {
+      if (prev->frame >= next->frame) {
+        return;
+      }
+    } while (!_bounds.compare_exchange(&prev, next));
+
+    // Finally it's safe to compute the crossed lanes.
+    std::vector<road::element::LaneMarking> crossed_lanes;
+    for (auto i = 0u; i < 4u; ++i) {
+      const auto lanes = map.CalculateCrossedLanes(prev->corners[i], next->corners[i]);
+      crossed_lanes.insert(crossed_lanes.end(), lanes.begin(), lanes.end());
+    }
+
+    if (!crossed_lanes.empty()) {
+      _callback(MakeShared<sensor::data::LaneInvasionEvent>(
+          snapshot.GetTimestamp().frame,
+          snapshot.GetTimestamp().elapsed_seconds,
+          parent->transform,
+          _parent,
+          std::move(crossed_lanes)));
+    }
+  }
+
+  std::shared_ptr<const LaneInvasionCallback::Bounds> LaneInvasionCallback::MakeBounds(
+      const size_t frame,
+      const geom::Transform &transform) const {
+    const auto &box = _parent_bounding_box;
+    auto bounds = std::make_shared<Bounds>(Bounds{frame, {{
+        geom::Location( box.extent.x,  box.extent.y, 0.0f),
+        geom::Location(-box.extent.x,  box.extent.y, 0.0f),
+        geom::Location( box.extent.x, -box.extent.y, 0.0f),
+        geom::Location(-box.extent.x, -box.extent.y, 0.0f)}}});
+    // Only the yaw of the vehicle matters.
+    const geom::Transform yaw_transform{
+        transform.location + box.location,
+        geom::Rotation(0.0f, transform.rotation.yaw, 0.0f)};
+    yaw_transform.TransformPoints(bounds->corners.data(), bounds->corners.size());
+    return bounds;
+  }
+
+  // ===========================================================================
+  // -- LaneInvasionBatch ------------------------------------------------------
+  // ===========================================================================
+
+  LaneInvasionBatch::LaneInvasionBatch(SharedPtr<const Map> map)
+    : _map(std::move(map)) {
+    DEBUG_ASSERT(_map != nullptr);
+    // Build the index now rather than in the first tick.
+    _map->GetLaneMarkingIndex();
+  }
+
+  LaneInvasionBatch::~LaneInvasionBatch() = default;
+
+  size_t LaneInvasionBatch::Register(
+      const Vehicle &vehicle,
+      Sensor::CallbackFunctionType callback) {
+    auto id = ++_counter;
+    DEBUG_ASSERT(id != 0u);
+    _sensors.Push(Item{id, std::make_shared<LaneInvasionCallback>(vehicle, std::move(callback))});
+    return id;
+  }
+
+  void LaneInvasionBatch::Tick(const WorldSnapshot &snapshot) const {
+    auto sensors = _sensors.Load();
+    for (auto &item : *sensors) {
+      try {
+        item.callback->Tick(snapshot, *_map);
+      } catch (const std::exception &e) {
+        log_error("LaneInvasionSensor:", e.what());
+      }
+    }
+  }
+
+} // namespace detail
+} // namespace client
+} // namespace carla
@@ -0,0 +1,76 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/client/Sensor.h"
+#include "carla/AtomicList.h"
+
+#include <atomic>
+#include <memory>
+
+namespace carla {
+namespace client {
+
+  class Map;
+  class Vehicle;
+  class WorldSnapshot;
+
+namespace detail {
+
+  class LaneInvasionCallback;
+
+  /// Evaluates every lane invasion sensor of the episode in a single call per
+  /// world snapshot. The sensors share one map and its lane marking index,
+  /// instead of parsing the map again for each sensor that starts listening.
+  class LaneInvasionBatch : private NonCopyable {
+  public:
+
+    explicit LaneInvasionBatch(SharedPtr<const Map> map);
+
+    ~LaneInvasionBatch();
+
+    /// Start reporting the lane markings crossed by @a vehicle to
+    /// @a callback. Return the id to pass to Unregister.
+    size_t Register(const Vehicle &vehicle, Sensor::CallbackFunctionType callback);
+
+    void Unregister(size_t id) {
+      _sensors.DeleteByValue(id);
+    }
+
+    void Tick(const WorldSnapshot &snapshot) const;
+
+  private:
+
+    struct Item {
+      size_t id;
+      std::shared_ptr<LaneInvasionCallback> callback;
+
+      friend bool operator==(const Item &lhs, const Item &rhs) {
+        return lhs.id == rhs.id;
+      }
+
+      friend bool operator==(const Item &lhs, size_t rhs) {
+        return lhs.id == rhs;
+      }
+
+      friend bool operator==(size_t lhs, const Item &rhs) {
+        return lhs == rhs.id;
+      }
+    };
+
+    const SharedPtr<const Map> _map;
+
+    std::atomic_size_t _counter{0u};
+
+    AtomicList<Item> _sensors;
+  };
+
+} // namespace detail
+} // namespace client
+} // namespace carla
@@ -16,9 +16,15 @@
 #include "carla/client/TimeoutException.h"
 #include "carla/client/WalkerAIController.h"
 #include "carla/client/detail/ActorFactory.h"
+#include "carla/client/detail/LaneInvasionBatch.h"
+#include "carla/profiler/FrameTracer.h"
 #include "carla/sensor/Deserializer.h"
+#include "carla/sensor/data/SensorBundle.h"
 
+#include <algorithm>
+#include <chrono>
 #include <exception>
+#include <stdexcept>
 #include <thread>
 
 using namespace std::string_literals;
@@ -57,9 +63,10 @@ namespace detail {
       const std::string &host,
       const uint16_t port,
       const size_t worker_threads,
-      const bool enable_garbage_collection)
+      const bool enable_garbage_collection,
+      const size_t rpc_connections)
     : LIBCARLA_INITIALIZE_LIFETIME_PROFILER("SimulatorClient("s + host + ":" + std::to_string(port) + ")"),
-      _client(host, port, worker_threads),
+      _client(host, port, worker_threads, rpc_connections),
       _gc_policy(enable_garbage_collection ?
         GarbageCollectionPolicy::Enabled : GarbageCollectionPolicy::Disabled) {}
 
@@ -70,12 +77,27 @@ namespace detail {
   EpisodeProxy Simulator::LoadEpisode(std::string map_name) {
     const auto id = GetCurrentEpisode().GetId();
     _client.LoadEpisode(std::move(map_name));
+    return WaitForNewEpisode(id);
+  }
+
+  EpisodeProxy Simulator::ResetEpisode() {
+    const auto id = GetCurrentEpisode().GetId();
+    _client.ResetEpisode();
+    if (GetEpisodeSettings().synchronous_mode) {
+      // The settings are kept, nobody else would send the frame that brings
+      // the new episode.
+      Tick();
+    }
+    return WaitForNewEpisode(id);
+  }
+
+  EpisodeProxy Simulator::WaitForNewEpisode(const uint64_t previous_id) {
     size_t number_of_attempts = _client.GetTimeout().milliseconds() / 10u;
     for (auto i = 0u; i < number_of_attempts; ++i) {
       using namespace std::literals::chrono_literals;
       _episode->WaitForState(10ms);
       auto episode = GetCurrentEpisode();
-      if (episode.GetId() != id) {
+      if (episode.GetId() != previous_id) {
         return episode;
       }
     }
@@ -117,19 +139,70 @@ namespace detail {
 
   uint64_t Simulator::Tick() {
     DEBUG_ASSERT(_episode != nullptr);
+    profiler::FrameTraceSpan span("client.tick");
+    _episode->FlushDebugShapes();
     const auto frame = _client.SendTickCue();
+    span.SetFrame(frame);
+    _last_tick_cue_frame = frame;
     SynchronizeFrame(frame, *_episode);
     RELEASE_ASSERT(frame == _episode->GetState()->GetTimestamp().frame);
     return frame;
   }
 
+  uint64_t Simulator::TickAsync(const size_t max_pending_ticks) {
+    DEBUG_ASSERT(_episode != nullptr);
+    // Ticks that may still be pending once this one is sent.
+    const uint64_t pending = std::max<size_t>(1u, max_pending_ticks) - 1u;
+    const uint64_t last_frame = _last_tick_cue_frame;
+    if (last_frame > pending) {
+      WaitForFrame(last_frame - pending, _client.GetTimeout());
+    }
+    _episode->FlushDebugShapes();
+    const auto frame = _client.SendTickCue();
+    _last_tick_cue_frame = frame;
+    return frame;
+  }
+
+  uint64_t Simulator::TickN(const uint32_t frames, const bool skip_intermediate_frames) {
+    DEBUG_ASSERT(_episode != nullptr);
+    profiler::FrameTraceSpan span("client.tick_n");
+    _episode->FlushDebugShapes();
+    const auto frame = _client.SendTickCues(std::max(frames, 1u), skip_intermediate_frames);
+    span.SetFrame(frame);
+    _last_tick_cue_frame = frame;
+    SynchronizeFrame(frame, *_episode);
+    return frame;
+  }
+
+  WorldSnapshot Simulator::WaitForFrame(const uint64_t frame, const time_duration timeout) {
+    DEBUG_ASSERT(_episode != nullptr);
+    const auto deadline = std::chrono::steady_clock::now() + timeout.to_chrono();
+    auto state = _episode->GetState();
+    while (state->GetTimestamp().frame < frame) {
+      if (std::chrono::steady_clock::now() >= deadline) {
+        throw_exception(TimeoutException(_client.GetEndpoint(), timeout));
+      }
+      // The frame may be received right before we start waiting for the next
+      // one, wait in short steps to check it again.
+      _episode->WaitForState(time_duration::milliseconds(10u));
+      state = _episode->GetState();
+    }
+    return WorldSnapshot{state};
+  }
+
   // ===========================================================================
   // -- Access to global objects in the episode --------------------------------
   // ===========================================================================
 
   SharedPtr<BlueprintLibrary> Simulator::GetBlueprintLibrary() {
-    auto defs = _client.GetActorDefinitions();
-    return MakeShared<BlueprintLibrary>(std::move(defs));
+    std::lock_guard<std::mutex> lock(_blueprint_library_mutex);
+    const auto version = _client.GetActorDefinitionsVersion();
+    if ((_blueprint_library == nullptr) || (version != _blueprint_library_version)) {
+      auto defs = _client.GetActorDefinitions();
+      _blueprint_library = MakeShared<BlueprintLibrary>(std::move(defs));
+      _blueprint_library_version = version;
+    }
+    return _blueprint_library;
   }
 
   SharedPtr<Actor> Simulator::GetSpectator() {
@@ -142,6 +215,12 @@ namespace detail {
           "synchronous mode enabled with variable delta seconds. It is highly "
           "recommended to set 'fixed_delta_seconds' when running on synchronous mode.");
     }
+    if (settings.substepping && settings.fixed_delta_seconds.has_value() &&
+        (*settings.fixed_delta_seconds > settings.max_substep_delta_time * settings.max_substeps)) {
+      log_warning(
+          "fixed_delta_seconds is longer than max_substep_delta_time * max_substeps, "
+          "the physics substeps will be longer than max_substep_delta_time.");
+    }
     const auto frame = _client.SetEpisodeSettings(settings);
     SynchronizeFrame(frame, *_episode);
     return frame;
@@ -170,9 +249,11 @@ namespace detail {
       return;
     }
     DEBUG_ASSERT(_episode != nullptr);
-    auto navigation = _episode->CreateNavigationIfMissing();
-    DEBUG_ASSERT(navigation != nullptr);
-    navigation->UnregisterWalker(walker->GetId(), controller.GetId());
+    // nothing to unregister if the client-side navigation was never created
+    auto navigation = _episode->GetNavigation();
+    if (navigation != nullptr) {
+      navigation->UnregisterWalker(walker->GetId(), controller.GetId());
+    }
   }
 
   boost::optional<geom::Location> Simulator::GetRandomLocationFromNavigation() {
@@ -182,6 +263,37 @@ namespace detail {
     return navigation->GetRandomLocation();
   }
 
+  void Simulator::SetMaxPedestriansPerRegion(unsigned max_pedestrians) {
+    if (max_pedestrians == 0u) {
+      throw_exception(std::invalid_argument("the maximum number of pedestrians must be positive"));
+    }
+    DEBUG_ASSERT(_episode != nullptr);
+    auto navigation = _episode->CreateNavigationIfMissing();
+    DEBUG_ASSERT(navigation != nullptr);
+    navigation->SetMaxWalkersPerRegion(max_pedestrians);
+  }
+
+  // ===========================================================================
+  // -- Client-side sensors ----------------------------------------------------
+  // ===========================================================================
+
+  size_t Simulator::RegisterLaneInvasionSensor(
+      const Vehicle &vehicle,
+      std::function<void(SharedPtr<sensor::SensorData>)> callback) {
+    DEBUG_ASSERT(_episode != nullptr);
+    auto lane_invasion = _episode->CreateLaneInvasionBatchIfMissing();
+    DEBUG_ASSERT(lane_invasion != nullptr);
+    return lane_invasion->Register(vehicle, std::move(callback));
+  }
+
+  void Simulator::UnregisterLaneInvasionSensor(const size_t id) {
+    DEBUG_ASSERT(_episode != nullptr);
+    auto lane_invasion = _episode->GetLaneInvasionBatch();
+    if (lane_invasion != nullptr) {
+      lane_invasion->Unregister(id);
+    }
+  }
+
   // ===========================================================================
   // -- General operations with actors -----------------------------------------
   // ===========================================================================
@@ -204,10 +316,43 @@ namespace detail {
           blueprint.MakeActorDescription(),
           transform);
     }
+    return MakeSpawnedActor(actor, gc);
+  }
+
+  Future<SharedPtr<Actor>> Simulator::SpawnActorAsync(
+      const ActorBlueprint &blueprint,
+      const geom::Transform &transform,
+      Actor *parent,
+      rpc::AttachmentType attachment_type,
+      GarbageCollectionPolicy gc) {
+    auto future = (parent != nullptr) ?
+        _client.SpawnActorWithParentAsync(
+            blueprint.MakeActorDescription(),
+            transform,
+            parent->GetId(),
+            attachment_type) :
+        _client.SpawnActorAsync(
+            blueprint.MakeActorDescription(),
+            transform);
+    return future.Then([episode = GetCurrentEpisode(), gc](const rpc::Actor &actor) {
+      return episode.Lock()->MakeSpawnedActor(actor, gc);
+    });
+  }
+
+  SharedPtr<Actor> Simulator::MakeSpawnedActor(
+      const rpc::Actor &actor,
+      GarbageCollectionPolicy gc) {
     DEBUG_ASSERT(_episode != nullptr);
-    _episode->RegisterActor(actor);
     const auto gca = (gc == GarbageCollectionPolicy::Inherit ? _gc_policy : gc);
-    auto result = ActorFactory::MakeActor(GetCurrentEpisode(), actor, gca);
+    SharedPtr<Actor> result;
+    if (gca == GarbageCollectionPolicy::Disabled) {
+      // Registers the actor too.
+      result = _episode->GetActorInstance(GetCurrentEpisode(), actor);
+    } else {
+      // Destroyed when released, it cannot be shared with other queries.
+      _episode->RegisterActor(actor);
+      result = ActorFactory::MakeActor(GetCurrentEpisode(), actor, gca);
+    }
     log_debug(
         result->GetDisplayId(),
         "created",
@@ -240,8 +385,16 @@ namespace detail {
     _client.SubscribeToStream(
         sensor.GetActorDescription().GetStreamToken(),
         [cb=std::move(callback), ep=WeakEpisodeProxy{shared_from_this()}](auto buffer) {
+          profiler::FrameTraceSpan span("sensor.on_data");
           auto data = sensor::Deserializer::Deserialize(std::move(buffer));
+          span.SetFrame(data->GetFrame());
           data->_episode = ep.TryLock();
+          auto *bundle = dynamic_cast<sensor::data::SensorBundle *>(data.get());
+          if (bundle != nullptr) {
+            for (auto &reading : *bundle) {
+              reading->_episode = data->_episode;
+            }
+          }
           cb(std::move(data));
         });
   }
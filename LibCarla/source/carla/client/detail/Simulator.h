@@ -23,7 +23,9 @@
 #include "carla/profiler/LifetimeProfiled.h"
 #include "carla/rpc/TrafficLightState.h"
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <optional>
 
 namespace carla {
@@ -53,7 +55,8 @@ namespace detail {
         const std::string &host,
         uint16_t port,
         size_t worker_threads = 0u,
-        bool enable_garbage_collection = false);
+        bool enable_garbage_collection = false,
+        size_t rpc_connections = 1u);
 
     /// @}
     // =========================================================================
@@ -67,6 +70,38 @@ namespace detail {
 
     EpisodeProxy LoadEpisode(std::string map_name);
 
+    void LoadEpisodeAsync(std::string map_name, std::vector<std::string> preload_assets) {
+      _client.LoadEpisodeAsync(std::move(map_name), std::move(preload_assets));
+    }
+
+    rpc::MapLoadProgress GetMapLoadProgress() {
+      return _client.GetMapLoadProgress();
+    }
+
+    /// Start a new episode in the current map without reloading it, see
+    /// Client::ResetWorld.
+    EpisodeProxy ResetEpisode();
+
+    /// Capture the dynamic state of the current episode in the memory of the
+    /// simulator, see World::SaveState.
+    uint64_t SaveEpisodeState() {
+      return _client.SaveEpisodeState();
+    }
+
+    void RestoreEpisodeState(uint64_t snapshot_id) {
+      _client.RestoreEpisodeState(snapshot_id);
+    }
+
+    bool DropEpisodeState(uint64_t snapshot_id) {
+      return _client.DropEpisodeState(snapshot_id);
+    }
+
+    /// Listen to the episode state of the actors matching @a filter only.
+    void SetEpisodeStateFilter(const rpc::EpisodeStateFilter &filter) {
+      DEBUG_ASSERT(_episode != nullptr);
+      _episode->SetStateFilter(filter);
+    }
+
     /// @}
     // =========================================================================
     /// @name Access to current episode
@@ -132,6 +167,38 @@ namespace detail {
       return _client.GetServerVersion();
     }
 
+    std::vector<profiler::ProfilerStats> GetServerProfilerStats() {
+      return _client.GetServerProfilerStats();
+    }
+
+    void SetServerProfilerEnabled(bool enabled) {
+      _client.SetServerProfilerEnabled(enabled);
+    }
+
+    rpc::ServerMetrics GetServerMetrics() {
+      return _client.GetServerMetrics();
+    }
+
+    std::vector<rpc::SensorMetrics> GetSensorMetrics() {
+      return _client.GetSensorMetrics();
+    }
+
+    void SetSensorMetricsEnabled(bool enabled) {
+      _client.SetSensorMetricsEnabled(enabled);
+    }
+
+    rpc::MemoryReport GetServerMemoryReport() {
+      return _client.GetServerMemoryReport();
+    }
+
+    std::string GetServerFrameTrace() {
+      return _client.GetServerFrameTrace();
+    }
+
+    void SetServerFrameTracerEnabled(bool enabled) {
+      _client.SetServerFrameTracerEnabled(enabled);
+    }
+
     /// @}
     // =========================================================================
     /// @name Tick
@@ -145,6 +212,16 @@ namespace detail {
       return _episode->RegisterOnTickEvent(std::move(callback));
     }
 
+    size_t RegisterOnTickEventAsync(std::function<void(WorldSnapshot)> callback) {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->RegisterOnTickEventAsync(std::move(callback));
+    }
+
+    boost::optional<CallbackStats> GetOnTickEventStats(size_t id) const {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->GetOnTickEventStats(id);
+    }
+
     void RemoveOnTickEvent(size_t id) {
       DEBUG_ASSERT(_episode != nullptr);
       _episode->RemoveOnTickEvent(id);
@@ -152,12 +229,27 @@ namespace detail {
 
     uint64_t Tick();
 
+    /// Send a tick cue without waiting for the frame it starts, returns the
+    /// id of that frame. No more than @a max_pending_ticks ticks are left in
+    /// flight, waiting first for the oldest ones if needed.
+    uint64_t TickAsync(size_t max_pending_ticks);
+
+    /// Tick @a frames frames in a single call, returns the id of the last
+    /// one once it is received.
+    uint64_t TickN(uint32_t frames, bool skip_intermediate_frames);
+
+    /// Block until the frame @a frame, or a later one, is received. Returns
+    /// the snapshot of the latest frame received.
+    WorldSnapshot WaitForFrame(uint64_t frame, time_duration timeout);
+
     /// @}
     // =========================================================================
     /// @name Access to global objects in the episode
     // =========================================================================
     /// @{
 
+    /// The library is downloaded again only if the actor definitions of the
+    /// server changed since the last call.
     SharedPtr<BlueprintLibrary> GetBlueprintLibrary();
 
     SharedPtr<Actor> GetSpectator();
@@ -176,10 +268,22 @@ namespace detail {
       _client.SetWeatherParameters(weather);
     }
 
+    rpc::AutopilotSettings GetAutopilotSettings() {
+      return _client.GetAutopilotSettings();
+    }
+
+    void SetAutopilotSettings(const rpc::AutopilotSettings &settings) {
+      _client.SetAutopilotSettings(settings);
+    }
+
     rpc::VehiclePhysicsControl GetVehiclePhysicsControl(const Vehicle &vehicle) const {
       return _client.GetVehiclePhysicsControl(vehicle.GetId());
     }
 
+    Future<rpc::VehiclePhysicsControl> GetVehiclePhysicsControlAsync(const Vehicle &vehicle) const {
+      return _client.GetVehiclePhysicsControlAsync(vehicle.GetId());
+    }
+
     /// @}
     // =========================================================================
     /// @name AI
@@ -192,10 +296,52 @@ namespace detail {
 
     boost::optional<geom::Location> GetRandomLocationFromNavigation();
 
+    void SetMaxPedestriansPerRegion(unsigned max_pedestrians);
+
+    rpc::RayHitBatch CastRays(const rpc::RayCastBatch &batch) {
+      return _client.CastRays(batch);
+    }
+
+    rpc::BoxOverlapResultBatch OverlapBoxes(const rpc::BoxOverlapBatch &batch) {
+      return _client.OverlapBoxes(batch);
+    }
+
     std::shared_ptr<WalkerNavigation> GetNavigation() {
       return _episode->GetNavigation();
     }
 
+    /// Navigation run by the server, see
+    /// rpc::EpisodeSettings::server_side_navigation.
+    void AddWalkerToServerNavigation(const Actor &walker) {
+      _client.AddWalkerToNavigation(walker.GetId());
+    }
+
+    bool RemoveWalkerFromServerNavigation(const Actor &walker) {
+      return _client.RemoveWalkerFromNavigation(walker.GetId());
+    }
+
+    bool SetWalkerServerNavigationTarget(const Actor &walker, const geom::Location &target) {
+      return _client.SetWalkerNavigationTarget(walker.GetId(), target);
+    }
+
+    bool SetWalkerServerNavigationMaxSpeed(const Actor &walker, float max_speed) {
+      return _client.SetWalkerNavigationMaxSpeed(walker.GetId(), max_speed);
+    }
+
+    /// @}
+    // =========================================================================
+    /// @name Client-side sensors
+    // =========================================================================
+    /// @{
+
+    /// Start evaluating a lane invasion sensor attached to @a vehicle in the
+    /// batch of the episode. Return the id to unregister it.
+    size_t RegisterLaneInvasionSensor(
+        const Vehicle &vehicle,
+        std::function<void(SharedPtr<sensor::SensorData>)> callback);
+
+    void UnregisterLaneInvasionSensor(size_t id);
+
     /// @}
     // =========================================================================
     /// @name General operations with actors
@@ -217,6 +363,18 @@ namespace detail {
       return _episode->GetActors();
     }
 
+    std::vector<rpc::Actor> GetAllTheActorsInTheEpisode(const std::string &wildcard_pattern) const {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->GetActors(wildcard_pattern);
+    }
+
+    std::vector<boost::optional<bool>> MatchTypeIds(
+        const std::vector<ActorId> &actor_ids,
+        const std::string &wildcard_pattern) const {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->MatchTypeIds(actor_ids, wildcard_pattern);
+    }
+
     /// Creates an actor instance out of a description of an existing actor.
     /// Note that this does not spawn an actor.
     ///
@@ -227,6 +385,10 @@ namespace detail {
         rpc::Actor actor_description,
         GarbageCollectionPolicy gc = GarbageCollectionPolicy::Disabled) {
       RELEASE_ASSERT(gc != GarbageCollectionPolicy::Inherit);
+      if (gc == GarbageCollectionPolicy::Disabled) {
+        DEBUG_ASSERT(_episode != nullptr);
+        return _episode->GetActorInstance(GetCurrentEpisode(), std::move(actor_description));
+      }
       return ActorFactory::MakeActor(GetCurrentEpisode(), std::move(actor_description), gc);
     }
 
@@ -243,6 +405,17 @@ namespace detail {
         rpc::AttachmentType attachment_type = rpc::AttachmentType::Rigid,
         GarbageCollectionPolicy gc = GarbageCollectionPolicy::Inherit);
 
+    /// Same as SpawnActor but does not wait for the simulator to spawn the
+    /// actor, several actors can be spawned at once this way. The actor is
+    /// registered in the episode when the result of the returned future is
+    /// first retrieved.
+    Future<SharedPtr<Actor>> SpawnActorAsync(
+        const ActorBlueprint &blueprint,
+        const geom::Transform &transform,
+        Actor *parent = nullptr,
+        rpc::AttachmentType attachment_type = rpc::AttachmentType::Rigid,
+        GarbageCollectionPolicy gc = GarbageCollectionPolicy::Inherit);
+
     bool DestroyActor(Actor &actor);
 
     ActorSnapshot GetActorSnapshot(ActorId actor_id) const {
@@ -298,6 +471,10 @@ namespace detail {
       _client.SetActorSimulatePhysics(actor.GetId(), enabled);
     }
 
+    void SetActorKinematic(Actor &actor, bool enabled) {
+      _client.SetActorKinematic(actor.GetId(), enabled);
+    }
+
     /// @}
     // =========================================================================
     /// @name Operations with vehicles
@@ -349,6 +526,18 @@ namespace detail {
       return _client.ShowRecorderActorsBlocked(std::move(name), min_time, min_distance);
     }
 
+    rpc::RecorderFileInfo GetRecorderFileInfo(std::string name) {
+      return _client.GetRecorderFileInfo(std::move(name));
+    }
+
+    rpc::RecorderCollisions GetRecorderCollisions(std::string name, char type1, char type2) {
+      return _client.GetRecorderCollisions(std::move(name), type1, type2);
+    }
+
+    rpc::RecorderBlockedActors GetRecorderActorsBlocked(std::string name, double min_time, double min_distance) {
+      return _client.GetRecorderActorsBlocked(std::move(name), min_time, min_distance);
+    }
+
     std::string ReplayFile(std::string name, double start, double duration, uint32_t follow_id) {
       return _client.ReplayFile(std::move(name), start, duration, follow_id);
     }
@@ -357,6 +546,30 @@ namespace detail {
       _client.SetReplayerTimeFactor(time_factor);
     }
 
+    void SetReplayerInterpolation(bool enabled) {
+      _client.SetReplayerInterpolation(enabled);
+    }
+
+    void SetReplayerFrameByFrame(bool enabled) {
+      _client.SetReplayerFrameByFrame(enabled);
+    }
+
+    ActorId GetReplayerActorId(ActorId recorded_id) {
+      return _client.GetReplayerActorId(recorded_id);
+    }
+
+    void SetRecorderKeyFrameInterval(double seconds) {
+      _client.SetRecorderKeyFrameInterval(seconds);
+    }
+
+    void SetRecorderCompression(bool enabled) {
+      _client.SetRecorderCompression(enabled);
+    }
+
+    void SetRecorderFilter(const rpc::RecorderFilter &filter) {
+      _client.SetRecorderFilter(filter);
+    }
+
     /// @}
     // =========================================================================
     /// @name Operations with sensors
@@ -399,14 +612,26 @@ namespace detail {
       return _client.GetGroupTrafficLights(trafficLight.GetId());
     }
 
+    Future<std::vector<ActorId>> GetGroupTrafficLightsAsync(TrafficLight &trafficLight) {
+      return _client.GetGroupTrafficLightsAsync(trafficLight.GetId());
+    }
+
     /// @}
     // =========================================================================
     /// @name Debug
     // =========================================================================
     /// @{
 
+    /// Shapes are queued and sent together with the next tick, see
+    /// Episode::DrawDebugShape.
     void DrawDebugShape(const rpc::DebugShape &shape) {
-      _client.DrawDebugShape(shape);
+      DEBUG_ASSERT(_episode != nullptr);
+      _episode->DrawDebugShape(shape);
+    }
+
+    void FlushDebugShapes() {
+      DEBUG_ASSERT(_episode != nullptr);
+      _episode->FlushDebugShapes();
     }
 
     /// @}
@@ -423,15 +648,48 @@ namespace detail {
       return _client.ApplyBatchSync(std::move(commands), do_tick_cue);
     }
 
+    void ApplyVehicleControlBatch(const rpc::VehicleControlBatch &batch) {
+      _client.ApplyVehicleControlBatch(batch);
+    }
+
+    void ApplyTransformBatch(const rpc::TransformBatch &batch) {
+      _client.ApplyTransformBatch(batch);
+    }
+
+    uint32_t RegisterWalkerBones(const std::vector<std::string> &bone_names) {
+      return _client.RegisterWalkerBones(bone_names);
+    }
+
+    void ApplyWalkerBoneControlBatch(const rpc::WalkerBoneControlBatch &batch) {
+      _client.ApplyWalkerBoneControlBatch(batch);
+    }
+
     /// @}
 
   private:
 
+    /// Register in the episode the @a actor just spawned and make its
+    /// instance.
+    SharedPtr<Actor> MakeSpawnedActor(const rpc::Actor &actor, GarbageCollectionPolicy gc);
+
+    /// Wait until the episode changes from @a previous_id and return the new
+    /// one.
+    EpisodeProxy WaitForNewEpisode(uint64_t previous_id);
+
     Client _client;
 
     std::shared_ptr<Episode> _episode;
 
     const GarbageCollectionPolicy _gc_policy;
+
+    /// Frame started by the last tick cue sent.
+    std::atomic<uint64_t> _last_tick_cue_frame{0u};
+
+    std::mutex _blueprint_library_mutex;
+
+    SharedPtr<BlueprintLibrary> _blueprint_library;
+
+    uint64_t _blueprint_library_version = 0u;
   };
 
 } // namespace detail
@@ -6,21 +6,104 @@
 
 #include "carla/client/detail/WalkerNavigation.h"
 
+#include "carla/FileSystem.h"
+#include "carla/Logging.h"
+#include "carla/client/Map.h"
 #include "carla/client/detail/Client.h"
 #include "carla/client/detail/EpisodeState.h"
-#include "carla/rpc/Command.h"
-#include "carla/rpc/WalkerControl.h"
+#include "carla/profiler/Profiler.h"
+#include "carla/rpc/NavigationMeshInfo.h"
+#include "carla/rpc/WalkerStateBatch.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
 
 namespace carla {
 namespace client {
 namespace detail {
 
+  static std::string GetCachedMeshPath(const std::string &folder, const rpc::NavigationMeshInfo &info) {
+    std::ostringstream name;
+    for (const auto c : info.map_name) {
+      name << (std::isalnum(static_cast<unsigned char>(c)) ? c : '_');
+    }
+    name << '_' << std::hex << std::setw(16) << std::setfill('0') << info.hash << ".bin";
+    return folder + "/" + name.str();
+  }
+
+  /// The file is mapped read-only instead of copied, the tiles are copied out
+  /// of it while loading.
+  static bool ReadCachedMesh(nav::Navigation &nav, const std::string &path, const uint64_t hash) {
+    namespace bip = boost::interprocess;
+    try {
+      const bip::file_mapping file(path.c_str(), bip::read_only);
+      const bip::mapped_region region(file, bip::read_only);
+      const auto *data = static_cast<const uint8_t *>(region.get_address());
+      const auto size = region.get_size();
+      return (rpc::NavigationMeshInfo::Hash(data, size) == hash) && nav.Load(data, size);
+    } catch (const bip::interprocess_exception &) {
+      // Missing or empty, it is downloaded again.
+      return false;
+    }
+  }
+
+  /// Written to a temporary file first, other processes may be reading or
+  /// writing the same mesh.
+  static void WriteCachedMesh(const std::string &path, const std::vector<uint8_t> &content) {
+    const auto temp_path = path + "." + std::to_string(std::random_device{}()) + ".tmp";
+    {
+      std::ofstream file(temp_path, std::ios::binary);
+      file.write(reinterpret_cast<const char *>(content.data()), static_cast<std::streamsize>(content.size()));
+      if (!file) {
+        file.close();
+        std::remove(temp_path.c_str());
+        return;
+      }
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+      std::remove(temp_path.c_str());
+    }
+  }
+
   WalkerNavigation::WalkerNavigation(Client &client) : _client(client), _next_check_index(0) {
     // Here call the server to retrieve the navmesh data.
-    _nav.Load(_client.GetNavigationMesh());
+    LoadNavigationMesh();
+  }
+
+  void WalkerNavigation::LoadNavigationMesh() {
+    const auto folder = Map::GetCacheFolder();
+    if (folder.empty()) {
+      _nav.Load(_client.GetNavigationMesh());
+      return;
+    }
+    const auto info = _client.GetNavigationMeshInfo();
+    if (info.hash == 0u) {
+      // the map has no navigation mesh
+      return;
+    }
+    auto path = GetCachedMeshPath(folder, info);
+    FileSystem::ValidateFilePath(path);
+    if (ReadCachedMesh(_nav, path, info.hash)) {
+      return;
+    }
+    auto content = _client.GetNavigationMesh();
+    if (rpc::NavigationMeshInfo::Hash(content.data(), content.size()) == info.hash) {
+      WriteCachedMesh(path, content);
+    } else {
+      log_warning("navigation mesh of", info.map_name, "changed while downloading it, not cached");
+    }
+    _nav.Load(std::move(content));
   }
 
   void WalkerNavigation::Tick(const EpisodeState &state) {
+    CARLA_PROFILE_SCOPE(walker_navigation, tick);
     auto walkers = _walkers.Load();
     if (walkers->empty()) {
       return;
@@ -30,21 +113,14 @@ namespace detail {
     CheckIfWalkerExist(*walkers, state);
 
     // update crowd in navigation module
-    _nav.UpdateCrowd(state);
-
-    carla::geom::Transform trans;
-    using Cmd = rpc::Command;
-    std::vector<Cmd> commands;
-    commands.reserve(walkers->size());
-    for (auto handle : *walkers) {
-      // get the transform of the walker
-      if (_nav.GetWalkerTransform(handle.walker, trans)) {
-        float speed = _nav.GetWalkerSpeed(handle.walker);
-        commands.emplace_back(Cmd::ApplyWalkerState{ handle.walker, trans, speed });
-      }
-    }
+    _nav.UpdateCrowd(state.GetTimestamp().delta_seconds);
 
-    _client.ApplyBatch(std::move(commands), false);
+    // send the transform of all walkers in a single packed message
+    rpc::WalkerStateBatch batch;
+    _nav.GetAllWalkerTransforms(batch);
+    if (!batch.empty()) {
+      _client.ApplyWalkerStateBatch(batch);
+    }
   }
 
   void WalkerNavigation::CheckIfWalkerExist(std::vector<WalkerHandle> walkers, const EpisodeState &state) {
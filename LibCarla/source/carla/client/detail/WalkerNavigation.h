@@ -13,6 +13,8 @@
 #include "carla/client/detail/EpisodeProxy.h"
 #include "carla/rpc/ActorId.h"
 
+#include <boost/optional.hpp>
+
 #include <memory>
 
 namespace carla {
@@ -48,9 +50,9 @@ namespace detail {
       }
     }
 
-    void RemoveWalker(ActorId walker_id) {
+    bool RemoveWalker(ActorId walker_id) {
       // remove the walker in the crowd
-      _nav.RemoveWalker(walker_id);
+      return _nav.RemoveWalker(walker_id);
     }
 
     void AddWalker(ActorId walker_id, carla::geom::Location location) {
@@ -79,6 +81,11 @@ namespace detail {
       return _nav.SetWalkerMaxSpeed(id, max_speed);
     }
 
+    // set the maximum number of walkers in each region of the crowd
+    void SetMaxWalkersPerRegion(unsigned max_walkers) {
+      _nav.SetMaxAgentsPerRegion(max_walkers);
+    }
+
   private:
 
     Client &_client;
@@ -96,6 +103,10 @@ namespace detail {
 
     // check a few walkers and if they don't exist then remove from the crowd
     void CheckIfWalkerExist(std::vector<WalkerHandle> walkers, const EpisodeState &state);
+
+    // load the navigation mesh from the cache folder of the maps if it holds
+    // the one of the server, otherwise download it and store it there
+    void LoadNavigationMesh();
   };
 
 } // namespace detail
@@ -43,6 +43,9 @@ namespace geom {
 
     /// Transform the given @a location to a GeoLocation using this as
     /// geo-reference.
+    ///
+    /// @note Builds a GeoProjection each call, keep a GeoProjection instead to
+    /// transform many locations.
     GeoLocation Transform(const Location &location) const;
 
     // =========================================================================
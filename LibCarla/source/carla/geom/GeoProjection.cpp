@@ -0,0 +1,76 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/geom/GeoProjection.h"
+
+#include "carla/geom/Location.h"
+#include "carla/geom/Math.h"
+
+#include <cmath>
+
+#if defined(_WIN32) && !defined(_USE_MATH_DEFINES)
+#  define _USE_MATH_DEFINES
+#  include <math.h> // cmath is not enough for MSVC
+#endif
+
+namespace carla {
+namespace geom {
+
+  /// Earth radius at equator [m].
+  static constexpr double EARTH_RADIUS_EQUA = 6378137.0;
+
+  /// Convert latitude to scale, which is needed by mercator
+  /// transformations
+  /// @param lat latitude in degrees (DEG)
+  /// @return scale factor
+  /// @note when converting from lat/lon -> mercator and back again,
+  ///        or vice versa, use the same scale in both transformations!
+  static double LatToScale(double lat) {
+    return std::cos(Math::ToRadians(lat));
+  }
+
+  /// Converts lat/lon/scale to mx/my (mx/my in meters if correct scale
+  /// is given).
+  static void LatLonToMercator(double lat, double lon, double scale, double &mx, double &my) {
+    mx = scale * Math::ToRadians(lon) * EARTH_RADIUS_EQUA;
+    my = scale * EARTH_RADIUS_EQUA * std::log(std::tan((90.0 + lat) * Math::Pi<double>() / 360.0));
+  }
+
+  GeoProjection::GeoProjection(const GeoLocation &geo_reference)
+    : _geo_reference(geo_reference) {
+    const double scale = LatToScale(_geo_reference.latitude);
+    LatLonToMercator(_geo_reference.latitude, _geo_reference.longitude, scale, _mx, _my);
+    _degrees_per_meter = 180.0 / (Math::Pi<double>() * EARTH_RADIUS_EQUA * scale);
+    _inverse_radius = 1.0 / (EARTH_RADIUS_EQUA * scale);
+  }
+
+  GeoLocation GeoProjection::Transform(const Location &location) const {
+    // Invert y axis to have increasing latitudes northward.
+    const double mx = _mx + location.x;
+    const double my = _my - location.y;
+    return GeoLocation{
+        360.0 * std::atan(std::exp(my * _inverse_radius)) / Math::Pi<double>() - 90.0,
+        mx * _degrees_per_meter,
+        _geo_reference.altitude + location.z};
+  }
+
+  void GeoProjection::Transform(
+      const Location *locations,
+      const size_t count,
+      GeoLocation *output) const {
+    for (size_t i = 0u; i < count; ++i) {
+      output[i] = Transform(locations[i]);
+    }
+  }
+
+  std::vector<GeoLocation> GeoProjection::Transform(const std::vector<Location> &locations) const {
+    std::vector<GeoLocation> result(locations.size());
+    Transform(locations.data(), locations.size(), result.data());
+    return result;
+  }
+
+} // namespace geom
+} // namespace carla
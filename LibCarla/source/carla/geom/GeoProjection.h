@@ -0,0 +1,62 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/GeoLocation.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace carla {
+namespace geom {
+
+  class Location;
+
+  /// Transforms locations of the map to GeoLocation around a geo-reference.
+  /// The scale of the Mercator projection and the projected reference point
+  /// are computed once at construction, so each transform only does the
+  /// inverse projection of the displaced point.
+  class GeoProjection {
+  public:
+
+    GeoProjection() : GeoProjection(GeoLocation{}) {}
+
+    explicit GeoProjection(const GeoLocation &geo_reference);
+
+    const GeoLocation &GetGeoReference() const {
+      return _geo_reference;
+    }
+
+    /// Transform the given @a location to a GeoLocation, same as
+    /// GeoLocation::Transform of the geo-reference.
+    GeoLocation Transform(const Location &location) const;
+
+    /// Transform @a count locations starting at @a locations, the results are
+    /// written to @a output.
+    void Transform(const Location *locations, size_t count, GeoLocation *output) const;
+
+    /// Transform each of @a locations.
+    std::vector<GeoLocation> Transform(const std::vector<Location> &locations) const;
+
+  private:
+
+    GeoLocation _geo_reference;
+
+    /// Mercator coordinates of the geo-reference, in meters.
+    double _mx;
+
+    double _my;
+
+    /// Degrees of longitude per meter of Mercator x.
+    double _degrees_per_meter;
+
+    /// Inverse of the radius scaled by the reference latitude.
+    double _inverse_radius;
+  };
+
+} // namespace geom
+} // namespace carla
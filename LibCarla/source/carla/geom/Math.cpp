@@ -8,9 +8,202 @@
 
 #include "carla/geom/Rotation.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#  include <emmintrin.h>
+#elif defined(__aarch64__)
+#  include <arm_neon.h>
+#endif
+
 namespace carla {
 namespace geom {
 
+  // ===========================================================================
+  // -- Batch kernels ----------------------------------------------------------
+  // ===========================================================================
+
+namespace kernels {
+
+  /// One point at a time, also used for the points left after the last full
+  /// vector.
+  struct ScalarOps {
+    using F = float;
+
+    static constexpr size_t Width = 1u;
+
+    static void Load3(const float *xyz, F &x, F &y, F &z) {
+      x = xyz[0u];
+      y = xyz[1u];
+      z = xyz[2u];
+    }
+
+    static void Store3(float *xyz, F x, F y, F z) {
+      xyz[0u] = x;
+      xyz[1u] = y;
+      xyz[2u] = z;
+    }
+
+    static void Store(float *out, F value) { *out = value; }
+
+    static F Set(float value) { return value; }
+    static F Add(F lhs, F rhs) { return lhs + rhs; }
+    static F Sub(F lhs, F rhs) { return lhs - rhs; }
+    static F Mul(F lhs, F rhs) { return lhs * rhs; }
+  };
+
+#if defined(__SSE2__) || defined(_M_X64)
+
+  struct SIMDOps {
+    using F = __m128;
+
+    static constexpr size_t Width = 4u;
+
+    /// Load four points x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3 and split
+    /// them by coordinate.
+    static void Load3(const float *xyz, F &x, F &y, F &z) {
+      const F a = _mm_loadu_ps(xyz);
+      const F b = _mm_loadu_ps(xyz + 4u);
+      const F c = _mm_loadu_ps(xyz + 8u);
+      const F bc_x = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+      x = _mm_shuffle_ps(a, bc_x, _MM_SHUFFLE(2, 0, 3, 0));
+      const F ab_y = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+      const F bc_y = _mm_shuffle_ps(b, c, _MM_SHUFFLE(3, 2, 3, 0));
+      y = _mm_shuffle_ps(ab_y, bc_y, _MM_SHUFFLE(2, 1, 2, 0));
+      const F ab_z = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+      z = _mm_shuffle_ps(ab_z, c, _MM_SHUFFLE(3, 0, 2, 0));
+    }
+
+    /// Inverse of Load3.
+    static void Store3(float *xyz, F x, F y, F z) {
+      const F xy = _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0));
+      const F zx = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+      _mm_storeu_ps(xyz, _mm_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0)));
+      const F yz = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+      const F xy2 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2));
+      _mm_storeu_ps(xyz + 4u, _mm_shuffle_ps(yz, xy2, _MM_SHUFFLE(2, 0, 2, 0)));
+      const F zx3 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));
+      const F yz3 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));
+      _mm_storeu_ps(xyz + 8u, _mm_shuffle_ps(zx3, yz3, _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+
+    static void Store(float *out, F value) { _mm_storeu_ps(out, value); }
+
+    static F Set(float value) { return _mm_set1_ps(value); }
+    static F Add(F lhs, F rhs) { return _mm_add_ps(lhs, rhs); }
+    static F Sub(F lhs, F rhs) { return _mm_sub_ps(lhs, rhs); }
+    static F Mul(F lhs, F rhs) { return _mm_mul_ps(lhs, rhs); }
+  };
+
+#elif defined(__aarch64__)
+
+  struct SIMDOps {
+    using F = float32x4_t;
+
+    static constexpr size_t Width = 4u;
+
+    static void Load3(const float *xyz, F &x, F &y, F &z) {
+      const float32x4x3_t points = vld3q_f32(xyz);
+      x = points.val[0u];
+      y = points.val[1u];
+      z = points.val[2u];
+    }
+
+    static void Store3(float *xyz, F x, F y, F z) {
+      float32x4x3_t points;
+      points.val[0u] = x;
+      points.val[1u] = y;
+      points.val[2u] = z;
+      vst3q_f32(xyz, points);
+    }
+
+    static void Store(float *out, F value) { vst1q_f32(out, value); }
+
+    static F Set(float value) { return vdupq_n_f32(value); }
+    static F Add(F lhs, F rhs) { return vaddq_f32(lhs, rhs); }
+    static F Sub(F lhs, F rhs) { return vsubq_f32(lhs, rhs); }
+    static F Mul(F lhs, F rhs) { return vmulq_f32(lhs, rhs); }
+  };
+
+#else
+
+  using SIMDOps = ScalarOps;
+
+#endif
+
+  /// Call @a kernel with the vector operations on every full vector of
+  /// points, and with the scalar ones on the rest. @a kernel receives the
+  /// operations and the index of the first point.
+  template <typename KernelT>
+  static void ForEachPoint(size_t count, KernelT &&kernel) {
+    size_t i = 0u;
+    for (; i + SIMDOps::Width <= count; i += SIMDOps::Width) {
+      kernel(SIMDOps(), i);
+    }
+    for (; i < count; ++i) {
+      kernel(ScalarOps(), i);
+    }
+  }
+
+} // namespace kernels
+
+  void Math::DistanceSquared(
+      const Vector3D &point,
+      const float *points,
+      const size_t count,
+      float *out,
+      const bool is_2d) {
+    DEBUG_ASSERT((count == 0u) || ((points != nullptr) && (out != nullptr)));
+    kernels::ForEachPoint(count, [&](auto ops, size_t i) {
+      using Ops = decltype(ops);
+      typename Ops::F x, y, z;
+      Ops::Load3(points + 3u * i, x, y, z);
+      const auto dx = Ops::Sub(x, Ops::Set(point.x));
+      const auto dy = Ops::Sub(y, Ops::Set(point.y));
+      auto result = Ops::Add(Ops::Mul(dx, dx), Ops::Mul(dy, dy));
+      if (!is_2d) {
+        const auto dz = Ops::Sub(z, Ops::Set(point.z));
+        result = Ops::Add(result, Ops::Mul(dz, dz));
+      }
+      Ops::Store(out + i, result);
+    });
+  }
+
+  void Math::RotatePointsOnOrigin2D(float *points, const size_t count, const float angle) {
+    DEBUG_ASSERT((count == 0u) || (points != nullptr));
+    const float s = std::sin(angle);
+    const float c = std::cos(angle);
+    kernels::ForEachPoint(count, [&](auto ops, size_t i) {
+      using Ops = decltype(ops);
+      typename Ops::F x, y, z;
+      Ops::Load3(points + 3u * i, x, y, z);
+      const auto vs = Ops::Set(s);
+      const auto vc = Ops::Set(c);
+      Ops::Store3(
+          points + 3u * i,
+          Ops::Sub(Ops::Mul(x, vc), Ops::Mul(y, vs)),
+          Ops::Add(Ops::Mul(x, vs), Ops::Mul(y, vc)),
+          z);
+    });
+  }
+
+  void Math::TransformPoints(
+      const float (&m)[9],
+      const Vector3D &translation,
+      float *points,
+      const size_t count) {
+    DEBUG_ASSERT((count == 0u) || (points != nullptr));
+    kernels::ForEachPoint(count, [&](auto ops, size_t i) {
+      using Ops = decltype(ops);
+      typename Ops::F x, y, z;
+      Ops::Load3(points + 3u * i, x, y, z);
+      auto row = [&](size_t r, float t) {
+        return Ops::Add(
+            Ops::Add(Ops::Mul(x, Ops::Set(m[3u * r])), Ops::Mul(y, Ops::Set(m[3u * r + 1u]))),
+            Ops::Add(Ops::Mul(z, Ops::Set(m[3u * r + 2u])), Ops::Set(t)));
+      };
+      Ops::Store3(points + 3u * i, row(0u, translation.x), row(1u, translation.y), row(2u, translation.z));
+    });
+  }
+
   std::pair<float, float> Math::DistanceSegmentToPoint(
       const Vector3D &p,
       const Vector3D &v,
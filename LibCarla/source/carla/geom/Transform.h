@@ -11,6 +11,8 @@
 #include "carla/geom/Math.h"
 #include "carla/geom/Rotation.h"
 
+#include <vector>
+
 #ifdef LIBCARLA_INCLUDED_FROM_UE4
 #include "Math/Transform.h"
 #endif // LIBCARLA_INCLUDED_FROM_UE4
@@ -80,6 +82,41 @@ namespace geom {
       in_point = out_point;
     }
 
+    /// Same as TransformPoint applied to @a count consecutive points, e.g. an
+    /// array of Location. Vectorized, see Math::TransformPoints.
+    template <typename PointT>
+    void TransformPoints(PointT *points, size_t count) const {
+      float matrix[9];
+      GetMatrix(matrix);
+      Math::TransformPoints(matrix, location, points, count);
+    }
+
+    template <typename PointT>
+    void TransformPoints(std::vector<PointT> &points) const {
+      TransformPoints(points.data(), points.size());
+    }
+
+    /// Row-major 3x3 rotation matrix of this transform, the one used by
+    /// TransformPoint. Use TransformMatrix to compute it only once for many
+    /// points.
+    void GetMatrix(float (&matrix)[9]) const {
+      const float cy = std::cos(Math::ToRadians(rotation.yaw));
+      const float sy = std::sin(Math::ToRadians(rotation.yaw));
+      const float cr = std::cos(Math::ToRadians(rotation.roll));
+      const float sr = std::sin(Math::ToRadians(rotation.roll));
+      const float cp = std::cos(Math::ToRadians(rotation.pitch));
+      const float sp = std::sin(Math::ToRadians(rotation.pitch));
+      matrix[0] = cp * cy;
+      matrix[1] = cy * sp * sr - sy * cr;
+      matrix[2] = -cy * sp * cr - sy * sr;
+      matrix[3] = cp * sy;
+      matrix[4] = sy * sp * sr + cy * cr;
+      matrix[5] = -sy * sp * cr + cy * sr;
+      matrix[6] = sp;
+      matrix[7] = -(cp * sr);
+      matrix[8] = cp * cr;
+    }
+
     // =========================================================================
     // -- Comparison operators -------------------------------------------------
     // =========================================================================
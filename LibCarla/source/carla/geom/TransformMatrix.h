@@ -0,0 +1,75 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/Location.h"
+#include "carla/geom/Math.h"
+#include "carla/geom/Transform.h"
+#include "carla/geom/Vector3D.h"
+
+#include <vector>
+
+namespace carla {
+namespace geom {
+
+  /// A Transform with the sines and cosines of its rotation computed once,
+  /// so transforming a point costs a single matrix multiply. Build one to
+  /// apply the same transform to many points, e.g. sensor to world.
+  class TransformMatrix {
+  public:
+
+    TransformMatrix() : TransformMatrix(Transform()) {}
+
+    explicit TransformMatrix(const Transform &transform)
+      : _translation(transform.location) {
+      transform.GetMatrix(_matrix);
+    }
+
+    /// Same as Transform::TransformPoint.
+    void TransformPoint(Vector3D &point) const {
+      const auto &m = _matrix;
+      point = Vector3D{
+          point.x * m[0] + point.y * m[1] + point.z * m[2] + _translation.x,
+          point.x * m[3] + point.y * m[4] + point.z * m[5] + _translation.y,
+          point.x * m[6] + point.y * m[7] + point.z * m[8] + _translation.z};
+    }
+
+    /// Transform in place @a count consecutive points, vectorized, see
+    /// Math::TransformPoints.
+    template <typename PointT>
+    void TransformPoints(PointT *points, size_t count) const {
+      Math::TransformPoints(_matrix, _translation, points, count);
+    }
+
+    template <typename PointT>
+    void TransformPoints(std::vector<PointT> &points) const {
+      TransformPoints(points.data(), points.size());
+    }
+
+    /// Same as Transform::GetForwardVector, the first column of the matrix.
+    Vector3D GetForwardVector() const {
+      return {_matrix[0], _matrix[3], _matrix[6]};
+    }
+
+    /// Row-major 3x3 rotation matrix.
+    const float (&GetRotationMatrix() const)[9] {
+      return _matrix;
+    }
+
+    const Location &GetTranslation() const {
+      return _translation;
+    }
+
+  private:
+
+    float _matrix[9];
+
+    Location _translation;
+  };
+
+} // namespace geom
+} // namespace carla
@@ -0,0 +1,268 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/image/FastImageConverter.h"
+
+#include "carla/BufferPool.h"
+#include "carla/Debug.h"
+#include "carla/TaskScheduler.h"
+#include "carla/image/CityScapesPalette.h"
+#include "carla/image/FastImageConverterKernels.h"
+
+#include <algorithm>
+#include <array>
+
+#if defined(_MSC_VER) && defined(LIBCARLA_IMAGE_WITH_AVX2)
+#  include <intrin.h>
+#endif
+
+namespace carla {
+namespace image {
+
+  static_assert(sizeof(sensor::data::Color) == sizeof(uint32_t), "Invalid pixel size.");
+
+namespace kernels {
+
+#ifdef LIBCARLA_IMAGE_WITH_AVX2
+  // Defined in FastImageConverterAVX2.cpp.
+  void DepthAVX2(uint32_t *pixels, size_t size);
+  void LogarithmicDepthAVX2(uint32_t *pixels, size_t size);
+#endif // LIBCARLA_IMAGE_WITH_AVX2
+
+} // namespace kernels
+
+  // ===========================================================================
+  // -- Static local methods ---------------------------------------------------
+  // ===========================================================================
+
+  /// Images smaller than this are converted by the calling thread alone.
+  static constexpr size_t MIN_PIXELS_PER_THREAD = 512u * 1024u;
+
+  static bool CpuSupportsAVX2() {
+#if !defined(LIBCARLA_IMAGE_WITH_AVX2)
+    return false;
+#elif defined(_MSC_VER)
+    int info[4u];
+    __cpuid(info, 1);
+    const bool os_saves_ymm =
+        ((info[2u] & (1 << 27)) != 0) && ((_xgetbv(0u) & 6u) == 6u);
+    __cpuidex(info, 7, 0);
+    return os_saves_ymm && ((info[1u] & (1 << 5)) != 0);
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+  }
+
+  /// Keys of the converted copies kept by the images.
+  enum class Conversion : uint8_t {
+    Depth,
+    LogarithmicDepth,
+    CityScapesPalette
+  };
+
+  static BufferPool &GetConvertedImagePool() {
+    static auto pool = std::make_shared<BufferPool>();
+    return *pool;
+  }
+
+  template <typename ColorConverterT>
+  static SharedPtr<sensor::data::Image> GetConvertedImage(
+      const sensor::data::Image &image,
+      const Conversion key,
+      ColorConverterT converter) {
+    return image.GetConverted(
+        static_cast<uint8_t>(key),
+        GetConvertedImagePool(),
+        [converter](sensor::data::Image &copy) {
+          FastImageConverter::ConvertInPlace(copy.data(), copy.size(), converter);
+        });
+  }
+
+  static uint32_t *GetPixels(sensor::data::Color *data) {
+    return reinterpret_cast<uint32_t *>(data);
+  }
+
+  /// Run @a kernel on the @a size pixels at @a pixels, split in contiguous
+  /// chunks run in the TaskScheduler if the image is large enough.
+  template <typename KernelT>
+  static void ForEachChunk(uint32_t *pixels, const size_t size, KernelT &&kernel) {
+    const size_t threads = TaskScheduler::GetDefault().GetNumberOfWorkers() + 1u;
+    const size_t number_of_chunks = std::min(threads, size / MIN_PIXELS_PER_THREAD);
+    if (number_of_chunks <= 1u) {
+      kernel(pixels, size);
+      return;
+    }
+    // Keep the chunks a multiple of the widest vector.
+    const size_t chunk_size = ((size / number_of_chunks) + 7u) & ~size_t(7u);
+    TaskGroup group;
+    size_t begin = chunk_size;
+    for (; begin < size; begin += chunk_size) {
+      const size_t count = std::min(chunk_size, size - begin);
+      group.Run([&kernel, pixels, begin, count]() {
+        kernel(pixels + begin, count);
+      }, TaskPriority::High);
+    }
+    // The calling thread takes the first chunk.
+    kernel(pixels, std::min(chunk_size, size));
+    group.Wait();
+  }
+
+  // ===========================================================================
+  // -- FastImageConverter -----------------------------------------------------
+  // ===========================================================================
+
+  bool FastImageConverter::IsSupported(const Kernel kernel) {
+    switch (kernel) {
+      case Kernel::Scalar:
+        return true;
+      case Kernel::SSE2:
+#if defined(__SSE2__) || defined(_M_X64)
+        return true;
+#else
+        return false;
+#endif
+      case Kernel::AVX2:
+        return CpuSupportsAVX2();
+      case Kernel::NEON:
+#if defined(__aarch64__)
+        return true;
+#else
+        return false;
+#endif
+      default:
+        return false;
+    }
+  }
+
+  FastImageConverter::Kernel FastImageConverter::GetKernel() {
+    static const Kernel kernel = []() {
+      for (auto candidate : {Kernel::AVX2, Kernel::NEON, Kernel::SSE2}) {
+        if (IsSupported(candidate)) {
+          return candidate;
+        }
+      }
+      return Kernel::Scalar;
+    }();
+    return kernel;
+  }
+
+  const char *FastImageConverter::GetKernelName(const Kernel kernel) {
+    switch (kernel) {
+      case Kernel::Scalar: return "Scalar";
+      case Kernel::SSE2:   return "SSE2";
+      case Kernel::AVX2:   return "AVX2";
+      case Kernel::NEON:   return "NEON";
+      default:             return "Invalid";
+    }
+  }
+
+  void FastImageConverter::ConvertInPlace(
+      sensor::data::Color *data,
+      const size_t size,
+      ColorConverter::Depth,
+      const Kernel kernel) {
+    DEBUG_ASSERT(IsSupported(kernel));
+    ForEachChunk(GetPixels(data), size, [kernel](uint32_t *pixels, size_t count) {
+      switch (kernel) {
+#ifdef LIBCARLA_IMAGE_WITH_AVX2
+        case Kernel::AVX2:
+          kernels::DepthAVX2(pixels, count);
+          break;
+#endif // LIBCARLA_IMAGE_WITH_AVX2
+#if defined(__SSE2__) || defined(_M_X64)
+        case Kernel::SSE2:
+          kernels::Depth<kernels::SSE2Ops>(pixels, count);
+          break;
+#endif // __SSE2__ || _M_X64
+#if defined(__aarch64__)
+        case Kernel::NEON:
+          kernels::Depth<kernels::NEONOps>(pixels, count);
+          break;
+#endif // __aarch64__
+        default:
+          kernels::Depth<kernels::ScalarOps>(pixels, count);
+          break;
+      }
+    });
+  }
+
+  void FastImageConverter::ConvertInPlace(
+      sensor::data::Color *data,
+      const size_t size,
+      ColorConverter::LogarithmicDepth,
+      const Kernel kernel) {
+    DEBUG_ASSERT(IsSupported(kernel));
+    ForEachChunk(GetPixels(data), size, [kernel](uint32_t *pixels, size_t count) {
+      switch (kernel) {
+#ifdef LIBCARLA_IMAGE_WITH_AVX2
+        case Kernel::AVX2:
+          kernels::LogarithmicDepthAVX2(pixels, count);
+          break;
+#endif // LIBCARLA_IMAGE_WITH_AVX2
+#if defined(__SSE2__) || defined(_M_X64)
+        case Kernel::SSE2:
+          kernels::LogarithmicDepth<kernels::SSE2Ops>(pixels, count);
+          break;
+#endif // __SSE2__ || _M_X64
+#if defined(__aarch64__)
+        case Kernel::NEON:
+          kernels::LogarithmicDepth<kernels::NEONOps>(pixels, count);
+          break;
+#endif // __aarch64__
+        default:
+          kernels::LogarithmicDepth<kernels::ScalarOps>(pixels, count);
+          break;
+      }
+    });
+  }
+
+  void FastImageConverter::ConvertInPlace(
+      sensor::data::Color *data,
+      const size_t size,
+      ColorConverter::CityScapesPalette,
+      Kernel) {
+    // A table lookup per pixel, the same for every kernel; gathers are not
+    // faster than the scalar loads.
+    static const auto palette = []() {
+      std::array<uint32_t, 256u> result;
+      for (auto tag = 0u; tag < result.size(); ++tag) {
+        const auto color = CityScapesPalette::GetColor(static_cast<uint8_t>(tag));
+        result[tag] =
+            (static_cast<uint32_t>(color[2u]) << 0u) |
+            (static_cast<uint32_t>(color[1u]) << 8u) |
+            (static_cast<uint32_t>(color[0u]) << 16u) |
+            0xFF000000u;
+      }
+      return result;
+    }();
+    ForEachChunk(GetPixels(data), size, [](uint32_t *pixels, size_t count) {
+      for (auto i = 0u; i < count; ++i) {
+        auto pixel = kernels::ScalarOps::Load(pixels + i);
+        kernels::ScalarOps::Store(pixels + i, palette[(pixel >> 16u) & 0xFFu]);
+      }
+    });
+  }
+
+  SharedPtr<sensor::data::Image> FastImageConverter::GetConverted(
+      const sensor::data::Image &image,
+      const ColorConverter::Depth converter) {
+    return GetConvertedImage(image, Conversion::Depth, converter);
+  }
+
+  SharedPtr<sensor::data::Image> FastImageConverter::GetConverted(
+      const sensor::data::Image &image,
+      const ColorConverter::LogarithmicDepth converter) {
+    return GetConvertedImage(image, Conversion::LogarithmicDepth, converter);
+  }
+
+  SharedPtr<sensor::data::Image> FastImageConverter::GetConverted(
+      const sensor::data::Image &image,
+      const ColorConverter::CityScapesPalette converter) {
+    return GetConvertedImage(image, Conversion::CityScapesPalette, converter);
+  }
+
+} // namespace image
+} // namespace carla
@@ -0,0 +1,93 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/image/ColorConverter.h"
+#include "carla/sensor/data/Color.h"
+#include "carla/sensor/data/Image.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace carla {
+namespace image {
+
+  /// In-place colour conversion of BGRA8 sensor images with SIMD kernels,
+  /// selected at runtime for the CPU. Large images are split in contiguous
+  /// chunks converted by several threads.
+  ///
+  /// Same results as ImageConverter::ConvertInPlace with the corresponding
+  /// ColorConverter, which remains the reference implementation. The
+  /// logarithmic depth uses an approximation of the logarithm, its values may
+  /// differ by one.
+  class FastImageConverter {
+  public:
+
+    enum class Kernel : uint8_t {
+      Scalar,
+      SSE2,
+      AVX2,
+      NEON
+    };
+
+    /// Best kernel supported by this CPU.
+    static Kernel GetKernel();
+
+    static bool IsSupported(Kernel kernel);
+
+    static const char *GetKernelName(Kernel kernel);
+
+    /// @{
+    /// Convert the @a size pixels at @a data.
+    static void ConvertInPlace(
+        sensor::data::Color *data,
+        size_t size,
+        ColorConverter::Depth,
+        Kernel kernel = GetKernel());
+
+    static void ConvertInPlace(
+        sensor::data::Color *data,
+        size_t size,
+        ColorConverter::LogarithmicDepth,
+        Kernel kernel = GetKernel());
+
+    static void ConvertInPlace(
+        sensor::data::Color *data,
+        size_t size,
+        ColorConverter::CityScapesPalette,
+        Kernel kernel = GetKernel());
+    /// @}
+
+    /// Convert the pixels of @a image, a sensor::data::ImageTmpl of
+    /// sensor::data::Color. The converted copies it kept are dropped.
+    template <typename ImageT, typename ColorConverterT>
+    static void ConvertInPlace(ImageT &image, ColorConverterT converter) {
+      ConvertInPlace(image.data(), image.size(), converter);
+      image.ClearConverted();
+    }
+
+    /// @{
+    /// Copy of @a image converted, leaving @a image untouched. Computed the
+    /// first time it is requested, in a buffer of a pool shared by every
+    /// conversion, and kept by @a image for the other consumers of the frame.
+    static SharedPtr<sensor::data::Image> GetConverted(
+        const sensor::data::Image &image,
+        ColorConverter::Depth);
+
+    static SharedPtr<sensor::data::Image> GetConverted(
+        const sensor::data::Image &image,
+        ColorConverter::LogarithmicDepth);
+
+    static SharedPtr<sensor::data::Image> GetConverted(
+        const sensor::data::Image &image,
+        ColorConverter::CityScapesPalette);
+    /// @}
+  };
+
+} // namespace image
+} // namespace carla
@@ -0,0 +1,30 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+// Compiled with AVX2 enabled, see LibCarla/cmake/client/CMakeLists.txt. The
+// kernels are only called after checking the CPU supports the instructions.
+
+#include "carla/image/FastImageConverterKernels.h"
+
+#if defined(__AVX2__)
+
+namespace carla {
+namespace image {
+namespace kernels {
+
+  void DepthAVX2(uint32_t *pixels, size_t size) {
+    Depth<AVX2Ops>(pixels, size);
+  }
+
+  void LogarithmicDepthAVX2(uint32_t *pixels, size_t size) {
+    LogarithmicDepth<AVX2Ops>(pixels, size);
+  }
+
+} // namespace kernels
+} // namespace image
+} // namespace carla
+
+#endif // __AVX2__
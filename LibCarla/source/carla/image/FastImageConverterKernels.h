@@ -0,0 +1,335 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+/// @file
+/// Colour converter kernels of FastImageConverter, written once against a
+/// small set of vector operations and instantiated for each instruction set.
+/// Only included by the translation units of FastImageConverter, each one
+/// compiled with the flags of the instruction sets it instantiates.
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#  include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#endif
+#if defined(__aarch64__)
+#  include <arm_neon.h>
+#endif
+
+namespace carla {
+namespace image {
+namespace kernels {
+
+  // ===========================================================================
+  // -- Vector operations ------------------------------------------------------
+  // ===========================================================================
+
+  /// One pixel at a time, also used for the pixels left after the last full
+  /// vector.
+  struct ScalarOps {
+    using F = float;
+    using I = uint32_t;
+    using M = bool;
+
+    static constexpr size_t Width = 1u;
+
+    static I Load(const uint32_t *source) {
+      I result;
+      std::memcpy(&result, source, sizeof(result));
+      return result;
+    }
+
+    static void Store(uint32_t *destination, I value) {
+      std::memcpy(destination, &value, sizeof(value));
+    }
+
+    static I SetI(uint32_t value) { return value; }
+    static F SetF(float value) { return value; }
+
+    static I And(I lhs, I rhs) { return lhs & rhs; }
+    static I Or(I lhs, I rhs) { return lhs | rhs; }
+    static I SubI(I lhs, I rhs) { return lhs - rhs; }
+    static I AddI(I lhs, I rhs) { return lhs + rhs; }
+    template <int N> static I ShiftLeft(I value) { return value << N; }
+    template <int N> static I ShiftRight(I value) { return value >> N; }
+
+    static F Add(F lhs, F rhs) { return lhs + rhs; }
+    static F Sub(F lhs, F rhs) { return lhs - rhs; }
+    static F Mul(F lhs, F rhs) { return lhs * rhs; }
+    static F Div(F lhs, F rhs) { return lhs / rhs; }
+    static F Min(F lhs, F rhs) { return lhs < rhs ? lhs : rhs; }
+    static F Max(F lhs, F rhs) { return lhs > rhs ? lhs : rhs; }
+
+    static M Less(F lhs, F rhs) { return lhs < rhs; }
+    static F Select(M mask, F lhs, F rhs) { return mask ? lhs : rhs; }
+
+    static F ToFloat(I value) { return static_cast<float>(static_cast<int32_t>(value)); }
+    static I Truncate(F value) { return static_cast<uint32_t>(value); }
+
+    static F AsFloat(I value) {
+      F result;
+      std::memcpy(&result, &value, sizeof(result));
+      return result;
+    }
+
+    static I AsInt(F value) {
+      I result;
+      std::memcpy(&result, &value, sizeof(result));
+      return result;
+    }
+  };
+
+#if defined(__SSE2__) || defined(_M_X64)
+
+  struct SSE2Ops {
+    using F = __m128;
+    using I = __m128i;
+    using M = __m128;
+
+    static constexpr size_t Width = 4u;
+
+    static I Load(const uint32_t *source) {
+      return _mm_loadu_si128(reinterpret_cast<const __m128i *>(source));
+    }
+    static void Store(uint32_t *destination, I value) {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(destination), value);
+    }
+
+    static I SetI(uint32_t value) { return _mm_set1_epi32(static_cast<int>(value)); }
+    static F SetF(float value) { return _mm_set1_ps(value); }
+
+    static I And(I lhs, I rhs) { return _mm_and_si128(lhs, rhs); }
+    static I Or(I lhs, I rhs) { return _mm_or_si128(lhs, rhs); }
+    static I SubI(I lhs, I rhs) { return _mm_sub_epi32(lhs, rhs); }
+    static I AddI(I lhs, I rhs) { return _mm_add_epi32(lhs, rhs); }
+    template <int N> static I ShiftLeft(I value) { return _mm_slli_epi32(value, N); }
+    template <int N> static I ShiftRight(I value) { return _mm_srli_epi32(value, N); }
+
+    static F Add(F lhs, F rhs) { return _mm_add_ps(lhs, rhs); }
+    static F Sub(F lhs, F rhs) { return _mm_sub_ps(lhs, rhs); }
+    static F Mul(F lhs, F rhs) { return _mm_mul_ps(lhs, rhs); }
+    static F Div(F lhs, F rhs) { return _mm_div_ps(lhs, rhs); }
+    static F Min(F lhs, F rhs) { return _mm_min_ps(lhs, rhs); }
+    static F Max(F lhs, F rhs) { return _mm_max_ps(lhs, rhs); }
+
+    static M Less(F lhs, F rhs) { return _mm_cmplt_ps(lhs, rhs); }
+    static F Select(M mask, F lhs, F rhs) {
+      return _mm_or_ps(_mm_and_ps(mask, lhs), _mm_andnot_ps(mask, rhs));
+    }
+
+    static F ToFloat(I value) { return _mm_cvtepi32_ps(value); }
+    static I Truncate(F value) { return _mm_cvttps_epi32(value); }
+
+    static F AsFloat(I value) { return _mm_castsi128_ps(value); }
+    static I AsInt(F value) { return _mm_castps_si128(value); }
+  };
+
+#endif // __SSE2__ || _M_X64
+
+#if defined(__AVX2__)
+
+  struct AVX2Ops {
+    using F = __m256;
+    using I = __m256i;
+    using M = __m256;
+
+    static constexpr size_t Width = 8u;
+
+    static I Load(const uint32_t *source) {
+      return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source));
+    }
+    static void Store(uint32_t *destination, I value) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(destination), value);
+    }
+
+    static I SetI(uint32_t value) { return _mm256_set1_epi32(static_cast<int>(value)); }
+    static F SetF(float value) { return _mm256_set1_ps(value); }
+
+    static I And(I lhs, I rhs) { return _mm256_and_si256(lhs, rhs); }
+    static I Or(I lhs, I rhs) { return _mm256_or_si256(lhs, rhs); }
+    static I SubI(I lhs, I rhs) { return _mm256_sub_epi32(lhs, rhs); }
+    static I AddI(I lhs, I rhs) { return _mm256_add_epi32(lhs, rhs); }
+    template <int N> static I ShiftLeft(I value) { return _mm256_slli_epi32(value, N); }
+    template <int N> static I ShiftRight(I value) { return _mm256_srli_epi32(value, N); }
+
+    static F Add(F lhs, F rhs) { return _mm256_add_ps(lhs, rhs); }
+    static F Sub(F lhs, F rhs) { return _mm256_sub_ps(lhs, rhs); }
+    static F Mul(F lhs, F rhs) { return _mm256_mul_ps(lhs, rhs); }
+    static F Div(F lhs, F rhs) { return _mm256_div_ps(lhs, rhs); }
+    static F Min(F lhs, F rhs) { return _mm256_min_ps(lhs, rhs); }
+    static F Max(F lhs, F rhs) { return _mm256_max_ps(lhs, rhs); }
+
+    static M Less(F lhs, F rhs) { return _mm256_cmp_ps(lhs, rhs, _CMP_LT_OQ); }
+    static F Select(M mask, F lhs, F rhs) { return _mm256_blendv_ps(rhs, lhs, mask); }
+
+    static F ToFloat(I value) { return _mm256_cvtepi32_ps(value); }
+    static I Truncate(F value) { return _mm256_cvttps_epi32(value); }
+
+    static F AsFloat(I value) { return _mm256_castsi256_ps(value); }
+    static I AsInt(F value) { return _mm256_castps_si256(value); }
+  };
+
+#endif // __AVX2__
+
+#if defined(__aarch64__)
+
+  struct NEONOps {
+    using F = float32x4_t;
+    using I = uint32x4_t;
+    using M = uint32x4_t;
+
+    static constexpr size_t Width = 4u;
+
+    static I Load(const uint32_t *source) { return vld1q_u32(source); }
+    static void Store(uint32_t *destination, I value) { vst1q_u32(destination, value); }
+
+    static I SetI(uint32_t value) { return vdupq_n_u32(value); }
+    static F SetF(float value) { return vdupq_n_f32(value); }
+
+    static I And(I lhs, I rhs) { return vandq_u32(lhs, rhs); }
+    static I Or(I lhs, I rhs) { return vorrq_u32(lhs, rhs); }
+    static I SubI(I lhs, I rhs) { return vsubq_u32(lhs, rhs); }
+    static I AddI(I lhs, I rhs) { return vaddq_u32(lhs, rhs); }
+    template <int N> static I ShiftLeft(I value) { return vshlq_n_u32(value, N); }
+    template <int N> static I ShiftRight(I value) { return vshrq_n_u32(value, N); }
+
+    static F Add(F lhs, F rhs) { return vaddq_f32(lhs, rhs); }
+    static F Sub(F lhs, F rhs) { return vsubq_f32(lhs, rhs); }
+    static F Mul(F lhs, F rhs) { return vmulq_f32(lhs, rhs); }
+    static F Div(F lhs, F rhs) { return vdivq_f32(lhs, rhs); }
+    static F Min(F lhs, F rhs) { return vminq_f32(lhs, rhs); }
+    static F Max(F lhs, F rhs) { return vmaxq_f32(lhs, rhs); }
+
+    static M Less(F lhs, F rhs) { return vcltq_f32(lhs, rhs); }
+    static F Select(M mask, F lhs, F rhs) { return vbslq_f32(mask, lhs, rhs); }
+
+    static F ToFloat(I value) { return vcvtq_f32_s32(vreinterpretq_s32_u32(value)); }
+    static I Truncate(F value) { return vcvtq_u32_f32(value); }
+
+    static F AsFloat(I value) { return vreinterpretq_f32_u32(value); }
+    static I AsInt(F value) { return vreinterpretq_u32_f32(value); }
+  };
+
+#endif // __aarch64__
+
+  // ===========================================================================
+  // -- Kernels ----------------------------------------------------------------
+  // ===========================================================================
+
+  /// Same arithmetic as ColorConverter, pixels are BGRA8 read as little endian
+  /// 32-bit words.
+  template <typename Ops>
+  struct Kernels {
+    using F = typename Ops::F;
+    using I = typename Ops::I;
+
+    /// Depth encoded in the red, green, and blue channels, normalized to
+    /// [0, 1].
+    static F DecodeDepth(I pixel) {
+      const I mask = Ops::SetI(0xFFu);
+      const I r = Ops::And(Ops::template ShiftRight<16>(pixel), mask);
+      const I g = Ops::And(Ops::template ShiftRight<8>(pixel), mask);
+      const I b = Ops::And(pixel, mask);
+      const I depth = Ops::AddI(
+          r,
+          Ops::AddI(Ops::template ShiftLeft<8>(g), Ops::template ShiftLeft<16>(b)));
+      return Ops::Div(Ops::ToFloat(depth), Ops::SetF(static_cast<float>(256 * 256 * 256 - 1)));
+    }
+
+    /// Opaque gray pixel of @a value in [0, 1], rounded like Boost.GIL
+    /// channel conversion.
+    static I EncodeGray(F value) {
+      const I gray = Ops::Truncate(Ops::Add(Ops::Mul(value, Ops::SetF(255.0f)), Ops::SetF(0.5f)));
+      return Ops::Or(
+          Ops::Or(gray, Ops::template ShiftLeft<8>(gray)),
+          Ops::Or(Ops::template ShiftLeft<16>(gray), Ops::SetI(0xFF000000u)));
+    }
+
+    /// Natural logarithm, cephes logf approximation. Non-positive values are
+    /// taken as the smallest normal float.
+    static F Log(F x) {
+      const F one = Ops::SetF(1.0f);
+      x = Ops::Max(x, Ops::SetF(std::numeric_limits<float>::min()));
+      const I bits = Ops::AsInt(x);
+      F exponent = Ops::ToFloat(Ops::SubI(Ops::template ShiftRight<23>(bits), Ops::SetI(126u)));
+      // Mantissa in [0.5, 1).
+      F m = Ops::AsFloat(Ops::Or(Ops::And(bits, Ops::SetI(0x007FFFFFu)), Ops::SetI(0x3F000000u)));
+      const auto is_small = Ops::Less(m, Ops::SetF(0.707106781186547524f));
+      exponent = Ops::Select(is_small, Ops::Sub(exponent, one), exponent);
+      m = Ops::Sub(Ops::Select(is_small, Ops::Add(m, m), m), one);
+      const F z = Ops::Mul(m, m);
+      F y = Ops::SetF(7.0376836292e-2f);
+      y = Ops::Add(Ops::Mul(y, m), Ops::SetF(-1.1514610310e-1f));
+      y = Ops::Add(Ops::Mul(y, m), Ops::SetF(1.1676998740e-1f));
+      y = Ops::Add(Ops::Mul(y, m), Ops::SetF(-1.2420140846e-1f));
+      y = Ops::Add(Ops::Mul(y, m), Ops::SetF(1.4249322787e-1f));
+      y = Ops::Add(Ops::Mul(y, m), Ops::SetF(-1.6668057665e-1f));
+      y = Ops::Add(Ops::Mul(y, m), Ops::SetF(2.0000714765e-1f));
+      y = Ops::Add(Ops::Mul(y, m), Ops::SetF(-2.4999993993e-1f));
+      y = Ops::Add(Ops::Mul(y, m), Ops::SetF(3.3333331174e-1f));
+      y = Ops::Mul(Ops::Mul(y, m), z);
+      y = Ops::Add(y, Ops::Mul(exponent, Ops::SetF(-2.12194440e-4f)));
+      y = Ops::Sub(y, Ops::Mul(z, Ops::SetF(0.5f)));
+      return Ops::Add(Ops::Add(m, y), Ops::Mul(exponent, Ops::SetF(0.693359375f)));
+    }
+
+    static I Depth(I pixel) {
+      return EncodeGray(DecodeDepth(pixel));
+    }
+
+    static I LogarithmicDepth(I pixel) {
+      const F value = Ops::Add(
+          Ops::SetF(1.0f),
+          Ops::Div(Log(DecodeDepth(pixel)), Ops::SetF(5.70378f)));
+      return EncodeGray(Ops::Max(Ops::Min(value, Ops::SetF(1.0f)), Ops::SetF(0.005f)));
+    }
+  };
+
+  /// Apply @a vector_func to the @a size pixels at @a pixels a vector at a
+  /// time, and @a scalar_func to the pixels left.
+  template <typename Ops, typename VectorFuncT, typename ScalarFuncT>
+  static inline void Transform(
+      uint32_t *pixels,
+      const size_t size,
+      VectorFuncT &&vector_func,
+      ScalarFuncT &&scalar_func) {
+    size_t i = 0u;
+    for (; (i + Ops::Width) <= size; i += Ops::Width) {
+      Ops::Store(pixels + i, vector_func(Ops::Load(pixels + i)));
+    }
+    for (; i < size; ++i) {
+      ScalarOps::Store(pixels + i, scalar_func(ScalarOps::Load(pixels + i)));
+    }
+  }
+
+  template <typename Ops>
+  static inline void Depth(uint32_t *pixels, const size_t size) {
+    Transform<Ops>(
+        pixels,
+        size,
+        [](typename Ops::I pixel) { return Kernels<Ops>::Depth(pixel); },
+        [](uint32_t pixel) { return Kernels<ScalarOps>::Depth(pixel); });
+  }
+
+  template <typename Ops>
+  static inline void LogarithmicDepth(uint32_t *pixels, const size_t size) {
+    Transform<Ops>(
+        pixels,
+        size,
+        [](typename Ops::I pixel) { return Kernels<Ops>::LogarithmicDepth(pixel); },
+        [](uint32_t pixel) { return Kernels<ScalarOps>::LogarithmicDepth(pixel); });
+  }
+
+} // namespace kernels
+} // namespace image
+} // namespace carla
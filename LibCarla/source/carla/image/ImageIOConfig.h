@@ -35,6 +35,14 @@
 #  endif
 #endif
 
+#ifndef LIBCARLA_IMAGE_WITH_TGA_SUPPORT
+#  if defined(__has_include) && __has_include(<boost/gil/extension/io/targa.hpp>)
+#    define LIBCARLA_IMAGE_WITH_TGA_SUPPORT true
+#  else
+#    define LIBCARLA_IMAGE_WITH_TGA_SUPPORT false
+#  endif
+#endif
+
 #if defined(__clang__)
 #  pragma clang diagnostic push
 #  pragma clang diagnostic ignored "-Wunused-parameter"
@@ -66,6 +74,10 @@
 #  include <boost/gil/extension/io/tiff.hpp>
 #endif
 
+#if LIBCARLA_IMAGE_WITH_TGA_SUPPORT == true
+#  include <boost/gil/extension/io/targa.hpp>
+#endif
+
 #if defined(__clang__)
 #  pragma clang diagnostic pop
 #endif
@@ -86,6 +98,10 @@ namespace io {
     return LIBCARLA_IMAGE_WITH_TIFF_SUPPORT;
   }
 
+  constexpr bool has_tga_support() {
+    return LIBCARLA_IMAGE_WITH_TGA_SUPPORT;
+  }
+
   static_assert(has_png_support() || has_jpeg_support() || has_tiff_support(),
       "No image format supported, please compile with at least one of "
       "LIBCARLA_IMAGE_WITH_PNG_SUPPORT, LIBCARLA_IMAGE_WITH_JPEG_SUPPORT, "
@@ -123,6 +139,23 @@ namespace detail {
       boost::gil::write_view(std::forward<Str>(out_filename), view, boost::gil::png_tag());
     }
 
+#endif // LIBCARLA_IMAGE_WITH_PNG_SUPPORT
+  };
+
+  /// PNG at the lowest compression level, several times faster to encode
+  /// for files only slightly bigger.
+  struct io_png_fast : io_png {
+
+#if LIBCARLA_IMAGE_WITH_PNG_SUPPORT
+
+    template <typename Str, typename ViewT>
+    static void write_view(Str &&out_filename, const ViewT &view) {
+      const boost::gil::image_write_info<boost::gil::png_tag> info(
+          boost::gil::png_compression_type::default_value,
+          Z_BEST_SPEED);
+      boost::gil::write_view(std::forward<Str>(out_filename), view, info);
+    }
+
 #endif // LIBCARLA_IMAGE_WITH_PNG_SUPPORT
   };
 
@@ -203,6 +236,45 @@ namespace detail {
 #endif // LIBCARLA_IMAGE_WITH_TIFF_SUPPORT
   };
 
+  /// Uncompressed Targa, the fastest to write.
+  struct io_tga {
+
+    static constexpr bool is_supported = has_tga_support();
+
+#if LIBCARLA_IMAGE_WITH_TGA_SUPPORT
+
+    static constexpr const char *get_default_extension() {
+      return "tga";
+    }
+
+    template <typename Str>
+    static bool match_extension(const Str &str) {
+      return StringUtil::EndsWith(str, get_default_extension());
+    }
+
+    template <typename Str, typename ImageT>
+    static void read_image(Str &&in_filename, ImageT &image) {
+      boost::gil::read_and_convert_image(std::forward<Str>(in_filename), image, boost::gil::targa_tag());
+    }
+
+    template <typename Str, typename ViewT>
+    static typename std::enable_if<is_write_supported<ViewT, boost::gil::targa_tag>::value>::type
+    write_view(Str &&out_filename, const ViewT &view) {
+      boost::gil::write_view(std::forward<Str>(out_filename), view, boost::gil::targa_tag());
+    }
+
+    template <typename Str, typename ViewT>
+    static typename std::enable_if<!is_write_supported<ViewT, boost::gil::targa_tag>::value>::type
+    write_view(Str &&out_filename, const ViewT &view) {
+      boost::gil::write_view(
+          std::forward<Str>(out_filename),
+          boost::gil::color_converted_view<boost::gil::rgb8_pixel_t>(view),
+          boost::gil::targa_tag());
+    }
+
+#endif // LIBCARLA_IMAGE_WITH_TGA_SUPPORT
+  };
+
   struct io_resolver {
 
     template <typename IO, typename Str>
@@ -322,17 +394,26 @@ namespace detail {
 
   struct tiff : detail::io_impl<detail::io_tiff> {};
 
+  struct tga : detail::io_impl<detail::io_tga> {};
+
 #if LIBCARLA_IMAGE_WITH_PNG_SUPPORT
 
-  struct any : detail::io_any<detail::io_png, detail::io_tiff, detail::io_jpeg> {};
+  struct any : detail::io_any<detail::io_png, detail::io_tiff, detail::io_jpeg, detail::io_tga> {};
+
+  /// Same as any, but PNG files are written at the lowest compression level.
+  struct any_fast : detail::io_any<detail::io_png_fast, detail::io_tiff, detail::io_jpeg, detail::io_tga> {};
 
 #elif LIBCARLA_IMAGE_WITH_TIFF_SUPPORT
 
-  struct any : detail::io_any<detail::io_tiff, detail::io_jpeg> {};
+  struct any : detail::io_any<detail::io_tiff, detail::io_jpeg, detail::io_tga> {};
+
+  struct any_fast : any {};
 
 #else // Then for sure this one is available.
 
-  struct any : detail::io_any<detail::io_jpeg> {};
+  struct any : detail::io_any<detail::io_jpeg, detail::io_tga> {};
+
+  struct any_fast : any {};
 
 #endif
 
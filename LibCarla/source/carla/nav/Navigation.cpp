@@ -9,11 +9,17 @@
 #include <cmath>
 
 #include "carla/Logging.h"
+#include "carla/ThreadPool.h"
 #include "carla/nav/Navigation.h"
+#include "carla/profiler/Profiler.h"
 
+#include <algorithm>
+#include <cstring>
+#include <future>
 #include <iterator>
 #include <fstream>
 #include <mutex>
+#include <random>
 
 namespace carla {
 namespace nav {
@@ -50,26 +56,116 @@ namespace nav {
   };
 
   static const int MAX_POLYS = 256;
-  static const int MAX_AGENTS = 500;
+  static const unsigned DEFAULT_MAX_AGENTS_PER_REGION = 500u;
+  static const int TILES_PER_REGION = 4;
+  // distance past the boundary of its region before a walker moves to the
+  // crowd of the next one, so walkers along a boundary do not keep switching
+  static const float REGION_MARGIN = 2.0f;
   static const int MAX_QUERY_SEARCH_NODES = 2048;
   static const float AGENT_HEIGHT = 1.8f;
   static const float AGENT_RADIUS = 0.3f;
+  // random locations sampled in advance, refilled when below a quarter
+  static const size_t RANDOM_LOCATIONS = 1024u;
+  // walkers that get a new target per tick, the rest wait for the next ones
+  static const size_t MAX_TARGETS_PER_TICK = 32u;
 
-  // return a random float
+  // return a random float, each thread has its own generator
   static float frand() {
-    return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+    static thread_local std::mt19937 generator{std::random_device{}()};
+    return std::uniform_real_distribution<float>(0.0f, 1.0f)(generator);
   }
 
+  static void SetDefaultFilter(dtQueryFilter &filter) {
+    filter.setIncludeFlags(SAMPLE_POLYFLAGS_ALL ^ SAMPLE_POLYFLAGS_DISABLED);
+    filter.setExcludeFlags(0);
+  }
+
+  static uint64_t GetRegionKey(std::pair<int, int> region) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(region.first)) << 32u) |
+        static_cast<uint64_t>(static_cast<uint32_t>(region.second));
+  }
+
+  class Navigation::QueryLease : private NonCopyable {
+  public:
+
+    explicit QueryLease(const Navigation &navigation)
+      : _navigation(navigation),
+        _query(navigation.AcquireQuery()) {}
+
+    ~QueryLease() {
+      if (_query != nullptr) {
+        _navigation.ReleaseQuery(_query);
+      }
+    }
+
+    dtNavMeshQuery *operator->() const {
+      return _query;
+    }
+
+    explicit operator bool() const {
+      return _query != nullptr;
+    }
+
+  private:
+
+    const Navigation &_navigation;
+
+    dtNavMeshQuery *_query;
+  };
+
+  Navigation::Navigation() : _max_agents_per_region(DEFAULT_MAX_AGENTS_PER_REGION) {}
+
   Navigation::~Navigation() {
     _ready = false;
-    _mappedId.clear();
-    _yaw_walkers.clear();
+    _thread_pool.reset();
+    FreeCrowds();
     _binaryMesh.clear();
-    dtFreeCrowd(_crowd);
-    dtFreeNavMeshQuery(_navQuery);
+    FreeQueries();
     dtFreeNavMesh(_navMesh);
   }
 
+  dtNavMeshQuery *Navigation::AcquireQuery() const {
+    dtNavMeshQuery *query = nullptr;
+    if (_freeQueries.try_dequeue(query)) {
+      return query;
+    }
+    DEBUG_ASSERT(_navMesh != nullptr);
+    query = dtAllocNavMeshQuery();
+    if (query == nullptr) {
+      return nullptr;
+    }
+    if (dtStatusFailed(query->init(_navMesh, MAX_QUERY_SEARCH_NODES))) {
+      dtFreeNavMeshQuery(query);
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(_queriesMutex);
+    _queries.emplace_back(query);
+    return query;
+  }
+
+  void Navigation::ReleaseQuery(dtNavMeshQuery *query) const {
+    _freeQueries.enqueue(query);
+  }
+
+  void Navigation::FreeQueries() {
+    dtNavMeshQuery *query = nullptr;
+    while (_freeQueries.try_dequeue(query));
+    std::lock_guard<std::mutex> lock(_queriesMutex);
+    for (auto *item : _queries) {
+      dtFreeNavMeshQuery(item);
+    }
+    _queries.clear();
+  }
+
+  ThreadPool &Navigation::GetThreadPool() const {
+    std::lock_guard<std::mutex> lock(_thread_pool_mutex);
+    if (_thread_pool == nullptr) {
+      _thread_pool = std::make_unique<ThreadPool>();
+      _thread_pool->AsyncRun();
+    }
+    return *_thread_pool;
+  }
+
   // load navigation data
   bool Navigation::Load(const std::string &filename) {
     std::ifstream f;
@@ -89,6 +185,17 @@ namespace nav {
 
   // load navigation data from memory
   bool Navigation::Load(std::vector<uint8_t> content) {
+    if (!Load(content.data(), content.size())) {
+      return false;
+    }
+    _binaryMesh = std::move(content);
+    _memory.Set(_memory.bytes() + _binaryMesh.size());
+    return true;
+  }
+
+  // load navigation data from a buffer only read while loading, e.g. a mapped
+  // file, the tiles are copied
+  bool Navigation::Load(const uint8_t *content, size_t size) {
     const int NAVMESHSET_MAGIC = 'M' << 24 | 'S' << 16 | 'E' << 8 | 'T'; // 'MSET';
     const int NAVMESHSET_VERSION = 1;
 #pragma pack(push, 1)
@@ -106,14 +213,14 @@ namespace nav {
 #pragma pack(pop)
 
     // check size for header
-    if (content.size() < sizeof(header)) {
+    if (size < sizeof(header)) {
       logging::log("Nav: failed loading binary");
       return false;
     }
 
     // read the file header
     unsigned long pos = 0;
-    memcpy(&header, &content[pos], sizeof(header));
+    memcpy(&header, content + pos, sizeof(header));
     pos += sizeof(header);
 
     // check file magic and version
@@ -134,13 +241,14 @@ namespace nav {
     }
 
     // read the tiles data
+    size_t tile_bytes = 0u;
     for (int i = 0; i < header.numTiles; ++i) {
       NavMeshTileHeader tileHeader;
 
       // read the tile header
-      memcpy(&tileHeader, &content[pos], sizeof(tileHeader));
+      memcpy(&tileHeader, content + pos, sizeof(tileHeader));
       pos += sizeof(tileHeader);
-      if (pos >= content.size()) {
+      if (pos >= size) {
         dtFreeNavMesh(mesh);
         return false;
       }
@@ -157,9 +265,9 @@ namespace nav {
       }
 
       // read the tile
-      memcpy(data, &content[pos], static_cast<size_t>(tileHeader.dataSize));
+      memcpy(data, content + pos, static_cast<size_t>(tileHeader.dataSize));
       pos += static_cast<unsigned long>(tileHeader.dataSize);
-      if (pos > content.size()) {
+      if (pos > size) {
         dtFree(data);
         dtFreeNavMesh(mesh);
         return false;
@@ -168,19 +276,24 @@ namespace nav {
       // add the tile data
       mesh->addTile(reinterpret_cast<unsigned char *>(data), tileHeader.dataSize, DT_TILE_FREE_DATA,
       tileHeader.tileRef, 0);
+      tile_bytes += static_cast<size_t>(tileHeader.dataSize);
     }
 
-    // exchange
+    // wait for the background queries on the previous mesh
+    _ready = false;
+    _thread_pool.reset();
+
+    // exchange, the query objects are bound to the previous mesh
+    FreeQueries();
     dtFreeNavMesh(_navMesh);
     _navMesh = mesh;
+    {
+      std::lock_guard<std::mutex> lock(_randomLocationsMutex);
+      _randomLocations.clear();
+    }
 
-    // prepare the query object
-    dtFreeNavMeshQuery(_navQuery);
-    _navQuery = dtAllocNavMeshQuery();
-    _navQuery->init(_navMesh, MAX_QUERY_SEARCH_NODES);
-
-    // copy
-    _binaryMesh = std::move(content);
+    _binaryMesh.clear();
+    _memory.Set(tile_bytes);
     _ready = true;
 
     // create and init the crowd manager
@@ -191,48 +304,98 @@ namespace nav {
 
   void Navigation::CreateCrowd(void) {
 
-    // check if all is ready
-    if (!_ready) {
-      return;
+    // force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // the crowd of each region is created with its first walker
+    FreeCrowds();
+    _pendingTargets.clear();
+  }
+
+  void Navigation::SetMaxAgentsPerRegion(unsigned max_agents) {
+    DEBUG_ASSERT(max_agents > 0u);
+    std::lock_guard<std::mutex> lock(_mutex);
+    _max_agents_per_region = max_agents;
+  }
+
+  unsigned Navigation::GetMaxAgentsPerRegion() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _max_agents_per_region;
+  }
+
+  void Navigation::FreeCrowds() {
+    for (auto &crowd : _crowds) {
+      dtFreeCrowd(crowd.crowd);
     }
+    _crowds.clear();
+    _regions.clear();
+    _walkers.clear();
+  }
+
+  std::pair<int, int> Navigation::GetRegion(const float *position) const {
+    DEBUG_ASSERT(_navMesh != nullptr);
+    const dtNavMeshParams *params = _navMesh->getParams();
+    const float width = params->tileWidth * TILES_PER_REGION;
+    const float height = params->tileHeight * TILES_PER_REGION;
+    return std::make_pair(
+        static_cast<int>(std::floor((position[0] - params->orig[0]) / width)),
+        static_cast<int>(std::floor((position[2] - params->orig[2]) / height)));
+  }
+
+  bool Navigation::IsInsideRegion(const Crowd &crowd, const float *position, float margin) const {
+    DEBUG_ASSERT(_navMesh != nullptr);
+    const dtNavMeshParams *params = _navMesh->getParams();
+    const float width = params->tileWidth * TILES_PER_REGION;
+    const float height = params->tileHeight * TILES_PER_REGION;
+    const float min_x = params->orig[0] + static_cast<float>(crowd.region.first) * width;
+    const float min_z = params->orig[2] + static_cast<float>(crowd.region.second) * height;
+    return
+        (position[0] >= min_x - margin) && (position[0] <= min_x + width + margin) &&
+        (position[2] >= min_z - margin) && (position[2] <= min_z + height + margin);
+  }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+  int Navigation::GetOrCreateCrowd(std::pair<int, int> region) {
+    auto it = _regions.find(GetRegionKey(region));
+    if (it != _regions.end()) {
+      return static_cast<int>(it->second);
+    }
 
     // create and init
-    _crowd = dtAllocCrowd();
-    if (!_crowd->init(MAX_AGENTS, AGENT_RADIUS, _navMesh)) {
+    dtCrowd *crowd = dtAllocCrowd();
+    if (!crowd || !crowd->init(static_cast<int>(_max_agents_per_region), AGENT_RADIUS, _navMesh)) {
       logging::log("Nav: failed to create crowd");
-      return;
+      dtFreeCrowd(crowd);
+      return -1;
     }
 
     // make polygons with 'disabled' flag invalid
-    _crowd->getEditableFilter(0)->setExcludeFlags(SAMPLE_POLYFLAGS_DISABLED);
+    crowd->getEditableFilter(0)->setExcludeFlags(SAMPLE_POLYFLAGS_DISABLED);
 
     // Setup local avoidance params to different qualities.
     dtObstacleAvoidanceParams params;
     // Use mostly default settings, copy from dtCrowd.
-    memcpy(&params, _crowd->getObstacleAvoidanceParams(0), sizeof(dtObstacleAvoidanceParams));
+    memcpy(&params, crowd->getObstacleAvoidanceParams(0), sizeof(dtObstacleAvoidanceParams));
 
     // Low (11)
     params.velBias = 0.5f;
     params.adaptiveDivs = 5;
     params.adaptiveRings = 2;
     params.adaptiveDepth = 1;
-    _crowd->setObstacleAvoidanceParams(0, &params);
+    crowd->setObstacleAvoidanceParams(0, &params);
 
     // Medium (22)
     params.velBias = 0.5f;
     params.adaptiveDivs = 5;
     params.adaptiveRings = 2;
     params.adaptiveDepth = 2;
-    _crowd->setObstacleAvoidanceParams(1, &params);
+    crowd->setObstacleAvoidanceParams(1, &params);
 
     // Good (45)
     params.velBias = 0.5f;
     params.adaptiveDivs = 7;
     params.adaptiveRings = 2;
     params.adaptiveDepth = 3;
-    _crowd->setObstacleAvoidanceParams(2, &params);
+    crowd->setObstacleAvoidanceParams(2, &params);
 
     // High (66)
     params.velBias = 0.5f;
@@ -240,12 +403,77 @@ namespace nav {
     params.adaptiveRings = 3;
     params.adaptiveDepth = 3;
 
-    _crowd->setObstacleAvoidanceParams(3, &params);
+    crowd->setObstacleAvoidanceParams(3, &params);
+
+    Crowd item;
+    item.crowd = crowd;
+    item.region = region;
+    item.walkers.resize(_max_agents_per_region, 0u);
+    _crowds.emplace_back(std::move(item));
+    _regions[GetRegionKey(region)] = _crowds.size() - 1u;
+    return static_cast<int>(_crowds.size() - 1u);
+  }
+
+  bool Navigation::AddAgent(ActorId id, const float *position, const dtCrowdAgentParams &params, float yaw) {
+    const int crowd_index = GetOrCreateCrowd(GetRegion(position));
+    if (crowd_index == -1) {
+      return false;
+    }
+    Crowd &crowd = _crowds[static_cast<size_t>(crowd_index)];
+    const int index = crowd.crowd->addAgent(position, &params);
+    if (index == -1) {
+      return false;
+    }
+    crowd.walkers[static_cast<size_t>(index)] = id;
+    ++crowd.number_of_walkers;
+    _walkers[id] = Walker{static_cast<size_t>(crowd_index), index, yaw, false};
+    return true;
+  }
+
+  void Navigation::MigrateAgent(size_t crowd_index, int index) {
+    const dtCrowdAgent *agent = _crowds[crowd_index].crowd->getAgent(index);
+    const ActorId id = _crowds[crowd_index].walkers[static_cast<size_t>(index)];
+    auto it = _walkers.find(id);
+    DEBUG_ASSERT(it != _walkers.end());
+
+    // copy what is needed before the agent slot is released
+    float position[3];
+    dtVcopy(position, agent->npos);
+    const dtCrowdAgentParams params = agent->params;
+    const dtPolyRef target_ref = agent->targetRef;
+    float target[3];
+    dtVcopy(target, agent->targetPos);
+    const float yaw = it->second.yaw;
+    const bool is_waiting_target = it->second.is_waiting_target;
+
+    // keep the walker where it is if the crowd of the new region is full
+    if (!AddAgent(id, position, params, yaw)) {
+      return;
+    }
+    _walkers[id].is_waiting_target = is_waiting_target;
+    Crowd &previous = _crowds[crowd_index];
+    previous.crowd->removeAgent(index);
+    previous.walkers[static_cast<size_t>(index)] = 0u;
+    --previous.number_of_walkers;
+
+    // the walker goes on to the same target
+    if (target_ref) {
+      const Walker &walker = _walkers[id];
+      _crowds[walker.crowd].crowd->requestMoveTarget(walker.index, target_ref, target);
+    }
+  }
+
+  const dtCrowdAgent *Navigation::GetAgent(ActorId id) const {
+    auto it = _walkers.find(id);
+    if (it == _walkers.end()) {
+      return nullptr;
+    }
+    return _crowds[it->second.crowd].crowd->getAgent(it->second.index);
   }
 
   // return the path points to go from one position to another
   bool Navigation::GetPath(carla::geom::Location from, carla::geom::Location to,
-  dtQueryFilter * filter, std::vector<carla::geom::Location> &path) {
+  dtQueryFilter * filter, std::vector<carla::geom::Location> &path) const {
     // path found
     float m_straightPath[MAX_POLYS * 3];
     unsigned char m_straightPathFlags[MAX_POLYS];
@@ -256,15 +484,16 @@ namespace nav {
     dtPolyRef m_polys[MAX_POLYS];
     int m_npolys;
 
-    // force single thread running this
-    std::lock_guard<std::mutex> lock(_mutex);
-
     // check if all is ready
     if (!_ready) {
       return false;
     }
 
-    DEBUG_ASSERT(_navQuery != nullptr);
+    // each thread uses its own query object, no lock needed
+    QueryLease query(*this);
+    if (!query) {
+      return false;
+    }
 
     // point extension
     float m_polyPickExt[3];
@@ -275,8 +504,7 @@ namespace nav {
     // filter
     dtQueryFilter filter2;
     if (filter == nullptr) {
-      filter2.setIncludeFlags(SAMPLE_POLYFLAGS_ALL ^ SAMPLE_POLYFLAGS_DISABLED);
-      filter2.setExcludeFlags(0);
+      SetDefaultFilter(filter2);
       filter = &filter2;
     }
 
@@ -285,14 +513,14 @@ namespace nav {
     dtPolyRef m_endRef = 0;
     float m_spos[3] = { from.x, from.z, from.y };
     float m_epos[3] = { to.x, to.z, to.y };
-    _navQuery->findNearestPoly(m_spos, m_polyPickExt, filter, &m_startRef, 0);
-    _navQuery->findNearestPoly(m_epos, m_polyPickExt, filter, &m_endRef, 0);
+    query->findNearestPoly(m_spos, m_polyPickExt, filter, &m_startRef, 0);
+    query->findNearestPoly(m_epos, m_polyPickExt, filter, &m_endRef, 0);
     if (!m_startRef || !m_endRef) {
       return false;
     }
 
     // get the path of nodes
-    _navQuery->findPath(m_startRef, m_endRef, m_spos, m_epos, filter, m_polys, &m_npolys, MAX_POLYS);
+    query->findPath(m_startRef, m_endRef, m_spos, m_epos, filter, m_polys, &m_npolys, MAX_POLYS);
 
     // get the path of points
     m_nstraightPath = 0;
@@ -305,11 +533,11 @@ namespace nav {
     float epos[3];
     dtVcopy(epos, m_epos);
     if (m_polys[m_npolys - 1] != m_endRef) {
-      _navQuery->closestPointOnPoly(m_polys[m_npolys - 1], m_epos, epos, 0);
+      query->closestPointOnPoly(m_polys[m_npolys - 1], m_epos, epos, 0);
     }
 
     // get the points
-    _navQuery->findStraightPath(m_spos, epos, m_polys, m_npolys,
+    query->findStraightPath(m_spos, epos, m_polys, m_npolys,
     m_straightPath, m_straightPathFlags,
     m_straightPathPolys, &m_nstraightPath, MAX_POLYS, m_straightPathOptions);
 
@@ -324,6 +552,18 @@ namespace nav {
     return true;
   }
 
+  std::future<std::vector<carla::geom::Location>> Navigation::GetPathAsync(
+      carla::geom::Location from,
+      carla::geom::Location to) const {
+    return GetThreadPool().Post([this, from, to]() {
+      std::vector<carla::geom::Location> path;
+      if (!GetPath(from, to, nullptr, path)) {
+        path.clear();
+      }
+      return path;
+    });
+  }
+
   // create a new walker in crowd
   bool Navigation::AddWalker(ActorId id, carla::geom::Location from) {
     dtCrowdAgentParams params;
@@ -336,8 +576,6 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
     // set parameters
     memset(&params, 0, sizeof(params));
     params.radius = AGENT_RADIUS;
@@ -360,18 +598,8 @@ namespace nav {
     // from Unreal coordinates (subtract half height to move pivot from center
     // (unreal) to bottom (recast))
     float PointFrom[3] = { from.x, from.z - (AGENT_HEIGHT / 2.0f), from.y };
-    // add walker
-    int index = _crowd->addAgent(PointFrom, &params);
-    if (index == -1) {
-      return false;
-    }
-
-    // save the id
-    _mappedId[id] = index;
-
-    _yaw_walkers[id] = 0.0f;
-
-    return true;
+    // add walker to the crowd of its region
+    return AddAgent(id, PointFrom, params, 0.0f);
   }
 
   // remove a walker
@@ -385,19 +613,20 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
     // get the internal index
-    auto it = _mappedId.find(id);
-    if (it == _mappedId.end()) {
+    auto it = _walkers.find(id);
+    if (it == _walkers.end()) {
       return false;
     }
 
     // remove from crowd
-    _crowd->removeAgent(it->second);
+    Crowd &crowd = _crowds[it->second.crowd];
+    crowd.crowd->removeAgent(it->second.index);
+    crowd.walkers[static_cast<size_t>(it->second.index)] = 0u;
+    --crowd.number_of_walkers;
 
     // remove from mapping
-    _mappedId.erase(it);
+    _walkers.erase(it);
 
     return true;
   }
@@ -413,16 +642,14 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
     // get the internal index
-    auto it = _mappedId.find(id);
-    if (it == _mappedId.end()) {
+    auto it = _walkers.find(id);
+    if (it == _walkers.end()) {
       return false;
     }
 
     // get the agent
-    dtCrowdAgent *agent = _crowd->getEditableAgent(it->second);
+    dtCrowdAgent *agent = _crowds[it->second.crowd].crowd->getEditableAgent(it->second.index);
     if (agent) {
       agent->params.maxSpeed = max_speed;
       return true;
@@ -434,59 +661,55 @@ namespace nav {
   // set a new target point to go
   bool Navigation::SetWalkerTarget(ActorId id, carla::geom::Location to) {
 
+    // force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
+
     // check if all is ready
     if (!_ready) {
       return false;
     }
 
     // get the internal index
-    auto it = _mappedId.find(id);
-    if (it == _mappedId.end()) {
+    auto it = _walkers.find(id);
+    if (it == _walkers.end()) {
       return false;
     }
 
-    return SetWalkerTargetIndex(it->second, to);
+    return SetAgentTarget(_crowds[it->second.crowd], it->second.index, to);
   }
 
   // set a new target point to go
-  bool Navigation::SetWalkerTargetIndex(int index, carla::geom::Location to, bool use_lock) {
+  bool Navigation::SetAgentTarget(Crowd &crowd, int index, carla::geom::Location to) {
 
-    std::unique_lock<std::mutex> guard(_mutex, std::defer_lock);
+    DEBUG_ASSERT(crowd.crowd != nullptr);
 
-    // lock mutex
-    if (use_lock) {
-      guard.lock();
-    }
-
-    // check if all is ready
-    if (!_ready) {
+    if (index == -1) {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-    DEBUG_ASSERT(_navQuery != nullptr);
-
-    if (index == -1) {
+    QueryLease query(*this);
+    if (!query) {
       return false;
     }
 
     // set target position
     float pointTo[3] = { to.x, to.z, to.y };
     float nearest[3];
-    const dtQueryFilter *filter = _crowd->getFilter(0);
+    const dtQueryFilter *filter = crowd.crowd->getFilter(0);
     dtPolyRef targetRef;
-    _navQuery->findNearestPoly(pointTo, _crowd->getQueryHalfExtents(), filter, &targetRef, nearest);
+    query->findNearestPoly(pointTo, crowd.crowd->getQueryHalfExtents(), filter, &targetRef, nearest);
     if (!targetRef) {
       return false;
     }
 
-    bool res = _crowd->requestMoveTarget(index, targetRef, pointTo);
+    bool res = crowd.crowd->requestMoveTarget(index, targetRef, pointTo);
 
     return res;
   }
 
   // update all walkers in crowd
-  void Navigation::UpdateCrowd(const client::detail::EpisodeState &state) {
+  void Navigation::UpdateCrowd(double delta_seconds) {
+    CARLA_PROFILE_SCOPE(navigation, update_crowd);
 
     // force single thread running this
     std::lock_guard<std::mutex> lock(_mutex);
@@ -496,27 +719,77 @@ namespace nav {
       return;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
-    // update all
-    _delta_seconds = state.GetTimestamp().delta_seconds;
-    _crowd->update(static_cast<float>(_delta_seconds), nullptr);
+    // update all, each crowd has its own query object so they can run in
+    // parallel (the navigation mesh is only read)
+    _delta_seconds = delta_seconds;
+    const float step = static_cast<float>(_delta_seconds);
+    std::vector<std::future<void>> updates;
+    for (auto &crowd : _crowds) {
+      if (crowd.number_of_walkers == 0u) {
+        continue;
+      }
+      dtCrowd *item = crowd.crowd;
+      if (_crowds.size() == 1u) {
+        item->update(step, nullptr);
+      } else {
+        updates.emplace_back(GetThreadPool().Post([item, step]() {
+          item->update(step, nullptr);
+        }));
+      }
+    }
+    for (auto &update : updates) {
+      update.get();
+    }
 
-    // check if walker has finished
-    for (int i = 0; i < _crowd->getAgentCount(); ++i) {
-      const dtCrowdAgent *ag = _crowd->getAgent(i);
-      if (!ag->active) {
+    for (size_t c = 0u; c < _crowds.size(); ++c) {
+      if (_crowds[c].number_of_walkers == 0u) {
         continue;
       }
 
-      // check distance to the target point
-      const float *end = &ag->cornerVerts[(ag->ncorners - 1) * 3];
-      carla::geom::Vector3D dist(end[0] - ag->npos[0], end[1] - ag->npos[1], end[2] - ag->npos[2]);
-      if (dist.SquaredLength() <= 2) {
-        // set a new random target
-        carla::geom::Location location;
-        GetRandomLocation(location, 1, nullptr, false);
-        SetWalkerTargetIndex(i, location, false);
+      // check if walker has finished
+      for (int i = 0; i < _crowds[c].crowd->getAgentCount(); ++i) {
+        const dtCrowdAgent *ag = _crowds[c].crowd->getAgent(i);
+        if (!ag->active) {
+          continue;
+        }
+
+        // move to the crowd of the next region when crossing the boundary
+        if (!IsInsideRegion(_crowds[c], ag->npos, REGION_MARGIN)) {
+          MigrateAgent(c, i);
+          continue;
+        }
+
+        // check distance to the target point
+        const float *end = &ag->cornerVerts[(ag->ncorners - 1) * 3];
+        carla::geom::Vector3D dist(end[0] - ag->npos[0], end[1] - ag->npos[1], end[2] - ag->npos[2]);
+        if (dist.SquaredLength() <= 2) {
+          // queue it for a new random target
+          Walker &walker = _walkers[_crowds[c].walkers[static_cast<size_t>(i)]];
+          if (!walker.is_waiting_target) {
+            walker.is_waiting_target = true;
+            _pendingTargets.emplace_back(_crowds[c].walkers[static_cast<size_t>(i)]);
+          }
+        }
+      }
+    }
+
+    AssignPendingTargets();
+  }
+
+  void Navigation::AssignPendingTargets() {
+    // spread the walkers arriving at once over several ticks
+    for (size_t count = 0u; count < MAX_TARGETS_PER_TICK && !_pendingTargets.empty(); ++count) {
+      const ActorId id = _pendingTargets.front();
+      _pendingTargets.pop_front();
+      auto it = _walkers.find(id);
+      if (it == _walkers.end() || !it->second.is_waiting_target) {
+        // removed meanwhile
+        continue;
+      }
+      it->second.is_waiting_target = false;
+      carla::geom::Location location;
+      if (PopRandomLocation(location, 1.0f)) {
+        SetAgentTarget(_crowds[it->second.crowd], it->second.index, location);
       }
     }
   }
@@ -532,42 +805,36 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
-    // get the internal index
-    auto it = _mappedId.find(id);
-    if (it == _mappedId.end()) {
-      return false;
-    }
-
-    // get the index found
-    int index = it->second;
-    if (index == -1) {
+    // get the walker
+    const dtCrowdAgent *agent = GetAgent(id);
+    if (agent == nullptr || !agent->active) {
       return false;
     }
 
-    // get the walker
-    const dtCrowdAgent *agent = _crowd->getAgent(index);
+    GetAgentTransform(*agent, _walkers[id], trans);
+    return true;
+  }
 
-    if (!agent->active) {
-      return false;
-    }
+  void Navigation::GetAgentTransform(const dtCrowdAgent &agent, Walker &walker, carla::geom::Transform &trans) const {
 
     // set its position in Unreal coordinates
-    trans.location.x = agent->npos[0];
-    trans.location.y = agent->npos[2];
-    trans.location.z = agent->npos[1];
+    trans.location.x = agent.npos[0];
+    trans.location.y = agent.npos[2];
+    trans.location.z = agent.npos[1];
 
     // set its rotation
-    float yaw =  atan2f(agent->dvel[2], agent->dvel[0]) * (180.0f / static_cast<float>(M_PI));
-    float shortest_angle = fmod(yaw - _yaw_walkers[id] + 540.0f, 360.0f) - 180.0f;
+    float yaw =  atan2f(agent.dvel[2], agent.dvel[0]) * (180.0f / static_cast<float>(M_PI));
+    float shortest_angle = fmod(yaw - walker.yaw + 540.0f, 360.0f) - 180.0f;
     float rotation_speed = 4.0f;
-    trans.rotation.yaw = _yaw_walkers[id] +
+    trans.rotation.yaw = walker.yaw +
     (shortest_angle * rotation_speed * static_cast<float>(_delta_seconds));
 
-    _yaw_walkers[id] = trans.rotation.yaw;
+    walker.yaw = trans.rotation.yaw;
+  }
 
-    return true;
+  float Navigation::GetAgentSpeed(const dtCrowdAgent &agent) {
+    return sqrt(agent.vel[0] * agent.vel[0] + agent.vel[1] * agent.vel[1] + agent.vel[2] *
+    agent.vel[2]);
   }
 
   float Navigation::GetWalkerSpeed(ActorId id) {
@@ -580,50 +847,55 @@ namespace nav {
       return 0.0f;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
-    // get the internal index
-    auto it = _mappedId.find(id);
-    if (it == _mappedId.end()) {
+    // get the walker
+    const dtCrowdAgent *agent = GetAgent(id);
+    if (agent == nullptr) {
       return 0.0f;
     }
+    return GetAgentSpeed(*agent);
+  }
 
-    // get the index found
-    int index = it->second;
-    if (index == -1) {
-      return 0.0f;
+  // get the transform and speed of all walkers at once
+  void Navigation::GetAllWalkerTransforms(rpc::WalkerStateBatch &batch) {
+
+    // force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // check if all is ready
+    if (!_ready) {
+      return;
     }
 
-    // get the walker
-    const dtCrowdAgent *agent = _crowd->getAgent(index);
-    return sqrt(agent->vel[0] * agent->vel[0] + agent->vel[1] * agent->vel[1] + agent->vel[2] *
-    agent->vel[2]);
+    carla::geom::Transform trans;
+    batch.Reserve(batch.size() + _walkers.size());
+    for (auto &item : _walkers) {
+      const dtCrowdAgent *agent = _crowds[item.second.crowd].crowd->getAgent(item.second.index);
+      if (!agent->active) {
+        continue;
+      }
+      GetAgentTransform(*agent, item.second, trans);
+      batch.Add(item.first, trans, GetAgentSpeed(*agent));
+    }
   }
 
   // get a random location for navigation
-  bool Navigation::GetRandomLocation(carla::geom::Location &location, float maxHeight, dtQueryFilter * filter,
-  bool use_lock) const {
-
-    std::unique_lock<std::mutex> guard(_mutex, std::defer_lock);
-
-    // lock mutex
-    if (use_lock) {
-      guard.lock();
-    }
+  bool Navigation::GetRandomLocation(carla::geom::Location &location, float maxHeight,
+  dtQueryFilter * filter) const {
 
     // check if all is ready
     if (!_ready) {
       return false;
     }
 
-    DEBUG_ASSERT(_navQuery != nullptr);
-
-    // filter
-    dtQueryFilter filter2;
+    // the default filter uses the locations sampled in advance
     if (filter == nullptr) {
-      filter2.setIncludeFlags(SAMPLE_POLYFLAGS_ALL ^ SAMPLE_POLYFLAGS_DISABLED);
-      filter2.setExcludeFlags(0);
-      filter = &filter2;
+      return PopRandomLocation(location, maxHeight);
+    }
+
+    // each thread uses its own query object, no lock needed
+    QueryLease query(*this);
+    if (!query) {
+      return false;
     }
 
     // search
@@ -631,7 +903,7 @@ namespace nav {
     float point[3] { 0.0f, 0.0f, 0.0f };
 
     do {
-      dtStatus status = _navQuery->findRandomPoint(filter, frand, &randomRef, point);
+      dtStatus status = query->findRandomPoint(filter, frand, &randomRef, point);
       if (status == DT_SUCCESS) {
         // set the location in Unreal coords
         location.x = point[0];
@@ -647,5 +919,64 @@ namespace nav {
     return true;
   }
 
+  bool Navigation::PopRandomLocation(carla::geom::Location &location, float maxHeight) const {
+    bool found = false;
+    bool is_low = false;
+    {
+      std::lock_guard<std::mutex> lock(_randomLocationsMutex);
+      while (!found && !_randomLocations.empty()) {
+        location = _randomLocations.back();
+        _randomLocations.pop_back();
+        // check for max height (to avoid roofs, it is a workaround until next version)
+        found = (maxHeight == -1.0f || (maxHeight >= 0.0f && location.z <= maxHeight));
+      }
+      is_low = _randomLocations.size() < RANDOM_LOCATIONS / 4u;
+    }
+
+    // refill in the background, only one refill at a time
+    if (is_low && !_isRefilling.exchange(true)) {
+      GetThreadPool().Post([this]() {
+        RefillRandomLocations();
+        _isRefilling = false;
+      });
+    }
+
+    if (found) {
+      return true;
+    }
+
+    // the reservoir ran out, sample one now
+    dtQueryFilter filter;
+    SetDefaultFilter(filter);
+    return GetRandomLocation(location, maxHeight, &filter);
+  }
+
+  void Navigation::RefillRandomLocations() const {
+    if (!_ready) {
+      return;
+    }
+    QueryLease query(*this);
+    if (!query) {
+      return;
+    }
+    dtQueryFilter filter;
+    SetDefaultFilter(filter);
+
+    // sample without the lock, the height is checked when popping
+    std::vector<carla::geom::Location> locations;
+    locations.reserve(RANDOM_LOCATIONS);
+    dtPolyRef randomRef { 0 };
+    float point[3] { 0.0f, 0.0f, 0.0f };
+    for (size_t i = 0u; i < RANDOM_LOCATIONS && _ready; ++i) {
+      if (query->findRandomPoint(&filter, frand, &randomRef, point) == DT_SUCCESS) {
+        locations.emplace_back(point[0], point[2], point[1]);
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(_randomLocationsMutex);
+    const size_t count = std::min(locations.size(), RANDOM_LOCATIONS - std::min(RANDOM_LOCATIONS, _randomLocations.size()));
+    _randomLocations.insert(_randomLocations.end(), locations.begin(), locations.begin() + static_cast<std::ptrdiff_t>(count));
+  }
+
 } // namespace nav
 } // namespace carla
@@ -7,10 +7,12 @@
 #pragma once
 
 #include "carla/AtomicList.h"
-#include "carla/client/detail/EpisodeState.h"
+#include "carla/MemoryAccounting.h"
+#include "carla/NonCopyable.h"
 #include "carla/geom/Location.h"
 #include "carla/geom/Transform.h"
 #include "carla/rpc/ActorId.h"
+#include "carla/rpc/WalkerStateBatch.h"
 #include <recast/Recast.h>
 #include <recast/DetourCrowd.h>
 #include <recast/DetourNavMesh.h>
@@ -18,30 +20,61 @@
 #include <recast/DetourNavMeshQuery.h>
 #include <recast/DetourCommon.h>
 
+#include "moodycamel/ConcurrentQueue.h"
+
+#include <atomic>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace carla {
+
+  class ThreadPool;
+
 namespace nav {
 
   /// Manage the pedestrians navigation, using the Recast & Detour library for low level calculations.
   ///
   /// This class gets the binary content of the map from the server, which is required for the path finding.
   /// Then this class can add or remove pedestrians, and also set target points to walk for each one.
+  ///
+  /// The navigation mesh is split in square regions of tiles, each with its own crowd, so the crowds
+  /// can be updated in parallel. Pedestrians move to the crowd of a neighbour region when they cross
+  /// its boundary.
+  ///
+  /// Path and random location queries do not take the lock of the crowds, each thread uses its own
+  /// query object from a pool. Random locations come from a reservoir refilled in the background.
+  /// Loading the navigation data must not happen concurrently with any other call.
   class Navigation : private NonCopyable {
 
   public:
 
-    Navigation() = default;
+    Navigation();
     ~Navigation();
 
     /// load navigation data
     bool Load(const std::string &filename);
     /// load navigation data from memory
     bool Load(std::vector<uint8_t> content);
+    /// load navigation data from @a size bytes at @a content, only read during the call
+    bool Load(const uint8_t *content, size_t size);
     /// return the path points to go from one position to another
     bool GetPath(carla::geom::Location from, carla::geom::Location to, dtQueryFilter * filter,
-    std::vector<carla::geom::Location> &path);
+    std::vector<carla::geom::Location> &path) const;
+    /// same as GetPath with the default filter, computed in a background thread; the path is empty if
+    /// not found
+    std::future<std::vector<carla::geom::Location>> GetPathAsync(carla::geom::Location from,
+    carla::geom::Location to) const;
 
-    /// create the crowd object
+    /// remove all the walkers and the crowds of every region
     void CreateCrowd(void);
+    /// set the maximum number of walkers in each region, applies to the crowds created afterwards
+    void SetMaxAgentsPerRegion(unsigned max_agents);
+    unsigned GetMaxAgentsPerRegion() const;
     /// create a new walker
     bool AddWalker(ActorId id, carla::geom::Location from);
     /// remove a walker
@@ -50,31 +83,97 @@ namespace nav {
     bool SetWalkerMaxSpeed(ActorId id, float max_speed);
     /// set a new target point to go
     bool SetWalkerTarget(ActorId id, carla::geom::Location to);
-    bool SetWalkerTargetIndex(int index, carla::geom::Location to, bool use_lock = true);
     /// get the walker current transform
     bool GetWalkerTransform(ActorId id, carla::geom::Transform &trans);
-    /// get the walker current transform
+    /// get the walker current speed
     float GetWalkerSpeed(ActorId id);
+    /// append the current transform and speed of every walker to @a batch
+    void GetAllWalkerTransforms(rpc::WalkerStateBatch &batch);
     /// update all walkers in crowd
-    void UpdateCrowd(const client::detail::EpisodeState &state);
+    void UpdateCrowd(double delta_seconds);
     /// get a random location for navigation
     bool GetRandomLocation(carla::geom::Location &location, float maxHeight = -1.0f,
-    dtQueryFilter * filter = nullptr, bool use_lock = true) const;
+    dtQueryFilter * filter = nullptr) const;
 
   private:
 
-    bool _ready { false };
+    /// crowd of the walkers in one region of the navigation mesh
+    struct Crowd {
+      dtCrowd *crowd { nullptr };
+      std::pair<int, int> region;
+      /// id of the walker of each agent index
+      std::vector<ActorId> walkers;
+      size_t number_of_walkers { 0u };
+    };
+
+    struct Walker {
+      size_t crowd;
+      int index;
+      /// yaw angle from previous tick
+      float yaw;
+      /// arrived to its target and queued for a new one
+      bool is_waiting_target;
+    };
+
+    /// query object of the pool, returned to it on destruction
+    class QueryLease;
+
+    dtNavMeshQuery *AcquireQuery() const;
+    void ReleaseQuery(dtNavMeshQuery *query) const;
+    void FreeQueries();
+    ThreadPool &GetThreadPool() const;
+    /// take a location from the reservoir, refilling it in the background when running low
+    bool PopRandomLocation(carla::geom::Location &location, float maxHeight) const;
+    void RefillRandomLocations() const;
+    /// give a new random target to some of the walkers that arrived to theirs
+    void AssignPendingTargets();
+
+    /// current transform of an agent, smoothing the yaw of the walker
+    void GetAgentTransform(const dtCrowdAgent &agent, Walker &walker, carla::geom::Transform &trans) const;
+    static float GetAgentSpeed(const dtCrowdAgent &agent);
+    /// pointer to the agent of a walker, null if not found
+    const dtCrowdAgent *GetAgent(ActorId id) const;
+    /// region of the navigation mesh containing a point (in Recast coordinates)
+    std::pair<int, int> GetRegion(const float *position) const;
+    /// whether a point is inside the region of a crowd, extended by a margin
+    bool IsInsideRegion(const Crowd &crowd, const float *position, float margin) const;
+    /// index of the crowd of a region, created if missing; -1 if it cannot be created
+    int GetOrCreateCrowd(std::pair<int, int> region);
+    /// add an agent to the crowd of the region containing its position
+    bool AddAgent(ActorId id, const float *position, const dtCrowdAgentParams &params, float yaw);
+    /// move an agent to the crowd of the region it is now in
+    void MigrateAgent(size_t crowd_index, int index);
+    void FreeCrowds();
+    bool SetAgentTarget(Crowd &crowd, int index, carla::geom::Location to);
+
+    std::atomic_bool _ready { false };
     std::vector<uint8_t> _binaryMesh;
+    /// tiles of the mesh and binary kept, accounted as navigation memory
+    TrackedMemory _memory { MemoryTag::Navigation, 0u };
     double _delta_seconds;
     /// meshes
     dtNavMesh *_navMesh { nullptr };
-    dtNavMeshQuery *_navQuery { nullptr };
-    /// crowd
-    dtCrowd *_crowd { nullptr };
+    /// query objects not in use
+    mutable moodycamel::ConcurrentQueue<dtNavMeshQuery *> _freeQueries;
+    /// every query object allocated
+    mutable std::vector<dtNavMeshQuery *> _queries;
+    mutable std::mutex _queriesMutex;
+    /// random locations sampled in advance
+    mutable std::vector<carla::geom::Location> _randomLocations;
+    mutable std::mutex _randomLocationsMutex;
+    mutable std::atomic_bool _isRefilling { false };
+    /// crowds of the regions with walkers
+    std::vector<Crowd> _crowds;
+    /// mapping region to crowd index
+    std::unordered_map<uint64_t, size_t> _regions;
     /// mapping Id
-    std::unordered_map<ActorId, int> _mappedId;
-    /// Store walkers yaw angle from previous tick
-    std::unordered_map<ActorId, float> _yaw_walkers;
+    std::unordered_map<ActorId, Walker> _walkers;
+    /// walkers waiting for a new target
+    std::deque<ActorId> _pendingTargets;
+    unsigned _max_agents_per_region;
+    /// updates the crowds in parallel and runs the background queries, created when first needed
+    mutable std::unique_ptr<ThreadPool> _thread_pool;
+    mutable std::mutex _thread_pool_mutex;
 
     mutable std::mutex _mutex;
 
@@ -7,6 +7,7 @@
 #include "carla/opendrive/OpenDriveParser.h"
 
 #include "carla/Logging.h"
+#include "carla/TaskScheduler.h"
 #include "carla/opendrive/parser/GeoReferenceParser.h"
 #include "carla/opendrive/parser/GeometryParser.h"
 #include "carla/opendrive/parser/JunctionParser.h"
@@ -23,7 +24,9 @@
 namespace carla {
 namespace opendrive {
 
-  boost::optional<road::Map> OpenDriveParser::Load(const std::string &opendrive) {
+  boost::optional<road::Map> OpenDriveParser::Load(
+      const std::string &opendrive,
+      const Profile profile) {
     pugi::xml_document xml;
     pugi::xml_parse_result parse_result = xml.load_string(opendrive.c_str());
 
@@ -37,12 +40,27 @@ namespace opendrive {
     parser::GeoReferenceParser::Parse(xml, map_builder);
     parser::RoadParser::Parse(xml, map_builder);
     parser::JunctionParser::Parse(xml, map_builder);
+
+    // The roads and their lanes are all created by now, the rest of the
+    // parsers only look them up. The builder stages the infos of the roads
+    // and the infos of the lanes apart, and the signals are stored in their
+    // road, so the parsers writing different ones run concurrently. The ones
+    // writing the same run in the same order as before, so are their infos.
+    const bool is_full = profile == Profile::Full;
+    TaskGroup parsers;
+    parsers.Run([&]() {
+      parser::LaneParser::Parse(xml, map_builder, is_full);
+    });
+    if (is_full) {
+      parsers.Run([&]() {
+        parser::TrafficGroupParser::Parse(xml, map_builder);
+        parser::SignalParser::Parse(xml, map_builder);
+        // parser::ObjectParser::Parse(xml, map_builder);
+      });
+    }
     parser::GeometryParser::Parse(xml, map_builder);
-    parser::LaneParser::Parse(xml, map_builder);
     parser::ProfilesParser::Parse(xml, map_builder);
-    parser::TrafficGroupParser::Parse(xml, map_builder);
-    parser::SignalParser::Parse(xml, map_builder);
-    // parser::ObjectParser::Parse(xml, map_builder);
+    parsers.Wait();
 
     return map_builder.Build();
   }
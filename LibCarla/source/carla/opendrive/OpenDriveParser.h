@@ -10,6 +10,7 @@
 
 #include <boost/optional.hpp>
 
+#include <cstdint>
 #include <string>
 
 namespace carla {
@@ -18,7 +19,20 @@ namespace opendrive {
   class OpenDriveParser {
   public:
 
-    static boost::optional<road::Map> Load(const std::string &opendrive);
+    /// The parts of the OpenDRIVE file parsed.
+    enum class Profile : uint8_t {
+      /// Everything the map stores.
+      Full,
+      /// Only what driving along the lanes needs: the geometry, elevation,
+      /// lanes with their widths, road marks and speeds, the links between
+      /// them and the junctions. The signals, controllers and the material,
+      /// visibility, access, height and rules of the lanes are skipped.
+      Driving
+    };
+
+    static boost::optional<road::Map> Load(
+        const std::string &opendrive,
+        Profile profile = Profile::Full);
   };
 
 } // namespace opendrive
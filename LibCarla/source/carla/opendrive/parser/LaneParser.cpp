@@ -18,7 +18,8 @@ namespace parser {
       road::RoadId road_id,
       double s,
       const pugi::xml_node &parent_node,
-      carla::road::MapBuilder &map_builder) {
+      carla::road::MapBuilder &map_builder,
+      const bool with_attributes) {
     for (pugi::xml_node lane_node : parent_node.children("lane")) {
 
       road::LaneId lane_id = lane_node.attribute("id").as_int();
@@ -112,6 +113,21 @@ namespace parser {
         ++road_mark_id;
       }
 
+      // Lane Speed
+      for (pugi::xml_node lane_speed_node : lane_node.children("speed")) {
+        const double s_offset = lane_speed_node.attribute("sOffset").as_double();
+        const double max = lane_speed_node.attribute("max").as_double();
+        std::string unit = lane_speed_node.attribute("unit").value();
+
+        // Create map builder for Lane Speed
+        map_builder.CreateLaneSpeed(lane, s_offset + s, max, unit);
+      }
+
+      // The rest of the attributes are not needed to drive along the lanes.
+      if (!with_attributes) {
+        continue;
+      }
+
       // Lane Material
       for (pugi::xml_node lane_material_node : lane_node.children("material")) {
 
@@ -136,16 +152,6 @@ namespace parser {
         map_builder.CreateLaneVisibility(lane, s_offset + s, forward, back, left, right);
       }
 
-      // Lane Speed
-      for (pugi::xml_node lane_speed_node : lane_node.children("speed")) {
-        const double s_offset = lane_speed_node.attribute("sOffset").as_double();
-        const double max = lane_speed_node.attribute("max").as_double();
-        std::string unit = lane_speed_node.attribute("unit").value();
-
-        // Create map builder for Lane Speed
-        map_builder.CreateLaneSpeed(lane, s_offset + s, max, unit);
-      }
-
       // Lane Access
       for (pugi::xml_node lane_access_node : lane_node.children("access")) {
         const double s_offset = lane_access_node.attribute("sOffset").as_double();
@@ -179,7 +185,8 @@ namespace parser {
 
   void LaneParser::Parse(
       const pugi::xml_document &xml,
-      carla::road::MapBuilder &map_builder) {
+      carla::road::MapBuilder &map_builder,
+      const bool with_attributes) {
 
     pugi::xml_node open_drive_node = xml.child("OpenDRIVE");
 
@@ -193,17 +200,17 @@ namespace parser {
           double s = lane_section_node.attribute("s").as_double();
           pugi::xml_node left_node = lane_section_node.child("left");
           if (left_node) {
-            ParseLanes(road_id, s, left_node, map_builder);
+            ParseLanes(road_id, s, left_node, map_builder, with_attributes);
           }
 
           pugi::xml_node center_node = lane_section_node.child("center");
           if (center_node) {
-            ParseLanes(road_id, s, center_node, map_builder);
+            ParseLanes(road_id, s, center_node, map_builder, with_attributes);
           }
 
           pugi::xml_node right_node = lane_section_node.child("right");
           if (right_node) {
-            ParseLanes(road_id, s, right_node, map_builder);
+            ParseLanes(road_id, s, right_node, map_builder, with_attributes);
           }
         }
       }
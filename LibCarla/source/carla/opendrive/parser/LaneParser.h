@@ -22,9 +22,13 @@ namespace parser {
   class LaneParser {
   public:
 
+    /// Without @a with_attributes only the geometry, road marks and speeds
+    /// of the lanes are parsed, their material, visibility, access, height
+    /// and rules are skipped.
     static void Parse(
         const pugi::xml_document &xml,
-        carla::road::MapBuilder &map_builder);
+        carla::road::MapBuilder &map_builder,
+        bool with_attributes = true);
   };
 
 } // namespace parser
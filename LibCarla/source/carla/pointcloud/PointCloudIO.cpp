@@ -11,9 +11,13 @@
 namespace carla {
 namespace pointcloud {
 
-  void PointCloudIO::WriteHeader(std::ostream &out, size_t number_of_points) {
+  void PointCloudIO::WriteHeader(
+      std::ostream &out,
+      size_t number_of_points,
+      PointCloudFormat format) {
+    const bool is_ascii = (format == PointCloudFormat::AsciiPly);
     out << "ply\n"
-           "format ascii 1.0\n"
+           "format " << (is_ascii ? "ascii" : "binary_little_endian") << " 1.0\n"
            "element vertex " << std::to_string(number_of_points) << "\n"
            "property float32 x\n"
            "property float32 y\n"
@@ -22,7 +26,9 @@ namespace pointcloud {
            // "property uchar diffuse_green\n"
            // "property uchar diffuse_blue\n"
            "end_header\n";
-    out << std::fixed << std::setprecision(4u);
+    if (is_ascii) {
+      out << std::fixed << std::setprecision(4u);
+    }
   }
 
 } // namespace pointcloud
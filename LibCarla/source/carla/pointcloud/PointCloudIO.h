@@ -6,14 +6,30 @@
 
 #pragma once
 
+#include "carla/Debug.h"
 #include "carla/FileSystem.h"
 
+#include <cstdint>
 #include <fstream>
 #include <iterator>
+#include <vector>
 
 namespace carla {
 namespace pointcloud {
 
+  /// File formats a point cloud can be saved in.
+  enum class PointCloudFormat : uint8_t {
+    /// PLY with one line of text per point.
+    AsciiPly,
+
+    /// PLY with the points as little-endian float32 x, y, z.
+    BinaryPly,
+
+    /// Headerless little-endian float32 x, y, z, intensity per point, the
+    /// format of the KITTI Velodyne scans.
+    Bin
+  };
+
   class PointCloudIO {
   public:
 
@@ -26,17 +42,94 @@ namespace pointcloud {
       }
     }
 
+    /// Write the points as binary PLY, in a single write.
+    template <typename PointIt>
+    static void DumpBinary(std::ostream &out, PointIt begin, PointIt end) {
+      DEBUG_ASSERT(std::distance(begin, end) >= 0);
+      const auto number_of_points = static_cast<size_t>(std::distance(begin, end));
+      WriteHeader(out, number_of_points, PointCloudFormat::BinaryPly);
+      std::vector<float> data;
+      data.reserve(3u * number_of_points);
+      for (; begin != end; ++begin) {
+        data.insert(data.end(), {begin->x, begin->y, begin->z});
+      }
+      Write(out, data);
+    }
+
+    /// Write the points as KITTI .bin, in a single write. @a intensity is
+    /// called with the index of each point and returns its intensity.
+    template <typename PointIt, typename IntensityF>
+    static void DumpBin(std::ostream &out, PointIt begin, PointIt end, IntensityF &&intensity) {
+      DEBUG_ASSERT(std::distance(begin, end) >= 0);
+      std::vector<float> data;
+      data.reserve(4u * static_cast<size_t>(std::distance(begin, end)));
+      for (size_t i = 0u; begin != end; ++begin, ++i) {
+        data.insert(data.end(), {begin->x, begin->y, begin->z, static_cast<float>(intensity(i))});
+      }
+      Write(out, data);
+    }
+
+    /// @copydoc DumpBin
+    ///
+    /// The intensity of every point is zero.
+    template <typename PointIt>
+    static void DumpBin(std::ostream &out, PointIt begin, PointIt end) {
+      DumpBin(out, begin, end, [](size_t) { return 0.0f; });
+    }
+
     template <typename PointIt>
     static std::string SaveToDisk(std::string path, PointIt begin, PointIt end) {
-      FileSystem::ValidateFilePath(path, ".ply");
-      std::ofstream out(path);
-      Dump(out, begin, end);
+      return SaveToDisk(std::move(path), begin, end, PointCloudFormat::AsciiPly);
+    }
+
+    /// Save the points to @a path in @a format. The ".ply" extension, or
+    /// ".bin" for PointCloudFormat::Bin, is appended if @a path has none.
+    template <typename PointIt>
+    static std::string SaveToDisk(std::string path, PointIt begin, PointIt end, PointCloudFormat format) {
+      return SaveToDisk(std::move(path), begin, end, format, [](size_t) { return 0.0f; });
+    }
+
+    /// @copydoc SaveToDisk(std::string, PointIt, PointIt, PointCloudFormat)
+    ///
+    /// @a intensity gives the intensity of each point, only used by
+    /// PointCloudFormat::Bin.
+    template <typename PointIt, typename IntensityF>
+    static std::string SaveToDisk(
+        std::string path,
+        PointIt begin,
+        PointIt end,
+        PointCloudFormat format,
+        IntensityF &&intensity) {
+      if (format == PointCloudFormat::AsciiPly) {
+        FileSystem::ValidateFilePath(path, ".ply");
+        std::ofstream out(path);
+        Dump(out, begin, end);
+        return path;
+      }
+      FileSystem::ValidateFilePath(path, format == PointCloudFormat::Bin ? ".bin" : ".ply");
+      std::ofstream out(path, std::ios::binary);
+      if (format == PointCloudFormat::Bin) {
+        DumpBin(out, begin, end, std::forward<IntensityF>(intensity));
+      } else {
+        DumpBinary(out, begin, end);
+      }
       return path;
     }
 
   private:
 
-    static void WriteHeader(std::ostream &out, size_t number_of_points);
+    static void WriteHeader(
+        std::ostream &out,
+        size_t number_of_points,
+        PointCloudFormat format = PointCloudFormat::AsciiPly);
+
+    /// The points are written in the byte order of the host, all the
+    /// platforms supported are little-endian.
+    static void Write(std::ostream &out, const std::vector<float> &data) {
+      out.write(
+          reinterpret_cast<const char *>(data.data()),
+          static_cast<std::streamsize>(sizeof(float) * data.size()));
+    }
   };
 
 } // namespace pointcloud
@@ -0,0 +1,258 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace profiler {
+
+  /// Records spans tagged with the simulation frame they belong to, and dumps
+  /// them in the Chrome trace event format, readable by chrome://tracing and
+  /// Perfetto.
+  ///
+  /// Each thread writes to its own ring buffer without locks. Only the latest
+  /// Capacity spans of each thread are kept. Timestamps are wall-clock, so the
+  /// traces of a server and a client running on the same machine can be
+  /// merged into a single view; the frame of each span is in its arguments.
+  ///
+  /// Disabled by default, starts enabled if the environment variable
+  /// CARLA_FRAME_TRACER is set to a non-zero value.
+  class FrameTracer {
+  public:
+
+    static constexpr size_t Capacity = 8192u;
+
+    /// Microseconds since epoch.
+    static uint64_t Now() {
+      using namespace std::chrono;
+      return static_cast<uint64_t>(
+          duration_cast<microseconds>(system_clock::now().time_since_epoch()).count());
+    }
+
+    static void SetEnabled(bool enabled) {
+      GetState().is_enabled = enabled;
+    }
+
+    static bool IsEnabled() {
+      return GetState().is_enabled.load(std::memory_order_relaxed);
+    }
+
+    /// Set the process the spans are shown under, every process writing to
+    /// the same view needs a different @a id.
+    static void SetProcess(uint32_t id, std::string name) {
+      auto &state = GetState();
+      std::lock_guard<std::mutex> lock(state.mutex);
+      state.process_id = id;
+      state.process_name = std::move(name);
+    }
+
+    /// Record a span from @a start to @a end, as returned by Now().
+    ///
+    /// @pre @a name must outlive the tracer, usually a string literal.
+    static void Record(const char *name, uint64_t frame, uint64_t start, uint64_t end) {
+      if (IsEnabled()) {
+        GetThreadBuffer().Push(name, frame, start, end > start ? end - start : 0u);
+      }
+    }
+
+    /// Write the spans recorded so far as a Chrome trace JSON object.
+    static std::string DumpChromeTrace() {
+      auto &state = GetState();
+      std::lock_guard<std::mutex> lock(state.mutex);
+      std::ostringstream out;
+      out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+      out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << state.process_id
+          << ",\"args\":{\"name\":\"" << Escape(state.process_name) << "\"}}";
+      for (auto &buffer : state.buffers) {
+        buffer->Dump(state.process_id, out);
+      }
+      out << "]}";
+      return out.str();
+    }
+
+    static void Clear() {
+      auto &state = GetState();
+      std::lock_guard<std::mutex> lock(state.mutex);
+      for (auto &buffer : state.buffers) {
+        buffer->Clear();
+      }
+    }
+
+  private:
+
+    /// Single-writer ring buffer. Each slot is guarded by a sequence number,
+    /// odd while being written, so readers can skip the slots that are
+    /// overwritten under them.
+    class ThreadBuffer : private NonCopyable {
+    public:
+
+      explicit ThreadBuffer(uint32_t thread_id) : _thread_id(thread_id) {}
+
+      void Push(const char *name, uint64_t frame, uint64_t start, uint64_t duration) {
+        const auto index = _head.load(std::memory_order_relaxed);
+        auto &slot = _slots[index % Capacity];
+        const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(sequence + 1u, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.frame.store(frame, std::memory_order_relaxed);
+        slot.start.store(start, std::memory_order_relaxed);
+        slot.duration.store(duration, std::memory_order_relaxed);
+        slot.sequence.store(sequence + 2u, std::memory_order_release);
+        _head.store(index + 1u, std::memory_order_release);
+      }
+
+      void Dump(uint32_t process_id, std::ostream &out) const {
+        const auto head = _head.load(std::memory_order_acquire);
+        const auto begin = std::max(_tail.load(), head > Capacity ? head - Capacity : 0u);
+        for (auto i = begin; i < head; ++i) {
+          // Sequence of the slot once the span number i is written to it.
+          const uint64_t expected = 2u * (i / Capacity + 1u);
+          auto &slot = _slots[i % Capacity];
+          const auto sequence = slot.sequence.load(std::memory_order_acquire);
+          const char *name = slot.name.load(std::memory_order_relaxed);
+          const auto frame = slot.frame.load(std::memory_order_relaxed);
+          const auto start = slot.start.load(std::memory_order_relaxed);
+          const auto duration = slot.duration.load(std::memory_order_relaxed);
+          std::atomic_thread_fence(std::memory_order_acquire);
+          if ((sequence != expected) ||
+              (sequence != slot.sequence.load(std::memory_order_relaxed))) {
+            continue;
+          }
+          out << ",{\"name\":\"" << Escape(name) << "\",\"cat\":\"carla\",\"ph\":\"X\""
+              << ",\"ts\":" << start << ",\"dur\":" << duration
+              << ",\"pid\":" << process_id << ",\"tid\":" << _thread_id
+              << ",\"args\":{\"frame\":" << frame << "}}";
+        }
+      }
+
+      /// Drop the spans recorded so far. The writer never reads the tail, so
+      /// it is safe to call while recording.
+      void Clear() {
+        _tail = _head.load(std::memory_order_acquire);
+      }
+
+    private:
+
+      struct Slot {
+        std::atomic<uint64_t> sequence{0u};
+        std::atomic<const char *> name{nullptr};
+        std::atomic<uint64_t> frame{0u};
+        std::atomic<uint64_t> start{0u};
+        std::atomic<uint64_t> duration{0u};
+      };
+
+      const uint32_t _thread_id;
+
+      std::atomic<uint64_t> _head{0u};
+
+      std::atomic<uint64_t> _tail{0u};
+
+      std::array<Slot, Capacity> _slots;
+    };
+
+    struct State {
+      std::atomic_bool is_enabled{IsEnabledByEnvironment()};
+
+      std::mutex mutex;
+
+      /// The simulator sets its own with SetProcess.
+      uint32_t process_id = 2u;
+
+      std::string process_name = "carla-client";
+
+      /// Buffers are kept after their thread exits so its spans can still be
+      /// dumped.
+      std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    };
+
+    static bool IsEnabledByEnvironment() {
+      const char *value = std::getenv("CARLA_FRAME_TRACER");
+      return (value != nullptr) && (value[0] != '\0') && (std::string(value) != "0");
+    }
+
+    /// Never destroyed, spans may be recorded from static destructors.
+    static State &GetState() {
+      static State *state = new State;
+      return *state;
+    }
+
+    static ThreadBuffer &GetThreadBuffer() {
+      static thread_local std::shared_ptr<ThreadBuffer> buffer = []() {
+        auto &state = GetState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        const auto thread_id = static_cast<uint32_t>(state.buffers.size());
+        state.buffers.emplace_back(std::make_shared<ThreadBuffer>(thread_id));
+        return state.buffers.back();
+      }();
+      return *buffer;
+    }
+
+    static std::string Escape(const std::string &str) {
+      std::string result;
+      result.reserve(str.size());
+      for (auto c : str) {
+        if ((c == '"') || (c == '\\')) {
+          result.push_back('\\');
+        }
+        if (static_cast<unsigned char>(c) >= 0x20) {
+          result.push_back(c);
+        }
+      }
+      return result;
+    }
+  };
+
+  /// Records a span from its construction to its destruction. The frame may
+  /// be set later if it is not known yet.
+  class FrameTraceSpan : private NonCopyable {
+  public:
+
+    explicit FrameTraceSpan(const char *name, uint64_t frame = 0u)
+      : _name(name),
+        _frame(frame),
+        _start(FrameTracer::IsEnabled() ? FrameTracer::Now() : 0u) {}
+
+    ~FrameTraceSpan() {
+      if (_start != 0u) {
+        FrameTracer::Record(_name, _frame, _start, FrameTracer::Now());
+      }
+    }
+
+    void SetFrame(uint64_t frame) {
+      _frame = frame;
+    }
+
+  private:
+
+    const char *_name;
+
+    uint64_t _frame;
+
+    const uint64_t _start;
+  };
+
+} // namespace profiler
+} // namespace carla
+
+/// Trace the rest of the enclosing scope as "context.name" belonging to
+/// @a frame.
+#define CARLA_TRACE_FRAME(context, name, frame) \
+    ::carla::profiler::FrameTraceSpan carla_frame_trace_ ## context ## _ ## name(#context "." #name, frame);
@@ -7,7 +7,9 @@
 #pragma once
 
 #ifndef LIBCARLA_ENABLE_PROFILER
-#  define CARLA_PROFILE_SCOPE(context, profiler_name)
+#  include "carla/profiler/RuntimeProfiler.h"
+// Without the compile-time profiler, scopes go to the runtime profiler.
+#  define CARLA_PROFILE_SCOPE(context, profiler_name) CARLA_RUNTIME_PROFILE_SCOPE(context, profiler_name)
 #  define CARLA_PROFILE_FPS(context, profiler_name)
 #else
 
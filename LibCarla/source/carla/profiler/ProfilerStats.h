@@ -0,0 +1,44 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+
+#include <cstdint>
+#include <string>
+
+namespace carla {
+namespace profiler {
+
+  /// Statistics of a profiled scope, aggregated across all threads since it
+  /// was first run or since the last reset. Times are in milliseconds.
+  class ProfilerStats {
+  public:
+
+    std::string name;
+
+    uint64_t count = 0u;
+
+    double total = 0.0;
+
+    double minimum = 0.0;
+
+    double maximum = 0.0;
+
+    double mean = 0.0;
+
+    double p50 = 0.0;
+
+    double p99 = 0.0;
+
+    double p999 = 0.0;
+
+    MSGPACK_DEFINE_ARRAY(name, count, total, minimum, maximum, mean, p50, p99, p999);
+  };
+
+} // namespace profiler
+} // namespace carla
@@ -0,0 +1,328 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/profiler/ProfilerStats.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace profiler {
+
+  /// Latency histogram with logarithmic buckets, each power of two is split in
+  /// 16 linear sub-buckets, so percentiles are within about 6% of the real
+  /// value. Values are in nanoseconds.
+  ///
+  /// Thread-safe, but meant to be written by a single thread so the atomic
+  /// updates are never contended.
+  class LatencyHistogram : private NonCopyable {
+  public:
+
+    static constexpr unsigned SubBucketBits = 4u;
+
+    static constexpr uint64_t SubBuckets = 1u << SubBucketBits;
+
+    /// Up to 2^48 nanoseconds, about three days.
+    static constexpr unsigned MaxMagnitude = 48u;
+
+    static constexpr size_t NumberOfBuckets = SubBuckets + (MaxMagnitude - SubBucketBits) * SubBuckets;
+
+    LatencyHistogram() {
+      Reset();
+    }
+
+    void Record(uint64_t nanoseconds) {
+      _buckets[GetBucket(nanoseconds)].fetch_add(1u, std::memory_order_relaxed);
+      _count.fetch_add(1u, std::memory_order_relaxed);
+      _total.fetch_add(nanoseconds, std::memory_order_relaxed);
+      auto max = _max.load(std::memory_order_relaxed);
+      while ((nanoseconds > max) && !_max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed));
+      auto min = _min.load(std::memory_order_relaxed);
+      while ((nanoseconds < min) && !_min.compare_exchange_weak(min, nanoseconds, std::memory_order_relaxed));
+    }
+
+    void Reset() {
+      for (auto &bucket : _buckets) {
+        bucket.store(0u, std::memory_order_relaxed);
+      }
+      _count = 0u;
+      _total = 0u;
+      _max = 0u;
+      _min = std::numeric_limits<uint64_t>::max();
+    }
+
+    /// Add the counts of this histogram to @a counts, and its totals to the
+    /// rest.
+    void MergeInto(
+        std::vector<uint64_t> &counts,
+        uint64_t &count,
+        uint64_t &total,
+        uint64_t &min,
+        uint64_t &max) const {
+      counts.resize(NumberOfBuckets, 0u);
+      for (size_t i = 0u; i < NumberOfBuckets; ++i) {
+        counts[i] += _buckets[i].load(std::memory_order_relaxed);
+      }
+      count += _count.load(std::memory_order_relaxed);
+      total += _total.load(std::memory_order_relaxed);
+      min = std::min(min, _min.load(std::memory_order_relaxed));
+      max = std::max(max, _max.load(std::memory_order_relaxed));
+    }
+
+    static size_t GetBucket(uint64_t value) {
+      if (value < SubBuckets) {
+        return static_cast<size_t>(value);
+      }
+      unsigned magnitude = SubBucketBits;
+      while ((magnitude + 1u < MaxMagnitude) && ((value >> (magnitude + 1u)) != 0u)) {
+        ++magnitude;
+      }
+      const unsigned shift = magnitude - SubBucketBits;
+      const uint64_t sub_bucket = std::min((value >> shift) - SubBuckets, SubBuckets - 1u);
+      return static_cast<size_t>(SubBuckets + shift * SubBuckets + sub_bucket);
+    }
+
+    /// Middle of the values that fall in @a bucket.
+    static uint64_t GetBucketValue(size_t bucket) {
+      if (bucket < SubBuckets) {
+        return bucket;
+      }
+      const uint64_t shift = (bucket - SubBuckets) / SubBuckets;
+      const uint64_t sub_bucket = (bucket - SubBuckets) % SubBuckets;
+      const uint64_t lower = (SubBuckets + sub_bucket) << shift;
+      return lower + ((uint64_t(1u) << shift) >> 1u);
+    }
+
+  private:
+
+    std::array<std::atomic<uint64_t>, NumberOfBuckets> _buckets;
+
+    std::atomic<uint64_t> _count;
+
+    std::atomic<uint64_t> _total;
+
+    std::atomic<uint64_t> _max;
+
+    std::atomic<uint64_t> _min;
+  };
+
+  /// A profiled scope. Each thread records into its own histogram, they are
+  /// only merged when taking a snapshot.
+  class ProfiledScope : private NonCopyable {
+  public:
+
+    explicit ProfiledScope(std::string name) : _name(std::move(name)) {}
+
+    /// Histogram of the calling thread, the returned pointer stays valid
+    /// after the thread exits.
+    LatencyHistogram *AddThread() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _histograms.emplace_back(std::make_unique<LatencyHistogram>());
+      return _histograms.back().get();
+    }
+
+    ProfilerStats GetStats() const {
+      std::vector<uint64_t> counts;
+      ProfilerStats stats;
+      stats.name = _name;
+      uint64_t total = 0u;
+      uint64_t min = std::numeric_limits<uint64_t>::max();
+      uint64_t max = 0u;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto &histogram : _histograms) {
+          histogram->MergeInto(counts, stats.count, total, min, max);
+        }
+      }
+      if (stats.count == 0u) {
+        return stats;
+      }
+      stats.total = ms(total);
+      stats.minimum = ms(min);
+      stats.maximum = ms(max);
+      stats.mean = stats.total / static_cast<double>(stats.count);
+      stats.p50 = ms(GetPercentile(counts, stats.count, 0.5, min, max));
+      stats.p99 = ms(GetPercentile(counts, stats.count, 0.99, min, max));
+      stats.p999 = ms(GetPercentile(counts, stats.count, 0.999, min, max));
+      return stats;
+    }
+
+    void Reset() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      for (auto &histogram : _histograms) {
+        histogram->Reset();
+      }
+    }
+
+  private:
+
+    static double ms(uint64_t nanoseconds) {
+      return 1e-6 * static_cast<double>(nanoseconds);
+    }
+
+    static uint64_t GetPercentile(
+        const std::vector<uint64_t> &counts,
+        uint64_t count,
+        double percentile,
+        uint64_t min,
+        uint64_t max) {
+      const auto rank = static_cast<uint64_t>(std::ceil(percentile * static_cast<double>(count)));
+      uint64_t accumulated = 0u;
+      for (size_t i = 0u; i < counts.size(); ++i) {
+        accumulated += counts[i];
+        if (accumulated >= rank) {
+          return std::min(max, std::max(min, LatencyHistogram::GetBucketValue(i)));
+        }
+      }
+      return max;
+    }
+
+    const std::string _name;
+
+    mutable std::mutex _mutex;
+
+    std::vector<std::unique_ptr<LatencyHistogram>> _histograms;
+  };
+
+  /// Profiler that is always compiled in and can be switched on and off at
+  /// runtime, with CARLA_PROFILE_SCOPE. While disabled a profiled scope costs
+  /// a relaxed atomic load. Starts enabled if the environment variable
+  /// CARLA_PROFILER is set to a non-zero value.
+  class RuntimeProfiler {
+  public:
+
+    static void SetEnabled(bool enabled) {
+      GetState().is_enabled = enabled;
+    }
+
+    static bool IsEnabled() {
+      return GetState().is_enabled.load(std::memory_order_relaxed);
+    }
+
+    /// Scope named @a name, created the first time it is requested.
+    static ProfiledScope &GetScope(const std::string &name) {
+      auto &state = GetState();
+      std::lock_guard<std::mutex> lock(state.mutex);
+      auto &scope = state.scopes[name];
+      if (scope == nullptr) {
+        scope = std::make_unique<ProfiledScope>(name);
+      }
+      return *scope;
+    }
+
+    /// Statistics of every scope that was run at least once.
+    static std::vector<ProfilerStats> GetStats() {
+      auto &state = GetState();
+      std::vector<ProfilerStats> result;
+      std::lock_guard<std::mutex> lock(state.mutex);
+      result.reserve(state.scopes.size());
+      for (auto &item : state.scopes) {
+        auto stats = item.second->GetStats();
+        if (stats.count > 0u) {
+          result.emplace_back(std::move(stats));
+        }
+      }
+      std::sort(result.begin(), result.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.name < rhs.name;
+      });
+      return result;
+    }
+
+    static void Reset() {
+      auto &state = GetState();
+      std::lock_guard<std::mutex> lock(state.mutex);
+      for (auto &item : state.scopes) {
+        item.second->Reset();
+      }
+    }
+
+  private:
+
+    struct State {
+      std::atomic_bool is_enabled{IsEnabledByEnvironment()};
+
+      std::mutex mutex;
+
+      std::unordered_map<std::string, std::unique_ptr<ProfiledScope>> scopes;
+    };
+
+    static bool IsEnabledByEnvironment() {
+      const char *value = std::getenv("CARLA_PROFILER");
+      return (value != nullptr) && (value[0] != '\0') && (std::string(value) != "0");
+    }
+
+    /// Never destroyed, scopes may be run from static destructors.
+    static State &GetState() {
+      static State *state = new State;
+      return *state;
+    }
+  };
+
+namespace detail {
+
+  /// Records the lifetime of a scope into @a histogram, created on the first
+  /// run of each thread.
+  class RuntimeScopedProfiler : private NonCopyable {
+  public:
+
+    RuntimeScopedProfiler(ProfiledScope &scope, LatencyHistogram *&histogram)
+      : _scope(scope),
+        _histogram(histogram),
+        _is_enabled(RuntimeProfiler::IsEnabled()) {
+      if (_is_enabled) {
+        _start = std::chrono::steady_clock::now();
+      }
+    }
+
+    ~RuntimeScopedProfiler() {
+      if (_is_enabled) {
+        const auto elapsed = std::chrono::steady_clock::now() - _start;
+        if (_histogram == nullptr) {
+          _histogram = _scope.AddThread();
+        }
+        _histogram->Record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+      }
+    }
+
+  private:
+
+    ProfiledScope &_scope;
+
+    LatencyHistogram *&_histogram;
+
+    const bool _is_enabled;
+
+    std::chrono::steady_clock::time_point _start;
+  };
+
+} // namespace detail
+} // namespace profiler
+} // namespace carla
+
+/// Profile the rest of the enclosing scope as "context.profiler_name" in the
+/// RuntimeProfiler.
+#define CARLA_RUNTIME_PROFILE_SCOPE(context, profiler_name) \
+    static ::carla::profiler::ProfiledScope &carla_runtime_profiler_ ## context ## _ ## profiler_name ## _scope = \
+        ::carla::profiler::RuntimeProfiler::GetScope(#context "." #profiler_name); \
+    static thread_local ::carla::profiler::LatencyHistogram *carla_runtime_profiler_ ## context ## _ ## profiler_name ## _histogram = nullptr; \
+    ::carla::profiler::detail::RuntimeScopedProfiler carla_runtime_profiler_ ## context ## _ ## profiler_name ## _scoped_profiler( \
+        carla_runtime_profiler_ ## context ## _ ## profiler_name ## _scope, \
+        carla_runtime_profiler_ ## context ## _ ## profiler_name ## _histogram);
@@ -0,0 +1,135 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/Vector3D.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace recorder {
+
+  /// Identifiers of the packets of a recorder file, as written by the
+  /// simulator (see Docs/recorder_binary_file_format.md).
+  enum class PacketId : uint8_t {
+    FrameStart = 0,
+    FrameEnd,
+    EventAdd,
+    EventDel,
+    EventParent,
+    Collision,
+    Position,
+    State,
+    AnimVehicle,
+    AnimWalker,
+    FrameIndex,
+    KeyFrame
+  };
+
+  /// Header at the start of a recorder file.
+  struct RecorderInfo {
+    uint16_t version = 0u;
+    std::string magic;
+    int64_t date = 0;
+    std::string map;
+  };
+
+  // ===========================================================================
+  // -- Fixed size packets -----------------------------------------------------
+  // ===========================================================================
+
+  // These structs have the same layout as the data in the file, so the
+  // entries of a packet are read in place. Locations are in centimeters and
+  // rotations are (roll, pitch, yaw) in degrees, as recorded in the simulator.
+
+#pragma pack(push, 1)
+
+  struct FrameStart {
+    uint64_t id;
+    double duration;
+    double elapsed;
+  };
+
+  struct EventDel {
+    uint32_t database_id;
+  };
+
+  struct EventParent {
+    uint32_t database_id;
+    uint32_t parent_id;
+  };
+
+  struct Collision {
+    uint32_t id;
+    uint32_t database_id1;
+    uint32_t database_id2;
+    bool is_actor1_hero;
+    bool is_actor2_hero;
+  };
+
+  struct Position {
+    uint32_t database_id;
+    geom::Vector3D location;
+    geom::Vector3D rotation;
+  };
+
+  struct TrafficLightState {
+    uint32_t database_id;
+    bool is_frozen;
+    float elapsed_time;
+    char state;
+  };
+
+  struct VehicleAnimation {
+    uint32_t database_id;
+    float steering;
+    float throttle;
+    float brake;
+    bool handbrake;
+    int32_t gear;
+  };
+
+  struct WalkerAnimation {
+    uint32_t database_id;
+    float speed;
+  };
+
+#pragma pack(pop)
+
+  static_assert(sizeof(FrameStart) == 24u, "Invalid recorder packet layout");
+  static_assert(sizeof(Collision) == 14u, "Invalid recorder packet layout");
+  static_assert(sizeof(Position) == 28u, "Invalid recorder packet layout");
+  static_assert(sizeof(TrafficLightState) == 10u, "Invalid recorder packet layout");
+  static_assert(sizeof(VehicleAnimation) == 21u, "Invalid recorder packet layout");
+  static_assert(sizeof(WalkerAnimation) == 8u, "Invalid recorder packet layout");
+
+  // ===========================================================================
+  // -- Variable size packets --------------------------------------------------
+  // ===========================================================================
+
+  struct ActorAttribute {
+    uint8_t type;
+    std::string id;
+    std::string value;
+  };
+
+  struct EventAdd {
+    uint32_t database_id;
+    /// Type of actor: 0 other, 1 vehicle, 2 walker, 3 traffic light, 4 invalid.
+    uint8_t type;
+    geom::Vector3D location;
+    geom::Vector3D rotation;
+    uint32_t uid;
+    /// Blueprint id, e.g. "vehicle.tesla.model3".
+    std::string id;
+    std::vector<ActorAttribute> attributes;
+  };
+
+} // namespace recorder
+} // namespace carla
@@ -0,0 +1,385 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/recorder/RecorderReader.h"
+
+#include "carla/Exception.h"
+#include "carla/Lz4.h"
+
+#include <fstream>
+#include <stdexcept>
+
+namespace carla {
+namespace recorder {
+
+  // ===========================================================================
+  // -- Compressed files -------------------------------------------------------
+  // ===========================================================================
+
+  // Layout of compressed recordings, as written by the simulator.
+  static constexpr uint32_t COMPRESSED_MAGIC = 0x5A4C5243u; // "CRLZ"
+  static constexpr size_t COMPRESSED_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint16_t);
+  static constexpr size_t COMPRESSED_TRAILER_SIZE = 2u * sizeof(uint64_t) + 2u * sizeof(uint32_t);
+
+  static constexpr size_t PLAIN_BUFFER_SIZE = 1024u * 1024u;
+
+  // ===========================================================================
+  // -- RecorderReader::Source -------------------------------------------------
+  // ===========================================================================
+
+  /// Uncompressed bytes of the file, read in large blocks.
+  class RecorderReader::Source {
+  public:
+
+    explicit Source(const std::string &filename) {
+      _file.open(filename, std::ios::in | std::ios::binary);
+      if (!_file.is_open()) {
+        throw_exception(std::runtime_error("cannot open recorder file " + filename));
+      }
+      uint32_t magic = 0u;
+      _compressed = ReadRaw(magic) && (magic == COMPRESSED_MAGIC);
+      if (_compressed) {
+        // the blocks end where the block table starts
+        _file.seekg(-static_cast<std::streamoff>(COMPRESSED_TRAILER_SIZE), std::ios::end);
+        if (!ReadRaw(_blocks_end)) {
+          throw_exception(std::runtime_error("corrupted recorder file " + filename));
+        }
+        _file.clear();
+        _file.seekg(COMPRESSED_HEADER_SIZE, std::ios::beg);
+        _file_offset = COMPRESSED_HEADER_SIZE;
+      } else {
+        _file.clear();
+        _file.seekg(0, std::ios::beg);
+      }
+    }
+
+    /// Returns false if there are not @a size bytes left.
+    bool Read(void *destination, size_t size) {
+      auto *out = static_cast<unsigned char *>(destination);
+      while (size > 0u) {
+        if ((_current == _buffer.size()) && !Fill()) {
+          return false;
+        }
+        const size_t count = std::min(size, _buffer.size() - _current);
+        std::memcpy(out, _buffer.data() + _current, count);
+        _current += count;
+        out += count;
+        size -= count;
+      }
+      return true;
+    }
+
+    template <typename T>
+    bool ReadValue(T &value) {
+      return Read(&value, sizeof(T));
+    }
+
+    /// Append @a size bytes to @a destination.
+    bool Append(std::vector<unsigned char> &destination, size_t size) {
+      const size_t offset = destination.size();
+      destination.resize(offset + size);
+      return Read(destination.data() + offset, size);
+    }
+
+    bool Skip(size_t size) {
+      while (size > 0u) {
+        if ((_current == _buffer.size()) && !Fill()) {
+          return false;
+        }
+        const size_t count = std::min(size, _buffer.size() - _current);
+        _current += count;
+        size -= count;
+      }
+      return true;
+    }
+
+  private:
+
+    template <typename T>
+    bool ReadRaw(T &value) {
+      _file.read(reinterpret_cast<char *>(&value), sizeof(T));
+      return static_cast<bool>(_file);
+    }
+
+    /// Load the next block of data.
+    bool Fill() {
+      _current = 0u;
+      _buffer.clear();
+      if (!_compressed) {
+        _buffer.resize(PLAIN_BUFFER_SIZE);
+        _file.read(reinterpret_cast<char *>(_buffer.data()), static_cast<std::streamsize>(_buffer.size()));
+        _buffer.resize(static_cast<size_t>(_file.gcount()));
+        return !_buffer.empty();
+      }
+      if (_file_offset >= _blocks_end) {
+        return false;
+      }
+      uint32_t compressed_size = 0u;
+      uint32_t size = 0u;
+      if (!ReadRaw(compressed_size) || !ReadRaw(size)) {
+        throw_exception(std::runtime_error("corrupted recorder file block"));
+      }
+      _buffer.resize(size);
+      if (compressed_size == size) {
+        // stored as is
+        _file.read(reinterpret_cast<char *>(_buffer.data()), size);
+      } else {
+        _compressed_buffer.resize(compressed_size);
+        _file.read(reinterpret_cast<char *>(_compressed_buffer.data()), compressed_size);
+        if (!_file || !Lz4::Decompress(_compressed_buffer.data(), compressed_size, _buffer.data(), size)) {
+          throw_exception(std::runtime_error("corrupted recorder file block"));
+        }
+      }
+      if (!_file) {
+        throw_exception(std::runtime_error("corrupted recorder file block"));
+      }
+      _file_offset += 2u * sizeof(uint32_t) + compressed_size;
+      return !_buffer.empty() || Fill();
+    }
+
+    std::ifstream _file;
+
+    bool _compressed = false;
+
+    uint64_t _file_offset = 0u;
+
+    uint64_t _blocks_end = 0u;
+
+    std::vector<unsigned char> _buffer;
+
+    std::vector<unsigned char> _compressed_buffer;
+
+    size_t _current = 0u;
+  };
+
+  // ===========================================================================
+  // -- Decoding ---------------------------------------------------------------
+  // ===========================================================================
+
+  namespace {
+
+    /// Reads values from the data of a packet.
+    class PacketDecoder {
+    public:
+
+      PacketDecoder(const unsigned char *data, size_t size)
+        : _data(data),
+          _end(data + size) {}
+
+      template <typename T>
+      T Read() {
+        T value;
+        Check(sizeof(T));
+        std::memcpy(&value, _data, sizeof(T));
+        _data += sizeof(T);
+        return value;
+      }
+
+      geom::Vector3D ReadVector() {
+        const float x = Read<float>();
+        const float y = Read<float>();
+        const float z = Read<float>();
+        return {x, y, z};
+      }
+
+      /// Length (uint16) and UTF-8 text.
+      std::string ReadString() {
+        const auto length = Read<uint16_t>();
+        Check(length);
+        std::string text(reinterpret_cast<const char *>(_data), length);
+        _data += length;
+        return text;
+      }
+
+      EventAdd ReadEventAdd() {
+        EventAdd event;
+        event.database_id = Read<uint32_t>();
+        event.type = Read<uint8_t>();
+        event.location = ReadVector();
+        event.rotation = ReadVector();
+        event.uid = Read<uint32_t>();
+        event.id = ReadString();
+        const auto total = Read<uint16_t>();
+        event.attributes.reserve(total);
+        for (auto i = 0u; i < total; ++i) {
+          ActorAttribute attribute;
+          attribute.type = Read<uint8_t>();
+          attribute.id = ReadString();
+          attribute.value = ReadString();
+          event.attributes.emplace_back(std::move(attribute));
+        }
+        return event;
+      }
+
+    private:
+
+      void Check(size_t size) const {
+        if (static_cast<size_t>(_end - _data) < size) {
+          throw_exception(std::runtime_error("corrupted recorder packet"));
+        }
+      }
+
+      const unsigned char *_data;
+
+      const unsigned char *_end;
+    };
+
+  } // namespace
+
+  // ===========================================================================
+  // -- RecorderFrame ----------------------------------------------------------
+  // ===========================================================================
+
+  const RecorderFrame::Packet *RecorderFrame::FindPacket(PacketId id) const {
+    for (auto &packet : _packets) {
+      if (packet.id == id) {
+        return &packet;
+      }
+    }
+    return nullptr;
+  }
+
+  std::vector<EventAdd> RecorderFrame::GetEventsAdd() const {
+    std::vector<EventAdd> result;
+    const Packet *packet = FindPacket(PacketId::EventAdd);
+    if (packet != nullptr) {
+      PacketDecoder decoder(_data.data() + packet->offset, packet->size);
+      const auto total = decoder.Read<uint16_t>();
+      result.reserve(total);
+      for (auto i = 0u; i < total; ++i) {
+        result.emplace_back(decoder.ReadEventAdd());
+      }
+    }
+    return result;
+  }
+
+  std::vector<EventAdd> RecorderFrame::GetKeyFrameActors() const {
+    std::vector<EventAdd> result;
+    const Packet *packet = FindPacket(PacketId::KeyFrame);
+    if (packet != nullptr) {
+      PacketDecoder decoder(_data.data() + packet->offset, packet->size);
+      const auto total = decoder.Read<uint16_t>();
+      result.reserve(total);
+      for (auto i = 0u; i < total; ++i) {
+        result.emplace_back(decoder.ReadEventAdd());
+      }
+    }
+    return result;
+  }
+
+  std::vector<EventParent> RecorderFrame::GetKeyFrameParents() const {
+    std::vector<EventParent> result;
+    const Packet *packet = FindPacket(PacketId::KeyFrame);
+    if (packet != nullptr) {
+      // the parents follow the actors
+      PacketDecoder decoder(_data.data() + packet->offset, packet->size);
+      const auto actors = decoder.Read<uint16_t>();
+      for (auto i = 0u; i < actors; ++i) {
+        decoder.ReadEventAdd();
+      }
+      const auto total = decoder.Read<uint16_t>();
+      result.reserve(total);
+      for (auto i = 0u; i < total; ++i) {
+        result.emplace_back(decoder.Read<EventParent>());
+      }
+    }
+    return result;
+  }
+
+  // ===========================================================================
+  // -- RecorderReader ---------------------------------------------------------
+  // ===========================================================================
+
+  RecorderReader::RecorderReader(const std::string &filename)
+    : _source(std::make_unique<Source>(filename)) {
+    // the info header is not a packet
+    auto read_string = [this](std::string &text) {
+      uint16_t length = 0u;
+      if (!_source->ReadValue(length)) {
+        return false;
+      }
+      text.resize(length);
+      return (length == 0u) || _source->Read(&text[0], length);
+    };
+    if (!_source->ReadValue(_info.version) ||
+        !read_string(_info.magic) ||
+        !_source->ReadValue(_info.date) ||
+        !read_string(_info.map) ||
+        (_info.magic != "CARLA_RECORDER")) {
+      throw_exception(std::runtime_error(filename + " is not a CARLA recorder file"));
+    }
+  }
+
+  RecorderReader::~RecorderReader() = default;
+
+  bool RecorderReader::ReadFrame(RecorderFrame &frame) {
+    frame._data.clear();
+    frame._packets.clear();
+    bool started = false;
+    if (_has_pending_start) {
+      frame._start = _pending_start;
+      _has_pending_start = false;
+      started = true;
+    }
+
+    for (;;) {
+      char id;
+      uint32_t size;
+      if (!_source->ReadValue(id)) {
+        // end of the file
+        return started;
+      }
+      if (!_source->ReadValue(size)) {
+        throw_exception(std::runtime_error("corrupted recorder file"));
+      }
+
+      switch (static_cast<PacketId>(id)) {
+        case PacketId::FrameStart: {
+          FrameStart start;
+          if ((size != sizeof(FrameStart)) || !_source->ReadValue(start)) {
+            throw_exception(std::runtime_error("corrupted recorder frame"));
+          }
+          if (started) {
+            // the previous frame had no end packet
+            _pending_start = start;
+            _has_pending_start = true;
+            return true;
+          }
+          frame._start = start;
+          started = true;
+          break;
+        }
+        case PacketId::FrameEnd:
+          if (!_source->Skip(size)) {
+            throw_exception(std::runtime_error("corrupted recorder file"));
+          }
+          if (started) {
+            return true;
+          }
+          break;
+        case PacketId::FrameIndex:
+          if (!_source->Skip(size)) {
+            throw_exception(std::runtime_error("corrupted recorder file"));
+          }
+          break;
+        default:
+          if (!started) {
+            if (!_source->Skip(size)) {
+              throw_exception(std::runtime_error("corrupted recorder file"));
+            }
+            break;
+          }
+          frame._packets.push_back({static_cast<PacketId>(id), frame._data.size(), size});
+          if (!_source->Append(frame._data, size)) {
+            throw_exception(std::runtime_error("corrupted recorder file"));
+          }
+          break;
+      }
+    }
+  }
+
+} // namespace recorder
+} // namespace carla
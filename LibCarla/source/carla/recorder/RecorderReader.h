@@ -0,0 +1,247 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/recorder/RecorderPackets.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace recorder {
+
+  /// Entries of a fixed size packet. The view points to the data of the
+  /// frame, each entry is decoded when accessed.
+  template <typename T>
+  class PacketView {
+  public:
+
+    using value_type = T;
+
+    class const_iterator {
+    public:
+
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = T;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const T *;
+      using reference = T;
+
+      explicit const_iterator(const unsigned char *data = nullptr) : _data(data) {}
+
+      T operator*() const {
+        T value;
+        std::memcpy(&value, _data, sizeof(T));
+        return value;
+      }
+
+      const_iterator &operator++() {
+        _data += sizeof(T);
+        return *this;
+      }
+
+      const_iterator operator++(int) {
+        auto tmp = *this;
+        ++*this;
+        return tmp;
+      }
+
+      difference_type operator-(const const_iterator &rhs) const {
+        return (_data - rhs._data) / static_cast<difference_type>(sizeof(T));
+      }
+
+      bool operator==(const const_iterator &rhs) const {
+        return _data == rhs._data;
+      }
+
+      bool operator!=(const const_iterator &rhs) const {
+        return _data != rhs._data;
+      }
+
+    private:
+
+      const unsigned char *_data;
+    };
+
+    PacketView() = default;
+
+    PacketView(const unsigned char *data, size_t size)
+      : _data(data),
+        _size(size) {}
+
+    size_t size() const {
+      return _size;
+    }
+
+    bool empty() const {
+      return _size == 0u;
+    }
+
+    T at(size_t index) const {
+      return *const_iterator(_data + index * sizeof(T));
+    }
+
+    T operator[](size_t index) const {
+      return at(index);
+    }
+
+    const_iterator begin() const {
+      return const_iterator(_data);
+    }
+
+    const_iterator end() const {
+      return const_iterator(_data + _size * sizeof(T));
+    }
+
+  private:
+
+    const unsigned char *_data = nullptr;
+
+    size_t _size = 0u;
+  };
+
+  /// A frame of a recording, with the data of all its packets. The views
+  /// returned point to this data, they are valid until the frame is read
+  /// again or destroyed.
+  class RecorderFrame {
+  public:
+
+    uint64_t GetId() const {
+      return _start.id;
+    }
+
+    /// Simulation time at the start of the frame in seconds.
+    double GetElapsed() const {
+      return _start.elapsed;
+    }
+
+    /// Duration of the frame in seconds.
+    double GetDuration() const {
+      return _start.duration;
+    }
+
+    /// Actors created in this frame.
+    std::vector<EventAdd> GetEventsAdd() const;
+
+    PacketView<EventDel> GetEventsDel() const {
+      return GetView<EventDel>(PacketId::EventDel);
+    }
+
+    PacketView<EventParent> GetEventsParent() const {
+      return GetView<EventParent>(PacketId::EventParent);
+    }
+
+    PacketView<Collision> GetCollisions() const {
+      return GetView<Collision>(PacketId::Collision);
+    }
+
+    PacketView<Position> GetPositions() const {
+      return GetView<Position>(PacketId::Position);
+    }
+
+    PacketView<TrafficLightState> GetTrafficLightStates() const {
+      return GetView<TrafficLightState>(PacketId::State);
+    }
+
+    PacketView<VehicleAnimation> GetVehicleAnimations() const {
+      return GetView<VehicleAnimation>(PacketId::AnimVehicle);
+    }
+
+    PacketView<WalkerAnimation> GetWalkerAnimations() const {
+      return GetView<WalkerAnimation>(PacketId::AnimWalker);
+    }
+
+    /// Whether the frame has a key frame with all the actors alive.
+    bool IsKeyFrame() const {
+      return FindPacket(PacketId::KeyFrame) != nullptr;
+    }
+
+    /// Actors alive in the key frame, empty if this is not a key frame.
+    std::vector<EventAdd> GetKeyFrameActors() const;
+
+    /// Parenting of the actors in the key frame.
+    std::vector<EventParent> GetKeyFrameParents() const;
+
+  private:
+
+    friend class RecorderReader;
+
+    struct Packet {
+      PacketId id;
+      size_t offset;
+      size_t size;
+    };
+
+    const Packet *FindPacket(PacketId id) const;
+
+    /// Packet with a uint16 total followed by the entries.
+    template <typename T>
+    PacketView<T> GetView(PacketId id) const;
+
+    FrameStart _start = {0u, 0.0, 0.0};
+
+    std::vector<unsigned char> _data;
+
+    std::vector<Packet> _packets;
+  };
+
+  /// Reads a recorder file sequentially, without the simulator. Both plain
+  /// and compressed recordings are supported. Only the data of one frame is
+  /// held in memory at a time.
+  class RecorderReader : private NonCopyable {
+  public:
+
+    /// @throw std::runtime_error if the file cannot be opened or it is not a
+    /// recorder file.
+    explicit RecorderReader(const std::string &filename);
+
+    ~RecorderReader();
+
+    const RecorderInfo &GetInfo() const {
+      return _info;
+    }
+
+    /// Read the next frame into @a frame, reusing its memory. Returns false
+    /// at the end of the file.
+    ///
+    /// @throw std::runtime_error if the file is corrupted.
+    bool ReadFrame(RecorderFrame &frame);
+
+  private:
+
+    class Source;
+
+    std::unique_ptr<Source> _source;
+
+    RecorderInfo _info;
+
+    /// Frame start packet read past the end of the previous frame.
+    bool _has_pending_start = false;
+
+    FrameStart _pending_start;
+  };
+
+  template <typename T>
+  inline PacketView<T> RecorderFrame::GetView(PacketId id) const {
+    const Packet *packet = FindPacket(id);
+    if ((packet == nullptr) || (packet->size < sizeof(uint16_t))) {
+      return {};
+    }
+    uint16_t total;
+    const unsigned char *begin = _data.data() + packet->offset;
+    std::memcpy(&total, begin, sizeof(uint16_t));
+    const size_t available = (packet->size - sizeof(uint16_t)) / sizeof(T);
+    return {begin + sizeof(uint16_t), std::min<size_t>(total, available)};
+  }
+
+} // namespace recorder
+} // namespace carla
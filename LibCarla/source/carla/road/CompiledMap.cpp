@@ -0,0 +1,628 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/CompiledMap.h"
+
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+#include "carla/road/MapBuilder.h"
+#include "carla/road/element/RoadInfoElevation.h"
+#include "carla/road/element/RoadInfoGeometry.h"
+#include "carla/road/element/RoadInfoLaneAccess.h"
+#include "carla/road/element/RoadInfoLaneBorder.h"
+#include "carla/road/element/RoadInfoLaneHeight.h"
+#include "carla/road/element/RoadInfoLaneMaterial.h"
+#include "carla/road/element/RoadInfoLaneOffset.h"
+#include "carla/road/element/RoadInfoLaneRule.h"
+#include "carla/road/element/RoadInfoLaneVisibility.h"
+#include "carla/road/element/RoadInfoLaneWidth.h"
+#include "carla/road/element/RoadInfoMarkRecord.h"
+#include "carla/road/element/RoadInfoMarkTypeLine.h"
+#include "carla/road/element/RoadInfoSpeed.h"
+
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+namespace carla {
+namespace road {
+
+  using namespace element;
+
+  constexpr uint32_t CompiledMap::Version;
+
+  static constexpr char MAGIC[] = {'C', 'M', 'A', 'P'};
+
+namespace detail {
+
+  class ImageWriter {
+  public:
+
+    template <typename T>
+    void Write(const T &value) {
+      static_assert(std::is_arithmetic<T>::value, "only numbers are written as is");
+      const auto *begin = reinterpret_cast<const unsigned char *>(&value);
+      _buffer.insert(_buffer.end(), begin, begin + sizeof(T));
+    }
+
+    void Write(const std::string &str) {
+      WriteCount(str.size());
+      _buffer.insert(_buffer.end(), str.begin(), str.end());
+    }
+
+    void WriteCount(const size_t count) {
+      Write(static_cast<uint32_t>(count));
+    }
+
+    /// Write the coefficients of @a polynomial as they were given to its
+    /// constructor, before the offset of its start was applied.
+    void Write(const geom::CubicPolynomial &polynomial) {
+      const auto s = polynomial.GetS();
+      const auto a = polynomial.GetA();
+      const auto b = polynomial.GetB();
+      const auto c = polynomial.GetC();
+      const auto d = polynomial.GetD();
+      Write(a + b * s + c * s * s + d * s * s * s);
+      Write(b + 2.0 * c * s + 3.0 * d * s * s);
+      Write(c + 3.0 * d * s);
+      Write(d);
+    }
+
+    std::vector<unsigned char> Release() {
+      return std::move(_buffer);
+    }
+
+  private:
+
+    std::vector<unsigned char> _buffer;
+  };
+
+  /// Reads an image without going past its end, once a read fails the
+  /// following ones return zeros.
+  class ImageReader {
+  public:
+
+    ImageReader(const unsigned char *image, const size_t size)
+      : _it(image),
+        _end(image + size) {}
+
+    template <typename T>
+    T Read() {
+      static_assert(std::is_arithmetic<T>::value, "only numbers are read as is");
+      T value = T();
+      if (Consume(sizeof(T))) {
+        std::memcpy(&value, _it - sizeof(T), sizeof(T));
+      }
+      return value;
+    }
+
+    std::string ReadString() {
+      const auto size = ReadCount(1u);
+      return Consume(size) ?
+          std::string(reinterpret_cast<const char *>(_it - size), size) :
+          std::string();
+    }
+
+    /// Number of the elements that follow, each of them at least
+    /// @a min_size bytes long.
+    size_t ReadCount(const size_t min_size) {
+      const auto count = Read<uint32_t>();
+      if (static_cast<size_t>(std::distance(_it, _end)) / min_size < count) {
+        _ok = false;
+        return 0u;
+      }
+      return count;
+    }
+
+    bool IsOk() const {
+      return _ok;
+    }
+
+    bool IsAtEnd() const {
+      return _it == _end;
+    }
+
+  private:
+
+    bool Consume(const size_t size) {
+      if (!_ok || (static_cast<size_t>(std::distance(_it, _end)) < size)) {
+        _ok = false;
+        return false;
+      }
+      _it += size;
+      return true;
+    }
+
+    const unsigned char *_it;
+
+    const unsigned char *_end;
+
+    bool _ok = true;
+  };
+
+} // namespace detail
+
+  static std::string ToString(const RoadInfoMarkRecord::LaneChange lane_change) {
+    switch (lane_change) {
+      case RoadInfoMarkRecord::LaneChange::Increase: return "increase";
+      case RoadInfoMarkRecord::LaneChange::Decrease: return "decrease";
+      case RoadInfoMarkRecord::LaneChange::Both:     return "both";
+      default:                                       return "none";
+    }
+  }
+
+  uint64_t CompiledMap::Hash(const std::string &opendrive) {
+    // FNV-1a, its value does not depend on the platform.
+    uint64_t hash = 14695981039346656037ull;
+    for (const auto c : opendrive) {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  std::vector<unsigned char> CompiledMap::Compile(const Map &map, const uint64_t content_hash) {
+    detail::ImageWriter out;
+    for (const auto c : MAGIC) {
+      out.Write(c);
+    }
+    out.Write(Version);
+    out.Write(content_hash);
+    Write(out, map._data);
+    return out.Release();
+  }
+
+  boost::optional<Map> CompiledMap::Load(
+      const std::vector<unsigned char> &image,
+      const uint64_t content_hash) {
+    return Load(image.data(), image.size(), content_hash);
+  }
+
+  boost::optional<Map> CompiledMap::Load(
+      const unsigned char *image,
+      const size_t size,
+      const uint64_t content_hash) {
+    DEBUG_ASSERT((image != nullptr) || (size == 0u));
+    detail::ImageReader in(image, size);
+    for (const auto c : MAGIC) {
+      if (in.Read<char>() != c) {
+        return {};
+      }
+    }
+    if ((in.Read<uint32_t>() != Version) || (in.Read<uint64_t>() != content_hash)) {
+      return {};
+    }
+    MapBuilder builder;
+    if (!Read(in, builder)) {
+      return {};
+    }
+    return builder.Build();
+  }
+
+  void CompiledMap::Write(detail::ImageWriter &out, const MapData &data) {
+    const auto &geo_reference = data.GetGeoReference();
+    out.Write(geo_reference.latitude);
+    out.Write(geo_reference.longitude);
+    out.Write(geo_reference.altitude);
+
+    const auto &roads = data.GetRoads();
+    out.WriteCount(roads.size());
+    for (const auto &road_pair : roads) {
+      const auto &road = road_pair.second;
+      out.Write(road.GetId());
+      out.Write(road.GetName());
+      out.Write(road.GetLength());
+      out.Write(road.GetJunctionId());
+      out.Write(road.GetPredecessor());
+      out.Write(road.GetSuccessor());
+
+      out.WriteCount(road.GetInfos<RoadInfoElevation>().size());
+      for (const auto *info : road.GetInfos<RoadInfoElevation>()) {
+        out.Write(info->GetDistance());
+        out.Write(info->GetPolynomial());
+      }
+      out.WriteCount(road.GetInfos<RoadInfoGeometry>().size());
+      for (const auto *info : road.GetInfos<RoadInfoGeometry>()) {
+        const auto &geometry = info->GetGeometry();
+        out.Write(static_cast<uint8_t>(geometry.GetType()));
+        out.Write(info->GetDistance());
+        out.Write(geometry.GetStartPosition().x);
+        out.Write(geometry.GetStartPosition().y);
+        out.Write(geometry.GetHeading());
+        out.Write(geometry.GetLength());
+        switch (geometry.GetType()) {
+          case GeometryType::LINE:
+            break;
+          case GeometryType::ARC:
+            out.Write(static_cast<const GeometryArc &>(geometry).GetCurvature());
+            break;
+          default:
+            throw_exception(std::runtime_error("geometry not supported by compiled maps"));
+        }
+      }
+      out.WriteCount(road.GetInfos<RoadInfoLaneOffset>().size());
+      for (const auto *info : road.GetInfos<RoadInfoLaneOffset>()) {
+        out.Write(info->GetDistance());
+        out.Write(info->GetPolynomial());
+      }
+      out.WriteCount(road.GetInfos<RoadInfoSpeed>().size());
+      for (const auto *info : road.GetInfos<RoadInfoSpeed>()) {
+        out.Write(info->GetDistance());
+        out.Write(info->GetSpeed());
+      }
+
+      const auto sections = road.GetLaneSections();
+      out.WriteCount(sections.size());
+      for (const auto &section : sections) {
+        out.Write(section.GetId());
+        out.Write(section.GetDistance());
+        out.WriteCount(section.GetLanes().size());
+        for (const auto &lane_pair : section.GetLanes()) {
+          const auto &lane = lane_pair.second;
+          out.Write(lane.GetId());
+          out.Write(static_cast<uint32_t>(lane.GetType()));
+          out.Write(static_cast<uint8_t>(lane.GetLevel()));
+          out.Write(lane.GetPredecessor());
+          out.Write(lane.GetSuccessor());
+
+          out.WriteCount(lane.GetInfos<RoadInfoLaneAccess>().size());
+          for (const auto *info : lane.GetInfos<RoadInfoLaneAccess>()) {
+            out.Write(info->GetDistance());
+            out.Write(info->GetRestriction());
+          }
+          out.WriteCount(lane.GetInfos<RoadInfoLaneBorder>().size());
+          for (const auto *info : lane.GetInfos<RoadInfoLaneBorder>()) {
+            out.Write(info->GetDistance());
+            out.Write(info->GetPolynomial());
+          }
+          out.WriteCount(lane.GetInfos<RoadInfoLaneHeight>().size());
+          for (const auto *info : lane.GetInfos<RoadInfoLaneHeight>()) {
+            out.Write(info->GetDistance());
+            out.Write(info->GetInner());
+            out.Write(info->GetOuter());
+          }
+          out.WriteCount(lane.GetInfos<RoadInfoLaneMaterial>().size());
+          for (const auto *info : lane.GetInfos<RoadInfoLaneMaterial>()) {
+            out.Write(info->GetDistance());
+            out.Write(info->GetSurface());
+            out.Write(info->GetFriction());
+            out.Write(info->GetRoughness());
+          }
+          out.WriteCount(lane.GetInfos<RoadInfoLaneRule>().size());
+          for (const auto *info : lane.GetInfos<RoadInfoLaneRule>()) {
+            out.Write(info->GetDistance());
+            out.Write(info->GetValue());
+          }
+          out.WriteCount(lane.GetInfos<RoadInfoLaneVisibility>().size());
+          for (const auto *info : lane.GetInfos<RoadInfoLaneVisibility>()) {
+            out.Write(info->GetDistance());
+            out.Write(info->GetForward());
+            out.Write(info->GetBack());
+            out.Write(info->GetLeft());
+            out.Write(info->GetRight());
+          }
+          out.WriteCount(lane.GetInfos<RoadInfoLaneWidth>().size());
+          for (const auto *info : lane.GetInfos<RoadInfoLaneWidth>()) {
+            out.Write(info->GetDistance());
+            out.Write(info->GetPolynomial());
+          }
+          out.WriteCount(lane.GetInfos<RoadInfoMarkRecord>().size());
+          for (const auto *info : lane.GetInfos<RoadInfoMarkRecord>()) {
+            out.Write(info->GetDistance());
+            out.Write(info->GetRoadMarkId());
+            out.Write(info->GetType());
+            out.Write(info->GetWeight());
+            out.Write(info->GetColor());
+            out.Write(info->GetMaterial());
+            out.Write(info->GetWidth());
+            out.Write(ToString(info->GetLaneChange()));
+            out.Write(info->GetHeight());
+            out.Write(info->GetTypeName());
+            out.Write(info->GetTypeWidth());
+            out.WriteCount(info->GetLines().size());
+            for (const auto &line : info->GetLines()) {
+              DEBUG_ASSERT(line != nullptr);
+              out.Write(line->GetDistance());
+              out.Write(line->GetLength());
+              out.Write(line->GetSpace());
+              out.Write(line->GetTOffset());
+              out.Write(line->GetRule());
+              out.Write(line->GetWidth());
+            }
+          }
+          out.WriteCount(lane.GetInfos<RoadInfoSpeed>().size());
+          for (const auto *info : lane.GetInfos<RoadInfoSpeed>()) {
+            out.Write(info->GetDistance());
+            out.Write(info->GetSpeed());
+          }
+        }
+      }
+
+      out.WriteCount(road._signals.size());
+      for (const auto &signal_pair : road._signals) {
+        const auto &signal = signal_pair.second;
+        out.Write(signal._signal_id);
+        out.Write(signal._s);
+        out.Write(signal._t);
+        out.Write(signal._name);
+        out.Write(signal._dynamic);
+        out.Write(signal._orientation);
+        out.Write(signal._zOffset);
+        out.Write(signal._country);
+        out.Write(signal._type);
+        out.Write(signal._subtype);
+        out.Write(signal._value);
+        out.Write(signal._unit);
+        out.Write(signal._height);
+        out.Write(signal._width);
+        out.Write(signal._text);
+        out.Write(signal._hOffset);
+        out.Write(signal._pitch);
+        out.Write(signal._roll);
+        out.WriteCount(signal._validities.size());
+        for (const auto &validity : signal._validities) {
+          out.Write(validity._from_lane);
+          out.Write(validity._to_lane);
+        }
+        out.WriteCount(signal._dependencies.size());
+        for (const auto &dependency : signal._dependencies) {
+          out.Write(dependency._dependency_id);
+          out.Write(dependency._type);
+        }
+      }
+
+      out.WriteCount(road._sign_ref.size());
+      for (const auto &reference_pair : road._sign_ref) {
+        const auto &reference = reference_pair.second;
+        out.Write(reference._signal_id);
+        out.Write(reference._s);
+        out.Write(reference._t);
+        out.Write(reference._orientation);
+        out.WriteCount(reference._validities.size());
+        for (const auto &validity : reference._validities) {
+          out.Write(validity._from_lane);
+          out.Write(validity._to_lane);
+        }
+      }
+    }
+
+    const auto &junctions = data.GetJunctions();
+    out.WriteCount(junctions.size());
+    for (const auto &junction_pair : junctions) {
+      const auto &junction = junction_pair.second;
+      out.Write(junction._id);
+      out.Write(junction._name);
+      out.WriteCount(junction._connections.size());
+      for (const auto &connection_pair : junction._connections) {
+        const auto &connection = connection_pair.second;
+        out.Write(connection.id);
+        out.Write(connection.incoming_road);
+        out.Write(connection.connecting_road);
+        out.WriteCount(connection.lane_links.size());
+        for (const auto &link : connection.lane_links) {
+          out.Write(link.from);
+          out.Write(link.to);
+        }
+      }
+    }
+  }
+
+  bool CompiledMap::Read(detail::ImageReader &in, MapBuilder &builder) {
+    // Smallest size of each element, so a count larger than what is left of
+    // the image is caught before reading any of them.
+    constexpr size_t min_size = sizeof(double);
+
+    geom::GeoLocation geo_reference;
+    geo_reference.latitude = in.Read<double>();
+    geo_reference.longitude = in.Read<double>();
+    geo_reference.altitude = in.Read<double>();
+    builder.SetGeoReference(geo_reference);
+
+    auto read_polynomial = [&](auto &&add) {
+      const auto s = in.Read<double>();
+      const auto a = in.Read<double>();
+      const auto b = in.Read<double>();
+      const auto c = in.Read<double>();
+      const auto d = in.Read<double>();
+      add(s, a, b, c, d);
+    };
+
+    for (auto roads = in.ReadCount(min_size); in.IsOk() && (roads > 0u); --roads) {
+      const auto road_id = in.Read<RoadId>();
+      auto name = in.ReadString();
+      const auto length = in.Read<double>();
+      const auto junction_id = in.Read<JuncId>();
+      const auto predecessor = in.Read<RoadId>();
+      const auto successor = in.Read<RoadId>();
+      auto *road = builder.AddRoad(road_id, name, length, junction_id, predecessor, successor);
+
+      for (auto count = in.ReadCount(min_size); count > 0u; --count) {
+        read_polynomial([&](double s, double a, double b, double c, double d) {
+          builder.AddRoadElevationProfile(road, s, a, b, c, d);
+        });
+      }
+      for (auto count = in.ReadCount(min_size); count > 0u; --count) {
+        const auto type = static_cast<GeometryType>(in.Read<uint8_t>());
+        const auto s = in.Read<double>();
+        const auto x = in.Read<float>();
+        const auto y = in.Read<float>();
+        const auto heading = in.Read<double>();
+        const auto geometry_length = in.Read<double>();
+        switch (type) {
+          case GeometryType::LINE:
+            builder.AddRoadGeometryLine(road, s, x, y, heading, geometry_length);
+            break;
+          case GeometryType::ARC:
+            builder.AddRoadGeometryArc(road, s, x, y, heading, geometry_length, in.Read<double>());
+            break;
+          default:
+            return false;
+        }
+      }
+      for (auto count = in.ReadCount(min_size); count > 0u; --count) {
+        read_polynomial([&](double s, double a, double b, double c, double d) {
+          builder.CreateSectionOffset(road, s, a, b, c, d);
+        });
+      }
+      for (auto count = in.ReadCount(min_size); count > 0u; --count) {
+        const auto s = in.Read<double>();
+        const auto max = in.Read<double>();
+        builder.CreateRoadSpeed(road, s, "", max, "");
+      }
+
+      for (auto sections = in.ReadCount(min_size); sections > 0u; --sections) {
+        const auto section_id = in.Read<SectionId>();
+        const auto section_s = in.Read<double>();
+        auto *section = builder.AddRoadSection(road, section_id, section_s);
+        for (auto lanes = in.ReadCount(min_size); lanes > 0u; --lanes) {
+          const auto lane_id = in.Read<LaneId>();
+          const auto lane_type = in.Read<uint32_t>();
+          const auto lane_level = in.Read<uint8_t>() != 0u;
+          const auto lane_predecessor = in.Read<LaneId>();
+          const auto lane_successor = in.Read<LaneId>();
+          auto *lane = builder.AddRoadSectionLane(
+              section, lane_id, lane_type, lane_level, lane_predecessor, lane_successor);
+
+          for (auto count = in.ReadCount(min_size); count > 0u; --count) {
+            const auto s = in.Read<double>();
+            builder.CreateLaneAccess(lane, s, in.ReadString());
+          }
+          for (auto count = in.ReadCount(min_size); count > 0u; --count) {
+            read_polynomial([&](double s, double a, double b, double c, double d) {
+              builder.CreateLaneBorder(lane, s, a, b, c, d);
+            });
+          }
+          for (auto count = in.ReadCount(min_size); count > 0u; --count) {
+            const auto s = in.Read<double>();
+            const auto inner = in.Read<double>();
+            const auto outer = in.Read<double>();
+            builder.CreateLaneHeight(lane, s, inner, outer);
+          }
+          for (auto count = in.ReadCount(min_size); count > 0u; --count) {
+            const auto s = in.Read<double>();
+            auto surface = in.ReadString();
+            const auto friction = in.Read<double>();
+            const auto roughness = in.Read<double>();
+            builder.CreateLaneMaterial(lane, s, surface, friction, roughness);
+          }
+          for (auto count = in.ReadCount(min_size); count > 0u; --count) {
+            const auto s = in.Read<double>();
+            builder.CreateLaneRule(lane, s, in.ReadString());
+          }
+          for (auto count = in.ReadCount(min_size); count > 0u; --count) {
+            const auto s = in.Read<double>();
+            const auto forward = in.Read<double>();
+            const auto back = in.Read<double>();
+            const auto left = in.Read<double>();
+            const auto right = in.Read<double>();
+            builder.CreateLaneVisibility(lane, s, forward, back, left, right);
+          }
+          for (auto count = in.ReadCount(min_size); count > 0u; --count) {
+            read_polynomial([&](double s, double a, double b, double c, double d) {
+              builder.CreateLaneWidth(lane, s, a, b, c, d);
+            });
+          }
+          for (auto count = in.ReadCount(min_size); count > 0u; --count) {
+            const auto s = in.Read<double>();
+            const auto road_mark_id = in.Read<int>();
+            auto type = in.ReadString();
+            auto weight = in.ReadString();
+            auto color = in.ReadString();
+            auto material = in.ReadString();
+            const auto width = in.Read<double>();
+            auto lane_change = in.ReadString();
+            const auto height = in.Read<double>();
+            auto type_name = in.ReadString();
+            const auto type_width = in.Read<double>();
+            builder.CreateRoadMark(lane, road_mark_id, s, type, weight, color,
+                material, width, lane_change, height, type_name, type_width);
+            for (auto lines = in.ReadCount(min_size); lines > 0u; --lines) {
+              const auto line_s = in.Read<double>();
+              const auto line_length = in.Read<double>();
+              const auto space = in.Read<double>();
+              const auto t_offset = in.Read<double>();
+              auto rule = in.ReadString();
+              const auto line_width = in.Read<double>();
+              builder.CreateRoadMarkTypeLine(
+                  lane, road_mark_id, line_length, space, t_offset, line_s, rule, line_width);
+            }
+          }
+          for (auto count = in.ReadCount(min_size); count > 0u; --count) {
+            const auto s = in.Read<double>();
+            const auto max = in.Read<double>();
+            builder.CreateLaneSpeed(lane, s, max, "");
+          }
+        }
+      }
+
+      for (auto signals = in.ReadCount(min_size); signals > 0u; --signals) {
+        const auto signal_id = in.Read<SignId>();
+        const auto s = in.Read<double>();
+        const auto t = in.Read<double>();
+        auto signal_name = in.ReadString();
+        auto dynamic = in.ReadString();
+        auto orientation = in.ReadString();
+        const auto z_offset = in.Read<double>();
+        auto country = in.ReadString();
+        auto type = in.ReadString();
+        auto subtype = in.ReadString();
+        const auto value = in.Read<double>();
+        auto unit = in.ReadString();
+        const auto height = in.Read<double>();
+        const auto width = in.Read<double>();
+        auto text = in.ReadString();
+        const auto h_offset = in.Read<double>();
+        const auto pitch = in.Read<double>();
+        const auto roll = in.Read<double>();
+        builder.AddSignal(road_id, signal_id, s, t, signal_name, dynamic,
+            orientation, z_offset, country, type, subtype, value, unit, height,
+            width, text, h_offset, pitch, roll);
+        for (auto validities = in.ReadCount(min_size); validities > 0u; --validities) {
+          const auto from_lane = in.Read<LaneId>();
+          const auto to_lane = in.Read<LaneId>();
+          builder.AddValidityToSignal(road_id, signal_id, from_lane, to_lane);
+        }
+        for (auto dependencies = in.ReadCount(min_size); dependencies > 0u; --dependencies) {
+          const auto dependency_id = in.Read<uint32_t>();
+          builder.AddDependencyToSignal(road_id, signal_id, dependency_id, in.ReadString());
+        }
+      }
+
+      for (auto references = in.ReadCount(min_size); references > 0u; --references) {
+        const auto reference_id = in.Read<SignRefId>();
+        const auto s = in.Read<double>();
+        const auto t = in.Read<double>();
+        builder.AddSignalReference(road_id, reference_id, s, t, in.ReadString());
+        for (auto validities = in.ReadCount(min_size); validities > 0u; --validities) {
+          const auto from_lane = in.Read<LaneId>();
+          const auto to_lane = in.Read<LaneId>();
+          builder.AddValidityToSignalReference(road_id, reference_id, from_lane, to_lane);
+        }
+      }
+    }
+
+    for (auto junctions = in.ReadCount(min_size); junctions > 0u; --junctions) {
+      const auto junction_id = in.Read<JuncId>();
+      builder.AddJunction(junction_id, in.ReadString());
+      for (auto connections = in.ReadCount(min_size); connections > 0u; --connections) {
+        const auto connection_id = in.Read<ConId>();
+        const auto incoming_road = in.Read<RoadId>();
+        const auto connecting_road = in.Read<RoadId>();
+        builder.AddConnection(junction_id, connection_id, incoming_road, connecting_road);
+        for (auto links = in.ReadCount(min_size); links > 0u; --links) {
+          const auto from = in.Read<LaneId>();
+          const auto to = in.Read<LaneId>();
+          builder.AddLaneLink(junction_id, connection_id, from, to);
+        }
+      }
+    }
+
+    return in.IsOk() && in.IsAtEnd();
+  }
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,78 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/road/Map.h"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  class MapBuilder;
+  class MapData;
+
+namespace detail {
+
+  class ImageReader;
+  class ImageWriter;
+
+} // namespace detail
+
+  /// Binary image of a road::Map. Loading an image skips the OpenDRIVE
+  /// parsing, the image holds the roads, junctions and signals of the map as
+  /// they are after parsing, and only the connections between the lanes and
+  /// the spatial index are rebuilt.
+  ///
+  /// Images are in the byte order of the machine that compiled them and
+  /// images of other versions are rejected, they are meant to be cached
+  /// locally and compiled again when rejected, not distributed.
+  ///
+  /// The lanes and their connections are the same as the ones of the map
+  /// compiled, but the roads may be iterated in a different order.
+  class CompiledMap {
+  public:
+
+    /// Version of the format, images of any other version are rejected.
+    static constexpr uint32_t Version = 1u;
+
+    /// Hash of the contents of an OpenDRIVE file, to tell which contents an
+    /// image was compiled from.
+    static uint64_t Hash(const std::string &opendrive);
+
+    /// Compile @a map into an image. @a content_hash is stored in the image,
+    /// usually the Hash of the OpenDRIVE contents @a map was parsed from.
+    static std::vector<unsigned char> Compile(const Map &map, uint64_t content_hash = 0u);
+
+    /// Load the map compiled into @a image. Returns an empty optional if
+    /// @a image is not a valid image of this version or it was compiled with
+    /// a different @a content_hash.
+    static boost::optional<Map> Load(
+        const std::vector<unsigned char> &image,
+        uint64_t content_hash = 0u);
+
+    /// Same as above for the @a size bytes at @a image. They are only read,
+    /// so they may be mapped read-only from a file or a shared memory
+    /// segment.
+    static boost::optional<Map> Load(
+        const unsigned char *image,
+        size_t size,
+        uint64_t content_hash = 0u);
+
+  private:
+
+    static void Write(detail::ImageWriter &out, const MapData &data);
+
+    static bool Read(detail::ImageReader &in, MapBuilder &builder);
+  };
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,84 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/InformationSet.h"
+
+#include "carla/Debug.h"
+
+namespace carla {
+namespace road {
+
+  /// Retrieves the position in detail::RoadInfoTypes of the type of the infos
+  /// visited.
+  class RoadInfoTypeIndexer final : public element::RoadInfoVisitor {
+  public:
+
+    size_t GetIndex(element::RoadInfo &info) {
+      _index = std::tuple_size<detail::RoadInfoTypes>::value;
+      info.AcceptVisitor(*this);
+      DEBUG_ASSERT(_index < std::tuple_size<detail::RoadInfoTypes>::value);
+      return _index;
+    }
+
+    void Visit(element::RoadInfoElevation &) override { Set<element::RoadInfoElevation>(); }
+    void Visit(element::RoadInfoGeometry &) override { Set<element::RoadInfoGeometry>(); }
+    void Visit(element::RoadInfoLane &) override { Set<element::RoadInfoLane>(); }
+    void Visit(element::RoadInfoLaneAccess &) override { Set<element::RoadInfoLaneAccess>(); }
+    void Visit(element::RoadInfoLaneBorder &) override { Set<element::RoadInfoLaneBorder>(); }
+    void Visit(element::RoadInfoLaneHeight &) override { Set<element::RoadInfoLaneHeight>(); }
+    void Visit(element::RoadInfoLaneMaterial &) override { Set<element::RoadInfoLaneMaterial>(); }
+    void Visit(element::RoadInfoLaneOffset &) override { Set<element::RoadInfoLaneOffset>(); }
+    void Visit(element::RoadInfoLaneRule &) override { Set<element::RoadInfoLaneRule>(); }
+    void Visit(element::RoadInfoLaneVisibility &) override { Set<element::RoadInfoLaneVisibility>(); }
+    void Visit(element::RoadInfoLaneWidth &) override { Set<element::RoadInfoLaneWidth>(); }
+    void Visit(element::RoadInfoMarkRecord &) override { Set<element::RoadInfoMarkRecord>(); }
+    void Visit(element::RoadInfoMarkTypeLine &) override { Set<element::RoadInfoMarkTypeLine>(); }
+    void Visit(element::RoadInfoSpeed &) override { Set<element::RoadInfoSpeed>(); }
+
+  private:
+
+    template <typename T>
+    void Set() {
+      _index = detail::TupleIndex<T, detail::RoadInfoTypes>::value;
+    }
+
+    size_t _index = 0u;
+  };
+
+  InformationSet::InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec)
+    : _infos(std::move(vec)) {
+    // Stable, so the infos at the same distance keep the order they were
+    // added in.
+    std::stable_sort(_infos.begin(), _infos.end(), [](const auto &lhs, const auto &rhs) {
+      return lhs->GetDistance() < rhs->GetDistance();
+    });
+
+    RoadInfoTypeIndexer indexer;
+    std::vector<std::pair<size_t, std::unique_ptr<element::RoadInfo>>> indexed;
+    indexed.reserve(_infos.size());
+    for (auto &info : _infos) {
+      DEBUG_ASSERT(info != nullptr);
+      const auto index = indexer.GetIndex(*info);
+      indexed.emplace_back(index, std::move(info));
+    }
+    // Stable, so the infos at the same distance keep the order of the sort
+    // above.
+    std::stable_sort(indexed.begin(), indexed.end(), [](const auto &lhs, const auto &rhs) {
+      return lhs.first < rhs.first;
+    });
+
+    _offsets.fill(0u);
+    for (size_t i = 0u; i < indexed.size(); ++i) {
+      _infos[i] = std::move(indexed[i].second);
+      ++_offsets[indexed[i].first + 1u];
+    }
+    for (size_t i = 1u; i < _offsets.size(); ++i) {
+      _offsets[i] += _offsets[i - 1u];
+    }
+  }
+
+} // road
+} // carla
@@ -6,47 +6,115 @@
 
 #pragma once
 
+#include "carla/ListView.h"
 #include "carla/NonCopyable.h"
-#include "carla/road/RoadElementSet.h"
 #include "carla/road/element/RoadInfo.h"
-#include "carla/road/element/RoadInfoIterator.h"
+#include "carla/road/element/RoadInfoVisitor.h"
 
-#include <vector>
+#include <boost/iterator/transform_iterator.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
 #include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace carla {
 namespace road {
 
+namespace detail {
+
+  /// Every type of info, in the order they are kept in InformationSet.
+  using RoadInfoTypes = std::tuple<
+      element::RoadInfoElevation,
+      element::RoadInfoGeometry,
+      element::RoadInfoLane,
+      element::RoadInfoLaneAccess,
+      element::RoadInfoLaneBorder,
+      element::RoadInfoLaneHeight,
+      element::RoadInfoLaneMaterial,
+      element::RoadInfoLaneOffset,
+      element::RoadInfoLaneRule,
+      element::RoadInfoLaneVisibility,
+      element::RoadInfoLaneWidth,
+      element::RoadInfoMarkRecord,
+      element::RoadInfoMarkTypeLine,
+      element::RoadInfoSpeed>;
+
+  template <typename T, typename Tuple>
+  struct TupleIndex;
+
+  template <typename T, typename... Ts>
+  struct TupleIndex<T, std::tuple<T, Ts...>>
+    : std::integral_constant<size_t, 0u> {};
+
+  template <typename T, typename U, typename... Ts>
+  struct TupleIndex<T, std::tuple<U, Ts...>>
+    : std::integral_constant<size_t, 1u + TupleIndex<T, std::tuple<Ts...>>::value> {};
+
+  template <typename T>
+  struct StaticCastInfo {
+    const T *operator()(const std::unique_ptr<element::RoadInfo> &info) const {
+      return static_cast<const T *>(info.get());
+    }
+  };
+
+} // namespace detail
+
+  /// The infos of a road or a lane. They are grouped by type at construction,
+  /// sorted by their position on the road, so retrieving them neither visits
+  /// the infos of other types nor allocates.
   class InformationSet : private MovableNonCopyable {
   public:
 
     InformationSet() = default;
 
-    InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec)
-      : _road_set(std::move(vec)) {}
+    InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec);
 
     /// Return all infos given a type from the start of the road
     template <typename T>
-    std::vector<const T *> GetInfos() const {
-      std::vector<const T *> vec;
-      auto it = element::MakeRoadInfoIterator<T>(_road_set.GetAll());
-      for (; !it.IsAtEnd(); ++it) {
-        vec.emplace_back(&*it);
-      }
-      return vec;
+    auto GetInfos() const {
+      const auto range = GetRange<T>();
+      return MakeListView(
+          boost::make_transform_iterator(range.first, detail::StaticCastInfo<T>()),
+          boost::make_transform_iterator(range.second, detail::StaticCastInfo<T>()));
     }
 
     /// Returns single info given a type and a distance (s) from
     /// the start of the road
     template <typename T>
     const T *GetInfo(const double s) const {
-      auto it = element::MakeRoadInfoIterator<T>(_road_set.GetReverseSubset(s));
-      return it.IsAtEnd() ? nullptr : &*it;
+      const auto range = GetRange<T>();
+      const auto it = std::upper_bound(range.first, range.second, s,
+          [](const double lhs, const std::unique_ptr<element::RoadInfo> &rhs) {
+        return lhs < rhs->GetDistance();
+      });
+      return it == range.first ? nullptr : static_cast<const T *>(std::prev(it)->get());
     }
 
   private:
 
-    RoadElementSet<std::unique_ptr<element::RoadInfo>> _road_set;
+    static constexpr size_t NumberOfTypes = std::tuple_size<detail::RoadInfoTypes>::value;
+
+    using const_iterator = std::vector<std::unique_ptr<element::RoadInfo>>::const_iterator;
+
+    template <typename T>
+    std::pair<const_iterator, const_iterator> GetRange() const {
+      constexpr auto index = detail::TupleIndex<T, detail::RoadInfoTypes>::value;
+      return std::make_pair(
+          _infos.begin() + _offsets[index],
+          _infos.begin() + _offsets[index + 1u]);
+    }
+
+    /// Sorted by type, and by position on the road within each type.
+    std::vector<std::unique_ptr<element::RoadInfo>> _infos;
+
+    /// Start of the infos of each type in @a _infos, and their end.
+    std::array<uint32_t, NumberOfTypes + 1u> _offsets = {};
   };
 
 } // road
@@ -79,6 +79,11 @@ namespace road {
       return _info.GetInfo<T>(s);
     }
 
+    template <typename T>
+    auto GetInfos() const {
+      return _info.GetInfos<T>();
+    }
+
     const std::vector<Lane *> &GetNextLanes() const {
       return _next_lanes;
     }
@@ -6,6 +6,8 @@
 
 #include "carla/road/LaneSection.h"
 
+#include <cstdint>
+
 namespace carla {
 namespace road {
 
@@ -22,6 +24,13 @@ namespace road {
   }
 
   Lane *LaneSection::GetLane(const LaneId id) {
+    if (!_lanes_by_id.empty()) {
+      const auto index = static_cast<int64_t>(id) - static_cast<int64_t>(_min_lane_id);
+      return ((index >= 0) && (index < static_cast<int64_t>(_lanes_by_id.size()))) ?
+          _lanes_by_id[static_cast<size_t>(index)] :
+          nullptr;
+    }
+    // Not indexed yet, the map is still being built.
     auto search = _lanes.find(id);
     if (search != _lanes.end()) {
       return &search->second;
@@ -29,6 +38,23 @@ namespace road {
     return nullptr;
   }
 
+  const Lane *LaneSection::GetLane(const LaneId id) const {
+    return const_cast<LaneSection *>(this)->GetLane(id);
+  }
+
+  void LaneSection::IndexLanes() {
+    _lanes_by_id.clear();
+    if (_lanes.empty()) {
+      return;
+    }
+    _min_lane_id = _lanes.begin()->first;
+    const auto max_lane_id = _lanes.rbegin()->first;
+    _lanes_by_id.resize(static_cast<size_t>(max_lane_id - _min_lane_id) + 1u, nullptr);
+    for (auto &pair : _lanes) {
+      _lanes_by_id[static_cast<size_t>(pair.first - _min_lane_id)] = &pair.second;
+    }
+  }
+
   std::map<LaneId, Lane> &LaneSection::GetLanes() {
     return _lanes;
   }
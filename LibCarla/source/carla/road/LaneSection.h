@@ -32,6 +32,8 @@ namespace road {
 
     Lane *GetLane(const LaneId id);
 
+    const Lane *GetLane(const LaneId id) const;
+
     bool ContainsLane(LaneId id) const {
       return (_lanes.find(id) != _lanes.end());
     }
@@ -48,6 +50,9 @@ namespace road {
 
     friend MapBuilder;
 
+    /// Index the lanes by id, once they are all added.
+    void IndexLanes();
+
     const SectionId _id = 0u;
 
     const double _s = 0.0;
@@ -56,6 +61,12 @@ namespace road {
 
     std::map<LaneId, Lane> _lanes;
 
+    /// Lanes by id, starting at @a _min_lane_id. The lane ids of a section
+    /// are consecutive, so finding a lane is indexing this array.
+    std::vector<Lane *> _lanes_by_id;
+
+    LaneId _min_lane_id = 0;
+
     geom::CubicPolynomial _lane_offset;
   };
 
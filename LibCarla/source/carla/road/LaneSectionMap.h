@@ -6,11 +6,13 @@
 
 #pragma once
 
+#include "carla/Exception.h"
 #include "carla/NonCopyable.h"
 #include "carla/road/LaneSection.h"
 
 #include <map>
-#include <unordered_map>
+#include <stdexcept>
+#include <vector>
 
 namespace carla {
 namespace road {
@@ -23,16 +25,22 @@ namespace road {
 
     LaneSection &Emplace(SectionId id, double s) {
       LaneSection &result = Super::emplace(s, LaneSection{id, s})->second;
-      _by_id.emplace(result.GetId(), &result);
+      if (id >= _by_id.size()) {
+        _by_id.resize(id + 1u, nullptr);
+      }
+      _by_id[id] = &result;
       return result;
     }
 
     LaneSection &GetById(SectionId id) {
-      return *_by_id.at(id);
+      if ((id >= _by_id.size()) || (_by_id[id] == nullptr)) {
+        throw_exception(std::out_of_range("lane section not found"));
+      }
+      return *_by_id[id];
     }
 
     const LaneSection &GetById(SectionId id) const {
-      return *_by_id.at(id);
+      return const_cast<LaneSectionMap *>(this)->GetById(id);
     }
 
     using Super::find;
@@ -46,7 +54,8 @@ namespace road {
 
   private:
 
-    std::unordered_map<SectionId, LaneSection *> _by_id;
+    /// Indexed by id, the ids of the sections of a road are consecutive.
+    std::vector<LaneSection *> _by_id;
   };
 
 } // road
@@ -7,6 +7,7 @@
 #include "carla/road/Map.h"
 
 #include "carla/Exception.h"
+#include "carla/ParallelFor.h"
 #include "carla/road/element/LaneCrossingCalculator.h"
 #include "carla/road/element/RoadInfoGeometry.h"
 #include "carla/road/element/RoadInfoLaneWidth.h"
@@ -14,13 +15,22 @@
 #include "carla/road/element/RoadInfoLaneOffset.h"
 #include "carla/geom/Math.h"
 
+#include <boost/geometry/strategies/strategies.hpp>
+#include <boost/iterator/function_output_iterator.hpp>
+
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
+#include <tuple>
+#include <unordered_set>
 
 namespace carla {
 namespace road {
 
   using namespace carla::road::element;
 
+  namespace bgi = boost::geometry::index;
+
   /// We use this epsilon to shift the waypoints away from the edges of the lane
   /// sections to avoid floating point precision errors.
   static constexpr double EPSILON = 10.0 * std::numeric_limits<double>::epsilon();
@@ -29,18 +39,6 @@ namespace road {
   // -- Static local methods ---------------------------------------------------
   // ===========================================================================
 
-  template <typename T>
-  static std::vector<T> ConcatVectors(std::vector<T> dst, std::vector<T> src) {
-    if (src.size() > dst.size()) {
-      return ConcatVectors(src, dst);
-    }
-    dst.insert(
-        dst.end(),
-        std::make_move_iterator(src.begin()),
-        std::make_move_iterator(src.end()));
-    return dst;
-  }
-
   static double GetDistanceAtStartOfLane(const Lane &lane) {
     if (lane.GetId() <= 0) {
       return lane.GetDistance() + 10.0 * EPSILON;
@@ -57,6 +55,20 @@ namespace road {
     }
   }
 
+  /// Return the waypoint of @a lane at the distance given by
+  /// @a get_distance(lane).
+  template <typename FuncT>
+  static Waypoint MakeWaypointAt(const Lane *lane, FuncT &&get_distance) {
+    RELEASE_ASSERT(lane != nullptr);
+    const auto lane_id = lane->GetId();
+    RELEASE_ASSERT(lane_id != 0);
+    const auto *section = lane->GetLaneSection();
+    RELEASE_ASSERT(section != nullptr);
+    const auto *road = lane->GetRoad();
+    RELEASE_ASSERT(road != nullptr);
+    return Waypoint{road->GetId(), section->GetId(), lane_id, get_distance(*lane)};
+  }
+
   /// Return a waypoint for each drivable lane on @a lane_section.
   template <typename FuncT>
   static void ForEachDrivableLaneImpl(
@@ -100,6 +112,39 @@ namespace road {
     }
   }
 
+  /// Call @a func(road, values) for each road of @a data, in parallel, and
+  /// return the values added by each in the order of the roads.
+  template <typename T, typename FuncT>
+  static std::vector<T> CollectPerRoad(
+      const MapData &data,
+      const size_t min_chunk_size,
+      FuncT &&func) {
+    std::vector<const Road *> roads;
+    roads.reserve(data.GetRoads().size());
+    for (const auto &road_pair : data.GetRoads()) {
+      roads.emplace_back(&road_pair.second);
+    }
+    std::vector<std::vector<T>> per_road(roads.size());
+    ParallelForEachChunk(roads.size(), min_chunk_size, [&](const size_t begin, const size_t end) {
+      for (auto i = begin; i < end; ++i) {
+        func(*roads[i], per_road[i]);
+      }
+    });
+    size_t total = 0u;
+    for (const auto &values : per_road) {
+      total += values.size();
+    }
+    std::vector<T> result;
+    result.reserve(total);
+    for (auto &values : per_road) {
+      result.insert(
+          result.end(),
+          std::make_move_iterator(values.begin()),
+          std::make_move_iterator(values.end()));
+    }
+    return result;
+  }
+
   /// Returns a pair containing first = width, second = tangent,
   /// for an specific Lane given an s and a iterator over lanes
   template <typename T>
@@ -135,6 +180,115 @@ namespace road {
     return section.ContainsLane(waypoint.lane_id);
   }
 
+  // ===========================================================================
+  // -- Map: Constructor -------------------------------------------------------
+  // ===========================================================================
+
+  /// Estimate of the memory of the roads of @a data, the node and pointer
+  /// overhead of the containers besides the elements.
+  static size_t EstimateMemory(const MapData &data) {
+    constexpr size_t node_overhead = 4u * sizeof(void *);
+    size_t bytes = 0u;
+    for (const auto &pair : data.GetRoads()) {
+      bytes += sizeof(pair) + node_overhead;
+      for (const auto &section : pair.second.GetLaneSections()) {
+        bytes += sizeof(section) + node_overhead;
+        bytes += section.GetLanes().size() * (sizeof(std::pair<const LaneId, Lane>) + node_overhead);
+      }
+    }
+    bytes += data.GetJunctions().size() * (sizeof(std::pair<const JuncId, Junction>) + node_overhead);
+    return bytes;
+  }
+
+  Map::Map(MapData m)
+    : _data(std::move(m)),
+      _geo_projection(_data.GetGeoReference()) {
+    CreateRtree();
+    _memory = TrackedMemory{
+        MemoryTag::MapData,
+        EstimateMemory(_data) + _rtree.size() * sizeof(Value)};
+  }
+
+  /// Upper bound of the lateral distance from the reference line of @a road
+  /// to the center of its lanes at @a s.
+  static double GetLateralExtent(const Road &road, const double s) {
+    double left = 0.0;
+    double right = 0.0;
+    auto add_width = [&](const LaneId id, const Lane &lane) {
+      const auto *width = lane.GetInfo<RoadInfoLaneWidth>(s);
+      if ((id == 0) || (width == nullptr)) {
+        return;
+      }
+      const auto value = std::abs(width->GetPolynomial().Evaluate(s));
+      (id > 0 ? left : right) += value;
+    };
+    // There is usually a single section at s, its lanes are used as they are
+    // instead of gathering them in a new map.
+    const auto sections = road.GetLaneSectionsAt(s);
+    if (sections.size() == 1u) {
+      for (const auto &pair : sections.begin()->GetLanes()) {
+        add_width(pair.first, pair.second);
+      }
+    } else {
+      for (const auto &pair : road.GetLanesAt(s)) {
+        add_width(pair.first, *pair.second);
+      }
+    }
+    const auto *lane_offset = road.GetInfo<RoadInfoLaneOffset>(s);
+    const double offset = lane_offset != nullptr ?
+        std::abs(lane_offset->GetPolynomial().Evaluate(s)) :
+        0.0;
+    return offset + std::max(left, right);
+  }
+
+  void Map::CreateRtree() {
+    // The pieces of each road are computed in parallel, and appended in
+    // order.
+    const auto values = CollectPerRoad<Value>(_data, 32u, [](const Road &road, auto &pieces) {
+      AddRoadPieces(road, pieces);
+    });
+    // The range constructor uses the packing algorithm, much faster than
+    // inserting the values one by one.
+    _rtree = decltype(_rtree)(values.begin(), values.end());
+  }
+
+  void Map::AddRoadPieces(const Road &road, std::vector<Value> &values) {
+    // Each geometry of the reference line is split in pieces no longer than
+    // this. Every point of a piece is within half its length of one of its
+    // ends, so the box of the ends grown by that much, and by the width of
+    // the road, encloses the center of every lane along the piece.
+    constexpr double max_piece_length = 2.0;
+    // Room for the changes of width within a piece and for the float
+    // precision of the geometries.
+    constexpr double tolerance = 0.5;
+
+    for (const auto *info : road.GetInfos<RoadInfoGeometry>()) {
+      DEBUG_ASSERT(info != nullptr);
+      const auto &geometry = info->GetGeometry();
+      const double length = geometry.GetLength();
+      const auto pieces = std::max<size_t>(1u, static_cast<size_t>(std::ceil(length / max_piece_length)));
+      const double piece_length = length / static_cast<double>(pieces);
+      auto start_s = info->GetDistance();
+      auto start = geometry.PosFromDist(0.0).location;
+      auto start_extent = GetLateralExtent(road, start_s);
+      for (size_t i = 1u; i <= pieces; ++i) {
+        const auto dist = std::min(length, static_cast<double>(i) * piece_length);
+        const auto end_s = info->GetDistance() + dist;
+        const auto end = geometry.PosFromDist(dist).location;
+        const auto end_extent = GetLateralExtent(road, std::min(end_s, road.GetLength()));
+        const auto margin = static_cast<float>(
+            0.5 * piece_length + std::max(start_extent, end_extent) + tolerance);
+        values.emplace_back(Box{
+            Point{std::min(start.x, end.x) - margin, std::min(start.y, end.y) - margin},
+            Point{std::max(start.x, end.x) + margin, std::max(start.y, end.y) + margin}},
+            road.GetId());
+        start_s = end_s;
+        start = end;
+        start_extent = end_extent;
+      }
+    }
+  }
+
   // ===========================================================================
   // -- Map: Geometry ----------------------------------------------------------
   // ===========================================================================
@@ -142,59 +296,57 @@ namespace road {
   boost::optional<Waypoint> Map::GetClosestWaypointOnRoad(
       const geom::Location &pos,
       uint32_t lane_type) const {
-    // max_nearests represents the max nearests roads
-    // where we will search for nearests lanes
-    constexpr size_t max_nearests = 50u;
-    // in case that map has less than max_nearests lanes,
-    // we will use the maximum lanes
-    const size_t max_nearest_allowed = std::min(_data.GetRoadCount(), max_nearests);
-
     // Unreal's Y axis hack
     const auto pos_inverted_y = geom::Location(pos.x, -pos.y, pos.z);
+    const Point point{pos_inverted_y.x, pos_inverted_y.y};
 
-    double nearest_dist[max_nearests];
-    std::fill(nearest_dist, nearest_dist + max_nearest_allowed,
-        std::numeric_limits<double>::max());
-
-    RoadId ids[max_nearests];
-    std::fill(ids, ids + max_nearest_allowed, 0);
-
-    double dists[max_nearests];
-    std::fill(dists, dists + max_nearest_allowed, 0.0);
-
-    for (const auto &road_pair : _data.GetRoads()) {
-      const auto road = &road_pair.second;
-      const auto current_dist = road->GetNearestPoint(pos_inverted_y);
+    Waypoint waypoint;
+    auto nearest_lane_dist = std::numeric_limits<double>::max();
+    std::unordered_set<RoadId> visited;
+
+    // The boxes enclose the centers of the lanes, so the lanes of a road are
+    // never nearer than its nearest box. The roads are visited in order of
+    // distance of their boxes until the boxes are further than the nearest
+    // lane found.
+    std::vector<std::pair<float, RoadId>> boxes;
+    size_t count = 8u;
+    bool done = _rtree.empty();
+    while (!done) {
+      count = std::min(count, _rtree.size());
+      boxes.clear();
+      _rtree.query(
+          bgi::nearest(point, static_cast<unsigned>(count)),
+          boost::make_function_output_iterator([&](const Value &value) {
+            boxes.emplace_back(static_cast<float>(boost::geometry::distance(point, value.first)), value.second);
+          }));
+      std::sort(boxes.begin(), boxes.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.first < rhs.first;
+      });
 
-      for (size_t i = 0u; i < max_nearest_allowed; ++i) {
-        if (current_dist.second < nearest_dist[i]) {
-          // reorder nearest_dist
-          for (size_t j = max_nearest_allowed - 1u; j > i; --j) {
-            DEBUG_ASSERT(j > 0u);
-            nearest_dist[j] = nearest_dist[j - 1];
-            ids[j] = ids[j - 1];
-            dists[j] = dists[j - 1];
-          }
-          nearest_dist[i] = current_dist.second;
-          ids[i] = road->GetId();
-          dists[i] = current_dist.first;
+      for (const auto &box : boxes) {
+        if (box.first > nearest_lane_dist) {
+          done = true;
           break;
         }
+        const RoadId road_id = box.second;
+        if (!visited.insert(road_id).second) {
+          continue;
+        }
+        const auto &road = _data.GetRoad(road_id);
+        const auto current_dist = road.GetNearestPoint(pos_inverted_y);
+        const auto lane_dist = road.GetNearestLane(current_dist.first, pos_inverted_y, lane_type);
+        if (lane_dist.second < nearest_lane_dist) {
+          nearest_lane_dist = lane_dist.second;
+          waypoint.lane_id = lane_dist.first->GetId();
+          waypoint.road_id = road_id;
+          waypoint.s = current_dist.first;
+        }
       }
-    }
 
-    // search for the nearest lane in nearest_dist
-    Waypoint waypoint;
-    auto nearest_lane_dist = std::numeric_limits<double>::max();
-    for (size_t i = 0u; i < max_nearest_allowed; ++i) {
-      auto lane_dist = _data.GetRoad(ids[i]).GetNearestLane(dists[i], pos_inverted_y, lane_type);
-
-      if (lane_dist.second < nearest_lane_dist) {
-        nearest_lane_dist = lane_dist.second;
-        waypoint.lane_id = lane_dist.first->GetId();
-        waypoint.road_id = ids[i];
-        waypoint.s = dists[i];
+      if (count == _rtree.size()) {
+        done = true;
       }
+      count *= 4u;
     }
 
     if (nearest_lane_dist == std::numeric_limits<double>::max()) {
@@ -239,6 +391,28 @@ namespace road {
     return boost::optional<Waypoint>{};
   }
 
+  std::vector<boost::optional<Waypoint>> Map::GetClosestWaypointsOnRoad(
+      const std::vector<geom::Location> &locations,
+      uint32_t lane_type) const {
+    std::vector<boost::optional<Waypoint>> result;
+    result.reserve(locations.size());
+    for (const auto &location : locations) {
+      result.emplace_back(GetClosestWaypointOnRoad(location, lane_type));
+    }
+    return result;
+  }
+
+  std::vector<boost::optional<Waypoint>> Map::GetWaypoints(
+      const std::vector<geom::Location> &locations,
+      uint32_t lane_type) const {
+    std::vector<boost::optional<Waypoint>> result;
+    result.reserve(locations.size());
+    for (const auto &location : locations) {
+      result.emplace_back(GetWaypoint(location, lane_type));
+    }
+    return result;
+  }
+
   geom::Transform Map::ComputeTransform(Waypoint waypoint) const {
     // lane_id can't be 0
     RELEASE_ASSERT(waypoint.lane_id != 0);
@@ -372,15 +546,7 @@ namespace road {
     std::vector<Waypoint> result;
     result.reserve(next_lanes.size());
     for (auto *next_lane : next_lanes) {
-      RELEASE_ASSERT(next_lane != nullptr);
-      const auto lane_id = next_lane->GetId();
-      RELEASE_ASSERT(lane_id != 0);
-      const auto *section = next_lane->GetLaneSection();
-      RELEASE_ASSERT(section != nullptr);
-      const auto *road = next_lane->GetRoad();
-      RELEASE_ASSERT(road != nullptr);
-      const auto distance = GetDistanceAtStartOfLane(*next_lane);
-      result.emplace_back(Waypoint{road->GetId(), section->GetId(), lane_id, distance});
+      result.emplace_back(MakeWaypointAt(next_lane, GetDistanceAtStartOfLane));
     }
     return result;
   }
@@ -389,16 +555,8 @@ namespace road {
     const auto &prev_lanes = GetLane(waypoint).GetPreviousLanes();
     std::vector<Waypoint> result;
     result.reserve(prev_lanes.size());
-    for (auto *next_lane : prev_lanes) {
-      RELEASE_ASSERT(next_lane != nullptr);
-      const auto lane_id = next_lane->GetId();
-      RELEASE_ASSERT(lane_id != 0);
-      const auto *section = next_lane->GetLaneSection();
-      RELEASE_ASSERT(section != nullptr);
-      const auto *road = next_lane->GetRoad();
-      RELEASE_ASSERT(road != nullptr);
-      const auto distance = GetDistanceAtEndOfLane(*next_lane);
-      result.emplace_back(Waypoint{road->GetId(), section->GetId(), lane_id, distance});
+    for (auto *prev_lane : prev_lanes) {
+      result.emplace_back(MakeWaypointAt(prev_lane, GetDistanceAtEndOfLane));
     }
     return result;
   }
@@ -406,36 +564,33 @@ namespace road {
   std::vector<Waypoint> Map::GetNext(
       const Waypoint waypoint,
       const double distance) const {
-    RELEASE_ASSERT(distance > 0.0);
-    const auto &lane = GetLane(waypoint);
-    const bool forward = (waypoint.lane_id <= 0);
-    const double signed_distance = forward ? distance : -distance;
-    const double relative_s = waypoint.s - lane.GetDistance() + EPSILON;
-    const double remaining_lane_length = forward ? lane.GetLength() - relative_s : relative_s;
-    DEBUG_ASSERT(remaining_lane_length >= 0.0);
-
-    // If after subtracting the distance we are still in the same lane, return
-    // same waypoint with the extra distance.
-    if (distance <= remaining_lane_length) {
-      Waypoint result = waypoint;
-      result.s += signed_distance;
-      result.s += forward ? -EPSILON : EPSILON;
-      RELEASE_ASSERT(result.s > 0.0);
-      return { result };
-    }
+    std::vector<Waypoint> result;
+    std::vector<std::pair<Waypoint, double>> stack;
+    AppendWaypointsAt(waypoint, distance, true, stack, result);
+    return result;
+  }
 
-    // If we run out of remaining_lane_length we have to go to the successors.
+  std::vector<Waypoint> Map::GetPrevious(
+      const Waypoint waypoint,
+      const double distance) const {
     std::vector<Waypoint> result;
-    for (const auto &successor : GetSuccessors(waypoint)) {
-      DEBUG_ASSERT(
-          successor.road_id != waypoint.road_id ||
-          successor.section_id != waypoint.section_id ||
-          successor.lane_id != waypoint.lane_id);
-      result = ConcatVectors(result, GetNext(successor, distance - remaining_lane_length));
-    }
+    std::vector<std::pair<Waypoint, double>> stack;
+    AppendWaypointsAt(waypoint, distance, false, stack, result);
     return result;
   }
 
+  Map::WaypointBatch Map::GetNext(
+      const std::vector<Waypoint> &waypoints,
+      const std::vector<double> &distances) const {
+    return GetWaypointsAt(waypoints, distances, true);
+  }
+
+  Map::WaypointBatch Map::GetPrevious(
+      const std::vector<Waypoint> &waypoints,
+      const std::vector<double> &distances) const {
+    return GetWaypointsAt(waypoints, distances, false);
+  }
+
   boost::optional<Waypoint> Map::GetRight(Waypoint waypoint) const {
     RELEASE_ASSERT(waypoint.lane_id != 0);
     if (waypoint.lane_id > 0) {
@@ -460,16 +615,13 @@ namespace road {
 
   std::vector<Waypoint> Map::GenerateWaypoints(const double distance) const {
     RELEASE_ASSERT(distance > 0.0);
-    std::vector<Waypoint> result;
-    for (const auto &pair : _data.GetRoads()) {
-      const auto &road = pair.second;
+    return CollectPerRoad<Waypoint>(_data, 16u, [distance](const Road &road, auto &result) {
       for (double s = EPSILON; s < (road.GetLength() - EPSILON); s += distance) {
         ForEachDrivableLaneAt(road, s, [&](auto &&waypoint) {
           result.emplace_back(waypoint);
         });
       }
-    }
-    return result;
+    });
   }
 
   std::vector<Waypoint> Map::GenerateWaypointsOnRoadEntries() const {
@@ -500,22 +652,88 @@ namespace road {
   }
 
   std::vector<std::pair<Waypoint, Waypoint>> Map::GenerateTopology() const {
-    std::vector<std::pair<Waypoint, Waypoint>> result;
-    for (const auto &pair : _data.GetRoads()) {
-      const auto &road = pair.second;
+    using Segment = std::pair<Waypoint, Waypoint>;
+    return CollectPerRoad<Segment>(_data, 32u, [this](const Road &road, auto &result) {
       ForEachDrivableLane(road, [&](auto &&waypoint) {
         for (auto &&successor : GetSuccessors(waypoint)) {
           result.push_back({waypoint, successor});
         }
       });
-    }
-    return result;
+    });
   }
 
   // ===========================================================================
   // -- Map: Private functions -------------------------------------------------
   // ===========================================================================
 
+  Map::WaypointBatch Map::GetWaypointsAt(
+      const std::vector<Waypoint> &waypoints,
+      const std::vector<double> &distances,
+      const bool forward) const {
+    if (distances.size() != waypoints.size()) {
+      throw_exception(std::invalid_argument("expected as many distances as waypoints"));
+    }
+    WaypointBatch result;
+    // Usually each waypoint has a single result.
+    result.waypoints.reserve(waypoints.size());
+    result.offsets.reserve(waypoints.size() + 1u);
+    result.offsets.emplace_back(0u);
+    std::vector<std::pair<Waypoint, double>> stack;
+    for (size_t i = 0u; i < waypoints.size(); ++i) {
+      AppendWaypointsAt(waypoints[i], distances[i], forward, stack, result.waypoints);
+      result.offsets.emplace_back(result.waypoints.size());
+    }
+    return result;
+  }
+
+  void Map::AppendWaypointsAt(
+      const Waypoint waypoint,
+      const double distance,
+      const bool forward,
+      std::vector<std::pair<Waypoint, double>> &stack,
+      std::vector<Waypoint> &result) const {
+    RELEASE_ASSERT(distance > 0.0);
+    // Depth first, the lanes pushed in reverse so the results come in the
+    // order of the lanes.
+    stack.clear();
+    stack.emplace_back(waypoint, distance);
+    while (!stack.empty()) {
+      const auto current = stack.back().first;
+      const auto remaining = stack.back().second;
+      stack.pop_back();
+      const auto &lane = GetLane(current);
+      // Driving forward increases s on the right lanes and decreases it on
+      // the left ones.
+      const bool increasing_s = ((current.lane_id <= 0) == forward);
+      const double relative_s = current.s - lane.GetDistance() + EPSILON;
+      const double remaining_lane_length = increasing_s ? lane.GetLength() - relative_s : relative_s;
+      DEBUG_ASSERT(remaining_lane_length >= 0.0);
+
+      // If after subtracting the distance we are still in the same lane,
+      // return same waypoint with the extra distance.
+      if (remaining <= remaining_lane_length) {
+        Waypoint found = current;
+        found.s += increasing_s ? remaining : -remaining;
+        found.s += increasing_s ? -EPSILON : EPSILON;
+        RELEASE_ASSERT(found.s > 0.0);
+        result.emplace_back(found);
+        continue;
+      }
+
+      // If we run out of remaining_lane_length we have to go to the next
+      // lanes.
+      const auto &lanes = forward ? lane.GetNextLanes() : lane.GetPreviousLanes();
+      for (auto it = lanes.rbegin(); it != lanes.rend(); ++it) {
+        DEBUG_ASSERT(*it != &lane);
+        stack.emplace_back(
+            forward ?
+                MakeWaypointAt(*it, GetDistanceAtStartOfLane) :
+                MakeWaypointAt(*it, GetDistanceAtEndOfLane),
+            remaining - remaining_lane_length);
+      }
+    }
+  }
+
   const Lane &Map::GetLane(Waypoint waypoint) const {
     return _data.GetRoad(waypoint.road_id).GetLaneById(waypoint.section_id, waypoint.lane_id);
   }
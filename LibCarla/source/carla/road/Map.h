@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include "carla/MemoryAccounting.h"
 #include "carla/NonCopyable.h"
+#include "carla/geom/GeoProjection.h"
 #include "carla/geom/Transform.h"
 #include "carla/road/MapData.h"
 #include "carla/road/RoadTypes.h"
@@ -14,13 +16,20 @@
 #include "carla/road/element/RoadInfoMarkRecord.h"
 #include "carla/road/element/Waypoint.h"
 
+#include <boost/geometry/geometries/box.hpp>
+#include <boost/geometry/geometries/point.hpp>
+#include <boost/geometry/index/rtree.hpp>
 #include <boost/optional.hpp>
 
+#include <utility>
 #include <vector>
 
 namespace carla {
 namespace road {
 
+  class CompiledMap;
+  class RoutePlanner;
+
   class Map : private MovableNonCopyable {
   public:
 
@@ -30,7 +39,8 @@ namespace road {
     /// -- Constructor ---------------------------------------------------------
     /// ========================================================================
 
-    Map(MapData m) : _data(std::move(m)) {}
+    /// Builds the spatial index of the roads of @a m.
+    Map(MapData m);
 
     /// ========================================================================
     /// -- Georeference --------------------------------------------------------
@@ -40,6 +50,11 @@ namespace road {
       return _data.GetGeoReference();
     }
 
+    /// Projection of the locations of the map around its geo-reference.
+    const geom::GeoProjection &GetGeoProjection() const {
+      return _geo_projection;
+    }
+
     /// ========================================================================
     /// -- Geometry ------------------------------------------------------------
     /// ========================================================================
@@ -52,6 +67,16 @@ namespace road {
         const geom::Location &location,
         uint32_t lane_type = static_cast<uint32_t>(Lane::LaneType::Driving)) const;
 
+    /// Same as GetClosestWaypointOnRoad for each of @a locations.
+    std::vector<boost::optional<element::Waypoint>> GetClosestWaypointsOnRoad(
+        const std::vector<geom::Location> &locations,
+        uint32_t lane_type = static_cast<uint32_t>(Lane::LaneType::Driving)) const;
+
+    /// Same as GetWaypoint for each of @a locations.
+    std::vector<boost::optional<element::Waypoint>> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        uint32_t lane_type = static_cast<uint32_t>(Lane::LaneType::Driving)) const;
+
     geom::Transform ComputeTransform(Waypoint waypoint) const;
 
     /// ========================================================================
@@ -89,6 +114,30 @@ namespace road {
     /// waypoint could drive to.
     std::vector<Waypoint> GetNext(Waypoint waypoint, double distance) const;
 
+    /// Return the list of waypoints at @a distance such that a vehicle could
+    /// drive from them to @a waypoint.
+    std::vector<Waypoint> GetPrevious(Waypoint waypoint, double distance) const;
+
+    /// The waypoints found for each of a batch of waypoints, in a single
+    /// list. Those found for the i-th are the ones from @a offsets[i] to
+    /// @a offsets[i + 1], not included.
+    struct WaypointBatch {
+      std::vector<Waypoint> waypoints;
+      std::vector<size_t> offsets;
+    };
+
+    /// Same as GetNext for each of @a waypoints, at the distance of the same
+    /// index in @a distances.
+    WaypointBatch GetNext(
+        const std::vector<Waypoint> &waypoints,
+        const std::vector<double> &distances) const;
+
+    /// Same as GetPrevious for each of @a waypoints, at the distance of the
+    /// same index in @a distances.
+    WaypointBatch GetPrevious(
+        const std::vector<Waypoint> &waypoints,
+        const std::vector<double> &distances) const;
+
     /// Return a waypoint at the lane of @a waypoint's right lane.
     boost::optional<Waypoint> GetRight(Waypoint waypoint) const;
 
@@ -96,13 +145,15 @@ namespace road {
     boost::optional<Waypoint> GetLeft(Waypoint waypoint) const;
 
     /// Generate all the waypoints in @a map separated by @a approx_distance.
+    /// The roads are visited in parallel.
     std::vector<Waypoint> GenerateWaypoints(double approx_distance) const;
 
     /// Generate waypoints on each @a lane at the start of each @a road
     std::vector<Waypoint> GenerateWaypointsOnRoadEntries() const;
 
     /// Generate the minimum set of waypoints that define the topology of @a
-    /// map. The waypoints are placed at the entrance of each lane.
+    /// map. The waypoints are placed at the entrance of each lane. The roads
+    /// are visited in parallel.
     std::vector<std::pair<Waypoint, Waypoint>> GenerateTopology() const;
 
 #ifdef LIBCARLA_WITH_GTEST
@@ -113,7 +164,46 @@ namespace road {
 
 private:
 
+    friend CompiledMap;
+
+    friend RoutePlanner;
+
+    using Point = boost::geometry::model::point<float, 2u, boost::geometry::cs::cartesian>;
+
+    using Box = boost::geometry::model::box<Point>;
+
+    using Value = std::pair<Box, RoadId>;
+
+    void CreateRtree();
+
+    /// Append to @a values the boxes of the pieces of @a road.
+    static void AddRoadPieces(const Road &road, std::vector<Value> &values);
+
+    WaypointBatch GetWaypointsAt(
+        const std::vector<Waypoint> &waypoints,
+        const std::vector<double> &distances,
+        bool forward) const;
+
+    /// Append to @a result the waypoints at @a distance from @a waypoint,
+    /// following the next lanes if @a forward, the previous ones otherwise.
+    /// @a stack is only scratch space, reused between calls.
+    void AppendWaypointsAt(
+        Waypoint waypoint,
+        double distance,
+        bool forward,
+        std::vector<std::pair<Waypoint, double>> &stack,
+        std::vector<Waypoint> &result) const;
+
     MapData _data;
+
+    geom::GeoProjection _geo_projection;
+
+    /// Boxes enclosing the reference line of the roads, piece by piece.
+    boost::geometry::index::rtree<Value, boost::geometry::index::rstar<16u>> _rtree;
+
+    /// Estimate of the size of the roads, lanes and rtree, accounted as map
+    /// data memory.
+    TrackedMemory _memory;
   };
 
 } // namespace road
@@ -4,10 +4,12 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include "carla/ParallelFor.h"
 #include "carla/StringUtil.h"
 #include "carla/road/MapBuilder.h"
 #include "carla/road/element/RoadInfoElevation.h"
 #include "carla/road/element/RoadInfoGeometry.h"
+#include "carla/road/element/RoadInfoIterator.h"
 #include "carla/road/element/RoadInfoLaneAccess.h"
 #include "carla/road/element/RoadInfoLaneBorder.h"
 #include "carla/road/element/RoadInfoLaneHeight.h"
@@ -26,8 +28,10 @@
 #include "carla/road/signal/SignalReference.h"
 #include "carla/road/signal/SignalDependency.h"
 
+#include <algorithm>
 #include <iterator>
 #include <memory>
+#include <tuple>
 
 using namespace carla::road::element;
 
@@ -36,17 +40,39 @@ namespace road {
 
   boost::optional<Map> MapBuilder::Build() {
 
+    // index the lanes of each section by id, all of them are added by now
+    for (auto &road : _map_data._roads) {
+      for (auto &section : road.second._lane_sections) {
+        section.second.IndexLanes();
+      }
+    }
+
     CreatePointersBetweenRoadSegments();
 
-    for (auto &&info : _temp_road_info_container) {
-      DEBUG_ASSERT(info.first != nullptr);
-      info.first->_info = InformationSet(std::move(info.second));
+    // the infos of each road and lane are sorted independently, in parallel
+    std::vector<std::pair<Road *const, std::vector<std::unique_ptr<RoadInfo>>> *> road_infos;
+    road_infos.reserve(_temp_road_info_container.size());
+    for (auto &info : _temp_road_info_container) {
+      road_infos.emplace_back(&info);
     }
+    ParallelForEachChunk(road_infos.size(), 64u, [&](const size_t begin, const size_t end) {
+      for (auto i = begin; i < end; ++i) {
+        DEBUG_ASSERT(road_infos[i]->first != nullptr);
+        road_infos[i]->first->_info = InformationSet(std::move(road_infos[i]->second));
+      }
+    });
 
-    for (auto &&info : _temp_lane_info_container) {
-      DEBUG_ASSERT(info.first != nullptr);
-      info.first->_info = InformationSet(std::move(info.second));
+    std::vector<std::pair<Lane *const, std::vector<std::unique_ptr<RoadInfo>>> *> lane_infos;
+    lane_infos.reserve(_temp_lane_info_container.size());
+    for (auto &info : _temp_lane_info_container) {
+      lane_infos.emplace_back(&info);
     }
+    ParallelForEachChunk(lane_infos.size(), 256u, [&](const size_t begin, const size_t end) {
+      for (auto i = begin; i < end; ++i) {
+        DEBUG_ASSERT(lane_infos[i]->first != nullptr);
+        lane_infos[i]->first->_info = InformationSet(std::move(lane_infos[i]->second));
+      }
+    });
 
     // remove temporal already used information
     _temp_road_info_container.clear();
@@ -587,7 +613,7 @@ namespace road {
     }
 
     // check all connections
-    for (auto con : junction->_connections) {
+    for (const auto &con : junction->_connections) {
       // only connections for our road
       if (con.second.incoming_road == road_id) {
         // for center lane it is always next lane id 0, we don't need to search
@@ -596,7 +622,7 @@ namespace road {
           result.push_back(std::make_pair(con.second.connecting_road, 0));
         } else {
           // check all lane links
-          for (auto link : con.second.lane_links) {
+          for (const auto &link : con.second.lane_links) {
             // is our lane id ?
             if (link.from == lane_id) {
               // add as option
@@ -610,23 +636,53 @@ namespace road {
     return result;
   }
 
+  /// Orders the lanes by road, position in the road and id.
+  static bool CompareLanes(const Lane *lhs, const Lane *rhs) {
+    DEBUG_ASSERT(lhs != nullptr);
+    DEBUG_ASSERT(rhs != nullptr);
+    return std::make_tuple(lhs->GetRoad()->GetId(), lhs->GetDistance(), lhs->GetId()) <
+           std::make_tuple(rhs->GetRoad()->GetId(), rhs->GetDistance(), rhs->GetId());
+  }
+
   // assign pointers to the next lanes
   void MapBuilder::CreatePointersBetweenRoadSegments(void) {
-    // process each lane to define its nexts
+    // the nexts of a lane only depend on its road and the junctions, they are
+    // found road by road in parallel. The pointers are sorted, the roads and
+    // the connections of the junctions are stored unordered so the order
+    // they were found in is arbitrary
+    std::vector<Road *> roads;
+    roads.reserve(_map_data._roads.size());
+    for (auto &road : _map_data._roads) {
+      roads.emplace_back(&road.second);
+    }
+    ParallelForEachChunk(roads.size(), 32u, [&](const size_t begin, const size_t end) {
+      for (auto i = begin; i < end; ++i) {
+        auto &road = *roads[i];
+        for (auto &section : road._lane_sections) {
+          for (auto &lane : section.second._lanes) {
+            auto &next_lanes = lane.second._next_lanes;
+            next_lanes = GetLaneNext(road._id, section.second._id, lane.first);
+            std::sort(next_lanes.begin(), next_lanes.end(), CompareLanes);
+          }
+        }
+      }
+    });
+
+    // add to each lane found, this as its predecessor
     for (auto &road : _map_data._roads) {
       for (auto &section : road.second._lane_sections) {
         for (auto &lane : section.second._lanes) {
-
-          // assign the next lane pointers
-          lane.second._next_lanes = GetLaneNext(road.first, section.second._id, lane.first);
-
-          // add to each lane found, this as its predecessor
           for (auto next_lane : lane.second._next_lanes) {
-            // add as previous
             DEBUG_ASSERT(next_lane != nullptr);
             next_lane->_prev_lanes.push_back(&lane.second);
           }
-
+        }
+      }
+    }
+    for (auto &road : _map_data._roads) {
+      for (auto &section : road.second._lane_sections) {
+        for (auto &lane : section.second._lanes) {
+          std::sort(lane.second._prev_lanes.begin(), lane.second._prev_lanes.end(), CompareLanes);
         }
       }
     }
@@ -350,7 +350,8 @@ namespace road {
         LaneId lane_id);
 
     /// Map to temporary store all the road and lane infos until the map is
-    /// built, so they can be added all together.
+    /// built, so they can be added all together. The road infos and the lane
+    /// infos are kept apart so the parsers adding each can run concurrently.
     std::unordered_map<Road *, std::vector<std::unique_ptr<element::RoadInfo>>>
     _temp_road_info_container;
 
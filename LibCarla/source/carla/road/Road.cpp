@@ -86,7 +86,11 @@ namespace road {
   }
 
   Lane &Road::GetLaneById(SectionId section_id, LaneId lane_id) {
-    return GetLaneSectionById(section_id).GetLanes().at(lane_id);
+    auto *lane = GetLaneSectionById(section_id).GetLane(lane_id);
+    if (lane == nullptr) {
+      throw_exception(std::out_of_range("lane not found"));
+    }
+    return *lane;
   }
 
   const Lane &Road::GetLaneById(SectionId section_id, LaneId lane_id) const {
@@ -224,12 +228,24 @@ namespace road {
     return last;
   }
 
-  const std::pair<const Lane *, double> Road::GetNearestLane(
+  static const Lane *ToLanePointer(const Lane &lane) {
+    return &lane;
+  }
+
+  static const Lane *ToLanePointer(const Lane *lane) {
+    return lane;
+  }
+
+  /// Nearest lane to @a loc of @a lanes, a map of lanes by id; either the
+  /// lanes of a section or the pointers returned by Road::GetLanesAt.
+  template <typename LaneMapT>
+  static std::pair<const Lane *, double> GetNearestLaneOf(
+      const LaneMapT &lanes,
+      const element::DirectedPoint &dp_lane_zero,
       const double s,
       const geom::Location &loc,
-      uint32_t lane_type) const {
+      const uint32_t lane_type) {
     using namespace carla::road::element;
-    std::map<LaneId, const Lane *> lanes(GetLanesAt(s));
     // negative right lanes
     auto right_lanes = MakeListView(
         std::make_reverse_iterator(lanes.lower_bound(0)), lanes.rend());
@@ -237,13 +253,13 @@ namespace road {
     auto left_lanes = MakeListView(
         lanes.lower_bound(1), lanes.end());
 
-    const DirectedPoint dp_lane_zero = GetDirectedPointIn(s);
     std::pair<const Lane *, double> result =
         std::make_pair(nullptr, std::numeric_limits<double>::max());
 
     DirectedPoint current_dp = dp_lane_zero;
-    for (const auto &lane : right_lanes) {
-      const auto lane_width_info = lane.second->GetInfo<RoadInfoLaneWidth>(s);
+    for (const auto &pair : right_lanes) {
+      const Lane *lane = ToLanePointer(pair.second);
+      const auto lane_width_info = lane->GetInfo<RoadInfoLaneWidth>(s);
       const auto half_width = static_cast<float>(lane_width_info->GetPolynomial().Evaluate(s)) * 0.5f;
 
       current_dp.ApplyLateralOffset(half_width);
@@ -253,8 +269,8 @@ namespace road {
       if (current_dist <= result.second) {
         // only consider the lanes that match the type flag for result
         // candidates
-        if ((static_cast<uint32_t>(lane.second->GetType()) & lane_type) > 0) {
-          result.first = &(*lane.second);
+        if ((static_cast<uint32_t>(lane->GetType()) & lane_type) > 0) {
+          result.first = lane;
           result.second = current_dist;
         }
       } else {
@@ -265,8 +281,9 @@ namespace road {
     }
 
     current_dp = dp_lane_zero;
-    for (const auto &lane : left_lanes) {
-      const auto lane_width_info = lane.second->GetInfo<RoadInfoLaneWidth>(s);
+    for (const auto &pair : left_lanes) {
+      const Lane *lane = ToLanePointer(pair.second);
+      const auto lane_width_info = lane->GetInfo<RoadInfoLaneWidth>(s);
       const auto half_width = -static_cast<float>(lane_width_info->GetPolynomial().Evaluate(s)) * 0.5f;
 
       current_dp.ApplyLateralOffset(half_width);
@@ -276,8 +293,8 @@ namespace road {
       if (current_dist <= result.second) {
         // only consider the lanes that match the type flag for result
         // candidates
-        if ((static_cast<uint32_t>(lane.second->GetType()) & lane_type) > 0) {
-          result.first = &(*lane.second);
+        if ((static_cast<uint32_t>(lane->GetType()) & lane_type) > 0) {
+          result.first = lane;
           result.second = current_dist;
         }
       } else {
@@ -290,6 +307,20 @@ namespace road {
     return result;
   }
 
+  const std::pair<const Lane *, double> Road::GetNearestLane(
+      const double s,
+      const geom::Location &loc,
+      uint32_t lane_type) const {
+    const auto dp_lane_zero = GetDirectedPointIn(s);
+    const auto sections = GetLaneSectionsAt(s);
+    // There is usually a single section at s, its lanes are used as they are
+    // instead of gathering them in a new map.
+    if (sections.size() == 1u) {
+      return GetNearestLaneOf(sections.begin()->GetLanes(), dp_lane_zero, s, loc, lane_type);
+    }
+    return GetNearestLaneOf(GetLanesAt(s), dp_lane_zero, s, loc, lane_type);
+  }
+
   std::map<LaneId, const Lane *> Road::GetLanesAt(const double s) const {
     std::map<LaneId, const Lane *> map;
     for (auto &&lane_section : GetLaneSectionsAt(s)) {
@@ -29,6 +29,7 @@ namespace road {
   class MapData;
   class Elevation;
   class MapBuilder;
+  class CompiledMap;
 
   class Road : private MovableNonCopyable {
   public:
@@ -113,6 +114,11 @@ namespace road {
       return _info.GetInfo<T>(s);
     }
 
+    template <typename T>
+    auto GetInfos() const {
+      return _info.GetInfos<T>();
+    }
+
     auto GetLaneSections() const {
       return MakeListView(
           iterator::make_map_values_const_iterator(_lane_sections.begin()),
@@ -171,6 +177,8 @@ namespace road {
 
     friend MapBuilder;
 
+    friend CompiledMap;
+
     MapData *_map_data { nullptr };
 
     RoadId _id { 0 };
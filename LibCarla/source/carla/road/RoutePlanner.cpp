@@ -0,0 +1,338 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/RoutePlanner.h"
+
+#include "carla/Debug.h"
+#include "carla/geom/Math.h"
+#include "carla/road/Map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace carla {
+namespace road {
+
+  using namespace carla::road::element;
+
+  /// Keeps the start of the lanes off the edges of the lane sections.
+  static constexpr double EPSILON = 1e-4;
+
+  static bool IsDrivingLane(const Lane &lane) {
+    return (static_cast<uint32_t>(lane.GetType()) & static_cast<uint32_t>(Lane::LaneType::Driving)) > 0;
+  }
+
+  /// Distance driven along the lane of @a waypoint from it to the end of the
+  /// lane.
+  static double GetRemainingLength(const Lane &lane, const Waypoint &waypoint) {
+    const auto remaining = waypoint.lane_id <= 0 ?
+        lane.GetDistance() + lane.GetLength() - waypoint.s :
+        waypoint.s - lane.GetDistance();
+    return std::max(0.0, remaining);
+  }
+
+  /// Whether the marking between the lane of @a waypoint and its right (or
+  /// left) lane allows changing to it, same as
+  /// client::Waypoint::GetLaneChange.
+  static bool IsLaneChangeAllowed(const Map &map, const Waypoint &waypoint, const bool right) {
+    const auto marks = map.GetMarkRecord(waypoint);
+    const auto *mark = right ? marks.first : marks.second;
+    if (mark == nullptr) {
+      return true;
+    }
+    // The marks are on the outer border of their lanes, the lane ids
+    // increase to the left of the lanes with negative id and to the right of
+    // the others.
+    const auto border_lane_id = right ?
+        waypoint.lane_id :
+        (waypoint.lane_id < 0 ? waypoint.lane_id + 1 : waypoint.lane_id - 1);
+    const auto wanted = (right != (border_lane_id > 0)) ?
+        RoadInfoMarkRecord::LaneChange::Increase :
+        RoadInfoMarkRecord::LaneChange::Decrease;
+    return (static_cast<uint8_t>(mark->GetLaneChange()) & static_cast<uint8_t>(wanted)) != 0u;
+  }
+
+  /// Call @a func for the waypoint at each neighbouring lane of @a waypoint
+  /// with the same direction, if the marking allows changing to it.
+  template <typename FuncT>
+  static void ForEachLaneChange(const Map &map, const Waypoint &waypoint, FuncT &&func) {
+    for (const bool right : {true, false}) {
+      const auto neighbour = right ? map.GetRight(waypoint) : map.GetLeft(waypoint);
+      if (neighbour.has_value() &&
+          ((neighbour->lane_id > 0) == (waypoint.lane_id > 0)) &&
+          IsLaneChangeAllowed(map, waypoint, right)) {
+        func(*neighbour);
+      }
+    }
+  }
+
+  // ===========================================================================
+  // -- RoutePlanner -----------------------------------------------------------
+  // ===========================================================================
+
+  RoutePlanner::RoutePlanner(
+      const Map &map,
+      const double lane_change_cost,
+      const size_t cache_size)
+    : _map(map),
+      _lane_change_cost(lane_change_cost),
+      _cache_size(cache_size) {
+    DEBUG_ASSERT(lane_change_cost >= 0.0);
+    for (const auto &road_pair : map._data.GetRoads()) {
+      const auto &road = road_pair.second;
+      for (const auto &section : road.GetLaneSections()) {
+        for (const auto &lane_pair : section.GetLanes()) {
+          const auto &lane = lane_pair.second;
+          if ((lane.GetId() == 0) || !IsDrivingLane(lane)) {
+            continue;
+          }
+          const auto s = lane.GetId() < 0 ?
+              lane.GetDistance() + EPSILON :
+              lane.GetDistance() + lane.GetLength() - EPSILON;
+          const Waypoint start{road.GetId(), section.GetId(), lane.GetId(), s};
+          _node_index.emplace(&lane, static_cast<uint32_t>(_nodes.size()));
+          _nodes.emplace_back(Node{
+              start,
+              map.ComputeTransform(start).location,
+              lane.GetLength(),
+              0u});
+        }
+      }
+    }
+
+    // The costs are never shorter than the distance between the starts of
+    // the lanes, so that distance never overestimates the cost left and A*
+    // finds the shortest route.
+    for (auto &node : _nodes) {
+      node.first_edge = static_cast<uint32_t>(_edges.size());
+      const auto add_edge = [&](const Lane &lane, const bool lane_change) {
+        const auto it = _node_index.find(&lane);
+        if (it == _node_index.end()) {
+          return;
+        }
+        const auto distance = static_cast<double>(
+            geom::Math::Distance(node.location, _nodes[it->second].location));
+        _edges.emplace_back(Edge{
+            it->second,
+            lane_change,
+            std::max(lane_change ? _lane_change_cost : node.length, distance)});
+      };
+      for (const auto *next_lane : map.GetLane(node.start).GetNextLanes()) {
+        DEBUG_ASSERT(next_lane != nullptr);
+        add_edge(*next_lane, false);
+      }
+      ForEachLaneChange(map, node.start, [&](const Waypoint &neighbour) {
+        add_edge(map.GetLane(neighbour), true);
+      });
+    }
+    _edges.shrink_to_fit();
+  }
+
+  std::vector<Waypoint> RoutePlanner::ComputeRoute(
+      const Waypoint &origin,
+      const Waypoint &destination) const {
+    const auto origin_node = FindNode(origin);
+    const auto destination_node = FindNode(destination);
+    if ((origin_node < 0) || (destination_node < 0)) {
+      return {};
+    }
+
+    // The lanes taken only depend on the lanes of origin and destination,
+    // unless the destination can be reached changing lanes where the route
+    // starts.
+    const auto laterals = GetLaterals(static_cast<uint32_t>(origin_node));
+    const bool cacheable = std::none_of(laterals.begin(), laterals.end(), [&](const auto &lateral) {
+      return lateral.node == destination_node;
+    });
+    const auto key = (static_cast<uint64_t>(origin_node) << 32u) | static_cast<uint64_t>(destination_node);
+    auto path = cacheable ? FindCachedPath(key) : nullptr;
+    if (path == nullptr) {
+      path = std::make_shared<const Path>(Search(
+          origin,
+          laterals,
+          destination,
+          static_cast<uint32_t>(destination_node)));
+      if (cacheable) {
+        CachePath(key, path);
+      }
+    }
+    if (path->empty()) {
+      return {};
+    }
+
+    // Lane changes keep the distance on the road.
+    std::vector<Waypoint> result;
+    result.reserve(path->size() + 1u);
+    result.emplace_back(origin);
+    auto current = origin;
+    for (size_t i = 1u; i < path->size(); ++i) {
+      const auto &node = _nodes[(*path)[i].first];
+      if ((*path)[i].second) {
+        current.lane_id = node.start.lane_id;
+      } else {
+        current = node.start;
+      }
+      result.emplace_back(current);
+    }
+    result.emplace_back(destination);
+    return result;
+  }
+
+  int64_t RoutePlanner::FindNode(const Waypoint &waypoint) const {
+    const auto it = _node_index.find(&_map.GetLane(waypoint));
+    return it != _node_index.end() ? static_cast<int64_t>(it->second) : -1;
+  }
+
+  std::vector<RoutePlanner::Lateral> RoutePlanner::GetLaterals(const uint32_t origin_node) const {
+    std::vector<Lateral> result = {{origin_node, -1, 0.0}};
+    for (size_t i = 0u; i < result.size(); ++i) {
+      const auto edges = GetEdges(result[i].node);
+      for (auto it = edges.first; it != edges.second; ++it) {
+        const auto is_new = std::none_of(result.begin(), result.end(), [&](const auto &lateral) {
+          return lateral.node == it->to;
+        });
+        if (it->lane_change && is_new) {
+          result.emplace_back(Lateral{it->to, static_cast<int64_t>(i), result[i].cost + _lane_change_cost});
+        }
+      }
+    }
+    return result;
+  }
+
+  RoutePlanner::Path RoutePlanner::Search(
+      const Waypoint &origin,
+      const std::vector<Lateral> &laterals,
+      const Waypoint &destination,
+      const uint32_t destination_node) const {
+    // The destination is the node after the last lane. The parents of the
+    // nodes are encoded as -2 - i when they are the i-th lateral.
+    const auto number_of_nodes = static_cast<uint32_t>(_nodes.size());
+    const auto terminal = number_of_nodes;
+    constexpr double infinity = std::numeric_limits<double>::infinity();
+    std::vector<double> cost(number_of_nodes + 1u, infinity);
+    std::vector<int64_t> parent(number_of_nodes + 1u, -1);
+    std::vector<bool> lane_change(number_of_nodes + 1u, false);
+    std::vector<bool> closed(number_of_nodes + 1u, false);
+
+    const auto destination_location = _map.ComputeTransform(destination).location;
+    const auto heuristic = [&](const uint32_t node) {
+      return node == terminal ?
+          0.0 :
+          static_cast<double>(geom::Math::Distance(_nodes[node].location, destination_location));
+    };
+
+    using Entry = std::pair<double, uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    const auto push = [&](const uint32_t node, const double new_cost, const int64_t from, const bool by_lane_change) {
+      if (new_cost < cost[node]) {
+        cost[node] = new_cost;
+        parent[node] = from;
+        lane_change[node] = by_lane_change;
+        open.emplace(new_cost + heuristic(node), node);
+      }
+    };
+    const auto cost_to_destination = [&](const Waypoint &from) {
+      const auto along_lane = std::abs(destination.s - from.s);
+      const auto location = _map.ComputeTransform(from).location;
+      return std::max(along_lane, static_cast<double>(geom::Math::Distance(location, destination_location)));
+    };
+
+    for (size_t i = 0u; i < laterals.size(); ++i) {
+      const auto &lateral = laterals[i];
+      const auto encoded = -2 - static_cast<int64_t>(i);
+      const auto &lane = _map.GetLane(_nodes[lateral.node].start);
+      auto waypoint = origin;
+      waypoint.lane_id = _nodes[lateral.node].start.lane_id;
+      if (lateral.node == destination_node) {
+        const bool ahead = destination.lane_id <= 0 ?
+            (destination.s >= origin.s) :
+            (destination.s <= origin.s);
+        if (ahead) {
+          push(terminal, lateral.cost + std::abs(destination.s - origin.s), encoded, false);
+        }
+      }
+      const auto remaining = GetRemainingLength(lane, waypoint);
+      const auto edges = GetEdges(lateral.node);
+      for (auto it = edges.first; it != edges.second; ++it) {
+        if (!it->lane_change) {
+          push(it->to, lateral.cost + remaining, encoded, false);
+        }
+      }
+    }
+
+    while (!open.empty()) {
+      const auto node = open.top().second;
+      open.pop();
+      if (closed[node]) {
+        continue;
+      }
+      closed[node] = true;
+      if (node == terminal) {
+        break;
+      }
+      if (node == destination_node) {
+        push(terminal, cost[node] + cost_to_destination(_nodes[node].start), node, false);
+      }
+      const auto edges = GetEdges(node);
+      for (auto it = edges.first; it != edges.second; ++it) {
+        if (!closed[it->to]) {
+          push(it->to, cost[node] + it->cost, node, it->lane_change);
+        }
+      }
+    }
+
+    Path result;
+    if (!closed[terminal]) {
+      return result;
+    }
+    auto current = parent[terminal];
+    while (current >= 0) {
+      const auto node = static_cast<uint32_t>(current);
+      result.emplace_back(node, lane_change[node]);
+      current = parent[node];
+    }
+    DEBUG_ASSERT(current <= -2);
+    for (auto i = -2 - current; i >= 0; i = laterals[i].parent) {
+      result.emplace_back(laterals[i].node, laterals[i].parent >= 0);
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+  }
+
+  std::shared_ptr<const RoutePlanner::Path> RoutePlanner::FindCachedPath(const uint64_t key) const {
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+    const auto it = _cache_index.find(key);
+    if (it == _cache_index.end()) {
+      return nullptr;
+    }
+    _cache.splice(_cache.begin(), _cache, it->second);
+    return it->second->second;
+  }
+
+  void RoutePlanner::CachePath(const uint64_t key, std::shared_ptr<const Path> path) const {
+    if (_cache_size == 0u) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+    const auto it = _cache_index.find(key);
+    if (it != _cache_index.end()) {
+      // Found meanwhile by another thread.
+      _cache.splice(_cache.begin(), _cache, it->second);
+      return;
+    }
+    _cache.emplace_front(key, std::move(path));
+    _cache_index.emplace(key, _cache.begin());
+    if (_cache.size() > _cache_size) {
+      _cache_index.erase(_cache.back().first);
+      _cache.pop_back();
+    }
+  }
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,139 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/geom/Location.h"
+#include "carla/road/element/Waypoint.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  class Lane;
+  class Map;
+
+  /// Lane level route planner. The driving lanes of a map are the nodes of a
+  /// graph, connected to their successor lanes and, where their marking
+  /// allows it, to their neighbouring lanes of the same direction. Routes are
+  /// the shortest paths found with A*, the most recent are kept so agents
+  /// replanning between the same lanes do not search again.
+  ///
+  /// Lane changes are taken at the start of the lanes, except the ones at the
+  /// start of the route, taken where the route starts.
+  class RoutePlanner : private NonCopyable {
+  public:
+
+    using Waypoint = element::Waypoint;
+
+    /// Builds the graph of the driving lanes of @a map, which must outlive
+    /// the planner. Changing lanes costs as much as driving
+    /// @a lane_change_cost meters, and up to @a cache_size routes are kept.
+    explicit RoutePlanner(
+        const Map &map,
+        double lane_change_cost = 5.0,
+        size_t cache_size = 1024u);
+
+    /// Return the route to drive from @a origin to @a destination: @a origin,
+    /// the waypoint where each lane of the route is entered, and
+    /// @a destination. Empty if @a destination cannot be reached or any of
+    /// them is not on a driving lane.
+    std::vector<Waypoint> ComputeRoute(
+        const Waypoint &origin,
+        const Waypoint &destination) const;
+
+    size_t GetNumberOfLanes() const {
+      return _nodes.size();
+    }
+
+  private:
+
+    struct Node {
+      /// Waypoint at the start of the lane.
+      Waypoint start;
+      geom::Location location;
+      double length;
+      /// Start of the edges of this node in @a _edges, those of the next
+      /// node start where these end.
+      uint32_t first_edge;
+    };
+
+    struct Edge {
+      uint32_t to;
+      bool lane_change;
+      double cost;
+    };
+
+    /// Index of the node of @a waypoint's lane, or -1 if it is not a driving
+    /// lane.
+    int64_t FindNode(const Waypoint &waypoint) const;
+
+    /// Nodes visited from the start of a route to its end, each with whether
+    /// it was entered changing lanes.
+    using Path = std::vector<std::pair<uint32_t, bool>>;
+
+    /// A node reached changing lanes where a route starts, and the index of
+    /// the one it is reached from, -1 for the first.
+    struct Lateral {
+      uint32_t node;
+      int64_t parent;
+      double cost;
+    };
+
+    /// The nodes reached changing lanes from @a origin_node, starting by it.
+    std::vector<Lateral> GetLaterals(uint32_t origin_node) const;
+
+    /// Shortest path from @a origin to @a destination, empty if there is
+    /// none.
+    Path Search(
+        const Waypoint &origin,
+        const std::vector<Lateral> &laterals,
+        const Waypoint &destination,
+        uint32_t destination_node) const;
+
+    /// The edges of @a node, begin and end.
+    std::pair<const Edge *, const Edge *> GetEdges(uint32_t node) const {
+      const auto begin = _nodes[node].first_edge;
+      const auto end = (node + 1u) < _nodes.size() ? _nodes[node + 1u].first_edge : _edges.size();
+      return {_edges.data() + begin, _edges.data() + end};
+    }
+
+    std::shared_ptr<const Path> FindCachedPath(uint64_t key) const;
+
+    void CachePath(uint64_t key, std::shared_ptr<const Path> path) const;
+
+    const Map &_map;
+
+    const double _lane_change_cost;
+
+    const size_t _cache_size;
+
+    std::vector<Node> _nodes;
+
+    std::vector<Edge> _edges;
+
+    std::unordered_map<const Lane *, uint32_t> _node_index;
+
+    mutable std::mutex _cache_mutex;
+
+    /// Most recently used first.
+    mutable std::list<std::pair<uint64_t, std::shared_ptr<const Path>>> _cache;
+
+    mutable std::unordered_map<
+        uint64_t,
+        std::list<std::pair<uint64_t, std::shared_ptr<const Path>>>::iterator> _cache_index;
+  };
+
+} // namespace road
+} // namespace carla
@@ -58,7 +58,7 @@ namespace element {
       return _heading;
     }
 
-    const geom::Location &GetStartPosition() {
+    const geom::Location &GetStartPosition() const {
       return _start_position;
     }
 
@@ -0,0 +1,200 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/element/LaneMarkingIndex.h"
+
+#include "carla/Debug.h"
+#include "carla/geom/Location.h"
+#include "carla/geom/Math.h"
+#include "carla/road/Map.h"
+
+#include <boost/iterator/function_output_iterator.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <tuple>
+
+namespace carla {
+namespace road {
+namespace element {
+
+  namespace bgi = boost::geometry::index;
+
+  /// Markings further away in height than this are ignored, e.g. those of a
+  /// bridge above the road.
+  static constexpr float MAX_HEIGHT_DIFFERENCE = 3.0f;
+
+  /// Keeps the samples off the edges of the lane sections.
+  static constexpr double EPSILON = 1e-4;
+
+  struct BorderSample {
+    geom::Location location;
+    const RoadInfoMarkRecord *mark;
+  };
+
+  /// Point at the border of the lane of @a waypoint, the outer one or the one
+  /// next to the center of the road. Both lanes sides face away from the
+  /// center, so the outer border is always at the right of the lane.
+  static geom::Location GetBorderLocation(
+      const Map &map,
+      const Waypoint &waypoint,
+      const bool outer) {
+    const auto transform = map.ComputeTransform(waypoint);
+    const auto yaw = geom::Math::ToRadians(transform.rotation.yaw);
+    const auto half_width = 0.5f * static_cast<float>(map.GetLaneWidth(waypoint));
+    const auto offset = outer ? half_width : -half_width;
+    auto location = transform.location;
+    location.x -= offset * std::sin(yaw);
+    location.y += offset * std::cos(yaw);
+    return location;
+  }
+
+  /// Whether segments a-b and c-d intersect, if so @a t is set to the
+  /// fraction of a-b at the intersection.
+  static bool IntersectSegments(
+      float ax, float ay, float bx, float by,
+      float cx, float cy, float dx, float dy,
+      float &t) {
+    const float rx = bx - ax;
+    const float ry = by - ay;
+    const float sx = dx - cx;
+    const float sy = dy - cy;
+    const float denominator = rx * sy - ry * sx;
+    if (std::abs(denominator) < std::numeric_limits<float>::epsilon()) {
+      // Parallel, moving along a marking does not cross it.
+      return false;
+    }
+    const float qx = cx - ax;
+    const float qy = cy - ay;
+    t = (qx * sy - qy * sx) / denominator;
+    const float u = (qx * ry - qy * rx) / denominator;
+    return (t >= 0.0f) && (t <= 1.0f) && (u >= 0.0f) && (u <= 1.0f);
+  }
+
+  LaneMarkingIndex::LaneMarkingIndex(const Map &map, const double sampling_distance) {
+    DEBUG_ASSERT(sampling_distance > 0.0);
+
+    // Group the waypoints by lane, ordered along the road.
+    using LaneKey = std::tuple<RoadId, SectionId, LaneId>;
+    std::map<LaneKey, std::vector<Waypoint>> lanes;
+    for (const auto &waypoint : map.GenerateWaypoints(sampling_distance)) {
+      if ((waypoint.lane_id != 0) && !map.IsJunction(waypoint.road_id)) {
+        lanes[LaneKey{waypoint.road_id, waypoint.section_id, waypoint.lane_id}].emplace_back(waypoint);
+      }
+    }
+
+    std::vector<std::vector<BorderSample>> borders;
+    for (auto &pair : lanes) {
+      auto &waypoints = pair.second;
+      // Reach the edges of the lane section so consecutive sections connect.
+      const auto &lane = map.GetLane(waypoints.front());
+      auto first = waypoints.front();
+      auto last = waypoints.front();
+      first.s = lane.GetDistance() + EPSILON;
+      last.s = lane.GetDistance() + lane.GetLength() - EPSILON;
+      waypoints.emplace_back(first);
+      waypoints.emplace_back(last);
+      std::sort(waypoints.begin(), waypoints.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.s < rhs.s;
+      });
+
+      std::vector<BorderSample> outer;
+      outer.reserve(waypoints.size());
+      for (const auto &waypoint : waypoints) {
+        outer.emplace_back(BorderSample{
+            GetBorderLocation(map, waypoint, true),
+            map.GetMarkRecord(waypoint).first});
+      }
+      borders.emplace_back(std::move(outer));
+
+      // The center of the road is added with the first lane at the right, or
+      // the first at the left if there is none at the right.
+      const auto lane_id = std::get<2>(pair.first);
+      const bool has_right_lane = lanes.count(LaneKey{
+          std::get<0>(pair.first),
+          std::get<1>(pair.first),
+          -1}) > 0u;
+      if ((lane_id == -1) || ((lane_id == 1) && !has_right_lane)) {
+        std::vector<BorderSample> center;
+        center.reserve(waypoints.size());
+        for (const auto &waypoint : waypoints) {
+          center.emplace_back(BorderSample{
+              GetBorderLocation(map, waypoint, false),
+              map.GetMarkRecord(waypoint).second});
+        }
+        borders.emplace_back(std::move(center));
+      }
+    }
+
+    std::vector<Value> values;
+    for (auto i = 0u; i < borders.size(); ++i) {
+      const auto &border = borders[i];
+      for (auto j = 1u; j < border.size(); ++j) {
+        const auto &a = border[j - 1u];
+        const auto &b = border[j];
+        if (a.mark == nullptr) {
+          continue;
+        }
+        const auto index = static_cast<uint32_t>(_segments.size());
+        _segments.emplace_back(Segment{
+            a.location.x, a.location.y,
+            b.location.x, b.location.y,
+            0.5f * (a.location.z + b.location.z),
+            i,
+            a.mark});
+        values.emplace_back(Box{
+            Point{std::min(a.location.x, b.location.x), std::min(a.location.y, b.location.y)},
+            Point{std::max(a.location.x, b.location.x), std::max(a.location.y, b.location.y)}},
+            index);
+      }
+    }
+    // The range constructor uses the packing algorithm, much faster than
+    // inserting the values one by one.
+    _rtree = decltype(_rtree)(values.begin(), values.end());
+  }
+
+  std::vector<LaneMarking> LaneMarkingIndex::CalculateCrossedLanes(
+      const geom::Location &origin,
+      const geom::Location &destination) const {
+    const Box query{
+        Point{std::min(origin.x, destination.x), std::min(origin.y, destination.y)},
+        Point{std::max(origin.x, destination.x), std::max(origin.y, destination.y)}};
+    const float z = 0.5f * (origin.z + destination.z);
+
+    std::vector<std::pair<float, const Segment *>> crossings;
+    _rtree.query(bgi::intersects(query), boost::make_function_output_iterator([&](const Value &value) {
+      const auto &segment = _segments[value.second];
+      float t;
+      if ((std::abs(segment.z - z) <= MAX_HEIGHT_DIFFERENCE) &&
+          IntersectSegments(
+              origin.x, origin.y, destination.x, destination.y,
+              segment.x0, segment.y0, segment.x1, segment.y1,
+              t)) {
+        crossings.emplace_back(t, &segment);
+      }
+    }));
+
+    std::sort(crossings.begin(), crossings.end(), [](const auto &lhs, const auto &rhs) {
+      return lhs.first < rhs.first;
+    });
+
+    // Crossing a polyline at a vertex hits both segments, report it once.
+    std::vector<LaneMarking> result;
+    std::vector<uint32_t> crossed_borders;
+    for (const auto &crossing : crossings) {
+      const auto border = crossing.second->border;
+      if (std::find(crossed_borders.begin(), crossed_borders.end(), border) == crossed_borders.end()) {
+        crossed_borders.emplace_back(border);
+        result.emplace_back(*crossing.second->mark);
+      }
+    }
+    return result;
+  }
+
+} // namespace element
+} // namespace road
+} // namespace carla
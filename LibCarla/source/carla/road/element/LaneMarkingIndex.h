@@ -0,0 +1,77 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/road/element/LaneMarking.h"
+
+#include <boost/geometry/geometries/box.hpp>
+#include <boost/geometry/geometries/point.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace geom { class Location; }
+namespace road {
+
+  class Map;
+
+namespace element {
+
+  class RoadInfoMarkRecord;
+
+  /// Spatial index of the lane markings of a map. The borders of the driving
+  /// lanes out of junctions are sampled into polylines, and their segments are
+  /// stored in an R-tree so the markings crossed by a motion are found by
+  /// intersecting segments instead of projecting waypoints onto the road.
+  ///
+  /// Same markings as LaneCrossingCalculator, but the lane sections do not
+  /// need to match and a crossing is never missed because the motion ends in
+  /// the middle of a lane.
+  class LaneMarkingIndex : private MovableNonCopyable {
+  public:
+
+    /// Samples the lane borders of @a map every @a sampling_distance meters.
+    explicit LaneMarkingIndex(const Map &map, double sampling_distance = 1.0);
+
+    /// Return the lane markings crossed moving from @a origin to
+    /// @a destination, in the order they are crossed.
+    std::vector<LaneMarking> CalculateCrossedLanes(
+        const geom::Location &origin,
+        const geom::Location &destination) const;
+
+    size_t GetNumberOfSegments() const {
+      return _segments.size();
+    }
+
+  private:
+
+    struct Segment {
+      float x0, y0;
+      float x1, y1;
+      float z;
+      /// Index of the lane border this segment belongs to.
+      uint32_t border;
+      const RoadInfoMarkRecord *mark;
+    };
+
+    using Point = boost::geometry::model::point<float, 2u, boost::geometry::cs::cartesian>;
+
+    using Box = boost::geometry::model::box<Point>;
+
+    using Value = std::pair<Box, uint32_t>;
+
+    std::vector<Segment> _segments;
+
+    boost::geometry::index::rtree<Value, boost::geometry::index::rstar<16u>> _rtree;
+  };
+
+} // namespace element
+} // namespace road
+} // namespace carla
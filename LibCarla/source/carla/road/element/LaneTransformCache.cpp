@@ -0,0 +1,149 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/element/LaneTransformCache.h"
+
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+#include "carla/geom/Math.h"
+#include "carla/road/Map.h"
+#include "carla/road/element/RoadInfoGeometry.h"
+#include "carla/road/element/RoadInfoLaneOffset.h"
+#include "carla/road/element/RoadInfoLaneWidth.h"
+
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+
+namespace carla {
+namespace road {
+namespace element {
+
+  /// Interpolates the angles in degrees @a a and @a b the shortest way
+  /// around.
+  static float LerpAngle(const float a, const float b, const float t) {
+    auto delta = b - a;
+    if (delta > 180.0f) {
+      delta -= 360.0f;
+    } else if (delta < -180.0f) {
+      delta += 360.0f;
+    }
+    return a + t * delta;
+  }
+
+  size_t LaneTransformCache::LaneKeyHash::operator()(const LaneKey &key) const {
+    size_t seed = 0u;
+    boost::hash_combine(seed, std::get<0>(key));
+    boost::hash_combine(seed, std::get<1>(key));
+    boost::hash_combine(seed, std::get<2>(key));
+    return seed;
+  }
+
+  LaneTransformCache::LaneTransformCache(const Map &map, const double resolution)
+    : _map(map),
+      _resolution(resolution) {
+    if (!(_resolution > 0.0)) {
+      throw_exception(std::invalid_argument("resolution must be positive"));
+    }
+  }
+
+  LaneTransformCache::~LaneTransformCache() = default;
+
+  geom::Transform LaneTransformCache::ComputeTransform(const Waypoint &waypoint) const {
+    const auto &samples = GetLaneSamples(waypoint);
+    const auto &transforms = samples.transforms;
+    DEBUG_ASSERT(!transforms.empty());
+    DEBUG_ASSERT(transforms.size() == samples.s.size());
+    if (transforms.size() == 1u) {
+      return transforms.front();
+    }
+    const auto it = std::upper_bound(samples.s.begin(), samples.s.end(), waypoint.s);
+    const auto i = static_cast<size_t>(geom::Math::Clamp<std::ptrdiff_t>(
+        std::distance(samples.s.begin(), it) - 1,
+        0,
+        static_cast<std::ptrdiff_t>(transforms.size()) - 2));
+    const auto alpha = static_cast<float>(geom::Math::Clamp(
+        (waypoint.s - samples.s[i]) / (samples.s[i + 1u] - samples.s[i])));
+
+    const auto &a = transforms[i];
+    const auto &b = transforms[i + 1u];
+    auto location = a.location;
+    location += geom::Location(alpha * (b.location - a.location));
+    return geom::Transform{
+        location,
+        geom::Rotation{
+            LerpAngle(a.rotation.pitch, b.rotation.pitch, alpha),
+            LerpAngle(a.rotation.yaw, b.rotation.yaw, alpha),
+            LerpAngle(a.rotation.roll, b.rotation.roll, alpha)}};
+  }
+
+  size_t LaneTransformCache::GetNumberOfSamples() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _number_of_samples;
+  }
+
+  const LaneTransformCache::LaneSamples &LaneTransformCache::GetLaneSamples(
+      const Waypoint &waypoint) const {
+    const LaneKey key{waypoint.road_id, waypoint.section_id, waypoint.lane_id};
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _lanes.find(key);
+    if (it != _lanes.end()) {
+      return *it->second;
+    }
+
+    const auto &lane = _map.GetLane(waypoint);
+    const auto *road = lane.GetRoad();
+    DEBUG_ASSERT(road != nullptr);
+
+    const double start = lane.GetDistance();
+    const double end = std::min(start + lane.GetLength(), road->GetLength());
+
+    // The lane center may turn sharply where a record starts, there must be
+    // a sample there.
+    std::vector<double> breaks = {start, end};
+    auto add_breaks = [&](const auto &infos) {
+      for (const auto *info : infos) {
+        if ((info->GetDistance() > start) && (info->GetDistance() < end)) {
+          breaks.emplace_back(info->GetDistance());
+        }
+      }
+    };
+    add_breaks(road->GetInfos<RoadInfoGeometry>());
+    add_breaks(road->GetInfos<RoadInfoLaneOffset>());
+    for (const auto &pair : lane.GetLaneSection()->GetLanes()) {
+      add_breaks(pair.second.GetInfos<RoadInfoLaneWidth>());
+    }
+    std::sort(breaks.begin(), breaks.end());
+    breaks.erase(std::unique(breaks.begin(), breaks.end()), breaks.end());
+
+    auto samples = std::make_unique<LaneSamples>();
+    Waypoint sample = waypoint;
+    auto add_sample = [&](const double s) {
+      sample.s = s;
+      samples->s.emplace_back(s);
+      samples->transforms.emplace_back(_map.ComputeTransform(sample));
+    };
+    add_sample(breaks.front());
+    for (size_t i = 1u; i < breaks.size(); ++i) {
+      const double length = breaks[i] - breaks[i - 1u];
+      const auto count = std::max<size_t>(1u, static_cast<size_t>(std::ceil(length / _resolution)));
+      for (size_t j = 1u; j < count; ++j) {
+        add_sample(breaks[i - 1u] + length * static_cast<double>(j) / static_cast<double>(count));
+      }
+      add_sample(breaks[i]);
+    }
+    _number_of_samples += samples->transforms.size();
+
+    it = _lanes.emplace(key, std::move(samples)).first;
+    return *it->second;
+  }
+
+} // namespace element
+} // namespace road
+} // namespace carla
@@ -0,0 +1,83 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/geom/Transform.h"
+#include "carla/road/RoadTypes.h"
+#include "carla/road/element/Waypoint.h"
+
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  class Map;
+
+namespace element {
+
+  /// Transforms of the center of the lanes of a map sampled every
+  /// @a resolution meters. The samples of a lane are computed the first time
+  /// a transform on it is requested, and the transforms in between samples
+  /// are interpolated, so the geometry and the lane widths are evaluated once
+  /// per sample instead of once per call. There is always a sample where a
+  /// geometry, lane offset or lane width record starts, the lane center may
+  /// turn sharply there.
+  ///
+  /// The error is below a centimeter on curves of radius above
+  /// 12.5 * resolution^2 meters. Thread-safe.
+  class LaneTransformCache : private NonCopyable {
+  public:
+
+    explicit LaneTransformCache(const Map &map, double resolution = 0.5);
+
+    ~LaneTransformCache();
+
+    double GetResolution() const {
+      return _resolution;
+    }
+
+    /// Same as Map::ComputeTransform, interpolated between the samples of
+    /// the lane of @a waypoint.
+    geom::Transform ComputeTransform(const Waypoint &waypoint) const;
+
+    /// Number of samples computed so far.
+    size_t GetNumberOfSamples() const;
+
+  private:
+
+    struct LaneSamples {
+      std::vector<double> s;
+      std::vector<geom::Transform> transforms;
+    };
+
+    using LaneKey = std::tuple<RoadId, SectionId, LaneId>;
+
+    struct LaneKeyHash {
+      size_t operator()(const LaneKey &key) const;
+    };
+
+    const LaneSamples &GetLaneSamples(const Waypoint &waypoint) const;
+
+    const Map &_map;
+
+    const double _resolution;
+
+    mutable std::mutex _mutex;
+
+    mutable std::unordered_map<LaneKey, std::unique_ptr<const LaneSamples>, LaneKeyHash> _lanes;
+
+    mutable size_t _number_of_samples = 0u;
+  };
+
+} // namespace element
+} // namespace road
+} // namespace carla
@@ -13,6 +13,9 @@
 
 namespace carla {
 namespace road {
+
+  class CompiledMap;
+
 namespace general {
 
   class Validity : private MovableNonCopyable {
@@ -28,6 +31,8 @@ namespace general {
 
   private:
 
+    friend road::CompiledMap;
+
 #if defined(__clang__)
 #  pragma clang diagnostic push
 #  pragma clang diagnostic ignored "-Wunused-private-field"
@@ -15,6 +15,9 @@
 
 namespace carla {
 namespace road {
+
+  class CompiledMap;
+
 namespace signal {
 
   class SignalDependency : private MovableNonCopyable {
@@ -32,6 +35,8 @@ namespace signal {
 
   private:
 
+    friend road::CompiledMap;
+
 #if defined(__clang__)
 #  pragma clang diagnostic push
 #  pragma clang diagnostic ignored "-Wunused-private-field"
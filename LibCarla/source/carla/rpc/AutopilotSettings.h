@@ -0,0 +1,76 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+
+#ifdef LIBCARLA_INCLUDED_FROM_UE4
+#  include "Carla/Vehicle/AutopilotSettings.h"
+#endif // LIBCARLA_INCLUDED_FROM_UE4
+
+namespace carla {
+namespace rpc {
+
+  /// Settings of the autopilot run by the simulator, shared by every vehicle
+  /// with the autopilot enabled.
+  class AutopilotSettings {
+  public:
+
+    AutopilotSettings() = default;
+
+    AutopilotSettings(
+        float in_speed_limit_percentage,
+        float in_obstacle_distance_factor,
+        bool in_respect_traffic_lights)
+      : speed_limit_percentage(in_speed_limit_percentage),
+        obstacle_distance_factor(in_obstacle_distance_factor),
+        respect_traffic_lights(in_respect_traffic_lights) {}
+
+    /// Speed targeted, as a percentage of the speed limit of each vehicle.
+    float speed_limit_percentage = 100.0f;
+
+    /// Scale of the distance ahead the vehicles look for obstacles.
+    float obstacle_distance_factor = 1.0f;
+
+    bool respect_traffic_lights = true;
+
+#ifdef LIBCARLA_INCLUDED_FROM_UE4
+
+    AutopilotSettings(const FAutopilotSettings &Settings)
+      : speed_limit_percentage(Settings.SpeedLimitPercentage),
+        obstacle_distance_factor(Settings.ObstacleDistanceFactor),
+        respect_traffic_lights(Settings.bRespectTrafficLights) {}
+
+    operator FAutopilotSettings() const {
+      FAutopilotSettings Settings;
+      Settings.SpeedLimitPercentage = speed_limit_percentage;
+      Settings.ObstacleDistanceFactor = obstacle_distance_factor;
+      Settings.bRespectTrafficLights = respect_traffic_lights;
+      return Settings;
+    }
+
+#endif // LIBCARLA_INCLUDED_FROM_UE4
+
+    bool operator!=(const AutopilotSettings &rhs) const {
+      return
+          speed_limit_percentage != rhs.speed_limit_percentage ||
+          obstacle_distance_factor != rhs.obstacle_distance_factor ||
+          respect_traffic_lights != rhs.respect_traffic_lights;
+    }
+
+    bool operator==(const AutopilotSettings &rhs) const {
+      return !(*this != rhs);
+    }
+
+    MSGPACK_DEFINE_ARRAY(
+        speed_limit_percentage,
+        obstacle_distance_factor,
+        respect_traffic_lights);
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -33,6 +33,12 @@ namespace rpc {
       return _client.call(function, Metadata::MakeSync(), std::forward<Args>(args)...);
     }
 
+    /// Same as call but returns a future instead of waiting for the response.
+    template <typename... Args>
+    auto call_async(const std::string &function, Args &&... args) {
+      return _client.async_call(function, Metadata::MakeSync(), std::forward<Args>(args)...);
+    }
+
     template <typename... Args>
     void async_call(const std::string &function, Args &&... args) {
       _client.async_call(function, Metadata::MakeAsync(), std::forward<Args>(args)...);
@@ -11,6 +11,7 @@
 #include "carla/geom/Transform.h"
 #include "carla/rpc/ActorDescription.h"
 #include "carla/rpc/ActorId.h"
+#include "carla/rpc/TrafficLightState.h"
 #include "carla/rpc/VehicleControl.h"
 #include "carla/rpc/WalkerControl.h"
 
@@ -144,6 +145,40 @@ namespace rpc {
       MSGPACK_DEFINE_ARRAY(actor, enabled);
     };
 
+    struct SetTrafficLightState : CommandBase<SetTrafficLightState> {
+      SetTrafficLightState() = default;
+      SetTrafficLightState(ActorId id, TrafficLightState value)
+        : actor(id),
+          state(value) {}
+      ActorId actor;
+      TrafficLightState state;
+      MSGPACK_DEFINE_ARRAY(actor, state);
+    };
+
+    struct SetTrafficLightTimes : CommandBase<SetTrafficLightTimes> {
+      SetTrafficLightTimes() = default;
+      SetTrafficLightTimes(ActorId id, float green, float yellow, float red)
+        : actor(id),
+          green_time(green),
+          yellow_time(yellow),
+          red_time(red) {}
+      ActorId actor;
+      float green_time;
+      float yellow_time;
+      float red_time;
+      MSGPACK_DEFINE_ARRAY(actor, green_time, yellow_time, red_time);
+    };
+
+    struct FreezeTrafficLight : CommandBase<FreezeTrafficLight> {
+      FreezeTrafficLight() = default;
+      FreezeTrafficLight(ActorId id, bool value)
+        : actor(id),
+          freeze(value) {}
+      ActorId actor;
+      bool freeze;
+      MSGPACK_DEFINE_ARRAY(actor, freeze);
+    };
+
     using CommandType = boost::variant<
         SpawnActor,
         DestroyActor,
@@ -155,7 +190,10 @@ namespace rpc {
         ApplyAngularVelocity,
         ApplyImpulse,
         SetSimulatePhysics,
-        SetAutopilot>;
+        SetAutopilot,
+        SetTrafficLightState,
+        SetTrafficLightTimes,
+        FreezeTrafficLight>;
 
     CommandType command;
 
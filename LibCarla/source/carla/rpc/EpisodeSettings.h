@@ -31,7 +31,68 @@ namespace rpc {
 
     boost::optional<double> fixed_delta_seconds;
 
-    MSGPACK_DEFINE_ARRAY(synchronous_mode, no_rendering_mode, fixed_delta_seconds);
+    /// Whether the pedestrians started by a WalkerAIController are moved by
+    /// the navigation of the server instead of the one of the client.
+    bool server_side_navigation = false;
+
+    /// Distance in meters from the nearest hero vehicle beyond which vehicles
+    /// are moved by a simplified kinematic model instead of the full physics
+    /// simulation, zero to always simulate them fully.
+    double physics_lod_distance = 0.0;
+
+    /// Maximum number of destroyed vehicles and walkers of each blueprint kept
+    /// deactivated by the server to reuse them on the next spawns, zero to
+    /// destroy them.
+    uint32_t actor_pool_size = 0u;
+
+    /// Distance in meters from the nearest hero vehicle within which the tiles
+    /// of a tiled map are streamed in, zero to keep every tile loaded.
+    double tile_streaming_distance = 0.0;
+
+    /// Whether the server skips rendering the spectator viewport and the HUD,
+    /// the camera sensors keep rendering. Ignored if no_rendering_mode is set.
+    bool no_viewport_rendering = false;
+
+    /// Distance in meters from the nearest camera or the spectator beyond
+    /// which the animation of the walkers is updated at a lower rate, the
+    /// lower the farther, zero to animate them every frame.
+    double walker_animation_lod_distance = 0.0;
+
+    /// Distance in meters from the nearest camera or the spectator beyond
+    /// which the pose of the walkers is frozen, zero to never freeze it.
+    double walker_animation_freeze_distance = 0.0;
+
+    /// Whether the physics step of each frame is split in substeps of at
+    /// most max_substep_delta_time seconds.
+    bool substepping = true;
+
+    /// Maximum duration of a physics substep in seconds.
+    double max_substep_delta_time = 1.0 / 60.0;
+
+    /// Maximum number of physics substeps per frame, if the frame is longer
+    /// than max_substeps * max_substep_delta_time the substeps are longer.
+    int32_t max_substeps = 6;
+
+    /// Whether the asynchronous physics scene is substepped too, if the
+    /// project enables it. Its bodies are simulated independently from the
+    /// frame rendered.
+    bool async_physics_scene = false;
+
+    MSGPACK_DEFINE_ARRAY(
+        synchronous_mode,
+        no_rendering_mode,
+        fixed_delta_seconds,
+        server_side_navigation,
+        physics_lod_distance,
+        actor_pool_size,
+        tile_streaming_distance,
+        no_viewport_rendering,
+        walker_animation_lod_distance,
+        walker_animation_freeze_distance,
+        substepping,
+        max_substep_delta_time,
+        max_substeps,
+        async_physics_scene);
 
     // =========================================================================
     // -- Constructors ---------------------------------------------------------
@@ -42,11 +103,35 @@ namespace rpc {
     EpisodeSettings(
         bool synchronous_mode,
         bool no_rendering_mode,
-        double fixed_delta_seconds = 0.0)
+        double fixed_delta_seconds = 0.0,
+        bool server_side_navigation = false,
+        double physics_lod_distance = 0.0,
+        uint32_t actor_pool_size = 0u,
+        double tile_streaming_distance = 0.0,
+        bool no_viewport_rendering = false,
+        double walker_animation_lod_distance = 0.0,
+        double walker_animation_freeze_distance = 0.0,
+        bool substepping = true,
+        double max_substep_delta_time = 1.0 / 60.0,
+        int32_t max_substeps = 6,
+        bool async_physics_scene = false)
       : synchronous_mode(synchronous_mode),
         no_rendering_mode(no_rendering_mode),
         fixed_delta_seconds(
-            fixed_delta_seconds > 0.0 ? fixed_delta_seconds : boost::optional<double>{}) {}
+            fixed_delta_seconds > 0.0 ? fixed_delta_seconds : boost::optional<double>{}),
+        server_side_navigation(server_side_navigation),
+        physics_lod_distance(physics_lod_distance > 0.0 ? physics_lod_distance : 0.0),
+        actor_pool_size(actor_pool_size),
+        tile_streaming_distance(tile_streaming_distance > 0.0 ? tile_streaming_distance : 0.0),
+        no_viewport_rendering(no_viewport_rendering),
+        walker_animation_lod_distance(
+            walker_animation_lod_distance > 0.0 ? walker_animation_lod_distance : 0.0),
+        walker_animation_freeze_distance(
+            walker_animation_freeze_distance > 0.0 ? walker_animation_freeze_distance : 0.0),
+        substepping(substepping),
+        max_substep_delta_time(max_substep_delta_time),
+        max_substeps(max_substeps),
+        async_physics_scene(async_physics_scene) {}
 
     // =========================================================================
     // -- Comparison operators -------------------------------------------------
@@ -56,7 +141,18 @@ namespace rpc {
       return
           (synchronous_mode == rhs.synchronous_mode) &&
           (no_rendering_mode == rhs.no_rendering_mode) &&
-          (fixed_delta_seconds == rhs.fixed_delta_seconds);
+          (fixed_delta_seconds == rhs.fixed_delta_seconds) &&
+          (server_side_navigation == rhs.server_side_navigation) &&
+          (physics_lod_distance == rhs.physics_lod_distance) &&
+          (actor_pool_size == rhs.actor_pool_size) &&
+          (tile_streaming_distance == rhs.tile_streaming_distance) &&
+          (no_viewport_rendering == rhs.no_viewport_rendering) &&
+          (walker_animation_lod_distance == rhs.walker_animation_lod_distance) &&
+          (walker_animation_freeze_distance == rhs.walker_animation_freeze_distance) &&
+          (substepping == rhs.substepping) &&
+          (max_substep_delta_time == rhs.max_substep_delta_time) &&
+          (max_substeps == rhs.max_substeps) &&
+          (async_physics_scene == rhs.async_physics_scene);
     }
 
     bool operator!=(const EpisodeSettings &rhs) const {
@@ -73,7 +169,18 @@ namespace rpc {
       : EpisodeSettings(
             Settings.bSynchronousMode,
             Settings.bNoRenderingMode,
-            Settings.FixedDeltaSeconds.Get(0.0)) {}
+            Settings.FixedDeltaSeconds.Get(0.0),
+            Settings.bServerSideNavigation,
+            Settings.PhysicsLODDistance,
+            Settings.ActorPoolSize > 0 ? static_cast<uint32_t>(Settings.ActorPoolSize) : 0u,
+            Settings.TileStreamingDistance,
+            Settings.bNoViewportRendering,
+            Settings.WalkerAnimationLODDistance,
+            Settings.WalkerAnimationFreezeDistance,
+            Settings.bSubstepping,
+            Settings.MaxSubstepDeltaTime,
+            Settings.MaxSubsteps,
+            Settings.bAsyncPhysicsScene) {}
 
     operator FEpisodeSettings() const {
       FEpisodeSettings Settings;
@@ -82,6 +189,17 @@ namespace rpc {
       if (fixed_delta_seconds.has_value()) {
         Settings.FixedDeltaSeconds = *fixed_delta_seconds;
       }
+      Settings.bServerSideNavigation = server_side_navigation;
+      Settings.PhysicsLODDistance = static_cast<float>(physics_lod_distance);
+      Settings.ActorPoolSize = static_cast<int32>(actor_pool_size);
+      Settings.TileStreamingDistance = static_cast<float>(tile_streaming_distance);
+      Settings.bNoViewportRendering = no_viewport_rendering;
+      Settings.WalkerAnimationLODDistance = static_cast<float>(walker_animation_lod_distance);
+      Settings.WalkerAnimationFreezeDistance = static_cast<float>(walker_animation_freeze_distance);
+      Settings.bSubstepping = substepping;
+      Settings.MaxSubstepDeltaTime = static_cast<float>(max_substep_delta_time);
+      Settings.MaxSubsteps = max_substeps;
+      Settings.bAsyncPhysicsScene = async_physics_scene;
       return Settings;
     }
 
@@ -0,0 +1,50 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/ActorId.h"
+
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// Selects the actors sent by a filtered episode state stream. An actor is
+  /// sent if it passes every criterion set; the criteria left empty let every
+  /// actor through.
+  class EpisodeStateFilter {
+  public:
+
+    /// Only these actors, if not empty.
+    std::vector<ActorId> actor_ids;
+
+    /// Wildcard patterns of the types sent, e.g. "vehicle.*". If empty, every
+    /// type is sent.
+    std::vector<std::string> type_patterns;
+
+    /// Actor the radius is measured from, always sent itself.
+    ActorId center_actor_id = 0u;
+
+    /// Only the actors closer than this many meters to center_actor_id, if
+    /// greater than zero.
+    float radius = 0.0f;
+
+    bool IsEmpty() const {
+      return actor_ids.empty() && type_patterns.empty() && (radius <= 0.0f);
+    }
+
+    MSGPACK_DEFINE_ARRAY(
+        actor_ids,
+        type_patterns,
+        center_actor_id,
+        radius);
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -0,0 +1,69 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+
+#include <cstdint>
+#include <string>
+
+namespace carla {
+namespace rpc {
+
+  enum class MapLoadState : uint8_t {
+    /// No map being loaded, the last one requested is the current one.
+    Idle,
+
+    /// The map and its preloaded assets are being loaded in the background,
+    /// the current episode keeps running.
+    Loading,
+
+    /// Everything is in memory, the level is being opened. The new episode
+    /// starts in the next frames.
+    Opening,
+
+    /// The map could not be loaded, the current episode is kept.
+    Failed
+  };
+
+  /// Progress of the map requested with an asynchronous load.
+  class MapLoadProgress {
+  public:
+
+    std::string map_name;
+
+    MapLoadState state = MapLoadState::Idle;
+
+    /// Fraction of the map and of the preloaded assets loaded, from 0 to 1.
+    float progress = 0.0f;
+
+    /// Assets of the preload list loaded, and their total.
+    uint32_t preloaded_assets = 0u;
+
+    uint32_t total_preload_assets = 0u;
+
+    /// Since the load was requested.
+    double elapsed_seconds = 0.0;
+
+    /// Id of the episode the load was requested in, the load is finished
+    /// once the current episode has a different one.
+    uint64_t previous_episode_id = 0u;
+
+    MSGPACK_DEFINE_ARRAY(
+        map_name,
+        state,
+        progress,
+        preloaded_assets,
+        total_preload_assets,
+        elapsed_seconds,
+        previous_episode_id);
+  };
+
+} // namespace rpc
+} // namespace carla
+
+MSGPACK_ADD_ENUM(carla::rpc::MapLoadState);
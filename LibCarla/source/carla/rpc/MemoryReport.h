@@ -0,0 +1,77 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MemoryAccounting.h"
+#include "carla/MsgPack.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// Memory used by a subsystem.
+  class MemoryUsage {
+  public:
+
+    MemoryUsage() = default;
+
+    MemoryUsage(std::string in_name, uint64_t in_bytes, uint64_t in_allocations = 0u, uint64_t in_peak_bytes = 0u)
+      : name(std::move(in_name)),
+        bytes(in_bytes),
+        allocations(in_allocations),
+        peak_bytes(in_peak_bytes) {}
+
+    std::string name;
+
+    uint64_t bytes = 0u;
+
+    /// Number of allocations or objects the bytes are made of, zero if not
+    /// counted.
+    uint64_t allocations = 0u;
+
+    /// Highest number of bytes at once, zero if not tracked.
+    uint64_t peak_bytes = 0u;
+
+    MSGPACK_DEFINE_ARRAY(name, bytes, allocations, peak_bytes);
+  };
+
+  /// Memory of a process by subsystem. The subsystems may overlap, e.g.
+  /// queued messages are made of buffers, and don't add up to the resident
+  /// memory of the process.
+  class MemoryReport {
+  public:
+
+    std::vector<MemoryUsage> subsystems;
+
+    /// Resident memory of the process, zero if unknown.
+    uint64_t resident_bytes = 0u;
+
+    /// Report of the subsystems accounted by MemoryAccounting in this
+    /// process.
+    static MemoryReport Make() {
+      MemoryReport report;
+      for (auto i = 0u; i < static_cast<uint32_t>(MemoryTag::SIZE); ++i) {
+        const auto tag = static_cast<MemoryTag>(i);
+        const auto usage = MemoryAccounting::GetUsage(tag);
+        report.subsystems.emplace_back(
+            MemoryAccounting::GetName(tag),
+            usage.bytes,
+            usage.allocations,
+            usage.peak_bytes);
+      }
+      report.resident_bytes = MemoryAccounting::GetResidentBytes();
+      return report;
+    }
+
+    MSGPACK_DEFINE_ARRAY(subsystems, resident_bytes);
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -0,0 +1,42 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace carla {
+namespace rpc {
+
+  /// Describes the navigation mesh of the current map without sending it, so
+  /// clients can tell whether the copy in their cache is still valid.
+  class NavigationMeshInfo {
+  public:
+
+    std::string map_name;
+
+    /// Hash of the navigation mesh contents, zero if the map has none.
+    uint64_t hash = 0u;
+
+    /// FNV-1a, its value does not depend on the platform.
+    static uint64_t Hash(const uint8_t *data, size_t size) {
+      uint64_t result = 14695981039346656037ull;
+      for (size_t i = 0u; i < size; ++i) {
+        result ^= data[i];
+        result *= 1099511628211ull;
+      }
+      return result;
+    }
+
+    MSGPACK_DEFINE_ARRAY(map_name, hash);
+  };
+
+} // namespace rpc
+} // namespace carla
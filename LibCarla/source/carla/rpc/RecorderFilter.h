@@ -0,0 +1,52 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/ActorId.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// Selects which actors the recorder samples, and how often. Only the
+  /// positions, animations and traffic light states are filtered, the events
+  /// and collisions are always recorded.
+  class RecorderFilter {
+  public:
+
+    /// Actors recorded on every frame regardless of the sampling divisors,
+    /// e.g. the ego vehicles. Actors with role name "hero" are always
+    /// recorded on every frame too.
+    std::vector<ActorId> actor_ids;
+
+    /// Wildcard patterns of the types recorded, e.g. "vehicle.*". If empty,
+    /// every type is recorded.
+    std::vector<std::string> type_patterns;
+
+    /// Record the vehicles once every this number of frames.
+    uint32_t vehicle_divisor = 1u;
+
+    /// Record the walkers once every this number of frames.
+    uint32_t walker_divisor = 1u;
+
+    /// Record the traffic lights once every this number of frames.
+    uint32_t traffic_light_divisor = 1u;
+
+    MSGPACK_DEFINE_ARRAY(
+        actor_ids,
+        type_patterns,
+        vehicle_divisor,
+        walker_divisor,
+        traffic_light_divisor);
+  };
+
+} // namespace rpc
+} // namespace carla
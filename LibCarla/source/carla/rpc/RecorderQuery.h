@@ -0,0 +1,185 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/rpc/Location.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  // ===========================================================================
+  // -- File info --------------------------------------------------------------
+  // ===========================================================================
+
+  /// Actor created during a recording.
+  class RecorderActor {
+  public:
+
+    ActorId id = 0u;
+
+    /// Type of actor: 0 other, 1 vehicle, 2 walker, 3 traffic light.
+    uint8_t type = 0u;
+
+    /// Blueprint id, e.g. "vehicle.tesla.model3".
+    std::string description;
+
+    Location location;
+
+    /// Pairs of attribute id and value.
+    std::vector<std::pair<std::string, std::string>> attributes;
+
+    MSGPACK_DEFINE_ARRAY(id, type, description, location, attributes);
+  };
+
+  class RecorderParenting {
+  public:
+
+    ActorId id = 0u;
+
+    ActorId parent_id = 0u;
+
+    MSGPACK_DEFINE_ARRAY(id, parent_id);
+  };
+
+  class RecorderFrameCollision {
+  public:
+
+    uint32_t id = 0u;
+
+    ActorId actor_id1 = 0u;
+
+    ActorId actor_id2 = 0u;
+
+    bool is_actor1_hero = false;
+
+    bool is_actor2_hero = false;
+
+    MSGPACK_DEFINE_ARRAY(id, actor_id1, actor_id2, is_actor1_hero, is_actor2_hero);
+  };
+
+  /// Events of a frame, only frames with events are reported.
+  class RecorderFrameEvents {
+  public:
+
+    uint64_t frame = 0u;
+
+    double elapsed = 0.0;
+
+    std::vector<RecorderActor> created;
+
+    std::vector<ActorId> destroyed;
+
+    std::vector<RecorderParenting> parented;
+
+    std::vector<RecorderFrameCollision> collisions;
+
+    MSGPACK_DEFINE_ARRAY(frame, elapsed, created, destroyed, parented, collisions);
+  };
+
+  class RecorderFileInfo {
+  public:
+
+    uint16_t version = 0u;
+
+    std::string map;
+
+    /// Date of the recording as a Unix timestamp.
+    int64_t date = 0;
+
+    /// Number of the last frame.
+    uint64_t frames = 0u;
+
+    /// Duration of the recording in seconds.
+    double duration = 0.0;
+
+    std::vector<RecorderFrameEvents> events;
+
+    MSGPACK_DEFINE_ARRAY(version, map, date, frames, duration, events);
+  };
+
+  // ===========================================================================
+  // -- Collisions -------------------------------------------------------------
+  // ===========================================================================
+
+  /// Start of a collision between two actors.
+  class RecorderCollisionInfo {
+  public:
+
+    /// Simulation time in seconds.
+    double time = 0.0;
+
+    /// Category of each actor: 'o' other, 'v' vehicle, 'w' walker, 't' traffic
+    /// light.
+    char type1 = 'o';
+
+    char type2 = 'o';
+
+    ActorId actor_id1 = 0u;
+
+    std::string actor1;
+
+    ActorId actor_id2 = 0u;
+
+    std::string actor2;
+
+    MSGPACK_DEFINE_ARRAY(time, type1, type2, actor_id1, actor1, actor_id2, actor2);
+  };
+
+  class RecorderCollisions {
+  public:
+
+    uint64_t frames = 0u;
+
+    double duration = 0.0;
+
+    std::vector<RecorderCollisionInfo> collisions;
+
+    MSGPACK_DEFINE_ARRAY(frames, duration, collisions);
+  };
+
+  // ===========================================================================
+  // -- Blocked actors ---------------------------------------------------------
+  // ===========================================================================
+
+  class RecorderBlockedActor {
+  public:
+
+    /// Simulation time when the actor stopped, in seconds.
+    double time = 0.0;
+
+    ActorId actor_id = 0u;
+
+    std::string actor;
+
+    /// Time the actor was stopped in seconds.
+    double duration = 0.0;
+
+    MSGPACK_DEFINE_ARRAY(time, actor_id, actor, duration);
+  };
+
+  class RecorderBlockedActors {
+  public:
+
+    uint64_t frames = 0u;
+
+    double duration = 0.0;
+
+    /// Sorted by decreasing duration.
+    std::vector<RecorderBlockedActor> actors;
+
+    MSGPACK_DEFINE_ARRAY(frames, duration, actors);
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -0,0 +1,142 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/MsgPack.h"
+#include "carla/geom/Location.h"
+#include "carla/geom/Rotation.h"
+#include "carla/geom/Vector3D.h"
+#include "carla/rpc/ActorId.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+#pragma pack(push, 1)
+
+  struct RayCast {
+    geom::Location origin;
+    /// Normalized by the server.
+    geom::Vector3D direction;
+  };
+
+  struct RayHit {
+    geom::Location point;
+    geom::Vector3D normal;
+    /// Meters from the origin of the ray.
+    float distance;
+    /// 0 if the object hit is not an actor, like the road.
+    ActorId actor;
+    uint8_t has_hit;
+  };
+
+  struct BoxOverlap {
+    geom::Location center;
+    /// Half the size of the box, in meters.
+    geom::Vector3D extent;
+    geom::Rotation rotation;
+  };
+
+  struct BoxOverlapResult {
+    /// 0 if the box does not overlap any actor.
+    ActorId actor;
+    uint8_t overlaps;
+  };
+
+#pragma pack(pop)
+
+  static_assert(sizeof(RayCast) == 24u, "Invalid RayCast size");
+  static_assert(sizeof(RayHit) == 33u, "Invalid RayHit size");
+  static_assert(sizeof(BoxOverlap) == 36u, "Invalid BoxOverlap size");
+  static_assert(sizeof(BoxOverlapResult) == 5u, "Invalid BoxOverlapResult size");
+
+  /// Scene queries, or their results, packed in a single binary blob. Same
+  /// as TransformBatch, thousands of them cost a single call and decode with
+  /// a copy.
+  template <typename EntryT>
+  class SceneQueryBatch {
+  public:
+
+    using Entry = EntryT;
+
+    void Reserve(size_t number_of_entries) {
+      _data.reserve(number_of_entries * sizeof(Entry));
+    }
+
+    void Add(const Entry &entry) {
+      const auto *begin = reinterpret_cast<const uint8_t *>(&entry);
+      _data.insert(_data.end(), begin, begin + sizeof(Entry));
+    }
+
+    void Clear() {
+      _data.clear();
+    }
+
+    size_t size() const {
+      return _data.size() / sizeof(Entry);
+    }
+
+    bool empty() const {
+      return _data.empty();
+    }
+
+    /// Whether the blob holds a whole number of entries, a batch received
+    /// from the network may not.
+    bool IsValid() const {
+      return (_data.size() % sizeof(Entry)) == 0u;
+    }
+
+    Entry at(size_t index) const {
+      DEBUG_ASSERT(index < size());
+      Entry entry;
+      std::memcpy(&entry, _data.data() + index * sizeof(Entry), sizeof(Entry));
+      return entry;
+    }
+
+    MSGPACK_DEFINE_ARRAY(_data);
+
+  protected:
+
+    std::vector<uint8_t> _data;
+  };
+
+  /// Rays cast against the physics scene of the server, each stops at the
+  /// first object blocking it up to the same maximum distance.
+  class RayCastBatch : public SceneQueryBatch<RayCast> {
+  public:
+
+    explicit RayCastBatch(float max_distance = 0.0f)
+      : _max_distance(max_distance) {}
+
+    /// In meters.
+    float GetMaxDistance() const {
+      return _max_distance;
+    }
+
+    MSGPACK_DEFINE_ARRAY(_max_distance, _data);
+
+  private:
+
+    float _max_distance;
+  };
+
+  /// The hit of each ray of a RayCastBatch, in the same order.
+  using RayHitBatch = SceneQueryBatch<RayHit>;
+
+  /// Oriented boxes tested for overlap against the physics scene of the
+  /// server, e.g. to check whether a region is free before spawning.
+  using BoxOverlapBatch = SceneQueryBatch<BoxOverlap>;
+
+  /// The result of each box of a BoxOverlapBatch, in the same order.
+  using BoxOverlapResultBatch = SceneQueryBatch<BoxOverlapResult>;
+
+} // namespace rpc
+} // namespace carla
@@ -0,0 +1,95 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/ActorId.h"
+
+#include <cstdint>
+#include <string>
+
+namespace carla {
+namespace rpc {
+
+  /// Cost of the data a sensor produced in a frame.
+  class SensorFrameCost {
+  public:
+
+    uint64_t frame = 0u;
+
+    /// CPU time of the tick of the sensor in the game thread.
+    double tick_seconds = 0.0;
+
+    /// CPU time spent mapping and copying the pixels read back from the GPU.
+    double readback_seconds = 0.0;
+
+    /// CPU time spent serializing the data.
+    double serialize_seconds = 0.0;
+
+    /// GPU time of the render commands of the sensor, measured with
+    /// timestamp queries.
+    double gpu_seconds = 0.0;
+
+    /// Size of the messages sent, header included.
+    uint64_t bytes = 0u;
+
+    MSGPACK_DEFINE_ARRAY(
+        frame,
+        tick_seconds,
+        readback_seconds,
+        serialize_seconds,
+        gpu_seconds,
+        bytes);
+  };
+
+  /// Cost counters of a sensor since the sensor metrics of the server were
+  /// enabled, aggregated per frame.
+  class SensorMetrics {
+  public:
+
+    ActorId actor_id = 0u;
+
+    std::string type_id;
+
+    /// Frames the sensor did any work in.
+    uint64_t frames = 0u;
+
+    uint64_t messages = 0u;
+
+    double total_tick_seconds = 0.0;
+
+    double total_readback_seconds = 0.0;
+
+    double total_serialize_seconds = 0.0;
+
+    double total_gpu_seconds = 0.0;
+
+    uint64_t total_bytes = 0u;
+
+    /// Most expensive frame of each kind, i.e. each field is the maximum of
+    /// that field over the frames, not the cost of a single frame.
+    SensorFrameCost max_frame;
+
+    /// Latest frame measured.
+    SensorFrameCost last_frame;
+
+    MSGPACK_DEFINE_ARRAY(
+        actor_id,
+        type_id,
+        frames,
+        messages,
+        total_tick_seconds,
+        total_readback_seconds,
+        total_serialize_seconds,
+        total_gpu_seconds,
+        total_bytes,
+        max_frame,
+        last_frame);
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -7,19 +7,114 @@
 #pragma once
 
 #include "carla/MoveHandler.h"
+#include "carla/ThreadAffinity.h"
 #include "carla/Time.h"
 #include "carla/rpc/Metadata.h"
 #include "carla/rpc/Response.h"
+#include "carla/rpc/ServerMetrics.h"
 
+#include <boost/asio/executor_work_guard.hpp>
 #include <boost/asio/io_context.hpp>
 
 #include <rpc/server.h>
 
+#include <atomic>
+#include <chrono>
 #include <future>
+#include <map>
+#include <memory>
+#include <mutex>
 
 namespace carla {
 namespace rpc {
 
+namespace detail {
+
+  /// Counters of a bound function, updated by its wrapper.
+  class FunctionCounters {
+  public:
+
+    /// Times a call from its construction to its destruction, the call
+    /// counts as failed unless Succeeded is called.
+    class Call {
+    public:
+
+      explicit Call(FunctionCounters &counters)
+        : _counters(counters),
+          _start(std::chrono::steady_clock::now()) {}
+
+      ~Call() {
+        _counters.Record(_start, _failed);
+      }
+
+      void Succeeded(bool succeeded = true) {
+        _failed = !succeeded;
+      }
+
+    private:
+
+      FunctionCounters &_counters;
+
+      const std::chrono::steady_clock::time_point _start;
+
+      bool _failed = true;
+    };
+
+    void RecordWait(std::chrono::steady_clock::time_point posted) {
+      const auto elapsed = ElapsedSince(posted);
+      _total_wait_nanoseconds += elapsed;
+      UpdateMax(_max_wait_nanoseconds, elapsed);
+    }
+
+    FunctionMetrics GetMetrics(std::string name) const {
+      FunctionMetrics metrics;
+      metrics.name = std::move(name);
+      metrics.calls = _calls;
+      metrics.failures = _failures;
+      metrics.total_seconds = 1e-9 * static_cast<double>(_total_nanoseconds.load());
+      metrics.max_seconds = 1e-9 * static_cast<double>(_max_nanoseconds.load());
+      metrics.total_wait_seconds = 1e-9 * static_cast<double>(_total_wait_nanoseconds.load());
+      metrics.max_wait_seconds = 1e-9 * static_cast<double>(_max_wait_nanoseconds.load());
+      return metrics;
+    }
+
+  private:
+
+    static uint64_t ElapsedSince(std::chrono::steady_clock::time_point start) {
+      return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start).count());
+    }
+
+    static void UpdateMax(std::atomic<uint64_t> &max, uint64_t value) {
+      auto current = max.load();
+      while ((value > current) && !max.compare_exchange_weak(current, value));
+    }
+
+    void Record(std::chrono::steady_clock::time_point start, bool failed) {
+      const auto elapsed = ElapsedSince(start);
+      ++_calls;
+      if (failed) {
+        ++_failures;
+      }
+      _total_nanoseconds += elapsed;
+      UpdateMax(_max_nanoseconds, elapsed);
+    }
+
+    std::atomic<uint64_t> _calls{0u};
+
+    std::atomic<uint64_t> _failures{0u};
+
+    std::atomic<uint64_t> _total_nanoseconds{0u};
+
+    std::atomic<uint64_t> _max_nanoseconds{0u};
+
+    std::atomic<uint64_t> _total_wait_nanoseconds{0u};
+
+    std::atomic<uint64_t> _max_wait_nanoseconds{0u};
+  };
+
+} // namespace detail
+
   // ===========================================================================
   // -- Server -----------------------------------------------------------------
   // ===========================================================================
@@ -28,11 +123,15 @@ namespace rpc {
   /// asynchronously.
   ///
   /// Use `AsyncRun` to start the worker threads, and use `SyncRunFor` to
-  /// run a slice of work in the caller's thread.
+  /// run a slice of work in the caller's thread, or `SyncRunUntil` to wait
+  /// in the caller's thread for a given call.
   ///
   /// Functions that are bind using `BindAsync` will run asynchronously in the
   /// worker threads. Functions that are bind using `BindSync` will run within
   /// `SyncRunFor` function.
+  ///
+  /// Every bound function counts its calls and how long they take, see
+  /// GetFunctionMetrics.
   class Server {
   public:
 
@@ -49,20 +148,92 @@ namespace rpc {
       _server.async_run(worker_threads);
     }
 
+    /// Runs the server in @a worker_threads pinned to the CPUs in @a
+    /// cpu_mask, zero leaves them unrestricted.
+    ///
+    /// @note rpclib creates the threads itself, they are pinned by inheriting
+    /// the affinity of the calling thread, hence this only has effect on
+    /// Linux.
+    void AsyncRun(size_t worker_threads, uint64_t cpu_mask) {
+      const auto previous_mask = ThreadAffinity::Get();
+      // Never leave the calling thread pinned if its mask cannot be restored.
+      const bool pinned =
+          (cpu_mask != 0u) &&
+          (previous_mask != 0u) &&
+          ThreadAffinity::Set(cpu_mask);
+      _server.async_run(worker_threads);
+      if (pinned) {
+        ThreadAffinity::Set(previous_mask);
+      }
+    }
+
     void SyncRunFor(time_duration duration) {
       _sync_io_context.reset();
       _sync_io_context.run_for(duration.to_chrono());
     }
 
+    /// Run the tasks posted to the caller's thread as soon as they arrive,
+    /// until @a done returns true or @a timeout expires. Unlike SyncRunFor,
+    /// sleeps while there is nothing to run and returns right after the task
+    /// that made @a done true. Return the last value of @a done.
+    template <typename PredicateT>
+    bool SyncRunUntil(time_duration timeout, PredicateT &&done) {
+      const auto deadline = std::chrono::steady_clock::now() + timeout.to_chrono();
+      _sync_io_context.reset();
+      // Keep waiting for tasks even when none is queued.
+      const auto work = boost::asio::make_work_guard(_sync_io_context);
+      while (!done()) {
+        if (_sync_io_context.run_one_until(deadline) == 0u) {
+          return done();
+        }
+      }
+      return true;
+    }
+
+    /// Run @a functor in the thread running SyncRunFor and wait for its
+    /// result, e.g. from a function bound with BindAsync that cannot answer
+    /// without the game thread.
+    ///
+    /// @warning deadlocks if called from the thread running SyncRunFor.
+    template <typename FunctorT>
+    auto SyncCall(FunctorT &&functor) -> decltype(functor()) {
+      std::packaged_task<decltype(functor())()> task(std::forward<FunctorT>(functor));
+      auto result = task.get_future();
+      _sync_io_context.post(MoveHandler(task));
+      return result.get();
+    }
+
     /// @warning does not stop the game thread.
     void Stop() {
       _server.stop();
     }
 
+    /// Counters of every bound function, sorted by name.
+    std::vector<FunctionMetrics> GetFunctionMetrics() const {
+      std::lock_guard<std::mutex> lock(_counters_mutex);
+      std::vector<FunctionMetrics> result;
+      result.reserve(_counters.size());
+      for (auto &item : _counters) {
+        result.emplace_back(item.second->GetMetrics(item.first));
+      }
+      return result;
+    }
+
   private:
 
+    std::shared_ptr<detail::FunctionCounters> MakeCounters(const std::string &name) {
+      std::lock_guard<std::mutex> lock(_counters_mutex);
+      auto &counters = _counters[name];
+      counters = std::make_shared<detail::FunctionCounters>();
+      return counters;
+    }
+
     boost::asio::io_context _sync_io_context;
 
+    mutable std::mutex _counters_mutex;
+
+    std::map<std::string, std::shared_ptr<detail::FunctionCounters>> _counters;
+
     ::rpc::server _server;
   };
 
@@ -87,6 +258,38 @@ namespace detail {
   template<class T>
   struct FunctionWrapper<T &&> : public FunctionWrapper<T> {};
 
+  template <typename T>
+  static bool IsError(const Response<T> &response) {
+    return response.HasError();
+  }
+
+  template <typename T>
+  static bool IsError(const T &) {
+    return false;
+  }
+
+  /// Calls @a functor and records the call in @a counters.
+  template <typename R>
+  struct RecordedCall {
+    template <typename FuncT, typename... Args>
+    static R Invoke(FunctionCounters &counters, const FuncT &functor, Args &&... args) {
+      FunctionCounters::Call call(counters);
+      R result = functor(std::forward<Args>(args)...);
+      call.Succeeded(!IsError(result));
+      return result;
+    }
+  };
+
+  template <>
+  struct RecordedCall<void> {
+    template <typename FuncT, typename... Args>
+    static void Invoke(FunctionCounters &counters, const FuncT &functor, Args &&... args) {
+      FunctionCounters::Call call(counters);
+      functor(std::forward<Args>(args)...);
+      call.Succeeded();
+    }
+  };
+
   template <typename R, typename... Args>
   struct FunctionWrapper<R (*)(Args...)> {
 
@@ -100,10 +303,15 @@ namespace detail {
     /// I.e., we can use the io_context to run tasks on a specific thread (e.g.
     /// game thread).
     template <typename FuncT>
-    static auto WrapSyncCall(boost::asio::io_context &io, FuncT &&functor) {
-      return [&io, functor=std::forward<FuncT>(functor)](Metadata metadata, Args... args) -> R {
-        auto task = std::packaged_task<R()>([functor=std::move(functor), args...]() {
-          return functor(args...);
+    static auto WrapSyncCall(
+        boost::asio::io_context &io,
+        std::shared_ptr<FunctionCounters> counters,
+        FuncT &&functor) {
+      return [&io, counters, functor=std::forward<FuncT>(functor)](Metadata metadata, Args... args) -> R {
+        const auto posted = std::chrono::steady_clock::now();
+        auto task = std::packaged_task<R()>([counters, functor=std::move(functor), posted, args...]() {
+          counters->RecordWait(posted);
+          return RecordedCall<R>::Invoke(*counters, functor, args...);
         });
         if (metadata.IsResponseIgnored()) {
           // Post task and ignore result.
@@ -122,13 +330,13 @@ namespace detail {
     /// handles the metadata sent by the client. If the client called this
     /// method asynchronously, the result is ignored.
     template <typename FuncT>
-    static auto WrapAsyncCall(FuncT &&functor) {
-      return [functor=std::forward<FuncT>(functor)](::carla::rpc::Metadata metadata, Args... args) -> R {
+    static auto WrapAsyncCall(std::shared_ptr<FunctionCounters> counters, FuncT &&functor) {
+      return [counters, functor=std::forward<FuncT>(functor)](::carla::rpc::Metadata metadata, Args... args) -> R {
         if (metadata.IsResponseIgnored()) {
-          functor(args...);
+          RecordedCall<R>::Invoke(*counters, functor, args...);
           return R();
         } else {
-          return functor(args...);
+          return RecordedCall<R>::Invoke(*counters, functor, args...);
         }
       };
     }
@@ -147,7 +355,7 @@ namespace detail {
     using Wrapper = detail::FunctionWrapper<FunctorT>;
     _server.bind(
         name,
-        Wrapper::WrapSyncCall(_sync_io_context, std::forward<FunctorT>(functor)));
+        Wrapper::WrapSyncCall(_sync_io_context, MakeCounters(name), std::forward<FunctorT>(functor)));
   }
 
   template <typename FunctorT>
@@ -155,7 +363,7 @@ namespace detail {
     using Wrapper = detail::FunctionWrapper<FunctorT>;
     _server.bind(
         name,
-        Wrapper::WrapAsyncCall(std::forward<FunctorT>(functor)));
+        Wrapper::WrapAsyncCall(MakeCounters(name), std::forward<FunctorT>(functor)));
   }
 
 } // namespace rpc
@@ -0,0 +1,152 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/streaming/detail/Types.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// Counters of a function bound to the RPC server, since the server
+  /// started.
+  class FunctionMetrics {
+  public:
+
+    std::string name;
+
+    uint64_t calls = 0u;
+
+    /// Calls that threw or returned an error.
+    uint64_t failures = 0u;
+
+    /// Time spent running the function.
+    double total_seconds = 0.0;
+
+    double max_seconds = 0.0;
+
+    /// Time synchronous functions spent waiting for the game thread to pick
+    /// them up, zero for asynchronous ones.
+    double total_wait_seconds = 0.0;
+
+    double max_wait_seconds = 0.0;
+
+    MSGPACK_DEFINE_ARRAY(
+        name,
+        calls,
+        failures,
+        total_seconds,
+        max_seconds,
+        total_wait_seconds,
+        max_wait_seconds);
+  };
+
+  /// Counters of the send queue of a stream, summed over the clients
+  /// subscribed to it.
+  class StreamMetrics {
+  public:
+
+    StreamMetrics() = default;
+
+    explicit StreamMetrics(const streaming::detail::StreamStats &stats)
+      : stream_id(stats.stream_id),
+        are_clients_listening(stats.are_clients_listening),
+        queued_messages(stats.queue.queued_messages),
+        sent_messages(stats.queue.sent_messages),
+        sent_bytes(stats.queue.sent_bytes),
+        dropped_messages(stats.queue.dropped_messages),
+        total_write_seconds(stats.queue.total_write_seconds),
+        max_write_seconds(stats.queue.max_write_seconds) {}
+
+    uint32_t stream_id = 0u;
+
+    bool are_clients_listening = false;
+
+    uint64_t queued_messages = 0u;
+
+    uint64_t sent_messages = 0u;
+
+    uint64_t sent_bytes = 0u;
+
+    uint64_t dropped_messages = 0u;
+
+    double total_write_seconds = 0.0;
+
+    double max_write_seconds = 0.0;
+
+    MSGPACK_DEFINE_ARRAY(
+        stream_id,
+        are_clients_listening,
+        queued_messages,
+        sent_messages,
+        sent_bytes,
+        dropped_messages,
+        total_write_seconds,
+        max_write_seconds);
+  };
+
+  /// Counters of the pool writing the data of the sensors spawned with a
+  /// "disk_sink", since the server started.
+  class DiskSinkMetrics {
+  public:
+
+    /// Files waiting in the queue.
+    uint64_t queued_files = 0u;
+
+    /// Most files that were waiting in the queue at once.
+    uint64_t max_queued_files = 0u;
+
+    /// Maximum number of files waiting in the queue.
+    uint64_t capacity = 0u;
+
+    uint64_t written_files = 0u;
+
+    uint64_t written_bytes = 0u;
+
+    /// Files that could not be encoded or written.
+    uint64_t failed_files = 0u;
+
+    /// Sensor messages that had to wait for room in the queue, i.e. the disk
+    /// did not keep up.
+    uint64_t blocked_messages = 0u;
+
+    double total_blocked_seconds = 0.0;
+
+    /// Time the workers spent encoding and writing files.
+    double total_write_seconds = 0.0;
+
+    MSGPACK_DEFINE_ARRAY(
+        queued_files,
+        max_queued_files,
+        capacity,
+        written_files,
+        written_bytes,
+        failed_files,
+        blocked_messages,
+        total_blocked_seconds,
+        total_write_seconds);
+  };
+
+  /// Counters of the RPC and streaming servers of the simulator.
+  class ServerMetrics {
+  public:
+
+    std::vector<FunctionMetrics> functions;
+
+    std::vector<StreamMetrics> streams;
+
+    DiskSinkMetrics disk_sink;
+
+    MSGPACK_DEFINE_ARRAY(functions, streams, disk_sink);
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -0,0 +1,91 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/MsgPack.h"
+#include "carla/geom/Transform.h"
+#include "carla/rpc/ActorId.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// Bone transforms of many walkers packed in a single binary blob. The
+  /// bones are given by their index in a bone set registered once with
+  /// Client::RegisterWalkerBones, so the server does not look up their names
+  /// on every control.
+  class WalkerBoneControlBatch {
+  public:
+
+#pragma pack(push, 1)
+    struct Entry {
+      ActorId walker;
+      uint16_t bone;
+      /// In the component space of the walker, as WalkerBoneControl.
+      geom::Transform transform;
+    };
+#pragma pack(pop)
+
+    WalkerBoneControlBatch() = default;
+
+    explicit WalkerBoneControlBatch(uint32_t bone_set)
+      : _bone_set(bone_set) {}
+
+    uint32_t GetBoneSet() const {
+      return _bone_set;
+    }
+
+    void Reserve(size_t number_of_bones) {
+      _data.reserve(number_of_bones * sizeof(Entry));
+    }
+
+    void Add(ActorId walker, uint16_t bone, const geom::Transform &transform) {
+      const Entry entry{walker, bone, transform};
+      const auto *begin = reinterpret_cast<const uint8_t *>(&entry);
+      _data.insert(_data.end(), begin, begin + sizeof(Entry));
+    }
+
+    void Clear() {
+      _data.clear();
+    }
+
+    size_t size() const {
+      return _data.size() / sizeof(Entry);
+    }
+
+    bool empty() const {
+      return _data.empty();
+    }
+
+    /// Whether the blob holds a whole number of entries, a batch received
+    /// from the network may not.
+    bool IsValid() const {
+      return (_data.size() % sizeof(Entry)) == 0u;
+    }
+
+    Entry at(size_t index) const {
+      DEBUG_ASSERT(index < size());
+      Entry entry;
+      std::memcpy(&entry, _data.data() + index * sizeof(Entry), sizeof(Entry));
+      return entry;
+    }
+
+    MSGPACK_DEFINE_ARRAY(_bone_set, _data);
+
+  private:
+
+    uint32_t _bone_set = 0u;
+
+    std::vector<uint8_t> _data;
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -0,0 +1,79 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/MsgPack.h"
+#include "carla/geom/Transform.h"
+#include "carla/rpc/ActorId.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// Transforms and speeds of many walkers packed in a single binary blob,
+  /// the server applies them all at once. Much cheaper to encode and decode
+  /// than a batch of Command::ApplyWalkerState, each of them a msgpack array
+  /// wrapped in a variant.
+  class WalkerStateBatch {
+  public:
+
+#pragma pack(push, 1)
+    struct Entry {
+      ActorId actor;
+      geom::Transform transform;
+      float speed;
+    };
+#pragma pack(pop)
+
+    void Reserve(size_t number_of_walkers) {
+      _data.reserve(number_of_walkers * sizeof(Entry));
+    }
+
+    void Add(ActorId actor, const geom::Transform &transform, float speed) {
+      const Entry entry{actor, transform, speed};
+      const auto *begin = reinterpret_cast<const uint8_t *>(&entry);
+      _data.insert(_data.end(), begin, begin + sizeof(Entry));
+    }
+
+    void Clear() {
+      _data.clear();
+    }
+
+    size_t size() const {
+      return _data.size() / sizeof(Entry);
+    }
+
+    bool empty() const {
+      return _data.empty();
+    }
+
+    /// Whether the blob holds a whole number of entries, a batch received
+    /// from the network may not.
+    bool IsValid() const {
+      return (_data.size() % sizeof(Entry)) == 0u;
+    }
+
+    Entry at(size_t index) const {
+      DEBUG_ASSERT(index < size());
+      Entry entry;
+      std::memcpy(&entry, _data.data() + index * sizeof(Entry), sizeof(Entry));
+      return entry;
+    }
+
+    MSGPACK_DEFINE_ARRAY(_data);
+
+  private:
+
+    std::vector<uint8_t> _data;
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -0,0 +1,71 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Exception.h"
+#include "carla/Memory.h"
+
+#include <boost/pool/pool_alloc.hpp>
+#include <boost/pool/singleton_pool.hpp>
+
+#include <new>
+
+namespace carla {
+namespace sensor {
+
+namespace detail {
+
+  struct SensorDataPoolTag {};
+
+  /// Free list shared by every SensorData type of the same size.
+  template <typename T>
+  using SensorDataPool = boost::singleton_pool<SensorDataPoolTag, sizeof(T)>;
+
+  template <typename T>
+  struct PooledSensorDataDeleter {
+    void operator()(T *object) const {
+      object->~T();
+      SensorDataPool<T>::free(object);
+    }
+  };
+
+} // namespace detail
+
+  /// Create a SensorData of type @a T in memory recycled from a pool. The
+  /// reference count of the SharedPtr is allocated from a pool too, so in the
+  /// steady state deserializing a message does not hit the heap other than for
+  /// the copy of its buffer, pooled already by the streaming client.
+  ///
+  /// The constructors of the SensorData classes are only accessible to their
+  /// serializers, so @a construct is given the memory and does the placement
+  /// new from the scope of the serializer:
+  ///
+  ///   return MakePooledSensorData<data::IMUMeasurement>([&](void *memory) {
+  ///     return new (memory) data::IMUMeasurement(std::move(data));
+  ///   });
+  template <typename T, typename ConstructorT>
+  static inline SharedPtr<T> MakePooledSensorData(ConstructorT &&construct) {
+    using Pool = detail::SensorDataPool<T>;
+    void *memory = Pool::malloc();
+    if (memory == nullptr) {
+      throw_exception(std::bad_alloc());
+    }
+    T *object = nullptr;
+    try {
+      object = construct(memory);
+    } catch (...) {
+      Pool::free(memory);
+      throw;
+    }
+    return SharedPtr<T>(
+        object,
+        detail::PooledSensorDataDeleter<T>{},
+        boost::fast_pool_allocator<T>{});
+  }
+
+} // namespace sensor
+} // namespace carla
@@ -15,6 +15,11 @@
 namespace carla {
 namespace sensor {
 
+namespace s11n {
+  class ImageSerializer;
+  class LidarSerializer;
+} // namespace s11n
+
   /// Wrapper around the raw data generated by a sensor plus some useful
   /// meta-information.
   class RawData {
@@ -47,6 +52,11 @@ namespace sensor {
      return GetHeader().sensor_transform;
     }
 
+    /// Cost of generating the data, see s11n::SensorHeaderSerializer::Cost.
+    const HeaderSerializer::Cost &GetCost() const {
+     return GetHeader().cost;
+    }
+
     /// Begin iterator to the data generated by the sensor.
     auto begin() noexcept {
      return _buffer.begin() + HeaderSerializer::header_offset;
@@ -89,6 +99,10 @@ namespace sensor {
     template <typename... Items>
     friend class CompositeSerializer;
 
+    friend class s11n::ImageSerializer;
+
+    friend class s11n::LidarSerializer;
+
     RawData(Buffer &&buffer) : _buffer(std::move(buffer)) {}
 
     Buffer _buffer;
@@ -8,8 +8,11 @@
 
 #include "carla/Memory.h"
 #include "carla/NonCopyable.h"
+#include "carla/rpc/SensorMetrics.h"
 #include "carla/sensor/RawData.h"
 
+#include <boost/optional.hpp>
+
 /// @todo This shouldn't be exposed in this namespace.
 #include "carla/client/detail/EpisodeProxy.h"
 
@@ -28,7 +31,18 @@ namespace sensor {
         _sensor_transform(sensor_transform) {}
 
     explicit SensorData(const RawData &data)
-      : SensorData(data.GetFrame(), data.GetTimestamp(), data.GetSensorTransform()) {}
+      : SensorData(data.GetFrame(), data.GetTimestamp(), data.GetSensorTransform()) {
+      const auto &cost = data.GetCost();
+      if (cost.is_measured != 0u) {
+        _cost = rpc::SensorFrameCost{};
+        _cost->frame = data.GetFrame();
+        _cost->tick_seconds = cost.tick_seconds;
+        _cost->readback_seconds = cost.readback_seconds;
+        _cost->serialize_seconds = cost.serialize_seconds;
+        _cost->gpu_seconds = cost.gpu_seconds;
+        _cost->bytes = cost.bytes;
+      }
+    }
 
   public:
 
@@ -49,6 +63,12 @@ namespace sensor {
       return _sensor_transform;
     }
 
+    /// Cost of generating the data in the simulator, only set while its
+    /// sensor metrics are enabled.
+    const boost::optional<rpc::SensorFrameCost> &GetCost() const {
+      return _cost;
+    }
+
   protected:
 
     const auto &GetEpisode() const {
@@ -66,6 +86,8 @@ namespace sensor {
     const double _timestamp;
 
     const rpc::Transform _sensor_transform;
+
+    boost::optional<rpc::SensorFrameCost> _cost;
   };
 
 } // namespace sensor
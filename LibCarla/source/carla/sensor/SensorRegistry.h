@@ -14,7 +14,10 @@
 // =============================================================================
 
 // 1. Include the serializer here.
+#include "carla/sensor/s11n/ActorBoundingBoxesSerializer.h"
+#include "carla/sensor/s11n/CollisionEventBatchSerializer.h"
 #include "carla/sensor/s11n/CollisionEventSerializer.h"
+#include "carla/sensor/s11n/EncodedImageSerializer.h"
 #include "carla/sensor/s11n/EpisodeStateSerializer.h"
 #include "carla/sensor/s11n/ImageSerializer.h"
 #include "carla/sensor/s11n/IMUSerializer.h"
@@ -22,10 +25,15 @@
 #include "carla/sensor/s11n/LidarSerializer.h"
 #include "carla/sensor/s11n/NoopSerializer.h"
 #include "carla/sensor/s11n/ObstacleDetectionEventSerializer.h"
+#include "carla/sensor/s11n/SensorBundleSerializer.h"
 
 // 2. Add a forward-declaration of the sensor here.
+class ACameraRig;
 class ACollisionSensor;
 class ADepthCamera;
+class ADepthLidar;
+class AEncodedCamera;
+class AGBufferCamera;
 class AGnssSensor;
 class AInertialMeasurementUnit;
 class ALaneInvasionSensor;
@@ -33,6 +41,9 @@ class AObstacleDetectionSensor;
 class ARayCastLidar;
 class ASceneCaptureCamera;
 class ASemanticSegmentationCamera;
+class FActorBoundingBoxes;
+class FCollisionEventBatch;
+class FSensorBundle;
 class FWorldObserver;
 
 namespace carla {
@@ -55,7 +66,14 @@ namespace sensor {
     std::pair<ACollisionSensor *, s11n::CollisionEventSerializer>,
     std::pair<AGnssSensor *, s11n::GnssSerializer>,
     std::pair<ALaneInvasionSensor *, s11n::NoopSerializer>,
-    std::pair<AObstacleDetectionSensor *, s11n::ObstacleDetectionEventSerializer>
+    std::pair<AObstacleDetectionSensor *, s11n::ObstacleDetectionEventSerializer>,
+    std::pair<FSensorBundle *, s11n::SensorBundleSerializer>,
+    std::pair<ACameraRig *, s11n::SensorBundleSerializer>,
+    std::pair<ADepthLidar *, s11n::LidarSerializer>,
+    std::pair<FCollisionEventBatch *, s11n::CollisionEventBatchSerializer>,
+    std::pair<AEncodedCamera *, s11n::EncodedImageSerializer>,
+    std::pair<AGBufferCamera *, s11n::SensorBundleSerializer>,
+    std::pair<FActorBoundingBoxes *, s11n::ActorBoundingBoxesSerializer>
   >;
 
 } // namespace sensor
@@ -76,5 +94,10 @@ namespace sensor {
 #include "Carla/Sensor/GnssSensor.h"
 #include "Carla/Sensor/LaneInvasionSensor.h"
 #include "Carla/Sensor/ObstacleDetectionSensor.h"
+#include "Carla/Sensor/SensorBundle.h"
+#include "Carla/Sensor/CameraRig.h"
+#include "Carla/Sensor/DepthLidar.h"
+#include "Carla/Sensor/EncodedCamera.h"
+#include "Carla/Sensor/GBufferCamera.h"
 
 #endif // LIBCARLA_SENSOR_REGISTRY_WITH_SENSOR_INCLUDES
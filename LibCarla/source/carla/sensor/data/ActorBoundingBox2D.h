@@ -0,0 +1,61 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/rpc/ActorId.h"
+
+#include <cstdint>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+#pragma pack(push, 1)
+  /// Box in pixels of an actor seen by a camera, and how much of it is
+  /// visible.
+  struct ActorBoundingBox2D {
+
+    ActorId actor_id;
+
+    /// Semantic tag of the pixels of the actor.
+    uint8_t semantic_tag;
+
+    /// Smallest box holding the visible pixels of the actor, the maximum
+    /// coordinates included.
+    uint16_t x_min;
+
+    uint16_t y_min;
+
+    uint16_t x_max;
+
+    uint16_t y_max;
+
+    /// Pixels showing the actor.
+    uint32_t visible_pixels;
+
+    /// Pixels of the projected box of the actor showing something closer to
+    /// the camera.
+    uint32_t occluded_pixels;
+
+    /// Distance in meters along the view of the camera to the closest point
+    /// of the bounding box of the actor.
+    float distance;
+
+    /// Fraction of the actor hidden behind other objects, between zero and
+    /// one.
+    float GetOcclusion() const {
+      const uint32_t total = visible_pixels + occluded_pixels;
+      return total > 0u ? static_cast<float>(occluded_pixels) / static_cast<float>(total) : 0.0f;
+    }
+  };
+#pragma pack(pop)
+
+  static_assert(sizeof(ActorBoundingBox2D) == 25u, "Invalid ActorBoundingBox2D size");
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
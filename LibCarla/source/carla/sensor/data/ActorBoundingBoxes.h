@@ -0,0 +1,52 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/sensor/data/ActorBoundingBox2D.h"
+#include "carla/sensor/data/Array.h"
+#include "carla/sensor/s11n/ActorBoundingBoxesSerializer.h"
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// 2D bounding boxes of the vehicles and walkers visible in an image of a
+  /// camera, computed by the server from the depth and the labels of the
+  /// image.
+  class ActorBoundingBoxes : public Array<ActorBoundingBox2D> {
+    using Super = Array<ActorBoundingBox2D>;
+  protected:
+
+    using Serializer = s11n::ActorBoundingBoxesSerializer;
+
+    friend Serializer;
+
+    explicit ActorBoundingBoxes(RawData data)
+      : Super(Serializer::header_offset, std::move(data)) {}
+
+  private:
+
+    const auto &GetHeader() const {
+      return Serializer::DeserializeHeader(Super::GetRawData());
+    }
+
+  public:
+
+    /// Width in pixels of the image of the boxes.
+    auto GetWidth() const {
+      return GetHeader().width;
+    }
+
+    /// Height in pixels of the image of the boxes.
+    auto GetHeight() const {
+      return GetHeader().height;
+    }
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
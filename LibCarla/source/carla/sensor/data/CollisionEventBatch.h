@@ -0,0 +1,91 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/client/detail/ActorVariant.h"
+#include "carla/geom/Vector3D.h"
+#include "carla/sensor/SensorData.h"
+#include "carla/sensor/s11n/CollisionEventBatchSerializer.h"
+
+#include <vector>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// The collisions registered during a frame, one event per actor hit with
+  /// the impulses of every hit against it summed up.
+  class CollisionEventBatch : public SensorData {
+    using Super = SensorData;
+  protected:
+
+    using Serializer = s11n::CollisionEventBatchSerializer;
+
+    friend Serializer;
+
+    explicit CollisionEventBatch(const RawData &data)
+      : CollisionEventBatch(data, Serializer::DeserializeRawData(data)) {}
+
+  private:
+
+    CollisionEventBatch(const RawData &data, Serializer::Data &&events)
+      : Super(data),
+        _self_actor(events.self_actor),
+        _events(std::move(events.events)) {
+      _other_actors.reserve(_events.size());
+      for (auto &event : _events) {
+        _other_actors.emplace_back(event.other_actor);
+      }
+    }
+
+  public:
+
+    /// Get "self" actor. Actor that measured the collisions.
+    SharedPtr<client::Actor> GetActor() const {
+      return _self_actor.Get(GetEpisode());
+    }
+
+    /// Number of actors hit during the frame.
+    size_t size() const {
+      return _events.size();
+    }
+
+    bool empty() const {
+      return _events.empty();
+    }
+
+    /// Get the actor hit by the event at @a pos.
+    SharedPtr<client::Actor> GetOtherActor(size_t pos) const {
+      DEBUG_ASSERT(pos < size());
+      return _other_actors[pos].Get(GetEpisode());
+    }
+
+    /// Sum of the normal impulses of the hits of the event at @a pos.
+    const geom::Vector3D &GetNormalImpulse(size_t pos) const {
+      DEBUG_ASSERT(pos < size());
+      return _events[pos].normal_impulse;
+    }
+
+    /// Number of hits coalesced into the event at @a pos.
+    uint32_t GetNumberOfHits(size_t pos) const {
+      DEBUG_ASSERT(pos < size());
+      return _events[pos].number_of_hits;
+    }
+
+  private:
+
+    client::detail::ActorVariant _self_actor;
+
+    std::vector<Serializer::Event> _events;
+
+    std::vector<client::detail::ActorVariant> _other_actors;
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
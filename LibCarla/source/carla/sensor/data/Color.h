@@ -46,6 +46,34 @@ namespace data {
 
   static_assert(sizeof(Color) == sizeof(uint32_t), "Invalid color size!");
 
+#pragma pack(push, 1)
+  /// A 24-bit RGB color.
+  struct ColorRGB {
+    ColorRGB() = default;
+
+    ColorRGB(uint8_t r, uint8_t g, uint8_t b)
+      : r(r), g(g), b(b) {}
+
+    bool operator==(const ColorRGB &rhs) const  {
+      return (r == rhs.r) && (g == rhs.g) && (b == rhs.b);
+    }
+
+    bool operator!=(const ColorRGB &rhs) const  {
+      return !(*this == rhs);
+    }
+
+    operator Color() const {
+      return {r, g, b};
+    }
+
+    uint8_t r = 0u;
+    uint8_t g = 0u;
+    uint8_t b = 0u;
+  };
+#pragma pack(pop)
+
+  static_assert(sizeof(ColorRGB) == 3u, "Invalid color size!");
+
 } // namespace data
 } // namespace sensor
 } // namespace carla
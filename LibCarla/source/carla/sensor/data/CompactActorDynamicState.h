@@ -0,0 +1,344 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/sensor/data/ActorDynamicState.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+namespace detail {
+
+  /// Convert @a value to IEEE 754 half precision, rounding to nearest.
+  inline uint16_t FloatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = (bits >> 16u) & 0x8000u;
+    const uint32_t float_exponent = (bits >> 23u) & 0xFFu;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+    if (float_exponent == 0xFFu) {
+      // Infinity or NaN.
+      return static_cast<uint16_t>(sign | 0x7C00u | (mantissa != 0u ? 0x200u : 0u));
+    }
+    const int32_t exponent = static_cast<int32_t>(float_exponent) - 127 + 15;
+    if (exponent >= 31) {
+      return static_cast<uint16_t>(sign | 0x7C00u);
+    }
+    if (exponent <= 0) {
+      // Subnormal, or too small even for that.
+      if (exponent < -10) {
+        return static_cast<uint16_t>(sign);
+      }
+      mantissa |= 0x800000u;
+      const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+      uint32_t half = mantissa >> shift;
+      if ((mantissa >> (shift - 1u)) & 1u) {
+        ++half;
+      }
+      return static_cast<uint16_t>(sign | half);
+    }
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10u) | (mantissa >> 13u);
+    // A carry into the exponent still gives the right value.
+    if (mantissa & 0x1000u) {
+      ++half;
+    }
+    return static_cast<uint16_t>(half);
+  }
+
+  inline float HalfToFloat(uint16_t half) {
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16u;
+    const uint32_t exponent = (half >> 10u) & 0x1Fu;
+    const uint32_t mantissa = half & 0x3FFu;
+    if (exponent == 0u) {
+      const float value = std::ldexp(static_cast<float>(mantissa), -24);
+      return sign != 0u ? -value : value;
+    }
+    const uint32_t bits = (exponent == 0x1Fu) ?
+        (sign | 0x7F800000u | (mantissa << 13u)) :
+        (sign | ((exponent + 112u) << 23u) | (mantissa << 13u));
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  /// Quantize @a value in [-1, 1] to 16 bits.
+  inline int16_t QuantizeUnit(float value) {
+    return static_cast<int16_t>(std::lround(32767.0f * std::min(1.0f, std::max(-1.0f, value))));
+  }
+
+  inline float DequantizeUnit(int16_t value) {
+    return static_cast<float>(value) / 32767.0f;
+  }
+
+#pragma pack(push, 1)
+  struct CompactVehicleData {
+    int16_t throttle;
+    int16_t steer;
+    int16_t brake;
+    int8_t gear;
+    rpc::TrafficLightState traffic_light_state;
+    uint16_t speed_limit;
+    rpc::ActorId traffic_light_id;
+  };
+#pragma pack(pop)
+
+#pragma pack(push, 1)
+  struct CompactTrafficLightData {
+    rpc::TrafficLightState state;
+    uint16_t green_time;
+    uint16_t yellow_time;
+    uint16_t red_time;
+    uint16_t elapsed_time;
+    uint32_t pole_index;
+  };
+#pragma pack(pop)
+
+#pragma pack(push, 1)
+  struct CompactWalkerControl {
+    int16_t direction[3u];
+    uint16_t speed;
+  };
+#pragma pack(pop)
+
+} // namespace detail
+
+#pragma pack(push, 1)
+
+  /// Quantized ActorDynamicState, sent by the episode state stream when the
+  /// server runs with a compact episode state. Locations have millimeter
+  /// precision from the origin of the map and rotations 16 bits per angle,
+  /// velocities, accelerations and timers are half precision floats, and the
+  /// controls 16 bits per axis. The booleans go in a single byte of flags.
+  class CompactActorDynamicState {
+  public:
+
+    /// Which member of the type dependent state an actor has.
+    enum class StateKind : uint8_t {
+      None,
+      Vehicle,
+      Walker,
+      TrafficLight
+    };
+
+    CompactActorDynamicState() = default;
+
+    CompactActorDynamicState(const ActorDynamicState &state, StateKind kind)
+      : id(state.id) {
+      // Copied out of the packed struct.
+      const geom::Transform transform = state.transform;
+      Quantize(transform.location, _location);
+      _rotation[0u] = QuantizeAngle(transform.rotation.pitch);
+      _rotation[1u] = QuantizeAngle(transform.rotation.yaw);
+      _rotation[2u] = QuantizeAngle(transform.rotation.roll);
+      ToHalf(state.velocity, _velocity);
+      ToHalf(state.angular_velocity, _angular_velocity);
+      ToHalf(state.acceleration, _acceleration);
+      _flags = static_cast<uint8_t>(kind);
+      std::memset(&_state, 0, sizeof(_state));
+      switch (kind) {
+        case StateKind::Vehicle: {
+          const auto &data = state.state.vehicle_data;
+          const rpc::VehicleControl control = data.control;
+          _state.vehicle_data.throttle = detail::QuantizeUnit(control.throttle);
+          _state.vehicle_data.steer = detail::QuantizeUnit(control.steer);
+          _state.vehicle_data.brake = detail::QuantizeUnit(control.brake);
+          _state.vehicle_data.gear = static_cast<int8_t>(std::min(127, std::max(-128, control.gear)));
+          _state.vehicle_data.traffic_light_state = data.traffic_light_state;
+          _state.vehicle_data.speed_limit = detail::FloatToHalf(data.speed_limit);
+          _state.vehicle_data.traffic_light_id = data.traffic_light_id;
+          SetFlag(FLAG_0, control.hand_brake);
+          SetFlag(FLAG_1, control.reverse);
+          SetFlag(FLAG_2, control.manual_gear_shift);
+          SetFlag(FLAG_3, data.has_traffic_light);
+          break;
+        }
+        case StateKind::Walker: {
+          const rpc::WalkerControl control = state.state.walker_control;
+          _state.walker_control.direction[0u] = detail::QuantizeUnit(control.direction.x);
+          _state.walker_control.direction[1u] = detail::QuantizeUnit(control.direction.y);
+          _state.walker_control.direction[2u] = detail::QuantizeUnit(control.direction.z);
+          _state.walker_control.speed = detail::FloatToHalf(control.speed);
+          SetFlag(FLAG_0, control.jump);
+          break;
+        }
+        case StateKind::TrafficLight: {
+          const auto &data = state.state.traffic_light_data;
+          _state.traffic_light_data.state = data.state;
+          _state.traffic_light_data.green_time = detail::FloatToHalf(data.green_time);
+          _state.traffic_light_data.yellow_time = detail::FloatToHalf(data.yellow_time);
+          _state.traffic_light_data.red_time = detail::FloatToHalf(data.red_time);
+          _state.traffic_light_data.elapsed_time = detail::FloatToHalf(data.elapsed_time);
+          _state.traffic_light_data.pole_index = data.pole_index;
+          SetFlag(FLAG_0, data.time_is_frozen);
+          break;
+        }
+        default:
+          break;
+      }
+    }
+
+    StateKind GetStateKind() const {
+      return static_cast<StateKind>(_flags & KIND_MASK);
+    }
+
+    /// Decode the full precision state.
+    operator ActorDynamicState() const {
+      ActorDynamicState state;
+      // Zeroed so the bytes of the unused members compare equal.
+      std::memset(&state.state, 0, sizeof(state.state));
+      state.id = id;
+      state.transform = geom::Transform{
+          geom::Location{Dequantize(_location[0u]), Dequantize(_location[1u]), Dequantize(_location[2u])},
+          geom::Rotation{DequantizeAngle(_rotation[0u]), DequantizeAngle(_rotation[1u]), DequantizeAngle(_rotation[2u])}};
+      state.velocity = FromHalf(_velocity);
+      state.angular_velocity = FromHalf(_angular_velocity);
+      state.acceleration = FromHalf(_acceleration);
+      switch (GetStateKind()) {
+        case StateKind::Vehicle: {
+          const auto &data = _state.vehicle_data;
+          state.state.vehicle_data.control = rpc::VehicleControl{
+              detail::DequantizeUnit(data.throttle),
+              detail::DequantizeUnit(data.steer),
+              detail::DequantizeUnit(data.brake),
+              GetFlag(FLAG_0),
+              GetFlag(FLAG_1),
+              GetFlag(FLAG_2),
+              data.gear};
+          state.state.vehicle_data.speed_limit = detail::HalfToFloat(data.speed_limit);
+          state.state.vehicle_data.traffic_light_state = data.traffic_light_state;
+          state.state.vehicle_data.has_traffic_light = GetFlag(FLAG_3);
+          state.state.vehicle_data.traffic_light_id = data.traffic_light_id;
+          break;
+        }
+        case StateKind::Walker: {
+          const auto &control = _state.walker_control;
+          state.state.walker_control = rpc::WalkerControl{
+              geom::Vector3D{
+                  detail::DequantizeUnit(control.direction[0u]),
+                  detail::DequantizeUnit(control.direction[1u]),
+                  detail::DequantizeUnit(control.direction[2u])},
+              detail::HalfToFloat(control.speed),
+              GetFlag(FLAG_0)};
+          break;
+        }
+        case StateKind::TrafficLight: {
+          const auto &data = _state.traffic_light_data;
+          auto &out = state.state.traffic_light_data;
+          out.state = data.state;
+          out.green_time = detail::HalfToFloat(data.green_time);
+          out.yellow_time = detail::HalfToFloat(data.yellow_time);
+          out.red_time = detail::HalfToFloat(data.red_time);
+          out.elapsed_time = detail::HalfToFloat(data.elapsed_time);
+          out.time_is_frozen = GetFlag(FLAG_0);
+          out.pole_index = data.pole_index;
+          break;
+        }
+        default:
+          break;
+      }
+      return state;
+    }
+
+    ActorId id;
+
+  private:
+
+    /// The two lower bits of the flags hold the StateKind, the rest the
+    /// booleans of the state.
+    static constexpr uint8_t KIND_MASK = 0x03u;
+    static constexpr uint8_t FLAG_0 = 0x04u;
+    static constexpr uint8_t FLAG_1 = 0x08u;
+    static constexpr uint8_t FLAG_2 = 0x10u;
+    static constexpr uint8_t FLAG_3 = 0x20u;
+
+    static void Quantize(const geom::Location &location, int32_t (&out)[3u]) {
+      auto quantize = [](float meters) {
+        const double millimeters = std::round(1e3 * static_cast<double>(meters));
+        return static_cast<int32_t>(std::min<double>(
+            std::numeric_limits<int32_t>::max(),
+            std::max<double>(std::numeric_limits<int32_t>::lowest(), millimeters)));
+      };
+      out[0u] = quantize(location.x);
+      out[1u] = quantize(location.y);
+      out[2u] = quantize(location.z);
+    }
+
+    static float Dequantize(int32_t millimeters) {
+      return static_cast<float>(1e-3 * static_cast<double>(millimeters));
+    }
+
+    /// Wraps @a degrees to [-180, 180).
+    static int16_t QuantizeAngle(float degrees) {
+      const auto turns = static_cast<int64_t>(std::lround(static_cast<double>(degrees) * 65536.0 / 360.0));
+      return static_cast<int16_t>(static_cast<uint16_t>(turns & 0xFFFF));
+    }
+
+    static float DequantizeAngle(int16_t angle) {
+      return static_cast<float>(angle) * (360.0f / 65536.0f);
+    }
+
+    static void ToHalf(const geom::Vector3D &vector, uint16_t (&out)[3u]) {
+      out[0u] = detail::FloatToHalf(vector.x);
+      out[1u] = detail::FloatToHalf(vector.y);
+      out[2u] = detail::FloatToHalf(vector.z);
+    }
+
+    static geom::Vector3D FromHalf(const uint16_t (&half)[3u]) {
+      return {
+          detail::HalfToFloat(half[0u]),
+          detail::HalfToFloat(half[1u]),
+          detail::HalfToFloat(half[2u])};
+    }
+
+    void SetFlag(uint8_t flag, bool value) {
+      if (value) {
+        _flags = static_cast<uint8_t>(_flags | flag);
+      }
+    }
+
+    bool GetFlag(uint8_t flag) const {
+      return (_flags & flag) != 0u;
+    }
+
+    int32_t _location[3u];
+
+    int16_t _rotation[3u];
+
+    uint16_t _velocity[3u];
+
+    uint16_t _angular_velocity[3u];
+
+    uint16_t _acceleration[3u];
+
+    uint8_t _flags;
+
+    union CompactTypeDependentState {
+      detail::CompactTrafficLightData traffic_light_data;
+      detail::CompactVehicleData vehicle_data;
+      detail::CompactWalkerControl walker_control;
+    } _state;
+  };
+
+#pragma pack(pop)
+
+static_assert(
+    sizeof(CompactActorDynamicState) == 55u,
+    "Invalid CompactActorDynamicState size! "
+    "If you modified this class please update the size here, else you may "
+    "comment this assert, but your platform may have compatibility issues "
+    "connecting to other platforms.");
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,60 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/sensor/data/Array.h"
+#include "carla/sensor/s11n/EncodedImageSerializer.h"
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// Compressed image sent by an encoding camera. The array holds the bytes
+  /// of the encoded file, nothing is decoded on reception.
+  class EncodedImage : public Array<unsigned char> {
+    using Super = Array<unsigned char>;
+  protected:
+
+    using Serializer = s11n::EncodedImageSerializer;
+
+    friend Serializer;
+
+    explicit EncodedImage(RawData data)
+      : Super(Serializer::header_offset, std::move(data)) {}
+
+  private:
+
+    const auto &GetHeader() const {
+      return Serializer::DeserializeHeader(Super::GetRawData());
+    }
+
+  public:
+
+    /// Get image width in pixels.
+    auto GetWidth() const {
+      return GetHeader().width;
+    }
+
+    /// Get image height in pixels.
+    auto GetHeight() const {
+      return GetHeader().height;
+    }
+
+    /// Get horizontal field of view of the image in degrees.
+    auto GetFOVAngle() const {
+      return GetHeader().fov_angle;
+    }
+
+    /// Codec the image is encoded with.
+    auto GetCodec() const {
+      return GetHeader().codec;
+    }
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
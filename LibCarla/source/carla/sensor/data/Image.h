@@ -16,6 +16,15 @@ namespace data {
   /// An image of 32-bit BGRA colors.
   using Image = ImageTmpl<Color>;
 
+  /// An image of 24-bit RGB colors.
+  using RGBImage = ImageTmpl<ColorRGB>;
+
+  /// An image of depths in meters.
+  using DepthImage = ImageTmpl<float>;
+
+  /// An image of semantic segmentation tags.
+  using LabelImage = ImageTmpl<uint8_t>;
+
 } // namespace data
 } // namespace sensor
 } // namespace carla
@@ -6,10 +6,17 @@
 
 #pragma once
 
+#include "carla/BufferPool.h"
 #include "carla/Debug.h"
+#include "carla/Memory.h"
 #include "carla/sensor/data/Array.h"
 #include "carla/sensor/s11n/ImageSerializer.h"
 
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
 namespace carla {
 namespace sensor {
 namespace data {
@@ -53,6 +60,43 @@ namespace data {
     auto GetFOVAngle() const {
       return GetHeader().fov_angle;
     }
+
+    /// Copy of this image modified by @a convert, made in a buffer of @a pool
+    /// the first time it is requested with @a key. The image keeps the copy,
+    /// so the consumers of one frame share a single conversion, and the
+    /// pixels of this image are never written.
+    template <typename ConvertT>
+    SharedPtr<ImageTmpl> GetConverted(
+        uint8_t key,
+        BufferPool &pool,
+        ConvertT &&convert) const {
+      std::lock_guard<std::mutex> lock(_converted_mutex);
+      for (const auto &item : _converted) {
+        if (item.first == key) {
+          return item.second;
+        }
+      }
+      const auto &source = Super::GetRawData();
+      auto buffer = pool.Pop(s11n::SensorHeaderSerializer::header_offset + source.size());
+      SharedPtr<ImageTmpl> image{
+          new ImageTmpl{Serializer::CopyRawData(source, std::move(buffer))}};
+      convert(*image);
+      _converted.emplace_back(key, image);
+      return image;
+    }
+
+    /// Drop the converted copies, to be called after writing the pixels of
+    /// this image.
+    void ClearConverted() {
+      std::lock_guard<std::mutex> lock(_converted_mutex);
+      _converted.clear();
+    }
+
+  private:
+
+    mutable std::mutex _converted_mutex;
+
+    mutable std::vector<std::pair<uint8_t, SharedPtr<ImageTmpl>>> _converted;
   };
 
 } // namespace data
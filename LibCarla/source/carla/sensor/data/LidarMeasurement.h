@@ -27,12 +27,13 @@ namespace data {
     friend Serializer;
 
     explicit LidarMeasurement(RawData data)
-      : Super(std::move(data)) {
-      Super::SetOffset(Serializer::GetHeaderOffset(Super::GetRawData()));
-    }
+      : LidarMeasurement(Serializer::GetHeaderOffset(data), std::move(data)) {}
 
   private:
 
+    LidarMeasurement(size_t offset, RawData &&data)
+      : Super(offset, std::move(data)) {}
+
     auto GetHeader() const {
       return Serializer::DeserializeHeader(Super::GetRawData());
     }
@@ -55,6 +56,56 @@ namespace data {
     auto GetPointCount(size_t channel) const {
       return GetHeader().GetPointCount(channel);
     }
+
+    /// Number of ticks this measurement is made of. Lidars sending full
+    /// sweeps gather the points of every tick of a rotation in a single
+    /// measurement, each tick is a slice; it is zero otherwise.
+    auto GetSliceCount() const {
+      return GetHeader().GetSliceCount();
+    }
+
+    /// Seconds from the timestamp of this measurement to the tick in which
+    /// @a slice was captured, zero or negative.
+    auto GetSliceTime(size_t slice) const {
+      return GetHeader().GetSliceTime(slice);
+    }
+
+    /// Retrieve the number of points that @a channel generated in @a slice.
+    /// Within a channel, points are sorted by slice.
+    auto GetPointCount(size_t channel, size_t slice) const {
+      return GetHeader().GetPointCount(channel, slice);
+    }
+
+    /// Slice of the point at @a index, zero if the measurement has no slices.
+    size_t GetSliceIndex(size_t index) const {
+      DEBUG_ASSERT(index < Super::size());
+      const auto header = GetHeader();
+      const auto slices = header.GetSliceCount();
+      if (slices == 0u) {
+        return 0u;
+      }
+      for (auto channel = 0u; channel < header.GetChannelCount(); ++channel) {
+        for (auto slice = 0u; slice < slices; ++slice) {
+          const size_t count = header.GetPointCount(channel, slice);
+          if (index < count) {
+            return slice;
+          }
+          index -= count;
+        }
+      }
+      return slices - 1u;
+    }
+
+    /// Intensity of the point at @a index, in [0, 255]. Only Lidars sending
+    /// packed points provide it, it is zero otherwise.
+    uint8_t GetIntensity(size_t index) const {
+      DEBUG_ASSERT(index < Super::size());
+      const auto header = GetHeader();
+      if (header.GetPointFormat() != s11n::LidarPointFormat::Float32WithIntensity) {
+        return 0u;
+      }
+      return Super::GetRawData().data()[header.GetHeaderSize() + index];
+    }
   };
 
 } // namespace data
@@ -0,0 +1,93 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/image/CityScapesPalette.h"
+#include "carla/sensor/data/Color.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// Format of the pixels sent by a camera. The cameras render 32-bit BGRA
+  /// colors, any other format is converted by the server while copying the
+  /// pixels out of the render target so clients do not need to.
+  enum class PixelFormat : uint32_t {
+    /// 32-bit BGRA colors, as rendered.
+    BGRA8,
+    /// 24-bit RGB colors, alpha dropped.
+    RGB8,
+    /// 32-bit float depth in meters, decoded from the depth camera colors.
+    Depth32F,
+    /// 8-bit semantic segmentation tags, taken from the red channel.
+    Label8,
+    /// 24-bit RGB colors of the CityScapes palette of each tag.
+    CityScapesRGB8
+  };
+
+  /// Distance of the far plane of the depth camera in meters.
+  static constexpr float DEPTH_FAR_PLANE = 1000.0f;
+
+  constexpr size_t GetBytesPerPixel(PixelFormat format) {
+    return
+        format == PixelFormat::BGRA8 ? sizeof(Color) :
+        format == PixelFormat::Depth32F ? sizeof(float) :
+        format == PixelFormat::Label8 ? sizeof(uint8_t) :
+        sizeof(ColorRGB);
+  }
+
+  /// Converts @a count BGRA pixels at @a source into @a format at
+  /// @a destination, which must hold GetBytesPerPixel(format) * count bytes.
+  inline void ConvertPixels(
+      const PixelFormat format,
+      const Color *source,
+      const size_t count,
+      unsigned char *destination) {
+    switch (format) {
+      case PixelFormat::BGRA8:
+        std::memcpy(destination, source, sizeof(Color) * count);
+        break;
+      case PixelFormat::RGB8:
+        for (size_t i = 0u; i < count; ++i, destination += sizeof(ColorRGB)) {
+          const ColorRGB pixel{source[i].r, source[i].g, source[i].b};
+          std::memcpy(destination, &pixel, sizeof(pixel));
+        }
+        break;
+      case PixelFormat::Depth32F:
+        for (size_t i = 0u; i < count; ++i, destination += sizeof(float)) {
+          const float encoded =
+              static_cast<float>(source[i].r) +
+              static_cast<float>(source[i].g) * 256.0f +
+              static_cast<float>(source[i].b) * (256.0f * 256.0f);
+          const float depth =
+              DEPTH_FAR_PLANE * encoded / static_cast<float>(256 * 256 * 256 - 1);
+          std::memcpy(destination, &depth, sizeof(depth));
+        }
+        break;
+      case PixelFormat::Label8:
+        for (size_t i = 0u; i < count; ++i) {
+          destination[i] = source[i].r;
+        }
+        break;
+      case PixelFormat::CityScapesRGB8:
+        for (size_t i = 0u; i < count; ++i, destination += sizeof(ColorRGB)) {
+          const auto color = image::CityScapesPalette::GetColor(source[i].r);
+          std::memcpy(destination, color, sizeof(ColorRGB));
+        }
+        break;
+      default:
+        DEBUG_ASSERT(false);
+    }
+  }
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
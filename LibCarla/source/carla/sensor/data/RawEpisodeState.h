@@ -7,8 +7,11 @@
 #pragma once
 
 #include "carla/Debug.h"
+#include "carla/ListView.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/sensor/SensorData.h"
 #include "carla/sensor/data/ActorDynamicState.h"
-#include "carla/sensor/data/Array.h"
+#include "carla/sensor/data/CompactActorDynamicState.h"
 #include "carla/sensor/s11n/EpisodeStateSerializer.h"
 
 namespace carla {
@@ -16,8 +19,10 @@ namespace sensor {
 namespace data {
 
   /// State of the episode at a given frame.
-  class RawEpisodeState : public Array<ActorDynamicState> {
-    using Super = Array<ActorDynamicState>;
+  ///
+  /// The actors are either ActorDynamicState or, if IsCompact(),
+  /// CompactActorDynamicState, decoded when read.
+  class RawEpisodeState : public SensorData {
   protected:
 
     using Serializer = s11n::EpisodeStateSerializer;
@@ -25,14 +30,33 @@ namespace data {
     friend Serializer;
 
     explicit RawEpisodeState(RawData data)
-      : Super(std::move(data)) {
-      Super::SetOffset(Serializer::header_offset);
+      : SensorData(data),
+        _data(std::move(data)) {
+      DEBUG_ASSERT(_data.size() >= GetActorsOffset());
+      DEBUG_ASSERT((_data.size() - GetActorsOffset()) % GetActorSize() == 0u);
     }
 
   private:
 
     auto GetHeader() const {
-      return Serializer::DeserializeHeader(Super::GetRawData());
+      return Serializer::DeserializeHeader(_data);
+    }
+
+    /// The ids of the destroyed actors go before the actors.
+    size_t GetActorsOffset() const {
+      return
+          Serializer::header_offset +
+          sizeof(ActorId) * GetHeader().number_of_destroyed_actors;
+    }
+
+    size_t GetActorSize() const {
+      return IsCompact() ? sizeof(CompactActorDynamicState) : sizeof(ActorDynamicState);
+    }
+
+    template <typename T>
+    auto GetActorsAs() const {
+      auto begin = reinterpret_cast<const T *>(_data.begin() + GetActorsOffset());
+      return MakeListView(begin, reinterpret_cast<const T *>(_data.end()));
     }
 
   public:
@@ -58,6 +82,59 @@ namespace data {
     double GetDeltaSeconds() const {
       return GetHeader().delta_seconds;
     }
+
+    /// Whether this frame only holds the actors that changed since
+    /// GetBaseFrame(), instead of every actor.
+    bool IsDelta() const {
+      return GetHeader().is_delta != 0u;
+    }
+
+    /// Frame the changes of a delta frame are relative to.
+    uint64_t GetBaseFrame() const {
+      return GetHeader().base_frame;
+    }
+
+    /// Ids of the actors destroyed since GetBaseFrame(), empty unless this is
+    /// a delta frame.
+    auto GetDestroyedActorIds() const {
+      auto begin = reinterpret_cast<const ActorId *>(_data.begin() + Serializer::header_offset);
+      return MakeListView(begin, begin + GetHeader().number_of_destroyed_actors);
+    }
+
+    /// Whether the actors are CompactActorDynamicState.
+    bool IsCompact() const {
+      return GetHeader().is_compact != 0u;
+    }
+
+    /// Number of actors in this frame.
+    size_t size() const {
+      return (_data.size() - GetActorsOffset()) / GetActorSize();
+    }
+
+    /// @pre !IsCompact().
+    auto GetActors() const {
+      DEBUG_ASSERT(!IsCompact());
+      return GetActorsAs<ActorDynamicState>();
+    }
+
+    /// @pre IsCompact().
+    auto GetCompactActors() const {
+      DEBUG_ASSERT(IsCompact());
+      return GetActorsAs<CompactActorDynamicState>();
+    }
+
+    /// The state of the actor at @a index, decoded if compact.
+    ActorDynamicState GetActor(size_t index) const {
+      DEBUG_ASSERT(index < size());
+      if (IsCompact()) {
+        return GetCompactActors().begin()[index];
+      }
+      return GetActors().begin()[index];
+    }
+
+  private:
+
+    RawData _data;
   };
 
 } // namespace data
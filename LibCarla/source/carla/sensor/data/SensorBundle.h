@@ -0,0 +1,91 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/sensor/SensorData.h"
+#include "carla/sensor/s11n/SensorBundleSerializer.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// The measurements generated in the same frame by every sensor of a
+  /// bundle, delivered together in a single callback. Each reading is keyed
+  /// by the actor id of the sensor that generated it.
+  class SensorBundle : public SensorData {
+    using Super = SensorData;
+  protected:
+
+    using Serializer = s11n::SensorBundleSerializer;
+
+    friend Serializer;
+
+    SensorBundle(
+        const RawData &data,
+        std::vector<SharedPtr<SensorData>> readings,
+        std::vector<Serializer::sensor_id_type> sensor_ids)
+      : Super(data),
+        _readings(std::move(readings)),
+        _sensor_ids(std::move(sensor_ids)) {
+      DEBUG_ASSERT(_readings.size() == _sensor_ids.size());
+    }
+
+  public:
+
+    using sensor_id_type = Serializer::sensor_id_type;
+
+    using value_type = SharedPtr<SensorData>;
+    using const_iterator = std::vector<value_type>::const_iterator;
+
+    size_t size() const {
+      return _readings.size();
+    }
+
+    bool empty() const {
+      return _readings.empty();
+    }
+
+    const value_type &at(size_t pos) const {
+      DEBUG_ASSERT(pos < size());
+      return _readings[pos];
+    }
+
+    /// Actor id of the sensor that generated the reading at @a pos.
+    sensor_id_type GetSensorId(size_t pos) const {
+      DEBUG_ASSERT(pos < size());
+      return _sensor_ids[pos];
+    }
+
+    /// Return the reading of the sensor with @a sensor_id, or nullptr if it
+    /// did not report in this frame.
+    value_type Find(sensor_id_type sensor_id) const {
+      const auto it = std::find(_sensor_ids.begin(), _sensor_ids.end(), sensor_id);
+      return it != _sensor_ids.end() ? _readings[it - _sensor_ids.begin()] : nullptr;
+    }
+
+    const_iterator begin() const {
+      return _readings.begin();
+    }
+
+    const_iterator end() const {
+      return _readings.end();
+    }
+
+  private:
+
+    const std::vector<value_type> _readings;
+
+    const std::vector<sensor_id_type> _sensor_ids;
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,21 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/s11n/ActorBoundingBoxesSerializer.h"
+
+#include "carla/sensor/data/ActorBoundingBoxes.h"
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  SharedPtr<SensorData> ActorBoundingBoxesSerializer::Deserialize(RawData &&data) {
+    return SharedPtr<data::ActorBoundingBoxes>(new data::ActorBoundingBoxes{std::move(data)});
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,62 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/Memory.h"
+#include "carla/sensor/RawData.h"
+#include "carla/sensor/data/ActorBoundingBox2D.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+
+  class SensorData;
+
+namespace s11n {
+
+  /// Serializes the 2D bounding boxes of the actors seen by a camera: the
+  /// size of the image followed by an ActorBoundingBox2D per actor.
+  class ActorBoundingBoxesSerializer {
+  public:
+
+#pragma pack(push, 1)
+    struct Header {
+      uint32_t width;
+      uint32_t height;
+    };
+#pragma pack(pop)
+
+    constexpr static auto header_offset = sizeof(Header);
+
+    static const Header &DeserializeHeader(const RawData &data) {
+      return *reinterpret_cast<const Header *>(data.begin());
+    }
+
+    /// Write @a boxes of an image of @a header size into @a buffer.
+    static Buffer Serialize(
+        const Header &header,
+        const std::vector<data::ActorBoundingBox2D> &boxes,
+        Buffer &&buffer) {
+      const size_t size = sizeof(data::ActorBoundingBox2D) * boxes.size();
+      buffer.reset(header_offset + size);
+      std::memcpy(buffer.data(), &header, sizeof(header));
+      if (size > 0u) {
+        std::memcpy(buffer.data() + header_offset, boxes.data(), size);
+      }
+      return std::move(buffer);
+    }
+
+    static SharedPtr<SensorData> Deserialize(RawData &&data);
+  };
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,23 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/PooledSensorData.h"
+#include "carla/sensor/data/CollisionEventBatch.h"
+#include "carla/sensor/s11n/CollisionEventBatchSerializer.h"
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  SharedPtr<SensorData> CollisionEventBatchSerializer::Deserialize(RawData &&data) {
+    return MakePooledSensorData<data::CollisionEventBatch>([&](void *memory) {
+      return new (memory) data::CollisionEventBatch(std::move(data));
+    });
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
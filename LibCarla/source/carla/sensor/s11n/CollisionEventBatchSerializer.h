@@ -0,0 +1,71 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/Debug.h"
+#include "carla/Memory.h"
+#include "carla/MsgPack.h"
+#include "carla/rpc/Actor.h"
+#include "carla/geom/Vector3D.h"
+#include "carla/sensor/RawData.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+
+  class SensorData;
+
+namespace s11n {
+
+  /// Serializes the collisions registered by a collision sensor during a
+  /// frame, coalesced by the other actor.
+  class CollisionEventBatchSerializer {
+  public:
+
+    /// The hits against the same actor within a frame.
+    struct Event {
+
+      rpc::Actor other_actor;
+
+      /// Sum of the normal impulses of the hits.
+      geom::Vector3D normal_impulse;
+
+      uint32_t number_of_hits;
+
+      MSGPACK_DEFINE_ARRAY(other_actor, normal_impulse, number_of_hits)
+    };
+
+    struct Data {
+
+      rpc::Actor self_actor;
+
+      std::vector<Event> events;
+
+      MSGPACK_DEFINE_ARRAY(self_actor, events)
+    };
+
+    static Data DeserializeRawData(const RawData &message) {
+      return MsgPack::UnPack<Data>(message.begin(), message.size());
+    }
+
+    template <typename SensorT>
+    static Buffer Serialize(
+        const SensorT &,
+        rpc::Actor self_actor,
+        std::vector<Event> events) {
+      return MsgPack::Pack(Data{self_actor, std::move(events)});
+    }
+
+    static SharedPtr<SensorData> Deserialize(RawData &&data);
+  };
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -4,6 +4,7 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include "carla/sensor/PooledSensorData.h"
 #include "carla/sensor/data/CollisionEvent.h"
 #include "carla/sensor/s11n/CollisionEventSerializer.h"
 
@@ -12,7 +13,9 @@ namespace sensor {
 namespace s11n {
 
   SharedPtr<SensorData> CollisionEventSerializer::Deserialize(RawData &&data) {
-    return SharedPtr<SensorData>(new data::CollisionEvent(std::move(data)));
+    return MakePooledSensorData<data::CollisionEvent>([&](void *memory) {
+      return new (memory) data::CollisionEvent(std::move(data));
+    });
   }
 
 } // namespace s11n
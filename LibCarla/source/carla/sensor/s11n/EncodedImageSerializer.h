@@ -0,0 +1,71 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/Memory.h"
+#include "carla/sensor/RawData.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace carla {
+namespace sensor {
+
+  class SensorData;
+
+namespace s11n {
+
+  /// Codec of the images sent by an encoding camera.
+  enum class ImageCodec : uint32_t {
+    JPEG
+  };
+
+  /// Serializes the compressed images generated by encoding cameras. The
+  /// buffer holds the header followed by the encoded image, a complete file
+  /// of the codec set in the header.
+  class EncodedImageSerializer {
+  public:
+
+#pragma pack(push, 1)
+    struct EncodedImageHeader {
+      uint32_t width;
+      uint32_t height;
+      float fov_angle;
+      ImageCodec codec;
+    };
+#pragma pack(pop)
+
+    constexpr static auto header_offset = sizeof(EncodedImageHeader);
+
+    static const EncodedImageHeader &DeserializeHeader(const RawData &data) {
+      return *reinterpret_cast<const EncodedImageHeader *>(data.begin());
+    }
+
+    /// @a encoded holds the encoded image after header_offset bytes.
+    template <typename Sensor>
+    static Buffer Serialize(const Sensor &sensor, Buffer &&encoded);
+
+    static SharedPtr<SensorData> Deserialize(RawData &&data);
+  };
+
+  template <typename Sensor>
+  inline Buffer EncodedImageSerializer::Serialize(const Sensor &sensor, Buffer &&encoded) {
+    DEBUG_ASSERT(encoded.size() > sizeof(EncodedImageHeader));
+    EncodedImageHeader header = {
+      sensor.GetOutputImageWidth(),
+      sensor.GetOutputImageHeight(),
+      sensor.GetOutputFOVAngle(),
+      sensor.GetImageCodec()
+    };
+    std::memcpy(encoded.data(), reinterpret_cast<const void *>(&header), sizeof(header));
+    return std::move(encoded);
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
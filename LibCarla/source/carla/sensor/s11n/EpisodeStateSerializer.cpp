@@ -6,6 +6,7 @@
 
 #include "carla/sensor/s11n/EpisodeStateSerializer.h"
 
+#include "carla/sensor/PooledSensorData.h"
 #include "carla/sensor/data/RawEpisodeState.h"
 
 namespace carla {
@@ -13,7 +14,9 @@ namespace sensor {
 namespace s11n {
 
   SharedPtr<SensorData> EpisodeStateSerializer::Deserialize(RawData &&data) {
-    return SharedPtr<data::RawEpisodeState>(new data::RawEpisodeState{std::move(data)});
+    return MakePooledSensorData<data::RawEpisodeState>([&](void *memory) {
+      return new (memory) data::RawEpisodeState{std::move(data)};
+    });
   }
 
 } // namespace s11n
@@ -13,6 +13,7 @@
 #include "carla/geom/Vector3D.h"
 #include "carla/sensor/RawData.h"
 #include "carla/sensor/data/ActorDynamicState.h"
+#include "carla/sensor/data/CompactActorDynamicState.h"
 
 #include <cstdint>
 
@@ -24,6 +25,13 @@ namespace sensor {
 namespace s11n {
 
   /// Serializes the current state of the whole episode.
+  ///
+  /// A full frame holds the state of every actor. A delta frame only holds
+  /// the actors that changed since the frame it is based on, preceded by the
+  /// ids of the actors destroyed since then.
+  ///
+  /// The actors go either as ActorDynamicState or, in a compact frame, as the
+  /// quantized CompactActorDynamicState.
   class EpisodeStateSerializer {
   public:
 
@@ -32,6 +40,14 @@ namespace s11n {
       uint64_t episode_id;
       double platform_timestamp;
       float delta_seconds;
+      /// Whether this is a delta frame.
+      uint8_t is_delta;
+      /// Frame this delta frame is based on.
+      uint64_t base_frame;
+      /// Number of ids of destroyed actors in this delta frame.
+      uint32_t number_of_destroyed_actors;
+      /// Whether the actors are CompactActorDynamicState.
+      uint8_t is_compact;
     };
 #pragma pack(pop)
 
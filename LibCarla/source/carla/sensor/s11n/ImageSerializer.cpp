@@ -13,6 +13,17 @@ namespace sensor {
 namespace s11n {
 
   SharedPtr<SensorData> ImageSerializer::Deserialize(RawData &&data) {
+    switch (DeserializeHeader(data).pixel_format) {
+      case data::PixelFormat::RGB8:
+      case data::PixelFormat::CityScapesRGB8:
+        return SharedPtr<data::RGBImage>(new data::RGBImage{std::move(data)});
+      case data::PixelFormat::Depth32F:
+        return SharedPtr<data::DepthImage>(new data::DepthImage{std::move(data)});
+      case data::PixelFormat::Label8:
+        return SharedPtr<data::LabelImage>(new data::LabelImage{std::move(data)});
+      default:
+        break;
+    }
     auto image = SharedPtr<data::Image>(new data::Image{std::move(data)});
     // Set alpha of each pixel in the buffer to max to make it 100% opaque
     for (auto &pixel : *image) {
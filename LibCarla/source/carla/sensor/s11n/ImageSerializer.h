@@ -8,6 +8,7 @@
 
 #include "carla/Memory.h"
 #include "carla/sensor/RawData.h"
+#include "carla/sensor/data/PixelFormat.h"
 
 #include <cstdint>
 #include <cstring>
@@ -28,6 +29,7 @@ namespace s11n {
       uint32_t width;
       uint32_t height;
       float fov_angle;
+      data::PixelFormat pixel_format;
     };
 #pragma pack(pop)
 
@@ -41,15 +43,22 @@ namespace s11n {
     static Buffer Serialize(const Sensor &sensor, Buffer &&bitmap);
 
     static SharedPtr<SensorData> Deserialize(RawData &&data);
+
+    /// Copy of @a data, headers included, in the memory of @a buffer.
+    static RawData CopyRawData(const RawData &data, Buffer &&buffer) {
+      buffer.copy_from(data._buffer);
+      return RawData{std::move(buffer)};
+    }
   };
 
   template <typename Sensor>
   inline Buffer ImageSerializer::Serialize(const Sensor &sensor, Buffer &&bitmap) {
     DEBUG_ASSERT(bitmap.size() > sizeof(ImageHeader));
     ImageHeader header = {
-      sensor.GetImageWidth(),
-      sensor.GetImageHeight(),
-      sensor.GetFOVAngle()
+      sensor.GetOutputImageWidth(),
+      sensor.GetOutputImageHeight(),
+      sensor.GetOutputFOVAngle(),
+      sensor.GetPixelFormat()
     };
     std::memcpy(bitmap.data(), reinterpret_cast<const void *>(&header), sizeof(header));
     return std::move(bitmap);
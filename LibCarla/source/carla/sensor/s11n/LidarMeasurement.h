@@ -6,15 +6,44 @@
 
 #pragma once
 
+#include "carla/Debug.h"
 #include "carla/rpc/Location.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 
 namespace carla {
 namespace sensor {
 namespace s11n {
 
+  /// Layout of the points of a Lidar measurement.
+  enum class LidarPointFormat : uint32_t {
+    /// X, Y, Z as 32-bit floats, 12 bytes per point.
+    Float32,
+    /// X, Y, Z as 16-bit fixed-point integers in units of the point scale,
+    /// plus an intensity and a channel byte, 8 bytes per point.
+    PackedInt16,
+    /// Layout of the points once a PackedInt16 measurement is decoded: an
+    /// array with the intensity of each point (padded to 4 bytes) followed
+    /// by the X, Y, Z of each point as 32-bit floats.
+    Float32WithIntensity
+  };
+
+#pragma pack(push, 1)
+  struct LidarPackedPoint {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+    uint8_t intensity;
+    uint8_t channel;
+  };
+#pragma pack(pop)
+
+  static_assert(sizeof(LidarPackedPoint) == 8u, "Invalid packed point size");
+
   /// Helper class to store and serialize the data generated by a Lidar.
   ///
   /// The header of a Lidar measurement consists of an array of uint32_t's in
@@ -23,12 +52,29 @@ namespace s11n {
   ///    {
   ///      Horizontal angle (float),
   ///      Channel count,
+  ///      Point format (LidarPointFormat),
+  ///      Point scale in meters (float),
+  ///      Slice count,
   ///      Point count of channel 0,
   ///      ...
   ///      Point count of channel n,
   ///    }
   ///
-  /// The points are stored in an array of floats
+  /// A measurement made of several ticks, a full sweep, has a slice count
+  /// greater than zero and the header goes on with
+  ///
+  ///    {
+  ///      Time of slice 0 (float),
+  ///      ...
+  ///      Time of slice m (float),
+  ///      Point count of channel 0 in slice 0,
+  ///      ...
+  ///      Point count of channel 0 in slice m,
+  ///      ...
+  ///      Point count of channel n in slice m,
+  ///    }
+  ///
+  /// By default the points are stored in an array of floats
   ///
   ///    {
   ///      X0, Y0, Z0,
@@ -36,9 +82,11 @@ namespace s11n {
   ///      Xn, Yn, Zn,
   ///    }
   ///
+  /// or, with LidarPointFormat::PackedInt16, in an array of LidarPackedPoint.
+  ///
   /// @warning WritePoint should be called sequentially in the order in which
   /// the points are going to be stored, i.e., starting at channel zero and
-  /// increasing steadily.
+  /// increasing steadily, and within a channel in increasing slice order.
   class LidarMeasurement {
     static_assert(sizeof(float) == sizeof(uint32_t), "Invalid float size");
 
@@ -48,14 +96,31 @@ namespace s11n {
     enum Index : size_t {
       HorizontalAngle,
       ChannelCount,
+      PointFormat,
+      PointScale,
+      SliceCount,
       SIZE
     };
 
   public:
 
-    explicit LidarMeasurement(uint32_t ChannelCount = 0u)
-      : _header(Index::SIZE + ChannelCount, 0u) {
+    /// @a point_scale is the size in meters of a unit of the packed
+    /// coordinates, ignored unless @a format is PackedInt16.
+    explicit LidarMeasurement(
+        uint32_t ChannelCount = 0u,
+        LidarPointFormat format = LidarPointFormat::Float32,
+        float point_scale = 0.01f)
+      : _header(Index::SIZE + ChannelCount, 0u),
+        _format(format),
+        _inverse_scale(1.0f / point_scale),
+        _point_size(format == LidarPointFormat::PackedInt16 ?
+            sizeof(LidarPackedPoint) :
+            3u * sizeof(float)) {
+      DEBUG_ASSERT(format != LidarPointFormat::Float32WithIntensity);
+      DEBUG_ASSERT(point_scale > 0.0f);
       _header[Index::ChannelCount] = ChannelCount;
+      _header[Index::PointFormat] = static_cast<uint32_t>(format);
+      std::memcpy(&_header[Index::PointScale], &point_scale, sizeof(uint32_t));
     }
 
     LidarMeasurement &operator=(LidarMeasurement &&) = default;
@@ -72,25 +137,90 @@ namespace s11n {
       return _header[Index::ChannelCount];
     }
 
-    void Reset(uint32_t total_point_count) {
-      std::memset(_header.data() + Index::SIZE, 0, sizeof(uint32_t) * GetChannelCount());
-      _points.clear();
-      _points.reserve(3u * total_point_count);
+    LidarPointFormat GetPointFormat() const {
+      return _format;
     }
 
-    void WritePoint(uint32_t channel, rpc::Location point) {
+    uint32_t GetSliceCount() const {
+      return _header[Index::SliceCount];
+    }
+
+    /// @a slice_count is the number of ticks the measurement is made of, zero
+    /// for a measurement of a single tick.
+    void Reset(uint32_t total_point_count, uint32_t slice_count = 0u) {
+      const uint32_t channels = GetChannelCount();
+      const size_t slice_size = slice_count > 0u ? slice_count * (1u + channels) : 0u;
+      _header.resize(Index::SIZE + channels + slice_size);
+      std::memset(_header.data() + Index::SIZE, 0, sizeof(uint32_t) * (channels + slice_size));
+      _header[Index::SliceCount] = slice_count;
+      _point_count = 0u;
+      // Only grows, the points are written with indexed stores.
+      if (_points.size() < _point_size * total_point_count) {
+        _points.resize(_point_size * total_point_count);
+      }
+    }
+
+    /// Seconds from the end of the sweep to the tick of @a slice, zero or
+    /// negative.
+    void SetSliceTime(uint32_t slice, float seconds) {
+      DEBUG_ASSERT(GetSliceCount() > slice);
+      std::memcpy(&_header[GetSliceOffset() + slice], &seconds, sizeof(uint32_t));
+    }
+
+    void WritePoint(
+        uint32_t channel,
+        rpc::Location point,
+        uint8_t intensity = 0u,
+        uint32_t slice = 0u) {
       DEBUG_ASSERT(GetChannelCount() > channel);
       _header[Index::SIZE + channel] += 1u;
-      _points.emplace_back(point.x);
-      _points.emplace_back(point.y);
-      _points.emplace_back(point.z);
+      if (GetSliceCount() > 0u) {
+        DEBUG_ASSERT(GetSliceCount() > slice);
+        _header[GetSliceOffset() + GetSliceCount() * (1u + channel) + slice] += 1u;
+      }
+      const size_t position = _point_size * _point_count;
+      if (position >= _points.size()) {
+        // More points than reserved in Reset.
+        _points.resize(2u * _points.size() + _point_size);
+      }
+      auto *destination = _points.data() + position;
+      if (_format == LidarPointFormat::PackedInt16) {
+        const LidarPackedPoint packed = {
+          Quantize(point.x),
+          Quantize(point.y),
+          Quantize(point.z),
+          intensity,
+          static_cast<uint8_t>(channel)};
+        std::memcpy(destination, &packed, sizeof(packed));
+      } else {
+        const float xyz[3u] = {point.x, point.y, point.z};
+        std::memcpy(destination, xyz, sizeof(xyz));
+      }
+      ++_point_count;
     }
 
   private:
 
+    size_t GetSliceOffset() const {
+      return Index::SIZE + GetChannelCount();
+    }
+
+    int16_t Quantize(float value) const {
+      const float units = std::round(value * _inverse_scale);
+      return static_cast<int16_t>(std::min(32767.0f, std::max(-32768.0f, units)));
+    }
+
     std::vector<uint32_t> _header;
 
-    std::vector<float> _points;
+    LidarPointFormat _format;
+
+    float _inverse_scale;
+
+    size_t _point_size;
+
+    size_t _point_count = 0u;
+
+    std::vector<unsigned char> _points;
   };
 
 } // namespace s11n
@@ -6,13 +6,59 @@
 
 #include "carla/sensor/s11n/LidarSerializer.h"
 
+#include "carla/Exception.h"
 #include "carla/sensor/data/LidarMeasurement.h"
 
+#include <exception>
+
 namespace carla {
 namespace sensor {
 namespace s11n {
 
+  RawData LidarSerializer::DecodePackedPoints(const RawData &data) {
+    using Index = LidarMeasurement::Index;
+    if (data.size() < sizeof(uint32_t) * Index::SIZE) {
+      throw_exception(std::runtime_error("corrupted lidar measurement"));
+    }
+    const auto header = DeserializeHeader(data);
+    const size_t header_size = header.GetHeaderSize();
+    if (data.size() < header_size) {
+      throw_exception(std::runtime_error("corrupted lidar measurement"));
+    }
+    const size_t point_count = header.GetTotalPointCount();
+    if ((data.size() - header_size) != (point_count * sizeof(LidarPackedPoint))) {
+      throw_exception(std::runtime_error("corrupted lidar measurement"));
+    }
+
+    constexpr auto sensor_header_size = SensorHeaderSerializer::header_offset;
+    const size_t intensities_size = GetIntensitiesSize(point_count);
+    Buffer buffer(static_cast<Buffer::size_type>(
+        sensor_header_size + header_size + intensities_size + 3u * sizeof(float) * point_count));
+    std::memcpy(buffer.data(), data._buffer.data(), sensor_header_size + header_size);
+    auto *output = buffer.data() + sensor_header_size;
+    const auto format = static_cast<uint32_t>(LidarPointFormat::Float32WithIntensity);
+    std::memcpy(output + sizeof(uint32_t) * Index::PointFormat, &format, sizeof(format));
+
+    auto *intensities = output + header_size;
+    std::memset(intensities, 0, intensities_size);
+    auto *points = reinterpret_cast<float *>(intensities + intensities_size);
+    const auto *input = data.data() + header_size;
+    const float scale = header.GetPointScale();
+    for (size_t i = 0u; i < point_count; ++i) {
+      LidarPackedPoint packed;
+      std::memcpy(&packed, input + i * sizeof(packed), sizeof(packed));
+      intensities[i] = packed.intensity;
+      points[3u * i + 0u] = scale * static_cast<float>(packed.x);
+      points[3u * i + 1u] = scale * static_cast<float>(packed.y);
+      points[3u * i + 2u] = scale * static_cast<float>(packed.z);
+    }
+    return RawData{std::move(buffer)};
+  }
+
   SharedPtr<SensorData> LidarSerializer::Deserialize(RawData &&data) {
+    if (DeserializeHeader(data).GetPointFormat() == LidarPointFormat::PackedInt16) {
+      data = DecodePackedPoints(data);
+    }
     return SharedPtr<data::LidarMeasurement>(
         new data::LidarMeasurement{std::move(data)});
   }
@@ -35,13 +35,57 @@ namespace s11n {
       return _begin[Index::ChannelCount];
     }
 
+    LidarPointFormat GetPointFormat() const {
+      return static_cast<LidarPointFormat>(_begin[Index::PointFormat]);
+    }
+
+    /// Size in meters of a unit of the packed coordinates.
+    float GetPointScale() const {
+      return reinterpret_cast<const float &>(_begin[Index::PointScale]);
+    }
+
     uint32_t GetPointCount(size_t channel) const {
       DEBUG_ASSERT(channel < GetChannelCount());
       return _begin[Index::SIZE + channel];
     }
 
+    /// Number of ticks the measurement is made of, zero unless the Lidar
+    /// sends full sweeps.
+    uint32_t GetSliceCount() const {
+      return _begin[Index::SliceCount];
+    }
+
+    /// Seconds from the end of the sweep to the tick of @a slice.
+    float GetSliceTime(size_t slice) const {
+      DEBUG_ASSERT(slice < GetSliceCount());
+      return reinterpret_cast<const float &>(_begin[GetSliceOffset() + slice]);
+    }
+
+    uint32_t GetPointCount(size_t channel, size_t slice) const {
+      DEBUG_ASSERT(channel < GetChannelCount());
+      DEBUG_ASSERT(slice < GetSliceCount());
+      return _begin[GetSliceOffset() + GetSliceCount() * (1u + channel) + slice];
+    }
+
+    uint32_t GetTotalPointCount() const {
+      uint32_t total = 0u;
+      for (auto i = 0u; i < GetChannelCount(); ++i) {
+        total += GetPointCount(i);
+      }
+      return total;
+    }
+
+    size_t GetHeaderSize() const {
+      const size_t slices = GetSliceCount();
+      return sizeof(uint32_t) * (GetSliceOffset() + slices * (1u + GetChannelCount()));
+    }
+
   private:
 
+    size_t GetSliceOffset() const {
+      return Index::SIZE + GetChannelCount();
+    }
+
     friend class LidarSerializer;
 
     explicit LidarHeaderView(const uint32_t *begin) : _begin(begin) {
@@ -63,9 +107,21 @@ namespace s11n {
       return LidarHeaderView{reinterpret_cast<const uint32_t *>(data.begin())};
     }
 
+    /// Offset of the XYZ floats, i.e. the size of the header plus the
+    /// intensities if any.
     static size_t GetHeaderOffset(const RawData &data) {
       auto View = DeserializeHeader(data);
-      return sizeof(uint32_t) * (View.GetChannelCount() + LidarMeasurement::Index::SIZE);
+      size_t offset = View.GetHeaderSize();
+      if (View.GetPointFormat() == LidarPointFormat::Float32WithIntensity) {
+        offset += GetIntensitiesSize(View.GetTotalPointCount());
+      }
+      return offset;
+    }
+
+    /// Size of the array of intensities of a decoded measurement, padded so
+    /// the floats that follow stay aligned.
+    static constexpr size_t GetIntensitiesSize(size_t point_count) {
+      return (point_count + 3u) & ~size_t(3u);
     }
 
     template <typename Sensor>
@@ -75,6 +131,12 @@ namespace s11n {
         Buffer &&bitmap);
 
     static SharedPtr<SensorData> Deserialize(RawData &&data);
+
+  private:
+
+    /// Expands the packed points of @a data into floats, the result has
+    /// LidarPointFormat::Float32WithIntensity.
+    static RawData DecodePackedPoints(const RawData &data);
   };
 
   // ===========================================================================
@@ -88,7 +150,9 @@ namespace s11n {
       Buffer &&output) {
     std::array<boost::asio::const_buffer, 2u> seq = {
         boost::asio::buffer(measurement._header),
-        boost::asio::buffer(measurement._points)};
+        boost::asio::buffer(
+            measurement._points.data(),
+            measurement._point_size * measurement._point_count)};
     output.copy_from(seq);
     return std::move(output);
   }
@@ -4,6 +4,7 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include "carla/sensor/PooledSensorData.h"
 #include "carla/sensor/data/ObstacleDetectionEvent.h"
 #include "carla/sensor/s11n/ObstacleDetectionEventSerializer.h"
 
@@ -12,7 +13,9 @@ namespace sensor {
 namespace s11n {
 
   SharedPtr<SensorData> ObstacleDetectionEventSerializer::Deserialize(RawData &&data) {
-    return SharedPtr<SensorData>(new data::ObstacleDetectionEvent(std::move(data)));
+    return MakePooledSensorData<data::ObstacleDetectionEvent>([&](void *memory) {
+      return new (memory) data::ObstacleDetectionEvent(std::move(data));
+    });
   }
 
 } // namespace s11n
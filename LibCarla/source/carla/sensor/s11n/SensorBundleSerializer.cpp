@@ -0,0 +1,60 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/s11n/SensorBundleSerializer.h"
+
+#include "carla/Exception.h"
+#include "carla/sensor/Deserializer.h"
+#include "carla/sensor/data/SensorBundle.h"
+
+#include <exception>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  std::vector<SensorBundleSerializer::ReceivedReading>
+  SensorBundleSerializer::DeserializeRawData(const RawData &data) {
+    auto position = data.begin();
+    const auto end = data.end();
+    auto read_value = [&]() {
+      if (static_cast<size_t>(end - position) < sizeof(uint32_t)) {
+        throw_exception(std::runtime_error("corrupted sensor bundle"));
+      }
+      uint32_t value;
+      std::memcpy(&value, position, sizeof(value));
+      position += sizeof(value);
+      return value;
+    };
+    std::vector<ReceivedReading> readings(read_value());
+    for (auto &reading : readings) {
+      const auto size = read_value();
+      reading.sensor_id = read_value();
+      if (static_cast<size_t>(end - position) < size) {
+        throw_exception(std::runtime_error("corrupted sensor bundle"));
+      }
+      reading.message.copy_from(position, size);
+      position += size;
+    }
+    return readings;
+  }
+
+  SharedPtr<SensorData> SensorBundleSerializer::Deserialize(RawData &&data) {
+    std::vector<SharedPtr<SensorData>> readings;
+    std::vector<sensor_id_type> sensor_ids;
+    for (auto &reading : DeserializeRawData(data)) {
+      sensor_ids.emplace_back(reading.sensor_id);
+      readings.emplace_back(Deserializer::Deserialize(std::move(reading.message)));
+    }
+    return SharedPtr<SensorData>(new data::SensorBundle(
+        data,
+        std::move(readings),
+        std::move(sensor_ids)));
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,99 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/Debug.h"
+#include "carla/Memory.h"
+#include "carla/sensor/RawData.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+
+  class SensorData;
+
+namespace s11n {
+
+  /// Serializes the messages generated in the same frame by the sensors of a
+  /// bundle into a single message. The data is the number of readings,
+  /// followed by the size, the id of the sensor and the message of each
+  /// reading.
+  class SensorBundleSerializer {
+  public:
+
+    using size_type = uint32_t;
+
+    using sensor_id_type = uint32_t;
+
+    /// The message of a single sensor, as it would be sent down its stream.
+    struct Reading {
+      Buffer header;
+
+      Buffer data;
+
+      /// Actor id of the sensor that generated the reading.
+      sensor_id_type sensor_id = 0u;
+    };
+
+    /// The message of a single sensor as received by the client.
+    struct ReceivedReading {
+      sensor_id_type sensor_id;
+
+      Buffer message;
+    };
+
+    template <typename SensorT>
+    static Buffer Serialize(
+        const SensorT &sensor,
+        const std::vector<Reading> &readings,
+        Buffer &&output);
+
+    /// Returns a copy of the message of each reading.
+    static std::vector<ReceivedReading> DeserializeRawData(const RawData &data);
+
+    static SharedPtr<SensorData> Deserialize(RawData &&data);
+  };
+
+  template <typename SensorT>
+  inline Buffer SensorBundleSerializer::Serialize(
+      const SensorT &,
+      const std::vector<Reading> &readings,
+      Buffer &&output) {
+    size_t total_size = sizeof(size_type);
+    for (auto &reading : readings) {
+      total_size +=
+          sizeof(size_type) +
+          sizeof(sensor_id_type) +
+          reading.header.size() +
+          reading.data.size();
+    }
+    output.reset(static_cast<Buffer::size_type>(total_size));
+    auto *position = output.data();
+    auto write = [&position](const void *source, size_t size) {
+      std::memcpy(position, source, size);
+      position += size;
+    };
+    const auto number_of_readings = static_cast<size_type>(readings.size());
+    write(&number_of_readings, sizeof(number_of_readings));
+    for (auto &reading : readings) {
+      const auto size = static_cast<size_type>(reading.header.size() + reading.data.size());
+      write(&size, sizeof(size));
+      write(&reading.sensor_id, sizeof(reading.sensor_id));
+      write(reading.header.data(), reading.header.size());
+      write(reading.data.data(), reading.data.size());
+    }
+    DEBUG_ASSERT(position == output.data() + output.size());
+    return std::move(output);
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -13,7 +13,7 @@ namespace sensor {
 namespace s11n {
 
   static_assert(
-      SensorHeaderSerializer::header_offset == 3u * 8u + 6u * 4u,
+      SensorHeaderSerializer::header_offset == 3u * 8u + 6u * 4u + 6u * 4u,
       "Header size missmatch");
 
   static Buffer PopBufferFromPool() {
@@ -31,6 +31,7 @@ namespace s11n {
     h.frame = frame;
     h.timestamp = timestamp;
     h.sensor_transform = transform;
+    h.cost = Cost{};
     auto buffer = PopBufferFromPool();
     buffer.copy_from(reinterpret_cast<const unsigned char *>(&h), sizeof(h));
     return buffer;
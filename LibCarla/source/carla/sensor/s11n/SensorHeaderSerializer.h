@@ -18,11 +18,25 @@ namespace s11n {
   public:
 
 #pragma pack(push, 1)
+    /// Cost of computing the data, only measured while the sensor metrics of
+    /// the server are enabled. The GPU time is zero if the timestamps were
+    /// not read back yet when the data was sent.
+    struct Cost {
+      /// Non-zero if the other fields were measured.
+      uint32_t is_measured;
+      float tick_seconds;
+      float readback_seconds;
+      float serialize_seconds;
+      float gpu_seconds;
+      uint32_t bytes;
+    };
+
     struct Header {
       uint64_t sensor_type;
       uint64_t frame;
       double timestamp;
       rpc::Transform sensor_transform;
+      Cost cost;
     };
 #pragma pack(pop)
 
@@ -34,6 +48,11 @@ namespace s11n {
         double timestamp,
         rpc::Transform transform);
 
+    /// Write @a cost in the header of @a message.
+    static void SetCost(Buffer &message, const Cost &cost) {
+      reinterpret_cast<Header *>(message.data())->cost = cost;
+    }
+
     static const Header &Deserialize(const Buffer &message) {
       return *reinterpret_cast<const Header *>(message.data());
     }
@@ -44,6 +44,18 @@ namespace streaming {
       _client.UnSubscribe(token);
     }
 
+    /// Whether the streams subscribed to from now on share a single
+    /// connection per server. Disabled by default.
+    void SetMultiplexed(bool enabled) {
+      _client.SetMultiplexed(enabled);
+    }
+
+    /// Size in bytes of the kernel socket buffers of the streams subscribed
+    /// to from now on, zero, the default, keeps the system defaults.
+    void SetSocketBufferSize(size_t size) {
+      _client.SetSocketBufferSize(size);
+    }
+
     void Run() {
       _service.Run();
     }
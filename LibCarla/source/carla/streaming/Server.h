@@ -48,6 +48,19 @@ namespace streaming {
       _server.SetTimeout(timeout);
     }
 
+    /// Set the capacity in bytes of the shared memory ring given to clients
+    /// running in the same host, zero disables it.
+    void SetSharedMemoryCapacity(size_t capacity) {
+      _server.SetSharedMemoryCapacity(capacity);
+    }
+
+    /// Set the size in bytes of the kernel socket buffers, zero keeps the
+    /// system defaults. Links of tens of gigabits per second need at least
+    /// their bandwidth-delay product to saturate the link with one stream.
+    void SetSocketBufferSize(size_t size) {
+      _server.SetSocketBufferSize(size);
+    }
+
     Stream MakeStream() {
       return _server.MakeStream();
     }
@@ -56,6 +69,11 @@ namespace streaming {
       return _server.MakeMultiStream();
     }
 
+    /// Counters of every stream alive, sorted by id.
+    std::vector<detail::StreamStats> GetStreamStats() const {
+      return _server.GetStreamStats();
+    }
+
     void Run() {
       _pool.Run();
     }
@@ -64,6 +82,12 @@ namespace streaming {
       _pool.AsyncRun(worker_threads);
     }
 
+    /// Runs the server in @a worker_threads pinned to the CPUs in @a
+    /// cpu_mask, zero leaves them unrestricted.
+    void AsyncRun(size_t worker_threads, uint64_t cpu_mask) {
+      _pool.AsyncRun(worker_threads, cpu_mask);
+    }
+
   private:
 
     // The order of these two arguments is very important.
@@ -27,5 +27,8 @@ namespace streaming {
   /// @warning MultiStream is quite slower than Stream.
   using MultiStream = detail::Stream<detail::MultiStreamState>;
 
+  /// Codec applied to the messages of a stream sent to remote clients.
+  using Compression = detail::Compression;
+
 } // namespace streaming
 } // namespace carla
@@ -11,16 +11,39 @@
 #include "carla/streaming/detail/MultiStreamState.h"
 #include "carla/streaming/detail/StreamState.h"
 
+#include <algorithm>
 #include <exception>
+#include <vector>
 
 namespace carla {
 namespace streaming {
 namespace detail {
 
-  template <typename StreamStateT, typename StreamMapT>
-  static auto MakeStreamState(const token_type &cached_token, StreamMapT &stream_map) {
-    auto ptr = std::make_shared<StreamStateT>(cached_token);
-    auto result = stream_map.emplace(std::make_pair(cached_token.get_stream_id(), ptr));
+  /// Removes the expired streams of @a stream_map.
+  template <typename StreamMapT>
+  static void ClearExpiredStreams(StreamMapT &stream_map) {
+    for (auto it = stream_map.begin(); it != stream_map.end(); ) {
+      if (it->second.expired()) {
+        it = stream_map.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  template <typename StreamStateT>
+  std::shared_ptr<StreamStateT> Dispatcher::MakeStreamState() {
+    // Zero is reserved for multiplexed sessions, it only comes up in overflow.
+    stream_id_type id;
+    do {
+      id = ++_last_stream_id;
+    } while (id == tcp::MULTIPLEXED_STREAM_ID);
+    auto token = _base_token;
+    token._token.stream_id = id;
+    auto ptr = std::make_shared<StreamStateT>(token);
+    auto &shard = GetShard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto result = shard.stream_map.emplace(std::make_pair(id, ptr));
     if (!result.second) {
       throw_exception(std::runtime_error("failed to create stream!"));
     }
@@ -31,44 +54,42 @@ namespace detail {
     // Disconnect all the sessions from their streams, this should kill any
     // session remaining since at this point the io_context should be already
     // stopped.
-    for (auto &pair : _stream_map) {
+    for (auto &shard : _shards) {
+      for (auto &pair : shard.stream_map) {
 #ifndef LIBCARLA_NO_EXCEPTIONS
-      try {
+        try {
 #endif // LIBCARLA_NO_EXCEPTIONS
-        auto stream_state = pair.second.lock();
-        if (stream_state != nullptr) {
-          stream_state->ClearSessions();
-        }
+          auto stream_state = pair.second.lock();
+          if (stream_state != nullptr) {
+            stream_state->ClearSessions();
+          }
 #ifndef LIBCARLA_NO_EXCEPTIONS
-      } catch (const std::exception &e) {
-        log_error("failed to clear sessions:", e.what());
-      }
+        } catch (const std::exception &e) {
+          log_error("failed to clear sessions:", e.what());
+        }
 #endif // LIBCARLA_NO_EXCEPTIONS
+      }
     }
   }
 
   carla::streaming::Stream Dispatcher::MakeStream() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    ++_cached_token._token.stream_id; // id zero only happens in overflow.
-    return MakeStreamState<StreamState>(_cached_token, _stream_map);
+    return MakeStreamState<StreamState>();
   }
 
   carla::streaming::MultiStream Dispatcher::MakeMultiStream() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    ++_cached_token._token.stream_id; // id zero only happens in overflow.
-    return MakeStreamState<MultiStreamState>(_cached_token, _stream_map);
+    return MakeStreamState<MultiStreamState>();
   }
 
   bool Dispatcher::RegisterSession(std::shared_ptr<Session> session) {
     DEBUG_ASSERT(session != nullptr);
-    std::lock_guard<std::mutex> lock(_mutex);
-    auto search = _stream_map.find(session->get_stream_id());
-    if (search != _stream_map.end()) {
-      auto stream_state = search->second.lock();
-      if (stream_state != nullptr) {
-        stream_state->ConnectSession(std::move(session));
-        return true;
-      }
+    if (session->IsMultiplexed()) {
+      // Connected to its streams as the requests arrive.
+      return true;
+    }
+    auto stream_state = GetStreamState(session->get_stream_id());
+    if (stream_state != nullptr) {
+      stream_state->ConnectSession(std::move(session));
+      return true;
     }
     log_error("Invalid session: no stream available with id", session->get_stream_id());
     return false;
@@ -76,25 +97,75 @@ namespace detail {
 
   void Dispatcher::DeregisterSession(std::shared_ptr<Session> session) {
     DEBUG_ASSERT(session != nullptr);
-    std::lock_guard<std::mutex> lock(_mutex);
-    ClearExpiredStreams();
-    auto search = _stream_map.find(session->get_stream_id());
-    if (search != _stream_map.end()) {
-      auto stream_state = search->second.lock();
+    const auto ids = session->IsMultiplexed() ?
+        session->GetSubscribedStreams() :
+        std::vector<stream_id_type>{session->get_stream_id()};
+    for (auto id : ids) {
+      auto &shard = GetShard(id);
+      std::shared_ptr<StreamStateBase> stream_state;
+      {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        ClearExpiredStreams(shard.stream_map);
+        auto search = shard.stream_map.find(id);
+        if (search != shard.stream_map.end()) {
+          stream_state = search->second.lock();
+        }
+      }
       if (stream_state != nullptr) {
         stream_state->DisconnectSession(session);
       }
     }
   }
 
-  void Dispatcher::ClearExpiredStreams() {
-    for (auto it = _stream_map.begin(); it != _stream_map.end(); ) {
-      if (it->second.expired()) {
-        it = _stream_map.erase(it);
-      } else {
-        ++it;
+  void Dispatcher::HandleRequest(
+      std::shared_ptr<Session> session,
+      const tcp::StreamRequest request) {
+    DEBUG_ASSERT(session != nullptr);
+    DEBUG_ASSERT(session->IsMultiplexed());
+    auto stream_state = GetStreamState(request.stream_id);
+    if (stream_state == nullptr) {
+      log_error("Invalid request: no stream available with id", request.stream_id);
+      return;
+    }
+    if (request.type == tcp::RequestType::Subscribe) {
+      stream_state->ConnectSession(std::move(session));
+    } else {
+      stream_state->DisconnectSession(session);
+    }
+  }
+
+  std::vector<StreamStats> Dispatcher::GetStreamStats() const {
+    std::vector<std::shared_ptr<StreamStateBase>> stream_states;
+    for (auto &shard : _shards) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      for (auto &pair : shard.stream_map) {
+        auto stream_state = pair.second.lock();
+        if (stream_state != nullptr) {
+          stream_states.emplace_back(std::move(stream_state));
+        }
       }
     }
+    // Query the sessions without holding the shards.
+    std::vector<StreamStats> result;
+    result.reserve(stream_states.size());
+    for (auto &stream_state : stream_states) {
+      StreamStats stats;
+      stats.stream_id = stream_state->token().get_stream_id();
+      stats.are_clients_listening = stream_state->AreClientsListening();
+      stats.queue = stream_state->GetSendQueueStats();
+      result.emplace_back(stats);
+    }
+    std::sort(result.begin(), result.end(), [](const auto &lhs, const auto &rhs) {
+      return lhs.stream_id < rhs.stream_id;
+    });
+    return result;
+  }
+
+  std::shared_ptr<StreamStateBase> Dispatcher::GetStreamState(const stream_id_type id) {
+    auto &shard = GetShard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto search = shard.stream_map.find(id);
+    return search != shard.stream_map.end() ? search->second.lock() : nullptr;
   }
 
 } // namespace detail
@@ -10,10 +10,14 @@
 #include "carla/streaming/Stream.h"
 #include "carla/streaming/detail/Session.h"
 #include "carla/streaming/detail/Token.h"
+#include "carla/streaming/detail/tcp/Multiplexing.h"
 
+#include <array>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace carla {
 namespace streaming {
@@ -22,12 +26,16 @@ namespace detail {
   class StreamStateBase;
 
   /// Keeps the mapping between streams and sessions.
+  ///
+  /// The streams are spread among a number of shards by id, each shard with
+  /// its own mutex, so sessions of different streams registering at the same
+  /// time rarely contend on the same lock.
   class Dispatcher {
   public:
 
     template <typename Protocol, typename EndPointType>
     explicit Dispatcher(const EndPoint<Protocol, EndPointType> &ep)
-      : _cached_token(0u, ep) {}
+      : _base_token(0u, ep) {}
 
     ~Dispatcher();
 
@@ -39,19 +47,40 @@ namespace detail {
 
     void DeregisterSession(std::shared_ptr<Session> session);
 
+    /// Connects or disconnects a multiplexed session to the stream of @a
+    /// request.
+    void HandleRequest(std::shared_ptr<Session> session, tcp::StreamRequest request);
+
+    /// Counters of every stream alive, sorted by id.
+    std::vector<StreamStats> GetStreamStats() const;
+
   private:
 
-    void ClearExpiredStreams();
+    static constexpr size_t NUMBER_OF_SHARDS = 16u;
+
+    struct Shard {
+      mutable std::mutex mutex;
+
+      std::unordered_map<
+          stream_id_type,
+          std::weak_ptr<StreamStateBase>> stream_map;
+    };
+
+    Shard &GetShard(stream_id_type id) {
+      return _shards[id % NUMBER_OF_SHARDS];
+    }
+
+    template <typename StreamStateT>
+    std::shared_ptr<StreamStateT> MakeStreamState();
+
+    /// Returns the state of @a id, nullptr if the stream does not exist.
+    std::shared_ptr<StreamStateBase> GetStreamState(stream_id_type id);
 
-    // We use a mutex here, but we assume that sessions and streams won't be
-    // created too often.
-    std::mutex _mutex;
+    const token_type _base_token;
 
-    token_type _cached_token;
+    std::atomic<stream_id_type> _last_stream_id{0u};
 
-    std::unordered_map<
-        stream_id_type,
-        std::weak_ptr<StreamStateBase>> _stream_map;
+    std::array<Shard, NUMBER_OF_SHARDS> _shards;
   };
 
 } // namespace detail
@@ -6,10 +6,10 @@
 
 #pragma once
 
+#include "carla/AtomicList.h"
 #include "carla/streaming/detail/StreamStateBase.h"
 
-#include <mutex>
-#include <vector>
+#include <memory>
 
 namespace carla {
 namespace streaming {
@@ -17,7 +17,9 @@ namespace detail {
 
   /// A stream state that can hold any number of sessions.
   ///
-  /// @todo Lacking some optimization.
+  /// The list of sessions is replaced with a copy every time a session
+  /// connects or disconnects, so writing to the stream never blocks on a
+  /// subscriber being added or removed.
   class MultiStreamState final : public StreamStateBase {
   public:
 
@@ -26,38 +28,60 @@ namespace detail {
     template <typename... Buffers>
     void Write(Buffers &&... buffers) {
       auto message = Session::MakeMessage(std::move(buffers)...);
-      std::lock_guard<std::mutex> lock(_mutex);
-      for (auto &session : _sessions) {
+      auto sessions = _sessions.Load();
+      for (auto &session : *sessions) {
         if (session != nullptr) {
-          session->Write(message);
+          session->WriteTo(token().get_stream_id(), message);
         }
       }
     }
 
+    SendQueueStats GetSendQueueStats() const final {
+      SendQueueStats stats;
+      auto sessions = _sessions.Load();
+      for (auto &session : *sessions) {
+        stats += session->GetSendQueueStats(token().get_stream_id());
+      }
+      return stats;
+    }
+
+    bool AreClientsListening() const final {
+      return !_sessions.Load()->empty();
+    }
+
   private:
 
     void ConnectSession(std::shared_ptr<Session> session) final {
       DEBUG_ASSERT(session != nullptr);
-      std::lock_guard<std::mutex> lock(_mutex);
-      _sessions.emplace_back(std::move(session));
+      session->SetSendQueueSettings(GetSendQueueSettings());
+      session->SetCompression(GetCompression());
+      _sessions.Push(std::move(session));
+    }
+
+    void ApplySendQueueSettings(const SendQueueSettings &settings) final {
+      auto sessions = _sessions.Load();
+      for (auto &session : *sessions) {
+        session->SetSendQueueSettings(settings);
+      }
+    }
+
+    void ApplyCompression(const Compression codec) final {
+      auto sessions = _sessions.Load();
+      for (auto &session : *sessions) {
+        session->SetCompression(codec);
+      }
     }
 
     void DisconnectSession(std::shared_ptr<Session> session) final {
-      std::lock_guard<std::mutex> lock(_mutex);
       DEBUG_ASSERT(session != nullptr);
-      _sessions.erase(
-          std::remove(_sessions.begin(), _sessions.end(), session),
-          _sessions.end());
+      _sessions.DeleteByValue(session);
     }
 
     void ClearSessions() final {
-      std::lock_guard<std::mutex> lock(_mutex);
-      _sessions.clear();
+      _sessions.Clear();
     }
 
-    std::mutex _mutex;
-
-    std::vector<std::shared_ptr<Session>> _sessions;
+    client::detail::AtomicList<std::shared_ptr<Session>> _sessions;
   };
 
 } // namespace detail
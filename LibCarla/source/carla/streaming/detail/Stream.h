@@ -9,6 +9,7 @@
 #include "carla/Buffer.h"
 #include "carla/Debug.h"
 #include "carla/streaming/Token.h"
+#include "carla/streaming/detail/Types.h"
 
 #include <memory>
 
@@ -46,6 +47,37 @@ namespace detail {
       return _shared_state->MakeBuffer();
     }
 
+    /// Sets how the memory of the buffers made by MakeBuffer is allocated.
+    /// Huge pages by default.
+    void SetBufferAllocation(BufferAllocation allocation) {
+      _shared_state->SetBufferAllocation(allocation);
+    }
+
+    /// Sets the size and overflow policy of the send queue of every session
+    /// subscribed to this stream, including sessions subscribing later.
+    void SetSendQueueSettings(const SendQueueSettings &settings) {
+      _shared_state->SetSendQueueSettings(settings);
+    }
+
+    /// Queue depth, sent and dropped message counters of this stream, summed
+    /// over its subscribed sessions.
+    SendQueueStats GetSendQueueStats() const {
+      return _shared_state->GetSendQueueStats();
+    }
+
+    /// Whether any client is subscribed to this stream. Sensors use it to
+    /// skip their work while nobody listens.
+    bool AreClientsListening() const {
+      return _shared_state->AreClientsListening();
+    }
+
+    /// Sets the codec used to compress the messages of this stream sent to
+    /// clients in other hosts. Messages are compressed on the server's io
+    /// threads, not on the thread writing to the stream.
+    void SetCompression(Compression codec) {
+      _shared_state->SetCompression(codec);
+    }
+
     /// Flush @a buffers down the stream. No copies are made.
     template <typename... Buffers>
     void Write(Buffers &&... buffers) {
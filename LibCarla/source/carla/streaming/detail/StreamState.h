@@ -23,17 +23,44 @@ namespace detail {
     void Write(Buffers &&... buffers) {
       auto session = _session.load();
       if (session != nullptr) {
-        session->Write(std::move(buffers)...);
+        session->WriteTo(
+            token().get_stream_id(),
+            Session::MakeMessage(std::move(buffers)...));
       }
     }
 
+    SendQueueStats GetSendQueueStats() const final {
+      auto session = _session.load();
+      return session != nullptr ? session->GetSendQueueStats(token().get_stream_id()) : SendQueueStats{};
+    }
+
+    bool AreClientsListening() const final {
+      return _session.load() != nullptr;
+    }
+
   private:
 
     void ConnectSession(std::shared_ptr<Session> session) final {
       DEBUG_ASSERT(session != nullptr);
+      session->SetSendQueueSettings(GetSendQueueSettings());
+      session->SetCompression(GetCompression());
       _session = std::move(session);
     }
 
+    void ApplySendQueueSettings(const SendQueueSettings &settings) final {
+      auto session = _session.load();
+      if (session != nullptr) {
+        session->SetSendQueueSettings(settings);
+      }
+    }
+
+    void ApplyCompression(const Compression codec) final {
+      auto session = _session.load();
+      if (session != nullptr) {
+        session->SetCompression(codec);
+      }
+    }
+
     void DisconnectSession(std::shared_ptr<Session> DEBUG_ONLY(session)) final {
       DEBUG_ASSERT(session == _session.load());
       _session = nullptr;
@@ -14,7 +14,10 @@ namespace detail {
 
   StreamStateBase::StreamStateBase(const token_type &token)
     : _token(token),
-      _buffer_pool(std::make_shared<BufferPool>()) {}
+      _buffer_pool(std::make_shared<BufferPool>()) {
+    // Sensor data such as images is big and filled right after allocation.
+    _buffer_pool->SetAllocation(BufferAllocation::HugePages);
+  }
 
   StreamStateBase::~StreamStateBase() = default;
 
@@ -22,6 +25,28 @@ namespace detail {
     return _buffer_pool->Pop();
   }
 
+  void StreamStateBase::SetBufferAllocation(BufferAllocation allocation) {
+    _buffer_pool->SetAllocation(allocation);
+  }
+
+  void StreamStateBase::SetSendQueueSettings(const SendQueueSettings &settings) {
+    {
+      std::lock_guard<std::mutex> lock(_settings_mutex);
+      _send_queue_settings = settings;
+    }
+    ApplySendQueueSettings(settings);
+  }
+
+  SendQueueSettings StreamStateBase::GetSendQueueSettings() const {
+    std::lock_guard<std::mutex> lock(_settings_mutex);
+    return _send_queue_settings;
+  }
+
+  void StreamStateBase::SetCompression(const Compression codec) {
+    _compression = codec;
+    ApplyCompression(codec);
+  }
+
 } // namespace detail
 } // namespace streaming
 } // namespace carla
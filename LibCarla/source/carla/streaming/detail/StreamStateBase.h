@@ -10,7 +10,9 @@
 #include "carla/streaming/detail/Session.h"
 #include "carla/streaming/detail/Token.h"
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 
 namespace carla {
 
@@ -34,17 +36,48 @@ namespace detail {
 
     Buffer MakeBuffer();
 
+    void SetBufferAllocation(BufferAllocation allocation);
+
+    /// Sets the send queue of the current and future sessions of the stream.
+    void SetSendQueueSettings(const SendQueueSettings &settings);
+
+    SendQueueSettings GetSendQueueSettings() const;
+
+    virtual SendQueueStats GetSendQueueStats() const = 0;
+
+    /// Whether at least one session is subscribed to the stream.
+    virtual bool AreClientsListening() const = 0;
+
+    /// Sets the codec of the current and future sessions of the stream.
+    void SetCompression(Compression codec);
+
+    Compression GetCompression() const {
+      return _compression;
+    }
+
     virtual void ConnectSession(std::shared_ptr<Session> session) = 0;
 
     virtual void DisconnectSession(std::shared_ptr<Session> session) = 0;
 
     virtual void ClearSessions() = 0;
 
+  protected:
+
+    virtual void ApplySendQueueSettings(const SendQueueSettings &settings) = 0;
+
+    virtual void ApplyCompression(Compression codec) = 0;
+
   private:
 
     const token_type _token;
 
     const std::shared_ptr<BufferPool> _buffer_pool;
+
+    mutable std::mutex _settings_mutex;
+
+    SendQueueSettings _send_queue_settings;
+
+    std::atomic<Compression> _compression{Compression::None};
   };
 
 } // namespace detail
@@ -8,6 +8,7 @@
 
 #include "carla/Buffer.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <type_traits>
 
@@ -23,6 +24,83 @@ namespace detail {
       std::is_same<message_size_type, Buffer::size_type>::value,
       "uint type mismatch!");
 
+  /// What a session does with a new message when its send queue is full.
+  enum class OverflowPolicy : uint8_t {
+    /// Discard the oldest queued message to make room for the new one.
+    DropOldest,
+    /// Discard the new message.
+    DropNewest,
+    /// Block the producer until there is room in the queue, or the session
+    /// time-out expires in which case the new message is discarded.
+    BlockProducer
+  };
+
+  /// Configuration of the send queue of the sessions of a stream.
+  struct SendQueueSettings {
+    /// Maximum number of messages waiting to be sent, not counting the ones
+    /// already being written to the socket. Must be at least one.
+    size_t max_queued_messages = 4u;
+
+    OverflowPolicy policy = OverflowPolicy::DropOldest;
+  };
+
+  /// Codec applied to the messages of a stream sent to remote clients.
+  /// Clients in the same host never receive compressed messages.
+  enum class Compression : uint8_t {
+    /// Messages are sent as they are.
+    None,
+    /// LZ4 block compression, fast enough to keep up with a 10 GbE link.
+    LZ4,
+    /// PNG-style predictor subtracting from each byte the one four bytes
+    /// before (same channel of the previous pixel, or same byte of the
+    /// previous float), followed by LZ4. Meant for depth images and other
+    /// smooth data.
+    DeltaLZ4
+  };
+
+  /// Counters of the send queue of a stream, summed over its sessions.
+  struct SendQueueStats {
+    /// Number of messages currently waiting to be sent.
+    size_t queued_messages = 0u;
+
+    /// Number of messages successfully written to the socket.
+    size_t sent_messages = 0u;
+
+    /// Size of the messages successfully written to the socket, before
+    /// compression.
+    size_t sent_bytes = 0u;
+
+    /// Number of messages discarded because the queue was full.
+    size_t dropped_messages = 0u;
+
+    /// Time the sent messages spent being written to the socket, the write
+    /// of several queued messages counts once for each of them.
+    double total_write_seconds = 0.0;
+
+    double max_write_seconds = 0.0;
+
+    SendQueueStats &operator+=(const SendQueueStats &rhs) {
+      queued_messages += rhs.queued_messages;
+      sent_messages += rhs.sent_messages;
+      sent_bytes += rhs.sent_bytes;
+      dropped_messages += rhs.dropped_messages;
+      total_write_seconds += rhs.total_write_seconds;
+      max_write_seconds = max_write_seconds > rhs.max_write_seconds ?
+          max_write_seconds :
+          rhs.max_write_seconds;
+      return *this;
+    }
+  };
+
+  /// Counters of a stream of the server.
+  struct StreamStats {
+    stream_id_type stream_id = 0u;
+
+    bool are_clients_listening = false;
+
+    SendQueueStats queue;
+  };
+
 } // namespace detail
 } // namespace streaming
 } // namespace carla
@@ -11,12 +11,15 @@
 #include "carla/Exception.h"
 #include "carla/Logging.h"
 #include "carla/Time.h"
+#include "carla/streaming/detail/tcp/SocketOptions.h"
 
 #include <boost/asio/connect.hpp>
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
 
+#include <array>
 #include <exception>
+#include <utility>
 
 namespace carla {
 namespace streaming {
@@ -28,24 +31,75 @@ namespace tcp {
   // ===========================================================================
 
   /// Helper for reading incoming TCP messages. Allocates the whole message in
-  /// a single buffer.
+  /// a single buffer, taken from the size class of the message once its size
+  /// is known.
   class IncomingMessage {
   public:
 
-    explicit IncomingMessage(Buffer &&buffer) : _message(std::move(buffer)) {}
+    explicit IncomingMessage(BufferPool &pool) : _pool(pool) {}
 
     boost::asio::mutable_buffer size_as_buffer() {
       return boost::asio::buffer(&_size, sizeof(_size));
     }
 
+    /// The stream id and the size, preceding every message of a multiplexed
+    /// session.
+    std::array<boost::asio::mutable_buffer, 2u> multiplexed_header_as_buffer() {
+      return {
+          boost::asio::buffer(&_stream_id, sizeof(_stream_id)),
+          boost::asio::buffer(&_size, sizeof(_size))};
+    }
+
+    stream_id_type stream_id() const {
+      return _stream_id;
+    }
+
+    boost::asio::mutable_buffer position_as_buffer() {
+      return boost::asio::buffer(&_position, sizeof(_position));
+    }
+
     boost::asio::mutable_buffer buffer() {
-      DEBUG_ASSERT(_size > 0u);
-      _message.reset(_size);
+      DEBUG_ASSERT(size() > 0u);
+      _message = _pool.Pop(size());
       return _message.buffer();
     }
 
-    auto size() const {
-      return _size;
+    /// Whether the payload lies in the shared memory ring, in which case only
+    /// its position follows the header.
+    bool is_in_shared_memory() const {
+      return (_size & SHARED_MEMORY_FLAG) != 0u;
+    }
+
+    /// Whether the payload is compressed, in which case it has to go through
+    /// decompress() before handing it to the user.
+    bool is_compressed() const {
+      return (_size & COMPRESSED_FLAG) != 0u;
+    }
+
+    /// Replaces the compressed payload with the decompressed message.
+    bool decompress() {
+      DEBUG_ASSERT(is_compressed());
+      auto message = _pool.Pop();
+      if (!Decompress(_message, message)) {
+        return false;
+      }
+      _message = std::move(message);
+      return true;
+    }
+
+    /// Whether this is not a message but an offer to switch to shared memory.
+    bool is_shared_memory_offer() const {
+      return _size == SHARED_MEMORY_FLAG;
+    }
+
+    bool read_from(SharedMemoryRing &ring) {
+      DEBUG_ASSERT(is_in_shared_memory());
+      _message = _pool.Pop(size());
+      return ring.Pop(_position, size(), _message);
+    }
+
+    message_size_type size() const {
+      return _size & ~(SHARED_MEMORY_FLAG | COMPRESSED_FLAG);
     }
 
     auto pop() {
@@ -54,8 +108,14 @@ namespace tcp {
 
   private:
 
+    BufferPool &_pool;
+
+    stream_id_type _stream_id = 0u;
+
     message_size_type _size = 0u;
 
+    uint64_t _position = 0u;
+
     Buffer _message;
   };
 
@@ -70,6 +130,7 @@ namespace tcp {
     : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(
           std::string("tcp client ") + std::to_string(token.get_stream_id())),
       _token(token),
+      _multiplexed(false),
       _callback(std::move(callback)),
       _socket(io_context),
       _strand(io_context),
@@ -80,6 +141,21 @@ namespace tcp {
     }
   }
 
+  Client::Client(
+      boost::asio::io_context &io_context,
+      const token_type &token)
+    : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(std::string("tcp multiplexed client")),
+      _token(token),
+      _multiplexed(true),
+      _socket(io_context),
+      _strand(io_context),
+      _connection_timer(io_context),
+      _buffer_pool(std::make_shared<BufferPool>()) {
+    if (!_token.protocol_is_tcp()) {
+      throw_exception(std::invalid_argument("invalid token, only TCP tokens supported"));
+    }
+  }
+
   Client::~Client() = default;
 
   void Client::Connect() {
@@ -94,6 +170,11 @@ namespace tcp {
       if (_socket.is_open()) {
         _socket.close();
       }
+      _ring = nullptr;
+      ++_connection_count;
+      _is_connected = false;
+      _is_writing_requests = false;
+      _pending_requests.clear();
 
       DEBUG_ASSERT(_token.is_valid());
       DEBUG_ASSERT(_token.protocol_is_tcp());
@@ -105,34 +186,219 @@ namespace tcp {
             return;
           }
           log_debug("streaming client: connected to", ep);
-          // Send the stream id to subscribe to the stream.
-          const auto &stream_id = _token.get_stream_id();
-          log_debug("streaming client: sending stream id", stream_id);
-          boost::asio::async_write(
-              _socket,
-              boost::asio::buffer(&stream_id, sizeof(stream_id)),
-              _strand.wrap([=](error_code ec, size_t DEBUG_ONLY(bytes)) {
-            if (!ec) {
-              DEBUG_ASSERT_EQ(bytes, sizeof(stream_id));
-              // If succeeded start reading data.
-              ReadData();
-            } else {
-              // Else try again.
-              log_info("streaming client: failed to send stream id:", ec.message());
-              Connect();
-            }
-          }));
+          Subscribe();
         } else {
           log_info("streaming client: connection failed:", ec.message());
           Reconnect();
         }
       };
 
+      // The receive buffer is set before connecting, the window scale is
+      // negotiated in the handshake.
+      error_code ec;
+      _socket.open(ep.protocol(), ec);
+      if (!ec) {
+        ApplySocketBufferSize(_socket, _socket_buffer_size);
+      }
+
       log_debug("streaming client: connecting to", ep);
       _socket.async_connect(ep, _strand.wrap(handle_connect));
     });
   }
 
+  /// Whether both ends of the socket are in the same host.
+  static bool IsSameHost(const boost::asio::ip::tcp::socket &socket) {
+    boost::system::error_code ec;
+    const auto remote = socket.remote_endpoint(ec).address();
+    if (ec) {
+      return false;
+    }
+    const auto local = socket.local_endpoint(ec).address();
+    return !ec && (remote.is_loopback() || (remote == local));
+  }
+
+  void Client::Subscribe() {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    using boost::system::error_code;
+    auto self = shared_from_this();
+
+    _requested_transport = IsSameHost(_socket) ?
+        Transport::shared_memory :
+        Transport::tcp;
+
+    // Send the stream id to subscribe to the stream, a multiplexed client
+    // sends all its subscriptions right after.
+    const auto &stream_id = _multiplexed ? MULTIPLEXED_STREAM_ID : _token.get_stream_id();
+    log_debug("streaming client: sending stream id", stream_id);
+    _requests_in_flight.clear();
+    if (_multiplexed) {
+      std::lock_guard<std::mutex> lock(_callbacks_mutex);
+      for (auto &pair : _callbacks) {
+        _requests_in_flight.push_back({RequestType::Subscribe, pair.first});
+      }
+      _is_connected = true;
+      _is_writing_requests = true;
+    }
+    const std::array<boost::asio::const_buffer, 4u> request = {
+        boost::asio::buffer(&stream_id, sizeof(stream_id)),
+        boost::asio::buffer(&_requested_transport, sizeof(_requested_transport)),
+        boost::asio::buffer(&_supported_compression, sizeof(_supported_compression)),
+        boost::asio::buffer(_requests_in_flight)};
+    const auto connection = _connection_count;
+    boost::asio::async_write(
+        _socket,
+        request,
+        _strand.wrap([this, self, connection](error_code ec, size_t DEBUG_ONLY(bytes)) {
+      if (connection != _connection_count) {
+        return;
+      }
+      if (!ec) {
+        DEBUG_ASSERT_EQ(
+            bytes,
+            sizeof(stream_id_type) + sizeof(Transport) + sizeof(uint8_t) +
+            sizeof(StreamRequest) * _requests_in_flight.size());
+        // If succeeded start reading data.
+        ReadData();
+        if (_multiplexed) {
+          _requests_in_flight.clear();
+          WriteRequests();
+        }
+      } else {
+        // Else try again.
+        log_info("streaming client: failed to send stream id:", ec.message());
+        Connect();
+      }
+    }));
+  }
+
+  void Client::AcceptSharedMemory() {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    using boost::system::error_code;
+    auto self = shared_from_this();
+
+    auto handle_offer = [this, self](error_code ec, size_t) {
+      if (ec || (_requested_transport != Transport::shared_memory)) {
+        log_info("streaming client: failed to read shared memory offer:", ec.message());
+        Connect();
+        return;
+      }
+      _shared_memory_offer.name[sizeof(_shared_memory_offer.name) - 1u] = '\0';
+      if (_shared_memory_offer.accepted != 0u) {
+        _ring = SharedMemoryRing::Open(_shared_memory_offer.name);
+      }
+      if ((_ring != nullptr) && (_ring->GetCapacity() != _shared_memory_offer.capacity)) {
+        _ring = nullptr;
+      }
+      log_debug("streaming client: using", (_ring != nullptr ? "shared memory" : "tcp"));
+      // The answer goes up the socket while we keep reading messages, the
+      // server switches to the ring once it receives it.
+      _shared_memory_ack = (_ring != nullptr) ? 1u : 0u;
+      if (_multiplexed) {
+        QueueRequest({RequestType::SharedMemoryAck, _shared_memory_ack});
+        ReadData();
+        return;
+      }
+      boost::asio::async_write(
+          _socket,
+          boost::asio::buffer(&_shared_memory_ack, sizeof(_shared_memory_ack)),
+          _strand.wrap([self](error_code ec, size_t) {
+        if (ec) {
+          log_info("streaming client: failed to answer shared memory offer:", ec.message());
+        }
+      }));
+      ReadData();
+    };
+
+    boost::asio::async_read(
+        _socket,
+        boost::asio::buffer(&_shared_memory_offer, sizeof(_shared_memory_offer)),
+        _strand.wrap(handle_offer));
+  }
+
+  void Client::AddStream(const token_type &token, callback_function_type callback) {
+    DEBUG_ASSERT(_multiplexed);
+    DEBUG_ASSERT(token.to_tcp_endpoint() == _token.to_tcp_endpoint());
+    const auto stream_id = token.get_stream_id();
+    {
+      std::lock_guard<std::mutex> lock(_callbacks_mutex);
+      _callbacks[stream_id] = std::make_shared<callback_function_type>(std::move(callback));
+    }
+    _strand.post([this, self=shared_from_this(), stream_id]() {
+      QueueRequest({RequestType::Subscribe, stream_id});
+    });
+  }
+
+  void Client::RemoveStream(const stream_id_type stream_id) {
+    DEBUG_ASSERT(_multiplexed);
+    {
+      std::lock_guard<std::mutex> lock(_callbacks_mutex);
+      _callbacks.erase(stream_id);
+    }
+    _strand.post([this, self=shared_from_this(), stream_id]() {
+      QueueRequest({RequestType::UnSubscribe, stream_id});
+    });
+  }
+
+  void Client::QueueRequest(const StreamRequest request) {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    if (!_is_connected) {
+      // The subscriptions are sent when connecting.
+      return;
+    }
+    _pending_requests.push_back(request);
+    if (!_is_writing_requests) {
+      WriteRequests();
+    }
+  }
+
+  void Client::WriteRequests() {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    DEBUG_ASSERT(_requests_in_flight.empty());
+    if (_pending_requests.empty()) {
+      _is_writing_requests = false;
+      return;
+    }
+    _is_writing_requests = true;
+    std::swap(_requests_in_flight, _pending_requests);
+    const auto connection = _connection_count;
+    boost::asio::async_write(
+        _socket,
+        boost::asio::buffer(_requests_in_flight),
+        _strand.wrap([this, self=shared_from_this(), connection](
+            boost::system::error_code ec,
+            size_t) {
+      if (connection != _connection_count) {
+        return;
+      }
+      _requests_in_flight.clear();
+      if (ec) {
+        // Reading fails as well and starts over.
+        log_info("streaming client: failed to send request:", ec.message());
+        return;
+      }
+      WriteRequests();
+    }));
+  }
+
+  void Client::InvokeCallback(const stream_id_type stream_id, Buffer message) {
+    if (!_multiplexed) {
+      _callback(std::move(message));
+      return;
+    }
+    std::shared_ptr<callback_function_type> callback;
+    {
+      std::lock_guard<std::mutex> lock(_callbacks_mutex);
+      auto search = _callbacks.find(stream_id);
+      if (search != _callbacks.end()) {
+        callback = search->second;
+      }
+    }
+    // Messages may still arrive a while after removing a stream.
+    if (callback != nullptr) {
+      (*callback)(std::move(message));
+    }
+  }
+
   void Client::Stop() {
     _connection_timer.cancel();
     auto self = shared_from_this();
@@ -163,7 +429,7 @@ namespace tcp {
 
       log_debug("streaming client: Client::ReadData");
 
-      auto message = std::make_shared<IncomingMessage>(_buffer_pool->Pop());
+      auto message = std::make_shared<IncomingMessage>(*_buffer_pool);
 
       auto handle_read_data = [this, self, message](boost::system::error_code ec, size_t DEBUG_ONLY(bytes)) {
         DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_data", bytes, "bytes"));
@@ -173,7 +439,14 @@ namespace tcp {
           // Move the buffer to the callback function and start reading the next
           // piece of data.
           log_debug("streaming client: success reading data, calling the callback");
-          _strand.context().post([self, message]() { self->_callback(message->pop()); });
+          _strand.context().post([self, message]() {
+            // Decompress out of the strand so we keep reading meanwhile.
+            if (message->is_compressed() && !message->decompress()) {
+              log_error("streaming client: failed to decompress message, discarded");
+              return;
+            }
+            self->InvokeCallback(message->stream_id(), message->pop());
+          });
           ReadData();
         } else {
           // As usual, if anything fails start over from the very top.
@@ -182,15 +455,40 @@ namespace tcp {
         }
       };
 
-      auto handle_read_header = [this, self, message, handle_read_data](
+      auto handle_read_position = [this, self, message](boost::system::error_code ec, size_t) {
+        if (!ec && (_ring != nullptr) && message->read_from(*_ring)) {
+          log_debug("streaming client: success reading shared memory, calling the callback");
+          _strand.context().post([self, message]() {
+            self->InvokeCallback(message->stream_id(), message->pop());
+          });
+          ReadData();
+        } else {
+          log_info("streaming client: failed to read data from shared memory");
+          Connect();
+        }
+      };
+
+      auto handle_read_header = [this, self, message, handle_read_data, handle_read_position](
           boost::system::error_code ec,
           size_t DEBUG_ONLY(bytes)) {
         DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_header", bytes, "bytes"));
-        if (!ec && (message->size() > 0u)) {
-          DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type));
+        if (!ec && message->is_shared_memory_offer()) {
+          AcceptSharedMemory();
+        } else if (!ec && (message->size() > 0u)) {
+          DEBUG_ASSERT_EQ(
+              bytes,
+              sizeof(message_size_type) + (_multiplexed ? sizeof(stream_id_type) : 0u));
           if (_done) {
             return;
           }
+          if (message->is_in_shared_memory()) {
+            // The payload is in the ring, only its position follows.
+            boost::asio::async_read(
+                _socket,
+                message->position_as_buffer(),
+                _strand.wrap(handle_read_position));
+            return;
+          }
           // Now that we know the size of the coming buffer, we can allocate our
           // buffer and start putting data into it.
           boost::asio::async_read(
@@ -205,11 +503,19 @@ namespace tcp {
         }
       };
 
-      // Read the size of the buffer that is coming.
-      boost::asio::async_read(
-          _socket,
-          message->size_as_buffer(),
-          _strand.wrap(handle_read_header));
+      // Read the size of the buffer that is coming, preceded by its stream id
+      // if multiplexed.
+      if (_multiplexed) {
+        boost::asio::async_read(
+            _socket,
+            message->multiplexed_header_as_buffer(),
+            _strand.wrap(handle_read_header));
+      } else {
+        boost::asio::async_read(
+            _socket,
+            message->size_as_buffer(),
+            _strand.wrap(handle_read_header));
+      }
     });
   }
 
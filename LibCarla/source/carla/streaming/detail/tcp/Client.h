@@ -11,6 +11,9 @@
 #include "carla/profiler/LifetimeProfiled.h"
 #include "carla/streaming/detail/Token.h"
 #include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/tcp/Compression.h"
+#include "carla/streaming/detail/tcp/Multiplexing.h"
+#include "carla/streaming/detail/tcp/SharedMemoryRing.h"
 
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/io_context.hpp>
@@ -20,6 +23,9 @@
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace carla {
 
@@ -31,6 +37,14 @@ namespace tcp {
 
   /// A client that connects to a single stream.
   ///
+  /// If the server runs in the same host, the client asks for the shared
+  /// memory transport when subscribing and falls back to plain TCP if it
+  /// cannot be established.
+  ///
+  /// A multiplexed client instead carries every stream of a server added with
+  /// AddStream() through a single connection. The streams are subscribed to
+  /// again in a single write every time the client reconnects.
+  ///
   /// @warning This client should be stopped before releasing the shared pointer
   /// or won't be destroyed.
   class Client
@@ -48,26 +62,78 @@ namespace tcp {
         const token_type &token,
         callback_function_type callback);
 
+    /// Creates a multiplexed client connecting to the server of @a token.
+    Client(boost::asio::io_context &io_context, const token_type &token);
+
     ~Client();
 
+    /// Set the size in bytes of the kernel send and receive buffers of the
+    /// socket, zero keeps the system defaults. Applies from the next call to
+    /// Connect().
+    void SetSocketBufferSize(size_t size) {
+      _socket_buffer_size = size;
+    }
+
     void Connect();
 
     stream_id_type GetStreamId() const {
       return _token.get_stream_id();
     }
 
+    endpoint GetEndPoint() const {
+      return _token.to_tcp_endpoint();
+    }
+
+    bool IsMultiplexed() const {
+      return _multiplexed;
+    }
+
+    /// Subscribes a multiplexed client to the stream of @a token, which must
+    /// belong to the same server. @a callback is called with every message of
+    /// the stream.
+    void AddStream(const token_type &token, callback_function_type callback);
+
+    /// Unsubscribes a multiplexed client from @a stream_id.
+    void RemoveStream(stream_id_type stream_id);
+
     void Stop();
 
   private:
 
+    /// Sends the stream id and the requested transport, then starts reading.
+    /// Shared memory is requested only if the server runs in the same host.
+    void Subscribe();
+
+    /// Reads the shared memory offer sent by the server, maps the segment and
+    /// answers whether it succeeded.
+    void AcceptSharedMemory();
+
     void Reconnect();
 
     void ReadData();
 
+    void InvokeCallback(stream_id_type stream_id, Buffer message);
+
+    /// Sends @a request to the server of a multiplexed client, must be called
+    /// within the strand.
+    void QueueRequest(StreamRequest request);
+
+    /// Sends every pending request, must be called within the strand.
+    void WriteRequests();
+
     const token_type _token;
 
+    const bool _multiplexed;
+
     callback_function_type _callback;
 
+    mutable std::mutex _callbacks_mutex;
+
+    /// Callbacks of the streams of a multiplexed client.
+    std::unordered_map<
+        stream_id_type,
+        std::shared_ptr<callback_function_type>> _callbacks;
+
     boost::asio::ip::tcp::socket _socket;
 
     boost::asio::io_context::strand _strand;
@@ -76,6 +142,32 @@ namespace tcp {
 
     std::shared_ptr<BufferPool> _buffer_pool;
 
+    Transport _requested_transport = Transport::tcp;
+
+    uint8_t _supported_compression = SUPPORTED_COMPRESSION;
+
+    std::atomic_size_t _socket_buffer_size{0u};
+
+    SharedMemoryOffer _shared_memory_offer;
+
+    uint8_t _shared_memory_ack = 0u;
+
+    std::unique_ptr<SharedMemoryRing> _ring;
+
+    /// The members below are only accessed within the strand.
+
+    /// Incremented every time the client connects, handlers of a previous
+    /// connection are ignored.
+    size_t _connection_count = 0u;
+
+    bool _is_connected = false;
+
+    bool _is_writing_requests = false;
+
+    std::vector<StreamRequest> _pending_requests;
+
+    std::vector<StreamRequest> _requests_in_flight;
+
     std::atomic_bool _done{false};
   };
 
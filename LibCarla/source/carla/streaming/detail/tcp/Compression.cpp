@@ -0,0 +1,118 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/tcp/Compression.h"
+
+#include "carla/BufferPool.h"
+#include "carla/Debug.h"
+#include "carla/Lz4.h"
+
+#include <cstring>
+#include <memory>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  // ===========================================================================
+  // -- Delta predictor --------------------------------------------------------
+  // ===========================================================================
+
+  static constexpr size_t DELTA_STRIDE = 4u;
+
+  static void DeltaEncode(unsigned char *data, const size_t size) {
+    for (size_t i = size; i > DELTA_STRIDE; --i) {
+      data[i - 1u] = static_cast<unsigned char>(data[i - 1u] - data[i - 1u - DELTA_STRIDE]);
+    }
+  }
+
+  static void DeltaDecode(unsigned char *data, const size_t size) {
+    for (size_t i = DELTA_STRIDE; i < size; ++i) {
+      data[i] = static_cast<unsigned char>(data[i] + data[i - DELTA_STRIDE]);
+    }
+  }
+
+  // ===========================================================================
+  // -- Compress and Decompress ------------------------------------------------
+  // ===========================================================================
+
+  static BufferPool &GetBufferPool() {
+    static auto pool = std::make_shared<BufferPool>();
+    return *pool;
+  }
+
+  bool Compress(
+      const Compression codec,
+      const boost::asio::const_buffer *buffers,
+      const size_t number_of_buffers,
+      Buffer &frame) {
+    DEBUG_ASSERT(codec != Compression::None);
+    size_t size = 0u;
+    for (auto i = 0u; i < number_of_buffers; ++i) {
+      size += buffers[i].size();
+    }
+    const size_t header_size = sizeof(message_size_type) + sizeof(CompressedHeader);
+    const size_t frame_size = header_size + Lz4::CompressBound(size);
+    if ((size < COMPRESSION_MIN_MESSAGE_SIZE) || (frame_size >= COMPRESSED_FLAG)) {
+      return false;
+    }
+
+    // The window of LZ4 spans the whole message, gather it first.
+    auto input = GetBufferPool().Pop(static_cast<Buffer::size_type>(size));
+    auto *position = input.data();
+    for (auto i = 0u; i < number_of_buffers; ++i) {
+      std::memcpy(position, buffers[i].data(), buffers[i].size());
+      position += buffers[i].size();
+    }
+    if (codec == Compression::DeltaLZ4) {
+      DeltaEncode(input.data(), input.size());
+    }
+
+    frame = GetBufferPool().Pop(static_cast<Buffer::size_type>(frame_size));
+    const auto compressed_size = Lz4::Compress(input.data(), input.size(), frame.data() + header_size);
+    if ((compressed_size + sizeof(CompressedHeader)) >= size) {
+      frame = Buffer();
+      return false;
+    }
+    const auto body_size = static_cast<message_size_type>(sizeof(CompressedHeader) + compressed_size);
+    const message_size_type flagged_size = body_size | COMPRESSED_FLAG;
+    CompressedHeader header;
+    header.codec = codec;
+    header.uncompressed_size = static_cast<message_size_type>(size);
+    std::memcpy(frame.data(), &flagged_size, sizeof(flagged_size));
+    std::memcpy(frame.data() + sizeof(flagged_size), &header, sizeof(header));
+    frame.reset(static_cast<Buffer::size_type>(sizeof(flagged_size) + body_size));
+    return true;
+  }
+
+  bool Decompress(const Buffer &body, Buffer &message) {
+    CompressedHeader header;
+    if (body.size() < sizeof(header)) {
+      return false;
+    }
+    std::memcpy(&header, body.data(), sizeof(header));
+    if ((header.codec != Compression::LZ4) && (header.codec != Compression::DeltaLZ4)) {
+      return false;
+    }
+    message.reset(header.uncompressed_size);
+    if (!Lz4::Decompress(
+            body.data() + sizeof(header),
+            body.size() - sizeof(header),
+            message.data(),
+            message.size())) {
+      return false;
+    }
+    if (header.codec == Compression::DeltaLZ4) {
+      DeltaDecode(message.data(), message.size());
+    }
+    return true;
+  }
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,66 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/streaming/detail/Types.h"
+
+#include <boost/asio/buffer.hpp>
+
+#include <cstdint>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+#pragma pack(push, 1)
+
+  /// Precedes the data of a compressed message. The message size sent in the
+  /// header has COMPRESSED_FLAG set and includes this header.
+  struct CompressedHeader {
+    Compression codec = Compression::None;
+
+    message_size_type uncompressed_size = 0u;
+  };
+
+#pragma pack(pop)
+
+  /// Bit of the message size flagging a compressed message.
+  static constexpr message_size_type COMPRESSED_FLAG = 1u << 30u;
+
+  /// Smaller messages are never compressed.
+  static constexpr message_size_type COMPRESSION_MIN_MESSAGE_SIZE = 4u * 1024u;
+
+  /// Bit of @a codec in the mask of codecs a client supports.
+  constexpr uint8_t GetCompressionBit(Compression codec) {
+    return static_cast<uint8_t>(1u << static_cast<uint8_t>(codec));
+  }
+
+  /// Codecs this client knows how to decompress, sent when subscribing.
+  static constexpr uint8_t SUPPORTED_COMPRESSION =
+      GetCompressionBit(Compression::LZ4) |
+      GetCompressionBit(Compression::DeltaLZ4);
+
+  /// Compresses the concatenation of @a buffers into @a frame, ready to be
+  /// written to the socket: the flagged message size, the CompressedHeader,
+  /// and the compressed data. Returns false if the compressed message is not
+  /// smaller than the original, in which case @a frame is left empty.
+  bool Compress(
+      Compression codec,
+      const boost::asio::const_buffer *buffers,
+      size_t number_of_buffers,
+      Buffer &frame);
+
+  /// Decompresses the @a body of a compressed message, i.e. everything after
+  /// the message size, into @a message. Returns false if the data is corrupt.
+  bool Decompress(const Buffer &body, Buffer &message);
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
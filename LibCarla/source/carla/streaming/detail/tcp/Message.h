@@ -11,6 +11,7 @@
 #include "carla/Debug.h"
 #include "carla/NonCopyable.h"
 #include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/tcp/Compression.h"
 
 #include <boost/asio/buffer.hpp>
 
@@ -18,6 +19,7 @@
 #include <exception>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace carla {
@@ -75,6 +77,19 @@ namespace tcp {
       return MakeListView(begin, begin + _number_of_buffers + 1u);
     }
 
+    /// Returns this message compressed with @a codec, ready to be written to
+    /// the socket in place of GetBufferSequence(), or nullptr if compressing
+    /// does not make it smaller. The message is compressed only once, by the
+    /// first session sending it, and shared by the rest.
+    ///
+    /// @warning Every call must use the same codec.
+    const Buffer *GetCompressed(Compression codec) const {
+      std::call_once(_compress_once, [&]() {
+        _is_compressed = Compress(codec, _buffer_views.data() + 1u, _number_of_buffers, _compressed);
+      });
+      return _is_compressed ? &_compressed : nullptr;
+    }
+
   private:
 
     message_size_type _number_of_buffers = 0u;
@@ -84,6 +99,12 @@ namespace tcp {
     std::array<Buffer, MaxNumberOfBuffers> _buffers;
 
     std::array<boost::asio::const_buffer, MaxNumberOfBuffers + 1u> _buffer_views;
+
+    mutable std::once_flag _compress_once;
+
+    mutable bool _is_compressed = false;
+
+    mutable Buffer _compressed;
   };
 
   /// A TCP message containing a maximum of 2 buffers. This is optimized for a
@@ -0,0 +1,45 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/streaming/detail/Types.h"
+
+#include <cstdint>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// Stream id sent by a client opening a multiplexed session, a single
+  /// connection carrying the messages of every stream the client subscribes
+  /// to. The dispatcher never gives this id to a stream.
+  static constexpr stream_id_type MULTIPLEXED_STREAM_ID = 0u;
+
+  /// Requests sent by the client of a multiplexed session.
+  enum class RequestType : uint8_t {
+    Subscribe,
+    UnSubscribe,
+    /// Answer to a shared memory offer, the stream id field holds one if the
+    /// client mapped the ring or zero otherwise.
+    SharedMemoryAck
+  };
+
+#pragma pack(push, 1)
+
+  struct StreamRequest {
+    RequestType type = RequestType::Subscribe;
+
+    stream_id_type stream_id = 0u;
+  };
+
+#pragma pack(pop)
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -7,6 +7,7 @@
 #include "carla/streaming/detail/tcp/Server.h"
 
 #include "carla/Logging.h"
+#include "carla/streaming/detail/tcp/SocketOptions.h"
 
 #include <memory>
 
@@ -18,19 +19,27 @@ namespace tcp {
   Server::Server(boost::asio::io_context &io_context, endpoint ep)
     : _io_context(io_context),
       _acceptor(_io_context, std::move(ep)),
-      _timeout(time_duration::seconds(10u)) {}
+      _timeout(time_duration::seconds(10u)),
+      _shared_memory_capacity(64u * 1024u * 1024u),
+      _socket_buffer_size(0u) {}
 
   void Server::OpenSession(
       time_duration timeout,
       ServerSession::callback_function_type on_opened,
-      ServerSession::callback_function_type on_closed) {
+      ServerSession::callback_function_type on_closed,
+      ServerSession::request_function_type on_request) {
     using boost::system::error_code;
 
-    auto session = std::make_shared<ServerSession>(_io_context, timeout);
+    auto session = std::make_shared<ServerSession>(
+        _io_context,
+        timeout,
+        _shared_memory_capacity);
 
-    auto handle_query = [on_opened, on_closed, session](const error_code &ec) {
+    auto handle_query = [this, on_opened, on_closed, on_request, session](const error_code &ec) {
       if (!ec) {
-        session->Open(std::move(on_opened), std::move(on_closed));
+        // Read when accepted, the session is created before it is needed.
+        ApplySocketBufferSize(session->_socket, _socket_buffer_size);
+        session->Open(std::move(on_opened), std::move(on_closed), std::move(on_request));
       } else {
         log_error("tcp accept error:", ec.message());
       }
@@ -39,7 +48,7 @@ namespace tcp {
     _acceptor.async_accept(session->_socket, [=](error_code ec) {
       // Handle query and open a new session immediately.
       _io_context.post([=]() { handle_query(ec); });
-      OpenSession(timeout, on_opened, on_closed);
+      OpenSession(timeout, on_opened, on_closed, on_request);
     });
   }
 
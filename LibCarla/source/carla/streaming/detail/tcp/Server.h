@@ -40,6 +40,20 @@ namespace tcp {
       _timeout = timeout;
     }
 
+    /// Set the capacity in bytes of the shared memory ring given to clients
+    /// running in the same host. Applies only to newly created sessions. Zero
+    /// disables the shared memory transport. By default it is set to 64 MB.
+    void SetSharedMemoryCapacity(size_t capacity) {
+      _shared_memory_capacity = capacity;
+    }
+
+    /// Set the size in bytes of the kernel send and receive buffers of the
+    /// sockets. Applies only to connections accepted from now on. Zero, the
+    /// default, keeps the system defaults.
+    void SetSocketBufferSize(size_t size) {
+      _socket_buffer_size = size;
+    }
+
     /// Start listening for connections. On each new connection, @a
     /// on_session_opened is called, and @a on_session_closed when the session
     /// is closed.
@@ -49,7 +63,26 @@ namespace tcp {
         OpenSession(
             _timeout,
             std::move(on_session_opened),
-            std::move(on_session_closed));
+            std::move(on_session_closed),
+            nullptr);
+      });
+    }
+
+    /// @copydoc Listen(FunctorT1, FunctorT2)
+    ///
+    /// Multiplexed sessions call @a on_session_request for every subscription
+    /// request received.
+    template <typename FunctorT1, typename FunctorT2, typename FunctorT3>
+    void Listen(
+        FunctorT1 on_session_opened,
+        FunctorT2 on_session_closed,
+        FunctorT3 on_session_request) {
+      _io_context.post([=]() {
+        OpenSession(
+            _timeout,
+            std::move(on_session_opened),
+            std::move(on_session_closed),
+            std::move(on_session_request));
       });
     }
 
@@ -58,13 +91,18 @@ namespace tcp {
     void OpenSession(
         time_duration timeout,
         ServerSession::callback_function_type on_session_opened,
-        ServerSession::callback_function_type on_session_closed);
+        ServerSession::callback_function_type on_session_closed,
+        ServerSession::request_function_type on_session_request);
 
     boost::asio::io_context &_io_context;
 
     boost::asio::ip::tcp::acceptor _acceptor;
 
     std::atomic<time_duration> _timeout;
+
+    std::atomic_size_t _shared_memory_capacity;
+
+    std::atomic_size_t _socket_buffer_size;
   };
 
 } // namespace tcp
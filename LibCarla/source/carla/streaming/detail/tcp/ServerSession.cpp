@@ -12,7 +12,11 @@
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <cstring>
+#include <iterator>
 
 namespace carla {
 namespace streaming {
@@ -21,22 +25,29 @@ namespace tcp {
 
   static std::atomic_size_t SESSION_COUNTER{0u};
 
+  /// Precedes the shared memory offer in multiplexed sessions.
+  static const stream_id_type OFFER_STREAM_ID = MULTIPLEXED_STREAM_ID;
+
   ServerSession::ServerSession(
       boost::asio::io_context &io_context,
-      const time_duration timeout)
+      const time_duration timeout,
+      const size_t shared_memory_capacity)
     : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(
           std::string("tcp server session ") + std::to_string(SESSION_COUNTER)),
       _session_id(SESSION_COUNTER++),
       _socket(io_context),
       _timeout(timeout),
       _deadline(io_context),
-      _strand(io_context) {}
+      _strand(io_context),
+      _shared_memory_capacity(shared_memory_capacity) {}
 
   void ServerSession::Open(
       callback_function_type on_opened,
-      callback_function_type on_closed) {
+      callback_function_type on_closed,
+      request_function_type on_request) {
     DEBUG_ASSERT(on_opened && on_closed);
     _on_closed = std::move(on_closed);
+    _on_request = std::move(on_request);
     StartTimer();
     auto self = shared_from_this(); // To keep myself alive.
     _strand.post([=]() {
@@ -45,63 +56,366 @@ namespace tcp {
           const boost::system::error_code &ec,
           size_t DEBUG_ONLY(bytes_received)) {
         if (!ec) {
-          DEBUG_ASSERT_EQ(bytes_received, sizeof(_stream_id));
+          DEBUG_ASSERT_EQ(
+              bytes_received,
+              sizeof(_stream_id) + sizeof(_requested_transport) + sizeof(_supported_compression));
           log_debug("session", _session_id, "for stream", _stream_id, " started");
           _strand.context().post([=]() { callback(self); });
+          if (IsMultiplexed()) {
+            ReadRequests();
+          } else {
+            ReadSharedMemoryAck();
+          }
         } else {
           log_error("session", _session_id, ": error retrieving stream id :", ec.message());
           CloseNow();
         }
       };
 
-      // Read the stream id.
+      // Read the stream id, the requested transport and the supported codecs.
+      const std::array<boost::asio::mutable_buffer, 3u> request = {
+          boost::asio::buffer(&_stream_id, sizeof(_stream_id)),
+          boost::asio::buffer(&_requested_transport, sizeof(_requested_transport)),
+          boost::asio::buffer(&_supported_compression, sizeof(_supported_compression))};
       _deadline.expires_from_now(_timeout);
       boost::asio::async_read(
           _socket,
-          boost::asio::buffer(&_stream_id, sizeof(_stream_id)),
+          request,
           _strand.wrap(handle_query));
     });
   }
 
-  void ServerSession::Write(std::shared_ptr<const Message> message) {
-    DEBUG_ASSERT(message != nullptr);
-    DEBUG_ASSERT(!message->empty());
+  void ServerSession::OfferSharedMemory() {
     auto self = shared_from_this();
-    _strand.post([=]() {
-      if (!_socket.is_open()) {
+    // Allocating the segment may take a while, keep it out of the strand.
+    _strand.context().post([this, self]() {
+      std::shared_ptr<SharedMemoryRing> ring = SharedMemoryRing::Create(_shared_memory_capacity);
+      if (ring == nullptr) {
+        return;
+      }
+      _strand.post([this, self, ring]() {
+        if (!_socket.is_open()) {
+          return;
+        }
+        _ring = ring;
+        const auto &name = _ring->GetName();
+        DEBUG_ASSERT(name.size() < sizeof(_shared_memory_offer.name));
+        _shared_memory_offer.accepted = 1u;
+        _shared_memory_offer.capacity = _ring->GetCapacity();
+        std::strncpy(_shared_memory_offer.name, name.c_str(), sizeof(_shared_memory_offer.name) - 1u);
+        _is_offer_pending = true;
+        bool start_writing = false;
+        {
+          std::lock_guard<std::mutex> lock(_queue_mutex);
+          start_writing = !_is_writing;
+          _is_writing = true;
+        }
+        if (start_writing) {
+          WriteQueued();
+        }
+      });
+    });
+  }
+
+  void ServerSession::ReadSharedMemoryAck() {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    auto handle_ack = [this, self=shared_from_this()](const boost::system::error_code &ec, size_t) {
+      if (ec) {
+        // The client closed the connection, close now instead of waiting for
+        // the next write to fail so the stream knows nobody listens.
+        _ring = nullptr;
+        CloseNow();
         return;
       }
-      if (_is_writing) {
-        log_debug("session", _session_id, ": connection too slow: message discarded");
+      HandleSharedMemoryAck(_shared_memory_ack != 0u);
+      ReadSharedMemoryAck();
+    };
+    boost::asio::async_read(
+        _socket,
+        boost::asio::buffer(&_shared_memory_ack, sizeof(_shared_memory_ack)),
+        _strand.wrap(handle_ack));
+  }
+
+  void ServerSession::HandleSharedMemoryAck(const bool accepted) {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    if (_ring == nullptr) {
+      return;
+    }
+    // The client has mapped the segment (or failed to), its name is no
+    // longer needed.
+    _ring->RemoveName();
+    if (accepted) {
+      log_debug("session", _session_id, ": using shared memory");
+      _uses_shared_memory = true;
+    } else {
+      log_info("session", _session_id, ": client could not open shared memory, using tcp");
+      _ring = nullptr;
+    }
+  }
+
+  void ServerSession::ReadRequests() {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    auto handle_request = [this, self=shared_from_this()](const boost::system::error_code &ec, size_t) {
+      if (ec) {
+        log_debug("session", _session_id, ": connection closed by the client:", ec.message());
+        CloseNow();
         return;
       }
+      _deadline.expires_from_now(_timeout);
+      const auto request = _request;
+      switch (request.type) {
+        case RequestType::SharedMemoryAck:
+          HandleSharedMemoryAck(request.stream_id != 0u);
+          break;
+        case RequestType::Subscribe:
+        case RequestType::UnSubscribe: {
+          bool changed;
+          {
+            std::lock_guard<std::mutex> lock(_queue_mutex);
+            if (request.type == RequestType::Subscribe) {
+              changed = _subscribed_streams.insert(request.stream_id).second;
+            } else {
+              changed = (_subscribed_streams.erase(request.stream_id) > 0u);
+            }
+          }
+          // Called within the strand so the requests are handled in order.
+          if (changed && _on_request) {
+            _on_request(self, request);
+          }
+          break;
+        }
+        default:
+          log_error("session", _session_id, ": invalid request");
+          CloseNow();
+          return;
+      }
+      ReadRequests();
+    };
+    boost::asio::async_read(
+        _socket,
+        boost::asio::buffer(&_request, sizeof(_request)),
+        _strand.wrap(handle_request));
+  }
+
+  std::vector<stream_id_type> ServerSession::GetSubscribedStreams() const {
+    std::lock_guard<std::mutex> lock(_queue_mutex);
+    return {_subscribed_streams.begin(), _subscribed_streams.end()};
+  }
+
+  void ServerSession::DropOldest(const stream_id_type stream_id) {
+    auto it = std::find_if(_queue.begin(), _queue.end(), [=](const QueuedMessage &item) {
+      return item.stream_id == stream_id;
+    });
+    DEBUG_ASSERT(it != _queue.end());
+    _queue.erase(it);
+    --_queued_per_stream[stream_id];
+    ++_stats_per_stream[stream_id].dropped_messages;
+  }
+
+  void ServerSession::WriteTo(
+      const stream_id_type stream_id,
+      std::shared_ptr<const Message> message) {
+    DEBUG_ASSERT(message != nullptr);
+    DEBUG_ASSERT(!message->empty());
+    DEBUG_ASSERT(IsMultiplexed() || (stream_id == _stream_id));
+    std::unique_lock<std::mutex> lock(_queue_mutex);
+    if (_is_closed) {
+      return;
+    }
+    // Elements of an unordered_map are never moved, and this one is only
+    // cleared once the session is closed.
+    auto &queued = _queued_per_stream[stream_id];
+    if (queued >= _queue_settings.max_queued_messages) {
+      switch (_queue_settings.policy) {
+        case OverflowPolicy::DropOldest:
+          LOG_DEBUG_EVERY(1.0, "session", _session_id, ": connection too slow: oldest message discarded");
+          DropOldest(stream_id);
+          break;
+        case OverflowPolicy::DropNewest:
+          LOG_DEBUG_EVERY(1.0, "session", _session_id, ": connection too slow: message discarded");
+          ++_stats_per_stream[stream_id].dropped_messages;
+          return;
+        case OverflowPolicy::BlockProducer:
+          if (!_queue_not_full.wait_for(lock, _timeout.to_chrono(), [this, &queued]() {
+                return _is_closed || (queued < _queue_settings.max_queued_messages);
+              })) {
+            LOG_DEBUG_EVERY(1.0, "session", _session_id, ": connection too slow: message discarded");
+            ++_stats_per_stream[stream_id].dropped_messages;
+            return;
+          }
+          if (_is_closed) {
+            return;
+          }
+          break;
+      }
+    }
+    if ((message->size() >= SHARED_MEMORY_MIN_MESSAGE_SIZE) &&
+        (_requested_transport == Transport::shared_memory) &&
+        (_shared_memory_capacity > 0u) &&
+        !_is_offer_requested.exchange(true)) {
+      OfferSharedMemory();
+    }
+    const auto size = message->size();
+    _queue.push_back({stream_id, std::move(message), TrackedMemory{MemoryTag::StreamingQueue, size}});
+    ++queued;
+    if (!_is_writing) {
       _is_writing = true;
+      lock.unlock();
+      _strand.post([self=shared_from_this()]() { self->WriteQueued(); });
+    }
+  }
 
-      auto handle_sent = [this, self, message](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
+  void ServerSession::WriteQueued() {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      DEBUG_ASSERT(_is_writing);
+      DEBUG_ASSERT(_in_flight.empty());
+      if (!_socket.is_open()) {
+        _queue.clear();
+        _queue_not_full.notify_all();
+      }
+      if (_queue.empty() && !_is_offer_pending) {
         _is_writing = false;
-        if (ec) {
-          log_info("session", _session_id, ": error sending data :", ec.message());
-          CloseNow();
-        } else {
-          DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
-          DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type) + message->size());
+        return;
+      }
+      _in_flight.assign(
+          std::make_move_iterator(_queue.begin()),
+          std::make_move_iterator(_queue.end()));
+      _queue.clear();
+      for (auto &pair : _queued_per_stream) {
+        pair.second = 0u;
+      }
+    }
+    _queue_not_full.notify_all();
+
+    // Gather the messages into a single write, messages fitting in the shared
+    // memory ring only send their descriptor.
+    _buffer_sequence.clear();
+    _descriptors.clear();
+    _descriptors.reserve(_in_flight.size());
+    _frame_stream_ids.clear();
+    _frame_stream_ids.reserve(_in_flight.size());
+    const bool is_multiplexed = IsMultiplexed();
+    size_t total_size = 0u;
+    if (_is_offer_pending) {
+      // The offer goes first, flagged as an empty message.
+      _is_offer_pending = false;
+      if (is_multiplexed) {
+        _buffer_sequence.emplace_back(&OFFER_STREAM_ID, sizeof(OFFER_STREAM_ID));
+        total_size += sizeof(OFFER_STREAM_ID);
+      }
+      _buffer_sequence.emplace_back(&SHARED_MEMORY_FLAG, sizeof(SHARED_MEMORY_FLAG));
+      _buffer_sequence.emplace_back(&_shared_memory_offer, sizeof(_shared_memory_offer));
+      total_size += sizeof(SHARED_MEMORY_FLAG) + sizeof(_shared_memory_offer);
+    }
+    const Compression codec = _compression;
+    for (auto &item : _in_flight) {
+      if (is_multiplexed) {
+        _frame_stream_ids.push_back(item.stream_id);
+        _buffer_sequence.emplace_back(&_frame_stream_ids.back(), sizeof(stream_id_type));
+        total_size += sizeof(stream_id_type);
+      }
+      auto &message = item.message;
+      uint64_t position;
+      const Buffer *compressed = nullptr;
+      if (_uses_shared_memory &&
+          (message->size() >= SHARED_MEMORY_MIN_MESSAGE_SIZE) &&
+          _ring->TryPush(*message, position)) {
+        _descriptors.push_back({message->size() | SHARED_MEMORY_FLAG, position});
+        _buffer_sequence.emplace_back(&_descriptors.back(), sizeof(SharedMemoryDescriptor));
+        total_size += sizeof(SharedMemoryDescriptor);
+      } else if (ShouldCompress(*message, codec) &&
+                 ((compressed = message->GetCompressed(codec)) != nullptr)) {
+        _buffer_sequence.emplace_back(compressed->cbuffer());
+        total_size += compressed->size();
+      } else {
+        auto buffers = message->GetBufferSequence();
+        _buffer_sequence.insert(_buffer_sequence.end(), buffers.begin(), buffers.end());
+        total_size += sizeof(message_size_type) + message->size();
+      }
+    }
+
+    auto handle_sent = [this, self=shared_from_this(), total_size](
+        const boost::system::error_code &ec,
+        size_t DEBUG_ONLY(bytes)) {
+      if (ec) {
+        log_info("session", _session_id, ": error sending data :", ec.message());
+        _in_flight.clear();
+        CloseNow();
+      } else {
+        DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
+        DEBUG_ASSERT_EQ(bytes, total_size);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(
+            std::chrono::steady_clock::now() - _write_start).count();
+        {
+          std::lock_guard<std::mutex> lock(_queue_mutex);
+          for (auto &item : _in_flight) {
+            auto &stats = _stats_per_stream[item.stream_id];
+            ++stats.sent_messages;
+            stats.sent_bytes += item.message->size();
+            stats.total_write_seconds += elapsed;
+            stats.max_write_seconds = std::max(stats.max_write_seconds, elapsed);
+          }
         }
-      };
+        _in_flight.clear();
+        WriteQueued();
+      }
+    };
 
-      log_debug("session", _session_id, ": sending message of", message->size(), "bytes");
+    log_debug("session", _session_id, ": sending", _in_flight.size(), "messages in", total_size, "bytes");
 
-      _deadline.expires_from_now(_timeout);
-      boost::asio::async_write(
-          _socket,
-          message->GetBufferSequence(),
-          _strand.wrap(handle_sent));
-    });
+    _deadline.expires_from_now(_timeout);
+    _write_start = std::chrono::steady_clock::now();
+    boost::asio::async_write(
+        _socket,
+        _buffer_sequence,
+        _strand.wrap(handle_sent));
+  }
+
+  bool ServerSession::ShouldCompress(const Message &message, const Compression codec) const {
+    return
+        (codec != Compression::None) &&
+        ((_supported_compression & GetCompressionBit(codec)) != 0u) &&
+        (_requested_transport == Transport::tcp) &&
+        (message.size() >= COMPRESSION_MIN_MESSAGE_SIZE);
   }
 
   void ServerSession::Close() {
     _strand.post([self=shared_from_this()]() { self->CloseNow(); });
   }
 
+  void ServerSession::SetSendQueueSettings(const SendQueueSettings &settings) {
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      _queue_settings = settings;
+      _queue_settings.max_queued_messages = std::max<size_t>(1u, settings.max_queued_messages);
+      for (auto it = _queue.begin(); it != _queue.end(); ) {
+        auto &queued = _queued_per_stream[it->stream_id];
+        if (queued > _queue_settings.max_queued_messages) {
+          ++_stats_per_stream[it->stream_id].dropped_messages;
+          it = _queue.erase(it);
+          --queued;
+        } else {
+          ++it;
+        }
+      }
+    }
+    _queue_not_full.notify_all();
+  }
+
+  SendQueueStats ServerSession::GetSendQueueStats(const stream_id_type stream_id) const {
+    SendQueueStats stats;
+    std::lock_guard<std::mutex> lock(_queue_mutex);
+    auto it = _stats_per_stream.find(stream_id);
+    if (it != _stats_per_stream.end()) {
+      stats = it->second;
+    }
+    auto queued = _queued_per_stream.find(stream_id);
+    stats.queued_messages = queued != _queued_per_stream.end() ? queued->second : 0u;
+    return stats;
+  }
+
   void ServerSession::StartTimer() {
     if (_deadline.expires_at() <= boost::asio::deadline_timer::traits_type::now()) {
       log_debug("session", _session_id, "timed out");
@@ -120,6 +434,15 @@ namespace tcp {
   void ServerSession::CloseNow() {
     DEBUG_ASSERT(_strand.running_in_this_thread());
     _deadline.cancel();
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      if (_is_closed) {
+        return;
+      }
+      _is_closed = true;
+      _queue.clear();
+    }
+    _queue_not_full.notify_all();
     if (_socket.is_open()) {
       _socket.close();
     }
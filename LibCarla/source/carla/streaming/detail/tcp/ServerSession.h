@@ -6,20 +6,31 @@
 
 #pragma once
 
+#include "carla/MemoryAccounting.h"
 #include "carla/NonCopyable.h"
 #include "carla/Time.h"
 #include "carla/TypeTraits.h"
 #include "carla/profiler/LifetimeProfiled.h"
 #include "carla/streaming/detail/Types.h"
 #include "carla/streaming/detail/tcp/Message.h"
+#include "carla/streaming/detail/tcp/Multiplexing.h"
+#include "carla/streaming/detail/tcp/SharedMemoryRing.h"
 
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/strand.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace carla {
 namespace streaming {
@@ -29,6 +40,28 @@ namespace tcp {
   /// A TCP server session. When a session opens, it reads from the socket a
   /// stream id object and passes itself to the callback functor. The session
   /// closes itself after @a timeout of inactivity is met.
+  ///
+  /// Messages written while the socket is busy wait in a bounded send queue,
+  /// what happens when the queue is full is decided by its OverflowPolicy.
+  /// Every queued message is sent in a single gathered write.
+  ///
+  /// A client running in the same host may ask for the shared memory
+  /// transport when subscribing. Once the stream writes a big message the
+  /// session offers it a SharedMemoryRing, and after the client accepts it
+  /// the payload of big messages is written into the ring and only their
+  /// position goes through the socket. Messages that don't fit in the ring
+  /// are sent through the socket as usual.
+  ///
+  /// Big messages sent to clients in other hosts are compressed with the
+  /// codec of the stream if the client supports it. Compression runs on the
+  /// io threads, when the message is about to be written.
+  ///
+  /// A client may open a multiplexed session instead by sending
+  /// MULTIPLEXED_STREAM_ID, and then request the streams to subscribe to over
+  /// the same connection. Every message is then preceded by the id of its
+  /// stream, and each stream gets its own send queue limit. The queue policy
+  /// and the codec are shared by every stream of the session, the last stream
+  /// subscribed sets them.
   class ServerSession
     : public std::enable_shared_from_this<ServerSession>,
       private profiler::LifetimeProfiled,
@@ -37,16 +70,21 @@ namespace tcp {
 
     using socket_type = boost::asio::ip::tcp::socket;
     using callback_function_type = std::function<void(std::shared_ptr<ServerSession>)>;
+    using request_function_type = std::function<void(std::shared_ptr<ServerSession>, StreamRequest)>;
 
     explicit ServerSession(
         boost::asio::io_context &io_context,
-        time_duration timeout);
+        time_duration timeout,
+        size_t shared_memory_capacity = 0u);
 
     /// Starts the session and calls @a on_opened after successfully reading the
-    /// stream id, and @a on_closed once the session is closed.
+    /// stream id, and @a on_closed once the session is closed. Multiplexed
+    /// sessions call @a on_request, within the strand of the session, for
+    /// every request that subscribes to or unsubscribes from a stream.
     void Open(
         callback_function_type on_opened,
-        callback_function_type on_closed);
+        callback_function_type on_closed,
+        request_function_type on_request = nullptr);
 
     /// @warning This function should only be called after the session is
     /// opened. It is safe to call this function from within the @a callback.
@@ -54,6 +92,17 @@ namespace tcp {
       return _stream_id;
     }
 
+    /// Whether the session carries the messages of several streams.
+    ///
+    /// @warning This function should only be called after the session is
+    /// opened.
+    bool IsMultiplexed() const {
+      return _stream_id == MULTIPLEXED_STREAM_ID;
+    }
+
+    /// Streams a multiplexed session is subscribed to.
+    std::vector<stream_id_type> GetSubscribedStreams() const;
+
     template <typename... Buffers>
     static auto MakeMessage(Buffers &&... buffers) {
       static_assert(
@@ -63,7 +112,18 @@ namespace tcp {
     }
 
     /// Writes some data to the socket.
-    void Write(std::shared_ptr<const Message> message);
+    ///
+    /// @warning With OverflowPolicy::BlockProducer this function may block,
+    /// it should never be called from a thread running the io_context.
+    void Write(std::shared_ptr<const Message> message) {
+      WriteTo(_stream_id, std::move(message));
+    }
+
+    /// Writes a message of the stream @a stream_id to the socket. Only
+    /// multiplexed sessions accept other streams than their own.
+    ///
+    /// @copydetails Write(std::shared_ptr<const Message>)
+    void WriteTo(stream_id_type stream_id, std::shared_ptr<const Message> message);
 
     /// Writes some data to the socket.
     template <typename... Buffers>
@@ -74,10 +134,55 @@ namespace tcp {
     /// Post a job to close the session.
     void Close();
 
+    /// Sets the size and overflow policy of the send queue.
+    void SetSendQueueSettings(const SendQueueSettings &settings);
+
+    /// Counters of the messages of @a stream_id, multiplexed sessions keep
+    /// separate counters for each of their streams.
+    SendQueueStats GetSendQueueStats(stream_id_type stream_id) const;
+
+    /// Sets the codec used for the messages written from now on.
+    void SetCompression(Compression codec) {
+      _compression = codec;
+    }
+
+    /// Whether the client accepted the shared memory transport, messages
+    /// written from then on go through the ring when they fit.
+    bool IsUsingSharedMemory() const {
+      return _uses_shared_memory;
+    }
+
   private:
 
+    /// Allocates a shared memory ring and queues an offer for the client,
+    /// messages keep going through the socket until the client accepts it.
+    /// Called at most once per session.
+    void OfferSharedMemory();
+
+    /// Waits for the client's answer to the offer, must be called within the
+    /// strand. Single stream sessions keep this read pending for their whole
+    /// life, it also notices the client closing the connection. Multiplexed
+    /// sessions receive the answer among the requests.
+    void ReadSharedMemoryAck();
+
+    void HandleSharedMemoryAck(bool accepted);
+
+    /// Reads the requests of a multiplexed session, must be called within the
+    /// strand.
+    void ReadRequests();
+
+    /// Sends every queued message, must be called within the strand.
+    void WriteQueued();
+
+    /// Whether @a message should go compressed through the socket.
+    bool ShouldCompress(const Message &message, Compression codec) const;
+
     void StartTimer();
 
+    /// Drops the oldest queued message of @a stream_id, must be called with
+    /// the queue locked.
+    void DropOldest(stream_id_type stream_id);
+
     void CloseNow();
 
     friend class Server;
@@ -86,6 +191,13 @@ namespace tcp {
 
     stream_id_type _stream_id = 0u;
 
+    Transport _requested_transport = Transport::tcp;
+
+    /// Mask of the codecs supported by the client.
+    uint8_t _supported_compression = 0u;
+
+    std::atomic<Compression> _compression{Compression::None};
+
     socket_type _socket;
 
     time_duration _timeout;
@@ -96,7 +208,73 @@ namespace tcp {
 
     callback_function_type _on_closed;
 
+    request_function_type _on_request;
+
+    /// Request being read, only accessed within the strand.
+    StreamRequest _request;
+
+    struct QueuedMessage {
+      stream_id_type stream_id;
+
+      std::shared_ptr<const Message> message;
+
+      /// The queued bytes, accounted as streaming queue memory. They are part
+      /// of the buffers of the message too, and counted once per queue.
+      TrackedMemory memory;
+    };
+
+    mutable std::mutex _queue_mutex;
+
+    std::condition_variable _queue_not_full;
+
+    SendQueueSettings _queue_settings;
+
+    std::deque<QueuedMessage> _queue;
+
+    /// Number of messages of each stream in the queue.
+    std::unordered_map<stream_id_type, size_t> _queued_per_stream;
+
+    /// Counters of each stream, guarded by the queue mutex. The queued
+    /// messages are counted by _queued_per_stream instead.
+    std::unordered_map<stream_id_type, SendQueueStats> _stats_per_stream;
+
+    /// Streams a multiplexed session is subscribed to, guarded by the queue
+    /// mutex.
+    std::unordered_set<stream_id_type> _subscribed_streams;
+
     bool _is_writing = false;
+
+    bool _is_closed = false;
+
+    std::atomic_bool _is_offer_requested{false};
+
+    std::atomic_bool _uses_shared_memory{false};
+
+    /// Messages being written to the socket, only accessed within the strand.
+    std::vector<QueuedMessage> _in_flight;
+
+    std::vector<boost::asio::const_buffer> _buffer_sequence;
+
+    /// Descriptors of the in-flight messages written into the ring.
+    std::vector<SharedMemoryDescriptor> _descriptors;
+
+    /// Stream ids preceding the in-flight messages of a multiplexed session.
+    std::vector<stream_id_type> _frame_stream_ids;
+
+    const size_t _shared_memory_capacity;
+
+    /// The members below are only accessed within the strand.
+
+    std::shared_ptr<SharedMemoryRing> _ring;
+
+    SharedMemoryOffer _shared_memory_offer;
+
+    bool _is_offer_pending = false;
+
+    uint8_t _shared_memory_ack = 0u;
+
+    /// When the in-flight messages started being written.
+    std::chrono::steady_clock::time_point _write_start;
   };
 
 } // namespace tcp
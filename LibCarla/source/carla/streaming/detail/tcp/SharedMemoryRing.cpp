@@ -0,0 +1,233 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/tcp/SharedMemoryRing.h"
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+#include <cstring>
+#include <iomanip>
+#include <iterator>
+#include <new>
+#include <random>
+#include <sstream>
+
+#ifdef __linux__
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <sys/statvfs.h>
+#  include <unistd.h>
+#endif // __linux__
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Shared memory requires lock-free atomics.");
+
+  static constexpr uint64_t SHARED_MEMORY_MAGIC = 0x4341524c41534d00ull; // "CARLASM"
+
+  struct SharedMemoryRing::Header {
+    uint64_t magic;
+
+    uint64_t capacity;
+
+    /// Written by the consumer only.
+    alignas(64) std::atomic<uint64_t> read_position;
+  };
+
+  static constexpr size_t DATA_OFFSET = (sizeof(SharedMemoryRing::Header) + 63u) & ~size_t(63u);
+
+#ifdef __linux__
+
+  static std::string MakeSegmentName() {
+    std::random_device device;
+    std::ostringstream name;
+    name << "/carla-stream-" << std::hex << std::setfill('0')
+         << std::setw(8) << device() << std::setw(8) << device();
+    return name.str();
+  }
+
+  static std::string GetSegmentPath(const std::string &name) {
+    // Same as shm_open but without requiring librt.
+    return "/dev/shm" + name;
+  }
+
+  static void *MapSegment(int fd, size_t size) {
+    void *mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    return (mapping == MAP_FAILED) ? nullptr : mapping;
+  }
+
+  std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Create(const size_t capacity) {
+    DEBUG_ASSERT(capacity > 0u);
+    const auto name = MakeSegmentName();
+    const auto path = GetSegmentPath(name);
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+      log_warning("shared memory: unable to create", path, ":", std::strerror(errno));
+      return nullptr;
+    }
+    const size_t mapping_size = DATA_OFFSET + capacity;
+    // Writing to the segment raises SIGBUS if tmpfs runs out of space, make
+    // sure it fits before extending it.
+    struct statvfs file_system;
+    if ((::fstatvfs(fd, &file_system) != 0) ||
+        ((static_cast<uint64_t>(file_system.f_bavail) * file_system.f_frsize) < mapping_size)) {
+      log_warning("shared memory: not enough space for", mapping_size, "bytes in /dev/shm");
+      ::close(fd);
+      ::unlink(path.c_str());
+      return nullptr;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(mapping_size)) != 0) {
+      log_warning("shared memory: unable to allocate", mapping_size, "bytes:", std::strerror(errno));
+      ::close(fd);
+      ::unlink(path.c_str());
+      return nullptr;
+    }
+    void *mapping = MapSegment(fd, mapping_size);
+    if (mapping == nullptr) {
+      log_warning("shared memory: unable to map", path, ":", std::strerror(errno));
+      ::unlink(path.c_str());
+      return nullptr;
+    }
+    auto *header = new (mapping) Header;
+    header->magic = SHARED_MEMORY_MAGIC;
+    header->capacity = capacity;
+    header->read_position.store(0u);
+    return std::unique_ptr<SharedMemoryRing>(
+        new SharedMemoryRing(name, true, mapping, mapping_size));
+  }
+
+  std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Open(const std::string &name) {
+    const auto path = GetSegmentPath(name);
+    const int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+      log_info("shared memory: unable to open", path, ":", std::strerror(errno));
+      return nullptr;
+    }
+    struct stat status;
+    if ((::fstat(fd, &status) != 0) || (static_cast<size_t>(status.st_size) <= DATA_OFFSET)) {
+      ::close(fd);
+      return nullptr;
+    }
+    const size_t mapping_size = static_cast<size_t>(status.st_size);
+    void *mapping = MapSegment(fd, mapping_size);
+    if (mapping == nullptr) {
+      log_info("shared memory: unable to map", path, ":", std::strerror(errno));
+      return nullptr;
+    }
+    const auto *header = static_cast<const Header *>(mapping);
+    if ((header->magic != SHARED_MEMORY_MAGIC) ||
+        (header->capacity != (mapping_size - DATA_OFFSET))) {
+      log_info("shared memory: invalid segment", path);
+      ::munmap(mapping, mapping_size);
+      return nullptr;
+    }
+    return std::unique_ptr<SharedMemoryRing>(
+        new SharedMemoryRing(name, false, mapping, mapping_size));
+  }
+
+  SharedMemoryRing::~SharedMemoryRing() {
+    RemoveName();
+    ::munmap(_mapping, _mapping_size);
+  }
+
+  void SharedMemoryRing::RemoveName() {
+    if (_owns_name) {
+      ::unlink(GetSegmentPath(_name).c_str());
+      _owns_name = false;
+    }
+  }
+
+#else
+
+  std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Create(size_t) {
+    return nullptr;
+  }
+
+  std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Open(const std::string &) {
+    return nullptr;
+  }
+
+  SharedMemoryRing::~SharedMemoryRing() = default;
+
+  void SharedMemoryRing::RemoveName() {}
+
+#endif // __linux__
+
+  SharedMemoryRing::SharedMemoryRing(
+      std::string name,
+      const bool owns_name,
+      void *mapping,
+      const size_t mapping_size)
+    : _name(std::move(name)),
+      _owns_name(owns_name),
+      _mapping(mapping),
+      _mapping_size(mapping_size) {}
+
+  SharedMemoryRing::Header &SharedMemoryRing::GetHeader() const {
+    return *static_cast<Header *>(_mapping);
+  }
+
+  unsigned char *SharedMemoryRing::GetData() const {
+    return static_cast<unsigned char *>(_mapping) + DATA_OFFSET;
+  }
+
+  size_t SharedMemoryRing::GetCapacity() const {
+    return GetHeader().capacity;
+  }
+
+  bool SharedMemoryRing::TryPush(const Message &message, uint64_t &position) {
+    const uint64_t capacity = GetCapacity();
+    const uint64_t size = message.size();
+    if (size > capacity) {
+      return false;
+    }
+    // Messages are never split, skip the end of the ring if it doesn't fit.
+    uint64_t start = _write_position;
+    const uint64_t offset = start % capacity;
+    if (offset + size > capacity) {
+      start += capacity - offset;
+    }
+    const uint64_t read_position = GetHeader().read_position.load(std::memory_order_acquire);
+    if (start + size - read_position > capacity) {
+      return false;
+    }
+    auto *destination = GetData() + (start % capacity);
+    auto buffers = message.GetBufferSequence();
+    // The first buffer is the size header.
+    for (auto it = std::next(buffers.begin()); it != buffers.end(); ++it) {
+      std::memcpy(destination, it->data(), it->size());
+      destination += it->size();
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    _write_position = start + size;
+    position = start;
+    return true;
+  }
+
+  bool SharedMemoryRing::Pop(
+      const uint64_t position,
+      const message_size_type size,
+      Buffer &buffer) {
+    const uint64_t capacity = GetCapacity();
+    if ((size > capacity) || ((position % capacity) + size > capacity)) {
+      return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    buffer.copy_from(GetData() + (position % capacity), size);
+    GetHeader().read_position.store(position + size, std::memory_order_release);
+    return true;
+  }
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,131 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/tcp/Message.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// Transport requested by a client when subscribing to a stream.
+  enum class Transport : uint8_t {
+    tcp,
+    shared_memory
+  };
+
+#pragma pack(push, 1)
+
+  /// Sent by the server in reply to a shared memory request.
+  struct SharedMemoryOffer {
+    uint8_t accepted = 0u;
+
+    uint64_t capacity = 0u;
+
+    char name[64u] = {};
+  };
+
+  /// Replaces the body of a message whose payload was written into the ring.
+  /// The message size sent in the header has SHARED_MEMORY_FLAG set.
+  struct SharedMemoryDescriptor {
+    message_size_type size = 0u;
+
+    uint64_t position = 0u;
+  };
+
+#pragma pack(pop)
+
+  /// Bit of the message size flagging a message carried by the shared memory
+  /// ring.
+  static constexpr message_size_type SHARED_MEMORY_FLAG = 1u << 31u;
+
+  /// Smaller messages always go through the socket, and a ring is only
+  /// offered once a stream writes a message of at least this size.
+  static constexpr message_size_type SHARED_MEMORY_MIN_MESSAGE_SIZE = 64u * 1024u;
+
+  /// Single producer, single consumer ring buffer living in a shared memory
+  /// segment, used to send messages to clients running in the same host
+  /// without copying them through the socket. The server session writes the
+  /// messages and sends their position over the socket, the client copies
+  /// them out in the same order they were written and advances the read
+  /// position stored in the segment.
+  ///
+  /// Only supported on Linux, elsewhere Create() and Open() always fail and
+  /// the sessions keep using the socket.
+  class SharedMemoryRing : private NonCopyable {
+  public:
+
+    /// Creates a new segment of @a capacity bytes, the segment is removed
+    /// when this object is destroyed unless RemoveName() is called before.
+    /// Returns nullptr on failure.
+    static std::unique_ptr<SharedMemoryRing> Create(size_t capacity);
+
+    /// Opens a segment created by another process. Returns nullptr on
+    /// failure.
+    static std::unique_ptr<SharedMemoryRing> Open(const std::string &name);
+
+    ~SharedMemoryRing();
+
+    const std::string &GetName() const {
+      return _name;
+    }
+
+    size_t GetCapacity() const;
+
+    /// Removes the name of the segment, the memory is kept alive until every
+    /// process unmaps it.
+    void RemoveName();
+
+    /// Copies @a message into the ring. Returns false without writing
+    /// anything if there is not enough free space.
+    bool TryPush(const Message &message, uint64_t &position);
+
+    /// Copies the message of @a size bytes at @a position into @a buffer and
+    /// releases its space. Returns false if the message lies outside the
+    /// ring.
+    bool Pop(uint64_t position, message_size_type size, Buffer &buffer);
+
+    /// Layout of the beginning of the segment.
+    struct Header;
+
+  private:
+
+    SharedMemoryRing(
+        std::string name,
+        bool owns_name,
+        void *mapping,
+        size_t mapping_size);
+
+    Header &GetHeader() const;
+
+    unsigned char *GetData() const;
+
+    const std::string _name;
+
+    bool _owns_name;
+
+    void *_mapping;
+
+    const size_t _mapping_size;
+
+    /// Only used by the producer.
+    uint64_t _write_position = 0u;
+  };
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
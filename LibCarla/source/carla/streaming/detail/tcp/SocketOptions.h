@@ -0,0 +1,44 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Logging.h"
+
+#include <boost/asio/ip/tcp.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// Set the kernel send and receive buffers of @a socket to @a buffer_size
+  /// bytes, zero keeps the system defaults. Links of tens of gigabits per
+  /// second, like IP over InfiniBand, need buffers holding a whole
+  /// bandwidth-delay product to keep the wire busy with a single stream. The
+  /// kernel may cap the size, e.g. to net.core.rmem_max on Linux.
+  inline void ApplySocketBufferSize(boost::asio::ip::tcp::socket &socket, size_t buffer_size) {
+    if (buffer_size == 0u) {
+      return;
+    }
+    const auto size = static_cast<int>(std::min<size_t>(buffer_size, std::numeric_limits<int>::max()));
+    boost::system::error_code ec;
+    socket.set_option(boost::asio::socket_base::send_buffer_size(size), ec);
+    if (!ec) {
+      socket.set_option(boost::asio::socket_base::receive_buffer_size(size), ec);
+    }
+    if (ec) {
+      log_warning("streaming: unable to set the socket buffer size:", ec.message());
+    }
+  }
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
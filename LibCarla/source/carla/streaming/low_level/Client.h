@@ -11,6 +11,8 @@
 
 #include <boost/asio/io_context.hpp>
 
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <unordered_map>
 
@@ -21,6 +23,9 @@ namespace low_level {
   /// A client able to subscribe to multiple streams. Accepts an external
   /// io_context.
   ///
+  /// By default every stream gets its own connection. If multiplexed, the
+  /// streams of the same server share a single connection instead.
+  ///
   /// @warning The client should not be destroyed before the @a io_context is
   /// stopped.
   template <typename T>
@@ -46,6 +51,18 @@ namespace low_level {
       }
     }
 
+    /// Whether the streams subscribed to from now on share a single
+    /// connection per server.
+    void SetMultiplexed(bool enabled) {
+      _multiplexed = enabled;
+    }
+
+    /// Size in bytes of the kernel socket buffers of the streams subscribed
+    /// to from now on, zero keeps the system defaults.
+    void SetSocketBufferSize(size_t size) {
+      _socket_buffer_size = size;
+    }
+
     /// @warning cannot subscribe twice to the same stream (even if it's a
     /// MultiStream).
     template <typename Functor>
@@ -57,19 +74,44 @@ namespace low_level {
       if (!token.has_address()) {
         token.set_address(_fallback_address);
       }
+      if (_multiplexed) {
+        auto &client = _multiplexed_clients[token.to_tcp_endpoint()];
+        if (client == nullptr) {
+          client = std::make_shared<underlying_client>(io_context, token);
+          client->SetSocketBufferSize(_socket_buffer_size);
+          client->Connect();
+        }
+        client->AddStream(token, std::forward<Functor>(callback));
+        _clients.emplace(token.get_stream_id(), client);
+        return;
+      }
       auto client = std::make_shared<underlying_client>(
           io_context,
           token,
           std::forward<Functor>(callback));
+      client->SetSocketBufferSize(_socket_buffer_size);
       client->Connect();
       _clients.emplace(token.get_stream_id(), std::move(client));
     }
 
     void UnSubscribe(token_type token) {
       auto it = _clients.find(token.get_stream_id());
-      if (it != _clients.end()) {
-        it->second->Stop();
-        _clients.erase(it);
+      if (it == _clients.end()) {
+        return;
+      }
+      auto client = it->second;
+      _clients.erase(it);
+      if (!client->IsMultiplexed()) {
+        client->Stop();
+        return;
+      }
+      client->RemoveStream(token.get_stream_id());
+      const bool in_use = std::any_of(_clients.begin(), _clients.end(), [&](const auto &pair) {
+        return pair.second == client;
+      });
+      if (!in_use) {
+        client->Stop();
+        _multiplexed_clients.erase(client->GetEndPoint());
       }
     }
 
@@ -77,6 +119,14 @@ namespace low_level {
 
     boost::asio::ip::address _fallback_address;
 
+    bool _multiplexed = false;
+
+    size_t _socket_buffer_size = 0u;
+
+    std::map<
+        typename underlying_client::endpoint,
+        std::shared_ptr<underlying_client>> _multiplexed_clients;
+
     std::unordered_map<
         detail::stream_id_type,
         std::shared_ptr<underlying_client>> _clients;
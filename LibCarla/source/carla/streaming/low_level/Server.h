@@ -60,6 +60,18 @@ namespace low_level {
       _server.SetTimeout(timeout);
     }
 
+    /// Set the capacity in bytes of the shared memory ring given to clients
+    /// running in the same host, zero disables it.
+    void SetSharedMemoryCapacity(size_t capacity) {
+      _server.SetSharedMemoryCapacity(capacity);
+    }
+
+    /// Set the size in bytes of the kernel socket buffers, zero keeps the
+    /// system defaults.
+    void SetSocketBufferSize(size_t size) {
+      _server.SetSocketBufferSize(size);
+    }
+
     Stream MakeStream() {
       return _dispatcher.MakeStream();
     }
@@ -68,6 +80,10 @@ namespace low_level {
       return _dispatcher.MakeMultiStream();
     }
 
+    std::vector<detail::StreamStats> GetStreamStats() const {
+      return _dispatcher.GetStreamStats();
+    }
+
   private:
 
     void StartServer() {
@@ -79,7 +95,10 @@ namespace low_level {
       auto on_session_closed = [this](auto session) {
         _dispatcher.DeregisterSession(session);
       };
-      _server.Listen(on_session_opened, on_session_closed);
+      auto on_session_request = [this](auto session, auto request) {
+        _dispatcher.HandleRequest(std::move(session), request);
+      };
+      _server.Listen(on_session_opened, on_session_closed, on_session_request);
     }
 
     underlying_server _server;
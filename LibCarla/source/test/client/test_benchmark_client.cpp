@@ -0,0 +1,294 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+#include "Random.h"
+
+#include <carla/BufferPool.h>
+#include <carla/MsgPack.h>
+#include <carla/client/detail/EpisodeState.h>
+#include <carla/image/FastImageConverter.h>
+#include <carla/image/ImageConverter.h>
+#include <carla/opendrive/OpenDriveParser.h>
+#include <carla/rpc/Command.h>
+#include <carla/sensor/Deserializer.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/RawEpisodeState.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Baselines of the hot paths of the client library, run with
+//
+//   make benchmark
+//
+// Each prints the best time per operation of a few repetitions, so the
+// numbers of different commits can be compared on the same machine.
+
+using namespace carla::road;
+using namespace carla::opendrive;
+
+/// Call @a functor, doing @a operations of something, @a repetitions times
+/// and print the best time per operation.
+template <typename F>
+static void benchmark(
+    const std::string &name,
+    const size_t operations,
+    F &&functor,
+    const size_t repetitions = 5u) {
+  using clock = std::chrono::steady_clock;
+  double best = std::numeric_limits<double>::max();
+  for (auto i = 0u; i < repetitions; ++i) {
+    const auto start = clock::now();
+    functor();
+    const std::chrono::duration<double, std::micro> elapsed = clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  std::cout << std::left << std::setw(52) << name << std::right
+            << std::setw(10) << operations << " ops"
+            << std::setw(14) << std::fixed << std::setprecision(3)
+            << (best / static_cast<double>(std::max<size_t>(1u, operations))) << " us/op"
+            << std::setw(12) << std::setprecision(1) << (1e-3 * best) << " ms"
+            << std::defaultfloat << std::endl;
+}
+
+static std::vector<std::pair<std::string, Map>> LoadTestMaps() {
+  std::vector<std::pair<std::string, Map>> maps;
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    EXPECT_TRUE(map.has_value()) << file;
+    if (map.has_value()) {
+      maps.emplace_back(file, std::move(*map));
+    }
+  }
+  return maps;
+}
+
+// =============================================================================
+// -- Road ---------------------------------------------------------------------
+// =============================================================================
+
+TEST(benchmark_client, opendrive_parser) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+    benchmark(file + " OpenDriveParser::Load", 1u, [&]() {
+      ASSERT_TRUE(OpenDriveParser::Load(opendrive).has_value());
+    }, 3u);
+  }
+}
+
+TEST(benchmark_client, map_queries) {
+  constexpr auto number_of_queries = 10000u;
+  for (const auto &pair : LoadTestMaps()) {
+    const auto &file = pair.first;
+    const auto &map = pair.second;
+
+    std::vector<element::Waypoint> waypoints;
+    benchmark(file + " GenerateWaypoints(2.0)", 1u, [&]() {
+      waypoints = map.GenerateWaypoints(2.0);
+    }, 3u);
+    ASSERT_FALSE(waypoints.empty());
+    util::Random::Shuffle(waypoints);
+    waypoints.resize(std::min<size_t>(number_of_queries, waypoints.size()));
+
+    // Near the lanes but not on their center.
+    std::vector<carla::geom::Location> locations;
+    locations.reserve(waypoints.size());
+    for (const auto &wp : waypoints) {
+      locations.emplace_back(map.ComputeTransform(wp).location + util::Random::Location(-2.0f, 2.0f));
+    }
+
+    size_t found = 0u;
+    benchmark(file + " GetClosestWaypointOnRoad", locations.size(), [&]() {
+      found = 0u;
+      for (const auto &location : locations) {
+        found += map.GetClosestWaypointOnRoad(location).has_value() ? 1u : 0u;
+      }
+    });
+    ASSERT_EQ(found, locations.size());
+
+    benchmark(file + " GetNext(5.0)", waypoints.size(), [&]() {
+      found = 0u;
+      for (const auto &wp : waypoints) {
+        found += map.GetNext(wp, 5.0).size();
+      }
+    });
+
+    // Short moves, as a vehicle in a tick, crossing a lane now and then.
+    std::vector<carla::geom::Location> destinations;
+    destinations.reserve(locations.size());
+    for (const auto &location : locations) {
+      destinations.emplace_back(location + util::Random::Location(-3.0f, 3.0f));
+    }
+    benchmark(file + " CalculateCrossedLanes", locations.size(), [&]() {
+      found = 0u;
+      for (auto i = 0u; i < locations.size(); ++i) {
+        found += map.CalculateCrossedLanes(locations[i], destinations[i]).size();
+      }
+    });
+  }
+}
+
+// =============================================================================
+// -- Buffers and serialization ------------------------------------------------
+// =============================================================================
+
+TEST(benchmark_client, buffer_pool) {
+  constexpr auto operations_per_thread = 100000u;
+  for (auto number_of_threads : {1u, 4u, 8u}) {
+    auto pool = std::make_shared<carla::BufferPool>();
+    benchmark("BufferPool pop/push " + std::to_string(number_of_threads) + " threads",
+        number_of_threads * operations_per_thread, [&]() {
+      std::vector<std::thread> threads;
+      for (auto i = 0u; i < number_of_threads; ++i) {
+        threads.emplace_back([&pool, i]() {
+          for (auto j = 0u; j < operations_per_thread; ++j) {
+            // A few sizes, as the sensors of different kinds sharing a pool.
+            auto buffer = pool->Pop(1024u << ((i + j) % 4u));
+            buffer.data()[0u] = static_cast<unsigned char>(j);
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+    });
+  }
+}
+
+TEST(benchmark_client, msgpack_commands) {
+  using carla::rpc::Command;
+  using mp = carla::MsgPack;
+  for (auto number_of_commands : {1000u, 10000u}) {
+    std::vector<Command> commands;
+    commands.reserve(number_of_commands);
+    for (auto i = 0u; i < number_of_commands; ++i) {
+      if (i % 2u == 0u) {
+        commands.emplace_back(Command::ApplyVehicleControl{i, carla::rpc::VehicleControl{0.5f, -0.25f, 0.0f, false, false, false, 0}});
+      } else {
+        commands.emplace_back(Command::ApplyTransform{i, carla::geom::Transform{
+            carla::geom::Location{1.0f * i, 2.0f, 3.0f},
+            carla::geom::Rotation{0.0f, 90.0f, 0.0f}}});
+      }
+    }
+    carla::Buffer buffer;
+    benchmark("MsgPack::Pack " + std::to_string(number_of_commands) + " commands", number_of_commands, [&]() {
+      buffer = mp::Pack(commands);
+    });
+    std::vector<Command> result;
+    benchmark("MsgPack::UnPack " + std::to_string(number_of_commands) + " commands", number_of_commands, [&]() {
+      result = mp::UnPack<std::vector<Command>>(buffer);
+    });
+    ASSERT_EQ(result.size(), commands.size());
+  }
+}
+
+// =============================================================================
+// -- Episode state ------------------------------------------------------------
+// =============================================================================
+
+static carla::Buffer MakeEpisodeFrame(const size_t number_of_actors) {
+  using namespace carla::sensor;
+  using Serializer = s11n::EpisodeStateSerializer;
+  auto message = s11n::SensorHeaderSerializer::Serialize(
+      SensorRegistry::get<FWorldObserver *>::index,
+      42u,
+      1.5,
+      carla::rpc::Transform{});
+  Serializer::Header header;
+  std::memset(&header, 0, sizeof(header));
+  header.episode_id = 1u;
+  const auto actors_size = sizeof(data::ActorDynamicState) * number_of_actors;
+  carla::Buffer buffer(message.size() + sizeof(header) + actors_size);
+  auto begin = buffer.data();
+  std::memcpy(begin, message.data(), message.size());
+  begin += message.size();
+  std::memcpy(begin, &header, sizeof(header));
+  begin += sizeof(header);
+  for (auto i = 0u; i < number_of_actors; ++i) {
+    data::ActorDynamicState state;
+    std::memset(&state.state, 0, sizeof(state.state));
+    // Shuffled ids, as received from the server.
+    state.id = static_cast<carla::ActorId>((i * 7919u) % number_of_actors + 1u);
+    state.transform = carla::geom::Transform{carla::geom::Location{1.0f * i, 0.0f, 0.0f}};
+    std::memcpy(begin + i * sizeof(state), &state, sizeof(state));
+  }
+  return buffer;
+}
+
+TEST(benchmark_client, episode_state) {
+  using namespace carla::sensor;
+  using carla::client::detail::EpisodeState;
+  for (auto number_of_actors : {1000u, 5000u, 10000u}) {
+    const auto frame = MakeEpisodeFrame(number_of_actors);
+    size_t size = 0u;
+    benchmark("EpisodeState " + std::to_string(number_of_actors) + " actors", number_of_actors, [&]() {
+      carla::Buffer copy(frame.size());
+      std::memcpy(copy.data(), frame.data(), frame.size());
+      auto raw = boost::static_pointer_cast<const data::RawEpisodeState>(
+          Deserializer::Deserialize(std::move(copy)));
+      EpisodeState state{raw};
+      size = state.size();
+    });
+    ASSERT_EQ(size, number_of_actors);
+  }
+}
+
+// =============================================================================
+// -- Images -------------------------------------------------------------------
+// =============================================================================
+
+TEST(benchmark_client, image_conversion) {
+  using namespace boost::gil;
+  using namespace carla::image;
+  using carla::sensor::data::Color;
+  constexpr auto width = 1920u;
+  constexpr auto height = 1080u;
+  std::vector<Color> source(width * height);
+  for (auto i = 0u; i < source.size(); ++i) {
+    const auto value = i * 2654435761u;
+    source[i] = Color(
+        static_cast<uint8_t>(value >> 24u),
+        static_cast<uint8_t>(value >> 16u),
+        static_cast<uint8_t>(value >> 8u));
+  }
+  std::vector<Color> image;
+
+  auto reference = [&](const std::string &name, auto converter) {
+    benchmark("ImageConverter " + name + " 1920x1080", source.size(), [&]() {
+      image = source;
+      auto view = interleaved_view(
+          width,
+          height,
+          reinterpret_cast<bgra8_pixel_t *>(image.data()),
+          static_cast<long>(sizeof(Color) * width));
+      ImageConverter::ConvertInPlace(view, converter);
+    });
+  };
+  reference("Depth", ColorConverter::Depth());
+  reference("LogarithmicDepth", ColorConverter::LogarithmicDepth());
+  reference("CityScapesPalette", ColorConverter::CityScapesPalette());
+
+  const auto kernel = FastImageConverter::GetKernel();
+  const std::string kernel_name = FastImageConverter::GetKernelName(kernel);
+  auto fast = [&](const std::string &name, auto converter) {
+    benchmark("FastImageConverter " + kernel_name + " " + name + " 1920x1080", source.size(), [&]() {
+      image = source;
+      FastImageConverter::ConvertInPlace(image.data(), image.size(), converter, kernel);
+    });
+  };
+  fast("Depth", ColorConverter::Depth());
+  fast("LogarithmicDepth", ColorConverter::LogarithmicDepth());
+  fast("CityScapesPalette", ColorConverter::CityScapesPalette());
+}
@@ -0,0 +1,53 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/BlueprintLibrary.h>
+
+using carla::client::BlueprintLibrary;
+
+static std::vector<carla::rpc::ActorDefinition> MakeDefinitions() {
+  std::vector<carla::rpc::ActorDefinition> definitions;
+  auto add = [&](const std::string &id, const std::string &tags) {
+    carla::rpc::ActorDefinition definition;
+    definition.id = id;
+    definition.tags = tags;
+    definitions.emplace_back(std::move(definition));
+  };
+  add("vehicle.audi.tt", "vehicle,audi,tt");
+  add("vehicle.audi.a2", "vehicle,audi,a2");
+  add("vehicle.tesla.model3", "vehicle,tesla,model3");
+  add("walker.pedestrian.0001", "walker,pedestrian");
+  add("sensor.camera.rgb", "sensor,camera,rgb");
+  return definitions;
+}
+
+static size_t CountMatches(const BlueprintLibrary &library, const std::string &pattern) {
+  return static_cast<size_t>(std::count_if(library.begin(), library.end(), [&](const auto &blueprint) {
+    return blueprint.MatchTags(pattern);
+  }));
+}
+
+TEST(blueprint_library, filter_matches_every_blueprint) {
+  const auto library = carla::MakeShared<BlueprintLibrary>(MakeDefinitions());
+  for (auto pattern : {
+      "vehicle.*", "vehicle.audi.tt", "audi", "*audi*", "vehicle", "walker.*",
+      "*", "sensor.camera.?gb", "model*", "nothing", "", "vehicle.[at]*"}) {
+    ASSERT_EQ(library->Filter(pattern)->size(), CountMatches(*library, pattern)) << pattern;
+  }
+  ASSERT_EQ(library->Filter("vehicle.*")->size(), 3u);
+  ASSERT_EQ(library->Filter("audi")->size(), 2u);
+  ASSERT_NE(library->Filter("tesla")->Find("vehicle.tesla.model3"), nullptr);
+}
+
+TEST(blueprint_library, filter_is_cached) {
+  const auto library = carla::MakeShared<BlueprintLibrary>(MakeDefinitions());
+  const auto vehicles = library->Filter("vehicle.*");
+  ASSERT_EQ(library->Filter("vehicle.*"), vehicles);
+  ASSERT_NE(library->Filter("vehicle"), vehicles);
+  ASSERT_EQ(vehicles->Filter("audi")->size(), 2u);
+}
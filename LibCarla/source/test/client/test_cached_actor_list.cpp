@@ -0,0 +1,146 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StringUtil.h>
+#include <carla/client/Vehicle.h>
+#include <carla/client/detail/ActorFactory.h>
+#include <carla/client/detail/CachedActorList.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace carla;
+
+static rpc::Actor MakeActor(ActorId id, std::string type_id) {
+  rpc::Actor actor;
+  actor.id = id;
+  actor.description.id = std::move(type_id);
+  return actor;
+}
+
+TEST(cached_actor_list, filter_by_type) {
+  const std::vector<std::string> type_ids = {
+      "vehicle.audi.a2",
+      "vehicle.tesla.model3",
+      "walker.pedestrian.0001",
+      "traffic.traffic_light",
+      "static.prop.bench"};
+  const std::vector<std::string> patterns = {
+      "vehicle.*", "*.pedestrian.*", "*", "traffic.*", "*.tesla.*", "nothing"};
+
+  client::detail::CachedActorList list;
+  std::vector<rpc::Actor> actors;
+  for (auto i = 0u; i < 60u; ++i) {
+    actors.emplace_back(MakeActor(i + 1u, type_ids[i % type_ids.size()]));
+  }
+  // Insert half, match, then the rest so new type ids are interned after
+  // the patterns were first used.
+  list.InsertRange(std::vector<rpc::Actor>(actors.begin(), actors.begin() + 7));
+  std::vector<ActorId> ids;
+  for (auto &&actor : actors) {
+    ids.emplace_back(actor.id);
+  }
+  for (auto &&pattern : patterns) {
+    auto matches = list.MatchTypeIds(ids, pattern);
+    ASSERT_EQ(matches.size(), ids.size());
+    for (auto i = 0u; i < ids.size(); ++i) {
+      if (i < 7u) {
+        ASSERT_TRUE(matches[i].has_value());
+        ASSERT_EQ(*matches[i], StringUtil::Match(actors[i].description.id, pattern));
+      } else {
+        ASSERT_FALSE(matches[i].has_value());
+      }
+    }
+  }
+  list.InsertRange(std::vector<rpc::Actor>(actors.begin() + 7, actors.end()));
+  for (auto &&pattern : patterns) {
+    auto matches = list.MatchTypeIds(ids, pattern);
+    auto filtered = list.GetActorsById(ids, pattern);
+    auto expected = 0u;
+    for (auto i = 0u; i < ids.size(); ++i) {
+      const bool is_match = StringUtil::Match(actors[i].description.id, pattern);
+      ASSERT_TRUE(matches[i].has_value());
+      ASSERT_EQ(*matches[i], is_match);
+      if (is_match) {
+        ASSERT_LT(expected, filtered.size());
+        ASSERT_EQ(filtered[expected].id, actors[i].id);
+        ++expected;
+      }
+    }
+    ASSERT_EQ(expected, filtered.size());
+  }
+  list.Clear();
+  ASSERT_TRUE(list.GetActorsById(ids, "*").empty());
+  ASSERT_FALSE(list.MatchTypeIds(ids, "*")[0u].has_value());
+}
+
+TEST(cached_actor_list, reuse_instances) {
+  using namespace client::detail;
+  CachedActorList list;
+  auto calls = 0u;
+  std::vector<ActorKind> kinds;
+  auto make = [&](const rpc::Actor &actor, ActorKind kind) {
+    ++calls;
+    kinds.emplace_back(kind);
+    return ActorFactory::MakeActor(EpisodeProxy{}, actor, kind, client::GarbageCollectionPolicy::Disabled);
+  };
+  auto camera = MakeActor(2u, "sensor.camera.rgb");
+  camera.stream_token.resize(sizeof(streaming::Token::data));
+  auto vehicle = list.GetOrMakeInstance(MakeActor(1u, "vehicle.audi.a2"), make);
+  auto sensor = list.GetOrMakeInstance(camera, make);
+  ASSERT_EQ(calls, 2u);
+  ASSERT_EQ(kinds[0u], ActorKind::Vehicle);
+  ASSERT_EQ(kinds[1u], ActorKind::ServerSideSensor);
+  ASSERT_NE(boost::dynamic_pointer_cast<client::Vehicle>(vehicle), nullptr);
+  ASSERT_TRUE(list.GetActorById(1u).has_value());
+  // Held instances are returned again.
+  for (auto i = 0u; i < 10u; ++i) {
+    ASSERT_EQ(list.GetOrMakeInstance(MakeActor(1u, "vehicle.audi.a2"), make), vehicle);
+  }
+  ASSERT_EQ(calls, 2u);
+  // Released ones are made again.
+  vehicle.reset();
+  ASSERT_NE(list.GetOrMakeInstance(MakeActor(1u, "vehicle.audi.a2"), make), nullptr);
+  ASSERT_EQ(calls, 3u);
+}
+
+TEST(cached_actor_list, concurrent_readers) {
+  client::detail::CachedActorList list;
+  constexpr auto number_of_actors = 2000u;
+  std::atomic_bool done{false};
+  std::atomic_bool failed{false};
+  std::vector<std::thread> readers;
+  for (auto i = 0u; i < 4u; ++i) {
+    readers.emplace_back([&]() {
+      std::vector<ActorId> ids(number_of_actors);
+      for (auto j = 0u; j < number_of_actors; ++j) {
+        ids[j] = j + 1u;
+      }
+      while (!done) {
+        // What is seen is always a prefix of the actors inserted.
+        const auto actors = list.GetActorsById(ids, "vehicle.*");
+        for (auto j = 0u; j < actors.size(); ++j) {
+          if (actors[j].id != ids[j]) {
+            failed = true;
+          }
+        }
+      }
+    });
+  }
+  for (auto i = 0u; i < number_of_actors; ++i) {
+    list.Insert(MakeActor(i + 1u, "vehicle.audi.a2"));
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  ASSERT_FALSE(failed);
+  ASSERT_TRUE(list.GetMissingIds(std::vector<ActorId>{1u, number_of_actors}).empty());
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/detail/CallbackList.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(callback_list, asynchronous_callbacks_are_coalesced) {
+  using namespace carla::client::detail;
+  CallbackList<int> list;
+  std::atomic_int last{-1};
+  std::atomic_int sum{0};
+  std::atomic_bool in_order{true};
+  const auto async_id = list.PushAsync([&](int value) {
+    std::this_thread::sleep_for(2ms);
+    in_order = in_order && (value > last);
+    last = value;
+  });
+  const auto sync_id = list.Push([&](int value) { sum += value; });
+
+  constexpr int number_of_calls = 100;
+  for (int i = 0; i < number_of_calls; ++i) {
+    list.Call(i);
+  }
+  ASSERT_EQ(sum, number_of_calls * (number_of_calls - 1) / 2);
+  while (last != (number_of_calls - 1)) {
+    std::this_thread::sleep_for(1ms);
+  }
+  ASSERT_TRUE(in_order);
+
+  auto sync_stats = list.GetStats(sync_id);
+  ASSERT_TRUE(sync_stats.has_value());
+  ASSERT_EQ(sync_stats->calls, size_t(number_of_calls));
+  ASSERT_EQ(sync_stats->coalesced, 0u);
+
+  std::this_thread::sleep_for(10ms);
+  auto async_stats = list.GetStats(async_id);
+  ASSERT_TRUE(async_stats.has_value());
+  ASSERT_LT(async_stats->calls, size_t(number_of_calls));
+  ASSERT_EQ(async_stats->calls + async_stats->coalesced, size_t(number_of_calls));
+  ASSERT_GE(async_stats->max_seconds, 0.002);
+  ASSERT_GE(async_stats->total_seconds, async_stats->max_seconds);
+
+  list.Remove(async_id);
+  ASSERT_FALSE(list.GetStats(async_id).has_value());
+}
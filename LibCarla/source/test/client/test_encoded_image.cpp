@@ -0,0 +1,102 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/sensor/Deserializer.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/EncodedImage.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+
+#include <cstring>
+
+using namespace carla::sensor;
+
+namespace {
+
+  struct FakeEncodedCamera {
+    uint32_t GetOutputImageWidth() const { return 640u; }
+    uint32_t GetOutputImageHeight() const { return 360u; }
+    float GetOutputFOVAngle() const { return 45.0f; }
+    s11n::ImageCodec GetImageCodec() const { return s11n::ImageCodec::JPEG; }
+  };
+
+} // namespace
+
+TEST(encoded_image, serialization) {
+  const unsigned char payload[] = {0xFF, 0xD8, 0xFF, 0xE0, 0x42, 0xFF, 0xD9};
+  constexpr auto offset = s11n::EncodedImageSerializer::header_offset;
+  carla::Buffer encoded(offset + sizeof(payload));
+  std::memcpy(encoded.data() + offset, payload, sizeof(payload));
+  auto data = s11n::EncodedImageSerializer::Serialize(FakeEncodedCamera{}, std::move(encoded));
+
+  auto message = s11n::SensorHeaderSerializer::Serialize(
+      SensorRegistry::get<AEncodedCamera *>::index,
+      7u,
+      2.0,
+      carla::rpc::Transform{});
+  carla::Buffer buffer(message.size() + data.size());
+  std::memcpy(buffer.data(), message.data(), message.size());
+  std::memcpy(buffer.data() + message.size(), data.data(), data.size());
+
+  auto image = boost::dynamic_pointer_cast<data::EncodedImage>(
+      Deserializer::Deserialize(std::move(buffer)));
+  ASSERT_NE(image, nullptr);
+  ASSERT_EQ(image->GetFrame(), 7u);
+  ASSERT_EQ(image->GetWidth(), 640u);
+  ASSERT_EQ(image->GetHeight(), 360u);
+  ASSERT_EQ(image->GetFOVAngle(), 45.0f);
+  ASSERT_EQ(image->GetCodec(), s11n::ImageCodec::JPEG);
+  ASSERT_EQ(image->size(), sizeof(payload));
+  ASSERT_EQ(std::memcmp(image->data(), payload, sizeof(payload)), 0);
+}
+
+TEST(encoded_image, header_cost) {
+  auto make_image = [](const s11n::SensorHeaderSerializer::Cost *cost) {
+    const unsigned char payload[] = {0xFF, 0xD8, 0xFF, 0xD9};
+    constexpr auto offset = s11n::EncodedImageSerializer::header_offset;
+    carla::Buffer encoded(offset + sizeof(payload));
+    std::memcpy(encoded.data() + offset, payload, sizeof(payload));
+    auto data = s11n::EncodedImageSerializer::Serialize(FakeEncodedCamera{}, std::move(encoded));
+    auto message = s11n::SensorHeaderSerializer::Serialize(
+        SensorRegistry::get<AEncodedCamera *>::index,
+        9u,
+        3.0,
+        carla::rpc::Transform{});
+    if (cost != nullptr) {
+      s11n::SensorHeaderSerializer::SetCost(message, *cost);
+    }
+    carla::Buffer buffer(message.size() + data.size());
+    std::memcpy(buffer.data(), message.data(), message.size());
+    std::memcpy(buffer.data() + message.size(), data.data(), data.size());
+    return Deserializer::Deserialize(std::move(buffer));
+  };
+
+  auto unmeasured = make_image(nullptr);
+  ASSERT_NE(unmeasured, nullptr);
+  ASSERT_FALSE(unmeasured->GetCost().has_value());
+
+  s11n::SensorHeaderSerializer::Cost cost;
+  cost.is_measured = 1u;
+  cost.tick_seconds = 0.25f;
+  cost.readback_seconds = 0.125f;
+  cost.serialize_seconds = 0.5f;
+  cost.gpu_seconds = 0.0f;
+  cost.bytes = 1234u;
+  auto measured = make_image(&cost);
+  ASSERT_NE(measured, nullptr);
+  ASSERT_TRUE(measured->GetCost().has_value());
+  ASSERT_EQ(measured->GetCost()->frame, 9u);
+  ASSERT_EQ(measured->GetCost()->tick_seconds, 0.25);
+  ASSERT_EQ(measured->GetCost()->readback_seconds, 0.125);
+  ASSERT_EQ(measured->GetCost()->serialize_seconds, 0.5);
+  ASSERT_EQ(measured->GetCost()->gpu_seconds, 0.0);
+  ASSERT_EQ(measured->GetCost()->bytes, 1234u);
+  // The data after the header is unchanged.
+  auto image = boost::dynamic_pointer_cast<data::EncodedImage>(measured);
+  ASSERT_NE(image, nullptr);
+  ASSERT_EQ(image->size(), 4u);
+}
@@ -0,0 +1,112 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/detail/EpisodeState.h>
+#include <carla/sensor/Deserializer.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/CompactActorDynamicState.h>
+#include <carla/sensor/data/RawEpisodeState.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace carla::sensor;
+using carla::client::detail::EpisodeState;
+
+using Compact = data::CompactActorDynamicState;
+
+static data::ActorDynamicState MakeVehicleState(carla::ActorId id, float x) {
+  data::ActorDynamicState state;
+  std::memset(&state.state, 0, sizeof(state.state));
+  state.id = id;
+  state.transform = carla::geom::Transform{
+      carla::geom::Location{x, -2.5f, 0.25f},
+      carla::geom::Rotation{1.0f, -170.0f, 90.0f}};
+  state.velocity = carla::geom::Vector3D{10.0f, -0.5f, 0.0f};
+  state.angular_velocity = carla::geom::Vector3D{0.0f, 0.0f, 30.0f};
+  state.acceleration = carla::geom::Vector3D{1.0f, 0.0f, -9.75f};
+  state.state.vehicle_data.control = carla::rpc::VehicleControl{0.5f, -0.25f, 0.0f, false, true, false, -1};
+  state.state.vehicle_data.speed_limit = 30.0f;
+  state.state.vehicle_data.has_traffic_light = true;
+  state.state.vehicle_data.traffic_light_id = 100u;
+  return state;
+}
+
+static carla::Buffer MakeCompactFrame(const std::vector<data::ActorDynamicState> &actors) {
+  using Serializer = s11n::EpisodeStateSerializer;
+  auto message = s11n::SensorHeaderSerializer::Serialize(
+      SensorRegistry::get<FWorldObserver *>::index,
+      42u,
+      1.5,
+      carla::rpc::Transform{});
+  Serializer::Header header;
+  std::memset(&header, 0, sizeof(header));
+  header.episode_id = 1u;
+  header.is_compact = 1u;
+  carla::Buffer buffer(message.size() + sizeof(header) + sizeof(Compact) * actors.size());
+  auto begin = buffer.data();
+  std::memcpy(begin, message.data(), message.size());
+  begin += message.size();
+  std::memcpy(begin, &header, sizeof(header));
+  begin += sizeof(header);
+  for (auto &&actor : actors) {
+    const Compact compact{actor, Compact::StateKind::Vehicle};
+    std::memcpy(begin, &compact, sizeof(compact));
+    begin += sizeof(compact);
+  }
+  return buffer;
+}
+
+TEST(episode_state, half_precision) {
+  for (float value : {0.0f, 1.0f, -2.5f, 0.1f, 1234.5f, 65504.0f}) {
+    ASSERT_NEAR(data::detail::HalfToFloat(data::detail::FloatToHalf(value)), value, 1e-3f * std::abs(value));
+  }
+  ASSERT_TRUE(std::isinf(data::detail::HalfToFloat(data::detail::FloatToHalf(1e6f))));
+}
+
+TEST(episode_state, compact_frame) {
+  std::vector<data::ActorDynamicState> actors;
+  for (auto id : {12u, 3u, 7u}) {
+    actors.emplace_back(MakeVehicleState(id, 1000.0f + id));
+  }
+  auto result = Deserializer::Deserialize(MakeCompactFrame(actors));
+  auto raw = boost::dynamic_pointer_cast<const data::RawEpisodeState>(result);
+  ASSERT_NE(raw, nullptr);
+  ASSERT_TRUE(raw->IsCompact());
+  ASSERT_EQ(raw->size(), actors.size());
+
+  EpisodeState state{raw};
+  ASSERT_EQ(state.size(), actors.size());
+  ASSERT_FALSE(state.ContainsActorSnapshot(1u));
+  auto ids = state.GetActorIds();
+  ASSERT_EQ(std::vector<carla::ActorId>(ids.begin(), ids.end()), (std::vector<carla::ActorId>{3u, 7u, 12u}));
+
+  auto received = state.begin();
+  for (auto &&actor : actors) {
+    const carla::ActorId id = actor.id;
+    ASSERT_EQ((*received++).id, id);
+    auto snapshot = state.GetActorSnapshot(id);
+    const carla::geom::Transform transform = actor.transform;
+    ASSERT_NEAR(snapshot.transform.location.x, transform.location.x, 1e-3f);
+    ASSERT_NEAR(snapshot.transform.location.y, transform.location.y, 1e-3f);
+    ASSERT_NEAR(snapshot.transform.rotation.yaw, transform.rotation.yaw, 1e-2f);
+    ASSERT_NEAR(snapshot.transform.rotation.roll, transform.rotation.roll, 1e-2f);
+    ASSERT_NEAR(snapshot.velocity.x, 10.0f, 1e-2f);
+    ASSERT_NEAR(snapshot.acceleration.z, -9.75f, 1e-2f);
+    const carla::rpc::VehicleControl control = snapshot.state.vehicle_data.control;
+    ASSERT_NEAR(control.throttle, 0.5f, 1e-4f);
+    ASSERT_NEAR(control.steer, -0.25f, 1e-4f);
+    ASSERT_FALSE(control.hand_brake);
+    ASSERT_TRUE(control.reverse);
+    ASSERT_EQ(control.gear, -1);
+    ASSERT_TRUE(snapshot.state.vehicle_data.has_traffic_light);
+    ASSERT_EQ(snapshot.state.vehicle_data.traffic_light_id, 100u);
+  }
+  ASSERT_TRUE(received == state.end());
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/ThreadGroup.h>
+#include <carla/client/Future.h>
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+using namespace std::chrono_literals;
+
+template <typename T>
+static carla::client::Future<T> MakeFuture(std::shared_future<T> future, std::atomic_size_t &calls) {
+  return carla::client::Future<T>(
+      [future](carla::time_duration timeout) {
+        return future.wait_for(timeout.to_chrono()) == std::future_status::ready;
+      },
+      [future, &calls]() {
+        ++calls;
+        return future.get();
+      });
+}
+
+TEST(future, get_once) {
+  using namespace carla;
+  std::promise<int> promise;
+  std::atomic_size_t calls{0u};
+  auto future = MakeFuture(promise.get_future().share(), calls);
+  auto mapped = future.Then([](const int &value) { return std::to_string(2 * value); });
+  ASSERT_FALSE(future.IsReady());
+  ASSERT_FALSE(mapped.WaitFor(1ms));
+
+  ThreadGroup threads;
+  std::atomic_size_t count{0u};
+  threads.CreateThreads(8u, [&]() {
+    ASSERT_EQ(mapped.Get(), "42");
+    ASSERT_EQ(future.Get(), 21);
+    ++count;
+  });
+  std::this_thread::sleep_for(10ms);
+  promise.set_value(21);
+  threads.JoinAll();
+
+  ASSERT_TRUE(mapped.IsReady());
+  ASSERT_EQ(count, 8u);
+  ASSERT_EQ(calls, 1u);
+}
+
+TEST(future, exception) {
+  using namespace carla;
+  std::promise<int> promise;
+  std::atomic_size_t calls{0u};
+  auto future = MakeFuture(promise.get_future().share(), calls);
+  auto mapped = future.Then([](const int &value) { return value + 1; });
+  promise.set_exception(std::make_exception_ptr(std::runtime_error("Uh oh an exception!")));
+  for (auto i = 0u; i < 2u; ++i) {
+    ASSERT_THROW(future.Get(), std::runtime_error);
+    ASSERT_THROW(mapped.Get(), std::runtime_error);
+  }
+  ASSERT_EQ(calls, 1u);
+}
@@ -6,11 +6,22 @@
 
 #include "test.h"
 
+#include <carla/image/FastImageConverter.h>
 #include <carla/image/ImageConverter.h>
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
+#include <carla/sensor/Deserializer.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/Image.h>
+#include <carla/sensor/data/PixelFormat.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
 
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <cstring>
 #include <memory>
+#include <vector>
 
 template <typename ViewT, typename PixelT>
 struct TestImage {
@@ -37,6 +48,7 @@ TEST(image, support) {
   carla::logging::log("PNG  support =", has_png_support());
   carla::logging::log("JPEG support =", has_jpeg_support());
   carla::logging::log("TIFF support =", has_tiff_support());
+  carla::logging::log("TGA  support =", has_tga_support());
 }
 #endif // PLATFORM_WINDOWS
 
@@ -186,3 +198,222 @@ TEST(image, semantic_segmentation) {
     }
   }
 }
+
+TEST(image, pixel_format_conversion) {
+  using namespace carla::image;
+  using namespace carla::sensor::data;
+
+  std::vector<Color> source;
+  for (auto tag = 0u; tag < CityScapesPalette::GetNumberOfTags(); ++tag) {
+    source.emplace_back(
+        static_cast<uint8_t>(tag),
+        static_cast<uint8_t>(3u * tag),
+        static_cast<uint8_t>(7u * tag),
+        42u);
+  }
+  const auto count = source.size();
+
+  auto convert = [&](PixelFormat format) {
+    std::vector<unsigned char> result(GetBytesPerPixel(format) * count);
+    ConvertPixels(format, source.data(), count, result.data());
+    return result;
+  };
+
+  auto bgra = convert(PixelFormat::BGRA8);
+  ASSERT_EQ(std::memcmp(bgra.data(), source.data(), bgra.size()), 0);
+
+  auto rgb = convert(PixelFormat::RGB8);
+  auto depth = convert(PixelFormat::Depth32F);
+  auto labels = convert(PixelFormat::Label8);
+  auto cityscapes = convert(PixelFormat::CityScapesRGB8);
+  for (auto i = 0u; i < count; ++i) {
+    const auto &pixel = source[i];
+    ColorRGB rgb_pixel;
+    std::memcpy(&rgb_pixel, rgb.data() + i * sizeof(ColorRGB), sizeof(ColorRGB));
+    ASSERT_EQ(rgb_pixel, ColorRGB(pixel.r, pixel.g, pixel.b)) << "at " << i;
+
+    float depth_pixel;
+    std::memcpy(&depth_pixel, depth.data() + i * sizeof(float), sizeof(float));
+    const float encoded = pixel.r + (pixel.g * 256) + (pixel.b * 256 * 256);
+    const float expected = 1000.0f * encoded / static_cast<float>(256 * 256 * 256 - 1);
+    ASSERT_FLOAT_EQ(depth_pixel, expected) << "at " << i;
+
+    ASSERT_EQ(labels[i], pixel.r) << "at " << i;
+
+    const auto color = CityScapesPalette::GetColor(pixel.r);
+    ColorRGB palette_pixel;
+    std::memcpy(&palette_pixel, cityscapes.data() + i * sizeof(ColorRGB), sizeof(ColorRGB));
+    ASSERT_EQ(palette_pixel, ColorRGB(color[0u], color[1u], color[2u])) << "at " << i;
+  }
+}
+
+TEST(image, fast_image_converter) {
+  using namespace boost::gil;
+  using namespace carla::image;
+  using carla::sensor::data::Color;
+  using Kernel = FastImageConverter::Kernel;
+
+  carla::logging::log("FastImageConverter kernel =",
+      FastImageConverter::GetKernelName(FastImageConverter::GetKernel()));
+
+  // Large enough to be split among several threads, with an odd size to go
+  // through the scalar tail of the kernels.
+  constexpr auto size = 1920u * 1080u + 3u;
+  std::vector<Color> source(size);
+  for (auto i = 0u; i < size; ++i) {
+    const auto value = i * 2654435761u;
+    source[i] = Color(
+        static_cast<uint8_t>(value >> 24u),
+        static_cast<uint8_t>(value >> 16u),
+        static_cast<uint8_t>(value >> 8u));
+  }
+  // Include the extremes.
+  source[0u] = Color(0u, 0u, 0u);
+  source[1u] = Color(255u, 255u, 255u);
+
+  auto convert_reference = [&](auto converter) {
+    auto result = source;
+    auto view = interleaved_view(
+        size,
+        1u,
+        reinterpret_cast<bgra8_pixel_t *>(result.data()),
+        static_cast<long>(sizeof(Color) * size));
+    ImageConverter::ConvertInPlace(view, converter);
+    return result;
+  };
+
+  const auto depth = convert_reference(ColorConverter::Depth());
+  const auto log_depth = convert_reference(ColorConverter::LogarithmicDepth());
+  const auto palette = convert_reference(ColorConverter::CityScapesPalette());
+
+  for (auto kernel : {Kernel::Scalar, Kernel::SSE2, Kernel::AVX2, Kernel::NEON}) {
+    if (!FastImageConverter::IsSupported(kernel)) {
+      continue;
+    }
+    auto check = [&](auto converter, const std::vector<Color> &expected, int tolerance) {
+      auto result = source;
+      FastImageConverter::ConvertInPlace(result.data(), result.size(), converter, kernel);
+      for (auto i = 0u; i < size; ++i) {
+        ASSERT_NEAR(int(result[i].r), int(expected[i].r), tolerance)
+            << FastImageConverter::GetKernelName(kernel) << " at " << i;
+        ASSERT_EQ(result[i].r, result[i].g);
+        ASSERT_EQ(result[i].r, result[i].b);
+        ASSERT_EQ(int(result[i].a), int(expected[i].a));
+      }
+    };
+    check(ColorConverter::Depth(), depth, 0);
+    check(ColorConverter::LogarithmicDepth(), log_depth, 1);
+
+    auto result = source;
+    FastImageConverter::ConvertInPlace(
+        result.data(),
+        result.size(),
+        ColorConverter::CityScapesPalette(),
+        kernel);
+    for (auto i = 0u; i < size; ++i) {
+      ASSERT_EQ(result[i], palette[i]) << " at " << i;
+      ASSERT_EQ(int(result[i].a), int(palette[i].a)) << " at " << i;
+    }
+  }
+}
+
+namespace {
+
+  struct FakeCamera {
+    uint32_t GetOutputImageWidth() const { return 4u; }
+    uint32_t GetOutputImageHeight() const { return 2u; }
+    float GetOutputFOVAngle() const { return 90.0f; }
+    carla::sensor::data::PixelFormat GetPixelFormat() const {
+      return carla::sensor::data::PixelFormat::BGRA8;
+    }
+  };
+
+} // namespace
+
+TEST(image, converted) {
+  using namespace carla::sensor;
+  using namespace carla::image;
+  constexpr auto offset = s11n::ImageSerializer::header_offset;
+  constexpr auto pixels = 8u;
+  carla::Buffer bitmap(offset + pixels * sizeof(data::Color));
+  auto *colors = reinterpret_cast<data::Color *>(bitmap.data() + offset);
+  for (auto i = 0u; i < pixels; ++i) {
+    colors[i] = data::Color{0u, 0u, static_cast<uint8_t>(10u * i), 255u};
+  }
+  auto serialized = s11n::ImageSerializer::Serialize(FakeCamera{}, std::move(bitmap));
+  auto message = s11n::SensorHeaderSerializer::Serialize(
+      SensorRegistry::get<ASceneCaptureCamera *>::index,
+      3u,
+      1.0,
+      carla::rpc::Transform{});
+  carla::Buffer buffer(message.size() + serialized.size());
+  std::memcpy(buffer.data(), message.data(), message.size());
+  std::memcpy(buffer.data() + message.size(), serialized.data(), serialized.size());
+
+  auto image = boost::dynamic_pointer_cast<data::Image>(
+      Deserializer::Deserialize(std::move(buffer)));
+  ASSERT_NE(image, nullptr);
+  const std::vector<data::Color> raw(image->begin(), image->end());
+
+  auto palette = FastImageConverter::GetConverted(*image, ColorConverter::CityScapesPalette());
+  ASSERT_NE(palette, image);
+  ASSERT_EQ(palette->GetFrame(), 3u);
+  ASSERT_EQ(palette->GetWidth(), 4u);
+  ASSERT_EQ(palette->GetHeight(), 2u);
+  ASSERT_EQ(palette->GetFOVAngle(), 90.0f);
+  std::vector<data::Color> expected = raw;
+  FastImageConverter::ConvertInPlace(
+      expected.data(),
+      expected.size(),
+      ColorConverter::CityScapesPalette());
+  ASSERT_TRUE(std::equal(palette->begin(), palette->end(), expected.begin()));
+  // The source is untouched and the copy is shared.
+  ASSERT_TRUE(std::equal(image->begin(), image->end(), raw.begin()));
+  ASSERT_EQ(FastImageConverter::GetConverted(*image, ColorConverter::CityScapesPalette()), palette);
+  auto depth = FastImageConverter::GetConverted(*image, ColorConverter::Depth());
+  ASSERT_NE(depth, palette);
+
+  // Converting in place drops the copies.
+  FastImageConverter::ConvertInPlace(*image, ColorConverter::Depth());
+  ASSERT_NE(FastImageConverter::GetConverted(*image, ColorConverter::Depth()), depth);
+}
+
+TEST(image, fast_write) {
+  using namespace boost::gil;
+  using namespace carla::image;
+
+  constexpr auto width = 64u;
+  constexpr auto height = 32u;
+  auto image = MakeTestImage<bgra8_pixel_t>(width, height);
+  auto i = 0u;
+  for (auto &pixel : image.view) {
+    get_color(pixel, red_t()) = static_cast<uint8_t>(i);
+    get_color(pixel, green_t()) = static_cast<uint8_t>(3u * i);
+    get_color(pixel, blue_t()) = static_cast<uint8_t>(7u * i);
+    get_color(pixel, alpha_t()) = 255u;
+    ++i;
+  }
+
+  const auto folder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  auto check = [&](const std::string &extension, auto io) {
+    const auto path = ImageIO::WriteView((folder / ("image" + extension)).string(), image.view, io::any_fast());
+    rgba8_image_t result;
+    ImageIO::ReadImage(path, result, io);
+    ASSERT_EQ(result.width(), long(width)) << extension;
+    ASSERT_EQ(result.height(), long(height)) << extension;
+    auto it = const_view(result).begin();
+    for (auto &pixel : image.view) {
+      rgba8_pixel_t expected;
+      color_convert(pixel, expected);
+      ASSERT_EQ(*it, expected) << extension;
+      ++it;
+    }
+  };
+#if LIBCARLA_IMAGE_WITH_PNG_SUPPORT
+  check(".png", io::png());
+#endif
+#if LIBCARLA_IMAGE_WITH_TGA_SUPPORT
+  check(".tga", io::tga());
+#endif
+  boost::filesystem::remove_all(folder);
+}
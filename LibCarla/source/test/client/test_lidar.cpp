@@ -0,0 +1,112 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/sensor/Deserializer.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/LidarMeasurement.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+
+#include <cstring>
+
+using namespace carla::sensor;
+
+static carla::SharedPtr<data::LidarMeasurement> SerializeAndDeserialize(
+    const s11n::LidarMeasurement &measurement) {
+  auto message = s11n::SensorHeaderSerializer::Serialize(
+      SensorRegistry::get<ARayCastLidar *>::index,
+      42u,
+      1.5,
+      carla::rpc::Transform{});
+  const int dummy = 0;
+  auto data = s11n::LidarSerializer::Serialize(dummy, measurement, carla::Buffer{});
+  carla::Buffer buffer(message.size() + data.size());
+  std::memcpy(buffer.data(), message.data(), message.size());
+  std::memcpy(buffer.data() + message.size(), data.data(), data.size());
+  auto result = Deserializer::Deserialize(std::move(buffer));
+  return boost::dynamic_pointer_cast<data::LidarMeasurement>(result);
+}
+
+static void WritePoints(s11n::LidarMeasurement &measurement) {
+  measurement.Reset(3u);
+  measurement.SetHorizontalAngle(0.5f);
+  measurement.WritePoint(0u, carla::rpc::Location{1.0f, -2.0f, 3.0f}, 10u);
+  measurement.WritePoint(0u, carla::rpc::Location{-4.5f, 0.25f, 0.0f}, 20u);
+  measurement.WritePoint(1u, carla::rpc::Location{100.0f, 0.01f, -0.5f}, 30u);
+}
+
+TEST(lidar, float_points) {
+  s11n::LidarMeasurement measurement(2u);
+  WritePoints(measurement);
+  auto lidar = SerializeAndDeserialize(measurement);
+  ASSERT_NE(lidar, nullptr);
+  ASSERT_EQ(lidar->GetChannelCount(), 2u);
+  ASSERT_EQ(lidar->GetHorizontalAngle(), 0.5f);
+  ASSERT_EQ(lidar->GetPointCount(0u), 2u);
+  ASSERT_EQ(lidar->GetPointCount(1u), 1u);
+  ASSERT_EQ(lidar->size(), 3u);
+  ASSERT_EQ(lidar->at(1u).x, -4.5f);
+  ASSERT_EQ(lidar->at(2u).y, 0.01f);
+  ASSERT_EQ(lidar->GetIntensity(0u), 0u);
+}
+
+TEST(lidar, packed_points) {
+  constexpr float scale = 0.01f;
+  s11n::LidarMeasurement measurement(2u, s11n::LidarPointFormat::PackedInt16, scale);
+  WritePoints(measurement);
+  auto lidar = SerializeAndDeserialize(measurement);
+  ASSERT_NE(lidar, nullptr);
+  ASSERT_EQ(lidar->GetChannelCount(), 2u);
+  ASSERT_EQ(lidar->GetHorizontalAngle(), 0.5f);
+  ASSERT_EQ(lidar->GetPointCount(0u), 2u);
+  ASSERT_EQ(lidar->GetPointCount(1u), 1u);
+  ASSERT_EQ(lidar->size(), 3u);
+  ASSERT_NEAR(lidar->at(0u).x, 1.0f, scale);
+  ASSERT_NEAR(lidar->at(0u).y, -2.0f, scale);
+  ASSERT_NEAR(lidar->at(1u).x, -4.5f, scale);
+  ASSERT_NEAR(lidar->at(1u).y, 0.25f, scale);
+  ASSERT_NEAR(lidar->at(2u).x, 100.0f, scale);
+  ASSERT_NEAR(lidar->at(2u).z, -0.5f, scale);
+  ASSERT_EQ(lidar->GetIntensity(0u), 10u);
+  ASSERT_EQ(lidar->GetIntensity(1u), 20u);
+  ASSERT_EQ(lidar->GetIntensity(2u), 30u);
+}
+
+TEST(lidar, sweep_slices) {
+  s11n::LidarMeasurement measurement(2u, s11n::LidarPointFormat::PackedInt16);
+  measurement.Reset(4u, 3u);
+  measurement.SetHorizontalAngle(0.5f);
+  measurement.SetSliceTime(0u, -0.1f);
+  measurement.SetSliceTime(1u, -0.05f);
+  measurement.SetSliceTime(2u, 0.0f);
+  measurement.WritePoint(0u, carla::rpc::Location{1.0f, 0.0f, 0.0f}, 10u, 0u);
+  measurement.WritePoint(0u, carla::rpc::Location{2.0f, 0.0f, 0.0f}, 20u, 2u);
+  measurement.WritePoint(1u, carla::rpc::Location{3.0f, 0.0f, 0.0f}, 30u, 1u);
+  measurement.WritePoint(1u, carla::rpc::Location{4.0f, 0.0f, 0.0f}, 40u, 1u);
+  auto lidar = SerializeAndDeserialize(measurement);
+  ASSERT_NE(lidar, nullptr);
+  ASSERT_EQ(lidar->GetSliceCount(), 3u);
+  ASSERT_EQ(lidar->GetSliceTime(0u), -0.1f);
+  ASSERT_EQ(lidar->GetSliceTime(2u), 0.0f);
+  ASSERT_EQ(lidar->GetPointCount(0u), 2u);
+  ASSERT_EQ(lidar->GetPointCount(1u), 2u);
+  ASSERT_EQ(lidar->GetPointCount(0u, 1u), 0u);
+  ASSERT_EQ(lidar->GetPointCount(1u, 1u), 2u);
+  ASSERT_EQ(lidar->size(), 4u);
+  ASSERT_EQ(lidar->GetSliceIndex(0u), 0u);
+  ASSERT_EQ(lidar->GetSliceIndex(1u), 2u);
+  ASSERT_EQ(lidar->GetSliceIndex(3u), 1u);
+  ASSERT_NEAR(lidar->at(3u).x, 4.0f, 0.01f);
+  ASSERT_EQ(lidar->GetIntensity(2u), 30u);
+
+  // Reusing the measurement for a single tick drops the slices.
+  WritePoints(measurement);
+  lidar = SerializeAndDeserialize(measurement);
+  ASSERT_EQ(lidar->GetSliceCount(), 0u);
+  ASSERT_EQ(lidar->size(), 3u);
+  ASSERT_EQ(lidar->GetSliceIndex(2u), 0u);
+}
@@ -10,12 +10,20 @@
 
 #include <carla/StopWatch.h>
 #include <carla/ThreadPool.h>
+#include <carla/client/Map.h>
+#include <carla/client/Waypoint.h>
+#include <carla/client/WaypointHandle.h>
 #include <carla/geom/Location.h>
 #include <carla/geom/Math.h>
 #include <carla/opendrive/OpenDriveParser.h>
+#include <carla/road/CompiledMap.h>
 #include <carla/road/MapBuilder.h>
+#include <carla/road/RoutePlanner.h>
+#include <carla/road/element/LaneMarkingIndex.h>
+#include <carla/road/element/LaneTransformCache.h>
 #include <carla/road/element/RoadInfoElevation.h>
 #include <carla/road/element/RoadInfoGeometry.h>
+#include <carla/road/element/RoadInfoLaneMaterial.h>
 #include <carla/road/element/RoadInfoMarkRecord.h>
 #include <carla/road/element/RoadInfoVisitor.h>
 
@@ -424,3 +432,321 @@ TEST(road, get_waypoint) {
     result.get();
   }
 }
+
+TEST(road, get_closest_waypoints) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    auto waypoints = map.GenerateWaypoints(2.0);
+    Random::Shuffle(waypoints);
+    waypoints.resize(std::min<size_t>(2000u, waypoints.size()));
+    std::vector<carla::geom::Location> locations;
+    for (const auto &wp : waypoints) {
+      locations.emplace_back(map.ComputeTransform(wp).location);
+    }
+    carla::StopWatch stop_watch;
+    const auto result = map.GetClosestWaypointsOnRoad(locations);
+    carla::logging::log(file, locations.size(), "waypoints found in",
+        1e-3f * stop_watch.GetElapsedTime(), "seconds.");
+    ASSERT_EQ(result.size(), locations.size());
+    for (auto i = 0u; i < locations.size(); ++i) {
+      ASSERT_TRUE(result[i].has_value());
+      ASSERT_EQ(*result[i], *map.GetClosestWaypointOnRoad(locations[i]));
+    }
+  }
+}
+
+TEST(road, lane_transform_cache) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    const LaneTransformCache cache(map, 0.5);
+    auto waypoints = map.GenerateWaypoints(0.3);
+    Random::Shuffle(waypoints);
+    waypoints.resize(std::min<size_t>(2000u, waypoints.size()));
+    for (const auto &wp : waypoints) {
+      const auto exact = map.ComputeTransform(wp);
+      const auto cached = cache.ComputeTransform(wp);
+      ASSERT_LT(Math::Distance(exact.location, cached.location), 0.05f);
+      ASSERT_LT(std::abs(std::remainder(exact.rotation.yaw - cached.rotation.yaw, 360.0f)), 1.0f);
+      ASSERT_LT(std::abs(std::remainder(exact.rotation.pitch - cached.rotation.pitch, 360.0f)), 1.0f);
+    }
+    carla::logging::log(file, "cached", cache.GetNumberOfSamples(), "samples.");
+  }
+}
+
+TEST(road, compiled_map) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    const auto opendrive = util::OpenDrive::Load(file);
+    auto m = OpenDriveParser::Load(opendrive);
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    const auto hash = CompiledMap::Hash(opendrive);
+    const auto image = CompiledMap::Compile(map, hash);
+    ASSERT_FALSE(CompiledMap::Load(image, hash + 1u).has_value());
+    auto truncated = image;
+    truncated.pop_back();
+    ASSERT_FALSE(CompiledMap::Load(truncated, hash).has_value());
+    carla::StopWatch stop_watch;
+    auto compiled = CompiledMap::Load(image, hash);
+    carla::logging::log(file, "loaded compiled in", 1e-3f * stop_watch.GetElapsedTime(), "seconds.");
+    ASSERT_TRUE(compiled.has_value());
+    ASSERT_EQ(CompiledMap::Compile(*compiled, hash).size(), image.size());
+    auto waypoints = map.GenerateWaypoints(1.0);
+    Random::Shuffle(waypoints);
+    waypoints.resize(std::min<size_t>(2000u, waypoints.size()));
+    for (const auto &wp : waypoints) {
+      const auto transform = map.ComputeTransform(wp);
+      ASSERT_LT(Math::Distance(transform.location, compiled->ComputeTransform(wp).location), 1e-3f);
+      // Overlapping lanes may be found in a different order, only the
+      // distance to the nearest one must match.
+      const auto nearest = map.GetClosestWaypointOnRoad(transform.location);
+      const auto compiled_nearest = compiled->GetClosestWaypointOnRoad(transform.location);
+      ASSERT_EQ(nearest.has_value(), compiled_nearest.has_value());
+      if (nearest.has_value()) {
+        ASSERT_NEAR(
+            Math::Distance(transform.location, map.ComputeTransform(*nearest).location),
+            Math::Distance(transform.location, compiled->ComputeTransform(*compiled_nearest).location),
+            1e-3f);
+      }
+      const auto next = map.GetNext(wp, 2.0);
+      const auto compiled_next = compiled->GetNext(wp, 2.0);
+      ASSERT_EQ(next.size(), compiled_next.size());
+      for (size_t i = 0u; i < next.size(); ++i) {
+        ASSERT_EQ(next[i], compiled_next[i]);
+      }
+    }
+  }
+}
+
+TEST(road, driving_profile) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+    auto full = OpenDriveParser::Load(opendrive);
+    auto driving = OpenDriveParser::Load(opendrive, OpenDriveParser::Profile::Driving);
+    ASSERT_TRUE(full.has_value());
+    ASSERT_TRUE(driving.has_value());
+    for (auto &&road : driving->GetMap().GetRoads()) {
+      ASSERT_TRUE(road.second.getSignals()->empty());
+      for (const auto &section : road.second.GetLaneSections()) {
+        for (const auto &lane : section.GetLanes()) {
+          ASSERT_TRUE(lane.second.GetInfos<RoadInfoLaneMaterial>().empty());
+        }
+      }
+    }
+    const auto waypoints = full->GenerateWaypoints(2.0);
+    ASSERT_EQ(waypoints.size(), driving->GenerateWaypoints(2.0).size());
+    for (const auto &wp : waypoints) {
+      ASSERT_LT(Math::Distance(full->ComputeTransform(wp).location, driving->ComputeTransform(wp).location), 1e-3f);
+      ASSERT_EQ(full->GetLaneWidth(wp), driving->GetLaneWidth(wp));
+      ASSERT_EQ(full->GetNext(wp, 2.0).size(), driving->GetNext(wp, 2.0).size());
+    }
+  }
+}
+
+TEST(road, batched_next_and_previous) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    auto waypoints = map.GenerateWaypoints(2.0);
+    Random::Shuffle(waypoints);
+    waypoints.resize(std::min<size_t>(2000u, waypoints.size()));
+    std::vector<double> distances;
+    for (auto i = 0u; i < waypoints.size(); ++i) {
+      distances.emplace_back(Random::Uniform(0.0001, 150.0));
+    }
+    const auto next = map.GetNext(waypoints, distances);
+    const auto previous = map.GetPrevious(waypoints, distances);
+    ASSERT_EQ(next.offsets.size(), waypoints.size() + 1u);
+    ASSERT_EQ(previous.offsets.size(), waypoints.size() + 1u);
+    for (size_t i = 0u; i < waypoints.size(); ++i) {
+      const auto single_next = map.GetNext(waypoints[i], distances[i]);
+      ASSERT_EQ(single_next.size(), next.offsets[i + 1u] - next.offsets[i]);
+      for (size_t j = 0u; j < single_next.size(); ++j) {
+        ASSERT_EQ(single_next[j], next.waypoints[next.offsets[i] + j]);
+      }
+      const auto single_previous = map.GetPrevious(waypoints[i], distances[i]);
+      ASSERT_EQ(single_previous.size(), previous.offsets[i + 1u] - previous.offsets[i]);
+      for (size_t j = 0u; j < single_previous.size(); ++j) {
+        const auto &wp = single_previous[j];
+        ASSERT_EQ(wp, previous.waypoints[previous.offsets[i] + j]);
+        // Either on the same lane at that distance, or on a previous lane.
+        if ((wp.road_id == waypoints[i].road_id) &&
+            (wp.section_id == waypoints[i].section_id) &&
+            (wp.lane_id == waypoints[i].lane_id)) {
+          ASSERT_NEAR(std::abs(wp.s - waypoints[i].s), distances[i], 1e-6);
+        }
+      }
+    }
+    ASSERT_THROW(map.GetNext(waypoints, {}), std::invalid_argument);
+  }
+}
+
+TEST(road, route_planner) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    carla::StopWatch stop_watch;
+    const RoutePlanner planner(map);
+    carla::logging::log(file, "graph of", planner.GetNumberOfLanes(), "lanes built in",
+        1e-3f * stop_watch.GetElapsedTime(), "seconds.");
+    const RoutePlanner uncached(map, 5.0, 0u);
+    auto waypoints = map.GenerateWaypoints(2.0);
+    Random::Shuffle(waypoints);
+    const auto number_of_routes = std::min<size_t>(1000u, waypoints.size() / 2u);
+    for (auto i = 0u; i < number_of_routes; ++i) {
+      const auto &origin = waypoints[2u * i];
+      const auto &destination = waypoints[2u * i + 1u];
+      const auto route = planner.ComputeRoute(origin, destination);
+      // Same route cached or not.
+      const auto same_route = planner.ComputeRoute(origin, destination);
+      const auto uncached_route = uncached.ComputeRoute(origin, destination);
+      ASSERT_EQ(route.size(), same_route.size());
+      ASSERT_EQ(route.size(), uncached_route.size());
+      for (size_t j = 0u; j < route.size(); ++j) {
+        ASSERT_EQ(route[j], same_route[j]);
+        ASSERT_EQ(route[j], uncached_route[j]);
+      }
+      if (route.empty()) {
+        continue;
+      }
+      ASSERT_EQ(route.front(), origin);
+      ASSERT_EQ(route.back(), destination);
+      // Each lane is entered from the previous one, at its start or changing
+      // lanes.
+      for (size_t j = 1u; (j + 1u) < route.size(); ++j) {
+        const auto &from = route[j - 1u];
+        const auto &to = route[j];
+        const bool lane_change =
+            (from.road_id == to.road_id) &&
+            (from.section_id == to.section_id) &&
+            (std::abs(from.lane_id - to.lane_id) == 1);
+        const auto successors = map.GetSuccessors(from);
+        const bool successor = std::any_of(successors.begin(), successors.end(), [&](const auto &next) {
+          return (next.road_id == to.road_id) && (next.section_id == to.section_id) && (next.lane_id == to.lane_id);
+        });
+        ASSERT_TRUE(lane_change || successor);
+      }
+    }
+  }
+}
+
+static bool IsSameWaypoint(const carla::client::Waypoint &lhs, const Waypoint &rhs) {
+  return
+      (lhs.GetRoadId() == rhs.road_id) &&
+      (lhs.GetSectionId() == rhs.section_id) &&
+      (lhs.GetLaneId() == rhs.lane_id) &&
+      (lhs.GetDistance() == rhs.s);
+}
+
+TEST(road, memoized_topology_and_waypoints) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    auto map = carla::MakeShared<carla::client::Map>(file, util::OpenDrive::Load(file));
+    const auto topology = map->GetMap().GenerateTopology();
+    const auto waypoints = map->GetMap().GenerateWaypoints(2.0);
+    for (auto i = 0u; i < 2u; ++i) {
+      const auto memoized_topology = map->GetTopology();
+      ASSERT_EQ(memoized_topology.size(), topology.size());
+      for (size_t j = 0u; j < topology.size(); ++j) {
+        ASSERT_TRUE(IsSameWaypoint(*memoized_topology[j].first, topology[j].first));
+        ASSERT_TRUE(IsSameWaypoint(*memoized_topology[j].second, topology[j].second));
+      }
+      const auto memoized_waypoints = map->GenerateWaypoints(2.0);
+      ASSERT_EQ(memoized_waypoints.size(), waypoints.size());
+      for (size_t j = 0u; j < waypoints.size(); ++j) {
+        ASSERT_TRUE(IsSameWaypoint(*memoized_waypoints[j], waypoints[j]));
+      }
+    }
+    ASSERT_LT(map->GenerateWaypoints(4.0).size(), waypoints.size());
+  }
+}
+
+TEST(road, waypoint_handles) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    auto map = carla::MakeShared<carla::client::Map>(file, util::OpenDrive::Load(file));
+    const auto waypoints = map->GenerateWaypoints(2.0);
+    const auto handles = map->GenerateWaypointHandles(2.0);
+    ASSERT_EQ(handles.size(), waypoints.size());
+    for (size_t i = 0u; i < handles.size(); ++i) {
+      ASSERT_TRUE(IsSameWaypoint(*waypoints[i], handles[i].GetRoadWaypoint()));
+      ASSERT_EQ(handles[i].GetId(), waypoints[i]->GetId());
+      ASSERT_EQ(handles[i].GetTransform(), waypoints[i]->GetTransform());
+      ASSERT_EQ(handles[i].GetTransform(), handles[i].MakeWaypoint()->GetTransform());
+      const auto right = waypoints[i]->GetRight();
+      const auto right_handle = handles[i].GetRight();
+      ASSERT_EQ(right != nullptr, right_handle.has_value());
+      if (right != nullptr) {
+        ASSERT_TRUE(IsSameWaypoint(*right, right_handle->GetRoadWaypoint()));
+      }
+    }
+    const auto topology = map->GetTopology();
+    const auto topology_handles = map->GetTopologyHandles();
+    ASSERT_EQ(topology_handles.size(), 2u * topology.size());
+    for (size_t i = 0u; i < topology.size(); ++i) {
+      ASSERT_TRUE(IsSameWaypoint(*topology[i].first, topology_handles[2u * i].GetRoadWaypoint()));
+      ASSERT_TRUE(IsSameWaypoint(*topology[i].second, topology_handles[2u * i + 1u].GetRoadWaypoint()));
+    }
+    const std::vector<double> distances(handles.size(), 5.0);
+    const auto next = map->GetNext(waypoints, distances);
+    const auto next_handles = map->GetNext(handles, distances);
+    ASSERT_EQ(next_handles.offsets, next.offsets);
+    ASSERT_EQ(next_handles.size(), next.waypoints.size());
+    for (size_t i = 0u; i < next_handles.size(); ++i) {
+      ASSERT_TRUE(IsSameWaypoint(*next.waypoints[i], next_handles[i].GetRoadWaypoint()));
+    }
+    if (handles.size() > 1u) {
+      const auto route = map->ComputeRoute(*waypoints.front(), *waypoints.back());
+      const auto route_handles = map->ComputeRoute(handles.front(), handles.back());
+      ASSERT_EQ(route_handles.size(), route.size());
+    }
+    // The handles of another map are rejected.
+    auto other = carla::MakeShared<carla::client::Map>(file, util::OpenDrive::Load(file));
+    ASSERT_THROW(other->GetNext(handles, distances), std::invalid_argument);
+  }
+}
+
+TEST(road, lane_marking_index) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    carla::StopWatch stop_watch;
+    const LaneMarkingIndex index(map);
+    carla::logging::log(file, "indexed", index.GetNumberOfSegments(), "segments in",
+        1e-3f * stop_watch.GetElapsedTime(), "seconds.");
+    auto waypoints = map.GenerateWaypoints(2.0);
+    Random::Shuffle(waypoints);
+    const auto number_of_waypoints_to_explore =
+        std::min<size_t>(2000u, waypoints.size());
+    for (auto i = 0u; i < number_of_waypoints_to_explore; ++i) {
+      const auto &wp = waypoints[i];
+      if (map.IsJunction(wp.road_id)) {
+        continue;
+      }
+      const auto location = map.ComputeTransform(wp).location;
+      // Moving to the center of the next lane crosses the marking in between.
+      auto right = map.GetRight(wp);
+      if (right.has_value() &&
+          (map.GetLaneType(*right) == Lane::LaneType::Driving) &&
+          (map.GetMarkRecord(wp).first != nullptr)) {
+        const auto destination = map.ComputeTransform(*right).location;
+        ASSERT_FALSE(index.CalculateCrossedLanes(location, destination).empty());
+      }
+      // A marking is never crossed staying at the center of the lane.
+      auto next = location + 0.1f * map.ComputeTransform(wp).GetForwardVector();
+      ASSERT_TRUE(index.CalculateCrossedLanes(location, next).empty());
+    }
+  }
+}
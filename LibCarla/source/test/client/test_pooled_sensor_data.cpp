@@ -0,0 +1,62 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/sensor/PooledSensorData.h>
+#include <carla/sensor/SensorData.h>
+
+#include <stdexcept>
+
+using carla::sensor::MakePooledSensorData;
+
+class PooledDummySensorData : public carla::sensor::SensorData {
+public:
+
+  explicit PooledDummySensorData(size_t frame, int &alive)
+    : carla::sensor::SensorData(frame, 0.0, carla::rpc::Transform{}),
+      _alive(alive) {
+    ++_alive;
+  }
+
+  ~PooledDummySensorData() {
+    --_alive;
+  }
+
+private:
+
+  int &_alive;
+};
+
+TEST(pooled_sensor_data, recycle_memory) {
+  int alive = 0;
+  void *first_address = nullptr;
+  {
+    auto data = MakePooledSensorData<PooledDummySensorData>([&](void *memory) {
+      return new (memory) PooledDummySensorData(1u, alive);
+    });
+    ASSERT_EQ(alive, 1);
+    ASSERT_EQ(data->GetFrame(), 1u);
+    // EnableSharedFromThis still works.
+    ASSERT_EQ(data->shared_from_this().get(), data.get());
+    carla::SharedPtr<carla::sensor::SensorData> base = data;
+    first_address = base.get();
+  }
+  ASSERT_EQ(alive, 0);
+  auto data = MakePooledSensorData<PooledDummySensorData>([&](void *memory) {
+    return new (memory) PooledDummySensorData(2u, alive);
+  });
+  ASSERT_EQ(static_cast<void *>(data.get()), first_address);
+  ASSERT_EQ(data->GetFrame(), 2u);
+}
+
+TEST(pooled_sensor_data, constructor_throws) {
+  ASSERT_THROW(
+      MakePooledSensorData<PooledDummySensorData>([](void *) -> PooledDummySensorData * {
+        throw std::runtime_error("failed");
+      }),
+      std::runtime_error);
+}
@@ -0,0 +1,241 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/Lz4.h>
+#include <carla/recorder/RecorderReader.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace carla::recorder;
+
+namespace {
+
+  /// Writes the packets of a recording as the simulator does.
+  class TestRecording {
+  public:
+
+    template <typename T>
+    void Write(const T &value) {
+      auto begin = reinterpret_cast<const char *>(&value);
+      _data.insert(_data.end(), begin, begin + sizeof(T));
+    }
+
+    void Write(const std::string &text) {
+      Write(static_cast<uint16_t>(text.size()));
+      _data.insert(_data.end(), text.begin(), text.end());
+    }
+
+    void WriteInfo(const std::string &map) {
+      Write(uint16_t(1u));
+      Write(std::string("CARLA_RECORDER"));
+      Write(int64_t(1234));
+      Write(map);
+    }
+
+    void BeginPacket(PacketId id) {
+      Write(static_cast<char>(id));
+      _packet_start = _data.size();
+      Write(uint32_t(0u));
+    }
+
+    void EndPacket() {
+      const uint32_t size = static_cast<uint32_t>(_data.size() - _packet_start - sizeof(uint32_t));
+      std::memcpy(_data.data() + _packet_start, &size, sizeof(size));
+    }
+
+    void WriteFrameStart(uint64_t id, double elapsed) {
+      BeginPacket(PacketId::FrameStart);
+      Write(FrameStart{id, 0.05, elapsed});
+      EndPacket();
+    }
+
+    void WriteFrameEnd() {
+      BeginPacket(PacketId::FrameEnd);
+      EndPacket();
+    }
+
+    void WriteEventAdd(uint32_t id, const std::string &blueprint) {
+      BeginPacket(PacketId::EventAdd);
+      Write(uint16_t(1u));
+      Write(id);
+      Write(uint8_t(1u));
+      Write(carla::geom::Vector3D{1.0f, 2.0f, 3.0f});
+      Write(carla::geom::Vector3D{0.0f, 0.0f, 90.0f});
+      Write(uint32_t(7u));
+      Write(blueprint);
+      Write(uint16_t(1u));
+      Write(uint8_t(5u));
+      Write(std::string("role_name"));
+      Write(std::string("hero"));
+      EndPacket();
+    }
+
+    template <typename T>
+    void WriteList(PacketId id, const std::vector<T> &values) {
+      BeginPacket(id);
+      Write(static_cast<uint16_t>(values.size()));
+      for (auto &value : values) {
+        Write(value);
+      }
+      EndPacket();
+    }
+
+    void Save(const std::string &filename) const {
+      std::ofstream file(filename, std::ios::binary);
+      file.write(_data.data(), static_cast<std::streamsize>(_data.size()));
+    }
+
+    /// Layout of compressed recordings, split in blocks of @a block_size.
+    void SaveCompressed(const std::string &filename, size_t block_size) const {
+      TestRecording out;
+      out.Write(uint32_t(0x5A4C5243u));
+      out.Write(uint16_t(1u));
+      std::vector<uint64_t> offsets;
+      std::vector<uint64_t> data_offsets;
+      for (size_t begin = 0u; begin < _data.size(); begin += block_size) {
+        const size_t size = std::min(block_size, _data.size() - begin);
+        const auto *source = reinterpret_cast<const unsigned char *>(_data.data() + begin);
+        std::vector<unsigned char> compressed(carla::Lz4::CompressBound(size));
+        size_t compressed_size = carla::Lz4::Compress(source, size, compressed.data());
+        offsets.push_back(out._data.size());
+        data_offsets.push_back(begin);
+        if (compressed_size >= size) {
+          compressed_size = size;
+          compressed.assign(source, source + size);
+        }
+        out.Write(static_cast<uint32_t>(compressed_size));
+        out.Write(static_cast<uint32_t>(size));
+        out._data.insert(out._data.end(), compressed.begin(), compressed.begin() + compressed_size);
+      }
+      const uint64_t table = out._data.size();
+      for (size_t i = 0u; i < offsets.size(); ++i) {
+        out.Write(offsets[i]);
+        out.Write(data_offsets[i]);
+      }
+      out.Write(table);
+      out.Write(static_cast<uint32_t>(offsets.size()));
+      out.Write(static_cast<uint64_t>(_data.size()));
+      out.Write(uint32_t(0x5A4C5243u));
+      out.Save(filename);
+    }
+
+  private:
+
+    std::vector<char> _data;
+
+    size_t _packet_start = 0u;
+  };
+
+  TestRecording MakeRecording(size_t frames) {
+    TestRecording recording;
+    recording.WriteInfo("Town01");
+    for (auto i = 0u; i < frames; ++i) {
+      recording.WriteFrameStart(i + 1u, 0.05 * i);
+      if (i == 0u) {
+        recording.WriteEventAdd(10u, "vehicle.tesla.model3");
+      }
+      if ((i % 10u) == 5u) {
+        recording.WriteList(PacketId::Collision, std::vector<Collision>{{i, 10u, 11u, true, false}});
+      }
+      recording.WriteList(PacketId::Position, std::vector<Position>{
+          {10u, {float(i), 0.0f, 0.0f}, {0.0f, 0.0f, 90.0f}},
+          {11u, {0.0f, float(i), 0.0f}, {0.0f, 0.0f, 0.0f}}});
+      recording.WriteList(PacketId::AnimVehicle, std::vector<VehicleAnimation>{{10u, 0.5f, 1.0f, 0.0f, false, 3}});
+      recording.WriteFrameEnd();
+    }
+    return recording;
+  }
+
+  void CheckRecording(const std::string &filename, size_t frames) {
+    RecorderReader reader(filename);
+    ASSERT_EQ(reader.GetInfo().version, 1u);
+    ASSERT_EQ(reader.GetInfo().map, "Town01");
+    ASSERT_EQ(reader.GetInfo().date, 1234);
+
+    RecorderFrame frame;
+    size_t count = 0u;
+    size_t collisions = 0u;
+    while (reader.ReadFrame(frame)) {
+      ASSERT_EQ(frame.GetId(), count + 1u);
+      ASSERT_DOUBLE_EQ(frame.GetElapsed(), 0.05 * static_cast<double>(count));
+
+      auto added = frame.GetEventsAdd();
+      if (count == 0u) {
+        ASSERT_EQ(added.size(), 1u);
+        ASSERT_EQ(added[0].database_id, 10u);
+        ASSERT_EQ(added[0].id, "vehicle.tesla.model3");
+        ASSERT_EQ(added[0].location.z, 3.0f);
+        ASSERT_EQ(added[0].uid, 7u);
+        ASSERT_EQ(added[0].attributes.size(), 1u);
+        ASSERT_EQ(added[0].attributes[0].id, "role_name");
+        ASSERT_EQ(added[0].attributes[0].value, "hero");
+      } else {
+        ASSERT_TRUE(added.empty());
+      }
+
+      auto positions = frame.GetPositions();
+      ASSERT_EQ(positions.size(), 2u);
+      ASSERT_EQ(positions[0].database_id, 10u);
+      ASSERT_EQ(positions[0].location.x, float(count));
+      ASSERT_EQ(positions[1].location.y, float(count));
+      size_t total = 0u;
+      for (auto position : positions) {
+        ASSERT_EQ(position.location.z, 0.0f);
+        ++total;
+      }
+      ASSERT_EQ(total, 2u);
+
+      for (auto collision : frame.GetCollisions()) {
+        ASSERT_EQ(collision.database_id1, 10u);
+        ASSERT_TRUE(collision.is_actor1_hero);
+        ++collisions;
+      }
+      ASSERT_EQ(frame.GetVehicleAnimations().size(), 1u);
+      ASSERT_EQ(frame.GetVehicleAnimations()[0].gear, 3);
+      ASSERT_TRUE(frame.GetWalkerAnimations().empty());
+      ASSERT_FALSE(frame.IsKeyFrame());
+      ++count;
+    }
+    ASSERT_EQ(count, frames);
+    ASSERT_EQ(collisions, frames / 10u);
+  }
+
+} // namespace
+
+TEST(recorder, read_plain_file) {
+  constexpr size_t frames = 200u;
+  const std::string filename = "test_recorder_plain.log";
+  MakeRecording(frames).Save(filename);
+  CheckRecording(filename, frames);
+  std::remove(filename.c_str());
+}
+
+TEST(recorder, read_compressed_file) {
+  constexpr size_t frames = 200u;
+  const std::string filename = "test_recorder_compressed.log";
+  // small blocks, so packets are split between blocks
+  MakeRecording(frames).SaveCompressed(filename, 1000u);
+  CheckRecording(filename, frames);
+  std::remove(filename.c_str());
+}
+
+TEST(recorder, invalid_file) {
+  const std::string filename = "test_recorder_invalid.log";
+  {
+    std::ofstream file(filename, std::ios::binary);
+    file << "not a recording";
+  }
+  ASSERT_THROW(RecorderReader{filename}, std::exception);
+  std::remove(filename.c_str());
+  ASSERT_THROW(RecorderReader{filename}, std::exception);
+}
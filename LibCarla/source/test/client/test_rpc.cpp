@@ -62,3 +62,85 @@ TEST(rpc, server_bind_sync_run_on_game_thread) {
   std::cout << "game thread: run " << i << " slices.\n";
   ASSERT_TRUE(done);
 }
+
+TEST(rpc, server_sync_run_until) {
+  const uint16_t port = (TESTING_PORT != 0u ? TESTING_PORT : 2017u);
+
+  Server server(port);
+  size_t cues = 0u;
+  server.BindSync("cue", [&]() { ++cues; });
+  server.AsyncRun(1u);
+
+  // Nothing arrives, wait until the timeout.
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_FALSE(server.SyncRunUntil(20ms, [&]() { return cues > 0u; }));
+  ASSERT_GE(std::chrono::steady_clock::now() - start, 20ms);
+
+  carla::ThreadGroup threads;
+  threads.CreateThread([&]() {
+    std::this_thread::sleep_for(10ms);
+    Client client("localhost", port);
+    client.async_call("cue");
+    client.call("cue");
+  });
+
+  // Returns right after the first cue instead of at the timeout.
+  start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(server.SyncRunUntil(10s, [&]() { return cues > 0u; }));
+  ASSERT_LT(std::chrono::steady_clock::now() - start, 5s);
+  ASSERT_TRUE(server.SyncRunUntil(10s, [&]() { return cues > 1u; }));
+  ASSERT_EQ(cues, 2u);
+}
+
+TEST(rpc, server_sync_call_from_async) {
+  const auto main_thread_id = std::this_thread::get_id();
+  const uint16_t port = (TESTING_PORT != 0u ? TESTING_PORT : 2017u);
+
+  Server server(port);
+  std::atomic_bool done{false};
+  server.BindAsync("read", [&](int x) -> int {
+    EXPECT_NE(std::this_thread::get_id(), main_thread_id);
+    return server.SyncCall([=]() {
+      EXPECT_EQ(std::this_thread::get_id(), main_thread_id);
+      return x + 1;
+    });
+  });
+  server.AsyncRun(1u);
+
+  carla::ThreadGroup threads;
+  threads.CreateThread([&]() {
+    Client client("localhost", port);
+    EXPECT_EQ(client.call("read", 41).as<int>(), 42);
+    done = true;
+  });
+
+  ASSERT_TRUE(server.SyncRunUntil(10s, [&]() { return done.load(); }));
+}
+
+TEST(rpc, function_metrics) {
+  const uint16_t port = (TESTING_PORT != 0u ? TESTING_PORT : 2017u);
+
+  Server server(port);
+  server.BindAsync("ok", [](int x) -> Response<int> { return x; });
+  server.BindAsync("fail", []() -> Response<void> { return ResponseError("nope"); });
+  server.AsyncRun(1u);
+
+  {
+    Client client("localhost", port);
+    for (auto i = 0; i < 10; ++i) {
+      client.call("ok", i);
+    }
+    client.call("fail");
+  }
+
+  const auto metrics = server.GetFunctionMetrics();
+  ASSERT_EQ(metrics.size(), 2u);
+  ASSERT_EQ(metrics[0u].name, "fail");
+  ASSERT_EQ(metrics[0u].calls, 1u);
+  ASSERT_EQ(metrics[0u].failures, 1u);
+  ASSERT_EQ(metrics[1u].name, "ok");
+  ASSERT_EQ(metrics[1u].calls, 10u);
+  ASSERT_EQ(metrics[1u].failures, 0u);
+  ASSERT_LE(metrics[1u].max_seconds, metrics[1u].total_seconds);
+  ASSERT_EQ(metrics[1u].total_wait_seconds, 0.0);
+}
@@ -0,0 +1,61 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/sensor/Deserializer.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/GnssMeasurement.h>
+#include <carla/sensor/data/SensorBundle.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace carla::sensor;
+
+using Registry = SensorRegistry;
+using HeaderSerializer = s11n::SensorHeaderSerializer;
+
+TEST(sensor_bundle, serialization) {
+  constexpr uint64_t frame = 42u;
+  std::vector<s11n::SensorBundleSerializer::Reading> readings;
+  for (auto i = 0u; i < 3u; ++i) {
+    readings.push_back({
+        HeaderSerializer::Serialize(
+            Registry::get<AGnssSensor *>::index,
+            frame,
+            1.5,
+            carla::rpc::Transform{}),
+        s11n::GnssSerializer::Serialize(0, carla::geom::GeoLocation{1.0 * i, 2.0, 3.0}),
+        10u + i});
+  }
+  const int dummy = 0;
+  auto message = HeaderSerializer::Serialize(
+      Registry::get<FSensorBundle *>::index,
+      frame,
+      1.5,
+      carla::rpc::Transform{});
+  auto data = s11n::SensorBundleSerializer::Serialize(dummy, readings, carla::Buffer{});
+  carla::Buffer buffer(message.size() + data.size());
+  std::memcpy(buffer.data(), message.data(), message.size());
+  std::memcpy(buffer.data() + message.size(), data.data(), data.size());
+
+  auto result = Deserializer::Deserialize(std::move(buffer));
+  auto bundle = boost::dynamic_pointer_cast<data::SensorBundle>(result);
+  ASSERT_NE(bundle, nullptr);
+  ASSERT_EQ(bundle->GetFrame(), frame);
+  ASSERT_EQ(bundle->size(), readings.size());
+  for (auto i = 0u; i < bundle->size(); ++i) {
+    auto gnss = boost::dynamic_pointer_cast<data::GnssMeasurement>(bundle->at(i));
+    ASSERT_NE(gnss, nullptr);
+    ASSERT_EQ(gnss->GetFrame(), frame);
+    ASSERT_EQ(gnss->GetLatitude(), 1.0 * i);
+    ASSERT_EQ(bundle->GetSensorId(i), 10u + i);
+    ASSERT_EQ(bundle->Find(10u + i), bundle->at(i));
+  }
+  ASSERT_EQ(bundle->Find(0u), nullptr);
+}
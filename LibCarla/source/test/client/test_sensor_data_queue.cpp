@@ -0,0 +1,82 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/ThreadGroup.h>
+#include <carla/client/SensorDataQueue.h>
+
+using namespace std::chrono_literals;
+
+using carla::client::SensorDataQueue;
+
+class DummySensorData : public carla::sensor::SensorData {
+public:
+
+  explicit DummySensorData(size_t frame)
+    : carla::sensor::SensorData(frame, 0.0, carla::rpc::Transform{}) {}
+};
+
+static SensorDataQueue::value_type MakeData(size_t frame) {
+  return carla::MakeShared<DummySensorData>(frame);
+}
+
+TEST(sensor_data_queue, fifo) {
+  SensorDataQueue queue;
+  ASSERT_EQ(queue.Pop(1ms), nullptr);
+  for (auto i = 0u; i < 5u; ++i) {
+    queue.Push(MakeData(i));
+  }
+  ASSERT_EQ(queue.size(), 5u);
+  for (auto i = 0u; i < 5u; ++i) {
+    auto data = queue.Pop(1ms);
+    ASSERT_NE(data, nullptr);
+    ASSERT_EQ(data->GetFrame(), i);
+  }
+  ASSERT_TRUE(queue.empty());
+  ASSERT_EQ(queue.GetNumberOfDroppedItems(), 0u);
+}
+
+TEST(sensor_data_queue, drop_policy) {
+  SensorDataQueue oldest(2u, true);
+  SensorDataQueue newest(2u, false);
+  for (auto i = 0u; i < 5u; ++i) {
+    oldest.Push(MakeData(i));
+    newest.Push(MakeData(i));
+  }
+  ASSERT_EQ(oldest.size(), 2u);
+  ASSERT_EQ(newest.size(), 2u);
+  ASSERT_EQ(oldest.GetNumberOfDroppedItems(), 3u);
+  ASSERT_EQ(newest.GetNumberOfDroppedItems(), 3u);
+  ASSERT_EQ(oldest.Pop(1ms)->GetFrame(), 3u);
+  ASSERT_EQ(newest.Pop(1ms)->GetFrame(), 0u);
+}
+
+TEST(sensor_data_queue, pop_frame) {
+  SensorDataQueue queue;
+  queue.Push(MakeData(1u));
+  queue.Push(MakeData(2u));
+  queue.Push(MakeData(4u));
+  ASSERT_EQ(queue.PopFrame(2u, 1ms)->GetFrame(), 2u);
+  ASSERT_EQ(queue.size(), 1u);
+  // Frame 3 was never received, frame 4 stays for the next call.
+  ASSERT_EQ(queue.PopFrame(3u, 1ms), nullptr);
+  ASSERT_EQ(queue.size(), 1u);
+  ASSERT_EQ(queue.PopFrame(4u, 1ms)->GetFrame(), 4u);
+  ASSERT_EQ(queue.PopFrame(5u, 1ms), nullptr);
+}
+
+TEST(sensor_data_queue, wait_for_push) {
+  SensorDataQueue queue(1u);
+  carla::ThreadGroup threads;
+  threads.CreateThread([&]() {
+    std::this_thread::sleep_for(10ms);
+    queue.Push(MakeData(7u));
+  });
+  auto data = queue.PopFrame(7u, 1s);
+  ASSERT_NE(data, nullptr);
+  ASSERT_EQ(data->GetFrame(), 7u);
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/SpawnPointIndex.h>
+
+#include <vector>
+
+using carla::client::SpawnPointIndex;
+using carla::geom::Location;
+using carla::geom::Transform;
+
+static std::vector<Transform> MakeSpawnPoints(const std::vector<float> &xs) {
+  std::vector<Transform> result;
+  for (auto x : xs) {
+    result.emplace_back(Location{x, 0.0f, 0.0f});
+  }
+  return result;
+}
+
+TEST(spawn_point_index, free_of_actors) {
+  SpawnPointIndex index{std::vector<Location>{{0.0f, 0.0f, 0.0f}, {20.0f, 4.0f, 0.0f}}, 5.0f};
+  ASSERT_EQ(index.size(), 2u);
+  ASSERT_FALSE(index.IsFree(Location{3.0f, 3.0f, 0.0f}));
+  ASSERT_TRUE(index.IsFree(Location{4.0f, 4.0f, 0.0f}));
+  ASSERT_FALSE(index.IsFree(Location{20.0f, 0.0f, 0.0f}));
+  // Bridges, the distance is in 3D.
+  ASSERT_TRUE(index.IsFree(Location{0.0f, 0.0f, 6.0f}));
+  // Across the border of the cells.
+  ASSERT_FALSE(index.IsFree(Location{-4.5f, -0.5f, 0.0f}));
+}
+
+TEST(spawn_point_index, take_free) {
+  SpawnPointIndex index{std::vector<Location>{{10.0f, 0.0f, 0.0f}}, 5.0f};
+  const auto spawn_points = MakeSpawnPoints({0.0f, 2.0f, 8.0f, 13.0f, 16.0f, 30.0f, 40.0f});
+  const auto free = index.TakeFree(spawn_points, 3u);
+  ASSERT_EQ(free.size(), 3u);
+  // 2 is too close to 0, 8 and 13 to the actor, 16 is the first free after.
+  ASSERT_EQ(free[0u].location.x, 0.0f);
+  ASSERT_EQ(free[1u].location.x, 16.0f);
+  ASSERT_EQ(free[2u].location.x, 30.0f);
+  // The points returned are taken.
+  ASSERT_FALSE(index.IsFree(Location{31.0f, 0.0f, 0.0f}));
+  const auto rest = index.TakeFree(spawn_points, 10u);
+  ASSERT_EQ(rest.size(), 1u);
+  ASSERT_EQ(rest[0u].location.x, 40.0f);
+}
+
+TEST(spawn_point_index, no_distance) {
+  SpawnPointIndex index{std::vector<Location>{{0.0f, 0.0f, 0.0f}}, 0.0f};
+  const auto free = index.TakeFree(MakeSpawnPoints({0.0f, 0.0f, 1.0f}), 5u);
+  ASSERT_EQ(free.size(), 3u);
+}
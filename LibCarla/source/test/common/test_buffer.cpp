@@ -13,6 +13,7 @@
 #include <list>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace util::buffer;
@@ -134,3 +135,128 @@ TEST(buffer, buffer_pool) {
   // Now delete the pool to test the weak reference inside the buffers.
   pool.reset();
 }
+
+TEST(buffer, buffer_pool_size_classes) {
+  auto pool = std::make_shared<carla::BufferPool>(2u);
+  const unsigned char *data = nullptr;
+  {
+    auto buff = pool->Pop(1000u);
+    ASSERT_EQ(buff.size(), 1000u);
+    ASSERT_EQ(buff.capacity(), 1024u);
+    data = buff.data();
+  }
+  ASSERT_EQ(pool->GetNumberOfBuffers(), 1u);
+  {
+    // Same size class, no reallocation.
+    auto buff = pool->Pop(600u);
+    ASSERT_EQ(buff.size(), 600u);
+    ASSERT_EQ(buff.data(), data);
+    // Different size class.
+    auto other = pool->Pop(2000u);
+    ASSERT_EQ(other.capacity(), 2048u);
+    ASSERT_EQ(pool->GetNumberOfBuffers(), 0u);
+  }
+  ASSERT_EQ(pool->GetNumberOfBuffers(), 2u);
+  {
+    std::vector<carla::Buffer> buffers;
+    for (auto i = 0u; i < 4u; ++i) {
+      buffers.emplace_back(pool->Pop(1024u));
+    }
+  }
+  // Only two buffers are kept per size class.
+  ASSERT_EQ(pool->GetNumberOfBuffers(), 3u);
+}
+
+TEST(buffer, buffer_pool_limits) {
+  using namespace std::chrono_literals;
+  auto pool = std::make_shared<carla::BufferPool>(
+      8u,
+      6000u,
+      carla::time_duration::milliseconds(20u));
+  {
+    auto small = pool->Pop(1000u);
+    auto big = pool->Pop(3000u);
+    auto other = pool->Pop(1000u);
+  }
+  // The last buffer returned does not fit in the pool.
+  auto stats = pool->GetStats();
+  ASSERT_EQ(stats.misses, 3u);
+  ASSERT_EQ(stats.discarded, 1u);
+  ASSERT_EQ(stats.buffers, 2u);
+  ASSERT_EQ(stats.bytes, 4096u + 1024u);
+  {
+    auto hit = pool->Pop(1000u);
+  }
+  ASSERT_EQ(pool->GetStats().hits, 1u);
+  // Nobody asks for big buffers anymore, they are trimmed by the next pop.
+  std::this_thread::sleep_for(50ms);
+  {
+    auto hit = pool->Pop(1000u);
+  }
+  stats = pool->GetStats();
+  ASSERT_EQ(stats.trimmed, 1u);
+  ASSERT_EQ(stats.buffers, 1u);
+  ASSERT_EQ(stats.bytes, 1024u);
+  pool->Trim();
+  ASSERT_EQ(pool->GetNumberOfBuffers(), 0u);
+  ASSERT_EQ(pool->GetStats().bytes, 0u);
+}
+
+TEST(buffer, allocation) {
+  using namespace carla;
+  const auto big = static_cast<Buffer::size_type>(4u * 1024u * 1024u);
+  for (auto allocation : {BufferAllocation::Default, BufferAllocation::HugePages, BufferAllocation::Pinned}) {
+    Buffer buffer;
+    buffer.set_allocation(allocation);
+    for (auto size : {Buffer::size_type(100u), big}) {
+      auto data = make_random(size);
+      buffer.copy_from(*data);
+      ASSERT_EQ(buffer.size(), size);
+      ASSERT_EQ(buffer, *data);
+    }
+    Buffer moved = std::move(buffer);
+    ASSERT_EQ(moved.allocation(), allocation);
+    ASSERT_EQ(moved.size(), big);
+  }
+  auto pool = std::make_shared<BufferPool>();
+  pool->SetAllocation(BufferAllocation::HugePages);
+  auto buffer = pool->Pop(big);
+  ASSERT_EQ(buffer.allocation(), BufferAllocation::HugePages);
+  ASSERT_EQ(buffer.size(), big);
+}
+
+TEST(buffer, memory_accounting) {
+  using namespace carla;
+  auto bytes_of = [](MemoryTag tag) { return MemoryAccounting::GetUsage(tag).bytes; };
+  const auto buffer_bytes = bytes_of(MemoryTag::Buffer);
+  const auto pool_bytes = bytes_of(MemoryTag::BufferPool);
+  auto pool = std::make_shared<BufferPool>();
+  {
+    auto buffer = pool->Pop(1000u);
+    ASSERT_EQ(bytes_of(MemoryTag::Buffer), buffer_bytes + buffer.capacity());
+    ASSERT_EQ(bytes_of(MemoryTag::BufferPool), pool_bytes);
+  }
+  // Back in the pool.
+  ASSERT_EQ(bytes_of(MemoryTag::Buffer), buffer_bytes);
+  ASSERT_GE(bytes_of(MemoryTag::BufferPool), pool_bytes + 1000u);
+  {
+    auto buffer = pool->Pop(1000u);
+    ASSERT_EQ(bytes_of(MemoryTag::BufferPool), pool_bytes);
+    buffer.set_memory_tag(MemoryTag::StreamingQueue);
+    ASSERT_EQ(bytes_of(MemoryTag::Buffer), buffer_bytes);
+    ASSERT_EQ(buffer.memory_tag(), MemoryTag::StreamingQueue);
+  }
+  pool->Trim();
+  ASSERT_EQ(bytes_of(MemoryTag::Buffer), buffer_bytes);
+  ASSERT_EQ(bytes_of(MemoryTag::BufferPool), pool_bytes);
+  const auto map_bytes = bytes_of(MemoryTag::MapData);
+  {
+    TrackedMemory memory{MemoryTag::MapData, 100u};
+    TrackedMemory copy = memory;
+    ASSERT_EQ(bytes_of(MemoryTag::MapData), map_bytes + 200u);
+    TrackedMemory moved = std::move(memory);
+    moved.Set(50u);
+    ASSERT_EQ(bytes_of(MemoryTag::MapData), map_bytes + 150u);
+  }
+  ASSERT_EQ(bytes_of(MemoryTag::MapData), map_bytes);
+}
@@ -6,10 +6,14 @@
 
 #include "test.h"
 
+#include <carla/geom/GeoProjection.h>
+#include <carla/geom/Location.h>
 #include <carla/geom/Vector3D.h>
 #include <carla/geom/Math.h>
 #include <carla/geom/Transform.h>
+#include <carla/geom/TransformMatrix.h>
 #include <limits>
+#include <vector>
 
 namespace carla {
 namespace geom {
@@ -179,3 +183,97 @@ TEST(geom, nearest_point_arc) {
   ASSERT_NEAR(Math::DistanceArcToPoint(Vector3D(1,2,0),
       Vector3D(0,0,0), 1.57f, 0, 1).second, 1.0f, 0.01f);
 }
+
+TEST(geom, batch_operations) {
+  constexpr float error = 0.001f;
+  // Not a multiple of the vector width, to go through the scalar tail.
+  std::vector<Location> points;
+  for (auto i = 0u; i < 23u; ++i) {
+    points.emplace_back(0.5f * i - 3.0f, 7.0f - 0.25f * i, 0.1f * i * i);
+  }
+  const Location origin(1.0f, -2.0f, 3.0f);
+
+  std::vector<float> distances(points.size());
+  std::vector<float> distances_2d(points.size());
+  Math::DistanceSquared(origin, points.data(), points.size(), distances.data());
+  Math::DistanceSquared2D(origin, points.data(), points.size(), distances_2d.data());
+  for (auto i = 0u; i < points.size(); ++i) {
+    ASSERT_NEAR(distances[i], Math::DistanceSquared(origin, points[i]), error) << "at " << i;
+    ASSERT_NEAR(distances_2d[i], Math::DistanceSquared2D(origin, points[i]), error) << "at " << i;
+  }
+
+  auto rotated = points;
+  Math::RotatePointsOnOrigin2D(rotated.data(), rotated.size(), 0.7f);
+  for (auto i = 0u; i < points.size(); ++i) {
+    const auto expected = Math::RotatePointOnOrigin2D(points[i], 0.7f);
+    ASSERT_NEAR(rotated[i].x, expected.x, error) << "at " << i;
+    ASSERT_NEAR(rotated[i].y, expected.y, error) << "at " << i;
+    ASSERT_EQ(rotated[i].z, points[i].z) << "at " << i;
+  }
+
+  const Transform transform(Location(2.0f, 5.0f, 7.0f), Rotation(10.0f, 30.0f, -45.0f));
+  auto transformed = points;
+  transform.TransformPoints(transformed);
+  for (auto i = 0u; i < points.size(); ++i) {
+    auto expected = points[i];
+    transform.TransformPoint(expected);
+    ASSERT_NEAR(transformed[i].x, expected.x, error) << "at " << i;
+    ASSERT_NEAR(transformed[i].y, expected.y, error) << "at " << i;
+    ASSERT_NEAR(transformed[i].z, expected.z, error) << "at " << i;
+  }
+}
+
+TEST(geom, transform_matrix) {
+  constexpr float error = 0.001f;
+  const Transform transform(Location(-4.0f, 1.5f, 3.0f), Rotation(-20.0f, 135.0f, 60.0f));
+  const TransformMatrix matrix(transform);
+  ASSERT_NEAR(matrix.GetForwardVector().x, transform.GetForwardVector().x, error);
+  ASSERT_NEAR(matrix.GetForwardVector().y, transform.GetForwardVector().y, error);
+  ASSERT_NEAR(matrix.GetForwardVector().z, transform.GetForwardVector().z, error);
+  std::vector<Location> points;
+  for (auto i = 0u; i < 10u; ++i) {
+    points.emplace_back(1.0f * i, -2.0f * i, 0.5f);
+  }
+  auto batch = points;
+  matrix.TransformPoints(batch);
+  for (auto i = 0u; i < points.size(); ++i) {
+    auto expected = points[i];
+    transform.TransformPoint(expected);
+    auto single = points[i];
+    matrix.TransformPoint(single);
+    ASSERT_NEAR(single.x, expected.x, error) << "at " << i;
+    ASSERT_NEAR(single.y, expected.y, error) << "at " << i;
+    ASSERT_NEAR(single.z, expected.z, error) << "at " << i;
+    ASSERT_NEAR(batch[i].x, expected.x, error) << "at " << i;
+    ASSERT_NEAR(batch[i].y, expected.y, error) << "at " << i;
+    ASSERT_NEAR(batch[i].z, expected.z, error) << "at " << i;
+  }
+}
+
+TEST(geom, geo_projection) {
+  const GeoLocation geo_reference{49.0, 8.0, 10.0};
+  const GeoProjection projection(geo_reference);
+  constexpr double radius = 6378137.0;
+  constexpr double pi = Math::Pi<double>();
+  const double scale = std::cos(Math::ToRadians(geo_reference.latitude));
+  const double mx0 = scale * Math::ToRadians(geo_reference.longitude) * radius;
+  const double my0 = scale * radius * std::log(std::tan((90.0 + geo_reference.latitude) * pi / 360.0));
+  std::vector<Location> locations;
+  for (auto i = 0u; i < 10u; ++i) {
+    locations.emplace_back(1000.0f * i, -700.0f * i, 2.0f * i);
+  }
+  const auto batch = projection.Transform(locations);
+  ASSERT_EQ(batch.size(), locations.size());
+  for (auto i = 0u; i < locations.size(); ++i) {
+    const double mx = mx0 + locations[i].x;
+    const double my = my0 - locations[i].y;
+    const double longitude = mx * 180.0 / (pi * radius * scale);
+    const double latitude = 360.0 * std::atan(std::exp(my / (radius * scale))) / pi - 90.0;
+    const auto single = projection.Transform(locations[i]);
+    ASSERT_NEAR(single.latitude, latitude, 1e-9) << "at " << i;
+    ASSERT_NEAR(single.longitude, longitude, 1e-9) << "at " << i;
+    ASSERT_NEAR(single.altitude, geo_reference.altitude + locations[i].z, 1e-9) << "at " << i;
+    ASSERT_EQ(batch[i], single) << "at " << i;
+    ASSERT_EQ(geo_reference.Transform(locations[i]), single) << "at " << i;
+  }
+}
@@ -6,8 +6,159 @@
 
 #include "test.h"
 
+#include <carla/AsyncWriter.h>
+#include <carla/Logging.h>
+#include <carla/ParallelFor.h>
+#include <carla/TaskScheduler.h>
+#include <carla/ThreadAffinity.h>
+#include <carla/ThreadPool.h>
 #include <carla/Version.h>
 
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
 TEST(miscellaneous, version) {
   std::cout << "LibCarla " << carla::version() << std::endl;
 }
+
+TEST(miscellaneous, parallel_for_each_chunk) {
+  for (const size_t size : {0u, 1u, 7u, 1000u, 12345u}) {
+    std::vector<std::atomic_int> visits(size);
+    for (auto &visit : visits) {
+      visit = 0;
+    }
+    carla::ParallelForEachChunk(size, 10u, [&](const size_t begin, const size_t end) {
+      ASSERT_LE(begin, end);
+      ASSERT_LE(end, size);
+      for (auto i = begin; i < end; ++i) {
+        ++visits[i];
+      }
+    });
+    for (const auto &visit : visits) {
+      ASSERT_EQ(visit, 1);
+    }
+  }
+  ASSERT_THROW(carla::ParallelForEachChunk(1000u, 1u, [](size_t, size_t end) {
+    if (end == 1000u) {
+      throw std::runtime_error("chunk failed");
+    }
+  }), std::runtime_error);
+}
+
+TEST(miscellaneous, parallel_reduce) {
+  for (const size_t size : {0u, 1u, 7u, 1000u, 12345u}) {
+    const auto sum = carla::ParallelReduce(size, 3u, size_t(0u), [](const size_t begin, const size_t end) {
+      size_t result = 0u;
+      for (auto i = begin; i < end; ++i) {
+        result += i;
+      }
+      return result;
+    }, [](const size_t lhs, const size_t rhs) { return lhs + rhs; });
+    ASSERT_EQ(sum, size > 0u ? size * (size - 1u) / 2u : 0u);
+  }
+}
+
+TEST(miscellaneous, task_group) {
+  carla::TaskScheduler scheduler{2u};
+  std::atomic_int count{0};
+  carla::TaskGroup group{scheduler};
+  for (auto i = 0; i < 64; ++i) {
+    // Nested groups, the tasks waiting run the tasks they wait for.
+    group.Run([&]() {
+      carla::TaskGroup inner{scheduler};
+      for (auto j = 0; j < 16; ++j) {
+        inner.Run([&]() { ++count; }, carla::TaskPriority::High);
+      }
+      inner.Wait();
+    }, carla::TaskPriority::Low);
+  }
+  group.Wait();
+  ASSERT_EQ(count, 64 * 16);
+  group.Run([]() { throw std::runtime_error("task failed"); });
+  ASSERT_THROW(group.Wait(), std::runtime_error);
+  group.Wait();
+}
+
+TEST(miscellaneous, log_rate_limiter) {
+  using namespace std::chrono_literals;
+  carla::logging::RateLimiter limiter{0.05};
+  size_t suppressed = 42u;
+  ASSERT_TRUE(limiter.Allow(suppressed));
+  ASSERT_EQ(suppressed, 0u);
+  ASSERT_FALSE(limiter.Allow(suppressed));
+  ASSERT_FALSE(limiter.Allow(suppressed));
+  std::this_thread::sleep_for(100ms);
+  ASSERT_TRUE(limiter.Allow(suppressed));
+  ASSERT_EQ(suppressed, 2u);
+  std::atomic_size_t allowed{0u};
+  std::vector<std::thread> threads;
+  for (auto i = 0u; i < 4u; ++i) {
+    threads.emplace_back([&]() {
+      size_t count;
+      for (auto j = 0u; j < 1000u; ++j) {
+        allowed += limiter.Allow(count) ? 1u : 0u;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_LE(allowed, 1u);
+  for (auto i = 0; i < 100; ++i) {
+    LOG_DEBUG_EVERY(10.0, "rate-limited message", i);
+  }
+  carla::logging::flush();
+}
+
+#ifdef __linux__
+TEST(miscellaneous, thread_pool_cpu_affinity) {
+  using carla::ThreadAffinity;
+  const auto available = ThreadAffinity::Get();
+  ASSERT_NE(available, 0u);
+  // Lowest CPU this process may run on.
+  const auto cpu_mask = available & (~available + 1u);
+  carla::ThreadPool pool;
+  pool.AsyncRun(2u, cpu_mask);
+  ASSERT_EQ(pool.Post([]() { return ThreadAffinity::Get(); }).get(), cpu_mask);
+  ASSERT_EQ(ThreadAffinity::Get(), available);
+}
+#endif // __linux__
+
+TEST(miscellaneous, async_writer) {
+  using namespace std::chrono_literals;
+  std::atomic_size_t written{0u};
+  std::vector<std::shared_future<std::string>> futures;
+  {
+    carla::AsyncWriter writer(2u, 2u);
+    for (auto i = 0u; i < 10u; ++i) {
+      futures.emplace_back(writer.Push([&written, i]() {
+        std::this_thread::sleep_for(5ms);
+        if (i == 3u) {
+          throw std::runtime_error("disk full");
+        }
+        ++written;
+        return std::to_string(i);
+      }));
+    }
+    writer.Wait();
+    const auto stats = writer.GetStats();
+    ASSERT_EQ(stats.queued, 0u);
+    ASSERT_EQ(stats.capacity, 2u);
+    ASSERT_LE(stats.max_queued, 2u);
+    ASSERT_EQ(stats.written, 9u);
+    ASSERT_EQ(stats.failed, 1u);
+    // Pushing 10 slow writes into a queue of 2 must have blocked.
+    ASSERT_GT(stats.blocked, 0u);
+    ASSERT_GT(stats.total_blocked_seconds, 0.0);
+    // Pending writes are finished on destruction.
+    writer.Push([&written]() { ++written; return std::string(); });
+  }
+  ASSERT_EQ(written, 10u);
+  ASSERT_EQ(futures[0u].get(), "0");
+  ASSERT_EQ(futures[9u].get(), "9");
+  ASSERT_THROW(futures[3u].get(), std::runtime_error);
+}
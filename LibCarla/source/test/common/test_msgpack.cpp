@@ -6,9 +6,15 @@
 
 #include "test.h"
 
+#include <carla/BufferPool.h>
+#include <carla/MsgPack.h>
 #include <carla/MsgPackAdaptors.h>
 #include <carla/rpc/Actor.h>
 #include <carla/rpc/Response.h>
+#include <carla/rpc/SceneQueryBatch.h>
+#include <carla/rpc/VehicleControlBatch.h>
+#include <carla/rpc/TransformBatch.h>
+#include <carla/rpc/WalkerStateBatch.h>
 
 #include <thread>
 
@@ -105,3 +111,126 @@ TEST(msgpack, optional) {
   ASSERT_TRUE(result.has_value());
   ASSERT_EQ(*result, 42.0f);
 }
+
+TEST(msgpack, vehicle_control_batch) {
+  using mp = carla::MsgPack;
+
+  VehicleControlBatch batch;
+  ASSERT_TRUE(batch.empty());
+  for (auto i = 0u; i < 100u; ++i) {
+    batch.Add(i, VehicleControl{1.0f / (i + 1u), -0.5f, 0.0f, (i % 2u) == 0u, false, true, int32_t(i)});
+  }
+
+  auto result = mp::UnPack<decltype(batch)>(mp::Pack(batch));
+  ASSERT_TRUE(result.IsValid());
+  ASSERT_EQ(result.size(), 100u);
+  for (auto i = 0u; i < result.size(); ++i) {
+    const auto entry = result.at(i);
+    const VehicleControl control = entry.control;
+    ASSERT_EQ(entry.actor, i);
+    ASSERT_EQ(control, (VehicleControl{1.0f / (i + 1u), -0.5f, 0.0f, (i % 2u) == 0u, false, true, int32_t(i)}));
+  }
+}
+
+TEST(msgpack, walker_state_batch) {
+  using mp = carla::MsgPack;
+
+  WalkerStateBatch batch;
+  ASSERT_TRUE(batch.empty());
+  for (auto i = 0u; i < 100u; ++i) {
+    const float f = static_cast<float>(i);
+    batch.Add(i, carla::geom::Transform{{f, -f, 0.5f * f}, {0.0f, f, 0.0f}}, 1.0f / (f + 1.0f));
+  }
+
+  auto result = mp::UnPack<decltype(batch)>(mp::Pack(batch));
+  ASSERT_TRUE(result.IsValid());
+  ASSERT_EQ(result.size(), 100u);
+  for (auto i = 0u; i < result.size(); ++i) {
+    const float f = static_cast<float>(i);
+    const auto entry = result.at(i);
+    ASSERT_EQ(entry.actor, i);
+    ASSERT_EQ(entry.transform, (carla::geom::Transform{{f, -f, 0.5f * f}, {0.0f, f, 0.0f}}));
+    ASSERT_EQ(entry.speed, 1.0f / (f + 1.0f));
+  }
+}
+
+TEST(msgpack, transform_batch) {
+  using mp = carla::MsgPack;
+
+  TransformBatch batch;
+  ASSERT_TRUE(batch.empty());
+  for (auto i = 0u; i < 100u; ++i) {
+    const float f = static_cast<float>(i);
+    batch.Add(i, carla::geom::Transform{{f, -f, 0.5f * f}, {-f, f, 2.0f * f}});
+  }
+
+  auto result = mp::UnPack<decltype(batch)>(mp::Pack(batch));
+  ASSERT_TRUE(result.IsValid());
+  ASSERT_EQ(result.size(), 100u);
+  for (auto i = 0u; i < result.size(); ++i) {
+    const float f = static_cast<float>(i);
+    const auto entry = result.at(i);
+    ASSERT_EQ(entry.actor, i);
+    ASSERT_EQ(entry.transform, (carla::geom::Transform{{f, -f, 0.5f * f}, {-f, f, 2.0f * f}}));
+  }
+}
+
+TEST(msgpack, ray_cast_batch) {
+  using mp = carla::MsgPack;
+  using namespace carla::rpc;
+
+  RayCastBatch batch{50.0f};
+  for (auto i = 0u; i < 100u; ++i) {
+    const float f = static_cast<float>(i);
+    batch.Add(RayCast{{f, -f, 10.0f}, {0.0f, 0.0f, -1.0f}});
+  }
+
+  auto result = mp::UnPack<decltype(batch)>(mp::Pack(batch));
+  ASSERT_TRUE(result.IsValid());
+  ASSERT_EQ(result.GetMaxDistance(), 50.0f);
+  ASSERT_EQ(result.size(), 100u);
+  for (auto i = 0u; i < result.size(); ++i) {
+    const float f = static_cast<float>(i);
+    const auto entry = result.at(i);
+    ASSERT_EQ(entry.origin, (carla::geom::Location{f, -f, 10.0f}));
+    ASSERT_EQ(entry.direction, (carla::geom::Vector3D{0.0f, 0.0f, -1.0f}));
+  }
+
+  RayHitBatch hits;
+  hits.Add(RayHit{{1.0f, 2.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, 10.0f, 42u, 1u});
+  hits.Add(RayHit{{}, {}, 0.0f, 0u, 0u});
+  auto hits_result = mp::UnPack<decltype(hits)>(mp::Pack(hits));
+  ASSERT_EQ(hits_result.size(), 2u);
+  ASSERT_EQ(hits_result.at(0u).actor, 42u);
+  ASSERT_EQ(hits_result.at(0u).distance, 10.0f);
+  ASSERT_EQ(hits_result.at(1u).has_hit, 0u);
+}
+
+TEST(msgpack, pack_into_pool) {
+  using mp = carla::MsgPack;
+  auto pool = std::make_shared<carla::BufferPool>();
+
+  // Bigger than the initial capacity, so the buffer has to grow.
+  std::vector<float> values(10000u);
+  for (auto i = 0u; i < values.size(); ++i) {
+    values[i] = static_cast<float>(i) * 0.5f;
+  }
+  const std::string text = "hola!";
+
+  {
+    auto buffer = mp::Pack(std::make_pair(text, values), *pool);
+    auto result = mp::UnPack<std::pair<std::string, std::vector<float>>>(buffer);
+    ASSERT_EQ(result.first, text);
+    ASSERT_EQ(result.second, values);
+    // The buffers outgrown while packing already went back to the pool.
+    ASSERT_GT(pool->GetStats().buffers, 0u);
+  }
+
+  const auto returned = pool->GetStats();
+  ASSERT_EQ(returned.misses, returned.buffers);
+  {
+    auto buffer = mp::Pack(values, *pool);
+    ASSERT_EQ(mp::UnPack<std::vector<float>>(buffer), values);
+  }
+  ASSERT_EQ(pool->GetStats().misses, returned.misses);
+}
@@ -11,11 +11,14 @@
 #include <carla/streaming/Server.h>
 #include <carla/streaming/detail/Dispatcher.h>
 #include <carla/streaming/detail/tcp/Client.h>
+#include <carla/streaming/detail/tcp/Compression.h>
 #include <carla/streaming/detail/tcp/Server.h>
 #include <carla/streaming/low_level/Client.h>
 #include <carla/streaming/low_level/Server.h>
 
+#include <array>
 #include <atomic>
+#include <unordered_set>
 
 using namespace std::chrono_literals;
 
@@ -255,3 +258,389 @@ TEST(streaming, multi_stream) {
     }
   }
 }
+
+TEST(streaming, are_clients_listening) {
+  using namespace carla::streaming;
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+  auto multi_stream = srv.MakeMultiStream();
+  ASSERT_FALSE(stream.AreClientsListening());
+  ASSERT_FALSE(multi_stream.AreClientsListening());
+
+  Client c;
+  c.AsyncRun(1u);
+  c.Subscribe(stream.token(), [](auto) {});
+  c.Subscribe(multi_stream.token(), [](auto) {});
+  for (auto i = 0u; (i < 100u) && !(stream.AreClientsListening() && multi_stream.AreClientsListening()); ++i) {
+    std::this_thread::sleep_for(2ms);
+  }
+  ASSERT_TRUE(stream.AreClientsListening());
+  ASSERT_TRUE(multi_stream.AreClientsListening());
+
+  c.UnSubscribe(stream.token());
+  c.UnSubscribe(multi_stream.token());
+  for (auto i = 0u; (i < 100u) && (stream.AreClientsListening() || multi_stream.AreClientsListening()); ++i) {
+    std::this_thread::sleep_for(2ms);
+  }
+  ASSERT_FALSE(stream.AreClientsListening());
+  ASSERT_FALSE(multi_stream.AreClientsListening());
+}
+
+TEST(streaming, send_queue_block_producer) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 500u;
+  const std::string message = "Do not drop me!";
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+  stream.SetSendQueueSettings({2u, detail::OverflowPolicy::BlockProducer});
+
+  std::atomic_size_t messages_received{0u};
+  Client c;
+  c.AsyncRun(2u);
+  c.Subscribe(stream.token(), [&](auto buffer) {
+    const std::string result = as_string(buffer);
+    ASSERT_EQ(result, message);
+    ++messages_received;
+  });
+  std::this_thread::sleep_for(20ms);
+
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    stream << message;
+  }
+  std::this_thread::sleep_for(100ms);
+
+  const auto stats = stream.GetSendQueueStats();
+  ASSERT_EQ(stats.dropped_messages, 0u);
+  ASSERT_EQ(stats.queued_messages, 0u);
+  ASSERT_EQ(stats.sent_messages, number_of_messages);
+  ASSERT_EQ(messages_received, number_of_messages);
+}
+
+TEST(streaming, stream_stats) {
+  using namespace carla::streaming;
+  constexpr size_t number_of_messages = 100u;
+  const std::string message = "Count me in.";
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+  auto idle = srv.MakeStream();
+  stream.SetSendQueueSettings({2u, detail::OverflowPolicy::BlockProducer});
+
+  std::atomic_size_t messages_received{0u};
+  Client c;
+  c.AsyncRun(2u);
+  c.Subscribe(stream.token(), [&](auto) { ++messages_received; });
+  std::this_thread::sleep_for(20ms);
+
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    stream << message;
+  }
+  std::this_thread::sleep_for(100ms);
+
+  const auto stats = srv.GetStreamStats();
+  ASSERT_EQ(stats.size(), 2u);
+  ASSERT_LT(stats[0u].stream_id, stats[1u].stream_id);
+  // The stream listened was created first.
+  const auto &listened = stats[0u];
+  const auto &not_listened = stats[1u];
+  ASSERT_TRUE(listened.are_clients_listening);
+  ASSERT_EQ(listened.queue.sent_messages, number_of_messages);
+  ASSERT_EQ(listened.queue.sent_bytes, number_of_messages * message.size());
+  ASSERT_GT(listened.queue.total_write_seconds, 0.0);
+  ASSERT_LE(listened.queue.max_write_seconds, listened.queue.total_write_seconds);
+  ASSERT_FALSE(not_listened.are_clients_listening);
+  ASSERT_EQ(not_listened.queue.sent_messages, 0u);
+  ASSERT_EQ(messages_received, number_of_messages);
+}
+
+TEST(streaming, send_queue_drop_newest) {
+  using namespace carla::streaming;
+  constexpr size_t number_of_messages = 500u;
+  const std::string message = "Drop me if you must.";
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+  stream.SetSendQueueSettings({1u, detail::OverflowPolicy::DropNewest});
+
+  std::atomic_size_t messages_received{0u};
+  Client c;
+  c.AsyncRun(2u);
+  c.Subscribe(stream.token(), [&](auto) { ++messages_received; });
+  std::this_thread::sleep_for(20ms);
+
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    stream << message;
+  }
+  std::this_thread::sleep_for(100ms);
+
+  const auto stats = stream.GetSendQueueStats();
+  ASSERT_EQ(stats.queued_messages, 0u);
+  ASSERT_EQ(stats.sent_messages + stats.dropped_messages, number_of_messages);
+  ASSERT_EQ(messages_received, stats.sent_messages);
+}
+
+TEST(streaming, shared_memory_transport) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 200u;
+  constexpr size_t message_size = 256u * 1024u;
+
+  boost::asio::io_context io_context;
+  tcp::Server::endpoint ep(boost::asio::ip::address_v4::loopback(), TESTING_PORT);
+
+  tcp::Server srv(io_context, ep);
+  srv.SetTimeout(1s);
+  srv.SetSharedMemoryCapacity(4u * message_size);
+  std::atomic_bool done{false};
+  std::atomic_bool uses_shared_memory{false};
+  std::atomic_size_t message_count{0u};
+
+  const auto message = make_random(message_size);
+
+  srv.Listen([&](std::shared_ptr<tcp::ServerSession> session) {
+    session->SetSendQueueSettings({2u, OverflowPolicy::BlockProducer});
+    for (auto i = 0u; (i < number_of_messages) && !done; ++i) {
+      session->Write(carla::Buffer(message->buffer()));
+    }
+    uses_shared_memory = session->IsUsingSharedMemory();
+    // Keep the session alive until the test finishes.
+    while (!done) {
+      std::this_thread::sleep_for(1ms);
+    }
+  }, [](std::shared_ptr<tcp::ServerSession>) {});
+
+  Dispatcher dispatcher{make_endpoint<tcp::Client::protocol_type>(srv.GetLocalEndpoint())};
+  auto stream = dispatcher.MakeStream();
+  auto c = std::make_shared<tcp::Client>(io_context, stream.token(), [&](carla::Buffer buffer) {
+    ASSERT_EQ(buffer, *message);
+    ++message_count;
+  });
+  c->Connect();
+
+  carla::ThreadGroup threads;
+  threads.CreateThreads(
+      std::max(2u, std::thread::hardware_concurrency()),
+      [&]() { io_context.run(); });
+
+  for (auto i = 0u; (i < 500u) && (message_count < number_of_messages); ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  done = true;
+  io_context.stop();
+#ifdef __linux__
+  ASSERT_TRUE(uses_shared_memory);
+#endif // __linux__
+  ASSERT_EQ(message_count, number_of_messages);
+  c->Stop();
+}
+
+TEST(streaming, socket_buffer_size) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 100u;
+  constexpr size_t message_size = 1024u * 1024u;
+
+  boost::asio::io_context io_context;
+  tcp::Server::endpoint ep(boost::asio::ip::address_v4::loopback(), TESTING_PORT);
+
+  // Plain TCP with buffers bigger than the messages.
+  tcp::Server srv(io_context, ep);
+  srv.SetTimeout(1s);
+  srv.SetSharedMemoryCapacity(0u);
+  srv.SetSocketBufferSize(4u * message_size);
+  std::atomic_bool done{false};
+  std::atomic_size_t message_count{0u};
+
+  const auto message = make_random(message_size);
+
+  srv.Listen([&](std::shared_ptr<tcp::ServerSession> session) {
+    session->SetSendQueueSettings({4u, OverflowPolicy::BlockProducer});
+    for (auto i = 0u; (i < number_of_messages) && !done; ++i) {
+      session->Write(carla::Buffer(message->buffer()));
+    }
+    while (!done) {
+      std::this_thread::sleep_for(1ms);
+    }
+  }, [](std::shared_ptr<tcp::ServerSession>) {});
+
+  Dispatcher dispatcher{make_endpoint<tcp::Client::protocol_type>(srv.GetLocalEndpoint())};
+  auto stream = dispatcher.MakeStream();
+  auto c = std::make_shared<tcp::Client>(io_context, stream.token(), [&](carla::Buffer buffer) {
+    ASSERT_EQ(buffer, *message);
+    ++message_count;
+  });
+  c->SetSocketBufferSize(4u * message_size);
+  c->Connect();
+
+  carla::ThreadGroup threads;
+  threads.CreateThreads(
+      std::max(2u, std::thread::hardware_concurrency()),
+      [&]() { io_context.run(); });
+
+  for (auto i = 0u; (i < 500u) && (message_count < number_of_messages); ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  done = true;
+  io_context.stop();
+  ASSERT_EQ(message_count, number_of_messages);
+  c->Stop();
+}
+
+TEST(streaming, compression) {
+  using namespace carla::streaming::detail;
+  using namespace util::buffer;
+
+  // A smooth depth-like image after a small header.
+  const auto header = make_random(40u);
+  std::vector<uint32_t> pixels(640u * 480u);
+  for (auto i = 0u; i < pixels.size(); ++i) {
+    pixels[i] = 0xFF000000u | ((i / 7u) & 0xFFFFFFu);
+  }
+  const carla::Buffer image(pixels);
+
+  std::vector<size_t> compressed_sizes;
+  for (auto codec : {Compression::LZ4, Compression::DeltaLZ4}) {
+    tcp::Message message(carla::Buffer(header->buffer()), carla::Buffer(image.buffer()));
+    const auto *frame = message.GetCompressed(codec);
+    ASSERT_NE(frame, nullptr);
+    ASSERT_LT(frame->size(), message.size() / 2u);
+    compressed_sizes.push_back(frame->size());
+    ASSERT_EQ(frame, message.GetCompressed(codec));
+
+    message_size_type size;
+    std::memcpy(&size, frame->data(), sizeof(size));
+    ASSERT_NE(size & tcp::COMPRESSED_FLAG, 0u);
+    size &= ~tcp::COMPRESSED_FLAG;
+    ASSERT_EQ(size + sizeof(size), frame->size());
+
+    carla::Buffer body(frame->data() + sizeof(size), size);
+    carla::Buffer result;
+    ASSERT_TRUE(tcp::Decompress(body, result));
+    ASSERT_EQ(result.size(), header->size() + image.size());
+    ASSERT_EQ(std::memcmp(result.data(), header->data(), header->size()), 0);
+    ASSERT_EQ(std::memcmp(result.data() + header->size(), image.data(), image.size()), 0);
+
+    // Truncated data is rejected.
+    body.reset(body.size() - 1u);
+    ASSERT_FALSE(tcp::Decompress(body, result));
+  }
+  // The predictor pays off on smooth images.
+  ASSERT_LT(compressed_sizes[1u], compressed_sizes[0u]);
+
+  // Random data does not compress, it is sent as it is.
+  tcp::Message message(carla::Buffer(make_random(64u * 1024u)->buffer()));
+  ASSERT_EQ(message.GetCompressed(Compression::LZ4), nullptr);
+}
+
+TEST(streaming, multiplexed_client) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 50u;
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+  std::vector<Stream> streams;
+  for (auto i = 0u; i < 3u; ++i) {
+    streams.emplace_back(srv.MakeStream());
+  }
+  auto multi_stream = srv.MakeMultiStream();
+
+  // Big enough to go through shared memory once the ring is accepted.
+  const auto big_message = make_random(128u * 1024u);
+
+  Client c;
+  c.SetMultiplexed(true);
+  c.AsyncRun(2u);
+  std::array<std::atomic_size_t, 4u> received;
+  for (auto &count : received) {
+    count = 0u;
+  }
+  for (auto i = 0u; i < streams.size(); ++i) {
+    const auto expected = "stream " + std::to_string(i);
+    c.Subscribe(streams[i].token(), [&received, i, expected](auto buffer) {
+      ASSERT_EQ(as_string(buffer), expected);
+      ++received[i];
+    });
+  }
+  c.Subscribe(multi_stream.token(), [&](auto buffer) {
+    ASSERT_EQ(buffer, *big_message);
+    ++received[3u];
+  });
+
+  // A regular client shares the multi-stream.
+  std::atomic_size_t received_by_other{0u};
+  Client other;
+  other.AsyncRun(1u);
+  other.Subscribe(multi_stream.token(), [&](auto buffer) {
+    ASSERT_EQ(buffer, *big_message);
+    ++received_by_other;
+  });
+
+  std::this_thread::sleep_for(20ms);
+  for (auto j = 0u; j < number_of_messages; ++j) {
+    std::this_thread::sleep_for(2ms);
+    for (auto i = 0u; i < streams.size(); ++i) {
+      streams[i] << ("stream " + std::to_string(i));
+    }
+    multi_stream.Write(carla::Buffer(big_message->buffer()));
+  }
+  std::this_thread::sleep_for(50ms);
+
+  for (auto &count : received) {
+    ASSERT_GE(count, number_of_messages - 3u);
+  }
+  ASSERT_GE(received_by_other, number_of_messages - 3u);
+
+  // Unsubscribing from one stream leaves the others untouched.
+  c.UnSubscribe(streams[0u].token());
+  std::this_thread::sleep_for(20ms);
+  const size_t received_before = received[0u];
+  const size_t received_by_second_before = received[1u];
+  for (auto j = 0u; j < number_of_messages; ++j) {
+    std::this_thread::sleep_for(2ms);
+    for (auto i = 0u; i < streams.size(); ++i) {
+      streams[i] << ("stream " + std::to_string(i));
+    }
+  }
+  std::this_thread::sleep_for(50ms);
+  ASSERT_EQ(received[0u], received_before);
+  ASSERT_GE(received[1u], received_by_second_before + number_of_messages - 3u);
+}
+
+TEST(streaming, dispatcher_concurrent_streams) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  constexpr size_t number_of_threads = 8u;
+  constexpr size_t number_of_streams = 200u;
+
+  Dispatcher dispatcher{make_endpoint<boost::asio::ip::tcp>(TESTING_PORT)};
+  std::vector<std::vector<MultiStream>> streams(number_of_threads);
+  carla::ThreadGroup threads;
+  for (auto &thread_streams : streams) {
+    threads.CreateThread([&dispatcher, &thread_streams]() {
+      for (auto i = 0u; i < number_of_streams; ++i) {
+        thread_streams.emplace_back(dispatcher.MakeMultiStream());
+      }
+    });
+  }
+  threads.JoinAll();
+
+  std::unordered_set<stream_id_type> ids;
+  for (auto &thread_streams : streams) {
+    for (auto &stream : thread_streams) {
+      const auto id = carla::streaming::detail::token_type(stream.token()).get_stream_id();
+      ASSERT_NE(id, tcp::MULTIPLEXED_STREAM_ID);
+      ASSERT_TRUE(ids.insert(id).second);
+    }
+  }
+  ASSERT_EQ(ids.size(), number_of_threads * number_of_streams);
+}
@@ -0,0 +1,262 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/ThreadGroup.h>
+#include <carla/sensor/data/ActorDynamicState.h>
+#include <carla/streaming/Client.h>
+#include <carla/streaming/Server.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#  include <time.h>
+#endif // __linux__
+
+using namespace carla::streaming;
+using namespace std::chrono_literals;
+
+using clock_type = std::chrono::steady_clock;
+
+/// CPU time spent by the calling thread, zero where it cannot be measured.
+static double get_thread_cpu_seconds() {
+#ifdef __linux__
+  timespec time;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) == 0) {
+    return static_cast<double>(time.tv_sec) + 1e-9 * static_cast<double>(time.tv_nsec);
+  }
+#endif // __linux__
+  return 0.0;
+}
+
+static double get_process_cpu_seconds() {
+  return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+static double percentile(const std::vector<double> &sorted, double p) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  const auto index = static_cast<size_t>(p * static_cast<double>(sorted.size()));
+  return sorted[std::min(index, sorted.size() - 1u)];
+}
+
+/// Streams a mix of sensors to a number of clients, every message carries the
+/// time it was written so the clients can measure the latency.
+class SensorMixBenchmark {
+public:
+
+  explicit SensorMixBenchmark(size_t number_of_clients)
+    : _server(TESTING_PORT) {
+    for (auto i = 0u; i < number_of_clients; ++i) {
+      _clients.emplace_back(std::make_unique<Client>());
+    }
+  }
+
+  void AddStream(std::string name, size_t message_size, size_t frequency) {
+    DEBUG_ASSERT(message_size >= sizeof(clock_type::rep));
+    _streams.emplace_back(std::make_unique<StreamData>(
+        std::move(name),
+        _server.MakeMultiStream(),
+        message_size,
+        frequency));
+  }
+
+  void Run(double seconds, double success_ratio) {
+    for (auto &client : _clients) {
+      for (auto &data : _streams) {
+        auto *stream = data.get();
+        client->Subscribe(stream->stream.token(), [stream](carla::Buffer message) {
+          const auto now = clock_type::now().time_since_epoch().count();
+          clock_type::rep written;
+          std::memcpy(&written, message.data(), sizeof(written));
+          const auto latency = 1e-6 * static_cast<double>(now - written);
+          stream->bytes += message.size();
+          std::lock_guard<std::mutex> lock(stream->mutex);
+          stream->latencies.emplace_back(latency);
+        });
+      }
+    }
+
+    _server.AsyncRun(_streams.size());
+    for (auto &client : _clients) {
+      client->AsyncRun(std::max<size_t>(1u, _streams.size() / 2u));
+    }
+
+    std::this_thread::sleep_for(1s); // the clients need to be ready so we make
+                                     // sure we get all the messages.
+
+    const auto process_cpu_begin = get_process_cpu_seconds();
+    const auto begin = clock_type::now();
+
+    carla::ThreadGroup producers;
+    for (auto &data : _streams) {
+      auto *stream = data.get();
+      stream->number_of_messages = static_cast<size_t>(seconds * static_cast<double>(stream->frequency));
+      producers.CreateThread([stream]() {
+        const auto cpu_begin = get_thread_cpu_seconds();
+        const auto period = std::chrono::nanoseconds(1000000000 / stream->frequency);
+        auto next = clock_type::now();
+        for (auto i = 0u; i < stream->number_of_messages; ++i) {
+          next += period;
+          std::this_thread::sleep_until(next);
+          // Same work as a sensor: copy the data into a buffer of the pool.
+          auto buffer = stream->stream.MakeBuffer();
+          buffer.copy_from(stream->payload);
+          const auto written = clock_type::now().time_since_epoch().count();
+          std::memcpy(buffer.data(), &written, sizeof(written));
+          stream->stream.Write(std::move(buffer));
+        }
+        stream->producer_cpu_seconds = get_thread_cpu_seconds() - cpu_begin;
+      });
+    }
+    producers.JoinAll();
+
+    for (auto i = 0u; (i < 10u) && !IsDone(); ++i) {
+      std::this_thread::sleep_for(100ms);
+    }
+
+    const std::chrono::duration<double> elapsed = clock_type::now() - begin;
+    const auto process_cpu = get_process_cpu_seconds() - process_cpu_begin;
+
+    Report(elapsed.count(), process_cpu, success_ratio);
+  }
+
+private:
+
+  struct StreamData {
+    StreamData(std::string in_name, MultiStream in_stream, size_t message_size, size_t in_frequency)
+      : name(std::move(in_name)),
+        stream(std::move(in_stream)),
+        payload(std::vector<uint32_t>(message_size / sizeof(uint32_t), 42u)),
+        frequency(in_frequency) {}
+
+    const std::string name;
+
+    MultiStream stream;
+
+    const carla::Buffer payload;
+
+    const size_t frequency;
+
+    size_t number_of_messages = 0u;
+
+    double producer_cpu_seconds = 0.0;
+
+    std::atomic_size_t bytes{0u};
+
+    std::mutex mutex;
+
+    std::vector<double> latencies;
+  };
+
+  bool IsDone() {
+    for (auto &stream : _streams) {
+      std::lock_guard<std::mutex> lock(stream->mutex);
+      if (stream->latencies.size() < (stream->number_of_messages * _clients.size())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void Report(double elapsed, double process_cpu, double success_ratio) {
+    std::cout << "benchmark: " << _clients.size() << " clients, "
+              << std::fixed << std::setprecision(2) << elapsed << " s, "
+              << process_cpu << " s of process CPU" << std::endl;
+    std::cout << std::left
+              << std::setw(14) << "stream"
+              << std::setw(20) << "received"
+              << std::setw(10) << "dropped"
+              << std::setw(10) << "p50 ms"
+              << std::setw(10) << "p99 ms"
+              << std::setw(10) << "p999 ms"
+              << std::setw(12) << "MB/s"
+              << std::setw(12) << "CPU ms" << std::endl;
+    for (auto &stream : _streams) {
+      std::vector<double> latencies;
+      {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        latencies = stream->latencies;
+      }
+      std::sort(latencies.begin(), latencies.end());
+      const auto expected = stream->number_of_messages * _clients.size();
+      const auto received = std::min(latencies.size(), expected);
+      const auto dropped_by_server = stream->stream.GetSendQueueStats().dropped_messages;
+      std::cout << std::setw(14) << stream->name
+                << std::setw(20) << (std::to_string(received) + '/' + std::to_string(expected))
+                << std::setw(10) << dropped_by_server
+                << std::setw(10) << percentile(latencies, 0.5)
+                << std::setw(10) << percentile(latencies, 0.99)
+                << std::setw(10) << percentile(latencies, 0.999)
+                << std::setw(12) << (1e-6 * static_cast<double>(stream->bytes) / elapsed)
+                << std::setw(12) << (1e3 * stream->producer_cpu_seconds) << std::endl;
+      const auto threshold = static_cast<size_t>(success_ratio * static_cast<double>(expected));
+#ifdef NDEBUG
+      EXPECT_GE(received, threshold) << stream->name;
+#else
+      if (received < threshold) {
+        carla::log_warning(stream->name, "threshold unmet:", received, '/', threshold);
+      }
+#endif // NDEBUG
+    }
+    std::cout << std::right;
+  }
+
+  Server _server;
+
+  std::vector<std::unique_ptr<StreamData>> _streams;
+
+  std::vector<std::unique_ptr<Client>> _clients;
+};
+
+static void benchmark_sensor_mix(
+    const size_t number_of_clients,
+    const double success_ratio) {
+  constexpr auto frequency = 20u;
+  constexpr auto seconds = 5.0;
+  carla::logging::log("Benchmark: sensor mix at", frequency, "FPS to", number_of_clients, "clients.");
+
+  SensorMixBenchmark benchmark(number_of_clients);
+  // RGBA cameras.
+  constexpr auto image_size = 1920u * 1080u * 4u;
+  for (auto i = 0u; i < 4u; ++i) {
+    benchmark.AddStream("camera_" + std::to_string(i), image_size, frequency);
+  }
+  // 64-channel lidar at 1.3 M points/s, a header with the number of points of
+  // each channel followed by the points.
+  constexpr auto lidar_channels = 64u;
+  constexpr auto lidar_points = 1300000u / frequency;
+  constexpr auto lidar_size =
+      (2u + lidar_channels) * sizeof(uint32_t) + lidar_points * 3u * sizeof(float);
+  benchmark.AddStream("lidar", lidar_size, frequency);
+  // Episode state of 2000 actors.
+  constexpr auto number_of_actors = 2000u;
+  constexpr auto episode_header_size = sizeof(uint64_t) + sizeof(double) + sizeof(float);
+  constexpr auto episode_size =
+      episode_header_size + number_of_actors * sizeof(carla::sensor::data::ActorDynamicState);
+  benchmark.AddStream("episode", episode_size, frequency);
+
+  benchmark.Run(seconds, success_ratio);
+}
+
+TEST(benchmark_sensor_mix, single_client) {
+  benchmark_sensor_mix(1u, 0.9);
+}
+
+TEST(benchmark_sensor_mix, multiple_clients) {
+  // Every client receives more than 600 MB/s, the send queues are expected to
+  // drop camera frames on most machines.
+  benchmark_sensor_mix(4u, 0.25);
+}
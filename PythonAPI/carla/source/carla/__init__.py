@@ -6,3 +6,14 @@
 
 # pylint: disable=W0401
 from .libcarla import *
+
+
+def _await_future(self):
+    """Waits for the future in the default executor of the running event loop."""
+    import asyncio
+    return asyncio.get_event_loop().run_in_executor(None, self.get).__await__()
+
+
+for _future in (ActorFuture, TrafficLightListFuture, VehiclePhysicsControlFuture):
+    _future.__await__ = _await_future
+del _future
@@ -4,6 +4,7 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include <carla/PythonUtil.h>
 #include <carla/client/Actor.h>
 #include <carla/client/TrafficLight.h>
 #include <carla/client/Vehicle.h>
@@ -36,7 +37,11 @@ static auto GetSemanticTags(const carla::client::Actor &self) {
 
 static auto GetGroupTrafficLights(carla::client::TrafficLight &self) {
   namespace py = boost::python;
-  auto values = self.GetGroupTrafficLights();
+  std::vector<carla::SharedPtr<carla::client::TrafficLight>> values;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    values = self.GetGroupTrafficLights();
+  }
   py::list result;
   for (auto value : values) {
     result.append(value);
@@ -46,12 +51,14 @@ static auto GetGroupTrafficLights(carla::client::TrafficLight &self) {
 
 template <typename ControlT>
 static void ApplyControl(carla::client::Walker &self, const ControlT &control) {
+  carla::PythonUtil::ReleaseGIL unlock;
   self.ApplyControl(control);
 }
 
 void export_actor() {
   using namespace boost::python;
   namespace cc = carla::client;
+  namespace cg = carla::geom;
   namespace cr = carla::rpc;
 
   class_<std::vector<int>>("vector_of_ints")
@@ -79,28 +86,32 @@ void export_actor() {
       .def("get_velocity", &cc::Actor::GetVelocity)
       .def("get_angular_velocity", &cc::Actor::GetAngularVelocity)
       .def("get_acceleration", &cc::Actor::GetAcceleration)
-      .def("set_location", &cc::Actor::SetLocation, (arg("location")))
-      .def("set_transform", &cc::Actor::SetTransform, (arg("transform")))
-      .def("set_velocity", &cc::Actor::SetVelocity, (arg("vector")))
-      .def("set_angular_velocity", &cc::Actor::SetAngularVelocity, (arg("vector")))
-      .def("add_impulse", &cc::Actor::AddImpulse, (arg("vector")))
-      .def("set_simulate_physics", &cc::Actor::SetSimulatePhysics, (arg("enabled") = true))
+      .def("set_location", CALL_WITHOUT_GIL_1(cc::Actor, SetLocation, const cg::Location &), (arg("location")))
+      .def("set_transform", CALL_WITHOUT_GIL_1(cc::Actor, SetTransform, const cg::Transform &), (arg("transform")))
+      .def("set_velocity", CALL_WITHOUT_GIL_1(cc::Actor, SetVelocity, const cg::Vector3D &), (arg("vector")))
+      .def("set_angular_velocity", CALL_WITHOUT_GIL_1(cc::Actor, SetAngularVelocity, const cg::Vector3D &), (arg("vector")))
+      .def("add_impulse", CALL_WITHOUT_GIL_1(cc::Actor, AddImpulse, const cg::Vector3D &), (arg("vector")))
+      .def("set_simulate_physics", CALL_WITHOUT_GIL_1(cc::Actor, SetSimulatePhysics, bool), (arg("enabled") = true))
+      .def("set_kinematic", CALL_WITHOUT_GIL_1(cc::Actor, SetKinematic, bool), (arg("enabled") = true))
       .def("destroy", CALL_WITHOUT_GIL(cc::Actor, Destroy))
       .def(self_ns::str(self_ns::self))
   ;
 
+  ExportFuture<cc::Vehicle::PhysicsControl>("VehiclePhysicsControlFuture");
+
   class_<cc::Vehicle, bases<cc::Actor>, boost::noncopyable, boost::shared_ptr<cc::Vehicle>>("Vehicle",
       no_init)
       .add_property("bounding_box", CALL_RETURNING_COPY(cc::Vehicle, GetBoundingBox))
-      .def("apply_control", &cc::Vehicle::ApplyControl, (arg("control")))
+      .def("apply_control", CALL_WITHOUT_GIL_1(cc::Vehicle, ApplyControl, const cc::Vehicle::Control &), (arg("control")))
       .def("get_control", &cc::Vehicle::GetControl)
-      .def("apply_physics_control", &cc::Vehicle::ApplyPhysicsControl, (arg("physics_control")))
+      .def("apply_physics_control", CALL_WITHOUT_GIL_1(cc::Vehicle, ApplyPhysicsControl, const cc::Vehicle::PhysicsControl &), (arg("physics_control")))
       .def("get_physics_control", CONST_CALL_WITHOUT_GIL(cc::Vehicle, GetPhysicsControl))
-      .def("set_autopilot", &cc::Vehicle::SetAutopilot, (arg("enabled") = true))
+      .def("get_physics_control_async", CONST_CALL_WITHOUT_GIL(cc::Vehicle, GetPhysicsControlAsync))
+      .def("set_autopilot", CALL_WITHOUT_GIL_1(cc::Vehicle, SetAutopilot, bool), (arg("enabled") = true))
       .def("get_speed_limit", &cc::Vehicle::GetSpeedLimit)
       .def("get_traffic_light_state", &cc::Vehicle::GetTrafficLightState)
       .def("is_at_traffic_light", &cc::Vehicle::IsAtTrafficLight)
-      .def("get_traffic_light", &cc::Vehicle::GetTrafficLight)
+      .def("get_traffic_light", CONST_CALL_WITHOUT_GIL(cc::Vehicle, GetTrafficLight))
       .def(self_ns::str(self_ns::self))
   ;
 
@@ -113,10 +124,10 @@ void export_actor() {
   ;
 
   class_<cc::WalkerAIController, bases<cc::Actor>, boost::noncopyable, boost::shared_ptr<cc::WalkerAIController>>("WalkerAIController", no_init)
-    .def("start", &cc::WalkerAIController::Start)
-    .def("stop", &cc::WalkerAIController::Stop)
-    .def("go_to_location", &cc::WalkerAIController::GoToLocation, (arg("destination")))
-    .def("set_max_speed", &cc::WalkerAIController::SetMaxSpeed, (arg("speed")))
+    .def("start", CALL_WITHOUT_GIL(cc::WalkerAIController, Start))
+    .def("stop", CALL_WITHOUT_GIL(cc::WalkerAIController, Stop))
+    .def("go_to_location", CALL_WITHOUT_GIL_1(cc::WalkerAIController, GoToLocation, const cg::Location &), (arg("destination")))
+    .def("set_max_speed", CALL_WITHOUT_GIL_1(cc::WalkerAIController, SetMaxSpeed, float), (arg("speed")))
     .def(self_ns::str(self_ns::self))
   ;
 
@@ -134,23 +145,26 @@ void export_actor() {
       .value("Unknown", cr::TrafficLightState::Unknown)
   ;
 
+  ExportFuture<std::vector<carla::SharedPtr<cc::TrafficLight>>>("TrafficLightListFuture");
+
   class_<cc::TrafficLight, bases<cc::TrafficSign>, boost::noncopyable, boost::shared_ptr<cc::TrafficLight>>(
       "TrafficLight",
       no_init)
       .add_property("state", &cc::TrafficLight::GetState)
-      .def("set_state", &cc::TrafficLight::SetState, (arg("state")))
+      .def("set_state", CALL_WITHOUT_GIL_1(cc::TrafficLight, SetState, cr::TrafficLightState), (arg("state")))
       .def("get_state", &cc::TrafficLight::GetState)
-      .def("set_green_time", &cc::TrafficLight::SetGreenTime, (arg("green_time")))
+      .def("set_green_time", CALL_WITHOUT_GIL_1(cc::TrafficLight, SetGreenTime, float), (arg("green_time")))
       .def("get_green_time", &cc::TrafficLight::GetGreenTime)
-      .def("set_yellow_time", &cc::TrafficLight::SetYellowTime, (arg("yellow_time")))
+      .def("set_yellow_time", CALL_WITHOUT_GIL_1(cc::TrafficLight, SetYellowTime, float), (arg("yellow_time")))
       .def("get_yellow_time", &cc::TrafficLight::GetYellowTime)
-      .def("set_red_time", &cc::TrafficLight::SetRedTime, (arg("red_time")))
+      .def("set_red_time", CALL_WITHOUT_GIL_1(cc::TrafficLight, SetRedTime, float), (arg("red_time")))
       .def("get_red_time", &cc::TrafficLight::GetRedTime)
       .def("get_elapsed_time", &cc::TrafficLight::GetElapsedTime)
-      .def("freeze", &cc::TrafficLight::Freeze, (arg("freeze")))
+      .def("freeze", CALL_WITHOUT_GIL_1(cc::TrafficLight, Freeze, bool), (arg("freeze")))
       .def("is_frozen", &cc::TrafficLight::IsFrozen)
-      .def("get_pole_index", &cc::TrafficLight::GetPoleIndex)
+      .def("get_pole_index", CALL_WITHOUT_GIL(cc::TrafficLight, GetPoleIndex))
       .def("get_group_traffic_lights", &GetGroupTrafficLights)
+      .def("get_group_traffic_lights_async", CALL_WITHOUT_GIL(cc::TrafficLight, GetGroupTrafficLightsAsync))
       .def(self_ns::str(self_ns::self))
   ;
 }
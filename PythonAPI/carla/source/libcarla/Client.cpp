@@ -5,11 +5,28 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include <carla/PythonUtil.h>
+#include <carla/client/Actor.h>
 #include <carla/client/Client.h>
 #include <carla/client/World.h>
 
 #include <boost/python/stl_iterator.hpp>
 
+#include <ostream>
+
+namespace carla {
+namespace rpc {
+
+  std::ostream &operator<<(std::ostream &out, const MapLoadProgress &progress) {
+    out << "MapLoadProgress(map_name=" << progress.map_name
+        << ", state=" << std::to_string(static_cast<int>(progress.state))
+        << ", progress=" << std::to_string(progress.progress)
+        << ", elapsed_seconds=" << std::to_string(progress.elapsed_seconds) << ')';
+    return out;
+  }
+
+} // namespace rpc
+} // namespace carla
+
 static void SetTimeout(carla::client::Client &client, double seconds) {
   client.SetTimeout(TimeDurationFromSeconds(seconds));
 }
@@ -23,6 +40,43 @@ static auto GetAvailableMaps(const carla::client::Client &self) {
   return result;
 }
 
+static auto GetServerProfilerStats(const carla::client::Client &self) {
+  std::vector<carla::profiler::ProfilerStats> stats_list;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    stats_list = self.GetServerProfilerStats();
+  }
+  boost::python::list result;
+  for (auto &stats : stats_list) {
+    result.append(std::move(stats));
+  }
+  return result;
+}
+
+static auto GetSensorMetrics(const carla::client::Client &self) {
+  std::vector<carla::rpc::SensorMetrics> metrics_list;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    metrics_list = self.GetSensorMetrics();
+  }
+  boost::python::list result;
+  for (auto &metrics : metrics_list) {
+    result.append(std::move(metrics));
+  }
+  return result;
+}
+
+static void LoadWorldAsync(
+    const carla::client::Client &self,
+    std::string map_name,
+    const boost::python::object &preload_assets) {
+  std::vector<std::string> assets{
+      boost::python::stl_input_iterator<std::string>(preload_assets),
+      boost::python::stl_input_iterator<std::string>()};
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.LoadWorldAsync(std::move(map_name), std::move(assets));
+}
+
 static void ApplyBatchCommands(
     const carla::client::Client &self,
     const boost::python::object &commands,
@@ -31,6 +85,7 @@ static void ApplyBatchCommands(
   std::vector<CommandType> cmds{
       boost::python::stl_input_iterator<CommandType>(commands),
       boost::python::stl_input_iterator<CommandType>()};
+  carla::PythonUtil::ReleaseGIL unlock;
   self.ApplyBatch(std::move(cmds), do_tick);
 }
 
@@ -42,34 +97,279 @@ static auto ApplyBatchCommandsSync(
   std::vector<CommandType> cmds{
       boost::python::stl_input_iterator<CommandType>(commands),
       boost::python::stl_input_iterator<CommandType>()};
+  std::vector<carla::rpc::CommandResponse> responses;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    responses = self.ApplyBatchSync(std::move(cmds), do_tick);
+  }
   boost::python::list result;
-  for (auto &response : self.ApplyBatchSync(std::move(cmds), do_tick)) {
+  for (auto &response : responses) {
     result.append(std::move(response));
   }
   return result;
 }
 
+static void ApplyVehicleControlBatch(
+    const carla::client::Client &self,
+    const boost::python::object &actors,
+    const boost::python::object &controls) {
+  namespace py = boost::python;
+  const auto size = py::len(actors);
+  if (py::len(controls) != size) {
+    PyErr_SetString(PyExc_ValueError, "actors and controls must have the same length");
+    py::throw_error_already_set();
+  }
+  carla::rpc::VehicleControlBatch batch;
+  batch.Reserve(static_cast<size_t>(size));
+  for (auto i = decltype(size)(0); i < size; ++i) {
+    py::object actor = actors[i];
+    py::extract<carla::ActorId> id(actor);
+    batch.Add(
+        id.check() ? id() : py::extract<const carla::client::Actor &>(actor)().GetId(),
+        py::extract<carla::rpc::VehicleControl>(controls[i]));
+  }
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.ApplyVehicleControlBatch(batch);
+}
+
+/// Copy the numbers in @a values to a vector, either any contiguous buffer of
+/// numbers such as a numpy array, converted without going through a Python
+/// object for each of them, or any other iterable.
+template <typename T>
+static std::vector<T> ReadNumbers(const boost::python::object &values) {
+  namespace py = boost::python;
+#if PY_MAJOR_VERSION >= 3
+  if (PyObject_CheckBuffer(values.ptr())) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(values.ptr(), &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+      py::throw_error_already_set();
+    }
+    std::unique_ptr<Py_buffer, decltype(&PyBuffer_Release)> release(&view, &PyBuffer_Release);
+    const auto count = static_cast<size_t>(view.len / view.itemsize);
+    auto copy = [&](auto *data) {
+      return std::vector<T>(data, data + count);
+    };
+    // Native byte order and sizes, as numpy exports them.
+    std::string format = view.format != nullptr ? view.format : "B";
+    if (!format.empty() && ((format[0] == '@') || (format[0] == '='))) {
+      format.erase(0u, 1u);
+    }
+    const auto size = view.itemsize;
+    if ((format == "f") && (size == 4)) { return copy(static_cast<const float *>(view.buf)); }
+    if ((format == "d") && (size == 8)) { return copy(static_cast<const double *>(view.buf)); }
+    // The size of the integers depends on the platform, e.g. "l" is 8 bytes
+    // on Linux and 4 on Windows.
+    if ((format.size() == 1u) && (std::string("bhilq").find(format[0u]) != std::string::npos)) {
+      if (size == 1) { return copy(static_cast<const int8_t *>(view.buf)); }
+      if (size == 2) { return copy(static_cast<const int16_t *>(view.buf)); }
+      if (size == 4) { return copy(static_cast<const int32_t *>(view.buf)); }
+      if (size == 8) { return copy(static_cast<const int64_t *>(view.buf)); }
+    }
+    if ((format.size() == 1u) && (std::string("BHILQ").find(format[0u]) != std::string::npos)) {
+      if (size == 1) { return copy(static_cast<const uint8_t *>(view.buf)); }
+      if (size == 2) { return copy(static_cast<const uint16_t *>(view.buf)); }
+      if (size == 4) { return copy(static_cast<const uint32_t *>(view.buf)); }
+      if (size == 8) { return copy(static_cast<const uint64_t *>(view.buf)); }
+    }
+    throw std::invalid_argument("unsupported buffer format " + format);
+  }
+#endif // PY_MAJOR_VERSION >= 3
+  return std::vector<T>{py::stl_input_iterator<T>(values), py::stl_input_iterator<T>()};
+}
+
+static void CheckSize(size_t size, size_t expected, const char *name) {
+  if (size != expected) {
+    throw std::invalid_argument(std::string(name) + " must have a value for each actor");
+  }
+}
+
+/// Same as ApplyVehicleControlBatch taking a column of values for each
+/// control, e.g. numpy arrays.
+static void ApplyVehicleControls(
+    const carla::client::Client &self,
+    const boost::python::object &actor_ids,
+    const boost::python::object &throttle,
+    const boost::python::object &steer,
+    const boost::python::object &brake) {
+  const auto ids = ReadNumbers<carla::ActorId>(actor_ids);
+  const auto throttles = ReadNumbers<float>(throttle);
+  const auto steers = ReadNumbers<float>(steer);
+  const auto brakes = ReadNumbers<float>(brake);
+  CheckSize(throttles.size(), ids.size(), "throttle");
+  CheckSize(steers.size(), ids.size(), "steer");
+  CheckSize(brakes.size(), ids.size(), "brake");
+  carla::PythonUtil::ReleaseGIL unlock;
+  carla::rpc::VehicleControlBatch batch;
+  batch.Reserve(ids.size());
+  for (size_t i = 0u; i < ids.size(); ++i) {
+    carla::rpc::VehicleControl control;
+    control.throttle = throttles[i];
+    control.steer = steers[i];
+    control.brake = brakes[i];
+    batch.Add(ids[i], control);
+  }
+  self.ApplyVehicleControlBatch(batch);
+}
+
+static void ApplyTransformBatch(
+    const carla::client::Client &self,
+    const boost::python::object &actors,
+    const boost::python::object &transforms) {
+  namespace py = boost::python;
+  const auto size = py::len(actors);
+  if (py::len(transforms) != size) {
+    PyErr_SetString(PyExc_ValueError, "actors and transforms must have the same length");
+    py::throw_error_already_set();
+  }
+  carla::rpc::TransformBatch batch;
+  batch.Reserve(static_cast<size_t>(size));
+  for (auto i = decltype(size)(0); i < size; ++i) {
+    py::object actor = actors[i];
+    py::extract<carla::ActorId> id(actor);
+    batch.Add(
+        id.check() ? id() : py::extract<const carla::client::Actor &>(actor)().GetId(),
+        py::extract<carla::geom::Transform>(transforms[i]));
+  }
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.ApplyTransformBatch(batch);
+}
+
+/// Same as ApplyTransformBatch taking a column of ids, x, y, z locations and
+/// pitch, yaw, roll rotations, e.g. numpy arrays of shape (N,) and (N, 3).
+static void ApplyTransforms(
+    const carla::client::Client &self,
+    const boost::python::object &actor_ids,
+    const boost::python::object &xyz,
+    const boost::python::object &rpy) {
+  const auto ids = ReadNumbers<carla::ActorId>(actor_ids);
+  const auto locations = ReadNumbers<float>(xyz);
+  const auto rotations = ReadNumbers<float>(rpy);
+  CheckSize(locations.size(), 3u * ids.size(), "xyz");
+  CheckSize(rotations.size(), 3u * ids.size(), "rpy");
+  carla::PythonUtil::ReleaseGIL unlock;
+  carla::rpc::TransformBatch batch;
+  batch.Reserve(ids.size());
+  for (size_t i = 0u; i < ids.size(); ++i) {
+    const auto *l = &locations[3u * i];
+    const auto *r = &rotations[3u * i];
+    batch.Add(ids[i], carla::geom::Transform{
+        carla::geom::Location{l[0u], l[1u], l[2u]},
+        carla::geom::Rotation{r[0u], r[1u], r[2u]}});
+  }
+  self.ApplyTransformBatch(batch);
+}
+
+static uint32_t RegisterWalkerBones(
+    const carla::client::Client &self,
+    const boost::python::object &bone_names) {
+  std::vector<std::string> names{
+      boost::python::stl_input_iterator<std::string>(bone_names),
+      boost::python::stl_input_iterator<std::string>()};
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.RegisterWalkerBones(names);
+}
+
+/// Set every bone of the bone set @a bone_set of each walker in @a walker_ids,
+/// from the x, y, z location and pitch, yaw, roll rotation of each bone, e.g.
+/// a numpy array of shape (N, B, 6) for B bones.
+static void ApplyWalkerBoneControls(
+    const carla::client::Client &self,
+    const uint32_t bone_set,
+    const boost::python::object &walker_ids,
+    const boost::python::object &transforms) {
+  const auto ids = ReadNumbers<carla::ActorId>(walker_ids);
+  const auto values = ReadNumbers<float>(transforms);
+  if (ids.empty()) {
+    return;
+  }
+  constexpr size_t values_per_bone = 6u;
+  const size_t values_per_walker = values.size() / ids.size();
+  if ((values_per_walker % values_per_bone) != 0u) {
+    throw std::invalid_argument("transforms must have 6 values for each bone");
+  }
+  CheckSize(values.size(), values_per_walker * ids.size(), "transforms");
+  carla::PythonUtil::ReleaseGIL unlock;
+  const size_t bones = values_per_walker / values_per_bone;
+  carla::rpc::WalkerBoneControlBatch batch{bone_set};
+  batch.Reserve(bones * ids.size());
+  for (size_t i = 0u; i < ids.size(); ++i) {
+    for (size_t bone = 0u; bone < bones; ++bone) {
+      const auto *v = &values[i * values_per_walker + bone * values_per_bone];
+      batch.Add(ids[i], static_cast<uint16_t>(bone), carla::geom::Transform{
+          carla::geom::Location{v[0u], v[1u], v[2u]},
+          carla::geom::Rotation{v[3u], v[4u], v[5u]}});
+    }
+  }
+  self.ApplyWalkerBoneControlBatch(batch);
+}
+
 void export_client() {
   using namespace boost::python;
   namespace cc = carla::client;
+  namespace cr = carla::rpc;
+
+  enum_<cr::MapLoadState>("MapLoadState")
+    .value("Idle", cr::MapLoadState::Idle)
+    .value("Loading", cr::MapLoadState::Loading)
+    .value("Opening", cr::MapLoadState::Opening)
+    .value("Failed", cr::MapLoadState::Failed)
+  ;
+
+  class_<cr::MapLoadProgress>("MapLoadProgress", no_init)
+    .def_readonly("map_name", &cr::MapLoadProgress::map_name)
+    .def_readonly("state", &cr::MapLoadProgress::state)
+    .def_readonly("progress", &cr::MapLoadProgress::progress)
+    .def_readonly("preloaded_assets", &cr::MapLoadProgress::preloaded_assets)
+    .def_readonly("total_preload_assets", &cr::MapLoadProgress::total_preload_assets)
+    .def_readonly("elapsed_seconds", &cr::MapLoadProgress::elapsed_seconds)
+    .def_readonly("previous_episode_id", &cr::MapLoadProgress::previous_episode_id)
+    .def(self_ns::str(self_ns::self))
+  ;
 
   class_<cc::Client>("Client",
-      init<std::string, uint16_t, size_t>((arg("host"), arg("port"), arg("worker_threads")=0u)))
+      init<std::string, uint16_t, size_t, size_t>((arg("host"), arg("port"), arg("worker_threads")=0u, arg("rpc_connections")=1u)))
     .def("set_timeout", &::SetTimeout, (arg("seconds")))
     .def("get_client_version", &cc::Client::GetClientVersion)
     .def("get_server_version", CONST_CALL_WITHOUT_GIL(cc::Client, GetServerVersion))
-    .def("get_world", &cc::Client::GetWorld)
+    .def("get_server_profiler_stats", &GetServerProfilerStats)
+    .def("set_server_profiler_enabled", CONST_CALL_WITHOUT_GIL_1(cc::Client, SetServerProfilerEnabled, bool), (arg("enabled")))
+    .def("get_server_metrics", CONST_CALL_WITHOUT_GIL(cc::Client, GetServerMetrics))
+    .def("get_sensor_metrics", &GetSensorMetrics)
+    .def("set_sensor_metrics_enabled", CONST_CALL_WITHOUT_GIL_1(cc::Client, SetSensorMetricsEnabled, bool), (arg("enabled")))
+    .def("get_server_memory_report", CONST_CALL_WITHOUT_GIL(cc::Client, GetServerMemoryReport))
+    .def("get_client_memory_report", &cc::Client::GetClientMemoryReport)
+    .def("get_server_frame_trace", CONST_CALL_WITHOUT_GIL(cc::Client, GetServerFrameTrace))
+    .def("set_server_frame_tracer_enabled", CONST_CALL_WITHOUT_GIL_1(cc::Client, SetServerFrameTracerEnabled, bool), (arg("enabled")))
+    .def("get_world", CONST_CALL_WITHOUT_GIL(cc::Client, GetWorld))
     .def("get_available_maps", &GetAvailableMaps)
     .def("reload_world", CONST_CALL_WITHOUT_GIL(cc::Client, ReloadWorld))
     .def("load_world", CONST_CALL_WITHOUT_GIL_1(cc::Client, LoadWorld, std::string), (arg("map_name")))
+    .def("load_world_async", &LoadWorldAsync, (arg("map_name"), arg("preload_assets")=list()))
+    .def("get_map_load_progress", CONST_CALL_WITHOUT_GIL(cc::Client, GetMapLoadProgress))
+    .def("reset_world", CONST_CALL_WITHOUT_GIL(cc::Client, ResetWorld))
     .def("start_recorder", CALL_WITHOUT_GIL_1(cc::Client, StartRecorder, std::string), (arg("name")))
-    .def("stop_recorder", &cc::Client::StopRecorder)
+    .def("stop_recorder", CALL_WITHOUT_GIL(cc::Client, StopRecorder))
     .def("show_recorder_file_info", CALL_WITHOUT_GIL_2(cc::Client, ShowRecorderFileInfo, std::string, bool), (arg("name"), arg("show_all")))
     .def("show_recorder_collisions", CALL_WITHOUT_GIL_3(cc::Client, ShowRecorderCollisions, std::string, char, char), (arg("name"), arg("type1"), arg("type2")))
     .def("show_recorder_actors_blocked", CALL_WITHOUT_GIL_3(cc::Client, ShowRecorderActorsBlocked, std::string, double, double), (arg("name"), arg("min_time"), arg("min_distance")))
+    .def("get_recorder_file_info", CALL_WITHOUT_GIL_1(cc::Client, GetRecorderFileInfo, std::string), (arg("name")))
+    .def("get_recorder_collisions", CALL_WITHOUT_GIL_3(cc::Client, GetRecorderCollisions, std::string, char, char), (arg("name"), arg("type1"), arg("type2")))
+    .def("get_recorder_actors_blocked", CALL_WITHOUT_GIL_3(cc::Client, GetRecorderActorsBlocked, std::string, double, double), (arg("name"), arg("min_time"), arg("min_distance")))
     .def("replay_file", CALL_WITHOUT_GIL_4(cc::Client, ReplayFile, std::string, double, double, uint32_t), (arg("name"), arg("time_start"), arg("duration"), arg("follow_id")))
-    .def("set_replayer_time_factor", &cc::Client::SetReplayerTimeFactor, (arg("time_factor")))
+    .def("set_replayer_time_factor", CALL_WITHOUT_GIL_1(cc::Client, SetReplayerTimeFactor, double), (arg("time_factor")))
+    .def("set_replayer_interpolation", CALL_WITHOUT_GIL_1(cc::Client, SetReplayerInterpolation, bool), (arg("enabled")))
+    .def("set_replayer_frame_by_frame", CALL_WITHOUT_GIL_1(cc::Client, SetReplayerFrameByFrame, bool), (arg("enabled")))
+    .def("get_replayer_actor_id", CALL_WITHOUT_GIL_1(cc::Client, GetReplayerActorId, carla::ActorId), (arg("recorded_id")))
+    .def("set_recorder_keyframe_interval", CALL_WITHOUT_GIL_1(cc::Client, SetRecorderKeyFrameInterval, double), (arg("seconds")))
+    .def("set_recorder_compression", CALL_WITHOUT_GIL_1(cc::Client, SetRecorderCompression, bool), (arg("enabled")))
+    .def("set_recorder_filter", CALL_WITHOUT_GIL_1(cc::Client, SetRecorderFilter, const carla::rpc::RecorderFilter &), (arg("filter")))
     .def("apply_batch", &ApplyBatchCommands, (arg("commands"), arg("do_tick")=false))
     .def("apply_batch_sync", &ApplyBatchCommandsSync, (arg("commands"), arg("do_tick")=false))
+    .def("apply_vehicle_control_batch", &ApplyVehicleControlBatch, (arg("actors"), arg("controls")))
+    .def("apply_vehicle_controls", &ApplyVehicleControls, (arg("actor_ids"), arg("throttle"), arg("steer"), arg("brake")))
+    .def("apply_transform_batch", &ApplyTransformBatch, (arg("actors"), arg("transforms")))
+    .def("apply_transforms", &ApplyTransforms, (arg("actor_ids"), arg("xyz"), arg("rpy")))
+    .def("register_walker_bones", &RegisterWalkerBones, (arg("bone_names")))
+    .def("apply_walker_bone_controls", &ApplyWalkerBoneControls, (arg("bone_set"), arg("walker_ids"), arg("transforms")))
   ;
 }
@@ -156,6 +156,29 @@ void export_commands() {
     .def_readwrite("enabled", &cr::Command::SetAutopilot::enabled)
   ;
 
+  class_<cr::Command::SetTrafficLightState>("SetTrafficLightState")
+    .def("__init__", &command_impl::CustomInit<ActorPtr, cr::TrafficLightState>, (arg("actor"), arg("state")))
+    .def(init<cr::ActorId, cr::TrafficLightState>((arg("actor_id"), arg("state"))))
+    .def_readwrite("actor_id", &cr::Command::SetTrafficLightState::actor)
+    .def_readwrite("state", &cr::Command::SetTrafficLightState::state)
+  ;
+
+  class_<cr::Command::SetTrafficLightTimes>("SetTrafficLightTimes")
+    .def("__init__", &command_impl::CustomInit<ActorPtr, float, float, float>, (arg("actor"), arg("green_time"), arg("yellow_time"), arg("red_time")))
+    .def(init<cr::ActorId, float, float, float>((arg("actor_id"), arg("green_time"), arg("yellow_time"), arg("red_time"))))
+    .def_readwrite("actor_id", &cr::Command::SetTrafficLightTimes::actor)
+    .def_readwrite("green_time", &cr::Command::SetTrafficLightTimes::green_time)
+    .def_readwrite("yellow_time", &cr::Command::SetTrafficLightTimes::yellow_time)
+    .def_readwrite("red_time", &cr::Command::SetTrafficLightTimes::red_time)
+  ;
+
+  class_<cr::Command::FreezeTrafficLight>("FreezeTrafficLight")
+    .def("__init__", &command_impl::CustomInit<ActorPtr, bool>, (arg("actor"), arg("freeze")))
+    .def(init<cr::ActorId, bool>((arg("actor_id"), arg("freeze"))))
+    .def_readwrite("actor_id", &cr::Command::FreezeTrafficLight::actor)
+    .def_readwrite("freeze", &cr::Command::FreezeTrafficLight::freeze)
+  ;
+
   implicitly_convertible<cr::Command::SpawnActor, cr::Command>();
   implicitly_convertible<cr::Command::DestroyActor, cr::Command>();
   implicitly_convertible<cr::Command::ApplyVehicleControl, cr::Command>();
@@ -167,4 +190,7 @@ void export_commands() {
   implicitly_convertible<cr::Command::ApplyImpulse, cr::Command>();
   implicitly_convertible<cr::Command::SetSimulatePhysics, cr::Command>();
   implicitly_convertible<cr::Command::SetAutopilot, cr::Command>();
+  implicitly_convertible<cr::Command::SetTrafficLightState, cr::Command>();
+  implicitly_convertible<cr::Command::SetTrafficLightTimes, cr::Command>();
+  implicitly_convertible<cr::Command::FreezeTrafficLight, cr::Command>();
 }
@@ -9,13 +9,17 @@
 #include <carla/geom/Location.h>
 #include <carla/geom/Rotation.h>
 #include <carla/geom/Transform.h>
+#include <carla/geom/TransformMatrix.h>
 #include <carla/geom/Vector2D.h>
 #include <carla/geom/Vector3D.h>
 
 #include <boost/python/implicit.hpp>
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 
+#include <memory>
 #include <ostream>
+#include <stdexcept>
+#include <string>
 
 namespace carla {
 namespace geom {
@@ -79,13 +83,39 @@ namespace geom {
 } // namespace geom
 } // namespace carla
 
-static void TransformList(const carla::geom::Transform &self, boost::python::list &list) {
+template <typename T>
+static void TransformList(const T &self, boost::python::list &list) {
+  const carla::geom::TransformMatrix matrix(self);
   auto length = boost::python::len(list);
-   for (auto i = 0u; i < length; ++i) {
-    self.TransformPoint(boost::python::extract<carla::geom::Vector3D &>(list[i]));
+  for (auto i = 0u; i < length; ++i) {
+    matrix.TransformPoint(boost::python::extract<carla::geom::Vector3D &>(list[i]));
   }
 }
 
+#if PY_MAJOR_VERSION >= 3
+
+/// Transform in place the points in @a buffer, any writable contiguous
+/// buffer of float32 x, y, z such as a numpy array of shape (N, 3).
+static void TransformBuffer(const carla::geom::TransformMatrix &self, boost::python::object buffer) {
+  Py_buffer view;
+  if (PyObject_GetBuffer(buffer.ptr(), &view, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+    boost::python::throw_error_already_set();
+  }
+  std::unique_ptr<Py_buffer, decltype(&PyBuffer_Release)> release(&view, &PyBuffer_Release);
+  if ((view.itemsize != sizeof(float)) || (std::string(view.format) != "f")) {
+    throw std::invalid_argument("buffer must contain float32 values");
+  }
+  if ((view.len % sizeof(carla::geom::Vector3D)) != 0) {
+    throw std::invalid_argument("buffer size must be a multiple of 3 floats");
+  }
+  auto *points = reinterpret_cast<carla::geom::Vector3D *>(view.buf);
+  const auto count = static_cast<size_t>(view.len) / sizeof(carla::geom::Vector3D);
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.TransformPoints(points, count);
+}
+
+#endif // PY_MAJOR_VERSION >= 3
+
 void export_geom() {
   using namespace boost::python;
   namespace cg = carla::geom;
@@ -165,17 +195,40 @@ void export_geom() {
         (arg("location")=cg::Location(), arg("rotation")=cg::Rotation())))
     .def_readwrite("location", &cg::Transform::location)
     .def_readwrite("rotation", &cg::Transform::rotation)
-    .def("transform", &TransformList)
+    .def("transform", &TransformList<cg::Transform>)
     .def("transform", +[](const cg::Transform &self, cg::Vector3D &location) {
       self.TransformPoint(location);
       return location;
     }, arg("in_point"))
     .def("get_forward_vector", &cg::Transform::GetForwardVector)
+    .def("get_matrix", +[](const cg::Transform &self) { return cg::TransformMatrix(self); })
     .def("__eq__", &cg::Transform::operator==)
     .def("__ne__", &cg::Transform::operator!=)
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<cg::TransformMatrix>("TransformMatrix")
+    .def(init<cg::Transform>((arg("transform"))))
+    .add_property("translation", CALL_RETURNING_COPY(cg::TransformMatrix, GetTranslation))
+    .add_property("rotation_matrix", +[](const cg::TransformMatrix &self) {
+      const auto &m = self.GetRotationMatrix();
+      boost::python::list rows;
+      for (auto i = 0u; i < 3u; ++i) {
+        rows.append(boost::python::make_tuple(m[3u * i], m[3u * i + 1u], m[3u * i + 2u]));
+      }
+      return rows;
+    })
+    .def("transform", &TransformList<cg::TransformMatrix>)
+    .def("transform", +[](const cg::TransformMatrix &self, cg::Vector3D &location) {
+      self.TransformPoint(location);
+      return location;
+    }, arg("in_point"))
+#if PY_MAJOR_VERSION >= 3
+    .def("transform_buffer", &TransformBuffer, arg("buffer"))
+#endif // PY_MAJOR_VERSION >= 3
+    .def("get_forward_vector", &cg::TransformMatrix::GetForwardVector)
+  ;
+
   class_<cg::BoundingBox>("BoundingBox")
     .def(init<cg::Location, cg::Vector3D>(
         (arg("location")=cg::Location(), arg("extent")=cg::Vector3D())))
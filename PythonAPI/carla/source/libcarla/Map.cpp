@@ -8,6 +8,8 @@
 #include <carla/PythonUtil.h>
 #include <carla/client/Map.h>
 #include <carla/client/Waypoint.h>
+#include <carla/client/WaypointHandle.h>
+#include <carla/client/WorldSnapshot.h>
 #include <carla/road/element/LaneMarking.h>
 
 #include <ostream>
@@ -49,10 +51,187 @@ static auto GetTopology(const carla::client::Map &self) {
   return result;
 }
 
+static boost::python::list GetWaypoints(
+    const carla::client::Map &self,
+    const boost::python::object &locations,
+    bool project_to_road,
+    uint32_t lane_type) {
+  std::vector<carla::geom::Location> input{
+      boost::python::stl_input_iterator<carla::geom::Location>(locations),
+      boost::python::stl_input_iterator<carla::geom::Location>()};
+  std::vector<carla::SharedPtr<carla::client::Waypoint>> waypoints;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    waypoints = self.GetWaypoints(input, project_to_road, lane_type);
+  }
+  boost::python::list result;
+  for (auto &waypoint : waypoints) {
+    result.append(waypoint);
+  }
+  return result;
+}
+
+/// Either a distance for each waypoint or the same for all.
+static boost::python::list GetFreeSpawnPoints(
+    const carla::client::Map &self,
+    const carla::client::WorldSnapshot &snapshot,
+    size_t count,
+    float min_distance) {
+  std::vector<carla::geom::Transform> spawn_points;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    spawn_points = self.GetFreeSpawnPoints(snapshot, count, min_distance);
+  }
+  boost::python::list result;
+  for (auto &&spawn_point : spawn_points) {
+    result.append(spawn_point);
+  }
+  return result;
+}
+
+static std::vector<double> GetDistances(const boost::python::object &distances, size_t size) {
+  namespace py = boost::python;
+  py::extract<double> distance(distances);
+  if (distance.check()) {
+    return std::vector<double>(size, distance());
+  }
+  return std::vector<double>{
+      py::stl_input_iterator<double>(distances),
+      py::stl_input_iterator<double>()};
+}
+
+static boost::python::list GetWaypointsAt(
+    const carla::client::Map &self,
+    const boost::python::object &waypoints,
+    const boost::python::object &distances,
+    const bool next) {
+  namespace py = boost::python;
+  using WaypointPtr = carla::SharedPtr<carla::client::Waypoint>;
+  std::vector<WaypointPtr> input{
+      py::stl_input_iterator<WaypointPtr>(waypoints),
+      py::stl_input_iterator<WaypointPtr>()};
+  const auto input_distances = GetDistances(distances, input.size());
+  carla::client::Map::WaypointBatch batch;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    batch = next ?
+        self.GetNext(input, input_distances) :
+        self.GetPrevious(input, input_distances);
+  }
+  py::list result;
+  for (size_t i = 0u; (i + 1u) < batch.offsets.size(); ++i) {
+    py::list found;
+    for (auto j = batch.offsets[i]; j < batch.offsets[i + 1u]; ++j) {
+      found.append(batch.waypoints[j]);
+    }
+    result.append(found);
+  }
+  return result;
+}
+
+static boost::python::list GetNext(
+    const carla::client::Map &self,
+    const boost::python::object &waypoints,
+    const boost::python::object &distances) {
+  return GetWaypointsAt(self, waypoints, distances, true);
+}
+
+static boost::python::list GetPrevious(
+    const carla::client::Map &self,
+    const boost::python::object &waypoints,
+    const boost::python::object &distances) {
+  return GetWaypointsAt(self, waypoints, distances, false);
+}
+
+static boost::python::list ComputeRoute(
+    const carla::client::Map &self,
+    const carla::client::Waypoint &origin,
+    const carla::client::Waypoint &destination) {
+  std::vector<carla::SharedPtr<carla::client::Waypoint>> route;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    route = self.ComputeRoute(origin, destination);
+  }
+  boost::python::list result;
+  for (auto &waypoint : route) {
+    result.append(waypoint);
+  }
+  return result;
+}
+
+static carla::client::WaypointHandleList GetHandlesAt(
+    const carla::client::Map &self,
+    const carla::client::WaypointHandleList &handles,
+    const boost::python::object &distances,
+    const bool next) {
+  const auto input_distances = GetDistances(distances, handles.size());
+  carla::PythonUtil::ReleaseGIL unlock;
+  return next ?
+      self.GetNext(handles, input_distances) :
+      self.GetPrevious(handles, input_distances);
+}
+
+static carla::client::WaypointHandleList ComputeRouteHandles(
+    const carla::client::Map &self,
+    const carla::client::Waypoint &origin,
+    const carla::client::Waypoint &destination) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.ComputeRoute(self.MakeHandle(origin), self.MakeHandle(destination));
+}
+
+/// Column of @a values, one per handle, as an array view.
+template <typename T, typename FunctorT>
+static boost::python::object GetHandleColumn(
+    const carla::client::WaypointHandleList &self,
+    const char *format,
+    FunctorT &&get) {
+  std::vector<T> values;
+  values.reserve(self.size());
+  for (const auto &handle : self) {
+    values.emplace_back(get(handle));
+  }
+  return MakeArrayView(values, format, 1u);
+}
+
+/// Location x, y, z and rotation pitch, yaw, roll of each handle, the ones
+/// not computed yet are computed now.
+static boost::python::object GetHandleTransforms(const carla::client::WaypointHandleList &self) {
+  std::vector<float> values;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    values.reserve(6u * self.size());
+    for (const auto &handle : self) {
+      const auto &transform = handle.GetTransform();
+      values.insert(values.end(), {
+          transform.location.x, transform.location.y, transform.location.z,
+          transform.rotation.pitch, transform.rotation.yaw, transform.rotation.roll});
+    }
+  }
+  return MakeArrayView(values, "f", 6u);
+}
+
 static carla::geom::GeoLocation ToGeolocation(
     const carla::client::Map &self,
     const carla::geom::Location &location) {
-  return self.GetGeoReference().Transform(location);
+  return self.GetGeoProjection().Transform(location);
+}
+
+static boost::python::list ToGeolocations(
+    const carla::client::Map &self,
+    const boost::python::object &locations) {
+  std::vector<carla::geom::Location> input{
+      boost::python::stl_input_iterator<carla::geom::Location>(locations),
+      boost::python::stl_input_iterator<carla::geom::Location>()};
+  std::vector<carla::geom::GeoLocation> geolocations;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    geolocations = self.GetGeoProjection().Transform(input);
+  }
+  boost::python::list result;
+  for (auto &geolocation : geolocations) {
+    result.append(geolocation);
+  }
+  return result;
 }
 
 void export_map() {
@@ -91,6 +270,11 @@ void export_map() {
     .value("Any", cr::Lane::LaneType::Any)
   ;
 
+  enum_<cc::Map::LoadProfile>("MapLoadProfile")
+    .value("Full", cc::Map::LoadProfile::Full)
+    .value("Driving", cc::Map::LoadProfile::Driving)
+  ;
+
   enum_<cre::LaneMarking::LaneChange>("LaneChange")
     .value("NONE", cre::LaneMarking::LaneChange::None)
     .value("Right", cre::LaneMarking::LaneChange::Right)
@@ -129,12 +313,37 @@ void export_map() {
     .def(init<std::string, std::string>((arg("name"), arg("xodr_content"))))
     .add_property("name", CALL_RETURNING_COPY(cc::Map, GetName))
     .def("get_spawn_points", CALL_RETURNING_LIST(cc::Map, GetRecommendedSpawnPoints))
+    .def("get_free_spawn_points", &GetFreeSpawnPoints, (arg("snapshot"), arg("count"), arg("min_distance")))
     .def("get_waypoint", &cc::Map::GetWaypoint, (arg("location"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
+    .def("get_waypoints", &GetWaypoints, (arg("locations"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
+    .def("get_next", &GetNext, (arg("waypoints"), arg("distances")))
+    .def("get_previous", &GetPrevious, (arg("waypoints"), arg("distances")))
     .def("get_topology", &GetTopology)
+    .def("compute_route", &ComputeRoute, (arg("origin"), arg("destination")))
     .def("generate_waypoints", CALL_RETURNING_LIST_1(cc::Map, GenerateWaypoints, double), (args("distance")))
+    .def("get_next_handles", +[](const cc::Map &self, const cc::WaypointHandleList &handles, const object &distances) {
+      return GetHandlesAt(self, handles, distances, true);
+    }, (arg("handles"), arg("distances")))
+    .def("get_previous_handles", +[](const cc::Map &self, const cc::WaypointHandleList &handles, const object &distances) {
+      return GetHandlesAt(self, handles, distances, false);
+    }, (arg("handles"), arg("distances")))
+    .def("get_topology_handles", CONST_CALL_WITHOUT_GIL(cc::Map, GetTopologyHandles))
+    .def("compute_route_handles", &ComputeRouteHandles, (arg("origin"), arg("destination")))
+    .def("generate_waypoint_handles", CONST_CALL_WITHOUT_GIL_1(cc::Map, GenerateWaypointHandles, double), (args("distance")))
     .def("transform_to_geolocation", &ToGeolocation, (arg("location")))
+    .def("transform_to_geolocations", &ToGeolocations, (arg("locations")))
     .def("to_opendrive", CALL_RETURNING_COPY(cc::Map, GetOpenDrive))
+    .def("set_transform_cache_resolution", &cc::Map::SetTransformCacheResolution, (arg("resolution")))
+    .def("get_transform_cache_resolution", &cc::Map::GetTransformCacheResolution)
     .def("save_to_disk", &SaveOpenDriveToDisk, (arg("path")=""))
+    .def("set_cache_folder", &cc::Map::SetCacheFolder, (arg("folder")))
+    .staticmethod("set_cache_folder")
+    .def("get_cache_folder", &cc::Map::GetCacheFolder)
+    .staticmethod("get_cache_folder")
+    .def("set_load_profile", &cc::Map::SetLoadProfile, (arg("profile")))
+    .staticmethod("set_load_profile")
+    .def("get_load_profile", &cc::Map::GetLoadProfile)
+    .staticmethod("get_load_profile")
     .def(self_ns::str(self_ns::self))
   ;
 
@@ -149,6 +358,43 @@ void export_map() {
     .add_property("width", &cre::LaneMarking::width)
   ;
 
+  class_<cc::WaypointHandleList>("WaypointHandleList", no_init)
+    .add_property("ids", +[](const cc::WaypointHandleList &self) {
+      return GetHandleColumn<uint64_t>(self, "Q", [](const auto &handle) { return handle.GetId(); });
+    })
+    .add_property("road_ids", +[](const cc::WaypointHandleList &self) {
+      return GetHandleColumn<uint32_t>(self, "I", [](const auto &handle) { return handle.GetRoadId(); });
+    })
+    .add_property("section_ids", +[](const cc::WaypointHandleList &self) {
+      return GetHandleColumn<uint32_t>(self, "I", [](const auto &handle) { return handle.GetSectionId(); });
+    })
+    .add_property("lane_ids", +[](const cc::WaypointHandleList &self) {
+      return GetHandleColumn<int32_t>(self, "i", [](const auto &handle) { return handle.GetLaneId(); });
+    })
+    .add_property("s", +[](const cc::WaypointHandleList &self) {
+      return GetHandleColumn<double>(self, "d", [](const auto &handle) { return handle.GetDistance(); });
+    })
+    .add_property("transforms", &GetHandleTransforms)
+    .add_property("offsets", +[](const cc::WaypointHandleList &self) {
+      boost::python::list result;
+      for (auto offset : self.offsets) {
+        result.append(offset);
+      }
+      return result;
+    })
+    .def("to_waypoints", +[](const cc::WaypointHandleList &self) {
+      boost::python::list result;
+      for (const auto &handle : self) {
+        result.append(handle.MakeWaypoint());
+      }
+      return result;
+    })
+    .def("__getitem__", +[](const cc::WaypointHandleList &self, size_t pos) {
+      return self.at(pos).MakeWaypoint();
+    })
+    .def("__len__", &cc::WaypointHandleList::size)
+  ;
+
   class_<cc::Waypoint, boost::noncopyable, boost::shared_ptr<cc::Waypoint>>("Waypoint", no_init)
     .add_property("id", &cc::Waypoint::GetId)
     .add_property("transform", CALL_RETURNING_COPY(cc::Waypoint, GetTransform))
@@ -165,6 +411,7 @@ void export_map() {
     .add_property("right_lane_marking", CALL_RETURNING_OPTIONAL(cc::Waypoint, GetRightLaneMarking))
     .add_property("left_lane_marking", CALL_RETURNING_OPTIONAL(cc::Waypoint, GetLeftLaneMarking))
     .def("next", CALL_RETURNING_LIST_1(cc::Waypoint, GetNext, double), (args("distance")))
+    .def("previous", CALL_RETURNING_LIST_1(cc::Waypoint, GetPrevious, double), (args("distance")))
     .def("get_right_lane", &cc::Waypoint::GetRight)
     .def("get_left_lane", &cc::Waypoint::GetLeft)
     .def(self_ns::str(self_ns::self))
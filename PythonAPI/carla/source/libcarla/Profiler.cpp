@@ -0,0 +1,235 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/profiler/FrameTracer.h>
+#include <carla/profiler/RuntimeProfiler.h>
+#include <carla/rpc/MemoryReport.h>
+#include <carla/rpc/SensorMetrics.h>
+#include <carla/rpc/ServerMetrics.h>
+
+#include <ostream>
+
+namespace carla {
+namespace profiler {
+
+  std::ostream &operator<<(std::ostream &out, const ProfilerStats &stats) {
+    out << "ProfilerStats(name=" << stats.name
+        << ", count=" << std::to_string(stats.count)
+        << ", total=" << std::to_string(stats.total)
+        << ", min=" << std::to_string(stats.minimum)
+        << ", max=" << std::to_string(stats.maximum)
+        << ", mean=" << std::to_string(stats.mean)
+        << ", p50=" << std::to_string(stats.p50)
+        << ", p99=" << std::to_string(stats.p99)
+        << ", p999=" << std::to_string(stats.p999) << ')';
+    return out;
+  }
+
+} // namespace profiler
+
+namespace rpc {
+
+  std::ostream &operator<<(std::ostream &out, const FunctionMetrics &metrics) {
+    out << "FunctionMetrics(name=" << metrics.name
+        << ", calls=" << std::to_string(metrics.calls)
+        << ", failures=" << std::to_string(metrics.failures)
+        << ", total_seconds=" << std::to_string(metrics.total_seconds)
+        << ", max_seconds=" << std::to_string(metrics.max_seconds) << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const StreamMetrics &metrics) {
+    out << "StreamMetrics(stream_id=" << std::to_string(metrics.stream_id)
+        << ", queued_messages=" << std::to_string(metrics.queued_messages)
+        << ", sent_messages=" << std::to_string(metrics.sent_messages)
+        << ", sent_bytes=" << std::to_string(metrics.sent_bytes)
+        << ", dropped_messages=" << std::to_string(metrics.dropped_messages) << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const DiskSinkMetrics &metrics) {
+    out << "DiskSinkMetrics(queued_files=" << std::to_string(metrics.queued_files)
+        << ", written_files=" << std::to_string(metrics.written_files)
+        << ", written_bytes=" << std::to_string(metrics.written_bytes)
+        << ", failed_files=" << std::to_string(metrics.failed_files)
+        << ", blocked_messages=" << std::to_string(metrics.blocked_messages) << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const SensorFrameCost &cost) {
+    out << "SensorFrameCost(frame=" << std::to_string(cost.frame)
+        << ", tick_seconds=" << std::to_string(cost.tick_seconds)
+        << ", readback_seconds=" << std::to_string(cost.readback_seconds)
+        << ", serialize_seconds=" << std::to_string(cost.serialize_seconds)
+        << ", gpu_seconds=" << std::to_string(cost.gpu_seconds)
+        << ", bytes=" << std::to_string(cost.bytes) << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const SensorMetrics &metrics) {
+    out << "SensorMetrics(actor_id=" << std::to_string(metrics.actor_id)
+        << ", type_id=" << metrics.type_id
+        << ", frames=" << std::to_string(metrics.frames)
+        << ", total_tick_seconds=" << std::to_string(metrics.total_tick_seconds)
+        << ", total_gpu_seconds=" << std::to_string(metrics.total_gpu_seconds)
+        << ", total_bytes=" << std::to_string(metrics.total_bytes) << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const MemoryUsage &usage) {
+    out << "MemoryUsage(name=" << usage.name
+        << ", bytes=" << std::to_string(usage.bytes)
+        << ", allocations=" << std::to_string(usage.allocations)
+        << ", peak_bytes=" << std::to_string(usage.peak_bytes) << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const MemoryReport &report) {
+    out << "MemoryReport(resident_bytes=" << std::to_string(report.resident_bytes);
+    for (const auto &usage : report.subsystems) {
+      out << ", " << usage.name << '=' << std::to_string(usage.bytes);
+    }
+    out << ')';
+    return out;
+  }
+
+} // namespace rpc
+} // namespace carla
+
+template <typename T>
+static boost::python::list ToList(const std::vector<T> &items) {
+  boost::python::list result;
+  for (auto &item : items) {
+    result.append(item);
+  }
+  return result;
+}
+
+static auto GetProfilerStats() {
+  return ToList(carla::profiler::RuntimeProfiler::GetStats());
+}
+
+void export_profiler() {
+  using namespace boost::python;
+  namespace cp = carla::profiler;
+  namespace cr = carla::rpc;
+
+  class_<cp::ProfilerStats>("ProfilerStats", no_init)
+    .def_readonly("name", &cp::ProfilerStats::name)
+    .def_readonly("count", &cp::ProfilerStats::count)
+    .def_readonly("total", &cp::ProfilerStats::total)
+    .def_readonly("min", &cp::ProfilerStats::minimum)
+    .def_readonly("max", &cp::ProfilerStats::maximum)
+    .def_readonly("mean", &cp::ProfilerStats::mean)
+    .def_readonly("p50", &cp::ProfilerStats::p50)
+    .def_readonly("p99", &cp::ProfilerStats::p99)
+    .def_readonly("p999", &cp::ProfilerStats::p999)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cp::RuntimeProfiler, boost::noncopyable>("Profiler", no_init)
+    .def("set_enabled", &cp::RuntimeProfiler::SetEnabled, (arg("enabled")))
+    .staticmethod("set_enabled")
+    .def("is_enabled", &cp::RuntimeProfiler::IsEnabled)
+    .staticmethod("is_enabled")
+    .def("get_stats", &GetProfilerStats)
+    .staticmethod("get_stats")
+    .def("reset", &cp::RuntimeProfiler::Reset)
+    .staticmethod("reset")
+  ;
+
+  class_<cr::FunctionMetrics>("FunctionMetrics", no_init)
+    .def_readonly("name", &cr::FunctionMetrics::name)
+    .def_readonly("calls", &cr::FunctionMetrics::calls)
+    .def_readonly("failures", &cr::FunctionMetrics::failures)
+    .def_readonly("total_seconds", &cr::FunctionMetrics::total_seconds)
+    .def_readonly("max_seconds", &cr::FunctionMetrics::max_seconds)
+    .def_readonly("total_wait_seconds", &cr::FunctionMetrics::total_wait_seconds)
+    .def_readonly("max_wait_seconds", &cr::FunctionMetrics::max_wait_seconds)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::StreamMetrics>("StreamMetrics", no_init)
+    .def_readonly("stream_id", &cr::StreamMetrics::stream_id)
+    .def_readonly("are_clients_listening", &cr::StreamMetrics::are_clients_listening)
+    .def_readonly("queued_messages", &cr::StreamMetrics::queued_messages)
+    .def_readonly("sent_messages", &cr::StreamMetrics::sent_messages)
+    .def_readonly("sent_bytes", &cr::StreamMetrics::sent_bytes)
+    .def_readonly("dropped_messages", &cr::StreamMetrics::dropped_messages)
+    .def_readonly("total_write_seconds", &cr::StreamMetrics::total_write_seconds)
+    .def_readonly("max_write_seconds", &cr::StreamMetrics::max_write_seconds)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::DiskSinkMetrics>("DiskSinkMetrics", no_init)
+    .def_readonly("queued_files", &cr::DiskSinkMetrics::queued_files)
+    .def_readonly("max_queued_files", &cr::DiskSinkMetrics::max_queued_files)
+    .def_readonly("capacity", &cr::DiskSinkMetrics::capacity)
+    .def_readonly("written_files", &cr::DiskSinkMetrics::written_files)
+    .def_readonly("written_bytes", &cr::DiskSinkMetrics::written_bytes)
+    .def_readonly("failed_files", &cr::DiskSinkMetrics::failed_files)
+    .def_readonly("blocked_messages", &cr::DiskSinkMetrics::blocked_messages)
+    .def_readonly("total_blocked_seconds", &cr::DiskSinkMetrics::total_blocked_seconds)
+    .def_readonly("total_write_seconds", &cr::DiskSinkMetrics::total_write_seconds)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::ServerMetrics>("ServerMetrics", no_init)
+    .add_property("functions", +[](const cr::ServerMetrics &self) { return ToList(self.functions); })
+    .add_property("streams", +[](const cr::ServerMetrics &self) { return ToList(self.streams); })
+    .def_readonly("disk_sink", &cr::ServerMetrics::disk_sink)
+  ;
+
+  class_<cr::SensorFrameCost>("SensorFrameCost", no_init)
+    .def_readonly("frame", &cr::SensorFrameCost::frame)
+    .def_readonly("tick_seconds", &cr::SensorFrameCost::tick_seconds)
+    .def_readonly("readback_seconds", &cr::SensorFrameCost::readback_seconds)
+    .def_readonly("serialize_seconds", &cr::SensorFrameCost::serialize_seconds)
+    .def_readonly("gpu_seconds", &cr::SensorFrameCost::gpu_seconds)
+    .def_readonly("bytes", &cr::SensorFrameCost::bytes)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::SensorMetrics>("SensorMetrics", no_init)
+    .def_readonly("actor_id", &cr::SensorMetrics::actor_id)
+    .def_readonly("type_id", &cr::SensorMetrics::type_id)
+    .def_readonly("frames", &cr::SensorMetrics::frames)
+    .def_readonly("messages", &cr::SensorMetrics::messages)
+    .def_readonly("total_tick_seconds", &cr::SensorMetrics::total_tick_seconds)
+    .def_readonly("total_readback_seconds", &cr::SensorMetrics::total_readback_seconds)
+    .def_readonly("total_serialize_seconds", &cr::SensorMetrics::total_serialize_seconds)
+    .def_readonly("total_gpu_seconds", &cr::SensorMetrics::total_gpu_seconds)
+    .def_readonly("total_bytes", &cr::SensorMetrics::total_bytes)
+    .def_readonly("max_frame", &cr::SensorMetrics::max_frame)
+    .def_readonly("last_frame", &cr::SensorMetrics::last_frame)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::MemoryUsage>("MemoryUsage", no_init)
+    .def_readonly("name", &cr::MemoryUsage::name)
+    .def_readonly("bytes", &cr::MemoryUsage::bytes)
+    .def_readonly("allocations", &cr::MemoryUsage::allocations)
+    .def_readonly("peak_bytes", &cr::MemoryUsage::peak_bytes)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::MemoryReport>("MemoryReport", no_init)
+    .add_property("subsystems", +[](const cr::MemoryReport &self) { return ToList(self.subsystems); })
+    .def_readonly("resident_bytes", &cr::MemoryReport::resident_bytes)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cp::FrameTracer, boost::noncopyable>("FrameTracer", no_init)
+    .def("set_enabled", &cp::FrameTracer::SetEnabled, (arg("enabled")))
+    .staticmethod("set_enabled")
+    .def("is_enabled", &cp::FrameTracer::IsEnabled)
+    .staticmethod("is_enabled")
+    .def("dump", &cp::FrameTracer::DumpChromeTrace)
+    .staticmethod("dump")
+    .def("clear", &cp::FrameTracer::Clear)
+    .staticmethod("clear")
+  ;
+}
@@ -0,0 +1,270 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/PythonUtil.h>
+#include <carla/recorder/RecorderReader.h>
+#include <carla/rpc/RecorderFilter.h>
+#include <carla/rpc/RecorderQuery.h>
+
+#include <ostream>
+
+namespace carla {
+namespace recorder {
+
+  std::ostream &operator<<(std::ostream &out, const RecorderInfo &info) {
+    out << "RecorderInfo(version=" << std::to_string(info.version)
+        << ", map=" << info.map
+        << ", date=" << std::to_string(info.date) << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const RecorderFrame &frame) {
+    out << "RecorderFrame(id=" << std::to_string(frame.GetId())
+        << ", elapsed=" << std::to_string(frame.GetElapsed()) << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const EventAdd &event) {
+    out << "RecorderEventAdd(id=" << std::to_string(event.database_id)
+        << ", type=" << event.id << ')';
+    return out;
+  }
+
+} // namespace recorder
+} // namespace carla
+
+template <typename T>
+static boost::python::list PacketViewToList(const carla::recorder::PacketView<T> &view) {
+  boost::python::list result;
+  for (auto item : view) {
+    result.append(item);
+  }
+  return result;
+}
+
+template <typename T>
+static boost::python::list VectorToList(const std::vector<T> &items) {
+  boost::python::list result;
+  for (auto &item : items) {
+    result.append(item);
+  }
+  return result;
+}
+
+template <typename T>
+static std::vector<T> ListToVector(const boost::python::object &items) {
+  return {
+      boost::python::stl_input_iterator<T>(items),
+      boost::python::stl_input_iterator<T>()};
+}
+
+static carla::recorder::RecorderFrame ReadNextFrame(carla::recorder::RecorderReader &self) {
+  carla::recorder::RecorderFrame frame;
+  bool found;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    found = self.ReadFrame(frame);
+  }
+  if (!found) {
+    PyErr_SetString(PyExc_StopIteration, "end of the recording");
+    boost::python::throw_error_already_set();
+  }
+  return frame;
+}
+
+void export_recorder() {
+  using namespace boost::python;
+  namespace cr = carla::recorder;
+  namespace crpc = carla::rpc;
+
+  // The packets are packed structs, their members are exposed by copy.
+
+  class_<cr::RecorderInfo>("RecorderInfo", no_init)
+    .def_readonly("version", &cr::RecorderInfo::version)
+    .def_readonly("map", &cr::RecorderInfo::map)
+    .def_readonly("date", &cr::RecorderInfo::date)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::ActorAttribute>("RecorderActorAttribute", no_init)
+    .def_readonly("type", &cr::ActorAttribute::type)
+    .def_readonly("id", &cr::ActorAttribute::id)
+    .def_readonly("value", &cr::ActorAttribute::value)
+  ;
+
+  class_<cr::EventAdd>("RecorderEventAdd", no_init)
+    .def_readonly("database_id", &cr::EventAdd::database_id)
+    .def_readonly("type", &cr::EventAdd::type)
+    .add_property("location", +[](const cr::EventAdd &self) { return self.location; })
+    .add_property("rotation", +[](const cr::EventAdd &self) { return self.rotation; })
+    .def_readonly("uid", &cr::EventAdd::uid)
+    .def_readonly("id", &cr::EventAdd::id)
+    .add_property("attributes", +[](const cr::EventAdd &self) { return VectorToList(self.attributes); })
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::EventDel>("RecorderEventDel", no_init)
+    .add_property("database_id", +[](const cr::EventDel &self) { return self.database_id; })
+  ;
+
+  class_<cr::EventParent>("RecorderEventParent", no_init)
+    .add_property("database_id", +[](const cr::EventParent &self) { return self.database_id; })
+    .add_property("parent_id", +[](const cr::EventParent &self) { return self.parent_id; })
+  ;
+
+  class_<cr::Collision>("RecorderCollision", no_init)
+    .add_property("id", +[](const cr::Collision &self) { return self.id; })
+    .add_property("database_id1", +[](const cr::Collision &self) { return self.database_id1; })
+    .add_property("database_id2", +[](const cr::Collision &self) { return self.database_id2; })
+    .add_property("is_actor1_hero", +[](const cr::Collision &self) { return self.is_actor1_hero; })
+    .add_property("is_actor2_hero", +[](const cr::Collision &self) { return self.is_actor2_hero; })
+  ;
+
+  class_<cr::Position>("RecorderPosition", no_init)
+    .add_property("database_id", +[](const cr::Position &self) { return self.database_id; })
+    .add_property("location", +[](const cr::Position &self) { return self.location; })
+    .add_property("rotation", +[](const cr::Position &self) { return self.rotation; })
+  ;
+
+  class_<cr::TrafficLightState>("RecorderTrafficLightState", no_init)
+    .add_property("database_id", +[](const cr::TrafficLightState &self) { return self.database_id; })
+    .add_property("is_frozen", +[](const cr::TrafficLightState &self) { return self.is_frozen; })
+    .add_property("elapsed_time", +[](const cr::TrafficLightState &self) { return self.elapsed_time; })
+    .add_property("state", +[](const cr::TrafficLightState &self) { return static_cast<int>(self.state); })
+  ;
+
+  class_<cr::VehicleAnimation>("RecorderVehicleAnimation", no_init)
+    .add_property("database_id", +[](const cr::VehicleAnimation &self) { return self.database_id; })
+    .add_property("steering", +[](const cr::VehicleAnimation &self) { return self.steering; })
+    .add_property("throttle", +[](const cr::VehicleAnimation &self) { return self.throttle; })
+    .add_property("brake", +[](const cr::VehicleAnimation &self) { return self.brake; })
+    .add_property("handbrake", +[](const cr::VehicleAnimation &self) { return self.handbrake; })
+    .add_property("gear", +[](const cr::VehicleAnimation &self) { return self.gear; })
+  ;
+
+  class_<cr::WalkerAnimation>("RecorderWalkerAnimation", no_init)
+    .add_property("database_id", +[](const cr::WalkerAnimation &self) { return self.database_id; })
+    .add_property("speed", +[](const cr::WalkerAnimation &self) { return self.speed; })
+  ;
+
+  class_<cr::RecorderFrame>("RecorderFrame", no_init)
+    .add_property("id", &cr::RecorderFrame::GetId)
+    .add_property("elapsed", &cr::RecorderFrame::GetElapsed)
+    .add_property("duration", &cr::RecorderFrame::GetDuration)
+    .add_property("is_key_frame", &cr::RecorderFrame::IsKeyFrame)
+    .def("get_events_add", +[](const cr::RecorderFrame &self) { return VectorToList(self.GetEventsAdd()); })
+    .def("get_events_del", +[](const cr::RecorderFrame &self) { return PacketViewToList(self.GetEventsDel()); })
+    .def("get_events_parent", +[](const cr::RecorderFrame &self) { return PacketViewToList(self.GetEventsParent()); })
+    .def("get_collisions", +[](const cr::RecorderFrame &self) { return PacketViewToList(self.GetCollisions()); })
+    .def("get_positions", +[](const cr::RecorderFrame &self) { return PacketViewToList(self.GetPositions()); })
+    .def("get_traffic_light_states", +[](const cr::RecorderFrame &self) { return PacketViewToList(self.GetTrafficLightStates()); })
+    .def("get_vehicle_animations", +[](const cr::RecorderFrame &self) { return PacketViewToList(self.GetVehicleAnimations()); })
+    .def("get_walker_animations", +[](const cr::RecorderFrame &self) { return PacketViewToList(self.GetWalkerAnimations()); })
+    .def("get_key_frame_actors", +[](const cr::RecorderFrame &self) { return VectorToList(self.GetKeyFrameActors()); })
+    .def("get_key_frame_parents", +[](const cr::RecorderFrame &self) { return VectorToList(self.GetKeyFrameParents()); })
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  // -- Query results ----------------------------------------------------------
+
+  class_<crpc::RecorderActor>("RecorderActor", no_init)
+    .def_readonly("id", &crpc::RecorderActor::id)
+    .def_readonly("type", &crpc::RecorderActor::type)
+    .def_readonly("description", &crpc::RecorderActor::description)
+    .def_readonly("location", &crpc::RecorderActor::location)
+    .add_property("attributes", +[](const crpc::RecorderActor &self) {
+      boost::python::dict result;
+      for (auto &attribute : self.attributes) {
+        result[attribute.first] = attribute.second;
+      }
+      return result;
+    })
+  ;
+
+  class_<crpc::RecorderParenting>("RecorderParenting", no_init)
+    .def_readonly("id", &crpc::RecorderParenting::id)
+    .def_readonly("parent_id", &crpc::RecorderParenting::parent_id)
+  ;
+
+  class_<crpc::RecorderFrameCollision>("RecorderFrameCollision", no_init)
+    .def_readonly("id", &crpc::RecorderFrameCollision::id)
+    .def_readonly("actor_id1", &crpc::RecorderFrameCollision::actor_id1)
+    .def_readonly("actor_id2", &crpc::RecorderFrameCollision::actor_id2)
+    .def_readonly("is_actor1_hero", &crpc::RecorderFrameCollision::is_actor1_hero)
+    .def_readonly("is_actor2_hero", &crpc::RecorderFrameCollision::is_actor2_hero)
+  ;
+
+  class_<crpc::RecorderFrameEvents>("RecorderFrameEvents", no_init)
+    .def_readonly("frame", &crpc::RecorderFrameEvents::frame)
+    .def_readonly("elapsed", &crpc::RecorderFrameEvents::elapsed)
+    .add_property("created", +[](const crpc::RecorderFrameEvents &self) { return VectorToList(self.created); })
+    .add_property("destroyed", +[](const crpc::RecorderFrameEvents &self) { return VectorToList(self.destroyed); })
+    .add_property("parented", +[](const crpc::RecorderFrameEvents &self) { return VectorToList(self.parented); })
+    .add_property("collisions", +[](const crpc::RecorderFrameEvents &self) { return VectorToList(self.collisions); })
+  ;
+
+  class_<crpc::RecorderFileInfo>("RecorderFileInfo", no_init)
+    .def_readonly("version", &crpc::RecorderFileInfo::version)
+    .def_readonly("map", &crpc::RecorderFileInfo::map)
+    .def_readonly("date", &crpc::RecorderFileInfo::date)
+    .def_readonly("frames", &crpc::RecorderFileInfo::frames)
+    .def_readonly("duration", &crpc::RecorderFileInfo::duration)
+    .add_property("events", +[](const crpc::RecorderFileInfo &self) { return VectorToList(self.events); })
+  ;
+
+  class_<crpc::RecorderCollisionInfo>("RecorderCollisionInfo", no_init)
+    .def_readonly("time", &crpc::RecorderCollisionInfo::time)
+    .def_readonly("type1", &crpc::RecorderCollisionInfo::type1)
+    .def_readonly("type2", &crpc::RecorderCollisionInfo::type2)
+    .def_readonly("actor_id1", &crpc::RecorderCollisionInfo::actor_id1)
+    .def_readonly("actor1", &crpc::RecorderCollisionInfo::actor1)
+    .def_readonly("actor_id2", &crpc::RecorderCollisionInfo::actor_id2)
+    .def_readonly("actor2", &crpc::RecorderCollisionInfo::actor2)
+  ;
+
+  class_<crpc::RecorderCollisions>("RecorderCollisions", no_init)
+    .def_readonly("frames", &crpc::RecorderCollisions::frames)
+    .def_readonly("duration", &crpc::RecorderCollisions::duration)
+    .add_property("collisions", +[](const crpc::RecorderCollisions &self) { return VectorToList(self.collisions); })
+  ;
+
+  class_<crpc::RecorderBlockedActor>("RecorderBlockedActor", no_init)
+    .def_readonly("time", &crpc::RecorderBlockedActor::time)
+    .def_readonly("actor_id", &crpc::RecorderBlockedActor::actor_id)
+    .def_readonly("actor", &crpc::RecorderBlockedActor::actor)
+    .def_readonly("duration", &crpc::RecorderBlockedActor::duration)
+  ;
+
+  class_<crpc::RecorderBlockedActors>("RecorderBlockedActors", no_init)
+    .def_readonly("frames", &crpc::RecorderBlockedActors::frames)
+    .def_readonly("duration", &crpc::RecorderBlockedActors::duration)
+    .add_property("actors", +[](const crpc::RecorderBlockedActors &self) { return VectorToList(self.actors); })
+  ;
+
+  // -- Filter -----------------------------------------------------------------
+
+  class_<crpc::RecorderFilter>("RecorderFilter")
+    .add_property("actor_ids",
+        +[](const crpc::RecorderFilter &self) { return VectorToList(self.actor_ids); },
+        +[](crpc::RecorderFilter &self, const object &ids) { self.actor_ids = ListToVector<carla::ActorId>(ids); })
+    .add_property("type_patterns",
+        +[](const crpc::RecorderFilter &self) { return VectorToList(self.type_patterns); },
+        +[](crpc::RecorderFilter &self, const object &patterns) { self.type_patterns = ListToVector<std::string>(patterns); })
+    .def_readwrite("vehicle_divisor", &crpc::RecorderFilter::vehicle_divisor)
+    .def_readwrite("walker_divisor", &crpc::RecorderFilter::walker_divisor)
+    .def_readwrite("traffic_light_divisor", &crpc::RecorderFilter::traffic_light_divisor)
+  ;
+
+  // -- Reader -----------------------------------------------------------------
+
+  class_<cr::RecorderReader, boost::noncopyable>("RecorderReader", init<std::string>((arg("filename"))))
+    .add_property("info", +[](const cr::RecorderReader &self) { return self.GetInfo(); })
+    .def("read_frame", &ReadNextFrame)
+    .def("__iter__", +[](object self) { return self; })
+    .def("__next__", &ReadNextFrame)
+    .def("next", &ReadNextFrame)
+  ;
+}
@@ -8,20 +8,57 @@
 #include <carla/client/ClientSideSensor.h>
 #include <carla/client/LaneInvasionSensor.h>
 #include <carla/client/Sensor.h>
+#include <carla/client/SensorDataQueue.h>
 #include <carla/client/ServerSideSensor.h>
 
 static void SubscribeToStream(carla::client::Sensor &self, boost::python::object callback) {
   self.Listen(MakeCallback(std::move(callback)));
 }
 
+// The queue is filled on the streaming threads without taking the GIL.
+static auto SubscribeToQueue(carla::client::Sensor &self, size_t max_size, bool drop_oldest) {
+  auto queue = carla::MakeShared<carla::client::SensorDataQueue>(max_size, drop_oldest);
+  self.Listen([queue](auto data) { queue->Push(std::move(data)); });
+  return queue;
+}
+
+static boost::python::object SensorDataOrNone(carla::SharedPtr<carla::sensor::SensorData> data) {
+  return data != nullptr ? boost::python::object(data) : boost::python::object();
+}
+
 void export_sensor() {
   using namespace boost::python;
   namespace cc = carla::client;
 
+  class_<cc::SensorDataQueue, boost::noncopyable, boost::shared_ptr<cc::SensorDataQueue>>("SensorDataQueue", no_init)
+    .add_property("maxsize", &cc::SensorDataQueue::GetMaxSize)
+    .add_property("dropped", &cc::SensorDataQueue::GetNumberOfDroppedItems)
+    .def("get", +[](cc::SensorDataQueue &self, double seconds) {
+      carla::SharedPtr<carla::sensor::SensorData> data;
+      {
+        carla::PythonUtil::ReleaseGIL unlock;
+        data = self.Pop(TimeDurationFromSeconds(seconds));
+      }
+      return SensorDataOrNone(std::move(data));
+    }, (arg("timeout")=10.0))
+    .def("get_frame", +[](cc::SensorDataQueue &self, size_t frame, double seconds) {
+      carla::SharedPtr<carla::sensor::SensorData> data;
+      {
+        carla::PythonUtil::ReleaseGIL unlock;
+        data = self.PopFrame(frame, TimeDurationFromSeconds(seconds));
+      }
+      return SensorDataOrNone(std::move(data));
+    }, (arg("frame"), arg("timeout")=10.0))
+    .def("empty", &cc::SensorDataQueue::empty)
+    .def("clear", &cc::SensorDataQueue::Clear)
+    .def("__len__", &cc::SensorDataQueue::size)
+  ;
+
   class_<cc::Sensor, bases<cc::Actor>, boost::noncopyable, boost::shared_ptr<cc::Sensor>>("Sensor", no_init)
     .add_property("is_listening", &cc::Sensor::IsListening)
     .def("listen", &SubscribeToStream, (arg("callback")))
-    .def("stop", &cc::Sensor::Stop)
+    .def("listen_to_queue", &SubscribeToQueue, (arg("maxsize")=0u, arg("drop_oldest")=true))
+    .def("stop", CALL_WITHOUT_GIL(cc::Sensor, Stop))
     .def(self_ns::str(self_ns::self))
   ;
 
@@ -4,24 +4,36 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include <carla/AsyncWriter.h>
 #include <carla/PythonUtil.h>
+#include <carla/image/FastImageConverter.h>
 #include <carla/image/ImageConverter.h>
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
 #include <carla/pointcloud/PointCloudIO.h>
+#include <carla/sensor/Deserializer.h>
 #include <carla/sensor/SensorData.h>
+#include <carla/sensor/data/ActorBoundingBoxes.h>
 #include <carla/sensor/data/CollisionEvent.h>
+#include <carla/sensor/data/CollisionEventBatch.h>
+#include <carla/sensor/data/EncodedImage.h>
 #include <carla/sensor/data/IMUMeasurement.h>
 #include <carla/sensor/data/ObstacleDetectionEvent.h>
 #include <carla/sensor/data/Image.h>
 #include <carla/sensor/data/LaneInvasionEvent.h>
 #include <carla/sensor/data/LidarMeasurement.h>
 #include <carla/sensor/data/GnssMeasurement.h>
+#include <carla/sensor/data/SensorBundle.h>
 
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 
+#include <algorithm>
+#include <fstream>
+#include <future>
 #include <ostream>
 #include <iostream>
+#include <thread>
+#include <tuple>
 
 namespace carla {
 namespace sensor {
@@ -35,6 +47,36 @@ namespace data {
     return out;
   }
 
+  template <typename PixelT>
+  static std::ostream &PrintImage(std::ostream &out, const char *name, const ImageTmpl<PixelT> &image) {
+    out << name << "(frame=" << std::to_string(image.GetFrame())
+        << ", timestamp=" << std::to_string(image.GetTimestamp())
+        << ", size=" << std::to_string(image.GetWidth()) << 'x' << std::to_string(image.GetHeight())
+        << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const RGBImage &image) {
+    return PrintImage(out, "RGBImage", image);
+  }
+
+  std::ostream &operator<<(std::ostream &out, const DepthImage &image) {
+    return PrintImage(out, "DepthImage", image);
+  }
+
+  std::ostream &operator<<(std::ostream &out, const LabelImage &image) {
+    return PrintImage(out, "LabelImage", image);
+  }
+
+  std::ostream &operator<<(std::ostream &out, const EncodedImage &image) {
+    out << "EncodedImage(frame=" << std::to_string(image.GetFrame())
+        << ", timestamp=" << std::to_string(image.GetTimestamp())
+        << ", size=" << std::to_string(image.GetWidth()) << 'x' << std::to_string(image.GetHeight())
+        << ", bytes=" << std::to_string(image.size())
+        << ')';
+    return out;
+  }
+
   std::ostream &operator<<(std::ostream &out, const LidarMeasurement &meas) {
     out << "LidarMeasurement(frame=" << std::to_string(meas.GetFrame())
         << ", timestamp=" << std::to_string(meas.GetTimestamp())
@@ -51,6 +93,34 @@ namespace data {
     return out;
   }
 
+  std::ostream &operator<<(std::ostream &out, const ActorBoundingBox2D &box) {
+    out << "ActorBoundingBox2D(actor_id=" << std::to_string(box.actor_id)
+        << ", x_min=" << std::to_string(box.x_min)
+        << ", y_min=" << std::to_string(box.y_min)
+        << ", x_max=" << std::to_string(box.x_max)
+        << ", y_max=" << std::to_string(box.y_max)
+        << ", visible_pixels=" << std::to_string(box.visible_pixels)
+        << ", occlusion=" << std::to_string(box.GetOcclusion())
+        << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const ActorBoundingBoxes &meas) {
+    out << "ActorBoundingBoxes(frame=" << std::to_string(meas.GetFrame())
+        << ", timestamp=" << std::to_string(meas.GetTimestamp())
+        << ", number_of_actors=" << std::to_string(meas.size())
+        << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const CollisionEventBatch &meas) {
+    out << "CollisionEventBatch(frame=" << std::to_string(meas.GetFrame())
+        << ", timestamp=" << std::to_string(meas.GetTimestamp())
+        << ", number_of_events=" << std::to_string(meas.size())
+        << ')';
+    return out;
+  }
+
   std::ostream &operator<<(std::ostream &out, const ObstacleDetectionEvent &meas) {
     out << "ObstacleDetectionEvent(frame=" << std::to_string(meas.GetFrame())
         << ", timestamp=" << std::to_string(meas.GetTimestamp())
@@ -76,6 +146,14 @@ namespace data {
     return out;
   }
 
+  std::ostream &operator<<(std::ostream &out, const SensorBundle &bundle) {
+    out << "SensorBundle(frame=" << std::to_string(bundle.GetFrame())
+        << ", timestamp=" << std::to_string(bundle.GetTimestamp())
+        << ", number_of_readings=" << std::to_string(bundle.size())
+        << ')';
+    return out;
+  }
+
   std::ostream &operator<<(std::ostream &out, const IMUMeasurement &meas) {
     out << "IMUMeasurement(frame=" << std::to_string(meas.GetFrame())
         << ", timestamp=" << std::to_string(meas.GetTimestamp())
@@ -97,32 +175,166 @@ enum class EColorConverter {
   CityScapesPalette
 };
 
+#if PY_MAJOR_VERSION >= 3
+
+/// Shape and type of the elements the buffer of each sensor data type is
+/// exported as, e.g. HxWx4 uint8 for carla.Image.
+template <typename T>
+struct SensorDataBufferLayout;
+
+template <typename PixelT, int Channels, char Format>
+struct ImageBufferLayout {
+  static constexpr int ndim = (Channels > 1 ? 3 : 2);
+  static constexpr Py_ssize_t itemsize = sizeof(PixelT) / Channels;
+  static constexpr const char *format() {
+    return Format == 'B' ? "B" : "f";
+  }
+  template <typename ImageT>
+  static void FillShape(const ImageT &self, Py_ssize_t *shape) {
+    shape[0] = static_cast<Py_ssize_t>(self.GetHeight());
+    shape[1] = static_cast<Py_ssize_t>(self.GetWidth());
+    if (ndim == 3) {
+      shape[2] = Channels;
+    }
+  }
+};
+
+template <>
+struct SensorDataBufferLayout<carla::sensor::data::Image>
+  : ImageBufferLayout<carla::sensor::data::Color, 4, 'B'> {};
+
+template <>
+struct SensorDataBufferLayout<carla::sensor::data::RGBImage>
+  : ImageBufferLayout<carla::sensor::data::ColorRGB, 3, 'B'> {};
+
+template <>
+struct SensorDataBufferLayout<carla::sensor::data::DepthImage>
+  : ImageBufferLayout<float, 1, 'f'> {};
+
+template <>
+struct SensorDataBufferLayout<carla::sensor::data::LabelImage>
+  : ImageBufferLayout<uint8_t, 1, 'B'> {};
+
+template <>
+struct SensorDataBufferLayout<carla::sensor::data::EncodedImage> {
+  static constexpr int ndim = 1;
+  static constexpr Py_ssize_t itemsize = 1;
+  static constexpr const char *format() {
+    return "B";
+  }
+  static void FillShape(const carla::sensor::data::EncodedImage &self, Py_ssize_t *shape) {
+    shape[0] = static_cast<Py_ssize_t>(self.size());
+  }
+};
+
+template <>
+struct SensorDataBufferLayout<carla::sensor::data::LidarMeasurement> {
+  static constexpr int ndim = 2;
+  static constexpr Py_ssize_t itemsize = sizeof(float);
+  static constexpr const char *format() {
+    return "f";
+  }
+  static void FillShape(const carla::sensor::data::LidarMeasurement &self, Py_ssize_t *shape) {
+    shape[0] = static_cast<Py_ssize_t>(self.size());
+    shape[1] = 3;
+  }
+};
+
+/// Exposes the buffer received from the stream through the buffer protocol,
+/// read-only, with the shape and type of SensorDataBufferLayout, so
+/// numpy.asarray gets a typed array without copying it. The exported view
+/// holds a reference to the Python object, which keeps the sensor data and
+/// its buffer alive for as long as the view is in use.
+template <typename T>
+static int GetSensorDataBuffer(PyObject *exporter, Py_buffer *view, int flags) {
+  using Layout = SensorDataBufferLayout<T>;
+  view->obj = nullptr;
+  boost::python::extract<T &> extracted(exporter);
+  if (!extracted.check()) {
+    PyErr_SetString(PyExc_BufferError, "invalid sensor data");
+    return -1;
+  }
+  if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE) {
+    PyErr_SetString(PyExc_BufferError, "sensor data buffer is read-only");
+    return -1;
+  }
+  T &self = extracted();
+  const auto size = static_cast<Py_ssize_t>(sizeof(typename T::value_type) * self.size());
+  if ((flags & PyBUF_ND) != PyBUF_ND) {
+    // Plain bytes, as PyBuffer_FillInfo would export them.
+    return PyBuffer_FillInfo(view, exporter, self.data(), size, 1, flags);
+  }
+  if (((flags & PyBUF_FORMAT) != PyBUF_FORMAT) && (Layout::itemsize != 1)) {
+    PyErr_SetString(PyExc_BufferError, "sensor data buffer requires the format");
+    return -1;
+  }
+  // Shape and strides live until the view is released.
+  auto *shape = new Py_ssize_t[2u * Layout::ndim];
+  auto *strides = shape + Layout::ndim;
+  Layout::FillShape(self, shape);
+  strides[Layout::ndim - 1] = Layout::itemsize;
+  for (int i = Layout::ndim - 2; i >= 0; --i) {
+    strides[i] = strides[i + 1] * shape[i + 1];
+  }
+  view->buf = self.data();
+  view->obj = exporter;
+  Py_INCREF(exporter);
+  view->len = size;
+  view->readonly = 1;
+  view->itemsize = Layout::itemsize;
+  view->format = ((flags & PyBUF_FORMAT) == PyBUF_FORMAT) ? const_cast<char *>(Layout::format()) : nullptr;
+  view->ndim = Layout::ndim;
+  view->shape = shape;
+  view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? strides : nullptr;
+  view->suboffsets = nullptr;
+  view->internal = shape;
+  return 0;
+}
+
+static void ReleaseSensorDataBuffer(PyObject *, Py_buffer *view) {
+  delete[] static_cast<Py_ssize_t *>(view->internal);
+  view->internal = nullptr;
+}
+
+template <typename T>
+static void EnableBufferProtocol(const boost::python::object &type) {
+  static PyBufferProcs procs = {&GetSensorDataBuffer<T>, &ReleaseSensorDataBuffer};
+  reinterpret_cast<PyTypeObject *>(type.ptr())->tp_as_buffer = &procs;
+}
+
+/// Flat bytes, as raw_data always returned; the typed view is available with
+/// memoryview(data) or numpy.asarray(data).
+template <typename T>
+static auto GetRawDataAsBuffer(boost::python::object self) {
+  boost::python::object view{boost::python::handle<>(PyMemoryView_FromObject(self.ptr()))};
+  return view.attr("cast")("B");
+}
+
+#else
+
 template <typename T>
 static auto GetRawDataAsBuffer(T &self) {
   auto *data = reinterpret_cast<unsigned char *>(self.data());
   auto size = static_cast<Py_ssize_t>(sizeof(typename T::value_type) * self.size());
-#if PY_MAJOR_VERSION >= 3
-  auto *ptr = PyMemoryView_FromMemory(reinterpret_cast<char *>(data), size, PyBUF_READ);
-#else
   auto *ptr = PyBuffer_FromMemory(data, size);
-#endif
   return boost::python::object(boost::python::handle<>(ptr));
 }
 
+#endif // PY_MAJOR_VERSION >= 3
+
 template <typename T>
 static void ConvertImage(T &self, EColorConverter cc) {
   carla::PythonUtil::ReleaseGIL unlock;
   using namespace carla::image;
-  auto view = ImageView::MakeView(self);
   switch (cc) {
     case EColorConverter::Depth:
-      ImageConverter::ConvertInPlace(view, ColorConverter::Depth());
+      FastImageConverter::ConvertInPlace(self, ColorConverter::Depth());
       break;
     case EColorConverter::LogarithmicDepth:
-      ImageConverter::ConvertInPlace(view, ColorConverter::LogarithmicDepth());
+      FastImageConverter::ConvertInPlace(self, ColorConverter::LogarithmicDepth());
       break;
     case EColorConverter::CityScapesPalette:
-      ImageConverter::ConvertInPlace(view, ColorConverter::CityScapesPalette());
+      FastImageConverter::ConvertInPlace(self, ColorConverter::CityScapesPalette());
       break;
     case EColorConverter::Raw:
       break; // ignore.
@@ -131,37 +343,190 @@ static void ConvertImage(T &self, EColorConverter cc) {
   }
 }
 
+/// Writer shared by the images and point clouds saved asynchronously. Saves
+/// still queued at exit are finished.
+static carla::AsyncWriter &GetSaveQueue() {
+  static carla::AsyncWriter writer(std::max(1u, std::thread::hardware_concurrency() / 2u));
+  return writer;
+}
+
+/// Shared pointer owning @a self, keeps it alive while saved in the
+/// background without holding a reference to the Python object.
+template <typename T>
+static boost::shared_ptr<T> SharedFromSensorData(T &self) {
+  return boost::static_pointer_cast<T>(self.shared_from_this());
+}
+
+/// Copy of @a self converted, shared by every consumer of the frame. @a self
+/// is left untouched.
 template <typename T>
-static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc) {
+static boost::shared_ptr<T> GetConvertedImage(T &self, EColorConverter cc) {
   carla::PythonUtil::ReleaseGIL unlock;
+  using namespace carla::image;
+  switch (cc) {
+    case EColorConverter::Depth:
+      return FastImageConverter::GetConverted(self, ColorConverter::Depth());
+    case EColorConverter::LogarithmicDepth:
+      return FastImageConverter::GetConverted(self, ColorConverter::LogarithmicDepth());
+    case EColorConverter::CityScapesPalette:
+      return FastImageConverter::GetConverted(self, ColorConverter::CityScapesPalette());
+    case EColorConverter::Raw:
+      return SharedFromSensorData(self);
+    default:
+      throw std::invalid_argument("invalid color converter!");
+  }
+}
+
+/// Queue @a write in the save queue, the future holds the path written.
+template <typename F>
+static carla::client::Future<std::string> PushSave(F &&write) {
+  auto future = GetSaveQueue().Push(std::forward<F>(write));
+  return carla::client::Future<std::string>(
+      [future](carla::time_duration timeout) {
+        return future.wait_for(timeout.to_chrono()) == std::future_status::ready;
+      },
+      [future]() { return future.get(); });
+}
+
+template <typename T, typename IO>
+static std::string WriteImageAs(const T &self, std::string path, EColorConverter cc, IO io) {
   using namespace carla::image;
   auto view = ImageView::MakeView(self);
   switch (cc) {
     case EColorConverter::Raw:
       return ImageIO::WriteView(
           std::move(path),
-          view);
+          view,
+          io);
     case EColorConverter::Depth:
       return ImageIO::WriteView(
           std::move(path),
-          ImageView::MakeColorConvertedView(view, ColorConverter::Depth()));
+          ImageView::MakeColorConvertedView(view, ColorConverter::Depth()),
+          io);
     case EColorConverter::LogarithmicDepth:
       return ImageIO::WriteView(
           std::move(path),
-          ImageView::MakeColorConvertedView(view, ColorConverter::LogarithmicDepth()));
+          ImageView::MakeColorConvertedView(view, ColorConverter::LogarithmicDepth()),
+          io);
     case EColorConverter::CityScapesPalette:
       return ImageIO::WriteView(
           std::move(path),
-          ImageView::MakeColorConvertedView(view, ColorConverter::CityScapesPalette()));
+          ImageView::MakeColorConvertedView(view, ColorConverter::CityScapesPalette()),
+          io);
     default:
       throw std::invalid_argument("invalid color converter!");
   }
 }
 
+/// With @a fast, PNG images are written at the lowest compression level.
+template <typename T>
+static std::string WriteImage(const T &self, std::string path, EColorConverter cc, bool fast) {
+  namespace io = carla::image::io;
+  return fast ?
+      WriteImageAs(self, std::move(path), cc, io::any_fast()) :
+      WriteImageAs(self, std::move(path), cc, io::any());
+}
+
+template <typename T>
+static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc, bool fast) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return WriteImage(self, std::move(path), cc, fast);
+}
+
 template <typename T>
-static std::string SavePointCloudToDisk(T &self, std::string path) {
+static auto SaveImageToDiskAsync(T &self, std::string path, EColorConverter cc, bool fast) {
   carla::PythonUtil::ReleaseGIL unlock;
-  return carla::pointcloud::PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end());
+  return PushSave([data = SharedFromSensorData(self), path = std::move(path), cc, fast]() {
+    return WriteImage(*data, path, cc, fast);
+  });
+}
+
+/// Save each (image, path[, color_converter]) of @a images on the threads of
+/// the save queue, returns the paths written once all of them are done.
+static boost::python::list SaveImagesToDisk(boost::python::object images, bool fast) {
+  namespace py = boost::python;
+  using ImagePtr = boost::shared_ptr<carla::sensor::data::Image>;
+  std::vector<std::tuple<ImagePtr, std::string, EColorConverter>> saves;
+  for (auto it = py::stl_input_iterator<py::object>(images); it != py::stl_input_iterator<py::object>(); ++it) {
+    const py::object item = *it;
+    const auto size = py::len(item);
+    if ((size < 2) || (size > 3)) {
+      throw std::invalid_argument("expected a list of (image, path[, color_converter])");
+    }
+    ImagePtr image = py::extract<ImagePtr>(item[0]);
+    if (image == nullptr) {
+      throw std::invalid_argument("invalid image");
+    }
+    saves.emplace_back(
+        std::move(image),
+        py::extract<std::string>(item[1]),
+        size > 2 ? py::extract<EColorConverter>(item[2])() : EColorConverter::Raw);
+  }
+  std::vector<std::string> paths;
+  paths.reserve(saves.size());
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    std::vector<std::shared_future<std::string>> futures;
+    futures.reserve(saves.size());
+    for (auto &save : saves) {
+      futures.emplace_back(GetSaveQueue().Push([save = std::move(save), fast]() {
+        return WriteImage(*std::get<0>(save), std::get<1>(save), std::get<2>(save), fast);
+      }));
+    }
+    // Wait for all of them before reporting the first error.
+    for (auto &future : futures) {
+      future.wait();
+    }
+    for (auto &future : futures) {
+      paths.emplace_back(future.get());
+    }
+  }
+  py::list result;
+  for (auto &path : paths) {
+    result.append(path);
+  }
+  return result;
+}
+
+template <typename T>
+static std::string WritePointCloud(const T &self, std::string path, carla::pointcloud::PointCloudFormat format) {
+  return carla::pointcloud::PointCloudIO::SaveToDisk(
+      std::move(path),
+      self.begin(),
+      self.end(),
+      format,
+      [&self](size_t index) { return static_cast<float>(self.GetIntensity(index)) / 255.0f; });
+}
+
+template <typename T>
+static std::string SavePointCloudToDisk(T &self, std::string path, carla::pointcloud::PointCloudFormat format) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return WritePointCloud(self, std::move(path), format);
+}
+
+template <typename T>
+static auto SavePointCloudToDiskAsync(T &self, std::string path, carla::pointcloud::PointCloudFormat format) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return PushSave([data = SharedFromSensorData(self), path = std::move(path), format]() {
+    return WritePointCloud(*data, path, format);
+  });
+}
+
+/// Read a message written by the "disk_sink" of a sensor, the file holds the
+/// message exactly as the client would have received it.
+static carla::SharedPtr<carla::sensor::SensorData> LoadSensorData(const std::string &path) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    throw std::invalid_argument("unable to open " + path);
+  }
+  carla::Buffer buffer(static_cast<uint64_t>(file.tellg()));
+  file.seekg(0);
+  file.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+  if (!file) {
+    throw std::runtime_error("unable to read " + path);
+  }
+  return carla::sensor::Deserializer::Deserialize(std::move(buffer));
 }
 
 void export_sensor_data() {
@@ -176,8 +541,30 @@ void export_sensor_data() {
     .add_property("frame_number", &cs::SensorData::GetFrame) // deprecated.
     .add_property("timestamp", &cs::SensorData::GetTimestamp)
     .add_property("transform", CALL_RETURNING_COPY(cs::SensorData, GetSensorTransform))
+    .add_property("cost", CALL_RETURNING_OPTIONAL(cs::SensorData, GetCost))
+    .def("wait_for_saves", +[]() {
+      carla::PythonUtil::ReleaseGIL unlock;
+      GetSaveQueue().Wait();
+    })
+    .staticmethod("wait_for_saves")
+    .def("get_save_stats", +[]() { return GetSaveQueue().GetStats(); })
+    .staticmethod("get_save_stats")
+    .def("load_from_disk", &LoadSensorData, (arg("path")))
+    .staticmethod("load_from_disk")
+  ;
+
+  class_<carla::AsyncWriterStats>("SaveQueueStats", no_init)
+    .def_readonly("queued", &carla::AsyncWriterStats::queued)
+    .def_readonly("max_queued", &carla::AsyncWriterStats::max_queued)
+    .def_readonly("capacity", &carla::AsyncWriterStats::capacity)
+    .def_readonly("written", &carla::AsyncWriterStats::written)
+    .def_readonly("failed", &carla::AsyncWriterStats::failed)
+    .def_readonly("blocked", &carla::AsyncWriterStats::blocked)
+    .def_readonly("total_blocked_seconds", &carla::AsyncWriterStats::total_blocked_seconds)
   ;
 
+  ExportFuture<std::string>("SaveFuture");
+
   enum_<EColorConverter>("ColorConverter")
     .value("Raw", EColorConverter::Raw)
     .value("Depth", EColorConverter::Depth)
@@ -185,13 +572,23 @@ void export_sensor_data() {
     .value("CityScapesPalette", EColorConverter::CityScapesPalette)
   ;
 
-  class_<csd::Image, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::Image>>("Image", no_init)
+  enum_<carla::pointcloud::PointCloudFormat>("PointCloudFormat")
+    .value("AsciiPly", carla::pointcloud::PointCloudFormat::AsciiPly)
+    .value("BinaryPly", carla::pointcloud::PointCloudFormat::BinaryPly)
+    .value("Bin", carla::pointcloud::PointCloudFormat::Bin)
+  ;
+
+  auto image = class_<csd::Image, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::Image>>("Image", no_init)
     .add_property("width", &csd::Image::GetWidth)
     .add_property("height", &csd::Image::GetHeight)
     .add_property("fov", &csd::Image::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::Image>)
     .def("convert", &ConvertImage<csd::Image>, (arg("color_converter")))
-    .def("save_to_disk", &SaveImageToDisk<csd::Image>, (arg("path"), arg("color_converter")=EColorConverter::Raw))
+    .def("converted", &GetConvertedImage<csd::Image>, (arg("color_converter")))
+    .def("save_to_disk", &SaveImageToDisk<csd::Image>, (arg("path"), arg("color_converter")=EColorConverter::Raw, arg("fast")=false))
+    .def("save_to_disk_async", &SaveImageToDiskAsync<csd::Image>, (arg("path"), arg("color_converter")=EColorConverter::Raw, arg("fast")=false))
+    .def("save_images", &SaveImagesToDisk, (arg("images"), arg("fast")=false))
+    .staticmethod("save_images")
     .def("__len__", &csd::Image::size)
     .def("__iter__", iterator<csd::Image>())
     .def("__getitem__", +[](const csd::Image &self, size_t pos) -> csd::Color {
@@ -203,12 +600,110 @@ void export_sensor_data() {
     .def(self_ns::str(self_ns::self))
   ;
 
-  class_<csd::LidarMeasurement, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::LidarMeasurement>>("LidarMeasurement", no_init)
+#if PY_MAJOR_VERSION >= 3
+  EnableBufferProtocol<csd::Image>(image);
+#endif // PY_MAJOR_VERSION >= 3
+
+  auto rgb_image = class_<csd::RGBImage, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::RGBImage>>("RGBImage", no_init)
+    .add_property("width", &csd::RGBImage::GetWidth)
+    .add_property("height", &csd::RGBImage::GetHeight)
+    .add_property("fov", &csd::RGBImage::GetFOVAngle)
+    .add_property("raw_data", &GetRawDataAsBuffer<csd::RGBImage>)
+    .def("__len__", &csd::RGBImage::size)
+    .def("__getitem__", +[](const csd::RGBImage &self, size_t pos) -> csd::Color {
+      return self.at(pos);
+    })
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  auto depth_image = class_<csd::DepthImage, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::DepthImage>>("DepthImage", no_init)
+    .add_property("width", &csd::DepthImage::GetWidth)
+    .add_property("height", &csd::DepthImage::GetHeight)
+    .add_property("fov", &csd::DepthImage::GetFOVAngle)
+    .add_property("raw_data", &GetRawDataAsBuffer<csd::DepthImage>)
+    .def("__len__", &csd::DepthImage::size)
+    .def("__iter__", iterator<csd::DepthImage>())
+    .def("__getitem__", +[](const csd::DepthImage &self, size_t pos) -> float {
+      return self.at(pos);
+    })
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  auto label_image = class_<csd::LabelImage, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::LabelImage>>("LabelImage", no_init)
+    .add_property("width", &csd::LabelImage::GetWidth)
+    .add_property("height", &csd::LabelImage::GetHeight)
+    .add_property("fov", &csd::LabelImage::GetFOVAngle)
+    .add_property("raw_data", &GetRawDataAsBuffer<csd::LabelImage>)
+    .def("__len__", &csd::LabelImage::size)
+    .def("__iter__", iterator<csd::LabelImage>())
+    .def("__getitem__", +[](const csd::LabelImage &self, size_t pos) -> int {
+      return self.at(pos);
+    })
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  enum_<carla::sensor::s11n::ImageCodec>("ImageCodec")
+    .value("JPEG", carla::sensor::s11n::ImageCodec::JPEG)
+  ;
+
+  auto encoded_image = class_<csd::EncodedImage, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::EncodedImage>>("EncodedImage", no_init)
+    .add_property("width", &csd::EncodedImage::GetWidth)
+    .add_property("height", &csd::EncodedImage::GetHeight)
+    .add_property("fov", &csd::EncodedImage::GetFOVAngle)
+    .add_property("codec", &csd::EncodedImage::GetCodec)
+    .add_property("raw_data", &GetRawDataAsBuffer<csd::EncodedImage>)
+    .def("save_to_disk", +[](const csd::EncodedImage &self, const std::string &path) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      std::ofstream file(path, std::ios::binary);
+      if (!file.write(reinterpret_cast<const char *>(self.data()), static_cast<std::streamsize>(self.size()))) {
+        throw std::runtime_error("failed to write encoded image to " + path);
+      }
+    }, (arg("path")))
+    .def("__len__", &csd::EncodedImage::size)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+#if PY_MAJOR_VERSION >= 3
+  EnableBufferProtocol<csd::RGBImage>(rgb_image);
+  EnableBufferProtocol<csd::DepthImage>(depth_image);
+  EnableBufferProtocol<csd::LabelImage>(label_image);
+  EnableBufferProtocol<csd::EncodedImage>(encoded_image);
+#endif // PY_MAJOR_VERSION >= 3
+
+  auto lidar = class_<csd::LidarMeasurement, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::LidarMeasurement>>("LidarMeasurement", no_init)
     .add_property("horizontal_angle", &csd::LidarMeasurement::GetHorizontalAngle)
     .add_property("channels", &csd::LidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::LidarMeasurement>)
-    .def("get_point_count", &csd::LidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path")))
+    .add_property("slices", &csd::LidarMeasurement::GetSliceCount)
+    .def("get_point_count", +[](const csd::LidarMeasurement &self, size_t channel) -> uint32_t {
+      return self.GetPointCount(channel);
+    }, (arg("channel")))
+    .def("get_slice_point_count", +[](const csd::LidarMeasurement &self, size_t channel, size_t slice) -> uint32_t {
+      if ((channel >= self.GetChannelCount()) || (slice >= self.GetSliceCount())) {
+        throw std::out_of_range("Lidar channel or slice out of range");
+      }
+      return self.GetPointCount(channel, slice);
+    }, (arg("channel"), arg("slice")))
+    .def("get_slice_time", +[](const csd::LidarMeasurement &self, size_t slice) -> float {
+      if (slice >= self.GetSliceCount()) {
+        throw std::out_of_range("Lidar slice out of range");
+      }
+      return self.GetSliceTime(slice);
+    }, (arg("slice")))
+    .def("get_slice_index", +[](const csd::LidarMeasurement &self, size_t index) -> size_t {
+      if (index >= self.size()) {
+        throw std::out_of_range("Lidar point index out of range");
+      }
+      return self.GetSliceIndex(index);
+    }, (arg("index")))
+    .def("get_intensity", +[](const csd::LidarMeasurement &self, size_t index) -> int {
+      if (index >= self.size()) {
+        throw std::out_of_range("Lidar point index out of range");
+      }
+      return self.GetIntensity(index);
+    }, (arg("index")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path"), arg("format")=carla::pointcloud::PointCloudFormat::AsciiPly))
+    .def("save_to_disk_async", &SavePointCloudToDiskAsync<csd::LidarMeasurement>, (arg("path"), arg("format")=carla::pointcloud::PointCloudFormat::AsciiPly))
     .def("__len__", &csd::LidarMeasurement::size)
     .def("__iter__", iterator<csd::LidarMeasurement>())
     .def("__getitem__", +[](const csd::LidarMeasurement &self, size_t pos) -> cr::Location {
@@ -220,6 +715,10 @@ void export_sensor_data() {
     .def(self_ns::str(self_ns::self))
   ;
 
+#if PY_MAJOR_VERSION >= 3
+  EnableBufferProtocol<csd::LidarMeasurement>(lidar);
+#endif // PY_MAJOR_VERSION >= 3
+
   class_<csd::CollisionEvent, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::CollisionEvent>>("CollisionEvent", no_init)
     .add_property("actor", &csd::CollisionEvent::GetActor)
     .add_property("other_actor", &csd::CollisionEvent::GetOtherActor)
@@ -227,6 +726,41 @@ void export_sensor_data() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<csd::CollisionEventBatch, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::CollisionEventBatch>>("CollisionEventBatch", no_init)
+    .add_property("actor", &csd::CollisionEventBatch::GetActor)
+    .def("__len__", &csd::CollisionEventBatch::size)
+    .def("get_other_actor", &csd::CollisionEventBatch::GetOtherActor, (arg("pos")))
+    .def("get_normal_impulse", CALL_RETURNING_COPY_1(csd::CollisionEventBatch, GetNormalImpulse, size_t), (arg("pos")))
+    .def("get_number_of_hits", &csd::CollisionEventBatch::GetNumberOfHits, (arg("pos")))
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  // The fields are packed, read them by copy.
+  class_<csd::ActorBoundingBox2D>("ActorBoundingBox2D", no_init)
+    .add_property("actor_id", +[](const csd::ActorBoundingBox2D &self) -> carla::ActorId { return self.actor_id; })
+    .add_property("semantic_tag", +[](const csd::ActorBoundingBox2D &self) -> int { return self.semantic_tag; })
+    .add_property("x_min", +[](const csd::ActorBoundingBox2D &self) -> int { return self.x_min; })
+    .add_property("y_min", +[](const csd::ActorBoundingBox2D &self) -> int { return self.y_min; })
+    .add_property("x_max", +[](const csd::ActorBoundingBox2D &self) -> int { return self.x_max; })
+    .add_property("y_max", +[](const csd::ActorBoundingBox2D &self) -> int { return self.y_max; })
+    .add_property("visible_pixels", +[](const csd::ActorBoundingBox2D &self) -> uint32_t { return self.visible_pixels; })
+    .add_property("occluded_pixels", +[](const csd::ActorBoundingBox2D &self) -> uint32_t { return self.occluded_pixels; })
+    .add_property("occlusion", &csd::ActorBoundingBox2D::GetOcclusion)
+    .add_property("distance", +[](const csd::ActorBoundingBox2D &self) -> float { return self.distance; })
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<csd::ActorBoundingBoxes, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::ActorBoundingBoxes>>("ActorBoundingBoxes", no_init)
+    .add_property("width", &csd::ActorBoundingBoxes::GetWidth)
+    .add_property("height", &csd::ActorBoundingBoxes::GetHeight)
+    .def("__len__", &csd::ActorBoundingBoxes::size)
+    .def("__iter__", iterator<csd::ActorBoundingBoxes>())
+    .def("__getitem__", +[](const csd::ActorBoundingBoxes &self, size_t pos) -> csd::ActorBoundingBox2D {
+      return self.at(pos);
+    })
+    .def(self_ns::str(self_ns::self))
+  ;
+
     class_<csd::ObstacleDetectionEvent, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::ObstacleDetectionEvent>>("ObstacleDetectionEvent", no_init)
     .add_property("actor", &csd::ObstacleDetectionEvent::GetActor)
     .add_property("other_actor", &csd::ObstacleDetectionEvent::GetOtherActor)
@@ -253,4 +787,15 @@ void export_sensor_data() {
     .add_property("compass", &csd::IMUMeasurement::GetCompass)
     .def(self_ns::str(self_ns::self))
   ;
+
+  class_<csd::SensorBundle, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::SensorBundle>>("SensorBundle", no_init)
+    .def("__len__", &csd::SensorBundle::size)
+    .def("__iter__", iterator<csd::SensorBundle>())
+    .def("__getitem__", +[](const csd::SensorBundle &self, size_t pos) -> carla::SharedPtr<cs::SensorData> {
+      return self.at(pos);
+    })
+    .def("get_sensor_id", &csd::SensorBundle::GetSensorId, (arg("pos")))
+    .def("find", &csd::SensorBundle::Find, (arg("sensor_id")))
+    .def(self_ns::str(self_ns::self))
+  ;
 }
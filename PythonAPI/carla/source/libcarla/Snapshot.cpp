@@ -9,8 +9,11 @@
 #include <carla/client/ActorList.h>
 #include <carla/client/World.h>
 
+#include <boost/python/stl_iterator.hpp>
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 
+#include <vector>
+
 namespace carla {
 namespace client {
 
@@ -27,6 +30,32 @@ namespace client {
 } // namespace client
 } // namespace carla
 
+static carla::client::ActorStateArrays GetActorStates(
+    const carla::client::WorldSnapshot &self,
+    const boost::python::object &actors) {
+  namespace py = boost::python;
+  if (actors.is_none()) {
+    carla::PythonUtil::ReleaseGIL unlock;
+    return self.GetActorStates();
+  }
+  // Either a carla.ActorList, to filter by type with ActorList.filter, or a
+  // list of ids.
+  std::vector<carla::ActorId> ids;
+  py::extract<const carla::client::ActorList &> actor_list(actors);
+  if (actor_list.check()) {
+    ids.reserve(actor_list().size());
+    for (auto &&actor : actor_list()) {
+      ids.emplace_back(actor->GetId());
+    }
+  } else {
+    ids.assign(
+        py::stl_input_iterator<carla::ActorId>(actors),
+        py::stl_input_iterator<carla::ActorId>());
+  }
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.GetActorStates(ids);
+}
+
 void export_snapshot() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -40,6 +69,25 @@ void export_snapshot() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<cc::ActorStateArrays>("ActorStateArrays", no_init)
+    .add_property("ids", +[](const cc::ActorStateArrays &self) {
+      return MakeArrayView(self.ids, "I", 1u);
+    })
+    .add_property("transforms", +[](const cc::ActorStateArrays &self) {
+      return MakeArrayView(self.transforms, "f", 6u);
+    })
+    .add_property("velocities", +[](const cc::ActorStateArrays &self) {
+      return MakeArrayView(self.velocities, "f", 3u);
+    })
+    .add_property("angular_velocities", +[](const cc::ActorStateArrays &self) {
+      return MakeArrayView(self.angular_velocities, "f", 3u);
+    })
+    .add_property("accelerations", +[](const cc::ActorStateArrays &self) {
+      return MakeArrayView(self.accelerations, "f", 3u);
+    })
+    .def("__len__", +[](const cc::ActorStateArrays &self) { return self.ids.size(); })
+  ;
+
   class_<cc::WorldSnapshot>("WorldSnapshot", no_init)
     .add_property("id", &cc::WorldSnapshot::GetId)
     .add_property("frame", +[](const cc::WorldSnapshot &self) { return self.GetTimestamp().frame; })
@@ -52,6 +100,7 @@ void export_snapshot() {
     /// @}
     .def("has_actor", &cc::WorldSnapshot::Contains, (arg("actor_id")))
     .def("find", CALL_RETURNING_OPTIONAL_1(cc::WorldSnapshot, Find, carla::ActorId), (arg("actor_id")))
+    .def("get_actor_states", &GetActorStates, (arg("actors")=object()))
     .def("__len__", &cc::WorldSnapshot::size)
     .def("__iter__", range(&cc::WorldSnapshot::begin, &cc::WorldSnapshot::end))
     .def("__eq__", &cc::WorldSnapshot::operator==)
@@ -40,7 +40,25 @@ namespace rpc {
   std::ostream &operator<<(std::ostream &out, const EpisodeSettings &settings) {
     auto BoolToStr = [](bool b) { return b ? "True" : "False"; };
     out << "WorldSettings(synchronous_mode=" << BoolToStr(settings.synchronous_mode)
-        << ",no_rendering_mode=" << BoolToStr(settings.no_rendering_mode) << ')';
+        << ",no_rendering_mode=" << BoolToStr(settings.no_rendering_mode)
+        << ",server_side_navigation=" << BoolToStr(settings.server_side_navigation)
+        << ",physics_lod_distance=" << settings.physics_lod_distance
+        << ",actor_pool_size=" << settings.actor_pool_size
+        << ",tile_streaming_distance=" << settings.tile_streaming_distance
+        << ",no_viewport_rendering=" << BoolToStr(settings.no_viewport_rendering)
+        << ",walker_animation_lod_distance=" << settings.walker_animation_lod_distance
+        << ",walker_animation_freeze_distance=" << settings.walker_animation_freeze_distance
+        << ",substepping=" << BoolToStr(settings.substepping)
+        << ",max_substep_delta_time=" << settings.max_substep_delta_time
+        << ",max_substeps=" << settings.max_substeps
+        << ",async_physics_scene=" << BoolToStr(settings.async_physics_scene) << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const AutopilotSettings &settings) {
+    out << "AutopilotSettings(speed_limit_percentage=" << settings.speed_limit_percentage
+        << ",obstacle_distance_factor=" << settings.obstacle_distance_factor
+        << ",respect_traffic_lights=" << (settings.respect_traffic_lights ? "True" : "False") << ')';
     return out;
   }
 
@@ -52,8 +70,14 @@ static auto WaitForTick(const carla::client::World &world, double seconds) {
   return world.WaitForTick(TimeDurationFromSeconds(seconds));
 }
 
-static size_t OnTick(carla::client::World &self, boost::python::object callback) {
-  return self.OnTick(MakeCallback(std::move(callback)));
+static auto WaitForFrame(const carla::client::World &world, uint64_t frame, double seconds) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return world.WaitForFrame(frame, TimeDurationFromSeconds(seconds));
+}
+
+static size_t OnTick(carla::client::World &self, boost::python::object callback, bool asynchronous) {
+  auto function = MakeCallback(std::move(callback));
+  return asynchronous ? self.OnTickAsync(std::move(function)) : self.OnTick(std::move(function));
 }
 
 static auto GetActorsById(carla::client::World &self, const boost::python::list &actor_ids) {
@@ -64,6 +88,75 @@ static auto GetActorsById(carla::client::World &self, const boost::python::list
   return self.GetActors(ids);
 }
 
+/// Read @a values as rows of three floats, as many as @a rows if not zero.
+static std::vector<float> ReadVectors(
+    const boost::python::object &values,
+    const size_t rows,
+    const char *name) {
+  auto result = ReadNumbers<float>(values);
+  if (((result.size() % 3u) != 0u) || ((rows > 0u) && (result.size() != 3u * rows))) {
+    throw std::invalid_argument(std::string(name) + " must have three values for each query");
+  }
+  return result;
+}
+
+/// Rays from the (N, 3) @a origins to the (N, 3) @a directions, e.g. numpy
+/// arrays.
+static auto CastRays(
+    const carla::client::World &self,
+    const boost::python::object &origins,
+    const boost::python::object &directions,
+    const float max_distance) {
+  const auto o = ReadVectors(origins, 0u, "origins");
+  const auto d = ReadVectors(directions, o.size() / 3u, "directions");
+  carla::PythonUtil::ReleaseGIL unlock;
+  carla::rpc::RayCastBatch batch{max_distance};
+  batch.Reserve(o.size() / 3u);
+  for (size_t i = 0u; i < o.size(); i += 3u) {
+    batch.Add(carla::rpc::RayCast{{o[i], o[i + 1u], o[i + 2u]}, {d[i], d[i + 1u], d[i + 2u]}});
+  }
+  return self.CastRays(batch);
+}
+
+/// Boxes centered at the (N, 3) @a centers with half sizes @a extents, and
+/// pitch, yaw, roll @a rotations if not None.
+static auto OverlapBoxes(
+    const carla::client::World &self,
+    const boost::python::object &centers,
+    const boost::python::object &extents,
+    const boost::python::object &rotations) {
+  const auto c = ReadVectors(centers, 0u, "centers");
+  const auto e = ReadVectors(extents, c.size() / 3u, "extents");
+  const auto r = rotations.is_none() ?
+      std::vector<float>(c.size(), 0.0f) :
+      ReadVectors(rotations, c.size() / 3u, "rotations");
+  carla::PythonUtil::ReleaseGIL unlock;
+  carla::rpc::BoxOverlapBatch batch;
+  batch.Reserve(c.size() / 3u);
+  for (size_t i = 0u; i < c.size(); i += 3u) {
+    batch.Add(carla::rpc::BoxOverlap{
+        {c[i], c[i + 1u], c[i + 2u]},
+        {e[i], e[i + 1u], e[i + 2u]},
+        {r[i], r[i + 1u], r[i + 2u]}});
+  }
+  return self.OverlapBoxes(batch);
+}
+
+/// Column of @a values, @a columns per entry of @a batch, as an array view.
+template <typename T, typename BatchT, typename FunctorT>
+static boost::python::object GetBatchColumn(
+    const BatchT &batch,
+    const char *format,
+    const size_t columns,
+    FunctorT &&get) {
+  std::vector<T> values;
+  values.reserve(columns * batch.size());
+  for (size_t i = 0u; i < batch.size(); ++i) {
+    get(batch.at(i), values);
+  }
+  return MakeArrayView(values, format, columns);
+}
+
 void export_world() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -96,12 +189,34 @@ void export_world() {
   ;
 
   class_<cr::EpisodeSettings>("WorldSettings")
-    .def(init<bool, bool, double>(
+    .def(init<bool, bool, double, bool, double, uint32_t, double, bool, double, double, bool, double, int32_t, bool>(
         (arg("synchronous_mode")=false,
          arg("no_rendering_mode")=false,
-         arg("fixed_delta_seconds")=0.0)))
+         arg("fixed_delta_seconds")=0.0,
+         arg("server_side_navigation")=false,
+         arg("physics_lod_distance")=0.0,
+         arg("actor_pool_size")=0u,
+         arg("tile_streaming_distance")=0.0,
+         arg("no_viewport_rendering")=false,
+         arg("walker_animation_lod_distance")=0.0,
+         arg("walker_animation_freeze_distance")=0.0,
+         arg("substepping")=true,
+         arg("max_substep_delta_time")=1.0 / 60.0,
+         arg("max_substeps")=6,
+         arg("async_physics_scene")=false)))
     .def_readwrite("synchronous_mode", &cr::EpisodeSettings::synchronous_mode)
     .def_readwrite("no_rendering_mode", &cr::EpisodeSettings::no_rendering_mode)
+    .def_readwrite("server_side_navigation", &cr::EpisodeSettings::server_side_navigation)
+    .def_readwrite("physics_lod_distance", &cr::EpisodeSettings::physics_lod_distance)
+    .def_readwrite("actor_pool_size", &cr::EpisodeSettings::actor_pool_size)
+    .def_readwrite("tile_streaming_distance", &cr::EpisodeSettings::tile_streaming_distance)
+    .def_readwrite("no_viewport_rendering", &cr::EpisodeSettings::no_viewport_rendering)
+    .def_readwrite("walker_animation_lod_distance", &cr::EpisodeSettings::walker_animation_lod_distance)
+    .def_readwrite("walker_animation_freeze_distance", &cr::EpisodeSettings::walker_animation_freeze_distance)
+    .def_readwrite("substepping", &cr::EpisodeSettings::substepping)
+    .def_readwrite("max_substep_delta_time", &cr::EpisodeSettings::max_substep_delta_time)
+    .def_readwrite("max_substeps", &cr::EpisodeSettings::max_substeps)
+    .def_readwrite("async_physics_scene", &cr::EpisodeSettings::async_physics_scene)
     .add_property("fixed_delta_seconds",
         +[](const cr::EpisodeSettings &self) {
           return OptionalToPythonObject(self.fixed_delta_seconds);
@@ -115,6 +230,46 @@ void export_world() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<cr::AutopilotSettings>("AutopilotSettings")
+    .def(init<float, float, bool>(
+        (arg("speed_limit_percentage")=100.0f,
+         arg("obstacle_distance_factor")=1.0f,
+         arg("respect_traffic_lights")=true)))
+    .def_readwrite("speed_limit_percentage", &cr::AutopilotSettings::speed_limit_percentage)
+    .def_readwrite("obstacle_distance_factor", &cr::AutopilotSettings::obstacle_distance_factor)
+    .def_readwrite("respect_traffic_lights", &cr::AutopilotSettings::respect_traffic_lights)
+    .def("__eq__", &cr::AutopilotSettings::operator==)
+    .def("__ne__", &cr::AutopilotSettings::operator!=)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::EpisodeStateFilter>("EpisodeStateFilter")
+    .add_property("actor_ids",
+        +[](const cr::EpisodeStateFilter &self) {
+          list result;
+          for (auto id : self.actor_ids) {
+            result.append(id);
+          }
+          return result;
+        },
+        +[](cr::EpisodeStateFilter &self, const object &ids) {
+          self.actor_ids.assign(stl_input_iterator<carla::ActorId>(ids), stl_input_iterator<carla::ActorId>());
+        })
+    .add_property("type_patterns",
+        +[](const cr::EpisodeStateFilter &self) {
+          list result;
+          for (auto &&pattern : self.type_patterns) {
+            result.append(pattern);
+          }
+          return result;
+        },
+        +[](cr::EpisodeStateFilter &self, const object &patterns) {
+          self.type_patterns.assign(stl_input_iterator<std::string>(patterns), stl_input_iterator<std::string>());
+        })
+    .def_readwrite("center_actor_id", &cr::EpisodeStateFilter::center_actor_id)
+    .def_readwrite("radius", &cr::EpisodeStateFilter::radius)
+  ;
+
   enum_<cr::AttachmentType>("AttachmentType")
     .value("Rigid", cr::AttachmentType::Rigid)
     .value("SpringArm", cr::AttachmentType::SpringArm)
@@ -135,27 +290,94 @@ void export_world() {
       arg("attach_to")=carla::SharedPtr<cc::Actor>(), \
       arg("attachment_type")=cr::AttachmentType::Rigid)
 
+  ExportFuture<carla::SharedPtr<cc::Actor>>("ActorFuture");
+
+  class_<cc::detail::CallbackStats>("CallbackStats", no_init)
+    .def_readonly("calls", &cc::detail::CallbackStats::calls)
+    .def_readonly("coalesced", &cc::detail::CallbackStats::coalesced)
+    .def_readonly("total_seconds", &cc::detail::CallbackStats::total_seconds)
+    .def_readonly("max_seconds", &cc::detail::CallbackStats::max_seconds)
+  ;
+
+  class_<cr::RayHitBatch>("RayCastHits", no_init)
+    .add_property("has_hit", +[](const cr::RayHitBatch &self) {
+      return GetBatchColumn<uint8_t>(self, "?", 1u, [](const cr::RayHit &hit, auto &values) {
+        values.emplace_back(hit.has_hit);
+      });
+    })
+    .add_property("points", +[](const cr::RayHitBatch &self) {
+      return GetBatchColumn<float>(self, "f", 3u, [](const cr::RayHit &hit, auto &values) {
+        values.insert(values.end(), {hit.point.x, hit.point.y, hit.point.z});
+      });
+    })
+    .add_property("normals", +[](const cr::RayHitBatch &self) {
+      return GetBatchColumn<float>(self, "f", 3u, [](const cr::RayHit &hit, auto &values) {
+        values.insert(values.end(), {hit.normal.x, hit.normal.y, hit.normal.z});
+      });
+    })
+    .add_property("distances", +[](const cr::RayHitBatch &self) {
+      return GetBatchColumn<float>(self, "f", 1u, [](const cr::RayHit &hit, auto &values) {
+        values.emplace_back(hit.distance);
+      });
+    })
+    .add_property("actor_ids", +[](const cr::RayHitBatch &self) {
+      return GetBatchColumn<uint32_t>(self, "I", 1u, [](const cr::RayHit &hit, auto &values) {
+        values.emplace_back(hit.actor);
+      });
+    })
+    .def("__len__", &cr::RayHitBatch::size)
+  ;
+
+  class_<cr::BoxOverlapResultBatch>("BoxOverlaps", no_init)
+    .add_property("overlaps", +[](const cr::BoxOverlapResultBatch &self) {
+      return GetBatchColumn<uint8_t>(self, "?", 1u, [](const cr::BoxOverlapResult &result, auto &values) {
+        values.emplace_back(result.overlaps);
+      });
+    })
+    .add_property("actor_ids", +[](const cr::BoxOverlapResultBatch &self) {
+      return GetBatchColumn<uint32_t>(self, "I", 1u, [](const cr::BoxOverlapResult &result, auto &values) {
+        values.emplace_back(result.actor);
+      });
+    })
+    .def("__len__", &cr::BoxOverlapResultBatch::size)
+  ;
+
   class_<cc::World>("World", no_init)
     .add_property("id", &cc::World::GetId)
     .add_property("debug", &cc::World::MakeDebugHelper)
     .def("get_blueprint_library", CONST_CALL_WITHOUT_GIL(cc::World, GetBlueprintLibrary))
     .def("get_map", CONST_CALL_WITHOUT_GIL(cc::World, GetMap))
     .def("get_random_location_from_navigation", CALL_RETURNING_OPTIONAL_WITHOUT_GIL(cc::World, GetRandomLocationFromNavigation))
+    .def("set_max_pedestrians_per_region", CALL_WITHOUT_GIL_1(cc::World, SetMaxPedestriansPerRegion, unsigned), arg("max_pedestrians"))
+    .def("cast_rays", &CastRays, (arg("origins"), arg("directions"), arg("max_distance")=100.0f))
+    .def("overlap_boxes", &OverlapBoxes, (arg("centers"), arg("extents"), arg("rotations")=object()))
     .def("get_spectator", CONST_CALL_WITHOUT_GIL(cc::World, GetSpectator))
     .def("get_settings", CONST_CALL_WITHOUT_GIL(cc::World, GetSettings))
     .def("apply_settings", CALL_WITHOUT_GIL_1(cc::World, ApplySettings, cr::EpisodeSettings), arg("settings"))
+    .def("save_state", CALL_WITHOUT_GIL(cc::World, SaveState))
+    .def("restore_state", CALL_WITHOUT_GIL_1(cc::World, RestoreState, uint64_t), arg("snapshot_id"))
+    .def("drop_state", CALL_WITHOUT_GIL_1(cc::World, DropState, uint64_t), arg("snapshot_id"))
+    .def("set_state_filter", CALL_WITHOUT_GIL_1(cc::World, SetStateFilter, cr::EpisodeStateFilter), arg("filter"))
     .def("get_weather", CONST_CALL_WITHOUT_GIL(cc::World, GetWeather))
-    .def("set_weather", &cc::World::SetWeather)
+    .def("set_weather", CALL_WITHOUT_GIL_1(cc::World, SetWeather, const cr::WeatherParameters &), arg("weather"))
+    .def("get_autopilot_settings", CONST_CALL_WITHOUT_GIL(cc::World, GetAutopilotSettings))
+    .def("apply_autopilot_settings", CALL_WITHOUT_GIL_1(cc::World, ApplyAutopilotSettings, cr::AutopilotSettings), arg("settings"))
     .def("get_snapshot", &cc::World::GetSnapshot)
     .def("get_actor", CONST_CALL_WITHOUT_GIL_1(cc::World, GetActor, carla::ActorId), (arg("actor_id")))
     .def("get_actors", CONST_CALL_WITHOUT_GIL(cc::World, GetActors))
     .def("get_actors", &GetActorsById, (arg("actor_ids")))
+    .def("get_actors_by_type", CONST_CALL_WITHOUT_GIL_1(cc::World, GetActorsByType, std::string), (arg("wildcard_pattern")))
     .def("spawn_actor", SPAWN_ACTOR_WITHOUT_GIL(SpawnActor))
     .def("try_spawn_actor", SPAWN_ACTOR_WITHOUT_GIL(TrySpawnActor))
+    .def("spawn_actor_async", SPAWN_ACTOR_WITHOUT_GIL(SpawnActorAsync))
     .def("wait_for_tick", &WaitForTick, (arg("seconds")=10.0))
-    .def("on_tick", &OnTick, (arg("callback")))
+    .def("on_tick", &OnTick, (arg("callback"), arg("asynchronous")=false))
+    .def("get_on_tick_stats", CALL_RETURNING_OPTIONAL_1(cc::World, GetOnTickStats, size_t), (arg("callback_id")))
     .def("remove_on_tick", &cc::World::RemoveOnTick, (arg("callback_id")))
     .def("tick", CALL_WITHOUT_GIL(cc::World, Tick))
+    .def("tick_async", CALL_WITHOUT_GIL_1(cc::World, TickAsync, size_t), (arg("max_pending_ticks")=2u))
+    .def("tick_n", CALL_WITHOUT_GIL_2(cc::World, TickN, uint32_t, bool), (arg("frames"), arg("skip_intermediate_frames")=false))
+    .def("wait_for_frame", &WaitForFrame, (arg("frame"), arg("seconds")=10.0))
     .def(self_ns::str(self_ns::self))
   ;
 
@@ -197,5 +419,6 @@ void export_world() {
          arg("color")=cc::DebugHelper::Color(255u, 0u, 0u),
          arg("life_time")=-1.0f,
          arg("persistent_lines")=true))
+    .def("flush", CALL_WITHOUT_GIL(cc::DebugHelper, Flush))
   ;
 }
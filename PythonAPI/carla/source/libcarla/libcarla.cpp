@@ -7,6 +7,7 @@
 #include <carla/Memory.h>
 #include <carla/PythonUtil.h>
 #include <carla/Time.h>
+#include <carla/client/Future.h>
 
 #include <ostream>
 #include <type_traits>
@@ -173,6 +174,68 @@ static auto MakeCallback(boost::python::object callback) {
   };
 }
 
+template <typename T>
+static boost::python::object FutureResultToPythonObject(const T &result) {
+  return boost::python::object(result);
+}
+
+template <typename T>
+static boost::python::object FutureResultToPythonObject(const std::vector<T> &result) {
+  boost::python::list list;
+  for (auto &&item : result) {
+    list.append(item);
+  }
+  return list;
+}
+
+// Exposes carla::client::Future<T> as a Python class, the GIL is released
+// while waiting for the response. Awaitable in Python 3, see carla/__init__.py.
+template <typename T>
+static void ExportFuture(const char *name) {
+  namespace py = boost::python;
+  using FutureT = carla::client::Future<T>;
+  py::class_<FutureT>(name, py::no_init)
+    .def("done", &FutureT::IsReady)
+    .def("wait", +[](const FutureT &self, double seconds) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      return self.WaitFor(TimeDurationFromSeconds(seconds));
+    }, (py::arg("seconds")=10.0))
+    .def("get", +[](const FutureT &self) {
+      const T *result = nullptr;
+      {
+        carla::PythonUtil::ReleaseGIL unlock;
+        result = &self.Get();
+      }
+      return FutureResultToPythonObject(*result);
+    })
+  ;
+}
+
+/// Copy @a values into a new buffer, exposed as @a columns values of type
+/// @a format per row so numpy.asarray gets the shape right.
+template <typename T>
+static boost::python::object MakeArrayView(
+    const std::vector<T> &values,
+    const char *format,
+    const size_t columns) {
+  namespace py = boost::python;
+  auto *data = reinterpret_cast<const char *>(values.data());
+  auto size = static_cast<Py_ssize_t>(sizeof(T) * values.size());
+  py::object bytes{py::handle<>(PyBytes_FromStringAndSize(data, size))};
+#if PY_MAJOR_VERSION >= 3
+  py::object view{py::handle<>(PyMemoryView_FromObject(bytes.ptr()))};
+  // Views with zeros in their shape cannot be cast.
+  if ((columns == 1u) || values.empty()) {
+    return view.attr("cast")(format);
+  }
+  return view.attr("cast")(format, py::make_tuple(values.size() / columns, columns));
+#else
+  (void) format;
+  (void) columns;
+  return bytes;
+#endif // PY_MAJOR_VERSION >= 3
+}
+
 #include "Geom.cpp"
 #include "Actor.cpp"
 #include "Blueprint.cpp"
@@ -180,18 +243,21 @@ static auto MakeCallback(boost::python::object callback) {
 #include "Control.cpp"
 #include "Exception.cpp"
 #include "Map.cpp"
+#include "Profiler.cpp"
 #include "Sensor.cpp"
 #include "SensorData.cpp"
 #include "Snapshot.cpp"
 #include "Weather.cpp"
 #include "World.cpp"
 #include "Commands.cpp"
+#include "Recorder.cpp"
 
 BOOST_PYTHON_MODULE(libcarla) {
   using namespace boost::python;
   PyEval_InitThreads();
   scope().attr("__path__") = "libcarla";
   export_geom();
+  export_profiler();
   export_control();
   export_blueprint();
   export_actor();
@@ -204,4 +270,5 @@ BOOST_PYTHON_MODULE(libcarla) {
   export_client();
   export_exception();
   export_commands();
+  export_recorder();
 }
@@ -5,9 +5,46 @@
 # For a copy, see <https://opensource.org/licenses/MIT>.
 
 
+import threading
+import time
+
+import carla
+
 from . import SmokeTest
+from . import TESTING_ADDRESS
 
 
 class TestClient(SmokeTest):
     def test_version(self):
         self.assertEqual(self.client.get_client_version(), self.client.get_server_version())
+
+    def test_concurrent_throughput(self):
+        number_of_threads = 4
+        calls_per_thread = 50
+        client = carla.Client(*TESTING_ADDRESS, rpc_connections=number_of_threads)
+        client.set_timeout(10.0)
+        world = client.get_world()
+
+        def make_calls():
+            for _ in range(calls_per_thread):
+                world.get_settings()
+
+        start = time.time()
+        for _ in range(number_of_threads):
+            make_calls()
+        sequential_seconds = time.time() - start
+
+        threads = [threading.Thread(target=make_calls) for _ in range(number_of_threads)]
+        start = time.time()
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        concurrent_seconds = time.time() - start
+
+        calls = number_of_threads * calls_per_thread
+        print('%d calls: %.1f calls/s sequential, %.1f calls/s from %d threads' % (
+            calls, calls / sequential_seconds, calls / concurrent_seconds, number_of_threads))
+        # The GIL is released while waiting for the server, the threads must
+        # not be slower than making the calls one after another.
+        self.assertLess(concurrent_seconds, 1.5 * sequential_seconds)
@@ -40,3 +40,13 @@ class TestSnapshot(SyncSmokeTest):
             self.assertAlmostEqual(t0.rotation.pitch, t1.rotation.pitch, places=2)
             self.assertAlmostEqual(t0.rotation.yaw, t1.rotation.yaw, places=2)
             self.assertAlmostEqual(t0.rotation.roll, t1.rotation.roll, places=2)
+
+        states = snapshot.get_actor_states(ids)
+        self.assertEqual(states.ids.tolist(), ids)
+        for t0, t1 in zip(spawn_points, states.transforms.tolist()):
+            self.assertAlmostEqual(t0.location.x, t1[0], places=2)
+            self.assertAlmostEqual(t0.location.y, t1[1], places=2)
+            self.assertAlmostEqual(t0.rotation.yaw, t1[4], places=2)
+        vehicles = snapshot.get_actor_states(actors.filter('vehicle.*'))
+        self.assertEqual(sorted(vehicles.ids.tolist()), sorted(ids))
+        self.assertEqual(len(snapshot.get_actor_states()), len(snapshot))
@@ -50,3 +50,10 @@ class TestSynchronousMode(SyncSmokeTest):
 
         finally:
             camera.destroy()
+
+    def test_pipelined_ticks(self):
+        frames = [self.world.tick_async(max_pending_ticks=3) for _ in range(0, 30)]
+        for previous, frame in zip(frames, frames[1:]):
+            self.assertEqual(frame, previous + 1)
+        snapshot = self.world.wait_for_frame(frames[-1])
+        self.assertEqual(snapshot.timestamp.frame, frames[-1])
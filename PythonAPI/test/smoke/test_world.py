@@ -5,6 +5,8 @@
 # For a copy, see <https://opensource.org/licenses/MIT>.
 
 
+import carla
+
 from . import SmokeTest
 
 
@@ -21,3 +23,21 @@ class TestWorld(SmokeTest):
                 self.assertAlmostEqual(expected_delta_seconds, delta_seconds)
         settings.fixed_delta_seconds = None
         world.apply_settings(settings)
+
+    def test_spawn_actor_async(self):
+        world = self.client.get_world()
+        blueprints = world.get_blueprint_library().filter("static.prop.*")
+        spawn_points = world.get_map().get_spawn_points()
+        futures = []
+        for index in range(min(10, len(blueprints))):
+            blueprint = blueprints[index]
+            spawn_point = spawn_points[index % len(spawn_points)]
+            spawn_point.location.z += 100 * (index + 1)
+            futures.append(world.spawn_actor_async(blueprint, spawn_point))
+        actors = [future.get() for future in futures]
+        for future in futures:
+            self.assertTrue(future.done())
+        self.assertEqual(len(set(actor.id for actor in actors)), len(futures))
+        for actor in actors:
+            self.assertIsNotNone(world.get_actor(actor.id))
+        self.client.apply_batch_sync([carla.command.DestroyActor(actor) for actor in actors])
@@ -102,7 +102,12 @@ def inspect(args, client):
     print('weather:    % 22s\n' % weather)
     print('time:       % 22s\n' % elapsed_time)
     print('frame rate: % 22s' % frame_rate)
-    print('rendering:  % 22s' % ('disabled' if s.no_rendering_mode else 'enabled'))
+    rendering = 'enabled'
+    if s.no_rendering_mode:
+        rendering = 'disabled'
+    elif s.no_viewport_rendering:
+        rendering = 'sensors only'
+    print('rendering:  % 22s' % rendering)
     print('sync mode:  % 22s\n' % ('disabled' if not s.synchronous_mode else 'enabled'))
     print('actors:     % 22d' % len(actors))
     print('  * spectator:% 20d' % len(actors.filter('spectator')))
@@ -156,6 +161,10 @@ def main():
         '--no-rendering',
         action='store_true',
         help='disable rendering')
+    argparser.add_argument(
+        '--no-viewport-rendering',
+        action='store_true',
+        help='render only the sensors, not the spectator view')
     argparser.add_argument(
         '--no-sync',
         action='store_true',
@@ -208,6 +217,11 @@ def main():
     elif args.rendering:
         print('enable rendering.')
         settings.no_rendering_mode = False
+        settings.no_viewport_rendering = False
+
+    if args.no_viewport_rendering:
+        print('disable viewport rendering.')
+        settings.no_viewport_rendering = True
 
     if args.no_sync:
         print('disable synchronous mode.')
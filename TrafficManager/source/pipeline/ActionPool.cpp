@@ -0,0 +1,170 @@
+#include "ActionPool.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace traffic_manager {
+
+namespace ActionPoolConstants {
+  /// Number of chunks per worker when the grain size is chosen automatically.
+  static const uint CHUNKS_PER_WORKER = 4u;
+}
+  using namespace ActionPoolConstants;
+
+  ActionPool::ActionPool(uint number_of_workers, bool pin_workers)
+    : pin_workers(pin_workers) {
+
+    number_of_workers = std::max(number_of_workers, 1u);
+    run_pool.store(true);
+    queued_tasks.store(0u);
+    next_queue.store(0u);
+
+    for (uint i = 0u; i < number_of_workers; ++i) {
+      queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (uint i = 0u; i < number_of_workers; ++i) {
+      workers.push_back(
+          std::make_unique<std::thread>(&ActionPool::WorkerThreadManager, this, i));
+    }
+  }
+
+  ActionPool::~ActionPool() {
+
+    {
+      std::lock_guard<std::mutex> lock(idle_mutex);
+      run_pool.store(false);
+    }
+    wake_worker_notifier.notify_all();
+    for (auto &worker: workers) {
+      worker->join();
+    }
+  }
+
+  uint ActionPool::GetNumberOfWorkers() const {
+    return static_cast<uint>(workers.size());
+  }
+
+  void ActionPool::PinToCore(const uint core_id) {
+#ifdef __linux__
+    const uint core_count = std::max(std::thread::hardware_concurrency(), 1u);
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(core_id % core_count, &cpu_set);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+#else
+    (void) core_id;
+#endif
+  }
+
+  bool ActionPool::FindTask(const uint worker_id, Task &task) {
+
+    const uint number_of_queues = static_cast<uint>(queues.size());
+
+    // Owner end of the home queue first, it holds the most recently queued
+    // and therefore cache-warm chunks.
+    {
+      WorkerQueue &home = *queues.at(worker_id % number_of_queues);
+      std::lock_guard<std::mutex> lock(home.queue_mutex);
+      if (!home.tasks.empty()) {
+        task = home.tasks.back();
+        home.tasks.pop_back();
+        queued_tasks.fetch_sub(1u);
+        return true;
+      }
+    }
+
+    // Steal from the opposite end of the other queues.
+    for (uint i = 1u; i < number_of_queues; ++i) {
+      WorkerQueue &victim = *queues.at((worker_id + i) % number_of_queues);
+      std::lock_guard<std::mutex> lock(victim.queue_mutex);
+      if (!victim.tasks.empty()) {
+        task = victim.tasks.front();
+        victim.tasks.pop_front();
+        queued_tasks.fetch_sub(1u);
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void ActionPool::RunTask(const Task &task) {
+
+    (*task.job->action)(task.start_index, task.end_index);
+
+    if (task.job->pending_tasks.fetch_sub(1u) == 1u) {
+      std::lock_guard<std::mutex> lock(completion_mutex);
+      job_done_notifier.notify_all();
+    }
+  }
+
+  void ActionPool::WorkerThreadManager(const uint worker_id) {
+
+    if (pin_workers) {
+      PinToCore(worker_id);
+    }
+
+    Task task;
+    while (run_pool.load()) {
+
+      if (FindTask(worker_id, task)) {
+        RunTask(task);
+        continue;
+      }
+
+      // Park until new chunks are queued.
+      std::unique_lock<std::mutex> lock(idle_mutex);
+      while (queued_tasks.load() == 0u && run_pool.load()) {
+        wake_worker_notifier.wait_for(lock, 1ms);
+      }
+    }
+  }
+
+  void ActionPool::ParallelFor(uint number_of_elements, uint grain_size, const RangeAction &action) {
+
+    if (number_of_elements == 0u) {
+      return;
+    }
+
+    const uint number_of_queues = static_cast<uint>(queues.size());
+    if (grain_size == 0u) {
+      const uint target_chunks = number_of_queues * CHUNKS_PER_WORKER;
+      grain_size = std::max((number_of_elements + target_chunks - 1u) / target_chunks, 1u);
+    }
+    const uint number_of_tasks = (number_of_elements + grain_size - 1u) / grain_size;
+
+    Job job;
+    job.action = &action;
+    job.pending_tasks.store(number_of_tasks);
+
+    // Deal the chunks out round-robin, starting on a different queue for
+    // every submission so concurrent stages do not pile onto one worker.
+    const uint first_queue = next_queue.fetch_add(1u) % number_of_queues;
+    for (uint i = 0u; i < number_of_tasks; ++i) {
+      const uint start_index = i * grain_size;
+      const uint end_index = std::min(start_index + grain_size, number_of_elements) - 1u;
+      WorkerQueue &queue = *queues.at((first_queue + i) % number_of_queues);
+      std::lock_guard<std::mutex> lock(queue.queue_mutex);
+      queue.tasks.push_back({&job, start_index, end_index});
+    }
+    {
+      std::lock_guard<std::mutex> lock(idle_mutex);
+      queued_tasks.fetch_add(number_of_tasks);
+    }
+    wake_worker_notifier.notify_all();
+
+    // Help draining the queues until this job is complete.
+    Task task;
+    while (job.pending_tasks.load() > 0u) {
+      if (FindTask(first_queue, task)) {
+        RunTask(task);
+      } else {
+        std::unique_lock<std::mutex> lock(completion_mutex);
+        job_done_notifier.wait_for(lock, 1ms, [&] {return job.pending_tasks.load() == 0u;});
+      }
+    }
+  }
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace traffic_manager {
+
+  /// This class is a work-stealing thread pool shared by all the stages of
+  /// the pipeline. A stage splits its vehicle array into chunks and submits
+  /// them with ParallelFor(); chunks are spread over per-worker queues, each
+  /// worker drains its own queue from the back and steals from the front of
+  /// the other queues once it runs dry. The submitting thread helps executing
+  /// chunks until its own job is done, so no core is left waiting on a slow
+  /// partition.
+  class ActionPool {
+
+  public:
+
+    /// Callable processing the inclusive index range [start_index, end_index].
+    using RangeAction = std::function<void(const uint start_index, const uint end_index)>;
+
+  private:
+
+    /// Book-keeping of a single ParallelFor() call.
+    struct Job {
+      const RangeAction *action;
+      std::atomic<uint> pending_tasks;
+    };
+
+    /// A chunk of a job.
+    struct Task {
+      Job *job;
+      uint start_index;
+      uint end_index;
+    };
+
+    /// Task queue owned by a worker, other threads steal from its front.
+    struct WorkerQueue {
+      std::mutex queue_mutex;
+      std::deque<Task> tasks;
+    };
+
+    /// Whether to pin every worker to a core.
+    const bool pin_workers;
+    /// Flag to stop the workers.
+    std::atomic<bool> run_pool;
+    /// Number of tasks queued and not yet picked up.
+    std::atomic<uint> queued_tasks;
+    /// Queue on which the next submission starts distributing chunks.
+    std::atomic<uint> next_queue;
+    /// One queue per worker.
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    /// Pointers to worker thread instances.
+    std::vector<std::unique_ptr<std::thread>> workers;
+    /// Mutex and condition variable used to park idle workers.
+    std::mutex idle_mutex;
+    std::condition_variable wake_worker_notifier;
+    /// Mutex and condition variable used to wake submitters on completion.
+    std::mutex completion_mutex;
+    std::condition_variable job_done_notifier;
+
+    /// Method run by every worker.
+    void WorkerThreadManager(const uint worker_id);
+
+    /// Pops a task from the given worker's queue, stealing from the other
+    /// queues if it is empty. Returns false if no task was found.
+    bool FindTask(const uint worker_id, Task &task);
+
+    /// Runs a task and signals its job upon completion of the last chunk.
+    void RunTask(const Task &task);
+
+    /// Pins the calling thread to a core, if supported by the platform.
+    static void PinToCore(const uint core_id);
+
+  public:
+
+    /// Creates a pool with @a number_of_workers threads, optionally pinning
+    /// worker i to core i modulo the number of cores.
+    explicit ActionPool(uint number_of_workers, bool pin_workers = false);
+
+    ~ActionPool();
+
+    /// Number of worker threads in the pool.
+    uint GetNumberOfWorkers() const;
+
+    /// Runs @a action over [0, number_of_elements) in chunks of at most
+    /// @a grain_size elements and blocks until every chunk has completed. A
+    /// grain size of zero picks one giving every worker a few chunks.
+    void ParallelFor(uint number_of_elements, uint grain_size, const RangeAction &action);
+
+  };
+
+}
@@ -6,18 +6,78 @@ namespace traffic_manager {
       std::shared_ptr<PlannerToControlMessenger> messenger,
       cc::Client &carla_client,
       uint number_of_vehicles,
-      uint pool_size)
+      uint pool_size,
+      BatchControlMode mode)
     : messenger(messenger),
       carla_client(carla_client),
+      mode(mode),
+      has_pending_commands(false),
+      tick_received(false),
+      run_dispatcher(true),
+      coalesced_batches(0u),
+      on_tick_id(0u),
       PipelineStage(pool_size, number_of_vehicles) {
 
     // Initializing messenger state.
     messenger_state = messenger->GetState();
     // Allocating array for command batching.
     commands = std::make_shared<std::vector<carla::rpc::Command>>(number_of_vehicles);
+
+    if (mode == BatchControlMode::Synchronous) {
+      world = std::make_unique<cc::World>(carla_client.GetWorld());
+      on_tick_id = world->OnTick([this] (cc::WorldSnapshot) {
+        std::lock_guard<std::mutex> lock(dispatch_mutex);
+        tick_received = true;
+        dispatch_notifier.notify_one();
+      });
+    }
+    if (mode != BatchControlMode::Throttled) {
+      dispatcher = std::make_unique<std::thread>(&BatchControlStage::DispatcherThreadManager, this);
+    }
+  }
+
+  BatchControlStage::~BatchControlStage() {
+
+    if (world != nullptr) {
+      world->RemoveOnTick(on_tick_id);
+    }
+    if (dispatcher != nullptr) {
+      {
+        std::lock_guard<std::mutex> lock(dispatch_mutex);
+        run_dispatcher = false;
+      }
+      dispatch_notifier.notify_one();
+      dispatcher->join();
+    }
   }
 
-  BatchControlStage::~BatchControlStage() {}
+  uint64_t BatchControlStage::GetCoalescedBatches() {
+    std::lock_guard<std::mutex> lock(dispatch_mutex);
+    return coalesced_batches;
+  }
+
+  TimingStatistics BatchControlStage::GetApplyBatchStatistics() const {
+    return apply_timing.Get();
+  }
+
+  TimingStatistics BatchControlStage::GetControlLatencyStatistics() const {
+    return control_latency.Get();
+  }
+
+  void BatchControlStage::ApplyBatch(
+      const std::vector<carla::rpc::Command> &batch,
+      const chr::steady_clock::time_point state_time,
+      const bool wait_for_response) {
+
+    const auto start = chr::steady_clock::now();
+    if (wait_for_response) {
+      carla_client.ApplyBatchSync(batch);
+    } else {
+      carla_client.ApplyBatch(batch);
+    }
+    apply_timing.Add(TimingAccumulator::ElapsedMicroseconds(start));
+    control_latency.Add(TimingAccumulator::ElapsedMicroseconds(state_time));
+  }
 
   void BatchControlStage::Action(const uint start_index, const uint end_index) {
 
@@ -41,13 +101,76 @@ namespace traffic_manager {
     auto packet = messenger->ReceiveData(messenger_state);
     data_frame = packet.data;
     messenger_state = packet.id;
+
+    // The batch follows the vehicles registered, every command is rewritten
+    // by the actions.
+    if (data_frame->size() != commands->size()) {
+      commands->resize(data_frame->size());
+      SetNumberOfVehicles(static_cast<uint>(data_frame->size()));
+    }
   }
 
   void BatchControlStage::DataSender() {
 
-    carla_client.ApplyBatch(*commands.get());
+    const auto state_time = data_frame->empty() ?
+        chr::steady_clock::now() :
+        data_frame->front().state_time;
 
-    // Limiting updates to 100 frames per second.
-    std::this_thread::sleep_for(10ms);
+    if (mode == BatchControlMode::Throttled) {
+
+      ApplyBatch(*commands.get(), state_time, false);
+
+      // Limiting updates to 100 frames per second.
+      std::this_thread::sleep_for(10ms);
+    } else {
+
+      // Hand the batch over to the dispatcher, replacing any batch it did
+      // not get to send yet.
+      {
+        std::lock_guard<std::mutex> lock(dispatch_mutex);
+        if (has_pending_commands) {
+          ++coalesced_batches;
+        }
+        pending_commands = *commands.get();
+        pending_state_time = state_time;
+        has_pending_commands = true;
+      }
+      dispatch_notifier.notify_one();
+    }
+  }
+
+  void BatchControlStage::DispatcherThreadManager() {
+
+    const bool wait_for_tick = mode == BatchControlMode::Synchronous;
+
+    while (true) {
+
+      {
+        std::unique_lock<std::mutex> lock(dispatch_mutex);
+        dispatch_notifier.wait(lock, [=] {
+          return !run_dispatcher || (has_pending_commands && (tick_received || !wait_for_tick));
+        });
+        if (!run_dispatcher) {
+          break;
+        }
+        dispatch_commands.swap(pending_commands);
+        dispatch_state_time = pending_state_time;
+        has_pending_commands = false;
+        tick_received = false;
+      }
+
+      try {
+        if (wait_for_tick) {
+          // One fire-and-forget batch per tick, applied before the next one.
+          ApplyBatch(dispatch_commands, dispatch_state_time, false);
+        } else {
+          // Waiting for the response keeps a single batch in flight, newer
+          // batches coalesce in the meantime.
+          ApplyBatch(dispatch_commands, dispatch_state_time, true);
+        }
+      } catch (const std::exception &e) {
+        carla::log_warning("Failed to apply command batch:", e.what());
+      }
+    }
   }
 }
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include "carla/client/Client.h"
+#include "carla/client/World.h"
+#include "carla/client/WorldSnapshot.h"
 #include "carla/Logging.h"
 #include "carla/rpc/ActorId.h"
 #include "carla/rpc/Command.h"
@@ -10,11 +15,26 @@
 
 #include "MessengerAndDataTypes.h"
 #include "PipelineStage.h"
+#include "TimingStatistics.h"
 
 namespace traffic_manager {
 
 namespace cc = carla::client;
 
+  /// How the command batches are delivered to the simulator.
+  enum class BatchControlMode {
+    /// Send every batch synchronously and sleep 10 ms after it.
+    Throttled,
+    /// Hand batches to a dispatcher thread without waiting. A batch produced
+    /// while the previous one is still in flight replaces any batch waiting
+    /// to be sent.
+    Asynchronous,
+    /// Send the latest batch once per world tick, driven by the world's
+    /// on-tick callback. Meant for lock-step runs with the simulator in
+    /// synchronous mode.
+    Synchronous
+  };
+
   /// This class receives actuation signals (throttle, brake, steer)
   /// from MotionPlannerStage class and communicates these signals to
   /// the simulator in batches to control vehicles' movement.
@@ -32,6 +52,46 @@ namespace cc = carla::client;
     cc::Client &carla_client;
     /// Array to hold command batch.
     std::shared_ptr<std::vector<carla::rpc::Command>> commands;
+    /// Delivery mode of the command batches.
+    const BatchControlMode mode;
+    /// Latest batch waiting for the dispatcher.
+    std::vector<carla::rpc::Command> pending_commands;
+    /// Batch being sent by the dispatcher.
+    std::vector<carla::rpc::Command> dispatch_commands;
+    /// Capture time of the vehicle state of the pending and dispatched
+    /// batches.
+    chr::steady_clock::time_point pending_state_time;
+    chr::steady_clock::time_point dispatch_state_time;
+    /// Duration of the ApplyBatch calls.
+    TimingAccumulator apply_timing;
+    /// Time from reading the vehicle state to the return of the ApplyBatch
+    /// call carrying the controls computed from it. Every vehicle of a batch
+    /// shares the same state, so there is a sample per batch.
+    TimingAccumulator control_latency;
+    /// Flags describing the dispatcher's work, guarded by dispatch_mutex.
+    bool has_pending_commands;
+    bool tick_received;
+    bool run_dispatcher;
+    /// Number of batches replaced before being sent.
+    uint64_t coalesced_batches;
+    /// Pointer to dispatcher thread instance, unused in throttled mode.
+    std::unique_ptr<std::thread> dispatcher;
+    std::mutex dispatch_mutex;
+    std::condition_variable dispatch_notifier;
+    /// World whose ticks drive the synchronous mode.
+    std::unique_ptr<cc::World> world;
+    /// Identifier of the on-tick callback in synchronous mode.
+    size_t on_tick_id;
+
+    /// Method run by the dispatcher thread.
+    void DispatcherThreadManager();
+
+    /// Sends @a batch, synchronously if @a wait_for_response, and records its
+    /// timing.
+    void ApplyBatch(
+        const std::vector<carla::rpc::Command> &batch,
+        chr::steady_clock::time_point state_time,
+        bool wait_for_response);
 
   public:
 
@@ -39,9 +99,21 @@ namespace cc = carla::client;
         std::shared_ptr<PlannerToControlMessenger> messenger,
         cc::Client &carla_client,
         uint number_of_vehicles,
-        uint pool_size);
+        uint pool_size,
+        BatchControlMode mode = BatchControlMode::Throttled);
     ~BatchControlStage();
 
+    /// Number of batches dropped because a newer one replaced them before
+    /// they were sent.
+    uint64_t GetCoalescedBatches();
+
+    /// Returns the timing of the ApplyBatch calls so far.
+    TimingStatistics GetApplyBatchStatistics() const;
+
+    /// Returns the end-to-end control latency so far, from the capture of the
+    /// vehicle state to the apply of the controls computed from it.
+    TimingStatistics GetControlLatencyStatistics() const;
+
     void DataReceiver() override;
 
     void Action(const uint start_index, const uint end_index) override;
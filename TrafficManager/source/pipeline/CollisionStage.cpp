@@ -11,6 +11,13 @@ namespace CollisionStageConstants {
   static const float TIME_HORIZON = 0.5f;
   static const float HIGHWAY_SPEED = 50 / 3.6f;
   static const float HIGHWAY_TIME_HORIZON = 5.0f;
+  /// Band around the decision thresholds of the lane frames within which the
+  /// polygons decide, it covers the spacing of the waypoints and the offset
+  /// of the vehicles from their closest waypoint.
+  static const float LANE_FRAME_MARGIN = 2.0f;
+  static const float LATERAL_MARGIN = 0.5f;
+  /// Cosine of the largest angle between the headings of a parallel pair.
+  static const float PARALLEL_HEADING_COSINE = 0.966f;
 }
   using namespace  CollisionStageConstants;
 
@@ -20,16 +27,19 @@ namespace CollisionStageConstants {
       std::shared_ptr<CollisionToPlannerMessenger> planner_messenger,
       uint number_of_vehicle,
       uint pool_size,
+      InMemoryMap &local_map,
       cc::World &world,
       cc::DebugHelper &debug_helper)
     : localization_messenger(localization_messenger),
       planner_messenger(planner_messenger),
+      local_map(local_map),
       world(world),
       debug_helper(debug_helper),
+      isolated_update_divisor(1u),
+      ticks_to_next_check(number_of_vehicle, 0u),
+      registration(0u),
       PipelineStage(pool_size, number_of_vehicle) {
 
-    // Initializing clock for checking unregistered actors periodically.
-    last_world_actors_pass_instance = chr::system_clock::now();
     // Initializing output array selector.
     frame_selector = true;
     // Allocating output arrays to be shared with motion planner stage.
@@ -44,79 +54,92 @@ namespace CollisionStageConstants {
 
   CollisionStage::~CollisionStage() {}
 
+  void CollisionStage::SetIsolatedUpdateDivisor(uint divisor) {
+    isolated_update_divisor = std::max(divisor, 1u);
+  }
+
   void CollisionStage::Action(const uint start_index, const uint end_index) {
 
     auto current_planner_frame = frame_selector ? planner_frame_a : planner_frame_b;
-
-    // Handle vehicles not spawned by TrafficManager.
-    // Choosing an arbitrary thread.
-    if (start_index == 0u) {
-      auto current_time = chr::system_clock::now();
-      chr::duration<double> diff = current_time - last_world_actors_pass_instance;
-
-      // Periodically check for actors not spawned by TrafficManager.
-      if (diff.count() > 0.5f) {
-        auto world_actors = world.GetActors()->Filter("vehicle.*");
-        for (auto actor: *world_actors.get()) {
-          auto unregistered_id = actor->GetId();
-          if (id_to_index.find(unregistered_id) == id_to_index.end() &&
-              unregistered_actors.find(unregistered_id) == unregistered_actors.end()) {
-            unregistered_actors.insert({unregistered_id, actor});
-          }
-        }
-        last_world_actors_pass_instance = current_time;
-      }
-
-      // Regularly update unregistered actors.
-      std::vector<ActorId> actor_ids_to_erase;
-      for (auto actor_info: unregistered_actors) {
-        if (actor_info.second->IsAlive()) {
-          vicinity_grid.UpdateGrid(actor_info.second);
-        } else {
-          vicinity_grid.EraseActor(actor_info.first);
-          actor_ids_to_erase.push_back(actor_info.first);
-        }
-      }
-      for (auto actor_id: actor_ids_to_erase) {
-        unregistered_actors.erase(actor_id);
+    auto previous_planner_frame = frame_selector ? planner_frame_b : planner_frame_a;
+    const VehicleStateSnapshot &snapshot = *localization_frame->snapshot;
+
+    // Isolated vehicles waiting for their next check keep the result of the
+    // previous tick, only their position in the grid is refreshed so the
+    // other vehicles still see them.
+    std::vector<uint> partition_indices;
+    std::vector<ActorId> partition_ids;
+    std::vector<cg::Location> partition_locations;
+    uint skipped_vehicles = 0u;
+    for (uint i = start_index; i <= end_index; ++i) {
+      if (ticks_to_next_check[i] > 0u) {
+        --ticks_to_next_check[i];
+        current_planner_frame->at(i) = previous_planner_frame->at(i);
+        vicinity_grid.UpdateGrid(snapshot.ids.at(i), snapshot.locations.at(i));
+        ++skipped_vehicles;
+      } else {
+        partition_indices.push_back(i);
+        partition_ids.push_back(snapshot.ids.at(i));
+        partition_locations.push_back(snapshot.locations.at(i));
       }
     }
+    if (skipped_vehicles > 0u) {
+      AddSkippedUpdates(skipped_vehicles);
+    }
+
+    // Retrieve actors around every ego actor checked in one pass.
+    std::vector<ActorIdList> partition_vicinities =
+        vicinity_grid.GetActors(partition_ids, partition_locations);
 
     // Looping over arrays' partitions for the current thread.
-    for (uint i = start_index; i <= end_index; ++i) {
+    for (uint k = 0u; k < partition_indices.size(); ++k) {
 
-      LocalizationToCollisionData &data = localization_frame->at(i);
-      Actor ego_actor = data.actor;
-      ActorId ego_actor_id = ego_actor->GetId();
+      const uint i = partition_indices[k];
+      const CollisionVehicleState ego_state = GetRegisteredState(i);
+      const CollisionGeometry &ego_geometry = GetRegisteredGeometry(i);
 
-      // Retrieve actors around ego actor.
-      std::unordered_set<ActorId> actor_id_list = vicinity_grid.GetActors(ego_actor);
+      const ActorIdList &actor_id_list = partition_vicinities.at(k);
       bool collision_hazard = false;
 
       // Check every actor in the vicinity if it poses a collision hazard.
-      for (auto i = actor_id_list.begin(); (i != actor_id_list.end()) && !collision_hazard; ++i) {
-        ActorId actor_id = *i;
+      for (auto j = actor_id_list.begin(); (j != actor_id_list.end()) && !collision_hazard; ++j) {
+        ActorId actor_id = *j;
         try {
 
-          if (actor_id != ego_actor_id) {
+          if (actor_id != ego_state.id) {
 
-            Actor actor = nullptr;
+            CollisionVehicleState other_state;
+            const CollisionGeometry *other_geometry = nullptr;
             if (id_to_index.find(actor_id) != id_to_index.end()) {
-              actor = localization_frame->at(id_to_index.at(actor_id)).actor;
-            } else if (unregistered_actors.find(actor_id) != unregistered_actors.end()) {
-              actor = unregistered_actors.at(actor_id);
+              const uint other_index = id_to_index.at(actor_id);
+              other_state = GetRegisteredState(other_index);
+              other_geometry = &GetRegisteredGeometry(other_index);
+            } else if (unregistered_states.find(actor_id) != unregistered_states.end()) {
+              other_state = unregistered_states.at(actor_id);
+              other_geometry = &unregistered_geometries.at(actor_id);
+            } else {
+              continue;
             }
 
-            float squared_distance = cg::Math::DistanceSquared(ego_actor->GetLocation(), actor->GetLocation());
+            float squared_distance = cg::Math::DistanceSquared(ego_state.location, other_state.location);
             if (squared_distance <= SEARCH_RADIUS * SEARCH_RADIUS) {
-              if (NegotiateCollision(ego_actor, actor)) {
+              // Most pairs follow each other or drive side by side, their lane
+              // frames decide them without touching the polygons.
+              const LanePairClass lane_pair = ClassifyLanePair(
+                  ego_state, ego_geometry.lane_frame,
+                  other_state, other_geometry->lane_frame);
+              if (lane_pair == LanePairClass::Hazard) {
+                collision_hazard = true;
+              } else if (lane_pair == LanePairClass::Undecided &&
+                  NegotiateCollision(ego_state, ego_geometry, other_state, *other_geometry)) {
                 collision_hazard = true;
               }
             }
           }
         } catch (const std::exception &e) {
-          carla::log_warning("Encountered problem while determining collision \n");
-          carla::log_info("Actor might not be alive \n");
+          // Once per failed pair and tick otherwise.
+          LOG_WARNING_EVERY(1.0, "Encountered problem while determining collision,",
+              "actor might not be alive:", e.what());
         }
 
       }
@@ -124,6 +147,104 @@ namespace CollisionStageConstants {
       CollisionToPlannerData &message = current_planner_frame->at(i);
       message.hazard = collision_hazard;
 
+      // Nothing but the vehicle itself in the surrounding cells.
+      const bool isolated = std::all_of(actor_id_list.begin(), actor_id_list.end(),
+          [&ego_state] (ActorId actor_id) { return actor_id == ego_state.id; });
+      if (isolated && !collision_hazard) {
+        ticks_to_next_check[i] = isolated_update_divisor - 1u;
+      }
+    }
+  }
+
+  CollisionVehicleState CollisionStage::GetRegisteredState(uint index) const {
+
+    const VehicleStateSnapshot &snapshot = *localization_frame->snapshot;
+    CollisionVehicleState state;
+    state.id = snapshot.ids.at(index);
+    state.location = snapshot.locations.at(index);
+    state.heading = snapshot.headings.at(index);
+    state.extent = snapshot.extents.at(index);
+    state.speed = snapshot.speeds.at(index);
+    state.buffer = localization_frame->at(index).buffer;
+    return state;
+  }
+
+  const CollisionGeometry &CollisionStage::GetRegisteredGeometry(uint index) {
+
+    std::call_once(registered_geometry_flags[index], [this, index] {
+      registered_geometries.at(index) = BuildGeometry(GetRegisteredState(index));
+    });
+    return registered_geometries.at(index);
+  }
+
+  void CollisionStage::UpdateUnregisteredActors() {
+
+    // The world snapshot is kept up to date by the episode stream, reading it
+    // does not involve any call to the simulator.
+    const cc::WorldSnapshot world_snapshot = world.GetSnapshot();
+
+    // Actors which disappeared from the snapshot have been destroyed, and
+    // the ones found in the registered vehicles have been registered since.
+    for (auto it = unregistered_extents.begin(); it != unregistered_extents.end();) {
+      if (!world_snapshot.Contains(it->first)) {
+        vicinity_grid.EraseActor(it->first);
+        unregistered_states.erase(it->first);
+        unregistered_geometries.erase(it->first);
+        it = unregistered_extents.erase(it);
+      } else if (id_to_index.find(it->first) != id_to_index.end()) {
+        unregistered_states.erase(it->first);
+        unregistered_geometries.erase(it->first);
+        it = unregistered_extents.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    for (auto it = ignored_actors.begin(); it != ignored_actors.end();) {
+      if (!world_snapshot.Contains(*it)) {
+        it = ignored_actors.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    // Collect actors seen for the first time.
+    std::vector<ActorId> new_actor_ids;
+    for (const cc::ActorSnapshot &actor_snapshot: world_snapshot) {
+      const ActorId actor_id = actor_snapshot.id;
+      if (id_to_index.find(actor_id) == id_to_index.end() &&
+          unregistered_extents.find(actor_id) == unregistered_extents.end() &&
+          ignored_actors.find(actor_id) == ignored_actors.end()) {
+        new_actor_ids.push_back(actor_id);
+      }
+    }
+
+    // Resolve the type and extent of the new actors once, in a single batch.
+    if (!new_actor_ids.empty()) {
+      auto new_actors = world.GetActors(new_actor_ids);
+      for (auto actor: *new_actors.get()) {
+        if (carla::StringUtil::StartsWith(actor->GetTypeId(), "vehicle.")) {
+          auto vehicle = boost::static_pointer_cast<cc::Vehicle>(actor);
+          unregistered_extents.insert({actor->GetId(), vehicle->GetBoundingBox().extent});
+        } else {
+          ignored_actors.insert(actor->GetId());
+        }
+      }
+    }
+
+    // Refresh the state of the unregistered vehicles from the snapshot.
+    for (const auto &actor_info: unregistered_extents) {
+      const cc::ActorSnapshot actor_snapshot = *world_snapshot.Find(actor_info.first);
+
+      CollisionVehicleState state;
+      state.id = actor_info.first;
+      state.location = actor_snapshot.transform.location;
+      state.heading = HeadingFromYaw(actor_snapshot.transform.rotation.yaw);
+      state.extent = actor_info.second;
+      state.speed = actor_snapshot.velocity.Length();
+      unregistered_states[actor_info.first] = state;
+      unregistered_geometries[actor_info.first] = BuildGeometry(state);
+
+      vicinity_grid.UpdateGrid(state.id, state.location);
     }
   }
 
@@ -135,44 +256,134 @@ namespace CollisionStageConstants {
     // Connecting actor ids to their position indices on data arrays.
     // This map also provides us the additional benefit of being able to quickly identify
     // if a vehicle id is registered with the traffic manager or not.
-    uint index = 0u;
-    for (auto &element: *localization_frame.get()) {
-      id_to_index.insert({element.actor->GetId(), index++});
+    if (localization_frame->snapshot != nullptr) {
+      const std::vector<ActorId> &ids = localization_frame->snapshot->ids;
+      if (localization_frame->snapshot->registration != registration) {
+        // The registered vehicles changed, the vehicles unregistered are
+        // handled as unregistered actors from now on and every vehicle is
+        // checked on this tick.
+        registration = localization_frame->snapshot->registration;
+        const uint number_of_vehicles = static_cast<uint>(ids.size());
+        id_to_index.clear();
+        ticks_to_next_check.assign(number_of_vehicles, 0u);
+        planner_frame_a = std::make_shared<CollisionToPlannerFrame>(number_of_vehicles);
+        planner_frame_b = std::make_shared<CollisionToPlannerFrame>(number_of_vehicles);
+        SetNumberOfVehicles(number_of_vehicles);
+      }
+      for (uint index = 0u; index < ids.size(); ++index) {
+        id_to_index.insert({ids.at(index), index});
+      }
+    }
+
+    // Handle vehicles not spawned by TrafficManager. This runs before the
+    // action threads start, so they all see a consistent state.
+    UpdateUnregisteredActors();
+
+    // Invalidate the geometry and pair results of the previous tick.
+    const size_t number_of_vehicles = localization_frame->size();
+    registered_geometries.assign(number_of_vehicles, CollisionGeometry());
+    registered_geometry_flags.reset(new std::once_flag[number_of_vehicles]);
+    for (PairCacheShard &shard: pair_cache) {
+      shard.results.clear();
     }
   }
 
   void CollisionStage::DataSender() {
+    auto current_planner_frame = frame_selector ? planner_frame_a : planner_frame_b;
+    current_planner_frame->snapshot = localization_frame->snapshot;
     DataPacket<std::shared_ptr<CollisionToPlannerFrame>> packet{
       planner_messenger_state,
-      frame_selector ? planner_frame_a : planner_frame_b
+      current_planner_frame
     };
     frame_selector = !frame_selector;
     planner_messenger_state = planner_messenger->SendData(packet);
   }
 
-  bool CollisionStage::NegotiateCollision(const Actor &reference_vehicle, const Actor &other_vehicle) const {
+  LanePairClass CollisionStage::ClassifyLanePair(
+      const CollisionVehicleState &ego_vehicle,
+      const LaneFrame &ego_frame,
+      const CollisionVehicleState &other_vehicle,
+      const LaneFrame &other_frame) const {
 
-    bool hazard = false;
+    if (!ego_frame.valid || !other_frame.valid) {
+      return LanePairClass::Undecided;
+    }
+    const SimpleWaypoint &ego_waypoint = *ego_frame.waypoint;
+    const SimpleWaypoint &other_waypoint = *other_frame.waypoint;
+    if (ego_waypoint.GetRoadId() != other_waypoint.GetRoadId() ||
+        ego_waypoint.GetSectionId() != other_waypoint.GetSectionId()) {
+      return LanePairClass::Undecided;
+    }
+
+    if (ego_waypoint.GetLaneId() == other_waypoint.GetLaneId()) {
+
+      // Gap between the centers along the direction of travel, positive if
+      // the other vehicle leads.
+      const float gap = ego_waypoint.GetLaneDirection() * static_cast<float>(
+          other_waypoint.GetDistanceAlongRoad() - ego_waypoint.GetDistanceAlongRoad());
+      const float bodies_length = ego_vehicle.extent.x + other_vehicle.extent.x;
+      if (std::abs(gap) < bodies_length + LANE_FRAME_MARGIN) {
+        return LanePairClass::Undecided;
+      }
+      if (gap < 0.0f) {
+        // The leader never yields to its follower.
+        return LanePairClass::Clear;
+      }
+      const float clearance = gap - other_vehicle.extent.x - ego_frame.reach;
+      if (std::abs(clearance) < LANE_FRAME_MARGIN) {
+        return LanePairClass::Undecided;
+      }
+      return clearance < 0.0f ? LanePairClass::Hazard : LanePairClass::Clear;
+    }
 
-    float reference_height = reference_vehicle->GetLocation().z;
-    float other_height = other_vehicle->GetLocation().z;
-    if (abs(reference_height - other_height) < VERTICAL_OVERLAP_THRESHOLD) {
+    // Parallel lanes, both geodesic boundaries are strips as wide as their
+    // vehicle around their own lane.
+    const cg::Vector3D &lane_heading = ego_waypoint.GetForwardVector();
+    const float heading_cosine = std::abs(
+        lane_heading.x * other_waypoint.GetForwardVector().x +
+        lane_heading.y * other_waypoint.GetForwardVector().y);
+    if (heading_cosine < PARALLEL_HEADING_COSINE) {
+      return LanePairClass::Undecided;
+    }
+    auto lateral_distance = [&lane_heading] (const cg::Location &a, const cg::Location &b) {
+      const cg::Location offset = b - a;
+      return std::abs(lane_heading.x * offset.y - lane_heading.y * offset.x);
+    };
+    const float bodies_width = ego_vehicle.extent.y + other_vehicle.extent.y + LATERAL_MARGIN;
+    if (lateral_distance(ego_vehicle.location, other_vehicle.location) > bodies_width &&
+        lateral_distance(ego_waypoint.GetLocation(), other_waypoint.GetLocation()) > bodies_width) {
+      return LanePairClass::Clear;
+    }
+    return LanePairClass::Undecided;
+  }
+
+  bool CollisionStage::NegotiateCollision(
+      const CollisionVehicleState &reference_vehicle,
+      const CollisionGeometry &reference_geometry,
+      const CollisionVehicleState &other_vehicle,
+      const CollisionGeometry &other_geometry) {
 
-      LocationList reference_geodesic_bbox = GetGeodesicBoundary(reference_vehicle);
-      LocationList other_geodesic_bbox = GetGeodesicBoundary(other_vehicle);
+    bool hazard = false;
 
-      bool geodesic_overlap = CheckOverlap(reference_geodesic_bbox, other_geodesic_bbox);
+    float reference_height = reference_vehicle.location.z;
+    float other_height = other_vehicle.location.z;
+    if (abs(reference_height - other_height) < VERTICAL_OVERLAP_THRESHOLD &&
+        // Broad phase, geodesic boundaries can only overlap if their
+        // enclosing boxes do.
+        bg::intersects(reference_geometry.geodesic_box, other_geometry.geodesic_box)) {
 
-      Polygon reference_geodesic_polygon = GetPolygon(reference_geodesic_bbox);
-      Polygon other_geodesic_polygon = GetPolygon(other_geodesic_bbox);
-      Polygon reference_polygon = GetPolygon(GetBoundary(reference_vehicle));
-      Polygon other_polygon = GetPolygon(GetBoundary(other_vehicle));
+      const CollisionPairResult result = GetPairResult(
+          reference_vehicle, reference_geometry,
+          other_vehicle, other_geometry);
 
-      float reference_vehicle_to_other_geodesic = bg::distance(reference_polygon, other_geodesic_polygon);
-      float other_vehicle_to_reference_geodesic = bg::distance(other_polygon, reference_geodesic_polygon);
+      const bool reference_is_lower = reference_vehicle.id < other_vehicle.id;
+      const double reference_vehicle_to_other_geodesic =
+          reference_is_lower ? result.lower_to_higher_geodesic : result.higher_to_lower_geodesic;
+      const double other_vehicle_to_reference_geodesic =
+          reference_is_lower ? result.higher_to_lower_geodesic : result.lower_to_higher_geodesic;
 
       // Whichever vehicle's path is farthest away from the other vehicle gets priority to move.
-      if (geodesic_overlap &&
+      if (result.geodesic_overlap &&
           (reference_vehicle_to_other_geodesic > other_vehicle_to_reference_geodesic)) {
 
         hazard = true;
@@ -182,17 +393,49 @@ namespace CollisionStageConstants {
     return hazard;
   }
 
-  bool CollisionStage::CheckOverlap(const LocationList &boundary_a,
-                                    const LocationList &boundary_b) const {
+  CollisionPairResult CollisionStage::GetPairResult(
+      const CollisionVehicleState &vehicle_a,
+      const CollisionGeometry &geometry_a,
+      const CollisionVehicleState &vehicle_b,
+      const CollisionGeometry &geometry_b) {
+
+    const bool a_is_lower = vehicle_a.id < vehicle_b.id;
+    const CollisionGeometry &lower = a_is_lower ? geometry_a : geometry_b;
+    const CollisionGeometry &higher = a_is_lower ? geometry_b : geometry_a;
+    const uint64_t lower_id = static_cast<uint64_t>(std::min(vehicle_a.id, vehicle_b.id));
+    const uint64_t higher_id = static_cast<uint64_t>(std::max(vehicle_a.id, vehicle_b.id));
+    const uint64_t key = (lower_id << 32u) | higher_id;
+
+    PairCacheShard &shard = pair_cache[(lower_id ^ higher_id) % PAIR_CACHE_SHARDS];
+    {
+      std::lock_guard<std::mutex> lock(shard.shard_mutex);
+      auto cached = shard.results.find(key);
+      if (cached != shard.results.end()) {
+        return cached->second;
+      }
+    }
 
-    bool overlap = false;
-    if (boundary_a.size() > 0 && boundary_b.size() > 0) {
+    // Both vehicles of the pair may race here, they compute the same result.
+    CollisionPairResult result;
+    result.geodesic_overlap = CheckOverlap(lower.geodesic_boundary, higher.geodesic_boundary);
+    if (result.geodesic_overlap) {
+      result.lower_to_higher_geodesic = bg::distance(lower.boundary, higher.geodesic_boundary);
+      result.higher_to_lower_geodesic = bg::distance(higher.boundary, lower.geodesic_boundary);
+    }
 
-      Polygon reference_polygon = GetPolygon(boundary_a);
-      Polygon other_polygon = GetPolygon(boundary_b);
+    std::lock_guard<std::mutex> lock(shard.shard_mutex);
+    shard.results.insert({key, result});
+    return result;
+  }
+
+  bool CollisionStage::CheckOverlap(const Polygon &boundary_a,
+                                    const Polygon &boundary_b) const {
+
+    bool overlap = false;
+    if (!boundary_a.outer().empty() && !boundary_b.outer().empty()) {
 
       std::deque<Polygon> output;
-      bg::intersection(reference_polygon, other_polygon, output);
+      bg::intersection(boundary_a, boundary_b, output);
 
       for (uint i = 0u; i < output.size() && !overlap; ++i) {
         Polygon &p = output.at(i);
@@ -207,45 +450,84 @@ namespace CollisionStageConstants {
 
   traffic_manager::Polygon CollisionStage::GetPolygon(const LocationList &boundary) const {
 
-    std::string boundary_polygon_wkt;
-    for (const cg::Location &location: boundary) {
-      boundary_polygon_wkt += std::to_string(location.x) + " " + std::to_string(location.y) + ",";
-    }
-    boundary_polygon_wkt += std::to_string(boundary[0].x) + " " + std::to_string(boundary[0].y);
-
     traffic_manager::Polygon boundary_polygon;
-    bg::read_wkt("POLYGON((" + boundary_polygon_wkt + "))", boundary_polygon);
+    if (!boundary.empty()) {
+      for (const cg::Location &location: boundary) {
+        bg::append(boundary_polygon.outer(), Point2D(location.x, location.y));
+      }
+      // Closing the ring.
+      bg::append(boundary_polygon.outer(), Point2D(boundary[0].x, boundary[0].y));
+    }
 
     return boundary_polygon;
   }
 
-  LocationList CollisionStage::GetGeodesicBoundary(const Actor &actor) const {
+  CollisionGeometry CollisionStage::BuildGeometry(const CollisionVehicleState &vehicle) const {
+
+    CollisionGeometry geometry;
+    geometry.boundary = GetPolygon(GetBoundary(vehicle));
+    geometry.geodesic_boundary = GetPolygon(GetGeodesicBoundary(vehicle));
+    bg::envelope(geometry.geodesic_boundary, geometry.geodesic_box);
+    geometry.lane_frame = BuildLaneFrame(vehicle);
+    return geometry;
+  }
+
+  LaneFrame CollisionStage::BuildLaneFrame(const CollisionVehicleState &vehicle) const {
+
+    LaneFrame frame;
+    if (vehicle.buffer == nullptr || vehicle.buffer->empty()) {
+      return frame;
+    }
+
+    // Walking the same span of the buffer as the geodesic boundary, which has
+    // to stay on the lane of the closest waypoint.
+    const Buffer &waypoint_buffer = *vehicle.buffer;
+    const SimpleWaypoint &start = local_map.GetNode(waypoint_buffer.front());
+    const float extension = GetBoundaryExtension(vehicle.speed);
+    float reach = 0.0f;
+    for (uint i = 0u; i < waypoint_buffer.size() && reach < extension; ++i) {
+      const SimpleWaypoint &waypoint = local_map.GetNode(waypoint_buffer.at(i));
+      if (waypoint.CheckJunction() || !start.IsSameLane(waypoint)) {
+        return frame;
+      }
+      reach = start.Distance(waypoint);
+    }
+
+    frame.valid = true;
+    frame.waypoint = &start;
+    frame.reach = reach;
+    return frame;
+  }
+
+  float CollisionStage::GetBoundaryExtension(const float speed) const {
+
+    const float bbox_extension = (std::max(std::sqrt(EXTENSION_SQUARE_POINT * speed), BOUNDARY_EXTENSION_MINIMUM) +
+                                  std::max(speed * TIME_HORIZON, BOUNDARY_EXTENSION_MINIMUM) +
+                                  BOUNDARY_EXTENSION_MINIMUM);
+
+    return (speed > HIGHWAY_SPEED) ? (HIGHWAY_TIME_HORIZON * speed) : bbox_extension;
+  }
 
-    LocationList bbox = GetBoundary(actor);
+  LocationList CollisionStage::GetGeodesicBoundary(const CollisionVehicleState &vehicle) const {
 
-    if (id_to_index.find(actor->GetId()) != id_to_index.end()) {
+    LocationList bbox = GetBoundary(vehicle);
 
-      float velocity = actor->GetVelocity().Length();
-      float bbox_extension = (std::max(std::sqrt(EXTENSION_SQUARE_POINT * velocity), BOUNDARY_EXTENSION_MINIMUM) +
-                              std::max(velocity * TIME_HORIZON, BOUNDARY_EXTENSION_MINIMUM) +
-                              BOUNDARY_EXTENSION_MINIMUM);
+    if (vehicle.buffer != nullptr && !vehicle.buffer->empty()) {
 
-      bbox_extension = (velocity > HIGHWAY_SPEED) ? (HIGHWAY_TIME_HORIZON * velocity) : bbox_extension;
-      auto &waypoint_buffer =  localization_frame->at(id_to_index.at(actor->GetId())).buffer;
+      const float bbox_extension = GetBoundaryExtension(vehicle.speed);
+      const Buffer *waypoint_buffer = vehicle.buffer;
 
       LocationList left_boundary;
       LocationList right_boundary;
-      auto vehicle = boost::static_pointer_cast<cc::Vehicle>(actor);
-      float width = vehicle->GetBoundingBox().extent.y;
+      float width = vehicle.extent.y;
 
-      SimpleWaypointPtr boundary_start = waypoint_buffer->front();
-      SimpleWaypointPtr boundary_end = waypoint_buffer->front();
+      const SimpleWaypoint &boundary_start = local_map.GetNode(waypoint_buffer->front());
+      const SimpleWaypoint *boundary_end = &boundary_start;
 
-      auto vehicle_reference = boost::static_pointer_cast<cc::Vehicle>(actor);
       // At non-signalized junctions, we extend the boundary across the junction and
       // in all other situations, boundary length is velocity-dependent.
       for (uint i = 0u;
-          (boundary_start->DistanceSquared(boundary_end) < std::pow(bbox_extension, 2)) &&
+          (boundary_start.DistanceSquared(*boundary_end) < std::pow(bbox_extension, 2)) &&
           (i < waypoint_buffer->size());
           ++i) {
 
@@ -257,7 +539,7 @@ namespace CollisionStageConstants {
         cg::Vector3D scaled_perpendicular = perpendicular_vector * width;
         left_boundary.push_back(location + cg::Location(scaled_perpendicular));
         right_boundary.push_back(location + cg::Location(-1 * scaled_perpendicular));
-        boundary_end = waypoint_buffer->at(i);
+        boundary_end = &local_map.GetNode(waypoint_buffer->at(i));
       }
 
       // Connecting the geodesic path boundary with the vehicle bounding box.
@@ -278,14 +560,11 @@ namespace CollisionStageConstants {
     }
   }
 
-  LocationList CollisionStage::GetBoundary(const Actor &actor) const {
+  LocationList CollisionStage::GetBoundary(const CollisionVehicleState &vehicle) const {
 
-    auto vehicle = boost::static_pointer_cast<cc::Vehicle>(actor);
-    cg::BoundingBox bbox = vehicle->GetBoundingBox();
-    cg::Vector3D extent = bbox.extent;
-    cg::Location location = vehicle->GetLocation();
-    cg::Vector3D heading_vector = vehicle->GetTransform().GetForwardVector();
-    heading_vector.z = 0;
+    const cg::Vector3D &extent = vehicle.extent;
+    const cg::Location &location = vehicle.location;
+    const cg::Vector3D &heading_vector = vehicle.heading;
     cg::Vector3D perpendicular_vector = cg::Vector3D(-heading_vector.y, heading_vector.x, 0);
 
     // Four corners of the vehicle in top view clockwise order (left-handed
@@ -3,11 +3,15 @@
 #include <algorithm>
 #include <cmath>
 #include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "boost/geometry.hpp"
+#include "boost/geometry/geometries/box.hpp"
 #include "boost/geometry/geometries/point_xy.hpp"
 #include "boost/geometry/geometries/polygon.hpp"
 #include "boost/pointer_cast.hpp"
@@ -18,8 +22,10 @@
 #include "carla/geom/Math.h"
 #include "carla/geom/Vector3D.h"
 #include "carla/Logging.h"
+#include "carla/StringUtil.h"
 #include "carla/rpc/ActorId.h"
 
+#include "InMemoryMap.h"
 #include "MessengerAndDataTypes.h"
 #include "PipelineStage.h"
 #include "VicinityGrid.h"
@@ -33,9 +39,72 @@ namespace bg = boost::geometry;
 
   using ActorId = carla::ActorId;
   using Actor = carla::SharedPtr<cc::Actor>;
-  using Polygon = bg::model::polygon<bg::model::d2::point_xy<double>>;
+  using Point2D = bg::model::d2::point_xy<double>;
+  using Polygon = bg::model::polygon<Point2D>;
+  using Box = bg::model::box<Point2D>;
   using LocationList = std::vector<cg::Location>;
-  using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
+
+  /// State of a vehicle as seen by the collision stage, taken either from the
+  /// snapshot of registered vehicles or queried for an unregistered actor.
+  struct CollisionVehicleState {
+    ActorId id = 0u;
+    cg::Location location;
+    /// Unit heading vector on the horizontal plane.
+    cg::Vector3D heading;
+    cg::Vector3D extent;
+    float speed = 0.0f;
+    /// Waypoint buffer of the vehicle, only for registered vehicles.
+    Buffer *buffer = nullptr;
+  };
+
+  /// Position of a vehicle in the lane it is localized on, built once per
+  /// tick along with its geometry.
+  struct LaneFrame {
+    /// False if the vehicle has no waypoint buffer, or if the span of its
+    /// geodesic boundary leaves its lane or enters a junction. Only valid
+    /// frames are classified analytically.
+    bool valid = false;
+    /// Waypoint closest to the vehicle.
+    const SimpleWaypoint *waypoint = nullptr;
+    /// Length of the geodesic boundary along the lane, from the closest
+    /// waypoint.
+    float reach = 0.0f;
+  };
+
+  /// Outcome of classifying a pair of vehicles by their lane frames.
+  enum class LanePairClass {
+    /// The ego vehicle has to wait for the other vehicle.
+    Hazard,
+    /// The pair poses no hazard to the ego vehicle.
+    Clear,
+    /// The lane frames cannot tell, the polygons decide.
+    Undecided
+  };
+
+  /// Collision geometry of a vehicle, built once per tick.
+  struct CollisionGeometry {
+    /// Bounding box of the vehicle in top view.
+    Polygon boundary;
+    /// Bounding box extrapolated along the vehicle's trajectory.
+    Polygon geodesic_boundary;
+    /// Axis-aligned box enclosing the geodesic boundary, for broad-phase
+    /// culling.
+    Box geodesic_box;
+    /// Lane frame of the vehicle.
+    LaneFrame lane_frame;
+  };
+
+  /// Outcome of the narrow-phase test between two vehicles, stored for the
+  /// pair ordered by increasing actor id so both vehicles of the pair share it.
+  struct CollisionPairResult {
+    bool geodesic_overlap = false;
+    /// Distance from the lower id vehicle to the geodesic boundary of the
+    /// higher id vehicle.
+    double lower_to_higher_geodesic = 0.0;
+    /// Distance from the higher id vehicle to the geodesic boundary of the
+    /// lower id vehicle.
+    double higher_to_lower_geodesic = 0.0;
+  };
 
   /// This class is the thread executable for the collision detection stage.
   /// The class is responsible for checking possible collisions with other
@@ -44,6 +113,8 @@ namespace bg = boost::geometry;
 
   private:
 
+    /// Reference to local map-cache object.
+    InMemoryMap &local_map;
     /// Reference to Carla's world object.
     cc::World &world;
     /// Reference to Carla's debug helper object.
@@ -65,32 +136,101 @@ namespace bg = boost::geometry;
     VicinityGrid vicinity_grid;
     /// The map used to connect actor ids to the array index of data frames.
     std::unordered_map<ActorId, uint> id_to_index;
-    /// A structure used to keep track of actors spawned outside of traffic
-    /// manager.
-    std::unordered_map<ActorId, Actor> unregistered_actors;
-    /// An object used to keep track of time between checking for all world actors.
-    chr::time_point<chr::_V2::system_clock, chr::nanoseconds> last_world_actors_pass_instance;
+    /// Extent of the vehicles spawned outside of traffic manager, resolved
+    /// once when they first appear in the world snapshot.
+    std::unordered_map<ActorId, cg::Vector3D> unregistered_extents;
+    /// Ids of world actors that are not vehicles, remembered so they are
+    /// never queried again.
+    std::unordered_set<ActorId> ignored_actors;
+    /// State of the unregistered actors for the current tick.
+    std::unordered_map<ActorId, CollisionVehicleState> unregistered_states;
+    /// Geometry of the unregistered actors for the current tick.
+    std::unordered_map<ActorId, CollisionGeometry> unregistered_geometries;
+    /// Geometry of the registered vehicles for the current tick, built on
+    /// first use by whichever action thread needs it.
+    std::vector<CollisionGeometry> registered_geometries;
+    std::unique_ptr<std::once_flag[]> registered_geometry_flags;
+    /// Number of shards of the pair result cache.
+    static constexpr uint PAIR_CACHE_SHARDS = 16u;
+    /// Shard of the per-tick cache of narrow-phase results.
+    struct PairCacheShard {
+      std::mutex shard_mutex;
+      std::unordered_map<uint64_t, CollisionPairResult> results;
+    };
+    PairCacheShard pair_cache[PAIR_CACHE_SHARDS];
+    /// Number of ticks between the checks of a vehicle found isolated.
+    uint isolated_update_divisor;
+    /// Ticks left before the next check of every registered vehicle, each
+    /// entry only touched by the action thread owning its vehicle.
+    std::vector<uint> ticks_to_next_check;
+    /// Registration of the vehicles the per-vehicle state above refers to.
+    uint64_t registration;
 
     /// Returns true if there is a possible collision detected between the
     /// vehicles passed to the method.
     /// Collision is predicted by extrapolating a boundary around the vehicle
     /// along its trajectory and checking if it overlaps with the extrapolated
     /// boundary of the other vehicle.
-    bool CheckOverlap(const LocationList &boundary_a, const LocationList &boundary_b) const;
+    bool CheckOverlap(const Polygon &boundary_a, const Polygon &boundary_b) const;
 
     /// Returns the bounding box corners of the vehicle passed to the method.
-    LocationList GetBoundary(const Actor &actor) const;
+    LocationList GetBoundary(const CollisionVehicleState &vehicle) const;
+
+    /// Returns the length by which the geodesic boundary extends the bounding
+    /// box of a vehicle moving at @a speed.
+    float GetBoundaryExtension(float speed) const;
 
     /// Returns the extrapolated bounding box of the vehicle along its
     /// trajectory.
-    LocationList GetGeodesicBoundary(const Actor &actor) const;
+    LocationList GetGeodesicBoundary(const CollisionVehicleState &vehicle) const;
 
     /// Method to construct a boost polygon object.
     Polygon GetPolygon(const LocationList &boundary) const;
 
+    /// Builds the boundary polygons of the vehicle passed to the method.
+    CollisionGeometry BuildGeometry(const CollisionVehicleState &vehicle) const;
+
+    /// Builds the lane frame of the vehicle passed to the method.
+    LaneFrame BuildLaneFrame(const CollisionVehicleState &vehicle) const;
+
+    /// Decides the pair from the lane frames when both vehicles stay in their
+    /// lanes on the same lane section: a follower on the same lane has to
+    /// wait if its geodesic boundary reaches the leader, and vehicles on
+    /// parallel lanes far enough apart sideways do not interfere. Junction,
+    /// merge and lane change pairs are left undecided.
+    LanePairClass ClassifyLanePair(
+        const CollisionVehicleState &ego_vehicle,
+        const LaneFrame &ego_frame,
+        const CollisionVehicleState &other_vehicle,
+        const LaneFrame &other_frame) const;
+
     /// The method returns true if ego_vehicle should stop and wait for
     /// other_vehicle to pass.
-    bool NegotiateCollision(const Actor &ego_vehicle, const Actor &other_vehicle) const;
+    bool NegotiateCollision(
+        const CollisionVehicleState &ego_vehicle,
+        const CollisionGeometry &ego_geometry,
+        const CollisionVehicleState &other_vehicle,
+        const CollisionGeometry &other_geometry);
+
+    /// Returns the narrow-phase result of the pair, computing it if no other
+    /// thread did it yet this tick.
+    CollisionPairResult GetPairResult(
+        const CollisionVehicleState &vehicle_a,
+        const CollisionGeometry &geometry_a,
+        const CollisionVehicleState &vehicle_b,
+        const CollisionGeometry &geometry_b);
+
+    /// Returns the state of the registered vehicle at the given position of
+    /// the localization frame.
+    CollisionVehicleState GetRegisteredState(uint index) const;
+
+    /// Returns the geometry of the registered vehicle at the given position
+    /// of the localization frame.
+    const CollisionGeometry &GetRegisteredGeometry(uint index);
+
+    /// Refreshes the set of unregistered actors and their state from the
+    /// actor additions and removals of the latest world snapshot.
+    void UpdateUnregisteredActors();
 
     /// A simple method used to draw bounding boxes around vehicles
     void DrawBoundary(const LocationList &boundary) const;
@@ -102,10 +242,17 @@ namespace bg = boost::geometry;
         std::shared_ptr<CollisionToPlannerMessenger> planner_messenger,
         uint number_of_vehicle,
         uint pool_size,
+        InMemoryMap &local_map,
         cc::World &world,
         cc::DebugHelper &debug_helper);
     ~CollisionStage();
 
+    /// Checks a vehicle with no other vehicle in its vicinity and no hazard
+    /// only every @a divisor ticks, carrying its result forward in between.
+    /// 1, the default, checks every vehicle every tick. To be called before
+    /// Start().
+    void SetIsolatedUpdateDivisor(uint divisor);
+
     void DataReceiver() override;
 
     void Action(const uint start_index, const uint end_index) override;
@@ -0,0 +1,116 @@
+#include "FusedExecutor.h"
+
+#include "carla/client/TimeoutException.h"
+
+namespace traffic_manager {
+
+namespace FusedExecutorConstants {
+  /// Time waited for a world tick before checking whether to stop.
+  static const auto TICK_TIMEOUT = 100ms;
+}
+  using namespace FusedExecutorConstants;
+
+  FusedExecutor::FusedExecutor(
+      LocalizationStage &localization_stage,
+      CollisionStage &collision_stage,
+      TrafficLightStage &traffic_light_stage,
+      MotionPlannerStage &planner_stage,
+      BatchControlStage &control_stage,
+      std::shared_ptr<ActionPool> action_pool,
+      cc::World &world)
+    : localization_stage(localization_stage),
+      collision_stage(collision_stage),
+      traffic_light_stage(traffic_light_stage),
+      planner_stage(planner_stage),
+      control_stage(control_stage),
+      action_pool(action_pool),
+      world(world),
+      grain_size(0u) {
+
+    run_executor.store(false);
+  }
+
+  FusedExecutor::~FusedExecutor() {
+    Stop();
+  }
+
+  void FusedExecutor::SetGrainSize(uint grain) {
+    grain_size = grain;
+  }
+
+  void FusedExecutor::Start() {
+    run_executor.store(true);
+    executor = std::make_unique<std::thread>(&FusedExecutor::ExecutorThreadManager, this);
+  }
+
+  void FusedExecutor::Stop() {
+    run_executor.store(false);
+    if (executor != nullptr) {
+      executor->join();
+      executor.reset();
+    }
+  }
+
+  TimingStatistics FusedExecutor::GetTraversalStatistics() const {
+    return traversal_timing.Get();
+  }
+
+  void FusedExecutor::ExecutorThreadManager() {
+
+    while (run_executor.load()) {
+      try {
+        world.WaitForTick(TICK_TIMEOUT);
+      } catch (const cc::TimeoutException &) {
+        // No tick, the simulator may be paused by its client.
+        continue;
+      }
+      if (run_executor.load()) {
+        const auto start = chr::steady_clock::now();
+        RunTraversal();
+        traversal_timing.Add(TimingAccumulator::ElapsedMicroseconds(start));
+      }
+    }
+  }
+
+  void FusedExecutor::RunTraversal() {
+
+    // Every pass covers the vehicles registered with its stage, which follow
+    // the registration changes applied by the localization stage.
+    const auto run_pass = [this] (PipelineStage &stage, const ActionPool::RangeAction &action) {
+      const auto start = chr::steady_clock::now();
+      action_pool->ParallelFor(stage.number_of_vehicles, grain_size, action);
+      stage.action_timing.Add(TimingAccumulator::ElapsedMicroseconds(start));
+    };
+
+    localization_stage.DataReceiver();
+    run_pass(localization_stage, [this] (const uint start_index, const uint end_index) {
+      localization_stage.Action(start_index, end_index);
+    });
+    localization_stage.DataSender();
+
+    // Both stages read the localization of the same tick and write their own
+    // frames, so a chunk runs the two of them while its data is in cache. The
+    // pass is timed as the collision action.
+    collision_stage.DataReceiver();
+    traffic_light_stage.DataReceiver();
+    run_pass(collision_stage, [this] (const uint start_index, const uint end_index) {
+      collision_stage.Action(start_index, end_index);
+      traffic_light_stage.Action(start_index, end_index);
+    });
+    collision_stage.DataSender();
+    traffic_light_stage.DataSender();
+
+    planner_stage.DataReceiver();
+    run_pass(planner_stage, [this] (const uint start_index, const uint end_index) {
+      planner_stage.Action(start_index, end_index);
+    });
+    planner_stage.DataSender();
+
+    control_stage.DataReceiver();
+    run_pass(control_stage, [this] (const uint start_index, const uint end_index) {
+      control_stage.Action(start_index, end_index);
+    });
+    control_stage.DataSender();
+  }
+
+}
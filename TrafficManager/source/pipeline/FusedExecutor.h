@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "carla/client/World.h"
+
+#include "ActionPool.h"
+#include "BatchControlStage.h"
+#include "CollisionStage.h"
+#include "LocalizationStage.h"
+#include "MotionPlannerStage.h"
+#include "TimingStatistics.h"
+#include "TrafficLightStage.h"
+
+namespace traffic_manager {
+
+namespace cc = carla::client;
+
+  /// This class runs all the stages of the pipeline on a single thread, once
+  /// per world tick, instead of each stage on its own receiver and sender
+  /// threads. Meant for lock-step runs with the simulator in synchronous
+  /// mode, where the staged pipeline adds a hand-off and a thread wake-up per
+  /// stage to the latency of every tick.
+  ///
+  /// A traversal runs the data hand-offs of the stages in order on the
+  /// executor thread, so the messengers never block, and their Action() work
+  /// in four passes over the shared action pool: localization; collision and
+  /// traffic light together, since both only read the localization results;
+  /// motion planner; and batch control. The passes are the barriers the
+  /// double-buffered frames of the stages need, the collision pass in
+  /// particular reads the localization of every vehicle.
+  class FusedExecutor {
+
+  private:
+
+    /// Stages run by the executor, not started themselves.
+    LocalizationStage &localization_stage;
+    CollisionStage &collision_stage;
+    TrafficLightStage &traffic_light_stage;
+    MotionPlannerStage &planner_stage;
+    BatchControlStage &control_stage;
+    /// Pool executing the Action() passes.
+    std::shared_ptr<ActionPool> action_pool;
+    /// World whose ticks drive the traversals.
+    cc::World &world;
+    /// Maximum number of vehicles per chunk, zero picks it automatically.
+    uint grain_size;
+    /// Flag to start/stop the executor.
+    std::atomic<bool> run_executor;
+    /// Pointer to the executor thread instance.
+    std::unique_ptr<std::thread> executor;
+    /// Duration of the traversals, from the tick to the hand-off of the
+    /// command batch.
+    TimingAccumulator traversal_timing;
+
+    /// Method run by the executor thread.
+    void ExecutorThreadManager();
+
+    /// Runs every stage once over all the vehicles.
+    void RunTraversal();
+
+  public:
+
+    FusedExecutor(
+        LocalizationStage &localization_stage,
+        CollisionStage &collision_stage,
+        TrafficLightStage &traffic_light_stage,
+        MotionPlannerStage &planner_stage,
+        BatchControlStage &control_stage,
+        std::shared_ptr<ActionPool> action_pool,
+        cc::World &world);
+
+    ~FusedExecutor();
+
+    /// Sets the maximum number of vehicles per chunk, to be called before
+    /// Start().
+    void SetGrainSize(uint grain);
+
+    void Start();
+
+    void Stop();
+
+    /// Returns the timing of the traversals so far.
+    TimingStatistics GetTraversalStatistics() const;
+
+  };
+
+}
@@ -9,14 +9,83 @@ namespace MapConstants {
   static const uint LANE_CHANGE_LOOK_AHEAD = 5u;
   // Cosine of the angle.
   static const float LANE_CHANGE_ANGULAR_THRESHOLD = 0.5f;
+  // Number of nearest candidates examined by heading filtered queries.
+  static const uint HEADING_QUERY_CANDIDATES = 8u;
+  // Cosine of the maximum angle between query heading and waypoint direction.
+  static const float HEADING_ANGULAR_THRESHOLD = 0.0f;
+  // Identification and format version of the cache files.
+  static const char CACHE_MAGIC[4] = {'T', 'M', 'W', 'C'};
+  static const uint32_t CACHE_VERSION = 1u;
+  // Maximum distance a traffic light is propagated past its trigger volume.
+  static const float TRAFFIC_LIGHT_PROPAGATION_DISTANCE = 30.0f;
+  // Vertical tolerance of the trigger volumes, waypoints lie on the road.
+  static const float TRIGGER_VOLUME_HEIGHT_MARGIN = 2.0f;
+  // Distances along the lanes are only computed up to this length.
+  static const float MAX_PATH_DISTANCE = 200.0f;
 }
   using namespace MapConstants;
 
+  /// FNV-1a hash, stable across platforms and runs unlike std::hash.
+  static uint64_t HashOpenDrive(const std::string &content) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const char character : content) {
+      hash ^= static_cast<uint8_t>(character);
+      hash *= 0x100000001b3ull;
+    }
+    return hash;
+  }
+
+  template <typename T>
+  static void WriteValue(std::ofstream &out, const T &value) {
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  static bool ReadValue(std::ifstream &in, T &value) {
+    in.read(reinterpret_cast<char *>(&value), sizeof(T));
+    return static_cast<bool>(in);
+  }
+
   InMemoryMap::InMemoryMap(TopologyList topology) {
     _topology = topology;
   }
   InMemoryMap::~InMemoryMap() {}
 
+  NodeIndex InMemoryMap::AddWaypoint(WaypointPtr waypoint) {
+    const NodeIndex index = static_cast<NodeIndex>(dense_topology.size());
+    dense_topology.emplace_back(waypoint, index);
+    StructuredWaypoints(index);
+    return index;
+  }
+
+  void InMemoryMap::RunParallel(size_t number_of_elements, const std::function<void(size_t)> &action) {
+
+    // Exceptions cannot cross the worker threads, the first one is kept and
+    // re-thrown on the calling thread.
+    std::exception_ptr first_error;
+    std::mutex error_mutex;
+
+    ActionPool pool(std::max(std::thread::hardware_concurrency(), 1u));
+    pool.ParallelFor(
+        static_cast<uint>(number_of_elements), 0u,
+        [&] (const uint start_index, const uint end_index) {
+          try {
+            for (size_t i = start_index; i <= end_index; ++i) {
+              action(i);
+            }
+          } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (first_error == nullptr) {
+              first_error = std::current_exception();
+            }
+          }
+        });
+
+    if (first_error != nullptr) {
+      std::rethrow_exception(first_error);
+    }
+  }
+
   void InMemoryMap::SetUp(int sampling_resolution) {
 
     NodeList entry_node_list;
@@ -27,123 +96,460 @@ namespace MapConstants {
         };
     auto square = [](float input) {return std::pow(input, 2);};
 
-    // Creating dense topology.
-    for (auto &pair : _topology) {
+    // Sampling every topology segment, segments are independent of each
+    // other so they are sampled in parallel.
+    std::vector<std::vector<WaypointPtr>> segment_samples(_topology.size());
+    RunParallel(_topology.size(), [&] (size_t segment_index) {
 
       // Looping through every topology segment.
-      WaypointPtr begin_waypoint = pair.first;
-      WaypointPtr end_waypoint = pair.second;
+      WaypointPtr begin_waypoint = _topology.at(segment_index).first;
+      WaypointPtr end_waypoint = _topology.at(segment_index).second;
       cg::Location begin_location = begin_waypoint->GetTransform().location;
       cg::Location end_location = end_waypoint->GetTransform().location;
 
       if (distance_squared(begin_location, end_location) > square(ZERO_LENGTH)) {
 
+        std::vector<WaypointPtr> &samples = segment_samples.at(segment_index);
+
         // Adding entry waypoint.
         WaypointPtr current_waypoint = begin_waypoint;
-        dense_topology.push_back(std::make_shared<SimpleWaypoint>(current_waypoint));
-
-        StructuredWaypoints(dense_topology.back());
-
-        entry_node_list.push_back(dense_topology.back());
+        samples.push_back(current_waypoint);
 
         // Populating waypoints from begin_waypoint to end_waypoint.
         while (distance_squared(current_waypoint->GetTransform().location,
             end_location) > square(sampling_resolution)) {
 
           current_waypoint = current_waypoint->GetNext(sampling_resolution)[0];
-          SimpleWaypointPtr previous_wp = dense_topology.back();
-          dense_topology.push_back(std::make_shared<SimpleWaypoint>(current_waypoint));
-
-          StructuredWaypoints(dense_topology.back());
-
-          previous_wp->SetNextWaypoint({dense_topology.back()});
+          samples.push_back(current_waypoint);
         }
 
         // Adding exit waypoint.
-        SimpleWaypointPtr previous_wp = dense_topology.back();
-        dense_topology.push_back(std::make_shared<SimpleWaypoint>(end_waypoint));
+        samples.push_back(end_waypoint);
+      }
+    });
 
-        StructuredWaypoints(dense_topology.back());
+    // Creating dense topology, in segment order so the result does not
+    // depend on scheduling.
+    for (const std::vector<WaypointPtr> &samples : segment_samples) {
 
-        previous_wp->SetNextWaypoint({dense_topology.back()});
-        exit_node_list.push_back(dense_topology.back());
+      if (!samples.empty()) {
+
+        NodeIndex previous_wp = AddWaypoint(samples.front());
+        entry_node_list.push_back(previous_wp);
+
+        for (size_t k = 1u; k < samples.size(); ++k) {
+          NodeIndex current_wp = AddWaypoint(samples.at(k));
+          dense_topology.at(previous_wp).SetNextWaypoint({current_wp});
+          previous_wp = current_wp;
+        }
+        exit_node_list.push_back(previous_wp);
       }
     }
 
-    // Linking segments.
-    uint i = 0, j = 0;
-    for (SimpleWaypointPtr end_point : exit_node_list) {
-      for (SimpleWaypointPtr begin_point : entry_node_list) {
-        if (end_point->DistanceSquared(begin_point) < square(ZERO_LENGTH) and i != j) {
-          end_point->SetNextWaypoint({begin_point});
+    // Linking segments. Every exit node only updates itself, so exit nodes
+    // are processed in parallel.
+    RunParallel(exit_node_list.size(), [&] (size_t i) {
+      SimpleWaypoint &end_point = dense_topology.at(exit_node_list.at(i));
+      for (size_t j = 0u; j < entry_node_list.size(); ++j) {
+        if (end_point.DistanceSquared(dense_topology.at(entry_node_list.at(j))) < square(ZERO_LENGTH)
+            and i != j) {
+          end_point.SetNextWaypoint({entry_node_list.at(j)});
         }
-        ++j;
       }
-      ++i;
-    }
+    });
 
     // Tying up loose ends.
     // Loop through all exit nodes of topology segments,
     // connect any dangling endpoints to the nearest entry point
-    // of another topology segment.
-    i = 0;
-    for (auto &end_point : exit_node_list) {
-      if (end_point->GetNextWaypoint().size() == 0) {
-        j = 0;
+    // of another topology segment. Connections are searched in parallel
+    // without modifying the graph, then placed.
+    std::vector<NodeIndex> loose_end_connections(exit_node_list.size(), INVALID_NODE);
+    RunParallel(exit_node_list.size(), [&] (size_t i) {
+      const SimpleWaypoint &end_point = dense_topology.at(exit_node_list.at(i));
+      if (end_point.GetNextWaypoint().size() == 0) {
         float min_distance = INFINITE_DISTANCE;
-        SimpleWaypointPtr closest_connection;
-        for (auto &begin_point : entry_node_list) {
-          float new_distance = end_point->DistanceSquared(begin_point);
+        NodeIndex closest_connection = INVALID_NODE;
+        for (size_t j = 0u; j < entry_node_list.size(); ++j) {
+          float new_distance = end_point.DistanceSquared(dense_topology.at(entry_node_list.at(j)));
           if (new_distance < min_distance and i != j) {
             min_distance = new_distance;
-            closest_connection = begin_point;
+            closest_connection = entry_node_list.at(j);
           }
-          ++j;
         }
-        cg::Vector3D end_point_vector = end_point->GetForwardVector();
-        cg::Vector3D relative_vector = closest_connection->GetLocation() - end_point->GetLocation();
+        if (closest_connection == INVALID_NODE) {
+          return;
+        }
+        cg::Vector3D end_point_vector = end_point.GetForwardVector();
+        cg::Vector3D relative_vector =
+            dense_topology.at(closest_connection).GetLocation() - end_point.GetLocation();
         relative_vector = relative_vector.MakeUnitVector();
         float relative_dot = cg::Math::Dot(end_point_vector, relative_vector);
         if (relative_dot < LANE_CHANGE_ANGULAR_THRESHOLD) {
           uint count = LANE_CHANGE_LOOK_AHEAD;
-          while (count > 0) {
-            closest_connection = closest_connection->GetNextWaypoint()[0];
+          while (count > 0 && !dense_topology.at(closest_connection).GetNextWaypoint().empty()) {
+            closest_connection = dense_topology.at(closest_connection).GetNextWaypoint()[0];
             --count;
           }
         }
-        end_point->SetNextWaypoint({closest_connection});
+        loose_end_connections.at(i) = closest_connection;
       }
-      ++i;
+    });
+    for (size_t i = 0u; i < exit_node_list.size(); ++i) {
+      if (loose_end_connections.at(i) != INVALID_NODE) {
+        dense_topology.at(exit_node_list.at(i)).SetNextWaypoint({loose_end_connections.at(i)});
+      }
+    }
+
+    // Linking lane change connections, each waypoint only updates itself.
+    RunParallel(dense_topology.size(), [this] (size_t index) {
+      FindAndLinkLaneChange(static_cast<NodeIndex>(index));
+    });
+
+    // Building the spatial index for closest waypoint queries.
+    BuildIndex();
+    ComputePathDistances();
+  }
+
+  std::string InMemoryMap::GetCacheFileName(const cc::Map &world_map, int sampling_resolution) {
+    char hash_string[17];
+    std::snprintf(hash_string, sizeof(hash_string), "%016llx",
+        static_cast<unsigned long long>(HashOpenDrive(world_map.GetOpenDrive())));
+    return "traffic_manager_map_" + std::string(hash_string) + "_" +
+        std::to_string(sampling_resolution) + ".bin";
+  }
+
+  bool InMemoryMap::Save(
+      const std::string &file_path,
+      const cc::Map &world_map,
+      int sampling_resolution) const {
+
+    std::ofstream out(file_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      return false;
     }
 
-    // Linking lane change connections.
-    for (auto &simple_waypoint:dense_topology) {
-      FindAndLinkLaneChange(simple_waypoint);
+    out.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    WriteValue(out, CACHE_VERSION);
+    WriteValue(out, HashOpenDrive(world_map.GetOpenDrive()));
+    WriteValue(out, static_cast<int32_t>(sampling_resolution));
+    WriteValue(out, static_cast<uint32_t>(dense_topology.size()));
+
+    // Waypoints are stored by their road coordinates, links by index.
+    for (const SimpleWaypoint &simple_waypoint : dense_topology) {
+      WaypointPtr waypoint = simple_waypoint.GetWaypoint();
+      WriteValue(out, static_cast<uint32_t>(waypoint->GetRoadId()));
+      WriteValue(out, static_cast<uint32_t>(waypoint->GetSectionId()));
+      WriteValue(out, static_cast<int32_t>(waypoint->GetLaneId()));
+      WriteValue(out, static_cast<double>(waypoint->GetDistance()));
+      WriteValue(out, simple_waypoint.GetLeftWaypoint());
+      WriteValue(out, simple_waypoint.GetRightWaypoint());
+      const NextNodeList &next_waypoints = simple_waypoint.GetNextWaypoint();
+      WriteValue(out, static_cast<uint32_t>(next_waypoints.size()));
+      for (NodeIndex next_waypoint : next_waypoints) {
+        WriteValue(out, next_waypoint);
+      }
     }
 
+    return static_cast<bool>(out);
   }
 
-  SimpleWaypointPtr InMemoryMap::GetWaypoint(const cg::Location &location) const {
+  bool InMemoryMap::Load(
+      const std::string &file_path,
+      const cc::Map &world_map,
+      int sampling_resolution) {
+
+    dense_topology.clear();
+    road_to_waypoint.clear();
+    waypoint_index.clear();
 
-    SimpleWaypointPtr closest_waypoint;
+    std::ifstream in(file_path, std::ios::binary);
+    if (!in) {
+      return false;
+    }
+
+    char magic[sizeof(CACHE_MAGIC)];
+    uint32_t version = 0u;
+    uint64_t hash = 0u;
+    int32_t resolution = 0;
+    uint32_t number_of_waypoints = 0u;
+    in.read(magic, sizeof(magic));
+    if (!in || !std::equal(magic, magic + sizeof(magic), CACHE_MAGIC) ||
+        !ReadValue(in, version) || version != CACHE_VERSION ||
+        !ReadValue(in, hash) || hash != HashOpenDrive(world_map.GetOpenDrive()) ||
+        !ReadValue(in, resolution) || resolution != sampling_resolution ||
+        !ReadValue(in, number_of_waypoints)) {
+      return false;
+    }
+
+    struct WaypointLinks {
+      NodeIndex left;
+      NodeIndex right;
+      std::vector<NodeIndex> next;
+    };
+    std::vector<WaypointLinks> links(number_of_waypoints);
+
+    auto valid_link = [=](NodeIndex index) {
+      return index == INVALID_NODE || index < number_of_waypoints;
+    };
+
+    bool valid = true;
+    dense_topology.reserve(number_of_waypoints);
+    for (uint32_t i = 0u; i < number_of_waypoints && valid; ++i) {
+      carla::road::element::Waypoint raw_waypoint;
+      uint32_t road_id = 0u;
+      uint32_t section_id = 0u;
+      int32_t lane_id = 0;
+      uint32_t number_of_next = 0u;
+      WaypointLinks &waypoint_links = links.at(i);
+      valid = ReadValue(in, road_id) && ReadValue(in, section_id) &&
+              ReadValue(in, lane_id) && ReadValue(in, raw_waypoint.s) &&
+              ReadValue(in, waypoint_links.left) && ReadValue(in, waypoint_links.right) &&
+              ReadValue(in, number_of_next) &&
+              valid_link(waypoint_links.left) && valid_link(waypoint_links.right);
+      for (uint32_t k = 0u; k < number_of_next && valid; ++k) {
+        NodeIndex next_waypoint = INVALID_NODE;
+        valid = ReadValue(in, next_waypoint) && next_waypoint < number_of_waypoints;
+        waypoint_links.next.push_back(next_waypoint);
+      }
+      if (valid) {
+        raw_waypoint.road_id = road_id;
+        raw_waypoint.section_id = section_id;
+        raw_waypoint.lane_id = lane_id;
+        AddWaypoint(world_map.MakeWaypoint(raw_waypoint));
+      }
+    }
+
+    try {
+      for (uint32_t i = 0u; i < number_of_waypoints && valid; ++i) {
+        SimpleWaypoint &simple_waypoint = dense_topology.at(i);
+        const WaypointLinks &waypoint_links = links.at(i);
+        simple_waypoint.SetNextWaypoint(waypoint_links.next);
+        if (waypoint_links.left != INVALID_NODE) {
+          simple_waypoint.SetLeftWaypoint(dense_topology.at(waypoint_links.left));
+        }
+        if (waypoint_links.right != INVALID_NODE) {
+          simple_waypoint.SetRightWaypoint(dense_topology.at(waypoint_links.right));
+        }
+      }
+    } catch (const std::exception &) {
+      valid = false;
+    }
+
+    if (!valid) {
+      dense_topology.clear();
+      road_to_waypoint.clear();
+      return false;
+    }
+
+    BuildIndex();
+    ComputePathDistances();
+    return true;
+  }
+
+  void InMemoryMap::BuildIndex() {
+
+    std::vector<IndexEntry> entries;
+    entries.reserve(dense_topology.size());
+    for (NodeIndex i = 0u; i < dense_topology.size(); ++i) {
+      const cg::Location &location = dense_topology.at(i).GetLocation();
+      entries.emplace_back(IndexPoint(location.x, location.y, location.z), i);
+    }
+    // The range constructor uses bulk loading (packing), which produces a
+    // better balanced tree than inserting the entries one by one.
+    waypoint_index = WaypointIndex(entries.begin(), entries.end());
+  }
+
+  void InMemoryMap::ComputePathDistances() {
+
+    const size_t number_of_waypoints = dense_topology.size();
+
+    // Reversing the links, distances propagate from the targets backwards.
+    std::vector<std::vector<NodeIndex>> previous_waypoints(number_of_waypoints);
+    for (NodeIndex i = 0u; i < number_of_waypoints; ++i) {
+      for (NodeIndex next_waypoint: dense_topology.at(i).GetNextWaypoint()) {
+        previous_waypoints.at(next_waypoint).push_back(i);
+      }
+    }
+
+    // Multi-source Dijkstra over the reversed links from every target.
+    auto distances_to = [&](const std::function<bool(const SimpleWaypoint &)> &is_target) {
+      using QueueEntry = std::pair<float, NodeIndex>;
+      std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+      std::vector<float> distances(number_of_waypoints, std::numeric_limits<float>::infinity());
+      for (NodeIndex i = 0u; i < number_of_waypoints; ++i) {
+        if (is_target(dense_topology.at(i))) {
+          distances.at(i) = 0.0f;
+          queue.emplace(0.0f, i);
+        }
+      }
+      while (!queue.empty()) {
+        const QueueEntry entry = queue.top();
+        queue.pop();
+        if (entry.first > distances.at(entry.second)) {
+          continue;
+        }
+        const SimpleWaypoint &target = dense_topology.at(entry.second);
+        for (NodeIndex previous_waypoint: previous_waypoints.at(entry.second)) {
+          const float distance = entry.first + target.Distance(dense_topology.at(previous_waypoint));
+          if (distance < distances.at(previous_waypoint) && distance <= MAX_PATH_DISTANCE) {
+            distances.at(previous_waypoint) = distance;
+            queue.emplace(distance, previous_waypoint);
+          }
+        }
+      }
+      return distances;
+    };
+
+    const std::vector<float> junction_distances = distances_to([](const SimpleWaypoint &waypoint) {
+      return waypoint.CheckJunction();
+    });
+    const std::vector<float> branch_distances = distances_to([](const SimpleWaypoint &waypoint) {
+      return waypoint.GetNextWaypoint().size() > 1u;
+    });
+    for (NodeIndex i = 0u; i < number_of_waypoints; ++i) {
+      dense_topology.at(i).SetPathDistances(junction_distances.at(i), branch_distances.at(i));
+    }
+  }
+
+  NodeIndex InMemoryMap::GetWaypoint(const cg::Location &location) const {
+
+    NodeIndex closest_waypoint = INVALID_NODE;
+    std::vector<IndexEntry> result;
+    IndexPoint query_point(location.x, location.y, location.z);
+    waypoint_index.query(bgi::nearest(query_point, 1u), std::back_inserter(result));
+    if (!result.empty()) {
+      closest_waypoint = result.front().second;
+    }
+    return closest_waypoint;
+  }
+
+  NodeIndex InMemoryMap::GetWaypoint(
+      const cg::Location &location,
+      const cg::Vector3D &heading) const {
+
+    std::vector<IndexEntry> result;
+    IndexPoint query_point(location.x, location.y, location.z);
+    waypoint_index.query(
+        bgi::nearest(query_point, HEADING_QUERY_CANDIDATES),
+        std::back_inserter(result));
+
+    // Picking the closest candidate agreeing with the heading.
+    NodeIndex closest_waypoint = INVALID_NODE;
+    NodeIndex closest_aligned_waypoint = INVALID_NODE;
     float min_distance = INFINITE_DISTANCE;
-    for (auto &simple_waypoint : dense_topology) {
-      float current_distance = simple_waypoint->DistanceSquared(location);
+    float min_aligned_distance = INFINITE_DISTANCE;
+    for (const IndexEntry &entry : result) {
+      const SimpleWaypoint &candidate = dense_topology.at(entry.second);
+      float current_distance = candidate.DistanceSquared(location);
       if (current_distance < min_distance) {
         min_distance = current_distance;
-        closest_waypoint = simple_waypoint;
+        closest_waypoint = entry.second;
+      }
+      if (current_distance < min_aligned_distance &&
+          cg::Math::Dot(candidate.GetForwardVector(), heading) > HEADING_ANGULAR_THRESHOLD) {
+        min_aligned_distance = current_distance;
+        closest_aligned_waypoint = entry.second;
+      }
+    }
+    return closest_aligned_waypoint != INVALID_NODE ? closest_aligned_waypoint : closest_waypoint;
+  }
+
+  NodeList InMemoryMap::GetWaypoints(const std::vector<cg::Location> &locations) const {
+
+    NodeList waypoints;
+    waypoints.reserve(locations.size());
+    for (const cg::Location &location : locations) {
+      waypoints.push_back(GetWaypoint(location));
+    }
+    return waypoints;
+  }
+
+  NodeList InMemoryMap::GetWaypoints(
+      const std::vector<cg::Location> &locations,
+      const std::vector<cg::Vector3D> &headings) const {
+
+    NodeList waypoints;
+    waypoints.reserve(locations.size());
+    for (uint i = 0u; i < locations.size(); ++i) {
+      waypoints.push_back(GetWaypoint(locations.at(i), headings.at(i)));
+    }
+    return waypoints;
+  }
+
+  void InMemoryMap::LinkTrafficLights(const std::vector<TrafficLightPtr> &traffic_lights) {
+
+    traffic_light_ids.clear();
+    for (SimpleWaypoint &simple_waypoint: dense_topology) {
+      simple_waypoint.SetTrafficLight(INVALID_TRAFFIC_LIGHT);
+    }
+
+    for (const TrafficLightPtr &traffic_light: traffic_lights) {
+
+      const TrafficLightIndex light = static_cast<TrafficLightIndex>(traffic_light_ids.size());
+      traffic_light_ids.push_back(traffic_light->GetId());
+
+      // The trigger volume is relative to the traffic light and aligned with
+      // its yaw.
+      const cg::Transform transform = traffic_light->GetTransform();
+      const carla::geom::BoundingBox &volume = traffic_light->GetTriggerVolume();
+      cg::Location center = volume.location;
+      transform.TransformPoint(center);
+      const float yaw = carla::geom::Math::ToRadians(transform.rotation.yaw);
+      const float cos_yaw = std::cos(yaw);
+      const float sin_yaw = std::sin(yaw);
+      const float radius = volume.extent.Length();
+
+      std::vector<IndexEntry> candidates;
+      waypoint_index.query(
+          bgi::intersects(IndexBox(
+              IndexPoint(center.x - radius, center.y - radius, center.z - radius),
+              IndexPoint(center.x + radius, center.y + radius, center.z + radius))),
+          std::back_inserter(candidates));
+
+      std::vector<NodeIndex> frontier;
+      for (const IndexEntry &candidate: candidates) {
+        const SimpleWaypoint &simple_waypoint = dense_topology.at(candidate.second);
+        const cg::Vector3D offset = simple_waypoint.GetLocation() - center;
+        const float local_x = offset.x * cos_yaw + offset.y * sin_yaw;
+        const float local_y = -offset.x * sin_yaw + offset.y * cos_yaw;
+        if (!simple_waypoint.CheckJunction() &&
+            std::abs(local_x) <= volume.extent.x &&
+            std::abs(local_y) <= volume.extent.y &&
+            std::abs(offset.z) <= volume.extent.z + TRIGGER_VOLUME_HEIGHT_MARGIN) {
+          frontier.push_back(candidate.second);
+        }
+      }
+
+      // Following the lanes from the trigger volume up to the junction, so
+      // vehicles past the volume still see the light.
+      for (NodeIndex start: frontier) {
+        NodeIndex current = start;
+        float distance = 0.0f;
+        while (current != INVALID_NODE && distance < TRAFFIC_LIGHT_PROPAGATION_DISTANCE) {
+          SimpleWaypoint &simple_waypoint = dense_topology.at(current);
+          if (simple_waypoint.CheckJunction() ||
+              (current != start && simple_waypoint.GetTrafficLight() == light)) {
+            break;
+          }
+          simple_waypoint.SetTrafficLight(light);
+          const NextNodeList &next_waypoints = simple_waypoint.GetNextWaypoint();
+          if (next_waypoints.size() != 1u) {
+            break;
+          }
+          distance += simple_waypoint.Distance(dense_topology.at(next_waypoints.front()));
+          current = next_waypoints.front();
+        }
       }
     }
-    return closest_waypoint;
   }
 
-  std::vector<SimpleWaypointPtr> InMemoryMap::GetDenseTopology() const {
+  const WaypointArena &InMemoryMap::GetDenseTopology() const {
     return dense_topology;
   }
 
-  void InMemoryMap::StructuredWaypoints(SimpleWaypointPtr waypoint) {
+  void InMemoryMap::StructuredWaypoints(NodeIndex waypoint) {
 
-    WaypointPtr current_waypoint = waypoint->GetWaypoint();
+    WaypointPtr current_waypoint = dense_topology.at(waypoint).GetWaypoint();
     uint section_id = current_waypoint->GetSectionId();
     uint road_id = current_waypoint->GetRoadId();
     int lane_id = current_waypoint->GetLaneId();
@@ -164,14 +570,14 @@ namespace MapConstants {
         } else {
 
           // Create a new list to hold waypoints for the lane.
-          std::vector<SimpleWaypointPtr> lane_waypoint_list;
+          NodeList lane_waypoint_list;
           lane_waypoint_list.push_back(waypoint);
           // Insert the new list into the lane map.
           lane_map.insert({lane_id, lane_waypoint_list});
         }
       } else {
 
-        std::vector<SimpleWaypointPtr> lane_waypoint_list;
+        NodeList lane_waypoint_list;
         lane_waypoint_list.push_back(waypoint);
         // Create a new lane map to hold the waypoint list.
         LaneWaypointMap lane_map;
@@ -182,7 +588,7 @@ namespace MapConstants {
       }
     } else {
 
-      std::vector<SimpleWaypointPtr> lane_waypoint_list;
+      NodeList lane_waypoint_list;
       lane_waypoint_list.push_back(waypoint);
       LaneWaypointMap lane_map;
       lane_map.insert({lane_id, lane_waypoint_list});
@@ -195,7 +601,7 @@ namespace MapConstants {
   }
 
   void InMemoryMap::LinkLaneChangePoint(
-      SimpleWaypointPtr reference_waypoint,
+      NodeIndex reference_index,
       WaypointPtr neighbor_waypoint,
       int side) {
 
@@ -206,42 +612,49 @@ namespace MapConstants {
 
       // Find waypoint samples in dense topology corresponding to the
       // geo ids of the neighbor waypoint found using Carla's server call.
-      if (road_to_waypoint.find(neighbour_road_id) != road_to_waypoint.end() &&
-          (road_to_waypoint[neighbour_road_id].find(neighbour_section_id)
-          != road_to_waypoint[neighbour_road_id].end()) &&
-          (road_to_waypoint[neighbour_road_id][neighbour_section_id].find(neighbour_lane_id)
-          != road_to_waypoint[neighbour_road_id][neighbour_section_id].end())) {
+      // Only const lookups here, this runs concurrently for many waypoints.
+      auto road_entry = road_to_waypoint.find(neighbour_road_id);
+      if (road_entry == road_to_waypoint.end()) {
+        return;
+      }
+      auto section_entry = road_entry->second.find(neighbour_section_id);
+      if (section_entry == road_entry->second.end()) {
+        return;
+      }
+      auto lane_entry = section_entry->second.find(neighbour_lane_id);
+      if (lane_entry != section_entry->second.end()) {
 
-        std::vector<SimpleWaypointPtr> waypoints_to_left =
-            road_to_waypoint[neighbour_road_id][neighbour_section_id][neighbour_lane_id];
+        const NodeList &waypoints_to_left = lane_entry->second;
+        SimpleWaypoint &reference_waypoint = dense_topology.at(reference_index);
 
         // Find the nearest sample to the neighbor waypoint to be used as a
         // local cache representative to be linked for indicating a lane change
         // connection.
         if (waypoints_to_left.size() > 0) {
-          SimpleWaypointPtr nearest_waypoint = waypoints_to_left[0];
+          NodeIndex nearest_waypoint = waypoints_to_left[0];
           float smallest_left_distance = INFINITE_DISTANCE;
-          for (SimpleWaypointPtr &left_wp : waypoints_to_left) {
-            if (reference_waypoint->DistanceSquared(left_wp) < smallest_left_distance) {
-              smallest_left_distance = reference_waypoint->DistanceSquared(left_wp);
+          for (NodeIndex left_wp : waypoints_to_left) {
+            float left_distance = reference_waypoint.DistanceSquared(dense_topology.at(left_wp));
+            if (left_distance < smallest_left_distance) {
+              smallest_left_distance = left_distance;
               nearest_waypoint = left_wp;
             }
           }
 
           // Place appropriate lane change link.
           if (side < 0) {
-            reference_waypoint->SetLeftWaypoint(nearest_waypoint);
+            reference_waypoint.SetLeftWaypoint(dense_topology.at(nearest_waypoint));
           } else if (side > 0) {
-            reference_waypoint->SetRightWaypoint(nearest_waypoint);
+            reference_waypoint.SetRightWaypoint(dense_topology.at(nearest_waypoint));
           }
         }
       }
     }
   }
 
-  void InMemoryMap::FindAndLinkLaneChange(SimpleWaypointPtr reference_waypoint) {
+  void InMemoryMap::FindAndLinkLaneChange(NodeIndex reference_waypoint) {
 
-    WaypointPtr raw_waypoint = reference_waypoint->GetWaypoint();
+    WaypointPtr raw_waypoint = dense_topology.at(reference_waypoint).GetWaypoint();
     uint8_t lane_change = static_cast<uint8_t>(raw_waypoint->GetLaneChange());
     uint8_t change_right = static_cast<uint8_t>(carla::road::element::LaneMarking::LaneChange::Right);
     uint8_t change_left = static_cast<uint8_t>(carla::road::element::LaneMarking::LaneChange::Left);
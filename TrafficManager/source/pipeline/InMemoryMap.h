@@ -1,30 +1,57 @@
 #pragma once
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <functional>
 #include <limits>
 #include <memory>
+#include <mutex>
+#include <queue>
 #include <string>
 #include <unordered_map>
-
+#include <utility>
+#include <vector>
+
+#include "boost/geometry.hpp"
+#include "boost/geometry/geometries/point.hpp"
+#include "boost/geometry/index/rtree.hpp"
+#include "carla/client/Map.h"
+#include "carla/client/TrafficLight.h"
 #include "carla/client/Waypoint.h"
 #include "carla/geom/Location.h"
 #include "carla/geom/Math.h"
 #include "carla/Memory.h"
+#include "carla/rpc/ActorId.h"
 
+#include "ActionPool.h"
 #include "SimpleWaypoint.h"
 
 namespace traffic_manager {
 
 namespace cg = carla::geom;
 namespace cc = carla::client;
+namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
 
   using WaypointPtr = carla::SharedPtr<cc::Waypoint>;
   using TopologyList = std::vector<std::pair<WaypointPtr, WaypointPtr>>;
-  using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
-  using NodeList = std::vector<SimpleWaypointPtr>;
+  /// Contiguous storage of the waypoints of the local map.
+  using WaypointArena = std::vector<SimpleWaypoint>;
+  using NodeList = std::vector<NodeIndex>;
   using LaneWaypointMap = std::unordered_map<int, NodeList>;
   using SectionWaypointMap = std::unordered_map<uint, LaneWaypointMap>;
   using RoadWaypointMap = std::unordered_map<uint, SectionWaypointMap>;
+  using IndexPoint = bg::model::point<float, 3, bg::cs::cartesian>;
+  /// Entry of the spatial index, a location paired with the position of the
+  /// waypoint in the dense topology.
+  using IndexEntry = std::pair<IndexPoint, NodeIndex>;
+  using WaypointIndex = bgi::rtree<IndexEntry, bgi::rstar<16>>;
+  using IndexBox = bg::model::box<IndexPoint>;
+  using TrafficLightPtr = carla::SharedPtr<cc::TrafficLight>;
 
   /// This class builds a discretized local map-cache.
   /// Instantiate the class with map topology from the simulator
@@ -36,19 +63,40 @@ namespace cc = carla::client;
     /// Object to hold sparse topology received by the constructor.
     TopologyList _topology;
     /// Structure to hold all custom waypoint objects after
-    /// interpolation of sparse topology.
-    NodeList dense_topology;
+    /// interpolation of sparse topology, links between waypoints are
+    /// positions in this array.
+    WaypointArena dense_topology;
     /// Structure to segregate waypoints according to their geo ids.
     RoadWaypointMap road_to_waypoint;
+    /// Spatial index over the dense topology, built at the end of SetUp().
+    WaypointIndex waypoint_index;
+    /// Ids of the traffic lights linked to the waypoints, in the order of
+    /// their TrafficLightIndex.
+    std::vector<carla::ActorId> traffic_light_ids;
+
+    /// This method appends a waypoint to the dense topology and returns its
+    /// index.
+    NodeIndex AddWaypoint(WaypointPtr waypoint);
 
     /// This method is used to segregate and place waypoints into RoadWaypointMap.
-    void StructuredWaypoints(SimpleWaypointPtr waypoint);
+    void StructuredWaypoints(NodeIndex waypoint);
 
     /// This method is used to place a lane change link between waypoints
-    void LinkLaneChangePoint(SimpleWaypointPtr reference_waypoint, WaypointPtr neighbor_waypoint, int side);
+    void LinkLaneChangePoint(NodeIndex reference_waypoint, WaypointPtr neighbor_waypoint, int side);
 
     /// This method is used to find and place lane change links.
-    void FindAndLinkLaneChange(SimpleWaypointPtr reference_waypoint);
+    void FindAndLinkLaneChange(NodeIndex reference_waypoint);
+
+    /// This method builds the spatial index over the dense topology.
+    void BuildIndex();
+
+    /// This method computes the distances along the lanes from every waypoint
+    /// to the closest junction and branching waypoints ahead.
+    void ComputePathDistances();
+
+    /// Runs @a action for every index in [0, number_of_elements) on a
+    /// temporary pool and re-throws the first exception raised, if any.
+    static void RunParallel(size_t number_of_elements, const std::function<void(size_t)> &action);
 
   public:
 
@@ -58,11 +106,60 @@ namespace cc = carla::client;
     /// This method constructs the local map with a resolution of sampling_resolution.
     void SetUp(int sampling_resolution);
 
-    /// This method returns the closest waypoint to a given location on the map.
-    SimpleWaypointPtr GetWaypoint(const cg::Location &location) const;
+    /// This method writes the local map built by SetUp() into a binary cache
+    /// file, keyed on the OpenDRIVE content of @a world_map and the sampling
+    /// resolution. Returns false if the file could not be written.
+    bool Save(const std::string &file_path, const cc::Map &world_map, int sampling_resolution) const;
+
+    /// This method replaces the local map with the one stored in a cache file
+    /// written by Save(). Returns false, leaving the local map empty, if the
+    /// file is missing, corrupt, or was built for a different OpenDRIVE
+    /// content or sampling resolution.
+    bool Load(const std::string &file_path, const cc::Map &world_map, int sampling_resolution);
+
+    /// This method returns a cache file name unique to the OpenDRIVE content
+    /// of @a world_map and the sampling resolution.
+    static std::string GetCacheFileName(const cc::Map &world_map, int sampling_resolution);
+
+    /// This method returns the waypoint at the given index of the dense
+    /// topology.
+    const SimpleWaypoint &GetNode(NodeIndex index) const {
+      return dense_topology[index];
+    }
+
+    /// This method returns the index of the closest waypoint to a given
+    /// location on the map, INVALID_NODE if the map is empty.
+    NodeIndex GetWaypoint(const cg::Location &location) const;
+
+    /// This method returns the index of the closest waypoint to a given
+    /// location whose direction agrees with the given heading, falling back to
+    /// the closest waypoint if none of the nearby candidates does.
+    NodeIndex GetWaypoint(const cg::Location &location, const cg::Vector3D &heading) const;
+
+    /// Batch version of GetWaypoint, returns the closest waypoint for every
+    /// location in the same order.
+    NodeList GetWaypoints(const std::vector<cg::Location> &locations) const;
+
+    /// Batch version of the heading filtered GetWaypoint, @a headings must be
+    /// of the same size as @a locations.
+    NodeList GetWaypoints(
+        const std::vector<cg::Location> &locations,
+        const std::vector<cg::Vector3D> &headings) const;
+
+    /// This method links every waypoint inside the trigger volume of each of
+    /// @a traffic_lights, and the waypoints following it up to the junction,
+    /// to that light. Traffic lights are not part of the cache files, call
+    /// this after SetUp() or Load().
+    void LinkTrafficLights(const std::vector<TrafficLightPtr> &traffic_lights);
+
+    /// This method returns the ids of the linked traffic lights, indexed by
+    /// SimpleWaypoint::GetTrafficLight().
+    const std::vector<carla::ActorId> &GetTrafficLightIds() const {
+      return traffic_light_ids;
+    }
 
     /// This method returns the full list of discrete samples of the map in the local cache.
-    NodeList GetDenseTopology() const;
+    const WaypointArena &GetDenseTopology() const;
 
   };
 
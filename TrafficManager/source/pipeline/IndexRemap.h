@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "carla/rpc/ActorId.h"
+
+namespace traffic_manager {
+
+  /// Position in the previous registration of every vehicle of a new one,
+  /// NEW_VEHICLE for the vehicles registered since.
+  using IndexRemap = std::vector<uint>;
+  /// Index standing in for a vehicle missing from the previous registration.
+  static constexpr uint NEW_VEHICLE = std::numeric_limits<uint>::max();
+
+  /// Returns the remap from the vehicles @a previous_ids to @a ids.
+  inline IndexRemap MakeIndexRemap(
+      const std::vector<carla::ActorId> &previous_ids,
+      const std::vector<carla::ActorId> &ids) {
+
+    std::unordered_map<carla::ActorId, uint> previous_index;
+    previous_index.reserve(previous_ids.size());
+    for (uint i = 0u; i < previous_ids.size(); ++i) {
+      previous_index.insert({previous_ids[i], i});
+    }
+    IndexRemap remap(ids.size(), NEW_VEHICLE);
+    for (uint i = 0u; i < ids.size(); ++i) {
+      auto it = previous_index.find(ids[i]);
+      if (it != previous_index.end()) {
+        remap[i] = it->second;
+      }
+    }
+    return remap;
+  }
+
+  /// Moves the entries of a per-vehicle @a array to their positions in the
+  /// new registration, the vehicles registered since get @a initial.
+  template <typename T>
+  void RemapVehicleArray(std::vector<T> &array, const IndexRemap &remap, const T &initial = T()) {
+    std::vector<T> remapped;
+    remapped.reserve(remap.size());
+    for (uint previous: remap) {
+      remapped.push_back(previous < array.size() ? T(array[previous]) : initial);
+    }
+    array.swap(remapped);
+  }
+
+}
@@ -12,6 +12,29 @@ namespace LocalizationConstants {
 }
   using namespace LocalizationConstants;
 
+  /// Moves @a position to the first waypoint of @a buffer at least @a distance
+  /// away from its front, or to its last waypoint if there is none. Moving
+  /// from the previous tick's position only takes a few steps.
+  static uint MoveCursor(
+      const Buffer &buffer,
+      const InMemoryMap &local_map,
+      uint position,
+      float distance) {
+
+    const SimpleWaypoint &front = local_map.GetNode(buffer.front());
+    const float squared_distance = distance * distance;
+    position = std::min(position, static_cast<uint>(buffer.size() - 1u));
+    while (position + 1u < buffer.size() &&
+           front.DistanceSquared(local_map.GetNode(buffer[position])) < squared_distance) {
+      ++position;
+    }
+    while (position > 0u &&
+           front.DistanceSquared(local_map.GetNode(buffer[position - 1u])) >= squared_distance) {
+      --position;
+    }
+    return position;
+  }
+
   LocalizationStage::LocalizationStage(
       std::shared_ptr<LocalizationToPlannerMessenger> planner_messenger,
       std::shared_ptr<LocalizationToCollisionMessenger> collision_messenger,
@@ -20,13 +43,18 @@ namespace LocalizationConstants {
       uint pool_size,
       std::vector<Actor> &actor_list,
       InMemoryMap &local_map,
+      cc::World &world,
       cc::DebugHelper &debug_helper)
     : planner_messenger(planner_messenger),
       collision_messenger(collision_messenger),
       traffic_light_messenger(traffic_light_messenger),
       actor_list(actor_list),
       local_map(local_map),
+      world(world),
       debug_helper(debug_helper),
+      traffic_distributor(number_of_vehicles),
+      buffer_refill_threshold(1.0f),
+      registration(0u),
       PipelineStage(pool_size, number_of_vehicles) {
 
     // Initializing various output frame selectors.
@@ -36,6 +64,8 @@ namespace LocalizationConstants {
     // Allocating the buffer lists.
     buffer_list_a = std::make_shared<BufferList>(number_of_vehicles);
     buffer_list_b = std::make_shared<BufferList>(number_of_vehicles);
+    cursor_list_a.resize(number_of_vehicles);
+    cursor_list_b.resize(number_of_vehicles);
     // Allocating output frames to be shared with the motion planner stage.
     planner_frame_a = std::make_shared<LocalizationToPlannerFrame>(number_of_vehicles);
     planner_frame_b = std::make_shared<LocalizationToPlannerFrame>(number_of_vehicles);
@@ -51,16 +81,135 @@ namespace LocalizationConstants {
     collision_messenger_state = collision_messenger->GetState() - 1;
     traffic_light_messenger_state = traffic_light_messenger->GetState() - 1;
 
-    // Connecting vehicle ids to their position indices on data arrays.
-    uint index = 0u;
-    for (auto &actor: actor_list) {
-      vehicle_id_to_index.insert({actor->GetId(), index});
-      ++index;
+    // Caching vehicle dimensions and initializing the state snapshot.
+    snapshot = std::make_shared<VehicleStateSnapshot>(number_of_vehicles);
+    for (uint i = 0u; i < actor_list.size(); ++i) {
+      auto vehicle = boost::static_pointer_cast<cc::Vehicle>(actor_list.at(i));
+      vehicle_extents.push_back(vehicle->GetBoundingBox().extent);
+      snapshot->ids.at(i) = actor_list.at(i)->GetId();
     }
   }
 
   LocalizationStage::~LocalizationStage() {}
 
+  void LocalizationStage::SetBufferRefillThreshold(float threshold) {
+    buffer_refill_threshold = std::min(std::max(threshold, 0.0f), 1.0f);
+  }
+
+  void LocalizationStage::RegisterVehicles(const std::vector<Actor> &vehicles) {
+    vehicle_registry.Register(vehicles);
+  }
+
+  void LocalizationStage::UnregisterVehicles(const std::vector<ActorId> &vehicle_ids) {
+    vehicle_registry.Unregister(vehicle_ids);
+  }
+
+  void LocalizationStage::ApplyRegistrationChanges(const cc::WorldSnapshot &world_snapshot) {
+
+    const bool changed = vehicle_registry.Apply(actor_list, [&world_snapshot] (ActorId actor_id) {
+      return world_snapshot.Contains(actor_id);
+    });
+    if (!changed) {
+      return;
+    }
+
+    // The previous snapshot lists the vehicles of the previous registration.
+    std::vector<ActorId> ids;
+    ids.reserve(actor_list.size());
+    for (const Actor &actor: actor_list) {
+      ids.push_back(actor->GetId());
+    }
+    const IndexRemap remap = MakeIndexRemap(snapshot->ids, ids);
+    const uint number_of_vehicles = static_cast<uint>(actor_list.size());
+
+    RemapVehicleArray(vehicle_extents, remap);
+    for (uint i = 0u; i < number_of_vehicles; ++i) {
+      if (remap[i] == NEW_VEHICLE) {
+        auto vehicle = boost::static_pointer_cast<cc::Vehicle>(actor_list[i]);
+        vehicle_extents[i] = vehicle->GetBoundingBox().extent;
+      }
+    }
+
+    // Downstream stages may still be reading the frames, buffers and snapshot
+    // of the previous registration, so they are replaced rather than resized.
+    auto remapped_snapshot = std::make_shared<VehicleStateSnapshot>(*snapshot);
+    remapped_snapshot->Remap(remap);
+    snapshot = remapped_snapshot;
+    buffer_list_a = std::make_shared<BufferList>(*buffer_list_a);
+    buffer_list_b = std::make_shared<BufferList>(*buffer_list_b);
+    RemapVehicleArray(*buffer_list_a, remap);
+    RemapVehicleArray(*buffer_list_b, remap);
+    RemapVehicleArray(cursor_list_a, remap);
+    RemapVehicleArray(cursor_list_b, remap);
+    traffic_distributor.Remap(remap);
+
+    planner_frame_a = std::make_shared<LocalizationToPlannerFrame>(number_of_vehicles);
+    planner_frame_b = std::make_shared<LocalizationToPlannerFrame>(number_of_vehicles);
+    collision_frame_a = std::make_shared<LocalizationToCollisionFrame>(number_of_vehicles);
+    collision_frame_b = std::make_shared<LocalizationToCollisionFrame>(number_of_vehicles);
+    traffic_light_frame_a = std::make_shared<LocalizationToTrafficLightFrame>(number_of_vehicles);
+    traffic_light_frame_b = std::make_shared<LocalizationToTrafficLightFrame>(number_of_vehicles);
+
+    ++registration;
+    SetNumberOfVehicles(number_of_vehicles);
+  }
+
+  void LocalizationStage::UpdateSnapshot(const cc::WorldSnapshot &world_snapshot) {
+
+    // A new snapshot is allocated every tick since downstream stages may still
+    // be reading the previous one.
+    auto previous_snapshot = snapshot;
+    snapshot = std::make_shared<VehicleStateSnapshot>(actor_list.size());
+    snapshot->registration = registration;
+    snapshot->capture_time = std::chrono::steady_clock::now();
+    snapshot->elapsed_seconds = world_snapshot.GetTimestamp().elapsed_seconds;
+    snapshot->delta_seconds = world_snapshot.GetTimestamp().delta_seconds;
+
+    for (uint i = 0u; i < actor_list.size(); ++i) {
+
+      ActorId actor_id = actor_list.at(i)->GetId();
+      snapshot->ids.at(i) = actor_id;
+      snapshot->extents.at(i) = vehicle_extents.at(i);
+
+      auto actor_snapshot = world_snapshot.Find(actor_id);
+      if (!actor_snapshot.has_value()) {
+        // Keep the last known state of vehicles missing in this frame.
+        snapshot->locations.at(i) = previous_snapshot->locations.at(i);
+        snapshot->velocities.at(i) = previous_snapshot->velocities.at(i);
+        snapshot->speeds.at(i) = previous_snapshot->speeds.at(i);
+        snapshot->yaws.at(i) = previous_snapshot->yaws.at(i);
+        snapshot->headings.at(i) = previous_snapshot->headings.at(i);
+        snapshot->speed_limits.at(i) = previous_snapshot->speed_limits.at(i);
+        snapshot->traffic_light_states.at(i) = previous_snapshot->traffic_light_states.at(i);
+        snapshot->at_traffic_light.at(i) = previous_snapshot->at_traffic_light.at(i);
+        continue;
+      }
+
+      const auto &vehicle_data = actor_snapshot->state.vehicle_data;
+      snapshot->locations.at(i) = actor_snapshot->transform.location;
+      snapshot->velocities.at(i) = actor_snapshot->velocity;
+      snapshot->speeds.at(i) = actor_snapshot->velocity.Length();
+      snapshot->yaws.at(i) = actor_snapshot->transform.rotation.yaw;
+      snapshot->headings.at(i) = HeadingFromYaw(actor_snapshot->transform.rotation.yaw);
+      snapshot->speed_limits.at(i) = vehicle_data.speed_limit;
+      snapshot->traffic_light_states.at(i) = vehicle_data.traffic_light_state;
+      snapshot->at_traffic_light.at(i) = vehicle_data.has_traffic_light;
+    }
+
+    // Caching the state of the traffic lights once per tick, so the vehicles
+    // approaching the same light share a single lookup.
+    const std::vector<ActorId> &traffic_light_ids = local_map.GetTrafficLightIds();
+    snapshot->light_states.resize(traffic_light_ids.size(), carla::rpc::TrafficLightState::Unknown);
+    for (uint k = 0u; k < traffic_light_ids.size(); ++k) {
+      auto light_snapshot = world_snapshot.Find(traffic_light_ids[k]);
+      if (light_snapshot.has_value()) {
+        snapshot->light_states[k] = light_snapshot->state.traffic_light_data.state;
+      } else if (k < previous_snapshot->light_states.size()) {
+        snapshot->light_states[k] = previous_snapshot->light_states[k];
+      }
+    }
+  }
+
   void LocalizationStage::Action(const uint start_index, const uint end_index) {
 
     // Selecting output frames based on selector keys.
@@ -70,15 +219,17 @@ namespace LocalizationConstants {
         traffic_light_frame_selector ? traffic_light_frame_a : traffic_light_frame_b;
     auto current_buffer_list = collision_frame_selector ? buffer_list_a : buffer_list_b;
     auto copy_buffer_list = !collision_frame_selector ? buffer_list_a : buffer_list_b;
+    CursorList &cursor_list = collision_frame_selector ? cursor_list_a : cursor_list_b;
+
+    const VehicleStateSnapshot &state = *snapshot;
+    uint skipped_refills = 0u;
 
     // Looping over arrays' partitions for the current thread.
     for (uint i = start_index; i <= end_index; ++i) {
 
-      Actor vehicle = actor_list.at(i);
-      ActorId actor_id = vehicle->GetId();
-
-      cg::Location vehicle_location = vehicle->GetLocation();
-      float vehicle_velocity = vehicle->GetVelocity().Length();
+      const cg::Location &vehicle_location = state.locations.at(i);
+      const cg::Vector3D &vehicle_heading = state.headings.at(i);
+      float vehicle_velocity = state.speeds.at(i);
 
       float horizon_size = std::max(
           WAYPOINT_TIME_HORIZON * vehicle_velocity,
@@ -86,97 +237,110 @@ namespace LocalizationConstants {
 
       Buffer &waypoint_buffer = current_buffer_list->at(i);
       Buffer &copy_waypoint_buffer = copy_buffer_list->at(i);
+      BufferCursor &cursor = cursor_list[i];
 
       // Synchronizing buffer copies in case the path of the vehicle has changed.
       if (!waypoint_buffer.empty() && !copy_waypoint_buffer.empty() &&
-          ((copy_waypoint_buffer.front()->GetWaypoint()->GetLaneId()
-          != waypoint_buffer.front()->GetWaypoint()->GetLaneId()) ||
-          (copy_waypoint_buffer.front()->GetWaypoint()->GetSectionId()
-          != waypoint_buffer.front()->GetWaypoint()->GetSectionId()) ||
-          (copy_waypoint_buffer.front()->GetWaypoint()->GetRoadId()
-          != waypoint_buffer.front()->GetWaypoint()->GetRoadId()))) {
+          ((local_map.GetNode(copy_waypoint_buffer.front()).GetWaypoint()->GetLaneId()
+          != local_map.GetNode(waypoint_buffer.front()).GetWaypoint()->GetLaneId()) ||
+          (local_map.GetNode(copy_waypoint_buffer.front()).GetWaypoint()->GetSectionId()
+          != local_map.GetNode(waypoint_buffer.front()).GetWaypoint()->GetSectionId()) ||
+          (local_map.GetNode(copy_waypoint_buffer.front()).GetWaypoint()->GetRoadId()
+          != local_map.GetNode(waypoint_buffer.front()).GetWaypoint()->GetRoadId()))) {
 
         waypoint_buffer.clear();
         waypoint_buffer.assign(copy_waypoint_buffer.begin(), copy_waypoint_buffer.end());
+        cursor = BufferCursor();
       }
 
       // Purge passed waypoints.
       if (!waypoint_buffer.empty()) {
 
-        float dot_product = DeviationDotProduct(vehicle, waypoint_buffer.front()->GetLocation());
+        float dot_product = DeviationDotProduct(
+            vehicle_location,
+            vehicle_heading,
+            local_map.GetNode(waypoint_buffer.front()).GetLocation());
 
         while (dot_product <= 0 && !waypoint_buffer.empty()) {
           waypoint_buffer.pop_front();
+          cursor.target = cursor.target > 0u ? cursor.target - 1u : 0u;
+          cursor.look_ahead = cursor.look_ahead > 0u ? cursor.look_ahead - 1u : 0u;
           if (!waypoint_buffer.empty()) {
-            dot_product = DeviationDotProduct(vehicle, waypoint_buffer.front()->GetLocation());
+            dot_product = DeviationDotProduct(
+                vehicle_location,
+                vehicle_heading,
+                local_map.GetNode(waypoint_buffer.front()).GetLocation());
           }
         }
       }
 
       // Initializing buffer if it is empty.
       if (waypoint_buffer.empty()) {
-        SimpleWaypointPtr closest_waypoint = local_map.GetWaypoint(vehicle_location);
+        NodeIndex closest_waypoint = local_map.GetWaypoint(vehicle_location);
         waypoint_buffer.push_back(closest_waypoint);
+        cursor = BufferCursor();
       }
 
       // Assign a lane change.
-      SimpleWaypointPtr front_waypoint = waypoint_buffer.front();
+      const NodeIndex front_index = waypoint_buffer.front();
+      const SimpleWaypoint &front_waypoint = local_map.GetNode(front_index);
       GeoIds current_road_ids = {
-        front_waypoint->GetWaypoint()->GetRoadId(),
-        front_waypoint->GetWaypoint()->GetSectionId(),
-        front_waypoint->GetWaypoint()->GetLaneId()
+        front_waypoint.GetWaypoint()->GetRoadId(),
+        front_waypoint.GetWaypoint()->GetSectionId(),
+        front_waypoint.GetWaypoint()->GetLaneId()
       };
 
       traffic_distributor.UpdateVehicleRoadPosition(
-          actor_id,
-          current_road_ids);
-
-      if (!front_waypoint->CheckJunction()) {
-        SimpleWaypointPtr change_over_point = traffic_distributor.AssignLaneChange(
-            vehicle,
-            front_waypoint,
+          i,
+          current_road_ids,
+          front_waypoint);
+
+      if (!front_waypoint.CheckJunction()) {
+        NodeIndex change_over_point = traffic_distributor.AssignLaneChange(
+            i,
+            state,
+            local_map,
+            front_index,
             current_road_ids,
-            current_buffer_list,
-            vehicle_id_to_index,
-            actor_list,
             debug_helper);
 
-        if (change_over_point != nullptr) {
+        if (change_over_point != INVALID_NODE) {
           waypoint_buffer.clear();
           waypoint_buffer.push_back(change_over_point);
+          cursor = BufferCursor();
         }
       }
 
-      // Populating the buffer.
-      while (waypoint_buffer.back()->DistanceSquared(waypoint_buffer.front())
-             <= std::pow(horizon_size, 2)) {
-
-        uint pre_selection_id = waypoint_buffer.back()->GetWaypoint()->GetId();
-        std::vector<SimpleWaypointPtr> next_waypoints = waypoint_buffer.back()->GetNextWaypoint();
+      // Populating the buffer, once it has fallen below the refill threshold.
+      const float buffer_length_squared =
+          local_map.GetNode(waypoint_buffer.back()).DistanceSquared(local_map.GetNode(waypoint_buffer.front()));
+      if (buffer_length_squared > std::pow(buffer_refill_threshold * horizon_size, 2)) {
+        ++skipped_refills;
+      } else {
+        while (local_map.GetNode(waypoint_buffer.back()).DistanceSquared(local_map.GetNode(waypoint_buffer.front()))
+               <= std::pow(horizon_size, 2)) {
+
+          const NextNodeList &next_waypoints = local_map.GetNode(waypoint_buffer.back()).GetNextWaypoint();
+
+          uint selection_index = 0u;
+          // Pseudo-randomized path selection if found more than one choice.
+          if (next_waypoints.size() > 1) {
+            selection_index = rand() % next_waypoints.size();
+          }
 
-        uint selection_index = 0u;
-        // Pseudo-randomized path selection if found more than one choice.
-        if (next_waypoints.size() > 1) {
-          selection_index = rand() % next_waypoints.size();
+          waypoint_buffer.push_back(next_waypoints.at(selection_index));
         }
-
-        waypoint_buffer.push_back(next_waypoints.at(selection_index));
       }
 
       // Generating output.
       float target_point_distance = std::max(std::ceil(vehicle_velocity * TARGET_WAYPOINT_TIME_HORIZON),
                                              TARGET_WAYPOINT_HORIZON_LENGTH);
-      SimpleWaypointPtr target_waypoint = waypoint_buffer.front();
-      for (uint i = 0u;
-          (i < waypoint_buffer.size()) &&
-          (waypoint_buffer.front()->DistanceSquared(target_waypoint)
-          < std::pow(target_point_distance, 2));
-          ++i) {
-        target_waypoint = waypoint_buffer.at(i);
-      }
+      const SimpleWaypoint &buffer_front = local_map.GetNode(waypoint_buffer.front());
+      cursor.target = MoveCursor(waypoint_buffer, local_map, cursor.target, target_point_distance);
+      const SimpleWaypoint *target_waypoint = &local_map.GetNode(waypoint_buffer[cursor.target]);
       cg::Location target_location = target_waypoint->GetLocation();
-      float dot_product = DeviationDotProduct(vehicle, target_location);
-      float cross_product = DeviationCrossProduct(vehicle, target_location);
+      float dot_product = DeviationDotProduct(vehicle_location, vehicle_heading, target_location);
+      float cross_product = DeviationCrossProduct(vehicle_location, vehicle_heading, target_location);
       dot_product = 1 - dot_product;
       if (cross_product < 0) {
         dot_product *= -1;
@@ -185,30 +349,19 @@ namespace LocalizationConstants {
       // Filtering out false junctions on highways.
       // On highways, if there is only one possible path and the section is
       // marked as intersection, ignore it.
-      auto vehicle_reference = boost::static_pointer_cast<cc::Vehicle>(vehicle);
-      float speed_limit = vehicle_reference->GetSpeedLimit();
+      float speed_limit = state.speed_limits.at(i);
       float look_ahead_distance = std::max(2 * vehicle_velocity, MINIMUM_JUNCTION_LOOK_AHEAD);
 
-      SimpleWaypointPtr look_ahead_point = waypoint_buffer.front();
-      uint look_ahead_index = 0u;
-      for (uint i = 0u;
-          (waypoint_buffer.front()->DistanceSquared(look_ahead_point)
-          < std::pow(look_ahead_distance, 2)) &&
-          (i < waypoint_buffer.size());
-          ++i) {
-        look_ahead_point = waypoint_buffer.at(i);
-        look_ahead_index = i;
-      }
+      cursor.look_ahead = MoveCursor(waypoint_buffer, local_map, cursor.look_ahead, look_ahead_distance);
+      const SimpleWaypoint *look_ahead_point = &local_map.GetNode(waypoint_buffer[cursor.look_ahead]);
 
+      // The distances along the lanes precomputed by the local map tell
+      // whether the road forks before the junction.
       bool approaching_junction = false;
-      if (look_ahead_point->CheckJunction() && !(waypoint_buffer.front()->CheckJunction())) {
+      if (look_ahead_point->CheckJunction() && !(buffer_front.CheckJunction())) {
         if (speed_limit > HIGHWAY_SPEED) {
-          for (uint i = 0u; (i < look_ahead_index) && !approaching_junction; ++i) {
-            SimpleWaypointPtr swp = waypoint_buffer.at(i);
-            if (swp->GetNextWaypoint().size() > 1) {
-              approaching_junction = true;
-            }
-          }
+          approaching_junction =
+              buffer_front.GetDistanceToBranch() <= buffer_front.GetDistanceToJunction();
         } else {
           approaching_junction = true;
         }
@@ -216,22 +369,30 @@ namespace LocalizationConstants {
 
       // Editing output frames.
       LocalizationToPlannerData &planner_message = current_planner_frame->at(i);
-      planner_message.actor = vehicle;
       planner_message.deviation = dot_product;
       planner_message.approaching_true_junction = approaching_junction;
 
       LocalizationToCollisionData &collision_message = current_collision_frame->at(i);
-      collision_message.actor = vehicle;
       collision_message.buffer = &waypoint_buffer;
 
       LocalizationToTrafficLightData &traffic_light_message = current_traffic_light_frame->at(i);
-      traffic_light_message.actor = vehicle;
       traffic_light_message.closest_waypoint = waypoint_buffer.front();
-      traffic_light_message.junction_look_ahead_waypoint = waypoint_buffer.at(look_ahead_index);
+      traffic_light_message.junction_look_ahead_waypoint = waypoint_buffer[cursor.look_ahead];
+    }
+
+    if (skipped_refills > 0u) {
+      AddSkippedUpdates(skipped_refills);
     }
   }
 
-  void LocalizationStage::DataReceiver() {}
+  void LocalizationStage::DataReceiver() {
+    cc::WorldSnapshot world_snapshot = world.GetSnapshot();
+    ApplyRegistrationChanges(world_snapshot);
+    UpdateSnapshot(world_snapshot);
+    // The lanes are read-only while the actions run, they see the positions
+    // recorded on the previous tick.
+    traffic_distributor.RebuildLanes();
+  }
 
   void LocalizationStage::DataSender() {
 
@@ -240,9 +401,11 @@ namespace LocalizationConstants {
     // which takes the most priority (which needs the highest rate of data feed)
     // to run the system well.
 
+    auto current_planner_frame = planner_frame_selector ? planner_frame_a : planner_frame_b;
+    current_planner_frame->snapshot = snapshot;
     DataPacket<std::shared_ptr<LocalizationToPlannerFrame>> planner_data_packet = {
       planner_messenger_state,
-      planner_frame_selector ? planner_frame_a : planner_frame_b
+      current_planner_frame
     };
     planner_frame_selector = !planner_frame_selector;
     planner_messenger_state = planner_messenger->SendData(planner_data_packet);
@@ -251,9 +414,12 @@ namespace LocalizationConstants {
     // processing, received the previous message and started processing it.
     int collision_messenger_current_state = collision_messenger->GetState();
     if (collision_messenger_current_state != collision_messenger_state) {
+      auto current_collision_frame = collision_frame_selector ? collision_frame_a : collision_frame_b;
+      current_collision_frame->snapshot = snapshot;
+      current_collision_frame->buffer_list = collision_frame_selector ? buffer_list_a : buffer_list_b;
       DataPacket<std::shared_ptr<LocalizationToCollisionFrame>> collision_data_packet = {
         collision_messenger_state,
-        collision_frame_selector ? collision_frame_a : collision_frame_b
+        current_collision_frame
       };
 
       collision_messenger_state = collision_messenger->SendData(collision_data_packet);
@@ -264,9 +430,12 @@ namespace LocalizationConstants {
     // processing, received the previous message and started processing it.
     int traffic_light_messenger_current_state = traffic_light_messenger->GetState();
     if (traffic_light_messenger_current_state != traffic_light_messenger_state) {
+      auto current_traffic_light_frame =
+          traffic_light_frame_selector ? traffic_light_frame_a : traffic_light_frame_b;
+      current_traffic_light_frame->snapshot = snapshot;
       DataPacket<std::shared_ptr<LocalizationToTrafficLightFrame>> traffic_light_data_packet = {
         traffic_light_messenger_state,
-        traffic_light_frame_selector ? traffic_light_frame_a : traffic_light_frame_b
+        current_traffic_light_frame
       };
 
       traffic_light_messenger_state = traffic_light_messenger->SendData(traffic_light_data_packet);
@@ -277,7 +446,7 @@ namespace LocalizationConstants {
   void LocalizationStage::DrawBuffer(Buffer &buffer) {
 
     for (int i = 0; i < buffer.size() && i < 5; ++i) {
-      debug_helper.DrawPoint(buffer.at(i)->GetLocation(), 0.1f, {255u, 0u, 0u}, 0.5f);
+      debug_helper.DrawPoint(local_map.GetNode(buffer.at(i)).GetLocation(), 0.1f, {255u, 0u, 0u}, 0.5f);
     }
   }
 }
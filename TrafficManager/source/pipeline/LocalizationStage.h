@@ -9,6 +9,7 @@
 
 #include "carla/client/Actor.h"
 #include "carla/client/Vehicle.h"
+#include "carla/client/World.h"
 #include "carla/geom/Location.h"
 #include "carla/geom/Math.h"
 #include "carla/geom/Transform.h"
@@ -16,17 +17,28 @@
 #include "carla/Memory.h"
 #include "carla/rpc/ActorId.h"
 
+#include "IndexRemap.h"
 #include "InMemoryMap.h"
 #include "MessengerAndDataTypes.h"
 #include "PipelineStage.h"
 #include "SimpleWaypoint.h"
 #include "TrafficDistributor.h"
+#include "VehicleRegistry.h"
 
 namespace traffic_manager {
 
 namespace cc = carla::client;
   using Actor = carla::SharedPtr<cc::Actor>;
 
+  /// Positions in a vehicle's waypoint buffer of the target and junction
+  /// look-ahead waypoints found on the previous tick. They move by a few
+  /// entries per tick, so the next search starts there.
+  struct BufferCursor {
+    uint target = 0u;
+    uint look_ahead = 0u;
+  };
+  using CursorList = std::vector<BufferCursor>;
+
   /// This class is responsible for maintaining a horizon of waypoints ahead
   /// of the vehicle for it to follow.
   /// The class is also responsible for managing lane change decisions and
@@ -35,6 +47,8 @@ namespace cc = carla::client;
 
   private:
 
+    /// Reference to Carla's world object.
+    cc::World &world;
     /// Reference to Carla's debug helper object.
     cc::DebugHelper &debug_helper;
     /// Variables to remember messenger states.
@@ -66,13 +80,36 @@ namespace cc = carla::client;
     /// These are shared with the collisions stage.
     std::shared_ptr<BufferList> buffer_list_a;
     std::shared_ptr<BufferList> buffer_list_b;
+    /// Cursors into the buffers of buffer_list_a and buffer_list_b.
+    CursorList cursor_list_a;
+    CursorList cursor_list_b;
     /// Object used to keep track of vehicles according to their map position,
     /// determine and execute lane changes.
     TrafficDistributor traffic_distributor;
-    /// Map connecting actor ids to indices of data arrays.
-    std::unordered_map<carla::ActorId, uint> vehicle_id_to_index;
-    /// Reference to list of all the actors registered with the traffic manager.
-    std::vector<Actor> &actor_list;
+    /// List of all the actors registered with the traffic manager, starting
+    /// with the ones the pipeline was built with.
+    std::vector<Actor> actor_list;
+    /// Vehicles registered and unregistered since the pipeline started,
+    /// applied to actor_list at the start of a tick.
+    VehicleRegistry vehicle_registry;
+    /// Number of registration changes applied so far.
+    uint64_t registration;
+    /// Bounding box extents of the registered vehicles, these do not change
+    /// during the lifetime of an actor.
+    std::vector<cg::Vector3D> vehicle_extents;
+    /// State of the registered vehicles for the current tick.
+    std::shared_ptr<VehicleStateSnapshot> snapshot;
+    /// Fraction of the horizon below which a waypoint buffer is refilled.
+    float buffer_refill_threshold;
+
+    /// Applies the pending registration changes to actor_list and moves the
+    /// per-vehicle state of the stage to the new positions of the vehicles.
+    /// Vehicles are only registered once they appear in @a world_snapshot.
+    void ApplyRegistrationChanges(const cc::WorldSnapshot &world_snapshot);
+
+    /// Builds the vehicle state snapshot for the current tick from the
+    /// episode state.
+    void UpdateSnapshot(const cc::WorldSnapshot &world_snapshot);
 
     /// A simple method used to draw waypoint buffer ahead of a vehicle.
     void DrawBuffer(Buffer &buffer);
@@ -87,10 +124,25 @@ namespace cc = carla::client;
         uint pool_size,
         std::vector<Actor> &actor_list,
         InMemoryMap &local_map,
+        cc::World &world,
         cc::DebugHelper &debug_helper);
 
     ~LocalizationStage();
 
+    /// Refills the waypoint buffer of a vehicle up to its horizon only once
+    /// it spans less than @a threshold times the horizon, instead of topping
+    /// it up every tick. 1, the default, refills every tick. To be called
+    /// before Start().
+    void SetBufferRefillThreshold(float threshold);
+
+    /// Registers @a vehicles with the running pipeline from the next tick in
+    /// which they appear in the world snapshot. Safe to call from any thread.
+    void RegisterVehicles(const std::vector<Actor> &vehicles);
+
+    /// Unregisters the vehicles @a vehicle_ids from the next tick on, they
+    /// are left with the last control applied. Safe to call from any thread.
+    void UnregisterVehicles(const std::vector<ActorId> &vehicle_ids);
+
     void DataReceiver() override;
 
     void Action(const uint start_index, const uint end_index) override;
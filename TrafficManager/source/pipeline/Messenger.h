@@ -3,25 +3,108 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
+#include <thread>
 
 using namespace std::chrono_literals;
 
 namespace traffic_manager {
 
+namespace chr = std::chrono;
+
   template <typename Data>
   struct DataPacket {
     int id;
     Data data;
   };
 
+  /// Wait policy that keeps the calling thread spinning on the messenger
+  /// state, yielding the core between polls. Lowest hand-off latency, but
+  /// occupies a core per waiting thread.
+  class SpinWaitPolicy {
+
+  public:
+
+    template <typename Predicate>
+    void Wait(Predicate &&ready) {
+      while (!ready()) {
+        std::this_thread::yield();
+      }
+    }
+
+    void Notify() {}
+
+  };
+
+  /// Wait policy that spins for a short while and then parks the calling
+  /// thread on a condition variable until the other end notifies. The mutex
+  /// is only touched on the slow path, the fast path is lock-free.
+  class ParkingWaitPolicy {
+
+  private:
+
+    /// Number of polls before parking the thread.
+    static constexpr uint SPIN_LIMIT = 1000u;
+    /// Number of threads currently parked.
+    std::atomic<uint> parked_threads;
+    /// Mutex and condition variable used only for parking.
+    std::mutex park_mutex;
+    std::condition_variable park_condition;
+
+  public:
+
+    ParkingWaitPolicy() : parked_threads(0u) {}
+
+    template <typename Predicate>
+    void Wait(Predicate &&ready) {
+      for (uint i = 0u; i < SPIN_LIMIT; ++i) {
+        if (ready()) {
+          return;
+        }
+        std::this_thread::yield();
+      }
+      std::unique_lock<std::mutex> lock(park_mutex);
+      parked_threads.fetch_add(1u);
+      // Timed wait guards against a notification racing with the increment.
+      while (!ready()) {
+        park_condition.wait_for(lock, 1ms);
+      }
+      parked_threads.fetch_sub(1u);
+    }
+
+    void Notify() {
+      if (parked_threads.load() > 0u) {
+        std::lock_guard<std::mutex> lock(park_mutex);
+        park_condition.notify_all();
+      }
+    }
+
+  };
+
+  /// Snapshot of the hand-off latency counters of a messenger.
+  struct MessengerStatistics {
+    uint64_t messages_sent = 0u;
+    uint64_t messages_received = 0u;
+    /// Time spent blocked in SendData/ReceiveData, in microseconds.
+    double average_send_wait = 0.0;
+    double maximum_send_wait = 0.0;
+    double average_receive_wait = 0.0;
+    double maximum_receive_wait = 0.0;
+  };
+
   /// This class is the template for messaging functionality between
   /// different stage classes to send and receive data.
   /// One object of this type can only facilitate receiving data from
   /// a sender stage and passing the data onto a receiver stage.
   /// The class maintains state internally and blocks send or receive
   /// requests until data is available/successfully passed on.
-  template <typename Data>
+  ///
+  /// The sender and receiver strictly alternate on the state counter, so the
+  /// class behaves as a lock-free single-producer/single-consumer ring with
+  /// one slot: only the side that observed the expected state touches the
+  /// stored data, and the counter increment publishes it to the other side.
+  template <typename Data, typename WaitPolicy = ParkingWaitPolicy>
   class Messenger {
 
   private:
@@ -33,17 +116,43 @@ namespace traffic_manager {
     std::atomic<int> state_counter;
     /// Member used to hold data sent by the sender.
     Data data;
-    /// Mutex used to manage contention between the sender and receiver.
-    std::mutex data_modification_mutex;
-    /// Variable to conditionally block sender in case waiting for the receiver.
-    std::condition_variable send_condition;
-    /// Variable to conditionally block receiver in case waiting for the sender.
-    std::condition_variable receive_condition;
+    /// Policy deciding how the sender and receiver wait for each other.
+    WaitPolicy wait_policy;
+    /// Latency counters, each one written only by the sender or the receiver.
+    std::atomic<uint64_t> send_count;
+    std::atomic<uint64_t> receive_count;
+    std::atomic<uint64_t> total_send_wait;
+    std::atomic<uint64_t> maximum_send_wait;
+    std::atomic<uint64_t> total_receive_wait;
+    std::atomic<uint64_t> maximum_receive_wait;
+
+    static uint64_t ElapsedMicroseconds(chr::steady_clock::time_point start) {
+      return static_cast<uint64_t>(
+          chr::duration_cast<chr::microseconds>(chr::steady_clock::now() - start).count());
+    }
+
+    static void RecordWait(
+        std::atomic<uint64_t> &count,
+        std::atomic<uint64_t> &total,
+        std::atomic<uint64_t> &maximum,
+        uint64_t wait) {
+      count.store(count.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+      total.store(total.load(std::memory_order_relaxed) + wait, std::memory_order_relaxed);
+      if (wait > maximum.load(std::memory_order_relaxed)) {
+        maximum.store(wait, std::memory_order_relaxed);
+      }
+    }
 
   public:
 
-    Messenger() {
-      state_counter = 0;
+    Messenger()
+      : send_count(0u),
+        receive_count(0u),
+        total_send_wait(0u),
+        maximum_send_wait(0u),
+        total_receive_wait(0u),
+        maximum_receive_wait(0u) {
+      state_counter.store(0);
       stop_messenger.store(false);
     }
     ~Messenger() {}
@@ -52,14 +161,15 @@ namespace traffic_manager {
     /// increments state.
     int SendData(DataPacket<Data> packet) {
 
-      std::unique_lock<std::mutex> lock(data_modification_mutex);
-      while (state_counter.load() == packet.id && !stop_messenger.load()) {
-        send_condition.wait_for(lock, 1ms, [=] {return state_counter.load() != packet.id;});
-      }
+      const auto start = chr::steady_clock::now();
+      wait_policy.Wait([&] {
+        return state_counter.load(std::memory_order_acquire) != packet.id ||
+               stop_messenger.load(std::memory_order_relaxed);
+      });
       data = packet.data;
-      state_counter.store(state_counter.load() + 1);
-      int present_state = state_counter.load();
-      receive_condition.notify_one();
+      const int present_state = state_counter.fetch_add(1, std::memory_order_acq_rel) + 1;
+      wait_policy.Notify();
+      RecordWait(send_count, total_send_wait, maximum_send_wait, ElapsedMicroseconds(start));
 
       return present_state;
     }
@@ -67,25 +177,48 @@ namespace traffic_manager {
     /// This method presents stored data to the receiver and increments state.
     DataPacket<Data> ReceiveData(int old_state) {
 
-      std::unique_lock<std::mutex> lock(data_modification_mutex);
-      while (state_counter.load() == old_state && !stop_messenger.load()) {
-        receive_condition.wait_for(lock, 1ms, [=] {return state_counter.load() != old_state;});
-      }
-      state_counter.store(state_counter.load() + 1);
-      DataPacket<Data> packet = {state_counter.load(), data};
-      send_condition.notify_one();
+      const auto start = chr::steady_clock::now();
+      wait_policy.Wait([&] {
+        return state_counter.load(std::memory_order_acquire) != old_state ||
+               stop_messenger.load(std::memory_order_relaxed);
+      });
+      DataPacket<Data> packet = {0, data};
+      packet.id = state_counter.fetch_add(1, std::memory_order_acq_rel) + 1;
+      wait_policy.Notify();
+      RecordWait(receive_count, total_receive_wait, maximum_receive_wait, ElapsedMicroseconds(start));
 
       return packet;
     }
 
     /// This method returns the current value of the state counter.
     int GetState() {
-      return state_counter.load();
+      return state_counter.load(std::memory_order_acquire);
     }
 
     /// This method unblocks any waiting calls on this object.
     void Stop() {
       stop_messenger.store(true);
+      wait_policy.Notify();
+    }
+
+    /// Returns the hand-off latency counters accumulated so far.
+    MessengerStatistics GetStatistics() const {
+      MessengerStatistics statistics;
+      statistics.messages_sent = send_count.load(std::memory_order_relaxed);
+      statistics.messages_received = receive_count.load(std::memory_order_relaxed);
+      if (statistics.messages_sent > 0u) {
+        statistics.average_send_wait =
+            static_cast<double>(total_send_wait.load(std::memory_order_relaxed)) /
+            static_cast<double>(statistics.messages_sent);
+      }
+      if (statistics.messages_received > 0u) {
+        statistics.average_receive_wait =
+            static_cast<double>(total_receive_wait.load(std::memory_order_relaxed)) /
+            static_cast<double>(statistics.messages_received);
+      }
+      statistics.maximum_send_wait = static_cast<double>(maximum_send_wait.load(std::memory_order_relaxed));
+      statistics.maximum_receive_wait = static_cast<double>(maximum_receive_wait.load(std::memory_order_relaxed));
+      return statistics;
     }
 
   };
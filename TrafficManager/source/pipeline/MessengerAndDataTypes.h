@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <deque>
 #include <memory>
 #include <vector>
 
@@ -9,6 +11,7 @@
 
 #include "Messenger.h"
 #include "SimpleWaypoint.h"
+#include "VehicleStateSnapshot.h"
 
 namespace traffic_manager {
 
@@ -16,16 +19,49 @@ namespace cc = carla::client;
 
   /// Convenience typing.
 
-  /// Alias for waypoint buffer used in the localization stage.
-  using Buffer = std::deque<std::shared_ptr<SimpleWaypoint>>;
+  /// Alias for waypoint buffer used in the localization stage, it holds
+  /// indices into the dense topology of the local map.
+  using Buffer = std::deque<NodeIndex>;
   /// Alias used for the list of buffers in the localization stage.
   using BufferList = std::vector<Buffer>;
 
   /// Data types.
 
+  /// Array of data flowing out of the localization stage, together with the
+  /// vehicle state snapshot its entries refer to. Entry i corresponds to
+  /// position i of the snapshot.
+  template <typename Data>
+  struct SnapshotFrame {
+
+    explicit SnapshotFrame(size_t size) : entries(size) {}
+
+    Data &at(size_t index) {
+      return entries.at(index);
+    }
+
+    const Data &at(size_t index) const {
+      return entries.at(index);
+    }
+
+    size_t size() const {
+      return entries.size();
+    }
+
+    auto begin() {
+      return entries.begin();
+    }
+
+    auto end() {
+      return entries.end();
+    }
+
+    /// Vehicle state at the tick the entries were computed.
+    std::shared_ptr<const VehicleStateSnapshot> snapshot;
+    std::vector<Data> entries;
+  };
+
   /// Type of data sent by the localization stage to the motion planner stage.
   struct LocalizationToPlannerData {
-    carla::SharedPtr<cc::Actor> actor;
     float deviation;
     bool approaching_true_junction;
   };
@@ -36,11 +72,12 @@ namespace cc = carla::client;
     float throttle;
     float brake;
     float steer;
+    /// Capture time of the vehicle state the control was computed from.
+    std::chrono::steady_clock::time_point state_time;
   };
 
   /// Type of data sent by the localization stage to the collision stage.
   struct LocalizationToCollisionData {
-    carla::SharedPtr<cc::Actor> actor;
     Buffer *buffer;
   };
 
@@ -51,9 +88,8 @@ namespace cc = carla::client;
 
   /// Type of data sent by the localization stage to the traffic light stage.
   struct LocalizationToTrafficLightData {
-    carla::SharedPtr<cc::Actor> actor;
-    std::shared_ptr<SimpleWaypoint> closest_waypoint;
-    std::shared_ptr<SimpleWaypoint> junction_look_ahead_waypoint;
+    NodeIndex closest_waypoint;
+    NodeIndex junction_look_ahead_waypoint;
   };
 
   /// Type of data sent by the traffic light stage to the motion planner stage.
@@ -65,12 +101,23 @@ namespace cc = carla::client;
 
   /// Array types of data flowing between stages.
 
-  using LocalizationToPlannerFrame = std::vector<LocalizationToPlannerData>;
+  using LocalizationToPlannerFrame = SnapshotFrame<LocalizationToPlannerData>;
   using PlannerToControlFrame = std::vector<PlannerToControlData>;
-  using LocalizationToCollisionFrame = std::vector<LocalizationToCollisionData>;
-  using LocalizationToTrafficLightFrame = std::vector<LocalizationToTrafficLightData>;
-  using CollisionToPlannerFrame = std::vector<CollisionToPlannerData>;
-  using TrafficLightToPlannerFrame = std::vector<TrafficLightToPlannerData>;
+  using LocalizationToTrafficLightFrame = SnapshotFrame<LocalizationToTrafficLightData>;
+  /// The frames read by the motion planner carry their snapshot too, they may
+  /// lag behind the localization frame across a registration change.
+  using CollisionToPlannerFrame = SnapshotFrame<CollisionToPlannerData>;
+  using TrafficLightToPlannerFrame = SnapshotFrame<TrafficLightToPlannerData>;
+
+  /// Frame sent by the localization stage to the collision stage, it keeps
+  /// alive the buffer list its entries point into, which the localization
+  /// stage replaces when the registered vehicles change.
+  struct LocalizationToCollisionFrame : SnapshotFrame<LocalizationToCollisionData> {
+
+    using SnapshotFrame<LocalizationToCollisionData>::SnapshotFrame;
+
+    std::shared_ptr<BufferList> buffer_list;
+  };
 
   /// Messenger types
 
@@ -13,6 +13,24 @@ namespace PlannerConstants {
 }
   using namespace PlannerConstants;
 
+  /// Returns the remap from the vehicles of @a frame_snapshot to the ones of
+  /// @a snapshot, empty if they list the same vehicles.
+  static IndexRemap MakeFrameRemap(
+      const std::shared_ptr<const VehicleStateSnapshot> &frame_snapshot,
+      const VehicleStateSnapshot &snapshot) {
+
+    if (frame_snapshot == nullptr || frame_snapshot->registration == snapshot.registration) {
+      return IndexRemap();
+    }
+    return MakeIndexRemap(frame_snapshot->ids, snapshot.ids);
+  }
+
+  /// Returns the position in a frame of the vehicle at @a index, following
+  /// @a remap if not empty.
+  static uint GetFrameIndex(const IndexRemap &remap, uint index) {
+    return remap.empty() ? index : remap[index];
+  }
+
   MotionPlannerStage::MotionPlannerStage(
       std::shared_ptr<LocalizationToPlannerMessenger> localization_messenger,
       std::shared_ptr<CollisionToPlannerMessenger> collision_messenger,
@@ -36,15 +54,9 @@ namespace PlannerConstants {
       collision_messenger(collision_messenger),
       traffic_light_messenger(traffic_light_messenger),
       debug_helper(debug_helper),
+      pid_batch(number_of_vehicles),
       PipelineStage(pool_size, number_of_vehicles) {
 
-    // Allocate and initialize vector to keep track of controller states for all
-    // vehicles.
-    pid_state_vector = std::make_shared<std::vector<StateEntry>>(number_of_vehicles);
-    for (StateEntry &entry: *pid_state_vector.get()) {
-      entry.time_instance = chr::system_clock::now();
-    }
-
     // Initializing the output frame selector.
     frame_selector = true;
 
@@ -67,30 +79,21 @@ namespace PlannerConstants {
 
     // Selecting an output frame.
     auto current_control_frame = frame_selector ? control_frame_a : control_frame_b;
+    const VehicleStateSnapshot &snapshot = *localization_frame->snapshot;
 
-    // Looping over arrays' partitions for the current thread.
+    // Gathering the controller inputs of the current thread's partition.
     for (uint i = start_index; i <= end_index; ++i) {
 
-      LocalizationToPlannerData &localization_data = localization_frame->at(i);
-      Actor actor = localization_data.actor;
-      float current_deviation = localization_data.deviation;
-      ActorId actor_id = actor->GetId();
-
-      auto vehicle = boost::static_pointer_cast<cc::Vehicle>(actor);
-      float current_velocity = vehicle->GetVelocity().Length();
-      auto current_time = chr::system_clock::now();
-
-      // Retrieving the previous state.
-      traffic_manager::StateEntry previous_state;
-      previous_state = pid_state_vector->at(i);
+      const LocalizationToPlannerData &localization_data = localization_frame->at(i);
 
       float dynamic_target_velocity = urban_target_velocity;
+      float highway = 0.0f;
 
       // Increase speed if on highway.
-      float speed_limit = vehicle->GetSpeedLimit() / 3.6f;
+      float speed_limit = snapshot.speed_limits[i] / 3.6f;
       if (speed_limit > HIGHWAY_SPEED) {
         dynamic_target_velocity = highway_target_velocity;
-        longitudinal_parameters = highway_longitudinal_parameters;
+        highway = 1.0f;
       }
 
       // Decrease speed approaching an intersection.
@@ -98,50 +101,78 @@ namespace PlannerConstants {
         dynamic_target_velocity = INTERSECTION_APPROACH_SPEED;
       }
 
-      // State update for vehicle.
-      StateEntry current_state = controller.StateUpdate(
-          previous_state,
-          current_velocity,
-          dynamic_target_velocity,
-          current_deviation,
-          current_time);
-
-      // Controller actuation.
-      ActuationSignal actuation_signal = controller.RunStep(
-          current_state,
-          previous_state,
-          longitudinal_parameters,
-          lateral_parameters);
+      pid_batch.current_velocity[i] = snapshot.speeds[i];
+      pid_batch.target_velocity[i] = dynamic_target_velocity;
+      pid_batch.deviation[i] = localization_data.deviation;
+      pid_batch.highway[i] = highway;
+    }
 
-      // In case of collision or traffic light or approaching a junction.
-      if ((collision_messenger_state != 0 && collision_frame->at(i).hazard) ||
-          (traffic_light_messenger_state != 0 &&
-           traffic_light_frame->at(i).traffic_light_hazard)) {
-
-        current_state.deviation_integral = 0.0f;
-        current_state.velocity_integral = 0.0f;
-        actuation_signal.throttle = 0.0f;
-        actuation_signal.brake = 1.0f;
+    // State update and controller actuation for the whole partition.
+    controller.RunStepBatch(
+        pid_batch,
+        start_index,
+        end_index,
+        snapshot.elapsed_seconds,
+        snapshot.delta_seconds,
+        longitudinal_parameters,
+        highway_longitudinal_parameters,
+        lateral_parameters);
+
+    for (uint i = start_index; i <= end_index; ++i) {
+
+      float throttle = pid_batch.throttle[i];
+      float brake = pid_batch.brake[i];
+
+      // Vehicles registered since the collision and traffic light frames
+      // were computed are not in them yet.
+      bool collision_hazard = false;
+      if (collision_messenger_state != 0) {
+        const uint index = GetFrameIndex(collision_remap, i);
+        collision_hazard = index < collision_frame->size() && collision_frame->at(index).hazard;
+      }
+      bool traffic_light_hazard = false;
+      if (traffic_light_messenger_state != 0) {
+        const uint index = GetFrameIndex(traffic_light_remap, i);
+        traffic_light_hazard = index < traffic_light_frame->size() &&
+            traffic_light_frame->at(index).traffic_light_hazard;
       }
 
-      // Updating PID state.
-      StateEntry &state = pid_state_vector->at(i);
-      state = current_state;
+      // In case of collision or traffic light or approaching a junction.
+      if (collision_hazard || traffic_light_hazard) {
+
+        pid_batch.deviation_integral[i] = 0.0f;
+        pid_batch.velocity_integral[i] = 0.0f;
+        throttle = 0.0f;
+        brake = 1.0f;
+      }
 
       // Constructing the actuation signal.
       PlannerToControlData &message = current_control_frame->at(i);
-      message.actor_id = actor_id;
-      message.throttle = actuation_signal.throttle;
-      message.brake = actuation_signal.brake;
-      message.steer = actuation_signal.steer;
+      message.actor_id = snapshot.ids[i];
+      message.throttle = throttle;
+      message.brake = brake;
+      message.steer = pid_batch.steer[i];
+      message.state_time = snapshot.capture_time;
     }
   }
 
   void MotionPlannerStage::DataReceiver() {
 
+    auto previous_localization_frame = localization_frame;
     auto localization_packet = localization_messenger->ReceiveData(localization_messenger_state);
     localization_frame = localization_packet.data;
     localization_messenger_state = localization_packet.id;
+    const VehicleStateSnapshot &snapshot = *localization_frame->snapshot;
+
+    // Moving the controller state along with the registered vehicles.
+    if (previous_localization_frame != nullptr &&
+        previous_localization_frame->snapshot->registration != snapshot.registration) {
+      pid_batch.Remap(MakeIndexRemap(previous_localization_frame->snapshot->ids, snapshot.ids));
+      const uint number_of_vehicles = static_cast<uint>(snapshot.size());
+      control_frame_a = std::make_shared<PlannerToControlFrame>(number_of_vehicles);
+      control_frame_b = std::make_shared<PlannerToControlFrame>(number_of_vehicles);
+      SetNumberOfVehicles(number_of_vehicles);
+    }
 
     // Block on receive call only if new data is available on the messenger.
     int collision_messenger_current_state = collision_messenger->GetState();
@@ -158,6 +189,13 @@ namespace PlannerConstants {
       traffic_light_frame = traffic_light_packet.data;
       traffic_light_messenger_state = traffic_light_packet.id;
     }
+
+    if (collision_frame != nullptr) {
+      collision_remap = MakeFrameRemap(collision_frame->snapshot, snapshot);
+    }
+    if (traffic_light_frame != nullptr) {
+      traffic_light_remap = MakeFrameRemap(traffic_light_frame->snapshot, snapshot);
+    }
   }
 
   void MotionPlannerStage::DataSender() {
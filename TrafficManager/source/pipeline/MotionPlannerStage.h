@@ -1,18 +1,17 @@
 #pragma once
 
-#include <chrono>
 #include <vector>
 
 #include "carla/client/Vehicle.h"
 #include "carla/rpc/Actor.h"
 
+#include "IndexRemap.h"
 #include "MessengerAndDataTypes.h"
 #include "PIDController.h"
 #include "PipelineStage.h"
 
 namespace traffic_manager {
 
-namespace chr = std::chrono;
 namespace cc = carla::client;
 
   using Actor = carla::SharedPtr<cc::Actor>;
@@ -41,14 +40,19 @@ namespace cc = carla::client;
     std::shared_ptr<LocalizationToPlannerFrame> localization_frame;
     std::shared_ptr<CollisionToPlannerFrame> collision_frame;
     std::shared_ptr<TrafficLightToPlannerFrame> traffic_light_frame;
+    /// Positions in the collision and traffic light frames of the registered
+    /// vehicles, empty while the frames list the same vehicles as the
+    /// localization frame.
+    IndexRemap collision_remap;
+    IndexRemap traffic_light_remap;
     /// Pointers to messenger objects connecting to various stages.
     std::shared_ptr<LocalizationToPlannerMessenger> localization_messenger;
     std::shared_ptr<PlannerToControlMessenger> control_messenger;
     std::shared_ptr<CollisionToPlannerMessenger> collision_messenger;
     std::shared_ptr<TrafficLightToPlannerMessenger> traffic_light_messenger;
-    /// Array to store states for integral and differential components
-    /// of the PID controller.
-    std::shared_ptr<std::vector<StateEntry>> pid_state_vector;
+    /// Arrays to store inputs and states for integral and differential
+    /// components of the PID controller.
+    PIDBatch pid_batch;
     /// Configuration parameters for the PID controller.
     std::vector<float> longitudinal_parameters;
     std::vector<float> highway_longitudinal_parameters;
@@ -5,73 +5,140 @@ namespace traffic_manager {
 namespace PIDControllerConstants {
   const float MAX_THROTTLE = 0.8f;
   const float MAX_BRAKE = 1.0f;
+  const double MIN_DELTA_SECONDS = 1e-3;
 }
   using namespace PIDControllerConstants;
 
-  PIDController::PIDController() {}
+  // The kernels below are free of branches and work on contiguous arrays that
+  // do not overlap, with a size_t index so the trip count is known, letting
+  // the compiler vectorize them.
+
+  static void LongitudinalStep(
+      const size_t start_index,
+      const size_t end_index,
+      const std::vector<float> &urban_parameters,
+      const std::vector<float> &highway_parameters,
+      const float *__restrict current_velocity,
+      const float *__restrict target_velocity,
+      const float *__restrict highway,
+      const float *__restrict step_delta,
+      const float *__restrict previous_velocity_error,
+      const float *__restrict previous_velocity_integral,
+      float *__restrict velocity_error,
+      float *__restrict velocity_integral,
+      float *__restrict throttle,
+      float *__restrict brake) {
+
+    const float kp_urban = urban_parameters[0];
+    const float ki_urban = urban_parameters[1];
+    const float kd_urban = urban_parameters[2];
+    const float kp_highway = highway_parameters[0];
+    const float ki_highway = highway_parameters[1];
+    const float kd_highway = highway_parameters[2];
+
+    for (size_t i = start_index; i <= end_index; ++i) {
+
+      const float dt = step_delta[i];
+      const float error = (current_velocity[i] - target_velocity[i]) / target_velocity[i];
+      const float integral = previous_velocity_integral[i] + error * dt;
+
+      const float kp = kp_urban + highway[i] * (kp_highway - kp_urban);
+      const float ki = ki_urban + highway[i] * (ki_highway - ki_urban);
+      const float kd = kd_urban + highway[i] * (kd_highway - kd_urban);
+      const float expr_v = kp * error + ki * integral +
+          kd * (error - previous_velocity_error[i]) / dt;
+
+      throttle[i] = std::min(std::max(-expr_v, 0.0f), MAX_THROTTLE);
+      brake[i] = std::min(std::max(expr_v, 0.0f), MAX_BRAKE);
+      velocity_error[i] = error;
+      velocity_integral[i] = integral;
+    }
+  }
 
-  // Initializing present state.
-  StateEntry PIDController::StateUpdate(
-      StateEntry previous_state,
-      float current_velocity,
-      float target_velocity,
-      float angular_deviation,
-      TimeInstance current_time) {
-
-    traffic_manager::StateEntry current_state = {
-      angular_deviation,
-      (current_velocity - target_velocity) / target_velocity,
-      current_time,
-      0.0f,
-      0.0f
-    };
-
-    // Calculating dt for 'D' and 'I' controller components.
-    chr::duration<double> duration = current_state.time_instance - previous_state.time_instance;
-    double dt = duration.count();
-
-    // Calculating integrals.
-    current_state.deviation_integral = angular_deviation * dt + previous_state.deviation_integral;
-    current_state.velocity_integral = dt * current_state.velocity + previous_state.velocity_integral;
-
-    return current_state;
+  static void LateralStep(
+      const size_t start_index,
+      const size_t end_index,
+      const std::vector<float> &parameters,
+      const float *__restrict deviation,
+      const float *__restrict step_delta,
+      const float *__restrict previous_deviation,
+      const float *__restrict previous_deviation_integral,
+      float *__restrict deviation_error,
+      float *__restrict deviation_integral,
+      float *__restrict steer) {
+
+    const float kp = parameters[0];
+    const float ki = parameters[1];
+    const float kd = parameters[2];
+
+    for (size_t i = start_index; i <= end_index; ++i) {
+
+      const float dt = step_delta[i];
+      const float error = deviation[i];
+      const float integral = previous_deviation_integral[i] + error * dt;
+
+      const float expr_s = kp * error + ki * integral +
+          kd * (error - previous_deviation[i]) / dt;
+
+      steer[i] = std::max(-1.0f, std::min(expr_s, 1.0f));
+      deviation_error[i] = error;
+      deviation_integral[i] = integral;
+    }
   }
 
-  ActuationSignal PIDController::RunStep(
-      StateEntry present_state,
-      StateEntry previous_state,
-      const std::vector<float> &longitudinal_parameters,
+  PIDController::PIDController() {}
+
+  void PIDController::RunStepBatch(
+      PIDBatch &batch,
+      const uint start_index,
+      const uint end_index,
+      double elapsed_seconds,
+      double delta_seconds,
+      const std::vector<float> &urban_longitudinal_parameters,
+      const std::vector<float> &highway_longitudinal_parameters,
       const std::vector<float> &lateral_parameters) const {
 
-    // Calculating dt for updating the integral component.
-    chr::duration<double> duration = present_state.time_instance - previous_state.time_instance;
-    double dt = duration.count();
-
-    // Longitudinal PID calculation.
-    float expr_v = longitudinal_parameters[0] * present_state.velocity +
-    longitudinal_parameters[1] * present_state.velocity_integral +
-    longitudinal_parameters[2] * (present_state.velocity -
-    previous_state.velocity) / dt;
-
-    float throttle;
-    float brake;
-
-    if (expr_v < 0.0f) {
-      throttle = std::min(std::abs(expr_v), MAX_THROTTLE);
-      brake = 0.0f;
-    } else {
-      throttle = 0.0f;
-      brake = std::min(expr_v, MAX_BRAKE);
+    // Moving on to a new step for the vehicles whose present step belongs to
+    // an older simulation time. Vehicles never controlled start from their
+    // present error, so the first derivative is zero.
+    for (uint i = start_index; i <= end_index; ++i) {
+      if (batch.step_time[i] < 0.0) {
+        batch.previous_step_time[i] = elapsed_seconds - std::max(delta_seconds, MIN_DELTA_SECONDS);
+        batch.previous_deviation[i] = batch.deviation[i];
+        batch.previous_velocity_error[i] =
+            (batch.current_velocity[i] - batch.target_velocity[i]) / batch.target_velocity[i];
+        batch.previous_deviation_integral[i] = 0.0f;
+        batch.previous_velocity_integral[i] = 0.0f;
+        batch.step_time[i] = elapsed_seconds;
+      } else if (batch.step_time[i] < elapsed_seconds) {
+        batch.previous_step_time[i] = batch.step_time[i];
+        batch.previous_deviation[i] = batch.deviation_error[i];
+        batch.previous_velocity_error[i] = batch.velocity_error[i];
+        batch.previous_deviation_integral[i] = batch.deviation_integral[i];
+        batch.previous_velocity_integral[i] = batch.velocity_integral[i];
+        batch.step_time[i] = elapsed_seconds;
+      }
+      // Calculating dt for 'D' and 'I' controller components.
+      batch.step_delta[i] = static_cast<float>(
+          std::max(elapsed_seconds - batch.previous_step_time[i], MIN_DELTA_SECONDS));
     }
 
-    // Lateral PID calculation.
-    float steer =lateral_parameters[0] * present_state.deviation +
-    lateral_parameters[1] * present_state.deviation_integral +
-    lateral_parameters[2] * (present_state.deviation -
-    previous_state.deviation) / dt;
-
-    steer = std::max(-1.0f, std::min(steer, 1.0f));
-
-    return ActuationSignal{throttle, brake, steer};
+    // Longitudinal and lateral PID calculations.
+    LongitudinalStep(
+        start_index, end_index,
+        urban_longitudinal_parameters, highway_longitudinal_parameters,
+        batch.current_velocity.data(), batch.target_velocity.data(),
+        batch.highway.data(), batch.step_delta.data(),
+        batch.previous_velocity_error.data(), batch.previous_velocity_integral.data(),
+        batch.velocity_error.data(), batch.velocity_integral.data(),
+        batch.throttle.data(), batch.brake.data());
+
+    LateralStep(
+        start_index, end_index,
+        lateral_parameters,
+        batch.deviation.data(), batch.step_delta.data(),
+        batch.previous_deviation.data(), batch.previous_deviation_integral.data(),
+        batch.deviation_error.data(), batch.deviation_integral.data(),
+        batch.steer.data());
   }
 }
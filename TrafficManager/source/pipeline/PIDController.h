@@ -1,28 +1,83 @@
 #pragma once
 
-#include <chrono>
+#include <algorithm>
 #include <cmath>
 #include <vector>
 
+#include "IndexRemap.h"
+
 namespace traffic_manager {
 
-namespace chr = std::chrono;
-  using TimeInstance = chr::time_point<chr::_V2::system_clock, chr::nanoseconds>;
+  /// Structure-of-arrays state and input of the controller for every vehicle
+  /// registered with the traffic manager, indexed like the vehicle state
+  /// snapshot. Each partition of the motion planner only touches its own
+  /// range, so the arrays are shared by all the threads of the stage.
+  struct PIDBatch {
 
-  /// Structure to hold the actuation signals.
-  struct ActuationSignal {
-    float throttle;
-    float brake;
-    float steer;
-  };
+    PIDBatch() = default;
+
+    explicit PIDBatch(size_t number_of_vehicles)
+      : current_velocity(number_of_vehicles, 0.0f),
+        target_velocity(number_of_vehicles, 0.0f),
+        deviation(number_of_vehicles, 0.0f),
+        highway(number_of_vehicles, 0.0f),
+        deviation_error(number_of_vehicles, 0.0f),
+        velocity_error(number_of_vehicles, 0.0f),
+        deviation_integral(number_of_vehicles, 0.0f),
+        velocity_integral(number_of_vehicles, 0.0f),
+        previous_deviation(number_of_vehicles, 0.0f),
+        previous_velocity_error(number_of_vehicles, 0.0f),
+        previous_deviation_integral(number_of_vehicles, 0.0f),
+        previous_velocity_integral(number_of_vehicles, 0.0f),
+        step_time(number_of_vehicles, -1.0),
+        previous_step_time(number_of_vehicles, -1.0),
+        step_delta(number_of_vehicles, 0.0f),
+        throttle(number_of_vehicles, 0.0f),
+        brake(number_of_vehicles, 0.0f),
+        steer(number_of_vehicles, 0.0f) {}
+
+    /// Moves the state of the vehicles to their positions in a new
+    /// registration, the vehicles registered since start uncontrolled.
+    void Remap(const IndexRemap &remap) {
+      for (std::vector<float> *array: {
+          &current_velocity, &target_velocity, &deviation, &highway,
+          &deviation_error, &velocity_error, &deviation_integral, &velocity_integral,
+          &previous_deviation, &previous_velocity_error,
+          &previous_deviation_integral, &previous_velocity_integral,
+          &step_delta, &throttle, &brake, &steer}) {
+        RemapVehicleArray(*array, remap, 0.0f);
+      }
+      RemapVehicleArray(step_time, remap, -1.0);
+      RemapVehicleArray(previous_step_time, remap, -1.0);
+    }
 
-  /// Structure to hold the controller state.
-  struct StateEntry {
-    float deviation;
-    float velocity;
-    TimeInstance time_instance;
-    float deviation_integral;
-    float velocity_integral;
+    /// Inputs, filled by the caller before every step.
+    std::vector<float> current_velocity;
+    std::vector<float> target_velocity;
+    std::vector<float> deviation;
+    /// 1 to use the highway longitudinal parameters, 0 for the urban ones.
+    std::vector<float> highway;
+    /// State of the present step.
+    std::vector<float> deviation_error;
+    std::vector<float> velocity_error;
+    std::vector<float> deviation_integral;
+    std::vector<float> velocity_integral;
+    /// State of the previous step, origin of the derivative and integral
+    /// components.
+    std::vector<float> previous_deviation;
+    std::vector<float> previous_velocity_error;
+    std::vector<float> previous_deviation_integral;
+    std::vector<float> previous_velocity_integral;
+    /// Simulation time of the present and the previous step, in seconds,
+    /// negative until the vehicle is first controlled.
+    std::vector<double> step_time;
+    std::vector<double> previous_step_time;
+    /// Time between the previous and the present step, in seconds.
+    std::vector<float> step_delta;
+    /// Outputs.
+    std::vector<float> throttle;
+    std::vector<float> brake;
+    std::vector<float> steer;
   };
 
   /// This class calculates PID actuation signals to control the vehicle
@@ -35,21 +90,18 @@ namespace chr = std::chrono;
 
     PIDController();
 
-    /// This method calculates the present state of the vehicle including
-    /// the accumulated integral component of the PID system.
-    StateEntry StateUpdate(
-        StateEntry previous_state,
-        float current_velocity,
-        float target_velocity,
-        float angular_deviation,
-        TimeInstance current_time);
-
-    /// This method calculates the actuation signals based on the resent state
-    /// change of the vehicle to minimize PID error.
-    ActuationSignal RunStep(
-        StateEntry present_state,
-        StateEntry previous_state,
-        const std::vector<float> &longitudinal_parameters,
+    /// This method updates the state and calculates the actuation signals of
+    /// the vehicles in [start_index, end_index] of @a batch at the simulation
+    /// time @a elapsed_seconds. Evaluating the same simulation time again only
+    /// recomputes the present step, so the derivative always spans a tick.
+    void RunStepBatch(
+        PIDBatch &batch,
+        const uint start_index,
+        const uint end_index,
+        double elapsed_seconds,
+        double delta_seconds,
+        const std::vector<float> &urban_longitudinal_parameters,
+        const std::vector<float> &highway_longitudinal_parameters,
         const std::vector<float> &lateral_parameters) const;
 
   };
@@ -5,6 +5,13 @@ namespace traffic_manager {
 namespace PipelineConstants {
   uint MINIMUM_CORE_COUNT = 4u;
   uint MINIMUM_NUMBER_OF_VEHICLES = 100u;
+  float SHARD_GRID_CELL_SIZE = 50.0f;
+  /// Horizontal distance to the closest actor below which a spawn point is
+  /// taken.
+  float SPAWN_CLEARANCE = 5.0f;
+  /// Spawn batches sent at most, the spawns failed in a batch are retried at
+  /// the spawn points left in the next one.
+  uint SPAWN_ROUNDS = 2u;
 }
   using namespace PipelineConstants;
 
@@ -15,19 +22,102 @@ namespace PipelineConstants {
     return core_count > 0 ? core_count : MINIMUM_CORE_COUNT;
   }
 
+  std::vector<cg::Transform> select_shard_spawn_points(
+      const std::vector<cg::Transform> &spawn_points,
+      const ShardConfiguration &shard) {
+
+    if (shard.index >= shard.count) {
+      throw std::invalid_argument("Shard index out of range!");
+    }
+    if (shard.count == 1u || spawn_points.empty()) {
+      return spawn_points;
+    }
+
+    // Binning the spawn points by grid column, every process gets the same
+    // bins since the recommended spawn points depend on the map only.
+    std::map<int32_t, std::vector<cg::Transform>> columns;
+    for (const cg::Transform &spawn_point: spawn_points) {
+      int32_t column = static_cast<int32_t>(std::floor(spawn_point.location.x / SHARD_GRID_CELL_SIZE));
+      columns[column].push_back(spawn_point);
+    }
+
+    // Walking the columns from west to east, moving on to the next region
+    // every spawn_points.size() / shard.count points.
+    std::vector<cg::Transform> shard_spawn_points;
+    size_t visited_points = 0u;
+    for (const auto &column: columns) {
+      uint region = std::min(
+          static_cast<uint>(visited_points * shard.count / spawn_points.size()),
+          shard.count - 1u);
+      if (region == shard.index) {
+        shard_spawn_points.insert(shard_spawn_points.end(), column.second.begin(), column.second.end());
+      }
+      visited_points += column.second.size();
+    }
+
+    return shard_spawn_points;
+  }
+
+  std::vector<cg::Transform> select_free_spawn_points(
+      const std::vector<cg::Transform> &spawn_points,
+      const cc::WorldSnapshot &world_snapshot) {
+
+    // Binning the actors on a grid of SPAWN_CLEARANCE sized cells, so a spawn
+    // point only checks the actors of its cell and of the cells around it.
+    auto get_cell = [] (const cg::Location &location) {
+      return std::make_pair(
+          static_cast<int32_t>(std::floor(location.x / SPAWN_CLEARANCE)),
+          static_cast<int32_t>(std::floor(location.y / SPAWN_CLEARANCE)));
+    };
+    std::map<std::pair<int32_t, int32_t>, std::vector<cg::Location>> cells;
+    for (const cc::ActorSnapshot &actor_snapshot: world_snapshot) {
+      const cg::Location &location = actor_snapshot.transform.location;
+      cells[get_cell(location)].push_back(location);
+    }
+
+    std::vector<cg::Transform> free_spawn_points;
+    for (const cg::Transform &spawn_point: spawn_points) {
+      const auto cell = get_cell(spawn_point.location);
+      bool is_free = true;
+      for (int32_t dx = -1; dx <= 1 && is_free; ++dx) {
+        for (int32_t dy = -1; dy <= 1 && is_free; ++dy) {
+          auto found = cells.find({cell.first + dx, cell.second + dy});
+          if (found == cells.end()) {
+            continue;
+          }
+          for (const cg::Location &location: found->second) {
+            if (cg::Math::DistanceSquared2D(location, spawn_point.location) <
+                SPAWN_CLEARANCE * SPAWN_CLEARANCE) {
+              is_free = false;
+              break;
+            }
+          }
+        }
+      }
+      if (is_free) {
+        free_spawn_points.push_back(spawn_point);
+      }
+    }
+    return free_spawn_points;
+  }
+
   std::vector<ActorPtr> spawn_traffic(
       cc::Client &client,
       cc::World &world,
       uint core_count,
-      uint target_amount = 0) {
+      uint target_amount,
+      const ShardConfiguration &shard,
+      bool enable_autopilot) {
 
     std::vector<ActorPtr> actor_list;
     carla::SharedPtr<cc::Map> world_map = world.GetMap();
 
     auto max_random = [] (uint limit) {return rand()%limit;};
 
-    // Get a random selection of spawn points from the map.
-    std::vector<cg::Transform> spawn_points = world_map->GetRecommendedSpawnPoints();
+    // Get a random selection of the spawn points not taken by an actor.
+    std::vector<cg::Transform> spawn_points = select_free_spawn_points(
+        select_shard_spawn_points(world_map->GetRecommendedSpawnPoints(), shard),
+        world.GetSnapshot());
     std::random_shuffle(spawn_points.begin(), spawn_points.end(), max_random);
 
     // Blueprint library containing all vehicle types.
@@ -64,45 +154,65 @@ namespace PipelineConstants {
 
     carla::log_info("Spawning " + std::to_string(number_of_vehicles) + " vehicles\n");
 
-    // Creating spawn batch command.
-    std::vector<cr::Command> batch_spawn_commands;
-    for (uint i = 0u; i < number_of_vehicles; ++i) {
-
-      cg::Transform spawn_point = spawn_points.at(i);
-      uint blueprint_size = safe_blueprint_library.size();
-      cc::ActorBlueprint blueprint = safe_blueprint_library.at(i % blueprint_size);
-
-      blueprint.SetAttribute("role_name", "traffic_manager");
-
-      using spawn = cr::Command::SpawnActor;
-      batch_spawn_commands.push_back(spawn(blueprint.MakeActorDescription(), spawn_point));
-    }
+    // Each shard tags its vehicles with its own role name so it only gathers
+    // the vehicles it spawned.
+    const std::string role_name = shard.count > 1u ?
+        "traffic_manager_" + std::to_string(shard.index) :
+        "traffic_manager";
+
+    // Spawning in a batch answered with the id or the error of every spawn,
+    // the vehicles failing to spawn are retried at the spawn points left.
+    using spawn = cr::Command::SpawnActor;
+    std::vector<carla::ActorId> spawned_ids;
+    uint next_spawn_point = 0u;
+    uint next_blueprint = 0u;
+    for (uint round = 0u;
+         round < SPAWN_ROUNDS &&
+         spawned_ids.size() < number_of_vehicles &&
+         next_spawn_point < spawn_points.size();
+         ++round) {
+
+      std::vector<cr::Command> batch_spawn_commands;
+      std::vector<uint> batch_spawn_points;
+      while (batch_spawn_commands.size() + spawned_ids.size() < number_of_vehicles &&
+             next_spawn_point < spawn_points.size()) {
+
+        cc::ActorBlueprint blueprint =
+            safe_blueprint_library.at(next_blueprint++ % safe_blueprint_library.size());
+        blueprint.SetAttribute("role_name", role_name);
+
+        spawn command(blueprint.MakeActorDescription(), spawn_points.at(next_spawn_point));
+        if (enable_autopilot) {
+          // The id of the vehicle is filled in by the simulator.
+          command.do_after.push_back(cr::Command::SetAutopilot(0u, true));
+        }
+        batch_spawn_commands.push_back(std::move(command));
+        batch_spawn_points.push_back(next_spawn_point++);
+      }
 
-    client.ApplyBatch(std::move(batch_spawn_commands));
-    // We need to wait till the simulator spawns all vehicles,
-    // tried to use World::WaitForTick but it also wasn't sufficient.
-    // We need to find a better way to do this.
-    std::this_thread::sleep_for(500ms);
-
-    // Gathering actors spawned by the traffic manager.
-    carla::SharedPtr<cc::ActorList> world_actors = world.GetActors();
-    for (auto iter = world_actors->begin(); iter != world_actors->end(); ++iter) {
-      ActorPtr world_actor = *iter;
-      auto world_vehicle = boost::static_pointer_cast<cc::Vehicle>(world_actor);
-      std::vector<cc::ActorAttributeValue> actor_attributes = world_vehicle->GetAttributes();
-      bool found_traffic_manager_vehicle = false;
-      for (
-        auto iter = actor_attributes.begin();
-        (iter != actor_attributes.end()) && !found_traffic_manager_vehicle;
-        ++iter
-        ) {
-        cc::ActorAttributeValue attribute = *iter;
-        if (attribute.GetValue() == "traffic_manager") {
-          found_traffic_manager_vehicle = true;
+      std::vector<cr::CommandResponse> responses = client.ApplyBatchSync(std::move(batch_spawn_commands));
+      uint failed_spawns = 0u;
+      for (uint i = 0u; i < responses.size(); ++i) {
+        if (responses[i].HasError()) {
+          ++failed_spawns;
+          carla::log_warning(
+              "Failed to spawn a vehicle at spawn point " + std::to_string(batch_spawn_points.at(i)) +
+              ": " + responses[i].GetError().What() + "\n");
+        } else {
+          spawned_ids.push_back(responses[i].Get());
         }
       }
-      if (found_traffic_manager_vehicle) {
-        actor_list.push_back(world_actor);
+      if (failed_spawns > 0u) {
+        carla::log_info(std::to_string(failed_spawns) + " vehicles failed to spawn in round " +
+            std::to_string(round + 1u) + "\n");
+      }
+    }
+
+    // Gathering the vehicles spawned in a single request.
+    if (!spawned_ids.empty()) {
+      carla::SharedPtr<cc::ActorList> spawned_actors = world.GetActors(spawned_ids);
+      for (auto iter = spawned_actors->begin(); iter != spawned_actors->end(); ++iter) {
+        actor_list.push_back(*iter);
       }
     }
 
@@ -129,7 +239,9 @@ namespace PipelineConstants {
       cc::Client &client_connection,
       cc::World &world,
       cc::DebugHelper &debug_helper,
-      uint pipeline_width)
+      uint pipeline_width,
+      BatchControlMode control_mode,
+      PipelineExecution execution)
     : longitudinal_PID_parameters(longitudinal_PID_parameters),
       longitudinal_highway_PID_parameters(longitudinal_highway_PID_parameters),
       lateral_PID_parameters(lateral_PID_parameters),
@@ -139,7 +251,23 @@ namespace PipelineConstants {
       client_connection(client_connection),
       world(world),
       debug_helper(debug_helper),
-      pipeline_width(pipeline_width) {
+      pipeline_width(pipeline_width),
+      control_mode(control_mode),
+      execution(execution) {
+
+    // The fused executor is already driven by the world ticks, so its batches
+    // go out right away instead of waiting for the next tick or sleeping.
+    if (execution == PipelineExecution::Fused) {
+      this->control_mode = BatchControlMode::Asynchronous;
+    }
+
+    // Traffic lights never move, so they are linked to the waypoints once and
+    // only their states are read every tick.
+    std::vector<TrafficLightPtr> traffic_lights;
+    for (auto actor: *world.GetActorsByType("traffic.traffic_light")) {
+      traffic_lights.push_back(boost::static_pointer_cast<cc::TrafficLight>(actor));
+    }
+    local_map.LinkTrafficLights(traffic_lights);
 
     localization_collision_messenger = std::make_shared<LocalizationToCollisionMessenger>();
     localization_traffic_light_messenger = std::make_shared<LocalizationToTrafficLightMessenger>();
@@ -152,16 +280,16 @@ namespace PipelineConstants {
         localization_planner_messenger, localization_collision_messenger,
         localization_traffic_light_messenger, actor_list.size(), pipeline_width,
         actor_list, local_map,
-        debug_helper);
+        world, debug_helper);
 
     collision_stage = std::make_unique<CollisionStage>(
         localization_collision_messenger, collision_planner_messenger,
         actor_list.size(), pipeline_width,
-        world, debug_helper);
+        local_map, world, debug_helper);
 
     traffic_light_stage = std::make_unique<TrafficLightStage>(
         localization_traffic_light_messenger, traffic_light_planner_messenger,
-        actor_list.size(), pipeline_width, debug_helper);
+        actor_list.size(), pipeline_width, local_map, debug_helper);
 
     planner_stage = std::make_unique<MotionPlannerStage>(
         localization_planner_messenger,
@@ -179,11 +307,46 @@ namespace PipelineConstants {
 
     control_stage = std::make_unique<BatchControlStage>(
         planner_control_messenger, client_connection,
-        actor_list.size(), pipeline_width);
+        actor_list.size(), pipeline_width, this->control_mode);
+
+    // All stages share one pool sized to the machine rather than spawning
+    // pipeline_width threads each.
+    action_pool = std::make_shared<ActionPool>(std::max(pipeline_width, read_core_count()));
+    localization_stage->SetActionPool(action_pool);
+    collision_stage->SetActionPool(action_pool);
+    traffic_light_stage->SetActionPool(action_pool);
+    planner_stage->SetActionPool(action_pool);
+    control_stage->SetActionPool(action_pool);
+
+    if (execution == PipelineExecution::Fused) {
+      fused_executor = std::make_unique<FusedExecutor>(
+          *localization_stage, *collision_stage, *traffic_light_stage,
+          *planner_stage, *control_stage, action_pool, world);
+    }
+  }
+
+  void Pipeline::SetUpdateRates(const StageUpdateRates &rates) {
+
+    collision_stage->SetIsolatedUpdateDivisor(rates.isolated_collision_divisor);
+    traffic_light_stage->SetUpdateDivisor(rates.traffic_light_divisor);
+    localization_stage->SetBufferRefillThreshold(rates.buffer_refill_threshold);
+  }
+
+  void Pipeline::RegisterVehicles(const std::vector<ActorPtr> &vehicles) {
+    localization_stage->RegisterVehicles(vehicles);
+  }
+
+  void Pipeline::UnregisterVehicles(const std::vector<carla::ActorId> &vehicle_ids) {
+    localization_stage->UnregisterVehicles(vehicle_ids);
   }
 
   void Pipeline::Start() {
 
+    if (fused_executor != nullptr) {
+      fused_executor->Start();
+      return;
+    }
+
     localization_stage->Start();
     collision_stage->Start();
     traffic_light_stage->Start();
@@ -193,6 +356,12 @@ namespace PipelineConstants {
 
   void Pipeline::Stop() {
 
+    // The fused executor never waits on the messengers.
+    if (fused_executor != nullptr) {
+      fused_executor->Stop();
+      return;
+    }
+
     localization_collision_messenger->Stop();
     localization_traffic_light_messenger->Stop();
     localization_planner_messenger->Stop();
@@ -207,4 +376,52 @@ namespace PipelineConstants {
     control_stage->Stop();
   }
 
+
+  PipelineStatistics Pipeline::GetStatistics() const {
+
+    PipelineStatistics statistics;
+
+    statistics.emplace_back("localization.action", localization_stage->GetActionStatistics());
+    statistics.emplace_back("collision.action", collision_stage->GetActionStatistics());
+    statistics.emplace_back("traffic_light.action", traffic_light_stage->GetActionStatistics());
+    statistics.emplace_back("planner.action", planner_stage->GetActionStatistics());
+    statistics.emplace_back("control.action", control_stage->GetActionStatistics());
+
+    auto add_skipped = [&statistics] (const std::string &name, uint64_t skipped_updates) {
+      TimingStatistics skipped;
+      skipped.count = skipped_updates;
+      statistics.emplace_back(name + ".skipped", skipped);
+    };
+    add_skipped("localization", localization_stage->GetSkippedUpdates());
+    add_skipped("collision", collision_stage->GetSkippedUpdates());
+    add_skipped("traffic_light", traffic_light_stage->GetSkippedUpdates());
+
+    auto add_messenger = [&statistics] (const std::string &name, const MessengerStatistics &messenger) {
+      TimingStatistics send;
+      send.count = messenger.messages_sent;
+      send.average = messenger.average_send_wait;
+      send.maximum = messenger.maximum_send_wait;
+      TimingStatistics receive;
+      receive.count = messenger.messages_received;
+      receive.average = messenger.average_receive_wait;
+      receive.maximum = messenger.maximum_receive_wait;
+      statistics.emplace_back(name + ".send_wait", send);
+      statistics.emplace_back(name + ".receive_wait", receive);
+    };
+    add_messenger("localization_collision", localization_collision_messenger->GetStatistics());
+    add_messenger("localization_traffic_light", localization_traffic_light_messenger->GetStatistics());
+    add_messenger("localization_planner", localization_planner_messenger->GetStatistics());
+    add_messenger("collision_planner", collision_planner_messenger->GetStatistics());
+    add_messenger("traffic_light_planner", traffic_light_planner_messenger->GetStatistics());
+    add_messenger("planner_control", planner_control_messenger->GetStatistics());
+
+    statistics.emplace_back("control.apply_batch", control_stage->GetApplyBatchStatistics());
+    statistics.emplace_back("control.latency", control_stage->GetControlLatencyStatistics());
+    if (fused_executor != nullptr) {
+      statistics.emplace_back("fused.traversal", fused_executor->GetTraversalStatistics());
+    }
+
+    return statistics;
+  }
+
 }
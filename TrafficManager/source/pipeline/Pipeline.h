@@ -1,25 +1,37 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
+#include <map>
 #include <memory>
 #include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
 
 #include "carla/client/Actor.h"
+#include "carla/client/ActorList.h"
 #include "carla/client/BlueprintLibrary.h"
 #include "carla/client/Map.h"
 #include "carla/client/World.h"
+#include "carla/client/WorldSnapshot.h"
+#include "carla/geom/Math.h"
 #include "carla/geom/Transform.h"
 #include "carla/Logging.h"
 #include "carla/Memory.h"
 #include "carla/rpc/Command.h"
+#include "carla/rpc/CommandResponse.h"
 
+#include "ActionPool.h"
 #include "BatchControlStage.h"
 #include "CollisionStage.h"
+#include "FusedExecutor.h"
 #include "InMemoryMap.h"
 #include "LocalizationStage.h"
 #include "MotionPlannerStage.h"
+#include "TimingStatistics.h"
 #include "TrafficLightStage.h"
 
 #define EXPECT_TRUE(pred) if (!(pred)) { throw std::runtime_error(# pred); }
@@ -34,18 +46,83 @@ namespace cr = carla::rpc;
   /// Function to read hardware concurrency.
   uint read_core_count();
 
-  /// Function to spawn a specified number of vehicles.
+  /// Part of the map owned by one of several traffic manager processes driving
+  /// the same simulation. The spawn points are split into regions of
+  /// consecutive grid columns along x, holding about the same number of spawn
+  /// points each. Every process spawns and controls the vehicles of its own
+  /// region and sends its own batches of commands. The vehicles of the other
+  /// processes are seen in the world snapshot like any vehicle spawned outside
+  /// of traffic manager.
+  struct ShardConfiguration {
+    /// Position of this process among the shards, smaller than count.
+    uint index = 0u;
+    /// Number of traffic manager processes, 1 disables sharding.
+    uint count = 1u;
+  };
+
+  /// Function to select the spawn points in the region of @a shard.
+  std::vector<cg::Transform> select_shard_spawn_points(
+      const std::vector<cg::Transform> &spawn_points,
+      const ShardConfiguration &shard);
+
+  /// Function to select the spawn points with no actor of @a world_snapshot
+  /// close enough to collide with a vehicle spawned there.
+  std::vector<cg::Transform> select_free_spawn_points(
+      const std::vector<cg::Transform> &spawn_points,
+      const cc::WorldSnapshot &world_snapshot);
+
+  /// Function to spawn a specified number of vehicles, in the region of
+  /// @a shard only if several processes share the simulation. The vehicles
+  /// are spawned in batches at the free spawn points, each failure is logged
+  /// and retried once at another point. With @a enable_autopilot the
+  /// simulator autopilot is enabled in the same batch.
   std::vector<ActorPtr> spawn_traffic(
       cc::Client &client,
       cc::World &world,
       uint core_count,
-      uint target_amount);
+      uint target_amount,
+      const ShardConfiguration &shard = ShardConfiguration(),
+      bool enable_autopilot = false);
 
   /// Destroy actors.
   void destroy_traffic(
       std::vector<ActorPtr> &actor_list,
       cc::Client &client);
 
+  /// How often the stages update every vehicle. With the defaults every stage
+  /// updates every vehicle every tick, the skipped updates carry the results
+  /// of the previous tick forward.
+  struct StageUpdateRates {
+    /// Number of ticks between the collision checks of a vehicle with no
+    /// other vehicle around.
+    uint isolated_collision_divisor = 1u;
+    /// Number of ticks between the traffic light checks of a vehicle
+    /// approaching a junction. The other vehicles are never checked.
+    uint traffic_light_divisor = 1u;
+    /// Fraction of the horizon below which a waypoint buffer is refilled.
+    float buffer_refill_threshold = 1.0f;
+  };
+
+  /// How the stages of the pipeline are run.
+  enum class PipelineExecution {
+    /// Every stage on its own receiver and sender threads, handing frames
+    /// over to the next stages through messengers.
+    Staged,
+    /// Every stage once per world tick on a single FusedExecutor thread.
+    /// Meant for the simulator in synchronous mode, the command batches are
+    /// sent as soon as they are computed.
+    Fused
+  };
+
+  /// Timing of a running pipeline, each entry named after what it measures:
+  /// "<stage>.action" for the Action() runs of a stage, "<messenger>.send_wait"
+  /// and "<messenger>.receive_wait" for the hand-offs between stages, and
+  /// "control.apply_batch" and "control.latency" for the delivery of the
+  /// commands, and "fused.traversal" for the ticks run by a fused pipeline.
+  /// Durations in microseconds. The count of "<stage>.skipped" is the number
+  /// of vehicle updates skipped by the stage.
+  using PipelineStatistics = std::vector<std::pair<std::string, TimingStatistics>>;
+
   /// The function of this class is to integrate all the various stages of
   /// the traffic manager appropriately using messengers.
   class Pipeline {
@@ -56,7 +133,7 @@ namespace cr = carla::rpc;
     std::vector<float> longitudinal_PID_parameters;
     std::vector<float> longitudinal_highway_PID_parameters;
     std::vector<float> lateral_PID_parameters;
-    /// The number of working threads per stage.
+    /// The minimum number of workers of the shared action pool.
     uint pipeline_width;
     /// Target velocities.
     float highway_target_velocity;
@@ -71,6 +148,10 @@ namespace cr = carla::rpc;
     cc::Client &client_connection;
     /// Reference to Carla's world object.
     cc::World &world;
+    /// Delivery mode of the control commands.
+    BatchControlMode control_mode;
+    /// How the stages are run.
+    PipelineExecution execution;
     /// Pointers to messenger objects connecting stage pairs.
     std::shared_ptr<CollisionToPlannerMessenger> collision_planner_messenger;
     std::shared_ptr<LocalizationToCollisionMessenger> localization_collision_messenger;
@@ -78,12 +159,16 @@ namespace cr = carla::rpc;
     std::shared_ptr<LocalizationToPlannerMessenger> localization_planner_messenger;
     std::shared_ptr<PlannerToControlMessenger> planner_control_messenger;
     std::shared_ptr<TrafficLightToPlannerMessenger> traffic_light_planner_messenger;
+    /// Work-stealing pool executing the actions of all the stages.
+    std::shared_ptr<ActionPool> action_pool;
     /// Pointers to the stage objects of traffic manager.
     std::unique_ptr<CollisionStage> collision_stage;
     std::unique_ptr<BatchControlStage> control_stage;
     std::unique_ptr<LocalizationStage> localization_stage;
     std::unique_ptr<MotionPlannerStage> planner_stage;
     std::unique_ptr<TrafficLightStage> traffic_light_stage;
+    /// Executor running the stages in fused execution, null otherwise.
+    std::unique_ptr<FusedExecutor> fused_executor;
 
   public:
 
@@ -98,12 +183,27 @@ namespace cr = carla::rpc;
         cc::Client &client_connection,
         cc::World &world,
         cc::DebugHelper &debug_helper,
-        uint pipeline_width);
+        uint pipeline_width,
+        BatchControlMode control_mode = BatchControlMode::Throttled,
+        PipelineExecution execution = PipelineExecution::Staged);
 
     /// To start the pipeline.
     void Start();
     /// To stop the pipeline.
     void Stop();
+    /// Sets how often the stages update every vehicle, to be called before
+    /// Start().
+    void SetUpdateRates(const StageUpdateRates &rates);
+    /// Registers @a vehicles with the running pipeline, each one from the
+    /// first tick it appears in the world snapshot. The stages keep the state
+    /// of the vehicles already registered. Safe to call from any thread.
+    void RegisterVehicles(const std::vector<ActorPtr> &vehicles);
+    /// Unregisters the vehicles @a vehicle_ids from the next tick on, the
+    /// vehicles are left with the last control applied. Safe to call from any
+    /// thread.
+    void UnregisterVehicles(const std::vector<carla::ActorId> &vehicle_ids);
+    /// Returns the timing accumulated since the pipeline started.
+    PipelineStatistics GetStatistics() const;
 
   };
 
@@ -6,25 +6,32 @@ namespace traffic_manager {
       uint pool_size,
       uint number_of_vehicles)
     : pool_size(pool_size),
-      number_of_vehicles(number_of_vehicles) {
+      number_of_vehicles(number_of_vehicles),
+      grain_size(0u) {
 
-    action_start_counter.store(0u);
-    action_finished_counter.store(0u);
+    skipped_updates.store(0u);
     run_stage.store(true);
     run_receiver.store(true);
-    run_threads.store(false);
     run_sender.store(false);
   }
 
   PipelineStage::~PipelineStage() {}
 
+  void PipelineStage::SetActionPool(std::shared_ptr<ActionPool> pool) {
+    action_pool = pool;
+  }
+
+  void PipelineStage::SetGrainSize(uint grain) {
+    grain_size = grain;
+  }
+
   void PipelineStage::Start() {
 
-    data_receiver = std::make_unique<std::thread>(&PipelineStage::ReceiverThreadManager, this);
-    for (uint i = 0u; i < pool_size; ++i) {
-      action_threads.push_back(
-          std::make_unique<std::thread>(&PipelineStage::ActionThreadManager, this, i));
+    if (action_pool == nullptr) {
+      action_pool = std::make_shared<ActionPool>(pool_size);
     }
+
+    data_receiver = std::make_unique<std::thread>(&PipelineStage::ReceiverThreadManager, this);
     data_sender = std::make_unique<std::thread>(&PipelineStage::SenderThreadManager, this);
 
   }
@@ -32,14 +39,19 @@ namespace traffic_manager {
   void PipelineStage::Stop() {
     run_stage.store(false);
     data_receiver->join();
-    for (auto &action: action_threads) {
-      action->join();
-    }
     data_sender->join();
   }
 
+  TimingStatistics PipelineStage::GetActionStatistics() const {
+    return action_timing.Get();
+  }
+
   void PipelineStage::ReceiverThreadManager() {
 
+    const ActionPool::RangeAction action = [this] (const uint start_index, const uint end_index) {
+      Action(start_index, end_index);
+    };
+
     while (run_stage.load()) {
       std::unique_lock<std::mutex> lock(thread_coordination_mutex);
       // Wait for notification from sender thread and
@@ -53,71 +65,21 @@ namespace traffic_manager {
       if (run_stage.load()) {
         DataReceiver();
       }
-
-      // Wait for all worker threads to reach start condition.
-      while (action_start_counter.load() < pool_size && run_stage.load()) {
-        wake_receiver_notifier.wait_for(lock, 1ms, [=] {return action_start_counter.load() == pool_size;});
-      }
-
-      // Start all workers.
-      run_threads.store(true);
-      action_start_counter.store(0u);
-      action_finished_counter.store(0u);
-
-      wake_action_notifier.notify_all();
       lock.unlock();
-    }
-  }
-
-  void PipelineStage::ActionThreadManager(const uint thread_id) {
 
-    uint array_size = number_of_vehicles;
-    uint load_per_thread = static_cast<uint>(std::floor(array_size / pool_size));
-
-    while (run_stage.load()) {
-
-      std::unique_lock<std::mutex> lock(thread_coordination_mutex);
-
-      // Notify receiver after all worker threads reach start condition.
-      ++action_start_counter;
-      if (action_start_counter == pool_size) {
-        wake_receiver_notifier.notify_one();
+      // Run the action over all vehicles on the pool, this thread helps
+      // executing chunks until every one of them is done.
+      if (run_stage.load()) {
+        const auto start = chr::steady_clock::now();
+        action_pool->ParallelFor(number_of_vehicles, grain_size, action);
+        action_timing.Add(TimingAccumulator::ElapsedMicroseconds(start));
       }
 
-      // Wait for receiver to send a start command.
-      while (!run_threads.load() && run_stage.load()) {
-        wake_action_notifier.wait_for(lock, 1ms, [=] {return run_threads.load();});
-      }
+      // Notify sender.
+      lock.lock();
+      run_sender.store(true);
+      wake_sender_notifier.notify_one();
       lock.unlock();
-
-      uint array_start_index = thread_id * load_per_thread;
-
-      uint array_end_index;
-      if (thread_id == pool_size - 1) {
-        array_end_index = array_size - 1;
-      } else {
-        array_end_index = (thread_id + 1) * load_per_thread - 1;
-      }
-
-      // Run action.
-      Action(array_start_index, array_end_index);
-      ++action_finished_counter;
-
-      // Wait for all workers to finish.
-      while (action_finished_counter.load() < pool_size && run_stage.load()) {
-        std::this_thread::sleep_for(1us);
-      }
-
-      if (run_threads.load()) {
-        run_threads.store(false);
-      }
-
-      // Arbitrarily choosing last thread to notify sender
-      // after all worker threads are done the processing.
-      if (thread_id == pool_size - 1) {
-        run_sender.store(true);
-        wake_sender_notifier.notify_one();
-      }
     }
   }
 
@@ -126,7 +88,7 @@ namespace traffic_manager {
     while (run_stage.load()) {
       std::unique_lock<std::mutex> lock(thread_coordination_mutex);
 
-      // Wait for notification from worker threads.
+      // Wait for notification from the receiver thread.
       while (!run_sender.load() && run_stage.load()) {
         wake_sender_notifier.wait_for(lock, 1ms, [=] {return run_sender.load();});
       }
@@ -12,7 +12,9 @@
 
 #include "carla/rpc/ActorId.h"
 
+#include "ActionPool.h"
 #include "Messenger.h"
+#include "TimingStatistics.h"
 
 using namespace std::chrono_literals;
 
@@ -20,45 +22,51 @@ namespace traffic_manager {
 
   /// This class provides base functionality and template for
   /// various stages of the pipeline.
+  ///
+  /// The Action() work of a stage is chunked and executed on an ActionPool,
+  /// which is normally shared by all the stages of the pipeline. A stage
+  /// started without a pool being set creates a private one of pool_size
+  /// workers.
   class PipelineStage {
 
+    /// Runs the stages on its own thread instead of starting them, and
+    /// records their action timing.
+    friend class FusedExecutor;
+
   private:
 
-    /// Number of worker threads.
+    /// Number of worker threads of the private pool.
     const uint pool_size;
-    /// Number of registered vehicles.
-    const uint number_of_vehicles;
+    /// Number of registered vehicles, only touched by the receiver thread.
+    uint number_of_vehicles;
+    /// Maximum number of vehicles per chunk submitted to the pool, zero picks
+    /// it automatically.
+    uint grain_size;
+    /// Pool executing the Action() chunks.
+    std::shared_ptr<ActionPool> action_pool;
     /// Pointer to receiver thread instance.
     std::unique_ptr<std::thread> data_receiver;
     /// Pointer to sender thread instance.
     std::unique_ptr<std::thread> data_sender;
-    /// Pointers to worker thread instances.
-    std::vector<std::unique_ptr<std::thread>> action_threads;
-    /// Counter to track every worker's start condition.
-    std::atomic<uint> action_start_counter;
-    /// Counter to track every worker's finish condition.
-    std::atomic<uint> action_finished_counter;
     /// Flag to allow/block receiver.
     std::atomic<bool> run_receiver;
     /// Flag to allow/block sender.
     std::atomic<bool> run_sender;
-    /// Flag to allow/block workers.
-    std::atomic<bool> run_threads;
     /// Flag to start/stop stage.
     std::atomic<bool> run_stage;
-    /// Mutex used to co-ordinate between receiver, workers, and sender.
+    /// Mutex used to co-ordinate between receiver and sender.
     std::mutex thread_coordination_mutex;
-    /// Variables to conditionally block receiver, workers, and sender.
+    /// Variables to conditionally block receiver and sender.
     std::condition_variable wake_receiver_notifier;
-    std::condition_variable wake_action_notifier;
     std::condition_variable wake_sender_notifier;
+    /// Duration of the Action() runs over all the vehicles.
+    TimingAccumulator action_timing;
+    /// Number of vehicle updates skipped by the schedule of the stage.
+    std::atomic<uint64_t> skipped_updates;
 
-    /// Method to manage receiver thread.
+    /// Method to manage receiver thread, it also runs the actions.
     void ReceiverThreadManager();
 
-    /// Method to manage worker threads.
-    void ActionThreadManager(const uint thread_id);
-
     /// Method to manage sender thread.
     void SenderThreadManager();
 
@@ -75,16 +83,44 @@ namespace traffic_manager {
     /// Implement this method with logic to process data inside the stage
     virtual void Action(const uint start_index, const uint end_index) = 0;
 
+    /// Counts @a count vehicle updates skipped by Action(), whose previous
+    /// results were carried forward.
+    void AddSkippedUpdates(uint count) {
+      skipped_updates.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /// Sets the number of vehicles the next Action() run covers, to be called
+    /// from DataReceiver() when the registered vehicles change.
+    void SetNumberOfVehicles(uint count) {
+      number_of_vehicles = count;
+    }
+
   public:
 
     PipelineStage(uint pool_size, uint number_of_vehicles);
 
     virtual ~PipelineStage();
 
+    /// Sets the pool executing the actions, to be called before Start().
+    void SetActionPool(std::shared_ptr<ActionPool> pool);
+
+    /// Sets the maximum number of vehicles per chunk, to be called before
+    /// Start().
+    void SetGrainSize(uint grain);
+
     void Start();
 
     void Stop();
 
+    /// Returns the timing of the Action() runs so far, each one covering all
+    /// the vehicles.
+    TimingStatistics GetActionStatistics() const;
+
+    /// Returns the number of vehicle updates skipped so far.
+    uint64_t GetSkippedUpdates() const {
+      return skipped_updates.load(std::memory_order_relaxed);
+    }
+
   };
 
 }
@@ -2,63 +2,60 @@
 
 namespace traffic_manager {
 
-  using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
-
-  SimpleWaypoint::SimpleWaypoint(WaypointPtr _waypoint) {
+  SimpleWaypoint::SimpleWaypoint(WaypointPtr _waypoint, NodeIndex _index) {
     waypoint = _waypoint;
-    next_left_waypoint = nullptr;
-    next_right_waypoint = nullptr;
+    location = waypoint->GetTransform().location;
+    forward_vector = waypoint->GetTransform().rotation.GetForwardVector();
+    junction = waypoint->IsJunction();
+    road_id = waypoint->GetRoadId();
+    section_id = waypoint->GetSectionId();
+    lane_id = waypoint->GetLaneId();
+    distance_along_road = waypoint->GetDistance();
+    index = _index;
+    next_left_waypoint = INVALID_NODE;
+    next_right_waypoint = INVALID_NODE;
+    traffic_light = INVALID_TRAFFIC_LIGHT;
+    distance_to_junction = std::numeric_limits<float>::infinity();
+    distance_to_branch = std::numeric_limits<float>::infinity();
   }
   SimpleWaypoint::~SimpleWaypoint() {}
 
-  std::vector<SimpleWaypointPtr> SimpleWaypoint::GetNextWaypoint() const {
-    return next_waypoints;
-  }
-
   WaypointPtr SimpleWaypoint::GetWaypoint() const {
     return waypoint;
   }
 
-  SimpleWaypointPtr SimpleWaypoint::GetLeftWaypoint() {
+  NodeIndex SimpleWaypoint::GetLeftWaypoint() const {
     return next_left_waypoint;
   }
 
-  SimpleWaypointPtr SimpleWaypoint::GetRightWaypoint() {
+  NodeIndex SimpleWaypoint::GetRightWaypoint() const {
     return next_right_waypoint;
   }
 
-  cg::Location SimpleWaypoint::GetLocation() const {
-    return waypoint->GetTransform().location;
-  }
-
-  cg::Vector3D SimpleWaypoint::GetForwardVector() const {
-    return waypoint->GetTransform().rotation.GetForwardVector();
-  }
-
-  uint SimpleWaypoint::SetNextWaypoint(const std::vector<SimpleWaypointPtr> &waypoints) {
-    for (auto &simple_waypoint: waypoints) {
+  uint SimpleWaypoint::SetNextWaypoint(const std::vector<NodeIndex> &waypoints) {
+    for (NodeIndex simple_waypoint: waypoints) {
       next_waypoints.push_back(simple_waypoint);
     }
     return waypoints.size();
   }
 
-  void SimpleWaypoint::SetLeftWaypoint(SimpleWaypointPtr _waypoint) {
+  void SimpleWaypoint::SetLeftWaypoint(const SimpleWaypoint &_waypoint) {
 
-    cg::Vector3D heading_vector = waypoint->GetTransform().GetForwardVector();
-    cg::Vector3D relative_vector = GetLocation() - _waypoint->GetLocation();
+    const cg::Vector3D &heading_vector = forward_vector;
+    cg::Vector3D relative_vector = GetLocation() - _waypoint.GetLocation();
     if ((heading_vector.x*relative_vector.y - heading_vector.y*relative_vector.x) > 0) {
-      next_left_waypoint = _waypoint;
+      next_left_waypoint = _waypoint.GetIndex();
     } else {
       throw std::invalid_argument("Argument not on the left side!");
     }
   }
 
-  void SimpleWaypoint::SetRightWaypoint(SimpleWaypointPtr _waypoint) {
+  void SimpleWaypoint::SetRightWaypoint(const SimpleWaypoint &_waypoint) {
 
-    cg::Vector3D heading_vector = waypoint->GetTransform().GetForwardVector();
-    cg::Vector3D relative_vector = GetLocation() - _waypoint->GetLocation();
+    const cg::Vector3D &heading_vector = forward_vector;
+    cg::Vector3D relative_vector = GetLocation() - _waypoint.GetLocation();
     if ((heading_vector.x*relative_vector.y - heading_vector.y*relative_vector.x) < 0) {
-      next_left_waypoint = _waypoint;
+      next_right_waypoint = _waypoint.GetIndex();
     } else {
       throw std::invalid_argument("Argument not on the right side!");
     }
@@ -68,20 +65,20 @@ namespace traffic_manager {
     return GetLocation().Distance(location);
   }
 
-  float SimpleWaypoint::Distance(const SimpleWaypointPtr &other) const {
-    return GetLocation().Distance(other->GetLocation());
+  float SimpleWaypoint::Distance(const SimpleWaypoint &other) const {
+    return GetLocation().Distance(other.GetLocation());
   }
 
   float SimpleWaypoint::DistanceSquared(const cg::Location &location) const {
     return cg::Math::DistanceSquared(GetLocation(), location);
   }
 
-  float SimpleWaypoint::DistanceSquared(const SimpleWaypointPtr &other) const {
-    return cg::Math::DistanceSquared(GetLocation(), other->GetLocation());
+  float SimpleWaypoint::DistanceSquared(const SimpleWaypoint &other) const {
+    return cg::Math::DistanceSquared(GetLocation(), other.GetLocation());
   }
 
   bool SimpleWaypoint::CheckJunction() const {
-    return waypoint->IsJunction();
+    return junction;
   }
 
 }
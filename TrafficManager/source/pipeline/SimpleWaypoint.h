@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
 #include <memory.h>
 
+#include "boost/container/small_vector.hpp"
 #include "carla/client/Waypoint.h"
 #include "carla/geom/Location.h"
 #include "carla/geom/Math.h"
@@ -14,68 +17,174 @@ namespace traffic_manager {
 namespace cc = carla::client;
 namespace cg = carla::geom;
   using WaypointPtr = carla::SharedPtr<cc::Waypoint>;
+  /// Position of a waypoint in the dense topology of the local map.
+  using NodeIndex = uint32_t;
+  /// Index standing in for a missing link.
+  static constexpr NodeIndex INVALID_NODE = std::numeric_limits<NodeIndex>::max();
+  /// Position of a traffic light in the list of lights linked to the local map.
+  using TrafficLightIndex = uint32_t;
+  /// Index standing in for a waypoint not controlled by a traffic light.
+  static constexpr TrafficLightIndex INVALID_TRAFFIC_LIGHT =
+      std::numeric_limits<TrafficLightIndex>::max();
+  /// List of links to next waypoints, most waypoints have a single one.
+  using NextNodeList = boost::container::small_vector<NodeIndex, 2>;
 
   /// This is a simple wrapper class on Carla's waypoint object.
   /// The class is used to represent discrete samples of the world map.
+  /// Waypoints are stored contiguously in the dense topology of the local map
+  /// and link to each other through their indices in it.
   class SimpleWaypoint {
 
-    using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
-
   private:
 
     /// Pointer to Carla's waypoint object around which this class wraps around.
     WaypointPtr waypoint;
-    /// List of pointers to next connecting waypoints.
-    std::vector<SimpleWaypointPtr> next_waypoints;
-    /// Pointer to left lane change waypoint.
-    SimpleWaypointPtr next_left_waypoint;
-    /// Pointer to right lane change waypoint.
-    SimpleWaypointPtr next_right_waypoint;
+    /// Location and direction of the waypoint, kept inline for fast access.
+    cg::Location location;
+    cg::Vector3D forward_vector;
+    /// Whether the waypoint belongs to an intersection.
+    bool junction;
+    /// OpenDRIVE lane of the waypoint and its distance along the road.
+    uint32_t road_id;
+    uint32_t section_id;
+    int32_t lane_id;
+    double distance_along_road;
+    /// Position of this waypoint in the dense topology.
+    NodeIndex index;
+    /// List of indices of next connecting waypoints.
+    NextNodeList next_waypoints;
+    /// Index of left lane change waypoint.
+    NodeIndex next_left_waypoint;
+    /// Index of right lane change waypoint.
+    NodeIndex next_right_waypoint;
+    /// Traffic light controlling the entry to the junction ahead.
+    TrafficLightIndex traffic_light;
+    /// Shortest distance along the lanes to a waypoint in a junction, and to
+    /// a waypoint with several next waypoints.
+    float distance_to_junction;
+    float distance_to_branch;
 
   public:
 
-    SimpleWaypoint(WaypointPtr _waypoint);
+    SimpleWaypoint(WaypointPtr _waypoint, NodeIndex _index);
     ~SimpleWaypoint();
 
     /// Returns the location object for this waypoint.
-    cg::Location GetLocation() const;
+    const cg::Location &GetLocation() const {
+      return location;
+    }
 
     /// Returns a carla::shared_ptr to carla::waypoint.
     WaypointPtr GetWaypoint() const;
 
-    /// Returns the list of next waypoints.
-    std::vector<SimpleWaypointPtr> GetNextWaypoint() const;
+    /// Returns the OpenDRIVE road, lane section and lane of the waypoint.
+    uint32_t GetRoadId() const {
+      return road_id;
+    }
+
+    uint32_t GetSectionId() const {
+      return section_id;
+    }
+
+    int32_t GetLaneId() const {
+      return lane_id;
+    }
+
+    /// Returns the distance along the road of the waypoint, the s coordinate
+    /// of OpenDRIVE.
+    double GetDistanceAlongRoad() const {
+      return distance_along_road;
+    }
+
+    /// Returns true if both waypoints are on the same lane of the same lane
+    /// section.
+    bool IsSameLane(const SimpleWaypoint &other) const {
+      return road_id == other.road_id &&
+             section_id == other.section_id &&
+             lane_id == other.lane_id;
+    }
+
+    /// Returns +1 if the lane runs along increasing distances along the road
+    /// and -1 otherwise.
+    float GetLaneDirection() const {
+      return lane_id < 0 ? 1.0f : -1.0f;
+    }
+
+    /// Returns the position of this waypoint in the dense topology.
+    NodeIndex GetIndex() const {
+      return index;
+    }
+
+    /// Returns the list of indices of next waypoints.
+    const NextNodeList &GetNextWaypoint() const {
+      return next_waypoints;
+    }
 
     /// Returns the vector along the waypoint's direction.
-    cg::Vector3D GetForwardVector() const;
+    const cg::Vector3D &GetForwardVector() const {
+      return forward_vector;
+    }
 
     /// This method is used to set the next waypoints.
-    uint SetNextWaypoint(const std::vector<SimpleWaypointPtr> &next_waypoints);
+    uint SetNextWaypoint(const std::vector<NodeIndex> &next_waypoints);
 
     /// This method is used to set the closest left waypoint for a lane change.
-    void SetLeftWaypoint(SimpleWaypointPtr waypoint);
+    void SetLeftWaypoint(const SimpleWaypoint &waypoint);
 
     /// This method is used to set the closest right waypoint for a lane change.
-    void SetRightWaypoint(SimpleWaypointPtr waypoint);
-
-    /// This method is used to get the closest left waypoint for a lane change.
-    SimpleWaypointPtr GetLeftWaypoint();
-
-    /// This method is used to get the closest right waypoint for a lane change.
-    SimpleWaypointPtr GetRightWaypoint();
+    void SetRightWaypoint(const SimpleWaypoint &waypoint);
+
+    /// This method is used to get the index of the closest left waypoint for
+    /// a lane change, INVALID_NODE if there is none.
+    NodeIndex GetLeftWaypoint() const;
+
+    /// This method is used to get the index of the closest right waypoint for
+    /// a lane change, INVALID_NODE if there is none.
+    NodeIndex GetRightWaypoint() const;
+
+    /// This method is used to set the traffic light controlling the entry to
+    /// the junction ahead of this waypoint.
+    void SetTrafficLight(TrafficLightIndex light) {
+      traffic_light = light;
+    }
+
+    /// Returns the traffic light controlling the entry to the junction ahead
+    /// of this waypoint, INVALID_TRAFFIC_LIGHT if there is none.
+    TrafficLightIndex GetTrafficLight() const {
+      return traffic_light;
+    }
+
+    /// This method is used to set the distances along the lanes computed by
+    /// the local map.
+    void SetPathDistances(float junction_distance, float branch_distance) {
+      distance_to_junction = junction_distance;
+      distance_to_branch = branch_distance;
+    }
+
+    /// Returns the shortest distance along the lanes to a waypoint inside a
+    /// junction, 0 inside one and infinite if there is none close by.
+    float GetDistanceToJunction() const {
+      return distance_to_junction;
+    }
+
+    /// Returns the shortest distance along the lanes to a waypoint with
+    /// several next waypoints, infinite if there is none close by.
+    float GetDistanceToBranch() const {
+      return distance_to_branch;
+    }
 
     /// Calculates the distance from the object's waypoint to the passed
     /// location.
     float Distance(const cg::Location &location) const;
 
     /// Calculates the distance the other SimpleWaypoint object.
-    float Distance(const SimpleWaypointPtr &other) const;
+    float Distance(const SimpleWaypoint &other) const;
 
     /// Calculates the square of the distance to given location.
     float DistanceSquared(const cg::Location &location) const;
 
     /// Calculates the square of the distance to other waypoints.
-    float DistanceSquared(const SimpleWaypointPtr &other) const;
+    float DistanceSquared(const SimpleWaypoint &other) const;
 
     /// Returns true if the object's waypoint belongs to an intersection.
     bool CheckJunction() const;
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace traffic_manager {
+
+namespace chr = std::chrono;
+
+  /// Snapshot of the counters of a TimingAccumulator, durations in
+  /// microseconds.
+  struct TimingStatistics {
+    uint64_t count = 0u;
+    double average = 0.0;
+    double maximum = 0.0;
+  };
+
+  /// Accumulates the count, total and maximum of a duration measured over and
+  /// over. Written by a single thread, read from any.
+  class TimingAccumulator {
+
+  private:
+
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> maximum;
+
+  public:
+
+    TimingAccumulator() : count(0u), total(0u), maximum(0u) {}
+
+    /// Microseconds elapsed since @a start.
+    static uint64_t ElapsedMicroseconds(chr::steady_clock::time_point start) {
+      return static_cast<uint64_t>(
+          chr::duration_cast<chr::microseconds>(chr::steady_clock::now() - start).count());
+    }
+
+    void Add(uint64_t microseconds) {
+      count.store(count.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+      total.store(total.load(std::memory_order_relaxed) + microseconds, std::memory_order_relaxed);
+      if (microseconds > maximum.load(std::memory_order_relaxed)) {
+        maximum.store(microseconds, std::memory_order_relaxed);
+      }
+    }
+
+    TimingStatistics Get() const {
+      TimingStatistics statistics;
+      statistics.count = count.load(std::memory_order_relaxed);
+      if (statistics.count > 0u) {
+        statistics.average =
+            static_cast<double>(total.load(std::memory_order_relaxed)) /
+            static_cast<double>(statistics.count);
+      }
+      statistics.maximum = static_cast<double>(maximum.load(std::memory_order_relaxed));
+      return statistics;
+    }
+
+  };
+
+}
@@ -8,124 +8,113 @@ namespace TrafficDistributorConstants {
   static const float LANE_CHANGE_OBSTACLE_DISTANCE = 20.0f;
   static const float LANE_OBSTACLE_MINIMUM_DISTANCE = 10.0f;
   static const float APPROACHING_VEHICLE_TIME_MARGIN = 2.0f;
+  static const float LANE_WINDOW_MARGIN = 5.0f;
 }
   using namespace TrafficDistributorConstants;
 
-  TrafficDistributor::TrafficDistributor() {}
+  TrafficDistributor::TrafficDistributor(uint number_of_vehicles)
+    : vehicle_records(number_of_vehicles) {}
 
   TrafficDistributor::~TrafficDistributor() {}
 
-  void TrafficDistributor::SetVehicleId(ActorId vehicle_id, GeoIds ids) {
-
-    std::unique_lock<std::shared_timed_mutex> lock(distributor_mutex);
-    if (road_to_vehicle_id_map.find(ids) != road_to_vehicle_id_map.end()) {
-      road_to_vehicle_id_map.at(ids).insert(vehicle_id);
-    } else {
-      road_to_vehicle_id_map.insert({ids, std::unordered_set<ActorId>()});
-      road_to_vehicle_id_map.at(ids).insert(vehicle_id);
-    }
+  void TrafficDistributor::UpdateVehicleRoadPosition(
+      uint vehicle_index,
+      GeoIds road_ids,
+      const SimpleWaypoint &front_waypoint) {
+
+    VehicleRecord &record = vehicle_records.at(vehicle_index);
+    record.recorded = true;
+    record.lane = road_ids;
+    record.position.vehicle_index = vehicle_index;
+    record.position.s = static_cast<float>(front_waypoint.GetWaypoint()->GetDistance());
+    record.position.location = front_waypoint.GetLocation();
+    record.position.in_junction = front_waypoint.CheckJunction();
   }
 
-  void TrafficDistributor::EraseVehicleId(ActorId vehicle_id, GeoIds ids) {
+  void TrafficDistributor::Remap(const IndexRemap &remap) {
 
-    std::unique_lock<std::shared_timed_mutex> lock(distributor_mutex);
-    if (road_to_vehicle_id_map.find(ids) != road_to_vehicle_id_map.end()) {
-      road_to_vehicle_id_map.at(ids).erase(vehicle_id);
+    RemapVehicleArray(vehicle_records, remap);
+    for (uint i = 0u; i < vehicle_records.size(); ++i) {
+      vehicle_records[i].position.vehicle_index = i;
     }
   }
 
-  void TrafficDistributor::SetRoadIds(ActorId vehicle_id, GeoIds ids) {
+  void TrafficDistributor::RebuildLanes() {
 
-    std::unique_lock<std::shared_timed_mutex> lock(distributor_mutex);
-    if (vehicle_id_to_road_map.find(vehicle_id) != vehicle_id_to_road_map.end()) {
-      vehicle_id_to_road_map.at(vehicle_id) = ids;
-    } else {
-      vehicle_id_to_road_map.insert({vehicle_id, ids});
+    for (auto &lane : lane_positions) {
+      lane.second.clear();
     }
-  }
-
-  GeoIds TrafficDistributor::GetRoadIds(ActorId vehicle_id) const {
-
-    std::shared_lock<std::shared_timed_mutex> lock(distributor_mutex);
-    if (vehicle_id_to_road_map.find(vehicle_id) != vehicle_id_to_road_map.end()) {
-      return vehicle_id_to_road_map.at(vehicle_id);
-    } else {
-      return {0, 0, 0};
+    for (const VehicleRecord &record : vehicle_records) {
+      if (record.recorded) {
+        lane_positions[record.lane].push_back(record.position);
+      }
     }
-  }
-
-  std::unordered_set<ActorId> TrafficDistributor::GetVehicleIds(GeoIds ids) const {
-
-    std::shared_lock<std::shared_timed_mutex> lock(distributor_mutex);
-    if (road_to_vehicle_id_map.find(ids) != road_to_vehicle_id_map.end()) {
-      return road_to_vehicle_id_map.at(ids);
-    } else {
-      return std::unordered_set<ActorId>();
+    for (auto &lane : lane_positions) {
+      std::sort(lane.second.begin(), lane.second.end(),
+          [] (const LanePosition &lhs, const LanePosition &rhs) { return lhs.s < rhs.s; });
     }
-
   }
 
-  void TrafficDistributor::UpdateVehicleRoadPosition(ActorId actor_id, GeoIds road_ids) {
+  const std::vector<LanePosition> &TrafficDistributor::GetLanePositions(GeoIds ids) const {
 
-    GeoIds old_ids = GetRoadIds(actor_id);
+    static const std::vector<LanePosition> empty_lane;
+    auto lane = lane_positions.find(ids);
+    return lane != lane_positions.end() ? lane->second : empty_lane;
+  }
 
-    if (road_ids.road_id != old_ids.road_id ||
-        road_ids.section_id != old_ids.section_id ||
-        road_ids.lane_id != old_ids.lane_id) {
+  /// Returns the vehicles of @a lane whose distance along the road is within
+  /// @a radius of @a s, as an iterator range.
+  static auto FindLaneWindow(const std::vector<LanePosition> &lane, float s, float radius) {
 
-      EraseVehicleId(actor_id, old_ids);
-      SetVehicleId(actor_id, road_ids);
-      SetRoadIds(actor_id, road_ids);
-    }
+    auto compare = [] (const LanePosition &position, float value) { return position.s < value; };
+    auto first = std::lower_bound(lane.begin(), lane.end(), s - radius, compare);
+    auto last = std::lower_bound(first, lane.end(), std::nextafter(s + radius, INFINITY), compare);
+    return std::make_pair(first, last);
   }
 
-  std::shared_ptr<SimpleWaypoint>
-  TrafficDistributor::AssignLaneChange(
-      Actor vehicle,
-      std::shared_ptr<SimpleWaypoint> current_waypoint,
+  NodeIndex TrafficDistributor::AssignLaneChange(
+      uint vehicle_index,
+      const VehicleStateSnapshot &snapshot,
+      const InMemoryMap &local_map,
+      NodeIndex current_waypoint,
       GeoIds current_road_ids,
-      std::shared_ptr<BufferList> buffer_list,
-      std::unordered_map<ActorId, uint> &vehicle_id_to_index,
-      std::vector<carla::SharedPtr<cc::Actor>> &actor_list,
       cc::DebugHelper &debug_helper) {
 
-    ActorId actor_id = vehicle->GetId();
-    cg::Location vehicle_location = vehicle->GetLocation();
-    float vehicle_velocity = vehicle->GetVelocity().Length();
-    std::unordered_set<ActorId> co_lane_vehicles = GetVehicleIds(current_road_ids);
+    const cg::Location &vehicle_location = snapshot.locations.at(vehicle_index);
+    const cg::Vector3D &vehicle_heading = snapshot.headings.at(vehicle_index);
+    float vehicle_velocity = snapshot.speeds.at(vehicle_index);
+    const std::vector<LanePosition> &co_lane_vehicles = GetLanePositions(current_road_ids);
 
     bool need_to_change_lane = false;
     // true -> left, false -> right
     bool lane_change_direction;
 
-    auto left_waypoint = current_waypoint->GetLeftWaypoint();
-    auto right_waypoint = current_waypoint->GetRightWaypoint();
+    const SimpleWaypoint &current_node = local_map.GetNode(current_waypoint);
+    NodeIndex left_waypoint = current_node.GetLeftWaypoint();
+    NodeIndex right_waypoint = current_node.GetRightWaypoint();
 
     // Don't try to change lane if the current lane has less than two vehicles.
     if (co_lane_vehicles.size() >= 2) {
 
-      // Check if any vehicle in the current lane is blocking us.
-      for (auto i = co_lane_vehicles.begin(); i != co_lane_vehicles.end() && !need_to_change_lane; ++i) {
-
-        const traffic_manager::ActorId &same_lane_vehicle_id = *i;
-        traffic_manager::Buffer &other_vehicle_buffer = buffer_list->at(
-            vehicle_id_to_index.at(same_lane_vehicle_id));
+      // Only the vehicles within the obstacle distance along the road can be
+      // blocking us, the margin covers the curvature of the lane.
+      const float vehicle_s = static_cast<float>(current_node.GetWaypoint()->GetDistance());
+      const auto window = FindLaneWindow(
+          co_lane_vehicles,
+          vehicle_s,
+          LANE_CHANGE_OBSTACLE_DISTANCE + LANE_WINDOW_MARGIN);
 
-        std::shared_ptr<traffic_manager::SimpleWaypoint> same_lane_vehicle_waypoint = nullptr;
-        cg::Location same_lane_location;
-        if (!other_vehicle_buffer.empty()) {
+      // Check if any vehicle in the current lane is blocking us.
+      for (auto i = window.first; i != window.second && !need_to_change_lane; ++i) {
 
-          same_lane_vehicle_waypoint = buffer_list->at(
-              vehicle_id_to_index.at(same_lane_vehicle_id)).front();
-          same_lane_location = same_lane_vehicle_waypoint->GetLocation();
-        }
+        const LanePosition &same_lane_vehicle = *i;
+        const cg::Location &same_lane_location = same_lane_vehicle.location;
 
         // Check if there is another vehicle in the current lane in front for
         // a threshold distance and current position not in a junction.
-        if (same_lane_vehicle_id != actor_id &&
-            same_lane_vehicle_waypoint != nullptr &&
-            !same_lane_vehicle_waypoint->CheckJunction() &&
-            DeviationDotProduct(vehicle, same_lane_location) > 0 &&
+        if (same_lane_vehicle.vehicle_index != vehicle_index &&
+            !same_lane_vehicle.in_junction &&
+            DeviationDotProduct(vehicle_location, vehicle_heading, same_lane_location) > 0 &&
             (same_lane_location.Distance(vehicle_location)
             < LANE_CHANGE_OBSTACLE_DISTANCE) &&
             (same_lane_location.Distance(vehicle_location)
@@ -134,23 +123,23 @@ namespace TrafficDistributorConstants {
           // If lane change connections are available,
           // pick a direction (preferring left) and
           // announce the need for a lane change.
-          if (left_waypoint != nullptr) {
-            traffic_manager::ActorIDSet left_lane_vehicles = GetVehicleIds({
+          if (left_waypoint != INVALID_NODE) {
+            const size_t left_lane_vehicles = GetLanePositions({
               current_road_ids.road_id,
               current_road_ids.section_id,
-              left_waypoint->GetWaypoint()->GetLaneId()
-            });
-            if (co_lane_vehicles.size() - left_lane_vehicles.size() > 1) {
+              local_map.GetNode(left_waypoint).GetWaypoint()->GetLaneId()
+            }).size();
+            if (co_lane_vehicles.size() > left_lane_vehicles + 1u) {
               need_to_change_lane = true;
               lane_change_direction = true;
             }
-          } else if (right_waypoint != nullptr) {
-            traffic_manager::ActorIDSet right_lane_vehicles = GetVehicleIds({
+          } else if (right_waypoint != INVALID_NODE) {
+            const size_t right_lane_vehicles = GetLanePositions({
               current_road_ids.road_id,
               current_road_ids.section_id,
-              right_waypoint->GetWaypoint()->GetLaneId()
-            });
-            if (co_lane_vehicles.size() - right_lane_vehicles.size() > 1) {
+              local_map.GetNode(right_waypoint).GetWaypoint()->GetLaneId()
+            }).size();
+            if (co_lane_vehicles.size() > right_lane_vehicles + 1u) {
               need_to_change_lane = true;
               lane_change_direction = false;
             }
@@ -167,7 +156,7 @@ namespace TrafficDistributorConstants {
       );
 
     bool possible_to_lane_change = false;
-    std::shared_ptr<traffic_manager::SimpleWaypoint> change_over_point;
+    NodeIndex change_over_point = INVALID_NODE;
     if (need_to_change_lane) {
 
       if (lane_change_direction) {
@@ -176,90 +165,78 @@ namespace TrafficDistributorConstants {
         change_over_point = right_waypoint;
       }
 
-      if (change_over_point != nullptr) {
+      if (change_over_point != INVALID_NODE) {
 
-        carla::road::LaneId lane_change_id = change_over_point->GetWaypoint()->GetLaneId();
-        traffic_manager::ActorIDSet target_lane_vehicles = GetVehicleIds({
+        const SimpleWaypoint &change_over_waypoint = local_map.GetNode(change_over_point);
+        carla::road::LaneId lane_change_id = change_over_waypoint.GetWaypoint()->GetLaneId();
+        const std::vector<LanePosition> &target_lane_vehicles = GetLanePositions({
           current_road_ids.road_id,
           current_road_ids.section_id,
           lane_change_id
         });
 
         // If target lane has vehicles, check if there are any obstacles
-        // for lane change execution.
-        if (target_lane_vehicles.size() > 0) {
-
-          bool found_hazard = false;
-          for (auto i = target_lane_vehicles.begin(); i != target_lane_vehicles.end() && !found_hazard; ++i) {
-
-            const ActorId &other_vehicle_id = *i;
-            traffic_manager::Buffer &other_vehicle_buffer = buffer_list->at(
-                vehicle_id_to_index.at(other_vehicle_id));
-
-            // If a vehicle on the target lane is behind us, check if we are
-            // fast enough to execute lane change.
-            if (!other_vehicle_buffer.empty() &&
-                other_vehicle_buffer.front()->GetWaypoint()->GetLaneId() == lane_change_id) {
-
-              Actor other_vehicle = actor_list.at(vehicle_id_to_index.at(other_vehicle_id));
-              cg::Location other_vehicle_location = other_vehicle_buffer.front()->GetLocation();
-              float relative_deviation = DeviationDotProduct(vehicle, other_vehicle_location);
-
-              if (relative_deviation < 0) {
-
-                float time_to_reach_other =
-                    change_over_point->Distance(other_vehicle_location) /
-                    other_vehicle->GetVelocity().Length();
-
-                float time_to_reach_reference =
-                    change_over_point->Distance(vehicle_location) /
-                    vehicle->GetVelocity().Length();
-
-                if (relative_deviation > std::cos(M_PI * LATERAL_DETECTION_CONE / 180) ||
-                    time_to_reach_other > (time_to_reach_reference + APPROACHING_VEHICLE_TIME_MARGIN)) {
-
-                  found_hazard = true;
-                }
-              }
-              // If a vehicle on the target lane is in front, check if it is far
-              // enough to perform a lane change.
-              else {
-
-                auto vehicle_reference = boost::static_pointer_cast<cc::Vehicle>(vehicle);
-                if (change_over_point->Distance(other_vehicle_location) <
-                    (1.0 + change_over_distance + vehicle_reference->GetBoundingBox().extent.x * 2)) {
-                  found_hazard = true;
-                }
-              }
+        // for lane change execution. Vehicles behind us may be approaching
+        // from any distance, so all of them are visited.
+        bool found_hazard = false;
+        for (auto i = target_lane_vehicles.begin(); i != target_lane_vehicles.end() && !found_hazard; ++i) {
+
+          const LanePosition &other_vehicle = *i;
+          const cg::Location &other_vehicle_location = other_vehicle.location;
+          float relative_deviation = DeviationDotProduct(
+              vehicle_location,
+              vehicle_heading,
+              other_vehicle_location);
+
+          // If a vehicle on the target lane is behind us, check if we are
+          // fast enough to execute lane change.
+          if (relative_deviation < 0) {
+
+            float time_to_reach_other =
+                change_over_waypoint.Distance(other_vehicle_location) /
+                snapshot.speeds.at(other_vehicle.vehicle_index);
+
+            float time_to_reach_reference =
+                change_over_waypoint.Distance(vehicle_location) /
+                vehicle_velocity;
+
+            if (relative_deviation > std::cos(M_PI * LATERAL_DETECTION_CONE / 180) ||
+                time_to_reach_other > (time_to_reach_reference + APPROACHING_VEHICLE_TIME_MARGIN)) {
+
+              found_hazard = true;
             }
           }
+          // If a vehicle on the target lane is in front, check if it is far
+          // enough to perform a lane change.
+          else {
 
-          if (!found_hazard) {
-            possible_to_lane_change = true;
+            if (change_over_waypoint.Distance(other_vehicle_location) <
+                (1.0 + change_over_distance + snapshot.extents.at(vehicle_index).x * 2)) {
+              found_hazard = true;
+            }
           }
-
-        } else {
-          possible_to_lane_change = true;
         }
+
+        possible_to_lane_change = !found_hazard;
       }
     }
 
     if (need_to_change_lane && possible_to_lane_change) {
       for (int i = change_over_distance; i >= 0; i--) {
-        change_over_point = change_over_point->GetNextWaypoint()[0];
+        change_over_point = local_map.GetNode(change_over_point).GetNextWaypoint()[0];
       }
       return change_over_point;
     } else {
-      return nullptr;
+      return INVALID_NODE;
     }
   }
 
-  float DeviationCrossProduct(Actor actor, const cg::Location &target_location) {
+  float DeviationCrossProduct(
+      const cg::Location &vehicle_location,
+      const cg::Vector3D &heading_vector,
+      const cg::Location &target_location) {
 
-    cg::Vector3D heading_vector = actor->GetTransform().GetForwardVector();
-    heading_vector.z = 0;
-    heading_vector = heading_vector.MakeUnitVector();
-    cg::Location next_vector = target_location - actor->GetLocation();
+    cg::Location next_vector = target_location - vehicle_location;
     next_vector.z = 0;
     if (next_vector.Length() > 2.0f * std::numeric_limits<float>::epsilon()) {
       next_vector = next_vector.MakeUnitVector();
@@ -270,12 +247,12 @@ namespace TrafficDistributorConstants {
     }
   }
 
-  float DeviationDotProduct(Actor actor, const cg::Location &target_location) {
+  float DeviationDotProduct(
+      const cg::Location &vehicle_location,
+      const cg::Vector3D &heading_vector,
+      const cg::Location &target_location) {
 
-    cg::Vector3D heading_vector = actor->GetTransform().GetForwardVector();
-    heading_vector.z = 0;
-    heading_vector = heading_vector.MakeUnitVector();
-    cg::Location next_vector = target_location - actor->GetLocation();
+    cg::Location next_vector = target_location - vehicle_location;
     next_vector.z = 0;
     if (next_vector.Length() > 2.0f * std::numeric_limits<float>::epsilon()) {
       next_vector = next_vector.MakeUnitVector();
@@ -1,8 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
-#include <mutex>
-#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -11,6 +11,8 @@
 #include "carla/client/Vehicle.h"
 #include "carla/rpc/ActorId.h"
 
+#include "IndexRemap.h"
+#include "InMemoryMap.h"
 #include "MessengerAndDataTypes.h"
 #include "SimpleWaypoint.h"
 
@@ -59,52 +61,89 @@ namespace cg = carla::geom;
   /// Returns the cross product (z component value) between the vehicle's heading
   /// vector and the vector along the direction to the next target waypoint on
   /// the horizon.
-  float DeviationCrossProduct(Actor actor, const cg::Location &target_location);
+  /// @a heading_vector is expected to be a unit vector on the horizontal plane.
+  float DeviationCrossProduct(
+      const cg::Location &vehicle_location,
+      const cg::Vector3D &heading_vector,
+      const cg::Location &target_location);
 
   /// Returns the dot product between the vehicle's heading vector and
   /// the vector along the direction to the next target waypoint on the horizon.
-  float DeviationDotProduct(Actor actor, const cg::Location &target_location);
+  /// @a heading_vector is expected to be a unit vector on the horizontal plane.
+  float DeviationDotProduct(
+      const cg::Location &vehicle_location,
+      const cg::Vector3D &heading_vector,
+      const cg::Location &target_location);
+
+  /// Position of a vehicle on its lane, taken from the first waypoint of its
+  /// buffer.
+  struct LanePosition {
+    /// Position of the vehicle in the vehicle state snapshot.
+    uint vehicle_index = 0u;
+    /// Distance along the road of the waypoint.
+    float s = 0.0f;
+    cg::Location location;
+    bool in_junction = false;
+  };
 
   /// This class keeps track of the vehicle’s positions in road sections, lanes and
   /// provides lane change decisions.
+  ///
+  /// Every vehicle records its position in its own slot while the stage's
+  /// actions run, and the slots are gathered once per tick into an array per
+  /// lane sorted by distance along the road. The lane arrays do not change
+  /// while the actions read them, so neither the records nor the queries take
+  /// a lock, and a query only visits the vehicles near the queried position.
   class TrafficDistributor {
 
   private:
 
-    /// Mutex used to manage contention for internal resources between various
-    /// accessors.
-    mutable std::shared_timed_mutex distributor_mutex;
-    /// Map connecting geo ids to a set of vehicles with those specific geo ids.
-    std::unordered_map<GeoIds, std::unordered_set<ActorId>> road_to_vehicle_id_map;
-    /// Map connecting vehicle id to it's geo ids.
-    std::unordered_map<ActorId, GeoIds> vehicle_id_to_road_map;
-
-    void SetVehicleId(ActorId actor_id, GeoIds ids);
-
-    void EraseVehicleId(ActorId actor_id, GeoIds ids);
+    /// Lane and position recorded by a vehicle.
+    struct VehicleRecord {
+      bool recorded = false;
+      GeoIds lane;
+      LanePosition position;
+    };
 
-    void SetRoadIds(ActorId actor_id, GeoIds ids);
+    /// One record per vehicle, indexed as the snapshot.
+    std::vector<VehicleRecord> vehicle_records;
+    /// Vehicles of each lane as of the last rebuild, sorted by distance along
+    /// the road. Arrays of lanes left empty are kept to reuse their storage.
+    std::unordered_map<GeoIds, std::vector<LanePosition>> lane_positions;
 
-    std::unordered_set<ActorId> GetVehicleIds(GeoIds ids) const;
-
-    GeoIds GetRoadIds(ActorId vehicle_id) const;
+    /// Returns the vehicles on lane @a ids, sorted by distance along the road.
+    const std::vector<LanePosition> &GetLanePositions(GeoIds ids) const;
 
   public:
 
-    TrafficDistributor();
+    explicit TrafficDistributor(uint number_of_vehicles);
     ~TrafficDistributor();
 
-    void UpdateVehicleRoadPosition(ActorId actor_id, GeoIds road_ids);
-
-    /// Returns the shared pointer of SimpleWaypoint for Lane Change
-    /// if Lane Change is required and possible, else returns nullptr.
-    std::shared_ptr<SimpleWaypoint> AssignLaneChange(
-        Actor vehicle,
-        std::shared_ptr<SimpleWaypoint> current_waypoint,
+    /// Records the lane and position of the vehicle at @a vehicle_index for
+    /// the next rebuild. Safe to call concurrently for different vehicles.
+    void UpdateVehicleRoadPosition(
+        uint vehicle_index,
+        GeoIds road_ids,
+        const SimpleWaypoint &front_waypoint);
+
+    /// Moves the records to the positions of the vehicles in a new
+    /// registration, the vehicles registered since start unrecorded. To be
+    /// called before RebuildLanes().
+    void Remap(const IndexRemap &remap);
+
+    /// Gathers the positions recorded so far into the sorted lane arrays read
+    /// by AssignLaneChange. Must not run concurrently with it.
+    void RebuildLanes();
+
+    /// Returns the index of the SimpleWaypoint for Lane Change
+    /// if Lane Change is required and possible, else returns INVALID_NODE.
+    /// @a vehicle_index is the position of the vehicle in @a snapshot.
+    NodeIndex AssignLaneChange(
+        uint vehicle_index,
+        const VehicleStateSnapshot &snapshot,
+        const InMemoryMap &local_map,
+        NodeIndex current_waypoint,
         GeoIds current_road_ids,
-        std::shared_ptr<BufferList> buffer_list,
-        std::unordered_map<ActorId, uint> &vehicle_id_to_index,
-        std::vector<Actor> &actor_list,
         cc::DebugHelper &debug_helper);
 
   };
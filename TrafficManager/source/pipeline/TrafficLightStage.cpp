@@ -9,11 +9,17 @@ namespace traffic_manager {
       std::shared_ptr<TrafficLightToPlannerMessenger> planner_messenger,
       uint number_of_vehicle,
       uint pool_size,
+      InMemoryMap &local_map,
       cc::DebugHelper &debug_helper)
     : localization_messenger(localization_messenger),
       planner_messenger(planner_messenger),
       PipelineStage(pool_size, number_of_vehicle),
-      debug_helper(debug_helper){
+      local_map(local_map),
+      debug_helper(debug_helper),
+      update_divisor(1u),
+      tick_count(0u),
+      registration(0u),
+      registration_changed(false) {
 
     // Initializing output frame selector.
     frame_selector = true;
@@ -33,31 +39,58 @@ namespace traffic_manager {
 
   TrafficLightStage::~TrafficLightStage() {}
 
+  void TrafficLightStage::SetUpdateDivisor(uint divisor) {
+    update_divisor = std::max(divisor, 1u);
+  }
+
   void TrafficLightStage::Action(const uint start_index, const uint end_index) {
 
     // Selecting the output frame based on the selection key.
     auto current_planner_frame = frame_selector ? planner_frame_a : planner_frame_b;
+    auto previous_planner_frame = frame_selector ? planner_frame_b : planner_frame_a;
+    const VehicleStateSnapshot &snapshot = *localization_frame->snapshot;
+    uint skipped_vehicles = 0u;
 
     // Looping over array's partitions for the current thread.
     for (uint i = start_index; i <= end_index; ++i) {
 
       bool traffic_light_hazard = false;
       LocalizationToTrafficLightData &data = localization_frame->at(i);
-      Actor ego_actor = data.actor;
-      ActorId ego_actor_id = ego_actor->GetId();
-      SimpleWaypointPtr closest_waypoint = data.closest_waypoint;
-      SimpleWaypointPtr look_ahead_point = data.junction_look_ahead_waypoint;
+      ActorId ego_actor_id = snapshot.ids.at(i);
+      const SimpleWaypoint *closest_waypoint = &local_map.GetNode(data.closest_waypoint);
+      const SimpleWaypoint *look_ahead_point = &local_map.GetNode(data.junction_look_ahead_waypoint);
+
+      // Only a vehicle whose look-ahead enters a junction it is not in yet
+      // may have to stop.
+      if (closest_waypoint->CheckJunction() || !look_ahead_point->CheckJunction()) {
+        current_planner_frame->at(i).traffic_light_hazard = false;
+        ++skipped_vehicles;
+        continue;
+      }
+      if (!registration_changed && (tick_count + i) % update_divisor != 0u) {
+        current_planner_frame->at(i) = previous_planner_frame->at(i);
+        ++skipped_vehicles;
+        continue;
+      }
 
       JunctionID junction_id = look_ahead_point->GetWaypoint()->GetJunctionId();
       TimeInstance current_time = chr::system_clock::now();
 
-      auto ego_vehicle = boost::static_pointer_cast<cc::Vehicle>(ego_actor);
-      TLS traffic_light_state = ego_vehicle->GetTrafficLightState();
+      // The light linked to the waypoint is looked up in the states cached
+      // for this tick, the light reported by the vehicle covers waypoints the
+      // local map could not link.
+      TLS traffic_light_state = snapshot.traffic_light_states[i];
+      bool is_at_traffic_light = snapshot.at_traffic_light[i];
+      const TrafficLightIndex traffic_light = closest_waypoint->GetTrafficLight();
+      if (traffic_light < snapshot.light_states.size()) {
+        traffic_light_state = snapshot.light_states[traffic_light];
+        is_at_traffic_light = true;
+      }
 
       // We determine to stop if the current position of the vehicle is not a junction,
       // a point on the path beyond a threshold (velocity-dependent) distance
       // is inside the junction and there is a red or yellow light.
-      if (ego_vehicle->IsAtTrafficLight() &&
+      if (is_at_traffic_light &&
           !closest_waypoint->CheckJunction() &&
           look_ahead_point->CheckJunction() &&
           traffic_light_state != TLS::Green) {
@@ -65,7 +98,7 @@ namespace traffic_manager {
         traffic_light_hazard = true;
       }
       // Handle entry negotiation at non-signalised junction.
-      else if (!ego_vehicle->IsAtTrafficLight() &&
+      else if (!is_at_traffic_light &&
                !closest_waypoint->CheckJunction() &&
                look_ahead_point->CheckJunction() &&
                traffic_light_state != TLS::Green) {
@@ -133,18 +166,38 @@ namespace traffic_manager {
       message.traffic_light_hazard = traffic_light_hazard;
     }
 
+    if (skipped_vehicles > 0u) {
+      AddSkippedUpdates(skipped_vehicles);
+    }
+
   }
 
   void TrafficLightStage::DataReceiver() {
     auto packet = localization_messenger->ReceiveData(localization_messenger_state);
     localization_frame = packet.data;
     localization_messenger_state = packet.id;
+    ++tick_count;
+
+    // On a change of the registered vehicles the previous results no longer
+    // line up with the vehicles, every vehicle is checked on this tick.
+    registration_changed = false;
+    if (localization_frame->snapshot != nullptr &&
+        localization_frame->snapshot->registration != registration) {
+      registration = localization_frame->snapshot->registration;
+      registration_changed = true;
+      const uint number_of_vehicles = static_cast<uint>(localization_frame->size());
+      planner_frame_a = std::make_shared<TrafficLightToPlannerFrame>(number_of_vehicles);
+      planner_frame_b = std::make_shared<TrafficLightToPlannerFrame>(number_of_vehicles);
+      SetNumberOfVehicles(number_of_vehicles);
+    }
   }
 
   void TrafficLightStage::DataSender() {
+    auto current_planner_frame = frame_selector ? planner_frame_a : planner_frame_b;
+    current_planner_frame->snapshot = localization_frame->snapshot;
     DataPacket<std::shared_ptr<TrafficLightToPlannerFrame>> packet{
       planner_messenger_state,
-      frame_selector ? planner_frame_a : planner_frame_b
+      current_planner_frame
     };
     frame_selector = !frame_selector;
     planner_messenger_state = planner_messenger->SendData(packet);
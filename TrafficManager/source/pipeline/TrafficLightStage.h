@@ -10,6 +10,7 @@
 #include "carla/Memory.h"
 #include "carla/rpc/TrafficLightState.h"
 
+#include "InMemoryMap.h"
 #include "MessengerAndDataTypes.h"
 #include "PipelineStage.h"
 
@@ -22,7 +23,6 @@ namespace cg = carla::geom;
   using ActorId = carla::ActorId;
   using Actor = carla::SharedPtr<cc::Actor>;
   using JunctionID = carla::road::JuncId;
-  using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
   using TrafficLight = carla::SharedPtr<cc::TrafficLight>;
   using TLS = carla::rpc::TrafficLightState;
   using TimeInstance = chr::time_point<chr::_V2::system_clock, chr::nanoseconds>;
@@ -33,6 +33,8 @@ namespace cg = carla::geom;
 
   private:
 
+    /// Reference to local map-cache object.
+    InMemoryMap &local_map;
     cc::DebugHelper &debug_helper;
     /// Variables to remember messenger states.
     int localization_messenger_state;
@@ -55,6 +57,14 @@ namespace cg = carla::geom;
     std::unordered_map<ActorId, JunctionID> vehicle_last_junction;
     /// No signal negotiation mutex.
     std::mutex no_signal_negotiation_mutex;
+    /// Number of ticks between the checks of a vehicle approaching a junction.
+    uint update_divisor;
+    /// Number of frames received so far.
+    uint64_t tick_count;
+    /// Registration of the vehicles the output frames refer to.
+    uint64_t registration;
+    /// Whether the registered vehicles changed with the frame received.
+    bool registration_changed;
 
   public:
 
@@ -63,9 +73,16 @@ namespace cg = carla::geom;
         std::shared_ptr<TrafficLightToPlannerMessenger> planner_messenger,
         uint number_of_vehicle,
         uint pool_size,
+        InMemoryMap &local_map,
         cc::DebugHelper &debug_helper);
     ~TrafficLightStage();
 
+    /// Checks a vehicle approaching a junction only every @a divisor ticks,
+    /// carrying its result forward in between. The vehicles are staggered so
+    /// every tick checks about the same number of them. 1, the default,
+    /// checks them every tick. To be called before Start().
+    void SetUpdateDivisor(uint divisor);
+
     void DataReceiver() override;
 
     void Action(const uint start_index, const uint end_index) override;
@@ -0,0 +1,84 @@
+#include "VehicleRegistry.h"
+
+#include <algorithm>
+
+namespace traffic_manager {
+
+  VehicleRegistry::VehicleRegistry() {
+    has_pending_changes.store(false);
+  }
+
+  void VehicleRegistry::Register(const std::vector<ActorPtr> &vehicles) {
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (const ActorPtr &vehicle: vehicles) {
+      pending_unregistrations.erase(vehicle->GetId());
+      pending_registrations.push_back(vehicle);
+    }
+    has_pending_changes.store(!vehicles.empty() || has_pending_changes.load());
+  }
+
+  void VehicleRegistry::Unregister(const std::vector<carla::ActorId> &vehicle_ids) {
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (carla::ActorId vehicle_id: vehicle_ids) {
+      pending_unregistrations.insert(vehicle_id);
+    }
+    // An unregistration cancels any earlier registration still pending.
+    pending_registrations.erase(
+        std::remove_if(pending_registrations.begin(), pending_registrations.end(),
+            [this] (const ActorPtr &vehicle) {
+              return pending_unregistrations.count(vehicle->GetId()) > 0u;
+            }),
+        pending_registrations.end());
+    has_pending_changes.store(!vehicle_ids.empty() || has_pending_changes.load());
+  }
+
+  bool VehicleRegistry::Apply(
+      std::vector<ActorPtr> &registered_vehicles,
+      const std::function<bool(carla::ActorId)> &is_ready) {
+
+    if (!has_pending_changes.load()) {
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    const size_t previous_size = registered_vehicles.size();
+    bool changed = false;
+
+    if (!pending_unregistrations.empty()) {
+      registered_vehicles.erase(
+          std::remove_if(registered_vehicles.begin(), registered_vehicles.end(),
+              [this] (const ActorPtr &vehicle) {
+                return pending_unregistrations.count(vehicle->GetId()) > 0u;
+              }),
+          registered_vehicles.end());
+      changed = registered_vehicles.size() != previous_size;
+      pending_unregistrations.clear();
+    }
+
+    std::unordered_set<carla::ActorId> registered_ids;
+    for (const ActorPtr &vehicle: registered_vehicles) {
+      registered_ids.insert(vehicle->GetId());
+    }
+    std::vector<ActorPtr> not_ready;
+    for (const ActorPtr &vehicle: pending_registrations) {
+      const carla::ActorId vehicle_id = vehicle->GetId();
+      if (registered_ids.count(vehicle_id) > 0u) {
+        continue;
+      }
+      if (is_ready(vehicle_id)) {
+        registered_vehicles.push_back(vehicle);
+        registered_ids.insert(vehicle_id);
+        changed = true;
+      } else {
+        not_ready.push_back(vehicle);
+      }
+    }
+    pending_registrations.swap(not_ready);
+    has_pending_changes.store(!pending_registrations.empty());
+
+    return changed;
+  }
+
+}
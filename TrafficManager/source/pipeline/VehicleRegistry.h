@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "carla/client/Actor.h"
+#include "carla/Memory.h"
+#include "carla/rpc/ActorId.h"
+
+namespace traffic_manager {
+
+namespace cc = carla::client;
+
+  /// This class collects the vehicles registered and unregistered with a
+  /// running pipeline from any thread. The localization stage applies them to
+  /// its list of registered vehicles at the start of a tick, so every stage
+  /// sees the change between two ticks.
+  class VehicleRegistry {
+
+  public:
+
+    using ActorPtr = carla::SharedPtr<cc::Actor>;
+
+  private:
+
+    std::mutex registry_mutex;
+    /// Vehicles waiting to be registered, in order of registration.
+    std::vector<ActorPtr> pending_registrations;
+    /// Vehicles waiting to be unregistered.
+    std::unordered_set<carla::ActorId> pending_unregistrations;
+    /// Whether there is any pending change, read without the lock.
+    std::atomic<bool> has_pending_changes;
+
+  public:
+
+    VehicleRegistry();
+
+    /// Queues @a vehicles to be registered, the ones already registered are
+    /// ignored.
+    void Register(const std::vector<ActorPtr> &vehicles);
+
+    /// Queues the vehicles @a vehicle_ids to be unregistered.
+    void Unregister(const std::vector<carla::ActorId> &vehicle_ids);
+
+    /// Applies the pending changes to @a registered_vehicles. The vehicles
+    /// kept stay in their order and the registered ones are appended, except
+    /// those @a is_ready rejects, which stay pending. Returns true if
+    /// @a registered_vehicles changed.
+    bool Apply(
+        std::vector<ActorPtr> &registered_vehicles,
+        const std::function<bool(carla::ActorId)> &is_ready);
+
+  };
+
+}
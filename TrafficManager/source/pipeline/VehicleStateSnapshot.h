@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "carla/geom/Location.h"
+#include "carla/geom/Vector3D.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/rpc/TrafficLightState.h"
+
+#include "IndexRemap.h"
+
+namespace traffic_manager {
+
+namespace cg = carla::geom;
+
+  /// Structure-of-arrays snapshot of the state of every vehicle registered
+  /// with the traffic manager, taken once per tick from the episode state by
+  /// the localization stage. Array positions match the positions of the
+  /// vehicles in the registered actor list, so the data frames flowing between
+  /// stages index into it directly.
+  struct VehicleStateSnapshot {
+
+    VehicleStateSnapshot() = default;
+
+    explicit VehicleStateSnapshot(size_t number_of_vehicles)
+      : ids(number_of_vehicles),
+        locations(number_of_vehicles),
+        velocities(number_of_vehicles),
+        speeds(number_of_vehicles, 0.0f),
+        yaws(number_of_vehicles, 0.0f),
+        headings(number_of_vehicles),
+        extents(number_of_vehicles),
+        speed_limits(number_of_vehicles, 0.0f),
+        traffic_light_states(number_of_vehicles, carla::rpc::TrafficLightState::Unknown),
+        at_traffic_light(number_of_vehicles, false) {}
+
+    size_t size() const {
+      return ids.size();
+    }
+
+    /// Moves the state of the vehicles to their positions in a new
+    /// registration, the vehicles registered since start with a default
+    /// state.
+    void Remap(const IndexRemap &remap) {
+      RemapVehicleArray(ids, remap);
+      RemapVehicleArray(locations, remap);
+      RemapVehicleArray(velocities, remap);
+      RemapVehicleArray(speeds, remap, 0.0f);
+      RemapVehicleArray(yaws, remap, 0.0f);
+      RemapVehicleArray(headings, remap);
+      RemapVehicleArray(extents, remap);
+      RemapVehicleArray(speed_limits, remap, 0.0f);
+      RemapVehicleArray(traffic_light_states, remap, carla::rpc::TrafficLightState::Unknown);
+      RemapVehicleArray(at_traffic_light, remap, false);
+    }
+
+    std::vector<carla::ActorId> ids;
+    std::vector<cg::Location> locations;
+    std::vector<cg::Vector3D> velocities;
+    /// Length of the velocity vectors.
+    std::vector<float> speeds;
+    /// Yaw of the vehicles in degrees.
+    std::vector<float> yaws;
+    /// Unit heading vectors projected on the horizontal plane.
+    std::vector<cg::Vector3D> headings;
+    /// Bounding box extents of the vehicles.
+    std::vector<cg::Vector3D> extents;
+    /// Speed limit applying to the vehicles, in km/h.
+    std::vector<float> speed_limits;
+    std::vector<carla::rpc::TrafficLightState> traffic_light_states;
+    std::vector<bool> at_traffic_light;
+    /// State of every traffic light linked to the local map, indexed by
+    /// SimpleWaypoint::GetTrafficLight().
+    std::vector<carla::rpc::TrafficLightState> light_states;
+    /// When the state was read from the episode, origin of the end-to-end
+    /// control latency.
+    std::chrono::steady_clock::time_point capture_time;
+    /// Simulation time of the episode state, in seconds.
+    double elapsed_seconds = 0.0;
+    /// Simulation time elapsed since the previous episode state, in seconds.
+    double delta_seconds = 0.0;
+    /// Number of registration changes applied before this snapshot, the
+    /// snapshots with the same value list the same vehicles in the same order.
+    uint64_t registration = 0u;
+  };
+
+  /// Returns the unit vector on the horizontal plane pointing along @a yaw
+  /// (in degrees).
+  inline cg::Vector3D HeadingFromYaw(float yaw) {
+    constexpr float to_radians = static_cast<float>(M_PI) / 180.0f;
+    return {std::cos(yaw * to_radians), std::sin(yaw * to_radians), 0.0f};
+  }
+
+}
@@ -2,82 +2,204 @@
 
 namespace traffic_manager {
 
-  VicinityGrid::VicinityGrid() {}
+namespace VicinityGridConstants {
+  static const size_t INITIAL_CELL_CAPACITY = 1024u;
+}
+  using namespace VicinityGridConstants;
+
+  VicinityGrid::VicinityGrid(float cell_size)
+    : cell_size(cell_size),
+      cells(INITIAL_CELL_CAPACITY),
+      occupied_cells(0u) {}
 
   VicinityGrid::~VicinityGrid() {}
 
-  std::string VicinityGrid::MakeKey(std::pair<int, int> grid_ids) {
-    return std::to_string(grid_ids.first) + std::to_string(grid_ids.second);
+  GridKey VicinityGrid::MakeKey(int32_t x, int32_t y) {
+    return (static_cast<GridKey>(static_cast<uint32_t>(x)) << 32u) |
+           static_cast<GridKey>(static_cast<uint32_t>(y));
   }
 
-  std::pair<int, int> VicinityGrid::UpdateGrid(Actor actor) {
+  std::pair<int32_t, int32_t> VicinityGrid::GetGridIds(const cg::Location &location) const {
+    return {
+      static_cast<int32_t>(std::floor(location.x / cell_size)),
+      static_cast<int32_t>(std::floor(location.y / cell_size))
+    };
+  }
 
-    ActorId actor_id = actor->GetId();
-    cg::Location location = actor->GetLocation();
-    int first = static_cast<int>(std::floor(location.x / 10.0f));
-    int second = static_cast<int>(std::floor(location.y / 10.0f));
+  static size_t HashKey(GridKey key, size_t mask) {
+    // Fibonacci hashing spreads neighbouring cells across the table.
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 17u) & mask;
+  }
 
-    std::string new_grid_id = MakeKey({first, second});
+  const VicinityGrid::Cell *VicinityGrid::FindCell(GridKey key) const {
 
-    // If the actor exists in the grid.
-    if (actor_to_grid_id.find(actor_id) != actor_to_grid_id.end()) {
-
-      std::string old_grid_id = actor_to_grid_id.at(actor_id);
-      // If the actor has moved into a new road/section/lane.
-      if (old_grid_id != new_grid_id) {
-        std::unique_lock<std::shared_timed_mutex> lock(modification_mutex);
-        // Remove actor from old grid position and update the new position.
-        grid_to_actor_id.at(old_grid_id).erase(actor_id);
-        actor_to_grid_id.insert({actor_id, new_grid_id});
-        if (grid_to_actor_id.find(new_grid_id) != grid_to_actor_id.end()) {
-          grid_to_actor_id.at(new_grid_id).insert(actor_id);
-        } else {
-          grid_to_actor_id.insert({new_grid_id, {actor_id}});
+    const size_t mask = cells.size() - 1u;
+    for (size_t slot = HashKey(key, mask); cells[slot].occupied; slot = (slot + 1u) & mask) {
+      if (cells[slot].key == key) {
+        return &cells[slot];
+      }
+    }
+    return nullptr;
+  }
+
+  VicinityGrid::Cell &VicinityGrid::FindOrInsertCell(GridKey key) {
+
+    // Keeping the load factor under one half keeps probe sequences short.
+    if (2u * (occupied_cells + 1u) > cells.size()) {
+      Grow();
+    }
+
+    const size_t mask = cells.size() - 1u;
+    size_t slot = HashKey(key, mask);
+    while (cells[slot].occupied && cells[slot].key != key) {
+      slot = (slot + 1u) & mask;
+    }
+
+    Cell &cell = cells[slot];
+    if (!cell.occupied) {
+      cell.occupied = true;
+      cell.key = key;
+      ++occupied_cells;
+    }
+    return cell;
+  }
+
+  void VicinityGrid::Grow() {
+
+    std::vector<Cell> old_cells(cells.size() * 2u);
+    old_cells.swap(cells);
+
+    const size_t mask = cells.size() - 1u;
+    for (Cell &old_cell : old_cells) {
+      if (old_cell.occupied) {
+        size_t slot = HashKey(old_cell.key, mask);
+        while (cells[slot].occupied) {
+          slot = (slot + 1u) & mask;
         }
+        cells[slot] = std::move(old_cell);
+      }
+    }
+  }
+
+  void VicinityGrid::PlaceActor(ActorId actor_id, GridKey new_key) {
+
+    auto actor_entry = actor_to_grid_id.find(actor_id);
+
+    // If the actor exists in the grid.
+    if (actor_entry != actor_to_grid_id.end()) {
+
+      // If the actor has not moved into a new grid cell, nothing to do.
+      if (actor_entry->second == new_key) {
+        return;
       }
+      // Remove actor from old grid position.
+      Cell &old_cell = FindOrInsertCell(actor_entry->second);
+      auto position = std::find(old_cell.actors.begin(), old_cell.actors.end(), actor_id);
+      if (position != old_cell.actors.end()) {
+        *position = old_cell.actors.back();
+        old_cell.actors.pop_back();
+      }
+      actor_entry->second = new_key;
     }
     // If the actor is new, then add entries to map.
     else {
+      actor_to_grid_id.insert({actor_id, new_key});
+    }
 
-      std::unique_lock<std::shared_timed_mutex> lock(modification_mutex);
-      actor_to_grid_id.insert({actor_id, new_grid_id});
-      if (grid_to_actor_id.find(new_grid_id) != grid_to_actor_id.end()) {
-        grid_to_actor_id.at(new_grid_id).insert(actor_id);
-      } else {
-        grid_to_actor_id.insert({new_grid_id, {actor_id}});
+    FindOrInsertCell(new_key).actors.push_back(actor_id);
+  }
+
+  void VicinityGrid::CollectActors(std::pair<int32_t, int32_t> grid_ids, ActorIdList &actors) const {
+
+    // Search all surrounding grids and find any vehicles in them.
+    // Every actor lives in exactly one cell, so no de-duplication is needed.
+    for (int32_t i = -1; i <= 1; ++i) {
+      for (int32_t j = -1; j <= 1; ++j) {
+        const Cell *cell = FindCell(MakeKey(grid_ids.first + i, grid_ids.second + j));
+        if (cell != nullptr) {
+          actors.insert(actors.end(), cell->actors.begin(), cell->actors.end());
+        }
+      }
+    }
+  }
+
+  std::pair<int, int> VicinityGrid::UpdateGrid(Actor actor) {
+    return UpdateGrid(actor->GetId(), actor->GetLocation());
+  }
+
+  std::pair<int, int> VicinityGrid::UpdateGrid(ActorId actor_id, const cg::Location &location) {
+
+    const std::pair<int32_t, int32_t> grid_ids = GetGridIds(location);
+    const GridKey new_key = MakeKey(grid_ids.first, grid_ids.second);
+
+    {
+      // Most updates leave the actor in its previous cell, check that first
+      // under the shared lock.
+      std::shared_lock<std::shared_timed_mutex> lock(modification_mutex);
+      auto actor_entry = actor_to_grid_id.find(actor_id);
+      if (actor_entry != actor_to_grid_id.end() && actor_entry->second == new_key) {
+        return grid_ids;
       }
     }
 
+    std::unique_lock<std::shared_timed_mutex> lock(modification_mutex);
+    PlaceActor(actor_id, new_key);
+
     // Return updated grid position.
-    return {first, second};
+    return grid_ids;
   }
 
-  std::unordered_set<carla::ActorId> VicinityGrid::GetActors(Actor actor) {
+  ActorIdList VicinityGrid::GetActors(Actor actor) {
 
-    std::pair<int, int> grid_ids = UpdateGrid(actor);
+    const std::pair<int32_t, int32_t> grid_ids = UpdateGrid(actor);
 
     std::shared_lock<std::shared_timed_mutex> lock(modification_mutex);
-    std::unordered_set<ActorId> actors;
-    // Search all surrounding grids and find any vehicles in them.
-    for (int i = -1; i <= 1; ++i) {
-      for (int j = -1; j <= 1; ++j) {
-
-        std::string grid_key = MakeKey({grid_ids.first + i, grid_ids.second + j});
-        if (grid_to_actor_id.find(grid_key) != grid_to_actor_id.end()) {
-          for (auto actor: grid_to_actor_id.at(grid_key)) {
-            actors.insert(actor);
-          }
-        }
+    ActorIdList actors;
+    CollectActors(grid_ids, actors);
+
+    return actors;
+  }
+
+  std::vector<ActorIdList> VicinityGrid::GetActors(
+      const std::vector<ActorId> &actor_ids,
+      const std::vector<cg::Location> &locations) {
+
+    std::vector<std::pair<int32_t, int32_t>> grid_ids;
+    grid_ids.reserve(locations.size());
+    for (const cg::Location &location : locations) {
+      grid_ids.push_back(GetGridIds(location));
+    }
+
+    {
+      std::unique_lock<std::shared_timed_mutex> lock(modification_mutex);
+      for (size_t i = 0u; i < actor_ids.size(); ++i) {
+        PlaceActor(actor_ids[i], MakeKey(grid_ids[i].first, grid_ids[i].second));
       }
     }
 
-    return actors;
+    std::shared_lock<std::shared_timed_mutex> lock(modification_mutex);
+    std::vector<ActorIdList> vicinities(actor_ids.size());
+    for (size_t i = 0u; i < actor_ids.size(); ++i) {
+      CollectActors(grid_ids[i], vicinities[i]);
+    }
+
+    return vicinities;
   }
 
   void VicinityGrid::EraseActor(ActorId actor_id) {
-    std::string grid_key = actor_to_grid_id.at(actor_id);
-    actor_to_grid_id.erase(actor_id);
-    grid_to_actor_id.at(grid_key).erase(actor_id);
+
+    std::unique_lock<std::shared_timed_mutex> lock(modification_mutex);
+    auto actor_entry = actor_to_grid_id.find(actor_id);
+    if (actor_entry == actor_to_grid_id.end()) {
+      return;
+    }
+    Cell &cell = FindOrInsertCell(actor_entry->second);
+    auto position = std::find(cell.actors.begin(), cell.actors.end(), actor_id);
+    if (position != cell.actors.end()) {
+      *position = cell.actors.back();
+      cell.actors.pop_back();
+    }
+    actor_to_grid_id.erase(actor_entry);
   }
 
 }
@@ -1,12 +1,14 @@
 #pragma once
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <mutex>
 #include <shared_mutex>
-#include <string>
 #include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
+#include "boost/container/small_vector.hpp"
 #include "carla/client/Actor.h"
 #include "carla/geom/Location.h"
 #include "carla/rpc/Actor.h"
@@ -17,34 +19,86 @@ namespace cc = carla::client;
 namespace cg = carla::geom;
   using ActorId = carla::ActorId;
   using Actor = carla::SharedPtr<cc::Actor>;
+  /// Cell coordinates packed into a single integer key.
+  using GridKey = uint64_t;
+  /// List of actor ids in the vicinity of an actor.
+  using ActorIdList = std::vector<ActorId>;
 
   /// This class maintains vehicle positions in grid segments.
   /// This is used in the collision stage to filter vehicles.
+  /// Cells are stored in a flat open-addressing table keyed on the packed
+  /// cell coordinates, each holding a small inline list of actor ids.
   class VicinityGrid {
 
   private:
 
+    /// Inline capacity of a cell before it spills to the heap.
+    static constexpr size_t CELL_INLINE_CAPACITY = 8u;
+    using CellActors = boost::container::small_vector<ActorId, CELL_INLINE_CAPACITY>;
+
+    /// A slot of the open-addressing table.
+    struct Cell {
+      GridKey key = 0u;
+      bool occupied = false;
+      CellActors actors;
+    };
+
     /// Mutex to manage contention between modifiers and readers.
     std::shared_timed_mutex modification_mutex;
-    /// Map connecting grid id to set of actor ids.
-    std::unordered_map<std::string, std::unordered_set<ActorId>> grid_to_actor_id;
+    /// Side length of a grid cell in meters.
+    const float cell_size;
+    /// Open-addressing table of cells, its size is always a power of two.
+    std::vector<Cell> cells;
+    /// Number of occupied slots in the table.
+    size_t occupied_cells;
     /// Map connecting actor id to grid key.
-    std::unordered_map<ActorId, std::string> actor_to_grid_id;
+    std::unordered_map<ActorId, GridKey> actor_to_grid_id;
 
     /// Key generator for a given grid.
-    std::string MakeKey(std::pair<int, int> grid_ids);
+    static GridKey MakeKey(int32_t x, int32_t y);
+
+    /// Grid coordinates of a location.
+    std::pair<int32_t, int32_t> GetGridIds(const cg::Location &location) const;
+
+    /// Returns the slot for the key, or nullptr if the cell was never used.
+    const Cell *FindCell(GridKey key) const;
+
+    /// Returns the slot for the key, claiming a new one if needed.
+    Cell &FindOrInsertCell(GridKey key);
+
+    /// Doubles the table size and re-inserts every occupied cell.
+    void Grow();
+
+    /// Moves the actor into the cell of the given key. Expects the
+    /// modification mutex to be held exclusively.
+    void PlaceActor(ActorId actor_id, GridKey new_key);
+
+    /// Appends the actors of the 3x3 cell neighbourhood around the given grid
+    /// position. Expects the modification mutex to be held.
+    void CollectActors(std::pair<int32_t, int32_t> grid_ids, ActorIdList &actors) const;
 
   public:
 
-    VicinityGrid();
+    VicinityGrid(float cell_size = 10.0f);
     ~VicinityGrid();
 
-    /// Returns a set of actors in the vicinity of a given actor.
-    std::unordered_set<ActorId> GetActors(Actor actor);
+    /// Returns the actors in the vicinity of a given actor.
+    ActorIdList GetActors(Actor actor);
+
+    /// Batch version of GetActors: updates the positions of all the given
+    /// actors under a single lock, then returns the vicinity of every one of
+    /// them in the same order.
+    std::vector<ActorIdList> GetActors(
+        const std::vector<ActorId> &actor_ids,
+        const std::vector<cg::Location> &locations);
 
     /// Updates the grid position of the given actor and returns new grid id.
     std::pair<int, int> UpdateGrid(Actor actor);
 
+    /// Updates the grid position of the actor with the given id to
+    /// @a location and returns new grid id.
+    std::pair<int, int> UpdateGrid(ActorId actor_id, const cg::Location &location);
+
     /// Removes actor.
     void EraseActor(ActorId actor_id);
 
@@ -12,6 +12,7 @@
 #include "carla/client/TimeoutException.h"
 #include "carla/Logging.h"
 #include "carla/Memory.h"
+#include "carla/rpc/AutopilotSettings.h"
 
 #include "CarlaDataAccessLayer.h"
 #include "InMemoryMap.h"
@@ -21,7 +22,14 @@ namespace cc = carla::client;
 using Actor = carla::SharedPtr<cc::Actor>;
 
 void run_pipeline(cc::World &world, cc::Client &client_conn,
-                  uint target_traffic_amount, uint randomization_seed);
+                  uint target_traffic_amount, uint randomization_seed,
+                  const traffic_manager::ShardConfiguration &shard,
+                  traffic_manager::PipelineExecution execution,
+                  const traffic_manager::StageUpdateRates &update_rates);
+
+void run_server_autopilot(cc::World &world, cc::Client &client_conn,
+                          uint target_traffic_amount,
+                          const traffic_manager::ShardConfiguration &shard);
 
 std::atomic<bool> quit(false);
 void got_signal(int) {
@@ -57,24 +65,52 @@ int main(int argc, char *argv[]) {
     std::cout << "\nAvailable options\n";
     std::cout << "[-n] \t\t Number of vehicles to be spawned\n";
     std::cout << "[-s] \t\t System randomization seed integer\n";
+    std::cout << "[-k] \t\t Shard of this process, as <index> <count>, to share\n";
+    std::cout << "     \t\t the simulation between several traffic managers\n";
+    std::cout << "[-f] \t\t Run all the stages once per world tick on a single\n";
+    std::cout << "     \t\t thread, for a simulator in synchronous mode\n";
+    std::cout << "[-u] \t\t Check isolated vehicles for collisions and vehicles\n";
+    std::cout << "     \t\t approaching a junction for traffic lights every\n";
+    std::cout << "     \t\t <N> ticks only\n";
+    std::cout << "[-e] \t\t Drive the vehicles with the autopilot embedded in\n";
+    std::cout << "     \t\t the simulator instead of the pipeline\n";
   } else {
 
     uint target_traffic_amount = 0u;
-    if (argc >= 3 && std::string(argv[1]) == "-n") {
+    int randomization_seed = -1;
+    traffic_manager::ShardConfiguration shard;
+    auto execution = traffic_manager::PipelineExecution::Staged;
+    traffic_manager::StageUpdateRates update_rates;
+    bool server_autopilot = false;
+
+    for (int i = 1; i < argc; ++i) {
+      const std::string option = argv[i];
       try {
-        target_traffic_amount = std::stoi(argv[2]);
+        if (option == "-n" && i + 1 < argc) {
+          target_traffic_amount = std::stoi(argv[++i]);
+        } else if (option == "-s" && i + 1 < argc) {
+          randomization_seed = std::stoi(argv[++i]);
+        } else if (option == "-k" && i + 2 < argc) {
+          shard.index = std::stoi(argv[++i]);
+          shard.count = std::stoi(argv[++i]);
+        } else if (option == "-u" && i + 1 < argc) {
+          update_rates.isolated_collision_divisor = std::stoi(argv[++i]);
+          update_rates.traffic_light_divisor = update_rates.isolated_collision_divisor;
+        } else if (option == "-f") {
+          execution = traffic_manager::PipelineExecution::Fused;
+        } else if (option == "-e") {
+          server_autopilot = true;
+        } else {
+          carla::log_warning("Ignoring unknown argument " + option + "\n");
+        }
       } catch (const std::exception &e) {
         carla::log_warning("Failed to parse argument, choosing defaults\n");
       }
     }
 
-    int randomization_seed = -1;
-    if (argc == 5 && std::string(argv[3]) == "-s") {
-      try {
-        randomization_seed = std::stoi(argv[4]);
-      } catch (const std::exception &e) {
-        carla::log_warning("Failed to parse argument, choosing defaults\n");
-      }
+    if (shard.count == 0u || shard.index >= shard.count) {
+      carla::log_warning("Invalid shard, running a single traffic manager\n");
+      shard = traffic_manager::ShardConfiguration();
     }
 
     if (randomization_seed < 0) {
@@ -83,7 +119,11 @@ int main(int argc, char *argv[]) {
       std::srand(randomization_seed);
     }
 
-    run_pipeline(world, client_conn, target_traffic_amount, randomization_seed);
+    if (server_autopilot) {
+      run_server_autopilot(world, client_conn, target_traffic_amount, shard);
+    } else {
+      run_pipeline(world, client_conn, target_traffic_amount, randomization_seed, shard, execution, update_rates);
+    }
 
   }
 
@@ -91,7 +131,10 @@ int main(int argc, char *argv[]) {
 }
 
 void run_pipeline(cc::World &world, cc::Client &client_conn,
-                  uint target_traffic_amount, uint randomization_seed) {
+                  uint target_traffic_amount, uint randomization_seed,
+                  const traffic_manager::ShardConfiguration &shard,
+                  traffic_manager::PipelineExecution execution,
+                  const traffic_manager::StageUpdateRates &update_rates) {
 
   struct sigaction sa;
   memset(&sa, 0, sizeof(sa));
@@ -106,11 +149,23 @@ void run_pipeline(cc::World &world, cc::Client &client_conn,
   using Topology = std::vector<std::pair<traffic_manager::WaypointPtr, traffic_manager::WaypointPtr>>;
   Topology topology = dao.GetTopology();
   auto local_map = std::make_shared<traffic_manager::InMemoryMap>(topology);
-  local_map->SetUp(1.0);
+
+  // Reusing the local map built by a previous run on the same map, if any.
+  const int sampling_resolution = 1;
+  const char *cache_directory = std::getenv("TMPDIR");
+  const std::string map_cache_file =
+      std::string(cache_directory != nullptr ? cache_directory : "/tmp") + "/" +
+      traffic_manager::InMemoryMap::GetCacheFileName(*world_map, sampling_resolution);
+  if (!local_map->Load(map_cache_file, *world_map, sampling_resolution)) {
+    local_map->SetUp(sampling_resolution);
+    if (!local_map->Save(map_cache_file, *world_map, sampling_resolution)) {
+      carla::log_warning("Failed to write local map cache to " + map_cache_file + "\n");
+    }
+  }
 
   uint core_count = traffic_manager::read_core_count();
   std::vector<Actor> registered_actors = traffic_manager::spawn_traffic(
-    client_conn, world, core_count, target_traffic_amount);
+    client_conn, world, core_count, target_traffic_amount, shard);
   global_actor_list = &registered_actors;
 
   client_conn.SetTimeout(2s);
@@ -126,8 +181,11 @@ void run_pipeline(cc::World &world, cc::Client &client_conn,
       client_conn,
       world,
       debug_helper,
-      1
+      1,
+      traffic_manager::BatchControlMode::Throttled,
+      execution
       );
+  pipeline.SetUpdateRates(update_rates);
 
   try
   {
@@ -151,3 +209,43 @@ void run_pipeline(cc::World &world, cc::Client &client_conn,
 
   carla::log_info("\nTrafficManager stopped by user\n");
 }
+
+void run_server_autopilot(cc::World &world, cc::Client &client_conn,
+                          uint target_traffic_amount,
+                          const traffic_manager::ShardConfiguration &shard) {
+
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = got_signal;
+  sigfillset(&sa.sa_mask);
+  sigaction(SIGINT, &sa, NULL);
+
+  uint core_count = traffic_manager::read_core_count();
+  // The simulator computes and applies the controls before every physics
+  // step, this process only hands the vehicles over and waits.
+  world.ApplyAutopilotSettings(carla::rpc::AutopilotSettings());
+  std::vector<Actor> registered_actors = traffic_manager::spawn_traffic(
+    client_conn, world, core_count, target_traffic_amount, shard, true);
+  global_actor_list = &registered_actors;
+
+  client_conn.SetTimeout(2s);
+
+  try
+  {
+    carla::log_info("TrafficManager started with the simulator autopilot\n");
+
+    while (!quit.load()) {
+      sleep(1);
+      // Periodically polling if Carla is still running
+      world.GetSettings();
+    }
+  }
+  catch(const cc::TimeoutException& e)
+  {
+    carla::log_error("Carla has stopped running, stopping TrafficManager\n");
+  }
+
+  traffic_manager::destroy_traffic(registered_actors, client_conn);
+
+  carla::log_info("\nTrafficManager stopped by user\n");
+}
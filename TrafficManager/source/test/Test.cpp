@@ -37,6 +37,13 @@ void test_pipeline(
     cc::Client &client_conn,
     uint target_traffic_amount);
 
+void benchmark_pipeline(
+    cc::World &world,
+    cc::Client &client_conn,
+    const std::vector<uint> &vehicle_counts,
+    const std::vector<uint> &pipeline_widths,
+    chr::seconds duration);
+
 std::atomic<bool> quit(false);
 void got_signal(int) {
   quit.store(true);
@@ -72,7 +79,13 @@ int main(int argc, char *argv[]) {
   // test_in_memory_map(world_map);
   // test_pipeline_stages(vehicle_list, world_map, client_conn, world);
   // test_lane_change(world);
-  test_pipeline(world, client_conn, 0u);
+  if (argc >= 2 && std::string(argv[1]) == "-b") {
+    // Benchmark mode, optionally followed by the seconds each run lasts.
+    const chr::seconds duration(argc >= 3 ? std::stoi(argv[2]) : 20);
+    benchmark_pipeline(world, client_conn, {50u, 100u, 200u}, {1u, 2u, 4u}, duration);
+  } else {
+    test_pipeline(world, client_conn, 0u);
+  }
 
   return 0;
 }
@@ -132,6 +145,84 @@ void test_pipeline(
   std::cout << "TrafficManager stopped by user" << std::endl;
 }
 
+/// Runs the pipeline for @a duration with every combination of number of
+/// vehicles and pipeline width, printing its timing as CSV to the standard
+/// output, one row per measurement and run.
+void benchmark_pipeline(
+    cc::World &world,
+    cc::Client &client_conn,
+    const std::vector<uint> &vehicle_counts,
+    const std::vector<uint> &pipeline_widths,
+    chr::seconds duration) {
+
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = got_signal;
+  sigfillset(&sa.sa_mask);
+  sigaction(SIGINT, &sa, NULL);
+
+  CarlaMap world_map = world.GetMap();
+  cc::DebugHelper debug_helper = client_conn.GetWorld().MakeDebugHelper();
+  auto dao = traffic_manager::CarlaDataAccessLayer(world_map);
+  traffic_manager::TopologyList topology = dao.GetTopology();
+  auto local_map = std::make_shared<traffic_manager::InMemoryMap>(topology);
+  local_map->SetUp(1.0);
+
+  uint core_count = traffic_manager::read_core_count();
+  std::cout << "map,cores,vehicles,pipeline_width,measurement,count,average_us,maximum_us" << std::endl;
+
+  for (uint vehicle_count : vehicle_counts) {
+
+    auto registered_actors = traffic_manager::spawn_traffic(client_conn, world, core_count, vehicle_count);
+    global_actor_list = &registered_actors;
+
+    for (uint pipeline_width : pipeline_widths) {
+
+      traffic_manager::Pipeline pipeline(
+        {0.1f, 0.15f, 0.01f},
+        {5.0f, 0.0f, 0.1f},
+        {10.0f, 0.01f, 0.1f},
+        25/3.6f,
+        50/3.6f,
+        registered_actors,
+        *local_map.get(),
+        client_conn,
+        world,
+        debug_helper,
+        pipeline_width
+      );
+      pipeline.Start();
+
+      const auto end = chr::steady_clock::now() + duration;
+      while (!quit.load() && chr::steady_clock::now() < end) {
+        std::this_thread::sleep_for(100ms);
+      }
+
+      const auto statistics = pipeline.GetStatistics();
+      pipeline.Stop();
+
+      for (auto &entry : statistics) {
+        std::cout << world_map->GetName() << ',' << core_count << ','
+                  << registered_actors.size() << ',' << pipeline_width << ','
+                  << entry.first << ',' << entry.second.count << ','
+                  << entry.second.average << ',' << entry.second.maximum << std::endl;
+      }
+
+      if (quit.load()) {
+        break;
+      }
+    }
+
+    traffic_manager::destroy_traffic(registered_actors, client_conn);
+    // Letting the simulator remove the vehicles before spawning the next ones.
+    std::this_thread::sleep_for(1s);
+
+    if (quit.load()) {
+      break;
+    }
+  }
+}
+
 void test_pipeline_stages(
     carla::SharedPtr<cc::ActorList> actor_list,
     carla::SharedPtr<cc::Map> world_map,
@@ -163,18 +254,18 @@ void test_pipeline_stages(
     localization_planner_messenger, localization_collision_messenger,
     localization_traffic_light_messenger, registered_actors.size(), 1,
     registered_actors, local_map,
-    debug_helper
+    world, debug_helper
   );
 
   traffic_manager::CollisionStage collision_stage(
     localization_collision_messenger, collision_planner_messenger,
     registered_actors.size(), 1,
-    world, debug_helper
+    local_map, world, debug_helper
   );
 
   traffic_manager::TrafficLightStage traffic_light_stage(
     localization_traffic_light_messenger, traffic_light_planner_messenger,
-    registered_actors.size(), 1
+    registered_actors.size(), 1, local_map, debug_helper
   );
 
   traffic_manager::MotionPlannerStage planner_stage(
@@ -182,7 +273,7 @@ void test_pipeline_stages(
     collision_planner_messenger,
     traffic_light_planner_messenger,
     planner_control_messenger,
-    registered_actors.size(), 1u,
+    registered_actors.size(), debug_helper, 1u,
     25/3.6f, 50/3.6f, {0.1f, 0.15f, 0.01f},
     {10.0f, 0.01f, 0.1f}, {10.0f, 0.0f, 0.1f}
   );
@@ -257,11 +348,11 @@ void test_in_memory_map(carla::SharedPtr<cc::Map> world_map) {
   local_map.SetUp(1.0);
   std::cout << "setup complete" << std::endl;
   uint loose_ends_count = 0u;
-  auto dense_topology = local_map.GetDenseTopology();
+  auto &dense_topology = local_map.GetDenseTopology();
   for (auto &swp : dense_topology) {
-    if (swp->GetNextWaypoint().size() < 1 || swp->GetNextWaypoint()[0] == 0) {
+    if (swp.GetNextWaypoint().size() < 1 || swp.GetNextWaypoint()[0] == traffic_manager::INVALID_NODE) {
       loose_ends_count += 1;
-      auto loc = swp->GetLocation();
+      auto loc = swp.GetLocation();
       std::cout << "Loose end at : " << loc.x << " " << loc.y << std::endl;
     }
   }
@@ -274,8 +365,8 @@ void test_dense_topology(const cc::World &world) {
   auto topology = dao.GetTopology();
   traffic_manager::InMemoryMap local_map(topology);
   local_map.SetUp(1.0);
-  for (auto point : local_map.GetDenseTopology()) {
-    auto location = point->GetLocation();
+  for (auto &point : local_map.GetDenseTopology()) {
+    auto location = point.GetLocation();
     debug.DrawPoint(location + carla::geom::Location(0,
         0,
         1), 0.2f, {225u, 0u, 0u}, 30.0f);
@@ -295,23 +386,23 @@ void test_lane_change(const cc::World &world) {
   uint total_left_lane_links = 0u;
   uint total_right_lane_links = 0u;
 
-  for (auto point : local_map.GetDenseTopology()) {
+  for (auto &point : local_map.GetDenseTopology()) {
 
-    auto raw_waypoint = point->GetWaypoint();
+    auto raw_waypoint = point.GetWaypoint();
     uint8_t lane_change = static_cast<uint8_t>(raw_waypoint->GetLaneChange());
     uint8_t change_right = static_cast<uint8_t>(carla::road::element::LaneMarking::LaneChange::Right);
     uint8_t change_left = static_cast<uint8_t>(carla::road::element::LaneMarking::LaneChange::Left);
 
-    if ((lane_change & change_right) > 0u && !(point->CheckJunction())) {
+    if ((lane_change & change_right) > 0u && !(point.CheckJunction())) {
       ++total_right_lane_links;
-      if (point->GetRightWaypoint() == nullptr) {
+      if (point.GetRightWaypoint() == traffic_manager::INVALID_NODE) {
         ++missing_right_lane_links;
       }
     }
 
-    if ((lane_change & change_left) > 0u && !(point->CheckJunction())) {
+    if ((lane_change & change_left) > 0u && !(point.CheckJunction())) {
       ++total_left_lane_links;
-      if (point->GetLeftWaypoint() == nullptr) {
+      if (point.GetLeftWaypoint() == traffic_manager::INVALID_NODE) {
         ++missing_left_lane_links;
       }
     }
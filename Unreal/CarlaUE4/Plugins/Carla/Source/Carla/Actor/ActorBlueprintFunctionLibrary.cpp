@@ -234,6 +234,59 @@ static void AddVariationsForSensor(FActorDefinition &Def)
   Tick.bRestrictToRecommended = false;
 
   Def.Variations.Emplace(Tick);
+
+  // Codec used to send the data to clients in other hosts.
+  FActorVariation Compression;
+
+  Compression.Id = TEXT("compression");
+  Compression.Type = EActorAttributeType::String;
+  Compression.RecommendedValues = { TEXT("none"), TEXT("lz4"), TEXT("delta") };
+  Compression.bRestrictToRecommended = true;
+
+  Def.Variations.Emplace(Compression);
+
+  // Sensors of the same bundle deliver the data of each frame together.
+  FActorVariation Bundle;
+
+  Bundle.Id = TEXT("bundle");
+  Bundle.Type = EActorAttributeType::String;
+  Bundle.RecommendedValues = { TEXT("") };
+  Bundle.bRestrictToRecommended = false;
+
+  Def.Variations.Emplace(Bundle);
+
+  // Directory in the server where the data is written instead of sent.
+  FActorVariation DiskSink;
+
+  DiskSink.Id = TEXT("disk_sink");
+  DiskSink.Type = EActorAttributeType::String;
+  DiskSink.RecommendedValues = { TEXT("") };
+  DiskSink.bRestrictToRecommended = false;
+
+  Def.Variations.Emplace(DiskSink);
+
+  FActorVariation DiskSinkFormat;
+
+  DiskSinkFormat.Id = TEXT("disk_sink_format");
+  DiskSinkFormat.Type = EActorAttributeType::String;
+  DiskSinkFormat.RecommendedValues = { TEXT("raw"), TEXT("png") };
+  DiskSinkFormat.bRestrictToRecommended = true;
+
+  Def.Variations.Emplace(DiskSinkFormat);
+}
+
+static void AddVariationsForBatchedSensor(FActorDefinition &Def)
+{
+  // Computed by the engine together with every other batched sensor, the
+  // readings of all of them are sent in a single message.
+  FActorVariation Batched;
+
+  Batched.Id = TEXT("batched");
+  Batched.Type = EActorAttributeType::Bool;
+  Batched.RecommendedValues = { TEXT("false") };
+  Batched.bRestrictToRecommended = false;
+
+  Def.Variations.Emplace(Batched);
 }
 
 static void AddVariationsForTrigger(FActorDefinition &Def)
@@ -360,6 +413,63 @@ void UActorBlueprintFunctionLibrary::MakeCameraDefinition(
   LensYSize.RecommendedValues = { TEXT("0.08") };
   LensYSize.bRestrictToRecommended = false;
 
+  // Read the pixels without stalling the render thread, two frames later.
+  FActorVariation AsyncReadback;
+  AsyncReadback.Id = TEXT("async_readback");
+  AsyncReadback.Type = EActorAttributeType::Bool;
+  AsyncReadback.RecommendedValues = { TEXT("false") };
+  AsyncReadback.bRestrictToRecommended = false;
+
+  // Region of the image sent and its size, cropped and scaled on the GPU.
+  FActorVariation RoiX;
+  RoiX.Id = TEXT("roi_x");
+  RoiX.Type = EActorAttributeType::Int;
+  RoiX.RecommendedValues = { TEXT("0") };
+  RoiX.bRestrictToRecommended = false;
+
+  FActorVariation RoiY;
+  RoiY.Id = TEXT("roi_y");
+  RoiY.Type = EActorAttributeType::Int;
+  RoiY.RecommendedValues = { TEXT("0") };
+  RoiY.bRestrictToRecommended = false;
+
+  FActorVariation RoiWidth;
+  RoiWidth.Id = TEXT("roi_width");
+  RoiWidth.Type = EActorAttributeType::Int;
+  RoiWidth.RecommendedValues = { TEXT("0") };
+  RoiWidth.bRestrictToRecommended = false;
+
+  FActorVariation RoiHeight;
+  RoiHeight.Id = TEXT("roi_height");
+  RoiHeight.Type = EActorAttributeType::Int;
+  RoiHeight.RecommendedValues = { TEXT("0") };
+  RoiHeight.bRestrictToRecommended = false;
+
+  FActorVariation Downsample;
+  Downsample.Id = TEXT("downsample");
+  Downsample.Type = EActorAttributeType::Int;
+  Downsample.RecommendedValues = { TEXT("1") };
+  Downsample.bRestrictToRecommended = false;
+
+  FActorVariation OutputX;
+  OutputX.Id = TEXT("output_size_x");
+  OutputX.Type = EActorAttributeType::Int;
+  OutputX.RecommendedValues = { TEXT("0") };
+  OutputX.bRestrictToRecommended = false;
+
+  FActorVariation OutputY;
+  OutputY.Id = TEXT("output_size_y");
+  OutputY.Type = EActorAttributeType::Int;
+  OutputY.RecommendedValues = { TEXT("0") };
+  OutputY.bRestrictToRecommended = false;
+
+  // Cheaper rendering for secondary cameras.
+  FActorVariation RenderProfile;
+  RenderProfile.Id = TEXT("render_profile");
+  RenderProfile.Type = EActorAttributeType::String;
+  RenderProfile.RecommendedValues = { TEXT("default"), TEXT("fast") };
+  RenderProfile.bRestrictToRecommended = true;
+
   Definition.Variations.Append({
       ResX,
       ResY,
@@ -369,7 +479,16 @@ void UActorBlueprintFunctionLibrary::MakeCameraDefinition(
       LensK,
       LensKcube,
       LensXSize,
-      LensYSize});
+      LensYSize,
+      AsyncReadback,
+      RoiX,
+      RoiY,
+      RoiWidth,
+      RoiHeight,
+      Downsample,
+      OutputX,
+      OutputY,
+      RenderProfile});
 
   if (bEnableModifyingPostProcessEffects)
   {
@@ -655,6 +774,7 @@ void UActorBlueprintFunctionLibrary::MakeIMUDefinition(
 {
   FillIdAndTags(Definition, TEXT("sensor"), TEXT("other"), TEXT("imu"));
   AddVariationsForSensor(Definition);
+  AddVariationsForBatchedSensor(Definition);
 
   // - Noise seed --------------------------------
   FActorVariation NoiseSeed;
@@ -776,9 +896,26 @@ void UActorBlueprintFunctionLibrary::MakeLidarDefinition(
   LowerFOV.Id = TEXT("lower_fov");
   LowerFOV.Type = EActorAttributeType::Float;
   LowerFOV.RecommendedValues = { TEXT("-30.0") };
+  // Point format.
+  FActorVariation PointFormat;
+  PointFormat.Id = TEXT("point_format");
+  PointFormat.Type = EActorAttributeType::String;
+  PointFormat.RecommendedValues = { TEXT("float"), TEXT("int16") };
+  PointFormat.bRestrictToRecommended = true;
+  // Point scale.
+  FActorVariation PointScale;
+  PointScale.Id = TEXT("point_scale");
+  PointScale.Type = EActorAttributeType::Float;
+  PointScale.RecommendedValues = { TEXT("0.01") }; // 1 centimeter
+  // Full sweep.
+  FActorVariation FullSweep;
+  FullSweep.Id = TEXT("full_sweep");
+  FullSweep.Type = EActorAttributeType::Bool;
+  FullSweep.RecommendedValues = { TEXT("false") };
+  FullSweep.bRestrictToRecommended = false;
 
   Definition.Variations.Append(
-      {Channels, Range, PointsPerSecond, Frequency, UpperFOV, LowerFOV});
+      {Channels, Range, PointsPerSecond, Frequency, UpperFOV, LowerFOV, PointFormat, PointScale, FullSweep});
 
   Success = CheckActorDefinition(Definition);
 }
@@ -798,6 +935,7 @@ void UActorBlueprintFunctionLibrary::MakeGnssDefinition(
 {
   FillIdAndTags(Definition, TEXT("sensor"), TEXT("other"), TEXT("gnss"));
   AddVariationsForSensor(Definition);
+  AddVariationsForBatchedSensor(Definition);
 
   // - Noise seed --------------------------------
   FActorVariation NoiseSeed;
@@ -1035,6 +1173,14 @@ void UActorBlueprintFunctionLibrary::MakePropDefinition(
     EActorAttributeType::String,
     GetSize(Parameters.Size)});
 
+  // Rendered as an instance of a mesh shared by the props of this kind.
+  FActorVariation Instanced;
+  Instanced.Id = TEXT("instanced");
+  Instanced.Type = EActorAttributeType::Bool;
+  Instanced.RecommendedValues = { TEXT("false") };
+  Instanced.bRestrictToRecommended = false;
+  Definition.Variations.Emplace(Instanced);
+
   Success = CheckActorDefinition(Definition);
 }
 
@@ -1045,6 +1191,109 @@ void UActorBlueprintFunctionLibrary::MakePropDefinitions(
   FillActorDefinitionArray(ParameterArray, Definitions, &MakePropDefinition);
 }
 
+FActorDefinition UActorBlueprintFunctionLibrary::MakeCameraRigDefinition(const FString &Id)
+{
+  auto Definition = MakeGenericSensorDefinition(TEXT("camera"), Id);
+  AddVariationsForSensor(Definition);
+
+  // Resolution of each view.
+  FActorVariation ResX;
+  ResX.Id = TEXT("image_size_x");
+  ResX.Type = EActorAttributeType::Int;
+  ResX.RecommendedValues = { TEXT("800") };
+  ResX.bRestrictToRecommended = false;
+
+  FActorVariation ResY;
+  ResY.Id = TEXT("image_size_y");
+  ResY.Type = EActorAttributeType::Int;
+  ResY.RecommendedValues = { TEXT("600") };
+  ResY.bRestrictToRecommended = false;
+
+  // FOV of each view.
+  FActorVariation FOV;
+  FOV.Id = TEXT("fov");
+  FOV.Type = EActorAttributeType::Float;
+  FOV.RecommendedValues = { TEXT("90.0") };
+  FOV.bRestrictToRecommended = false;
+
+  // Views evenly spread around the yaw of the rig.
+  FActorVariation NumberOfViews;
+  NumberOfViews.Id = TEXT("number_of_views");
+  NumberOfViews.Type = EActorAttributeType::Int;
+  NumberOfViews.RecommendedValues = { TEXT("6") };
+  NumberOfViews.bRestrictToRecommended = false;
+
+  // Comma-separated yaw of each view in degrees, overrides number_of_views.
+  FActorVariation ViewYaws;
+  ViewYaws.Id = TEXT("view_yaws");
+  ViewYaws.Type = EActorAttributeType::String;
+  ViewYaws.RecommendedValues = { TEXT("") };
+  ViewYaws.bRestrictToRecommended = false;
+
+  FActorVariation PixelFormat;
+  PixelFormat.Id = TEXT("pixel_format");
+  PixelFormat.Type = EActorAttributeType::String;
+  PixelFormat.RecommendedValues = { TEXT("bgra"), TEXT("rgb") };
+  PixelFormat.bRestrictToRecommended = true;
+
+  Definition.Variations.Append({
+      ResX,
+      ResY,
+      FOV,
+      NumberOfViews,
+      ViewYaws,
+      PixelFormat});
+
+  return Definition;
+}
+
+FActorDefinition UActorBlueprintFunctionLibrary::MakeGBufferCameraDefinition(const FString &Id)
+{
+  auto Definition = MakeGenericSensorDefinition(TEXT("camera"), Id);
+  AddVariationsForSensor(Definition);
+
+  FActorVariation ResX;
+  ResX.Id = TEXT("image_size_x");
+  ResX.Type = EActorAttributeType::Int;
+  ResX.RecommendedValues = { TEXT("800") };
+  ResX.bRestrictToRecommended = false;
+
+  FActorVariation ResY;
+  ResY.Id = TEXT("image_size_y");
+  ResY.Type = EActorAttributeType::Int;
+  ResY.RecommendedValues = { TEXT("600") };
+  ResY.bRestrictToRecommended = false;
+
+  FActorVariation FOV;
+  FOV.Id = TEXT("fov");
+  FOV.Type = EActorAttributeType::Float;
+  FOV.RecommendedValues = { TEXT("90.0") };
+  FOV.bRestrictToRecommended = false;
+
+  // Of the RGB image, the depth and labels have their own.
+  FActorVariation PixelFormat;
+  PixelFormat.Id = TEXT("pixel_format");
+  PixelFormat.Type = EActorAttributeType::String;
+  PixelFormat.RecommendedValues = { TEXT("bgra"), TEXT("rgb") };
+  PixelFormat.bRestrictToRecommended = true;
+
+  FActorVariation BoundingBoxes;
+  BoundingBoxes.Id = TEXT("actor_bounding_boxes");
+  BoundingBoxes.Type = EActorAttributeType::Bool;
+  BoundingBoxes.RecommendedValues = { TEXT("false") };
+  BoundingBoxes.bRestrictToRecommended = false;
+
+  FActorVariation BoundingBoxDistance;
+  BoundingBoxDistance.Id = TEXT("bounding_box_distance");
+  BoundingBoxDistance.Type = EActorAttributeType::Float;
+  BoundingBoxDistance.RecommendedValues = { TEXT("100.0") };
+  BoundingBoxDistance.bRestrictToRecommended = false;
+
+  Definition.Variations.Append({ResX, ResY, FOV, PixelFormat, BoundingBoxes, BoundingBoxDistance});
+
+  return Definition;
+}
+
 void UActorBlueprintFunctionLibrary::MakeObstacleDetectorDefinitions(
     const FString &Type,
     const FString &Id,
@@ -1076,12 +1325,19 @@ void UActorBlueprintFunctionLibrary::MakeObstacleDetectorDefinitions(
   debuglinetrace.Type = EActorAttributeType::Bool;
   debuglinetrace.RecommendedValues = { TEXT("false") };
   debuglinetrace.bRestrictToRecommended = false;
+  // Batch Sweeps
+  FActorVariation batchsweeps;
+  batchsweeps.Id = TEXT("batch_sweeps");
+  batchsweeps.Type = EActorAttributeType::Bool;
+  batchsweeps.RecommendedValues = { TEXT("false") };
+  batchsweeps.bRestrictToRecommended = false;
 
   Definition.Variations.Append({
     distance,
     hitradius,
     onlydynamics,
-    debuglinetrace
+    debuglinetrace,
+    batchsweeps
   });
 
 }
@@ -1257,6 +1513,23 @@ void UActorBlueprintFunctionLibrary::SetCamera(
       RetrieveActorAttributeToInt("image_size_y", Description.Variations, 600));
   Camera->SetFOVAngle(
       RetrieveActorAttributeToFloat("fov", Description.Variations, 90.0f));
+  Camera->EnableAsyncReadback(
+      RetrieveActorAttributeToBool("async_readback", Description.Variations, false));
+  const int32 RoiX = RetrieveActorAttributeToInt("roi_x", Description.Variations, 0);
+  const int32 RoiY = RetrieveActorAttributeToInt("roi_y", Description.Variations, 0);
+  Camera->SetOutputTransform(
+      FIntRect(
+          RoiX,
+          RoiY,
+          RoiX + RetrieveActorAttributeToInt("roi_width", Description.Variations, 0),
+          RoiY + RetrieveActorAttributeToInt("roi_height", Description.Variations, 0)),
+      FMath::Max(RetrieveActorAttributeToInt("downsample", Description.Variations, 1), 1),
+      FMath::Max(RetrieveActorAttributeToInt("output_size_x", Description.Variations, 0), 0),
+      FMath::Max(RetrieveActorAttributeToInt("output_size_y", Description.Variations, 0), 0));
+  Camera->SetRenderProfile(
+      RetrieveActorAttributeToString("render_profile", Description.Variations, TEXT("default")) == TEXT("fast") ?
+          ECameraRenderProfile::Fast :
+          ECameraRenderProfile::Default);
   if (Description.Variations.Contains("enable_postprocess_effects"))
   {
     Camera->EnablePostProcessingEffects(
@@ -1370,6 +1643,13 @@ void UActorBlueprintFunctionLibrary::SetLidar(
       RetrieveActorAttributeToFloat("upper_fov", Description.Variations, Lidar.UpperFovLimit);
   Lidar.LowerFovLimit =
       RetrieveActorAttributeToFloat("lower_fov", Description.Variations, Lidar.LowerFovLimit);
+  Lidar.bPackPoints =
+      (RetrieveActorAttributeToString("point_format", Description.Variations, TEXT("float")) == TEXT("int16"));
+  Lidar.PointScale = FMath::Max(
+      RetrieveActorAttributeToFloat("point_scale", Description.Variations, Lidar.PointScale),
+      1e-4f);
+  Lidar.bFullSweep =
+      RetrieveActorAttributeToBool("full_sweep", Description.Variations, Lidar.bFullSweep);
 }
 
 void UActorBlueprintFunctionLibrary::SetGnss(
@@ -143,6 +143,10 @@ public:
       const FString &Id,
       FActorDefinition &Definition);
 
+  static FActorDefinition MakeCameraRigDefinition(const FString &Id);
+
+  static FActorDefinition MakeGBufferCameraDefinition(const FString &Id);
+
   /// @}
   /// ==========================================================================
   /// @name Helpers to retrieve attribute values
@@ -9,8 +9,13 @@
 
 #include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
 #include "Carla/Actor/CarlaActorFactory.h"
+#include "Carla/Actor/InstancedPropManager.h"
 
+#include "Carla/Vehicle/WheeledVehicleAIController.h"
+
+#include "Engine/World.h"
 #include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
 
 void UActorDispatcher::Bind(FActorDefinition Definition, SpawnFunctionType Functor)
 {
@@ -31,7 +36,12 @@ void UActorDispatcher::Bind(ACarlaActorFactory &ActorFactory)
 {
   for (const auto &Definition : ActorFactory.GetDefinitions())
   {
-    Bind(Definition, [&](const FTransform &Transform, const FActorDescription &Description) {
+    Bind(Definition, [this, &ActorFactory](const FTransform &Transform, const FActorDescription &Description) {
+      UWorld *World = ActorFactory.GetWorld();
+      if ((World != nullptr) && AInstancedPropManager::IsInstanced(Description))
+      {
+        return SpawnInstancedProp(*World, Transform, Description);
+      }
       return ActorFactory.SpawnActor(Transform, Description);
     });
   }
@@ -51,6 +61,13 @@ TPair<EActorSpawnResultStatus, FActorView> UActorDispatcher::SpawnActor(
   UE_LOG(LogCarla, Log, TEXT("Spawning actor '%s'"), *Description.Id);
 
   Description.Class = Classes[Description.UId - 1];
+
+  if (AActor *PooledActor = TryTakeFromPool(Transform, Description))
+  {
+    auto View = RegisterActor(*PooledActor, std::move(Description), DesiredId);
+    return MakeTuple(EActorSpawnResultStatus::Success, View);
+  }
+
   auto Result = SpawnFunctions[Description.UId - 1](Transform, Description);
 
   if ((Result.Status == EActorSpawnResultStatus::Success) && (Result.Actor == nullptr))
@@ -86,6 +103,12 @@ bool UActorDispatcher::DestroyActor(AActor *Actor)
   }
   const auto &Id = View.GetActorInfo()->Description.Id;
 
+  if (TryReleaseToPool(*Actor, View))
+  {
+    UE_LOG(LogCarla, Log, TEXT("Actor returned to the pool: '%s'"), *Id);
+    return true;
+  }
+
   // Destroy its controller if present.
   auto Pawn = Cast<APawn>(Actor);
   auto Controller = (Pawn != nullptr ? Pawn->GetController() : nullptr);
@@ -118,3 +141,185 @@ FActorView UActorDispatcher::RegisterActor(AActor &Actor, FActorDescription Desc
   }
   return View;
 }
+
+void UActorDispatcher::SetPoolSize(const uint32 MaxActorsPerDefinition)
+{
+  PoolSize = MaxActorsPerDefinition;
+  for (auto &Pair : Pool)
+  {
+    auto &Actors = Pair.Value;
+    while (static_cast<uint32>(Actors.Num()) > PoolSize)
+    {
+      AActor *Actor = Actors.Last().Actor.Get();
+      if ((Actor != nullptr) && !Actor->IsPendingKill())
+      {
+        auto Pawn = Cast<APawn>(Actor);
+        auto Controller = (Pawn != nullptr ? Pawn->GetController() : nullptr);
+        if (Controller != nullptr)
+        {
+          Controller->Destroy();
+        }
+        Actor->Destroy();
+      }
+      Actors.Pop(false);
+    }
+  }
+}
+
+int32 UActorDispatcher::GetNumberOfPooledActors() const
+{
+  int32 Count = 0;
+  for (const auto &Pair : Pool)
+  {
+    Count += Pair.Value.Num();
+  }
+  return Count;
+}
+
+FActorSpawnResult UActorDispatcher::SpawnInstancedProp(
+    UWorld &World,
+    const FTransform &Transform,
+    const FActorDescription &Description)
+{
+  if (!InstancedPropManager.IsValid() || (InstancedPropManager->GetWorld() != &World))
+  {
+    InstancedPropManager = World.SpawnActor<AInstancedPropManager>();
+    if (!InstancedPropManager.IsValid())
+    {
+      UE_LOG(LogCarla, Error, TEXT("Failed to spawn the instanced prop manager"));
+      return FActorSpawnResult{};
+    }
+  }
+  return InstancedPropManager->SpawnProp(Transform, Description);
+}
+
+static bool UActorDispatcher_HaveSameVariations(
+    const FActorDescription &Lhs,
+    const FActorDescription &Rhs)
+{
+  if (Lhs.Variations.Num() != Rhs.Variations.Num())
+  {
+    return false;
+  }
+  for (const auto &Pair : Lhs.Variations)
+  {
+    const auto *Other = Rhs.Variations.Find(Pair.Key);
+    if ((Other == nullptr) || (Other->Value != Pair.Value.Value))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool UActorDispatcher::TryReleaseToPool(AActor &Actor, const FActorView &View)
+{
+  const auto Type = View.GetActorType();
+  if ((PoolSize == 0u) ||
+      ((Type != FActorView::ActorType::Vehicle) && (Type != FActorView::ActorType::Walker)) ||
+      Actor.IsPendingKill())
+  {
+    return false;
+  }
+  // Actors with something attached, e.g. sensors, are not reused.
+  TArray<AActor *> AttachedActors;
+  Actor.GetAttachedActors(AttachedActors);
+  if (AttachedActors.Num() > 0)
+  {
+    return false;
+  }
+  const auto &Description = View.GetActorInfo()->Description;
+  auto &Actors = Pool.FindOrAdd(Description.UId);
+  if (static_cast<uint32>(Actors.Num()) >= PoolSize)
+  {
+    return false;
+  }
+
+  FPooledActor Pooled;
+  Pooled.Actor = &Actor;
+  Pooled.Description = Description;
+
+  Registry.Deregister(View.GetActorId());
+  Actor.OnDestroyed.RemoveDynamic(this, &UActorDispatcher::OnActorDestroyed);
+
+  auto *Controller = Cast<AWheeledVehicleAIController>(
+      Cast<APawn>(&Actor) != nullptr ? Cast<APawn>(&Actor)->GetController() : nullptr);
+  if (Controller != nullptr)
+  {
+    Controller->SetAutopilot(false);
+  }
+  auto *RootComponent = Cast<UPrimitiveComponent>(Actor.GetRootComponent());
+  if (RootComponent != nullptr)
+  {
+    Pooled.bWasSimulatingPhysics = RootComponent->IsSimulatingPhysics();
+    RootComponent->SetSimulatePhysics(false);
+  }
+  for (UActorComponent *Component : Actor.GetComponents())
+  {
+    if ((Component != nullptr) && Component->IsComponentTickEnabled())
+    {
+      Component->SetComponentTickEnabled(false);
+      Pooled.TickingComponents.Emplace(Component);
+    }
+  }
+  Actor.SetActorTickEnabled(false);
+  Actor.SetActorEnableCollision(false);
+  Actor.SetActorHiddenInGame(true);
+
+  Actors.Emplace(MoveTemp(Pooled));
+  return true;
+}
+
+AActor *UActorDispatcher::TryTakeFromPool(
+    const FTransform &Transform,
+    const FActorDescription &Description)
+{
+  auto *Actors = Pool.Find(Description.UId);
+  if (Actors == nullptr)
+  {
+    return nullptr;
+  }
+  for (int32 i = Actors->Num() - 1; i >= 0; --i)
+  {
+    auto &Pooled = (*Actors)[i];
+    AActor *Actor = Pooled.Actor.Get();
+    if ((Actor == nullptr) || Actor->IsPendingKill())
+    {
+      Actors->RemoveAtSwap(i);
+      continue;
+    }
+    if (!UActorDispatcher_HaveSameVariations(Pooled.Description, Description))
+    {
+      continue;
+    }
+    // Same check the spawn of a new actor would do.
+    Actor->SetActorEnableCollision(true);
+    UWorld *World = Actor->GetWorld();
+    if ((World == nullptr) ||
+        World->EncroachingBlockingGeometry(Actor, Transform.GetLocation(), Transform.Rotator()))
+    {
+      Actor->SetActorEnableCollision(false);
+      return nullptr;
+    }
+    Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+    Actor->SetActorHiddenInGame(false);
+    Actor->SetActorTickEnabled(true);
+    for (auto &Component : Pooled.TickingComponents)
+    {
+      if (Component.IsValid())
+      {
+        Component->SetComponentTickEnabled(true);
+      }
+    }
+    auto *RootComponent = Cast<UPrimitiveComponent>(Actor->GetRootComponent());
+    if ((RootComponent != nullptr) && Pooled.bWasSimulatingPhysics)
+    {
+      RootComponent->SetSimulatePhysics(true);
+      RootComponent->SetPhysicsLinearVelocity(FVector::ZeroVector);
+      RootComponent->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+    }
+    Actors->RemoveAtSwap(i);
+    return Actor;
+  }
+  return nullptr;
+}
@@ -12,11 +12,14 @@
 #include "Carla/Actor/ActorSpawnResult.h"
 
 #include "Containers/Array.h"
+#include "Containers/Map.h"
 #include "Templates/Function.h"
+#include "UObject/WeakObjectPtrTemplates.h"
 
 #include "ActorDispatcher.generated.h"
 
 class ACarlaActorFactory;
+class AInstancedPropManager;
 
 /// Object in charge of binding ActorDefinitions to spawn functions, as well as
 /// keeping the registry of all the actors spawned.
@@ -53,10 +56,21 @@ public:
 
   /// Destroys an actor, properly removing it from the registry.
   ///
+  /// Vehicles and walkers may be kept in the pool instead, see SetPoolSize.
+  ///
   /// Return true if the @a Actor is destroyed or already marked for
   /// destruction, false if indestructible or nullptr.
   bool DestroyActor(AActor *Actor);
 
+  /// Keep up to @a MaxActorsPerDefinition destroyed vehicles and walkers of
+  /// each definition, deactivated and hidden, to reuse them when an actor of
+  /// the same description is spawned. Zero destroys them as usual and empties
+  /// the pool.
+  void SetPoolSize(uint32 MaxActorsPerDefinition);
+
+  /// Number of actors waiting in the pool.
+  int32 GetNumberOfPooledActors() const;
+
   /// Register an actor that was not created using "SpawnActor" function but
   /// that should be kept in the registry.
   FActorView RegisterActor(AActor &Actor, FActorDescription ActorDescription, FActorRegistry::IdType DesiredId = 0);
@@ -73,6 +87,34 @@ public:
 
 private:
 
+  /// A deactivated actor waiting in the pool.
+  struct FPooledActor
+  {
+    TWeakObjectPtr<AActor> Actor;
+
+    FActorDescription Description;
+
+    bool bWasSimulatingPhysics = false;
+
+    /// Components that were ticking when the actor was deactivated.
+    TArray<TWeakObjectPtr<UActorComponent>> TickingComponents;
+  };
+
+  /// Spawn a prop with the "instanced" attribute into the instanced prop
+  /// manager of @a World, spawning the manager if missing.
+  FActorSpawnResult SpawnInstancedProp(
+      UWorld &World,
+      const FTransform &Transform,
+      const FActorDescription &Description);
+
+  /// Deregister and deactivate @a Actor into the pool, false if it cannot be
+  /// pooled.
+  bool TryReleaseToPool(AActor &Actor, const FActorView &View);
+
+  /// Activate at @a Transform a pooled actor matching @a Description, nullptr
+  /// if there is none or it does not fit there.
+  AActor *TryTakeFromPool(const FTransform &Transform, const FActorDescription &Description);
+
   UFUNCTION()
   void OnActorDestroyed(AActor *Actor)
   {
@@ -87,4 +129,10 @@ private:
 
   FActorRegistry Registry;
 
+  uint32 PoolSize = 0u;
+
+  /// Pooled actors by UId of their definition.
+  TMap<uint32, TArray<FPooledActor>> Pool;
+
+  TWeakObjectPtr<AInstancedPropManager> InstancedPropManager;
 };
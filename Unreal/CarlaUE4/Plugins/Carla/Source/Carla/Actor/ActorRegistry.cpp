@@ -13,6 +13,8 @@
 #include "Carla/Traffic/TrafficLightBase.h"
 #include "Carla/Util/BoundingBoxCalculator.h"
 
+#include <algorithm>
+
 static FActorView::ActorType FActorRegistry_GetActorType(const FActorView &View)
 {
   if (!View.IsValid())
@@ -50,20 +52,37 @@ static FString GetRelevantTagAsString(const TSet<ECityObjectLabel> &SemanticTags
   return TEXT("unknown");
 }
 
-FActorView FActorRegistry::Register(AActor &Actor, FActorDescription Description, IdType DesiredId)
+FActorRegistry::IdType FActorRegistry::AllocateId(IdType DesiredId)
 {
-  static IdType ID_COUNTER = 0u;
-  auto Id = ++ID_COUNTER;
-
-  if (DesiredId != 0 && Id != DesiredId) {
-    // check if the desired Id is free, then use it instead
-    if (!Actors.Contains(DesiredId))
-      Id = DesiredId;
-      if (ID_COUNTER < Id)
-        ID_COUNTER = Id;
+  const uint32 DesiredSlot = GetSlot(DesiredId);
+  if ((DesiredSlot != 0u) && ((DesiredSlot >= Slots.size()) || (Slots[DesiredSlot].Index == INDEX_NONE)))
+  {
+    // the desired id is free, use it instead
+    while (Slots.size() <= DesiredSlot)
+    {
+      FreeSlots.emplace_back(static_cast<uint32>(Slots.size()));
+      Slots.emplace_back();
+    }
+    FreeSlots.erase(std::find(FreeSlots.begin(), FreeSlots.end(), DesiredSlot));
+    Slots[DesiredSlot].Generation = GetGeneration(DesiredId);
+    return DesiredId;
   }
+  if (!FreeSlots.empty())
+  {
+    const uint32 Slot = FreeSlots.back();
+    FreeSlots.pop_back();
+    return MakeId(Slot, Slots[Slot].Generation);
+  }
+  const uint32 Slot = static_cast<uint32>(Slots.size());
+  check(Slot <= SlotMask);
+  Slots.emplace_back();
+  return MakeId(Slot, 0u);
+}
+
+FActorView FActorRegistry::Register(AActor &Actor, FActorDescription Description, IdType DesiredId)
+{
+  const IdType Id = AllocateId(DesiredId);
 
-  Actors.Emplace(Id, &Actor);
   if (Ids.Contains(&Actor))
   {
     UE_LOG(
@@ -75,23 +94,37 @@ FActorView FActorRegistry::Register(AActor &Actor, FActorDescription Description
   }
   Ids.Emplace(&Actor, Id);
 
-  auto View = MakeView(Id, Actor, std::move(Description));
-
-  auto Result = ActorDatabase.emplace(Id, View);
-  check(Result.second);
-  check(static_cast<size_t>(Actors.Num()) == ActorDatabase.size());
-  return Result.first->second;
+  FSlot &Slot = Slots[GetSlot(Id)];
+  check(Slot.Index == INDEX_NONE);
+  Slot.Index = static_cast<int32>(ActorDatabase.size());
+  ActorDatabase.emplace_back(MakeView(Id, Actor, std::move(Description)));
+  ++(*Version);
+  return ActorDatabase.back();
 }
 
 void FActorRegistry::Deregister(IdType Id)
 {
-  check(Contains(Id));
-  AActor *Actor = Find(Id).GetActor();
+  const int32 Index = FindIndex(Id);
+  check(Index != INDEX_NONE);
+  AActor *Actor = ActorDatabase[Index].GetActor();
   check(Actor != nullptr);
-  ActorDatabase.erase(Id);
-  Actors.Remove(Id);
+
+  // keep the views packed, the last one takes the place of the removed one
+  if (static_cast<size_t>(Index) + 1u != ActorDatabase.size())
+  {
+    ActorDatabase[Index] = std::move(ActorDatabase.back());
+    Slots[GetSlot(ActorDatabase[Index].GetActorId())].Index = Index;
+  }
+  ActorDatabase.pop_back();
+
+  // the next actor in this slot gets a different id
+  FSlot &Slot = Slots[GetSlot(Id)];
+  Slot.Index = INDEX_NONE;
+  Slot.Generation = (Slot.Generation + 1u) & (~IdType(0u) >> SlotBits);
+  FreeSlots.emplace_back(GetSlot(Id));
+
   Ids.Remove(Actor);
-  check(static_cast<size_t>(Actors.Num()) == ActorDatabase.size());
+  ++(*Version);
 }
 
 void FActorRegistry::Deregister(AActor *Actor)
@@ -10,22 +10,32 @@
 
 #include "Containers/Map.h"
 
-#include <compiler/disable-ue4-macros.h>
-#include <carla/Iterator.h>
-#include <compiler/enable-ue4-macros.h>
-
-#include <unordered_map>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 /// A registry of all the Carla actors.
+///
+/// An id is made of the index of a slot and the generation of that slot, so
+/// resolving an id is an array lookup. Slots are reused once their actor is
+/// deregistered, and each reuse increments the generation so stale ids do not
+/// resolve to the new actor. The views are kept packed in a contiguous array,
+/// iterating the registry is a linear scan.
 class FActorRegistry
 {
 private:
 
-  using DatabaseType = std::unordered_map<FActorView::IdType, FActorView>;
+  using DatabaseType = std::vector<FActorView>;
 
 public:
 
-  using IdType = DatabaseType::key_type;
+  using IdType = FActorView::IdType;
+
+  /// Number of bits of an id that hold the index of its slot, the rest hold
+  /// the generation.
+  static constexpr uint32 SlotBits = 20u;
+
+  static constexpr IdType SlotMask = (1u << SlotBits) - 1u;
 
   // ===========================================================================
   /// @name Actor registry functions
@@ -51,7 +61,7 @@ public:
 
   int32 Num() const
   {
-    return Actors.Num();
+    return static_cast<int32>(ActorDatabase.size());
   }
 
   bool IsEmpty() const
@@ -59,15 +69,39 @@ public:
     return ActorDatabase.empty();
   }
 
+  /// Bytes of memory held by the registry, the descriptions of the actors
+  /// only by their size.
+  size_t GetAllocatedSize() const
+  {
+    return
+        Slots.capacity() * sizeof(FSlot) +
+        FreeSlots.capacity() * sizeof(uint32) +
+        Ids.GetAllocatedSize() +
+        ActorDatabase.capacity() * sizeof(FActorView);
+  }
+
+  /// Changes each time an actor is registered or deregistered.
+  uint64 GetVersion() const
+  {
+    return *Version;
+  }
+
+  /// The counter behind GetVersion, for other threads to find out whether
+  /// what they copied of the registry is still current.
+  std::shared_ptr<const std::atomic<uint64>> GetVersionCounter() const
+  {
+    return Version;
+  }
+
   bool Contains(uint32 Id) const
   {
-    return ActorDatabase.find(Id) != ActorDatabase.end();
+    return FindIndex(Id) != INDEX_NONE;
   }
 
   FActorView Find(IdType Id) const
   {
-    auto it = ActorDatabase.find(Id);
-    return it != ActorDatabase.end() ? it->second : FActorView();
+    const int32 Index = FindIndex(Id);
+    return Index != INDEX_NONE ? ActorDatabase[Index] : FActorView();
   }
 
   FActorView Find(AActor *Actor) const
@@ -88,26 +122,73 @@ public:
   /// @{
 public:
 
-  using value_type = DatabaseType::mapped_type;
+  using value_type = DatabaseType::value_type;
 
   auto begin() const noexcept
   {
-    return carla::iterator::make_map_values_const_iterator(ActorDatabase.begin());
+    return ActorDatabase.cbegin();
   }
 
   auto end() const noexcept
   {
-    return carla::iterator::make_map_values_const_iterator(ActorDatabase.end());
+    return ActorDatabase.cend();
   }
 
   /// @}
 private:
 
+  struct FSlot
+  {
+    /// Generation of the id of the actor in this slot, or of the next one if
+    /// empty.
+    IdType Generation = 0u;
+
+    /// Index of the view in ActorDatabase, INDEX_NONE if the slot is empty.
+    int32 Index = INDEX_NONE;
+  };
+
+  static uint32 GetSlot(IdType Id)
+  {
+    return Id & SlotMask;
+  }
+
+  static IdType GetGeneration(IdType Id)
+  {
+    return Id >> SlotBits;
+  }
+
+  static IdType MakeId(uint32 Slot, IdType Generation)
+  {
+    return (Generation << SlotBits) | Slot;
+  }
+
+  /// Index in ActorDatabase of the actor with @a Id, INDEX_NONE if it is not
+  /// registered.
+  int32 FindIndex(IdType Id) const
+  {
+    const uint32 Slot = GetSlot(Id);
+    if ((Id == 0u) || (Slot >= Slots.size()))
+    {
+      return INDEX_NONE;
+    }
+    const FSlot &Item = Slots[Slot];
+    return Item.Generation == GetGeneration(Id) ? Item.Index : INDEX_NONE;
+  }
+
+  /// Take the slot of @a DesiredId if it is free, otherwise any free slot.
+  IdType AllocateId(IdType DesiredId);
+
   FActorView MakeView(IdType Id, AActor &Actor, FActorDescription Description) const;
 
-  TMap<IdType, AActor *> Actors;
+  /// Slot 0 is never used, so 0 is never a valid id.
+  std::vector<FSlot> Slots = std::vector<FSlot>(1u);
+
+  std::vector<uint32> FreeSlots;
 
   TMap<AActor *, IdType> Ids;
 
+  /// Packed views of the registered actors, in no particular order.
   DatabaseType ActorDatabase;
+
+  std::shared_ptr<std::atomic<uint64>> Version = std::make_shared<std::atomic<uint64>>(0u);
 };
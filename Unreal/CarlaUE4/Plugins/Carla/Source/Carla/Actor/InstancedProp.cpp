@@ -0,0 +1,41 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Actor/InstancedProp.h"
+
+#include "Carla/Actor/InstancedPropManager.h"
+
+#include "Components/SceneComponent.h"
+
+AInstancedProp::AInstancedProp(const FObjectInitializer &ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  PrimaryActorTick.bCanEverTick = false;
+  RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+  RootComponent->SetMobility(EComponentMobility::Movable);
+  RootComponent->TransformUpdated.AddUObject(this, &AInstancedProp::OnTransformUpdated);
+}
+
+void AInstancedProp::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  if (Manager.IsValid())
+  {
+    Manager->RemoveInstance(*this);
+  }
+  Super::EndPlay(EndPlayReason);
+}
+
+void AInstancedProp::OnTransformUpdated(
+    USceneComponent *,
+    EUpdateTransformFlags,
+    ETeleportType)
+{
+  if (Manager.IsValid())
+  {
+    Manager->UpdateInstance(*this);
+  }
+}
@@ -0,0 +1,60 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+
+#include "InstancedProp.generated.h"
+
+class AInstancedPropManager;
+class UStaticMesh;
+
+/// Prop spawned with the "instanced" attribute. The actor has no mesh nor
+/// collision of its own, it only stands in the registry for an instance of
+/// the shared mesh component of AInstancedPropManager, which follows its
+/// transform and is removed with it.
+UCLASS()
+class CARLA_API AInstancedProp : public AActor
+{
+  GENERATED_BODY()
+
+public:
+
+  AInstancedProp(const FObjectInitializer &ObjectInitializer);
+
+  UStaticMesh *GetMesh() const
+  {
+    return Mesh;
+  }
+
+  /// Index of the instance in the component of its mesh, INDEX_NONE if
+  /// removed.
+  int32 GetInstanceIndex() const
+  {
+    return InstanceIndex;
+  }
+
+protected:
+
+  void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+private:
+
+  friend AInstancedPropManager;
+
+  void OnTransformUpdated(
+      USceneComponent *Component,
+      EUpdateTransformFlags UpdateTransformFlags,
+      ETeleportType Teleport);
+
+  TWeakObjectPtr<AInstancedPropManager> Manager;
+
+  UPROPERTY()
+  UStaticMesh *Mesh = nullptr;
+
+  int32 InstanceIndex = INDEX_NONE;
+};
@@ -0,0 +1,152 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Actor/InstancedPropManager.h"
+
+#include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
+#include "Carla/Actor/CarlaBlueprintRegistry.h"
+#include "Carla/Actor/InstancedProp.h"
+#include "Carla/Game/Tagger.h"
+
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+
+AInstancedPropManager::AInstancedPropManager(const FObjectInitializer &ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  PrimaryActorTick.bCanEverTick = false;
+  RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+  RootComponent->SetMobility(EComponentMobility::Movable);
+}
+
+bool AInstancedPropManager::IsInstanced(const FActorDescription &Description)
+{
+  return
+      Description.Id.StartsWith(TEXT("static.prop.")) &&
+      UActorBlueprintFunctionLibrary::RetrieveActorAttributeToBool(
+          TEXT("instanced"),
+          Description.Variations,
+          false);
+}
+
+FActorSpawnResult AInstancedPropManager::SpawnProp(
+    const FTransform &Transform,
+    const FActorDescription &Description)
+{
+  UStaticMesh *Mesh = FindMesh(Description.Id);
+  if (Mesh == nullptr)
+  {
+    UE_LOG(LogCarla, Error, TEXT("No mesh found for the instanced prop '%s'"), *Description.Id);
+    return FActorSpawnResult{};
+  }
+  FActorSpawnParameters SpawnParameters;
+  SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+  auto *Prop = GetWorld()->SpawnActor<AInstancedProp>(
+      AInstancedProp::StaticClass(),
+      Transform,
+      SpawnParameters);
+  if (Prop == nullptr)
+  {
+    return FActorSpawnResult{};
+  }
+  auto &Group = GetGroup(*Mesh);
+  Prop->Manager = this;
+  Prop->Mesh = Mesh;
+  Prop->InstanceIndex = Group.Component->AddInstanceWorldSpace(Transform);
+  Group.Props.Add(Prop);
+  check(Group.Props.Num() == Group.Component->GetInstanceCount());
+  check(Prop->InstanceIndex == Group.Props.Num() - 1);
+  return FActorSpawnResult{Prop};
+}
+
+void AInstancedPropManager::UpdateInstance(const AInstancedProp &Prop)
+{
+  auto *Group = Groups.Find(Prop.Mesh);
+  if ((Group != nullptr) && Group->Props.IsValidIndex(Prop.InstanceIndex))
+  {
+    Group->Component->UpdateInstanceTransform(
+        Prop.InstanceIndex,
+        Prop.GetActorTransform(),
+        true,
+        true,
+        true);
+  }
+}
+
+void AInstancedPropManager::RemoveInstance(AInstancedProp &Prop)
+{
+  const int32 Index = Prop.InstanceIndex;
+  Prop.InstanceIndex = INDEX_NONE;
+  Prop.Manager = nullptr;
+  auto *Group = Groups.Find(Prop.Mesh);
+  if ((Group == nullptr) || !Group->Props.IsValidIndex(Index))
+  {
+    return;
+  }
+  check(Group->Props[Index] == &Prop);
+  // The hierarchical component removes with a swap, the last instance takes
+  // the index of the removed one.
+  Group->Component->RemoveInstance(Index);
+  Group->Props.RemoveAtSwap(Index);
+  if (Group->Props.IsValidIndex(Index))
+  {
+    Group->Props[Index]->InstanceIndex = Index;
+  }
+}
+
+void AInstancedPropManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  // The props left are only being destroyed with the world.
+  for (auto &Pair : Groups)
+  {
+    for (AInstancedProp *Prop : Pair.Value.Props)
+    {
+      Prop->Manager = nullptr;
+      Prop->InstanceIndex = INDEX_NONE;
+    }
+  }
+  Groups.Empty();
+  Super::EndPlay(EndPlayReason);
+}
+
+UStaticMesh *AInstancedPropManager::FindMesh(const FString &DefinitionId)
+{
+  if (Meshes.Num() == 0)
+  {
+    // Same ids the prop definitions get.
+    TArray<FPropParameters> Parameters;
+    UCarlaBlueprintRegistry::LoadPropDefinitions(Parameters);
+    for (const auto &Prop : Parameters)
+    {
+      if (Prop.Mesh != nullptr)
+      {
+        Meshes.Add((TEXT("static.prop.") + Prop.Name).ToLower(), Prop.Mesh);
+      }
+    }
+  }
+  UStaticMesh **Mesh = Meshes.Find(DefinitionId);
+  return Mesh != nullptr ? *Mesh : nullptr;
+}
+
+AInstancedPropManager::FPropGroup &AInstancedPropManager::GetGroup(UStaticMesh &Mesh)
+{
+  auto &Group = Groups.FindOrAdd(&Mesh);
+  if (Group.Component == nullptr)
+  {
+    Group.Component = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+    Group.Component->SetStaticMesh(&Mesh);
+    Group.Component->SetMobility(EComponentMobility::Movable);
+    Group.Component->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+    Group.Component->SetupAttachment(RootComponent);
+    Group.Component->RegisterComponent();
+    // Spawned before it had this component.
+    ATagger::TagActor(*this, true);
+  }
+  return Group;
+}
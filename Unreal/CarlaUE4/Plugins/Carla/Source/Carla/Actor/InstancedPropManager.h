@@ -0,0 +1,70 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Actor/ActorDescription.h"
+#include "Carla/Actor/ActorSpawnResult.h"
+
+#include "Containers/Map.h"
+#include "GameFramework/Actor.h"
+
+#include "InstancedPropManager.generated.h"
+
+class AInstancedProp;
+class UHierarchicalInstancedStaticMeshComponent;
+class UStaticMesh;
+
+/// Renders the props spawned with the "instanced" attribute, those of the
+/// same mesh share a hierarchical instanced static mesh component, a few
+/// draw calls and no actor with its own mesh and collision per prop.
+UCLASS()
+class CARLA_API AInstancedPropManager : public AActor
+{
+  GENERATED_BODY()
+
+public:
+
+  AInstancedPropManager(const FObjectInitializer &ObjectInitializer);
+
+  /// Whether @a Description is a prop with the "instanced" attribute set.
+  static bool IsInstanced(const FActorDescription &Description);
+
+  /// Spawn the AInstancedProp of @a Description at @a Transform.
+  FActorSpawnResult SpawnProp(
+      const FTransform &Transform,
+      const FActorDescription &Description);
+
+  /// Move the instance of @a Prop to the transform of the actor.
+  void UpdateInstance(const AInstancedProp &Prop);
+
+  void RemoveInstance(AInstancedProp &Prop);
+
+protected:
+
+  void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+private:
+
+  /// The instanced props of a mesh, the i-th has the i-th instance.
+  struct FPropGroup
+  {
+    UHierarchicalInstancedStaticMeshComponent *Component = nullptr;
+
+    TArray<AInstancedProp *> Props;
+  };
+
+  UStaticMesh *FindMesh(const FString &DefinitionId);
+
+  FPropGroup &GetGroup(UStaticMesh &Mesh);
+
+  /// Mesh of each prop definition, loaded with the first instanced prop.
+  UPROPERTY()
+  TMap<FString, UStaticMesh *> Meshes;
+
+  /// The components are owned by this actor.
+  TMap<UStaticMesh *, FPropGroup> Groups;
+};
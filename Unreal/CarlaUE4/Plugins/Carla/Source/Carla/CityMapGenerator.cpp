@@ -11,8 +11,10 @@
 #include "MapGen/RoadMap.h"
 #include "Game/Tagger.h"
 
+#include "Async/ParallelFor.h"
 #include "Components/InstancedStaticMeshComponent.h"
 #include "Engine/World.h"
+#include "Misc/Crc.h"
 #include "Paths.h"
 
 #include <algorithm>
@@ -111,6 +113,13 @@ void ACityMapGenerator::GenerateGraph()
     MapSizeY = 5u;
     UE_LOG(LogCarla, Warning, TEXT("Map size changed, was too small"));
   }
+  // The generation is deterministic, the construction script runs again on
+  // every property change.
+  const FIntVector Parameters(Seed, MapSizeX, MapSizeY);
+  if ((Dcel != nullptr) && (DcelParameters == Parameters)) {
+    return;
+  }
+  DcelParameters = Parameters;
 #ifdef CARLA_ROAD_GENERATOR_EXTRA_LOG
   // Delete the dcel before the new one is created so indices are restored.
   Dcel.Reset(nullptr);
@@ -257,6 +266,23 @@ static bool LineTrace(
   return false;
 }
 
+uint32 ACityMapGenerator::GetRoadMapCacheKey() const
+{
+  // Everything the traced pixels depend on besides the seed and size in the
+  // name of the cache file.
+  const FString Layout = FString::Printf(
+      TEXT("%d %u %u %u %d %d %f %s"),
+      Seed,
+      MapSizeX,
+      MapSizeY,
+      PixelsPerMapUnit,
+      bLeftHandTraffic ? 1 : 0,
+      bGenerateRoads ? 1 : 0,
+      GetMapScale(),
+      *GetActorRotation().ToString());
+  return FCrc::StrCrc32(*Layout);
+}
+
 void ACityMapGenerator::GenerateRoadMap()
 {
   UE_LOG(LogCarla, Log, TEXT("Generating road map..."));
@@ -281,29 +307,43 @@ void ACityMapGenerator::GenerateRoadMap()
   const FVector MapOffset(-Offset, -Offset, 0.0f);
   RoadMap->Reset(SizeX, SizeY, 1.0f / CmPerPixel, ActorTransform.Inverse(), MapOffset);
 
-  for (uint32 PixelY = 0u; PixelY < SizeY; ++PixelY) {
-    for (uint32 PixelX = 0u; PixelX < SizeX; ++PixelX) {
-      const float X = static_cast<float>(PixelX) * CmPerPixel - Offset;
-      const float Y = static_cast<float>(PixelY) * CmPerPixel - Offset;
-      const FVector Start = ActorTransform.TransformPosition(FVector(X, Y, 50.0f));
-      const FVector End = ActorTransform.TransformPosition(FVector(X, Y, -50.0f));
-
-      // Do the ray tracing.
-      FHitResult Hit;
-      if (LineTrace(World, Start, End, Hit)) {
-        auto StaticMeshComponent = Cast<UStaticMeshComponent>(Hit.Component.Get());
-        if (StaticMeshComponent == nullptr) {
-          UE_LOG(LogCarla, Error, TEXT("Road component is not UInstancedStaticMeshComponent"));
-        } else {
-          RoadMap->SetPixelAt(
-            PixelX,
-            PixelY,
-            GetTag(*StaticMeshComponent->GetStaticMesh()),
-            StaticMeshComponent->GetOwner()->GetTransform(),
-            bLeftHandTraffic);
+  const FString CachePath = FPaths::Combine(
+      FPaths::ProjectSavedDir(),
+      TEXT("RoadMaps"),
+      FString::Printf(TEXT("%d_%ux%u.roadmap"), Seed, MapSizeX, MapSizeY));
+  const uint32 CacheKey = GetRoadMapCacheKey();
+
+  if (RoadMap->LoadPixelData(CachePath, CacheKey)) {
+    UE_LOG(LogCarla, Log, TEXT("Loaded road map from %s"), *CachePath);
+  } else {
+    // The traces only read the physics scene and each writes its own pixel,
+    // so the rows are traced in parallel.
+    ParallelFor(static_cast<int32>(SizeY), [&](int32 Row) {
+      const uint32 PixelY = static_cast<uint32>(Row);
+      for (uint32 PixelX = 0u; PixelX < SizeX; ++PixelX) {
+        const float X = static_cast<float>(PixelX) * CmPerPixel - Offset;
+        const float Y = static_cast<float>(PixelY) * CmPerPixel - Offset;
+        const FVector Start = ActorTransform.TransformPosition(FVector(X, Y, 50.0f));
+        const FVector End = ActorTransform.TransformPosition(FVector(X, Y, -50.0f));
+
+        // Do the ray tracing.
+        FHitResult Hit;
+        if (LineTrace(World, Start, End, Hit)) {
+          auto StaticMeshComponent = Cast<UStaticMeshComponent>(Hit.Component.Get());
+          if (StaticMeshComponent == nullptr) {
+            UE_LOG(LogCarla, Error, TEXT("Road component is not UInstancedStaticMeshComponent"));
+          } else {
+            RoadMap->SetPixelAt(
+              PixelX,
+              PixelY,
+              GetTag(*StaticMeshComponent->GetStaticMesh()),
+              StaticMeshComponent->GetOwner()->GetTransform(),
+              bLeftHandTraffic);
+          }
         }
       }
-    }
+    });
+    RoadMap->SavePixelData(CachePath, CacheKey);
   }
 
 #if WITH_EDITOR
@@ -74,15 +74,21 @@ private:
   /// Update the random seeds. Generate random if no fixed seed is used.
   void UpdateSeeds();
 
-  /// Regenerate the DCEL.
+  /// Regenerate the DCEL, unless it was already generated with the same seed
+  /// and size.
   void GenerateGraph();
 
   /// Add the road meshes to the scene based on the current DCEL.
   void GenerateRoads();
 
-  /// Generate the road map image and save to disk if requested.
+  /// Generate the road map image and save to disk if requested. The pixel data
+  /// is cached in the "Saved/RoadMaps" folder of the project per layout, so
+  /// regenerating the same map skips the ray tracing.
   void GenerateRoadMap();
 
+  /// Key identifying the road layout the road map is computed from.
+  uint32 GetRoadMapCacheKey() const;
+
   /// @}
   // ===========================================================================
   /// @name Map generation properties
@@ -179,5 +185,8 @@ private:
   TUniquePtr<MapGen::DoublyConnectedEdgeList> Dcel;
 
   TUniquePtr<MapGen::GraphParser> DcelParser;
+
+  /// Seed and size the current DCEL was generated with.
+  FIntVector DcelParameters;
   /// @}
 };
@@ -7,6 +7,7 @@
 #include "PrepareAssetsForCookingCommandlet.h"
 
 #include "HAL/PlatformFilemanager.h"
+#include "Misc/SecureHash.h"
 
 UPrepareAssetsForCookingCommandlet::UPrepareAssetsForCookingCommandlet()
 {
@@ -50,6 +51,12 @@ FPackageParams UPrepareAssetsForCookingCommandlet::ParseParams(const FString &In
 
   // Parse and store flag for only preparing maps
   FParse::Bool(*InParams, TEXT("OnlyPrepareMaps="), PackageParams.bOnlyPrepareMaps);
+
+  // Parse and store the partition of the maps handled by this process
+  FParse::Value(*InParams, TEXT("NumWorkers="), PackageParams.NumWorkers);
+  FParse::Value(*InParams, TEXT("WorkerIndex="), PackageParams.WorkerIndex);
+  PackageParams.NumWorkers = FMath::Max(PackageParams.NumWorkers, 1);
+  PackageParams.WorkerIndex = FMath::Clamp(PackageParams.WorkerIndex, 0, PackageParams.NumWorkers - 1);
   return PackageParams;
 }
 
@@ -184,7 +191,7 @@ bool UPrepareAssetsForCookingCommandlet::SaveWorld(
     OpenWorldActor->BuildRoutes(WorldName);
     OpenWorldActor->AddSpawners();
 
-    SavePackage(PackagePath, Package);
+    bPackageSaved = SavePackage(PackagePath, Package);
 
     // We need to destroy OpenDrive assets once saved the map
     OpenWorldActor->RemoveRoutes();
@@ -193,7 +200,7 @@ bool UPrepareAssetsForCookingCommandlet::SaveWorld(
   }
   else
   {
-    SavePackage(PackagePath, Package);
+    bPackageSaved = SavePackage(PackagePath, Package);
   }
   return bPackageSaved;
 }
@@ -333,9 +340,46 @@ void UPrepareAssetsForCookingCommandlet::GeneratePackagePathFile(const FString &
   SaveStringTextToFile(SaveDirectory, FileName, PackageJsonFilePath, true);
 }
 
+FString UPrepareAssetsForCookingCommandlet::GetMapContentHashPath(
+    const FString &PackageName,
+    const FString &MapName) const
+{
+  return FPaths::ProjectSavedDir() / TEXT("PrepareAssetsForCooking") / PackageName / (MapName + TEXT(".md5"));
+}
+
+FString UPrepareAssetsForCookingCommandlet::ComputeMapContentHash(
+    const FString &PackageName,
+    const FMapData &Map,
+    const TArray<FString> &DataPath) const
+{
+  // List every file with its hash, sorted so the result does not depend on
+  // the order of the file system
+  TArray<FString> Files;
+  for (const auto &Path : DataPath)
+  {
+    const FString Directory = Path.Replace(TEXT("/Game/"), *FPaths::ProjectContentDir());
+    TArray<FString> DirectoryFiles;
+    IFileManager::Get().FindFilesRecursive(DirectoryFiles, *Directory, TEXT("*.uasset"), true, false, false);
+    Files.Append(DirectoryFiles);
+  }
+  Files.Add(FPaths::ProjectContentDir() + PackageName + TEXT("/Maps/") + Map.Name + TEXT(
+      "/OpenDrive/") + Map.Name + TEXT(".xodr"));
+  Files.Sort();
+
+  FString Manifest = Map.Path + (Map.bUseCarlaMapMaterials ? TEXT(" carla\n") : TEXT("\n"));
+  for (const auto &File : Files)
+  {
+    // Missing files hash as empty, so adding or removing them changes the result
+    Manifest += File + TEXT(" ") + LexToString(FMD5Hash::HashFile(*File)) + TEXT("\n");
+  }
+  return FMD5::HashAnsiString(*Manifest);
+}
+
 void UPrepareAssetsForCookingCommandlet::PrepareMapsForCooking(
     const FString &PackageName,
-    const TArray<FMapData> &MapsPaths)
+    const TArray<FMapData> &MapsPaths,
+    const int32 WorkerIndex,
+    const int32 NumWorkers)
 {
   // Load World
   FAssetData AssetData;
@@ -344,8 +388,9 @@ void UPrepareAssetsForCookingCommandlet::PrepareMapsForCooking(
 
   FString BasePath = TEXT("/Game/") + PackageName + TEXT("/Static/");
 
-  for (const auto &Map : MapsPaths)
+  for (int32 Index = WorkerIndex; Index < MapsPaths.Num(); Index += NumWorkers)
   {
+    const auto &Map = MapsPaths[Index];
     FString MapPath = TEXT("/") + Map.Name;
 
     FString DefaultPath   = TEXT("/Game/") + PackageName + TEXT("/Maps/") + Map.Name;
@@ -356,10 +401,31 @@ void UPrepareAssetsForCookingCommandlet::PrepareMapsForCooking(
     // Spawn assets located in semantic segmentation fodlers
     TArray<FString> DataPath = {DefaultPath, RoadsPath, RoadLinesPath, TerrainPath};
 
+    // Skip the maps already prepared from the same content
+    const FString HashPath = GetMapContentHashPath(PackageName, Map.Name);
+    const FString ContentHash = ComputeMapContentHash(PackageName, Map, DataPath);
+    const FString PackageFileName = FPackageName::LongPackageNameToFilename(
+        Map.Path + TEXT("/") + Map.Name,
+        FPackageName::GetMapPackageExtension());
+    FString PreviousHash;
+    if (FFileHelper::LoadFileToString(PreviousHash, *HashPath) &&
+        (PreviousHash == ContentHash) &&
+        FPaths::FileExists(PackageFileName))
+    {
+      UE_LOG(LogTemp, Log, TEXT("Map %s did not change, skipping it."), *Map.Name);
+      continue;
+    }
+
+    // The content changed, the previous map would not be overwritten
+    IFileManager::Get().Delete(*PackageFileName, false, false, true);
+
     TArray<AStaticMeshActor *> SpawnedActors = SpawnMeshesToWorld(DataPath, Map.bUseCarlaMapMaterials);
 
     // Save the World in specified path
-    SaveWorld(AssetData, PackageName, Map.Path, Map.Name);
+    if (SaveWorld(AssetData, PackageName, Map.Path, Map.Name))
+    {
+      FFileHelper::SaveStringToFile(ContentHash, *HashPath);
+    }
 
     // Remove spawned actors from world to keep equal as BaseMap
     DestroySpawnedActorsInWorld(SpawnedActors);
@@ -404,7 +470,11 @@ int32 UPrepareAssetsForCookingCommandlet::Main(const FString &Params)
 
   if (PackageParams.bOnlyPrepareMaps)
   {
-    PrepareMapsForCooking(PackageParams.Name, AssetsPaths.MapsPaths);
+    PrepareMapsForCooking(
+        PackageParams.Name,
+        AssetsPaths.MapsPaths,
+        PackageParams.WorkerIndex,
+        PackageParams.NumWorkers);
   }
   else
   {
@@ -16,7 +16,9 @@
 /// Struct containing Package with @a Name and @a bOnlyPrepareMaps flag used to
 /// separate the cooking of maps and props across the different stages (Maps
 /// will be imported during make import command and Props will be imported
-/// during make package command)
+/// during make package command). The maps are split between @a NumWorkers
+/// commandlet processes, this one preparing the ones whose index modulo
+/// NumWorkers is @a WorkerIndex.
 USTRUCT()
 struct CARLA_API FPackageParams
 {
@@ -25,6 +27,10 @@ struct CARLA_API FPackageParams
   FString Name;
 
   bool bOnlyPrepareMaps;
+
+  int32 WorkerIndex = 0;
+
+  int32 NumWorkers = 1;
 };
 
 /// Struct containing map data read from .Package.json file.
@@ -102,10 +108,22 @@ public:
   /// PackageName
   void GeneratePackagePathFile(const FString &PackageName);
 
-  /// For each Map data contained in @MapsPaths, it creates a World, spawn its
-  /// actors inside the world and saves it in .umap format
-  /// in a destination path built from @a PackageName.
-  void PrepareMapsForCooking(const FString &PackageName, const TArray<FMapData> &MapsPaths);
+  /// For each Map data contained in @MapsPaths assigned to this worker, it
+  /// creates a World, spawn its actors inside the world and saves it in .umap
+  /// format in a destination path built from @a PackageName. Maps whose
+  /// content did not change since they were last prepared are skipped.
+  void PrepareMapsForCooking(
+      const FString &PackageName,
+      const TArray<FMapData> &MapsPaths,
+      int32 WorkerIndex,
+      int32 NumWorkers);
+
+  /// Hash of the content of the assets in @a DataPath and the OpenDrive file
+  /// used to prepare @a Map.
+  FString ComputeMapContentHash(
+      const FString &PackageName,
+      const FMapData &Map,
+      const TArray<FString> &DataPath) const;
 
   /// For all the props inside @a PropsPaths, it creates a single World, spawn
   /// all the props inside the world and saves it in .umap format
@@ -168,4 +186,8 @@ private:
   /// @a PackageName
   FString GetFirstPackagePath(const FString &PackageName) const;
 
+  /// Gets the file where the content hash of the last preparation of the map
+  /// @a MapName is saved, one per map so workers never write the same file.
+  FString GetMapContentHashPath(const FString &PackageName, const FString &MapName) const;
+
 };
@@ -12,8 +12,15 @@
 #include "Carla/Settings/CarlaSettings.h"
 #include "Carla/Settings/EpisodeSettings.h"
 
+#include "GameFramework/HUD.h"
+#include "Kismet/GameplayStatics.h"
+#include "PhysicsEngine/PhysicsSettings.h"
 #include "Runtime/Core/Public/Misc/App.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/profiler/FrameTracer.h>
+#include <compiler/enable-ue4-macros.h>
+
 #include <thread>
 
 // =============================================================================
@@ -36,6 +43,54 @@ static void FCarlaEngine_SetFixedDeltaSeconds(TOptional<double> FixedDeltaSecond
   FApp::SetFixedDeltaTime(FixedDeltaSeconds.Get(0.0));
 }
 
+static void FCarlaEngine_GetPhysicsSubstepping(FEpisodeSettings &Settings)
+{
+  const UPhysicsSettings *PhysicsSettings = UPhysicsSettings::Get();
+  check(PhysicsSettings != nullptr);
+  Settings.bSubstepping = PhysicsSettings->bSubstepping;
+  Settings.MaxSubstepDeltaTime = PhysicsSettings->MaxSubstepDeltaTime;
+  Settings.MaxSubsteps = PhysicsSettings->MaxSubsteps;
+  Settings.bAsyncPhysicsScene = PhysicsSettings->bSubsteppingAsync;
+}
+
+static void FCarlaEngine_SetPhysicsSubstepping(const FEpisodeSettings &Settings)
+{
+  // The physics scene reads them at the start of every physics step, the
+  // frame delta is split in substeps without ticking the world again.
+  UPhysicsSettings *PhysicsSettings = UPhysicsSettings::Get();
+  check(PhysicsSettings != nullptr);
+  PhysicsSettings->bSubstepping = Settings.bSubstepping;
+  PhysicsSettings->MaxSubstepDeltaTime = FMath::Max(Settings.MaxSubstepDeltaTime, 0.0001f);
+  PhysicsSettings->MaxSubsteps = FMath::Clamp(Settings.MaxSubsteps, 1, 32);
+  PhysicsSettings->bSubsteppingAsync = Settings.bAsyncPhysicsScene;
+  // Otherwise the physics of a longer fixed delta is cut short.
+  if (Settings.FixedDeltaSeconds.IsSet())
+  {
+    PhysicsSettings->MaxPhysicsDeltaTime = FMath::Max(
+        PhysicsSettings->MaxPhysicsDeltaTime,
+        static_cast<float>(*Settings.FixedDeltaSeconds));
+  }
+}
+
+static void FCarlaEngine_SetViewportRendering(const FEpisodeSettings &Settings)
+{
+  if (GEngine == nullptr || GEngine->GameViewport == nullptr)
+  {
+    return;
+  }
+  // The scene captures of the sensors are updated by the world at the end of
+  // the frame, independently of the viewport, so they keep rendering.
+  auto Viewport = GEngine->GameViewport;
+  Viewport->bDisableWorldRendering =
+      Settings.bNoRenderingMode || Settings.bNoViewportRendering;
+  auto PlayerController = UGameplayStatics::GetPlayerController(Viewport->GetWorld(), 0);
+  AHUD *HUD = PlayerController != nullptr ? PlayerController->GetHUD() : nullptr;
+  if (HUD != nullptr)
+  {
+    HUD->bShowHUD = !Settings.bNoRenderingMode && !Settings.bNoViewportRendering;
+  }
+}
+
 // =============================================================================
 // -- FCarlaEngine -------------------------------------------------------------
 // =============================================================================
@@ -56,9 +111,28 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
   {
     const auto StreamingPort = Settings.StreamingPort.Get(Settings.RPCPort + 1u);
     auto BroadcastStream = Server.Start(Settings.RPCPort, StreamingPort);
-    Server.AsyncRun(FCarlaEngine_GetNumberOfThreadsForRPCServer());
+    Server.SetStreamingSocketBufferSize(Settings.StreamingSocketBufferSize);
+    // Split the default number of threads in halves unless given.
+    const auto NumberOfThreads = FCarlaEngine_GetNumberOfThreadsForRPCServer();
+    const auto RPCThreads = Settings.RPCWorkerThreads > 0u ?
+        Settings.RPCWorkerThreads :
+        std::max(2u, NumberOfThreads / 2u);
+    const auto StreamingThreads = Settings.StreamingWorkerThreads > 0u ?
+        Settings.StreamingWorkerThreads :
+        std::max(2u, NumberOfThreads - NumberOfThreads / 2u);
+    Server.AsyncRun(
+        RPCThreads,
+        StreamingThreads,
+        Settings.RPCCpuAffinityMask,
+        Settings.StreamingCpuAffinityMask);
+
+    carla::profiler::FrameTracer::SetProcess(1u, "carla-server");
 
     WorldObserver.SetStream(BroadcastStream);
+    WorldObserver.SetKeyFramePeriod(Settings.EpisodeStateKeyFramePeriod);
+    WorldObserver.SetCompactStates(Settings.bCompactEpisodeState);
+    RenderNodePrimaryHost = Settings.RenderNodePrimaryHost;
+    RenderNodePrimaryPort = static_cast<uint16>(Settings.RenderNodePrimaryPort);
 
     OnPreTickHandle = FWorldDelegates::OnWorldTickStart.AddRaw(
         this,
@@ -77,13 +151,25 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
 void FCarlaEngine::NotifyBeginEpisode(UCarlaEpisode &Episode)
 {
   Episode.EpisodeSettings.FixedDeltaSeconds = FCarlaEngine_GetFixedDeltaSeconds();
+  FCarlaEngine_GetPhysicsSubstepping(Episode.EpisodeSettings);
   CurrentEpisode = &Episode;
+  MapLoader.NotifyBeginEpisode(Episode);
   Server.NotifyBeginEpisode(Episode);
+  if (!RenderNodePrimaryHost.IsEmpty())
+  {
+    RenderNode.Connect(RenderNodePrimaryHost, RenderNodePrimaryPort);
+  }
 }
 
 void FCarlaEngine::NotifyEndEpisode()
 {
   Server.NotifyEndEpisode();
+  RenderNode.Disconnect();
+  SensorScheduler.Clear();
+  ObstacleSweepBatch.Clear();
+  KinematicSensorBatch.Clear();
+  PhysicsActivationQueue.Clear();
+  TrafficLightScheduler.Clear();
   CurrentEpisode = nullptr;
 }
 
@@ -91,28 +177,78 @@ void FCarlaEngine::OnPreTick(ELevelTick TickType, float DeltaSeconds)
 {
   if ((TickType == ELevelTick::LEVELTICK_All) && (CurrentEpisode != nullptr))
   {
-    CurrentEpisode->TickTimers(DeltaSeconds);
-    WorldObserver.BroadcastTick(*CurrentEpisode, DeltaSeconds);
+    using carla::profiler::FrameTraceSpan;
+    const uint64 Frame = GFrameCounter;
+    const bool bIsSkippedFrame = Server.IsSkippedFrame(Frame);
+    {
+      FrameTraceSpan Span("engine.pre_tick", Frame);
+      MapLoader.Tick();
+      RenderNode.Tick(*CurrentEpisode);
+      CurrentEpisode->TickTimers(DeltaSeconds);
+      CurrentEpisode->TickWalkerNavigation(DeltaSeconds);
+      CurrentEpisode->TickWorldTiles();
+      CurrentEpisode->TickVehiclePhysicsLOD(DeltaSeconds);
+      CurrentEpisode->TickWalkerAnimationLOD();
+      PhysicsActivationQueue.Tick();
+      TrafficLightScheduler.Tick(DeltaSeconds);
+      CurrentEpisode->TickVehicleControls(DeltaSeconds);
+    }
+    if (!bIsSkippedFrame)
+    {
+      FrameTraceSpan Span("engine.broadcast_tick", Frame);
+      WorldObserver.BroadcastTick(*CurrentEpisode, DeltaSeconds);
+    }
+    {
+      FrameTraceSpan Span("engine.sensor_scheduler", Frame);
+      SensorScheduler.Tick(DeltaSeconds, bIsSkippedFrame);
+    }
+    WorldTickStart = carla::profiler::FrameTracer::Now();
   }
 }
 
-void FCarlaEngine::OnPostTick(UWorld *, ELevelTick, float)
+void FCarlaEngine::OnPostTick(UWorld *, ELevelTick TickType, float DeltaSeconds)
 {
-  do
+  using carla::profiler::FrameTracer;
+  if (WorldTickStart != 0u)
+  {
+    // Physics and the tick of every actor.
+    FrameTracer::Record("engine.world_tick", GFrameCounter, WorldTickStart, FrameTracer::Now());
+    WorldTickStart = 0u;
+  }
+  if ((TickType == ELevelTick::LEVELTICK_All) && (CurrentEpisode != nullptr))
+  {
+    carla::profiler::FrameTraceSpan Span("engine.kinematic_sensors", GFrameCounter);
+    KinematicSensorBatch.Tick(DeltaSeconds);
+  }
+  Server.UpdateReadSnapshot();
+  CARLA_TRACE_FRAME(engine, wait_tick_cue, GFrameCounter);
+  if (RenderNode.IsConnected())
+  {
+    // A render node ticks once per frame of its primary.
+    while (RenderNode.IsConnected() && !RenderNode.HasPendingFrames())
+    {
+      Server.RunSome(1u);
+    }
+    return;
+  }
+  if (!bSynchronousMode)
   {
     Server.RunSome(10u);
+    return;
   }
-  while (bSynchronousMode && !Server.TickCueReceived());
+  // Sleeps until a call arrives and returns right after the tick cue. The
+  // time slice only bounds how long a switch to asynchronous mode, done by
+  // one of these calls, goes unnoticed.
+  while (bSynchronousMode && !Server.RunUntilTickCue(10u));
 }
 
 void FCarlaEngine::OnEpisodeSettingsChanged(const FEpisodeSettings &Settings)
 {
   bSynchronousMode = Settings.bSynchronousMode;
 
-  if (GEngine && GEngine->GameViewport)
-  {
-    GEngine->GameViewport->bDisableWorldRendering = Settings.bNoRenderingMode;
-  }
+  FCarlaEngine_SetViewportRendering(Settings);
 
   FCarlaEngine_SetFixedDeltaSeconds(Settings.FixedDeltaSeconds);
+
+  FCarlaEngine_SetPhysicsSubstepping(Settings);
 }
@@ -6,8 +6,15 @@
 
 #pragma once
 
+#include "Carla/Game/MapLoader.h"
+#include "Carla/Game/PhysicsActivationQueue.h"
+#include "Carla/Game/RenderNode.h"
+#include "Carla/Sensor/KinematicSensorBatch.h"
+#include "Carla/Sensor/ObstacleSweepBatch.h"
+#include "Carla/Sensor/SensorScheduler.h"
 #include "Carla/Sensor/WorldObserver.h"
 #include "Carla/Server/CarlaServer.h"
+#include "Carla/Traffic/TrafficLightScheduler.h"
 #include "Carla/Util/NonCopyable.h"
 
 #include "Misc/CoreDelegates.h"
@@ -37,6 +44,41 @@ public:
     return CurrentEpisode;
   }
 
+  FSensorScheduler &GetSensorScheduler()
+  {
+    return SensorScheduler;
+  }
+
+  FObstacleSweepBatch &GetObstacleSweepBatch()
+  {
+    return ObstacleSweepBatch;
+  }
+
+  FKinematicSensorBatch &GetKinematicSensorBatch()
+  {
+    return KinematicSensorBatch;
+  }
+
+  FPhysicsActivationQueue &GetPhysicsActivationQueue()
+  {
+    return PhysicsActivationQueue;
+  }
+
+  FTrafficLightScheduler &GetTrafficLightScheduler()
+  {
+    return TrafficLightScheduler;
+  }
+
+  FWorldObserver &GetWorldObserver()
+  {
+    return WorldObserver;
+  }
+
+  FMapLoader &GetMapLoader()
+  {
+    return MapLoader;
+  }
+
 private:
 
   void OnPreTick(ELevelTick TickType, float DeltaSeconds);
@@ -53,8 +95,30 @@ private:
 
   FWorldObserver WorldObserver;
 
+  FSensorScheduler SensorScheduler;
+
+  FObstacleSweepBatch ObstacleSweepBatch;
+
+  FKinematicSensorBatch KinematicSensorBatch;
+
+  FPhysicsActivationQueue PhysicsActivationQueue;
+
+  FTrafficLightScheduler TrafficLightScheduler;
+
+  FRenderNode RenderNode;
+
+  FMapLoader MapLoader;
+
+  /// Primary server mirrored by RenderNode, none if the host is empty.
+  FString RenderNodePrimaryHost;
+
+  uint16 RenderNodePrimaryPort = 0u;
+
   UCarlaEpisode *CurrentEpisode = nullptr;
 
+  /// Start of the world tick of the current frame, for the frame tracer.
+  uint64 WorldTickStart = 0u;
+
   FDelegateHandle OnPreTickHandle;
 
   FDelegateHandle OnPostTickHandle;
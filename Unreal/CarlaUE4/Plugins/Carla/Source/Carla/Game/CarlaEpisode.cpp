@@ -7,7 +7,10 @@
 #include "Carla.h"
 #include "Carla/Game/CarlaEpisode.h"
 
+#include "Carla/Game/CarlaGameInstance.h"
+#include "Carla/Game/CarlaStatics.h"
 #include "Carla/Sensor/Sensor.h"
+#include "Carla/Traffic/TrafficLightBase.h"
 #include "Carla/Util/BoundingBoxCalculator.h"
 #include "Carla/Util/RandomEngine.h"
 #include "Carla/Vehicle/VehicleSpawnPoint.h"
@@ -17,6 +20,10 @@
 #include "GameFramework/SpectatorPawn.h"
 #include "Kismet/GameplayStatics.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/WeatherParameters.h>
+#include <compiler/enable-ue4-macros.h>
+
 static FString UCarlaEpisode_GetTrafficSignId(ETrafficSignState State)
 {
   using TSS = ETrafficSignState;
@@ -46,9 +53,11 @@ UCarlaEpisode::UCarlaEpisode(const FObjectInitializer &ObjectInitializer)
   ActorDispatcher = CreateDefaultSubobject<UActorDispatcher>(TEXT("ActorDispatcher"));
 }
 
-bool UCarlaEpisode::LoadNewEpisode(const FString &MapString)
+/// Find the map @a MapString, a path under /Game or the name of a map under
+/// the content directory. @a FinalPath starts with the map to look for and
+/// ends with its path under /Game.
+static bool UCarlaEpisode_FindMapPath(const FString &MapString, FString &FinalPath)
 {
-  FString FinalPath = MapString.IsEmpty() ? GetMapName() : MapString;
   bool bIsFileFound = false;
   if (MapString.StartsWith("/Game"))
   {
@@ -91,6 +100,13 @@ bool UCarlaEpisode::LoadNewEpisode(const FString &MapString)
       }
     }
   }
+  return bIsFileFound;
+}
+
+bool UCarlaEpisode::LoadNewEpisode(const FString &MapString)
+{
+  FString FinalPath = MapString.IsEmpty() ? GetMapName() : MapString;
+  const bool bIsFileFound = UCarlaEpisode_FindMapPath(MapString, FinalPath);
   if (bIsFileFound)
   {
     UE_LOG(LogCarla, Warning, TEXT("Loading a new episode: %s"), *FinalPath);
@@ -100,10 +116,95 @@ bool UCarlaEpisode::LoadNewEpisode(const FString &MapString)
   return bIsFileFound;
 }
 
+bool UCarlaEpisode::LoadNewEpisodeAsync(const FString &MapString, const TArray<FString> &PreloadAssets)
+{
+  FString FinalPath = MapString.IsEmpty() ? GetMapName() : MapString;
+  if (!UCarlaEpisode_FindMapPath(MapString, FinalPath))
+  {
+    return false;
+  }
+  auto *GameInstance = UCarlaStatics::GetGameInstance(GetWorld());
+  if (GameInstance == nullptr)
+  {
+    return false;
+  }
+  // A long package name, without the extension of the file.
+  GameInstance->GetMapLoader().Load(*this, FPaths::SetExtension(FinalPath, TEXT("")), PreloadAssets);
+  return true;
+}
+
+void UCarlaEpisode::ResetEpisode()
+{
+  UE_LOG(LogCarla, Log, TEXT("Resetting the episode"));
+
+  // Attached actors first, so their parents are free to go to the pool.
+  TArray<AActor *> AttachedActors;
+  TArray<AActor *> Actors;
+  for (FActorView View : GetActorRegistry())
+  {
+    AActor *Actor = View.GetActor();
+    if ((Actor != nullptr) && !LevelActorIds.Contains(View.GetActorId()))
+    {
+      (Actor->GetAttachParentActor() != nullptr ? AttachedActors : Actors).Emplace(Actor);
+    }
+  }
+  for (AActor *Actor : AttachedActors)
+  {
+    DestroyActor(Actor);
+  }
+  for (AActor *Actor : Actors)
+  {
+    DestroyActor(Actor);
+  }
+
+  for (const auto &InitialState : TrafficLightInitialStates)
+  {
+    ATrafficLightBase *TrafficLight = InitialState.TrafficLight.Get();
+    if (TrafficLight != nullptr)
+    {
+      TrafficLight->SetGreenTime(InitialState.GreenTime);
+      TrafficLight->SetYellowTime(InitialState.YellowTime);
+      TrafficLight->SetRedTime(InitialState.RedTime);
+      TrafficLight->SetTrafficLightState(InitialState.State);
+      TrafficLight->SetElapsedTime(InitialState.ElapsedTime);
+      TrafficLight->SetTimeIsFrozen(InitialState.bTimeIsFrozen);
+    }
+  }
+
+  if (Weather != nullptr)
+  {
+    Weather->ApplyWeather(carla::rpc::WeatherParameters::Default);
+  }
+
+  StateSnapshots.Empty();
+  ElapsedGameTime = 0.0;
+  Id = URandomEngine::GenerateRandomId();
+}
+
+uint64 UCarlaEpisode::SaveStateSnapshot()
+{
+  const auto SnapshotId = ++LastStateSnapshotId;
+  StateSnapshots.Add(SnapshotId, FEpisodeStateSnapshot::Capture(*this));
+  return SnapshotId;
+}
+
+bool UCarlaEpisode::RestoreStateSnapshot(const uint64 SnapshotId)
+{
+  const auto *Snapshot = StateSnapshots.Find(SnapshotId);
+  if (Snapshot == nullptr)
+  {
+    return false;
+  }
+  Snapshot->Restore(*this);
+  return true;
+}
+
 void UCarlaEpisode::ApplySettings(const FEpisodeSettings &Settings)
 {
   FCarlaStaticDelegates::OnEpisodeSettingsChange.Broadcast(Settings);
   EpisodeSettings = Settings;
+  check(ActorDispatcher != nullptr);
+  ActorDispatcher->SetPoolSize(static_cast<uint32>(FMath::Max(Settings.ActorPoolSize, 0)));
 }
 
 TArray<FTransform> UCarlaEpisode::GetRecommendedSpawnPoints() const
@@ -135,6 +236,23 @@ carla::rpc::Actor UCarlaEpisode::SerializeActor(FActorView ActorView) const
   return Actor;
 }
 
+bool UCarlaEpisode::SetActorKinematic(AActor &Actor, const bool bEnabled)
+{
+  auto RootComponent = Cast<UPrimitiveComponent>(Actor.GetRootComponent());
+  if (RootComponent == nullptr)
+  {
+    return false;
+  }
+  RootComponent->SetSimulatePhysics(!bEnabled);
+  TInlineComponentArray<UPrimitiveComponent *> Components;
+  Actor.GetComponents(Components);
+  for (auto *Component : Components)
+  {
+    Component->SetGenerateOverlapEvents(!bEnabled);
+  }
+  return true;
+}
+
 void UCarlaEpisode::AttachActors(
     AActor *Child,
     AActor *Parent,
@@ -158,6 +276,10 @@ void UCarlaEpisode::InitializeAtBeginPlay()
 {
   auto World = GetWorld();
   check(World != nullptr);
+
+  // Blueprints may have changed since the previous episode.
+  UBoundingBoxCalculator::ClearCache();
+
   auto PlayerController = UGameplayStatics::GetPlayerController(World, 0);
   if (PlayerController == nullptr)
   {
@@ -170,7 +292,7 @@ void UCarlaEpisode::InitializeAtBeginPlay()
     FActorDescription Description;
     Description.Id = TEXT("spectator");
     Description.Class = Spectator->GetClass();
-    ActorDispatcher->RegisterActor(*Spectator, Description);
+    LevelActorIds.Add(ActorDispatcher->RegisterActor(*Spectator, Description).GetActorId());
   }
   else
   {
@@ -184,7 +306,18 @@ void UCarlaEpisode::InitializeAtBeginPlay()
     FActorDescription Description;
     Description.Id = UCarlaEpisode_GetTrafficSignId(Actor->GetTrafficSignState());
     Description.Class = Actor->GetClass();
-    ActorDispatcher->RegisterActor(*Actor, Description);
+    LevelActorIds.Add(ActorDispatcher->RegisterActor(*Actor, Description).GetActorId());
+    if (auto *TrafficLight = Cast<ATrafficLightBase>(Actor))
+    {
+      TrafficLightInitialStates.Emplace(FTrafficLightInitialState{
+          TrafficLight,
+          TrafficLight->GetTrafficLightState(),
+          TrafficLight->GetGreenTime(),
+          TrafficLight->GetYellowTime(),
+          TrafficLight->GetRedTime(),
+          TrafficLight->GetElapsedTime(),
+          TrafficLight->GetTimeIsFrozen()});
+    }
   }
 
   for (TActorIterator<AStaticMeshActor> It(World); It; ++It)
@@ -198,7 +331,7 @@ void UCarlaEpisode::InitializeAtBeginPlay()
       FActorDescription Description;
       Description.Id = TEXT("static.prop");
       Description.Class = Actor->GetClass();
-      ActorDispatcher->RegisterActor(*Actor, Description);
+      LevelActorIds.Add(ActorDispatcher->RegisterActor(*Actor, Description).GetActorId());
     }
   }
 }
@@ -7,11 +7,20 @@
 #pragma once
 
 #include "Carla/Actor/ActorDispatcher.h"
+#include "Carla/Game/EpisodeStateSnapshot.h"
+#include "Carla/Game/WorldTileStreamer.h"
 #include "Carla/Recorder/CarlaRecorder.h"
 #include "Carla/Sensor/WorldObserver.h"
 #include "Carla/Server/CarlaServer.h"
 #include "Carla/Settings/EpisodeSettings.h"
+#include "Carla/Traffic/TrafficLightState.h"
 #include "Carla/Util/ActorAttacher.h"
+#include "Carla/Vehicle/AutopilotSettings.h"
+#include "Carla/Vehicle/VehicleControlBatch.h"
+#include "Carla/Vehicle/VehicleObstacleGrid.h"
+#include "Carla/Vehicle/VehiclePhysicsLOD.h"
+#include "Carla/Walker/WalkerAnimationLOD.h"
+#include "Carla/Walker/WalkerNavigation.h"
 #include "Carla/Weather/Weather.h"
 
 #include "GameFramework/Pawn.h"
@@ -19,6 +28,7 @@
 #include <compiler/disable-ue4-macros.h>
 #include <carla/geom/BoundingBox.h>
 #include <carla/geom/GeoLocation.h>
+#include <carla/geom/GeoProjection.h>
 #include <carla/rpc/Actor.h>
 #include <carla/rpc/ActorDescription.h>
 #include <carla/streaming/Server.h>
@@ -26,6 +36,8 @@
 
 #include "CarlaEpisode.generated.h"
 
+class ATrafficLightBase;
+
 /// A simulation episode.
 ///
 /// Each time the level is restarted a new episode is created.
@@ -54,6 +66,20 @@ public:
   UFUNCTION(BlueprintCallable)
   bool LoadNewEpisode(const FString &MapString);
 
+  /// Load a new map in the background and start a new episode once it is
+  /// loaded, along with the assets of @a PreloadAssets, see FMapLoader. This
+  /// episode keeps running meanwhile.
+  ///
+  /// Return false if the map is not found.
+  bool LoadNewEpisodeAsync(const FString &MapString, const TArray<FString> &PreloadAssets);
+
+  /// Start a new episode in the current map without reloading it. Destroys
+  /// the actors spawned since the level started, resets the weather, the
+  /// traffic lights and the timers, and takes a new id. The settings are
+  /// kept.
+  UFUNCTION(BlueprintCallable)
+  void ResetEpisode();
+
   // ===========================================================================
   // -- Episode settings -------------------------------------------------------
   // ===========================================================================
@@ -109,7 +135,14 @@ public:
   /// Return the GeoLocation point of the map loaded
   const carla::geom::GeoLocation &GetGeoReference() const
   {
-    return MapGeoReference;
+    return MapGeoProjection.GetGeoReference();
+  }
+
+  /// Return the projection to GeoLocation around the geo-reference of the
+  /// map loaded.
+  const carla::geom::GeoProjection &GetGeoProjection() const
+  {
+    return MapGeoProjection;
   }
 
   // ===========================================================================
@@ -226,6 +259,13 @@ public:
       AActor *Parent,
       EAttachmentType InAttachmentType = EAttachmentType::Rigid);
 
+  /// Make @a Actor kinematic, moved only by setting its transform: its
+  /// physics is turned off and it generates no overlap events. Disabling it
+  /// turns both back on.
+  ///
+  /// @return false if the root component of @a Actor is not a primitive.
+  static bool SetActorKinematic(AActor &Actor, bool bEnabled);
+
   /// @copydoc FActorDispatcher::DestroyActor(AActor*)
   UFUNCTION(BlueprintCallable)
   bool DestroyActor(AActor *Actor)
@@ -243,6 +283,62 @@ public:
     return ActorDispatcher->DestroyActor(Actor);
   }
 
+  // ===========================================================================
+  // -- Pedestrian navigation --------------------------------------------------
+  // ===========================================================================
+
+public:
+
+  /// Navigation of the walkers moved by the server, used when
+  /// FEpisodeSettings::bServerSideNavigation is enabled.
+  FWalkerNavigation &GetWalkerNavigation()
+  {
+    return WalkerNavigation;
+  }
+
+  /// Grid of the vehicles and walkers used by the server-side autopilot,
+  /// rebuilt the first time it is requested each frame.
+  const FVehicleObstacleGrid &GetVehicleObstacleGrid()
+  {
+    VehicleObstacleGrid.Update(*this);
+    return VehicleObstacleGrid;
+  }
+
+  /// Settings of the server-side autopilot, read by every
+  /// AWheeledVehicleAIController with the autopilot enabled.
+  const FAutopilotSettings &GetAutopilotSettings() const
+  {
+    return AutopilotSettings;
+  }
+
+  void SetAutopilotSettings(const FAutopilotSettings &Settings)
+  {
+    AutopilotSettings = Settings;
+  }
+
+  // ===========================================================================
+  // -- State snapshots --------------------------------------------------------
+  // ===========================================================================
+
+public:
+
+  /// Capture the dynamic state of the episode in memory, see
+  /// FEpisodeStateSnapshot.
+  ///
+  /// @return the id to restore it with.
+  uint64 SaveStateSnapshot();
+
+  /// Put back the state captured by SaveStateSnapshot with @a SnapshotId.
+  ///
+  /// @return false if there is no such snapshot.
+  bool RestoreStateSnapshot(uint64 SnapshotId);
+
+  /// Release the memory of the snapshot @a SnapshotId.
+  bool DropStateSnapshot(uint64 SnapshotId)
+  {
+    return StateSnapshots.Remove(SnapshotId) > 0;
+  }
+
   // ===========================================================================
   // -- Other methods ----------------------------------------------------------
   // ===========================================================================
@@ -300,7 +396,56 @@ private:
     ElapsedGameTime += DeltaSeconds;
   }
 
-  const uint64 Id = 0u;
+  void TickWalkerNavigation(float DeltaSeconds)
+  {
+    WalkerNavigation.Tick(*this, DeltaSeconds);
+  }
+
+  const FWorldTileStreamer &GetWorldTileStreamer() const
+  {
+    return WorldTileStreamer;
+  }
+
+  void TickWorldTiles()
+  {
+    WorldTileStreamer.Tick(*this);
+  }
+
+  void TickVehiclePhysicsLOD(float DeltaSeconds)
+  {
+    VehiclePhysicsLOD.Tick(*this, DeltaSeconds);
+  }
+
+  void TickWalkerAnimationLOD()
+  {
+    WalkerAnimationLOD.Tick(*this);
+  }
+
+  void TickVehicleControls(float DeltaSeconds)
+  {
+    VehicleControlBatch.Tick(*this, DeltaSeconds);
+  }
+
+  /// State of a traffic light of the level when it started, restored by
+  /// ResetEpisode.
+  struct FTrafficLightInitialState
+  {
+    TWeakObjectPtr<ATrafficLightBase> TrafficLight;
+
+    ETrafficLightState State;
+
+    float GreenTime;
+
+    float YellowTime;
+
+    float RedTime;
+
+    float ElapsedTime;
+
+    bool bTimeIsFrozen;
+  };
+
+  uint64 Id = 0u;
 
   double ElapsedGameTime = 0.0;
 
@@ -321,5 +466,29 @@ private:
 
   ACarlaRecorder *Recorder = nullptr;
 
-  carla::geom::GeoLocation MapGeoReference;
+  carla::geom::GeoProjection MapGeoProjection;
+
+  FWalkerNavigation WalkerNavigation;
+
+  FWorldTileStreamer WorldTileStreamer;
+
+  FVehiclePhysicsLOD VehiclePhysicsLOD;
+
+  FWalkerAnimationLOD WalkerAnimationLOD;
+
+  FVehicleObstacleGrid VehicleObstacleGrid;
+
+  FVehicleControlBatch VehicleControlBatch;
+
+  FAutopilotSettings AutopilotSettings;
+
+  /// Actors part of the level, registered at begin play.
+  TSet<FActorView::IdType> LevelActorIds;
+
+  TArray<FTrafficLightInitialState> TrafficLightInitialStates;
+
+  /// Snapshots saved in this episode by id, dropped when it is reset.
+  TMap<uint64, FEpisodeStateSnapshot> StateSnapshots;
+
+  uint64 LastStateSnapshotId = 0u;
 };
@@ -73,6 +73,41 @@ public:
     return CarlaEngine.GetServer();
   }
 
+  FSensorScheduler &GetSensorScheduler()
+  {
+    return CarlaEngine.GetSensorScheduler();
+  }
+
+  FObstacleSweepBatch &GetObstacleSweepBatch()
+  {
+    return CarlaEngine.GetObstacleSweepBatch();
+  }
+
+  FKinematicSensorBatch &GetKinematicSensorBatch()
+  {
+    return CarlaEngine.GetKinematicSensorBatch();
+  }
+
+  FPhysicsActivationQueue &GetPhysicsActivationQueue()
+  {
+    return CarlaEngine.GetPhysicsActivationQueue();
+  }
+
+  FTrafficLightScheduler &GetTrafficLightScheduler()
+  {
+    return CarlaEngine.GetTrafficLightScheduler();
+  }
+
+  FWorldObserver &GetWorldObserver()
+  {
+    return CarlaEngine.GetWorldObserver();
+  }
+
+  FMapLoader &GetMapLoader()
+  {
+    return CarlaEngine.GetMapLoader();
+  }
+
 private:
 
   UPROPERTY(Category = "CARLA Settings", EditAnywhere)
@@ -100,7 +100,7 @@ void ACarlaGameModeBase::InitGame(
   if (!map.has_value()) {
     UE_LOG(LogCarla, Error, TEXT("Invalid Map"));
   } else {
-    Episode->MapGeoReference = map->GetGeoReference();
+    Episode->MapGeoProjection = map->GetGeoProjection();
   }
 
 }
@@ -0,0 +1,137 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Game/EpisodeStateSnapshot.h"
+
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Traffic/TrafficLightBase.h"
+#include "Carla/Vehicle/CarlaWheeledVehicle.h"
+#include "Carla/Walker/WalkerController.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/Pawn.h"
+
+static AWalkerController *FEpisodeStateSnapshot_GetWalkerController(AActor &Actor)
+{
+  auto Pawn = Cast<APawn>(&Actor);
+  return Pawn != nullptr ? Cast<AWalkerController>(Pawn->GetController()) : nullptr;
+}
+
+FEpisodeStateSnapshot FEpisodeStateSnapshot::Capture(UCarlaEpisode &Episode)
+{
+  FEpisodeStateSnapshot Snapshot;
+  for (FActorView View : Episode.GetActorRegistry())
+  {
+    AActor *Actor = View.GetActor();
+    if (!View.IsValid() || Actor->IsPendingKill())
+    {
+      continue;
+    }
+    const auto Id = View.GetActorId();
+
+    if (Actor->GetAttachParentActor() == nullptr)
+    {
+      const auto RootComponent = Cast<UPrimitiveComponent>(Actor->GetRootComponent());
+      Snapshot.Actors.Emplace(FActorState{
+          Id,
+          Actor->GetActorTransform(),
+          Actor->GetVelocity(),
+          RootComponent != nullptr ?
+              RootComponent->GetPhysicsAngularVelocityInDegrees() :
+              FVector::ZeroVector});
+    }
+
+    switch (View.GetActorType())
+    {
+      case FActorView::ActorType::Vehicle:
+        if (auto Vehicle = Cast<ACarlaWheeledVehicle>(Actor))
+        {
+          Snapshot.Vehicles.Emplace(FVehicleState{Id, Vehicle->GetVehicleControl()});
+        }
+        break;
+      case FActorView::ActorType::Walker:
+        if (auto Controller = FEpisodeStateSnapshot_GetWalkerController(*Actor))
+        {
+          Snapshot.Walkers.Emplace(FWalkerState{Id, Controller->GetWalkerControl()});
+        }
+        break;
+      case FActorView::ActorType::TrafficLight:
+        if (auto TrafficLight = Cast<ATrafficLightBase>(Actor))
+        {
+          Snapshot.TrafficLights.Emplace(FTrafficLightState{
+              Id,
+              TrafficLight->GetTrafficLightState(),
+              TrafficLight->GetElapsedTime(),
+              TrafficLight->GetTimeIsFrozen()});
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  Episode.GetWalkerNavigation().GetWalkerStates(Episode, Snapshot.CrowdWalkers);
+  return Snapshot;
+}
+
+void FEpisodeStateSnapshot::Restore(UCarlaEpisode &Episode) const
+{
+  // The traffic lights go first, switching them notifies the vehicles waiting.
+  for (const auto &State : TrafficLights)
+  {
+    auto TrafficLight = Cast<ATrafficLightBase>(Episode.FindActor(State.Id).GetActor());
+    if (TrafficLight != nullptr)
+    {
+      TrafficLight->SetTimeIsFrozen(State.bTimeIsFrozen);
+      TrafficLight->SetTrafficLightState(State.State);
+      TrafficLight->SetElapsedTime(State.ElapsedTime);
+    }
+  }
+
+  for (const auto &State : Actors)
+  {
+    AActor *Actor = Episode.FindActor(State.Id).GetActor();
+    if ((Actor == nullptr) || Actor->IsPendingKill())
+    {
+      continue;
+    }
+    Actor->SetActorTransform(State.Transform, false, nullptr, ETeleportType::TeleportPhysics);
+    auto RootComponent = Cast<UPrimitiveComponent>(Actor->GetRootComponent());
+    if ((RootComponent != nullptr) && RootComponent->IsSimulatingPhysics())
+    {
+      RootComponent->SetPhysicsLinearVelocity(State.LinearVelocity, false, "None");
+      RootComponent->SetPhysicsAngularVelocityInDegrees(State.AngularVelocity, false, "None");
+    }
+  }
+
+  for (const auto &State : Vehicles)
+  {
+    auto Vehicle = Cast<ACarlaWheeledVehicle>(Episode.FindActor(State.Id).GetActor());
+    if (Vehicle != nullptr)
+    {
+      Vehicle->ApplyVehicleControl(State.Control, EVehicleInputPriority::Client);
+    }
+  }
+
+  for (const auto &State : Walkers)
+  {
+    AActor *Actor = Episode.FindActor(State.Id).GetActor();
+    auto Controller = Actor != nullptr ? FEpisodeStateSnapshot_GetWalkerController(*Actor) : nullptr;
+    if (Controller != nullptr)
+    {
+      Controller->ApplyWalkerControl(State.Control);
+    }
+  }
+
+  auto &Navigation = Episode.GetWalkerNavigation();
+  for (const auto &State : CrowdWalkers)
+  {
+    if (Episode.FindActor(State.Id).IsValid() && !Navigation.RestoreWalker(Episode, State))
+    {
+      UE_LOG(LogCarla, Warning, TEXT("Unable to restore the crowd state of walker %d"), State.Id);
+    }
+  }
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Actor/ActorView.h"
+#include "Carla/Traffic/TrafficLightState.h"
+#include "Carla/Vehicle/VehicleControl.h"
+#include "Carla/Walker/WalkerControl.h"
+#include "Carla/Walker/WalkerNavigation.h"
+
+#include "Containers/Array.h"
+
+class UCarlaEpisode;
+
+/// In-memory copy of the dynamic state of an episode: the transforms and
+/// velocities of the actors, the controls of the vehicles and walkers, the
+/// timers of the traffic lights and the crowd state of the walkers driven by
+/// FWalkerNavigation. Restoring it puts the episode back to the moment it was
+/// captured within a frame, so a scenario can be rolled forward several times
+/// from the same state.
+///
+/// Actors spawned after the capture are left as they are, and the ones
+/// destroyed since are not brought back. The internal state of the PhysX
+/// drivetrain, like the engine revolutions and the wheel spin, is not
+/// captured.
+class FEpisodeStateSnapshot
+{
+public:
+
+  /// Capture the state of every actor of @a Episode.
+  static FEpisodeStateSnapshot Capture(UCarlaEpisode &Episode);
+
+  /// Put back the state captured to the actors of @a Episode still alive.
+  void Restore(UCarlaEpisode &Episode) const;
+
+private:
+
+  struct FActorState
+  {
+    FActorView::IdType Id;
+
+    FTransform Transform;
+
+    FVector LinearVelocity;
+
+    FVector AngularVelocity;
+  };
+
+  struct FVehicleState
+  {
+    FActorView::IdType Id;
+
+    FVehicleControl Control;
+  };
+
+  struct FWalkerState
+  {
+    FActorView::IdType Id;
+
+    FWalkerControl Control;
+  };
+
+  struct FTrafficLightState
+  {
+    FActorView::IdType Id;
+
+    ETrafficLightState State;
+
+    float ElapsedTime;
+
+    bool bTimeIsFrozen;
+  };
+
+  /// Actors not attached to another one, attached actors follow their parent.
+  TArray<FActorState> Actors;
+
+  TArray<FVehicleState> Vehicles;
+
+  TArray<FWalkerState> Walkers;
+
+  TArray<FTrafficLightState> TrafficLights;
+
+  TArray<FWalkerNavigation::FWalkerState> CrowdWalkers;
+};
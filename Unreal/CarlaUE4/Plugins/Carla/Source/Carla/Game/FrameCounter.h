@@ -0,0 +1,43 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CoreGlobals.h"
+
+/// Frame stamped on the data sent to the clients. That is GFrameCounter,
+/// except on a render node, where it is the frame of the primary server the
+/// actors were last moved to.
+class FFrameCounter
+{
+public:
+
+  static uint64 Get()
+  {
+    return GFrameCounter + GetOffset();
+  }
+
+  /// Stamp @a Frame on the data of the current frame, and the frames after
+  /// it on the ones following.
+  static void SyncTo(uint64 Frame)
+  {
+    GetOffset() = Frame - GFrameCounter;
+  }
+
+  static void Reset()
+  {
+    GetOffset() = 0u;
+  }
+
+private:
+
+  /// Only read and written from the game thread.
+  static uint64 &GetOffset()
+  {
+    static uint64 Offset = 0u;
+    return Offset;
+  }
+};
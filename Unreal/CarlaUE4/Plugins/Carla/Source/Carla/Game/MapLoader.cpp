@@ -0,0 +1,176 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Game/MapLoader.h"
+
+#include "Carla/Game/CarlaEpisode.h"
+
+#include "Engine/StreamableManager.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/String.h>
+#include <compiler/enable-ue4-macros.h>
+
+FMapLoader::~FMapLoader()
+{
+  // Not releasing the map, the object system may be gone already.
+  AssetsHandle.Reset();
+}
+
+void FMapLoader::Load(
+    UCarlaEpisode &InEpisode,
+    const FString &InMapPath,
+    const TArray<FString> &PreloadAssets)
+{
+  ReleaseMap();
+  if (AssetsHandle.IsValid())
+  {
+    AssetsHandle->ReleaseHandle();
+    AssetsHandle.Reset();
+  }
+
+  const uint32 Request = ++CurrentRequest;
+  State = EState::Loading;
+  Episode = &InEpisode;
+  PreviousEpisodeId = InEpisode.GetId();
+  MapPath = InMapPath;
+  StartTime = FPlatformTime::Seconds();
+
+  UE_LOG(LogCarla, Log, TEXT("Loading in the background the map %s and %d assets"), *MapPath, PreloadAssets.Num());
+
+  if (PreloadAssets.Num() > 0)
+  {
+    if (!StreamableManager.IsValid())
+    {
+      StreamableManager = MakeUnique<FStreamableManager>();
+    }
+    TArray<FSoftObjectPath> Paths;
+    Paths.Reserve(PreloadAssets.Num());
+    for (const auto &Asset : PreloadAssets)
+    {
+      Paths.Emplace(Asset);
+    }
+    AssetsHandle = StreamableManager->RequestAsyncLoad(
+        Paths,
+        FStreamableDelegate(),
+        FStreamableManager::AsyncLoadHighPriority,
+        true);
+  }
+
+  LoadPackageAsync(
+      MapPath,
+      FLoadPackageAsyncDelegate::CreateLambda([this, Request](
+          const FName &, UPackage *Package, EAsyncLoadingResult::Type Result) {
+        OnMapLoaded(Request, Package, Result == EAsyncLoadingResult::Succeeded);
+      }));
+}
+
+carla::rpc::MapLoadProgress FMapLoader::GetProgress() const
+{
+  carla::rpc::MapLoadProgress Progress;
+  Progress.map_name = carla::rpc::FromFString(MapPath);
+  Progress.state = State;
+  Progress.previous_episode_id = PreviousEpisodeId;
+  if (State == EState::Idle)
+  {
+    Progress.progress = MapPath.IsEmpty() ? 0.0f : 1.0f;
+    return Progress;
+  }
+  Progress.elapsed_seconds = FPlatformTime::Seconds() - StartTime;
+  float MapProgress = 1.0f;
+  if (!IsMapLoaded())
+  {
+    // Negative while queued.
+    const float Percentage = GetAsyncLoadPercentage(FName(*MapPath));
+    MapProgress = Percentage >= 0.0f ? Percentage / 100.0f : 0.0f;
+  }
+  Progress.progress = MapProgress;
+  if (AssetsHandle.IsValid())
+  {
+    int32 Loaded = 0;
+    int32 Requested = 0;
+    AssetsHandle->GetLoadedCount(Loaded, Requested);
+    Progress.preloaded_assets = static_cast<uint32_t>(Loaded);
+    Progress.total_preload_assets = static_cast<uint32_t>(Requested);
+    Progress.progress = 0.5f * (MapProgress + AssetsHandle->GetProgress());
+  }
+  return Progress;
+}
+
+void FMapLoader::Tick()
+{
+  if ((State != EState::Loading) || !IsMapLoaded() || !AreAssetsLoaded())
+  {
+    return;
+  }
+  if (!Episode.IsValid() || (Episode->GetId() != PreviousEpisodeId))
+  {
+    // The episode changed meanwhile, it is up to the client to load again.
+    UE_LOG(LogCarla, Warning, TEXT("Map %s loaded after the episode was replaced, not opening it"), *MapPath);
+    ReleaseMap();
+    State = EState::Failed;
+    return;
+  }
+  UE_LOG(
+      LogCarla,
+      Log,
+      TEXT("Map %s loaded in the background in %.2f s, opening it"),
+      *MapPath,
+      FPlatformTime::Seconds() - StartTime);
+  State = EState::Opening;
+  // The level is opened in the travel of the next frame, the package is
+  // already in memory.
+  if (!Episode->LoadNewEpisode(MapPath))
+  {
+    ReleaseMap();
+    State = EState::Failed;
+  }
+}
+
+void FMapLoader::NotifyBeginEpisode(UCarlaEpisode &)
+{
+  if (State == EState::Opening)
+  {
+    ReleaseMap();
+    State = EState::Idle;
+  }
+}
+
+void FMapLoader::OnMapLoaded(const uint32 Request, UPackage *Package, const bool bSucceeded)
+{
+  if (Request != CurrentRequest)
+  {
+    return;
+  }
+  if (!bSucceeded || (Package == nullptr))
+  {
+    UE_LOG(LogCarla, Error, TEXT("Failed to load in the background the map %s"), *MapPath);
+    State = EState::Failed;
+    return;
+  }
+  // The old world is garbage collected when the level opens, the new one
+  // would go with it.
+  Package->AddToRoot();
+  MapPackage = Package;
+}
+
+bool FMapLoader::AreAssetsLoaded() const
+{
+  return !AssetsHandle.IsValid() || AssetsHandle->HasLoadCompleted() || AssetsHandle->WasCanceled();
+}
+
+void FMapLoader::ReleaseMap()
+{
+  if (MapPackage != nullptr)
+  {
+    MapPackage->RemoveFromRoot();
+    MapPackage = nullptr;
+  }
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Util/NonCopyable.h"
+
+#include "Templates/UniquePtr.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/MapLoadProgress.h>
+#include <compiler/enable-ue4-macros.h>
+
+class UCarlaEpisode;
+class UPackage;
+struct FStreamableHandle;
+struct FStreamableManager;
+
+/// Loads the next map in the background with the async loading of the
+/// engine, along with a list of assets to preload, while the current episode
+/// keeps running. Once everything is in memory the level is opened at the
+/// beginning of a frame, the switch then only has to create the new world.
+///
+/// In synchronous mode the loading advances as the client ticks.
+///
+/// @pre To be used from the game-thread.
+class FMapLoader : private NonCopyable
+{
+public:
+
+  ~FMapLoader();
+
+  /// Start loading the map of long package name @a MapPath and the assets
+  /// of @a PreloadAssets, object paths, to replace @a Episode. Replaces the
+  /// load in progress, if any.
+  void Load(UCarlaEpisode &Episode, const FString &MapPath, const TArray<FString> &PreloadAssets);
+
+  carla::rpc::MapLoadProgress GetProgress() const;
+
+  /// Open the level if everything is loaded, called at the beginning of each
+  /// frame.
+  void Tick();
+
+  /// The level opened, the new world holds the map from now on.
+  void NotifyBeginEpisode(UCarlaEpisode &Episode);
+
+private:
+
+  using EState = carla::rpc::MapLoadState;
+
+  void OnMapLoaded(uint32 Request, UPackage *Package, bool bSucceeded);
+
+  bool IsMapLoaded() const
+  {
+    return MapPackage != nullptr;
+  }
+
+  bool AreAssetsLoaded() const;
+
+  /// Let the garbage collector take the map package again.
+  void ReleaseMap();
+
+  EState State = EState::Idle;
+
+  /// Id of the load in progress, the callbacks of the replaced ones are
+  /// ignored.
+  uint32 CurrentRequest = 0u;
+
+  TWeakObjectPtr<UCarlaEpisode> Episode;
+
+  uint64 PreviousEpisodeId = 0u;
+
+  FString MapPath;
+
+  double StartTime = 0.0;
+
+  /// Rooted until the new world holds it.
+  UPackage *MapPackage = nullptr;
+
+  /// Created on the first load, the garbage collector has to be up.
+  TUniquePtr<FStreamableManager> StreamableManager;
+
+  /// Keeps the preloaded assets in memory until the next load, so the
+  /// actors spawned in the new episode find them loaded too.
+  TSharedPtr<FStreamableHandle> AssetsHandle;
+};
@@ -0,0 +1,37 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Game/PhysicsActivationQueue.h"
+
+#include "GameFramework/Actor.h"
+
+void FPhysicsActivationQueue::Defer(AActor &Actor)
+{
+  auto *RootComponent = Cast<UPrimitiveComponent>(Actor.GetRootComponent());
+  if ((RootComponent != nullptr) && RootComponent->IsSimulatingPhysics())
+  {
+    RootComponent->SetSimulatePhysics(false);
+    Pending.Emplace(RootComponent);
+  }
+}
+
+void FPhysicsActivationQueue::Tick()
+{
+  const int32 Count = FMath::Min(Pending.Num(), ActivationsPerFrame);
+  for (int32 i = 0; i < Count; ++i)
+  {
+    UPrimitiveComponent *RootComponent = Pending[i].Get();
+    if ((RootComponent != nullptr) && !RootComponent->IsPendingKill())
+    {
+      RootComponent->SetSimulatePhysics(true);
+    }
+  }
+  if (Count > 0)
+  {
+    Pending.RemoveAt(0, Count, false);
+  }
+}
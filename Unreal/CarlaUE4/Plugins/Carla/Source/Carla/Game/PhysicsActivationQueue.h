@@ -0,0 +1,48 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Util/NonCopyable.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class AActor;
+
+/// Turns on the physics of actors spawned in bulk a few per frame, so the
+/// physics scene does not have to take hundreds of new bodies in the same
+/// frame.
+class FPhysicsActivationQueue : private NonCopyable
+{
+public:
+
+  /// Actors whose physics is turned on each frame.
+  static constexpr int32 ActivationsPerFrame = 64;
+
+  /// Turn off the physics of @a Actor until one of the next ticks. Does
+  /// nothing if its root component is not simulating physics.
+  void Defer(AActor &Actor);
+
+  /// Turn on the physics of the next deferred actors, called at the beginning
+  /// of each world tick.
+  void Tick();
+
+  int32 Num() const
+  {
+    return Pending.Num();
+  }
+
+  void Clear()
+  {
+    Pending.Empty();
+  }
+
+private:
+
+  /// Root components waiting for their physics, oldest first.
+  TArray<TWeakObjectPtr<UPrimitiveComponent>> Pending;
+};
@@ -0,0 +1,300 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Game/RenderNode.h"
+
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Game/FrameCounter.h"
+#include "Carla/Traffic/TrafficLightBase.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/Actor.h>
+#include <carla/rpc/Client.h>
+#include <carla/rpc/EpisodeInfo.h>
+#include <carla/rpc/Response.h>
+#include <carla/rpc/String.h>
+#include <carla/sensor/data/ActorDynamicState.h>
+#include <carla/sensor/data/CompactActorDynamicState.h>
+#include <carla/sensor/s11n/EpisodeStateSerializer.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+#include <carla/streaming/Client.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <cstring>
+
+/// Call @a Function on the primary and return its result, throws on error.
+template <typename T, typename... Args>
+static T FRenderNode_Call(carla::rpc::Client &Client, const std::string &Function, Args &&... InArgs)
+{
+  auto Response = Client.call(Function, std::forward<Args>(InArgs)...).template as<carla::rpc::Response<T>>();
+  if (Response.HasError())
+  {
+    throw std::runtime_error(Response.GetError().What());
+  }
+  return Response.Get();
+}
+
+/// Only these types are spawned, the rest of the actors of the map are
+/// already in the render node and the sensors are its own.
+static bool FRenderNode_IsSpawned(const std::string &TypeId)
+{
+  return (TypeId.rfind("vehicle.", 0u) == 0u) || (TypeId.rfind("walker.", 0u) == 0u);
+}
+
+static void FRenderNode_ApplyState(AActor &Actor, const carla::sensor::data::ActorDynamicState &State)
+{
+  const carla::geom::Transform Transform = State.transform;
+  Actor.SetActorTransform(FTransform(Transform), false, nullptr, ETeleportType::TeleportPhysics);
+  auto TrafficLight = Cast<ATrafficLightBase>(&Actor);
+  if (TrafficLight != nullptr)
+  {
+    const auto &Data = State.state.traffic_light_data;
+    TrafficLight->SetTimeIsFrozen(true);
+    TrafficLight->SetTrafficLightState(static_cast<ETrafficLightState>(Data.state));
+    TrafficLight->SetElapsedTime(Data.elapsed_time);
+  }
+}
+
+FRenderNode::~FRenderNode()
+{
+  Disconnect();
+}
+
+void FRenderNode::Connect(const FString &Host, const uint16 Port)
+{
+  Disconnect();
+  const std::string HostName = carla::rpc::FromFString(Host);
+  try
+  {
+    RpcClient = std::make_unique<carla::rpc::Client>(HostName, Port);
+    RpcClient->set_timeout(10000);
+    const auto Info = FRenderNode_Call<carla::rpc::EpisodeInfo>(*RpcClient, "get_episode_info");
+    StreamingClient = std::make_unique<carla::streaming::Client>(HostName);
+    StreamingClient->AsyncRun(1u);
+    StreamingClient->Subscribe(Info.token, [this](carla::Buffer Message)
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      PendingFrames.emplace_back(std::move(Message));
+    });
+    UE_LOG(LogCarla, Log, TEXT("Render node mirroring the primary server at %s:%d"), *Host, Port);
+  }
+  catch (const std::exception &e)
+  {
+    UE_LOG(LogCarla, Error, TEXT("Render node unable to connect to %s:%d: %s"), *Host, Port, UTF8_TO_TCHAR(e.what()));
+    Disconnect();
+  }
+}
+
+void FRenderNode::Disconnect()
+{
+  // Destroying the streaming client joins its thread, so the callback does
+  // not outlive this.
+  StreamingClient.reset();
+  RpcClient.reset();
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    PendingFrames.clear();
+  }
+  EpisodeId = 0u;
+  Mirrors.Empty();
+  SpawnedMirrors.Empty();
+  Ignored.Empty();
+  FFrameCounter::Reset();
+}
+
+bool FRenderNode::HasPendingFrames() const
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return !PendingFrames.empty();
+}
+
+void FRenderNode::Tick(UCarlaEpisode &Episode)
+{
+  if (!IsConnected())
+  {
+    return;
+  }
+  std::vector<carla::Buffer> Frames;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    std::swap(Frames, PendingFrames);
+  }
+  // The delta frames only hold changes, so every frame is applied in order.
+  for (const auto &Message : Frames)
+  {
+    try
+    {
+      ApplyFrame(Episode, Message);
+    }
+    catch (const std::exception &e)
+    {
+      UE_LOG(LogCarla, Error, TEXT("Render node unable to apply a frame: %s"), UTF8_TO_TCHAR(e.what()));
+    }
+  }
+}
+
+void FRenderNode::ApplyFrame(UCarlaEpisode &Episode, const carla::Buffer &Message)
+{
+  using SensorHeaderSerializer = carla::sensor::s11n::SensorHeaderSerializer;
+  using Serializer = carla::sensor::s11n::EpisodeStateSerializer;
+  using ActorDynamicState = carla::sensor::data::ActorDynamicState;
+  using Compact = carla::sensor::data::CompactActorDynamicState;
+
+  if (Message.size() < SensorHeaderSerializer::header_offset + Serializer::header_offset)
+  {
+    return;
+  }
+  const uint64 Frame = SensorHeaderSerializer::Deserialize(Message).frame;
+  const unsigned char *Begin = Message.data() + SensorHeaderSerializer::header_offset;
+  const unsigned char *End = Message.data() + Message.size();
+  Serializer::Header Header;
+  std::memcpy(&Header, Begin, sizeof(Header));
+  Begin += sizeof(Header);
+
+  if (Header.episode_id != EpisodeId)
+  {
+    // The primary started a new episode, the mirrors are gone with it.
+    TArray<carla::ActorId> Ids;
+    Mirrors.GetKeys(Ids);
+    for (auto Id : Ids)
+    {
+      DestroyMirror(Episode, Id);
+    }
+    Ignored.Empty();
+    EpisodeId = Header.episode_id;
+    if (Header.is_delta)
+    {
+      // Wait for a full frame.
+      return;
+    }
+  }
+
+  for (auto i = 0u; i < Header.number_of_destroyed_actors; ++i)
+  {
+    carla::ActorId Id;
+    std::memcpy(&Id, Begin, sizeof(Id));
+    Begin += sizeof(Id);
+    DestroyMirror(Episode, Id);
+  }
+
+  const size_t StateSize = Header.is_compact ? sizeof(Compact) : sizeof(ActorDynamicState);
+  const size_t Count = static_cast<size_t>(End - Begin) / StateSize;
+  std::vector<ActorDynamicState> States(Count);
+  TSet<carla::ActorId> Received;
+  std::vector<carla::ActorId> Missing;
+  for (size_t i = 0u; i < Count; ++i, Begin += StateSize)
+  {
+    if (Header.is_compact)
+    {
+      Compact State;
+      std::memcpy(&State, Begin, sizeof(State));
+      States[i] = State;
+    }
+    else
+    {
+      std::memcpy(&States[i], Begin, sizeof(ActorDynamicState));
+    }
+    const carla::ActorId Id = States[i].id;
+    Received.Add(Id);
+    if (!Mirrors.Contains(Id) && !Ignored.Contains(Id))
+    {
+      Missing.emplace_back(Id);
+    }
+  }
+
+  if (!Header.is_delta)
+  {
+    // A full frame holds every actor, the rest were destroyed.
+    TArray<carla::ActorId> Ids;
+    Mirrors.GetKeys(Ids);
+    for (auto Id : Ids)
+    {
+      if (!Received.Contains(Id))
+      {
+        DestroyMirror(Episode, Id);
+      }
+    }
+  }
+
+  if (!Missing.empty())
+  {
+    AddMirrors(Episode, Missing);
+  }
+
+  for (const auto &State : States)
+  {
+    const auto *Mirror = Mirrors.Find(State.id);
+    if ((Mirror != nullptr) && Mirror->IsValid())
+    {
+      FRenderNode_ApplyState(*Mirror->Get(), State);
+    }
+  }
+
+  FFrameCounter::SyncTo(Frame);
+}
+
+void FRenderNode::AddMirrors(UCarlaEpisode &Episode, const std::vector<carla::ActorId> &Ids)
+{
+  check(RpcClient != nullptr);
+  const auto Actors = FRenderNode_Call<std::vector<carla::rpc::Actor>>(*RpcClient, "get_actors_by_id", Ids);
+  for (const auto &Actor : Actors)
+  {
+    const auto &TypeId = Actor.description.id;
+    if (FRenderNode_IsSpawned(TypeId))
+    {
+      FActorDescription Description = Actor.description;
+      auto Result = Episode.SpawnActorWithInfo(FTransform::Identity, std::move(Description), Actor.id);
+      if (Result.Key != EActorSpawnResultStatus::Success)
+      {
+        UE_LOG(LogCarla, Warning, TEXT("Render node unable to mirror actor %d (%s)"), Actor.id, *carla::rpc::ToFString(TypeId));
+        Ignored.Add(Actor.id);
+        continue;
+      }
+      AActor *Mirror = Result.Value.GetActor();
+      UCarlaEpisode::SetActorKinematic(*Mirror, true);
+      Mirrors.Add(Actor.id, Mirror);
+      SpawnedMirrors.Add(Actor.id);
+    }
+    else
+    {
+      // The actors of the map, like the traffic lights, have the same id if
+      // registered in the same order.
+      auto View = Episode.FindActor(Actor.id);
+      const bool bIsSameActor =
+          (TypeId.rfind("traffic.", 0u) == 0u) &&
+          View.IsValid() &&
+          (View.GetActorInfo() != nullptr) &&
+          (View.GetActorInfo()->Description.Id == carla::rpc::ToFString(TypeId));
+      if (bIsSameActor)
+      {
+        Mirrors.Add(Actor.id, View.GetActor());
+      }
+      else
+      {
+        Ignored.Add(Actor.id);
+      }
+    }
+  }
+  // The actors destroyed in the primary meanwhile are not listed.
+  for (auto Id : Ids)
+  {
+    if (!Mirrors.Contains(Id))
+    {
+      Ignored.Add(Id);
+    }
+  }
+}
+
+void FRenderNode::DestroyMirror(UCarlaEpisode &Episode, const carla::ActorId Id)
+{
+  TWeakObjectPtr<AActor> Mirror;
+  if (Mirrors.RemoveAndCopyValue(Id, Mirror) && (SpawnedMirrors.Remove(Id) > 0) && Mirror.IsValid())
+  {
+    Episode.DestroyActor(Mirror.Get());
+  }
+  Ignored.Remove(Id);
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Util/NonCopyable.h"
+
+#include "Containers/Map.h"
+#include "Containers/Set.h"
+#include "GameFramework/Actor.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/Buffer.h>
+#include <carla/rpc/ActorId.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class UCarlaEpisode;
+
+namespace carla {
+namespace rpc { class Client; }
+namespace streaming { class Client; }
+} // namespace carla
+
+/// Turns this server into a render node of a primary server running the
+/// same map: the vehicles and walkers of the primary are mirrored here as
+/// kinematic actors, moved every tick to the state received from the episode
+/// stream of the primary, and the traffic lights follow theirs.
+///
+/// Clients connect to the render node to spawn the sensors it renders,
+/// attached to the mirrored actors, which keep the id they have in the
+/// primary whenever it is free here. Every tick of a render node applies one
+/// frame of the primary, and the sensor data is stamped with that frame.
+class FRenderNode : private NonCopyable
+{
+public:
+
+  ~FRenderNode();
+
+  bool IsConnected() const
+  {
+    return RpcClient != nullptr;
+  }
+
+  /// Subscribe to the episode stream of the primary server at @a Host and
+  /// @a Port, its RPC port.
+  void Connect(const FString &Host, uint16 Port);
+
+  /// Stop mirroring, the mirrored actors are left as they are.
+  void Disconnect();
+
+  /// Whether a frame of the primary arrived since the last tick.
+  bool HasPendingFrames() const;
+
+  /// Move the mirrors in @a Episode to the frames received since the last
+  /// tick, called at the beginning of each world tick.
+  void Tick(UCarlaEpisode &Episode);
+
+private:
+
+  /// Apply one frame of the episode stream of the primary.
+  void ApplyFrame(UCarlaEpisode &Episode, const carla::Buffer &Message);
+
+  /// Spawn or find the mirror of each actor in @a Ids, the ones not mirrored
+  /// are ignored from then on.
+  void AddMirrors(UCarlaEpisode &Episode, const std::vector<carla::ActorId> &Ids);
+
+  void DestroyMirror(UCarlaEpisode &Episode, carla::ActorId Id);
+
+  std::unique_ptr<carla::rpc::Client> RpcClient;
+
+  std::unique_ptr<carla::streaming::Client> StreamingClient;
+
+  mutable std::mutex Mutex;
+
+  /// Messages received from the episode stream, waiting for the next tick.
+  std::vector<carla::Buffer> PendingFrames;
+
+  uint64 EpisodeId = 0u;
+
+  /// Mirror of each actor of the primary, by the id it has there.
+  TMap<carla::ActorId, TWeakObjectPtr<AActor>> Mirrors;
+
+  /// Whether each mirror was spawned by the render node, the rest are actors
+  /// of the map like the traffic lights.
+  TSet<carla::ActorId> SpawnedMirrors;
+
+  /// Actors of the primary not mirrored, like its sensors.
+  TSet<carla::ActorId> Ignored;
+};
@@ -7,12 +7,14 @@
 #include "Carla.h"
 #include "Tagger.h"
 
+#include "Async/ParallelFor.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "Engine/SkeletalMesh.h"
 #include "Engine/StaticMesh.h"
 #include "EngineUtils.h"
 #include "PhysicsEngine/PhysicsAsset.h"
+#include "UObject/ObjectKey.h"
 
 template <typename T>
 static auto CastEnum(T label)
@@ -45,6 +47,25 @@ static ECityObjectLabel GetLabelByPath(const T *Object)
   return (StringArray.Num() > 4 ? GetLabelByFolderName(StringArray[4]) : ECityObjectLabel::None);
 }
 
+/// Label of each mesh or physics asset, parsed from its path the first time
+/// it is seen. Only used from the game thread.
+static TMap<FObjectKey, ECityObjectLabel> &GetLabelCache()
+{
+  static TMap<FObjectKey, ECityObjectLabel> Cache;
+  return Cache;
+}
+
+static ECityObjectLabel GetCachedLabel(const UObject *Object)
+{
+  if (Object == nullptr) {
+    return ECityObjectLabel::None;
+  }
+  auto &Cache = GetLabelCache();
+  const FObjectKey Key(Object);
+  const auto *Label = Cache.Find(Key);
+  return Label != nullptr ? *Label : Cache.Add(Key, GetLabelByPath(Object));
+}
+
 static void SetStencilValue(
     UPrimitiveComponent &Component,
     const ECityObjectLabel &Label,
@@ -69,7 +90,7 @@ void ATagger::TagActor(const AActor &Actor, bool bTagForSemanticSegmentation)
   TArray<UStaticMeshComponent *> StaticMeshComponents;
   Actor.GetComponents<UStaticMeshComponent>(StaticMeshComponents);
   for (UStaticMeshComponent *Component : StaticMeshComponents) {
-    const auto Label = GetLabelByPath(Component->GetStaticMesh());
+    const auto Label = GetCachedLabel(Component->GetStaticMesh());
     SetStencilValue(*Component, Label, bTagForSemanticSegmentation);
 #ifdef CARLA_TAGGER_EXTRA_LOG
     UE_LOG(LogCarla, Log, TEXT("  + StaticMeshComponent: %s"), *Component->GetName());
@@ -81,7 +102,7 @@ void ATagger::TagActor(const AActor &Actor, bool bTagForSemanticSegmentation)
   TArray<USkeletalMeshComponent *> SkeletalMeshComponents;
   Actor.GetComponents<USkeletalMeshComponent>(SkeletalMeshComponents);
   for (USkeletalMeshComponent *Component : SkeletalMeshComponents) {
-    const auto Label = GetLabelByPath(Component->GetPhysicsAsset());
+    const auto Label = GetCachedLabel(Component->GetPhysicsAsset());
     SetStencilValue(*Component, Label, bTagForSemanticSegmentation);
 #ifdef CARLA_TAGGER_EXTRA_LOG
     UE_LOG(LogCarla, Log, TEXT("  + SkeletalMeshComponent: %s"), *Component->GetName());
@@ -92,8 +113,54 @@ void ATagger::TagActor(const AActor &Actor, bool bTagForSemanticSegmentation)
 
 void ATagger::TagActorsInLevel(UWorld &World, bool bTagForSemanticSegmentation)
 {
+  struct FComponentToTag
+  {
+    UPrimitiveComponent *Component;
+    const UObject *Asset;
+  };
+
+  // Gather the components and the assets not labelled yet.
+  const auto &Cache = GetLabelCache();
+  TArray<FComponentToTag> Components;
+  TArray<const UObject *> NewAssets;
+  TSet<FObjectKey> SeenAssets;
+  auto AddComponent = [&](UPrimitiveComponent *Component, const UObject *Asset) {
+    Components.Add(FComponentToTag{Component, Asset});
+    if ((Asset != nullptr) && !Cache.Contains(FObjectKey(Asset))) {
+      bool bIsAlreadySeen = false;
+      SeenAssets.Add(FObjectKey(Asset), &bIsAlreadySeen);
+      if (!bIsAlreadySeen) {
+        NewAssets.Add(Asset);
+      }
+    }
+  };
   for (TActorIterator<AActor> it(&World); it; ++it) {
-    TagActor(**it, bTagForSemanticSegmentation);
+    TArray<UStaticMeshComponent *> StaticMeshComponents;
+    it->GetComponents<UStaticMeshComponent>(StaticMeshComponents);
+    for (UStaticMeshComponent *Component : StaticMeshComponents) {
+      AddComponent(Component, Component->GetStaticMesh());
+    }
+    TArray<USkeletalMeshComponent *> SkeletalMeshComponents;
+    it->GetComponents<USkeletalMeshComponent>(SkeletalMeshComponents);
+    for (USkeletalMeshComponent *Component : SkeletalMeshComponents) {
+      AddComponent(Component, Component->GetPhysicsAsset());
+    }
+  }
+
+  // Parsing the paths is the slow part, only read-only access to the assets,
+  // so it runs in parallel.
+  TArray<ECityObjectLabel> NewLabels;
+  NewLabels.SetNumUninitialized(NewAssets.Num());
+  ParallelFor(NewAssets.Num(), [&](int32 Index) {
+    NewLabels[Index] = GetLabelByPath(NewAssets[Index]);
+  });
+  for (int32 Index = 0; Index < NewAssets.Num(); ++Index) {
+    GetLabelCache().Add(FObjectKey(NewAssets[Index]), NewLabels[Index]);
+  }
+
+  // Changing the render state has to happen on the game thread.
+  for (const auto &Item : Components) {
+    SetStencilValue(*Item.Component, GetCachedLabel(Item.Asset), bTagForSemanticSegmentation);
   }
 }
 
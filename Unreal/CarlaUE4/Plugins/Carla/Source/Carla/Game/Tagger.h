@@ -47,7 +47,9 @@ public:
   /// objects having this value active.
   static void TagActor(const AActor &Actor, bool bTagForSemanticSegmentation);
 
-  /// Set the tag of every actor in level.
+  /// Set the tag of every actor in level. The labels of the meshes are
+  /// computed in parallel and cached, actors spawned later are tagged one by
+  /// one with TagActor.
   ///
   /// If bTagForSemanticSegmentation true, activate the custom depth pass. This
   /// pass is necessary for rendering the semantic segmentation. However, it may
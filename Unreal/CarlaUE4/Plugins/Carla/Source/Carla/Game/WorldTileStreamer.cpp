@@ -0,0 +1,143 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Game/WorldTileStreamer.h"
+
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Vehicle/VehiclePhysicsLOD.h"
+
+#include "Engine/LevelStreaming.h"
+#include "Misc/PackageName.h"
+
+/// Parse the "_Tile_<X>_<Y>" suffix of @a LevelName.
+static bool FWorldTileStreamer_ParseTileIndex(const FString &LevelName, FIntPoint &Index)
+{
+  static const FString Tag = TEXT("_Tile_");
+  const int32 Position = LevelName.Find(Tag, ESearchCase::IgnoreCase, ESearchDir::FromEnd);
+  if (Position == INDEX_NONE)
+  {
+    return false;
+  }
+  FString X, Y;
+  if (!LevelName.Mid(Position + Tag.Len()).Split(TEXT("_"), &X, &Y) ||
+      !X.IsNumeric() || !Y.IsNumeric())
+  {
+    return false;
+  }
+  Index.X = FCString::Atoi(*X);
+  Index.Y = FCString::Atoi(*Y);
+  return true;
+}
+
+static void FWorldTileStreamer_SetLoaded(ULevelStreaming &Level, const bool bLoaded)
+{
+  if (Level.ShouldBeLoaded() != bLoaded)
+  {
+    Level.SetShouldBeLoaded(bLoaded);
+    Level.SetShouldBeVisible(bLoaded);
+  }
+}
+
+FIntPoint FWorldTileStreamer::GetTileIndex(const FVector &Location)
+{
+  return {
+    FMath::FloorToInt(Location.X / TileSize),
+    FMath::FloorToInt(Location.Y / TileSize)};
+}
+
+void FWorldTileStreamer::CollectTiles(const UCarlaEpisode &Episode)
+{
+  bTilesCollected = true;
+  const UWorld *World = Episode.GetWorld();
+  if (World == nullptr)
+  {
+    return;
+  }
+  for (ULevelStreaming *Level : World->GetStreamingLevels())
+  {
+    FIntPoint Index;
+    if ((Level != nullptr) && FWorldTileStreamer_ParseTileIndex(
+            FPackageName::GetShortName(Level->GetWorldAssetPackageFName()),
+            Index))
+    {
+      Tiles.Add(Index, Level);
+    }
+  }
+  UE_LOG(LogCarla, Log, TEXT("Found %d world tiles"), Tiles.Num());
+}
+
+void FWorldTileStreamer::Tick(const UCarlaEpisode &Episode)
+{
+  // Tiles are unloaded a bit farther than they are loaded, so the ones right
+  // at the distance do not stream every tick.
+  constexpr float HYSTERESIS = 1.1f;
+  constexpr float TO_CENTIMETERS = 1e2f;
+
+  if (!bTilesCollected)
+  {
+    CollectTiles(Episode);
+  }
+  if (Tiles.Num() == 0)
+  {
+    return;
+  }
+
+  const float Distance = TO_CENTIMETERS * Episode.GetSettings().TileStreamingDistance;
+  TArray<FVector2D> Heroes;
+  if (Distance > 0.0f)
+  {
+    for (auto &&View : Episode.GetActorRegistry())
+    {
+      if ((View.GetActorType() == FActorView::ActorType::Vehicle) && View.IsValid() && FVehiclePhysicsLOD::IsHero(View))
+      {
+        Heroes.Emplace(View.GetActor()->GetActorLocation());
+      }
+    }
+  }
+
+  const float NearSquared = FMath::Square(Distance);
+  const float FarSquared = FMath::Square(HYSTERESIS * Distance);
+  for (auto &Tile : Tiles)
+  {
+    ULevelStreaming *Level = Tile.Value.Get();
+    if (Level == nullptr)
+    {
+      continue;
+    }
+    if (Heroes.Num() == 0)
+    {
+      FWorldTileStreamer_SetLoaded(*Level, true);
+      continue;
+    }
+    const FBox2D Bounds(
+        TileSize * FVector2D(Tile.Key.X, Tile.Key.Y),
+        TileSize * FVector2D(Tile.Key.X + 1, Tile.Key.Y + 1));
+    float ClosestSquared = TNumericLimits<float>::Max();
+    for (const auto &Hero : Heroes)
+    {
+      ClosestSquared = FMath::Min(ClosestSquared, Bounds.ComputeSquaredDistanceToPoint(Hero));
+    }
+    if (ClosestSquared <= NearSquared)
+    {
+      FWorldTileStreamer_SetLoaded(*Level, true);
+    }
+    else if (ClosestSquared > FarSquared)
+    {
+      FWorldTileStreamer_SetLoaded(*Level, false);
+    }
+  }
+}
+
+bool FWorldTileStreamer::IsLocationLoaded(const FVector &Location) const
+{
+  const auto *Tile = Tiles.Find(GetTileIndex(Location));
+  if ((Tile == nullptr) || !Tile->IsValid())
+  {
+    return true;
+  }
+  return (*Tile)->IsLevelLoaded() && (*Tile)->IsLevelVisible();
+}
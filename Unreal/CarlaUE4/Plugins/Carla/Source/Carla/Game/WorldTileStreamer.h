@@ -0,0 +1,57 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Util/NonCopyable.h"
+
+#include "Containers/Map.h"
+#include "Math/IntPoint.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class UCarlaEpisode;
+class ULevelStreaming;
+
+/// Streams the tiles of a large map around the hero vehicles, the ones with
+/// role_name "hero".
+///
+/// The tiles are the streaming sublevels of the map whose package name ends
+/// with "_Tile_<X>_<Y>", each one covering the square of side TileSize whose
+/// lower corner is (X * TileSize, Y * TileSize). The tiles closer than
+/// FEpisodeSettings::TileStreamingDistance to a hero are loaded, the rest
+/// unloaded. The OpenDRIVE road network is not tiled, the routes and
+/// waypoints stay available all over the map.
+class FWorldTileStreamer : private NonCopyable
+{
+public:
+
+  /// Side of the tiles in centimeters.
+  static constexpr float TileSize = 20000.0f;
+
+  /// Load and unload the tiles of the world of @a Episode.
+  void Tick(const UCarlaEpisode &Episode);
+
+  /// Whether the world has tiles.
+  bool HasTiles() const
+  {
+    return Tiles.Num() > 0;
+  }
+
+  /// Whether the tile under @a Location is loaded and visible. Locations
+  /// outside every tile are always loaded.
+  bool IsLocationLoaded(const FVector &Location) const;
+
+private:
+
+  void CollectTiles(const UCarlaEpisode &Episode);
+
+  static FIntPoint GetTileIndex(const FVector &Location);
+
+  /// Sublevel of each tile.
+  TMap<FIntPoint, TWeakObjectPtr<ULevelStreaming>> Tiles;
+
+  bool bTilesCollected = false;
+};
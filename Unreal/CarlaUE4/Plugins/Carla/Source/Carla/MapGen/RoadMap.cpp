@@ -11,6 +11,8 @@
 
 #include "FileHelper.h"
 #include "HighResScreenshot.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 
 #if WITH_EDITOR
 #include "DrawDebugHelpers.h"
@@ -248,6 +250,50 @@ FRoadMapIntersectionResult URoadMap::Intersect(
   return Result;
 }
 
+static constexpr uint32 RoadMapPixelDataMagic = 0x504d4452u; // "RDMP"
+
+bool URoadMap::SavePixelData(const FString &Path, const uint32 Key) const
+{
+  if (!IsValid()) {
+    UE_LOG(LogCarla, Error, TEXT("Cannot save invalid road map to disk"));
+    return false;
+  }
+  TArray<uint8> Data;
+  FMemoryWriter Writer(Data);
+  uint32 Magic = RoadMapPixelDataMagic;
+  uint32 CacheKey = Key;
+  uint32 CacheWidth = Width;
+  uint32 CacheHeight = Height;
+  Writer << Magic << CacheKey << CacheWidth << CacheHeight;
+  Writer << const_cast<TArray<uint16> &>(RoadMapData);
+  return FFileHelper::SaveArrayToFile(Data, *Path);
+}
+
+bool URoadMap::LoadPixelData(const FString &Path, const uint32 Key)
+{
+  TArray<uint8> Data;
+  if (!FFileHelper::LoadFileToArray(Data, *Path, FILEREAD_Silent)) {
+    return false;
+  }
+  FMemoryReader Reader(Data);
+  uint32 Magic = 0u, CacheKey = 0u, CacheWidth = 0u, CacheHeight = 0u;
+  Reader << Magic << CacheKey << CacheWidth << CacheHeight;
+  if (Reader.IsError() ||
+      (Magic != RoadMapPixelDataMagic) ||
+      (CacheKey != Key) ||
+      (CacheWidth != Width) ||
+      (CacheHeight != Height)) {
+    return false;
+  }
+  TArray<uint16> PixelData;
+  Reader << PixelData;
+  if (Reader.IsError() || (PixelData.Num() != RoadMapData.Num())) {
+    return false;
+  }
+  RoadMapData = std::move(PixelData);
+  return true;
+}
+
 bool URoadMap::SaveAsPNG(const FString &Folder, const FString &MapName) const
 {
   if (!IsValid()) {
@@ -146,6 +146,15 @@ public:
   /// Save the current map as PNG with the pixel data encoded as color.
   bool SaveAsPNG(const FString &Folder, const FString &MapName) const;
 
+  /// Save the pixel data to the binary file @a Path, tagged with @a Key to
+  /// identify the layout it was computed from.
+  bool SavePixelData(const FString &Path, uint32 Key) const;
+
+  /// Load the pixel data saved by SavePixelData. Fails, leaving the map
+  /// untouched, if the file does not exist or was saved with a different @a Key
+  /// or size.
+  bool LoadPixelData(const FString &Path, uint32 Key);
+
 #if WITH_EDITOR
 
   /// Log status of the map to the console.
@@ -9,9 +9,16 @@
 
 #include "Carla/OpenDrive/OpenDrive.h"
 
+#include "Async/ParallelFor.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
 #include <compiler/disable-ue4-macros.h>
 #include <carla/geom/Math.h>
 #include <carla/opendrive/OpenDriveParser.h>
+#include <carla/road/Map.h>
 #include <carla/road/element/Waypoint.h>
 #include <carla/rpc/String.h>
 #include <compiler/enable-ue4-macros.h>
@@ -130,31 +137,96 @@ void AOpenDriveActor::BuildRoutes()
   BuildRoutes(GetWorld()->GetMapName());
 }
 
-void AOpenDriveActor::BuildRoutes(FString MapName)
+/// Geometry of a route planner and its routes, computed off the game thread.
+struct FOpenDriveRoutePlanner
 {
-  using Waypoint = carla::road::element::Waypoint;
+  FVector Location = FVector::ZeroVector;
 
-  // As the OpenDrive file has the same name as level, build the path to the
-  // xodr file using the lavel name and the game content directory.
-  const FString XodrContent = UOpenDrive::LoadXODR(MapName);
+  FRotator Rotation = FRotator::ZeroRotator;
 
-  auto map = carla::opendrive::OpenDriveParser::Load(carla::rpc::FromFString(XodrContent));
+  bool bIsIntersection = false;
 
-  if (!map.has_value())
+  TArray<TArray<FVector>> Routes;
+
+  friend FArchive &operator<<(FArchive &Ar, FOpenDriveRoutePlanner &Planner)
   {
-    UE_LOG(LogCarla, Error, TEXT("Failed to parse OpenDrive file."));
-    return;
+    return Ar << Planner.Location << Planner.Rotation << Planner.bIsIntersection << Planner.Routes;
   }
+};
+
+/// Routes of a map saved in "Saved/OpenDrive/<map>.routes" so later loads of
+/// the same map skip the computation. The cache is discarded when the XODR
+/// file or the generation parameters change.
+class FOpenDriveRouteCache
+{
+public:
+
+  FOpenDriveRouteCache(const FString &MapName, const FString &XodrContent, float RoadAccuracy, float TriggersHeight)
+    : Filename(FPaths::ProjectSavedDir() / TEXT("OpenDrive") / (MapName + TEXT(".routes"))),
+      XodrCrc(FCrc::StrCrc32(*XodrContent)),
+      RoadAccuracy(RoadAccuracy),
+      TriggersHeight(TriggersHeight) {}
+
+  bool Load(TArray<FOpenDriveRoutePlanner> &Planners) const
+  {
+    TArray<uint8> Data;
+    if (!FFileHelper::LoadFileToArray(Data, *Filename, FILEREAD_Silent))
+    {
+      return false;
+    }
+    FMemoryReader Reader(Data);
+    uint32 Magic = 0u, Crc = 0u;
+    float Accuracy = 0.0f, Height = 0.0f;
+    Reader << Magic << Crc << Accuracy << Height;
+    if (Reader.IsError() || (Magic != CacheMagic) || (Crc != XodrCrc) ||
+        (Accuracy != RoadAccuracy) || (Height != TriggersHeight))
+    {
+      return false;
+    }
+    Reader << Planners;
+    return !Reader.IsError();
+  }
+
+  /// Failures are ignored, the routes are computed again on the next load.
+  void Save(TArray<FOpenDriveRoutePlanner> &Planners) const
+  {
+    TArray<uint8> Data;
+    FMemoryWriter Writer(Data);
+    uint32 Magic = CacheMagic, Crc = XodrCrc;
+    float Accuracy = RoadAccuracy, Height = TriggersHeight;
+    Writer << Magic << Crc << Accuracy << Height << Planners;
+    FFileHelper::SaveArrayToFile(Data, *Filename);
+  }
+
+private:
+
+  static constexpr uint32 CacheMagic = 0x52444f32u; // "2ODR"
+
+  const FString Filename;
+
+  const uint32 XodrCrc;
+
+  const float RoadAccuracy;
+
+  const float TriggersHeight;
+};
+
+static TArray<FOpenDriveRoutePlanner> ComputeRoutePlanners(
+    const carla::road::Map &map,
+    const float RoadAccuracy,
+    const float TriggersHeight)
+{
+  using Waypoint = carla::road::element::Waypoint;
 
   // List with waypoints, each one at the end of each lane of the map
   const std::vector<Waypoint> LaneWaypoints =
-      map->GenerateWaypointsOnRoadEntries();
+      map.GenerateWaypointsOnRoadEntries();
 
   std::unordered_map<Waypoint, std::vector<Waypoint>> PredecessorMap;
 
   for (auto &Wp : LaneWaypoints)
   {
-    const auto PredecessorsList = map->GetPredecessors(Wp);
+    const auto PredecessorsList = map.GetPredecessors(Wp);
     if (PredecessorsList.empty())
     {
       continue;
@@ -168,11 +240,22 @@ void AOpenDriveActor::BuildRoutes(FString MapName)
     PredecessorMap[MinRoadId].emplace_back(Wp);
   }
 
+  std::vector<const std::vector<Waypoint> *> Entries;
+  Entries.reserve(PredecessorMap.size());
   for (auto &&PredecessorWp : PredecessorMap)
   {
-    ARoutePlanner *RoutePlanner = nullptr;
+    Entries.emplace_back(&PredecessorWp.second);
+  }
+
+  // The map is only read, each task samples the lanes of a route planner.
+  TArray<FOpenDriveRoutePlanner> Planners;
+  Planners.SetNum(static_cast<int32>(Entries.size()));
+  ParallelFor(Planners.Num(), [&](int32 Index)
+  {
+    FOpenDriveRoutePlanner &Planner = Planners[Index];
+    bool bHasTransform = false;
 
-    for (auto &&Wp : PredecessorWp.second)
+    for (auto &&Wp : *Entries[Index])
     {
       std::vector<Waypoint> Waypoints;
       auto CurrentWp = Wp;
@@ -180,7 +263,7 @@ void AOpenDriveActor::BuildRoutes(FString MapName)
       do
       {
         Waypoints.emplace_back(CurrentWp);
-        const auto Successors = map->GetNext(CurrentWp, RoadAccuracy);
+        const auto Successors = map.GetNext(CurrentWp, RoadAccuracy);
         if (Successors.empty())
         {
           break;
@@ -193,7 +276,7 @@ void AOpenDriveActor::BuildRoutes(FString MapName)
       } while (CurrentWp.road_id == Wp.road_id);
 
       // connect the last wp of the current road to the first wp of the following road
-      const auto FollowingWp = map->GetSuccessors(CurrentWp);
+      const auto FollowingWp = map.GetSuccessors(CurrentWp);
       if (!FollowingWp.empty())
       {
         Waypoints.emplace_back(FollowingWp.front());
@@ -207,29 +290,71 @@ void AOpenDriveActor::BuildRoutes(FString MapName)
         {
           // Add the trigger height because the z position of the points does not
           // influence on the driver AI and is easy to visualize in the editor
-          Positions.Add(map->ComputeTransform(Waypoints[i]).location +
+          Positions.Add(map.ComputeTransform(Waypoints[i]).location +
               FVector(0.f, 0.f, TriggersHeight));
         }
 
-        // If the route planner does not exist, create it
-        if (RoutePlanner == nullptr )
+        // The route planner is placed at the first route
+        if (!bHasTransform)
         {
-          const auto WpTransform = map->ComputeTransform(Wp);
-          RoutePlanner = GetWorld()->SpawnActor<ARoutePlanner>();
-          RoutePlanner->bIsIntersection = map->IsJunction(Wp.road_id);
-          RoutePlanner->SetBoxExtent(FVector(70.f, 70.f, 50.f));
-          RoutePlanner->SetActorRotation(WpTransform.rotation);
-          RoutePlanner->SetActorLocation(WpTransform.location +
-              FVector(0.f, 0.f, TriggersHeight));
+          bHasTransform = true;
+          const auto WpTransform = map.ComputeTransform(Wp);
+          Planner.bIsIntersection = map.IsJunction(Wp.road_id);
+          Planner.Rotation = WpTransform.rotation;
+          Planner.Location = WpTransform.location + FVector(0.f, 0.f, TriggersHeight);
         }
 
-        if (RoutePlanner != nullptr)
-        {
-          RoutePlanner->AddRoute(1.f, Positions);
-          RoutePlanners.Add(RoutePlanner);
-        }
+        Planner.Routes.Emplace(std::move(Positions));
       }
     }
+  });
+
+  Planners.RemoveAll([](const FOpenDriveRoutePlanner &Planner) {
+    return Planner.Routes.Num() == 0;
+  });
+  return Planners;
+}
+
+void AOpenDriveActor::BuildRoutes(FString MapName)
+{
+  // As the OpenDrive file has the same name as level, build the path to the
+  // xodr file using the lavel name and the game content directory.
+  const FString XodrContent = UOpenDrive::LoadXODR(MapName);
+
+  const FOpenDriveRouteCache Cache(MapName, XodrContent, RoadAccuracy, TriggersHeight);
+  TArray<FOpenDriveRoutePlanner> Planners;
+  if (!Cache.Load(Planners))
+  {
+    auto map = carla::opendrive::OpenDriveParser::Load(carla::rpc::FromFString(XodrContent));
+
+    if (!map.has_value())
+    {
+      UE_LOG(LogCarla, Error, TEXT("Failed to parse OpenDrive file."));
+      return;
+    }
+
+    Planners = ComputeRoutePlanners(*map, RoadAccuracy, TriggersHeight);
+    Cache.Save(Planners);
+  }
+
+  // Only the actors are spawned on the game thread.
+  for (auto &Planner : Planners)
+  {
+    ARoutePlanner *RoutePlanner = GetWorld()->SpawnActor<ARoutePlanner>();
+    if (RoutePlanner == nullptr)
+    {
+      continue;
+    }
+    RoutePlanner->bIsIntersection = Planner.bIsIntersection;
+    RoutePlanner->SetBoxExtent(FVector(70.f, 70.f, 50.f));
+    RoutePlanner->SetActorRotation(Planner.Rotation);
+    RoutePlanner->SetActorLocation(Planner.Location);
+
+    for (auto &Positions : Planner.Routes)
+    {
+      RoutePlanner->AddRoute(1.f, Positions);
+      RoutePlanners.Add(RoutePlanner);
+    }
   }
 }
 
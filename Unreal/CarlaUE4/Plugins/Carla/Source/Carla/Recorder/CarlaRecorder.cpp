@@ -15,6 +15,9 @@
 #include <ctime>
 #include <sstream>
 
+// size of the chunks sent to the writer thread
+static constexpr size_t RecorderChunkSize = 1024u * 1024u;
+
 ACarlaRecorder::ACarlaRecorder(void)
 {
   PrimaryActorTick.TickGroup = TG_PrePhysics;
@@ -43,6 +46,31 @@ std::string ACarlaRecorder::ShowFileActorsBlocked(std::string Name, double MinTi
   return Query.QueryBlocked(Name, MinTime, MinDistance);
 }
 
+bool ACarlaRecorder::QueryFileInfo(std::string Name, carla::rpc::RecorderFileInfo &Result, std::string &Error)
+{
+  return Query.QueryInfo(Name, Result, Error);
+}
+
+bool ACarlaRecorder::QueryFileCollisions(
+    std::string Name,
+    char Type1,
+    char Type2,
+    carla::rpc::RecorderCollisions &Result,
+    std::string &Error)
+{
+  return Query.QueryCollisions(Name, Type1, Type2, Result, Error);
+}
+
+bool ACarlaRecorder::QueryFileActorsBlocked(
+    std::string Name,
+    double MinTime,
+    double MinDistance,
+    carla::rpc::RecorderBlockedActors &Result,
+    std::string &Error)
+{
+  return Query.QueryBlocked(Name, MinTime, MinDistance, Result, Error);
+}
+
 std::string ACarlaRecorder::ReplayFile(std::string Name, double TimeStart, double Duration, uint32_t FollowId)
 {
   Stop();
@@ -54,6 +82,21 @@ inline void ACarlaRecorder::SetReplayerTimeFactor(double TimeFactor)
   Replayer.SetTimeFactor(TimeFactor);
 }
 
+inline void ACarlaRecorder::SetReplayerInterpolation(bool bEnabled)
+{
+  Replayer.SetInterpolation(bEnabled);
+}
+
+inline void ACarlaRecorder::SetReplayerFrameByFrame(bool bEnabled)
+{
+  Replayer.SetFrameByFrame(bEnabled);
+}
+
+inline uint32_t ACarlaRecorder::GetReplayedActorId(uint32_t RecordedId) const
+{
+  return Replayer.GetReplayedActorId(RecordedId);
+}
+
 void ACarlaRecorder::Tick(float DeltaSeconds)
 {
   Super::Tick(DeltaSeconds);
@@ -65,12 +108,17 @@ void ACarlaRecorder::Tick(float DeltaSeconds)
   if (Enabled)
   {
     const FActorRegistry &Registry = Episode->GetActorRegistry();
+    const uint64_t FrameId = Frames.GetId() + 1u;
 
     // through all actors in registry
     for (auto It = Registry.begin(); It != Registry.end(); ++It)
     {
       FActorView View = *It;
 
+      // skip the actors not sampled in this frame
+      if (!Filter.IsDue(View, FrameId))
+        continue;
+
       switch (View.GetActorType())
       {
         // save the transform of all vehicles
@@ -212,15 +260,19 @@ std::string ACarlaRecorder::Start(std::string Name, FString MapName)
   // reset collisions Id
   NextCollisionId = 0;
 
+  // first key frame in the first frame
+  NextKeyFrameTime = 0.0;
+
   // get the final path + filename
   std::string Filename = GetRecorderFilename(Name);
 
   // binary file
-  File.open(Filename, std::ios::binary);
-  if (!File.is_open())
+  if (!Writer.Open(Filename, bCompressFile))
   {
     return "";
   }
+  Buffer.Reset();
+  File.clear();
 
   // save info
   Info.Version = 1;
@@ -232,6 +284,8 @@ std::string ACarlaRecorder::Start(std::string Name, FString MapName)
   Info.Write(File);
 
   Frames.Reset();
+  FrameIndex.Clear();
+  Filter.Reset();
 
   Enable();
 
@@ -245,9 +299,20 @@ void ACarlaRecorder::Stop(void)
 {
   Disable();
 
-  if (File)
+  if (Writer.IsOpen())
   {
-    File.close();
+    // write the frame index as the last packet
+    FrameIndex.Write(File);
+    FrameIndex.Clear();
+
+    // write the rest of the data and wait for the writer
+    Buffer.Split(Chunk);
+    Writer.Write(Chunk);
+    Writer.Close();
+    Buffer.Reset();
+    UE_LOG(LogCarla, Log, TEXT("Recorder: %llu bytes written, waited %llu times for the disk"),
+        static_cast<uint64>(Writer.GetBytesWritten()),
+        static_cast<uint64>(Writer.GetNumberOfWaits()));
   }
 
   Clear();
@@ -263,6 +328,7 @@ void ACarlaRecorder::Clear(void)
   States.Clear();
   Vehicles.Clear();
   Walkers.Clear();
+  KeyFrame.Clear();
 }
 
 void ACarlaRecorder::Write(double DeltaSeconds)
@@ -270,9 +336,45 @@ void ACarlaRecorder::Write(double DeltaSeconds)
   // update this frame data
   Frames.SetFrame(DeltaSeconds);
 
+  // check if this frame needs a key frame
+  bool bKeyFrame = false;
+  if (KeyFrameInterval > 0.0 && Frames.GetElapsed() >= NextKeyFrameTime)
+  {
+    bKeyFrame = true;
+    NextKeyFrameTime = Frames.GetElapsed() + KeyFrameInterval;
+  }
+
+  // add the frame to the index
+  uint8_t Flags = 0u;
+  if (!EventsAdd.IsEmpty() || !EventsDel.IsEmpty() || !EventsParent.IsEmpty())
+  {
+    Flags |= CarlaRecorderFrameIndexEntry::FlagEvents;
+  }
+  if (bKeyFrame)
+  {
+    Flags |= CarlaRecorderFrameIndexEntry::FlagKeyFrame;
+  }
+  std::streampos FrameOffset = File.tellp();
+  FrameIndex.Add(FrameOffset, Frames.GetElapsed(), Flags);
+
   // start
   Frames.WriteStart(File);
 
+  // the previous frames are complete now (the frame start updates the
+  // duration of the previous one), send them to the writer
+  if (Buffer.GetSize() >= RecorderChunkSize)
+  {
+    Buffer.Split(static_cast<uint64_t>(FrameOffset), Chunk);
+    Writer.Write(Chunk);
+  }
+
+  // key frame
+  if (bKeyFrame)
+  {
+    AddKeyFrameActors();
+    KeyFrame.Write(File);
+  }
+
   // events
   EventsAdd.Write(File);
   EventsDel.Write(File);
@@ -401,11 +503,50 @@ void ACarlaRecorder::AddExistingActors(void)
   }
 }
 
+void ACarlaRecorder::AddKeyFrameActors(void)
+{
+  const FActorRegistry &Registry = Episode->GetActorRegistry();
+  for (auto &&View : Registry)
+  {
+    const AActor *Actor = View.GetActor();
+    if (Actor == nullptr)
+    {
+      continue;
+    }
+
+    KeyFrame.AddActor(MakeRecorderEventAdd(
+        View.GetActorId(),
+        static_cast<uint8_t>(View.GetActorType()),
+        Actor->GetActorTransform(),
+        View.GetActorInfo()->Description));
+
+    // parent
+    AActor *Parent = Actor->GetAttachParentActor();
+    if (Parent != nullptr)
+    {
+      FActorView ParentView = Registry.Find(Parent);
+      if (ParentView.IsValid())
+      {
+        KeyFrame.AddParent(CarlaRecorderEventParent{View.GetActorId(), ParentView.GetActorId()});
+      }
+    }
+  }
+}
+
 void ACarlaRecorder::CreateRecorderEventAdd(
     uint32_t DatabaseId,
     uint8_t Type,
     const FTransform &Transform,
     FActorDescription ActorDescription)
+{
+  AddEvent(MakeRecorderEventAdd(DatabaseId, Type, Transform, ActorDescription));
+}
+
+CarlaRecorderEventAdd ACarlaRecorder::MakeRecorderEventAdd(
+    uint32_t DatabaseId,
+    uint8_t Type,
+    const FTransform &Transform,
+    const FActorDescription &ActorDescription) const
 {
   CarlaRecorderActorDescription Description;
   Description.UId = ActorDescription.UId;
@@ -427,7 +568,7 @@ void ACarlaRecorder::CreateRecorderEventAdd(
   }
 
   // recorder event
-  CarlaRecorderEventAdd RecEvent
+  return CarlaRecorderEventAdd
   {
     DatabaseId,
     Type,
@@ -435,5 +576,4 @@ void ACarlaRecorder::CreateRecorderEventAdd(
     Transform.GetRotation().Euler(),
     std::move(Description)
   };
-  AddEvent(std::move(RecEvent));
 }
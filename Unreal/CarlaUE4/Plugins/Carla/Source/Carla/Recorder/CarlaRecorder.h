@@ -17,11 +17,15 @@
 #include "CarlaRecorderEventAdd.h"
 #include "CarlaRecorderEventDel.h"
 #include "CarlaRecorderEventParent.h"
+#include "CarlaRecorderFilter.h"
+#include "CarlaRecorderFrameIndex.h"
 #include "CarlaRecorderFrames.h"
 #include "CarlaRecorderInfo.h"
+#include "CarlaRecorderKeyFrame.h"
 #include "CarlaRecorderPosition.h"
 #include "CarlaRecorderQuery.h"
 #include "CarlaRecorderState.h"
+#include "CarlaRecorderWriter.h"
 #include "CarlaReplayer.h"
 
 #include "CarlaRecorder.generated.h"
@@ -40,7 +44,9 @@ enum class CarlaRecorderPacketId : uint8_t
   Position,
   State,
   AnimVehicle,
-  AnimWalker
+  AnimWalker,
+  FrameIndex,
+  KeyFrame
 };
 
 /// Recorder for the simulation
@@ -112,8 +118,48 @@ public:
   std::string ShowFileInfo(std::string Name, bool bShowAll = false);
   std::string ShowFileCollisions(std::string Name, char Type1, char Type2);
   std::string ShowFileActorsBlocked(std::string Name, double MinTime = 30, double MinDistance = 10);
+  bool QueryFileInfo(std::string Name, carla::rpc::RecorderFileInfo &Result, std::string &Error);
+  bool QueryFileCollisions(
+      std::string Name,
+      char Type1,
+      char Type2,
+      carla::rpc::RecorderCollisions &Result,
+      std::string &Error);
+  bool QueryFileActorsBlocked(
+      std::string Name,
+      double MinTime,
+      double MinDistance,
+      carla::rpc::RecorderBlockedActors &Result,
+      std::string &Error);
   std::string ReplayFile(std::string Name, double TimeStart, double Duration, uint32_t FollowId);
   void SetReplayerTimeFactor(double TimeFactor);
+  void SetReplayerInterpolation(bool bEnabled);
+  void SetReplayerFrameByFrame(bool bEnabled);
+  uint32_t GetReplayedActorId(uint32_t RecordedId) const;
+
+  // seconds between key frames, zero to disable them
+  void SetKeyFrameInterval(double Seconds)
+  {
+    KeyFrameInterval = Seconds;
+  }
+
+  // compress the next recorded files in LZ4 blocks
+  void SetCompression(bool bCompress)
+  {
+    bCompressFile = bCompress;
+  }
+
+  // actors sampled and their sampling rates, for the next recorded files
+  void SetFilter(const carla::rpc::RecorderFilter &InFilter)
+  {
+    Filter.Set(InFilter);
+  }
+
+  // bytes of memory held by the buffers of the file being recorded
+  size_t GetAllocatedSize(void)
+  {
+    return Buffer.GetAllocatedSize() + Chunk.capacity() + Writer.GetAllocatedSize();
+  }
 
   void Tick(float DeltaSeconds) final;
 
@@ -123,14 +169,27 @@ private:
 
   uint32_t NextCollisionId = 0;
 
-  // files
-  std::ofstream File;
+  // key frames
+  double KeyFrameInterval = 60.0;
+  double NextKeyFrameTime = 0.0;
+
+  bool bCompressFile = false;
+
+  CarlaRecorderFilter Filter;
+
+  // files: packets are serialized to memory and written by another thread
+  CarlaRecorderBuffer Buffer;
+  std::ostream File { &Buffer };
+  CarlaRecorderWriter Writer;
+  std::vector<char> Chunk;
 
   UCarlaEpisode *Episode = nullptr;
 
   // structures
   CarlaRecorderInfo Info;
   CarlaRecorderFrames Frames;
+  CarlaRecorderFrameIndex FrameIndex;
+  CarlaRecorderKeyFrame KeyFrame;
   CarlaRecorderEventsAdd EventsAdd;
   CarlaRecorderEventsDel EventsDel;
   CarlaRecorderEventsParent EventsParent;
@@ -147,6 +206,12 @@ private:
   CarlaRecorderQuery Query;
 
   void AddExistingActors(void);
+  void AddKeyFrameActors(void);
+  CarlaRecorderEventAdd MakeRecorderEventAdd(
+      uint32_t DatabaseId,
+      uint8_t Type,
+      const FTransform &Transform,
+      const FActorDescription &ActorDescription) const;
   void AddActorPosition(FActorView &View);
   void AddWalkerAnimation(FActorView &View);
   void AddVehicleAnimation(FActorView &View);
@@ -31,8 +31,8 @@ struct CarlaRecorderEventAdd
     FVector Rotation;
     CarlaRecorderActorDescription Description;
 
-    void Read(std::ifstream &InFile);
-    void Write(std::ofstream &OutFile) const;
+    void Read(std::istream &InFile);
+    void Write(std::ostream &OutFile) const;
 };
 
 class CarlaRecorderEventsAdd
@@ -41,7 +41,12 @@ class CarlaRecorderEventsAdd
     public:
     void Add(const CarlaRecorderEventAdd &Event);
     void Clear(void);
-    void Write(std::ofstream &OutFile);
+    void Write(std::ostream &OutFile);
+
+    bool IsEmpty(void) const
+    {
+        return Events.empty();
+    }
 
     private:
     std::vector<CarlaRecorderEventAdd> Events;
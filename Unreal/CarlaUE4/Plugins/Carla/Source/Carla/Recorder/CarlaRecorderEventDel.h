@@ -13,8 +13,8 @@ struct CarlaRecorderEventDel
 {
     uint32_t DatabaseId;
 
-    void Read(std::ifstream &InFile);
-    void Write(std::ofstream &OutFile) const;
+    void Read(std::istream &InFile);
+    void Write(std::ostream &OutFile) const;
 };
 
 class CarlaRecorderEventsDel
@@ -23,7 +23,12 @@ class CarlaRecorderEventsDel
     public:
     void Add(const CarlaRecorderEventDel &Event);
     void Clear(void);
-    void Write(std::ofstream &OutFile);
+    void Write(std::ostream &OutFile);
+
+    bool IsEmpty(void) const
+    {
+        return Events.empty();
+    }
 
     private:
     std::vector<CarlaRecorderEventDel> Events;
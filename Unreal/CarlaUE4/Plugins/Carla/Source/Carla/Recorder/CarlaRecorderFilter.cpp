@@ -0,0 +1,101 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaRecorder.h"
+#include "CarlaRecorderFilter.h"
+
+#include "Carla/Actor/ActorInfo.h"
+
+#include <algorithm>
+
+void CarlaRecorderFilter::Set(const carla::rpc::RecorderFilter &InFilter)
+{
+  FullRateIds.clear();
+  FullRateIds.insert(InFilter.actor_ids.begin(), InFilter.actor_ids.end());
+
+  TypePatterns.Empty();
+  for (const auto &Pattern : InFilter.type_patterns)
+  {
+    TypePatterns.Add(FString(Pattern.c_str()));
+  }
+
+  // a divisor of zero is taken as one
+  VehicleDivisor = std::max(InFilter.vehicle_divisor, 1u);
+  WalkerDivisor = std::max(InFilter.walker_divisor, 1u);
+  TrafficLightDivisor = std::max(InFilter.traffic_light_divisor, 1u);
+
+  Reset();
+}
+
+bool CarlaRecorderFilter::IsDue(const FActorView &View, uint64_t FrameId)
+{
+  const uint32_t Id = View.GetActorId();
+  auto It = Divisors.find(Id);
+  if (It == Divisors.end())
+  {
+    It = Divisors.emplace(Id, GetDivisor(View)).first;
+  }
+
+  const uint32_t Divisor = It->second;
+  if (Divisor <= 1u)
+  {
+    return (Divisor == 1u);
+  }
+  return ((FrameId + Id) % Divisor) == 0u;
+}
+
+uint32_t CarlaRecorderFilter::GetDivisor(const FActorView &View) const
+{
+  const FActorInfo *Info = View.GetActorInfo();
+
+  // check the type
+  if (TypePatterns.Num() > 0)
+  {
+    if (Info == nullptr)
+    {
+      return 0u;
+    }
+    bool bMatch = false;
+    for (const FString &Pattern : TypePatterns)
+    {
+      if (Info->Description.Id.MatchesWildcard(Pattern))
+      {
+        bMatch = true;
+        break;
+      }
+    }
+    if (!bMatch)
+    {
+      return 0u;
+    }
+  }
+
+  // actors at full rate
+  if (FullRateIds.count(View.GetActorId()) > 0)
+  {
+    return 1u;
+  }
+  if (Info != nullptr)
+  {
+    auto *Role = Info->Description.Variations.Find("role_name");
+    if (Role != nullptr && Role->Value == "hero")
+    {
+      return 1u;
+    }
+  }
+
+  switch (View.GetActorType())
+  {
+    case FActorView::ActorType::Vehicle:
+      return VehicleDivisor;
+    case FActorView::ActorType::Walker:
+      return WalkerDivisor;
+    case FActorView::ActorType::TrafficLight:
+      return TrafficLightDivisor;
+    default:
+      return 1u;
+  }
+}
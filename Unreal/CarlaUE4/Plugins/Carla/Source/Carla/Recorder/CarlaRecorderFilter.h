@@ -0,0 +1,50 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Actor/ActorView.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/RecorderFilter.h>
+#include <compiler/enable-ue4-macros.h>
+
+// Decides which actors are sampled by the recorder on each frame. An actor
+// with a divisor N is sampled once every N frames, the frame depends on the
+// actor id so the cost is spread over the frames.
+class CarlaRecorderFilter
+{
+
+public:
+
+  void Set(const carla::rpc::RecorderFilter &InFilter);
+
+  // forget the actors seen, at the start of a recording
+  void Reset(void)
+  {
+    Divisors.clear();
+  }
+
+  // whether the data of the actor has to be recorded in the frame
+  bool IsDue(const FActorView &View, uint64_t FrameId);
+
+private:
+
+  // zero if the actor is not recorded at all
+  uint32_t GetDivisor(const FActorView &View) const;
+
+  std::unordered_set<uint32_t> FullRateIds;
+  TArray<FString> TypePatterns;
+  uint32_t VehicleDivisor = 1u;
+  uint32_t WalkerDivisor = 1u;
+  uint32_t TrafficLightDivisor = 1u;
+
+  // divisor of each actor, found the first time it is seen
+  std::unordered_map<uint32_t, uint32_t> Divisors;
+};
@@ -0,0 +1,135 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaRecorder.h"
+#include "CarlaRecorderFrameIndex.h"
+#include "CarlaRecorderHelpers.h"
+
+#include <algorithm>
+
+// last bytes of the index packet: offset of the packet and magic number
+static constexpr uint32_t FrameIndexMagic = 0x58444952u; // "RIDX"
+static constexpr uint32_t FrameIndexTrailerSize = sizeof(uint64_t) + sizeof(uint32_t);
+static constexpr uint32_t FrameIndexHeaderSize = sizeof(char) + sizeof(uint32_t);
+
+void CarlaRecorderFrameIndex::Clear(void)
+{
+  Frames.clear();
+}
+
+void CarlaRecorderFrameIndex::Add(std::streampos Offset, double Elapsed, uint8_t Flags)
+{
+  CarlaRecorderFrameIndexEntry Entry;
+  Entry.Offset = static_cast<uint64_t>(Offset);
+  Entry.Elapsed = Elapsed;
+  Entry.Flags = Flags;
+  Frames.push_back(Entry);
+}
+
+void CarlaRecorderFrameIndex::Write(std::ostream &OutFile)
+{
+  uint64_t PacketOffset = static_cast<uint64_t>(OutFile.tellp());
+
+  // write the packet id
+  WriteValue<char>(OutFile, static_cast<char>(CarlaRecorderPacketId::FrameIndex));
+
+  // write the packet size
+  uint32_t Total = Frames.size();
+  uint32_t Size = sizeof(uint32_t) + Total * sizeof(CarlaRecorderFrameIndexEntry) + FrameIndexTrailerSize;
+  WriteValue<uint32_t>(OutFile, Size);
+
+  // write the frames
+  WriteValue<uint32_t>(OutFile, Total);
+  if (Total > 0)
+  {
+    OutFile.write(reinterpret_cast<const char *>(Frames.data()), Total * sizeof(CarlaRecorderFrameIndexEntry));
+  }
+
+  // write the trailer
+  WriteValue<uint64_t>(OutFile, PacketOffset);
+  WriteValue<uint32_t>(OutFile, FrameIndexMagic);
+}
+
+bool CarlaRecorderFrameIndex::Read(std::istream &InFile)
+{
+  Frames.clear();
+
+  std::streampos Current = InFile.tellg();
+  auto Restore = [&]() {
+    InFile.clear();
+    InFile.seekg(Current, std::ios::beg);
+  };
+
+  // read the trailer
+  InFile.seekg(0, std::ios::end);
+  uint64_t FileSize = static_cast<uint64_t>(InFile.tellg());
+  if (!InFile || FileSize < FrameIndexHeaderSize + sizeof(uint32_t) + FrameIndexTrailerSize)
+  {
+    Restore();
+    return false;
+  }
+  uint64_t PacketOffset = 0;
+  uint32_t Magic = 0;
+  InFile.seekg(FileSize - FrameIndexTrailerSize, std::ios::beg);
+  ReadValue<uint64_t>(InFile, PacketOffset);
+  ReadValue<uint32_t>(InFile, Magic);
+  if (!InFile || Magic != FrameIndexMagic || PacketOffset >= FileSize)
+  {
+    Restore();
+    return false;
+  }
+
+  // read the packet and check it fills the rest of the file
+  char Id = 0;
+  uint32_t Size = 0, Total = 0;
+  InFile.seekg(PacketOffset, std::ios::beg);
+  ReadValue<char>(InFile, Id);
+  ReadValue<uint32_t>(InFile, Size);
+  ReadValue<uint32_t>(InFile, Total);
+  if (!InFile ||
+      Id != static_cast<char>(CarlaRecorderPacketId::FrameIndex) ||
+      PacketOffset + FrameIndexHeaderSize + Size != FileSize ||
+      Size != sizeof(uint32_t) + static_cast<uint64_t>(Total) * sizeof(CarlaRecorderFrameIndexEntry) + FrameIndexTrailerSize)
+  {
+    Restore();
+    return false;
+  }
+  Frames.resize(Total);
+  if (Total > 0)
+  {
+    InFile.read(reinterpret_cast<char *>(Frames.data()), Total * sizeof(CarlaRecorderFrameIndexEntry));
+  }
+  if (!InFile)
+  {
+    Frames.clear();
+  }
+
+  Restore();
+  return !Frames.empty();
+}
+
+size_t CarlaRecorderFrameIndex::FindFrame(double Time) const
+{
+  check(!Frames.empty());
+  // first frame starting after the time
+  auto It = std::upper_bound(
+      Frames.begin(),
+      Frames.end(),
+      Time,
+      [](double Value, const CarlaRecorderFrameIndexEntry &Entry) {
+        return Value < Entry.Elapsed;
+      });
+  if (It == Frames.begin())
+  {
+    return 0;
+  }
+  return static_cast<size_t>(std::distance(Frames.begin(), It)) - 1;
+}
+
+double CarlaRecorderFrameIndex::GetTotalTime(void) const
+{
+  return Frames.empty() ? 0.0 : Frames.back().Elapsed;
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <fstream>
+#include <vector>
+
+#pragma pack(push, 1)
+struct CarlaRecorderFrameIndexEntry
+{
+  // the frame has actor events (add, del, parent) that must be replayed even
+  // when seeking past it
+  static constexpr uint8_t FlagEvents = 1u << 0;
+  // the frame has a key frame packet with all the actors
+  static constexpr uint8_t FlagKeyFrame = 1u << 1;
+
+  // position in the file of the frame start packet
+  uint64_t Offset;
+  double Elapsed;
+  uint8_t Flags;
+
+  bool HasEvents(void) const
+  {
+    return (Flags & FlagEvents) != 0u;
+  }
+
+  bool IsKeyFrame(void) const
+  {
+    return (Flags & FlagKeyFrame) != 0u;
+  }
+};
+#pragma pack(pop)
+
+// Index of the frames of a recording, written as the last packet of the file.
+// The packet ends with its own offset and a magic number, so it can be found
+// reading only the end of the file. Files without index are read sequentially
+// as before, and older versions of the replayer skip the packet.
+class CarlaRecorderFrameIndex
+{
+
+public:
+
+  void Clear(void);
+
+  void Add(std::streampos Offset, double Elapsed, uint8_t Flags);
+
+  void Write(std::ostream &OutFile);
+
+  // load the index from the end of the file, returns false if the file has
+  // none; the read position of the file is kept
+  bool Read(std::istream &InFile);
+
+  bool IsEmpty(void) const
+  {
+    return Frames.empty();
+  }
+
+  size_t GetNumberOfFrames(void) const
+  {
+    return Frames.size();
+  }
+
+  const CarlaRecorderFrameIndexEntry &GetFrame(size_t Index) const
+  {
+    return Frames[Index];
+  }
+
+  // index of the frame that contains the given time (binary search)
+  size_t FindFrame(double Time) const;
+
+  // elapsed time at the start of the last frame
+  double GetTotalTime(void) const;
+
+private:
+
+  std::vector<CarlaRecorderFrameIndexEntry> Frames;
+};
@@ -15,9 +15,9 @@ struct CarlaRecorderFrame
   double DurationThis;
   double Elapsed;
 
-  void Read(std::ifstream &InFile);
+  void Read(std::istream &InFile);
 
-  void Write(std::ofstream &OutFile);
+  void Write(std::ostream &OutFile);
 
 };
 #pragma pack(pop)
@@ -32,8 +32,18 @@ public:
 
   void SetFrame(double DeltaSeconds);
 
-  void WriteStart(std::ofstream &OutFile);
-  void WriteEnd(std::ofstream &OutFile);
+  void WriteStart(std::ostream &OutFile);
+  void WriteEnd(std::ostream &OutFile);
+
+  uint64_t GetId(void) const
+  {
+    return Frame.Id;
+  }
+
+  double GetElapsed(void) const
+  {
+    return Frame.Elapsed;
+  }
 
 private:
 
@@ -0,0 +1,82 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaRecorder.h"
+#include "CarlaRecorderKeyFrame.h"
+#include "CarlaRecorderHelpers.h"
+
+void CarlaRecorderKeyFrame::AddActor(CarlaRecorderEventAdd Actor)
+{
+    Actors.push_back(std::move(Actor));
+}
+
+void CarlaRecorderKeyFrame::AddParent(const CarlaRecorderEventParent &Parent)
+{
+    Parents.push_back(Parent);
+}
+
+void CarlaRecorderKeyFrame::Clear(void)
+{
+    Actors.clear();
+    Parents.clear();
+}
+
+void CarlaRecorderKeyFrame::Write(std::ostream &OutFile)
+{
+    // write the packet id
+    WriteValue<char>(OutFile, static_cast<char>(CarlaRecorderPacketId::KeyFrame));
+
+    std::streampos PosStart = OutFile.tellp();
+
+    // write a dummy packet size
+    uint32_t Total = 0;
+    WriteValue<uint32_t>(OutFile, Total);
+
+    // write the actors
+    Total = Actors.size();
+    WriteValue<uint16_t>(OutFile, Total);
+    for (uint16_t i=0; i<Total; ++i)
+    {
+        Actors[i].Write(OutFile);
+    }
+
+    // write the parents
+    Total = Parents.size();
+    WriteValue<uint16_t>(OutFile, Total);
+    for (uint16_t i=0; i<Total; ++i)
+    {
+        Parents[i].Write(OutFile);
+    }
+
+    // write the real packet size
+    std::streampos PosEnd = OutFile.tellp();
+    Total = PosEnd - PosStart - sizeof(uint32_t);
+    OutFile.seekp(PosStart, std::ios::beg);
+    WriteValue<uint32_t>(OutFile, Total);
+    OutFile.seekp(PosEnd, std::ios::beg);
+}
+
+void CarlaRecorderKeyFrame::Read(std::istream &InFile)
+{
+    uint16_t i, Total;
+    Clear();
+
+    // read the actors
+    ReadValue<uint16_t>(InFile, Total);
+    Actors.resize(Total);
+    for (i = 0; i < Total; ++i)
+    {
+        Actors[i].Read(InFile);
+    }
+
+    // read the parents
+    ReadValue<uint16_t>(InFile, Total);
+    Parents.resize(Total);
+    for (i = 0; i < Total; ++i)
+    {
+        Parents[i].Read(InFile);
+    }
+}
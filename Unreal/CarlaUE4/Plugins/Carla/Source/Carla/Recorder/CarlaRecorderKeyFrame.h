@@ -0,0 +1,42 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CarlaRecorderEventAdd.h"
+#include "CarlaRecorderEventParent.h"
+
+#include <fstream>
+#include <vector>
+
+// Full set of actors alive at the end of a frame, with their descriptions and
+// parents. Lets the replayer start from this frame without replaying the
+// events of all the previous ones. Positions, states and animations are
+// already complete in every frame.
+class CarlaRecorderKeyFrame
+{
+
+    public:
+    void AddActor(CarlaRecorderEventAdd Actor);
+    void AddParent(const CarlaRecorderEventParent &Parent);
+    void Clear(void);
+    void Write(std::ostream &OutFile);
+    void Read(std::istream &InFile);
+
+    const std::vector<CarlaRecorderEventAdd> &GetActors(void) const
+    {
+        return Actors;
+    }
+
+    const std::vector<CarlaRecorderEventParent> &GetParents(void) const
+    {
+        return Parents;
+    }
+
+    private:
+    std::vector<CarlaRecorderEventAdd> Actors;
+    std::vector<CarlaRecorderEventParent> Parents;
+};
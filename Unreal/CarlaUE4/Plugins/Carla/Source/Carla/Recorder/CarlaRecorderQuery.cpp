@@ -4,14 +4,102 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include "CarlaRecorder.h"
+#include "CarlaRecorderQuery.h"
 #include "CarlaRecorderHelpers.h"
 
+#include "Async/ParallelFor.h"
+
+#include <algorithm>
 #include <ctime>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <map>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+// ---------------------------------------------
+// partial results of the chunks
+// ---------------------------------------------
+
+namespace {
+
+  struct InfoPartial
+  {
+    std::string Text;
+    CarlaRecorderFrame Frame {};
+    bool bHasFrame = false;
+  };
+
+  struct InfoRecordsPartial
+  {
+    std::vector<carla::rpc::RecorderFrameEvents> Events;
+    CarlaRecorderFrame Frame {};
+    bool bHasFrame = false;
+  };
+
+  struct CollisionItem
+  {
+    enum class EKind : uint8_t { Add, Del, Collision } Kind;
+    // number of the frame in the file
+    uint32_t FrameNumber;
+    double Elapsed;
+    // actor added or removed
+    uint32_t DatabaseId;
+    uint8_t Type;
+    FString Id;
+    CarlaRecorderCollision Collision;
+  };
+
+  struct CollisionsPartial
+  {
+    std::vector<CollisionItem> Items;
+    CarlaRecorderFrame Frame {};
+    bool bHasFrame = false;
+  };
+
+  struct BlockedItem
+  {
+    enum class EKind : uint8_t { Frame, Add, Del, Position } Kind;
+    uint32_t DatabaseId;
+    // frame
+    double Elapsed;
+    double DurationThis;
+    // position
+    FVector Location;
+    // actor added
+    FString Id;
+  };
+
+  struct BlockedPartial
+  {
+    std::vector<BlockedItem> Items;
+    CarlaRecorderFrame Frame {};
+    bool bHasFrame = false;
+  };
+
+} // namespace
 
-inline bool CarlaRecorderQuery::ReadHeader(void)
+// ---------------------------------------------
+// reader of a chunk
+// ---------------------------------------------
+
+bool CarlaRecorderQuery::Reader::Open(const std::string &Filename, const Chunk &Range)
+{
+  if (!File.Open(Filename))
+  {
+    return false;
+  }
+  File.seekg(Range.Begin, std::ios::beg);
+  return static_cast<bool>(File);
+}
+
+inline bool CarlaRecorderQuery::Reader::ReadHeader(const Chunk &Range)
 {
-  if (File.eof())
+  if (File.eof() || static_cast<uint64_t>(File.tellg()) >= Range.End)
   {
     return false;
   }
@@ -19,14 +107,18 @@ inline bool CarlaRecorderQuery::ReadHeader(void)
   ReadValue<char>(File, Header.Id);
   ReadValue<uint32_t>(File, Header.Size);
 
-  return true;
+  return static_cast<bool>(File);
 }
 
-inline void CarlaRecorderQuery::SkipPacket(void)
+inline void CarlaRecorderQuery::Reader::SkipPacket(void)
 {
   File.seekg(Header.Size, std::ios::cur);
 }
 
+// ---------------------------------------------
+// query
+// ---------------------------------------------
+
 inline bool CarlaRecorderQuery::CheckFileInfo(std::stringstream &Info)
 {
   // read Info
@@ -50,258 +142,585 @@ inline bool CarlaRecorderQuery::CheckFileInfo(std::stringstream &Info)
   return true;
 }
 
-std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
+bool CarlaRecorderQuery::OpenFile(const std::string &Filename, std::stringstream &Info)
 {
-  std::stringstream Info;
+  // try to open
+  File.Open(Filename);
+  if (!File.IsOpen())
+  {
+    Info << "File " << Filename << " not found on server\n";
+    return false;
+  }
 
-  // get the final path + filename
-  std::string Filename2 = GetRecorderFilename(Filename);
+  if (!CheckFileInfo(Info))
+  {
+    File.Close();
+    return false;
+  }
 
-  // try to open
-  File.open(Filename2, std::ios::binary);
-  if (!File.is_open())
+  // split the frames of the index in chunks, a file without index is read as
+  // a single chunk
+  constexpr uint64_t EndOfFile = std::numeric_limits<uint64_t>::max();
+  uint64_t Start = static_cast<uint64_t>(File.tellg());
+  Chunks.clear();
+  if (FrameIndex.Read(File))
   {
-    Info << "File " << Filename2 << " not found on server\n";
-    return Info.str();
+    size_t Total = FrameIndex.GetNumberOfFrames();
+    for (size_t i = 0; i < Total; i += MaxFramesPerChunk)
+    {
+      size_t Next = i + MaxFramesPerChunk;
+      Chunks.push_back(Chunk {
+          FrameIndex.GetFrame(i).Offset,
+          Next < Total ? FrameIndex.GetFrame(Next).Offset : EndOfFile,
+          static_cast<uint32_t>(i) });
+    }
+  }
+  else
+  {
+    Chunks.push_back(Chunk { Start, EndOfFile, 0u });
   }
 
-  uint16_t i, Total;
-  bool bFramePrinted = false;
+  File.Close();
+  return true;
+}
 
-  // lambda for repeating task
-  auto PrintFrame = [this](std::stringstream &Info)
+bool CarlaRecorderQuery::ReadFileInfo(const std::string &Filename, std::stringstream &Info)
+{
+  File.Open(Filename);
+  if (!File.IsOpen())
   {
-    Info << "Frame " << Frame.Id << " at " << Frame.Elapsed << " seconds\n";
-  };
+    Info << "File " << Filename << " not found on server\n";
+    return false;
+  }
 
-  if (!CheckFileInfo(Info))
-    return Info.str();
+  bool bIsValid = CheckFileInfo(Info);
+  File.Close();
+  return bIsValid;
+}
 
-  // parse only frames
-  while (File)
+template <typename T>
+bool CarlaRecorderQuery::FindRecords(const std::string &Key, T &Result)
+{
+  std::string Data;
+  if (!Cache.Find(Key, Data))
   {
+    return false;
+  }
+  try
+  {
+    Result = carla::MsgPack::UnPack<T>(reinterpret_cast<const unsigned char *>(Data.data()), Data.size());
+  }
+  catch (const std::exception &)
+  {
+    // written by a different version, parse the file again
+    return false;
+  }
+  return true;
+}
+
+template <typename T>
+void CarlaRecorderQuery::SaveRecords(const std::string &Key, const T &Result)
+{
+  carla::Buffer Data = carla::MsgPack::Pack(Result);
+  Cache.Save(Key, std::string(reinterpret_cast<const char *>(Data.data()), Data.size()));
+}
 
-    // get header
-    if (!ReadHeader())
+template <typename TPartial, typename TScan, typename TMerge>
+void CarlaRecorderQuery::ScanChunks(const std::string &Filename, TScan &&Scan, TMerge &&Merge)
+{
+  const size_t Tasks = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<TPartial> Partials;
+  for (size_t First = 0u; First < Chunks.size(); First += Tasks)
+  {
+    const size_t Count = std::min(Tasks, Chunks.size() - First);
+    Partials.clear();
+    Partials.resize(Count);
+    ParallelFor(static_cast<int32>(Count), [&](int32 Index)
+    {
+      const Chunk &Range = Chunks[First + Index];
+      Reader ChunkReader;
+      if (ChunkReader.Open(Filename, Range))
+      {
+        Scan(ChunkReader, Range, Partials[Index]);
+      }
+    });
+    for (auto &Partial : Partials)
     {
-      break;
+      Merge(Partial);
     }
+  }
+}
 
-    // check for a frame packet
-    switch (Header.Id)
-    {
-      // frame
-      case static_cast<char>(CarlaRecorderPacketId::FrameStart):
-        Frame.Read(File);
-        if (bShowAll)
-        {
-          PrintFrame(Info);
-          bFramePrinted = true;
-        }
-        else
-          bFramePrinted = false;
-        break;
+std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
+{
+  // get the final path + filename
+  std::string Filename2 = GetRecorderFilename(Filename);
 
-      // events add
-      case static_cast<char>(CarlaRecorderPacketId::EventAdd):
-        ReadValue<uint16_t>(File, Total);
-        if (Total > 0 && !bFramePrinted)
-        {
-          PrintFrame(Info);
-          bFramePrinted = true;
-        }
-        for (i = 0; i < Total; ++i)
-        {
-          // add
-          EventAdd.Read(File);
-          Info << " Create " << EventAdd.DatabaseId << ": " << TCHAR_TO_UTF8(*EventAdd.Description.Id) <<
-            " (" <<
-            static_cast<int>(EventAdd.Type) << ") at (" << EventAdd.Location.X << ", " <<
-            EventAdd.Location.Y << ", " << EventAdd.Location.Z << ")" << std::endl;
-          for (auto &Att : EventAdd.Description.Attributes)
-          {
-            Info << "  " << TCHAR_TO_UTF8(*Att.Id) << " = " << TCHAR_TO_UTF8(*Att.Value) << std::endl;
-          }
-        }
-        break;
+  // the full info is too large to be cached
+  std::string Output;
+  const std::string Key = "info";
+  Cache.Load(Filename2);
+  if (!bShowAll && Cache.Find(Key, Output))
+  {
+    return Output;
+  }
 
-      // events del
-      case static_cast<char>(CarlaRecorderPacketId::EventDel):
-        ReadValue<uint16_t>(File, Total);
-        if (Total > 0 && !bFramePrinted)
-        {
-          PrintFrame(Info);
-          bFramePrinted = true;
-        }
-        for (i = 0; i < Total; ++i)
-        {
-          EventDel.Read(File);
-          Info << " Destroy " << EventDel.DatabaseId << "\n";
-        }
-        break;
+  std::stringstream Info;
+  if (!OpenFile(Filename2, Info))
+  {
+    return Info.str();
+  }
 
-      // events parenting
-      case static_cast<char>(CarlaRecorderPacketId::EventParent):
-        ReadValue<uint16_t>(File, Total);
-        if (Total > 0 && !bFramePrinted)
-        {
-          PrintFrame(Info);
-          bFramePrinted = true;
-        }
-        for (i = 0; i < Total; ++i)
-        {
-          EventParent.Read(File);
-          Info << " Parenting " << EventParent.DatabaseId << " with " << EventParent.DatabaseIdParent <<
-            " (parent)\n";
-        }
-        break;
+  auto Scan = [bShowAll](Reader &R, const Chunk &Range, InfoPartial &Partial)
+  {
+    std::stringstream Text;
+    uint16_t i, Total;
+    bool bFramePrinted = false;
 
-      // collisions
-      case static_cast<char>(CarlaRecorderPacketId::Collision):
-        ReadValue<uint16_t>(File, Total);
-        if (Total > 0 && !bFramePrinted)
-        {
-          PrintFrame(Info);
-          bFramePrinted = true;
-        }
-        for (i = 0; i < Total; ++i)
-        {
-          Collision.Read(File);
-          Info << " Collision id " << Collision.Id << " between " << Collision.DatabaseId1;
-          if (Collision.IsActor1Hero)
-            Info << " (hero) ";
-          Info << " with " << Collision.DatabaseId2;
-          if (Collision.IsActor2Hero)
-            Info << " (hero) ";
-          Info << std::endl;
-        }
+    // lambda for repeating task
+    auto PrintFrame = [&]()
+    {
+      Text << "Frame " << R.Frame.Id << " at " << R.Frame.Elapsed << " seconds\n";
+    };
+
+    // parse only frames
+    while (R.File)
+    {
+
+      // get header
+      if (!R.ReadHeader(Range))
+      {
         break;
+      }
+
+      // check for a frame packet
+      switch (R.Header.Id)
+      {
+        // frame
+        case static_cast<char>(CarlaRecorderPacketId::FrameStart):
+          R.Frame.Read(R.File);
+          Partial.Frame = R.Frame;
+          Partial.bHasFrame = true;
+          if (bShowAll)
+          {
+            PrintFrame();
+            bFramePrinted = true;
+          }
+          else
+            bFramePrinted = false;
+          break;
 
-      // positions
-      case static_cast<char>(CarlaRecorderPacketId::Position):
-        if (bShowAll)
-        {
-          ReadValue<uint16_t>(File, Total);
+        // events add
+        case static_cast<char>(CarlaRecorderPacketId::EventAdd):
+          ReadValue<uint16_t>(R.File, Total);
           if (Total > 0 && !bFramePrinted)
           {
-            PrintFrame(Info);
+            PrintFrame();
             bFramePrinted = true;
           }
-          Info << " Positions: " << Total << std::endl;
           for (i = 0; i < Total; ++i)
           {
-            Position.Read(File);
-            Info << "  Id: " << Position.DatabaseId << " Location (" << Position.Location.X << ", " << Position.Location.Y << ", " << Position.Location.Z << ") Rotation (" <<  Position.Rotation.X << ", " << Position.Rotation.Y << ", " << Position.Rotation.Z << ")" << std::endl;
+            // add
+            R.EventAdd.Read(R.File);
+            Text << " Create " << R.EventAdd.DatabaseId << ": " << TCHAR_TO_UTF8(*R.EventAdd.Description.Id) <<
+              " (" <<
+              static_cast<int>(R.EventAdd.Type) << ") at (" << R.EventAdd.Location.X << ", " <<
+              R.EventAdd.Location.Y << ", " << R.EventAdd.Location.Z << ")" << std::endl;
+            for (auto &Att : R.EventAdd.Description.Attributes)
+            {
+              Text << "  " << TCHAR_TO_UTF8(*Att.Id) << " = " << TCHAR_TO_UTF8(*Att.Value) << std::endl;
+            }
           }
-        }
-        else
-          SkipPacket();
-        break;
+          break;
 
-      // traffic light
-      case static_cast<char>(CarlaRecorderPacketId::State):
-        if (bShowAll)
-        {
-          ReadValue<uint16_t>(File, Total);
+        // events del
+        case static_cast<char>(CarlaRecorderPacketId::EventDel):
+          ReadValue<uint16_t>(R.File, Total);
           if (Total > 0 && !bFramePrinted)
           {
-            PrintFrame(Info);
+            PrintFrame();
             bFramePrinted = true;
           }
-          Info << " State traffic lights: " << Total << std::endl;
           for (i = 0; i < Total; ++i)
           {
-            StateTraffic.Read(File);
-            Info << "  Id: " << StateTraffic.DatabaseId << " state: " << static_cast<char>(0x30 + StateTraffic.State) << " frozen: " <<
-              StateTraffic.IsFrozen << " elapsedTime: " << StateTraffic.ElapsedTime << std::endl;
+            R.EventDel.Read(R.File);
+            Text << " Destroy " << R.EventDel.DatabaseId << "\n";
           }
-        }
-        else
-          SkipPacket();
-        break;
+          break;
 
-      // vehicle animations
-      case static_cast<char>(CarlaRecorderPacketId::AnimVehicle):
-        if (bShowAll)
-        {
-          ReadValue<uint16_t>(File, Total);
+        // events parenting
+        case static_cast<char>(CarlaRecorderPacketId::EventParent):
+          ReadValue<uint16_t>(R.File, Total);
           if (Total > 0 && !bFramePrinted)
           {
-            PrintFrame(Info);
+            PrintFrame();
             bFramePrinted = true;
           }
-          Info << " Vehicle animations: " << Total << std::endl;
           for (i = 0; i < Total; ++i)
           {
-            Vehicle.Read(File);
-            Info << "  Vehicle id " << Vehicle.DatabaseId << ": Steering " << Vehicle.Steering << " Throttle " << Vehicle.Throttle << " Brake " << Vehicle.Brake << " Handbrake " << Vehicle.bHandbrake << " Gear " << Vehicle.Gear << std::endl;
+            R.EventParent.Read(R.File);
+            Text << " Parenting " << R.EventParent.DatabaseId << " with " << R.EventParent.DatabaseIdParent <<
+              " (parent)\n";
           }
-        }
-        else
-          SkipPacket();
-        break;
+          break;
 
-      // walker animations
-      case static_cast<char>(CarlaRecorderPacketId::AnimWalker):
-        if (bShowAll)
-        {
-          ReadValue<uint16_t>(File, Total);
+        // collisions
+        case static_cast<char>(CarlaRecorderPacketId::Collision):
+          ReadValue<uint16_t>(R.File, Total);
           if (Total > 0 && !bFramePrinted)
           {
-            PrintFrame(Info);
+            PrintFrame();
             bFramePrinted = true;
           }
-          Info << " Walker animations: " << Total << std::endl;
           for (i = 0; i < Total; ++i)
           {
-            Walker.Read(File);
-            Info << "  Walker id " << Walker.DatabaseId << ": speed " << Walker.Speed << std::endl;
+            R.Collision.Read(R.File);
+            Text << " Collision id " << R.Collision.Id << " between " << R.Collision.DatabaseId1;
+            if (R.Collision.IsActor1Hero)
+              Text << " (hero) ";
+            Text << " with " << R.Collision.DatabaseId2;
+            if (R.Collision.IsActor2Hero)
+              Text << " (hero) ";
+            Text << std::endl;
           }
-        }
-        else
-          SkipPacket();
-        break;
+          break;
 
-      // frame end
-      case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
-        // do nothing, it is empty
-        break;
+        // positions
+        case static_cast<char>(CarlaRecorderPacketId::Position):
+          if (bShowAll)
+          {
+            ReadValue<uint16_t>(R.File, Total);
+            if (Total > 0 && !bFramePrinted)
+            {
+              PrintFrame();
+              bFramePrinted = true;
+            }
+            Text << " Positions: " << Total << std::endl;
+            for (i = 0; i < Total; ++i)
+            {
+              R.Position.Read(R.File);
+              Text << "  Id: " << R.Position.DatabaseId << " Location (" << R.Position.Location.X << ", " << R.Position.Location.Y << ", " << R.Position.Location.Z << ") Rotation (" <<  R.Position.Rotation.X << ", " << R.Position.Rotation.Y << ", " << R.Position.Rotation.Z << ")" << std::endl;
+            }
+          }
+          else
+            R.SkipPacket();
+          break;
 
-      default:
-        SkipPacket();
-        break;
+        // traffic light
+        case static_cast<char>(CarlaRecorderPacketId::State):
+          if (bShowAll)
+          {
+            ReadValue<uint16_t>(R.File, Total);
+            if (Total > 0 && !bFramePrinted)
+            {
+              PrintFrame();
+              bFramePrinted = true;
+            }
+            Text << " State traffic lights: " << Total << std::endl;
+            for (i = 0; i < Total; ++i)
+            {
+              R.StateTraffic.Read(R.File);
+              Text << "  Id: " << R.StateTraffic.DatabaseId << " state: " << static_cast<char>(0x30 + R.StateTraffic.State) << " frozen: " <<
+                R.StateTraffic.IsFrozen << " elapsedTime: " << R.StateTraffic.ElapsedTime << std::endl;
+            }
+          }
+          else
+            R.SkipPacket();
+          break;
+
+        // vehicle animations
+        case static_cast<char>(CarlaRecorderPacketId::AnimVehicle):
+          if (bShowAll)
+          {
+            ReadValue<uint16_t>(R.File, Total);
+            if (Total > 0 && !bFramePrinted)
+            {
+              PrintFrame();
+              bFramePrinted = true;
+            }
+            Text << " Vehicle animations: " << Total << std::endl;
+            for (i = 0; i < Total; ++i)
+            {
+              R.Vehicle.Read(R.File);
+              Text << "  Vehicle id " << R.Vehicle.DatabaseId << ": Steering " << R.Vehicle.Steering << " Throttle " << R.Vehicle.Throttle << " Brake " << R.Vehicle.Brake << " Handbrake " << R.Vehicle.bHandbrake << " Gear " << R.Vehicle.Gear << std::endl;
+            }
+          }
+          else
+            R.SkipPacket();
+          break;
+
+        // walker animations
+        case static_cast<char>(CarlaRecorderPacketId::AnimWalker):
+          if (bShowAll)
+          {
+            ReadValue<uint16_t>(R.File, Total);
+            if (Total > 0 && !bFramePrinted)
+            {
+              PrintFrame();
+              bFramePrinted = true;
+            }
+            Text << " Walker animations: " << Total << std::endl;
+            for (i = 0; i < Total; ++i)
+            {
+              R.Walker.Read(R.File);
+              Text << "  Walker id " << R.Walker.DatabaseId << ": speed " << R.Walker.Speed << std::endl;
+            }
+          }
+          else
+            R.SkipPacket();
+          break;
+
+        // frame end
+        case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
+          // do nothing, it is empty
+          break;
+
+        default:
+          R.SkipPacket();
+          break;
+      }
+    }
+
+    Partial.Text = Text.str();
+  };
+
+  CarlaRecorderFrame LastFrame {};
+  ScanChunks<InfoPartial>(Filename2, Scan, [&](InfoPartial &Partial)
+  {
+    Info << Partial.Text;
+    if (Partial.bHasFrame)
+    {
+      LastFrame = Partial.Frame;
     }
+  });
+
+  Info << "\nFrames: " << LastFrame.Id << "\n";
+  Info << "Duration: " << LastFrame.Elapsed << " seconds\n";
+
+  Output = Info.str();
+  if (!bShowAll)
+  {
+    Cache.Save(Key, Output);
+  }
+  return Output;
+}
+
+bool CarlaRecorderQuery::QueryInfo(std::string Filename, carla::rpc::RecorderFileInfo &Result, std::string &Error)
+{
+  // get the final path + filename
+  std::string Filename2 = GetRecorderFilename(Filename);
+
+  const std::string Key = "records info";
+  Cache.Load(Filename2);
+  if (FindRecords(Key, Result))
+  {
+    return true;
+  }
+
+  std::stringstream Info;
+  if (!OpenFile(Filename2, Info))
+  {
+    Error = Info.str();
+    return false;
   }
 
-  Info << "\nFrames: " << Frame.Id << "\n";
-  Info << "Duration: " << Frame.Elapsed << " seconds\n";
+  Result = carla::rpc::RecorderFileInfo{};
+  Result.version = RecInfo.Version;
+  Result.map = TCHAR_TO_UTF8(*RecInfo.Mapfile);
+  Result.date = static_cast<int64_t>(RecInfo.Date);
 
-  File.close();
+  auto Scan = [](Reader &R, const Chunk &Range, InfoRecordsPartial &Partial)
+  {
+    uint16_t i, Total;
+    bool bFrameAdded = false;
 
-  return Info.str();
+    // events of the current frame, added with the first event
+    auto CurrentFrame = [&]() -> carla::rpc::RecorderFrameEvents &
+    {
+      if (!bFrameAdded)
+      {
+        carla::rpc::RecorderFrameEvents Events;
+        Events.frame = R.Frame.Id;
+        Events.elapsed = R.Frame.Elapsed;
+        Partial.Events.emplace_back(std::move(Events));
+        bFrameAdded = true;
+      }
+      return Partial.Events.back();
+    };
+
+    // parse only frames
+    while (R.File)
+    {
+
+      // get header
+      if (!R.ReadHeader(Range))
+      {
+        break;
+      }
+
+      // check for a frame packet
+      switch (R.Header.Id)
+      {
+        // frame
+        case static_cast<char>(CarlaRecorderPacketId::FrameStart):
+          R.Frame.Read(R.File);
+          Partial.Frame = R.Frame;
+          Partial.bHasFrame = true;
+          bFrameAdded = false;
+          break;
+
+        // events add
+        case static_cast<char>(CarlaRecorderPacketId::EventAdd):
+          ReadValue<uint16_t>(R.File, Total);
+          for (i = 0; i < Total; ++i)
+          {
+            R.EventAdd.Read(R.File);
+            carla::rpc::RecorderActor Actor;
+            Actor.id = R.EventAdd.DatabaseId;
+            Actor.type = R.EventAdd.Type;
+            Actor.description = TCHAR_TO_UTF8(*R.EventAdd.Description.Id);
+            Actor.location = carla::geom::Location(R.EventAdd.Location);
+            for (auto &Att : R.EventAdd.Description.Attributes)
+            {
+              Actor.attributes.emplace_back(TCHAR_TO_UTF8(*Att.Id), TCHAR_TO_UTF8(*Att.Value));
+            }
+            CurrentFrame().created.emplace_back(std::move(Actor));
+          }
+          break;
+
+        // events del
+        case static_cast<char>(CarlaRecorderPacketId::EventDel):
+          ReadValue<uint16_t>(R.File, Total);
+          for (i = 0; i < Total; ++i)
+          {
+            R.EventDel.Read(R.File);
+            CurrentFrame().destroyed.push_back(R.EventDel.DatabaseId);
+          }
+          break;
+
+        // events parenting
+        case static_cast<char>(CarlaRecorderPacketId::EventParent):
+          ReadValue<uint16_t>(R.File, Total);
+          for (i = 0; i < Total; ++i)
+          {
+            R.EventParent.Read(R.File);
+            CurrentFrame().parented.push_back({ R.EventParent.DatabaseId, R.EventParent.DatabaseIdParent });
+          }
+          break;
+
+        // collisions
+        case static_cast<char>(CarlaRecorderPacketId::Collision):
+          ReadValue<uint16_t>(R.File, Total);
+          for (i = 0; i < Total; ++i)
+          {
+            R.Collision.Read(R.File);
+            CurrentFrame().collisions.push_back({
+                R.Collision.Id,
+                R.Collision.DatabaseId1,
+                R.Collision.DatabaseId2,
+                R.Collision.IsActor1Hero,
+                R.Collision.IsActor2Hero });
+          }
+          break;
+
+        // frame end
+        case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
+          // do nothing, it is empty
+          break;
+
+        default:
+          R.SkipPacket();
+          break;
+      }
+    }
+  };
+
+  CarlaRecorderFrame LastFrame {};
+  ScanChunks<InfoRecordsPartial>(Filename2, Scan, [&](InfoRecordsPartial &Partial)
+  {
+    std::move(Partial.Events.begin(), Partial.Events.end(), std::back_inserter(Result.events));
+    if (Partial.bHasFrame)
+    {
+      LastFrame = Partial.Frame;
+    }
+  });
+
+  Result.frames = LastFrame.Id;
+  Result.duration = LastFrame.Elapsed;
+
+  SaveRecords(Key, Result);
+  return true;
 }
 
 std::string CarlaRecorderQuery::QueryCollisions(std::string Filename, char Category1, char Category2)
 {
   std::stringstream Info;
+  if (!ReadFileInfo(GetRecorderFilename(Filename), Info))
+  {
+    return Info.str();
+  }
+
+  carla::rpc::RecorderCollisions Result;
+  std::string Error;
+  if (!QueryCollisions(Filename, Category1, Category2, Result, Error))
+  {
+    return Error;
+  }
+
+  // header
+  Info << std::setw(8) << "Time";
+  Info << " " << std::setw(6) << "Types";
+  Info << " " << std::setw(6) << std::right << "Id";
+  Info << " " << std::setw(35) << std::left << "Actor 1";
+  Info << " " << std::setw(6) << std::right << "Id";
+  Info << " " << std::setw(35) << std::left << "Actor 2";
+  Info << std::endl;
+
+  for (auto &Collision : Result.collisions)
+  {
+    Info << std::setw(8) << std::setprecision(0) << std::right << std::fixed << Collision.time;
+    Info << " " << "  " << Collision.type1 << " " << Collision.type2 << " ";
+    Info << " " << std::setw(6) << std::right << Collision.actor_id1;
+    Info << " " << std::setw(35) << std::left << Collision.actor1;
+    Info << " " << std::setw(6) << std::right << Collision.actor_id2;
+    Info << " " << std::setw(35) << std::left << Collision.actor2;
+    Info << std::endl;
+  }
+
+  Info << "\nFrames: " << Result.frames << "\n";
+  Info << "Duration: " << Result.duration << " seconds\n";
 
+  return Info.str();
+}
+
+bool CarlaRecorderQuery::QueryCollisions(
+    std::string Filename,
+    char Category1,
+    char Category2,
+    carla::rpc::RecorderCollisions &Result,
+    std::string &Error)
+{
   // get the final path + filename
   std::string Filename2 = GetRecorderFilename(Filename);
 
-  // try to open
-  File.open(Filename2, std::ios::binary);
-  if (!File.is_open())
+  const std::string Key = std::string("records collisions ") + Category1 + " " + Category2;
+  Cache.Load(Filename2);
+  if (FindRecords(Key, Result))
   {
-    Info << "File " << Filename2 << " not found on server\n";
-    return Info.str();
+    return true;
   }
 
-  if (!CheckFileInfo(Info))
-    return Info.str();
+  std::stringstream Info;
+  if (!OpenFile(Filename2, Info))
+  {
+    Error = Info.str();
+    return false;
+  }
+
+  Result = carla::rpc::RecorderCollisions{};
 
   // other, vehicle, walkers, trafficLight, hero, any
   char Categories[] = { 'o', 'v', 'w', 't', 'h', 'a' };
-  uint16_t i, Total;
   struct ReplayerActorInfo
   {
     uint8_t Type;
@@ -319,70 +738,127 @@ std::string CarlaRecorderQuery::QueryCollisions(std::string Filename, char Categ
     }
   };
   std::unordered_set<std::pair<uint32_t, uint32_t>, PairHash > oldCollisions, newCollisions;
+  uint32_t CollisionsFrame = 0u;
 
-  // header
-  Info << std::setw(8) << "Time";
-  Info << " " << std::setw(6) << "Types";
-  Info << " " << std::setw(6) << std::right << "Id";
-  Info << " " << std::setw(35) << std::left << "Actor 1";
-  Info << " " << std::setw(6) << std::right << "Id";
-  Info << " " << std::setw(35) << std::left << "Actor 2";
-  Info << std::endl;
-
-  // parse only frames
-  while (File)
+  // the chunks only collect the events, the actors and the collisions of the
+  // previous frame are tracked when merging them
+  auto Scan = [](Reader &R, const Chunk &Range, CollisionsPartial &Partial)
   {
+    uint16_t i, Total;
+    uint32_t FrameNumber = Range.FirstFrame;
 
-    // get header
-    if (!ReadHeader())
+    // parse only frames
+    while (R.File)
     {
-      break;
-    }
 
-    // check for a frame packet
-    switch (Header.Id)
-    {
-      // frame
-      case static_cast<char>(CarlaRecorderPacketId::FrameStart):
-        Frame.Read(File);
-        // exchange sets of collisions (to know when a collision is new or continue from previous frame)
-        oldCollisions = std::move(newCollisions);
-        newCollisions.clear();
+      // get header
+      if (!R.ReadHeader(Range))
+      {
         break;
+      }
+
+      // check for a frame packet
+      switch (R.Header.Id)
+      {
+        // frame
+        case static_cast<char>(CarlaRecorderPacketId::FrameStart):
+          R.Frame.Read(R.File);
+          if (Partial.bHasFrame)
+          {
+            ++FrameNumber;
+          }
+          Partial.Frame = R.Frame;
+          Partial.bHasFrame = true;
+          break;
 
-      // events add
-      case static_cast<char>(CarlaRecorderPacketId::EventAdd):
-        ReadValue<uint16_t>(File, Total);
-        for (i = 0; i < Total; ++i)
-        {
-          // add
-          EventAdd.Read(File);
-          Actors[EventAdd.DatabaseId] = ReplayerActorInfo { EventAdd.Type, EventAdd.Description.Id };
-        }
-        break;
+        // events add
+        case static_cast<char>(CarlaRecorderPacketId::EventAdd):
+          ReadValue<uint16_t>(R.File, Total);
+          for (i = 0; i < Total; ++i)
+          {
+            // add
+            R.EventAdd.Read(R.File);
+            CollisionItem Item {};
+            Item.Kind = CollisionItem::EKind::Add;
+            Item.DatabaseId = R.EventAdd.DatabaseId;
+            Item.Type = R.EventAdd.Type;
+            Item.Id = R.EventAdd.Description.Id;
+            Partial.Items.emplace_back(std::move(Item));
+          }
+          break;
 
-      // events del
-      case static_cast<char>(CarlaRecorderPacketId::EventDel):
-        ReadValue<uint16_t>(File, Total);
-        for (i = 0; i < Total; ++i)
-        {
-          EventDel.Read(File);
-          Actors.erase(EventAdd.DatabaseId);
-        }
-        break;
+        // events del
+        case static_cast<char>(CarlaRecorderPacketId::EventDel):
+          ReadValue<uint16_t>(R.File, Total);
+          for (i = 0; i < Total; ++i)
+          {
+            R.EventDel.Read(R.File);
+            CollisionItem Item {};
+            Item.Kind = CollisionItem::EKind::Del;
+            Item.DatabaseId = R.EventDel.DatabaseId;
+            Partial.Items.emplace_back(std::move(Item));
+          }
+          break;
 
-      // events parenting
-      case static_cast<char>(CarlaRecorderPacketId::EventParent):
-        SkipPacket();
-        break;
+        // collisions
+        case static_cast<char>(CarlaRecorderPacketId::Collision):
+          ReadValue<uint16_t>(R.File, Total);
+          for (i = 0; i < Total; ++i)
+          {
+            R.Collision.Read(R.File);
+            CollisionItem Item {};
+            Item.Kind = CollisionItem::EKind::Collision;
+            Item.FrameNumber = FrameNumber;
+            Item.Elapsed = R.Frame.Elapsed;
+            Item.Collision = R.Collision;
+            Partial.Items.emplace_back(std::move(Item));
+          }
+          break;
+
+        // frame end
+        case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
+          // do nothing, it is empty
+          break;
+
+        default:
+          R.SkipPacket();
+          break;
+      }
+    }
+  };
+
+  auto Merge = [&](CollisionsPartial &Partial)
+  {
+    for (auto &Item : Partial.Items)
+    {
+      switch (Item.Kind)
+      {
+        case CollisionItem::EKind::Add:
+          Actors[Item.DatabaseId] = ReplayerActorInfo { Item.Type, Item.Id };
+          break;
+
+        case CollisionItem::EKind::Del:
+          Actors.erase(Item.DatabaseId);
+          break;
 
-      // collisions
-      case static_cast<char>(CarlaRecorderPacketId::Collision):
-        ReadValue<uint16_t>(File, Total);
-        for (i = 0; i < Total; ++i)
+        case CollisionItem::EKind::Collision:
         {
-          Collision.Read(File);
+          // exchange sets of collisions (to know when a collision is new or continue from previous frame)
+          if (Item.FrameNumber != CollisionsFrame)
+          {
+            if (Item.FrameNumber == CollisionsFrame + 1)
+            {
+              oldCollisions = std::move(newCollisions);
+            }
+            else
+            {
+              oldCollisions.clear();
+            }
+            newCollisions.clear();
+            CollisionsFrame = Item.FrameNumber;
+          }
 
+          const CarlaRecorderCollision &Collision = Item.Collision;
           int Valid = 0;
           // get categories for both actors
           uint8_t Type1 = Categories[Actors[Collision.DatabaseId1].Type];
@@ -404,74 +880,116 @@ std::string CarlaRecorderQuery::QueryCollisions(std::string Filename, char Categ
           else if (Category2 == 'h' && Collision.IsActor2Hero)
             ++Valid;
 
-          // only show if both actors has passed the filter
+          // only report if both actors has passed the filter
           if (Valid == 2)
           {
-            // check if we need to show as a starting collision or it is a continuation one
+            // check if it is a starting collision or it is a continuation one
             auto collisionPair = std::make_pair(Collision.DatabaseId1, Collision.DatabaseId2);
             if (oldCollisions.count(collisionPair) == 0)
             {
-              Info << std::setw(8) << std::setprecision(0) << std::right << std::fixed << Frame.Elapsed;
-              Info << " " << "  " << Type1 << " " << Type2 << " ";
-              Info << " " << std::setw(6) << std::right << Collision.DatabaseId1;
-              Info << " " << std::setw(35) << std::left << TCHAR_TO_UTF8(*Actors[Collision.DatabaseId1].Id);
-              Info << " " << std::setw(6) << std::right << Collision.DatabaseId2;
-              Info << " " << std::setw(35) << std::left << TCHAR_TO_UTF8(*Actors[Collision.DatabaseId2].Id);
-              Info << std::endl;
+              carla::rpc::RecorderCollisionInfo Record;
+              Record.time = Item.Elapsed;
+              Record.type1 = static_cast<char>(Type1);
+              Record.type2 = static_cast<char>(Type2);
+              Record.actor_id1 = Collision.DatabaseId1;
+              Record.actor1 = TCHAR_TO_UTF8(*Actors[Collision.DatabaseId1].Id);
+              Record.actor_id2 = Collision.DatabaseId2;
+              Record.actor2 = TCHAR_TO_UTF8(*Actors[Collision.DatabaseId2].Id);
+              Result.collisions.emplace_back(std::move(Record));
             }
             // save current collision
             newCollisions.insert(collisionPair);
           }
+          break;
         }
-        break;
+      }
+    }
+  };
 
-      case static_cast<char>(CarlaRecorderPacketId::Position):
-        SkipPacket();
-        break;
+  CarlaRecorderFrame LastFrame {};
+  ScanChunks<CollisionsPartial>(Filename2, Scan, [&](CollisionsPartial &Partial)
+  {
+    Merge(Partial);
+    if (Partial.bHasFrame)
+    {
+      LastFrame = Partial.Frame;
+    }
+  });
 
-      case static_cast<char>(CarlaRecorderPacketId::State):
-        SkipPacket();
-        break;
+  Result.frames = LastFrame.Id;
+  Result.duration = LastFrame.Elapsed;
 
-      // frame end
-      case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
-        // do nothing, it is empty
-        break;
+  SaveRecords(Key, Result);
+  return true;
+}
 
-      default:
-        SkipPacket();
-        break;
-    }
+std::string CarlaRecorderQuery::QueryBlocked(std::string Filename, double MinTime, double MinDistance)
+{
+  std::stringstream Info;
+  if (!ReadFileInfo(GetRecorderFilename(Filename), Info))
+  {
+    return Info.str();
+  }
+
+  carla::rpc::RecorderBlockedActors Result;
+  std::string Error;
+  if (!QueryBlocked(Filename, MinTime, MinDistance, Result, Error))
+  {
+    return Error;
   }
 
-  Info << "\nFrames: " << Frame.Id << "\n";
-  Info << "Duration: " << Frame.Elapsed << " seconds\n";
+  // header
+  Info << std::setw(8) << "Time";
+  Info << " " << std::setw(6) << "Id";
+  Info << " " << std::setw(35) << std::left << "Actor";
+  Info << " " << std::setw(10) << std::right << "Duration";
+  Info << std::endl;
+
+  for (auto &Actor : Result.actors)
+  {
+    std::stringstream Line;
+    Line << std::setw(8) << std::setprecision(0) << std::fixed << Actor.time;
+    Line << " " << std::setw(6) << Actor.actor_id;
+    Line << " " << std::setw(35) << std::left << Actor.actor;
+    Line << " " << std::setw(10) << std::setprecision(0) << std::fixed << std::right << Actor.duration;
+    Line << std::endl;
+    Info << Line.str();
+  }
 
-  File.close();
+  Info << "\nFrames: " << Result.frames << "\n";
+  Info << "Duration: " << Result.duration << " seconds\n";
 
   return Info.str();
 }
 
-std::string CarlaRecorderQuery::QueryBlocked(std::string Filename, double MinTime, double MinDistance)
+bool CarlaRecorderQuery::QueryBlocked(
+    std::string Filename,
+    double MinTime,
+    double MinDistance,
+    carla::rpc::RecorderBlockedActors &Result,
+    std::string &Error)
 {
-  std::stringstream Info;
-
   // get the final path + filename
   std::string Filename2 = GetRecorderFilename(Filename);
 
-  // try to open
-  File.open(Filename2, std::ios::binary);
-  if (!File.is_open())
+  std::stringstream KeyStream;
+  KeyStream << std::setprecision(17) << "records blocked " << MinTime << " " << MinDistance;
+  const std::string Key = KeyStream.str();
+  Cache.Load(Filename2);
+  if (FindRecords(Key, Result))
   {
-    Info << "File " << Filename2 << " not found on server\n";
-    return Info.str();
+    return true;
   }
 
-  if (!CheckFileInfo(Info))
-    return Info.str();
+  std::stringstream Info;
+  if (!OpenFile(Filename2, Info))
+  {
+    Error = Info.str();
+    return false;
+  }
+
+  Result = carla::rpc::RecorderBlockedActors{};
 
-  // other, vehicle, walkers, trafficLight, hero, any
-  uint16_t i, Total;
   struct ReplayerActorInfo
   {
     uint8_t Type;
@@ -482,141 +1000,181 @@ std::string CarlaRecorderQuery::QueryBlocked(std::string Filename, double MinTim
   };
   std::unordered_map<uint32_t, ReplayerActorInfo> Actors;
   // to be able to sort the results by the duration of each actor (decreasing order)
-  std::multimap<double, std::string, std::greater<double>> Results;
+  std::multimap<double, carla::rpc::RecorderBlockedActor, std::greater<double>> Results;
+  double Elapsed = 0.0, DurationThis = 0.0;
 
-  // header
-  Info << std::setw(8) << "Time";
-  Info << " " << std::setw(6) << "Id";
-  Info << " " << std::setw(35) << std::left << "Actor";
-  Info << " " << std::setw(10) << std::right << "Duration";
-  Info << std::endl;
+  auto AddResult = [&](uint32_t DatabaseId, const ReplayerActorInfo &Actor)
+  {
+    carla::rpc::RecorderBlockedActor Record;
+    Record.time = Actor.Time;
+    Record.actor_id = DatabaseId;
+    Record.actor = TCHAR_TO_UTF8(*Actor.Id);
+    Record.duration = Actor.Duration;
+    Results.insert(std::make_pair(Actor.Duration, std::move(Record)));
+  };
 
-  // parse only frames
-  while (File)
+  // the chunks decode the frames, the events and the positions, the time each
+  // actor is stopped is computed when merging them
+  auto Scan = [](Reader &R, const Chunk &Range, BlockedPartial &Partial)
   {
+    uint16_t i, Total;
 
-    // get header
-    if (!ReadHeader())
+    // parse only frames
+    while (R.File)
     {
-      break;
-    }
 
-    // check for a frame packet
-    switch (Header.Id)
-    {
-      // frame
-      case static_cast<char>(CarlaRecorderPacketId::FrameStart):
-        Frame.Read(File);
+      // get header
+      if (!R.ReadHeader(Range))
+      {
         break;
+      }
 
-      // events add
-      case static_cast<char>(CarlaRecorderPacketId::EventAdd):
-        ReadValue<uint16_t>(File, Total);
-        for (i = 0; i < Total; ++i)
+      // check for a frame packet
+      switch (R.Header.Id)
+      {
+        // frame
+        case static_cast<char>(CarlaRecorderPacketId::FrameStart):
         {
-          // add
-          EventAdd.Read(File);
-          Actors[EventAdd.DatabaseId] = ReplayerActorInfo { EventAdd.Type, EventAdd.Description.Id, FVector(0, 0, 0), 0.0, 0.0 };
+          R.Frame.Read(R.File);
+          Partial.Frame = R.Frame;
+          Partial.bHasFrame = true;
+          BlockedItem Item {};
+          Item.Kind = BlockedItem::EKind::Frame;
+          Item.Elapsed = R.Frame.Elapsed;
+          Item.DurationThis = R.Frame.DurationThis;
+          Partial.Items.emplace_back(std::move(Item));
+          break;
         }
-        break;
 
-      // events del
-      case static_cast<char>(CarlaRecorderPacketId::EventDel):
-        ReadValue<uint16_t>(File, Total);
-        for (i = 0; i < Total; ++i)
-        {
-          EventDel.Read(File);
-          Actors.erase(EventAdd.DatabaseId);
-        }
-        break;
+        // events add
+        case static_cast<char>(CarlaRecorderPacketId::EventAdd):
+          ReadValue<uint16_t>(R.File, Total);
+          for (i = 0; i < Total; ++i)
+          {
+            // add
+            R.EventAdd.Read(R.File);
+            BlockedItem Item {};
+            Item.Kind = BlockedItem::EKind::Add;
+            Item.DatabaseId = R.EventAdd.DatabaseId;
+            Item.Id = R.EventAdd.Description.Id;
+            Partial.Items.emplace_back(std::move(Item));
+          }
+          break;
 
-      // events parenting
-      case static_cast<char>(CarlaRecorderPacketId::EventParent):
-        SkipPacket();
-        break;
+        // events del
+        case static_cast<char>(CarlaRecorderPacketId::EventDel):
+          ReadValue<uint16_t>(R.File, Total);
+          for (i = 0; i < Total; ++i)
+          {
+            R.EventDel.Read(R.File);
+            BlockedItem Item {};
+            Item.Kind = BlockedItem::EKind::Del;
+            Item.DatabaseId = R.EventDel.DatabaseId;
+            Partial.Items.emplace_back(std::move(Item));
+          }
+          break;
 
-      // collisions
-      case static_cast<char>(CarlaRecorderPacketId::Collision):
-        SkipPacket();
-        break;
+        // positions
+        case static_cast<char>(CarlaRecorderPacketId::Position):
+          // read all positions
+          ReadValue<uint16_t>(R.File, Total);
+          for (i = 0; i < Total; ++i)
+          {
+            R.Position.Read(R.File);
+            BlockedItem Item {};
+            Item.Kind = BlockedItem::EKind::Position;
+            Item.DatabaseId = R.Position.DatabaseId;
+            Item.Location = R.Position.Location;
+            Partial.Items.emplace_back(std::move(Item));
+          }
+          break;
+
+        // frame end
+        case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
+          // do nothing, it is empty
+          break;
+
+        default:
+          R.SkipPacket();
+          break;
+      }
+    }
+  };
 
-      // positions
-      case static_cast<char>(CarlaRecorderPacketId::Position):
-        // read all positions
-        ReadValue<uint16_t>(File, Total);
-        for (i=0; i<Total; ++i)
+  auto Merge = [&](BlockedPartial &Partial)
+  {
+    for (auto &Item : Partial.Items)
+    {
+      switch (Item.Kind)
+      {
+        case BlockedItem::EKind::Frame:
+          Elapsed = Item.Elapsed;
+          DurationThis = Item.DurationThis;
+          break;
+
+        case BlockedItem::EKind::Add:
+          Actors[Item.DatabaseId] = ReplayerActorInfo { 0u, Item.Id, FVector(0, 0, 0), 0.0, 0.0 };
+          break;
+
+        case BlockedItem::EKind::Del:
+          Actors.erase(Item.DatabaseId);
+          break;
+
+        case BlockedItem::EKind::Position:
         {
-          Position.Read(File);
+          ReplayerActorInfo &Actor = Actors[Item.DatabaseId];
           // check if actor moved less than a distance
-          if (FVector::Distance(Actors[Position.DatabaseId].LastPosition, Position.Location) < MinDistance)
+          if (FVector::Distance(Actor.LastPosition, Item.Location) < MinDistance)
           {
             // actor stopped
-            if (Actors[Position.DatabaseId].Duration == 0)
-              Actors[Position.DatabaseId].Time = Frame.Elapsed;
-            Actors[Position.DatabaseId].Duration += Frame.DurationThis;
+            if (Actor.Duration == 0)
+              Actor.Time = Elapsed;
+            Actor.Duration += DurationThis;
           }
           else
           {
-            // check to show info
-            if (Actors[Position.DatabaseId].Duration >= MinTime)
+            // check to report it
+            if (Actor.Duration >= MinTime)
             {
-              std::stringstream Result;
-              Result << std::setw(8) << std::setprecision(0) << std::fixed << Actors[Position.DatabaseId].Time;
-              Result << " " << std::setw(6) << Position.DatabaseId;
-              Result << " " << std::setw(35) << std::left << TCHAR_TO_UTF8(*Actors[Position.DatabaseId].Id);
-              Result << " " << std::setw(10) << std::setprecision(0) << std::fixed << std::right << Actors[Position.DatabaseId].Duration;
-              Result << std::endl;
-              Results.insert(std::make_pair(Actors[Position.DatabaseId].Duration, Result.str()));
+              AddResult(Item.DatabaseId, Actor);
             }
             // actor moving
-            Actors[Position.DatabaseId].Duration = 0;
-            Actors[Position.DatabaseId].LastPosition = Position.Location;
+            Actor.Duration = 0;
+            Actor.LastPosition = Item.Location;
           }
+          break;
         }
-        break;
-
-      // traffic light
-      case static_cast<char>(CarlaRecorderPacketId::State):
-        SkipPacket();
-        break;
-
-      // frame end
-      case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
-        // do nothing, it is empty
-        break;
+      }
+    }
+  };
 
-      default:
-        SkipPacket();
-        break;
+  CarlaRecorderFrame LastFrame {};
+  ScanChunks<BlockedPartial>(Filename2, Scan, [&](BlockedPartial &Partial)
+  {
+    Merge(Partial);
+    if (Partial.bHasFrame)
+    {
+      LastFrame = Partial.Frame;
     }
-  }
+  });
 
-  // show actors stopped that were not moving again
+  // actors stopped that were not moving again
   for (auto &Actor : Actors)
   {
-    // check to show info
     if (Actor.second.Duration >= MinTime)
     {
-      std::stringstream Result;
-      Result << std::setw(8) << std::setprecision(0) << std::fixed << Actor.second.Time;
-      Result << " " << std::setw(6) << Actor.first;
-      Result << " " << std::setw(35) << std::left << TCHAR_TO_UTF8(*Actor.second.Id);
-      Result << " " << std::setw(10) << std::setprecision(0) << std::fixed << std::right << Actor.second.Duration;
-      Result << std::endl;
-      Results.insert(std::make_pair(Actor.second.Duration, Result.str()));
+      AddResult(Actor.first, Actor.second);
     }
   }
 
-  // show the result
-  for (auto &Result : Results)
+  Result.actors.reserve(Results.size());
+  for (auto &Item : Results)
   {
-    Info << Result.second;
+    Result.actors.emplace_back(std::move(Item.second));
   }
+  Result.frames = LastFrame.Id;
+  Result.duration = LastFrame.Elapsed;
 
-  Info << "\nFrames: " << Frame.Id << "\n";
-  Info << "Duration: " << Frame.Elapsed << " seconds\n";
-
-  File.close();
-
-  return Info.str();
+  SaveRecords(Key, Result);
+  return true;
 }
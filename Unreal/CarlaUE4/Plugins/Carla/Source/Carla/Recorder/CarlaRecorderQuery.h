@@ -7,28 +7,33 @@
 #pragma once
 
 #include <fstream>
+#include <vector>
 
+#include "CarlaRecorderAnimVehicle.h"
 #include "CarlaRecorderAnimWalker.h"
 #include "CarlaRecorderCollision.h"
 #include "CarlaRecorderEventAdd.h"
 #include "CarlaRecorderEventDel.h"
 #include "CarlaRecorderEventParent.h"
+#include "CarlaRecorderFrameIndex.h"
 #include "CarlaRecorderFrames.h"
 #include "CarlaRecorderInfo.h"
 #include "CarlaRecorderPosition.h"
+#include "CarlaRecorderQueryCache.h"
+#include "CarlaRecorderReader.h"
 #include "CarlaRecorderState.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/RecorderQuery.h>
+#include <compiler/enable-ue4-macros.h>
+
+// Queries over a recorded file. When the file has a frame index, it is split
+// in chunks of frames that are parsed in parallel, each one with its own
+// reader, and the partial results are merged in order. The results are kept
+// in a cache next to the file.
 class CarlaRecorderQuery
 {
 
-  #pragma pack(push, 1)
-  struct Header
-  {
-    char Id;
-    uint32_t Size;
-  };
-  #pragma pack(pop)
-
 public:
 
   // get general info
@@ -38,27 +43,93 @@ public:
   // get info about blocked actors
   std::string QueryBlocked(std::string Filename, double MinTime = 30, double MinDistance = 10);
 
+  // the same queries with structured results, they return false with the
+  // reason in Error if the file cannot be read
+  bool QueryInfo(std::string Filename, carla::rpc::RecorderFileInfo &Result, std::string &Error);
+  bool QueryCollisions(
+      std::string Filename,
+      char Category1,
+      char Category2,
+      carla::rpc::RecorderCollisions &Result,
+      std::string &Error);
+  bool QueryBlocked(
+      std::string Filename,
+      double MinTime,
+      double MinDistance,
+      carla::rpc::RecorderBlockedActors &Result,
+      std::string &Error);
+
 private:
 
-  std::ifstream File;
-  Header Header;
+  // frames parsed by one task
+  struct Chunk
+  {
+    // offset of the first frame start packet
+    uint64_t Begin;
+    // offset where the next chunk starts
+    uint64_t End;
+    // number of the first frame in the file
+    uint32_t FirstFrame;
+  };
+
+  // file and packets used by one task
+  struct Reader
+  {
+    #pragma pack(push, 1)
+    struct Header
+    {
+      char Id;
+      uint32_t Size;
+    };
+    #pragma pack(pop)
+
+    CarlaRecorderInputFile File;
+    Header Header;
+    CarlaRecorderFrame Frame;
+    CarlaRecorderEventAdd EventAdd;
+    CarlaRecorderEventDel EventDel;
+    CarlaRecorderEventParent EventParent;
+    CarlaRecorderPosition Position;
+    CarlaRecorderCollision Collision;
+    CarlaRecorderStateTrafficLight StateTraffic;
+    CarlaRecorderAnimVehicle Vehicle;
+    CarlaRecorderAnimWalker Walker;
+
+    // open the file at the start of the chunk
+    bool Open(const std::string &Filename, const Chunk &Range);
+
+    // read next header packet, false at the end of the chunk
+    bool ReadHeader(const Chunk &Range);
+
+    // skip current packet
+    void SkipPacket(void);
+  };
+
+  static constexpr uint32_t MaxFramesPerChunk = 250u;
+
+  CarlaRecorderInputFile File;
   CarlaRecorderInfo RecInfo;
-  CarlaRecorderFrame Frame;
-  CarlaRecorderEventAdd EventAdd;
-  CarlaRecorderEventDel EventDel;
-  CarlaRecorderEventParent EventParent;
-  CarlaRecorderPosition Position;
-  CarlaRecorderCollision Collision;
-  CarlaRecorderStateTrafficLight StateTraffic;
-  CarlaRecorderAnimVehicle Vehicle;
-  CarlaRecorderAnimWalker Walker;
-
-  // read next header packet
-  bool ReadHeader(void);
-
-  // skip current packet
-  void SkipPacket(void);
+  CarlaRecorderFrameIndex FrameIndex;
+  CarlaRecorderQueryCache Cache;
+  std::vector<Chunk> Chunks;
+
+  // open the file, check the info header and split it in chunks
+  bool OpenFile(const std::string &Filename, std::stringstream &Info);
 
   // read the start info structure and check the magic string
   bool CheckFileInfo(std::stringstream &Info);
+
+  // read only the start info structure of the file
+  bool ReadFileInfo(const std::string &Filename, std::stringstream &Info);
+
+  // structured results are kept in the cache serialized with msgpack
+  template <typename T>
+  bool FindRecords(const std::string &Key, T &Result);
+  template <typename T>
+  void SaveRecords(const std::string &Key, const T &Result);
+
+  // parse the chunks in parallel (a few at a time to bound the memory of the
+  // partial results) and merge each partial result in order
+  template <typename TPartial, typename TScan, typename TMerge>
+  void ScanChunks(const std::string &Filename, TScan &&Scan, TMerge &&Merge);
 };
@@ -0,0 +1,141 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaRecorder.h"
+#include "CarlaRecorderQueryCache.h"
+#include "CarlaRecorderHelpers.h"
+
+#include "HAL/FileManager.h"
+
+#include <cstdio>
+#include <fstream>
+
+static constexpr uint32_t QueryCacheMagic = 0x48435152u; // "RQCH"
+
+// strings as length + bytes
+static void WriteCacheString(std::ostream &OutFile, const std::string &Text)
+{
+  WriteValue<uint32_t>(OutFile, static_cast<uint32_t>(Text.size()));
+  OutFile.write(Text.data(), static_cast<std::streamsize>(Text.size()));
+}
+
+static bool ReadCacheString(std::istream &InFile, std::string &Text)
+{
+  uint32_t Length = 0u;
+  ReadValue<uint32_t>(InFile, Length);
+  if (!InFile)
+  {
+    return false;
+  }
+  Text.resize(Length);
+  InFile.read(&Text[0], Length);
+  return static_cast<bool>(InFile);
+}
+
+bool CarlaRecorderQueryCache::GetFileStamp(const std::string &Filename, uint64_t &Size, int64_t &Time) const
+{
+  FString Name(UTF8_TO_TCHAR(Filename.c_str()));
+  int64 FileSize = IFileManager::Get().FileSize(*Name);
+  if (FileSize < 0)
+  {
+    return false;
+  }
+  Size = static_cast<uint64_t>(FileSize);
+  Time = IFileManager::Get().GetTimeStamp(*Name).GetTicks();
+  return true;
+}
+
+void CarlaRecorderQueryCache::Load(const std::string &Filename)
+{
+  Results.clear();
+  CacheFilename.clear();
+  if (!GetFileStamp(Filename, RecordingSize, RecordingTime))
+  {
+    return;
+  }
+  CacheFilename = Filename + ".query";
+
+  std::ifstream InFile(CacheFilename, std::ios::binary);
+  if (!InFile.is_open())
+  {
+    return;
+  }
+
+  // check the recording did not change
+  uint32_t Magic = 0u, Total = 0u;
+  uint64_t Size = 0u;
+  int64_t Time = 0;
+  ReadValue<uint32_t>(InFile, Magic);
+  ReadValue<uint64_t>(InFile, Size);
+  ReadValue<int64_t>(InFile, Time);
+  ReadValue<uint32_t>(InFile, Total);
+  if (!InFile || Magic != QueryCacheMagic || Size != RecordingSize || Time != RecordingTime)
+  {
+    return;
+  }
+
+  for (uint32_t i = 0u; i < Total; ++i)
+  {
+    std::string Key, Result;
+    if (!ReadCacheString(InFile, Key) || !ReadCacheString(InFile, Result))
+    {
+      Results.clear();
+      return;
+    }
+    Results[Key] = std::move(Result);
+  }
+}
+
+bool CarlaRecorderQueryCache::Find(const std::string &Key, std::string &Result) const
+{
+  auto It = Results.find(Key);
+  if (It == Results.end())
+  {
+    return false;
+  }
+  Result = It->second;
+  return true;
+}
+
+void CarlaRecorderQueryCache::Save(const std::string &Key, const std::string &Result)
+{
+  if (CacheFilename.empty())
+  {
+    return;
+  }
+  Results[Key] = Result;
+
+  // write to a temporal file and replace the old one, so another process
+  // never reads a cache half written
+  std::string TempFilename = CacheFilename + ".tmp";
+  {
+    std::ofstream OutFile(TempFilename, std::ios::binary | std::ios::trunc);
+    if (!OutFile.is_open())
+    {
+      return;
+    }
+    WriteValue<uint32_t>(OutFile, QueryCacheMagic);
+    WriteValue<uint64_t>(OutFile, RecordingSize);
+    WriteValue<int64_t>(OutFile, RecordingTime);
+    WriteValue<uint32_t>(OutFile, static_cast<uint32_t>(Results.size()));
+    for (auto &Entry : Results)
+    {
+      WriteCacheString(OutFile, Entry.first);
+      WriteCacheString(OutFile, Entry.second);
+    }
+    if (!OutFile)
+    {
+      OutFile.close();
+      std::remove(TempFilename.c_str());
+      return;
+    }
+  }
+  std::remove(CacheFilename.c_str());
+  if (std::rename(TempFilename.c_str(), CacheFilename.c_str()) != 0)
+  {
+    std::remove(TempFilename.c_str());
+  }
+}
@@ -0,0 +1,37 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+// Results of the queries of a recorded file, saved in a file next to it
+// ("<recording>.query") so the same query does not parse the recording again.
+// The cache is discarded when the size or the date of the recording change.
+class CarlaRecorderQueryCache
+{
+
+public:
+
+  // load the cache of the recorded file
+  void Load(const std::string &Filename);
+
+  bool Find(const std::string &Key, std::string &Result) const;
+
+  // add the result and save the cache (failures are ignored, the cache is
+  // just not used)
+  void Save(const std::string &Key, const std::string &Result);
+
+private:
+
+  bool GetFileStamp(const std::string &Filename, uint64_t &Size, int64_t &Time) const;
+
+  std::string CacheFilename;
+  uint64_t RecordingSize = 0u;
+  int64_t RecordingTime = 0;
+  std::unordered_map<std::string, std::string> Results;
+};
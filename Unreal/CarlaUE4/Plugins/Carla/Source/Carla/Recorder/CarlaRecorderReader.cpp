@@ -0,0 +1,238 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaRecorder.h"
+#include "CarlaRecorderReader.h"
+#include "CarlaRecorderWriter.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/Lz4.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <algorithm>
+#include <cstring>
+
+template <typename T>
+static bool ReadRaw(std::filebuf &File, T &Value)
+{
+  return File.sgetn(reinterpret_cast<char *>(&Value), sizeof(T)) == sizeof(T);
+}
+
+bool CarlaRecorderInputBuffer::Open(const std::string &Filename)
+{
+  Close();
+  if (File.open(Filename, std::ios::in | std::ios::binary) == nullptr)
+  {
+    return false;
+  }
+
+  // check for the magic number of compressed files
+  uint32_t Magic = 0u;
+  bCompressed = ReadRaw(File, Magic) && (Magic == CarlaRecorderCompressedFormat::Magic);
+  if (bCompressed)
+  {
+    if (!ReadBlockTable())
+    {
+      UE_LOG(LogCarla, Warning, TEXT("Recorder file %s is compressed but its block table is invalid"), UTF8_TO_TCHAR(Filename.c_str()));
+      Close();
+      return false;
+    }
+  }
+  else
+  {
+    Size = static_cast<uint64_t>(File.pubseekoff(0, std::ios::end, std::ios::in));
+  }
+  Load(0u);
+  return true;
+}
+
+void CarlaRecorderInputBuffer::Close(void)
+{
+  if (File.is_open())
+  {
+    File.close();
+  }
+  bCompressed = false;
+  Size = 0u;
+  BlockOffsets.clear();
+  BlockDataOffsets.clear();
+  Data.clear();
+  DataOffset = 0u;
+  setg(nullptr, nullptr, nullptr);
+}
+
+bool CarlaRecorderInputBuffer::ReadBlockTable(void)
+{
+  using Format = CarlaRecorderCompressedFormat;
+  uint64_t FileSize = static_cast<uint64_t>(File.pubseekoff(0, std::ios::end, std::ios::in));
+  if (FileSize < Format::HeaderSize + Format::TrailerSize)
+  {
+    return false;
+  }
+
+  // trailer
+  uint64_t TableOffset = 0u;
+  uint32_t Total = 0u;
+  uint32_t Magic = 0u;
+  File.pubseekpos(FileSize - Format::TrailerSize, std::ios::in);
+  if (!ReadRaw(File, TableOffset) ||
+      !ReadRaw(File, Total) ||
+      !ReadRaw(File, Size) ||
+      !ReadRaw(File, Magic) ||
+      Magic != Format::Magic ||
+      TableOffset + Total * 2u * sizeof(uint64_t) + Format::TrailerSize != FileSize)
+  {
+    return false;
+  }
+
+  // table
+  BlockOffsets.resize(Total);
+  BlockDataOffsets.resize(Total);
+  File.pubseekpos(TableOffset, std::ios::in);
+  for (uint32_t i = 0u; i < Total; ++i)
+  {
+    if (!ReadRaw(File, BlockOffsets[i]) || !ReadRaw(File, BlockDataOffsets[i]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CarlaRecorderInputBuffer::Load(uint64_t Position)
+{
+  Data.clear();
+  DataOffset = std::min(Position, Size);
+  if (Position >= Size)
+  {
+    setg(nullptr, nullptr, nullptr);
+    return false;
+  }
+
+  if (!bCompressed)
+  {
+    Data.resize(static_cast<size_t>(std::min<uint64_t>(PlainBlockSize, Size - Position)));
+    File.pubseekpos(Position, std::ios::in);
+    Data.resize(static_cast<size_t>(File.sgetn(Data.data(), Data.size())));
+  }
+  else
+  {
+    // last block starting before the position
+    auto It = std::upper_bound(BlockDataOffsets.begin(), BlockDataOffsets.end(), Position);
+    if (It == BlockDataOffsets.begin())
+    {
+      setg(nullptr, nullptr, nullptr);
+      return false;
+    }
+    size_t Block = static_cast<size_t>(std::distance(BlockDataOffsets.begin(), It)) - 1u;
+    uint32_t CompressedSize = 0u, BlockSize = 0u;
+    File.pubseekpos(BlockOffsets[Block], std::ios::in);
+    if (ReadRaw(File, CompressedSize) && ReadRaw(File, BlockSize))
+    {
+      DataOffset = BlockDataOffsets[Block];
+      Data.resize(BlockSize);
+      if (CompressedSize == BlockSize)
+      {
+        // stored as is
+        Data.resize(static_cast<size_t>(File.sgetn(Data.data(), BlockSize)));
+      }
+      else
+      {
+        Compressed.resize(CompressedSize);
+        bool bDone =
+            File.sgetn(Compressed.data(), CompressedSize) == CompressedSize &&
+            carla::Lz4::Decompress(
+                reinterpret_cast<const unsigned char *>(Compressed.data()),
+                CompressedSize,
+                reinterpret_cast<unsigned char *>(Data.data()),
+                BlockSize);
+        if (!bDone)
+        {
+          UE_LOG(LogCarla, Warning, TEXT("Recorder file block %u is corrupt"), static_cast<uint32>(Block));
+          Data.clear();
+        }
+      }
+    }
+  }
+
+  if (Data.empty() || DataOffset + Data.size() <= Position)
+  {
+    Data.clear();
+    DataOffset = Position;
+    setg(nullptr, nullptr, nullptr);
+    return false;
+  }
+  char *Begin = Data.data();
+  setg(Begin, Begin + (Position - DataOffset), Begin + Data.size());
+  return true;
+}
+
+CarlaRecorderInputBuffer::int_type CarlaRecorderInputBuffer::underflow()
+{
+  if (gptr() != nullptr && gptr() < egptr())
+  {
+    return traits_type::to_int_type(*gptr());
+  }
+  // next data
+  uint64_t Position = DataOffset + Data.size();
+  if (!Load(Position))
+  {
+    return traits_type::eof();
+  }
+  return traits_type::to_int_type(*gptr());
+}
+
+CarlaRecorderInputBuffer::pos_type CarlaRecorderInputBuffer::seekoff(
+    off_type Offset,
+    std::ios_base::seekdir Dir,
+    std::ios_base::openmode Which)
+{
+  int64_t Position;
+  switch (Dir)
+  {
+    case std::ios_base::beg:
+      Position = Offset;
+      break;
+    case std::ios_base::cur:
+    {
+      uint64_t Current = DataOffset + (gptr() != nullptr ? static_cast<uint64_t>(gptr() - eback()) : Data.size());
+      Position = static_cast<int64_t>(Current) + Offset;
+      break;
+    }
+    default:
+      Position = static_cast<int64_t>(Size) + Offset;
+      break;
+  }
+  return seekpos(pos_type(Position), Which);
+}
+
+CarlaRecorderInputBuffer::pos_type CarlaRecorderInputBuffer::seekpos(
+    pos_type Position,
+    std::ios_base::openmode Which)
+{
+  int64_t Target = static_cast<int64_t>(Position);
+  if (!(Which & std::ios_base::in) || !File.is_open() || Target < 0 || static_cast<uint64_t>(Target) > Size)
+  {
+    return pos_type(off_type(-1));
+  }
+  uint64_t NewPosition = static_cast<uint64_t>(Target);
+
+  // inside the data already loaded
+  if (!Data.empty() && NewPosition >= DataOffset && NewPosition < DataOffset + Data.size())
+  {
+    char *Begin = Data.data();
+    setg(Begin, Begin + (NewPosition - DataOffset), Begin + Data.size());
+    return Position;
+  }
+
+  if (!Load(NewPosition))
+  {
+    // at the end, the next read fails
+    Data.clear();
+    DataOffset = NewPosition;
+  }
+  return Position;
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// Reads a recorder file, compressed or not, as the uncompressed data. Seeking
+// in a compressed file decompresses only the block at the new position.
+class CarlaRecorderInputBuffer : public std::streambuf
+{
+
+public:
+
+  bool Open(const std::string &Filename);
+
+  bool IsOpen(void) const
+  {
+    return File.is_open();
+  }
+
+  void Close(void);
+
+  bool IsCompressed(void) const
+  {
+    return bCompressed;
+  }
+
+protected:
+
+  int_type underflow() override;
+
+  pos_type seekoff(off_type Offset, std::ios_base::seekdir Dir, std::ios_base::openmode Which) override;
+
+  pos_type seekpos(pos_type Position, std::ios_base::openmode Which) override;
+
+private:
+
+  // size of the reads of uncompressed files
+  static constexpr size_t PlainBlockSize = 64u * 1024u;
+
+  bool ReadBlockTable(void);
+
+  // load the data at the position of the uncompressed data
+  bool Load(uint64_t Position);
+
+  std::filebuf File;
+  bool bCompressed = false;
+  // uncompressed size
+  uint64_t Size = 0u;
+  // compressed files
+  std::vector<uint64_t> BlockOffsets;
+  std::vector<uint64_t> BlockDataOffsets;
+  std::vector<char> Compressed;
+  // data loaded, and its position in the uncompressed data
+  std::vector<char> Data;
+  uint64_t DataOffset = 0u;
+};
+
+// Input stream over a CarlaRecorderInputBuffer.
+class CarlaRecorderInputFile : public std::istream
+{
+
+public:
+
+  CarlaRecorderInputFile() : std::istream(&Buffer) {}
+
+  bool Open(const std::string &Filename)
+  {
+    clear();
+    if (!Buffer.Open(Filename))
+    {
+      setstate(std::ios_base::failbit);
+      return false;
+    }
+    return true;
+  }
+
+  bool IsOpen(void) const
+  {
+    return Buffer.IsOpen();
+  }
+
+  void Close(void)
+  {
+    Buffer.Close();
+  }
+
+private:
+
+  CarlaRecorderInputBuffer Buffer;
+};
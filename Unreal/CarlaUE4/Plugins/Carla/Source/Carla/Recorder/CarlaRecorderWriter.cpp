@@ -0,0 +1,274 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaRecorder.h"
+#include "CarlaRecorderHelpers.h"
+#include "CarlaRecorderWriter.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/Lz4.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <algorithm>
+#include <cstring>
+
+// definitions required in C++14, the values are passed by reference
+constexpr uint32_t CarlaRecorderCompressedFormat::Magic;
+constexpr uint16_t CarlaRecorderCompressedFormat::Version;
+
+// ---------------------------------------------
+// buffer
+// ---------------------------------------------
+
+void CarlaRecorderBuffer::Reset(uint64_t Offset)
+{
+  Data.clear();
+  Current = 0u;
+  Base = Offset;
+}
+
+void CarlaRecorderBuffer::Split(uint64_t Offset, std::vector<char> &Chunk)
+{
+  size_t Count = static_cast<size_t>(std::min<uint64_t>(Offset - std::min(Offset, Base), Data.size()));
+  // the chunk takes the memory of the buffer and the buffer keeps the rest
+  Chunk.swap(Data);
+  Data.assign(Chunk.begin() + Count, Chunk.end());
+  Chunk.resize(Count);
+  Current = Current > Count ? Current - Count : 0u;
+  Base += Count;
+}
+
+std::streamsize CarlaRecorderBuffer::xsputn(const char *Source, std::streamsize Count)
+{
+  size_t Size = static_cast<size_t>(Count);
+  if (Current + Size > Data.size())
+  {
+    Data.resize(Current + Size);
+  }
+  std::memcpy(Data.data() + Current, Source, Size);
+  Current += Size;
+  return Count;
+}
+
+CarlaRecorderBuffer::int_type CarlaRecorderBuffer::overflow(int_type Char)
+{
+  if (traits_type::eq_int_type(Char, traits_type::eof()))
+  {
+    return traits_type::not_eof(Char);
+  }
+  char Value = traits_type::to_char_type(Char);
+  xsputn(&Value, 1);
+  return Char;
+}
+
+CarlaRecorderBuffer::pos_type CarlaRecorderBuffer::seekoff(
+    off_type Offset,
+    std::ios_base::seekdir Dir,
+    std::ios_base::openmode Which)
+{
+  int64_t Position;
+  switch (Dir)
+  {
+    case std::ios_base::beg:
+      Position = Offset;
+      break;
+    case std::ios_base::cur:
+      Position = static_cast<int64_t>(Base + Current) + Offset;
+      break;
+    default:
+      Position = static_cast<int64_t>(Base + Data.size()) + Offset;
+      break;
+  }
+  return seekpos(pos_type(Position), Which);
+}
+
+CarlaRecorderBuffer::pos_type CarlaRecorderBuffer::seekpos(
+    pos_type Position,
+    std::ios_base::openmode Which)
+{
+  int64_t Offset = static_cast<int64_t>(Position);
+  // only the data still in the buffer can be reached
+  if (!(Which & std::ios_base::out) ||
+      Offset < static_cast<int64_t>(Base) ||
+      Offset > static_cast<int64_t>(Base + Data.size()))
+  {
+    return pos_type(off_type(-1));
+  }
+  Current = static_cast<size_t>(Offset - static_cast<int64_t>(Base));
+  return Position;
+}
+
+// ---------------------------------------------
+// writer
+// ---------------------------------------------
+
+bool CarlaRecorderWriter::Open(const std::string &Filename, bool bCompressData)
+{
+  Close();
+
+  // the chunks are large, write them without the buffer of the stream
+  File.rdbuf()->pubsetbuf(nullptr, 0);
+  File.open(Filename, std::ios::binary);
+  if (!File.is_open())
+  {
+    return false;
+  }
+
+  bCompress = bCompressData;
+  FileOffset = 0u;
+  DataOffset = 0u;
+  BlockOffsets.clear();
+  BlockDataOffsets.clear();
+  if (bCompress)
+  {
+    WriteValue<uint32_t>(File, CarlaRecorderCompressedFormat::Magic);
+    WriteValue<uint16_t>(File, CarlaRecorderCompressedFormat::Version);
+    FileOffset = CarlaRecorderCompressedFormat::HeaderSize;
+  }
+
+  bStop = false;
+  NumberOfWaits = 0u;
+  BytesWritten = 0u;
+  Thread = std::thread([this]() { Run(); });
+  return true;
+}
+
+void CarlaRecorderWriter::Write(std::vector<char> &Chunk)
+{
+  if (Chunk.empty())
+  {
+    return;
+  }
+  std::unique_lock<std::mutex> Lock(Mutex);
+  if (Queue.size() >= MaxQueueSize)
+  {
+    ++NumberOfWaits;
+    CondVar.wait(Lock, [this]() { return Queue.size() < MaxQueueSize; });
+  }
+  Queue.emplace_back(std::move(Chunk));
+  Chunk.clear();
+  if (!FreeBuffers.empty())
+  {
+    Chunk.swap(FreeBuffers.back());
+    FreeBuffers.pop_back();
+  }
+  Lock.unlock();
+  CondVar.notify_all();
+}
+
+size_t CarlaRecorderWriter::GetAllocatedSize(void)
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  size_t Bytes = 0u;
+  for (const auto &Chunk : Queue)
+  {
+    Bytes += Chunk.capacity();
+  }
+  for (const auto &Chunk : FreeBuffers)
+  {
+    Bytes += Chunk.capacity();
+  }
+  return Bytes;
+}
+
+void CarlaRecorderWriter::Close(void)
+{
+  if (Thread.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      bStop = true;
+    }
+    CondVar.notify_all();
+    Thread.join();
+  }
+  if (File.is_open())
+  {
+    if (bCompress)
+    {
+      WriteBlockTable();
+    }
+    File.close();
+  }
+  Queue.clear();
+  FreeBuffers.clear();
+}
+
+void CarlaRecorderWriter::Run(void)
+{
+  std::unique_lock<std::mutex> Lock(Mutex);
+  for (;;)
+  {
+    CondVar.wait(Lock, [this]() { return bStop || !Queue.empty(); });
+    if (Queue.empty())
+    {
+      // stopped and nothing left to write
+      return;
+    }
+    std::vector<char> Chunk = std::move(Queue.front());
+    Queue.pop_front();
+    Lock.unlock();
+    CondVar.notify_all();
+
+    if (bCompress)
+    {
+      WriteBlock(Chunk);
+    }
+    else
+    {
+      File.write(Chunk.data(), static_cast<std::streamsize>(Chunk.size()));
+      BytesWritten += Chunk.size();
+    }
+
+    Chunk.clear();
+    Lock.lock();
+    if (FreeBuffers.size() < MaxQueueSize)
+    {
+      FreeBuffers.emplace_back(std::move(Chunk));
+    }
+  }
+}
+
+void CarlaRecorderWriter::WriteBlock(const std::vector<char> &Chunk)
+{
+  const auto *Source = reinterpret_cast<const unsigned char *>(Chunk.data());
+  uint32_t Size = static_cast<uint32_t>(Chunk.size());
+  Compressed.resize(carla::Lz4::CompressBound(Size));
+  uint32_t CompressedSize = static_cast<uint32_t>(carla::Lz4::Compress(Source, Size, Compressed.data()));
+  if (CompressedSize >= Size)
+  {
+    // store it as is
+    CompressedSize = Size;
+  }
+  else
+  {
+    Source = Compressed.data();
+  }
+
+  BlockOffsets.push_back(FileOffset);
+  BlockDataOffsets.push_back(DataOffset);
+  WriteValue<uint32_t>(File, CompressedSize);
+  WriteValue<uint32_t>(File, Size);
+  File.write(reinterpret_cast<const char *>(Source), CompressedSize);
+
+  FileOffset += CarlaRecorderCompressedFormat::BlockHeaderSize + CompressedSize;
+  DataOffset += Size;
+  BytesWritten += CarlaRecorderCompressedFormat::BlockHeaderSize + CompressedSize;
+}
+
+void CarlaRecorderWriter::WriteBlockTable(void)
+{
+  uint64_t TableOffset = FileOffset;
+  for (size_t i = 0u; i < BlockOffsets.size(); ++i)
+  {
+    WriteValue<uint64_t>(File, BlockOffsets[i]);
+    WriteValue<uint64_t>(File, BlockDataOffsets[i]);
+  }
+  WriteValue<uint64_t>(File, TableOffset);
+  WriteValue<uint32_t>(File, static_cast<uint32_t>(BlockOffsets.size()));
+  WriteValue<uint64_t>(File, DataOffset);
+  WriteValue<uint32_t>(File, CarlaRecorderCompressedFormat::Magic);
+}
@@ -0,0 +1,167 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Layout of compressed recorder files. The data is the same as the one of an
+// uncompressed file, split in blocks compressed independently:
+//
+//   uint32 magic, uint16 version
+//   blocks: uint32 compressed size, uint32 size, data (stored as is if both
+//           sizes are equal)
+//   table:  for each block uint64 offset in the file, uint64 offset in the
+//           uncompressed data
+//   uint64 offset of the table, uint32 number of blocks, uint64 uncompressed
+//   size, uint32 magic
+//
+// Offsets everywhere else (frame index...) refer to the uncompressed data.
+struct CarlaRecorderCompressedFormat
+{
+  static constexpr uint32_t Magic = 0x5A4C5243u; // "CRLZ"
+  static constexpr uint16_t Version = 1u;
+  static constexpr size_t HeaderSize = sizeof(uint32_t) + sizeof(uint16_t);
+  static constexpr size_t BlockHeaderSize = 2u * sizeof(uint32_t);
+  static constexpr size_t TrailerSize = 2u * sizeof(uint64_t) + 2u * sizeof(uint32_t);
+};
+
+// Memory buffer for the serialization of the recorder. Positions are offsets
+// in the file, so packets can seek back to update their sizes as when writing
+// to the file directly. Only the data after the last split can be updated.
+class CarlaRecorderBuffer : public std::streambuf
+{
+
+public:
+
+  // empty the buffer, the next byte goes to the given offset of the file
+  void Reset(uint64_t Offset = 0u);
+
+  // move the data before the offset to the chunk, the data after it stays in
+  // the buffer
+  void Split(uint64_t Offset, std::vector<char> &Chunk);
+
+  // move all the data to the chunk
+  void Split(std::vector<char> &Chunk)
+  {
+    Split(Base + Data.size(), Chunk);
+  }
+
+  // bytes in the buffer
+  size_t GetSize(void) const
+  {
+    return Data.size();
+  }
+
+  // offset in the file of the first byte in the buffer
+  uint64_t GetBase(void) const
+  {
+    return Base;
+  }
+
+  // bytes of memory held by the buffer
+  size_t GetAllocatedSize(void) const
+  {
+    return Data.capacity();
+  }
+
+protected:
+
+  std::streamsize xsputn(const char *Source, std::streamsize Count) override;
+
+  int_type overflow(int_type Char) override;
+
+  pos_type seekoff(off_type Offset, std::ios_base::seekdir Dir, std::ios_base::openmode Which) override;
+
+  pos_type seekpos(pos_type Position, std::ios_base::openmode Which) override;
+
+private:
+
+  std::vector<char> Data;
+  // position of the next byte in Data
+  size_t Current = 0u;
+  uint64_t Base = 0u;
+};
+
+// Writes the chunks of a recorder file from a dedicated thread, so the game
+// thread only serializes to memory. The queue is bounded, if it is full the
+// game thread waits for the disk.
+class CarlaRecorderWriter
+{
+
+public:
+
+  ~CarlaRecorderWriter()
+  {
+    Close();
+  }
+
+  // open the file, compressing the chunks in blocks if required
+  bool Open(const std::string &Filename, bool bCompress = false);
+
+  bool IsOpen(void) const
+  {
+    return Thread.joinable();
+  }
+
+  // queue the chunk to be written, the chunk is swapped by an empty buffer
+  // (with some capacity reserved if available)
+  void Write(std::vector<char> &Chunk);
+
+  // write all the queued chunks and close the file
+  void Close(void);
+
+  // times the game thread waited because the queue was full
+  uint64_t GetNumberOfWaits(void) const
+  {
+    return NumberOfWaits;
+  }
+
+  uint64_t GetBytesWritten(void) const
+  {
+    return BytesWritten;
+  }
+
+  // bytes of memory held by the queued chunks and the buffers kept for reuse
+  size_t GetAllocatedSize(void);
+
+private:
+
+  static constexpr size_t MaxQueueSize = 8u;
+
+  void Run(void);
+
+  void WriteBlock(const std::vector<char> &Chunk);
+
+  void WriteBlockTable(void);
+
+  std::ofstream File;
+  bool bCompress = false;
+  // only used by the thread of the writer
+  std::vector<unsigned char> Compressed;
+  std::vector<uint64_t> BlockOffsets;
+  std::vector<uint64_t> BlockDataOffsets;
+  uint64_t FileOffset = 0u;
+  uint64_t DataOffset = 0u;
+  std::thread Thread;
+  std::mutex Mutex;
+  std::condition_variable CondVar;
+  std::deque<std::vector<char>> Queue;
+  // buffers already written, to reuse their memory
+  std::vector<std::vector<char>> FreeBuffers;
+  bool bStop = false;
+  std::atomic<uint64_t> NumberOfWaits { 0u };
+  std::atomic<uint64_t> BytesWritten { 0u };
+};
@@ -7,6 +7,7 @@
 #include "CarlaReplayer.h"
 #include "CarlaRecorder.h"
 
+#include <algorithm>
 #include <ctime>
 #include <sstream>
 
@@ -29,7 +30,7 @@ void CarlaReplayer::Stop(bool bKeepActors)
     Helper.ProcessReplayerFinish(bKeepActors);
   }
 
-  File.close();
+  File.Close();
 }
 
 bool CarlaReplayer::ReadHeader()
@@ -67,11 +68,19 @@ void CarlaReplayer::Rewind(void)
 
   // read geneal Info
   RecInfo.Read(File);
+
+  // read the frame index at the end of the file, if any
+  FrameIndex.Read(File);
 }
 
 // read last frame in File and return the Total time recorded
 double CarlaReplayer::GetTotalTime(void)
 {
+  if (!FrameIndex.IsEmpty())
+  {
+    return FrameIndex.GetTotalTime();
+  }
+
   std::streampos Current = File.tellg();
 
   // parse only frames
@@ -117,8 +126,8 @@ std::string CarlaReplayer::ReplayFile(std::string Filename, double TimeStart, do
   Info << "Replaying File: " << Filename2 << std::endl;
 
   // try to open
-  File.open(Filename2, std::ios::binary);
-  if (!File.is_open())
+  File.Open(Filename2);
+  if (!File.IsOpen())
   {
     Info << "File " << Filename2 << " not found on server\n";
     Stop();
@@ -178,7 +187,7 @@ std::string CarlaReplayer::ReplayFile(std::string Filename, double TimeStart, do
   if (!Autoplay.Enabled)
   {
     // process all events until the time
-    ProcessToTime(TimeStart, true);
+    SeekToTime(TimeStart);
     // mark as enabled
     Enabled = true;
   }
@@ -203,8 +212,8 @@ void CarlaReplayer::CheckPlayAfterMapLoaded(void)
   }
 
   // try to open
-  File.open(Autoplay.Filename, std::ios::binary);
-  if (!File.is_open())
+  File.Open(Autoplay.Filename);
+  if (!File.IsOpen())
   {
     return;
   }
@@ -237,7 +246,7 @@ void CarlaReplayer::CheckPlayAfterMapLoaded(void)
   TimeFactor = Autoplay.TimeFactor;
 
   // process all events until the time
-  ProcessToTime(TimeStart, true);
+  SeekToTime(TimeStart);
 
   // mark as enabled
   Enabled = true;
@@ -248,7 +257,6 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
   double Per = 0.0f;
   double NewTime = CurrentTime + Time;
   bool bFrameFound = false;
-  bool bExitAtNextFrame = false;
   bool bExitLoop = false;
 
   // check if we are in the right frame
@@ -266,102 +274,246 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
     ReadHeader();
 
     // check for a frame packet
+    if (Header.Id == static_cast<char>(CarlaRecorderPacketId::FrameStart))
+    {
+      // only read if we are not in the right frame
+      Frame.Read(File);
+      // check if target time is in this frame
+      if (NewTime < Frame.Elapsed + Frame.DurationThis)
+      {
+        Per = (NewTime - Frame.Elapsed) / Frame.DurationThis;
+        bFrameFound = true;
+      }
+    }
+    else
+    {
+      bExitLoop = ProcessPacket(bFrameFound, IsFirstTime);
+    }
+  }
+
+  // update all positions
+  if (Enabled && bFrameFound)
+  {
+    UpdatePositions(Per, Time);
+  }
+
+  // save current time
+  CurrentTime = NewTime;
+
+  // stop replay?
+  if (CurrentTime >= TimeToStop)
+  {
+    // keep actors in scene and let them continue with autopilot
+    Stop(true);
+  }
+}
+
+void CarlaReplayer::ProcessNextFrame(void)
+{
+  bool bFrameFound = false;
+  bool bExitLoop = false;
+
+  // process the packets until the end of the next frame
+  while (!File.eof() && !bExitLoop)
+  {
+    // get header
+    if (!ReadHeader())
+    {
+      break;
+    }
+
+    if (Header.Id == static_cast<char>(CarlaRecorderPacketId::FrameStart))
+    {
+      Frame.Read(File);
+      bFrameFound = true;
+    }
+    else
+    {
+      bExitLoop = ProcessPacket(bFrameFound, false);
+    }
+  }
+
+  // move the actors to the positions of the frame
+  if (Enabled && bFrameFound)
+  {
+    UpdatePositions(0.0, Frame.DurationThis);
+  }
+
+  // the time is the one of the frame, to not drift from the recording
+  CurrentTime = Frame.Elapsed;
+
+  // stop replay?
+  if (!bFrameFound || CurrentTime >= TimeToStop)
+  {
+    // keep actors in scene and let them continue with autopilot
+    Stop(true);
+  }
+}
+
+bool CarlaReplayer::ProcessPacket(bool bFrameFound, bool IsFirstTime)
+{
+  switch (Header.Id)
+  {
+    // events add
+    case static_cast<char>(CarlaRecorderPacketId::EventAdd):
+      ProcessEventsAdd();
+      break;
+
+    // events del
+    case static_cast<char>(CarlaRecorderPacketId::EventDel):
+      ProcessEventsDel();
+      break;
+
+    // events parent
+    case static_cast<char>(CarlaRecorderPacketId::EventParent):
+      ProcessEventsParent();
+      break;
+
+    // collisions
+    case static_cast<char>(CarlaRecorderPacketId::Collision):
+      SkipPacket();
+      break;
+
+    // positions
+    case static_cast<char>(CarlaRecorderPacketId::Position):
+      if (bFrameFound)
+        ProcessPositions(IsFirstTime);
+      else
+        SkipPacket();
+      break;
+
+    // states
+    case static_cast<char>(CarlaRecorderPacketId::State):
+      if (bFrameFound)
+        ProcessStates();
+      else
+        SkipPacket();
+      break;
+
+    // vehicle animation
+    case static_cast<char>(CarlaRecorderPacketId::AnimVehicle):
+      if (bFrameFound)
+        ProcessAnimVehicle();
+      else
+        SkipPacket();
+      break;
+
+    // walker animation
+    case static_cast<char>(CarlaRecorderPacketId::AnimWalker):
+      if (bFrameFound)
+        ProcessAnimWalker();
+      else
+        SkipPacket();
+      break;
+
+    // frame end
+    case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
+      if (bFrameFound)
+        return true;
+      break;
+
+    // unknown packet, just skip
+    default:
+      // skip packet
+      SkipPacket();
+      break;
+  }
+  return false;
+}
+
+void CarlaReplayer::SeekToTime(double Time)
+{
+  if (FrameIndex.IsEmpty())
+  {
+    // read all the packets from the start
+    ProcessToTime(Time, true);
+    return;
+  }
+
+  // the actors of the previous frames need to exist: start from the last key
+  // frame before the target, if any, and replay only the frames with events
+  size_t Target = FrameIndex.FindFrame(Time);
+  size_t First = 0;
+  for (size_t i = Target; i > 0; --i)
+  {
+    const CarlaRecorderFrameIndexEntry &Entry = FrameIndex.GetFrame(i - 1);
+    if (Entry.IsKeyFrame())
+    {
+      File.clear();
+      File.seekg(Entry.Offset, std::ios::beg);
+      ProcessFrameEvents(true);
+      // the key frame already includes the events of its frame
+      First = i;
+      break;
+    }
+  }
+  for (size_t i = First; i < Target; ++i)
+  {
+    const CarlaRecorderFrameIndexEntry &Entry = FrameIndex.GetFrame(i);
+    if (Entry.HasEvents())
+    {
+      File.clear();
+      File.seekg(Entry.Offset, std::ios::beg);
+      ProcessFrameEvents();
+    }
+  }
+
+  // jump to the frame
+  File.clear();
+  File.seekg(FrameIndex.GetFrame(Target).Offset, std::ios::beg);
+  ProcessToTime(Time, true);
+}
+
+void CarlaReplayer::ProcessFrameEvents(bool bOnlyKeyFrame)
+{
+  while (File && ReadHeader())
+  {
     switch (Header.Id)
     {
-      // frame
-      case static_cast<char>(CarlaRecorderPacketId::FrameStart):
-        // only read if we are not in the right frame
-        Frame.Read(File);
-        // check if target time is in this frame
-        if (NewTime < Frame.Elapsed + Frame.DurationThis)
+      // key frame
+      case static_cast<char>(CarlaRecorderPacketId::KeyFrame):
+        if (bOnlyKeyFrame)
         {
-          Per = (NewTime - Frame.Elapsed) / Frame.DurationThis;
-          bFrameFound = true;
+          ProcessKeyFrame();
+          return;
         }
+        SkipPacket();
         break;
 
       // events add
       case static_cast<char>(CarlaRecorderPacketId::EventAdd):
-        ProcessEventsAdd();
+        if (bOnlyKeyFrame)
+          SkipPacket();
+        else
+          ProcessEventsAdd();
         break;
 
       // events del
       case static_cast<char>(CarlaRecorderPacketId::EventDel):
-        ProcessEventsDel();
+        if (bOnlyKeyFrame)
+          SkipPacket();
+        else
+          ProcessEventsDel();
         break;
 
       // events parent
       case static_cast<char>(CarlaRecorderPacketId::EventParent):
-        ProcessEventsParent();
-        break;
-
-      // collisions
-      case static_cast<char>(CarlaRecorderPacketId::Collision):
-        SkipPacket();
-        break;
-
-      // positions
-      case static_cast<char>(CarlaRecorderPacketId::Position):
-        if (bFrameFound)
-          ProcessPositions(IsFirstTime);
-        else
+        if (bOnlyKeyFrame)
           SkipPacket();
-        break;
-
-      // states
-      case static_cast<char>(CarlaRecorderPacketId::State):
-        if (bFrameFound)
-          ProcessStates();
         else
-          SkipPacket();
-        break;
-
-      // vehicle animation
-      case static_cast<char>(CarlaRecorderPacketId::AnimVehicle):
-        if (bFrameFound)
-          ProcessAnimVehicle();
-        else
-          SkipPacket();
-        break;
-
-      // walker animation
-      case static_cast<char>(CarlaRecorderPacketId::AnimWalker):
-        if (bFrameFound)
-          ProcessAnimWalker();
-        else
-          SkipPacket();
+          ProcessEventsParent();
         break;
 
       // frame end
       case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
-        if (bFrameFound)
-          bExitLoop = true;
-        break;
+        return;
 
-      // unknown packet, just skip
+      // the frame start and any other packet
       default:
-        // skip packet
         SkipPacket();
         break;
-
     }
   }
-
-  // update all positions
-  if (Enabled && bFrameFound)
-  {
-    UpdatePositions(Per, Time);
-  }
-
-  // save current time
-  CurrentTime = NewTime;
-
-  // stop replay?
-  if (CurrentTime >= TimeToStop)
-  {
-    // keep actors in scene and let them continue with autopilot
-    Stop(true);
-  }
 }
 
 void CarlaReplayer::ProcessEventsAdd(void)
@@ -374,33 +526,37 @@ void CarlaReplayer::ProcessEventsAdd(void)
   for (i = 0; i < Total; ++i)
   {
     EventAdd.Read(File);
+    ProcessEventAdd(EventAdd);
+  }
+}
 
-    // auto Result = CallbackEventAdd(
-    auto Result = Helper.ProcessReplayerEventAdd(
-        EventAdd.Location,
-        EventAdd.Rotation,
-        std::move(EventAdd.Description),
-        EventAdd.DatabaseId);
-
-    switch (Result.first)
-    {
-      // actor not created
-      case 0:
-        UE_LOG(LogCarla, Log, TEXT("actor could not be created"));
-        break;
+void CarlaReplayer::ProcessEventAdd(CarlaRecorderEventAdd &EventAdd)
+{
+  // auto Result = CallbackEventAdd(
+  auto Result = Helper.ProcessReplayerEventAdd(
+      EventAdd.Location,
+      EventAdd.Rotation,
+      std::move(EventAdd.Description),
+      EventAdd.DatabaseId);
+
+  switch (Result.first)
+  {
+    // actor not created
+    case 0:
+      UE_LOG(LogCarla, Log, TEXT("actor could not be created"));
+      break;
 
-      // actor created but with different id
-      case 1:
-        // mapping id (recorded Id is a new Id in replayer)
-        MappedId[EventAdd.DatabaseId] = Result.second;
-        break;
+    // actor created but with different id
+    case 1:
+      // mapping id (recorded Id is a new Id in replayer)
+      MappedId[EventAdd.DatabaseId] = Result.second;
+      break;
 
-      // actor reused from existing
-      case 2:
-        // mapping id (say desired Id is mapped to what)
-        MappedId[EventAdd.DatabaseId] = Result.second;
-        break;
-    }
+    // actor reused from existing
+    case 2:
+      // mapping id (say desired Id is mapped to what)
+      MappedId[EventAdd.DatabaseId] = Result.second;
+      break;
   }
 }
 
@@ -414,8 +570,19 @@ void CarlaReplayer::ProcessEventsDel(void)
   for (i = 0; i < Total; ++i)
   {
     EventDel.Read(File);
-    Helper.ProcessReplayerEventDel(MappedId[EventDel.DatabaseId]);
+    const uint32_t Id = MappedId[EventDel.DatabaseId];
+    Helper.ProcessReplayerEventDel(Id);
     MappedId.erase(EventDel.DatabaseId);
+
+    // forget its positions
+    auto It = std::lower_bound(Tracks.begin(), Tracks.end(), Id, [](const PositionTrack &Track, uint32_t Value)
+    {
+      return Track.Last.DatabaseId < Value;
+    });
+    if (It != Tracks.end() && It->Last.DatabaseId == Id)
+    {
+      Tracks.erase(It);
+    }
   }
 }
 
@@ -430,7 +597,29 @@ void CarlaReplayer::ProcessEventsParent(void)
   for (i = 0; i < Total; ++i)
   {
     EventParent.Read(File);
-    Helper.ProcessReplayerEventParent(MappedId[EventParent.DatabaseId], MappedId[EventParent.DatabaseIdParent]);
+    ProcessEventParent(EventParent);
+  }
+}
+
+void CarlaReplayer::ProcessEventParent(const CarlaRecorderEventParent &EventParent)
+{
+  Helper.ProcessReplayerEventParent(MappedId[EventParent.DatabaseId], MappedId[EventParent.DatabaseIdParent]);
+}
+
+void CarlaReplayer::ProcessKeyFrame(void)
+{
+  CarlaRecorderKeyFrame KeyFrame;
+  KeyFrame.Read(File);
+
+  // create all the actors, then attach them
+  for (const CarlaRecorderEventAdd &Actor : KeyFrame.GetActors())
+  {
+    CarlaRecorderEventAdd EventAdd = Actor;
+    ProcessEventAdd(EventAdd);
+  }
+  for (const CarlaRecorderEventParent &Parent : KeyFrame.GetParents())
+  {
+    ProcessEventParent(Parent);
   }
 }
 
@@ -493,9 +682,6 @@ void CarlaReplayer::ProcessPositions(bool IsFirstTime)
 {
   uint16_t i, Total;
 
-  // save current as previous
-  PrevPos = std::move(CurrPos);
-
   // read all positions
   ReadValue<uint16_t>(File, Total);
   CurrPos.clear();
@@ -515,24 +701,56 @@ void CarlaReplayer::ProcessPositions(bool IsFirstTime)
     CurrPos.push_back(std::move(Pos));
   }
 
+  // sorted by id to match them with the previous ones
+  std::sort(CurrPos.begin(), CurrPos.end(), [](const CarlaRecorderPosition &A, const CarlaRecorderPosition &B)
+  {
+    return A.DatabaseId < B.DatabaseId;
+  });
+
   // check to copy positions the first time
   if (IsFirstTime)
   {
-    PrevPos.clear();
+    Tracks.clear();
   }
+  ++PositionsPacket;
+
+  // merge the positions with the tracks, both are sorted by id
+  NewTracks.clear();
+  NewTracks.reserve(Tracks.size() + CurrPos.size());
+  size_t T = 0u;
+  for (const CarlaRecorderPosition &Pos : CurrPos)
+  {
+    // actors not sampled in this frame
+    while (T < Tracks.size() && Tracks[T].Last.DatabaseId < Pos.DatabaseId)
+    {
+      NewTracks.push_back(Tracks[T++]);
+    }
+
+    PositionTrack Track;
+    Track.bHasBefore = (T < Tracks.size() && Tracks[T].Last.DatabaseId == Pos.DatabaseId);
+    if (Track.bHasBefore)
+    {
+      Track.Before = Tracks[T].Last;
+      Track.BeforeTime = Tracks[T].LastTime;
+      Track.BeforePacket = Tracks[T].LastPacket;
+      ++T;
+    }
+    Track.Last = Pos;
+    Track.LastTime = Frame.Elapsed;
+    Track.LastPacket = PositionsPacket;
+    NewTracks.push_back(Track);
+  }
+  while (T < Tracks.size())
+  {
+    NewTracks.push_back(Tracks[T++]);
+  }
+  std::swap(Tracks, NewTracks);
 }
 
 void CarlaReplayer::UpdatePositions(double Per, double DeltaTime)
 {
-  unsigned int i;
   uint32_t NewFollowId = 0;
-  std::unordered_map<int, int> TempMap;
-
-  // map the id of all previous positions to its index
-  for (i = 0; i < PrevPos.size(); ++i)
-  {
-    TempMap[PrevPos[i].DatabaseId] = i;
-  }
+  bool bFollowFound = false;
 
   // get the Id of the actor to follow
   if (FollowId != 0)
@@ -544,45 +762,71 @@ void CarlaReplayer::UpdatePositions(double Per, double DeltaTime)
     }
   }
 
-  // go through each actor and update
-  for (i = 0; i < CurrPos.size(); ++i)
+  // time shown, one frame behind the frame read as when interpolating
+  // between the last two frames
+  const double Time = Frame.Elapsed + (Per - 1.0) * Frame.DurationThis;
+
+  Transforms.clear();
+  Transforms.reserve(Tracks.size());
+  for (const PositionTrack &Track : Tracks)
   {
-    // check if exist a previous position
-    auto Result = TempMap.find(CurrPos[i].DatabaseId);
-    if (Result != TempMap.end())
+    // sampled in this frame, and also in the previous one
+    const bool bSampled = (Track.LastPacket == PositionsPacket);
+    const bool bEveryFrame = bSampled && Track.bHasBefore && Track.BeforePacket + 1u == Track.LastPacket;
+
+    FVector Location;
+    FRotator Rotation;
+    if (!bInterpolate || bFrameByFrame || !Track.bHasBefore || (!bEveryFrame && TimeFactor >= 2.0))
     {
-      // check if time factor is high
-      if (TimeFactor >= 2.0)
-        // assign first position
-        InterpolatePosition(PrevPos[Result->second], CurrPos[i], 0.0, DeltaTime);
-      else
-        // interpolate
-        InterpolatePosition(PrevPos[Result->second], CurrPos[i], Per, DeltaTime);
+      // the actors not sampled in this frame are already there
+      if (!bSampled)
+      {
+        continue;
+      }
+      // assign last position (we don't have previous one, or we snap to it)
+      Location = Track.Last.Location;
+      Rotation = FRotator::MakeFromEuler(Track.Last.Rotation);
+    }
+    else if (!bEveryFrame)
+    {
+      // sampled only in some frames, interpolate between the last two samples
+      // and extrapolate from them until the next one is read
+      double Alpha = 1.0;
+      const double Interval = Track.LastTime - Track.BeforeTime;
+      if (Interval > 0.0)
+      {
+        Alpha = FMath::Clamp((Time - Track.BeforeTime) / Interval, 0.0, 2.0);
+      }
+      Location = FMath::Lerp(Track.Before.Location, Track.Last.Location, static_cast<float>(Alpha));
+      Rotation = FMath::Lerp(FRotator::MakeFromEuler(Track.Before.Rotation), FRotator::MakeFromEuler(Track.Last.Rotation), static_cast<float>(Alpha));
+    }
+    else if (TimeFactor >= 2.0)
+    {
+      // time factor is high, assign first position
+      Location = Track.Before.Location;
+      Rotation = FRotator::MakeFromEuler(Track.Before.Rotation);
     }
     else
     {
-      // assign last position (we don't have previous one)
-      InterpolatePosition(CurrPos[i], CurrPos[i], 0.0, DeltaTime);
+      // interpolate
+      Location = FMath::Lerp(Track.Before.Location, Track.Last.Location, Per);
+      Rotation = FMath::Lerp(FRotator::MakeFromEuler(Track.Before.Rotation), FRotator::MakeFromEuler(Track.Last.Rotation), Per);
     }
+    Transforms.push_back({ Track.Last.DatabaseId, FTransform(Rotation, Location, FVector(1, 1, 1)) });
 
-    // move the camera to follow this actor if required
-    if (NewFollowId != 0)
+    if (NewFollowId != 0 && NewFollowId == Track.Last.DatabaseId)
     {
-      if (NewFollowId == CurrPos[i].DatabaseId)
-        Helper.SetCameraPosition(NewFollowId, FVector(-1000, 0, 500), FQuat::MakeFromEuler({0, -25, 0}));
+      bFollowFound = true;
     }
   }
-}
 
-// interpolate a position (transform, velocity...)
-void CarlaReplayer::InterpolatePosition(
-    const CarlaRecorderPosition &Pos1,
-    const CarlaRecorderPosition &Pos2,
-    double Per,
-    double DeltaTime)
-{
-  // call the callback
-  Helper.ProcessReplayerPosition(Pos1, Pos2, Per, DeltaTime);
+  Helper.ProcessReplayerTransforms(Transforms);
+
+  // move the camera to follow this actor if required
+  if (bFollowFound)
+  {
+    Helper.SetCameraPosition(NewFollowId, FVector(-1000, 0, 500), FQuat::MakeFromEuler({0, -25, 0}));
+  }
 }
 
 // tick for the replayer
@@ -591,6 +835,9 @@ void CarlaReplayer::Tick(float Delta)
   // check if there are events to process
   if (Enabled)
   {
-    ProcessToTime(Delta * TimeFactor, false);
+    if (bFrameByFrame)
+      ProcessNextFrame();
+    else
+      ProcessToTime(Delta * TimeFactor, false);
   }
 }
@@ -12,12 +12,15 @@
 
 #include <functional>
 #include "CarlaRecorderInfo.h"
+#include "CarlaRecorderFrameIndex.h"
 #include "CarlaRecorderFrames.h"
+#include "CarlaRecorderKeyFrame.h"
 #include "CarlaRecorderEventAdd.h"
 #include "CarlaRecorderEventDel.h"
 #include "CarlaRecorderEventParent.h"
 #include "CarlaRecorderCollision.h"
 #include "CarlaRecorderPosition.h"
+#include "CarlaRecorderReader.h"
 #include "CarlaRecorderState.h"
 #include "CarlaRecorderHelpers.h"
 #include "CarlaReplayerHelper.h"
@@ -78,6 +81,27 @@ public:
     TimeFactor = NewTimeFactor;
   }
 
+  // interpolate the positions between recorded frames, when disabled the
+  // actors snap to the positions of the last recorded frame
+  void SetInterpolation(bool bEnabled)
+  {
+    bInterpolate = bEnabled;
+  }
+
+  // advance exactly one recorded frame on each tick, without interpolation,
+  // instead of following the time of the simulation
+  void SetFrameByFrame(bool bEnabled)
+  {
+    bFrameByFrame = bEnabled;
+  }
+
+  // id of the actor that replays the recorded actor, 0 if there is none
+  uint32_t GetReplayedActorId(uint32_t RecordedId) const
+  {
+    auto It = MappedId.find(RecordedId);
+    return It != MappedId.end() ? It->second : 0u;
+  }
+
   // check if after a map is loaded, we need to replay
   void CheckPlayAfterMapLoaded(void);
 
@@ -89,13 +113,32 @@ private:
   bool Enabled;
   UCarlaEpisode *Episode = nullptr;
   // binary file reader
-  std::ifstream File;
+  CarlaRecorderInputFile File;
   Header Header;
   CarlaRecorderInfo RecInfo;
   CarlaRecorderFrame Frame;
-  // positions (to be able to interpolate)
+  // index of frames (empty if the file has none)
+  CarlaRecorderFrameIndex FrameIndex;
+  // last two positions read of each actor (to be able to interpolate), the
+  // recorder can sample some actors only in some of the frames
+  struct PositionTrack
+  {
+    CarlaRecorderPosition Last;
+    CarlaRecorderPosition Before;
+    double LastTime;
+    double BeforeTime;
+    uint64_t LastPacket;
+    uint64_t BeforePacket;
+    bool bHasBefore;
+  };
+  // positions of the current frame, and the tracks of the actors, sorted by id
   std::vector<CarlaRecorderPosition> CurrPos;
-  std::vector<CarlaRecorderPosition> PrevPos;
+  std::vector<PositionTrack> Tracks;
+  std::vector<PositionTrack> NewTracks;
+  // number of position packets read
+  uint64_t PositionsPacket { 0u };
+  // transforms applied on each tick (kept to reuse the memory)
+  std::vector<CarlaReplayerHelper::ActorTransform> Transforms;
   // mapping id
   std::unordered_map<uint32_t, uint32_t> MappedId;
   // times
@@ -108,6 +151,8 @@ private:
   uint32_t FollowId;
   // speed (time factor)
   double TimeFactor { 1.0 };
+  bool bInterpolate { true };
+  bool bFrameByFrame { false };
 
   // utils
   bool ReadHeader();
@@ -121,9 +166,27 @@ private:
   // processing packets
   void ProcessToTime(double Time, bool IsFirstTime = false);
 
+  // process the packets until the end of the next frame
+  void ProcessNextFrame(void);
+
+  // process the packet of the current header inside a frame, returns true at
+  // the end of the frame
+  bool ProcessPacket(bool bFrameFound, bool IsFirstTime);
+
+  // go from the start of the file to the time, using the frame index if any
+  void SeekToTime(double Time);
+
+  // process only the events of the frame at the current position, or only
+  // its key frame
+  void ProcessFrameEvents(bool bOnlyKeyFrame = false);
+
   void ProcessEventsAdd(void);
   void ProcessEventsDel(void);
   void ProcessEventsParent(void);
+  void ProcessKeyFrame(void);
+
+  void ProcessEventAdd(CarlaRecorderEventAdd &EventAdd);
+  void ProcessEventParent(const CarlaRecorderEventParent &EventParent);
 
   void ProcessPositions(bool IsFirstTime = false);
 
@@ -134,6 +197,4 @@ private:
 
   // positions
   void UpdatePositions(double Per, double DeltaTime);
-
-  void InterpolatePosition(const CarlaRecorderPosition &Start, const CarlaRecorderPosition &End, double Per, double DeltaTime);
 };
@@ -222,33 +222,18 @@ bool CarlaReplayerHelper::ProcessReplayerEventParent(uint32_t ChildId, uint32_t
 }
 
 // reposition actors
-bool CarlaReplayerHelper::ProcessReplayerPosition(CarlaRecorderPosition Pos1, CarlaRecorderPosition Pos2, double Per, double DeltaTime)
+void CarlaReplayerHelper::ProcessReplayerTransforms(const std::vector<ActorTransform> &Transforms)
 {
   check(Episode != nullptr);
-  AActor *Actor = Episode->GetActorRegistry().Find(Pos1.DatabaseId).GetActor();
-  FVector Location;
-  FRotator Rotation;
-  if (Actor  && !Actor->IsPendingKill())
+  const FActorRegistry &Registry = Episode->GetActorRegistry();
+  for (const ActorTransform &Item : Transforms)
   {
-    // check to assign first position or interpolate between both
-    if (Per == 0.0)
+    AActor *Actor = Registry.Find(Item.DatabaseId).GetActor();
+    if (Actor && !Actor->IsPendingKill())
     {
-      // assign position 1
-      Location = FVector(Pos1.Location);
-      Rotation = FRotator::MakeFromEuler(Pos1.Rotation);
+      Actor->SetActorTransform(Item.Transform, false, nullptr, ETeleportType::None);
     }
-    else
-    {
-      // interpolate positions
-      Location = FMath::Lerp(FVector(Pos1.Location), FVector(Pos2.Location), Per);
-      Rotation = FMath::Lerp(FRotator::MakeFromEuler(Pos1.Rotation), FRotator::MakeFromEuler(Pos2.Rotation), Per);
-    }
-    // set new transform
-    FTransform Trans(Rotation, Location, FVector(1, 1, 1));
-    Actor->SetActorTransform(Trans, false, nullptr, ETeleportType::None);
-    return true;
   }
-  return false;
 }
 
 // reposition the camera
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <vector>
+
 class UCarlaEpisode;
 class FActorView;
 struct FActorDescription;
@@ -15,6 +17,13 @@ class CarlaReplayerHelper
 
 public:
 
+  // new transform of a replayed actor
+  struct ActorTransform
+  {
+    uint32_t DatabaseId;
+    FTransform Transform;
+  };
+
   // set the episode to use
   void SetEpisode(UCarlaEpisode *ThisEpisode)
   {
@@ -34,8 +43,8 @@ public:
   // replay event for parenting actors
   bool ProcessReplayerEventParent(uint32_t ChildId, uint32_t ParentId);
 
-  // reposition actors
-  bool ProcessReplayerPosition(CarlaRecorderPosition Pos1, CarlaRecorderPosition Pos2, double Per, double DeltaTime);
+  // reposition all the actors of a frame at once
+  void ProcessReplayerTransforms(const std::vector<ActorTransform> &Transforms);
 
   // replay event for traffic light state
   bool ProcessReplayerStateTrafficLight(CarlaRecorderStateTrafficLight State);
@@ -6,13 +6,23 @@
 
 #pragma once
 
+#include "Carla/Game/FrameCounter.h"
+#include "Carla/Sensor/SensorBundle.h"
+#include "Carla/Sensor/SensorDiskSink.h"
+#include "Carla/Sensor/SensorMetrics.h"
+
+#include "HAL/PlatformTime.h"
+
 #include <compiler/disable-ue4-macros.h>
 #include <carla/Buffer.h>
+#include <carla/profiler/FrameTracer.h>
 #include <carla/sensor/SensorRegistry.h>
 #include <carla/sensor/s11n/SensorHeaderSerializer.h>
 #include <carla/streaming/Stream.h>
 #include <compiler/enable-ue4-macros.h>
 
+#include <memory>
+
 template <typename T>
 class FDataStreamTmpl;
 
@@ -28,6 +38,14 @@ class FDataStreamTmpl;
 /// @warning This is a single-use object, a new one needs to be created for each
 /// new message.
 ///
+/// If the sensor belongs to a FSensorBundle the data is handed to the bundle
+/// instead, and sent together with the data of the other members. If it has
+/// a disk sink the data is written to a file by the FSensorDiskSink and not
+/// sent at all.
+///
+/// While the sensor metrics are enabled the cost of the frame is written in the
+/// header of the data, see FSensorMetrics.
+///
 /// FAsyncDataStream also has a pool of carla::Buffer that allows reusing the
 /// allocated memory, use it whenever possible.
 template <typename T>
@@ -53,6 +71,19 @@ public:
     return Stream.MakeBuffer();
   }
 
+  /// Frame the data sent down this stream belongs to.
+  uint64 GetFrame() const
+  {
+    return Frame;
+  }
+
+  /// Cost counters of the sensor, nullptr unless the sensor metrics were
+  /// enabled when this object was created.
+  const std::shared_ptr<FSensorMetrics> &GetMetrics() const
+  {
+    return Metrics;
+  }
+
   /// Send some data down the stream.
   template <typename SensorT, typename... ArgsT>
   void Send(SensorT &Sensor, ArgsT &&... Args);
@@ -66,10 +97,25 @@ private:
   explicit FAsyncDataStreamTmpl(
       const SensorT &InSensor,
       double Timestamp,
-      StreamType InStream);
+      StreamType InStream,
+      std::shared_ptr<FSensorBundle> InBundle,
+      std::shared_ptr<const FSensorDiskSink::FTarget> InDiskSink,
+      std::shared_ptr<FSensorMetrics> InMetrics,
+      uint32 InSensorId);
 
   StreamType Stream;
 
+  std::shared_ptr<FSensorBundle> Bundle;
+
+  std::shared_ptr<const FSensorDiskSink::FTarget> DiskSink;
+
+  std::shared_ptr<FSensorMetrics> Metrics;
+
+  /// Actor id of the sensor, only needed by the bundle.
+  uint32 SensorId;
+
+  uint64 Frame;
+
   carla::Buffer Header;
 };
 
@@ -89,9 +135,25 @@ template <typename T>
 template <typename SensorT, typename... ArgsT>
 inline void FAsyncDataStreamTmpl<T>::Send(SensorT &Sensor, ArgsT &&... Args)
 {
-  Stream.Write(
-      std::move(Header),
-      carla::sensor::SensorRegistry::Serialize(Sensor, std::forward<ArgsT>(Args)...));
+  CARLA_TRACE_FRAME(sensor, send, Frame);
+  const double SerializeStart = Metrics != nullptr ? FPlatformTime::Seconds() : 0.0;
+  auto Data = carla::sensor::SensorRegistry::Serialize(Sensor, std::forward<ArgsT>(Args)...);
+  if (Metrics != nullptr)
+  {
+    Metrics->AddMessage(Frame, FPlatformTime::Seconds() - SerializeStart, Header, Data.size());
+  }
+  if (DiskSink != nullptr)
+  {
+    DiskSink->Sink->Write(DiskSink, Frame, std::move(Header), std::move(Data));
+  }
+  else if (Bundle != nullptr)
+  {
+    Bundle->Push(SensorId, std::move(Header), std::move(Data));
+  }
+  else
+  {
+    Stream.Write(std::move(Header), std::move(Data));
+  }
 }
 
 template <typename T>
@@ -99,14 +161,23 @@ template <typename SensorT>
 inline FAsyncDataStreamTmpl<T>::FAsyncDataStreamTmpl(
     const SensorT &Sensor,
     double Timestamp,
-    StreamType InStream)
+    StreamType InStream,
+    std::shared_ptr<FSensorBundle> InBundle,
+    std::shared_ptr<const FSensorDiskSink::FTarget> InDiskSink,
+    std::shared_ptr<FSensorMetrics> InMetrics,
+    uint32 InSensorId)
   : Stream(std::move(InStream)),
+    Bundle(std::move(InBundle)),
+    DiskSink(std::move(InDiskSink)),
+    Metrics(std::move(InMetrics)),
+    SensorId(InSensorId),
+    Frame(FFrameCounter::Get()),
     Header([&Sensor, Timestamp]() {
       check(IsInGameThread());
       using Serializer = carla::sensor::s11n::SensorHeaderSerializer;
       return Serializer::Serialize(
           carla::sensor::SensorRegistry::template get<SensorT*>::index,
-          GFrameCounter,
+          FFrameCounter::Get(),
           Timestamp,
           Sensor.GetActorTransform());
     }()) {}
@@ -0,0 +1,315 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/CameraRig.h"
+
+#include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
+#include "Carla/Game/FrameCounter.h"
+#include "Carla/Sensor/PixelReader.h"
+
+#include "CanvasTypes.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "EngineModule.h"
+#include "LegacyScreenPercentageDriver.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/s11n/ImageSerializer.h>
+#include <carla/sensor/s11n/SensorBundleSerializer.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <vector>
+
+FActorDefinition ACameraRig::GetSensorDefinition()
+{
+  return UActorBlueprintFunctionLibrary::MakeCameraRigDefinition(TEXT("rig"));
+}
+
+ACameraRig::ACameraRig(const FObjectInitializer &ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  PrimaryActorTick.bCanEverTick = true;
+  // Render once every actor moved this frame, like the scene captures do.
+  PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+  CaptureRenderTarget = CreateDefaultSubobject<UTextureRenderTarget2D>(TEXT("CaptureRenderTarget"));
+  CaptureRenderTarget->CompressionSettings = TextureCompressionSettings::TC_Default;
+  CaptureRenderTarget->SRGB = false;
+  CaptureRenderTarget->bAutoGenerateMips = false;
+  CaptureRenderTarget->AddressX = TextureAddress::TA_Clamp;
+  CaptureRenderTarget->AddressY = TextureAddress::TA_Clamp;
+}
+
+void ACameraRig::Set(const FActorDescription &Description)
+{
+  Super::Set(Description);
+  SetImageSize(
+      UActorBlueprintFunctionLibrary::RetrieveActorAttributeToInt("image_size_x", Description.Variations, 800),
+      UActorBlueprintFunctionLibrary::RetrieveActorAttributeToInt("image_size_y", Description.Variations, 600));
+  FOVAngle = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToFloat(
+      "fov",
+      Description.Variations,
+      90.0f);
+
+  TArray<float> Yaws;
+  const FString YawList = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToString(
+      "view_yaws",
+      Description.Variations,
+      TEXT(""));
+  TArray<FString> Items;
+  YawList.ParseIntoArray(Items, TEXT(","));
+  for (const auto &Item : Items)
+  {
+    Yaws.Add(FCString::Atof(*Item.TrimStartAndEnd()));
+  }
+  if (Yaws.Num() == 0)
+  {
+    const int32 NumberOfViews = FMath::Max(1, UActorBlueprintFunctionLibrary::RetrieveActorAttributeToInt(
+        "number_of_views",
+        Description.Variations,
+        6));
+    for (int32 i = 0; i < NumberOfViews; ++i)
+    {
+      Yaws.Add(360.0f * static_cast<float>(i) / static_cast<float>(NumberOfViews));
+    }
+  }
+  SetViewYaws(std::move(Yaws));
+
+  const FString Format = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToString(
+      "pixel_format",
+      Description.Variations,
+      TEXT("bgra"));
+  PixelFormat = (Format == TEXT("rgb")) ?
+      carla::sensor::data::PixelFormat::RGB8 :
+      carla::sensor::data::PixelFormat::BGRA8;
+}
+
+void ACameraRig::SetImageSize(uint32 InWidth, uint32 InHeight)
+{
+  ImageWidth = InWidth;
+  ImageHeight = InHeight;
+}
+
+void ACameraRig::SetViewYaws(TArray<float> Yaws)
+{
+  check(Yaws.Num() > 0);
+  ViewYaws = std::move(Yaws);
+}
+
+FIntPoint ACameraRig::GetTileOrigin(const int32 Index) const
+{
+  return {
+      static_cast<int32>(ImageWidth) * (Index % AtlasColumns),
+      static_cast<int32>(ImageHeight) * (Index / AtlasColumns)};
+}
+
+void ACameraRig::BeginPlay()
+{
+  // As square as possible, a single row of six HD views would exceed the
+  // maximum texture size of most GPUs.
+  const int32 NumberOfViews = ViewYaws.Num();
+  AtlasColumns = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumberOfViews)));
+  const int32 AtlasRows = (NumberOfViews + AtlasColumns - 1) / AtlasColumns;
+  CaptureRenderTarget->InitCustomFormat(
+      ImageWidth * AtlasColumns,
+      ImageHeight * AtlasRows,
+      PF_B8G8R8A8,
+      false);
+  CaptureRenderTarget->TargetGamma = 2.2f;
+
+  ViewStates.SetNum(NumberOfViews);
+  const auto FeatureLevel = GetWorld()->FeatureLevel;
+  for (auto &ViewState : ViewStates)
+  {
+    ViewState.Allocate(FeatureLevel);
+  }
+
+  Super::BeginPlay();
+}
+
+void ACameraRig::Tick(float DeltaTime)
+{
+  Super::Tick(DeltaTime);
+  RenderViews();
+  SendPixelsInRenderThread();
+}
+
+void ACameraRig::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+  Super::EndPlay(EndPlayReason);
+  for (auto &ViewState : ViewStates)
+  {
+    ViewState.Destroy();
+  }
+  ViewStates.Empty();
+}
+
+void ACameraRig::RenderViews()
+{
+  auto *World = GetWorld();
+  auto *Resource = CaptureRenderTarget->GameThread_GetRenderTargetResource();
+  if ((World == nullptr) || (World->Scene == nullptr) || (Resource == nullptr))
+  {
+    return;
+  }
+
+  FEngineShowFlags ShowFlags(ESFIM_Game);
+  FSceneViewFamilyContext ViewFamily(FSceneViewFamily::ConstructionValues(
+      Resource,
+      World->Scene,
+      ShowFlags)
+    .SetResolveScene(true)
+    .SetRealtimeUpdate(true));
+  ViewFamily.SceneCaptureSource = ESceneCaptureSource::SCS_FinalColorLDR;
+  ViewFamily.SetScreenPercentageInterface(new FLegacyScreenPercentageDriver(ViewFamily, 1.0f, false));
+
+  const FVector Location = GetActorLocation();
+  for (int32 i = 0; i < ViewYaws.Num(); ++i)
+  {
+    const FIntPoint Origin = GetTileOrigin(i);
+    AddView(
+        ViewFamily,
+        ViewStates[i].GetReference(),
+        FIntRect(
+            Origin.X,
+            Origin.Y,
+            Origin.X + static_cast<int32>(ImageWidth),
+            Origin.Y + static_cast<int32>(ImageHeight)),
+        Location,
+        (FRotator(0.0f, ViewYaws[i], 0.0f).Quaternion() * GetActorQuat()).Rotator(),
+        FOVAngle);
+  }
+
+  FCanvas Canvas(Resource, nullptr, World, World->FeatureLevel);
+  GetRendererModule().BeginRenderingViewFamily(&Canvas, &ViewFamily);
+}
+
+void ACameraRig::AddView(
+    FSceneViewFamily &ViewFamily,
+    FSceneViewStateInterface *ViewState,
+    const FIntRect &Rect,
+    const FVector &Location,
+    const FRotator &Rotation,
+    const float FOVAngle,
+    UMaterialInterface *Material)
+{
+  const float HalfFOV = FMath::DegreesToRadians(FOVAngle) * 0.5f;
+  const float AspectRatio = static_cast<float>(Rect.Width()) / static_cast<float>(Rect.Height());
+
+  FSceneViewInitOptions ViewInitOptions;
+  ViewInitOptions.SetViewRectangle(Rect);
+  ViewInitOptions.ViewFamily = &ViewFamily;
+  ViewInitOptions.SceneViewStateInterface = ViewState;
+  ViewInitOptions.ViewOrigin = Location;
+  // Unreal's axes to the view axes, as done by the scene captures.
+  ViewInitOptions.ViewRotationMatrix = FInverseRotationMatrix(Rotation) * FMatrix(
+      FPlane(0, 0, 1, 0),
+      FPlane(1, 0, 0, 0),
+      FPlane(0, 1, 0, 0),
+      FPlane(0, 0, 0, 1));
+  ViewInitOptions.ProjectionMatrix = FReversedZPerspectiveMatrix(
+      HalfFOV,
+      HalfFOV,
+      1.0f,
+      AspectRatio,
+      GNearClippingPlane,
+      GNearClippingPlane);
+  ViewInitOptions.FOV = FOVAngle;
+  ViewInitOptions.bUseFieldOfViewForLOD = true;
+  ViewInitOptions.BackgroundColor = FLinearColor::Black;
+
+  FSceneView *View = new FSceneView(ViewInitOptions);
+  ViewFamily.Views.Add(View);
+  View->StartFinalPostprocessSettings(Location);
+  if (Material != nullptr)
+  {
+    FPostProcessSettings Settings;
+    Settings.AddBlendable(Material, 1.0f);
+    View->OverridePostProcessSettings(Settings, 1.0f);
+  }
+  View->EndFinalPostprocessSettings(ViewInitOptions);
+}
+
+void ACameraRig::SendPixelsInRenderThread()
+{
+  using HeaderSerializer = carla::sensor::s11n::SensorHeaderSerializer;
+  using ImageSerializer = carla::sensor::s11n::ImageSerializer;
+  using Reading = carla::sensor::s11n::SensorBundleSerializer::Reading;
+
+  struct FView
+  {
+    carla::Buffer Header;
+
+    FIntPoint Origin;
+  };
+
+  // The headers need the frame and the transforms of the game-thread.
+  TArray<FView> Views;
+  const double Timestamp = GetEpisode().GetElapsedGameTime();
+  for (int32 i = 0; i < ViewYaws.Num(); ++i)
+  {
+    const FTransform ViewTransform = FTransform(FRotator(0.0f, ViewYaws[i], 0.0f)) * GetActorTransform();
+    Views.Add(FView{
+        HeaderSerializer::Serialize(
+            carla::sensor::SensorRegistry::get<ASceneCaptureCamera *>::index,
+            FFrameCounter::Get(),
+            Timestamp,
+            ViewTransform),
+        GetTileOrigin(i)});
+  }
+  const ImageSerializer::ImageHeader ImageHeader = {
+    ImageWidth,
+    ImageHeight,
+    FOVAngle,
+    PixelFormat
+  };
+
+  ENQUEUE_RENDER_COMMAND(FCameraRig_SendPixelsInRenderThread)
+  (
+    [this, Stream=GetDataStream(*this), Views=MoveTemp(Views), ImageHeader](auto &InRHICmdList) mutable
+    {
+      /// @todo Can we make sure the sensor is not going to be destroyed?
+      if (IsPendingKill())
+      {
+        return;
+      }
+      auto Atlas = Stream.PopBufferFromPool();
+      FPixelReader::WritePixelsToBuffer(
+          *CaptureRenderTarget,
+          Atlas,
+          0u,
+          carla::sensor::data::PixelFormat::BGRA8,
+          InRHICmdList);
+
+      using carla::sensor::data::Color;
+      const uint32 AtlasWidth = CaptureRenderTarget->GetSurfaceWidth();
+      const auto *Pixels = reinterpret_cast<const Color *>(Atlas.data());
+      const uint32 BytesPerPixel = carla::sensor::data::GetBytesPerPixel(ImageHeader.pixel_format);
+      const uint32 DstStride = ImageHeader.width * BytesPerPixel;
+      check(Atlas.size() >= (sizeof(Color) * AtlasWidth * CaptureRenderTarget->GetSurfaceHeight()));
+
+      std::vector<Reading> Readings;
+      Readings.reserve(Views.Num());
+      for (auto &View : Views)
+      {
+        auto Data = Stream.PopBufferFromPool();
+        Data.reset(ImageSerializer::header_offset + DstStride * ImageHeader.height);
+        FMemory::Memcpy(Data.data(), &ImageHeader, sizeof(ImageHeader));
+        auto *DstRow = Data.data() + ImageSerializer::header_offset;
+        for (uint32 Row = 0u; Row < ImageHeader.height; ++Row)
+        {
+          const auto *SrcRow = Pixels + (View.Origin.Y + Row) * AtlasWidth + View.Origin.X;
+          carla::sensor::data::ConvertPixels(ImageHeader.pixel_format, SrcRow, ImageHeader.width, DstRow);
+          DstRow += DstStride;
+        }
+        Readings.emplace_back(Reading{std::move(View.Header), std::move(Data)});
+      }
+      Stream.Send(*this, Readings, Stream.PopBufferFromPool());
+    }
+  );
+}
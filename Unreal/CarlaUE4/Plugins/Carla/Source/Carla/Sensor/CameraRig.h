@@ -0,0 +1,122 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Sensor/Sensor.h"
+
+#include "Carla/Actor/ActorDefinition.h"
+#include "Carla/Actor/ActorDescription.h"
+
+#include "SceneView.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/data/PixelFormat.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include "CameraRig.generated.h"
+
+class UMaterialInterface;
+class UTextureRenderTarget2D;
+
+/// A rig of cameras sharing the same location, rendered together. All the
+/// views are rendered as a single view family into the tiles of an atlas, so
+/// they share the scene traversal, the shadow and the lighting setup, and the
+/// atlas is read back once. Each frame the rig sends a SensorBundle with an
+/// Image per view, in the order of the views.
+///
+/// @warning All the setters should be called before BeginPlay.
+UCLASS()
+class CARLA_API ACameraRig : public ASensor
+{
+  GENERATED_BODY()
+
+public:
+
+  ACameraRig(const FObjectInitializer &ObjectInitializer);
+
+  static FActorDefinition GetSensorDefinition();
+
+  void Set(const FActorDescription &ActorDescription) override;
+
+  /// Set the size in pixels of each view.
+  void SetImageSize(uint32 Width, uint32 Height);
+
+  uint32 GetImageWidth() const
+  {
+    return ImageWidth;
+  }
+
+  uint32 GetImageHeight() const
+  {
+    return ImageHeight;
+  }
+
+  float GetFOVAngle() const
+  {
+    return FOVAngle;
+  }
+
+  carla::sensor::data::PixelFormat GetPixelFormat() const
+  {
+    return PixelFormat;
+  }
+
+  /// Set the yaw in degrees of each view, relative to the rig.
+  void SetViewYaws(TArray<float> Yaws);
+
+  /// Add to @a ViewFamily a view from @a Location towards @a Rotation,
+  /// rendered into the @a Rect of the family render target. If given,
+  /// @a Material is applied to this view only as a post-process blendable.
+  ///
+  /// Shared with the other sensors that render several views at once.
+  static void AddView(
+      FSceneViewFamily &ViewFamily,
+      FSceneViewStateInterface *ViewState,
+      const FIntRect &Rect,
+      const FVector &Location,
+      const FRotator &Rotation,
+      float FOVAngle,
+      UMaterialInterface *Material = nullptr);
+
+protected:
+
+  void BeginPlay() override;
+
+  void Tick(float DeltaTime) override;
+
+  void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+private:
+
+  /// Position of the view @a Index in the atlas.
+  FIntPoint GetTileOrigin(int32 Index) const;
+
+  void RenderViews();
+
+  void SendPixelsInRenderThread();
+
+  uint32 ImageWidth = 800u;
+
+  uint32 ImageHeight = 600u;
+
+  float FOVAngle = 90.0f;
+
+  carla::sensor::data::PixelFormat PixelFormat = carla::sensor::data::PixelFormat::BGRA8;
+
+  UPROPERTY(EditAnywhere)
+  TArray<float> ViewYaws;
+
+  /// Number of tiles per row of the atlas.
+  int32 AtlasColumns = 1;
+
+  /// Atlas with a tile per view.
+  UPROPERTY()
+  UTextureRenderTarget2D *CaptureRenderTarget = nullptr;
+
+  /// Keeps the temporal state (eye adaptation, anti-aliasing) of each view.
+  TArray<FSceneViewStateReference> ViewStates;
+};
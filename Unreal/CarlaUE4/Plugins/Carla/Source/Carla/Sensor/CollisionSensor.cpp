@@ -16,14 +16,33 @@
 ACollisionSensor::ACollisionSensor(const FObjectInitializer& ObjectInitializer)
   : Super(ObjectInitializer)
 {
-  PrimaryActorTick.bCanEverTick = false;
+  // Only ticks in "coalesce" mode, to send the hits after physics.
+  PrimaryActorTick.bCanEverTick = true;
+  PrimaryActorTick.TickGroup = TG_PostUpdateWork;
 }
 
 FActorDefinition ACollisionSensor::GetSensorDefinition()
 {
-  return UActorBlueprintFunctionLibrary::MakeGenericSensorDefinition(
+  auto Definition = UActorBlueprintFunctionLibrary::MakeGenericSensorDefinition(
       TEXT("other"),
       TEXT("collision"));
+  // Send the hits of each frame together, summed up by the other actor.
+  FActorVariation Coalesce;
+  Coalesce.Id = TEXT("coalesce");
+  Coalesce.Type = EActorAttributeType::Bool;
+  Coalesce.RecommendedValues = { TEXT("false") };
+  Coalesce.bRestrictToRecommended = false;
+  Definition.Variations.Emplace(Coalesce);
+  return Definition;
+}
+
+void ACollisionSensor::Set(const FActorDescription &Description)
+{
+  Super::Set(Description);
+  bCoalesce = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToBool(
+      "coalesce",
+      Description.Variations,
+      false);
 }
 
 void ACollisionSensor::SetOwner(AActor *NewOwner)
@@ -38,6 +57,17 @@ void ACollisionSensor::SetOwner(AActor *NewOwner)
   }
 }
 
+void ACollisionSensor::SetSensorActive(const bool bActive)
+{
+  SetActorTickEnabled(bActive && bCoalesce);
+}
+
+void ACollisionSensor::Tick(const float DeltaSeconds)
+{
+  Super::Tick(DeltaSeconds);
+  SendCoalescedEvents();
+}
+
 void ACollisionSensor::OnCollisionEvent(
     AActor *Actor,
     AActor *OtherActor,
@@ -49,13 +79,61 @@ void ACollisionSensor::OnCollisionEvent(
     const auto &Episode = GetEpisode();
     constexpr float TO_METERS = 1e-2;
     NormalImpulse *= TO_METERS;
-    GetDataStream(*this).Send(
-        *this,
-        Episode.SerializeActor(Episode.FindOrFakeActor(Actor)),
-        Episode.SerializeActor(Episode.FindOrFakeActor(OtherActor)),
-        carla::geom::Vector3D{NormalImpulse.X, NormalImpulse.Y, NormalImpulse.Z});
+    if (bCoalesce)
+    {
+      if ((CoalescedFrame != GFrameCounter) || (CoalescedSelfActor.Get() != Actor))
+      {
+        // Left over from a frame the sensor did not tick.
+        SendCoalescedEvents();
+        CoalescedFrame = GFrameCounter;
+        CoalescedSelfActor = Actor;
+      }
+      auto &Hits = CoalescedHits.FindOrAdd(OtherActor);
+      Hits.NormalImpulse += NormalImpulse;
+      ++Hits.NumberOfHits;
+    }
+    else
+    {
+      GetDataStream(*this).Send(
+          *this,
+          Episode.SerializeActor(Episode.FindOrFakeActor(Actor)),
+          Episode.SerializeActor(Episode.FindOrFakeActor(OtherActor)),
+          carla::geom::Vector3D{NormalImpulse.X, NormalImpulse.Y, NormalImpulse.Z});
+    }
     // record the collision event
     if (Episode.GetRecorder()->IsEnabled())
       Episode.GetRecorder()->AddCollision(Actor, OtherActor);
   }
 }
+
+void ACollisionSensor::SendCoalescedEvents()
+{
+  if (CoalescedHits.Num() == 0)
+  {
+    return;
+  }
+  using Serializer = carla::sensor::s11n::CollisionEventBatchSerializer;
+  const auto &Episode = GetEpisode();
+  std::vector<Serializer::Event> Events;
+  Events.reserve(CoalescedHits.Num());
+  for (auto &Item : CoalescedHits)
+  {
+    if (Item.Key.IsValid())
+    {
+      const FVector &Impulse = Item.Value.NormalImpulse;
+      Events.emplace_back(Serializer::Event{
+          Episode.SerializeActor(Episode.FindOrFakeActor(Item.Key.Get())),
+          carla::geom::Vector3D{Impulse.X, Impulse.Y, Impulse.Z},
+          Item.Value.NumberOfHits});
+    }
+  }
+  CoalescedHits.Reset();
+  if (!Events.empty() && CoalescedSelfActor.IsValid())
+  {
+    const FCollisionEventBatch Batch(*this);
+    GetDataStream(Batch).Send(
+        Batch,
+        Episode.SerializeActor(Episode.FindOrFakeActor(CoalescedSelfActor.Get())),
+        std::move(Events));
+  }
+}
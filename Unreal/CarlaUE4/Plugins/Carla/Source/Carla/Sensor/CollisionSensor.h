@@ -9,12 +9,20 @@
 #include "Carla/Actor/ActorDefinition.h"
 #include "Carla/Sensor/Sensor.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/s11n/CollisionEventBatchSerializer.h>
+#include <compiler/enable-ue4-macros.h>
+
 #include "CollisionSensor.generated.h"
 
 class UCarlaEpisode;
 class UCarlaGameInstance;
 
 /// A sensor to register collisions.
+///
+/// By default every hit is sent in its own message. With the "coalesce"
+/// attribute the hits of a frame are accumulated by the other actor instead,
+/// and sent at the end of the frame in a single FCollisionEventBatch message.
 UCLASS()
 class CARLA_API ACollisionSensor : public ASensor
 {
@@ -26,8 +34,14 @@ public:
 
   ACollisionSensor(const FObjectInitializer& ObjectInitializer);
 
+  void Set(const FActorDescription &Description) override;
+
   void SetOwner(AActor *NewOwner) override;
 
+  void SetSensorActive(bool bActive) override;
+
+  void Tick(float DeltaSeconds) override;
+
 private:
 
   UFUNCTION()
@@ -36,4 +50,45 @@ private:
       AActor *OtherActor,
       FVector NormalImpulse,
       const FHitResult &Hit);
+
+  /// Send the hits accumulated so far, if any.
+  void SendCoalescedEvents();
+
+  struct FCoalescedHits
+  {
+    FVector NormalImpulse = FVector::ZeroVector;
+
+    uint32 NumberOfHits = 0u;
+  };
+
+  bool bCoalesce = false;
+
+  /// Frame of the hits accumulated.
+  uint64 CoalescedFrame = 0u;
+
+  TWeakObjectPtr<AActor> CoalescedSelfActor;
+
+  TMap<TWeakObjectPtr<AActor>, FCoalescedHits> CoalescedHits;
+};
+
+/// The messages of a collision sensor in "coalesce" mode, registered at
+/// carla::sensor::SensorRegistry with a serializer of their own.
+class FCollisionEventBatch
+{
+public:
+
+  /// Not a real sensor, do not add it to the blueprint library.
+  using not_spawnable = void;
+
+  explicit FCollisionEventBatch(const ACollisionSensor &InSensor)
+    : Sensor(InSensor) {}
+
+  FTransform GetActorTransform() const
+  {
+    return Sensor.GetActorTransform();
+  }
+
+private:
+
+  const ACollisionSensor &Sensor;
 };
@@ -13,6 +13,8 @@
 #include <boost/optional.hpp>
 #include <compiler/enable-ue4-macros.h>
 
+#include <memory>
+
 // =============================================================================
 // -- FDataStreamTmpl ----------------------------------------------------------
 // =============================================================================
@@ -33,26 +35,102 @@ public:
 
   FDataStreamTmpl(StreamType InStream) : Stream(std::move(InStream)) {}
 
-  /// Create a FAsyncDataStream object.
+  /// Create a FAsyncDataStream object. @a SensorId keys the data in the
+  /// message of the bundle, if any.
   ///
   /// @pre This functions needs to be called in the game-thread.
   template <typename SensorT>
-  auto MakeAsyncDataStream(const SensorT &Sensor, double Timestamp)
+  auto MakeAsyncDataStream(const SensorT &Sensor, double Timestamp, uint32 SensorId = 0u)
   {
     check(Stream.has_value());
-    return FAsyncDataStreamTmpl<T>{Sensor, Timestamp, *Stream};
+    return FAsyncDataStreamTmpl<T>{
+        Sensor,
+        Timestamp,
+        *Stream,
+        Bundle,
+        DiskSink,
+        FSensorMetrics::IsEnabled() ? Metrics : nullptr,
+        SensorId};
+  }
+
+  /// Make the data of this stream go through @a InBundle, clients subscribe
+  /// to the stream of the bundle instead.
+  ///
+  /// @warning Do not change the bundle after BeginPlay. It is not
+  /// thread-safe.
+  void SetBundle(std::shared_ptr<FSensorBundle> InBundle)
+  {
+    Bundle = std::move(InBundle);
+  }
+
+  const std::shared_ptr<FSensorBundle> &GetBundle() const
+  {
+    return Bundle;
+  }
+
+  /// Write the data of this stream to files with the FSensorDiskSink of
+  /// @a InDiskSink instead of sending it to the clients.
+  ///
+  /// @warning Do not change the sink after BeginPlay. It is not thread-safe.
+  void SetDiskSink(std::shared_ptr<const FSensorDiskSink::FTarget> InDiskSink)
+  {
+    DiskSink = std::move(InDiskSink);
+  }
+
+  bool HasDiskSink() const
+  {
+    return DiskSink != nullptr;
+  }
+
+  /// Measure the cost of the data of this stream with @a InMetrics while the
+  /// sensor metrics are enabled.
+  ///
+  /// @warning Do not change the metrics after BeginPlay. It is not
+  /// thread-safe.
+  void SetMetrics(std::shared_ptr<FSensorMetrics> InMetrics)
+  {
+    Metrics = std::move(InMetrics);
+  }
+
+  /// Set the codec used to send the data of this stream to remote clients,
+  /// the data is compressed on the streaming threads.
+  void SetCompression(carla::streaming::Compression Codec)
+  {
+    check(Stream.has_value());
+    (*Stream).SetCompression(Codec);
+  }
+
+  /// Whether any client is subscribed to this stream, or to the stream of
+  /// its bundle if it belongs to one. A disk sink always listens.
+  bool AreClientsListening() const
+  {
+    if (!Stream.has_value())
+    {
+      return false;
+    }
+    if (DiskSink != nullptr)
+    {
+      return true;
+    }
+    return Bundle != nullptr ? Bundle->AreClientsListening() : (*Stream).AreClientsListening();
   }
 
   /// Return the token that allows subscribing to this stream.
   auto GetToken() const
   {
     check(Stream.has_value());
-    return (*Stream).token();
+    return Bundle != nullptr ? Bundle->GetToken() : (*Stream).token();
   }
 
 private:
 
   boost::optional<StreamType> Stream;
+
+  std::shared_ptr<FSensorBundle> Bundle;
+
+  std::shared_ptr<const FSensorDiskSink::FTarget> DiskSink;
+
+  std::shared_ptr<FSensorMetrics> Metrics;
 };
 
 // =============================================================================
@@ -11,7 +11,9 @@
 
 FActorDefinition ADepthCamera::GetSensorDefinition()
 {
-  return UActorBlueprintFunctionLibrary::MakeCameraDefinition(TEXT("depth"));
+  auto Definition = UActorBlueprintFunctionLibrary::MakeCameraDefinition(TEXT("depth"));
+  AddPixelFormatVariation(Definition, { TEXT("depth") });
+  return Definition;
 }
 
 ADepthCamera::ADepthCamera(const FObjectInitializer &ObjectInitializer)
@@ -0,0 +1,270 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/DepthLidar.h"
+
+#include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/s11n/LidarMeasurement.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include "Async/Async.h"
+#include "Components/SceneCaptureComponent2D.h"
+#include "Engine/TextureRenderTarget2D.h"
+
+FActorDefinition ADepthLidar::GetSensorDefinition()
+{
+  return UActorBlueprintFunctionLibrary::MakeLidarDefinition(TEXT("depth"));
+}
+
+ADepthLidar::ADepthLidar(const FObjectInitializer &ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  PrimaryActorTick.bCanEverTick = true;
+  PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+  for (int32 i = 0; i < NumberOfFaces; ++i)
+  {
+    auto *RenderTarget = CreateDefaultSubobject<UTextureRenderTarget2D>(
+        FName(*FString::Printf(TEXT("DepthRenderTarget_%d"), i)));
+    RenderTarget->CompressionSettings = TextureCompressionSettings::TC_Default;
+    RenderTarget->SRGB = false;
+    RenderTarget->bAutoGenerateMips = false;
+    RenderTarget->AddressX = TextureAddress::TA_Clamp;
+    RenderTarget->AddressY = TextureAddress::TA_Clamp;
+    CaptureRenderTargets.Add(RenderTarget);
+
+    auto *CaptureComponent = CreateDefaultSubobject<USceneCaptureComponent2D>(
+        FName(*FString::Printf(TEXT("DepthCaptureComponent_%d"), i)));
+    CaptureComponent->SetupAttachment(RootComponent);
+    CaptureComponent->SetRelativeRotation(FRotator(0.0f, 360.0f * i / NumberOfFaces, 0.0f));
+    CaptureComponent->CaptureSource = ESceneCaptureSource::SCS_SceneDepth;
+    CaptureComponent->FOVAngle = 360.0f / NumberOfFaces;
+    CaptureComponents.Add(CaptureComponent);
+  }
+}
+
+void ADepthLidar::Set(const FActorDescription &ActorDescription)
+{
+  Super::Set(ActorDescription);
+  FLidarDescription LidarDescription;
+  UActorBlueprintFunctionLibrary::SetLidar(ActorDescription, LidarDescription);
+  Set(LidarDescription);
+}
+
+void ADepthLidar::Set(const FLidarDescription &LidarDescription)
+{
+  Description = LidarDescription;
+  CreateLasers();
+}
+
+void ADepthLidar::SetSensorActive(const bool bActive)
+{
+  Super::SetSensorActive(bActive);
+  for (auto *CaptureComponent : CaptureComponents)
+  {
+    if (bActive)
+    {
+      CaptureComponent->Activate();
+    }
+    else
+    {
+      CaptureComponent->Deactivate();
+    }
+  }
+}
+
+void ADepthLidar::CreateLasers()
+{
+  const auto NumberOfLasers = Description.Channels;
+  check(NumberOfLasers > 0u);
+  const float DeltaAngle = NumberOfLasers == 1u ? 0.f :
+    (Description.UpperFovLimit - Description.LowerFovLimit) /
+    static_cast<float>(NumberOfLasers - 1);
+  LaserPitchTable.Empty(NumberOfLasers);
+  for(auto i = 0u; i < NumberOfLasers; ++i)
+  {
+    const float VerticalAngle =
+      Description.UpperFovLimit - static_cast<float>(i) * DeltaAngle;
+    float Sin, Cos;
+    FMath::SinCos(&Sin, &Cos, FMath::DegreesToRadians(VerticalAngle));
+    LaserPitchTable.Emplace(Cos, Sin);
+  }
+
+  // The rays at the edges of a face are the furthest from the image plane,
+  // the vertical field of view must cover them.
+  const float HalfFaceAngle = FMath::DegreesToRadians(180.0f / NumberOfFaces);
+  const float MaxPitch = FMath::DegreesToRadians(FMath::Max(
+      FMath::Abs(Description.UpperFovLimit),
+      FMath::Abs(Description.LowerFovLimit)));
+  FaceTanHalfFOV = FMath::Tan(MaxPitch) / FMath::Cos(HalfFaceAngle) + 0.01f;
+
+  // Twice the horizontal resolution of the lasers, and enough vertical
+  // resolution to tell the channels apart.
+  const float PointsPerRevolution =
+      static_cast<float>(Description.PointsPerSecond) /
+      (static_cast<float>(NumberOfLasers) * FMath::Max(Description.RotationFrequency, 1.0f));
+  const float TanHalfFaceAngle = FMath::Tan(HalfFaceAngle);
+  FaceWidth = FMath::Clamp<uint32>(
+      FMath::CeilToInt(2.0f * PointsPerRevolution / NumberOfFaces),
+      64u,
+      2048u);
+  FaceHeight = FMath::Clamp<uint32>(
+      FMath::Max(
+          FMath::CeilToInt(FaceWidth * FaceTanHalfFOV / TanHalfFaceAngle),
+          FMath::CeilToInt(4.0f * NumberOfLasers)),
+      16u,
+      2048u);
+}
+
+void ADepthLidar::BeginPlay()
+{
+  for (int32 i = 0; i < NumberOfFaces; ++i)
+  {
+    CaptureRenderTargets[i]->InitCustomFormat(FaceWidth, FaceHeight, PF_FloatRGBA, true);
+    auto *CaptureComponent = CaptureComponents[i];
+    CaptureComponent->Deactivate();
+    CaptureComponent->TextureTarget = CaptureRenderTargets[i];
+    CaptureComponent->CaptureSource = ESceneCaptureSource::SCS_SceneDepth;
+    CaptureComponent->UpdateContent();
+    CaptureComponent->Activate();
+  }
+  Super::BeginPlay();
+}
+
+void ADepthLidar::Tick(const float DeltaTime)
+{
+  Super::Tick(DeltaTime);
+  SendPointsInRenderThread(DeltaTime);
+}
+
+void ADepthLidar::SendPointsInRenderThread(const float DeltaTime)
+{
+  const uint32 ChannelCount = Description.Channels;
+  const uint32 PointsToScanWithOneLaser =
+    FMath::RoundHalfFromZero(
+        Description.PointsPerSecond * DeltaTime / float(ChannelCount));
+
+  if (PointsToScanWithOneLaser <= 0)
+  {
+    UE_LOG(
+        LogCarla,
+        Warning,
+        TEXT("%s: no points requested this frame, try increasing the number of points per second."),
+        *GetName());
+    return;
+  }
+
+  check(ChannelCount == LaserPitchTable.Num());
+
+  // Everything the worker needs is copied here, in the game-thread.
+  struct FSweep
+  {
+    float StartAngle;
+    float AngleStep;
+    uint32 PointsPerLaser;
+    float Range;
+    float TanHalfFOV;
+    uint32 Width;
+    uint32 Height;
+    FQuat BodyQuat;
+    FQuat OutputQuat;
+    TArray<FVector2D> Pitches;
+    carla::sensor::s11n::LidarPointFormat PointFormat;
+    float PointScale;
+  };
+
+  const float AngleDistanceOfTick = Description.RotationFrequency * 360.0f * DeltaTime;
+  const FRotator LidarBodyRot = GetActorRotation();
+  FSweep Sweep{
+      HorizontalAngle,
+      AngleDistanceOfTick / PointsToScanWithOneLaser,
+      PointsToScanWithOneLaser,
+      Description.Range,
+      FaceTanHalfFOV,
+      FaceWidth,
+      FaceHeight,
+      LidarBodyRot.Quaternion(),
+      // Same coordinates as ARayCastLidar.
+      FQuat(FVector(0, 0, 1), FMath::DegreesToRadians(90.0f - LidarBodyRot.Yaw)),
+      LaserPitchTable,
+      Description.bPackPoints ?
+          carla::sensor::s11n::LidarPointFormat::PackedInt16 :
+          carla::sensor::s11n::LidarPointFormat::Float32,
+      Description.PointScale};
+  HorizontalAngle = std::fmod(HorizontalAngle + AngleDistanceOfTick, 360.0f);
+  const float SentHorizontalAngle = FMath::DegreesToRadians(HorizontalAngle);
+
+  ENQUEUE_RENDER_COMMAND(FDepthLidar_SendPointsInRenderThread)
+  (
+    [this, Stream=GetDataStream(*this), Sweep=MoveTemp(Sweep), SentHorizontalAngle](auto &InRHICmdList) mutable
+    {
+      /// @todo Can we make sure the sensor is not going to be destroyed?
+      if (IsPendingKill())
+      {
+        return;
+      }
+
+      TArray<TArray<FFloat16Color>> Faces;
+      Faces.SetNum(NumberOfFaces);
+      for (int32 i = 0; i < NumberOfFaces; ++i)
+      {
+        auto *Resource = CaptureRenderTargets[i]->GetRenderTargetResource();
+        check(Resource != nullptr);
+        InRHICmdList.ReadSurfaceFloatData(
+            Resource->GetRenderTargetTexture(),
+            FIntRect(0, 0, Sweep.Width, Sweep.Height),
+            Faces[i],
+            CubeFace_PosX,
+            0,
+            0);
+      }
+
+      // Sampling the faces does not need the GPU, leave the render thread.
+      AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [this, Stream=MoveTemp(Stream), Sweep=MoveTemp(Sweep), Faces=MoveTemp(Faces), SentHorizontalAngle]() mutable
+      {
+        const uint32 ChannelCount = Sweep.Pitches.Num();
+        carla::sensor::s11n::LidarMeasurement Measurement(ChannelCount, Sweep.PointFormat, Sweep.PointScale);
+        Measurement.Reset(ChannelCount * Sweep.PointsPerLaser);
+
+        const float FaceAngle = 360.0f / NumberOfFaces;
+        for (auto Channel = 0u; Channel < ChannelCount; ++Channel)
+        {
+          const FVector2D &Pitch = Sweep.Pitches[Channel];
+          const float V = Pitch.Y / Sweep.TanHalfFOV;
+          for (auto i = 0u; i < Sweep.PointsPerLaser; ++i)
+          {
+            const float Angle = FRotator::ClampAxis(Sweep.StartAngle + Sweep.AngleStep * i);
+            const int32 Face = FMath::FloorToInt((Angle + 0.5f * FaceAngle) / FaceAngle) % NumberOfFaces;
+            float Sin, Cos;
+            FMath::SinCos(&Sin, &Cos, FMath::DegreesToRadians(Angle - Face * FaceAngle));
+            // Project the ray into the face, the faces have a horizontal
+            // field of view of 90 degrees so the image plane is at one.
+            const float Forward = Pitch.X * Cos;
+            const float U = 0.5f + 0.5f * (Pitch.X * Sin / Forward);
+            const float W = 0.5f - 0.5f * (V / Forward);
+            const uint32 X = FMath::Min<uint32>(FMath::Max(0, FMath::FloorToInt(U * Sweep.Width)), Sweep.Width - 1u);
+            const uint32 Y = FMath::Min<uint32>(FMath::Max(0, FMath::FloorToInt(W * Sweep.Height)), Sweep.Height - 1u);
+            const float Depth = Faces[Face][Y * Sweep.Width + X].R.GetFloat();
+            const float Distance = Depth / Forward;
+            if ((Depth <= 0.0f) || (Distance >= Sweep.Range))
+            {
+              continue;
+            }
+            FMath::SinCos(&Sin, &Cos, FMath::DegreesToRadians(Angle));
+            const FVector LaserDirection(Pitch.X * Cos, Pitch.X * Sin, Pitch.Y);
+            const FVector Offset = Distance * Sweep.BodyQuat.RotateVector(LaserDirection);
+            Measurement.WritePoint(Channel, Sweep.OutputQuat.RotateVector(-Offset));
+          }
+        }
+        Measurement.SetHorizontalAngle(SentHorizontalAngle);
+        Stream.Send(*this, Measurement, Stream.PopBufferFromPool());
+      });
+    }
+  );
+}
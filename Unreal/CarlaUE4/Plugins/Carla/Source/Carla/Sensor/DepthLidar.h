@@ -0,0 +1,81 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Sensor/Sensor.h"
+
+#include "Carla/Actor/ActorDefinition.h"
+#include "Carla/Sensor/LidarDescription.h"
+
+#include "DepthLidar.generated.h"
+
+class USceneCaptureComponent2D;
+class UTextureRenderTarget2D;
+
+/// A Lidar sensor that samples the depth buffer instead of ray-casting. The
+/// scene depth is rendered into four faces of 90 degrees around the sensor,
+/// and the points are computed by sampling the faces at the laser angles in a
+/// worker thread. It produces the same data as ARayCastLidar, trading some
+/// accuracy (the depth is stored as half-precision floats, and the rays are
+/// snapped to the nearest pixel) for a much higher point throughput.
+UCLASS()
+class CARLA_API ADepthLidar : public ASensor
+{
+  GENERATED_BODY()
+
+public:
+
+  static constexpr int32 NumberOfFaces = 4;
+
+  static FActorDefinition GetSensorDefinition();
+
+  ADepthLidar(const FObjectInitializer &ObjectInitializer);
+
+  void Set(const FActorDescription &Description) override;
+
+  void Set(const FLidarDescription &LidarDescription);
+
+  /// Stops rendering the faces while the sensor is idle.
+  void SetSensorActive(bool bActive) override;
+
+protected:
+
+  void BeginPlay() override;
+
+  void Tick(float DeltaTime) override;
+
+private:
+
+  /// Computes the angles of each laser and the size of the faces.
+  void CreateLasers();
+
+  /// Reads the faces in the render thread and sends the points read in
+  /// DeltaTime from a worker thread.
+  void SendPointsInRenderThread(float DeltaTime);
+
+  UPROPERTY(EditAnywhere)
+  FLidarDescription Description;
+
+  /// Cosine (X) and sine (Y) of the vertical angle of each laser.
+  TArray<FVector2D> LaserPitchTable;
+
+  /// Tangent of half the vertical field of view of the faces.
+  float FaceTanHalfFOV = 1.0f;
+
+  uint32 FaceWidth = 0u;
+
+  uint32 FaceHeight = 0u;
+
+  /// Horizontal angle of the sweep in degrees.
+  float HorizontalAngle = 0.0f;
+
+  UPROPERTY()
+  TArray<USceneCaptureComponent2D *> CaptureComponents;
+
+  UPROPERTY()
+  TArray<UTextureRenderTarget2D *> CaptureRenderTargets;
+};
@@ -0,0 +1,106 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/EncodedCamera.h"
+
+#include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
+
+#include "Async/Async.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Modules/ModuleManager.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <compiler/enable-ue4-macros.h>
+
+FActorDefinition AEncodedCamera::GetSensorDefinition()
+{
+  constexpr bool bEnableModifyingPostProcessEffects = true;
+  auto Definition = UActorBlueprintFunctionLibrary::MakeCameraDefinition(
+      TEXT("rgb_encoded"),
+      bEnableModifyingPostProcessEffects);
+
+  FActorVariation Codec;
+  Codec.Id = TEXT("codec");
+  Codec.Type = EActorAttributeType::String;
+  Codec.RecommendedValues = { TEXT("jpeg") };
+  Codec.bRestrictToRecommended = true;
+
+  FActorVariation Quality;
+  Quality.Id = TEXT("quality");
+  Quality.Type = EActorAttributeType::Int;
+  Quality.RecommendedValues = { TEXT("85") };
+  Quality.bRestrictToRecommended = false;
+
+  Definition.Variations.Append({Codec, Quality});
+  return Definition;
+}
+
+AEncodedCamera::AEncodedCamera(const FObjectInitializer &ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  AddPostProcessingMaterial(
+      TEXT("Material'/Carla/PostProcessingMaterials/PhysicLensDistortion.PhysicLensDistortion'"));
+}
+
+void AEncodedCamera::Set(const FActorDescription &Description)
+{
+  Super::Set(Description);
+  Quality = FMath::Clamp(
+      UActorBlueprintFunctionLibrary::RetrieveActorAttributeToInt("quality", Description.Variations, Quality),
+      1,
+      100);
+}
+
+void AEncodedCamera::BeginPlay()
+{
+  ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+  Super::BeginPlay();
+}
+
+void AEncodedCamera::Tick(float DeltaTime)
+{
+  Super::Tick(DeltaTime);
+  FPixelReader::SendPixelsInRenderThread(*this, [](AEncodedCamera &Sensor, auto Stream, carla::Buffer Pixels)
+  {
+    // Encoding a frame takes longer than reading it, keep it off the render
+    // thread.
+    AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [&Sensor, Stream=std::move(Stream), Pixels=std::move(Pixels)]() mutable
+    {
+      /// @todo Can we make sure the sensor is not going to be destroyed?
+      if (!Sensor.IsPendingKill() && Sensor.EncodePixels(Pixels))
+      {
+        Stream.Send(Sensor, std::move(Pixels));
+      }
+    });
+  });
+}
+
+bool AEncodedCamera::EncodePixels(carla::Buffer &Buffer) const
+{
+  constexpr auto Offset = carla::sensor::s11n::EncodedImageSerializer::header_offset;
+  const uint32 Width = GetOutputImageWidth();
+  const uint32 Height = GetOutputImageHeight();
+  const uint32 RawSize = sizeof(FColor) * Width * Height;
+  check(ImageWrapperModule != nullptr);
+  if (Buffer.size() != (Offset + RawSize))
+  {
+    return false;
+  }
+
+  TSharedPtr<IImageWrapper> Encoder = ImageWrapperModule->CreateImageWrapper(EImageFormat::JPEG);
+  if (!Encoder.IsValid() ||
+      !Encoder->SetRaw(Buffer.data() + Offset, RawSize, Width, Height, ERGBFormat::BGRA, 8))
+  {
+    UE_LOG(LogCarla, Error, TEXT("AEncodedCamera: failed to encode image"));
+    return false;
+  }
+  const TArray<uint8> &Encoded = Encoder->GetCompressed(Quality);
+  Buffer.copy_from(Offset, Encoded);
+  return true;
+}
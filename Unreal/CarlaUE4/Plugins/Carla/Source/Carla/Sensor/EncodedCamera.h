@@ -0,0 +1,61 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Actor/ActorDefinition.h"
+#include "Carla/Sensor/PixelReader.h"
+#include "Carla/Sensor/ShaderBasedSensor.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/s11n/EncodedImageSerializer.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include "EncodedCamera.generated.h"
+
+class IImageWrapperModule;
+
+/// A camera that sends its images compressed, for streaming cameras
+/// continuously to remote clients. The image is rendered and read back as
+/// the "rgb" camera does, then encoded in a background task so neither the
+/// game nor the render thread waits for the encoder.
+UCLASS()
+class CARLA_API AEncodedCamera : public AShaderBasedSensor
+{
+  GENERATED_BODY()
+
+public:
+
+  static FActorDefinition GetSensorDefinition();
+
+  AEncodedCamera(const FObjectInitializer &ObjectInitializer);
+
+  void Set(const FActorDescription &ActorDescription) override;
+
+  carla::sensor::s11n::ImageCodec GetImageCodec() const
+  {
+    return carla::sensor::s11n::ImageCodec::JPEG;
+  }
+
+protected:
+
+  void BeginPlay() override;
+
+  void Tick(float DeltaTime) override;
+
+private:
+
+  /// Replace the BGRA pixels of @a Buffer, after the header offset, with the
+  /// encoded image. Return whether it succeeded.
+  bool EncodePixels(carla::Buffer &Buffer) const;
+
+  /// Quality of the JPEG images, in [1, 100].
+  UPROPERTY(EditAnywhere)
+  int32 Quality = 85;
+
+  /// Loaded in the game-thread, used by the encoding tasks.
+  IImageWrapperModule *ImageWrapperModule = nullptr;
+};
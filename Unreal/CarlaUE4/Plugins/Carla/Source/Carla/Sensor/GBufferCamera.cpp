@@ -0,0 +1,427 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/GBufferCamera.h"
+
+#include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
+#include "Carla/Game/FrameCounter.h"
+#include "Carla/Sensor/CameraRig.h"
+#include "Carla/Sensor/PixelReader.h"
+#include "Carla/Sensor/SceneCaptureSensor.h"
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Game/Tagger.h"
+
+#include "CanvasTypes.h"
+#include "ConstructorHelpers.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "EngineModule.h"
+#include "LegacyScreenPercentageDriver.h"
+#include "Materials/Material.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/ActorBoundingBox2D.h>
+#include <carla/sensor/s11n/ActorBoundingBoxesSerializer.h>
+#include <carla/sensor/s11n/ImageSerializer.h>
+#include <carla/sensor/s11n/SensorBundleSerializer.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <vector>
+
+static UTextureRenderTarget2D *FGBufferCamera_MakeRenderTarget(UObject &Owner, const TCHAR *Name)
+{
+  auto *RenderTarget = Owner.CreateDefaultSubobject<UTextureRenderTarget2D>(Name);
+  RenderTarget->CompressionSettings = TextureCompressionSettings::TC_Default;
+  RenderTarget->SRGB = false;
+  RenderTarget->bAutoGenerateMips = false;
+  RenderTarget->AddressX = TextureAddress::TA_Clamp;
+  RenderTarget->AddressY = TextureAddress::TA_Clamp;
+  return RenderTarget;
+}
+
+static UMaterial *FGBufferCamera_LoadMaterial(const TCHAR *Path)
+{
+  ConstructorHelpers::FObjectFinder<UMaterial> Loader(Path);
+  return Loader.Succeeded() ? Loader.Object : nullptr;
+}
+
+FActorDefinition AGBufferCamera::GetSensorDefinition()
+{
+  return UActorBlueprintFunctionLibrary::MakeGBufferCameraDefinition(TEXT("gbuffer"));
+}
+
+AGBufferCamera::AGBufferCamera(const FObjectInitializer &ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  PrimaryActorTick.bCanEverTick = true;
+  // Render once every actor moved this frame, like the scene captures do.
+  PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+  ColorRenderTarget = FGBufferCamera_MakeRenderTarget(*this, TEXT("ColorRenderTarget"));
+  DataRenderTarget = FGBufferCamera_MakeRenderTarget(*this, TEXT("DataRenderTarget"));
+
+  // The same materials as the depth and semantic segmentation cameras.
+  DepthMaterial = FGBufferCamera_LoadMaterial(
+#if PLATFORM_LINUX
+      TEXT("Material'/Carla/PostProcessingMaterials/DepthEffectMaterial_GLSL.DepthEffectMaterial_GLSL'")
+#else
+      TEXT("Material'/Carla/PostProcessingMaterials/DepthEffectMaterial.DepthEffectMaterial'")
+#endif
+  );
+  LabelMaterial = FGBufferCamera_LoadMaterial(
+      TEXT("Material'/Carla/PostProcessingMaterials/GTMaterial.GTMaterial'"));
+}
+
+void AGBufferCamera::Set(const FActorDescription &Description)
+{
+  Super::Set(Description);
+  SetImageSize(
+      UActorBlueprintFunctionLibrary::RetrieveActorAttributeToInt("image_size_x", Description.Variations, 800),
+      UActorBlueprintFunctionLibrary::RetrieveActorAttributeToInt("image_size_y", Description.Variations, 600));
+  FOVAngle = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToFloat(
+      "fov",
+      Description.Variations,
+      90.0f);
+  const FString Format = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToString(
+      "pixel_format",
+      Description.Variations,
+      TEXT("bgra"));
+  PixelFormat = (Format == TEXT("rgb")) ?
+      carla::sensor::data::PixelFormat::RGB8 :
+      carla::sensor::data::PixelFormat::BGRA8;
+  bActorBoundingBoxes = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToBool(
+      "actor_bounding_boxes",
+      Description.Variations,
+      false);
+  BoundingBoxDistance = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToFloat(
+      "bounding_box_distance",
+      Description.Variations,
+      100.0f);
+}
+
+void AGBufferCamera::SetImageSize(uint32 InWidth, uint32 InHeight)
+{
+  ImageWidth = InWidth;
+  ImageHeight = InHeight;
+}
+
+void AGBufferCamera::BeginPlay()
+{
+  ColorRenderTarget->InitCustomFormat(ImageWidth, ImageHeight, PF_B8G8R8A8, false);
+  ColorRenderTarget->TargetGamma = 2.2f;
+  // Linear, the materials encode the data in the colors.
+  DataRenderTarget->InitCustomFormat(2u * ImageWidth, ImageHeight, PF_B8G8R8A8, true);
+
+  ViewStates.SetNum(3);
+  const auto FeatureLevel = GetWorld()->FeatureLevel;
+  for (auto &ViewState : ViewStates)
+  {
+    ViewState.Allocate(FeatureLevel);
+  }
+
+  Super::BeginPlay();
+}
+
+void AGBufferCamera::Tick(float DeltaTime)
+{
+  Super::Tick(DeltaTime);
+  RenderViews();
+  SendPixelsInRenderThread();
+}
+
+void AGBufferCamera::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+  Super::EndPlay(EndPlayReason);
+  for (auto &ViewState : ViewStates)
+  {
+    ViewState.Destroy();
+  }
+  ViewStates.Empty();
+}
+
+void AGBufferCamera::RenderViews()
+{
+  auto *World = GetWorld();
+  auto *ColorResource = ColorRenderTarget->GameThread_GetRenderTargetResource();
+  auto *DataResource = DataRenderTarget->GameThread_GetRenderTargetResource();
+  if ((World == nullptr) || (World->Scene == nullptr) || (ColorResource == nullptr) || (DataResource == nullptr))
+  {
+    return;
+  }
+
+  const FVector Location = GetActorLocation();
+  const FRotator Rotation = GetActorRotation();
+  const int32 Width = static_cast<int32>(ImageWidth);
+  const int32 Height = static_cast<int32>(ImageHeight);
+
+  auto Render = [&](FRenderTarget *Resource, const bool bPostProcessing, auto AddViews)
+  {
+    FEngineShowFlags ShowFlags(ESFIM_Game);
+    ASceneCaptureSensor::ConfigureShowFlags(ShowFlags, bPostProcessing);
+    FSceneViewFamilyContext ViewFamily(FSceneViewFamily::ConstructionValues(
+        Resource,
+        World->Scene,
+        ShowFlags)
+      .SetResolveScene(true)
+      .SetRealtimeUpdate(true));
+    ViewFamily.SceneCaptureSource = ESceneCaptureSource::SCS_FinalColorLDR;
+    ViewFamily.SetScreenPercentageInterface(new FLegacyScreenPercentageDriver(ViewFamily, 1.0f, false));
+    AddViews(ViewFamily);
+    FCanvas Canvas(Resource, nullptr, World, World->FeatureLevel);
+    GetRendererModule().BeginRenderingViewFamily(&Canvas, &ViewFamily);
+  };
+
+  Render(ColorResource, true, [&](FSceneViewFamily &ViewFamily)
+  {
+    ACameraRig::AddView(
+        ViewFamily,
+        ViewStates[0].GetReference(),
+        FIntRect(0, 0, Width, Height),
+        Location,
+        Rotation,
+        FOVAngle);
+  });
+
+  Render(DataResource, false, [&](FSceneViewFamily &ViewFamily)
+  {
+    ACameraRig::AddView(
+        ViewFamily,
+        ViewStates[1].GetReference(),
+        FIntRect(0, 0, Width, Height),
+        Location,
+        Rotation,
+        FOVAngle,
+        DepthMaterial);
+    ACameraRig::AddView(
+        ViewFamily,
+        ViewStates[2].GetReference(),
+        FIntRect(Width, 0, 2 * Width, Height),
+        Location,
+        Rotation,
+        FOVAngle,
+        LabelMaterial);
+  });
+}
+
+TArray<AGBufferCamera::FProjectedActor> AGBufferCamera::ProjectActors() const
+{
+  constexpr float TO_METERS = 1e-2f;
+  // Corners behind the camera are brought to this depth, their projection
+  // falls outside the image and is clamped.
+  constexpr float NEAR_PLANE = 10.0f;
+
+  TArray<FProjectedActor> Result;
+  const FVector Location = GetActorLocation();
+  const FRotator Rotation = GetActorRotation();
+  const float Focal = 0.5f * ImageWidth / FMath::Tan(FMath::DegreesToRadians(0.5f * FOVAngle));
+  const float MaxDistance = BoundingBoxDistance / TO_METERS;
+  for (auto &&View : GetEpisode().GetActorRegistry())
+  {
+    const auto Type = View.GetActorType();
+    if (((Type != FActorView::ActorType::Vehicle) && (Type != FActorView::ActorType::Walker)) ||
+        !View.IsValid() || (View.GetActorInfo() == nullptr) || View.GetActor()->bHidden)
+    {
+      continue;
+    }
+    const AActor *Actor = View.GetActor();
+    if (FVector::DistSquared(Actor->GetActorLocation(), Location) > FMath::Square(MaxDistance))
+    {
+      continue;
+    }
+    const auto &Box = View.GetActorInfo()->BoundingBox;
+    const FTransform Transform = Actor->GetActorTransform();
+    float Near = TNumericLimits<float>::Max();
+    float Far = 0.0f;
+    FVector2D Min{TNumericLimits<float>::Max(), TNumericLimits<float>::Max()};
+    FVector2D Max{-TNumericLimits<float>::Max(), -TNumericLimits<float>::Max()};
+    for (int32 Corner = 0; Corner < 8; ++Corner)
+    {
+      const FVector Offset{
+          (Corner & 1) ? Box.Extent.X : -Box.Extent.X,
+          (Corner & 2) ? Box.Extent.Y : -Box.Extent.Y,
+          (Corner & 4) ? Box.Extent.Z : -Box.Extent.Z};
+      // X forward, Y right and Z up in the camera.
+      const FVector Point = Rotation.UnrotateVector(Transform.TransformPosition(Box.Origin + Offset) - Location);
+      Near = FMath::Min(Near, Point.X);
+      Far = FMath::Max(Far, Point.X);
+      const float Depth = FMath::Max(Point.X, NEAR_PLANE);
+      const FVector2D Pixel{
+          0.5f * ImageWidth + Focal * Point.Y / Depth,
+          0.5f * ImageHeight - Focal * Point.Z / Depth};
+      Min = FVector2D::Min(Min, Pixel);
+      Max = FVector2D::Max(Max, Pixel);
+    }
+    const FIntRect Rect{
+        FMath::Max(0, FMath::FloorToInt(Min.X)),
+        FMath::Max(0, FMath::FloorToInt(Min.Y)),
+        FMath::Min(static_cast<int32>(ImageWidth), FMath::CeilToInt(Max.X)),
+        FMath::Min(static_cast<int32>(ImageHeight), FMath::CeilToInt(Max.Y))};
+    if ((Far < NEAR_PLANE) || (Rect.Min.X >= Rect.Max.X) || (Rect.Min.Y >= Rect.Max.Y))
+    {
+      continue;
+    }
+    const auto Tag = Type == FActorView::ActorType::Vehicle ?
+        ECityObjectLabel::Vehicles :
+        ECityObjectLabel::Pedestrians;
+    Result.Add({View.GetActorId(), static_cast<uint8>(Tag), Rect, FMath::Max(0.0f, Near) * TO_METERS, Far * TO_METERS});
+  }
+  return Result;
+}
+
+/// Count the pixels of each actor of @a Actors in the depth and labels
+/// images of a camera.
+template <typename ProjectedActorT>
+static std::vector<carla::sensor::data::ActorBoundingBox2D> FGBufferCamera_MeasureActors(
+    const TArray<ProjectedActorT> &Actors,
+    const float *Depth,
+    const uint8 *Labels,
+    const uint32 Width)
+{
+  // Slack in meters of the depth range of the actors, the bounding boxes
+  // are not tight.
+  constexpr float DEPTH_MARGIN = 0.5f;
+
+  std::vector<carla::sensor::data::ActorBoundingBox2D> Result;
+  Result.reserve(Actors.Num());
+  for (const auto &Actor : Actors)
+  {
+    carla::sensor::data::ActorBoundingBox2D Box{};
+    Box.actor_id = Actor.ActorId;
+    Box.semantic_tag = Actor.SemanticTag;
+    Box.distance = Actor.Near;
+    FIntPoint Min{TNumericLimits<int32>::Max(), TNumericLimits<int32>::Max()};
+    FIntPoint Max{-1, -1};
+    uint32 Visible = 0u;
+    uint32 Occluded = 0u;
+    for (int32 Y = Actor.Rect.Min.Y; Y < Actor.Rect.Max.Y; ++Y)
+    {
+      const uint32 Row = static_cast<uint32>(Y) * Width;
+      for (int32 X = Actor.Rect.Min.X; X < Actor.Rect.Max.X; ++X)
+      {
+        const float PixelDepth = Depth[Row + X];
+        if (PixelDepth < Actor.Near - DEPTH_MARGIN)
+        {
+          ++Occluded;
+        }
+        else if ((Labels[Row + X] == Actor.SemanticTag) && (PixelDepth <= Actor.Far + DEPTH_MARGIN))
+        {
+          ++Visible;
+          Min = FIntPoint{FMath::Min(Min.X, X), FMath::Min(Min.Y, Y)};
+          Max = FIntPoint{FMath::Max(Max.X, X), FMath::Max(Max.Y, Y)};
+        }
+      }
+    }
+    if (Visible == 0u)
+    {
+      continue;
+    }
+    Box.x_min = static_cast<uint16_t>(Min.X);
+    Box.y_min = static_cast<uint16_t>(Min.Y);
+    Box.x_max = static_cast<uint16_t>(Max.X);
+    Box.y_max = static_cast<uint16_t>(Max.Y);
+    Box.visible_pixels = Visible;
+    Box.occluded_pixels = Occluded;
+    Result.emplace_back(Box);
+  }
+  return Result;
+}
+
+void AGBufferCamera::SendPixelsInRenderThread()
+{
+  using HeaderSerializer = carla::sensor::s11n::SensorHeaderSerializer;
+  using ImageSerializer = carla::sensor::s11n::ImageSerializer;
+  using Reading = carla::sensor::s11n::SensorBundleSerializer::Reading;
+  using carla::sensor::SensorRegistry;
+
+  // The headers need the frame and the transform of the game-thread.
+  const double Timestamp = GetEpisode().GetElapsedGameTime();
+  auto MakeHeader = [&](const size_t TypeIndex)
+  {
+    return HeaderSerializer::Serialize(TypeIndex, FFrameCounter::Get(), Timestamp, GetActorTransform());
+  };
+  TArray<carla::Buffer> Headers;
+  Headers.Add(MakeHeader(SensorRegistry::get<ASceneCaptureCamera *>::index));
+  Headers.Add(MakeHeader(SensorRegistry::get<ADepthCamera *>::index));
+  Headers.Add(MakeHeader(SensorRegistry::get<ASemanticSegmentationCamera *>::index));
+  TArray<FProjectedActor> Actors;
+  if (bActorBoundingBoxes)
+  {
+    Headers.Add(MakeHeader(SensorRegistry::get<FActorBoundingBoxes *>::index));
+    Actors = ProjectActors();
+  }
+  const ImageSerializer::ImageHeader ImageHeaders[] = {
+    {ImageWidth, ImageHeight, FOVAngle, PixelFormat},
+    {ImageWidth, ImageHeight, FOVAngle, carla::sensor::data::PixelFormat::Depth32F},
+    {ImageWidth, ImageHeight, FOVAngle, carla::sensor::data::PixelFormat::Label8}
+  };
+
+  ENQUEUE_RENDER_COMMAND(FGBufferCamera_SendPixelsInRenderThread)
+  (
+    [this, Stream=GetDataStream(*this), Headers=MoveTemp(Headers), ImageHeaders, Actors=MoveTemp(Actors)](auto &InRHICmdList) mutable
+    {
+      /// @todo Can we make sure the sensor is not going to be destroyed?
+      if (IsPendingKill())
+      {
+        return;
+      }
+      std::vector<Reading> Readings;
+      Readings.reserve(Headers.Num());
+
+      auto Image = Stream.PopBufferFromPool();
+      FPixelReader::WritePixelsToBuffer(
+          *ColorRenderTarget,
+          Image,
+          ImageSerializer::header_offset,
+          ImageHeaders[0].pixel_format,
+          InRHICmdList);
+      FMemory::Memcpy(Image.data(), &ImageHeaders[0], sizeof(ImageHeaders[0]));
+      Readings.emplace_back(Reading{std::move(Headers[0]), std::move(Image)});
+
+      auto Atlas = Stream.PopBufferFromPool();
+      FPixelReader::WritePixelsToBuffer(
+          *DataRenderTarget,
+          Atlas,
+          0u,
+          carla::sensor::data::PixelFormat::BGRA8,
+          InRHICmdList);
+      using carla::sensor::data::Color;
+      const uint32 AtlasWidth = 2u * ImageWidth;
+      const auto *Pixels = reinterpret_cast<const Color *>(Atlas.data());
+      check(Atlas.size() >= (sizeof(Color) * AtlasWidth * ImageHeight));
+      for (uint32 Tile = 0u; Tile < 2u; ++Tile)
+      {
+        const auto &ImageHeader = ImageHeaders[1u + Tile];
+        const uint32 DstStride = ImageHeader.width * carla::sensor::data::GetBytesPerPixel(ImageHeader.pixel_format);
+        auto Data = Stream.PopBufferFromPool();
+        Data.reset(ImageSerializer::header_offset + DstStride * ImageHeader.height);
+        FMemory::Memcpy(Data.data(), &ImageHeader, sizeof(ImageHeader));
+        auto *DstRow = Data.data() + ImageSerializer::header_offset;
+        for (uint32 Row = 0u; Row < ImageHeader.height; ++Row)
+        {
+          const auto *SrcRow = Pixels + Row * AtlasWidth + Tile * ImageWidth;
+          carla::sensor::data::ConvertPixels(ImageHeader.pixel_format, SrcRow, ImageHeader.width, DstRow);
+          DstRow += DstStride;
+        }
+        Readings.emplace_back(Reading{std::move(Headers[1u + Tile]), std::move(Data)});
+      }
+      if (bActorBoundingBoxes)
+      {
+        using BoxesSerializer = carla::sensor::s11n::ActorBoundingBoxesSerializer;
+        const auto Boxes = FGBufferCamera_MeasureActors(
+            Actors,
+            reinterpret_cast<const float *>(Readings[1u].data.data() + ImageSerializer::header_offset),
+            Readings[2u].data.data() + ImageSerializer::header_offset,
+            ImageWidth);
+        Readings.emplace_back(Reading{
+            std::move(Headers[3u]),
+            BoxesSerializer::Serialize({ImageWidth, ImageHeight}, Boxes, Stream.PopBufferFromPool())});
+      }
+      Stream.Send(*this, Readings, Stream.PopBufferFromPool());
+    }
+  );
+}
@@ -0,0 +1,141 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Sensor/Sensor.h"
+
+#include "Carla/Actor/ActorDefinition.h"
+#include "Carla/Actor/ActorDescription.h"
+
+#include "SceneView.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/data/PixelFormat.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include "GBufferCamera.generated.h"
+
+class UMaterial;
+class UTextureRenderTarget2D;
+
+/// Key of the carla::sensor::data::ActorBoundingBoxes readings in the
+/// SensorRegistry.
+class FActorBoundingBoxes;
+
+/// A camera producing the RGB, depth and semantic segmentation images of the
+/// same view, replacing the usual three cameras at the same location. The
+/// depth and labels are unlit views of a single view family, rendered
+/// side by side into a second target with the materials of the depth and
+/// semantic segmentation cameras, so the scene is traversed once for both.
+/// Both targets are read back in the same render command and each frame the
+/// camera sends a single SensorBundle with the RGB image, the DepthImage and
+/// the LabelImage, in this order.
+///
+/// With "actor_bounding_boxes" enabled the bundle holds a fourth reading, the
+/// ActorBoundingBoxes of the vehicles and walkers in view. The bounding box
+/// of each actor is projected in the game thread, and its pixels are the
+/// ones inside the projection with the label of the actor and a depth
+/// within its bounding box; closer pixels occlude it.
+///
+/// @warning All the setters should be called before BeginPlay.
+UCLASS()
+class CARLA_API AGBufferCamera : public ASensor
+{
+  GENERATED_BODY()
+
+public:
+
+  AGBufferCamera(const FObjectInitializer &ObjectInitializer);
+
+  static FActorDefinition GetSensorDefinition();
+
+  void Set(const FActorDescription &ActorDescription) override;
+
+  void SetImageSize(uint32 Width, uint32 Height);
+
+  uint32 GetImageWidth() const
+  {
+    return ImageWidth;
+  }
+
+  uint32 GetImageHeight() const
+  {
+    return ImageHeight;
+  }
+
+  float GetFOVAngle() const
+  {
+    return FOVAngle;
+  }
+
+  /// Format of the RGB image, the depth and labels have their own.
+  carla::sensor::data::PixelFormat GetPixelFormat() const
+  {
+    return PixelFormat;
+  }
+
+protected:
+
+  void BeginPlay() override;
+
+  void Tick(float DeltaTime) override;
+
+  void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+private:
+
+  void RenderViews();
+
+  void SendPixelsInRenderThread();
+
+  /// An actor whose bounding box projects into the image.
+  struct FProjectedActor
+  {
+    uint32 ActorId;
+
+    uint8 SemanticTag;
+
+    FIntRect Rect;
+
+    /// Depth range in meters of its bounding box.
+    float Near;
+
+    float Far;
+  };
+
+  TArray<FProjectedActor> ProjectActors() const;
+
+  uint32 ImageWidth = 800u;
+
+  uint32 ImageHeight = 600u;
+
+  float FOVAngle = 90.0f;
+
+  carla::sensor::data::PixelFormat PixelFormat = carla::sensor::data::PixelFormat::BGRA8;
+
+  bool bActorBoundingBoxes = false;
+
+  /// In meters, farther actors get no bounding box.
+  float BoundingBoxDistance = 100.0f;
+
+  UPROPERTY()
+  UMaterial *DepthMaterial = nullptr;
+
+  UPROPERTY()
+  UMaterial *LabelMaterial = nullptr;
+
+  UPROPERTY()
+  UTextureRenderTarget2D *ColorRenderTarget = nullptr;
+
+  /// Depth on the left half, labels on the right.
+  UPROPERTY()
+  UTextureRenderTarget2D *DataRenderTarget = nullptr;
+
+  /// Keeps the temporal state (eye adaptation, anti-aliasing) of the RGB,
+  /// depth and labels views.
+  TArray<FSceneViewStateReference> ViewStates;
+};
@@ -33,10 +33,14 @@ void AGnssSensor::Set(const FActorDescription &ActorDescription)
 void AGnssSensor::Tick(float DeltaSeconds)
 {
   Super::Tick(DeltaSeconds);
+  SendFrameData(DeltaSeconds);
+}
 
+void AGnssSensor::SendFrameData(float)
+{
   carla::geom::Location Location = GetActorLocation();
 
-  carla::geom::GeoLocation CurrentLocation = CurrentGeoReference.Transform(Location);
+  carla::geom::GeoLocation CurrentLocation = GeoProjection.Transform(Location);
 
   // Compute the noise for the sensor
   const float LatError = RandomEngine->GetNormalDistribution(0.0f, LatitudeDeviation);
@@ -114,5 +118,5 @@ void AGnssSensor::BeginPlay()
   Super::BeginPlay();
 
   const UCarlaEpisode* episode = UCarlaStatics::GetCurrentEpisode(GetWorld());
-  CurrentGeoReference = episode->GetGeoReference();
+  GeoProjection = episode->GetGeoProjection();
 }
@@ -12,7 +12,7 @@
 #include "Carla/Actor/ActorDescription.h"
 
 #include <compiler/disable-ue4-macros.h>
-#include "carla/geom/GeoLocation.h"
+#include "carla/geom/GeoProjection.h"
 #include <compiler/enable-ue4-macros.h>
 
 #include "GnssSensor.generated.h"
@@ -34,6 +34,8 @@ public:
 
   void Tick(float DeltaSeconds) override;
 
+  void SendFrameData(float DeltaSeconds) override;
+
   void SetLatitudeDeviation(float Value);
   void SetLongitudeDeviation(float Value);
   void SetAltitudeDeviation(float Value);
@@ -58,7 +60,7 @@ protected:
 
 private:
 
-  carla::geom::GeoLocation CurrentGeoReference;
+  carla::geom::GeoProjection GeoProjection;
 
   float LatitudeDeviation;
   float LongitudeDeviation;
@@ -174,7 +174,11 @@ float AInertialMeasurementUnit::ComputeCompass()
 void AInertialMeasurementUnit::Tick(float DeltaTime)
 {
   Super::Tick(DeltaTime);
+  SendFrameData(DeltaTime);
+}
 
+void AInertialMeasurementUnit::SendFrameData(float DeltaTime)
+{
   auto Stream = GetDataStream(*this);
   Stream.Send(
       *this,
@@ -36,6 +36,8 @@ public:
 
   void Tick(float DeltaTime) override;
 
+  void SendFrameData(float DeltaTime) override;
+
   const carla::geom::Vector3D ComputeAccelerometerNoise(
       const FVector &Accelerometer);
 
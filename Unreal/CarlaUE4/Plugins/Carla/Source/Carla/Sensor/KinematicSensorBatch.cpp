@@ -0,0 +1,33 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/KinematicSensorBatch.h"
+
+#include "Carla/Sensor/Sensor.h"
+
+void FKinematicSensorBatch::Add(ASensor &Sensor)
+{
+  check(Sensor.IsBatched());
+  Sensors.Emplace(&Sensor);
+}
+
+void FKinematicSensorBatch::Tick(const float DeltaSeconds)
+{
+  Sensors.RemoveAllSwap([](const TWeakObjectPtr<ASensor> &Sensor) {
+    return !Sensor.IsValid();
+  });
+  if ((Sensors.Num() == 0) || !Sensors[0]->AreClientsListening())
+  {
+    // Every member shares the stream of the bundle.
+    return;
+  }
+  for (auto &Sensor : Sensors)
+  {
+    FSensorMetrics::FTickScope TickScope(Sensor->GetMetrics());
+    Sensor->SendFrameData(DeltaSeconds);
+  }
+}
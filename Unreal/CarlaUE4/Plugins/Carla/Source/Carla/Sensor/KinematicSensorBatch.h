@@ -0,0 +1,49 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Util/NonCopyable.h"
+
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class ASensor;
+
+/// The sensors spawned with the "batched" attribute, cheap sensors that only
+/// read the state of their parent, like the GNSS and the IMU. Instead of
+/// ticking each on its own, the engine computes all of them in a single pass
+/// after physics. Every batched sensor belongs to the same bundle, so the
+/// readings of the whole fleet reach the clients in a single message per
+/// frame, keyed by sensor id.
+///
+/// The "sensor_tick" of batched sensors is ignored, they are computed every
+/// frame while somebody listens.
+class FKinematicSensorBatch : private NonCopyable
+{
+public:
+
+  /// Name of the bundle shared by every batched sensor.
+  static const TCHAR *GetBundleName()
+  {
+    return TEXT("__batched__");
+  }
+
+  /// @pre @a Sensor is batched and already belongs to the bundle.
+  void Add(ASensor &Sensor);
+
+  /// Compute the data of every batched sensor, called after physics and the
+  /// tick of the actors.
+  void Tick(float DeltaSeconds);
+
+  void Clear()
+  {
+    Sensors.Empty();
+  }
+
+private:
+
+  TArray<TWeakObjectPtr<ASensor>> Sensors;
+};
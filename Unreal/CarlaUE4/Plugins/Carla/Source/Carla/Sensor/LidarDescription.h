@@ -39,6 +39,20 @@ struct CARLA_API FLidarDescription
   UPROPERTY(EditAnywhere)
   float LowerFovLimit = -30.0f;
 
+  /// Whether to send the points as 16-bit fixed-point coordinates plus an
+  /// intensity byte instead of 32-bit floats.
+  UPROPERTY(EditAnywhere)
+  bool bPackPoints = false;
+
+  /// Size in meters of a unit of the packed coordinates.
+  UPROPERTY(EditAnywhere)
+  float PointScale = 0.01f;
+
+  /// Whether to gather the points of a whole rotation and send them once per
+  /// sweep instead of sending the points of every tick.
+  UPROPERTY(EditAnywhere)
+  bool bFullSweep = false;
+
   /// Wether to show debug points of laser hits in simulator.
   UPROPERTY(EditAnywhere)
   bool ShowDebugPoints = false;
@@ -12,6 +12,8 @@
 #include "Carla/Game/CarlaEpisode.h"
 #include "Carla/Game/CarlaGameInstance.h"
 #include "Carla/Game/CarlaGameModeBase.h"
+#include "Carla/Game/CarlaStatics.h"
+#include "Carla/Sensor/ObstacleSweepBatch.h"
 
 AObstacleDetectionSensor::AObstacleDetectionSensor(const FObjectInitializer &ObjectInitializer)
   : Super(ObjectInitializer)
@@ -48,6 +50,27 @@ void AObstacleDetectionSensor::Set(const FActorDescription &Description)
       Description.Variations,
       bDebugLineTrace);
 #endif
+  bBatchSweeps = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToBool(
+      "batch_sweeps",
+      Description.Variations,
+      bBatchSweeps);
+}
+
+void AObstacleDetectionSensor::BeginPlay()
+{
+  Super::BeginPlay();
+  if (bBatchSweeps)
+  {
+    UCarlaGameInstance *GameInstance = UCarlaStatics::GetGameInstance(GetWorld());
+    if (GameInstance != nullptr)
+    {
+      SweepBatch = &GameInstance->GetObstacleSweepBatch();
+    }
+    else
+    {
+      UE_LOG(LogCarla, Warning, TEXT("AObstacleDetectionSensor: batch sweeps not available, incompatible game instance."));
+    }
+  }
 }
 
 void AObstacleDetectionSensor::Tick(float DeltaSeconds)
@@ -89,6 +112,12 @@ void AObstacleDetectionSensor::Tick(float DeltaSeconds)
   if(Super::GetOwner()!=nullptr)
     TraceParams.AddIgnoredActor(Super::GetOwner());
 
+  if (SweepBatch != nullptr)
+  {
+    SweepBatch->Sweep(*this, Start, End, HitRadius, bOnlyDynamics, TraceParams);
+    return;
+  }
+
   bool isHitReturned;
   // Choosing a type of sweep is a workaround until everything get properly
   // organized under correct collision channels and object types.
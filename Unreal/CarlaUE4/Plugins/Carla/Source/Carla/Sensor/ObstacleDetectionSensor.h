@@ -11,6 +11,7 @@
 #include "Carla/Actor/ActorDescription.h"
 #include "ObstacleDetectionSensor.generated.h"
 
+class FObstacleSweepBatch;
 class UCarlaEpisode;
 
 /// A sensor to register collisions.
@@ -29,8 +30,14 @@ public:
 
   void Tick(float DeltaSeconds) override;
 
+protected:
+
+  void BeginPlay() override;
+
 private:
 
+  friend class FObstacleSweepBatch;
+
   UFUNCTION()
   void OnObstacleDetectionEvent(
       AActor *Actor,
@@ -47,4 +54,10 @@ private:
   bool bOnlyDynamics = false;
 
   bool bDebugLineTrace = false;
+
+  /// If true, the sweeps go through the FObstacleSweepBatch of the engine and
+  /// the obstacles are reported one frame later.
+  bool bBatchSweeps = false;
+
+  FObstacleSweepBatch *SweepBatch = nullptr;
 };
@@ -0,0 +1,80 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/ObstacleSweepBatch.h"
+
+#include "Carla/Sensor/ObstacleDetectionSensor.h"
+
+FObstacleSweepBatch::FObstacleSweepBatch()
+{
+  OnSweepDoneDelegate.BindRaw(this, &FObstacleSweepBatch::OnSweepDone);
+}
+
+void FObstacleSweepBatch::Sweep(
+    AObstacleDetectionSensor &Sensor,
+    const FVector &Start,
+    const FVector &End,
+    const float Radius,
+    const bool bOnlyDynamics,
+    const FCollisionQueryParams &TraceParams)
+{
+  UWorld *World = Sensor.GetWorld();
+  check(World != nullptr);
+  const uint32 SweepId = NextSweepId++;
+  PendingSweeps.Emplace(SweepId, &Sensor);
+  // Same choice of channel as the sweeps of the sensor, see
+  // AObstacleDetectionSensor::Tick.
+  if (bOnlyDynamics)
+  {
+    World->AsyncSweepByObjectType(
+        EAsyncTraceType::Single,
+        Start,
+        End,
+        FQuat::Identity,
+        FCollisionObjectQueryParams(FCollisionObjectQueryParams::AllDynamicObjects),
+        FCollisionShape::MakeSphere(Radius),
+        TraceParams,
+        &OnSweepDoneDelegate,
+        SweepId);
+  }
+  else
+  {
+    World->AsyncSweepByChannel(
+        EAsyncTraceType::Single,
+        Start,
+        End,
+        FQuat::Identity,
+        ECC_WorldStatic,
+        FCollisionShape::MakeSphere(Radius),
+        TraceParams,
+        FCollisionResponseParams::DefaultResponseParam,
+        &OnSweepDoneDelegate,
+        SweepId);
+  }
+}
+
+void FObstacleSweepBatch::OnSweepDone(const FTraceHandle &, FTraceDatum &Datum)
+{
+  TWeakObjectPtr<AObstacleDetectionSensor> Sensor;
+  if (!PendingSweeps.RemoveAndCopyValue(Datum.UserData, Sensor))
+  {
+    // Issued before the batch was cleared.
+    return;
+  }
+  if (!Sensor.IsValid() || Sensor->IsPendingKill())
+  {
+    return;
+  }
+  for (const FHitResult &Hit : Datum.OutHits)
+  {
+    if (Hit.bBlockingHit)
+    {
+      Sensor->OnObstacleDetectionEvent(Sensor.Get(), Hit.Actor.Get(), Hit.Distance, Hit);
+      break;
+    }
+  }
+}
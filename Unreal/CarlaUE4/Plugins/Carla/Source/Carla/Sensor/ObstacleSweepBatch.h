@@ -0,0 +1,53 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Util/NonCopyable.h"
+
+#include "Engine/World.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class AObstacleDetectionSensor;
+
+/// Sweeps of the obstacle detectors in batch mode. Instead of blocking the
+/// game thread on a physics query each, the sensors hand their sweep to this
+/// batch as they tick, the sweeps are issued as asynchronous traces that the
+/// engine runs in parallel while the frame goes on, and the hits are delivered
+/// to the sensors at the beginning of the next frame.
+class FObstacleSweepBatch : private NonCopyable
+{
+public:
+
+  FObstacleSweepBatch();
+
+  /// Issue a sweep of a sphere of @a Radius from @a Start to @a End on behalf
+  /// of @a Sensor.
+  void Sweep(
+      AObstacleDetectionSensor &Sensor,
+      const FVector &Start,
+      const FVector &End,
+      float Radius,
+      bool bOnlyDynamics,
+      const FCollisionQueryParams &TraceParams);
+
+  /// Forget the pending sweeps, their results are discarded.
+  void Clear()
+  {
+    PendingSweeps.Empty();
+  }
+
+private:
+
+  void OnSweepDone(const FTraceHandle &Handle, FTraceDatum &Datum);
+
+  FTraceDelegate OnSweepDoneDelegate;
+
+  /// Sensor waiting for each sweep, by the user data given to the trace.
+  TMap<uint32, TWeakObjectPtr<AObstacleDetectionSensor>> PendingSweeps;
+
+  uint32 NextSweepId = 0u;
+};
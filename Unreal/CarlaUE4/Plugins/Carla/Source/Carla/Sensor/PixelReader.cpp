@@ -7,9 +7,15 @@
 #include "Carla.h"
 #include "Carla/Sensor/PixelReader.h"
 
+#include "CommonRenderResources.h"
 #include "Engine/TextureRenderTarget2D.h"
+#include "EngineModule.h"
+#include "GlobalShader.h"
 #include "HighResScreenshot.h"
+#include "PipelineStateCache.h"
+#include "RHIStaticStates.h"
 #include "Runtime/ImageWriteQueue/Public/ImageWriteQueue.h"
+#include "ScreenRendering.h"
 
 // For now we only support Vulkan on Windows.
 #if PLATFORM_WINDOWS
@@ -49,6 +55,7 @@ static void WritePixelsToBuffer_Vulkan(
     const UTextureRenderTarget2D &RenderTarget,
     carla::Buffer &Buffer,
     uint32 Offset,
+    carla::sensor::data::PixelFormat Format,
     FRHICommandListImmediate &InRHICmdList)
 {
   check(IsInRenderingThread());
@@ -69,11 +76,168 @@ static void WritePixelsToBuffer_Vulkan(
       Pixels,
       FReadSurfaceDataFlags(RCM_UNorm, CubeFace_MAX));
 
-  Buffer.copy_from(Offset, Pixels);
+  const auto Size = Offset + carla::sensor::data::GetBytesPerPixel(Format) * Pixels.Num();
+  Buffer.reset(static_cast<carla::Buffer::size_type>(Size));
+  carla::sensor::data::ConvertPixels(
+      Format,
+      reinterpret_cast<const carla::sensor::data::Color *>(Pixels.GetData()),
+      Pixels.Num(),
+      Buffer.begin() + Offset);
 }
 
 #endif // CARLA_WITH_VULKAN_SUPPORT
 
+/// Copy @a Height rows of @a ExpectedStride bytes into @a Buffer converted to
+/// @a Format, skipping the padding at the end of each source row if any.
+static void CopyRowsToBuffer(
+    const uint8 *Source,
+    uint32 SrcStride,
+    uint32 ExpectedStride,
+    uint32 Height,
+    carla::sensor::data::PixelFormat Format,
+    carla::Buffer &Buffer,
+    uint32 Offset)
+{
+  using namespace carla::sensor::data;
+  if ((Format == PixelFormat::BGRA8) && (ExpectedStride == SrcStride))
+  {
+    Buffer.copy_from(Offset, Source, ExpectedStride * Height);
+    return;
+  }
+  check(ExpectedStride <= SrcStride);
+  const uint32 Width = ExpectedStride / sizeof(Color);
+  const uint32 DstStride = Width * GetBytesPerPixel(Format);
+  Buffer.reset(Offset + DstStride * Height);
+  auto DstRow = Buffer.begin() + Offset;
+  const uint8 *SrcRow = Source;
+  for (uint32 Row = 0u; Row < Height; ++Row)
+  {
+    // Converting while copying keeps it to a single pass over the pixels.
+    ConvertPixels(Format, reinterpret_cast<const Color *>(SrcRow), Width, DstRow);
+    DstRow += DstStride;
+    SrcRow += SrcStride;
+  }
+}
+
+// =============================================================================
+// -- FPixelReadbackRing -------------------------------------------------------
+// =============================================================================
+
+void FPixelReadbackRing::Enqueue(
+    UTextureRenderTarget2D &RenderTarget,
+    carla::Buffer Buffer,
+    const uint32 Offset,
+    const carla::sensor::data::PixelFormat Format,
+    FSendFunction Send,
+    FRHICommandListImmediate &InRHICmdList)
+{
+  check(IsInRenderingThread());
+
+#if CARLA_WITH_VULKAN_SUPPORT == 1
+  if (IsVulkanPlatform(GMaxRHIShaderPlatform))
+  {
+    // The Vulkan path already reads through a copy, keep it synchronous.
+    const double Start = FPlatformTime::Seconds();
+    WritePixelsToBuffer_Vulkan(RenderTarget, Buffer, Offset, Format, InRHICmdList);
+    Send(std::move(Buffer), FPlatformTime::Seconds() - Start);
+    return;
+  }
+#endif // CARLA_WITH_VULKAN_SUPPORT
+
+  FRHITexture2D *Texture = RenderTarget.GetRenderTargetResource()->GetRenderTargetTexture();
+  checkf(Texture != nullptr, TEXT("FPixelReadbackRing: UTextureRenderTarget2D missing render target texture"));
+
+  FSlot &Slot = Slots[NextSlot];
+  NextSlot = (NextSlot + 1u) % NumberOfSlots;
+  if (Slot.bPending)
+  {
+    // The GPU is more than two frames behind, this blocks until it is done.
+    Resolve(Slot, InRHICmdList);
+  }
+
+  if (!Slot.StagingTexture.IsValid() ||
+      (Slot.StagingTexture->GetSizeXY() != Texture->GetSizeXY()) ||
+      (Slot.StagingTexture->GetFormat() != Texture->GetFormat()))
+  {
+    FRHIResourceCreateInfo CreateInfo;
+    Slot.StagingTexture = RHICreateTexture2D(
+        Texture->GetSizeX(),
+        Texture->GetSizeY(),
+        Texture->GetFormat(),
+        1,
+        1,
+        TexCreate_CPUReadback,
+        CreateInfo);
+  }
+  if (!Slot.Fence.IsValid())
+  {
+    Slot.Fence = RHICreateGPUFence(TEXT("CarlaPixelReadback"));
+  }
+
+  Slot.Fence->Clear();
+  InRHICmdList.CopyToResolveTarget(Texture, Slot.StagingTexture, FResolveParams());
+  InRHICmdList.WriteGPUFence(Slot.Fence);
+  Slot.Buffer = std::move(Buffer);
+  Slot.Offset = Offset;
+  Slot.Format = Format;
+  Slot.Send = MoveTemp(Send);
+  Slot.bPending = true;
+
+  // Send, in order, every older frame whose copy already finished.
+  for (uint32 i = 0u; i < NumberOfSlots - 1u; ++i)
+  {
+    FSlot &Oldest = Slots[(NextSlot + i) % NumberOfSlots];
+    if (!Oldest.bPending)
+    {
+      continue;
+    }
+    if (!Oldest.Fence->Poll())
+    {
+      break;
+    }
+    Resolve(Oldest, InRHICmdList);
+  }
+}
+
+void FPixelReadbackRing::Resolve(FSlot &Slot, FRHICommandListImmediate &InRHICmdList)
+{
+  check(Slot.bPending);
+  const uint32 BytesPerPixel = 4u; // PF_R8G8B8A8
+  const uint32 ExpectedStride = Slot.StagingTexture->GetSizeX() * BytesPerPixel;
+  const uint32 Height = Slot.StagingTexture->GetSizeY();
+
+  const double Start = FPlatformTime::Seconds();
+  void *Source = nullptr;
+  int32 MappedWidth = 0;
+  int32 MappedHeight = 0;
+  InRHICmdList.MapStagingSurface(Slot.StagingTexture, Source, MappedWidth, MappedHeight);
+  if (Source != nullptr)
+  {
+    CopyRowsToBuffer(
+        reinterpret_cast<const uint8 *>(Source),
+        static_cast<uint32>(MappedWidth) * BytesPerPixel,
+        ExpectedStride,
+        Height,
+        Slot.Format,
+        Slot.Buffer,
+        Slot.Offset);
+  }
+  else
+  {
+    UE_LOG(LogCarla, Error, TEXT("FPixelReadbackRing: failed to map staging texture"));
+  }
+  InRHICmdList.UnmapStagingSurface(Slot.StagingTexture);
+  const double ReadbackSeconds = FPlatformTime::Seconds() - Start;
+
+  auto Send = MoveTemp(Slot.Send);
+  Slot.bPending = false;
+  if (Source != nullptr)
+  {
+    Send(std::move(Slot.Buffer), ReadbackSeconds);
+  }
+  Slot.Buffer = carla::Buffer();
+}
+
 // =============================================================================
 // -- FPixelReader -------------------------------------------------------------
 // =============================================================================
@@ -130,10 +294,61 @@ TFuture<bool> FPixelReader::SavePixelsToDisk(
   return HighResScreenshotConfig.ImageWriteQueue->Enqueue(MoveTemp(ImageTask));
 }
 
+void FPixelReader::CropAndResize(
+    UTextureRenderTarget2D &Source,
+    const FIntRect &SourceRect,
+    UTextureRenderTarget2D &Destination,
+    FRHICommandListImmediate &InRHICmdList)
+{
+  check(IsInRenderingThread());
+  FTextureRenderTargetResource *SourceResource = Source.GetRenderTargetResource();
+  FTextureRenderTargetResource *DestinationResource = Destination.GetRenderTargetResource();
+  check((SourceResource != nullptr) && (DestinationResource != nullptr));
+  const FIntPoint SourceSize = SourceResource->GetSizeXY();
+  const FIntPoint DestinationSize = DestinationResource->GetSizeXY();
+
+  FRHIRenderPassInfo RenderPassInfo(
+      DestinationResource->GetRenderTargetTexture(),
+      ERenderTargetActions::DontLoad_Store);
+  InRHICmdList.BeginRenderPass(RenderPassInfo, TEXT("CarlaCropAndResize"));
+  InRHICmdList.SetViewport(0, 0, 0.0f, DestinationSize.X, DestinationSize.Y, 1.0f);
+
+  FGraphicsPipelineStateInitializer GraphicsPSOInit;
+  InRHICmdList.ApplyCachedRenderTargets(GraphicsPSOInit);
+  GraphicsPSOInit.BlendState = TStaticBlendState<>::GetRHI();
+  GraphicsPSOInit.RasterizerState = TStaticRasterizerState<>::GetRHI();
+  GraphicsPSOInit.DepthStencilState = TStaticDepthStencilState<false, CF_Always>::GetRHI();
+  GraphicsPSOInit.PrimitiveType = PT_TriangleList;
+
+  TShaderMapRef<FScreenVS> VertexShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+  TShaderMapRef<FScreenPS> PixelShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+  GraphicsPSOInit.BoundShaderState.VertexDeclarationRHI = GFilterVertexDeclaration.VertexDeclarationRHI;
+  GraphicsPSOInit.BoundShaderState.VertexShaderRHI = GETSAFERHISHADER_VERTEX(*VertexShader);
+  GraphicsPSOInit.BoundShaderState.PixelShaderRHI = GETSAFERHISHADER_PIXEL(*PixelShader);
+  SetGraphicsPipelineState(InRHICmdList, GraphicsPSOInit);
+
+  PixelShader->SetParameters(
+      InRHICmdList,
+      TStaticSamplerState<SF_Bilinear>::GetRHI(),
+      SourceResource->TextureRHI);
+  GetRendererModule().DrawRectangle(
+      InRHICmdList,
+      0.0f, 0.0f,
+      DestinationSize.X, DestinationSize.Y,
+      SourceRect.Min.X, SourceRect.Min.Y,
+      SourceRect.Width(), SourceRect.Height(),
+      DestinationSize,
+      SourceSize,
+      *VertexShader,
+      EDRF_Default);
+  InRHICmdList.EndRenderPass();
+}
+
 void FPixelReader::WritePixelsToBuffer(
     UTextureRenderTarget2D &RenderTarget,
     carla::Buffer &Buffer,
     uint32 Offset,
+    carla::sensor::data::PixelFormat Format,
     FRHICommandListImmediate &
 #if CARLA_WITH_VULKAN_SUPPORT == 1
     InRHICmdList
@@ -145,7 +360,7 @@ void FPixelReader::WritePixelsToBuffer(
 #if CARLA_WITH_VULKAN_SUPPORT == 1
   if (IsVulkanPlatform(GMaxRHIShaderPlatform))
   {
-    WritePixelsToBuffer_Vulkan(RenderTarget, Buffer, Offset, InRHICmdList);
+    WritePixelsToBuffer_Vulkan(RenderTarget, Buffer, Offset, Format, InRHICmdList);
     return;
   }
 #endif // CARLA_WITH_VULKAN_SUPPORT
@@ -164,23 +379,10 @@ void FPixelReader::WritePixelsToBuffer(
 #ifdef PLATFORM_WINDOWS
   // JB: Direct 3D uses additional rows in the buffer, so we need check the
   // result stride from the lock:
-  if (IsD3DPlatform(GMaxRHIShaderPlatform, false) && (ExpectedStride != SrcStride))
-  {
-    Buffer.reset(Offset + ExpectedStride * Height);
-    auto DstRow = Buffer.begin() + Offset;
-    const uint8 *SrcRow = Lock.Source;
-    for (uint32 Row = 0u; Row < Height; ++Row)
-    {
-      FMemory::Memcpy(DstRow, SrcRow, ExpectedStride);
-      DstRow += ExpectedStride;
-      SrcRow += SrcStride;
-    }
-  }
-  else
+  if (!IsD3DPlatform(GMaxRHIShaderPlatform, false))
 #endif // PLATFORM_WINDOWS
   {
     check(ExpectedStride == SrcStride);
-    const uint8 *Source = Lock.Source;
-    Buffer.copy_from(Offset, Source, ExpectedStride * Height);
   }
+  CopyRowsToBuffer(Lock.Source, SrcStride, ExpectedStride, Height, Format, Buffer, Offset);
 }
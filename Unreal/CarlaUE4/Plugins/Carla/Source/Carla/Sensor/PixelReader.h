@@ -7,14 +7,80 @@
 #pragma once
 
 #include "CoreGlobals.h"
+#include "HAL/PlatformTime.h"
 #include "Engine/TextureRenderTarget2D.h"
 #include "Runtime/ImageWriteQueue/Public/ImagePixelData.h"
+#include "RHIResources.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include <carla/Buffer.h>
+#include <carla/profiler/FrameTracer.h>
 #include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/PixelFormat.h>
 #include <compiler/enable-ue4-macros.h>
 
+// =============================================================================
+// -- FPixelReadbackRing -------------------------------------------------------
+// =============================================================================
+
+/// Triple-buffered asynchronous readback of a render target. Each frame the
+/// render target is copied into a staging texture and a GPU fence is written
+/// after the copy; the staging texture is mapped a couple of frames later,
+/// once the fence signaled, so the render thread never waits for the GPU to
+/// finish the capture.
+///
+/// The pixels of a frame are given to the send function enqueued with it, so
+/// the data keeps the header (and frame number) of the frame it was captured
+/// in, together with the seconds spent mapping and copying them.
+///
+/// @warning To be used from the render-thread only.
+class FPixelReadbackRing
+{
+public:
+
+  using FSendFunction = TUniqueFunction<void(carla::Buffer, double)>;
+
+  /// Copy @a RenderTarget into the next staging texture, @a Send is called
+  /// with @a Buffer holding the pixels, converted to @a Format, after
+  /// @a Offset once they are available. If every staging texture is in
+  /// flight, waits for the oldest one.
+  void Enqueue(
+      UTextureRenderTarget2D &RenderTarget,
+      carla::Buffer Buffer,
+      uint32 Offset,
+      carla::sensor::data::PixelFormat Format,
+      FSendFunction Send,
+      FRHICommandListImmediate &InRHICmdList);
+
+private:
+
+  struct FSlot
+  {
+    FTexture2DRHIRef StagingTexture;
+
+    FGPUFenceRHIRef Fence;
+
+    carla::Buffer Buffer;
+
+    uint32 Offset = 0u;
+
+    carla::sensor::data::PixelFormat Format = carla::sensor::data::PixelFormat::BGRA8;
+
+    FSendFunction Send;
+
+    bool bPending = false;
+  };
+
+  /// Map the staging texture of @a Slot and send its pixels.
+  void Resolve(FSlot &Slot, FRHICommandListImmediate &InRHICmdList);
+
+  static constexpr uint32 NumberOfSlots = 3u;
+
+  FSlot Slots[NumberOfSlots];
+
+  uint32 NextSlot = 0u;
+};
+
 // =============================================================================
 // -- FPixelReader -------------------------------------------------------------
 // =============================================================================
@@ -60,49 +126,131 @@ public:
   /// Note that the serializer needs to define a "header_offset" that it's
   /// allocated in front of the buffer.
   ///
+  /// If the sensor has a FPixelReadbackRing the pixels are read
+  /// asynchronously and sent a couple of frames later.
+  ///
+  /// While the sensor metrics are enabled, GPU timestamps are written around
+  /// the crop and the copy of the pixels, and the time of the readback is
+  /// added to the FSensorMetrics of the sensor.
+  ///
   /// @pre To be called from game-thread.
   template <typename TSensor>
-  static void SendPixelsInRenderThread(TSensor &Sensor);
+  static void SendPixelsInRenderThread(TSensor &Sensor)
+  {
+    SendPixelsInRenderThread(Sensor, [](TSensor &InSensor, auto Stream, carla::Buffer Pixels)
+    {
+      Stream.Send(InSensor, std::move(Pixels));
+    });
+  }
 
-private:
+  /// Same as above, but the pixels read are given to
+  /// @a SendPixels(Sensor, Stream, Buffer) instead of sent as they are, so
+  /// the sensor can process them before sending them down the stream. It is
+  /// called from the render-thread.
+  template <typename TSensor, typename TSendFunction>
+  static void SendPixelsInRenderThread(TSensor &Sensor, TSendFunction SendPixels);
 
-  /// Copy the pixels in @a RenderTarget into @a Buffer.
+  /// Draw @a SourceRect of @a Source scaled to the whole of @a Destination,
+  /// with bilinear filtering, so only the pixels sent are read back.
+  ///
+  /// @pre To be called from render-thread.
+  static void CropAndResize(
+      UTextureRenderTarget2D &Source,
+      const FIntRect &SourceRect,
+      UTextureRenderTarget2D &Destination,
+      FRHICommandListImmediate &InRHICmdList);
+
+  /// Copy the pixels in @a RenderTarget into @a Buffer, converted to
+  /// @a Format.
   ///
   /// @pre To be called from render-thread.
   static void WritePixelsToBuffer(
       UTextureRenderTarget2D &RenderTarget,
       carla::Buffer &Buffer,
       uint32 Offset,
+      carla::sensor::data::PixelFormat Format,
       FRHICommandListImmediate &InRHICmdList);
-
 };
 
 // =============================================================================
 // -- FPixelReader::SendPixelsInRenderThread -----------------------------------
 // =============================================================================
 
-template <typename TSensor>
-void FPixelReader::SendPixelsInRenderThread(TSensor &Sensor)
+template <typename TSensor, typename TSendFunction>
+void FPixelReader::SendPixelsInRenderThread(TSensor &Sensor, TSendFunction SendPixels)
 {
   check(Sensor.CaptureRenderTarget != nullptr);
+  // Without an output transform the capture itself is read back.
+  UTextureRenderTarget2D *ReadbackTarget = Sensor.OutputRenderTarget != nullptr ?
+      Sensor.OutputRenderTarget :
+      Sensor.CaptureRenderTarget;
 
   // Enqueue a command in the render-thread that will write the image buffer to
   // the data stream. The stream is created in the capture thus executed in the
   // game-thread.
   ENQUEUE_RENDER_COMMAND(FWritePixels_SendPixelsInRenderThread)
   (
-    [&Sensor, Stream=Sensor.GetDataStream(Sensor)](auto &InRHICmdList) mutable
+    [&Sensor, Stream=Sensor.GetDataStream(Sensor), Ring=Sensor.ReadbackRing, ReadbackTarget, SendPixels](auto &InRHICmdList) mutable
     {
       /// @todo Can we make sure the sensor is not going to be destroyed?
       if (!Sensor.IsPendingKill())
       {
+        const auto Metrics = Stream.GetMetrics();
+        const uint64 Frame = Stream.GetFrame();
+        if (Metrics != nullptr)
+        {
+          Metrics->BeginGPU(Frame, InRHICmdList);
+        }
+        if (ReadbackTarget != Sensor.CaptureRenderTarget)
+        {
+          CropAndResize(*Sensor.CaptureRenderTarget, Sensor.CropRect, *ReadbackTarget, InRHICmdList);
+        }
         auto Buffer = Stream.PopBufferFromPool();
-        WritePixelsToBuffer(
-            *Sensor.CaptureRenderTarget,
-            Buffer,
-            carla::sensor::SensorRegistry::get<TSensor *>::type::header_offset,
-            InRHICmdList);
-        Stream.Send(Sensor, std::move(Buffer));
+        if (Ring.IsValid())
+        {
+          Ring->Enqueue(
+              *ReadbackTarget,
+              std::move(Buffer),
+              carla::sensor::SensorRegistry::get<TSensor *>::type::header_offset,
+              Sensor.GetPixelFormat(),
+              [&Sensor, Stream=std::move(Stream), SendPixels](carla::Buffer Pixels, double ReadbackSeconds) mutable
+              {
+                if (Stream.GetMetrics() != nullptr)
+                {
+                  Stream.GetMetrics()->AddReadback(Stream.GetFrame(), ReadbackSeconds);
+                }
+                if (!Sensor.IsPendingKill())
+                {
+                  SendPixels(Sensor, std::move(Stream), std::move(Pixels));
+                }
+              },
+              InRHICmdList);
+          if (Metrics != nullptr)
+          {
+            Metrics->EndGPU(InRHICmdList);
+          }
+          return;
+        }
+        if (Metrics != nullptr)
+        {
+          // The synchronous copy blocks, it is measured as readback instead.
+          Metrics->EndGPU(InRHICmdList);
+        }
+        {
+          carla::profiler::FrameTraceSpan Span("sensor.readback", Frame);
+          const double ReadbackStart = FPlatformTime::Seconds();
+          WritePixelsToBuffer(
+              *ReadbackTarget,
+              Buffer,
+              carla::sensor::SensorRegistry::get<TSensor *>::type::header_offset,
+              Sensor.GetPixelFormat(),
+              InRHICmdList);
+          if (Metrics != nullptr)
+          {
+            Metrics->AddReadback(Frame, FPlatformTime::Seconds() - ReadbackStart);
+          }
+        }
+        SendPixels(Sensor, std::move(Stream), std::move(Buffer));
       }
     }
   );
@@ -12,9 +12,9 @@
 #include "carla/geom/Math.h"
 #include <compiler/enable-ue4-macros.h>
 
+#include "Async/ParallelFor.h"
 #include "DrawDebugHelpers.h"
 #include "Engine/CollisionProfile.h"
-#include "Runtime/Engine/Classes/Kismet/KismetMathLibrary.h"
 
 FActorDefinition ARayCastLidar::GetSensorDefinition()
 {
@@ -38,7 +38,12 @@ void ARayCastLidar::Set(const FActorDescription &ActorDescription)
 void ARayCastLidar::Set(const FLidarDescription &LidarDescription)
 {
   Description = LidarDescription;
-  LidarMeasurement = FLidarMeasurement(Description.Channels);
+  LidarMeasurement = FLidarMeasurement(
+      Description.Channels,
+      Description.bPackPoints ?
+          carla::sensor::s11n::LidarPointFormat::PackedInt16 :
+          carla::sensor::s11n::LidarPointFormat::Float32,
+      Description.PointScale);
   CreateLasers();
 }
 
@@ -50,25 +55,45 @@ void ARayCastLidar::CreateLasers()
     (Description.UpperFovLimit - Description.LowerFovLimit) /
     static_cast<float>(NumberOfLasers - 1);
   LaserAngles.Empty(NumberOfLasers);
+  LaserPitchTable.Empty(NumberOfLasers);
   for(auto i = 0u; i < NumberOfLasers; ++i)
   {
     const float VerticalAngle =
       Description.UpperFovLimit - static_cast<float>(i) * DeltaAngle;
     LaserAngles.Emplace(VerticalAngle);
+    float Sin, Cos;
+    FMath::SinCos(&Sin, &Cos, FMath::DegreesToRadians(VerticalAngle));
+    LaserPitchTable.Emplace(Cos, Sin);
   }
+  ChannelPoints.SetNum(NumberOfLasers);
+  SweepPoints.Reset();
+  SweepPoints.SetNum(NumberOfLasers);
+  SweepSliceTimes.Reset();
+  SweepAngle = 0.0f;
 }
 
 void ARayCastLidar::Tick(const float DeltaTime)
 {
   Super::Tick(DeltaTime);
 
-  ReadPoints(DeltaTime);
+  const bool bHasPoints = ReadPoints(DeltaTime);
+  if (!Description.bFullSweep)
+  {
+    if (bHasPoints)
+    {
+      WriteTickPoints();
+    }
+  }
+  else if (!bHasPoints || !AddSweepSlice(DeltaTime))
+  {
+    return;
+  }
 
   auto DataStream = GetDataStream(*this);
   DataStream.Send(*this, LidarMeasurement, DataStream.PopBufferFromPool());
 }
 
-void ARayCastLidar::ReadPoints(const float DeltaTime)
+bool ARayCastLidar::ReadPoints(const float DeltaTime)
 {
   const uint32 ChannelCount = Description.Channels;
   const uint32 PointsToScanWithOneLaser =
@@ -82,7 +107,7 @@ void ARayCastLidar::ReadPoints(const float DeltaTime)
         Warning,
         TEXT("%s: no points requested this frame, try increasing the number of points per second."),
         *GetName());
-    return;
+    return false;
   }
 
   check(ChannelCount == LaserAngles.Num());
@@ -92,17 +117,66 @@ void ARayCastLidar::ReadPoints(const float DeltaTime)
   const float AngleDistanceOfTick = Description.RotationFrequency * 360.0f * DeltaTime;
   const float AngleDistanceOfLaserMeasure = AngleDistanceOfTick / PointsToScanWithOneLaser;
 
-  LidarMeasurement.Reset(ChannelCount * PointsToScanWithOneLaser);
+  // The horizontal angles are the same for every channel, compute their sine
+  // and cosine only once per tick.
+  TArray<FVector2D> YawTable;
+  YawTable.Reserve(PointsToScanWithOneLaser);
+  for (auto i = 0u; i < PointsToScanWithOneLaser; ++i)
+  {
+    const float Angle = CurrentHorizontalAngle + AngleDistanceOfLaserMeasure * i;
+    float Sin, Cos;
+    FMath::SinCos(&Sin, &Cos, FMath::DegreesToRadians(Angle));
+    YawTable.Emplace(Cos, Sin);
+  }
 
-  for (auto Channel = 0u; Channel < ChannelCount; ++Channel)
+  const FVector LidarBodyLoc = GetActorLocation();
+  const FRotator LidarBodyRot = GetActorRotation();
+  const FQuat LidarBodyQuat = LidarBodyRot.Quaternion();
+  // Rotation from world to lidar coordinates sent to the client.
+  const FQuat OutputQuat(FVector(0, 0, 1), FMath::DegreesToRadians(90.0f - LidarBodyRot.Yaw));
+
+  // The line traces only read the physics scene, so the channels are traced
+  // in parallel, each with its own query params and points array.
+  ParallelFor(ChannelCount, [&](int32 Channel)
   {
-    for (auto i = 0u; i < PointsToScanWithOneLaser; ++i)
+    FCollisionQueryParams TraceParams = FCollisionQueryParams(FName(TEXT("Laser_Trace")), true, this);
+    TraceParams.bTraceComplex = true;
+    TraceParams.bReturnPhysicalMaterial = false;
+
+    const FVector2D &Pitch = LaserPitchTable[Channel];
+    auto &Points = ChannelPoints[Channel];
+    Points.Reset(PointsToScanWithOneLaser);
+    FHitResult HitInfo;
+    for (const auto &Yaw : YawTable)
     {
-      FVector Point;
-      const float Angle = CurrentHorizontalAngle + AngleDistanceOfLaserMeasure * i;
-      if (ShootLaser(Channel, Angle, Point))
+      // Same as the forward vector of FRotator(VerticalAngle, Angle, 0).
+      const FVector LaserDirection(Pitch.X * Yaw.X, Pitch.X * Yaw.Y, Pitch.Y);
+      const FVector Direction = LidarBodyQuat.RotateVector(LaserDirection);
+      if (ShootLaser(LidarBodyLoc, Direction, TraceParams, HitInfo))
       {
-        LidarMeasurement.WritePoint(Channel, Point);
+        // Approximate the intensity with the angle of incidence.
+        const float Incidence = FMath::Abs(FVector::DotProduct(HitInfo.ImpactNormal, Direction));
+        Points.Add({
+            OutputQuat.RotateVector(LidarBodyLoc - HitInfo.ImpactPoint),
+            static_cast<uint8>(FMath::RoundToInt(255.0f * FMath::Min(Incidence, 1.0f)))});
+      }
+    }
+  });
+
+  if (Description.ShowDebugPoints)
+  {
+    for (const auto &Points : ChannelPoints)
+    {
+      for (const auto &Point : Points)
+      {
+        DrawDebugPoint(
+          GetWorld(),
+          LidarBodyLoc - OutputQuat.Inverse().RotateVector(Point.Location),
+          10,  //size
+          FColor(255,0,255),
+          false,  //persistent (never goes away)
+          0.1  //point leaves a trail on moving object
+        );
       }
     }
   }
@@ -110,60 +184,88 @@ void ARayCastLidar::ReadPoints(const float DeltaTime)
   const float HorizontalAngle = carla::geom::Math::ToRadians(
       std::fmod(CurrentHorizontalAngle + AngleDistanceOfTick, 360.0f));
   LidarMeasurement.SetHorizontalAngle(HorizontalAngle);
+  return true;
 }
 
-bool ARayCastLidar::ShootLaser(const uint32 Channel, const float HorizontalAngle, FVector &XYZ) const
+void ARayCastLidar::WriteTickPoints()
 {
-  const float VerticalAngle = LaserAngles[Channel];
+  uint32 TotalPointCount = 0u;
+  for (const auto &Points : ChannelPoints)
+  {
+    TotalPointCount += Points.Num();
+  }
+  LidarMeasurement.Reset(TotalPointCount);
+  for (auto Channel = 0u; Channel < Description.Channels; ++Channel)
+  {
+    for (const auto &Point : ChannelPoints[Channel])
+    {
+      LidarMeasurement.WritePoint(Channel, Point.Location, Point.Intensity);
+    }
+  }
+}
 
-  FCollisionQueryParams TraceParams = FCollisionQueryParams(FName(TEXT("Laser_Trace")), true, this);
-  TraceParams.bTraceComplex = true;
-  TraceParams.bReturnPhysicalMaterial = false;
+bool ARayCastLidar::AddSweepSlice(const float DeltaTime)
+{
+  const uint32 Slice = SweepSliceTimes.Num();
+  SweepSliceTimes.Emplace(GetWorld()->GetTimeSeconds());
+  for (auto Channel = 0u; Channel < Description.Channels; ++Channel)
+  {
+    auto &Points = SweepPoints[Channel];
+    for (const auto &Point : ChannelPoints[Channel])
+    {
+      Points.Add({Point, Slice});
+    }
+  }
 
-  FHitResult HitInfo(ForceInit);
+  SweepAngle += Description.RotationFrequency * 360.0f * DeltaTime;
+  if (SweepAngle < 360.0f)
+  {
+    return false;
+  }
 
-  FVector LidarBodyLoc = GetActorLocation();
-  FRotator LidarBodyRot = GetActorRotation();
-  FRotator LaserRot (VerticalAngle, HorizontalAngle, 0);  // float InPitch, float InYaw, float InRoll
-  FRotator ResultRot = UKismetMathLibrary::ComposeRotators(
-    LaserRot,
-    LidarBodyRot
-  );
-  const auto Range = Description.Range;
-  FVector EndTrace = Range * UKismetMathLibrary::GetForwardVector(ResultRot) + LidarBodyLoc;
+  // Each slice keeps the coordinates of the tick it was read in, the time of
+  // the slices lets the client compensate the motion of the sensor.
+  uint32 TotalPointCount = 0u;
+  for (const auto &Points : SweepPoints)
+  {
+    TotalPointCount += Points.Num();
+  }
+  LidarMeasurement.Reset(TotalPointCount, SweepSliceTimes.Num());
+  const float SweepEndTime = SweepSliceTimes.Last();
+  for (auto i = 0; i < SweepSliceTimes.Num(); ++i)
+  {
+    LidarMeasurement.SetSliceTime(i, SweepSliceTimes[i] - SweepEndTime);
+  }
+  for (auto Channel = 0u; Channel < Description.Channels; ++Channel)
+  {
+    auto &Points = SweepPoints[Channel];
+    for (const auto &Point : Points)
+    {
+      LidarMeasurement.WritePoint(Channel, Point.Point.Location, Point.Point.Intensity, Point.Slice);
+    }
+    Points.Reset();
+  }
+  SweepSliceTimes.Reset();
+  SweepAngle = std::fmod(SweepAngle, 360.0f);
+  return true;
+}
+
+bool ARayCastLidar::ShootLaser(
+    const FVector &Origin,
+    const FVector &Direction,
+    const FCollisionQueryParams &TraceParams,
+    FHitResult &HitInfo) const
+{
+  HitInfo = FHitResult(ForceInit);
 
   GetWorld()->LineTraceSingleByChannel(
     HitInfo,
-    LidarBodyLoc,
-    EndTrace,
+    Origin,
+    Origin + Description.Range * Direction,
     ECC_MAX,
     TraceParams,
     FCollisionResponseParams::DefaultResponseParam
   );
 
-  if (HitInfo.bBlockingHit)
-  {
-    if (Description.ShowDebugPoints)
-    {
-      DrawDebugPoint(
-        GetWorld(),
-        HitInfo.ImpactPoint,
-        10,  //size
-        FColor(255,0,255),
-        false,  //persistent (never goes away)
-        0.1  //point leaves a trail on moving object
-      );
-    }
-
-    XYZ = LidarBodyLoc - HitInfo.ImpactPoint;
-    XYZ = UKismetMathLibrary::RotateAngleAxis(
-      XYZ,
-      - LidarBodyRot.Yaw + 90,
-      FVector(0, 0, 1)
-    );
-
-    return true;
-  } else {
-    return false;
-  }
+  return HitInfo.bBlockingHit;
 }
@@ -44,16 +44,59 @@ private:
   /// Creates a Laser for each channel.
   void CreateLasers();
 
-  /// Updates LidarMeasurement with the points read in DeltaTime.
-  void ReadPoints(float DeltaTime);
+  /// Fills ChannelPoints with the points read in DeltaTime, return whether
+  /// any point was requested.
+  bool ReadPoints(float DeltaTime);
 
-  /// Shoot a laser ray-trace, return whether the laser hit something.
-  bool ShootLaser(uint32 Channel, float HorizontalAngle, FVector &Point) const;
+  /// Updates LidarMeasurement with the points read this tick.
+  void WriteTickPoints();
+
+  /// Adds the points read this tick to the current sweep, return whether the
+  /// sweep completed a rotation and LidarMeasurement holds it.
+  bool AddSweepSlice(float DeltaTime);
+
+  /// Shoot a laser ray-trace along @a Direction (in world coordinates),
+  /// return whether the laser hit something.
+  bool ShootLaser(
+      const FVector &Origin,
+      const FVector &Direction,
+      const FCollisionQueryParams &TraceParams,
+      FHitResult &HitInfo) const;
 
   UPROPERTY(EditAnywhere)
   FLidarDescription Description;
 
   TArray<float> LaserAngles;
 
+  /// Cosine (X) and sine (Y) of the vertical angle of each laser.
+  TArray<FVector2D> LaserPitchTable;
+
+  struct FLidarPoint
+  {
+    FVector Location;
+
+    uint8 Intensity;
+  };
+
+  /// Points hit by each channel in the current tick, filled in parallel.
+  TArray<TArray<FLidarPoint>> ChannelPoints;
+
+  struct FSweepPoint
+  {
+    FLidarPoint Point;
+
+    uint32 Slice;
+  };
+
+  /// Points of each channel gathered since the start of the sweep, only with
+  /// Description.bFullSweep.
+  TArray<TArray<FSweepPoint>> SweepPoints;
+
+  /// World time of each tick of the current sweep.
+  TArray<float> SweepSliceTimes;
+
+  /// Degrees rotated since the start of the current sweep.
+  float SweepAngle = 0.0f;
+
   FLidarMeasurement LidarMeasurement;
 };
@@ -10,9 +10,11 @@
 FActorDefinition ASceneCaptureCamera::GetSensorDefinition()
 {
   constexpr bool bEnableModifyingPostProcessEffects = true;
-  return UActorBlueprintFunctionLibrary::MakeCameraDefinition(
+  auto Definition = UActorBlueprintFunctionLibrary::MakeCameraDefinition(
       TEXT("rgb"),
       bEnableModifyingPostProcessEffects);
+  AddPixelFormatVariation(Definition, { TEXT("rgb") });
+  return Definition;
 }
 
 ASceneCaptureCamera::ASceneCaptureCamera(const FObjectInitializer &ObjectInitializer)
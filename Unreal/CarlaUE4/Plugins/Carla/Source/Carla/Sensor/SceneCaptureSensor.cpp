@@ -30,6 +30,10 @@ namespace SceneCaptureSensor_local_ns {
 
   static void ConfigureShowFlags(FEngineShowFlags &ShowFlags, bool bPostProcessing = true);
 
+  static void ApplyRenderProfile(
+      ECameraRenderProfile Profile,
+      USceneCaptureComponent2D &CaptureComponent2D);
+
   static auto GetQualitySettings(UWorld *World)
   {
     auto Settings = UCarlaStatics::GetCarlaSettings(World);
@@ -70,6 +74,60 @@ void ASceneCaptureSensor::Set(const FActorDescription &Description)
 {
   Super::Set(Description);
   UActorBlueprintFunctionLibrary::SetCamera(Description, this);
+  if (Description.Variations.Contains("pixel_format"))
+  {
+    using carla::sensor::data::PixelFormat;
+    const FString Format = UActorBlueprintFunctionLibrary::ActorAttributeToString(
+        Description.Variations["pixel_format"],
+        TEXT("bgra"));
+    if (Format == TEXT("rgb"))
+    {
+      SetPixelFormat(PixelFormat::RGB8);
+    }
+    else if (Format == TEXT("depth"))
+    {
+      SetPixelFormat(PixelFormat::Depth32F);
+    }
+    else if (Format == TEXT("labels"))
+    {
+      SetPixelFormat(PixelFormat::Label8);
+    }
+    else if (Format == TEXT("cityscapes"))
+    {
+      SetPixelFormat(PixelFormat::CityScapesRGB8);
+    }
+    else
+    {
+      SetPixelFormat(PixelFormat::BGRA8);
+    }
+  }
+}
+
+void ASceneCaptureSensor::SetSensorActive(const bool bActive)
+{
+  Super::SetSensorActive(bActive);
+  check(CaptureComponent2D != nullptr);
+  if (bActive)
+  {
+    CaptureComponent2D->Activate();
+  }
+  else
+  {
+    CaptureComponent2D->Deactivate();
+  }
+}
+
+void ASceneCaptureSensor::AddPixelFormatVariation(
+    FActorDefinition &Definition,
+    const TArray<FString> &PixelFormats)
+{
+  FActorVariation Format;
+  Format.Id = TEXT("pixel_format");
+  Format.Type = EActorAttributeType::String;
+  Format.RecommendedValues = { TEXT("bgra") };
+  Format.RecommendedValues.Append(PixelFormats);
+  Format.bRestrictToRecommended = true;
+  Definition.Variations.Emplace(Format);
 }
 
 void ASceneCaptureSensor::SetImageSize(uint32 InWidth, uint32 InHeight)
@@ -78,6 +136,30 @@ void ASceneCaptureSensor::SetImageSize(uint32 InWidth, uint32 InHeight)
   ImageHeight = InHeight;
 }
 
+void ASceneCaptureSensor::SetOutputTransform(
+    const FIntRect &Crop,
+    const uint32 Downsample,
+    const uint32 Width,
+    const uint32 Height)
+{
+  CropRect = Crop;
+  OutputDownsample = FMath::Max(Downsample, 1u);
+  OutputWidth = Width;
+  OutputHeight = Height;
+}
+
+float ASceneCaptureSensor::GetOutputFOVAngle() const
+{
+  const float FOVAngle = GetFOVAngle();
+  if (CropRect.IsEmpty() || (CropRect.Width() == static_cast<int32>(ImageWidth)))
+  {
+    return FOVAngle;
+  }
+  const float HalfTan = FMath::Tan(FMath::DegreesToRadians(0.5f * FOVAngle));
+  const float Ratio = static_cast<float>(CropRect.Width()) / static_cast<float>(ImageWidth);
+  return FMath::RadiansToDegrees(2.0f * FMath::Atan(HalfTan * Ratio));
+}
+
 void ASceneCaptureSensor::SetFOVAngle(const float FOVAngle)
 {
   check(CaptureComponent2D != nullptr);
@@ -414,6 +496,11 @@ float ASceneCaptureSensor::GetChromAberrOffset() const
   return CaptureComponent2D->PostProcessSettings.ChromaticAberrationStartOffset;
 }
 
+void ASceneCaptureSensor::ConfigureShowFlags(FEngineShowFlags &ShowFlags, const bool bPostProcessing)
+{
+  SceneCaptureSensor_local_ns::ConfigureShowFlags(ShowFlags, bPostProcessing);
+}
+
 void ASceneCaptureSensor::BeginPlay()
 {
   using namespace SceneCaptureSensor_local_ns;
@@ -431,6 +518,35 @@ void ASceneCaptureSensor::BeginPlay()
     CaptureRenderTarget->TargetGamma = TargetGamma;
   }
 
+  // Resolve the output transform, the crop is clamped to the image.
+  const FIntRect ImageRect(0, 0, ImageWidth, ImageHeight);
+  CropRect = CropRect.IsEmpty() ? ImageRect : FIntRect(
+      CropRect.Min.ComponentMax(ImageRect.Min),
+      CropRect.Max.ComponentMin(ImageRect.Max));
+  if (CropRect.IsEmpty())
+  {
+    UE_LOG(LogCarla, Warning, TEXT("%s: crop rectangle outside the image, sending the whole image"), *GetName());
+    CropRect = ImageRect;
+  }
+  if ((OutputWidth == 0u) || (OutputHeight == 0u))
+  {
+    OutputWidth = FMath::Max(CropRect.Width() / static_cast<int32>(OutputDownsample), 1);
+    OutputHeight = FMath::Max(CropRect.Height() / static_cast<int32>(OutputDownsample), 1);
+  }
+  if ((CropRect != ImageRect) || (OutputWidth != ImageWidth) || (OutputHeight != ImageHeight))
+  {
+    OutputRenderTarget = NewObject<UTextureRenderTarget2D>(this);
+    OutputRenderTarget->CompressionSettings = TextureCompressionSettings::TC_Default;
+    OutputRenderTarget->SRGB = false;
+    OutputRenderTarget->bAutoGenerateMips = false;
+    OutputRenderTarget->InitCustomFormat(OutputWidth, OutputHeight, PF_B8G8R8A8, bInForceLinearGamma);
+    OutputRenderTarget->TargetGamma = CaptureRenderTarget->TargetGamma;
+  }
+  else
+  {
+    OutputRenderTarget = nullptr;
+  }
+
   check(IsValid(CaptureComponent2D) && !CaptureComponent2D->IsPendingKill());
 
   CaptureComponent2D->Deactivate();
@@ -460,6 +576,12 @@ void ASceneCaptureSensor::BeginPlay()
 
   SceneCaptureSensor_local_ns::ConfigureShowFlags(CaptureComponent2D->ShowFlags,
       bEnablePostProcessingEffects);
+  SceneCaptureSensor_local_ns::ApplyRenderProfile(RenderProfile, *CaptureComponent2D);
+
+  if (bEnableAsyncReadback)
+  {
+    ReadbackRing = MakeShared<FPixelReadbackRing, ESPMode::ThreadSafe>();
+  }
 
   Super::BeginPlay();
 }
@@ -478,6 +600,8 @@ void ASceneCaptureSensor::Tick(float DeltaTime)
 void ASceneCaptureSensor::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
   Super::EndPlay(EndPlayReason);
+  // Pending frames are dropped once the render commands release the ring.
+  ReadbackRing.Reset();
   SCENE_CAPTURE_COUNTER = 0u;
 }
 
@@ -556,6 +680,37 @@ namespace SceneCaptureSensor_local_ns {
     PostProcessSettings.BloomThreshold = -1.0f;
   }
 
+  static void ApplyRenderProfile(
+      const ECameraRenderProfile Profile,
+      USceneCaptureComponent2D &CaptureComponent2D)
+  {
+    if (Profile != ECameraRenderProfile::Fast)
+    {
+      return;
+    }
+    // The tonemapper stays, so the colors match the default profile.
+    auto &ShowFlags = CaptureComponent2D.ShowFlags;
+    ShowFlags.SetAmbientOcclusion(false);
+    ShowFlags.SetAntiAliasing(false);
+    ShowFlags.SetBloom(false);
+    ShowFlags.SetCameraImperfections(false);
+    ShowFlags.SetContactShadows(false);
+    ShowFlags.SetDepthOfField(false);
+    ShowFlags.SetDynamicShadows(false);
+    ShowFlags.SetGrain(false);
+    ShowFlags.SetLensFlares(false);
+    ShowFlags.SetLightShafts(false);
+    ShowFlags.SetMotionBlur(false);
+    ShowFlags.SetRefraction(false);
+    ShowFlags.SetSceneColorFringe(false);
+    ShowFlags.SetScreenSpaceAO(false);
+    ShowFlags.SetScreenSpaceReflections(false);
+    ShowFlags.SetTranslucency(false);
+    ShowFlags.SetVolumetricFog(false);
+    // Meshes switch to their lower levels of detail twice as close.
+    CaptureComponent2D.LODDistanceFactor = 2.0f;
+  }
+
   // Remove the show flags that might interfere with post-processing effects
   // like depth and semantic segmentation.
   static void ConfigureShowFlags(FEngineShowFlags &ShowFlags, bool bPostProcessing)
@@ -9,13 +9,32 @@
 #include "Carla/Sensor/PixelReader.h"
 #include "Carla/Sensor/Sensor.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/data/PixelFormat.h>
+#include <compiler/enable-ue4-macros.h>
+
 #include "SceneCaptureSensor.generated.h"
 
+struct FActorDefinition;
+struct FEngineShowFlags;
 class UDrawFrustumComponent;
 class USceneCaptureComponent2D;
 class UStaticMeshComponent;
 class UTextureRenderTarget2D;
 
+/// Features a scene capture renders, set by the "render_profile" attribute.
+enum class ECameraRenderProfile : uint8
+{
+  /// Everything enabled by the quality level and the post-processing
+  /// settings of the camera.
+  Default,
+  /// No costly post-processing (motion blur, bloom, lens flares, depth of
+  /// field, ambient occlusion, screen space reflections), no dynamic shadows,
+  /// translucency nor temporal anti-aliasing, and a coarser level of detail.
+  /// For secondary and low-resolution cameras.
+  Fast
+};
+
 /// Base class for sensors using a USceneCaptureComponent2D for rendering the
 /// scene. This class does not capture data, use
 /// `FPixelReader::SendPixelsInRenderThread(*this)` in derived classes.
@@ -37,6 +56,14 @@ public:
 
   void Set(const FActorDescription &ActorDescription) override;
 
+  /// Stops rendering the scene capture while the sensor is idle.
+  void SetSensorActive(bool bActive) override;
+
+  /// Apply to @a ShowFlags the features the captures render with, all of them
+  /// if @a bPostProcessing, or only the geometry for the cameras computing
+  /// data out of it (depth, semantic segmentation).
+  static void ConfigureShowFlags(FEngineShowFlags &ShowFlags, bool bPostProcessing);
+
   void SetImageSize(uint32 Width, uint32 Height);
 
   uint32 GetImageWidth() const
@@ -49,6 +76,39 @@ public:
     return ImageHeight;
   }
 
+  /// Send only @a Crop of the rendered image, scaled to @a Width x @a Height
+  /// on the GPU before reading it back. An empty @a Crop is the whole image,
+  /// a zero @a Width or @a Height is the size of the crop divided by
+  /// @a Downsample.
+  void SetOutputTransform(const FIntRect &Crop, uint32 Downsample, uint32 Width, uint32 Height);
+
+  /// Width in pixels of the images sent, the image width unless an output
+  /// transform is set.
+  uint32 GetOutputImageWidth() const
+  {
+    return OutputWidth > 0u ? OutputWidth : ImageWidth;
+  }
+
+  uint32 GetOutputImageHeight() const
+  {
+    return OutputHeight > 0u ? OutputHeight : ImageHeight;
+  }
+
+  /// Horizontal field of view of the images sent, that of the crop.
+  float GetOutputFOVAngle() const;
+
+  /// Set the format of the pixels sent to the clients, converted from the
+  /// rendered BGRA colors while copying them out of the render target.
+  void SetPixelFormat(carla::sensor::data::PixelFormat InPixelFormat)
+  {
+    PixelFormat = InPixelFormat;
+  }
+
+  carla::sensor::data::PixelFormat GetPixelFormat() const
+  {
+    return PixelFormat;
+  }
+
   UFUNCTION(BlueprintCallable)
   void EnablePostProcessingEffects(bool Enable = true)
   {
@@ -61,12 +121,38 @@ public:
     return bEnablePostProcessingEffects;
   }
 
+  /// Set the features rendered by this camera, see ECameraRenderProfile.
+  void SetRenderProfile(ECameraRenderProfile Profile)
+  {
+    RenderProfile = Profile;
+  }
+
+  ECameraRenderProfile GetRenderProfile() const
+  {
+    return RenderProfile;
+  }
+
   UFUNCTION(BlueprintCallable)
   void SetFOVAngle(float FOVAngle);
 
   UFUNCTION(BlueprintCallable)
   float GetFOVAngle() const;
 
+  /// Read the pixels through a ring of staging textures instead of locking
+  /// the render target, the data of each frame is sent a couple of frames
+  /// later but the render thread does not wait for the GPU.
+  UFUNCTION(BlueprintCallable)
+  void EnableAsyncReadback(bool Enable = true)
+  {
+    bEnableAsyncReadback = Enable;
+  }
+
+  UFUNCTION(BlueprintCallable)
+  bool IsAsyncReadbackEnabled() const
+  {
+    return bEnableAsyncReadback;
+  }
+
   UFUNCTION(BlueprintCallable)
   void SetTargetGamma(float InTargetGamma)
   {
@@ -267,6 +353,12 @@ protected:
 
   virtual void SetUpSceneCaptureComponent(USceneCaptureComponent2D &SceneCapture) {}
 
+  /// Add the "pixel_format" attribute to @a Definition, restricted to
+  /// @a PixelFormats. "bgra", the rendered colors, is always the default.
+  static void AddPixelFormatVariation(
+      FActorDefinition &Definition,
+      const TArray<FString> &PixelFormats);
+
 private:
 
   /// Image width in pixels.
@@ -284,10 +376,38 @@ private:
   UPROPERTY(EditAnywhere)
   float TargetGamma = 2.2f;
 
+  /// Set by the "render_profile" attribute.
+  ECameraRenderProfile RenderProfile = ECameraRenderProfile::Default;
+
+  /// Whether to read the pixels asynchronously, see EnableAsyncReadback.
+  UPROPERTY(EditAnywhere)
+  bool bEnableAsyncReadback = false;
+
+  /// Region of the render target sent, see SetOutputTransform. Resolved in
+  /// BeginPlay, empty if the whole image is sent.
+  FIntRect CropRect;
+
+  uint32 OutputDownsample = 1u;
+
+  uint32 OutputWidth = 0u;
+
+  uint32 OutputHeight = 0u;
+
+  /// Set by the "pixel_format" attribute.
+  carla::sensor::data::PixelFormat PixelFormat = carla::sensor::data::PixelFormat::BGRA8;
+
+  /// Only used by the render-thread, valid if bEnableAsyncReadback is set.
+  TSharedPtr<FPixelReadbackRing, ESPMode::ThreadSafe> ReadbackRing;
+
   /// Render target necessary for scene capture.
   UPROPERTY(EditAnywhere)
   UTextureRenderTarget2D *CaptureRenderTarget = nullptr;
 
+  /// Render target the crop is scaled into before the readback, only with an
+  /// output transform.
+  UPROPERTY()
+  UTextureRenderTarget2D *OutputRenderTarget = nullptr;
+
   /// Scene capture component.
   UPROPERTY(EditAnywhere)
   USceneCaptureComponent2D *CaptureComponent2D = nullptr;
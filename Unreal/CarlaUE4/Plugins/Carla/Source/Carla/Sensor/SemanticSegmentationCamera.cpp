@@ -11,7 +11,9 @@
 
 FActorDefinition ASemanticSegmentationCamera::GetSensorDefinition()
 {
-  return UActorBlueprintFunctionLibrary::MakeCameraDefinition(TEXT("semantic_segmentation"));
+  auto Definition = UActorBlueprintFunctionLibrary::MakeCameraDefinition(TEXT("semantic_segmentation"));
+  AddPixelFormatVariation(Definition, { TEXT("labels"), TEXT("cityscapes") });
+  return Definition;
 }
 
 ASemanticSegmentationCamera::ASemanticSegmentationCamera(
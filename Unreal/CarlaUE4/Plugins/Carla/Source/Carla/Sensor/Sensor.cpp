@@ -10,6 +10,9 @@
 #include "Carla/Actor/ActorDescription.h"
 #include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
 
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/Paths.h"
+
 ASensor::ASensor(const FObjectInitializer &ObjectInitializer)
   : Super(ObjectInitializer)
 {
@@ -19,6 +22,7 @@ ASensor::ASensor(const FObjectInitializer &ObjectInitializer)
   Mesh->CastShadow = false;
   Mesh->PostPhysicsComponentTick.bCanEverTick = false;
   RootComponent = Mesh;
+  Metrics = std::make_shared<FSensorMetrics>();
 }
 
 void ASensor::Set(const FActorDescription &Description)
@@ -30,6 +34,94 @@ void ASensor::Set(const FActorDescription &Description)
         UActorBlueprintFunctionLibrary::ActorAttributeToFloat(Description.Variations["sensor_tick"],
         0.0f));
   }
+  // set the codec used to stream the data to remote clients
+  if (Description.Variations.Contains("compression"))
+  {
+    const FString Codec = UActorBlueprintFunctionLibrary::ActorAttributeToString(
+        Description.Variations["compression"],
+        TEXT("none"));
+    if (Codec == TEXT("lz4"))
+    {
+      Compression = carla::streaming::Compression::LZ4;
+    }
+    else if (Codec == TEXT("delta"))
+    {
+      Compression = carla::streaming::Compression::DeltaLZ4;
+    }
+    else
+    {
+      Compression = carla::streaming::Compression::None;
+    }
+  }
+  // group the sensor with the others of the same bundle
+  if (Description.Variations.Contains("bundle"))
+  {
+    BundleName = UActorBlueprintFunctionLibrary::ActorAttributeToString(
+        Description.Variations["bundle"],
+        TEXT(""));
+  }
+  // let the engine compute the sensor together with the others batched
+  if (Description.Variations.Contains("batched"))
+  {
+    bBatched = UActorBlueprintFunctionLibrary::ActorAttributeToBool(
+        Description.Variations["batched"],
+        false);
+  }
+  // write the data to files in the server instead of sending it
+  if (Description.Variations.Contains("disk_sink"))
+  {
+    DiskSinkDirectory = UActorBlueprintFunctionLibrary::ActorAttributeToString(
+        Description.Variations["disk_sink"],
+        TEXT(""));
+  }
+  if (Description.Variations.Contains("disk_sink_format"))
+  {
+    const FString Format = UActorBlueprintFunctionLibrary::ActorAttributeToString(
+        Description.Variations["disk_sink_format"],
+        TEXT("raw"));
+    DiskSinkFormat = (Format == TEXT("png")) ? EDiskSinkFormat::PNG : EDiskSinkFormat::Raw;
+  }
+}
+
+uint32 ASensor::GetSensorId() const
+{
+  if ((SensorId == 0u) && (Episode != nullptr))
+  {
+    SensorId = Episode->FindActor(const_cast<ASensor *>(this)).GetActorId();
+  }
+  return SensorId;
+}
+
+void ASensor::SetBundle(std::shared_ptr<FSensorBundle> Bundle)
+{
+  check(Bundle != nullptr);
+  check(Stream.GetBundle() == nullptr);
+  Bundle->AddSensor();
+  Stream.SetBundle(std::move(Bundle));
+}
+
+bool ASensor::SetDiskSink(std::shared_ptr<FSensorDiskSink> Sink)
+{
+  check(Sink != nullptr);
+  check(!DiskSinkDirectory.IsEmpty());
+  const FString Directory = FPaths::ConvertRelativePathToFull(DiskSinkDirectory);
+  if (!FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*Directory))
+  {
+    UE_LOG(LogCarla, Error, TEXT("ASensor: unable to create the disk sink directory %s"), *Directory);
+    return false;
+  }
+  auto Target = std::make_shared<FSensorDiskSink::FTarget>();
+  Target->Sink = std::move(Sink);
+  Target->Directory = TCHAR_TO_UTF8(*(Directory.EndsWith(TEXT("/")) ? Directory : Directory + TEXT("/")));
+  Target->Format = DiskSinkFormat;
+  Stream.SetDiskSink(std::move(Target));
+  return true;
+}
+
+void ASensor::SetSensorActive(const bool bActive)
+{
+  // Batched sensors are computed by the FKinematicSensorBatch.
+  SetActorTickEnabled(bActive && !bBatched);
 }
 
 void ASensor::SetSeed(const int32 InSeed)
@@ -39,6 +131,15 @@ void ASensor::SetSeed(const int32 InSeed)
   RandomEngine->Seed(InSeed);
 }
 
+void ASensor::TickActor(
+    const float DeltaTime,
+    const ELevelTick TickType,
+    FActorTickFunction &ThisTickFunction)
+{
+  FSensorMetrics::FTickScope TickScope(*Metrics);
+  Super::TickActor(DeltaTime, TickType, ThisTickFunction);
+}
+
 void ASensor::PostActorCreated()
 {
   Super::PostActorCreated();
@@ -61,5 +162,9 @@ void ASensor::PostActorCreated()
 void ASensor::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
   Super::EndPlay(EndPlayReason);
+  if (Stream.GetBundle() != nullptr)
+  {
+    Stream.GetBundle()->RemoveSensor();
+  }
   Stream = FDataStream();
 }
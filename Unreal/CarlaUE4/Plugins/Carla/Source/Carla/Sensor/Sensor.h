@@ -39,14 +39,81 @@ public:
   void SetDataStream(FDataStream InStream)
   {
     Stream = std::move(InStream);
+    Stream.SetCompression(Compression);
+    Stream.SetMetrics(Metrics);
   }
 
-  /// Return the token that allows subscribing to this sensor's stream.
+  /// Make this sensor send its data through @a Bundle, together with the
+  /// other members of the bundle.
+  ///
+  /// @pre SetDataStream was called.
+  /// @warning Do not change the bundle after BeginPlay. It is not thread-safe.
+  void SetBundle(std::shared_ptr<FSensorBundle> Bundle);
+
+  /// Name of the bundle set by the "bundle" attribute, empty if the sensor
+  /// does not belong to any.
+  const FString &GetBundleName() const
+  {
+    return BundleName;
+  }
+
+  /// Directory set by the "disk_sink" attribute, empty if the sensor sends
+  /// its data to the clients.
+  const FString &GetDiskSinkDirectory() const
+  {
+    return DiskSinkDirectory;
+  }
+
+  /// Make this sensor write its data to files in the directory of the
+  /// "disk_sink" attribute with @a Sink, instead of sending it to the
+  /// clients. The directory is created if needed. Return false if it could
+  /// not be created, the sensor keeps sending its data.
+  ///
+  /// @pre SetDataStream was called.
+  /// @warning Do not change the sink after BeginPlay. It is not thread-safe.
+  bool SetDiskSink(std::shared_ptr<FSensorDiskSink> Sink);
+
+  /// Whether the "batched" attribute was set, the sensor does not tick on its
+  /// own and its data is computed by the FKinematicSensorBatch instead.
+  bool IsBatched() const
+  {
+    return bBatched;
+  }
+
+  /// Compute and send the data of the current frame. Sensors that support the
+  /// "batched" attribute override it, it is called by their tick or, if
+  /// batched, by the FKinematicSensorBatch after physics.
+  virtual void SendFrameData(float DeltaSeconds) {}
+
+  /// Cost counters of this sensor, see FSensorMetrics.
+  FSensorMetrics &GetMetrics() const
+  {
+    return *Metrics;
+  }
+
+  /// Actor id of this sensor in the episode, 0 until it is registered.
+  uint32 GetSensorId() const;
+
+  /// Return the token that allows subscribing to this sensor's stream, the
+  /// stream of its bundle if it belongs to one.
   auto GetToken() const
   {
     return Stream.GetToken();
   }
 
+  /// Whether any client is subscribed to this sensor's stream, or to the
+  /// stream of its bundle.
+  bool AreClientsListening() const
+  {
+    return Stream.AreClientsListening();
+  }
+
+  /// Called by the FSensorScheduler when the first client subscribes to the
+  /// stream of the sensor and after the last one leaves. By default it
+  /// enables or disables the tick of the actor, sensors with work outside the
+  /// tick (e.g. scene captures) should override it.
+  virtual void SetSensorActive(bool bActive);
+
   UFUNCTION(BlueprintCallable)
   URandomEngine *GetRandomEngine()
   {
@@ -66,6 +133,12 @@ protected:
 
   void PostActorCreated() override;
 
+  /// Measures the tick of the sensor while the sensor metrics are enabled.
+  void TickActor(
+      float DeltaTime,
+      ELevelTick TickType,
+      FActorTickFunction &ThisTickFunction) override;
+
   void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
   const UCarlaEpisode &GetEpisode() const
@@ -81,7 +154,10 @@ protected:
   template <typename SensorT>
   FAsyncDataStream GetDataStream(const SensorT &Self)
   {
-    return Stream.MakeAsyncDataStream(Self, GetEpisode().GetElapsedGameTime());
+    return Stream.MakeAsyncDataStream(
+        Self,
+        GetEpisode().GetElapsedGameTime(),
+        Stream.GetBundle() != nullptr ? GetSensorId() : 0u);
   }
 
   /// Seed of the pseudo-random engine.
@@ -96,5 +172,26 @@ private:
 
   FDataStream Stream;
 
+  /// Shared with the data streams, that may outlive the sensor.
+  std::shared_ptr<FSensorMetrics> Metrics;
+
+  /// Codec of the stream, set by the "compression" attribute.
+  carla::streaming::Compression Compression = carla::streaming::Compression::None;
+
+  /// Set by the "bundle" attribute.
+  FString BundleName;
+
+  /// Set by the "batched" attribute.
+  bool bBatched = false;
+
+  /// Set by the "disk_sink" attribute.
+  FString DiskSinkDirectory;
+
+  /// Set by the "disk_sink_format" attribute.
+  EDiskSinkFormat DiskSinkFormat = EDiskSinkFormat::Raw;
+
+  /// Cached by GetSensorId.
+  mutable uint32 SensorId = 0u;
+
   const UCarlaEpisode *Episode = nullptr;
 };
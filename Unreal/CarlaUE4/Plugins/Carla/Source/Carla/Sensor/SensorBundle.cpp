@@ -0,0 +1,89 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/SensorBundle.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+#include <compiler/enable-ue4-macros.h>
+
+using HeaderSerializer = carla::sensor::s11n::SensorHeaderSerializer;
+
+void FSensorBundle::AddSensor()
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  ++NumberOfSensors;
+}
+
+void FSensorBundle::RemoveSensor()
+{
+  std::vector<Reading> Complete;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    check(NumberOfSensors > 0u);
+    --NumberOfSensors;
+    // The frame may only be missing the reading of the removed sensor.
+    if (!Readings.empty() && (Readings.size() >= NumberOfSensors))
+    {
+      Complete = ExtractReadings();
+    }
+  }
+  Send(std::move(Complete));
+}
+
+void FSensorBundle::Push(const uint32 SensorId, carla::Buffer Header, carla::Buffer Data)
+{
+  const auto Frame = HeaderSerializer::Deserialize(Header).frame;
+  std::vector<Reading> Skipped;
+  std::vector<Reading> Complete;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (Frame < CurrentFrame)
+    {
+      UE_LOG(LogCarla, Warning, TEXT("FSensorBundle: dropping a reading of frame %llu, arrived late"), Frame);
+      return;
+    }
+    if ((Frame > CurrentFrame) && !Readings.empty())
+    {
+      // A member skipped the current frame, send what we have.
+      Skipped = ExtractReadings();
+    }
+    CurrentFrame = Frame;
+    Readings.emplace_back(Reading{std::move(Header), std::move(Data), SensorId});
+    if (Readings.size() >= NumberOfSensors)
+    {
+      Complete = ExtractReadings();
+    }
+  }
+  Send(std::move(Skipped));
+  Send(std::move(Complete));
+}
+
+std::vector<FSensorBundle::Reading> FSensorBundle::ExtractReadings()
+{
+  std::vector<Reading> Result;
+  Result.swap(Readings);
+  return Result;
+}
+
+void FSensorBundle::Send(std::vector<Reading> InReadings)
+{
+  if (InReadings.empty())
+  {
+    return;
+  }
+  const auto &First = HeaderSerializer::Deserialize(InReadings.front().header);
+  auto Header = HeaderSerializer::Serialize(
+      carla::sensor::SensorRegistry::get<FSensorBundle *>::index,
+      First.frame,
+      First.timestamp,
+      First.sensor_transform);
+  Stream.Write(
+      std::move(Header),
+      carla::sensor::SensorRegistry::Serialize(*this, InReadings, Stream.MakeBuffer()));
+}
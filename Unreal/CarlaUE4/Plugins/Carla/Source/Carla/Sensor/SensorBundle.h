@@ -0,0 +1,78 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/Buffer.h>
+#include <carla/sensor/s11n/SensorBundleSerializer.h>
+#include <carla/streaming/Stream.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <mutex>
+#include <vector>
+
+/// Groups the sensors spawned with the same "bundle" attribute. Every member
+/// sends its data to the bundle instead of its own stream, the bundle waits
+/// until every member reported the current frame and sends all the readings
+/// together in a single message, so clients get the measurements of a frame
+/// in a single callback.
+///
+/// A reading of a newer frame flushes the readings collected so far, sensors
+/// with a "sensor_tick" longer than the frame only delay the delivery of the
+/// frames they skip until the next frame starts.
+///
+/// Push is thread-safe, the rest of the functions need to be called in the
+/// game-thread.
+class FSensorBundle
+{
+  using Reading = carla::sensor::s11n::SensorBundleSerializer::Reading;
+
+public:
+
+  /// Not a real sensor, do not add it to the blueprint library.
+  using not_spawnable = void;
+
+  explicit FSensorBundle(carla::streaming::MultiStream InStream)
+    : Stream(std::move(InStream)) {}
+
+  /// Return the token that allows subscribing to the stream of the bundle,
+  /// shared by every member.
+  auto GetToken() const
+  {
+    return Stream.token();
+  }
+
+  bool AreClientsListening() const
+  {
+    return Stream.AreClientsListening();
+  }
+
+  void AddSensor();
+
+  void RemoveSensor();
+
+  /// Add the message of the member with id @a SensorId, with the @a Header
+  /// and @a Data it would have sent down its own stream.
+  void Push(uint32 SensorId, carla::Buffer Header, carla::Buffer Data);
+
+private:
+
+  /// @pre Mutex is locked.
+  std::vector<Reading> ExtractReadings();
+
+  void Send(std::vector<Reading> InReadings);
+
+  carla::streaming::MultiStream Stream;
+
+  std::mutex Mutex;
+
+  size_t NumberOfSensors = 0u;
+
+  uint64_t CurrentFrame = 0u;
+
+  std::vector<Reading> Readings;
+};
@@ -0,0 +1,137 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/SensorDiskSink.h"
+
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Modules/ModuleManager.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/data/PixelFormat.h>
+#include <carla/sensor/s11n/ImageSerializer.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+static std::string FSensorDiskSink_GetFileName(const uint64 Frame, const char *Extension)
+{
+  char Name[32u];
+  std::snprintf(Name, sizeof(Name), "%010llu.%s", static_cast<unsigned long long>(Frame), Extension);
+  return Name;
+}
+
+/// Encode the image in @a Data, serialized by the ImageSerializer, as PNG.
+static TArray<uint8> FSensorDiskSink_EncodePNG(IImageWrapperModule &Module, const carla::Buffer &Data)
+{
+  using carla::sensor::data::PixelFormat;
+  using Serializer = carla::sensor::s11n::ImageSerializer;
+  Serializer::ImageHeader Header;
+  if (Data.size() < Serializer::header_offset)
+  {
+    throw std::invalid_argument("the data of the sensor is not an image");
+  }
+  std::memcpy(&Header, Data.data(), sizeof(Header));
+  if ((Header.pixel_format != PixelFormat::BGRA8) && (Header.pixel_format != PixelFormat::Label8))
+  {
+    throw std::invalid_argument("only BGRA and label images can be written as PNG");
+  }
+  const bool bIsLabel = (Header.pixel_format == PixelFormat::Label8);
+  const size_t Size = carla::sensor::data::GetBytesPerPixel(Header.pixel_format) * Header.width * Header.height;
+  if (Data.size() != (Serializer::header_offset + Size))
+  {
+    throw std::invalid_argument("the size of the image does not match its header");
+  }
+  TSharedPtr<IImageWrapper> Encoder = Module.CreateImageWrapper(EImageFormat::PNG);
+  if (!Encoder.IsValid() || !Encoder->SetRaw(
+          Data.data() + Serializer::header_offset,
+          Size,
+          Header.width,
+          Header.height,
+          bIsLabel ? ERGBFormat::Gray : ERGBFormat::BGRA,
+          8))
+  {
+    throw std::runtime_error("failed to encode PNG");
+  }
+  return Encoder->GetCompressed();
+}
+
+FSensorDiskSink::FSensorDiskSink(const uint32 NumberOfWorkerThreads, const uint32 Capacity)
+  : ImageWrapperModule(FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"))),
+    Writer(NumberOfWorkerThreads, Capacity) {}
+
+void FSensorDiskSink::Write(
+    std::shared_ptr<const FTarget> Target,
+    const uint64 Frame,
+    carla::Buffer Header,
+    carla::Buffer Data)
+{
+  check(Target != nullptr);
+  // The write function needs to be copyable, the buffers are not.
+  auto Message = std::make_shared<std::pair<carla::Buffer, carla::Buffer>>(std::move(Header), std::move(Data));
+  Writer.Push([this, Target=std::move(Target), Frame, Message]() {
+    const auto Start = std::chrono::steady_clock::now();
+    const auto Bytes = WriteFile(*Target, Frame, Message->first, Message->second);
+    WrittenBytes += Bytes;
+    WriteMicroseconds += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - Start).count();
+    return Target->Directory;
+  });
+}
+
+uint64 FSensorDiskSink::WriteFile(
+    const FTarget &Target,
+    const uint64 Frame,
+    const carla::Buffer &Header,
+    const carla::Buffer &Data) const
+{
+  const bool bIsPNG = (Target.Format == EDiskSinkFormat::PNG);
+  const auto Path = Target.Directory + FSensorDiskSink_GetFileName(Frame, bIsPNG ? "png" : "carla");
+  std::ofstream File(Path, std::ios::binary | std::ios::trunc);
+  if (!File.is_open())
+  {
+    throw std::runtime_error("unable to open " + Path);
+  }
+  uint64 Bytes = 0u;
+  if (bIsPNG)
+  {
+    const auto Encoded = FSensorDiskSink_EncodePNG(ImageWrapperModule, Data);
+    File.write(reinterpret_cast<const char *>(Encoded.GetData()), Encoded.Num());
+    Bytes = Encoded.Num();
+  }
+  else
+  {
+    File.write(reinterpret_cast<const char *>(Header.data()), Header.size());
+    File.write(reinterpret_cast<const char *>(Data.data()), Data.size());
+    Bytes = Header.size() + Data.size();
+  }
+  if (!File)
+  {
+    throw std::runtime_error("failed to write " + Path);
+  }
+  return Bytes;
+}
+
+carla::rpc::DiskSinkMetrics FSensorDiskSink::GetMetrics() const
+{
+  const auto Stats = Writer.GetStats();
+  carla::rpc::DiskSinkMetrics Metrics;
+  Metrics.queued_files = Stats.queued;
+  Metrics.max_queued_files = Stats.max_queued;
+  Metrics.capacity = Stats.capacity;
+  Metrics.written_files = Stats.written;
+  Metrics.written_bytes = WrittenBytes;
+  Metrics.failed_files = Stats.failed;
+  Metrics.blocked_messages = Stats.blocked;
+  Metrics.total_blocked_seconds = Stats.total_blocked_seconds;
+  Metrics.total_write_seconds = 1e-6 * static_cast<double>(WriteMicroseconds);
+  return Metrics;
+}
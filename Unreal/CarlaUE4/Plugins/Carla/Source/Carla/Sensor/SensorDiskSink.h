@@ -0,0 +1,84 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Util/NonCopyable.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/AsyncWriter.h>
+#include <carla/Buffer.h>
+#include <carla/rpc/ServerMetrics.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+class IImageWrapperModule;
+
+/// Format of the files written by the FSensorDiskSink, set by the
+/// "disk_sink_format" attribute.
+enum class EDiskSinkFormat : uint8
+{
+  /// The message exactly as a client would receive it, header included. Load
+  /// it back with carla.SensorData.load_from_disk.
+  Raw,
+  /// The pixels of a BGRA or label image, other sensors fail to write.
+  PNG
+};
+
+/// Writes the data of the sensors spawned with a "disk_sink" attribute to
+/// files in a pool of worker threads, instead of sending it to the clients.
+/// The message never reaches the streaming server, so the sensors of a
+/// dataset generation do not pay for the network, the client callbacks and
+/// the deserialization.
+///
+/// The queue is bounded: once full, the thread sending the data of a sensor
+/// waits for a worker to pick up a file, so a disk that does not keep up
+/// slows down the simulation instead of dropping frames. The time spent
+/// waiting is reported in the metrics.
+///
+/// Write and GetMetrics are thread-safe.
+class FSensorDiskSink : private NonCopyable
+{
+public:
+
+  /// Where a sensor writes its data, shared by the messages in flight.
+  struct FTarget
+  {
+    std::shared_ptr<FSensorDiskSink> Sink;
+
+    /// UTF-8 path of the directory, with a trailing separator.
+    std::string Directory;
+
+    EDiskSinkFormat Format = EDiskSinkFormat::Raw;
+  };
+
+  /// @pre This functions needs to be called in the game-thread.
+  FSensorDiskSink(uint32 NumberOfWorkerThreads, uint32 Capacity);
+
+  /// Queue the file of @a Frame of the sensor writing to @a Target, named
+  /// after the frame number. @a Header and @a Data are the buffers the
+  /// sensor would have sent down its stream. Blocks while the queue is full.
+  void Write(std::shared_ptr<const FTarget> Target, uint64 Frame, carla::Buffer Header, carla::Buffer Data);
+
+  carla::rpc::DiskSinkMetrics GetMetrics() const;
+
+private:
+
+  /// Return the bytes written.
+  uint64 WriteFile(const FTarget &Target, uint64 Frame, const carla::Buffer &Header, const carla::Buffer &Data) const;
+
+  IImageWrapperModule &ImageWrapperModule;
+
+  std::atomic<uint64> WrittenBytes{0u};
+
+  std::atomic<uint64> WriteMicroseconds{0u};
+
+  /// Last, the workers finish the files queued before the rest is destroyed.
+  carla::AsyncWriter Writer;
+};
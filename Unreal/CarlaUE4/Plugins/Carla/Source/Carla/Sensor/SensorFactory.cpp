@@ -136,7 +136,29 @@ FActorSpawnResult ASensorFactory::SpawnActor(
     Sensor->SetEpisode(*Episode);
     Sensor->Set(Description);
     Sensor->SetDataStream(GameInstance->GetServer().OpenStream());
+    if (Sensor->IsBatched())
+    {
+      // Batched sensors share a bundle of their own, "bundle" and
+      // "disk_sink" are ignored.
+      Sensor->SetBundle(GameInstance->GetServer().OpenSensorBundle(
+          FKinematicSensorBatch::GetBundleName()));
+      GameInstance->GetKinematicSensorBatch().Add(*Sensor);
+    }
+    else if (!Sensor->GetDiskSinkDirectory().IsEmpty())
+    {
+      // Written to disk on its own, "bundle" is ignored as the bundle would
+      // wait for data that never comes.
+      Sensor->SetDiskSink(GameInstance->GetServer().GetSensorDiskSink());
+    }
+    else if (!Sensor->GetBundleName().IsEmpty())
+    {
+      Sensor->SetBundle(GameInstance->GetServer().OpenSensorBundle(Sensor->GetBundleName()));
+    }
   }
   UGameplayStatics::FinishSpawningActor(Sensor, Transform);
+  if (Sensor != nullptr)
+  {
+    GameInstance->GetSensorScheduler().Add(*Sensor);
+  }
   return FActorSpawnResult{Sensor};
 }
@@ -0,0 +1,227 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/SensorMetrics.h"
+
+#include "Carla/Game/FrameCounter.h"
+
+#include "HAL/PlatformTime.h"
+#include "RHICommandList.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <algorithm>
+
+std::atomic_bool FSensorMetrics::bIsEnabled{false};
+
+static void FSensorMetrics_AddTotals(
+    carla::rpc::SensorMetrics &Metrics,
+    const carla::rpc::SensorFrameCost &Cost)
+{
+  Metrics.total_tick_seconds += Cost.tick_seconds;
+  Metrics.total_readback_seconds += Cost.readback_seconds;
+  Metrics.total_serialize_seconds += Cost.serialize_seconds;
+  Metrics.total_gpu_seconds += Cost.gpu_seconds;
+  Metrics.total_bytes += Cost.bytes;
+}
+
+static void FSensorMetrics_Fold(
+    carla::rpc::SensorMetrics &Metrics,
+    const carla::rpc::SensorFrameCost &Cost)
+{
+  FSensorMetrics_AddTotals(Metrics, Cost);
+  ++Metrics.frames;
+  auto &Max = Metrics.max_frame;
+  Max.tick_seconds = std::max(Max.tick_seconds, Cost.tick_seconds);
+  Max.readback_seconds = std::max(Max.readback_seconds, Cost.readback_seconds);
+  Max.serialize_seconds = std::max(Max.serialize_seconds, Cost.serialize_seconds);
+  Max.gpu_seconds = std::max(Max.gpu_seconds, Cost.gpu_seconds);
+  Max.bytes = std::max(Max.bytes, Cost.bytes);
+  if (Cost.frame >= Metrics.last_frame.frame)
+  {
+    Metrics.last_frame = Cost;
+  }
+}
+
+// =============================================================================
+// -- FSensorMetrics::FTickScope -----------------------------------------------
+// =============================================================================
+
+FSensorMetrics::FTickScope::FTickScope(FSensorMetrics &InMetrics)
+  : Metrics(IsEnabled() ? &InMetrics : nullptr)
+{
+  if (Metrics != nullptr)
+  {
+    std::lock_guard<std::mutex> Lock(Metrics->Mutex);
+    Metrics->TickFrame = FFrameCounter::Get();
+    Metrics->TickStart = FPlatformTime::Seconds();
+  }
+}
+
+FSensorMetrics::FTickScope::~FTickScope()
+{
+  if (Metrics != nullptr)
+  {
+    std::lock_guard<std::mutex> Lock(Metrics->Mutex);
+    const double Seconds = FPlatformTime::Seconds() - Metrics->TickStart;
+    Metrics->TickStart = 0.0;
+    Metrics->Update(Metrics->TickFrame, [Seconds](auto &FrameCost) {
+      FrameCost.tick_seconds += Seconds;
+    });
+  }
+}
+
+// =============================================================================
+// -- FSensorMetrics -----------------------------------------------------------
+// =============================================================================
+
+void FSensorMetrics::SetEnabled(const bool bEnabled)
+{
+  bIsEnabled = bEnabled;
+}
+
+void FSensorMetrics::AddReadback(const uint64 Frame, const double Seconds)
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Update(Frame, [Seconds](auto &FrameCost) {
+    FrameCost.readback_seconds += Seconds;
+  });
+}
+
+void FSensorMetrics::AddMessage(
+    const uint64 Frame,
+    const double SerializeSeconds,
+    carla::Buffer &Header,
+    const size_t DataSize)
+{
+  const uint64 Bytes = Header.size() + DataSize;
+  std::lock_guard<std::mutex> Lock(Mutex);
+  ++Closed.messages;
+  auto Cost = Update(Frame, [SerializeSeconds, Bytes](auto &FrameCost) {
+    FrameCost.serialize_seconds += SerializeSeconds;
+    FrameCost.bytes += Bytes;
+  });
+  if ((TickStart > 0.0) && (TickFrame == Frame))
+  {
+    // Sent from the tick, count the tick up to now.
+    Cost.tick_seconds += FPlatformTime::Seconds() - TickStart;
+  }
+  carla::sensor::s11n::SensorHeaderSerializer::Cost HeaderCost;
+  HeaderCost.is_measured = 1u;
+  HeaderCost.tick_seconds = static_cast<float>(Cost.tick_seconds);
+  HeaderCost.readback_seconds = static_cast<float>(Cost.readback_seconds);
+  HeaderCost.serialize_seconds = static_cast<float>(Cost.serialize_seconds);
+  HeaderCost.gpu_seconds = static_cast<float>(Cost.gpu_seconds);
+  HeaderCost.bytes = static_cast<uint32>(std::min<uint64>(Cost.bytes, MAX_uint32));
+  carla::sensor::s11n::SensorHeaderSerializer::SetCost(Header, HeaderCost);
+}
+
+void FSensorMetrics::BeginGPU(const uint64 Frame, FRHICommandListImmediate &InRHICmdList)
+{
+  check(IsInRenderingThread());
+  if (!GSupportsTimestampRenderQueries)
+  {
+    return;
+  }
+  FGPUQuery Query;
+  Query.Frame = Frame;
+  Query.Begin = MakeQuery();
+  InRHICmdList.EndRenderQuery(Query.Begin);
+  PendingQueries.Add(MoveTemp(Query));
+}
+
+void FSensorMetrics::EndGPU(FRHICommandListImmediate &InRHICmdList)
+{
+  check(IsInRenderingThread());
+  if ((PendingQueries.Num() == 0) || PendingQueries.Last().End.IsValid())
+  {
+    return;
+  }
+  auto &Query = PendingQueries.Last();
+  Query.End = MakeQuery();
+  InRHICmdList.EndRenderQuery(Query.End);
+  PollGPU();
+}
+
+carla::rpc::SensorMetrics FSensorMetrics::GetMetrics() const
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto Result = Closed;
+  for (const auto &Cost : Frames)
+  {
+    if (Cost.frame != 0u)
+    {
+      FSensorMetrics_Fold(Result, Cost);
+    }
+  }
+  return Result;
+}
+
+carla::rpc::SensorFrameCost FSensorMetrics::Update(
+    const uint64 Frame,
+    TFunctionRef<void(carla::rpc::SensorFrameCost &)> Function)
+{
+  auto &Cost = Frames[Frame % NumberOfFrames];
+  if (Cost.frame > Frame)
+  {
+    // Already pushed out, it only adds to the totals.
+    carla::rpc::SensorFrameCost Late;
+    Late.frame = Frame;
+    Function(Late);
+    FSensorMetrics_AddTotals(Closed, Late);
+    return Late;
+  }
+  if (Cost.frame != Frame)
+  {
+    if (Cost.frame != 0u)
+    {
+      FSensorMetrics_Fold(Closed, Cost);
+    }
+    Cost = carla::rpc::SensorFrameCost{};
+    Cost.frame = Frame;
+  }
+  Function(Cost);
+  return Cost;
+}
+
+void FSensorMetrics::PollGPU()
+{
+  // The queries are read back in order, without waiting for the GPU.
+  int32 Resolved = 0;
+  for (auto &Query : PendingQueries)
+  {
+    uint64 Begin = 0u;
+    uint64 End = 0u;
+    if (!Query.End.IsValid() ||
+        !RHIGetRenderQueryResult(Query.Begin, Begin, false) ||
+        !RHIGetRenderQueryResult(Query.End, End, false))
+    {
+      break;
+    }
+    // Absolute time queries are in microseconds.
+    const double Seconds = 1e-6 * static_cast<double>(End > Begin ? End - Begin : 0u);
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      Update(Query.Frame, [Seconds](auto &FrameCost) {
+        FrameCost.gpu_seconds += Seconds;
+      });
+    }
+    FreeQueries.Add(MoveTemp(Query.Begin));
+    FreeQueries.Add(MoveTemp(Query.End));
+    ++Resolved;
+  }
+  PendingQueries.RemoveAt(0, Resolved, false);
+}
+
+FRenderQueryRHIRef FSensorMetrics::MakeQuery()
+{
+  return FreeQueries.Num() > 0 ?
+      FreeQueries.Pop(false) :
+      RHICreateRenderQuery(RQT_AbsoluteTime);
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "RHIResources.h"
+#include "Templates/Function.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/Buffer.h>
+#include <carla/rpc/SensorMetrics.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <atomic>
+#include <mutex>
+
+class FRHICommandListImmediate;
+
+/// Cost counters of a sensor: CPU time of its tick, of the readback of its
+/// pixels and of the serialization of its data, GPU time of its render
+/// commands and bytes sent. The counters are kept per frame, the data of a
+/// frame may be sent a few frames later by the render-thread.
+///
+/// Nothing is measured unless enabled with SetEnabled, the streams of the
+/// sensors only get the metrics while enabled.
+class FSensorMetrics
+{
+public:
+
+  static void SetEnabled(bool bEnabled);
+
+  static bool IsEnabled()
+  {
+    return bIsEnabled;
+  }
+
+  /// Measures the tick of the sensor, and the frame data computed by the
+  /// batch of a batched sensor, while in scope.
+  ///
+  /// @pre To be used from the game-thread.
+  class FTickScope
+  {
+  public:
+
+    explicit FTickScope(FSensorMetrics &Metrics);
+
+    ~FTickScope();
+
+  private:
+
+    FSensorMetrics *Metrics;
+  };
+
+  /// Add the readback of the pixels of @a Frame.
+  void AddReadback(uint64 Frame, double Seconds);
+
+  /// Add a message of @a Frame serialized in @a SerializeSeconds and write
+  /// the cost of the frame so far in its @a Header.
+  void AddMessage(uint64 Frame, double SerializeSeconds, carla::Buffer &Header, size_t DataSize);
+
+  /// Write a GPU timestamp before the render commands of the sensor for
+  /// @a Frame.
+  ///
+  /// @pre To be called from render-thread.
+  void BeginGPU(uint64 Frame, FRHICommandListImmediate &InRHICmdList);
+
+  /// Write a GPU timestamp after the render commands of the sensor, and add
+  /// the time of the previous ones already read back.
+  ///
+  /// @pre To be called from render-thread.
+  void EndGPU(FRHICommandListImmediate &InRHICmdList);
+
+  carla::rpc::SensorMetrics GetMetrics() const;
+
+private:
+
+  struct FGPUQuery
+  {
+    uint64 Frame = 0u;
+
+    FRenderQueryRHIRef Begin;
+
+    FRenderQueryRHIRef End;
+  };
+
+  /// Apply @a Function to the counters of @a Frame and return them. Frames
+  /// pushed out by newer ones are folded into the totals, as are the costs
+  /// of frames too old to be kept.
+  ///
+  /// @pre Called with the mutex locked.
+  carla::rpc::SensorFrameCost Update(
+      uint64 Frame,
+      TFunctionRef<void(carla::rpc::SensorFrameCost &)> Function);
+
+  void PollGPU();
+
+  FRenderQueryRHIRef MakeQuery();
+
+  static std::atomic_bool bIsEnabled;
+
+  mutable std::mutex Mutex;
+
+  /// Frames no longer kept.
+  carla::rpc::SensorMetrics Closed;
+
+  static constexpr uint32 NumberOfFrames = 8u;
+
+  carla::rpc::SensorFrameCost Frames[NumberOfFrames];
+
+  /// Start of the tick in progress, if any.
+  double TickStart = 0.0;
+
+  uint64 TickFrame = 0u;
+
+  /// Render-thread only.
+  TArray<FGPUQuery> PendingQueries;
+
+  /// Render-thread only, queries already read back.
+  TArray<FRenderQueryRHIRef> FreeQueries;
+};
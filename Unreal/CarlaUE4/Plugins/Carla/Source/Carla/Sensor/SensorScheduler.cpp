@@ -0,0 +1,86 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/SensorScheduler.h"
+
+#include "Carla/Sensor/Sensor.h"
+
+void FSensorScheduler::Add(ASensor &Sensor)
+{
+  FEntry Entry;
+  Entry.Sensor = &Sensor;
+  Sensors.Emplace(Entry);
+}
+
+float FSensorScheduler::GetActivationDelay(const ASensor &Sensor)
+{
+  const float TickInterval = Sensor.GetActorTickInterval();
+  if ((TickInterval <= 0.0f) || !Sensor.GetBundleName().IsEmpty())
+  {
+    return 0.0f;
+  }
+  // Golden ratio sequence, consecutive activations fall far apart within the
+  // interval.
+  constexpr float GoldenRatioConjugate = 0.6180339887f;
+  const float Phase = FMath::Frac(GoldenRatioConjugate * NumberOfStaggeredActivations++);
+  return Phase * TickInterval;
+}
+
+void FSensorScheduler::Tick(const float DeltaSeconds, const bool bSuspend)
+{
+  for (int32 i = Sensors.Num() - 1; i >= 0; --i)
+  {
+    auto &Entry = Sensors[i];
+    ASensor *Sensor = Entry.Sensor.Get();
+    if ((Sensor == nullptr) || Sensor->IsPendingKill())
+    {
+      Sensors.RemoveAtSwap(i);
+      continue;
+    }
+    if (bSuspend)
+    {
+      if (Entry.bIsActive && !Entry.bIsSuspended)
+      {
+        Sensor->SetSensorActive(false);
+        Entry.bIsSuspended = true;
+      }
+      continue;
+    }
+    if (Entry.bIsSuspended)
+    {
+      Sensor->SetSensorActive(true);
+      Entry.bIsSuspended = false;
+    }
+    if (!Sensor->AreClientsListening())
+    {
+      if (Entry.bIsActive)
+      {
+        Sensor->SetSensorActive(false);
+        Entry.bIsActive = false;
+      }
+      Entry.bIsWaiting = false;
+    }
+    else if (!Entry.bIsActive)
+    {
+      if (!Entry.bIsWaiting)
+      {
+        Entry.bIsWaiting = true;
+        Entry.ActivationDelay = GetActivationDelay(*Sensor);
+      }
+      if (Entry.ActivationDelay <= 0.0f)
+      {
+        Sensor->SetSensorActive(true);
+        Entry.bIsActive = true;
+        Entry.bIsWaiting = false;
+      }
+      else
+      {
+        Entry.ActivationDelay -= DeltaSeconds;
+      }
+    }
+  }
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Util/NonCopyable.h"
+
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class ASensor;
+
+/// Keeps the sensors spawned by clients idle while nobody is subscribed to
+/// their stream, so their capture components and traces do not cost GPU and
+/// CPU time. A sensor is activated once a client subscribes and deactivated
+/// again after the last one leaves.
+///
+/// Sensors with a "sensor_tick" longer than the frame are activated with a
+/// different phase each, so sensors subscribed at the same time do not all do
+/// their work in the same frame. Members of a bundle are never staggered, the
+/// bundle wants them in the same frame.
+class FSensorScheduler : private NonCopyable
+{
+public:
+
+  void Add(ASensor &Sensor);
+
+  /// Update the state of every sensor, called at the beginning of each world
+  /// tick before the actors tick. If @a bSuspend, active sensors are
+  /// deactivated for this frame and resumed on the next one not suspended.
+  void Tick(float DeltaSeconds, bool bSuspend = false);
+
+  void Clear()
+  {
+    Sensors.Empty();
+  }
+
+private:
+
+  struct FEntry
+  {
+    TWeakObjectPtr<ASensor> Sensor;
+
+    bool bIsActive = true;
+
+    /// Whether the sensor is active but deactivated by a suspended frame.
+    bool bIsSuspended = false;
+
+    /// Whether the sensor is listened but waiting for its activation.
+    bool bIsWaiting = false;
+
+    /// Seconds left before activating the sensor, if waiting.
+    float ActivationDelay = 0.0f;
+  };
+
+  /// Activation delay of @a Sensor, a fraction of its tick interval.
+  float GetActivationDelay(const ASensor &Sensor);
+
+  TArray<FEntry> Sensors;
+
+  uint32 NumberOfStaggeredActivations = 0u;
+};
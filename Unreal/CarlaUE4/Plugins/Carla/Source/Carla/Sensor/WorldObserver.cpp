@@ -10,18 +10,24 @@
 #include "Carla/Traffic/TrafficLightBase.h"
 #include "Carla/Walker/WalkerController.h"
 
+#include "Async/ParallelFor.h"
 #include "CoreGlobals.h"
 
 #include <compiler/disable-ue4-macros.h>
+#include <carla/geom/Math.h>
 #include <carla/sensor/SensorRegistry.h>
 #include <carla/sensor/data/ActorDynamicState.h>
 #include <compiler/enable-ue4-macros.h>
 
+#include <algorithm>
+
 static auto FWorldObserver_GetActorState(const FActorView &View, const FActorRegistry &Registry)
 {
   using AType = FActorView::ActorType;
 
   carla::sensor::data::ActorDynamicState::TypeDependentState state;
+  // Zeroed so the bytes of the unused members compare equal between ticks.
+  std::memset(&state, 0, sizeof(state));
 
   if (AType::Vehicle == View.GetActorType())
   {
@@ -78,6 +84,23 @@ static auto FWorldObserver_GetActorState(const FActorView &View, const FActorReg
   return state;
 }
 
+static auto FWorldObserver_GetStateKind(const FActorView &View)
+{
+  using AType = FActorView::ActorType;
+  using StateKind = carla::sensor::data::CompactActorDynamicState::StateKind;
+  switch (View.GetActorType())
+  {
+    case AType::Vehicle:
+      return StateKind::Vehicle;
+    case AType::Walker:
+      return StateKind::Walker;
+    case AType::TrafficLight:
+      return StateKind::TrafficLight;
+    default:
+      return StateKind::None;
+  }
+}
+
 static carla::geom::Vector3D FWorldObserver_GetAngularVelocity(const AActor &Actor)
 {
   const auto RootComponent = Cast<UPrimitiveComponent>(Actor.GetRootComponent());
@@ -89,28 +112,141 @@ static carla::geom::Vector3D FWorldObserver_GetAngularVelocity(const AActor &Act
 }
 
 static carla::geom::Vector3D FWorldObserver_GetAcceleration(
-    const FActorView &View,
+    const FActorInfo &Info,
     const FVector &Velocity,
     const float DeltaSeconds)
 {
-  FVector &PreviousVelocity = View.GetActorInfo()->Velocity;
+  FVector &PreviousVelocity = Info.Velocity;
   const FVector Acceleration = (Velocity - PreviousVelocity) / DeltaSeconds;
   PreviousVelocity = Velocity;
   return {Acceleration.X, Acceleration.Y, Acceleration.Z};
 }
 
+/// Compute the state of every gathered actor into @a Out, in parallel, as
+/// CompactActorDynamicState if @a bCompact. Only touches the gathered data,
+/// so it does not need to run on the game thread.
+template <typename GatheredT>
+static void FWorldObserver_ComputeStates(
+    const GatheredT &Actors,
+    const float DeltaSeconds,
+    const bool bCompact,
+    uint8 *Out)
+{
+  using Compact = carla::sensor::data::CompactActorDynamicState;
+
+  // Enough actors per task to be worth scheduling it.
+  constexpr int32 ACTORS_PER_TASK = 256;
+  constexpr float TO_METERS = 1e-2;
+
+  const int32 Count = static_cast<int32>(Actors.Num());
+  const int32 NumberOfTasks = (Count + ACTORS_PER_TASK - 1) / ACTORS_PER_TASK;
+  ParallelFor(NumberOfTasks, [&](int32 Task)
+  {
+    const int32 End = FMath::Min(Count, (Task + 1) * ACTORS_PER_TASK);
+    for (int32 Index = Task * ACTORS_PER_TASK; Index < End; ++Index)
+    {
+      const auto Velocity = TO_METERS * Actors.Velocities[Index];
+      const carla::sensor::data::ActorDynamicState State{
+        Actors.Ids[Index],
+        Actors.Transforms[Index],
+        carla::geom::Vector3D{Velocity.X, Velocity.Y, Velocity.Z},
+        Actors.AngularVelocities[Index],
+        FWorldObserver_GetAcceleration(*Actors.Infos[Index], Velocity, DeltaSeconds),
+        Actors.States[Index]
+      };
+      // The output may be an unaligned position of a buffer.
+      if (bCompact)
+      {
+        const Compact CompactState{State, Actors.Kinds[Index]};
+        std::memcpy(Out + sizeof(CompactState) * Index, &CompactState, sizeof(CompactState));
+      }
+      else
+      {
+        std::memcpy(Out + sizeof(State) * Index, &State, sizeof(State));
+      }
+    }
+  }, NumberOfTasks <= 1);
+}
+
+static bool FWorldObserver_IsNear(
+    const carla::geom::Vector3D A,
+    const carla::geom::Vector3D B,
+    const float Epsilon)
+{
+  return
+      (std::abs(A.x - B.x) <= Epsilon) &&
+      (std::abs(A.y - B.y) <= Epsilon) &&
+      (std::abs(A.z - B.z) <= Epsilon);
+}
+
+/// Whether @a Current differs enough from @a Sent, the state clients have,
+/// to be sent again.
+static bool FWorldObserver_HasChanged(
+    const carla::sensor::data::ActorDynamicState &Sent,
+    const carla::sensor::data::ActorDynamicState &Current)
+{
+  // Meters, degrees, and meters or degrees per second.
+  constexpr float LOCATION_EPSILON = 1e-3f;
+  constexpr float ROTATION_EPSILON = 1e-2f;
+  constexpr float VELOCITY_EPSILON = 1e-3f;
+
+  // Copied out of the packed structs.
+  const carla::geom::Transform SentTransform = Sent.transform;
+  const carla::geom::Transform CurrentTransform = Current.transform;
+  const carla::geom::Vector3D SentRotation{
+      SentTransform.rotation.pitch, SentTransform.rotation.yaw, SentTransform.rotation.roll};
+  const carla::geom::Vector3D CurrentRotation{
+      CurrentTransform.rotation.pitch, CurrentTransform.rotation.yaw, CurrentTransform.rotation.roll};
+
+  return
+      !FWorldObserver_IsNear(SentTransform.location, CurrentTransform.location, LOCATION_EPSILON) ||
+      !FWorldObserver_IsNear(SentRotation, CurrentRotation, ROTATION_EPSILON) ||
+      !FWorldObserver_IsNear(Sent.velocity, Current.velocity, VELOCITY_EPSILON) ||
+      !FWorldObserver_IsNear(Sent.angular_velocity, Current.angular_velocity, VELOCITY_EPSILON) ||
+      !FWorldObserver_IsNear(Sent.acceleration, Current.acceleration, VELOCITY_EPSILON) ||
+      (std::memcmp(&Sent.state, &Current.state, sizeof(Sent.state)) != 0);
+}
+
+static auto FWorldObserver_MakeHeader(
+    const UCarlaEpisode &Episode,
+    const float DeltaSeconds,
+    const bool bIsDelta,
+    const uint64 BaseFrame,
+    const size_t NumberOfDestroyedActors,
+    const bool bIsCompact)
+{
+  carla::sensor::s11n::EpisodeStateSerializer::Header header;
+  header.episode_id = Episode.GetId();
+  header.platform_timestamp = FPlatformTime::Seconds();
+  header.delta_seconds = DeltaSeconds;
+  header.is_delta = bIsDelta ? 1u : 0u;
+  header.base_frame = BaseFrame;
+  header.number_of_destroyed_actors = static_cast<uint32_t>(NumberOfDestroyedActors);
+  header.is_compact = bIsCompact ? 1u : 0u;
+  return header;
+}
+
+/// Serialize the given @a Actors, preceded by the @a DestroyedActors if
+/// @a Header is of a delta frame. A compact @a Header takes the kind of each
+/// actor from @a Kinds, indexed by its position from @a StatesBegin.
 static carla::Buffer FWorldObserver_Serialize(
     carla::Buffer &&buffer,
-    const UCarlaEpisode &Episode,
-    float DeltaSeconds)
+    const carla::sensor::s11n::EpisodeStateSerializer::Header &Header,
+    const std::vector<carla::ActorId> &DestroyedActors,
+    const std::vector<const carla::sensor::data::ActorDynamicState *> &Actors,
+    const carla::sensor::data::ActorDynamicState *StatesBegin,
+    const std::vector<carla::sensor::data::CompactActorDynamicState::StateKind> &Kinds)
 {
-  using Serializer = carla::sensor::s11n::EpisodeStateSerializer;
   using ActorDynamicState = carla::sensor::data::ActorDynamicState;
+  using Compact = carla::sensor::data::CompactActorDynamicState;
 
-  const auto &Registry = Episode.GetActorRegistry();
+  check(Header.number_of_destroyed_actors == DestroyedActors.size());
 
   // Set up buffer for writing.
-  buffer.reset(sizeof(Serializer::Header) + sizeof(ActorDynamicState) * Registry.Num());
+  buffer.reset(
+      sizeof(Header) +
+      sizeof(carla::ActorId) * DestroyedActors.size() +
+      (Header.is_compact ? sizeof(Compact) : sizeof(ActorDynamicState)) * Actors.size());
   auto begin = buffer.begin();
   auto write_data = [&begin](const auto &data)
   {
@@ -118,43 +254,312 @@ static carla::Buffer FWorldObserver_Serialize(
     begin += sizeof(data);
   };
 
-  // Write header.
-  Serializer::Header header;
-  header.episode_id = Episode.GetId();
-  header.platform_timestamp = FPlatformTime::Seconds();
-  header.delta_seconds = DeltaSeconds;
-  write_data(header);
+  write_data(Header);
+  for (auto Id : DestroyedActors)
+  {
+    write_data(Id);
+  }
+  for (auto *State : Actors)
+  {
+    if (Header.is_compact)
+    {
+      write_data(Compact{*State, Kinds[State - StatesBegin]});
+    }
+    else
+    {
+      write_data(*State);
+    }
+  }
+
+  check(begin == buffer.end());
+  return std::move(buffer);
+}
+
+bool FWorldObserver::CanSendDelta(const FSentFrames &InSent, const UCarlaEpisode &Episode) const
+{
+  return
+      (KeyFramePeriod > 1u) &&
+      InSent.bHasSentFrame &&
+      (InSent.SentEpisodeId == Episode.GetId()) &&
+      (InSent.TicksSinceKeyFrame + 1u < KeyFramePeriod);
+}
+
+carla::streaming::Token FWorldObserver::AddFilteredStream(
+    FDataMultiStream InStream,
+    const carla::rpc::EpisodeStateFilter &Filter)
+{
+  FFilteredStream Filtered;
+  Filtered.Stream = std::move(InStream);
+  Filtered.Filter = Filter;
+  Filtered.ActorIds.insert(Filter.actor_ids.begin(), Filter.actor_ids.end());
+  for (const auto &Pattern : Filter.type_patterns)
+  {
+    Filtered.TypePatterns.Add(FString(Pattern.c_str()));
+  }
+  const auto Token = Filtered.Stream.GetToken();
+  FilteredStreams.emplace_back(std::move(Filtered));
+  return Token;
+}
+
+void FWorldObserver::GatherActors(const UCarlaEpisode &Episode)
+{
+  const auto &Registry = Episode.GetActorRegistry();
+  const size_t Count = static_cast<size_t>(Registry.Num());
 
-  // Write every actor.
+  Gathered.Ids.clear();
+  Gathered.Infos.clear();
+  Gathered.Transforms.clear();
+  Gathered.Velocities.clear();
+  Gathered.AngularVelocities.clear();
+  Gathered.States.clear();
+  Gathered.Kinds.clear();
+  Gathered.Ids.reserve(Count);
+  Gathered.Infos.reserve(Count);
+  Gathered.Transforms.reserve(Count);
+  Gathered.Velocities.reserve(Count);
+  Gathered.AngularVelocities.reserve(Count);
+  Gathered.States.reserve(Count);
+  Gathered.Kinds.reserve(Count);
+
+  // Everything that reads the actors, it has to run on the game thread.
   for (auto &&View : Registry)
   {
     check(View.IsValid());
-    constexpr float TO_METERS = 1e-2;
-    const auto Velocity = TO_METERS * View.GetActor()->GetVelocity();
+    const AActor &Actor = *View.GetActor();
+    Gathered.Ids.emplace_back(View.GetActorId());
+    Gathered.Infos.emplace_back(View.GetActorInfo());
+    Gathered.Transforms.emplace_back(Actor.GetActorTransform());
+    Gathered.Velocities.emplace_back(Actor.GetVelocity());
+    Gathered.AngularVelocities.emplace_back(FWorldObserver_GetAngularVelocity(Actor));
+    Gathered.States.emplace_back(FWorldObserver_GetActorState(View, Registry));
+    Gathered.Kinds.emplace_back(FWorldObserver_GetStateKind(View));
+  }
+}
 
-    ActorDynamicState info = {
-      View.GetActorId(),
-      View.GetActor()->GetActorTransform(),
-      carla::geom::Vector3D{Velocity.X, Velocity.Y, Velocity.Z},
-      FWorldObserver_GetAngularVelocity(*View.GetActor()),
-      FWorldObserver_GetAcceleration(View, Velocity, DeltaSeconds),
-      FWorldObserver_GetActorState(View, Registry)
-    };
-    write_data(info);
+std::vector<const carla::sensor::data::ActorDynamicState *> FWorldObserver::SelectStates(
+    const UCarlaEpisode &Episode,
+    FFilteredStream &Filtered)
+{
+  const auto &Filter = Filtered.Filter;
+
+  if (Filtered.TypeMatchesEpisodeId != Episode.GetId())
+  {
+    Filtered.TypeMatches.clear();
+    Filtered.TypeMatchesEpisodeId = Episode.GetId();
   }
 
-  check(begin == buffer.end());
-  return std::move(buffer);
+  // Copied out of the packed struct.
+  carla::geom::Location Center;
+  bool bHasCenter = false;
+  if (Filter.radius > 0.0f)
+  {
+    for (auto &&State : CurrentStates)
+    {
+      if (State.id == Filter.center_actor_id)
+      {
+        const carla::geom::Transform Transform = State.transform;
+        Center = Transform.location;
+        bHasCenter = true;
+        break;
+      }
+    }
+  }
+  const float RadiusSquared = Filter.radius * Filter.radius;
+
+  auto IsSelected = [&](const size_t Index)
+  {
+    const ActorDynamicState &State = CurrentStates[Index];
+    const carla::ActorId Id = State.id;
+    if ((Id == Filter.center_actor_id) && (Filter.center_actor_id != 0u))
+    {
+      return true;
+    }
+    if (!Filtered.ActorIds.empty() && (Filtered.ActorIds.count(Id) == 0u))
+    {
+      return false;
+    }
+    if (Filter.radius > 0.0f)
+    {
+      const carla::geom::Transform Transform = State.transform;
+      if (!bHasCenter || (carla::geom::Math::DistanceSquared(Center, Transform.location) > RadiusSquared))
+      {
+        return false;
+      }
+    }
+    if (Filtered.TypePatterns.Num() > 0)
+    {
+      auto It = Filtered.TypeMatches.find(Id);
+      if (It == Filtered.TypeMatches.end())
+      {
+        const FActorInfo *Info = Gathered.Infos[Index];
+        bool bMatch = false;
+        for (const FString &Pattern : Filtered.TypePatterns)
+        {
+          if ((Info != nullptr) && Info->Description.Id.MatchesWildcard(Pattern))
+          {
+            bMatch = true;
+            break;
+          }
+        }
+        It = Filtered.TypeMatches.emplace(Id, bMatch).first;
+      }
+      return It->second;
+    }
+    return true;
+  };
+
+  std::vector<const ActorDynamicState *> Selected;
+  Filtered.SelectedIds.clear();
+  for (size_t Index = 0u; Index < CurrentStates.size(); ++Index)
+  {
+    if (IsSelected(Index))
+    {
+      Selected.emplace_back(&CurrentStates[Index]);
+      Filtered.SelectedIds.emplace(static_cast<carla::ActorId>(CurrentStates[Index].id));
+    }
+  }
+  return Selected;
 }
 
-void FWorldObserver::BroadcastTick(const UCarlaEpisode &Episode, float DeltaSeconds)
+void FWorldObserver::SendStates(
+    FDataMultiStream &OutStream,
+    FSentFrames &InOutSent,
+    const UCarlaEpisode &Episode,
+    const float DeltaSeconds,
+    std::vector<const ActorDynamicState *> States,
+    const std::unordered_set<carla::ActorId> *SelectedIds)
 {
-  auto AsyncStream = Stream.MakeAsyncDataStream(*this, Episode.GetElapsedGameTime());
+  auto AsyncStream = OutStream.MakeAsyncDataStream(*this, Episode.GetElapsedGameTime());
+  const auto &Registry = Episode.GetActorRegistry();
+  auto &SentStates = InOutSent.SentStates;
+
+  std::vector<carla::ActorId> DestroyedActors;
+  std::vector<const ActorDynamicState *> Actors;
+  const bool bIsDelta = CanSendDelta(InOutSent, Episode);
+  if (bIsDelta)
+  {
+    for (auto &&Pair : SentStates)
+    {
+      const bool bIsGone = (SelectedIds != nullptr) ?
+          (SelectedIds->count(Pair.first) == 0u) :
+          !Registry.Contains(Pair.first);
+      if (bIsGone)
+      {
+        DestroyedActors.emplace_back(Pair.first);
+      }
+    }
+    for (auto Id : DestroyedActors)
+    {
+      SentStates.erase(Id);
+    }
+    // Only the actors that are new or changed since they were last sent.
+    for (auto *State : States)
+    {
+      auto Result = SentStates.emplace(static_cast<carla::ActorId>(State->id), *State);
+      if (Result.second || FWorldObserver_HasChanged(Result.first->second, *State))
+      {
+        Result.first->second = *State;
+        Actors.emplace_back(State);
+      }
+    }
+    ++InOutSent.TicksSinceKeyFrame;
+  }
+  else
+  {
+    SentStates.clear();
+    if (KeyFramePeriod > 1u)
+    {
+      for (auto *State : States)
+      {
+        SentStates.emplace(static_cast<carla::ActorId>(State->id), *State);
+      }
+    }
+    Actors = std::move(States);
+    InOutSent.TicksSinceKeyFrame = 0u;
+  }
 
   auto buffer = FWorldObserver_Serialize(
       AsyncStream.PopBufferFromPool(),
-      Episode,
-      DeltaSeconds);
+      FWorldObserver_MakeHeader(
+          Episode,
+          DeltaSeconds,
+          bIsDelta,
+          bIsDelta ? InOutSent.SentFrame : 0u,
+          DestroyedActors.size(),
+          bCompactStates),
+      DestroyedActors,
+      Actors,
+      CurrentStates.data(),
+      Gathered.Kinds);
+
+  // Clients only apply a delta frame on top of the frame it is based on.
+  InOutSent.bHasSentFrame = true;
+  InOutSent.SentEpisodeId = Episode.GetId();
+  InOutSent.SentFrame = GFrameCounter;
 
   AsyncStream.Send(*this, std::move(buffer));
 }
+
+void FWorldObserver::BroadcastTick(const UCarlaEpisode &Episode, float DeltaSeconds)
+{
+  using Serializer = carla::sensor::s11n::EpisodeStateSerializer;
+
+  // Ticks a filtered stream is kept without clients, the first client takes
+  // a while to subscribe after opening it.
+  constexpr uint32 MAX_TICKS_WITHOUT_CLIENTS = 600u;
+
+  FilteredStreams.erase(std::remove_if(FilteredStreams.begin(), FilteredStreams.end(), [](auto &Filtered)
+  {
+    Filtered.TicksWithoutClients = Filtered.Stream.AreClientsListening() ? 0u : Filtered.TicksWithoutClients + 1u;
+    return Filtered.TicksWithoutClients > MAX_TICKS_WITHOUT_CLIENTS;
+  }), FilteredStreams.end());
+
+  GatherActors(Episode);
+
+  if ((KeyFramePeriod <= 1u) && FilteredStreams.empty())
+  {
+    // The states are computed straight into the buffer.
+    auto AsyncStream = Stream.MakeAsyncDataStream(*this, Episode.GetElapsedGameTime());
+    auto buffer = AsyncStream.PopBufferFromPool();
+    const size_t StateSize = bCompactStates ?
+        sizeof(carla::sensor::data::CompactActorDynamicState) :
+        sizeof(ActorDynamicState);
+    buffer.reset(sizeof(Serializer::Header) + StateSize * Gathered.Num());
+    const auto Header = FWorldObserver_MakeHeader(Episode, DeltaSeconds, false, 0u, 0u, bCompactStates);
+    std::memcpy(buffer.begin(), &Header, sizeof(Header));
+    FWorldObserver_ComputeStates(
+        Gathered,
+        DeltaSeconds,
+        bCompactStates,
+        buffer.begin() + sizeof(Header));
+
+    AsyncStream.Send(*this, std::move(buffer));
+    return;
+  }
+
+  CurrentStates.resize(Gathered.Num());
+  FWorldObserver_ComputeStates(
+      Gathered,
+      DeltaSeconds,
+      false,
+      reinterpret_cast<uint8 *>(CurrentStates.data()));
+
+  std::vector<const ActorDynamicState *> States;
+  States.reserve(CurrentStates.size());
+  for (auto &&State : CurrentStates)
+  {
+    States.emplace_back(&State);
+  }
+  SendStates(Stream, Sent, Episode, DeltaSeconds, std::move(States), nullptr);
+
+  for (auto &Filtered : FilteredStreams)
+  {
+    SendStates(
+        Filtered.Stream,
+        Filtered.Sent,
+        Episode,
+        DeltaSeconds,
+        SelectStates(Episode, Filtered),
+        &Filtered.SelectedIds);
+  }
+}
@@ -8,9 +8,34 @@
 
 #include "Carla/Sensor/DataStream.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/ActorId.h>
+#include <carla/rpc/EpisodeStateFilter.h>
+#include <carla/sensor/data/ActorDynamicState.h>
+#include <carla/sensor/data/CompactActorDynamicState.h>
+#include <carla/streaming/Token.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 class UCarlaEpisode;
+struct FActorInfo;
 
 /// Serializes and sends all the actors in the current UCarlaEpisode.
+///
+/// With a key frame period greater than one, only every KeyFramePeriod-th
+/// tick sends every actor, the ticks in between only send the actors created
+/// or changed since they were last sent, and the ids of the destroyed ones.
+///
+/// With compact states enabled the actors are sent quantized, as
+/// carla::sensor::data::CompactActorDynamicState, about half the size.
+///
+/// Besides the stream with every actor, clients can open filtered streams
+/// that only send the actors matching a carla::rpc::EpisodeStateFilter, e.g.
+/// the ones around their ego vehicle. The actors leaving the filter are sent
+/// as destroyed.
 class FWorldObserver
 {
 public:
@@ -30,6 +55,34 @@ public:
     return Stream.GetToken();
   }
 
+  /// Set the number of ticks between frames holding every actor. Zero and one
+  /// send every actor every tick.
+  void SetKeyFramePeriod(uint32 InKeyFramePeriod)
+  {
+    KeyFramePeriod = InKeyFramePeriod;
+    Sent.bHasSentFrame = false;
+    for (auto &Filtered : FilteredStreams)
+    {
+      Filtered.Sent.bHasSentFrame = false;
+    }
+  }
+
+  /// Send the actors as carla::sensor::data::CompactActorDynamicState from
+  /// the next tick on.
+  void SetCompactStates(bool bInCompactStates)
+  {
+    bCompactStates = bInCompactStates;
+  }
+
+  /// Send through @a InStream only the actors matching @a Filter, from the
+  /// next tick on. The stream is dropped once no client listened to it for
+  /// a while.
+  ///
+  /// @return the token to subscribe to the stream.
+  carla::streaming::Token AddFilteredStream(
+      FDataMultiStream InStream,
+      const carla::rpc::EpisodeStateFilter &Filter);
+
   /// Send a message to every connected client with the info about the given @a
   /// Episode.
   void BroadcastTick(const UCarlaEpisode &Episode, float DeltaSeconds);
@@ -42,5 +95,114 @@ public:
 
 private:
 
+  using ActorDynamicState = carla::sensor::data::ActorDynamicState;
+
+  using StateKind = carla::sensor::data::CompactActorDynamicState::StateKind;
+
+  /// Data of every actor read on the game thread, one array per field, so
+  /// the states can be computed from it in parallel.
+  struct FGatheredActors
+  {
+    std::vector<carla::ActorId> Ids;
+
+    std::vector<const FActorInfo *> Infos;
+
+    std::vector<FTransform> Transforms;
+
+    /// In centimeters per second.
+    std::vector<FVector> Velocities;
+
+    std::vector<carla::geom::Vector3D> AngularVelocities;
+
+    std::vector<ActorDynamicState::TypeDependentState> States;
+
+    /// Which member of States each actor uses.
+    std::vector<StateKind> Kinds;
+
+    size_t Num() const
+    {
+      return Ids.size();
+    }
+  };
+
+  /// What the clients of a stream have.
+  struct FSentFrames
+  {
+    /// Ticks since the last frame holding every actor was sent.
+    uint32 TicksSinceKeyFrame = 0u;
+
+    bool bHasSentFrame = false;
+
+    uint64 SentEpisodeId = 0u;
+
+    uint64 SentFrame = 0u;
+
+    /// State of each actor as clients have it, only kept if sending delta
+    /// frames.
+    std::unordered_map<carla::ActorId, ActorDynamicState> SentStates;
+  };
+
+  struct FFilteredStream
+  {
+    FDataMultiStream Stream;
+
+    carla::rpc::EpisodeStateFilter Filter;
+
+    std::unordered_set<carla::ActorId> ActorIds;
+
+    TArray<FString> TypePatterns;
+
+    /// Whether the type of each actor matches TypePatterns, found the first
+    /// time it is seen in the episode TypeMatchesEpisodeId.
+    std::unordered_map<carla::ActorId, bool> TypeMatches;
+
+    uint64 TypeMatchesEpisodeId = 0u;
+
+    uint32 TicksWithoutClients = 0u;
+
+    FSentFrames Sent;
+
+    /// Ids of the actors selected this tick, kept to reuse its memory.
+    std::unordered_set<carla::ActorId> SelectedIds;
+  };
+
+  /// Whether a delta frame can be sent for @a Episode this tick to the
+  /// clients that have @a InSent.
+  bool CanSendDelta(const FSentFrames &InSent, const UCarlaEpisode &Episode) const;
+
+  /// Read the data of every actor of @a Episode into Gathered.
+  void GatherActors(const UCarlaEpisode &Episode);
+
+  /// Select the CurrentStates matching the filter of @a Filtered.
+  std::vector<const ActorDynamicState *> SelectStates(
+      const UCarlaEpisode &Episode,
+      FFilteredStream &Filtered);
+
+  /// Send @a States through @a OutStream as a key frame or as a delta on top
+  /// of @a InOutSent. The actors in InOutSent not in @a SelectedIds, or not
+  /// in the episode if nullptr, are sent as destroyed.
+  void SendStates(
+      FDataMultiStream &OutStream,
+      FSentFrames &InOutSent,
+      const UCarlaEpisode &Episode,
+      float DeltaSeconds,
+      std::vector<const ActorDynamicState *> States,
+      const std::unordered_set<carla::ActorId> *SelectedIds);
+
   FDataMultiStream Stream;
+
+  uint32 KeyFramePeriod = 1u;
+
+  bool bCompactStates = false;
+
+  /// What the clients of Stream have.
+  FSentFrames Sent;
+
+  std::vector<FFilteredStream> FilteredStreams;
+
+  /// Data of each actor this tick, kept to reuse its memory.
+  FGatheredActors Gathered;
+
+  /// State of each actor this tick, kept to reuse its memory.
+  std::vector<ActorDynamicState> CurrentStates;
 };
@@ -7,34 +7,60 @@
 #include "Carla.h"
 #include "Carla/Server/CarlaServer.h"
 
-#include "Carla/OpenDrive/OpenDrive.h"
+#include "Carla/Game/CarlaGameInstance.h"
+#include "Carla/Game/CarlaStatics.h"
+#include "Carla/Recorder/CarlaRecorder.h"
+#include "Carla/Sensor/Sensor.h"
+#include "Carla/Server/ServerSnapshot.h"
 #include "Carla/Util/DebugShapeDrawer.h"
 #include "Carla/Util/NavigationMesh.h"
 #include "Carla/Vehicle/CarlaWheeledVehicle.h"
 #include "Carla/Walker/WalkerController.h"
+#include "Carla/Walker/WalkerNavigation.h"
+
+#include "Async/ParallelFor.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "HAL/PlatformMemory.h"
+#include "UObject/UObjectIterator.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include <carla/Functional.h>
 #include <carla/Version.h>
+#include <carla/profiler/FrameTracer.h>
+#include <carla/profiler/RuntimeProfiler.h>
 #include <carla/rpc/Actor.h>
 #include <carla/rpc/ActorDefinition.h>
 #include <carla/rpc/ActorDescription.h>
+#include <carla/rpc/AutopilotSettings.h>
 #include <carla/rpc/Command.h>
 #include <carla/rpc/CommandResponse.h>
 #include <carla/rpc/DebugShape.h>
 #include <carla/rpc/EpisodeInfo.h>
 #include <carla/rpc/EpisodeSettings.h>
+#include <carla/rpc/EpisodeStateFilter.h>
 #include <carla/rpc/MapInfo.h>
+#include <carla/rpc/MapLoadProgress.h>
+#include <carla/rpc/MemoryReport.h>
+#include <carla/rpc/NavigationMeshInfo.h>
+#include <carla/rpc/RecorderFilter.h>
+#include <carla/rpc/RecorderQuery.h>
 #include <carla/rpc/Response.h>
+#include <carla/rpc/SceneQueryBatch.h>
+#include <carla/rpc/SensorMetrics.h>
 #include <carla/rpc/Server.h>
+#include <carla/rpc/ServerMetrics.h>
 #include <carla/rpc/String.h>
 #include <carla/rpc/Transform.h>
+#include <carla/rpc/TransformBatch.h>
 #include <carla/rpc/Vector2D.h>
 #include <carla/rpc/Vector3D.h>
 #include <carla/rpc/VehicleControl.h>
+#include <carla/rpc/VehicleControlBatch.h>
 #include <carla/rpc/VehiclePhysicsControl.h>
 #include <carla/rpc/WalkerBoneControl.h>
+#include <carla/rpc/WalkerBoneControlBatch.h>
 #include <carla/rpc/WalkerControl.h>
+#include <carla/rpc/WalkerStateBatch.h>
 #include <carla/rpc/WeatherParameters.h>
 #include <carla/streaming/Server.h>
 #include <compiler/enable-ue4-macros.h>
@@ -48,10 +74,119 @@ using R = carla::rpc::Response<T>;
 // -- Static local functions ---------------------------------------------------
 // =============================================================================
 
-template <typename T, typename Other>
-static std::vector<T> MakeVectorFromTArray(const TArray<Other> &Array)
+/// Apply the run of consecutive @a Commands of type CommandT starting at
+/// @a Begin, returns the index where the run ends. @a Apply returns the error
+/// message of a command, or nullptr on success. Compared to applying them one
+/// by one, the commands are not dispatched through the command visitor and
+/// their errors are logged once for the whole run.
+template <typename CommandT, typename FuncT>
+static size_t ApplyCommandRun(
+    const UCarlaEpisode &Episode,
+    const std::vector<carla::rpc::Command> &Commands,
+    const size_t Begin,
+    const char *ActorNotFoundError,
+    std::vector<carla::rpc::CommandResponse> &Result,
+    FuncT &&Apply)
+{
+  using CR = carla::rpc::CommandResponse;
+  size_t NumberOfErrors = 0u;
+  size_t End = Begin;
+  for (; End < Commands.size(); ++End)
+  {
+    const auto *Command = boost::get<CommandT>(&Commands[End].command);
+    if (Command == nullptr)
+    {
+      break;
+    }
+    auto ActorView = Episode.FindActor(Command->actor);
+    const char *Error = ActorView.IsValid() ?
+        Apply(*ActorView.GetActor(), *Command) :
+        ActorNotFoundError;
+    if (Error == nullptr)
+    {
+      Result.emplace_back(CR{Command->actor});
+    }
+    else
+    {
+      ++NumberOfErrors;
+      Result.emplace_back(CR{carla::rpc::ResponseError(Error)});
+    }
+  }
+  if (NumberOfErrors > 0u)
+  {
+    UE_LOG(
+        LogCarlaServer,
+        Log,
+        TEXT("Responding error to %d of %d batched commands"),
+        static_cast<int>(NumberOfErrors),
+        static_cast<int>(End - Begin));
+  }
+  return End;
+}
+
+/// Vehicles of the same batch spawned closer than this, in meters, always
+/// collide with each other.
+static constexpr float MinVehicleSpawnSeparation = 1.0f;
+
+/// For each SpawnActor command in [@a Begin, @a End), whether it spawns a
+/// vehicle closer than MinVehicleSpawnSeparation to one spawned by an earlier
+/// command of the run. The spawn points are hashed in a grid of that size, so
+/// the whole run is checked in a single pass before spawning anything.
+static std::vector<bool> FindCrowdedSpawnPoints(
+    const std::vector<carla::rpc::Command> &Commands,
+    const size_t Begin,
+    const size_t End)
 {
-  return {Array.GetData(), Array.GetData() + Array.Num()};
+  using SpawnActor = carla::rpc::Command::SpawnActor;
+  constexpr float Cell = MinVehicleSpawnSeparation;
+  std::vector<bool> Result(End - Begin, false);
+  TMap<FIntVector, TArray<FVector, TInlineAllocator<2>>> Grid;
+  for (size_t i = Begin; i < End; ++i)
+  {
+    const auto &Command = boost::get<SpawnActor>(Commands[i].command);
+    if (Command.description.id.compare(0u, 8u, "vehicle.") != 0)
+    {
+      continue;
+    }
+    const auto &Location = Command.transform.location;
+    const FVector Point(Location.x, Location.y, Location.z);
+    const FIntVector Key(
+        FMath::FloorToInt(Point.X / Cell),
+        FMath::FloorToInt(Point.Y / Cell),
+        FMath::FloorToInt(Point.Z / Cell));
+    bool bIsCrowded = false;
+    for (int32 X = -1; (X <= 1) && !bIsCrowded; ++X)
+    {
+      for (int32 Y = -1; (Y <= 1) && !bIsCrowded; ++Y)
+      {
+        for (int32 Z = -1; (Z <= 1) && !bIsCrowded; ++Z)
+        {
+          const auto *Points = Grid.Find(Key + FIntVector(X, Y, Z));
+          if (Points == nullptr)
+          {
+            continue;
+          }
+          for (const auto &Other : *Points)
+          {
+            if (FVector::DistSquared(Point, Other) < Cell * Cell)
+            {
+              bIsCrowded = true;
+              break;
+            }
+          }
+        }
+      }
+    }
+    if (bIsCrowded)
+    {
+      Result[i - Begin] = true;
+    }
+    else
+    {
+      Grid.FindOrAdd(Key).Add(Point);
+    }
+  }
+  return Result;
 }
 
 // =============================================================================
@@ -65,7 +200,10 @@ public:
   FPimpl(uint16_t RPCPort, uint16_t StreamingPort)
     : Server(RPCPort),
       StreamingServer(StreamingPort),
-      BroadcastStream(StreamingServer.MakeMultiStream())
+      BroadcastStream(StreamingServer.MakeMultiStream()),
+      DiskSink(std::make_shared<FSensorDiskSink>(
+          FMath::Max(2, FPlatformMisc::NumberOfCoresIncludingHyperthreads() / 4),
+          256u))
   {
     BindActions();
   }
@@ -76,10 +214,30 @@ public:
 
   carla::streaming::MultiStream BroadcastStream;
 
+  /// Bundles by name, they are destroyed with their last sensor.
+  TMap<FString, std::weak_ptr<FSensorBundle>> SensorBundles;
+
+  /// Shared by every sensor with a "disk_sink", created with the server so
+  /// the metrics can read it from any thread.
+  std::shared_ptr<FSensorDiskSink> DiskSink;
+
   UCarlaEpisode *Episode = nullptr;
 
+  /// What the read-only calls answer from the worker threads.
+  FServerSnapshotBuffer ReadSnapshot;
+
   size_t TickCuesReceived = 0u;
 
+  /// Frames started by a "tick_n" that skips its intermediate frames,
+  /// [SkippedFramesBegin, SkippedFramesEnd).
+  uint64 SkippedFramesBegin = 0u;
+
+  uint64 SkippedFramesEnd = 0u;
+
+  /// Bone names registered by the clients, the bone set ids of the walker
+  /// bone control batches index this.
+  TArray<TArray<FName>> WalkerBoneSets;
+
 private:
 
   void BindActions();
@@ -156,12 +314,119 @@ void FCarlaServer::FPimpl::BindActions()
     return carla::version();
   };
 
+  // ~~ Profiler ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+  BIND_ASYNC(get_profiler_stats) << [] () -> R<std::vector<carla::profiler::ProfilerStats>>
+  {
+    return carla::profiler::RuntimeProfiler::GetStats();
+  };
+
+  BIND_ASYNC(set_profiler_enabled) << [] (bool enabled) -> R<void>
+  {
+    carla::profiler::RuntimeProfiler::SetEnabled(enabled);
+    return R<void>::Success();
+  };
+
+  BIND_ASYNC(get_server_metrics) << [this] () -> R<cr::ServerMetrics>
+  {
+    cr::ServerMetrics Metrics;
+    Metrics.functions = Server.GetFunctionMetrics();
+    for (const auto &Stats : StreamingServer.GetStreamStats())
+    {
+      Metrics.streams.emplace_back(Stats);
+    }
+    Metrics.disk_sink = DiskSink->GetMetrics();
+    return Metrics;
+  };
+
+  BIND_SYNC(get_sensor_metrics) << [this] () -> R<std::vector<cr::SensorMetrics>>
+  {
+    REQUIRE_CARLA_EPISODE();
+    std::vector<cr::SensorMetrics> Result;
+    for (const auto &View : Episode->GetActorRegistry())
+    {
+      auto *Sensor = Cast<ASensor>(View.GetActor());
+      if ((Sensor != nullptr) && (View.GetActorInfo() != nullptr))
+      {
+        Result.emplace_back(Sensor->GetMetrics().GetMetrics());
+        Result.back().actor_id = View.GetActorId();
+        Result.back().type_id = cr::FromFString(View.GetActorInfo()->Description.Id);
+      }
+    }
+    return Result;
+  };
+
+  BIND_ASYNC(set_sensor_metrics_enabled) << [] (bool enabled) -> R<void>
+  {
+    FSensorMetrics::SetEnabled(enabled);
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(get_memory_report) << [this] () -> R<cr::MemoryReport>
+  {
+    REQUIRE_CARLA_EPISODE();
+    auto Report = cr::MemoryReport::Make();
+    Report.subsystems.emplace_back(
+        "actor_registry",
+        Episode->GetActorRegistry().GetAllocatedSize(),
+        Episode->GetActorRegistry().Num());
+    auto *Recorder = Episode->GetRecorder();
+    Report.subsystems.emplace_back(
+        "recorder",
+        Recorder != nullptr ? Recorder->GetAllocatedSize() : 0u);
+    uint64 RenderTargetBytes = 0u;
+    uint64 RenderTargets = 0u;
+    for (TObjectIterator<UTextureRenderTarget2D> It; It; ++It)
+    {
+      RenderTargetBytes += It->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+      ++RenderTargets;
+    }
+    Report.subsystems.emplace_back("render_targets", RenderTargetBytes, RenderTargets);
+    // The whole process, not only LibCarla.
+    Report.resident_bytes = FPlatformMemory::GetStats().UsedPhysical;
+    return Report;
+  };
+
+  BIND_ASYNC(get_frame_trace) << [] () -> R<std::string>
+  {
+    return carla::profiler::FrameTracer::DumpChromeTrace();
+  };
+
+  BIND_ASYNC(set_frame_tracer_enabled) << [] (bool enabled) -> R<void>
+  {
+    carla::profiler::FrameTracer::SetEnabled(enabled);
+    return R<void>::Success();
+  };
+
   // ~~ Tick ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   BIND_SYNC(tick_cue) << [this]() -> R<uint64_t>
   {
+    using carla::profiler::FrameTracer;
+    const auto Now = FrameTracer::Now();
     ++TickCuesReceived;
-    return GFrameCounter + 1u;
+    // Cues sent before the previous ones were consumed start later frames,
+    // one per pending cue.
+    // Instant span, the frame this cue starts.
+    FrameTracer::Record("server.tick_cue", GFrameCounter + TickCuesReceived, Now, Now);
+    return GFrameCounter + TickCuesReceived;
+  };
+
+  BIND_SYNC(tick_n) << [this](uint32 Frames, bool SkipIntermediateFrames) -> R<uint64_t>
+  {
+    using carla::profiler::FrameTracer;
+    const auto Now = FrameTracer::Now();
+    Frames = std::max(Frames, 1u);
+    const uint64 FirstFrame = GFrameCounter + TickCuesReceived + 1u;
+    TickCuesReceived += Frames;
+    const uint64 LastFrame = GFrameCounter + TickCuesReceived;
+    if (SkipIntermediateFrames)
+    {
+      SkippedFramesBegin = FirstFrame;
+      SkippedFramesEnd = LastFrame;
+    }
+    FrameTracer::Record("server.tick_cue", LastFrame, Now, Now);
+    return LastFrame;
   };
 
   // ~~ Load new episode ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -188,25 +453,106 @@ void FCarlaServer::FPimpl::BindActions()
     return R<void>::Success();
   };
 
-  // ~~ Episode settings and info ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  BIND_SYNC(load_new_episode_async) << [this](
+      const std::string &map_name,
+      const std::vector<std::string> &preload_assets) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    TArray<FString> PreloadAssets;
+    PreloadAssets.Reserve(preload_assets.size());
+    for (const auto &Asset : preload_assets)
+    {
+      PreloadAssets.Emplace(cr::ToFString(Asset));
+    }
+    if (!Episode->LoadNewEpisodeAsync(cr::ToFString(map_name), PreloadAssets))
+    {
+      RESPOND_ERROR("map not found");
+    }
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(get_map_load_progress) << [this]() -> R<cr::MapLoadProgress>
+  {
+    REQUIRE_CARLA_EPISODE();
+    auto *GameInstance = UCarlaStatics::GetGameInstance(Episode->GetWorld());
+    if (GameInstance == nullptr)
+    {
+      RESPOND_ERROR("unable to get the map load progress: game instance not found");
+    }
+    return GameInstance->GetMapLoader().GetProgress();
+  };
+
+  BIND_SYNC(reset_episode) << [this]() -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    Episode->ResetEpisode();
+    ReadSnapshot.Update(*Episode);
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(save_episode_state) << [this]() -> R<uint64_t>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return Episode->SaveStateSnapshot();
+  };
+
+  BIND_SYNC(restore_episode_state) << [this](uint64_t SnapshotId) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    if (!Episode->RestoreStateSnapshot(SnapshotId))
+    {
+      RESPOND_ERROR("unable to restore episode state: snapshot not found");
+    }
+    return R<void>::Success();
+  };
 
-  BIND_SYNC(get_episode_info) << [this]() -> R<cr::EpisodeInfo>
+  BIND_SYNC(drop_episode_state) << [this](uint64_t SnapshotId) -> R<bool>
   {
     REQUIRE_CARLA_EPISODE();
-    return cr::EpisodeInfo{
-             Episode->GetId(),
-                 BroadcastStream.token()};
+    return Episode->DropStateSnapshot(SnapshotId);
   };
 
-  BIND_SYNC(get_map_info) << [this]() -> R<cr::MapInfo>
+  BIND_SYNC(open_filtered_episode_stream) << [this](
+      const cr::EpisodeStateFilter &Filter) -> R<carla::streaming::Token>
   {
     REQUIRE_CARLA_EPISODE();
-    auto FileContents = UOpenDrive::LoadXODR(Episode->GetMapName());
-    const auto &SpawnPoints = Episode->GetRecommendedSpawnPoints();
-    return cr::MapInfo{
-      cr::FromFString(Episode->GetMapName()),
-      cr::FromFString(FileContents),
-      MakeVectorFromTArray<cg::Transform>(SpawnPoints)};
+    if (Filter.IsEmpty())
+    {
+      return BroadcastStream.token();
+    }
+    auto *GameInstance = UCarlaStatics::GetGameInstance(Episode->GetWorld());
+    if (GameInstance == nullptr)
+    {
+      RESPOND_ERROR("unable to open filtered episode stream: game instance not found");
+    }
+    return GameInstance->GetWorldObserver().AddFilteredStream(
+        FDataMultiStream(StreamingServer.MakeMultiStream()),
+        Filter);
+  };
+
+  // ~~ Episode settings and info ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+  // The read-only calls are answered from the worker threads with the
+  // snapshot the game thread publishes, see FServerSnapshotBuffer.
+
+  BIND_ASYNC(get_episode_info) << [this]() -> R<cr::EpisodeInfo>
+  {
+    const auto Snapshot = ReadSnapshot.Get();
+    if (Snapshot == nullptr)
+    {
+      RESPOND_ERROR("episode not ready");
+    }
+    return cr::EpisodeInfo{Snapshot->EpisodeId, BroadcastStream.token()};
+  };
+
+  BIND_ASYNC(get_map_info) << [this]() -> R<cr::MapInfo>
+  {
+    const auto Snapshot = ReadSnapshot.Get();
+    if (Snapshot == nullptr)
+    {
+      RESPOND_ERROR("episode not ready");
+    }
+    return Snapshot->Episode->MapInfo;
   };
 
   BIND_SYNC(get_navigation_mesh) << [this]() -> R<std::vector<uint8_t>>
@@ -219,11 +565,28 @@ void FCarlaServer::FPimpl::BindActions()
     return Result;
   };
 
-
-  BIND_SYNC(get_episode_settings) << [this]() -> R<cr::EpisodeSettings>
+  BIND_SYNC(get_navigation_mesh_info) << [this]() -> R<cr::NavigationMeshInfo>
   {
     REQUIRE_CARLA_EPISODE();
-    return cr::EpisodeSettings{Episode->GetSettings()};
+    auto FileContents = FNavigationMesh::Load(Episode->GetMapName());
+    cr::NavigationMeshInfo Info;
+    Info.map_name = cr::FromFString(Episode->GetMapName());
+    if (FileContents.Num() > 0)
+    {
+      Info.hash = cr::NavigationMeshInfo::Hash(FileContents.GetData(), static_cast<size_t>(FileContents.Num()));
+    }
+    return Info;
+  };
+
+
+  BIND_ASYNC(get_episode_settings) << [this]() -> R<cr::EpisodeSettings>
+  {
+    const auto Snapshot = ReadSnapshot.Get();
+    if (Snapshot == nullptr)
+    {
+      RESPOND_ERROR("episode not ready");
+    }
+    return Snapshot->Settings;
   };
 
   BIND_SYNC(set_episode_settings) << [this](
@@ -231,13 +594,28 @@ void FCarlaServer::FPimpl::BindActions()
   {
     REQUIRE_CARLA_EPISODE();
     Episode->ApplySettings(settings);
+    ReadSnapshot.Update(*Episode, true);
     return GFrameCounter;
   };
 
-  BIND_SYNC(get_actor_definitions) << [this]() -> R<std::vector<cr::ActorDefinition>>
+  BIND_ASYNC(get_actor_definitions) << [this]() -> R<std::vector<cr::ActorDefinition>>
   {
-    REQUIRE_CARLA_EPISODE();
-    return MakeVectorFromTArray<cr::ActorDefinition>(Episode->GetActorDefinitions());
+    const auto Snapshot = ReadSnapshot.Get();
+    if (Snapshot == nullptr)
+    {
+      RESPOND_ERROR("episode not ready");
+    }
+    return Snapshot->Episode->ActorDefinitions;
+  };
+
+  BIND_ASYNC(get_actor_definitions_version) << [this]() -> R<uint64_t>
+  {
+    const auto Snapshot = ReadSnapshot.Get();
+    if (Snapshot == nullptr)
+    {
+      RESPOND_ERROR("episode not ready");
+    }
+    return Snapshot->Episode->ActorDefinitionsVersion;
   };
 
   BIND_SYNC(get_spectator) << [this]() -> R<cr::Actor>
@@ -277,9 +655,26 @@ void FCarlaServer::FPimpl::BindActions()
     return R<void>::Success();
   };
 
+  // ~~ Autopilot ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+  BIND_SYNC(get_autopilot_settings) << [this]() -> R<cr::AutopilotSettings>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return cr::AutopilotSettings{Episode->GetAutopilotSettings()};
+  };
+
+  BIND_SYNC(set_autopilot_settings) << [this](
+      const cr::AutopilotSettings &settings) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    Episode->SetAutopilotSettings(settings);
+    return R<void>::Success();
+  };
+
   // ~~ Actor operations ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-  BIND_SYNC(get_actors_by_id) << [this](
+  // Answers on the game thread while the snapshot is behind the registry.
+  auto get_actors_by_id_on_game_thread = [this](
       const std::vector<FActorView::IdType> &ids) -> R<std::vector<cr::Actor>>
   {
     REQUIRE_CARLA_EPISODE();
@@ -296,6 +691,28 @@ void FCarlaServer::FPimpl::BindActions()
     return Result;
   };
 
+  BIND_ASYNC(get_actors_by_id) << [this, get_actors_by_id_on_game_thread](
+      const std::vector<FActorView::IdType> &ids) -> R<std::vector<cr::Actor>>
+  {
+    const auto Snapshot = ReadSnapshot.Get();
+    if ((Snapshot == nullptr) || !Snapshot->AreActorsUpToDate())
+    {
+      return Server.SyncCall([&]() { return get_actors_by_id_on_game_thread(ids); });
+    }
+    const auto &Actors = Snapshot->Actors->Actors;
+    std::vector<cr::Actor> Result;
+    Result.reserve(ids.size());
+    for (auto &&Id : ids)
+    {
+      auto It = Actors.find(Id);
+      if (It != Actors.end())
+      {
+        Result.emplace_back(It->second);
+      }
+    }
+    return Result;
+  };
+
   BIND_SYNC(spawn_actor) << [this](
       cr::ActorDescription Description,
       const cr::Transform &Transform) -> R<cr::Actor>
@@ -405,41 +822,85 @@ void FCarlaServer::FPimpl::BindActions()
     {
       RESPOND_ERROR("unable to set walker state: actor not found");
     }
+    const char *Error = FWalkerNavigation::ApplyWalkerState(*ActorView.GetActor(), Transform, Speed);
+    if (Error != nullptr)
+    {
+      RESPOND_ERROR_FSTRING(FString(UTF8_TO_TCHAR(Error)));
+    }
+    return R<void>::Success();
+  };
 
-    // apply walker transform
-    FTransform NewTransform = Transform;
-    FVector NewLocation = NewTransform.GetLocation();
-
-    FTransform CurrentTransform = ActorView.GetActor()->GetTransform();
-    FVector CurrentLocation = CurrentTransform.GetLocation();
-
-    NewLocation.Z = CurrentLocation.Z;
-
-    NewTransform.SetLocation(NewLocation);
-
-    ActorView.GetActor()->SetActorRelativeTransform(
-    NewTransform,
-    false,
-    nullptr,
-    ETeleportType::TeleportPhysics);
-
-    // apply walker speed
-    auto Pawn = Cast<APawn>(ActorView.GetActor());
-    if (Pawn == nullptr)
+  BIND_SYNC(apply_walker_state_batch) << [this](
+      const cr::WalkerStateBatch &Batch) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    if (!Batch.IsValid())
     {
-      RESPOND_ERROR("unable to set walker state: actor is not a walker");
+      RESPOND_ERROR("unable to set walker states: malformed batch");
     }
-    auto Controller = Cast<AWalkerController>(Pawn->GetController());
-    if (Controller == nullptr)
+    size_t NumberOfErrors = 0u;
+    for (size_t i = 0u; i < Batch.size(); ++i)
+    {
+      const auto Entry = Batch.at(i);
+      auto ActorView = Episode->FindActor(Entry.actor);
+      if (!ActorView.IsValid() ||
+          (FWalkerNavigation::ApplyWalkerState(*ActorView.GetActor(), Entry.transform, Entry.speed) != nullptr))
+      {
+        ++NumberOfErrors;
+      }
+    }
+    if (NumberOfErrors > 0u)
     {
-      RESPOND_ERROR("unable to set walker state: walker has an incompatible controller");
+      UE_LOG(
+          LogCarlaServer,
+          Log,
+          TEXT("Unable to set the state of %d of %d walkers"),
+          static_cast<int>(NumberOfErrors),
+          static_cast<int>(Batch.size()));
     }
-    cr::WalkerControl Control(Transform.GetForwardVector(), Speed, false);
-    Controller->ApplyWalkerControl(Control);
+    return R<void>::Success();
+  };
 
+  BIND_SYNC(add_walker_to_navigation) << [this](cr::ActorId ActorId) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    auto ActorView = Episode->FindActor(ActorId);
+    if (!ActorView.IsValid())
+    {
+      RESPOND_ERROR("unable to add walker to navigation: actor not found");
+    }
+    if (!Episode->GetWalkerNavigation().AddWalker(
+            *Episode,
+            ActorId,
+            ActorView.GetActor()->GetActorLocation()))
+    {
+      RESPOND_ERROR("unable to add walker to navigation: navigation mesh not available or crowd full");
+    }
     return R<void>::Success();
   };
 
+  BIND_SYNC(remove_walker_from_navigation) << [this](cr::ActorId ActorId) -> R<bool>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return Episode->GetWalkerNavigation().RemoveWalker(ActorId);
+  };
+
+  BIND_SYNC(set_walker_navigation_target) << [this](
+      cr::ActorId ActorId,
+      cr::Location Location) -> R<bool>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return Episode->GetWalkerNavigation().SetWalkerTarget(ActorId, Location);
+  };
+
+  BIND_SYNC(set_walker_navigation_max_speed) << [this](
+      cr::ActorId ActorId,
+      float MaxSpeed) -> R<bool>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return Episode->GetWalkerNavigation().SetWalkerMaxSpeed(ActorId, MaxSpeed);
+  };
+
   BIND_SYNC(set_actor_velocity) << [this](
       cr::ActorId ActorId,
       cr::Vector3D vector) -> R<void>
@@ -506,7 +967,7 @@ void FCarlaServer::FPimpl::BindActions()
     return R<void>::Success();
   };
 
-  BIND_SYNC(get_physics_control) << [this](
+  auto get_physics_control_on_game_thread = [this](
       cr::ActorId ActorId) -> R<cr::VehiclePhysicsControl>
   {
     REQUIRE_CARLA_EPISODE();
@@ -524,6 +985,26 @@ void FCarlaServer::FPimpl::BindActions()
     return cr::VehiclePhysicsControl(Vehicle->GetVehiclePhysicsControl());
   };
 
+  BIND_ASYNC(get_physics_control) << [this, get_physics_control_on_game_thread](
+      cr::ActorId ActorId) -> R<cr::VehiclePhysicsControl>
+  {
+    const auto Snapshot = ReadSnapshot.Get();
+    if ((Snapshot == nullptr) || !Snapshot->AreActorsUpToDate())
+    {
+      return Server.SyncCall([&]() { return get_physics_control_on_game_thread(ActorId); });
+    }
+    if (Snapshot->Actors->Actors.count(ActorId) == 0u)
+    {
+      RESPOND_ERROR("unable to get actor physics control: actor not found");
+    }
+    auto It = Snapshot->Actors->PhysicsControls.find(ActorId);
+    if (It == Snapshot->Actors->PhysicsControls.end())
+    {
+      RESPOND_ERROR("unable to get actor physics control: actor is not a vehicle");
+    }
+    return It->second;
+  };
+
   BIND_SYNC(apply_physics_control) << [this](
       cr::ActorId ActorId,
       cr::VehiclePhysicsControl PhysicsControl) -> R<void>
@@ -541,6 +1022,7 @@ void FCarlaServer::FPimpl::BindActions()
     }
 
     Vehicle->ApplyVehiclePhysicsControl(FVehiclePhysicsControl(PhysicsControl));
+    ReadSnapshot.Update(*Episode, true);
 
     return R<void>::Success();
   };
@@ -564,46 +1046,233 @@ void FCarlaServer::FPimpl::BindActions()
     return R<void>::Success();
   };
 
-  // ~~ Apply control ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-
-  BIND_SYNC(apply_control_to_vehicle) << [this](
+  BIND_SYNC(set_actor_kinematic) << [this](
       cr::ActorId ActorId,
-      cr::VehicleControl Control) -> R<void>
+      bool bEnabled) -> R<void>
   {
     REQUIRE_CARLA_EPISODE();
     auto ActorView = Episode->FindActor(ActorId);
     if (!ActorView.IsValid())
     {
-      RESPOND_ERROR("unable to apply control: actor not found");
+      RESPOND_ERROR("unable to set actor kinematic: actor not found");
     }
-    auto Vehicle = Cast<ACarlaWheeledVehicle>(ActorView.GetActor());
-    if (Vehicle == nullptr)
+    if (!UCarlaEpisode::SetActorKinematic(*ActorView.GetActor(), bEnabled))
     {
-      RESPOND_ERROR("unable to apply control: actor is not a vehicle");
+      RESPOND_ERROR("unable to set actor kinematic: not supported by actor");
     }
-    Vehicle->ApplyVehicleControl(Control, EVehicleInputPriority::Client);
     return R<void>::Success();
   };
 
-  BIND_SYNC(apply_control_to_walker) << [this](
-      cr::ActorId ActorId,
-      cr::WalkerControl Control) -> R<void>
+  BIND_SYNC(apply_transform_batch) << [this](
+      const cr::TransformBatch &Batch) -> R<void>
   {
     REQUIRE_CARLA_EPISODE();
-    auto ActorView = Episode->FindActor(ActorId);
-    if (!ActorView.IsValid())
+    if (!Batch.IsValid())
     {
-      RESPOND_ERROR("unable to apply control: actor not found");
+      RESPOND_ERROR("unable to set actor transforms: malformed batch");
     }
-    auto Pawn = Cast<APawn>(ActorView.GetActor());
-    if (Pawn == nullptr)
+    size_t NumberOfErrors = 0u;
+    for (size_t i = 0u; i < Batch.size(); ++i)
     {
-      RESPOND_ERROR("unable to apply control: actor is not a walker");
+      const auto Entry = Batch.at(i);
+      auto Actor = Episode->FindActor(Entry.actor).GetActor();
+      if ((Actor == nullptr) || Actor->IsPendingKill())
+      {
+        ++NumberOfErrors;
+        continue;
+      }
+      // Same as Command::ApplyTransform, without sweeping.
+      Actor->SetActorRelativeTransform(
+          cr::Transform(Entry.transform),
+          false,
+          nullptr,
+          ETeleportType::TeleportPhysics);
     }
-    auto Controller = Cast<AWalkerController>(Pawn->GetController());
-    if (Controller == nullptr)
+    if (NumberOfErrors > 0u)
     {
-      RESPOND_ERROR("unable to apply control: walker has an incompatible controller");
+      UE_LOG(
+          LogCarlaServer,
+          Log,
+          TEXT("Unable to set the transform of %d of %d actors: actor not found"),
+          static_cast<int>(NumberOfErrors),
+          static_cast<int>(Batch.size()));
+    }
+    return R<void>::Success();
+  };
+
+  // ~~ Scene queries ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+  // The queries only read the physics scene, so they run in parallel.
+
+  BIND_SYNC(cast_rays) << [this](
+      const cr::RayCastBatch &Batch) -> R<cr::RayHitBatch>
+  {
+    REQUIRE_CARLA_EPISODE();
+    if (!Batch.IsValid())
+    {
+      RESPOND_ERROR("unable to cast rays: malformed batch");
+    }
+    auto *World = Episode->GetWorld();
+    const float MaxDistance = 1e2f * Batch.GetMaxDistance();
+    const int32 Count = static_cast<int32>(Batch.size());
+    TArray<FHitResult> Hits;
+    TArray<bool> HasHit;
+    Hits.SetNum(Count);
+    HasHit.SetNumZeroed(Count);
+    ParallelFor(Count, [&](int32 Index)
+    {
+      const auto Ray = Batch.at(Index);
+      const FVector Origin = Ray.origin;
+      const FVector Direction = Ray.direction.ToFVector().GetSafeNormal();
+      FCollisionQueryParams Params(FName(TEXT("CastRays")), true);
+      // Same channel and responses as the lidar, any blocking object is hit.
+      HasHit[Index] = World->LineTraceSingleByChannel(
+          Hits[Index],
+          Origin,
+          Origin + MaxDistance * Direction,
+          ECC_MAX,
+          Params,
+          FCollisionResponseParams::DefaultResponseParam);
+    });
+    cr::RayHitBatch Result;
+    Result.Reserve(Count);
+    for (int32 Index = 0; Index < Count; ++Index)
+    {
+      cr::RayHit Hit{};
+      if (HasHit[Index])
+      {
+        const auto &HitInfo = Hits[Index];
+        Hit.point = HitInfo.ImpactPoint;
+        Hit.normal = {HitInfo.ImpactNormal.X, HitInfo.ImpactNormal.Y, HitInfo.ImpactNormal.Z};
+        Hit.distance = 1e-2f * HitInfo.Distance;
+        Hit.actor = Episode->FindActor(HitInfo.GetActor()).GetActorId();
+        Hit.has_hit = 1u;
+      }
+      Result.Add(Hit);
+    }
+    return Result;
+  };
+
+  BIND_SYNC(overlap_boxes) << [this](
+      const cr::BoxOverlapBatch &Batch) -> R<cr::BoxOverlapResultBatch>
+  {
+    REQUIRE_CARLA_EPISODE();
+    if (!Batch.IsValid())
+    {
+      RESPOND_ERROR("unable to overlap boxes: malformed batch");
+    }
+    auto *World = Episode->GetWorld();
+    const int32 Count = static_cast<int32>(Batch.size());
+    TArray<TArray<FOverlapResult>> Overlaps;
+    Overlaps.SetNum(Count);
+    ParallelFor(Count, [&](int32 Index)
+    {
+      const auto Box = Batch.at(Index);
+      const FVector Extent = 1e2f * Box.extent.ToFVector();
+      FCollisionQueryParams Params(FName(TEXT("OverlapBoxes")), false);
+      // Every object with collision, whatever its responses.
+      World->OverlapMultiByObjectType(
+          Overlaps[Index],
+          Box.center,
+          FRotator(Box.rotation).Quaternion(),
+          FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllObjects),
+          FCollisionShape::MakeBox(Extent),
+          Params);
+    });
+    cr::BoxOverlapResultBatch Result;
+    Result.Reserve(Count);
+    for (const auto &BoxOverlaps : Overlaps)
+    {
+      cr::BoxOverlapResult Overlap{0u, static_cast<uint8_t>(BoxOverlaps.Num() > 0 ? 1u : 0u)};
+      // The first registered actor, if any; the rest are the map.
+      for (const auto &Item : BoxOverlaps)
+      {
+        Overlap.actor = Episode->FindActor(Item.GetActor()).GetActorId();
+        if (Overlap.actor != 0u)
+        {
+          break;
+        }
+      }
+      Result.Add(Overlap);
+    }
+    return Result;
+  };
+
+  // ~~ Apply control ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+  BIND_SYNC(apply_control_to_vehicle) << [this](
+      cr::ActorId ActorId,
+      cr::VehicleControl Control) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    auto ActorView = Episode->FindActor(ActorId);
+    if (!ActorView.IsValid())
+    {
+      RESPOND_ERROR("unable to apply control: actor not found");
+    }
+    auto Vehicle = Cast<ACarlaWheeledVehicle>(ActorView.GetActor());
+    if (Vehicle == nullptr)
+    {
+      RESPOND_ERROR("unable to apply control: actor is not a vehicle");
+    }
+    Vehicle->ApplyVehicleControl(Control, EVehicleInputPriority::Client);
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(apply_vehicle_control_batch) << [this](
+      const cr::VehicleControlBatch &Batch) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    if (!Batch.IsValid())
+    {
+      RESPOND_ERROR("unable to apply controls: malformed batch");
+    }
+    size_t NumberOfErrors = 0u;
+    for (size_t i = 0u; i < Batch.size(); ++i)
+    {
+      const auto Entry = Batch.at(i);
+      auto ActorView = Episode->FindActor(Entry.actor);
+      auto Vehicle = ActorView.IsValid() ?
+          Cast<ACarlaWheeledVehicle>(ActorView.GetActor()) :
+          nullptr;
+      if (Vehicle == nullptr)
+      {
+        ++NumberOfErrors;
+        continue;
+      }
+      Vehicle->ApplyVehicleControl(cr::VehicleControl(Entry.control), EVehicleInputPriority::Client);
+    }
+    if (NumberOfErrors > 0u)
+    {
+      UE_LOG(
+          LogCarlaServer,
+          Log,
+          TEXT("Unable to apply control to %d of %d actors: actor not found or not a vehicle"),
+          static_cast<int>(NumberOfErrors),
+          static_cast<int>(Batch.size()));
+    }
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(apply_control_to_walker) << [this](
+      cr::ActorId ActorId,
+      cr::WalkerControl Control) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    auto ActorView = Episode->FindActor(ActorId);
+    if (!ActorView.IsValid())
+    {
+      RESPOND_ERROR("unable to apply control: actor not found");
+    }
+    auto Pawn = Cast<APawn>(ActorView.GetActor());
+    if (Pawn == nullptr)
+    {
+      RESPOND_ERROR("unable to apply control: actor is not a walker");
+    }
+    auto Controller = Cast<AWalkerController>(Pawn->GetController());
+    if (Controller == nullptr)
+    {
+      RESPOND_ERROR("unable to apply control: walker has an incompatible controller");
     }
     Controller->ApplyWalkerControl(Control);
     return R<void>::Success();
@@ -633,6 +1302,69 @@ void FCarlaServer::FPimpl::BindActions()
     return R<void>::Success();
   };
 
+  BIND_SYNC(register_walker_bones) << [this](
+      std::vector<std::string> BoneNames) -> R<uint32_t>
+  {
+    TArray<FName> &BoneSet = WalkerBoneSets.AddDefaulted_GetRef();
+    BoneSet.Reserve(BoneNames.size());
+    for (const auto &BoneName : BoneNames)
+    {
+      BoneSet.Emplace(*carla::rpc::ToFString(BoneName));
+    }
+    return static_cast<uint32_t>(WalkerBoneSets.Num() - 1);
+  };
+
+  BIND_SYNC(apply_walker_bone_control_batch) << [this](
+      const cr::WalkerBoneControlBatch &Batch) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    if (!Batch.IsValid() || !WalkerBoneSets.IsValidIndex(static_cast<int32>(Batch.GetBoneSet())))
+    {
+      RESPOND_ERROR("unable to apply bone controls: malformed batch or unknown bone set");
+    }
+    const TArray<FName> &BoneSet = WalkerBoneSets[Batch.GetBoneSet()];
+    // The bones of each walker are usually next to each other in the batch.
+    TMap<cr::ActorId, FWalkerBoneControl> Controls;
+    FWalkerBoneControl *Control = nullptr;
+    cr::ActorId LastWalker = 0u;
+    for (size_t i = 0u; i < Batch.size(); ++i)
+    {
+      const auto Entry = Batch.at(i);
+      if (!BoneSet.IsValidIndex(Entry.bone))
+      {
+        continue;
+      }
+      if ((Control == nullptr) || (Entry.walker != LastWalker))
+      {
+        Control = &Controls.FindOrAdd(Entry.walker);
+        LastWalker = Entry.walker;
+      }
+      Control->BoneTransformsByName.Emplace(BoneSet[Entry.bone], cr::Transform(Entry.transform));
+    }
+    size_t NumberOfErrors = 0u;
+    for (auto &Pair : Controls)
+    {
+      auto Pawn = Cast<APawn>(Episode->FindActor(Pair.Key).GetActor());
+      auto Controller = Pawn != nullptr ? Cast<AWalkerController>(Pawn->GetController()) : nullptr;
+      if (Controller == nullptr)
+      {
+        ++NumberOfErrors;
+        continue;
+      }
+      Controller->ApplyWalkerControl(Pair.Value);
+    }
+    if (NumberOfErrors > 0u)
+    {
+      UE_LOG(
+          LogCarlaServer,
+          Log,
+          TEXT("Unable to apply the bone control of %d of %d walkers: walker not found"),
+          static_cast<int>(NumberOfErrors),
+          Controls.Num());
+    }
+    return R<void>::Success();
+  };
+
   BIND_SYNC(set_actor_autopilot) << [this](
       cr::ActorId ActorId,
       bool bEnabled) -> R<void>
@@ -754,7 +1486,7 @@ void FCarlaServer::FPimpl::BindActions()
     return R<void>::Success();
   };
 
-  BIND_SYNC(get_group_traffic_lights) << [this](
+  auto get_group_traffic_lights_on_game_thread = [this](
       const cr::ActorId ActorId) -> R<std::vector<cr::ActorId>>
   {
     REQUIRE_CARLA_EPISODE();
@@ -780,6 +1512,26 @@ void FCarlaServer::FPimpl::BindActions()
     return Result;
   };
 
+  BIND_ASYNC(get_group_traffic_lights) << [this, get_group_traffic_lights_on_game_thread](
+      const cr::ActorId ActorId) -> R<std::vector<cr::ActorId>>
+  {
+    const auto Snapshot = ReadSnapshot.Get();
+    if ((Snapshot == nullptr) || !Snapshot->AreActorsUpToDate())
+    {
+      return Server.SyncCall([&]() { return get_group_traffic_lights_on_game_thread(ActorId); });
+    }
+    if (Snapshot->Actors->Actors.count(ActorId) == 0u)
+    {
+      RESPOND_ERROR("unable to get group traffic lights: actor not found");
+    }
+    auto It = Snapshot->Actors->GroupTrafficLights.find(ActorId);
+    if (It == Snapshot->Actors->GroupTrafficLights.end())
+    {
+      RESPOND_ERROR("unable to get group traffic lights: actor is not a traffic light");
+    }
+    return It->second;
+  };
+
   // ~~ Logging and playback ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   BIND_SYNC(start_recorder) << [this](std::string name) -> R<std::string>
@@ -829,6 +1581,49 @@ void FCarlaServer::FPimpl::BindActions()
         min_distance));
   };
 
+  BIND_SYNC(get_recorder_file_info) << [this](
+      std::string name) -> R<cr::RecorderFileInfo>
+  {
+    REQUIRE_CARLA_EPISODE();
+    cr::RecorderFileInfo Result;
+    std::string Error;
+    if (!Episode->GetRecorder()->QueryFileInfo(name, Result, Error))
+    {
+      RESPOND_ERROR_FSTRING(cr::ToFString(Error));
+    }
+    return Result;
+  };
+
+  BIND_SYNC(get_recorder_collisions) << [this](
+      std::string name,
+      char type1,
+      char type2) -> R<cr::RecorderCollisions>
+  {
+    REQUIRE_CARLA_EPISODE();
+    cr::RecorderCollisions Result;
+    std::string Error;
+    if (!Episode->GetRecorder()->QueryFileCollisions(name, type1, type2, Result, Error))
+    {
+      RESPOND_ERROR_FSTRING(cr::ToFString(Error));
+    }
+    return Result;
+  };
+
+  BIND_SYNC(get_recorder_actors_blocked) << [this](
+      std::string name,
+      double min_time,
+      double min_distance) -> R<cr::RecorderBlockedActors>
+  {
+    REQUIRE_CARLA_EPISODE();
+    cr::RecorderBlockedActors Result;
+    std::string Error;
+    if (!Episode->GetRecorder()->QueryFileActorsBlocked(name, min_time, min_distance, Result, Error))
+    {
+      RESPOND_ERROR_FSTRING(cr::ToFString(Error));
+    }
+    return Result;
+  };
+
   BIND_SYNC(replay_file) << [this](
       std::string name,
       double start,
@@ -850,6 +1645,52 @@ void FCarlaServer::FPimpl::BindActions()
     return R<void>::Success();
   };
 
+  BIND_SYNC(set_replayer_interpolation) << [this](bool enabled) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    Episode->GetRecorder()->SetReplayerInterpolation(enabled);
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(set_replayer_frame_by_frame) << [this](bool enabled) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    const FEpisodeSettings &Settings = Episode->GetSettings();
+    if (enabled && (!Settings.bSynchronousMode || !Settings.FixedDeltaSeconds.IsSet()))
+    {
+      RESPOND_ERROR("frame by frame replay requires synchronous mode and a fixed delta");
+    }
+    Episode->GetRecorder()->SetReplayerFrameByFrame(enabled);
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(get_replayer_actor_id) << [this](cr::ActorId recorded_id) -> R<cr::ActorId>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return Episode->GetRecorder()->GetReplayedActorId(recorded_id);
+  };
+
+  BIND_SYNC(set_recorder_keyframe_interval) << [this](double seconds) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    Episode->GetRecorder()->SetKeyFrameInterval(seconds);
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(set_recorder_compression) << [this](bool enabled) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    Episode->GetRecorder()->SetCompression(enabled);
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(set_recorder_filter) << [this](cr::RecorderFilter filter) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    Episode->GetRecorder()->SetFilter(filter);
+    return R<void>::Success();
+  };
+
   // ~~ Draw debug shapes ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   BIND_SYNC(draw_debug_shape) << [this](const cr::DebugShape &shape) -> R<void>
@@ -862,6 +1703,19 @@ void FCarlaServer::FPimpl::BindActions()
     return R<void>::Success();
   };
 
+  BIND_SYNC(draw_debug_shapes) << [this](const std::vector<cr::DebugShape> &shapes) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    auto *World = Episode->GetWorld();
+    check(World != nullptr);
+    FDebugShapeDrawer Drawer(*World);
+    for (const auto &shape : shapes)
+    {
+      Drawer.Draw(shape);
+    }
+    return R<void>::Success();
+  };
+
   // ~~ Apply commands in batch ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   using C = cr::Command;
@@ -907,19 +1761,233 @@ void FCarlaServer::FPimpl::BindActions()
       [=](auto, const C::ApplyImpulse &c) {         MAKE_RESULT(add_actor_impulse(c.actor, c.impulse)); },
       [=](auto, const C::SetSimulatePhysics &c) {   MAKE_RESULT(set_actor_simulate_physics(c.actor, c.enabled)); },
       [=](auto, const C::SetAutopilot &c) {         MAKE_RESULT(set_actor_autopilot(c.actor, c.enabled)); },
-      [=](auto, const C::ApplyWalkerState &c) {     MAKE_RESULT(set_walker_state(c.actor, c.transform, c.speed)); });
+      [=](auto, const C::ApplyWalkerState &c) {     MAKE_RESULT(set_walker_state(c.actor, c.transform, c.speed)); },
+      [=](auto, const C::SetTrafficLightState &c) { MAKE_RESULT(set_traffic_light_state(c.actor, c.state)); },
+      [=](auto, const C::SetTrafficLightTimes &c) -> CR {
+        auto response = set_traffic_light_green_time(c.actor, c.green_time);
+        if (!response.HasError())
+        {
+          response = set_traffic_light_yellow_time(c.actor, c.yellow_time);
+        }
+        if (!response.HasError())
+        {
+          response = set_traffic_light_red_time(c.actor, c.red_time);
+        }
+        MAKE_RESULT(response);
+      },
+      [=](auto, const C::FreezeTrafficLight &c) {   MAKE_RESULT(freeze_traffic_light(c.actor, c.freeze)); });
 
 #undef MAKE_RESULT
 
+  // The most frequent commands are applied in bulk, each run of consecutive
+  // commands of these types in a batch checks the episode once and is
+  // applied in a single loop. The order of the commands is preserved.
+
+  // Runs of spawns without parent first reject the vehicles whose spawn point
+  // is taken by another one of the run, without trying to spawn them. If the
+  // run is long, the physics of the vehicles spawned is turned on over the
+  // next frames, see FPhysicsActivationQueue.
+  auto apply_spawn_run = [=](
+      const std::vector<cr::Command> &Commands,
+      const size_t Begin,
+      std::vector<CR> &Result) -> size_t
+  {
+    constexpr size_t MinSpawnsToDeferPhysics = 32u;
+    size_t End = Begin;
+    for (; End < Commands.size(); ++End)
+    {
+      const auto *Command = boost::get<C::SpawnActor>(&Commands[End].command);
+      if ((Command == nullptr) || Command->parent.has_value())
+      {
+        break;
+      }
+    }
+    const auto IsCrowded = FindCrowdedSpawnPoints(Commands, Begin, End);
+    FPhysicsActivationQueue *PhysicsQueue = nullptr;
+    if ((End - Begin) >= MinSpawnsToDeferPhysics)
+    {
+      auto *GameInstance = UCarlaStatics::GetGameInstance(Episode->GetWorld());
+      PhysicsQueue = (GameInstance != nullptr) ? &GameInstance->GetPhysicsActivationQueue() : nullptr;
+    }
+    const auto CollisionError = carla::rpc::FromFString(
+        FActorSpawnResult::StatusToString(EActorSpawnResultStatus::Collision));
+    size_t NumberOfCrowded = 0u;
+    for (size_t i = Begin; i < End; ++i)
+    {
+      if (IsCrowded[i - Begin])
+      {
+        ++NumberOfCrowded;
+        Result.emplace_back(CR{cr::ResponseError(CollisionError)});
+        continue;
+      }
+      auto Response = boost::apply_visitor(command_visitor, Commands[i].command);
+      if ((PhysicsQueue != nullptr) && !Response.HasError())
+      {
+        auto View = Episode->FindActor(Response.Get());
+        if (View.IsValid() && (View.GetActorType() == FActorView::ActorType::Vehicle))
+        {
+          PhysicsQueue->Defer(*View.GetActor());
+        }
+      }
+      Result.emplace_back(std::move(Response));
+    }
+    if (NumberOfCrowded > 0u)
+    {
+      UE_LOG(
+          LogCarlaServer,
+          Log,
+          TEXT("Rejected %d of %d batched spawns, spawn point taken by another vehicle of the batch"),
+          static_cast<int>(NumberOfCrowded),
+          static_cast<int>(End - Begin));
+    }
+    return End;
+  };
+
+  auto apply_vehicle_control = [](AActor &Actor, const C::ApplyVehicleControl &c) -> const char *
+  {
+    auto Vehicle = Cast<ACarlaWheeledVehicle>(&Actor);
+    if (Vehicle == nullptr)
+    {
+      return "unable to apply control: actor is not a vehicle";
+    }
+    Vehicle->ApplyVehicleControl(c.control, EVehicleInputPriority::Client);
+    return nullptr;
+  };
+
+  auto apply_transform = [](AActor &Actor, const C::ApplyTransform &c) -> const char *
+  {
+    Actor.SetActorRelativeTransform(
+        c.transform,
+        false,
+        nullptr,
+        ETeleportType::TeleportPhysics);
+    return nullptr;
+  };
+
+  auto apply_autopilot = [](AActor &Actor, const C::SetAutopilot &c) -> const char *
+  {
+    auto Vehicle = Cast<ACarlaWheeledVehicle>(&Actor);
+    if (Vehicle == nullptr)
+    {
+      return "unable to set autopilot: actor does not support autopilot";
+    }
+    auto Controller = Cast<AWheeledVehicleAIController>(Vehicle->GetController());
+    if (Controller == nullptr)
+    {
+      return "unable to set autopilot: vehicle controller does not support autopilot";
+    }
+    Controller->SetAutopilot(c.enabled);
+    return nullptr;
+  };
+
+  // A signal controller sends one command per light and cycle, so the traffic
+  // light commands are applied in bulk too.
+
+  auto apply_traffic_light_state = [](AActor &Actor, const C::SetTrafficLightState &c) -> const char *
+  {
+    auto TrafficLight = Cast<ATrafficLightBase>(&Actor);
+    if (TrafficLight == nullptr)
+    {
+      return "unable to set state: actor is not a traffic light";
+    }
+    TrafficLight->SetTrafficLightState(static_cast<ETrafficLightState>(c.state));
+    return nullptr;
+  };
+
+  auto apply_traffic_light_times = [](AActor &Actor, const C::SetTrafficLightTimes &c) -> const char *
+  {
+    auto TrafficLight = Cast<ATrafficLightBase>(&Actor);
+    if (TrafficLight == nullptr)
+    {
+      return "unable to set times: actor is not a traffic light";
+    }
+    TrafficLight->SetGreenTime(c.green_time);
+    TrafficLight->SetYellowTime(c.yellow_time);
+    TrafficLight->SetRedTime(c.red_time);
+    return nullptr;
+  };
+
+  auto apply_traffic_light_freeze = [](AActor &Actor, const C::FreezeTrafficLight &c) -> const char *
+  {
+    auto TrafficLight = Cast<ATrafficLightBase>(&Actor);
+    if (TrafficLight == nullptr)
+    {
+      return "unable to alter frozen state: actor is not a traffic light";
+    }
+    TrafficLight->SetTimeIsFrozen(c.freeze);
+    return nullptr;
+  };
+
   BIND_SYNC(apply_batch) << [=](
       const std::vector<cr::Command> &commands,
       bool do_tick_cue)
   {
     std::vector<CR> result;
     result.reserve(commands.size());
-    for (const auto &command : commands)
+    const bool bBulk = (Episode != nullptr);
+    size_t i = 0u;
+    while (i < commands.size())
     {
-      result.emplace_back(boost::apply_visitor(command_visitor, command.command));
+      const auto &command = commands[i].command;
+      if (bBulk && (boost::get<C::ApplyVehicleControl>(&command) != nullptr))
+      {
+        CARLA_ENSURE_GAME_THREAD();
+        i = ApplyCommandRun<C::ApplyVehicleControl>(
+            *Episode, commands, i,
+            "unable to apply control: actor not found",
+            result, apply_vehicle_control);
+      }
+      else if (bBulk && (boost::get<C::ApplyTransform>(&command) != nullptr))
+      {
+        CARLA_ENSURE_GAME_THREAD();
+        i = ApplyCommandRun<C::ApplyTransform>(
+            *Episode, commands, i,
+            "unable to set actor transform: actor not found",
+            result, apply_transform);
+      }
+      else if (bBulk && (boost::get<C::SpawnActor>(&command) != nullptr) &&
+               !boost::get<C::SpawnActor>(command).parent.has_value())
+      {
+        CARLA_ENSURE_GAME_THREAD();
+        i = apply_spawn_run(commands, i, result);
+      }
+      else if (bBulk && (boost::get<C::SetAutopilot>(&command) != nullptr))
+      {
+        CARLA_ENSURE_GAME_THREAD();
+        i = ApplyCommandRun<C::SetAutopilot>(
+            *Episode, commands, i,
+            "unable to set autopilot: actor not found",
+            result, apply_autopilot);
+      }
+      else if (bBulk && (boost::get<C::SetTrafficLightState>(&command) != nullptr))
+      {
+        CARLA_ENSURE_GAME_THREAD();
+        i = ApplyCommandRun<C::SetTrafficLightState>(
+            *Episode, commands, i,
+            "unable to set state: actor not found",
+            result, apply_traffic_light_state);
+      }
+      else if (bBulk && (boost::get<C::SetTrafficLightTimes>(&command) != nullptr))
+      {
+        CARLA_ENSURE_GAME_THREAD();
+        i = ApplyCommandRun<C::SetTrafficLightTimes>(
+            *Episode, commands, i,
+            "unable to set times: actor not found",
+            result, apply_traffic_light_times);
+      }
+      else if (bBulk && (boost::get<C::FreezeTrafficLight>(&command) != nullptr))
+      {
+        CARLA_ENSURE_GAME_THREAD();
+        i = ApplyCommandRun<C::FreezeTrafficLight>(
+            *Episode, commands, i,
+            "unable to alter frozen state: actor not found",
+            result, apply_traffic_light_freeze);
+      }
+      else
+      {
+        result.emplace_back(boost::apply_visitor(command_visitor, command));
+        ++i;
+      }
     }
     if (do_tick_cue)
     {
@@ -961,17 +2029,34 @@ FDataMultiStream FCarlaServer::Start(uint16_t RPCPort, uint16_t StreamingPort)
   return Pimpl->BroadcastStream;
 }
 
+void FCarlaServer::SetStreamingSocketBufferSize(const uint32 Bytes)
+{
+  check(Pimpl != nullptr);
+  Pimpl->StreamingServer.SetSocketBufferSize(Bytes);
+}
+
 void FCarlaServer::NotifyBeginEpisode(UCarlaEpisode &Episode)
 {
   check(Pimpl != nullptr);
   UE_LOG(LogCarlaServer, Log, TEXT("New episode '%s' started"), *Episode.GetMapName());
   Pimpl->Episode = &Episode;
+  Pimpl->ReadSnapshot.Update(Episode);
 }
 
 void FCarlaServer::NotifyEndEpisode()
 {
   check(Pimpl != nullptr);
   Pimpl->Episode = nullptr;
+  Pimpl->ReadSnapshot.Clear();
+}
+
+void FCarlaServer::UpdateReadSnapshot()
+{
+  check(Pimpl != nullptr);
+  if (Pimpl->Episode != nullptr)
+  {
+    Pimpl->ReadSnapshot.Update(*Pimpl->Episode);
+  }
 }
 
 void FCarlaServer::AsyncRun(uint32 NumberOfWorkerThreads)
@@ -984,11 +2069,45 @@ void FCarlaServer::AsyncRun(uint32 NumberOfWorkerThreads)
   Pimpl->StreamingServer.AsyncRun(std::max(2u, StreamingThreads));
 }
 
+void FCarlaServer::AsyncRun(
+    uint32 RPCWorkerThreads,
+    uint32 StreamingWorkerThreads,
+    uint64 RPCCpuAffinityMask,
+    uint64 StreamingCpuAffinityMask)
+{
+  check(Pimpl != nullptr);
+  UE_LOG(
+      LogCarlaServer,
+      Log,
+      TEXT("Running CarlaServer: Threads(rpc=%d, streaming=%d) CpuMasks(rpc=0x%llx, streaming=0x%llx)"),
+      RPCWorkerThreads,
+      StreamingWorkerThreads,
+      RPCCpuAffinityMask,
+      StreamingCpuAffinityMask);
+  Pimpl->Server.AsyncRun(std::max(1u, RPCWorkerThreads), RPCCpuAffinityMask);
+  Pimpl->StreamingServer.AsyncRun(std::max(1u, StreamingWorkerThreads), StreamingCpuAffinityMask);
+}
+
 void FCarlaServer::RunSome(uint32 Milliseconds)
 {
   Pimpl->Server.SyncRunFor(carla::time_duration::milliseconds(Milliseconds));
 }
 
+bool FCarlaServer::RunUntilTickCue(uint32 Milliseconds)
+{
+  check(Pimpl != nullptr);
+  Pimpl->Server.SyncRunUntil(
+      carla::time_duration::milliseconds(Milliseconds),
+      [this]() { return Pimpl->TickCuesReceived > 0u; });
+  return TickCueReceived();
+}
+
+bool FCarlaServer::IsSkippedFrame(uint64 Frame) const
+{
+  check(Pimpl != nullptr);
+  return (Frame >= Pimpl->SkippedFramesBegin) && (Frame < Pimpl->SkippedFramesEnd);
+}
+
 bool FCarlaServer::TickCueReceived()
 {
   if (Pimpl->TickCuesReceived > 0u)
@@ -1010,3 +2129,23 @@ FDataStream FCarlaServer::OpenStream() const
   check(Pimpl != nullptr);
   return Pimpl->StreamingServer.MakeStream();
 }
+
+std::shared_ptr<FSensorBundle> FCarlaServer::OpenSensorBundle(const FString &Name)
+{
+  check(Pimpl != nullptr);
+  check(IsInGameThread());
+  auto &Entry = Pimpl->SensorBundles.FindOrAdd(Name);
+  auto Bundle = Entry.lock();
+  if (Bundle == nullptr)
+  {
+    Bundle = std::make_shared<FSensorBundle>(Pimpl->StreamingServer.MakeMultiStream());
+    Entry = Bundle;
+  }
+  return Bundle;
+}
+
+std::shared_ptr<FSensorDiskSink> FCarlaServer::GetSensorDiskSink() const
+{
+  check(Pimpl != nullptr);
+  return Pimpl->DiskSink;
+}
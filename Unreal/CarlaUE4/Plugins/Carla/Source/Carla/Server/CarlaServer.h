@@ -11,6 +11,8 @@
 
 #include "CoreMinimal.h"
 
+#include <memory>
+
 class UCarlaEpisode;
 
 class FCarlaServer
@@ -23,20 +25,55 @@ public:
 
   FDataMultiStream Start(uint16_t RPCPort, uint16_t StreamingPort);
 
+  /// Size in bytes of the kernel buffers of the streaming sockets, zero
+  /// keeps the system defaults.
+  void SetStreamingSocketBufferSize(uint32 Bytes);
+
   void NotifyBeginEpisode(UCarlaEpisode &Episode);
 
   void NotifyEndEpisode();
 
   void AsyncRun(uint32 NumberOfWorkerThreads);
 
+  /// Runs each server in its own number of worker threads, pinned to the CPUs
+  /// of its mask. A zero mask leaves the threads unrestricted.
+  void AsyncRun(
+      uint32 RPCWorkerThreads,
+      uint32 StreamingWorkerThreads,
+      uint64 RPCCpuAffinityMask,
+      uint64 StreamingCpuAffinityMask);
+
+  /// Publish what changed this frame for the read-only calls answered by the
+  /// worker threads, call it from the game thread once per frame.
+  void UpdateReadSnapshot();
+
   void RunSome(uint32 Milliseconds);
 
+  /// Run the calls bound to the game thread as soon as they arrive, until a
+  /// tick cue is received or @a Milliseconds expire. Return whether a tick
+  /// cue was received, consuming it.
+  bool RunUntilTickCue(uint32 Milliseconds);
+
   bool TickCueReceived();
 
+  /// Whether @a Frame is one of the intermediate frames of a "tick_n" that
+  /// asked not to broadcast them nor run the sensors.
+  bool IsSkippedFrame(uint64 Frame) const;
+
   void Stop();
 
   FDataStream OpenStream() const;
 
+  /// Return the bundle named @a Name, a new one is created if no sensor
+  /// belongs to it yet.
+  ///
+  /// @pre This functions needs to be called in the game-thread.
+  std::shared_ptr<FSensorBundle> OpenSensorBundle(const FString &Name);
+
+  /// Return the pool writing the data of the sensors spawned with a
+  /// "disk_sink" attribute.
+  std::shared_ptr<FSensorDiskSink> GetSensorDiskSink() const;
+
 private:
 
   class FPimpl;
@@ -0,0 +1,96 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Server/ServerSnapshot.h"
+
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/OpenDrive/OpenDrive.h"
+#include "Carla/Traffic/TrafficLightBase.h"
+#include "Carla/Vehicle/CarlaWheeledVehicle.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/MsgPack.h>
+#include <carla/rpc/NavigationMeshInfo.h>
+#include <carla/rpc/String.h>
+#include <compiler/enable-ue4-macros.h>
+
+static std::shared_ptr<const FServerSnapshot::FEpisodeData> FServerSnapshot_MakeEpisodeData(
+    const UCarlaEpisode &Episode)
+{
+  namespace cr = carla::rpc;
+  auto Data = std::make_shared<FServerSnapshot::FEpisodeData>();
+  const auto SpawnPoints = Episode.GetRecommendedSpawnPoints();
+  Data->MapInfo = cr::MapInfo{
+      cr::FromFString(Episode.GetMapName()),
+      cr::FromFString(UOpenDrive::LoadXODR(Episode.GetMapName())),
+      {SpawnPoints.GetData(), SpawnPoints.GetData() + SpawnPoints.Num()}};
+  const auto &Definitions = Episode.GetActorDefinitions();
+  Data->ActorDefinitions = {Definitions.GetData(), Definitions.GetData() + Definitions.Num()};
+  const auto Packed = carla::MsgPack::Pack(Data->ActorDefinitions);
+  Data->ActorDefinitionsVersion = cr::NavigationMeshInfo::Hash(Packed.data(), Packed.size());
+  return Data;
+}
+
+static std::shared_ptr<const FServerSnapshot::FActorData> FServerSnapshot_MakeActorData(
+    const UCarlaEpisode &Episode)
+{
+  auto Data = std::make_shared<FServerSnapshot::FActorData>();
+  const auto &Registry = Episode.GetActorRegistry();
+  Data->Actors.reserve(Registry.Num());
+  for (FActorView View : Registry)
+  {
+    AActor *Actor = View.GetActor();
+    if (Actor == nullptr)
+    {
+      continue;
+    }
+    const auto Id = View.GetActorId();
+    Data->Actors.emplace(Id, Episode.SerializeActor(View));
+    if (auto *Vehicle = Cast<ACarlaWheeledVehicle>(Actor))
+    {
+      Data->PhysicsControls.emplace(Id, Vehicle->GetVehiclePhysicsControl());
+    }
+    else if (auto *TrafficLight = Cast<ATrafficLightBase>(Actor))
+    {
+      auto &Group = Data->GroupTrafficLights[Id];
+      for (auto *Light : TrafficLight->GetGroupTrafficLights())
+      {
+        auto LightView = Episode.FindActor(Light);
+        if (LightView.IsValid())
+        {
+          Group.emplace_back(LightView.GetActorId());
+        }
+      }
+    }
+  }
+  return Data;
+}
+
+void FServerSnapshotBuffer::Update(const UCarlaEpisode &Episode, const bool bForce)
+{
+  // Only this thread writes the snapshot, no need to lock to read it.
+  const auto Previous = Snapshot;
+  const auto EpisodeId = static_cast<uint64>(Episode.GetId());
+  const auto &Registry = Episode.GetActorRegistry();
+  const auto RegistryVersion = Registry.GetVersion();
+  const bool bNewEpisode = (Previous == nullptr) || (Previous->EpisodeId != EpisodeId);
+  if (!bNewEpisode && !bForce && (Previous->RegistryVersion == RegistryVersion))
+  {
+    return;
+  }
+
+  auto Next = std::make_shared<FServerSnapshot>();
+  Next->EpisodeId = EpisodeId;
+  Next->RegistryVersion = RegistryVersion;
+  Next->RegistryVersionCounter = Registry.GetVersionCounter();
+  Next->Settings = carla::rpc::EpisodeSettings{Episode.GetSettings()};
+  Next->Episode = bNewEpisode ? FServerSnapshot_MakeEpisodeData(Episode) : Previous->Episode;
+  Next->Actors = FServerSnapshot_MakeActorData(Episode);
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Snapshot = std::move(Next);
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Util/NonCopyable.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/Actor.h>
+#include <carla/rpc/ActorDefinition.h>
+#include <carla/rpc/EpisodeSettings.h>
+#include <carla/rpc/MapInfo.h>
+#include <carla/rpc/VehiclePhysicsControl.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class UCarlaEpisode;
+
+/// Copy of the data answered by the read-only calls, built on the game thread
+/// so the RPC worker threads can answer them without waiting for it.
+struct FServerSnapshot
+{
+  using ActorId = carla::rpc::ActorId;
+
+  /// Data that does not change during the episode.
+  struct FEpisodeData
+  {
+    carla::rpc::MapInfo MapInfo;
+
+    std::vector<carla::rpc::ActorDefinition> ActorDefinitions;
+
+    /// Hash of the serialized ActorDefinitions, clients download them again
+    /// only when it changes.
+    uint64_t ActorDefinitionsVersion = 0u;
+  };
+
+  /// Data of the registered actors, rebuilt when actors are spawned or
+  /// destroyed.
+  struct FActorData
+  {
+    std::unordered_map<ActorId, carla::rpc::Actor> Actors;
+
+    std::unordered_map<ActorId, carla::rpc::VehiclePhysicsControl> PhysicsControls;
+
+    std::unordered_map<ActorId, std::vector<ActorId>> GroupTrafficLights;
+  };
+
+  uint64 EpisodeId = 0u;
+
+  uint64 RegistryVersion = 0u;
+
+  std::shared_ptr<const std::atomic<uint64>> RegistryVersionCounter;
+
+  carla::rpc::EpisodeSettings Settings;
+
+  std::shared_ptr<const FEpisodeData> Episode;
+
+  std::shared_ptr<const FActorData> Actors;
+
+  /// Whether no actor was spawned or destroyed since this snapshot was built,
+  /// otherwise the actor data may be missing or keep actors already gone.
+  bool AreActorsUpToDate() const
+  {
+    return *RegistryVersionCounter == RegistryVersion;
+  }
+};
+
+/// Double buffer of FServerSnapshot: the game thread builds the next snapshot
+/// aside and publishes it at once, readers keep the one they got for as long
+/// as they need it.
+class FServerSnapshotBuffer : private NonCopyable
+{
+public:
+
+  /// Publish a new snapshot if @a Episode changed since the last one, or if
+  /// @a bForce. Only the parts that changed are rebuilt. Call it from the
+  /// game thread.
+  void Update(const UCarlaEpisode &Episode, bool bForce = false);
+
+  void Clear()
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Snapshot = nullptr;
+  }
+
+  /// Latest snapshot published, nullptr if there is no episode.
+  std::shared_ptr<const FServerSnapshot> Get() const
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return Snapshot;
+  }
+
+private:
+
+  mutable std::mutex Mutex;
+
+  std::shared_ptr<const FServerSnapshot> Snapshot;
+};
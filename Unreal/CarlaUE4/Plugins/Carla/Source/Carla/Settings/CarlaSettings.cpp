@@ -60,6 +60,24 @@ FString QualityLevelToString(EQualityLevel QualitySettingsLevel)
   return ptr->GetNameStringByIndex(static_cast<int32>(QualitySettingsLevel));
 }
 
+/// Parses a CPU mask, either decimal or hexadecimal with the "0x" prefix.
+static bool CpuMaskFromString(const FString &SCpuMask, uint64 &CpuMask)
+{
+  if (SCpuMask.IsEmpty())
+  {
+    return false;
+  }
+  TCHAR *End = nullptr;
+  const uint64 Value = FCString::Strtoui64(*SCpuMask, &End, 0);
+  if ((End == nullptr) || (*End != TEXT('\0')))
+  {
+    UE_LOG(LogCarla, Error, TEXT("Invalid CPU affinity mask \"%s\""), *SCpuMask);
+    return false;
+  }
+  CpuMask = Value;
+  return true;
+}
+
 static void LoadSettingsFromConfig(
     const FIniFile &ConfigFile,
     UCarlaSettings &Settings,
@@ -70,6 +88,19 @@ static void LoadSettingsFromConfig(
   {
     ConfigFile.GetInt(S_CARLA_SERVER, TEXT("WorldPort"), Settings.RPCPort);
     ConfigFile.GetInt(S_CARLA_SERVER, TEXT("RPCPort"), Settings.RPCPort);
+    ConfigFile.GetInt(S_CARLA_SERVER, TEXT("RPCWorkerThreads"), Settings.RPCWorkerThreads);
+    ConfigFile.GetInt(S_CARLA_SERVER, TEXT("StreamingWorkerThreads"), Settings.StreamingWorkerThreads);
+    ConfigFile.GetInt(S_CARLA_SERVER, TEXT("StreamingSocketBufferSize"), Settings.StreamingSocketBufferSize);
+    ConfigFile.GetInt(S_CARLA_SERVER, TEXT("EpisodeStateKeyFramePeriod"), Settings.EpisodeStateKeyFramePeriod);
+    ConfigFile.GetBool(S_CARLA_SERVER, TEXT("CompactEpisodeState"), Settings.bCompactEpisodeState);
+    ConfigFile.GetString(S_CARLA_SERVER, TEXT("RenderNodePrimaryHost"), Settings.RenderNodePrimaryHost);
+    ConfigFile.GetInt(S_CARLA_SERVER, TEXT("RenderNodePrimaryPort"), Settings.RenderNodePrimaryPort);
+    FString sCpuMask;
+    ConfigFile.GetString(S_CARLA_SERVER, TEXT("RPCCpuAffinityMask"), sCpuMask);
+    CpuMaskFromString(sCpuMask, Settings.RPCCpuAffinityMask);
+    sCpuMask.Empty();
+    ConfigFile.GetString(S_CARLA_SERVER, TEXT("StreamingCpuAffinityMask"), sCpuMask);
+    CpuMaskFromString(sCpuMask, Settings.StreamingCpuAffinityMask);
   }
   ConfigFile.GetBool(S_CARLA_SERVER, TEXT("SynchronousMode"), Settings.bSynchronousMode);
   ConfigFile.GetBool(S_CARLA_SERVER, TEXT("DisableRendering"), Settings.bDisableRendering);
@@ -123,6 +154,40 @@ void UCarlaSettings::LoadSettings()
     {
       StreamingPort = Value;
     }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-rpc-workers="), Value))
+    {
+      RPCWorkerThreads = Value;
+    }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-streaming-workers="), Value))
+    {
+      StreamingWorkerThreads = Value;
+    }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-streaming-socket-buffer="), Value))
+    {
+      StreamingSocketBufferSize = Value;
+    }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-episode-key-frame-period="), Value))
+    {
+      EpisodeStateKeyFramePeriod = Value;
+    }
+    if (FParse::Param(FCommandLine::Get(), TEXT("-carla-compact-episode-state")))
+    {
+      bCompactEpisodeState = true;
+    }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-primary-port="), Value))
+    {
+      RenderNodePrimaryPort = Value;
+    }
+    FParse::Value(FCommandLine::Get(), TEXT("-carla-primary-host="), RenderNodePrimaryHost);
+    FString StringCpuMask;
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-rpc-cpu-mask="), StringCpuMask))
+    {
+      CpuMaskFromString(StringCpuMask, RPCCpuAffinityMask);
+    }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-streaming-cpu-mask="), StringCpuMask))
+    {
+      CpuMaskFromString(StringCpuMask, StreamingCpuAffinityMask);
+    }
     FString StringQualityLevel;
     if (FParse::Value(FCommandLine::Get(), TEXT("-quality-level="), StringQualityLevel))
     {
@@ -154,6 +219,17 @@ void UCarlaSettings::LogSettings() const
   UE_LOG(LogCarla, Log, TEXT("[%s]"), S_CARLA_SERVER);
   UE_LOG(LogCarla, Log, TEXT("RPC Port = %d"), RPCPort);
   UE_LOG(LogCarla, Log, TEXT("Streaming Port = %d"), StreamingPort.Get(RPCPort + 1u));
+  UE_LOG(LogCarla, Log, TEXT("RPC Worker Threads = %d"), RPCWorkerThreads);
+  UE_LOG(LogCarla, Log, TEXT("Streaming Worker Threads = %d"), StreamingWorkerThreads);
+  UE_LOG(LogCarla, Log, TEXT("RPC CPU Affinity Mask = 0x%llx"), RPCCpuAffinityMask);
+  UE_LOG(LogCarla, Log, TEXT("Streaming CPU Affinity Mask = 0x%llx"), StreamingCpuAffinityMask);
+  UE_LOG(LogCarla, Log, TEXT("Streaming Socket Buffer Size = %d"), StreamingSocketBufferSize);
+  UE_LOG(LogCarla, Log, TEXT("Episode State Key Frame Period = %d"), EpisodeStateKeyFramePeriod);
+  UE_LOG(LogCarla, Log, TEXT("Compact Episode State = %s"), EnabledDisabled(bCompactEpisodeState));
+  if (!RenderNodePrimaryHost.IsEmpty())
+  {
+    UE_LOG(LogCarla, Log, TEXT("Render Node of = %s:%d"), *RenderNodePrimaryHost, RenderNodePrimaryPort);
+  }
   UE_LOG(LogCarla, Log, TEXT("Synchronous Mode = %s"), EnabledDisabled(bSynchronousMode));
   UE_LOG(LogCarla, Log, TEXT("Rendering = %s"), EnabledDisabled(!bDisableRendering));
   UE_LOG(LogCarla, Log, TEXT("[%s]"), S_CARLA_QUALITYSETTINGS);
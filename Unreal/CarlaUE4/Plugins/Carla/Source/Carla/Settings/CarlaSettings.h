@@ -85,6 +85,49 @@ public:
   /// Optional setting for the secondary port.
   TOptional<uint32> StreamingPort;
 
+  /// Number of worker threads of the RPC server, zero picks it based on the
+  /// number of cores.
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  uint32 RPCWorkerThreads = 0u;
+
+  /// Number of worker threads of the streaming server, zero picks it based on
+  /// the number of cores.
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  uint32 StreamingWorkerThreads = 0u;
+
+  /// CPUs the RPC worker threads are pinned to, bit i for CPU i. Zero leaves
+  /// them unrestricted.
+  uint64 RPCCpuAffinityMask = 0u;
+
+  /// CPUs the streaming worker threads are pinned to, bit i for CPU i. Zero
+  /// leaves them unrestricted.
+  uint64 StreamingCpuAffinityMask = 0u;
+
+  /// Size in bytes of the kernel send and receive buffers of the streaming
+  /// sockets, zero keeps the system defaults. Fast links, like IP over
+  /// InfiniBand, need their bandwidth-delay product to be saturated.
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  uint32 StreamingSocketBufferSize = 0u;
+
+  /// Number of ticks between episode states holding every actor, the ticks
+  /// in between only send the actors that changed. One sends every actor
+  /// every tick.
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  uint32 EpisodeStateKeyFramePeriod = 1u;
+
+  /// Send the episode state quantized, about half the size.
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  bool bCompactEpisodeState = false;
+
+  /// Host of the primary server if this is a render node, that mirrors the
+  /// actors of the primary to render sensors. Empty otherwise.
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  FString RenderNodePrimaryHost;
+
+  /// RPC port of the primary server of a render node.
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  uint32 RenderNodePrimaryPort = 2000u;
+
   /// In synchronous mode, CARLA waits every tick until the control from the
   /// client is received.
   UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
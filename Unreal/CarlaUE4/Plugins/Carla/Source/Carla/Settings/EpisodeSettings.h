@@ -19,5 +19,48 @@ struct CARLA_API FEpisodeSettings
   UPROPERTY(EditAnywhere, BlueprintReadWrite)
   bool bNoRenderingMode = false;
 
+  /// Skip the render of the game viewport and the HUD, the sensors still
+  /// render.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  bool bNoViewportRendering = false;
+
   TOptional<double> FixedDeltaSeconds;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  bool bServerSideNavigation = false;
+
+  /// In meters, zero disables the physics level of detail of the vehicles.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float PhysicsLODDistance = 0.0f;
+
+  /// Destroyed vehicles and walkers kept per blueprint to be reused, zero
+  /// disables the pool.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  int32 ActorPoolSize = 0;
+
+  /// In meters, zero keeps every tile of a tiled map loaded.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float TileStreamingDistance = 0.0f;
+
+  /// In meters, zero animates every walker every frame.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float WalkerAnimationLODDistance = 0.0f;
+
+  /// In meters, zero never freezes the pose of the walkers.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float WalkerAnimationFreezeDistance = 0.0f;
+
+  /// Same defaults as the physics settings of the project.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  bool bSubstepping = true;
+
+  /// In seconds.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float MaxSubstepDeltaTime = 1.0f / 60.0f;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  int32 MaxSubsteps = 6;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  bool bAsyncPhysicsScene = false;
 };
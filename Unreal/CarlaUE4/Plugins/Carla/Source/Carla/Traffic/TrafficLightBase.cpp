@@ -7,6 +7,9 @@
 #include "Carla.h"
 #include "TrafficLightBase.h"
 
+#include "Carla/Game/CarlaGameInstance.h"
+#include "Carla/Game/CarlaStatics.h"
+#include "Carla/Traffic/TrafficLightScheduler.h"
 #include "Vehicle/CarlaWheeledVehicle.h"
 #include "Vehicle/WheeledVehicleAIController.h"
 
@@ -19,6 +22,22 @@ static bool IsValid(const ACarlaWheeledVehicle *Vehicle)
   return ((Vehicle != nullptr) && !Vehicle->IsPendingKill());
 }
 
+/// Time of @a State, negative if the state has no time.
+static float GetStateTime(
+    const ETrafficLightState State,
+    const float GreenTime,
+    const float YellowTime,
+    const float RedTime)
+{
+  switch (State)
+  {
+    case ETrafficLightState::Red:    return RedTime;
+    case ETrafficLightState::Yellow: return YellowTime;
+    case ETrafficLightState::Green:  return GreenTime;
+    default:                         return -1.0f;
+  }
+}
+
 static ETrafficSignState ToTrafficSignState(ETrafficLightState State)
 {
   switch (State)
@@ -49,32 +68,93 @@ void ATrafficLightBase::OnConstruction(const FTransform &Transform)
   SetTrafficLightState(State);
 }
 
+void ATrafficLightBase::BeginPlay()
+{
+  Super::BeginPlay();
+  auto *GameInstance = UCarlaStatics::GetGameInstance(GetWorld());
+  if (GameInstance != nullptr)
+  {
+    Scheduler = &GameInstance->GetTrafficLightScheduler();
+    ElapsedTimeUpdate = Scheduler->GetTime();
+    SetActorTickEnabled(false);
+    ScheduleNextSwitch();
+  }
+}
+
+void ATrafficLightBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  if (Scheduler != nullptr)
+  {
+    Scheduler->Cancel(*this);
+    Scheduler = nullptr;
+  }
+  Super::EndPlay(EndPlayReason);
+}
+
 void ATrafficLightBase::Tick(float DeltaSeconds)
 {
   if (TimeIsFrozen)
   {
     return;
   }
-
   ElapsedTime += DeltaSeconds;
+  SwitchIfTimeIsOver();
+}
 
-  float ChangeTime;
+void ATrafficLightBase::OnScheduledSwitch()
+{
+  UpdateElapsedTime();
+  if (!TimeIsFrozen)
+  {
+    SwitchIfTimeIsOver();
+  }
+  ScheduleNextSwitch();
+}
 
-  switch (State)
+void ATrafficLightBase::UpdateElapsedTime()
+{
+  if (Scheduler != nullptr)
   {
-    case ETrafficLightState::Red:
-      ChangeTime = RedTime;
-      break;
-    case ETrafficLightState::Yellow:
-      ChangeTime = YellowTime;
-      break;
-    case ETrafficLightState::Green:
-      ChangeTime = GreenTime;
-      break;
-    default:
-      UE_LOG(LogCarla, Error, TEXT("Invalid traffic light state!"));
-      SetTrafficLightState(ETrafficLightState::Red);
-      return;
+    const double Now = Scheduler->GetTime();
+    if (!TimeIsFrozen)
+    {
+      ElapsedTime += static_cast<float>(Now - ElapsedTimeUpdate);
+    }
+    ElapsedTimeUpdate = Now;
+  }
+}
+
+void ATrafficLightBase::ScheduleNextSwitch()
+{
+  if (Scheduler == nullptr)
+  {
+    return;
+  }
+  const float ChangeTime = GetStateTime(State, GreenTime, YellowTime, RedTime);
+  if (TimeIsFrozen)
+  {
+    Scheduler->Cancel(*this);
+  }
+  else if (ChangeTime < 0.0f)
+  {
+    // Fixed on the next tick, as the ticking lights do.
+    Scheduler->Schedule(*this, Scheduler->GetTime());
+  }
+  else
+  {
+    const double Now = Scheduler->GetTime();
+    Scheduler->Schedule(*this, FMath::Max(Now, ElapsedTimeUpdate + ChangeTime - ElapsedTime));
+  }
+}
+
+void ATrafficLightBase::SwitchIfTimeIsOver()
+{
+  const float ChangeTime = GetStateTime(State, GreenTime, YellowTime, RedTime);
+  if (ChangeTime < 0.0f)
+  {
+    UE_LOG(LogCarla, Error, TEXT("Invalid traffic light state!"));
+    SetTrafficLightState(ETrafficLightState::Red);
+    return;
   }
 
   if (ElapsedTime > ChangeTime)
@@ -103,6 +183,7 @@ void ATrafficLightBase::PostEditChangeProperty(FPropertyChangedEvent &Event)
 
 void ATrafficLightBase::SetTrafficLightState(const ETrafficLightState InState)
 {
+  UpdateElapsedTime();
   ElapsedTime = 0.0f;
   State = InState;
   SetTrafficSignState(ToTrafficSignState(State));
@@ -121,6 +202,7 @@ void ATrafficLightBase::SetTrafficLightState(const ETrafficLightState InState)
   {
     Vehicles.Empty();
   }
+  ScheduleNextSwitch();
   OnTrafficLightStateChanged(State);
 }
 
@@ -154,7 +236,7 @@ void ATrafficLightBase::NotifyWheeledVehicle(ACarlaWheeledVehicle *Vehicle)
       Controller->SetTrafficLightState(State);
       if (State != ETrafficLightState::Green)
       {
-        Vehicles.Add(Controller);
+        Vehicles.AddUnique(Controller);
         Controller->SetTrafficLight(this);
       }
     }
@@ -163,7 +245,9 @@ void ATrafficLightBase::NotifyWheeledVehicle(ACarlaWheeledVehicle *Vehicle)
 
 void ATrafficLightBase::SetGreenTime(float InGreenTime)
 {
+  UpdateElapsedTime();
   GreenTime = InGreenTime;
+  ScheduleNextSwitch();
 }
 
 float ATrafficLightBase::GetGreenTime() const
@@ -173,7 +257,9 @@ float ATrafficLightBase::GetGreenTime() const
 
 void ATrafficLightBase::SetYellowTime(float InYellowTime)
 {
+  UpdateElapsedTime();
   YellowTime = InYellowTime;
+  ScheduleNextSwitch();
 }
 
 float ATrafficLightBase::GetYellowTime() const
@@ -183,7 +269,9 @@ float ATrafficLightBase::GetYellowTime() const
 
 void ATrafficLightBase::SetRedTime(float InRedTime)
 {
+  UpdateElapsedTime();
   RedTime = InRedTime;
+  ScheduleNextSwitch();
 }
 
 float ATrafficLightBase::GetRedTime() const
@@ -193,21 +281,29 @@ float ATrafficLightBase::GetRedTime() const
 
 float ATrafficLightBase::GetElapsedTime() const
 {
+  if ((Scheduler != nullptr) && !TimeIsFrozen)
+  {
+    return ElapsedTime + static_cast<float>(Scheduler->GetTime() - ElapsedTimeUpdate);
+  }
   return ElapsedTime;
 }
 
 void ATrafficLightBase::SetElapsedTime(float InElapsedTime)
 {
+  UpdateElapsedTime();
   ElapsedTime = InElapsedTime;
+  ScheduleNextSwitch();
 }
 
 void ATrafficLightBase::SetTimeIsFrozen(bool InTimeIsFrozen)
 {
+  UpdateElapsedTime();
   TimeIsFrozen = InTimeIsFrozen;
   if (!TimeIsFrozen)
   {
     ElapsedTime = 0.0f;
   }
+  ScheduleNextSwitch();
 }
 
 bool ATrafficLightBase::GetTimeIsFrozen() const
@@ -14,6 +14,7 @@
 
 class ACarlaWheeledVehicle;
 class AWheeledVehicleAIController;
+class FTrafficLightScheduler;
 
 UCLASS()
 class CARLA_API ATrafficLightBase : public ATrafficSignBase
@@ -25,10 +26,19 @@ public:
 
   ATrafficLightBase(const FObjectInitializer &ObjectInitializer);
 
+  /// Only called if there is no FTrafficLightScheduler, e.g. in the editor.
   virtual void Tick(float DeltaSeconds) override;
 
+  /// Called by the FTrafficLightScheduler when the time of the current state
+  /// is over.
+  void OnScheduledSwitch();
+
 protected:
 
+  virtual void BeginPlay() override;
+
+  virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
   virtual void OnConstruction(const FTransform &Transform) override;
 
 #if WITH_EDITOR
@@ -103,6 +113,16 @@ protected:
 
 private:
 
+  /// Switch to the next state if the time of the current one is over.
+  void SwitchIfTimeIsOver();
+
+  /// Add to ElapsedTime the time counted by the scheduler since the last
+  /// update.
+  void UpdateElapsedTime();
+
+  /// Tell the scheduler when the current state ends.
+  void ScheduleNextSwitch();
+
   UPROPERTY(Category = "Traffic Light", EditAnywhere)
   ETrafficLightState State = ETrafficLightState::Red;
 
@@ -129,4 +149,10 @@ private:
 
   UPROPERTY(Category = "Traffic Light", VisibleAnywhere)
   TArray<ATrafficLightBase *> GroupTrafficLights;
+
+  /// Null if the light ticks by itself.
+  FTrafficLightScheduler *Scheduler = nullptr;
+
+  /// Time of the scheduler ElapsedTime was last updated.
+  double ElapsedTimeUpdate = 0.0;
 };
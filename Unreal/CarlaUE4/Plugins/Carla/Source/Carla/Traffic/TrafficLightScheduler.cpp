@@ -0,0 +1,48 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Traffic/TrafficLightScheduler.h"
+
+#include "Carla/Traffic/TrafficLightBase.h"
+
+void FTrafficLightScheduler::Schedule(ATrafficLightBase &Light, const double SwitchTime)
+{
+  const uint32 Generation = ++Generations.FindOrAdd(&Light);
+  Queue.HeapPush(FEntry{SwitchTime, &Light, Generation});
+}
+
+void FTrafficLightScheduler::Cancel(ATrafficLightBase &Light)
+{
+  auto *Generation = Generations.Find(&Light);
+  if (Generation != nullptr)
+  {
+    ++(*Generation);
+  }
+}
+
+void FTrafficLightScheduler::Tick(const float DeltaSeconds)
+{
+  Time += DeltaSeconds;
+  // Lights switched here schedule their next switch, never before the
+  // current time, so this loop ends.
+  while ((Queue.Num() > 0) && (Queue.HeapTop().SwitchTime < Time))
+  {
+    FEntry Entry;
+    Queue.HeapPop(Entry, false);
+    ATrafficLightBase *Light = Entry.Light.Get();
+    if (Light == nullptr)
+    {
+      Generations.Remove(Entry.Light);
+      continue;
+    }
+    const uint32 *Generation = Generations.Find(Entry.Light);
+    if ((Generation != nullptr) && (*Generation == Entry.Generation) && !Light->IsPendingKill())
+    {
+      Light->OnScheduledSwitch();
+    }
+  }
+}
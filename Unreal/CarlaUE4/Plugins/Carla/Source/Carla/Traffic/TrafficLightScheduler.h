@@ -0,0 +1,79 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Util/NonCopyable.h"
+
+#include "Containers/Array.h"
+#include "Containers/Map.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class ATrafficLightBase;
+
+/// Queue of the next state switch of every traffic light, ordered by time.
+/// Traffic lights that use it do not tick, they only run when their time is
+/// over.
+class FTrafficLightScheduler : private NonCopyable
+{
+public:
+
+  /// Game seconds counted by Tick.
+  double GetTime() const
+  {
+    return Time;
+  }
+
+  /// Call ATrafficLightBase::OnScheduledSwitch of @a Light the first tick the
+  /// time goes past @a SwitchTime. Replaces the switch scheduled before for
+  /// the same light, if any.
+  void Schedule(ATrafficLightBase &Light, double SwitchTime);
+
+  /// Drop the switch scheduled for @a Light, if any.
+  void Cancel(ATrafficLightBase &Light);
+
+  /// Advance the time and switch the lights whose time is over, called at the
+  /// beginning of each world tick.
+  void Tick(float DeltaSeconds);
+
+  /// Number of switches in the queue, including the ones replaced or
+  /// canceled not popped yet.
+  int32 Num() const
+  {
+    return Queue.Num();
+  }
+
+  void Clear()
+  {
+    Queue.Empty();
+    Generations.Empty();
+    Time = 0.0;
+  }
+
+private:
+
+  struct FEntry
+  {
+    double SwitchTime;
+
+    TWeakObjectPtr<ATrafficLightBase> Light;
+
+    /// Entries older than the generation of their light are ignored.
+    uint32 Generation;
+
+    bool operator<(const FEntry &Rhs) const
+    {
+      return SwitchTime < Rhs.SwitchTime;
+    }
+  };
+
+  /// Binary heap, earliest switch at the top.
+  TArray<FEntry> Queue;
+
+  TMap<TWeakObjectPtr<ATrafficLightBase>, uint32> Generations;
+
+  double Time = 0.0;
+};
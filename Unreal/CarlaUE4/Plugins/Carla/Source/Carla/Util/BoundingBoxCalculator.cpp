@@ -12,8 +12,20 @@
 
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/Character.h"
+#include "UObject/ObjectKey.h"
 
-FBoundingBox UBoundingBoxCalculator::GetActorBoundingBox(const AActor *Actor)
+/// Class and scale of an actor, vehicles and walkers of the same class share
+/// the same local bounding box unless scaled.
+using FBoundingBoxKey = TPair<FObjectKey, FVector>;
+
+/// Only used from the game thread.
+static TMap<FBoundingBoxKey, FBoundingBox> &GetBoundingBoxCache()
+{
+  static TMap<FBoundingBoxKey, FBoundingBox> Cache;
+  return Cache;
+}
+
+static FBoundingBox ComputeActorBoundingBox(const AActor *Actor)
 {
   if (Actor != nullptr)
   {
@@ -60,3 +72,25 @@ FBoundingBox UBoundingBoxCalculator::GetActorBoundingBox(const AActor *Actor)
   }
   return {};
 }
+
+FBoundingBox UBoundingBoxCalculator::GetActorBoundingBox(const AActor *Actor)
+{
+  // Traffic signs have their trigger volume edited per instance, they are not
+  // cached.
+  const bool bIsCached =
+      (Actor != nullptr) &&
+      ((Cast<ACarlaWheeledVehicle>(Actor) != nullptr) || (Cast<ACharacter>(Actor) != nullptr));
+  if (!bIsCached)
+  {
+    return ComputeActorBoundingBox(Actor);
+  }
+  auto &Cache = GetBoundingBoxCache();
+  const FBoundingBoxKey Key(FObjectKey(Actor->GetClass()), Actor->GetActorScale3D());
+  const auto *BoundingBox = Cache.Find(Key);
+  return BoundingBox != nullptr ? *BoundingBox : Cache.Add(Key, ComputeActorBoundingBox(Actor));
+}
+
+void UBoundingBoxCalculator::ClearCache()
+{
+  GetBoundingBoxCache().Empty();
+}
@@ -27,6 +27,13 @@ public:
   /// box is returned.
   ///
   /// @warning Traffic signs return its trigger box instead.
+  ///
+  /// The bounding boxes of vehicles and walkers are cached per class and
+  /// scale, call ClearCache after changing the bounds of a class.
   UFUNCTION(Category = "Carla Actor", BlueprintCallable)
   static FBoundingBox GetActorBoundingBox(const AActor *Actor);
+
+  /// Drop the cached bounding boxes, they are computed again on request.
+  UFUNCTION(Category = "Carla Actor", BlueprintCallable)
+  static void ClearCache();
 };
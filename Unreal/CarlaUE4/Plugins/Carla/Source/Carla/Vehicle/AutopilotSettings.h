@@ -0,0 +1,28 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "AutopilotSettings.generated.h"
+
+/// Settings shared by every vehicle driven by the server-side autopilot of
+/// the episode.
+USTRUCT(BlueprintType)
+struct CARLA_API FAutopilotSettings
+{
+  GENERATED_BODY()
+
+  /// Speed targeted, as a percentage of the speed limit of each vehicle.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin = "0.0", UIMin = "0.0", UIMax = "200.0"))
+  float SpeedLimitPercentage = 100.0f;
+
+  /// Scale of the distance ahead the vehicles look for obstacles.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin = "0.0", UIMin = "0.0", UIMax = "4.0"))
+  float ObstacleDistanceFactor = 1.0f;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  bool bRespectTrafficLights = true;
+};
@@ -86,7 +86,9 @@ void ACarlaWheeledVehicle::BeginPlay()
 
 float ACarlaWheeledVehicle::GetVehicleForwardSpeed() const
 {
-  return GetVehicleMovementComponent()->GetForwardSpeed();
+  return bIsSimplifiedPhysics ?
+      SimplifiedSpeed :
+      GetVehicleMovementComponent()->GetForwardSpeed();
 }
 
 FVector ACarlaWheeledVehicle::GetVehicleOrientation() const
@@ -96,7 +98,9 @@ FVector ACarlaWheeledVehicle::GetVehicleOrientation() const
 
 int32 ACarlaWheeledVehicle::GetVehicleCurrentGear() const
 {
-  return GetVehicleMovementComponent()->GetCurrentGear();
+  return bIsSimplifiedPhysics ?
+      LastAppliedControl.Gear :
+      GetVehicleMovementComponent()->GetCurrentGear();
 }
 
 FTransform ACarlaWheeledVehicle::GetVehicleBoundingBoxTransform() const
@@ -111,6 +115,10 @@ FVector ACarlaWheeledVehicle::GetVehicleBoundingBoxExtent() const
 
 float ACarlaWheeledVehicle::GetMaximumSteerAngle() const
 {
+  if (bIsSimplifiedPhysics)
+  {
+    return SimplifiedMaxSteerAngle;
+  }
   const auto &Wheels = GetVehicleMovementComponent()->Wheels;
   check(Wheels.Num() > 0);
   const auto *FrontWheel = Wheels[0];
@@ -142,8 +150,16 @@ void ACarlaWheeledVehicle::FlushVehicleControl()
       MovementComponent->SetTargetGear(InputControl.Control.Gear, true);
     }
   }
-  InputControl.Control.Gear = MovementComponent->GetCurrentGear();
-  InputControl.Control.bReverse = InputControl.Control.Gear < 0;
+  if (bIsSimplifiedPhysics)
+  {
+    // There is no transmission, the gear follows the requested direction.
+    InputControl.Control.Gear = InputControl.Control.bReverse ? -1 : 1;
+  }
+  else
+  {
+    InputControl.Control.Gear = MovementComponent->GetCurrentGear();
+    InputControl.Control.bReverse = InputControl.Control.Gear < 0;
+  }
   LastAppliedControl = InputControl.Control;
   InputControl.Priority = EVehicleInputPriority::INVALID;
 }
@@ -185,6 +201,9 @@ void ACarlaWheeledVehicle::SetHandbrakeInput(const bool Value)
 
 TArray<float> ACarlaWheeledVehicle::GetWheelsFrictionScale()
 {
+  // The wheels only exist with the full simulation.
+  SetSimplifiedPhysics(false);
+
   UWheeledVehicleMovementComponent4W *Vehicle4W = Cast<UWheeledVehicleMovementComponent4W>(
       GetVehicleMovement());
   check(Vehicle4W != nullptr);
@@ -199,6 +218,8 @@ TArray<float> ACarlaWheeledVehicle::GetWheelsFrictionScale()
 
 void ACarlaWheeledVehicle::SetWheelsFrictionScale(TArray<float> &WheelsFrictionScale)
 {
+  SetSimplifiedPhysics(false);
+
   UWheeledVehicleMovementComponent4W *Vehicle4W = Cast<UWheeledVehicleMovementComponent4W>(
       GetVehicleMovement());
   check(Vehicle4W != nullptr);
@@ -212,6 +233,8 @@ void ACarlaWheeledVehicle::SetWheelsFrictionScale(TArray<float> &WheelsFrictionS
 
 FVehiclePhysicsControl ACarlaWheeledVehicle::GetVehiclePhysicsControl()
 {
+  SetSimplifiedPhysics(false);
+
   UWheeledVehicleMovementComponent4W *Vehicle4W = Cast<UWheeledVehicleMovementComponent4W>(
       GetVehicleMovement());
   check(Vehicle4W != nullptr);
@@ -291,6 +314,8 @@ FVehiclePhysicsControl ACarlaWheeledVehicle::GetVehiclePhysicsControl()
 
 void ACarlaWheeledVehicle::ApplyVehiclePhysicsControl(const FVehiclePhysicsControl &PhysicsControl)
 {
+  SetSimplifiedPhysics(false);
+
   UWheeledVehicleMovementComponent4W *Vehicle4W = Cast<UWheeledVehicleMovementComponent4W>(
       GetVehicleMovement());
   check(Vehicle4W != nullptr);
@@ -369,3 +394,111 @@ void ACarlaWheeledVehicle::ApplyVehiclePhysicsControl(const FVehiclePhysicsContr
   }
 
 }
+
+// =============================================================================
+// -- Physics level of detail --------------------------------------------------
+// =============================================================================
+
+/// Height of @a Vehicle over the ground at @a Location, negative if there is
+/// no ground below it.
+static float GetHeightOverGround(const ACarlaWheeledVehicle &Vehicle, const FVector &Location)
+{
+  constexpr float TRACE_UP = 200.0f;
+  constexpr float TRACE_DOWN = 500.0f;
+  FCollisionQueryParams Params(FName(TEXT("SimplifiedPhysics")), false, &Vehicle);
+  FHitResult Hit;
+  const bool bHit = Vehicle.GetWorld()->LineTraceSingleByChannel(
+      Hit,
+      Location + FVector(0.0f, 0.0f, TRACE_UP),
+      Location - FVector(0.0f, 0.0f, TRACE_DOWN),
+      ECC_WorldStatic,
+      Params);
+  return bHit ? Location.Z - Hit.ImpactPoint.Z : -1.0f;
+}
+
+void ACarlaWheeledVehicle::SetSimplifiedPhysics(const bool bEnabled)
+{
+  if (bEnabled == bIsSimplifiedPhysics)
+  {
+    return;
+  }
+  auto *MovementComponent = GetVehicleMovementComponent();
+  auto *Root = Cast<UPrimitiveComponent>(GetRootComponent());
+  check(MovementComponent != nullptr);
+  check(Root != nullptr);
+  if (bEnabled)
+  {
+    SimplifiedSpeed = MovementComponent->GetForwardSpeed();
+    SimplifiedMaxSteerAngle = GetMaximumSteerAngle();
+    SimplifiedGroundOffset = GetHeightOverGround(*this, GetActorLocation());
+    // Removes the vehicle from the PhysX vehicle manager.
+    MovementComponent->DestroyPhysicsState();
+    MovementComponent->SetComponentTickEnabled(false);
+    Root->SetSimulatePhysics(false);
+    bIsSimplifiedPhysics = true;
+  }
+  else
+  {
+    bIsSimplifiedPhysics = false;
+    Root->SetSimulatePhysics(true);
+    MovementComponent->SetComponentTickEnabled(true);
+    MovementComponent->RecreatePhysicsState();
+    // Keep moving as the bicycle model did.
+    Root->SetPhysicsLinearVelocity(GetActorForwardVector() * SimplifiedSpeed);
+    Root->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+    Root->ComponentVelocity = FVector::ZeroVector;
+  }
+}
+
+void ACarlaWheeledVehicle::TickSimplifiedPhysics(const float DeltaSeconds)
+{
+  if (!bIsSimplifiedPhysics || (DeltaSeconds <= 0.0f))
+  {
+    return;
+  }
+
+  // In cm/s^2, rough values of a passenger car.
+  constexpr float MAX_ACCELERATION = 350.0f;
+  constexpr float MAX_DECELERATION = 800.0f;
+  constexpr float ROLLING_DECELERATION = 50.0f;
+  // Quadratic drag, about 150 km/h of top speed at full throttle.
+  constexpr float DRAG = 2e-5f;
+  // Distance between the axles relative to the length of the bounds.
+  constexpr float WHEELBASE_RATIO = 0.6f;
+
+  const auto &Control = LastAppliedControl;
+
+  // Braking slows the vehicle down without reversing it.
+  const float Braking =
+      ((Control.bHandBrake ? 1.0f : Control.Brake) * MAX_DECELERATION + ROLLING_DECELERATION) * DeltaSeconds;
+  SimplifiedSpeed = FMath::Sign(SimplifiedSpeed) * FMath::Max(0.0f, FMath::Abs(SimplifiedSpeed) - Braking);
+  const float Direction = Control.bReverse ? -1.0f : 1.0f;
+  const float Acceleration =
+      Direction * Control.Throttle * MAX_ACCELERATION -
+      DRAG * SimplifiedSpeed * FMath::Abs(SimplifiedSpeed);
+  SimplifiedSpeed += Acceleration * DeltaSeconds;
+
+  // Kinematic bicycle model around the rear axle.
+  const float Wheelbase = FMath::Max(1.0f, 2.0f * WHEELBASE_RATIO * GetVehicleBoundingBoxExtent().X);
+  const float SteerAngle = FMath::DegreesToRadians(Control.Steer * SimplifiedMaxSteerAngle);
+  const float YawRate = FMath::RadiansToDegrees(SimplifiedSpeed / Wheelbase * FMath::Tan(SteerAngle));
+
+  FRotator Rotation = GetActorRotation();
+  Rotation.Yaw += YawRate * DeltaSeconds;
+  const FVector Forward = Rotation.Vector();
+  FVector Location = GetActorLocation() + Forward * SimplifiedSpeed * DeltaSeconds;
+
+  // Follow the ground when there was ground below the vehicle.
+  if (SimplifiedGroundOffset >= 0.0f)
+  {
+    const float Height = GetHeightOverGround(*this, Location);
+    if (Height >= 0.0f)
+    {
+      Location.Z += SimplifiedGroundOffset - Height;
+    }
+  }
+
+  SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+  // Reported by GetVelocity while the body does not simulate.
+  GetRootComponent()->ComponentVelocity = Forward * SimplifiedSpeed;
+}
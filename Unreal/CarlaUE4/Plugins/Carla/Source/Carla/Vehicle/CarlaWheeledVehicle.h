@@ -176,6 +176,26 @@ public:
 
   void SetWheelsFrictionScale(TArray<float> &WheelsFrictionScale);
 
+  /// @}
+  // ===========================================================================
+  /// @name Physics level of detail
+  // ===========================================================================
+  /// @{
+public:
+
+  /// Replace the PhysX vehicle simulation by a kinematic bicycle model driven
+  /// by the last applied control, much cheaper for vehicles far from any
+  /// hero. The vehicle keeps its speed when switching in either direction.
+  void SetSimplifiedPhysics(bool bEnabled);
+
+  bool IsSimplifiedPhysics() const
+  {
+    return bIsSimplifiedPhysics;
+  }
+
+  /// Move the vehicle with the bicycle model, does nothing unless simplified.
+  void TickSimplifiedPhysics(float DeltaSeconds);
+
   /// @}
   // ===========================================================================
   /// @name Overriden from AActor
@@ -203,4 +223,17 @@ private:
   InputControl;
 
   FVehicleControl LastAppliedControl;
+
+  bool bIsSimplifiedPhysics = false;
+
+  /// Forward speed of the bicycle model in cm/s.
+  float SimplifiedSpeed = 0.0f;
+
+  /// Maximum steer angle in degrees, the wheels are destroyed with the PhysX
+  /// vehicle.
+  float SimplifiedMaxSteerAngle = 0.0f;
+
+  /// Height of the actor over the ground, kept while simplified. Negative if
+  /// no ground was found below the vehicle.
+  float SimplifiedGroundOffset = -1.0f;
 };
@@ -0,0 +1,41 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Vehicle/VehicleControlBatch.h"
+
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Vehicle/CarlaWheeledVehicle.h"
+#include "Carla/Vehicle/WheeledVehicleAIController.h"
+
+void FVehicleControlBatch::Tick(const UCarlaEpisode &Episode, const float DeltaSeconds)
+{
+  Vehicles.Reset();
+  for (auto &&View : Episode.GetActorRegistry())
+  {
+    if ((View.GetActorType() != FActorView::ActorType::Vehicle) || !View.IsValid())
+    {
+      continue;
+    }
+    auto *Vehicle = Cast<ACarlaWheeledVehicle>(const_cast<AActor *>(View.GetActor()));
+    auto *Controller = Cast<AWheeledVehicleAIController>(Vehicle != nullptr ? Vehicle->GetController() : nullptr);
+    if ((Controller == nullptr) || Controller->IsPendingKill())
+    {
+      continue;
+    }
+    // From now on the controller is only ticked here.
+    if (Controller->IsActorTickEnabled())
+    {
+      Controller->SetActorTickEnabled(false);
+    }
+    Controller->UpdateVehicleControl(DeltaSeconds);
+    Vehicles.Emplace(Vehicle);
+  }
+  for (auto *Vehicle : Vehicles)
+  {
+    Vehicle->FlushVehicleControl();
+  }
+}
@@ -0,0 +1,31 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Util/NonCopyable.h"
+
+#include "Containers/Array.h"
+
+class ACarlaWheeledVehicle;
+class UCarlaEpisode;
+
+/// Updates the controls of every vehicle of the episode at the beginning of
+/// the tick, instead of each AWheeledVehicleAIController doing it in its own
+/// actor tick. First the controllers compute their controls, then all the
+/// pending controls, the ones sent by the clients too, are pushed into the
+/// movement components in a single pass before the physics step.
+class FVehicleControlBatch : private NonCopyable
+{
+public:
+
+  void Tick(const UCarlaEpisode &Episode, float DeltaSeconds);
+
+private:
+
+  /// Reused every tick to avoid allocations.
+  TArray<ACarlaWheeledVehicle *> Vehicles;
+};
@@ -0,0 +1,148 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Vehicle/VehicleObstacleGrid.h"
+
+#include "Carla/Game/CarlaEpisode.h"
+
+/// Slab test of the segment from @a Start to @a End against the box of
+/// half-size @a Extent centered at the origin.
+static bool FVehicleObstacleGrid_SegmentHitsBox(
+    const FVector &Start,
+    const FVector &End,
+    const FVector &Extent)
+{
+  const FVector Direction = End - Start;
+  float Enter = 0.0f;
+  float Exit = 1.0f;
+  for (int32 Axis = 0; Axis < 3; ++Axis)
+  {
+    if (FMath::Abs(Direction[Axis]) < SMALL_NUMBER)
+    {
+      if (FMath::Abs(Start[Axis]) > Extent[Axis])
+      {
+        return false;
+      }
+      continue;
+    }
+    float T0 = (-Extent[Axis] - Start[Axis]) / Direction[Axis];
+    float T1 = (Extent[Axis] - Start[Axis]) / Direction[Axis];
+    if (T0 > T1)
+    {
+      Swap(T0, T1);
+    }
+    Enter = FMath::Max(Enter, T0);
+    Exit = FMath::Min(Exit, T1);
+    if (Enter > Exit)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FVehicleObstacleGrid::Update(const UCarlaEpisode &Episode)
+{
+  if (UpdateFrame == GFrameCounter)
+  {
+    return;
+  }
+  UpdateFrame = GFrameCounter;
+  Boxes.Reset();
+  for (auto &Cell : Cells)
+  {
+    Cell.Value.Reset();
+  }
+
+  for (auto &&View : Episode.GetActorRegistry())
+  {
+    const auto Type = View.GetActorType();
+    if (((Type != FActorView::ActorType::Vehicle) && (Type != FActorView::ActorType::Walker)) ||
+        !View.IsValid() ||
+        (View.GetActorInfo() == nullptr))
+    {
+      continue;
+    }
+    const AActor *Actor = View.GetActor();
+    const auto &BoundingBox = View.GetActorInfo()->BoundingBox;
+    FTransform Transform = Actor->GetActorTransform();
+    Transform.SetLocation(Transform.TransformPosition(BoundingBox.Origin));
+    Transform.SetScale3D(FVector::OneVector);
+    const FVector Extent = BoundingBox.Extent * Actor->GetActorScale3D().GetAbs();
+
+    const int32 Index = Boxes.Emplace(FBox{Actor, Transform, Extent});
+
+    // Cells overlapped by the axis-aligned bounds of the box.
+    const FMatrix Rotation = FRotationMatrix(Transform.Rotator());
+    const FVector Half =
+        Rotation.GetScaledAxis(EAxis::X).GetAbs() * Extent.X +
+        Rotation.GetScaledAxis(EAxis::Y).GetAbs() * Extent.Y +
+        Rotation.GetScaledAxis(EAxis::Z).GetAbs() * Extent.Z;
+    const FIntPoint Min = GetCell(Transform.GetLocation() - Half);
+    const FIntPoint Max = GetCell(Transform.GetLocation() + Half);
+    for (int32 X = Min.X; X <= Max.X; ++X)
+    {
+      for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+      {
+        Cells.FindOrAdd(FIntPoint{X, Y}).Emplace(Index);
+      }
+    }
+  }
+}
+
+bool FVehicleObstacleGrid::IsAnySegmentBlocked(
+    const TArray<TPair<FVector, FVector>> &Segments,
+    const AActor *Ignored) const
+{
+  if ((Segments.Num() == 0) || (Boxes.Num() == 0))
+  {
+    return false;
+  }
+  FVector Min = Segments[0].Key;
+  FVector Max = Segments[0].Key;
+  for (const auto &Segment : Segments)
+  {
+    Min = Min.ComponentMin(Segment.Key.ComponentMin(Segment.Value));
+    Max = Max.ComponentMax(Segment.Key.ComponentMax(Segment.Value));
+  }
+
+  // A box may be in several cells, test it once.
+  TArray<int32, TInlineAllocator<32>> Tested;
+  const FIntPoint MinCell = GetCell(Min);
+  const FIntPoint MaxCell = GetCell(Max);
+  for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+  {
+    for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+    {
+      const auto *Cell = Cells.Find(FIntPoint{X, Y});
+      if (Cell == nullptr)
+      {
+        continue;
+      }
+      for (const int32 Index : *Cell)
+      {
+        const auto &Box = Boxes[Index];
+        if ((Box.Actor == Ignored) || Tested.Contains(Index))
+        {
+          continue;
+        }
+        Tested.Emplace(Index);
+        for (const auto &Segment : Segments)
+        {
+          if (FVehicleObstacleGrid_SegmentHitsBox(
+                  Box.Transform.InverseTransformPositionNoScale(Segment.Key),
+                  Box.Transform.InverseTransformPositionNoScale(Segment.Value),
+                  Box.Extent))
+          {
+            return true;
+          }
+        }
+      }
+    }
+  }
+  return false;
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Util/NonCopyable.h"
+
+#include "Containers/Array.h"
+#include "Containers/Map.h"
+
+class AActor;
+class UCarlaEpisode;
+
+/// Uniform grid of the bounding boxes of the vehicles and walkers of the
+/// episode, so the autopilot can look for obstacles ahead with a few
+/// analytic tests instead of tracing against the physics scene.
+class FVehicleObstacleGrid : private NonCopyable
+{
+public:
+
+  /// Side of the cells in centimeters.
+  static constexpr float CellSize = 1000.0f;
+
+  /// Rebuild the grid with the actors of @a Episode, once per frame; later
+  /// calls in the same frame do nothing.
+  void Update(const UCarlaEpisode &Episode);
+
+  /// Whether any of the @a Segments, given as pairs of start and end points,
+  /// crosses the bounding box of an actor other than @a Ignored.
+  bool IsAnySegmentBlocked(
+      const TArray<TPair<FVector, FVector>> &Segments,
+      const AActor *Ignored) const;
+
+  int32 Num() const
+  {
+    return Boxes.Num();
+  }
+
+private:
+
+  struct FBox
+  {
+    const AActor *Actor;
+
+    FTransform Transform;
+
+    FVector Extent;
+  };
+
+  FIntPoint GetCell(const FVector &Location) const
+  {
+    return {FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize)};
+  }
+
+  uint64 UpdateFrame = 0u;
+
+  TArray<FBox> Boxes;
+
+  /// Indices in Boxes of the boxes that overlap each cell.
+  TMap<FIntPoint, TArray<int32>> Cells;
+};
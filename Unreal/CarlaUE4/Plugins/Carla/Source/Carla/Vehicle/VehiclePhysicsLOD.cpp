@@ -0,0 +1,112 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Vehicle/VehiclePhysicsLOD.h"
+
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Vehicle/CarlaWheeledVehicle.h"
+
+bool FVehiclePhysicsLOD::IsHero(const FActorView &View)
+{
+  const auto *Info = View.GetActorInfo();
+  if (Info == nullptr)
+  {
+    return false;
+  }
+  const auto *Role = Info->Description.Variations.Find("role_name");
+  return (Role != nullptr) && (Role->Value == "hero");
+}
+
+void FVehiclePhysicsLOD::Tick(const UCarlaEpisode &Episode, const float DeltaSeconds)
+{
+  // Vehicles switch back to full simulation a bit closer than they left it,
+  // so the ones right at the distance do not switch every tick.
+  constexpr float HYSTERESIS = 0.9f;
+  constexpr float TO_CENTIMETERS = 1e2f;
+
+  const float Distance = TO_CENTIMETERS * Episode.GetSettings().PhysicsLODDistance;
+  const auto &Registry = Episode.GetActorRegistry();
+  const auto &TileStreamer = Episode.GetWorldTileStreamer();
+
+  TArray<FVector> Heroes;
+  if ((Distance > 0.0f) || TileStreamer.HasTiles())
+  {
+    for (auto &&View : Registry)
+    {
+      if ((View.GetActorType() == FActorView::ActorType::Vehicle) && View.IsValid() && IsHero(View))
+      {
+        Heroes.Add(View.GetActor()->GetActorLocation());
+      }
+    }
+  }
+  if (Heroes.Num() == 0)
+  {
+    RestoreAll();
+    return;
+  }
+
+  // Without a distance only the vehicles on unloaded tiles are simplified.
+  const float FarSquared = Distance > 0.0f ?
+      FMath::Square(Distance) :
+      TNumericLimits<float>::Max();
+  const float NearSquared = Distance > 0.0f ?
+      FMath::Square(HYSTERESIS * Distance) :
+      TNumericLimits<float>::Max();
+  Simplified.Reset();
+  for (auto &&View : Registry)
+  {
+    if ((View.GetActorType() != FActorView::ActorType::Vehicle) || !View.IsValid() || IsHero(View))
+    {
+      continue;
+    }
+    auto *Vehicle = Cast<ACarlaWheeledVehicle>(const_cast<AActor *>(View.GetActor()));
+    if (Vehicle == nullptr)
+    {
+      continue;
+    }
+    const FVector Location = Vehicle->GetActorLocation();
+    float ClosestSquared = TNumericLimits<float>::Max();
+    for (const auto &Hero : Heroes)
+    {
+      ClosestSquared = FMath::Min(ClosestSquared, FVector::DistSquared(Location, Hero));
+    }
+    const bool bIsOnLoadedTile = TileStreamer.IsLocationLoaded(Location);
+    if (Vehicle->IsSimplifiedPhysics())
+    {
+      if ((ClosestSquared < NearSquared) && bIsOnLoadedTile)
+      {
+        Vehicle->SetSimplifiedPhysics(false);
+        continue;
+      }
+    }
+    else
+    {
+      // Vehicles with the physics disabled, e.g. by the replayer, are left
+      // alone.
+      const auto *Root = Cast<UPrimitiveComponent>(Vehicle->GetRootComponent());
+      if (((ClosestSquared <= FarSquared) && bIsOnLoadedTile) || (Root == nullptr) || !Root->IsSimulatingPhysics())
+      {
+        continue;
+      }
+      Vehicle->SetSimplifiedPhysics(true);
+    }
+    Vehicle->TickSimplifiedPhysics(DeltaSeconds);
+    Simplified.Add(Vehicle);
+  }
+}
+
+void FVehiclePhysicsLOD::RestoreAll()
+{
+  for (auto &Vehicle : Simplified)
+  {
+    if (Vehicle.IsValid())
+    {
+      Vehicle->SetSimplifiedPhysics(false);
+    }
+  }
+  Simplified.Reset();
+}
@@ -0,0 +1,42 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Util/NonCopyable.h"
+
+#include "Containers/Array.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class ACarlaWheeledVehicle;
+class FActorView;
+class UCarlaEpisode;
+
+/// Physics level of detail of the vehicles. Vehicles farther than
+/// FEpisodeSettings::PhysicsLODDistance from every hero vehicle, the ones with
+/// role_name "hero", are moved by the simplified model of
+/// ACarlaWheeledVehicle instead of the full PhysX simulation. So are the
+/// vehicles on the tiles of the map unloaded by FWorldTileStreamer, which have
+/// no ground to drive on.
+class FVehiclePhysicsLOD : private NonCopyable
+{
+public:
+
+  /// Switch the vehicles of @a Episode that crossed the distance and move the
+  /// simplified ones.
+  void Tick(const UCarlaEpisode &Episode, float DeltaSeconds);
+
+  /// Whether @a View is a vehicle with role_name "hero".
+  static bool IsHero(const FActorView &View);
+
+private:
+
+  /// Back to full simulation every simplified vehicle.
+  void RestoreAll();
+
+  /// Vehicles currently simplified.
+  TArray<TWeakObjectPtr<ACarlaWheeledVehicle>> Simplified;
+};
@@ -7,6 +7,9 @@
 #include "Carla.h"
 #include "WheeledVehicleAIController.h"
 
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Game/CarlaStatics.h"
+#include "Carla/Vehicle/VehicleObstacleGrid.h"
 #include "MapGen/RoadMap.h"
 #include "Traffic/RoutePlanner.h"
 #include "Vehicle/CarlaWheeledVehicle.h"
@@ -39,17 +42,22 @@ static bool RayCast(const AActor &Actor, const FVector &Start, const FVector &En
   return Success && OutHit.bBlockingHit;
 }
 
+/// Without @a Grid, the segments are traced against the physics scene, which
+/// also finds other dynamic objects than vehicles and walkers. The distance
+/// looked ahead is scaled by @a DistanceFactor.
 static bool IsThereAnObstacleAhead(
     const ACarlaWheeledVehicle &Vehicle,
     const float Speed,
-    const FVector &Direction)
+    const FVector &Direction,
+    const FVehicleObstacleGrid *Grid,
+    const float DistanceFactor)
 {
   const auto ForwardVector = Vehicle.GetVehicleOrientation();
   const auto VehicleBounds = Vehicle.GetVehicleBoundingBoxExtent();
 
   FVector NormDirection = Direction.GetSafeNormal();
 
-  const float Distance = std::max(50.0f, Speed * Speed); // why?
+  const float Distance = DistanceFactor * std::max(50.0f, Speed * Speed); // why?
 
   const FVector StartCenter = Vehicle.GetActorLocation() +
       (ForwardVector * (250.0f + VehicleBounds.X / 2.0f)) + FVector(0.0f, 0.0f, 50.0f);
@@ -63,6 +71,16 @@ static bool IsThereAnObstacleAhead(
       (FVector(-ForwardVector.Y, ForwardVector.X, ForwardVector.Z) * 100.0f);
   const FVector EndLeft = StartLeft + NormDirection * (Distance + VehicleBounds.X / 2.0f);
 
+  if (Grid != nullptr)
+  {
+    TArray<TPair<FVector, FVector>> Segments;
+    Segments.Reserve(3);
+    Segments.Emplace(StartCenter, EndCenter);
+    Segments.Emplace(StartRight, EndRight);
+    Segments.Emplace(StartLeft, EndLeft);
+    return Grid->IsAnySegmentBlocked(Segments, &Vehicle);
+  }
+
   return
     RayCast(Vehicle, StartCenter, EndCenter) ||
     RayCast(Vehicle, StartRight, EndRight) ||
@@ -135,6 +153,17 @@ void AWheeledVehicleAIController::Tick(const float DeltaTime)
     return;
   }
 
+  UpdateVehicleControl(DeltaTime);
+  Vehicle->FlushVehicleControl();
+}
+
+void AWheeledVehicleAIController::UpdateVehicleControl(float)
+{
+  if (!IsPossessingAVehicle())
+  {
+    return;
+  }
+
   if (bAutopilotEnabled)
   {
     Vehicle->ApplyVehicleControl(TickAutopilotController(), EVehicleInputPriority::Autopilot);
@@ -143,8 +172,6 @@ void AWheeledVehicleAIController::Tick(const float DeltaTime)
   {
     Vehicle->ApplyVehicleControl(FVehicleControl{}, EVehicleInputPriority::Relaxation);
   }
-
-  Vehicle->FlushVehicleControl();
 }
 
 // =============================================================================
@@ -175,26 +202,28 @@ void AWheeledVehicleAIController::ConfigureAutopilot(const bool Enable, const bo
   /// enabling autopilot right after initializing a vehicle.
   if (bAutopilotEnabled)
   {
-    for (TActorIterator<ARoutePlanner> It(GetWorld()); It; ++It)
+    // Check if we are inside a route planner, asking the vehicle for what it
+    // overlaps instead of every route planner of the map.
+    TArray<UPrimitiveComponent *> OverlappingComponents;
+    Vehicle->GetOverlappingComponents(OverlappingComponents);
+    for (auto *Component : OverlappingComponents)
     {
-      ARoutePlanner *RoutePlanner = *It;
-      // Check if we are inside this route planner.
-      TSet<AActor *> OverlappingActors;
-      RoutePlanner->TriggerVolume->GetOverlappingActors(
-          OverlappingActors,
-          ACarlaWheeledVehicle::StaticClass());
-      for (auto *Actor : OverlappingActors)
+      auto *RoutePlanner = Cast<ARoutePlanner>(Component != nullptr ? Component->GetOwner() : nullptr);
+      if ((RoutePlanner != nullptr) && (Component == RoutePlanner->TriggerVolume))
       {
-        if (Actor == Vehicle)
-        {
-          RoutePlanner->AssignRandomRoute(*this);
-          return;
-        }
+        RoutePlanner->AssignRandomRoute(*this);
+        return;
       }
     }
   }
 }
 
+const FVehicleObstacleGrid *AWheeledVehicleAIController::GetObstacleGrid() const
+{
+  UCarlaEpisode *Episode = UCarlaStatics::GetCurrentEpisode(GetWorld());
+  return (Episode != nullptr ? &Episode->GetVehicleObstacleGrid() : nullptr);
+}
+
 // =============================================================================
 // -- Traffic ------------------------------------------------------------------
 // =============================================================================
@@ -245,20 +274,29 @@ FVehicleControl AWheeledVehicleAIController::TickAutopilotController()
   // Speed in km/h.
   const auto Speed = Vehicle->GetVehicleForwardSpeed() * 0.036f;
 
+  const UCarlaEpisode *Episode = UCarlaStatics::GetCurrentEpisode(GetWorld());
+  const FAutopilotSettings Settings =
+      Episode != nullptr ? Episode->GetAutopilotSettings() : FAutopilotSettings{};
+
   float Throttle;
-  if (TrafficLightState != ETrafficLightState::Green)
+  if (Settings.bRespectTrafficLights && (TrafficLightState != ETrafficLightState::Green))
   {
     Vehicle->SetAIVehicleState(ECarlaWheeledVehicleState::WaitingForRedLight);
     Throttle = Stop(Speed);
   }
-  else if (IsThereAnObstacleAhead(*Vehicle, Speed, Direction))
+  else if (IsThereAnObstacleAhead(
+      *Vehicle,
+      Speed,
+      Direction,
+      GetObstacleGrid(),
+      Settings.ObstacleDistanceFactor))
   {
     Vehicle->SetAIVehicleState(ECarlaWheeledVehicleState::ObstacleAhead);
     Throttle = Stop(Speed);
   }
   else
   {
-    Throttle = Move(Speed);
+    Throttle = Move(Speed, SpeedLimit * Settings.SpeedLimitPercentage / 100.0f);
   }
 
   FVehicleControl AutopilotControl;
@@ -486,13 +524,13 @@ float AWheeledVehicleAIController::Stop(const float Speed)
   return (Speed >= 1.0f ? -Speed / SpeedLimit : 0.0f);
 }
 
-float AWheeledVehicleAIController::Move(const float Speed)
+float AWheeledVehicleAIController::Move(const float Speed, const float TargetSpeed)
 {
-  if (Speed >= SpeedLimit)
+  if (Speed >= TargetSpeed)
   {
     return Stop(Speed);
   }
-  else if (Speed >= SpeedLimit - 10.0f)
+  else if (Speed >= TargetSpeed - 10.0f)
   {
     return 0.5f;
   }
@@ -16,6 +16,7 @@
 #include "WheeledVehicleAIController.generated.h"
 
 class ACarlaWheeledVehicle;
+class FVehicleObstacleGrid;
 class URandomEngine;
 class URoadMap;
 
@@ -48,8 +49,13 @@ public:
 
   void OnUnPossess() override;
 
+  /// Only called if the vehicle is not in a FVehicleControlBatch.
   void Tick(float DeltaTime) override;
 
+  /// Set the control of this tick into the vehicle, without flushing it.
+  /// Called by Tick or by the FVehicleControlBatch of the episode.
+  void UpdateVehicleControl(float DeltaTime);
+
   /// @}
   // ===========================================================================
   /// @name Possessed vehicle
@@ -223,8 +229,11 @@ private:
   /// Returns throttle value.
   float Stop(float Speed);
 
-  /// Returns throttle value.
-  float Move(float Speed);
+  /// Returns throttle value to reach @a TargetSpeed, in km/h.
+  float Move(float Speed, float TargetSpeed);
+
+  /// Grid of the current episode, nullptr if there is no episode.
+  const FVehicleObstacleGrid *GetObstacleGrid() const;
 
   /// @}
   // ===========================================================================
@@ -0,0 +1,153 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Walker/WalkerAnimationLOD.h"
+
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Sensor/SceneCaptureSensor.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/Character.h"
+
+/// Seconds between animation updates for each level of detail, the frozen
+/// level is not updated at all.
+static constexpr float FWalkerAnimationLOD_TickInterval[] = {0.0f, 0.05f, 0.1f, 0.15f, 0.2f};
+
+uint8 FWalkerAnimationLOD::GetLevel(
+    const float Distance,
+    const float LODDistance,
+    const float FreezeDistance)
+{
+  if ((FreezeDistance > 0.0f) && (Distance > FreezeDistance))
+  {
+    return FROZEN_LEVEL;
+  }
+  if ((LODDistance <= 0.0f) || (Distance <= LODDistance))
+  {
+    return 0u;
+  }
+  // One more level every time the distance grows by LODDistance.
+  const int32 Level = FMath::FloorToInt(Distance / LODDistance);
+  return static_cast<uint8>(FMath::Clamp(Level, 1, FROZEN_LEVEL - 1));
+}
+
+void FWalkerAnimationLOD::SetLevel(
+    USkeletalMeshComponent &Mesh,
+    const FWalkerState &State,
+    const uint8 Level)
+{
+  if (Level == 0u)
+  {
+    Mesh.SetComponentTickInterval(State.TickInterval);
+    Mesh.bNoSkeletonUpdate = false;
+  }
+  else if (Level == FROZEN_LEVEL)
+  {
+    Mesh.bNoSkeletonUpdate = true;
+  }
+  else
+  {
+    Mesh.SetComponentTickInterval(FWalkerAnimationLOD_TickInterval[Level]);
+    Mesh.bNoSkeletonUpdate = false;
+  }
+}
+
+void FWalkerAnimationLOD::Tick(const UCarlaEpisode &Episode)
+{
+  // Walkers get back their detail a bit closer than they lost it, so the
+  // ones right at a distance do not switch every tick.
+  constexpr float HYSTERESIS = 0.9f;
+  constexpr float TO_CENTIMETERS = 1e2f;
+
+  const auto &Settings = Episode.GetSettings();
+  const float LODDistance = TO_CENTIMETERS * Settings.WalkerAnimationLODDistance;
+  const float FreezeDistance = TO_CENTIMETERS * Settings.WalkerAnimationFreezeDistance;
+  if ((LODDistance <= 0.0f) && (FreezeDistance <= 0.0f))
+  {
+    RestoreAll();
+    return;
+  }
+
+  const auto &Registry = Episode.GetActorRegistry();
+  TArray<FVector> Viewpoints;
+  for (auto &&View : Registry)
+  {
+    if (View.IsValid() && (Cast<ASceneCaptureSensor>(View.GetActor()) != nullptr))
+    {
+      Viewpoints.Add(View.GetActor()->GetActorLocation());
+    }
+  }
+  const APawn *Spectator = Episode.GetSpectatorPawn();
+  if ((Spectator != nullptr) && !Settings.bNoRenderingMode && !Settings.bNoViewportRendering)
+  {
+    Viewpoints.Add(Spectator->GetActorLocation());
+  }
+
+  for (auto &&View : Registry)
+  {
+    if ((View.GetActorType() != FActorView::ActorType::Walker) || !View.IsValid())
+    {
+      continue;
+    }
+    const auto *Character = Cast<ACharacter>(View.GetActor());
+    USkeletalMeshComponent *Mesh = Character != nullptr ? Character->GetMesh() : nullptr;
+    if (Mesh == nullptr)
+    {
+      continue;
+    }
+    FWalkerState *State = Walkers.Find(Mesh);
+    if (State == nullptr)
+    {
+      State = &Walkers.Add(Mesh);
+      State->TickOption = Mesh->VisibilityBasedAnimTickOption;
+      State->TickInterval = Mesh->GetComponentTickInterval();
+      // Walkers out of every camera keep only their montages ticking.
+      Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+    }
+
+    // Without viewpoints nothing is rendered, every walker is far.
+    const FVector Location = Character->GetActorLocation();
+    float ClosestSquared = TNumericLimits<float>::Max();
+    for (const auto &Viewpoint : Viewpoints)
+    {
+      ClosestSquared = FMath::Min(ClosestSquared, FVector::DistSquared(Location, Viewpoint));
+    }
+    const float Distance = FMath::Sqrt(ClosestSquared);
+    uint8 Level = GetLevel(Distance, LODDistance, FreezeDistance);
+    if (Level < State->Level)
+    {
+      Level = FMath::Min(State->Level, GetLevel(Distance / HYSTERESIS, LODDistance, FreezeDistance));
+    }
+    if (Level != State->Level)
+    {
+      SetLevel(*Mesh, *State, Level);
+      State->Level = Level;
+    }
+  }
+
+  // Forget the walkers destroyed.
+  for (auto It = Walkers.CreateIterator(); It; ++It)
+  {
+    if (!It.Key().IsValid())
+    {
+      It.RemoveCurrent();
+    }
+  }
+}
+
+void FWalkerAnimationLOD::RestoreAll()
+{
+  for (auto &Pair : Walkers)
+  {
+    if (Pair.Key.IsValid())
+    {
+      SetLevel(*Pair.Key.Get(), Pair.Value, 0u);
+      Pair.Key->VisibilityBasedAnimTickOption = Pair.Value.TickOption;
+    }
+  }
+  Walkers.Empty();
+}
@@ -0,0 +1,59 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Util/NonCopyable.h"
+
+#include "Components/SkinnedMeshComponent.h"
+#include "Containers/Map.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class USkeletalMeshComponent;
+class UCarlaEpisode;
+
+/// Animation level of detail of the walkers, by their distance to the
+/// nearest viewpoint: the camera sensors and the spectator, if the viewport
+/// renders.
+///
+/// Walkers farther than FEpisodeSettings::WalkerAnimationLODDistance update
+/// their animation at a lower rate the farther they are, and the ones
+/// farther than FEpisodeSettings::WalkerAnimationFreezeDistance keep their
+/// last pose. Walkers not rendered by any viewpoint skip the evaluation of
+/// their pose and only move. None of it changes how the walkers move.
+class FWalkerAnimationLOD : private NonCopyable
+{
+public:
+
+  /// Update the level of detail of the walkers of @a Episode.
+  void Tick(const UCarlaEpisode &Episode);
+
+private:
+
+  /// Level of detail of a walker, 0 is animated every frame and
+  /// FROZEN_LEVEL keeps the last pose.
+  struct FWalkerState
+  {
+    uint8 Level = 0u;
+
+    /// Settings of the mesh before it was managed, restored with the full
+    /// level of detail.
+    EVisibilityBasedAnimTickOption TickOption;
+
+    float TickInterval;
+  };
+
+  static constexpr uint8 FROZEN_LEVEL = 5u;
+
+  static uint8 GetLevel(float Distance, float LODDistance, float FreezeDistance);
+
+  static void SetLevel(USkeletalMeshComponent &Mesh, const FWalkerState &State, uint8 Level);
+
+  /// Back to full detail every walker.
+  void RestoreAll();
+
+  TMap<TWeakObjectPtr<USkeletalMeshComponent>, FWalkerState> Walkers;
+};
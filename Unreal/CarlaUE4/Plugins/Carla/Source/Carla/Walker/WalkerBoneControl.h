@@ -16,4 +16,7 @@ struct CARLA_API FWalkerBoneControl
   UPROPERTY(Category = "Walker Bone Control", EditAnywhere, BlueprintReadWrite)
   TMap<FString, FTransform> BoneTransforms;
 
+  /// Same as BoneTransforms with the names already converted, as given by a
+  /// batch of bone controls.
+  TArray<TPair<FName, FTransform>> BoneTransformsByName;
 };
@@ -138,7 +138,12 @@ void AWalkerController::ControlTickVisitor::operator()(FWalkerBoneControl &Walke
       FName BoneName = FName(*pair.Key);
       PoseableMesh->SetBoneTransformByName(BoneName, pair.Value, EBoneSpaces::Type::ComponentSpace);
     }
+    for (const auto &Pair : WalkerBoneControl.BoneTransformsByName)
+    {
+      PoseableMesh->SetBoneTransformByName(Pair.Key, Pair.Value, EBoneSpaces::Type::ComponentSpace);
+    }
     WalkerBoneControl.BoneTransforms.Empty();
+    WalkerBoneControl.BoneTransformsByName.Empty();
   }
 }
 
@@ -0,0 +1,181 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Walker/WalkerNavigation.h"
+
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Util/NavigationMesh.h"
+#include "Carla/Walker/WalkerController.h"
+
+#include "GameFramework/Pawn.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/geom/Location.h>
+#include <carla/rpc/WalkerControl.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <vector>
+
+bool FWalkerNavigation::AddWalker(
+    const UCarlaEpisode &Episode,
+    const carla::rpc::ActorId WalkerId,
+    const FVector &Location)
+{
+  if (!bIsLoaded)
+  {
+    const auto FileContents = FNavigationMesh::Load(Episode.GetMapName());
+    if (FileContents.Num() == 0)
+    {
+      return false;
+    }
+    std::vector<uint8_t> Content(FileContents.GetData(), FileContents.GetData() + FileContents.Num());
+    if (!Navigation.Load(std::move(Content)))
+    {
+      UE_LOG(LogCarla, Error, TEXT("FWalkerNavigation: failed to load the navigation mesh"));
+      return false;
+    }
+    bIsLoaded = true;
+  }
+  if (!Navigation.AddWalker(WalkerId, carla::geom::Location(Location)))
+  {
+    return false;
+  }
+  Walkers.Add(WalkerId, FWalkerAgent{});
+  return true;
+}
+
+bool FWalkerNavigation::RemoveWalker(const carla::rpc::ActorId WalkerId)
+{
+  Walkers.Remove(WalkerId);
+  return Navigation.RemoveWalker(WalkerId);
+}
+
+bool FWalkerNavigation::SetWalkerTarget(const carla::rpc::ActorId WalkerId, const FVector &Location)
+{
+  if (!Navigation.SetWalkerTarget(WalkerId, carla::geom::Location(Location)))
+  {
+    return false;
+  }
+  if (auto *Agent = Walkers.Find(WalkerId))
+  {
+    Agent->Target = Location;
+  }
+  return true;
+}
+
+bool FWalkerNavigation::SetWalkerMaxSpeed(const carla::rpc::ActorId WalkerId, const float MaxSpeed)
+{
+  if (!Navigation.SetWalkerMaxSpeed(WalkerId, MaxSpeed))
+  {
+    return false;
+  }
+  if (auto *Agent = Walkers.Find(WalkerId))
+  {
+    Agent->MaxSpeed = MaxSpeed;
+  }
+  return true;
+}
+
+void FWalkerNavigation::Tick(const UCarlaEpisode &Episode, const float DeltaSeconds)
+{
+  if (Walkers.Num() == 0)
+  {
+    return;
+  }
+
+  Navigation.UpdateCrowd(DeltaSeconds);
+
+  Batch.Clear();
+  Navigation.GetAllWalkerTransforms(Batch);
+  for (size_t i = 0u; i < Batch.size(); ++i)
+  {
+    const auto Entry = Batch.at(i);
+    auto ActorView = Episode.FindActor(Entry.actor);
+    if (!ActorView.IsValid())
+    {
+      RemoveWalker(Entry.actor);
+      continue;
+    }
+    ApplyWalkerState(*ActorView.GetActor(), Entry.transform, Entry.speed);
+  }
+}
+
+const char *FWalkerNavigation::ApplyWalkerState(
+    AActor &Actor,
+    const carla::rpc::Transform &Transform,
+    const float Speed)
+{
+  // apply walker transform
+  FTransform NewTransform = Transform;
+  FVector NewLocation = NewTransform.GetLocation();
+
+  FTransform CurrentTransform = Actor.GetTransform();
+  FVector CurrentLocation = CurrentTransform.GetLocation();
+
+  NewLocation.Z = CurrentLocation.Z;
+
+  NewTransform.SetLocation(NewLocation);
+
+  Actor.SetActorRelativeTransform(
+  NewTransform,
+  false,
+  nullptr,
+  ETeleportType::TeleportPhysics);
+
+  // apply walker speed
+  auto Pawn = Cast<APawn>(&Actor);
+  if (Pawn == nullptr)
+  {
+    return "unable to set walker state: actor is not a walker";
+  }
+  auto Controller = Cast<AWalkerController>(Pawn->GetController());
+  if (Controller == nullptr)
+  {
+    return "unable to set walker state: walker has an incompatible controller";
+  }
+  carla::rpc::WalkerControl Control(Transform.GetForwardVector(), Speed, false);
+  Controller->ApplyWalkerControl(Control);
+  return nullptr;
+}
+
+void FWalkerNavigation::GetWalkerStates(
+    const UCarlaEpisode &Episode,
+    TArray<FWalkerState> &States) const
+{
+  for (const auto &Walker : Walkers)
+  {
+    auto ActorView = Episode.FindActor(Walker.Key);
+    if (ActorView.IsValid())
+    {
+      States.Emplace(FWalkerState{
+          Walker.Key,
+          ActorView.GetActor()->GetActorLocation(),
+          Walker.Value.Target,
+          Walker.Value.MaxSpeed});
+    }
+  }
+}
+
+bool FWalkerNavigation::RestoreWalker(const UCarlaEpisode &Episode, const FWalkerState &State)
+{
+  // The crowd cannot move an agent, it is added again instead.
+  RemoveWalker(State.Id);
+  if (!AddWalker(Episode, State.Id, State.Location))
+  {
+    return false;
+  }
+  bool bSuccess = true;
+  if (State.MaxSpeed.IsSet())
+  {
+    bSuccess &= SetWalkerMaxSpeed(State.Id, State.MaxSpeed.GetValue());
+  }
+  if (State.Target.IsSet())
+  {
+    bSuccess &= SetWalkerTarget(State.Id, State.Target.GetValue());
+  }
+  return bSuccess;
+}
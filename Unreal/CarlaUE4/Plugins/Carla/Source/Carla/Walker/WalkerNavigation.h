@@ -0,0 +1,96 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Util/NonCopyable.h"
+
+#include "Containers/Map.h"
+#include "Misc/Optional.h"
+#include "GameFramework/Actor.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/nav/Navigation.h>
+#include <carla/rpc/ActorId.h>
+#include <carla/rpc/Transform.h>
+#include <carla/rpc/WalkerStateBatch.h>
+#include <compiler/enable-ue4-macros.h>
+
+class UCarlaEpisode;
+
+/// Pedestrian navigation run by the server. The same Recast & Detour crowd
+/// the clients run in carla::client::detail::WalkerNavigation, but driven by
+/// the game tick, so the walkers move without any network traffic and the
+/// clients only send their targets and speeds.
+class FWalkerNavigation : private NonCopyable
+{
+public:
+
+  /// Add the walker @a WalkerId at @a Location to the crowd. The navigation
+  /// mesh of the map of @a Episode is loaded with the first walker.
+  ///
+  /// @return false if there is no navigation mesh or the walker cannot be
+  /// added.
+  bool AddWalker(const UCarlaEpisode &Episode, carla::rpc::ActorId WalkerId, const FVector &Location);
+
+  bool RemoveWalker(carla::rpc::ActorId WalkerId);
+
+  bool SetWalkerTarget(carla::rpc::ActorId WalkerId, const FVector &Location);
+
+  bool SetWalkerMaxSpeed(carla::rpc::ActorId WalkerId, float MaxSpeed);
+
+  /// Move the crowd @a DeltaSeconds and apply the new state of every walker.
+  /// Walkers that no longer exist are removed from the crowd.
+  void Tick(const UCarlaEpisode &Episode, float DeltaSeconds);
+
+  /// Move the walker @a Actor to @a Transform, keeping its height, and make
+  /// it walk forward at @a Speed.
+  ///
+  /// @return the error message, or nullptr on success.
+  static const char *ApplyWalkerState(
+      AActor &Actor,
+      const carla::rpc::Transform &Transform,
+      float Speed);
+
+  /// Crowd state of a walker, put back by RestoreWalker.
+  struct FWalkerState
+  {
+    carla::rpc::ActorId Id;
+
+    FVector Location;
+
+    TOptional<FVector> Target;
+
+    TOptional<float> MaxSpeed;
+  };
+
+  /// Append the crowd state of every walker of @a Episode in the crowd to
+  /// @a States.
+  void GetWalkerStates(const UCarlaEpisode &Episode, TArray<FWalkerState> &States) const;
+
+  /// Add again the walker of @a State to the crowd at its location, with the
+  /// same target and speed.
+  bool RestoreWalker(const UCarlaEpisode &Episode, const FWalkerState &State);
+
+private:
+
+  /// Target and speed given to a walker, not retrievable from the crowd.
+  struct FWalkerAgent
+  {
+    TOptional<FVector> Target;
+
+    TOptional<float> MaxSpeed;
+  };
+
+  bool bIsLoaded = false;
+
+  carla::nav::Navigation Navigation;
+
+  TMap<carla::rpc::ActorId, FWalkerAgent> Walkers;
+
+  /// Reused every tick to avoid allocations.
+  carla::rpc::WalkerStateBatch Batch;
+};
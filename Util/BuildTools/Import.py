@@ -10,6 +10,7 @@
 
 from __future__ import print_function
 
+import argparse
 import errno
 import fnmatch
 import json
@@ -38,8 +39,10 @@ def get_packages_json_list(folder):
     return json_files
 
 
-def invoke_commandlet(name, arguments):
-    """Generic function for running a commandlet with its arguments."""
+def invoke_commandlet(name, arguments, wait=True):
+    """Generic function for running a commandlet with its arguments. If not
+    'wait', returns the running process.
+    """
     if os.name == "nt":
         sys_name = "Win64"
     elif os.name == "posix":
@@ -49,7 +52,10 @@ def invoke_commandlet(name, arguments):
     uproject_path = os.path.join(CARLA_ROOT_PATH, "Unreal", "CarlaUE4", "CarlaUE4.uproject")
     full_command = "%s %s -run=%s %s" % (editor_path, uproject_path, name, arguments)
     print("\n[" + str(SCRIPT_NAME) + "] Running command:\n$ " + full_command + '\n')
+    if not wait:
+        return subprocess.Popen([full_command], shell=True)
     subprocess.check_call([full_command], shell=True)
+    return None
 
 
 def generate_import_setting_file(package_name, json_dirname, props, maps):
@@ -198,7 +204,7 @@ def import_assets(package_name, json_dirname, props, maps):
     generate_package_file(package_name, props, maps)
 
 
-def import_assets_from_json_list(json_list):
+def import_assets_from_json_list(json_list, jobs=1):
     maps = []
     package_name = ""
     for dirname, filename in json_list:
@@ -227,14 +233,30 @@ def import_assets_from_json_list(json_list):
             move_assets_commandlet(package_name, maps)
 
             # We prepare only the maps for cooking after moving them. Props cooking will be done from Package.sh script.
-            prepare_maps_commandlet_for_cooking(package_name, only_prepare_maps=True)
+            prepare_maps_commandlet_for_cooking(package_name, only_prepare_maps=True, jobs=min(jobs, max(len(maps), 1)))
 
 
-def prepare_maps_commandlet_for_cooking(package_name, only_prepare_maps):
+def prepare_maps_commandlet_for_cooking(package_name, only_prepare_maps, jobs=1):
+    """Prepares the maps splitting them between 'jobs' commandlet processes
+    running at the same time. Maps that did not change since the last import
+    are skipped by the commandlet.
+    """
     commandlet_name = "PrepareAssetsForCooking"
     commandlet_arguments = "-PackageName=%s" % package_name
     commandlet_arguments += " -OnlyPrepareMaps=%d" % only_prepare_maps
-    invoke_commandlet(commandlet_name, commandlet_arguments)
+    if jobs <= 1:
+        invoke_commandlet(commandlet_name, commandlet_arguments)
+        return
+    processes = []
+    for worker_index in range(jobs):
+        worker_arguments = commandlet_arguments
+        worker_arguments += " -NumWorkers=%d -WorkerIndex=%d" % (jobs, worker_index)
+        processes.append(invoke_commandlet(commandlet_name, worker_arguments, wait=False))
+    # Wait for every worker before reporting a failure
+    return_codes = [process.wait() for process in processes]
+    for return_code in return_codes:
+        if return_code != 0:
+            raise subprocess.CalledProcessError(return_code, commandlet_name)
 
 
 def move_assets_commandlet(package_name, maps):
@@ -250,9 +272,18 @@ def move_assets_commandlet(package_name, maps):
 
 
 def main():
+    argparser = argparse.ArgumentParser(description=__doc__)
+    argparser.add_argument(
+        '-j', '--jobs',
+        metavar='N',
+        default=1,
+        type=int,
+        help='number of commandlet processes preparing the maps in parallel (default: 1)')
+    args = argparser.parse_args()
+
     import_folder = os.path.join(CARLA_ROOT_PATH, "Import")
     json_list = get_packages_json_list(import_folder)
-    import_assets_from_json_list(json_list)
+    import_assets_from_json_list(json_list, max(args.jobs, 1))
 
 
 if __name__ == '__main__':